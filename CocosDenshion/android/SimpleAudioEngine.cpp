@@ -232,6 +232,29 @@ void SimpleAudioEngine::preloadEffect(const char* pszFilePath)
 	}
 }
 
+void SimpleAudioEngine::preloadEffectAsync(const char* pszFilePath, const PreloadCallback& callback)
+{
+	// the effects are decoded by the platform
+	preloadEffect(pszFilePath);
+	if (callback)
+	{
+		callback(pszFilePath, true);
+	}
+}
+
+void SimpleAudioEngine::setMaxEffectVoices(unsigned int count)
+{
+	// the platform mixes the effects
+}
+
+void SimpleAudioEngine::setEffectPlaybackLimits(const char* pszFilePath, int priority, unsigned int maxInstances)
+{
+}
+
+void SimpleAudioEngine::setEffectsMemoryBudget(unsigned int budget, unsigned int minCompressedSize)
+{
+}
+
 void SimpleAudioEngine::unloadEffect(const char* pszFilePath)
 {
 	std::string fullPath = getFullPathWithoutAssetsPrefix(pszFilePath);
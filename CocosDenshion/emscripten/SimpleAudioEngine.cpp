@@ -252,6 +252,29 @@ namespace CocosDenshion
 	{
 	}
 
+	void SimpleAudioEngine::preloadEffectAsync(const char* pszFilePath, const PreloadCallback& callback)
+	{
+		// the effects are decoded by SDL_mixer
+		preloadEffect(pszFilePath);
+		if (callback)
+		{
+			callback(pszFilePath, true);
+		}
+	}
+
+	void SimpleAudioEngine::setMaxEffectVoices(unsigned int count)
+	{
+		// the platform (SDL_mixer) mixes the effects
+	}
+
+	void SimpleAudioEngine::setEffectPlaybackLimits(const char* pszFilePath, int priority, unsigned int maxInstances)
+	{
+	}
+
+	void SimpleAudioEngine::setEffectsMemoryBudget(unsigned int budget, unsigned int minCompressedSize)
+	{
+	}
+
 	void SimpleAudioEngine::unloadEffect(const char* pszFilePath)
 	{
         std::string key = std::string(pszFilePath);
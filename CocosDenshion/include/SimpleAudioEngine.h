@@ -31,6 +31,9 @@ THE SOFTWARE.
 #include <typeinfo>
 #include <ctype.h>
 #include <string.h>
+#include <functional>
+#include <string>
+#include <vector>
 
 #if defined(__GNUC__) && ((__GNUC__ >= 4) || ((__GNUC__ == 3) && (__GNUC_MINOR__ >= 1)))
 #define CC_DEPRECATED_ATTRIBUTE __attribute__((deprecated))
@@ -72,6 +75,9 @@ static inline unsigned int getHashCodeByString(const char *key)
 class EXPORT_DLL SimpleAudioEngine : public TypeInfo
 {
 public:
+    /** called once a preloaded effect is ready, with the path given to preloadEffectAsync() */
+    typedef std::function<void(const std::string& filePath, bool success)> PreloadCallback;
+
     /**
      @brief Get the shared Engine object,it will new one when first time be called
      */
@@ -217,6 +223,35 @@ public:
     */
     void stopAllEffects();
 
+    /**
+    @brief Set how many effects can play at the same time
+    @details        with the OpenAL backend the effects are played by a pool of this many sources, 32 by default.
+                    When all of them play, a new effect takes the source of the oldest effect among the least
+                    important ones, if it isn't more important than the new effect. The other backends leave the
+                    mixing to the platform and ignore it.
+    */
+    void setMaxEffectVoices(unsigned int count);
+
+    /**
+    @brief Set the priority of an effect, and how many instances of it can play at the same time
+    @details        the limits are kept for the effects loaded later. When maxInstances instances of the effect
+                    play, playing it again restarts the oldest one. Only the OpenAL backend supports it.
+    @param pszFilePath  The path of the effect file
+    @param priority     the effects with a higher priority take the voices of the other ones, 0 by default
+    @param maxInstances 0 for no limit, the default
+    */
+    void setEffectPlaybackLimits(const char* pszFilePath, int priority, unsigned int maxInstances);
+
+    /**
+    @brief Bound the memory used by the decoded effects
+    @details        with the OpenAL backend, the effects loaded afterwards whose decoded data is at least
+                    minCompressedSize bytes are also kept compressed in memory. Their decoded buffers are deleted,
+                    least recently played first, once they use more than budget bytes, and decoded again when they
+                    are played. The smaller effects stay decoded. The other backends ignore it.
+    @param budget   bytes of decoded data of the compressed effects, 0 to keep all the effects decoded (the default)
+    */
+    void setEffectsMemoryBudget(unsigned int budget, unsigned int minCompressedSize = 256 * 1024);
+
     /**
     @brief          preload a compressed audio file
     @details        the compressed audio will be decoded to wave, then written into an internal buffer in SimpleAudioEngine
@@ -224,6 +259,28 @@ public:
     */
     void preloadEffect(const char* pszFilePath);
 
+    /**
+    @brief          preload an audio file in the background
+    @details        with the OpenAL backend the effect is decoded on a worker thread, then added to the internal buffer
+                    in the main thread. The other backends preload it immediately.
+                    Playing the effect before it is ready decodes it immediately, as playEffect() does for any effect.
+    @param pszFilePath The path of the effect file
+    @param callback    called in the main thread once the effect is ready, or its decoding failed. Can be nullptr
+    */
+    void preloadEffectAsync(const char* pszFilePath, const PreloadCallback& callback = nullptr);
+
+    /**
+    @brief          preload several audio files in the background, see preloadEffectAsync()
+    @param callback called once for each file
+    */
+    void preloadEffectsAsync(const std::vector<std::string>& filePaths, const PreloadCallback& callback = nullptr)
+    {
+        for (auto& filePath : filePaths)
+        {
+            preloadEffectAsync(filePath.c_str(), callback);
+        }
+    }
+
     /**
     @brief          unload the preloaded effect from internal buffer
     @param pszFilePath        The path of the effect file
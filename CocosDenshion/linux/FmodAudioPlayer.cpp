@@ -311,6 +311,17 @@ unsigned int FmodAudioPlayer::playEffect(const char* pszFilePath, bool bLoop,
 			break;
 		}
 
+		// forgets the channels done playing, FMOD reuses them
+		map<unsigned int, FMOD::Channel*>::iterator c_it = mapEffectSoundChannel.begin();
+		while (c_it != mapEffectSoundChannel.end()) {
+			bool bPlaying = false;
+			if (c_it->second->isPlaying(&bPlaying) != FMOD_OK || !bPlaying) {
+				mapEffectSoundChannel.erase(c_it++);
+			} else {
+				++c_it;
+			}
+		}
+
 		pChannel->setChannelGroup(pChannelGroup);
         pChannel->setPan(pan);
         float freq = 0;
@@ -87,6 +87,24 @@ void SimpleAudioEngine::preloadEffect(const char* pszFilePath) {
 	return oAudioPlayer->preloadEffect(fullPath.c_str());
 }
 
+void SimpleAudioEngine::preloadEffectAsync(const char* pszFilePath, const PreloadCallback& callback) {
+	// the effects are decoded by FMOD
+	preloadEffect(pszFilePath);
+	if (callback) {
+		callback(pszFilePath, true);
+	}
+}
+
+void SimpleAudioEngine::setMaxEffectVoices(unsigned int count) {
+	// FMOD mixes the effects
+}
+
+void SimpleAudioEngine::setEffectPlaybackLimits(const char* pszFilePath, int priority, unsigned int maxInstances) {
+}
+
+void SimpleAudioEngine::setEffectsMemoryBudget(unsigned int budget, unsigned int minCompressedSize) {
+}
+
 void SimpleAudioEngine::unloadEffect(const char* pszFilePath) {
 	// Changing file path to full path
 	std::string fullPath = FileUtils::getInstance()->fullPathForFilename(pszFilePath);
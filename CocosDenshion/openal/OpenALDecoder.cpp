@@ -57,13 +57,18 @@ static int checkALError(const char *funcName)
 
 class AlutDecoder : public OpenALDecoder
 {
-    bool decode(OpenALFile &file, ALuint &result)
+    bool decode(OpenALFile &file, OpenALPCM &result)
     {
         if (!file.mapToMemory())
             return false;
-        result = alutCreateBufferFromFileImage(file.mappedFile, file.fileSize);
-        if (AL_NONE == result)
+        ALsizei size = 0;
+        ALfloat freq = 0;
+        ALvoid *data = alutLoadMemoryFromFileImage(file.mappedFile, file.fileSize, &result.format, &size, &freq);
+        if (!data)
             return false;
+        result.freq = (ALsizei)freq;
+        result.data.assign((char*)data, (char*)data + size);
+        free(data);
         return true;
     }
 
@@ -73,21 +78,13 @@ class AlutDecoder : public OpenALDecoder
     }
 };
 
-class DataRaii
-{
-public:
-    char *data;
-    size_t size;
-
-    DataRaii() : data(0), size(0) {}
-    ~DataRaii() { delete [] data; }
-};
-
 #ifdef ENABLE_MPG123
 class Mpg123Decoder : public OpenALDecoder
 {
 private:
     mpg123_handle *handle;
+    // the handle is shared by the threads decoding
+    std::mutex mutex;
 
 public:
     class MpgOpenRaii
@@ -124,8 +121,9 @@ public:
         return true;
     }
 
-    bool decode(OpenALFile &file, ALuint &result)
+    bool decode(OpenALFile &file, OpenALPCM &result)
     {
+        std::lock_guard<std::mutex> lock(mutex);
         if (MPG123_OK != mpg123_open_fd(handle, fileno(file.file)))
             return false;
         MpgOpenRaii raii(handle);
@@ -134,16 +132,18 @@ public:
         ALsizei size = 0;
         if (!getInfo(format, freq, size))
             return false;
-        DataRaii pcm;
-        pcm.size = size;
+        size_t pcmSize = size;
         if (format == AL_FORMAT_MONO16 || format == AL_FORMAT_STEREO16)
-            pcm.size *= 2;
-        pcm.data = new char[pcm.size];
+            pcmSize *= 2;
+        result.data.resize(pcmSize);
         size_t done = 0;
-        if (MPG123_DONE != mpg123_read(handle, (unsigned char*)pcm.data, pcm.size, &done))
+        if (MPG123_DONE != mpg123_read(handle, (unsigned char*)result.data.data(), pcmSize, &done))
             return false;
         CCLOG("MP3 BUFFER SIZE: %ld, FORMAT %i.", (long)done, (int)format);
-        return initALBuffer(result, format, pcm.data, done, freq);
+        result.data.resize(done);
+        result.format = format;
+        result.freq = freq;
+        return true;
     }
 
     bool acceptsFormat(Format format) const
@@ -167,6 +167,34 @@ public:
 #endif
 
 #ifndef DISABLE_VORBIS
+class VorbisStream : public OpenALStream
+{
+public:
+    OggVorbis_File file;
+    bool opened;
+
+    VorbisStream() : opened(false) {}
+    ~VorbisStream() { if (opened) ov_clear(&file); }
+
+    size_t read(char *data, size_t size)
+    {
+        size_t done = 0;
+        int section = 0;
+        while (done < size) {
+            long status = ov_read(&file, data + done, size - done, 0, 2, 1, &section);
+            if (status <= 0)
+                break;
+            done += status;
+        }
+        return done;
+    }
+
+    bool rewind()
+    {
+        return 0 == ov_pcm_seek(&file, 0);
+    }
+};
+
 class VorbisDecoder : public OpenALDecoder
 {
     class OggRaii
@@ -178,7 +206,7 @@ class VorbisDecoder : public OpenALDecoder
     };
 
 public:
-    bool decode(OpenALFile &file, ALuint &result)
+    bool decode(OpenALFile &file, OpenALPCM &result)
     {
         OggRaii ogg;
         int status = ov_test(file.file, &ogg.file, 0, 0);
@@ -197,14 +225,13 @@ public:
         vorbis_info *info = ov_info(&ogg.file, -1);
         ALenum  format = (info->channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
 
-        DataRaii pcm;
-        pcm.size = ov_pcm_total(&ogg.file, -1) * info->channels * 2;
-        pcm.data = new char[pcm.size];
+        std::vector<char> &pcm = result.data;
+        pcm.resize(ov_pcm_total(&ogg.file, -1) * info->channels * 2);
 
         size_t size = 0;
         int section = 0;
-        while (size < pcm.size) {
-            status = ov_read(&ogg.file, pcm.data + size, pcm.size - size, 0, 2, 1, &section);
+        while (size < pcm.size()) {
+            status = ov_read(&ogg.file, pcm.data() + size, pcm.size() - size, 0, 2, 1, &section);
             if (status > 0) {
                 size += status;
             } else if (status < 0) {
@@ -218,13 +245,33 @@ public:
             fprintf(stderr, "Unable to read OGG data from '%s'\n", file.debugName.c_str());
 			return false;
         }
-        return initALBuffer(result, format, pcm.data, pcm.size, info->rate);
+        pcm.resize(size);
+        result.format = format;
+        result.freq = info->rate;
+        return true;
     }
 
     bool acceptsFormat(Format format) const
     {
         return Vorbis == format;
     }
+
+    OpenALStream *openStream(OpenALFile &file)
+    {
+        VorbisStream *stream = new VorbisStream();
+        if (0 != ov_open(file.file, &stream->file, 0, 0)) {
+            // the file isn't owned by vorbis yet
+            delete stream;
+            return NULL;
+        }
+        // owned by vorbis from now on, closed by ov_clear()
+        file.file = NULL;
+        stream->opened = true;
+        vorbis_info *info = ov_info(&stream->file, -1);
+        stream->format = (info->channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+        stream->freq = info->rate;
+        return stream;
+    }
 };
 #endif
 
@@ -242,8 +289,10 @@ public:
         return decoder;
     }
 
-    bool decode(OpenALFile &file, ALuint &result)
+    bool decode(OpenALFile &file, OpenALPCM &result)
     {
+        // the decoder is shared by the threads decoding
+        std::lock_guard<std::mutex> lock(_mutex);
         if (!file.mapToMemory())
             return false;
         ByteBuffer inputBuffer;
@@ -268,8 +317,10 @@ public:
             }
         }
 
-        return initALBuffer(result, getALFormat(sampleType, channelType),
-                            pcm.GetPointer(), pcm.GetPosition(), sampleRate);
+        result.format = getALFormat(sampleType, channelType);
+        result.freq = sampleRate;
+        result.data.assign((const char*)pcm.GetPointer(), (const char*)pcm.GetPointer() + pcm.GetPosition());
+        return true;
     }
 
     bool acceptsFormat(Format format) const
@@ -354,6 +405,7 @@ private:
 
     Format _format;
     AudioDecoder _decoder;
+    std::mutex _mutex;
 };
 #endif
 
@@ -384,20 +436,35 @@ void OpenALDecoder::addDecoder(OpenALDecoder *decoder)
         _decoders.push_back(decoder);
 }
 
-bool OpenALDecoder::initALBuffer(ALuint &result, ALenum format,
-                                 const ALvoid *data, ALsizei size, ALsizei freq)
+OpenALStream *OpenALDecoder::openFileStream(OpenALFile &file)
+{
+    OpenALStream *stream = NULL;
+    for (size_t i = 0, n = _decoders.size(); !stream && i < n; ++i)
+        stream = _decoders[i]->openStream(file);
+    return stream;
+}
+
+bool OpenALDecoder::decodeFile(OpenALFile &file, OpenALPCM &result)
+{
+    bool success = false;
+    for (size_t i = 0, n = _decoders.size(); !success && i < n; ++i)
+        success = _decoders[i]->decode(file, result);
+    return success;
+}
+
+bool OpenALPCM::createBuffer(ALuint &result) const
 {
     // Load audio data into a buffer.
     alGenBuffers(1, &result);
 
-    if (checkALError("initALBuffer:alGenBuffers") != AL_NO_ERROR)
+    if (checkALError("createBuffer:alGenBuffers") != AL_NO_ERROR)
     {
         fprintf(stderr, "Couldn't generate OpenAL buffer\n");
         return false;
     }
 
-    alBufferData(result, format, data, size, freq);
-    checkALError("initALBuffer:alBufferData");
+    alBufferData(result, format, data.data(), data.size(), freq);
+    checkALError("createBuffer:alBufferData");
     return true;
 }
 
@@ -409,7 +476,9 @@ const std::vector<OpenALDecoder *> &OpenALDecoder::getDecoders()
 void OpenALFile::clear()
 {
     if (mappedFile) {
-        ::munmap(mappedFile, fileSize);
+        if (ownsMapping)
+            ::munmap(mappedFile, fileSize);
+        ownsMapping = true;
         mappedFile = 0;
         fileSize = 0;
     }
@@ -419,6 +488,18 @@ void OpenALFile::clear()
     }
 }
 
+bool OpenALFile::openMemory(const void *data, size_t size)
+{
+    clear();
+    file = fmemopen(const_cast<void *>(data), size, "rb");
+    if (!file)
+        return false;
+    mappedFile = const_cast<void *>(data);
+    fileSize = size;
+    ownsMapping = false;
+    return true;
+}
+
 bool OpenALFile::mapToMemory()
 {
     if (!file)
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
 #include <stdio.h>
 #include <AL/al.h>
 #include "cocos2d.h"
@@ -19,14 +20,47 @@ struct OpenALFile
     FILE *file;
     void *mappedFile; ///< Reserved by decoders.
     size_t fileSize; ///< Reserved by decoders.
+    bool ownsMapping; ///< false if mappedFile is memory given to openMemory().
 
-    OpenALFile() : file(0), mappedFile(0), fileSize(0) {}
+    OpenALFile() : file(0), mappedFile(0), fileSize(0), ownsMapping(true) {}
     ~OpenALFile() { clear(); }
 
     /// Unmaps from memory and closes file.
     void clear();
     /// Performs memory map, if was not mapped before.
     bool mapToMemory();
+    /// Opens the content of a file already in memory. The decoders reading a file descriptor (mpg123) can't decode it.
+    bool openMemory(const void *data, size_t size);
+};
+
+/// Decoded audio data, to be loaded in an OpenAL buffer.
+struct OpenALPCM
+{
+    ALenum format;
+    ALsizei freq;
+    std::vector<char> data;
+
+    OpenALPCM() : format(AL_NONE), freq(0) {}
+
+    /// Creates an OpenAL buffer with the data. Must be called from the main thread.
+    bool createBuffer(ALuint &result) const;
+};
+
+/// Decodes a file a part at a time, to stream the background music.
+class OpenALStream
+{
+public:
+    OpenALStream() : format(AL_NONE), freq(0) {}
+    virtual ~OpenALStream() {}
+
+    /// Decodes up to size bytes of PCM data. Returns the number of bytes decoded, 0 at the end of the file.
+    /// Doesn't use OpenAL: it can be called from any thread.
+    virtual size_t read(char *data, size_t size) = 0;
+    /// Goes back to the beginning of the file.
+    virtual bool rewind() = 0;
+
+    ALenum format;
+    ALsizei freq;
 };
 
 class OpenALDecoder
@@ -45,16 +79,24 @@ public:
     virtual ~OpenALDecoder() {}
 
     /// Returns true if such format is supported and decoding was successful.
-    virtual bool decode(OpenALFile &file, ALuint &result) = 0;
+    /// Doesn't use OpenAL: it can be called from any thread.
+    virtual bool decode(OpenALFile &file, OpenALPCM &result) = 0;
     virtual bool acceptsFormat(Format format) const = 0;
+    /// Returns a stream decoding the file, or NULL if the format isn't supported or can't be streamed.
+    /// The stream takes the ownership of the file.
+    virtual OpenALStream *openStream(OpenALFile &file) { return NULL; }
+
+    /// Opens a stream with the first decoder streaming the file.
+    static OpenALStream *openFileStream(OpenALFile &file);
+
+    /// Decodes the file with the first decoder accepting it. Can be called from any thread.
+    static bool decodeFile(OpenALFile &file, OpenALPCM &result);
 
     static const std::vector<OpenALDecoder *> &getDecoders();
     static void installDecoders();
 
 protected:
     static void addDecoder(OpenALDecoder *decoder);
-    bool initALBuffer(ALuint &result, ALenum format,
-                      const ALvoid* data, ALsizei size, ALsizei freq);
 
     static std::vector<OpenALDecoder *> _decoders;
 };
@@ -23,8 +23,15 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "SimpleAudioEngine.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <algorithm>
+#include <climits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <stdio.h>
 #include <unistd.h>
@@ -45,17 +52,47 @@ using namespace std;
 namespace CocosDenshion {
 
 struct soundData {
-    ALuint buffer;
-    ALuint source;
-    bool   isLooped;
-    float pitch;
-    float pan;
-    float gain;
+    ALuint buffer;       ///< AL_NONE while a compressed effect isn't decoded
+    int    priority;
+    unsigned int maxInstances; ///< 0 if unlimited
+    // effects kept compressed, see setEffectsMemoryBudget()
+    bool   compressed;   ///< whether the buffer can be deleted, and decoded again when played
+    vector<char> fileData; ///< content of the file, empty if it is decoded from the file
+    size_t pcmSize;
+    unsigned int lastUse;
 };
 
 typedef map<string, soundData *> EffectsMap;
 EffectsMap s_effects;
 
+struct effectLimits {
+    int priority;
+    unsigned int maxInstances;
+};
+
+// limits set by setEffectPlaybackLimits(), kept for the effects loaded later
+typedef map<string, effectLimits> EffectLimitsMap;
+EffectLimitsMap s_effectLimits;
+
+// the effects are played by a pool of sources, reused once their effect is done
+struct effectVoice {
+    ALuint source;
+    soundData *effect;   ///< effect played last, NULL once it is unloaded
+    unsigned int order;  ///< when it was played, to steal the oldest voice
+    float gain;
+};
+
+// the buffers of the compressed effects are deleted, least recently played first, beyond this size. 0 to keep them
+static size_t s_effectsBudget = 0;
+// the effects whose PCM data is at least this big are compressed
+static size_t s_minCompressedSize = 256 * 1024;
+static size_t s_decodedCompressedSize = 0;
+static unsigned int s_effectUse = 0;
+
+static vector<effectVoice> s_voices;
+static unsigned int s_maxVoices = 32;
+static unsigned int s_voiceOrder = 0;
+
 typedef enum {
     PLAYING,
     STOPPED,
@@ -65,15 +102,35 @@ typedef enum {
 static float s_volume                  = 1.0f;
 static float s_effectVolume            = 1.0f;
 
+class MusicStream;
+
 struct backgroundMusicData {
     ALuint buffer;
     ALuint source;
+    MusicStream *stream; ///< NULL if the music is decoded in buffer
 };
 
 typedef map<string, backgroundMusicData *> BackgroundMusicsMap;
 BackgroundMusicsMap s_backgroundMusics;
 
 static ALuint s_backgroundSource = AL_NONE;
+static MusicStream *s_backgroundStream = nullptr;
+
+// effects being decoded by preloadEffectAsync()
+struct decodedEffect {
+    OpenALPCM pcm;
+    vector<char> fileData;
+    bool success;
+};
+
+struct pendingEffect {
+    shared_ptr<decodedEffect> result;
+    JobSystem::TaskPtr task;
+    vector< pair<string, SimpleAudioEngine::PreloadCallback> > callbacks;
+};
+
+typedef map<string, pendingEffect> PendingEffectsMap;
+PendingEffectsMap s_pendingEffects;
 
 static SimpleAudioEngine  *s_engine = nullptr;
 
@@ -110,13 +167,248 @@ static int checkALError(const char *funcName)
     return err;
 }
 
+// the streamed music is decoded in this many buffers, refilled while they are played
+#define MUSIC_STREAM_BUFFERS            4
+#define MUSIC_STREAM_BUFFER_SIZE        (64 * 1024)
+// how often the buffers played are refilled, in milliseconds
+#define MUSIC_STREAM_REFILL_INTERVAL    50
+
+/// Plays the background music while decoding it, with a few buffers queued to its source.
+/// The buffers played are decoded again and queued back by a thread.
+class MusicStream
+{
+public:
+    /// returns NULL if no decoder streams the file
+    static MusicStream *open(const std::string &fullPath, const char *debugName)
+    {
+        OpenALFile file;
+        file.debugName = debugName;
+        file.file = fopen(fullPath.c_str(), "rb");
+        if (!file.file)
+            return NULL;
+
+        OpenALStream *stream = OpenALDecoder::openFileStream(file);
+        if (!stream)
+            return NULL;
+
+        MusicStream *music = new MusicStream(stream);
+        if (!music->init()) {
+            delete music;
+            return NULL;
+        }
+        return music;
+    }
+
+    ~MusicStream()
+    {
+        stopThread();
+        if (_source != AL_NONE) {
+            alSourceStop(_source);
+            alDeleteSources(1, &_source);
+            checkALError("~MusicStream:alDeleteSources");
+        }
+        if (_buffers[0] != AL_NONE) {
+            alDeleteBuffers(MUSIC_STREAM_BUFFERS, _buffers);
+            checkALError("~MusicStream:alDeleteBuffers");
+        }
+        delete _stream;
+    }
+
+    ALuint getSource() const { return _source; }
+
+    /// plays from the beginning. The source doesn't loop: the stream does
+    void play(bool loop)
+    {
+        stopThread();
+        _loop = loop;
+        if (!_rewound)
+            reset();
+        _rewound = false;
+        alSourcePlay(_source);
+        checkALError("MusicStream::play:alSourcePlay");
+        startThread();
+    }
+
+    /// stops and goes back to the beginning
+    void stop()
+    {
+        stopThread();
+        reset();
+    }
+
+    /// goes back to the beginning, keeping the music playing or paused
+    void rewind()
+    {
+        ALint state;
+        alGetSourcei(_source, AL_SOURCE_STATE, &state);
+        stopThread();
+        reset();
+
+        if (state == AL_PLAYING || state == AL_PAUSED)
+        {
+            _rewound = false;
+            alSourcePlay(_source);
+            if (state == AL_PAUSED)
+                alSourcePause(_source);
+            startThread();
+        }
+        checkALError("MusicStream::rewind:alSourcePlay");
+    }
+
+private:
+    MusicStream(OpenALStream *stream)
+        : _stream(stream)
+        , _source(AL_NONE)
+        , _loop(false)
+        , _ended(false)
+        , _rewound(false)
+        , _thread(NULL)
+        , _quit(false)
+    {
+        for (int i = 0; i < MUSIC_STREAM_BUFFERS; ++i)
+            _buffers[i] = AL_NONE;
+    }
+
+    bool init()
+    {
+        alGenSources(1, &_source);
+        if (checkALError("MusicStream:alGenSources") != AL_NO_ERROR) {
+            _source = AL_NONE;
+            return false;
+        }
+        alGenBuffers(MUSIC_STREAM_BUFFERS, _buffers);
+        if (checkALError("MusicStream:alGenBuffers") != AL_NO_ERROR) {
+            _buffers[0] = AL_NONE;
+            return false;
+        }
+        _data.resize(MUSIC_STREAM_BUFFER_SIZE);
+        // decodes the beginning now, so that the music starts immediately when it is played
+        reset();
+        return true;
+    }
+
+    /// stops the source and queues the beginning of the music, the thread must be stopped
+    void reset()
+    {
+        alSourceStop(_source);
+        // unqueues all the buffers
+        alSourcei(_source, AL_BUFFER, AL_NONE);
+        checkALError("MusicStream::reset:alSourcei");
+
+        _stream->rewind();
+        _ended = false;
+        for (int i = 0; i < MUSIC_STREAM_BUFFERS && fill(_buffers[i]); ++i)
+            alSourceQueueBuffers(_source, 1, &_buffers[i]);
+        checkALError("MusicStream::reset:alSourceQueueBuffers");
+        _rewound = true;
+    }
+
+    /// decodes the next part of the music in buffer, returns false at its end
+    bool fill(ALuint buffer)
+    {
+        if (_ended)
+            return false;
+
+        size_t size = _stream->read(&_data[0], _data.size());
+        if (size == 0 && _loop && _stream->rewind())
+            size = _stream->read(&_data[0], _data.size());
+        if (size == 0) {
+            _ended = true;
+            return false;
+        }
+
+        alBufferData(buffer, _stream->format, &_data[0], size, _stream->freq);
+        return true;
+    }
+
+    void startThread()
+    {
+        _quit = false;
+        _thread = new std::thread(&MusicStream::refillLoop, this);
+    }
+
+    void stopThread()
+    {
+        if (!_thread)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _quit = true;
+        }
+        _condition.notify_one();
+        _thread->join();
+        delete _thread;
+        _thread = NULL;
+    }
+
+    void refillLoop()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (!_quit)
+        {
+            ALint processed = 0;
+            alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed);
+            for (; processed > 0; --processed)
+            {
+                ALuint buffer = AL_NONE;
+                alSourceUnqueueBuffers(_source, 1, &buffer);
+                if (fill(buffer))
+                    alSourceQueueBuffers(_source, 1, &buffer);
+            }
+
+            // the source stops if all its buffers were played before being refilled
+            ALint state = 0;
+            ALint queued = 0;
+            alGetSourcei(_source, AL_SOURCE_STATE, &state);
+            alGetSourcei(_source, AL_BUFFERS_QUEUED, &queued);
+            if (state == AL_STOPPED && queued > 0)
+                alSourcePlay(_source);
+            checkALError("MusicStream::refillLoop");
+
+            _condition.wait_for(lock, std::chrono::milliseconds(MUSIC_STREAM_REFILL_INTERVAL));
+        }
+    }
+
+    OpenALStream *_stream;
+    ALuint _source;
+    ALuint _buffers[MUSIC_STREAM_BUFFERS];
+    std::vector<char> _data;
+    bool _loop;
+    bool _ended;    ///< the whole music was queued
+    bool _rewound;  ///< the beginning of the music is queued and wasn't played yet
+
+    std::thread *_thread;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _quit;
+};
+
+static void releaseBackgroundMusic(backgroundMusicData *data)
+{
+    if (data->stream)
+    {
+        delete data->stream;
+    }
+    else
+    {
+        alDeleteSources(1, &data->source);
+        checkALError("releaseBackgroundMusic:alDeleteSources");
+        alDeleteBuffers(1, &data->buffer);
+        checkALError("releaseBackgroundMusic:alDeleteBuffers");
+    }
+    delete data;
+}
+
 static void stopBackground(bool bReleaseData)
 {
     // The background music might have been already stopped
     // Stop request can come from
     //   - stopBackgroundMusic(..)
     //   - end(..)
-    if (s_backgroundSource != AL_NONE)
+    if (s_backgroundStream)
+        s_backgroundStream->stop();
+    else if (s_backgroundSource != AL_NONE)
         alSourceStop(s_backgroundSource);
 
     if (bReleaseData)
@@ -125,11 +417,7 @@ static void stopBackground(bool bReleaseData)
         {
             if (it->second->source == s_backgroundSource)
             {
-                alDeleteSources(1, &it->second->source);
-                checkALError("stopBackground:alDeleteSources");
-                alDeleteBuffers(1, &it->second->buffer);
-                checkALError("stopBackground:alDeleteBuffers");
-                delete it->second;
+                releaseBackgroundMusic(it->second);
                 s_backgroundMusics.erase(it);
                 break;
             }
@@ -137,6 +425,238 @@ static void stopBackground(bool bReleaseData)
     }
 
     s_backgroundSource = AL_NONE;
+    s_backgroundStream = nullptr;
+}
+
+static bool decodeFile(const std::string &fullPath, const char *debugName, OpenALPCM &pcm)
+{
+    OpenALFile file;
+    file.debugName = debugName;
+    file.file = fopen(fullPath.c_str(), "rb");
+    if (!file.file) {
+        fprintf(stderr, "Cannot read file: '%s'\n", fullPath.data());
+        return false;
+    }
+
+    bool success = OpenALDecoder::decodeFile(file, pcm);
+    file.clear();
+    return success;
+}
+
+/// Decodes an effect. Also reads the file in fileData if the effect is to be compressed. Can be called from any thread
+static bool loadEffect(const std::string &fullPath, const char *debugName, size_t minCompressedSize,
+                       OpenALPCM &pcm, vector<char> &fileData)
+{
+    if (!decodeFile(fullPath, debugName, pcm))
+        return false;
+
+    if (minCompressedSize > 0 && pcm.data.size() >= minCompressedSize)
+    {
+        FILE *file = fopen(fullPath.c_str(), "rb");
+        if (file)
+        {
+            fseek(file, 0, SEEK_END);
+            long size = ftell(file);
+            fseek(file, 0, SEEK_SET);
+            if (size > 0)
+            {
+                fileData.resize(size);
+                if (fread(&fileData[0], 1, size, file) != (size_t)size)
+                    fileData.clear();
+            }
+            fclose(file);
+        }
+    }
+    return true;
+}
+
+static bool isEffectPlaying(soundData *effect);
+static void releaseVoices(soundData *effect);
+
+/// Deletes the buffers of the compressed effects played least recently, except keep, until they fit in the budget
+static void trimDecodedEffects(soundData *keep)
+{
+    while (s_effectsBudget > 0 && s_decodedCompressedSize > s_effectsBudget)
+    {
+        soundData *oldest = NULL;
+        for (auto& entry : s_effects)
+        {
+            soundData *effect = entry.second;
+            if (effect->compressed && effect->buffer != AL_NONE && effect != keep
+                && (!oldest || effect->lastUse < oldest->lastUse) && !isEffectPlaying(effect))
+                oldest = effect;
+        }
+        if (!oldest)
+            break;
+
+        releaseVoices(oldest);
+        alDeleteBuffers(1, &oldest->buffer);
+        checkALError("trimDecodedEffects:alDeleteBuffers");
+        oldest->buffer = AL_NONE;
+        s_decodedCompressedSize -= oldest->pcmSize;
+    }
+}
+
+/// Decodes a compressed effect whose buffer was deleted
+static bool decodeEffect(const std::string &fullPath, soundData *effect)
+{
+    effect->lastUse = ++s_effectUse;
+    if (effect->buffer != AL_NONE)
+        return true;
+
+    OpenALPCM pcm;
+    bool success = false;
+    if (!effect->fileData.empty())
+    {
+        OpenALFile file;
+        file.debugName = fullPath;
+        success = file.openMemory(&effect->fileData[0], effect->fileData.size()) && OpenALDecoder::decodeFile(file, pcm);
+        // its decoder reads a file descriptor: it is decoded from the file from now on
+        if (!success)
+            vector<char>().swap(effect->fileData);
+    }
+    if (!success)
+        success = decodeFile(fullPath, fullPath.c_str(), pcm);
+    if (!success || !pcm.createBuffer(effect->buffer))
+    {
+        effect->buffer = AL_NONE;
+        return false;
+    }
+
+    effect->pcmSize = pcm.data.size();
+    s_decodedCompressedSize += effect->pcmSize;
+    trimDecodedEffects(effect);
+    return true;
+}
+
+static bool addEffect(const std::string &fullPath, const OpenALPCM &pcm, vector<char> &fileData, bool compressed)
+{
+    ALuint      buffer = AL_NONE;
+
+    checkALError("addEffect:init");
+    if (!pcm.createBuffer(buffer))
+        return false;
+
+    soundData  *data = new soundData;
+    data->buffer = buffer;
+    data->priority = 0;
+    data->maxInstances = 0;
+    data->compressed = compressed;
+    data->fileData.swap(fileData);
+    data->pcmSize = pcm.data.size();
+    data->lastUse = ++s_effectUse;
+
+    EffectLimitsMap::const_iterator limits = s_effectLimits.find(fullPath);
+    if (limits != s_effectLimits.end())
+    {
+        data->priority = limits->second.priority;
+        data->maxInstances = limits->second.maxInstances;
+    }
+
+    s_effects.insert(EffectsMap::value_type(fullPath, data));
+
+    if (compressed)
+    {
+        s_decodedCompressedSize += data->pcmSize;
+        trimDecodedEffects(data);
+    }
+    return true;
+}
+
+static bool isVoicePlaying(const effectVoice &voice)
+{
+    ALint state;
+    alGetSourcei(voice.source, AL_SOURCE_STATE, &state);
+    return state == AL_PLAYING || state == AL_PAUSED;
+}
+
+static bool isEffectPlaying(soundData *effect)
+{
+    for (auto& voice : s_voices)
+    {
+        if (voice.effect == effect && isVoicePlaying(voice))
+            return true;
+    }
+    return false;
+}
+
+/// Returns the voice to play effect with, or NULL if all the voices play more important effects.
+static effectVoice *findVoice(soundData *effect)
+{
+    effectVoice *freeVoice = NULL;
+    effectVoice *oldestInstance = NULL;
+    effectVoice *stolenVoice = NULL;
+    unsigned int instances = 0;
+
+    for (auto& voice : s_voices)
+    {
+        if (!isVoicePlaying(voice))
+        {
+            if (!freeVoice)
+                freeVoice = &voice;
+            continue;
+        }
+
+        if (voice.effect == effect)
+        {
+            ++instances;
+            if (!oldestInstance || voice.order < oldestInstance->order)
+                oldestInstance = &voice;
+        }
+
+        // the least important effect, the oldest one among them
+        int priority = voice.effect ? voice.effect->priority : INT_MIN;
+        if (priority <= effect->priority)
+        {
+            int stolenPriority = stolenVoice && stolenVoice->effect ? stolenVoice->effect->priority : INT_MIN;
+            if (!stolenVoice || priority < stolenPriority || (priority == stolenPriority && voice.order < stolenVoice->order))
+                stolenVoice = &voice;
+        }
+    }
+
+    // too many instances of the effect: the oldest one is restarted
+    if (effect->maxInstances > 0 && instances >= effect->maxInstances)
+        return oldestInstance;
+
+    if (freeVoice)
+        return freeVoice;
+
+    if (s_voices.size() < s_maxVoices)
+    {
+        effectVoice voice;
+        voice.effect = NULL;
+        voice.order = 0;
+        voice.gain = 1.0f;
+        alGenSources(1, &voice.source);
+        if (checkALError("findVoice:alGenSources") == AL_NO_ERROR)
+        {
+            s_voices.push_back(voice);
+            return &s_voices.back();
+        }
+    }
+
+    return stolenVoice;
+}
+
+/// Stops the voices playing effect, and detaches its buffer from them.
+static void releaseVoices(soundData *effect)
+{
+    for (auto& voice : s_voices)
+    {
+        if (voice.effect == effect)
+        {
+            alSourceStop(voice.source);
+            alSourcei(voice.source, AL_BUFFER, AL_NONE);
+            voice.effect = NULL;
+        }
+    }
+    checkALError("releaseVoices");
+}
+
+static void cancelPendingEffect(PendingEffectsMap::iterator it)
+{
+    JobSystem::getInstance()->cancelTask(it->second.task);
+    s_pendingEffects.erase(it);
 }
 
 static void setBackgroundVolume(float volume)
@@ -174,22 +694,31 @@ void SimpleAudioEngine::end()
 {
     checkALError("end:init");
 
+    // the effects being decoded are dropped
+    while (!s_pendingEffects.empty())
+        cancelPendingEffect(s_pendingEffects.begin());
+
     // clear all the sound effects
-    EffectsMap::const_iterator end = s_effects.end();
-    for (auto it = s_effects.begin(); it != end; ++it)
+    for (auto& voice : s_voices)
     {
-        alSourceStop(it->second->source);
+        alSourceStop(voice.source);
         checkALError("end:alSourceStop");
 
-        alDeleteSources(1, &it->second->source);
+        alDeleteSources(1, &voice.source);
         checkALError("end:alDeleteSources");
+    }
+    s_voices.clear();
 
+    EffectsMap::const_iterator end = s_effects.end();
+    for (auto it = s_effects.begin(); it != end; ++it)
+    {
         alDeleteBuffers(1, &it->second->buffer);
         checkALError("end:alDeleteBuffers");
 
         delete it->second;
     }
     s_effects.clear();
+    s_decodedCompressedSize = 0;
 
     // and the background music too
     stopBackground(true);
@@ -199,13 +728,7 @@ void SimpleAudioEngine::end()
         alSourceStop(it->second->source);
         checkALError("end:alSourceStop");
 
-        alDeleteSources(1, &it->second->source);
-        checkALError("end:alDeleteSources");
-
-        alDeleteBuffers(1, &it->second->buffer);
-        checkALError("end:alDeleteBuffers");
-
-        delete it->second;
+        releaseBackgroundMusic(it->second);
     }
     s_backgroundMusics.clear();
 
@@ -223,20 +746,22 @@ void SimpleAudioEngine::preloadBackgroundMusic(const char* pszFilePath)
     BackgroundMusicsMap::const_iterator it = s_backgroundMusics.find(fullPath);
     if (it == s_backgroundMusics.end())
     {
-        ALuint buffer = AL_NONE;
-        bool success = false;
-        OpenALFile file;
-        file.debugName = pszFilePath;
-        file.file = fopen(fullPath.c_str(), "rb");
-        if (!file.file) {
-            fprintf(stderr, "Cannot read file: '%s'\n", fullPath.data());
+        // streamed if a decoder supports it, to start playing without decoding the whole music
+        MusicStream *stream = MusicStream::open(fullPath, pszFilePath);
+        if (stream)
+        {
+            backgroundMusicData* data = new backgroundMusicData();
+            data->buffer = AL_NONE;
+            data->source = stream->getSource();
+            data->stream = stream;
+            s_backgroundMusics.insert(BackgroundMusicsMap::value_type(fullPath, data));
             return;
         }
 
-        const std::vector<OpenALDecoder *> &decoders = OpenALDecoder::getDecoders();
-        for (size_t i = 0, n = decoders.size(); !success && i < n; ++i)
-            success = decoders[i]->decode(file, buffer);
-        file.clear();
+        ALuint buffer = AL_NONE;
+        OpenALPCM pcm;
+        if (!decodeFile(fullPath, pszFilePath, pcm) || !pcm.createBuffer(buffer))
+            return;
 
         ALuint source = AL_NONE;
         alGenSources(1, &source);
@@ -248,6 +773,7 @@ void SimpleAudioEngine::preloadBackgroundMusic(const char* pszFilePath)
         backgroundMusicData* data = new backgroundMusicData();
         data->buffer = buffer;
         data->source = source;
+        data->stream = NULL;
         s_backgroundMusics.insert(BackgroundMusicsMap::value_type(fullPath, data));
     }
 }
@@ -271,10 +797,18 @@ void SimpleAudioEngine::playBackgroundMusic(const char* pszFilePath, bool bLoop)
     if (it != s_backgroundMusics.end())
     {
         s_backgroundSource = it->second->source;
-        alSourcei(s_backgroundSource, AL_LOOPING, bLoop ? AL_TRUE : AL_FALSE);
+        s_backgroundStream = it->second->stream;
         setBackgroundVolume(s_volume);
-        alSourcePlay(s_backgroundSource);
-        checkALError("playBackgroundMusic:alSourcePlay");
+        if (s_backgroundStream)
+        {
+            s_backgroundStream->play(bLoop);
+        }
+        else
+        {
+            alSourcei(s_backgroundSource, AL_LOOPING, bLoop ? AL_TRUE : AL_FALSE);
+            alSourcePlay(s_backgroundSource);
+            checkALError("playBackgroundMusic:alSourcePlay");
+        }
     }
 }
 
@@ -324,6 +858,12 @@ void SimpleAudioEngine::rewindBackgroundMusic()
     if (s_backgroundSource == AL_NONE)
         return;
 
+    if (s_backgroundStream)
+    {
+        s_backgroundStream->rewind();
+        return;
+    }
+
     // Rewind and prevent the last state the source had
     ALint state;
     alGetSourcei(s_backgroundSource, AL_SOURCE_STATE, &state);
@@ -395,10 +935,9 @@ void SimpleAudioEngine::setEffectsVolume(float volume)
 {
     if (volume != s_effectVolume)
     {
-        EffectsMap::const_iterator end = s_effects.end();
-        for (EffectsMap::const_iterator it = s_effects.begin(); it != end; it++)
+        for (auto& voice : s_voices)
         {
-            alSourcef(it->second->source, AL_GAIN, volume * it->second->gain);
+            alSourcef(voice.source, AL_GAIN, volume * voice.gain);
         }
 
         s_effectVolume = volume;
@@ -427,20 +966,30 @@ unsigned int SimpleAudioEngine::playEffect(const char* pszFilePath, bool bLoop,
 
     checkALError("playEffect:init");
 
-    soundData &d = *iter->second;
-    d.isLooped = bLoop;
-    d.pitch = pitch;
-    d.pan = pan;
-    d.gain = gain;
-    alSourcei(d.source, AL_LOOPING, d.isLooped ? AL_TRUE : AL_FALSE);
-    alSourcef(d.source, AL_GAIN, s_effectVolume * d.gain);
-    alSourcef(d.source, AL_PITCH, d.pitch);
-    float sourcePosAL[] = {d.pan, 0.0f, 0.0f};//Set position - just using left and right panning
-    alSourcefv(d.source, AL_POSITION, sourcePosAL);
-    alSourcePlay(d.source);
+    soundData *effect = iter->second;
+    if (!decodeEffect(fullPath, effect))
+        return -1;
+
+    effectVoice *voice = findVoice(effect);
+    if (!voice)
+        return -1;
+
+    voice->effect = effect;
+    voice->order = ++s_voiceOrder;
+    voice->gain = gain;
+
+    ALuint source = voice->source;
+    alSourceStop(source);
+    alSourcei(source, AL_BUFFER, effect->buffer);
+    alSourcei(source, AL_LOOPING, bLoop ? AL_TRUE : AL_FALSE);
+    alSourcef(source, AL_GAIN, s_effectVolume * gain);
+    alSourcef(source, AL_PITCH, pitch);
+    float sourcePosAL[] = {pan, 0.0f, 0.0f};//Set position - just using left and right panning
+    alSourcefv(source, AL_POSITION, sourcePosAL);
+    alSourcePlay(source);
     checkALError("playEffect:alSourcePlay");
 
-    return d.source;
+    return source;
 }
 
 void SimpleAudioEngine::stopEffect(unsigned int nSoundId)
@@ -459,45 +1008,68 @@ void SimpleAudioEngine::preloadEffect(const char* pszFilePath)
     // check if we have this already
     if (iter == s_effects.end())
     {
-        ALuint      buffer = AL_NONE;
-        ALuint      source = AL_NONE;
-        soundData  *data = new soundData;
+        OpenALPCM pcm;
+        vector<char> fileData;
+        size_t minCompressedSize = s_effectsBudget > 0 ? s_minCompressedSize : 0;
+        if (loadEffect(fullPath, pszFilePath, minCompressedSize, pcm, fileData))
+            addEffect(fullPath, pcm, fileData, minCompressedSize > 0 && pcm.data.size() >= minCompressedSize);
+    }
+}
 
-        checkALError("preloadEffect:init");
-        OpenALFile file;
-        file.debugName = pszFilePath;
-        file.file = fopen(fullPath.c_str(), "rb");
-        if (!file.file) {
-            fprintf(stderr, "Cannot read file: '%s'\n", fullPath.data());
-            return;
-        }
+void SimpleAudioEngine::preloadEffectAsync(const char* pszFilePath, const PreloadCallback& callback)
+{
+    // Changing file path to full path
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(pszFilePath);
 
-        bool success = false;
-        const std::vector<OpenALDecoder *> &decoders = OpenALDecoder::getDecoders();
-        for (size_t i = 0, n = decoders.size(); !success && i < n; ++i)
-            success = decoders[i]->decode(file, buffer);
-        file.clear();
+    if (s_effects.find(fullPath) != s_effects.end())
+    {
+        if (callback)
+            callback(pszFilePath, true);
+        return;
+    }
 
-        alGenSources(1, &source);
+    // already being decoded
+    PendingEffectsMap::iterator pending = s_pendingEffects.find(fullPath);
+    if (pending != s_pendingEffects.end())
+    {
+        if (callback)
+            pending->second.callbacks.push_back(make_pair(string(pszFilePath), callback));
+        return;
+    }
 
-        if (checkALError("preloadEffect:alGenSources") != AL_NO_ERROR)
-        {
-            alDeleteBuffers(1, &buffer);
+    // the file is decoded on a worker thread, the OpenAL buffer is created in the main thread
+    shared_ptr<decodedEffect> result = make_shared<decodedEffect>();
+    result->success = false;
+    string debugName = pszFilePath;
+
+    pendingEffect &effect = s_pendingEffects[fullPath];
+    effect.result = result;
+    if (callback)
+        effect.callbacks.push_back(make_pair(debugName, callback));
+
+    size_t minCompressedSize = s_effectsBudget > 0 ? s_minCompressedSize : 0;
+    effect.task = JobSystem::getInstance()->addTask([result, fullPath, debugName, minCompressedSize] {
+        result->success = loadEffect(fullPath, debugName.c_str(), minCompressedSize, result->pcm, result->fileData);
+    }, [result, fullPath, minCompressedSize] {
+        PendingEffectsMap::iterator it = s_pendingEffects.find(fullPath);
+        // unloaded, or unloaded then preloaded again
+        if (it == s_pendingEffects.end() || it->second.result != result)
             return;
-        }
 
-        alSourcei(source, AL_BUFFER, buffer);
-        checkALError("preloadEffect:alSourcei");
+        vector< pair<string, PreloadCallback> > callbacks;
+        callbacks.swap(it->second.callbacks);
+        s_pendingEffects.erase(it);
 
-        data->isLooped = false;
-        data->buffer = buffer;
-        data->source = source;
-        data->pitch = 1.0;
-        data->pan = 0.0;
-        data->gain = 1.0;
+        // playEffect() may have decoded it meanwhile
+        bool success = s_effects.find(fullPath) != s_effects.end();
+        if (!success && result->success)
+            success = addEffect(fullPath, result->pcm, result->fileData,
+                                minCompressedSize > 0 && result->pcm.data.size() >= minCompressedSize);
+        result->pcm.data.clear();
 
-        s_effects.insert(EffectsMap::value_type(fullPath, data));
-    }
+        for (auto& entry : callbacks)
+            entry.second(entry.first, success);
+    });
 }
 
 void SimpleAudioEngine::unloadEffect(const char* pszFilePath)
@@ -505,18 +1077,26 @@ void SimpleAudioEngine::unloadEffect(const char* pszFilePath)
     // Changing file path to full path
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(pszFilePath);
 
+    PendingEffectsMap::iterator pending = s_pendingEffects.find(fullPath);
+    if (pending != s_pendingEffects.end())
+    {
+        vector< pair<string, PreloadCallback> > callbacks;
+        callbacks.swap(pending->second.callbacks);
+        cancelPendingEffect(pending);
+        for (auto& entry : callbacks)
+            entry.second(entry.first, false);
+    }
+
     EffectsMap::iterator iter = s_effects.find(fullPath);
 
     if (iter != s_effects.end())
     {
         checkALError("unloadEffect:init");
 
-        alSourceStop(iter->second->source);
-        checkALError("unloadEffect:alSourceStop");
-
-        alDeleteSources(1, &iter->second->source);
-        checkALError("unloadEffect:DeletSources");
+        releaseVoices(iter->second);
 
+        if (iter->second->compressed && iter->second->buffer != AL_NONE)
+            s_decodedCompressedSize -= iter->second->pcmSize;
         alDeleteBuffers(1, &iter->second->buffer);
         checkALError("unloadEffect:alDeleteBuffers");
         delete iter->second;
@@ -536,15 +1116,13 @@ void SimpleAudioEngine::pauseEffect(unsigned int nSoundId)
 
 void SimpleAudioEngine::pauseAllEffects()
 {
-    EffectsMap::iterator iter = s_effects.begin();
     ALint state;
-    while (iter != s_effects.end())
+    for (auto& voice : s_voices)
     {
-        alGetSourcei(iter->second->source, AL_SOURCE_STATE, &state);
+        alGetSourcei(voice.source, AL_SOURCE_STATE, &state);
         if (state == AL_PLAYING)
-            alSourcePause(iter->second->source);
+            alSourcePause(voice.source);
         checkALError("pauseAllEffects:alSourcePause");
-        ++iter;
     }
 }
 
@@ -559,28 +1137,66 @@ void SimpleAudioEngine::resumeEffect(unsigned int nSoundId)
 
 void SimpleAudioEngine::resumeAllEffects()
 {
-    EffectsMap::iterator iter = s_effects.begin();
     ALint state;
-    while (iter != s_effects.end())
+    for (auto& voice : s_voices)
     {
-        alGetSourcei(iter->second->source, AL_SOURCE_STATE, &state);
+        alGetSourcei(voice.source, AL_SOURCE_STATE, &state);
         if (state == AL_PAUSED)
-            alSourcePlay(iter->second->source);
+            alSourcePlay(voice.source);
         checkALError("resumeAllEffects:alSourcePlay");
-        ++iter;
     }
 }
 
 void SimpleAudioEngine::stopAllEffects()
 {
-    EffectsMap::iterator iter = s_effects.begin();
+    checkALError("stopAllEffects:init");
+    for (auto& voice : s_voices)
+    {
+        alSourceStop(voice.source);
+        checkALError("stopAllEffects:alSourceStop");
+    }
+}
+
+void SimpleAudioEngine::setMaxEffectVoices(unsigned int count)
+{
+    s_maxVoices = count;
+
+    // the voices beyond the new limit are deleted, the most recently played are kept
+    if (s_voices.size() > count)
+    {
+        sort(s_voices.begin(), s_voices.end(), [](const effectVoice& a, const effectVoice& b) {
+            return a.order > b.order;
+        });
+        for (size_t i = count; i < s_voices.size(); ++i)
+        {
+            alSourceStop(s_voices[i].source);
+            alDeleteSources(1, &s_voices[i].source);
+        }
+        s_voices.resize(count);
+        checkALError("setMaxEffectVoices:alDeleteSources");
+    }
+}
+
+void SimpleAudioEngine::setEffectPlaybackLimits(const char* pszFilePath, int priority, unsigned int maxInstances)
+{
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(pszFilePath);
 
+    effectLimits limits = { priority, maxInstances };
+    s_effectLimits[fullPath] = limits;
+
+    EffectsMap::iterator iter = s_effects.find(fullPath);
     if (iter != s_effects.end())
     {
-        checkALError("stopAllEffects:init");
-        alSourceStop(iter->second->source);
-        checkALError("stopAllEffects:alSourceStop");
+        iter->second->priority = priority;
+        iter->second->maxInstances = maxInstances;
     }
 }
 
+void SimpleAudioEngine::setEffectsMemoryBudget(unsigned int budget, unsigned int minCompressedSize)
+{
+    s_effectsBudget = budget;
+    s_minCompressedSize = minCompressedSize;
+    trimDecodedEffects(NULL);
+}
+
 } // namespace CocosDenshion {
@@ -394,6 +394,33 @@ SimpleAudioEngine::preloadEffect(const char* pszFilePath)
     QString filename = fullPath(pszFilePath);
 }
 
+/**
+@brief          preload an audio file in the background, calls the callback immediately
+*/
+void
+SimpleAudioEngine::preloadEffectAsync(const char* pszFilePath, const PreloadCallback& callback)
+{
+    preloadEffect(pszFilePath);
+    if (callback) {
+        callback(pszFilePath, true);
+    }
+}
+
+void
+SimpleAudioEngine::setMaxEffectVoices(unsigned int count)
+{
+}
+
+void
+SimpleAudioEngine::setEffectPlaybackLimits(const char* pszFilePath, int priority, unsigned int maxInstances)
+{
+}
+
+void
+SimpleAudioEngine::setEffectsMemoryBudget(unsigned int budget, unsigned int minCompressedSize)
+{
+}
+
 /**
 @brief          unload the preloaded effect from internal buffer
 @param[in]        pszFilePath        The path of the effect file,or the FileName of T_SoundResInfo
@@ -11,12 +11,15 @@ CCConfiguration.cpp \
 CCDeprecated.cpp \
 CCScheduler.cpp \
 CCCamera.cpp \
+CCCamera2D.cpp \
 ccFPSImages.c \
 ccTypes.cpp \
 actions/CCAction.cpp \
 actions/CCActionCamera.cpp \
 actions/CCActionCatmullRom.cpp \
 actions/CCActionEase.cpp \
+actions/CCTweenEasing.cpp \
+actions/CCActionTemplate.cpp \
 actions/CCActionGrid.cpp \
 actions/CCActionGrid3D.cpp \
 actions/CCActionInstant.cpp \
@@ -31,7 +34,9 @@ base_nodes/CCNode.cpp \
 cocoa/CCAffineTransform.cpp \
 cocoa/CCGeometry.cpp \
 cocoa/CCAutoreleasePool.cpp \
+cocoa/CCPoolAllocator.cpp \
 cocoa/CCDictionary.cpp \
+cocoa/CCStringDictionary.cpp \
 cocoa/CCNS.cpp \
 cocoa/CCObject.cpp \
 cocoa/CCSet.cpp \
@@ -43,6 +48,13 @@ cocos2d.cpp \
 CCDirector.cpp \
 draw_nodes/CCDrawingPrimitives.cpp \
 draw_nodes/CCDrawNode.cpp \
+renderer/CCRenderer.cpp \
+renderer/CCGroupCommand.cpp \
+renderer/CCPrimitiveCommand.cpp \
+renderer/CCBufferArena.cpp \
+renderer/CCCustomCommand.cpp \
+renderer/CCQuadCommand.cpp \
+renderer/CCRenderCommand.cpp \
 effects/CCGrabber.cpp \
 effects/CCGrid.cpp \
 kazmath/src/aabb.c \
@@ -61,9 +73,13 @@ kazmath/src/GL/matrix.c \
 keypad_dispatcher/CCKeypadDelegate.cpp \
 keypad_dispatcher/CCKeypadDispatcher.cpp \
 keyboard_dispatcher/CCKeyboardDispatcher.cpp \
+event_dispatcher/CCEvent.cpp \
+event_dispatcher/CCEventListener.cpp \
+event_dispatcher/CCEventDispatcher.cpp \
 label_nodes/CCLabelAtlas.cpp \
 label_nodes/CCLabelBMFont.cpp \
 label_nodes/CCLabelTTF.cpp \
+label_nodes/CCFontAtlas.cpp \
 layers_scenes_transitions_nodes/CCLayer.cpp \
 layers_scenes_transitions_nodes/CCScene.cpp \
 layers_scenes_transitions_nodes/CCTransitionPageTurn.cpp \
@@ -79,10 +95,13 @@ particle_nodes/CCParticleExamples.cpp \
 particle_nodes/CCParticleSystem.cpp \
 particle_nodes/CCParticleBatchNode.cpp \
 particle_nodes/CCParticleSystemQuad.cpp \
+particle_nodes/CCParticleSystemGPU.cpp \
+particle_nodes/CCParticleSystemManager.cpp \
 platform/CCImageCommonWebp.cpp \
 platform/CCSAXParser.cpp \
 platform/CCThread.cpp \
 platform/CCFileUtils.cpp \
+platform/CCMappedFile.cpp \
 platform/CCEGLViewProtocol.cpp \
 platform/android/CCDevice.cpp \
 platform/android/CCEGLView.cpp \
@@ -108,10 +127,22 @@ sprite_nodes/CCAnimation.cpp \
 sprite_nodes/CCAnimationCache.cpp \
 sprite_nodes/CCSprite.cpp \
 sprite_nodes/CCSpriteBatchNode.cpp \
+sprite_nodes/CCInstancedSpriteBatch.cpp \
 sprite_nodes/CCSpriteFrame.cpp \
 sprite_nodes/CCSpriteFrameCache.cpp \
 support/ccUTF8.cpp \
 support/CCNotificationCenter.cpp \
+support/CCJobSystem.cpp \
+support/CCSkeletonEvaluator.cpp \
+support/CCNodeBuildQueue.cpp \
+support/CCResourceGroupManager.cpp \
+support/CCInputRecorder.cpp \
+support/CCObjectPool.cpp \
+support/CCFrameProfiler.cpp \
+support/CCStatsOverlay.cpp \
+support/CCAssetLoadProfiler.cpp \
+support/CCGPUProfiler.cpp \
+support/CCObjectTracker.cpp \
 support/CCProfiling.cpp \
 support/TransformUtils.cpp \
 support/user_default/CCUserDefaultAndroid.cpp \
@@ -126,12 +157,15 @@ support/zip_support/ioapi.cpp \
 support/zip_support/unzip.cpp \
 support/component/CCComponent.cpp \
 support/component/CCComponentContainer.cpp \
+support/component/CCComponentSystem.cpp \
 text_input_node/CCIMEDispatcher.cpp \
 text_input_node/CCTextFieldTTF.cpp \
 textures/CCTexture2D.cpp \
 textures/CCTextureAtlas.cpp \
 textures/CCTextureCache.cpp \
+textures/CCDynamicAtlas.cpp \
 textures/CCTextureETC.cpp \
+textures/CCTextureKTX.cpp \
 textures/CCTexturePVR.cpp \
 textures/etc/etc1.cpp\
 tilemap_parallax_nodes/CCParallaxNode.cpp \
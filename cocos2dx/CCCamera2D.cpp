@@ -0,0 +1,148 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCCamera2D.h"
+#include "CCDirector.h"
+
+NS_CC_BEGIN
+
+Camera2D* Camera2D::create()
+{
+    Camera2D* camera = new Camera2D();
+    camera->autorelease();
+    return camera;
+}
+
+Camera2D::Camera2D()
+: _zoom(1.0f)
+, _rotation(0.0f)
+, _dirty(true)
+{
+    const Size& winSize = Director::getInstance()->getWinSize();
+    _position = Point(winSize.width / 2, winSize.height / 2);
+}
+
+Camera2D::~Camera2D()
+{
+}
+
+void Camera2D::setPosition(const Point& position)
+{
+    _position = position;
+    _dirty = true;
+}
+
+void Camera2D::setZoom(float zoom)
+{
+    CCASSERT(zoom > 0.0f, "zoom must be positive");
+    _zoom = zoom;
+    _dirty = true;
+}
+
+void Camera2D::setRotation(float rotation)
+{
+    _rotation = rotation;
+    _dirty = true;
+}
+
+bool Camera2D::isIdentity() const
+{
+    const Size& winSize = Director::getInstance()->getWinSize();
+    return _zoom == 1.0f && _rotation == 0.0f
+        && _position.x == winSize.width / 2 && _position.y == winSize.height / 2;
+}
+
+const kmMat4& Camera2D::getViewMatrix()
+{
+    if (_dirty)
+    {
+        // window center + zoom * rotation * (point - position)
+        // a clockwise camera shows the scene rotated counterclockwise
+        const Size& winSize = Director::getInstance()->getWinSize();
+        float radians = CC_DEGREES_TO_RADIANS(_rotation);
+        float a = _zoom * cosf(radians);
+        float b = _zoom * sinf(radians);
+
+        kmMat4Identity(&_viewMatrix);
+        _viewMatrix.mat[0] = a;
+        _viewMatrix.mat[1] = b;
+        _viewMatrix.mat[4] = -b;
+        _viewMatrix.mat[5] = a;
+        _viewMatrix.mat[12] = winSize.width / 2 - (a * _position.x - b * _position.y);
+        _viewMatrix.mat[13] = winSize.height / 2 - (b * _position.x + a * _position.y);
+
+        _dirty = false;
+    }
+    return _viewMatrix;
+}
+
+Point Camera2D::convertToScene(const Point& location) const
+{
+    const Size& winSize = Director::getInstance()->getWinSize();
+    float radians = CC_DEGREES_TO_RADIANS(_rotation);
+    float c = cosf(radians);
+    float s = sinf(radians);
+    float dx = location.x - winSize.width / 2;
+    float dy = location.y - winSize.height / 2;
+    return Point(_position.x + (c * dx + s * dy) / _zoom,
+                 _position.y + (c * dy - s * dx) / _zoom);
+}
+
+Point Camera2D::convertFromScene(const Point& point) const
+{
+    const Size& winSize = Director::getInstance()->getWinSize();
+    float radians = CC_DEGREES_TO_RADIANS(_rotation);
+    float a = _zoom * cosf(radians);
+    float b = _zoom * sinf(radians);
+    float dx = point.x - _position.x;
+    float dy = point.y - _position.y;
+    return Point(winSize.width / 2 + a * dx - b * dy,
+                 winSize.height / 2 + b * dx + a * dy);
+}
+
+Rect Camera2D::getVisibleRect() const
+{
+    Director* director = Director::getInstance();
+    Point origin = director->getVisibleOrigin();
+    Size size = director->getVisibleSize();
+    Point corners[4] = {
+        convertToScene(origin),
+        convertToScene(Point(origin.x + size.width, origin.y)),
+        convertToScene(Point(origin.x, origin.y + size.height)),
+        convertToScene(Point(origin.x + size.width, origin.y + size.height)),
+    };
+
+    float minX = corners[0].x, maxX = corners[0].x;
+    float minY = corners[0].y, maxY = corners[0].y;
+    for (int i = 1; i < 4; ++i)
+    {
+        minX = MIN(minX, corners[i].x);
+        maxX = MAX(maxX, corners[i].x);
+        minY = MIN(minY, corners[i].y);
+        maxY = MAX(maxY, corners[i].y);
+    }
+    return Rect(minX, minY, maxX - minX, maxY - minY);
+}
+
+NS_CC_END
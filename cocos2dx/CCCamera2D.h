@@ -0,0 +1,103 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCCAMERA2D_H__
+#define __CCCAMERA2D_H__
+
+#include "cocoa/CCObject.h"
+#include "cocoa/CCGeometry.h"
+#include "kazmath/mat4.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base_nodes
+ * @{
+ */
+
+/** @brief Camera2D pans, zooms and rotates a whole Scene.
+
+Its view matrix is applied once per scene by Scene::visit(), on top of the projection,
+so moving the camera doesn't change the transform of any node. The Sprite and
+SpriteBatchNode culling use the projection, so they are culled against the camera too.
+
+Node::convertToNodeSpace() and the touch locations ignore the camera: use
+convertToScene() to get the scene location of a touch.
+
+The per node Camera still works under a Camera2D.
+@since v3.0
+*/
+class CC_DLL Camera2D : public Object
+{
+public:
+    /** creates a camera that shows the scene as it is */
+    static Camera2D* create();
+
+    Camera2D();
+    virtual ~Camera2D();
+
+    /** sets the point of the scene shown at the center of the window. Default: the center of the window */
+    void setPosition(const Point& position);
+    inline const Point& getPosition() const { return _position; }
+
+    /** sets the zoom. Values greater than 1 magnify the scene. Default: 1 */
+    void setZoom(float zoom);
+    inline float getZoom() const { return _zoom; }
+
+    /** sets the rotation in degrees. Positive values rotate the camera clockwise, like Node. Default: 0 */
+    void setRotation(float rotation);
+    inline float getRotation() const { return _rotation; }
+
+    /** returns whether the camera shows the scene as it is, in which case it isn't applied */
+    bool isIdentity() const;
+
+    /** returns the matrix from the scene coordinates to the window coordinates */
+    const kmMat4& getViewMatrix();
+
+    /** converts a location in OpenGL coordinates, eg: Touch::getLocation(), to the scene coordinates */
+    Point convertToScene(const Point& location) const;
+    /** converts a point in the scene coordinates to OpenGL coordinates */
+    Point convertFromScene(const Point& point) const;
+
+    /** returns the bounding box, in the scene coordinates, of the area visible through the camera */
+    Rect getVisibleRect() const;
+
+protected:
+    Point _position;
+    float _zoom;
+    float _rotation;
+
+    bool _dirty;
+    kmMat4 _viewMatrix;
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(Camera2D);
+};
+
+// end of base_node group
+/// @}
+
+NS_CC_END
+
+#endif // __CCCAMERA2D_H__
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "cocoa/CCDictionary.h"
 #include "cocoa/CCInteger.h"
 #include "cocoa/CCBool.h"
+#include "cocoa/CCDouble.h"
 #include "cocos2d.h"
 #include "platform/CCFileUtils.h"
 
@@ -45,12 +46,20 @@ Configuration::Configuration(void)
 , _maxModelviewStackDepth(0)
 , _supportsPVRTC(false)
 , _supportsETC(false)
+, _supportsETC2(false)
+, _supportsASTC(false)
+, _supportsS3TC(false)
 , _supportsNPOT(false)
 , _supportsBGRA8888(false)
 , _supportsDiscardFramebuffer(false)
 , _supportsShareableVAO(false)
+, _supportsProgramBinary(false)
+, _supportsPixelBufferObject(false)
+, _supportsTimerQuery(false)
+, _supportsInstancing(false)
 , _maxSamplesAllowed(0)
 , _maxTextureUnits(0)
+, _maxAnisotropy(1)
 , _glExtensions(NULL)
 , _valueDict(NULL)
 {
@@ -121,6 +130,12 @@ void Configuration::gatherGPUInfo()
     glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &_maxTextureUnits);
 	_valueDict->setObject( Integer::create((int)_maxTextureUnits), "gl.max_texture_units");
 
+    if (checkForGLExtension("GL_EXT_texture_filter_anisotropic"))
+    {
+        glGetFloatv(0x84FF /* GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT */, &_maxAnisotropy);
+    }
+    _valueDict->setObject( Double::create(_maxAnisotropy), "gl.max_anisotropy");
+
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
     glGetIntegerv(GL_MAX_SAMPLES_APPLE, &_maxSamplesAllowed);
 	_valueDict->setObject( Integer::create((int)_maxSamplesAllowed), "gl.max_samples_allowed");
@@ -128,6 +143,18 @@ void Configuration::gatherGPUInfo()
     
     _supportsETC = checkForGLExtension("GL_OES_compressed_ETC1_RGB8_texture");
     _valueDict->setObject( Bool::create(_supportsETC), "gl.supports_ETC");
+
+    // ETC2/EAC formats are mandatory since OpenGL ES 3.0
+    const char* glVersion = (const char*)glGetString(GL_VERSION);
+    _supportsETC2 = (glVersion && strstr(glVersion, "OpenGL ES 3") != nullptr)
+        || checkForGLExtension("GL_ARB_ES3_compatibility");
+    _valueDict->setObject( Bool::create(_supportsETC2), "gl.supports_ETC2");
+
+    _supportsASTC = checkForGLExtension("GL_KHR_texture_compression_astc_ldr");
+    _valueDict->setObject( Bool::create(_supportsASTC), "gl.supports_ASTC");
+
+    _supportsS3TC = checkForGLExtension("GL_EXT_texture_compression_s3tc");
+    _valueDict->setObject( Bool::create(_supportsS3TC), "gl.supports_S3TC");
     
     _supportsPVRTC = checkForGLExtension("GL_IMG_texture_compression_pvrtc");
 	_valueDict->setObject( Bool::create(_supportsPVRTC), "gl.supports_PVRTC");
@@ -143,6 +170,35 @@ void Configuration::gatherGPUInfo()
 
     _supportsShareableVAO = checkForGLExtension("vertex_array_object");
 	_valueDict->setObject( Bool::create(_supportsShareableVAO), "gl.supports_vertex_array_object");
+
+    // some drivers expose the extension without any binary format
+    GLint binaryFormats = 0;
+    _supportsProgramBinary = checkForGLExtension("GL_OES_get_program_binary") || checkForGLExtension("GL_ARB_get_program_binary");
+    if (_supportsProgramBinary)
+    {
+        glGetIntegerv(0x87FE /* GL_NUM_PROGRAM_BINARY_FORMATS */, &binaryFormats);
+        _supportsProgramBinary = binaryFormats > 0;
+    }
+    _valueDict->setObject( Bool::create(_supportsProgramBinary), "gl.supports_program_binary");
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    _supportsPixelBufferObject = checkForGLExtension("GL_ARB_pixel_buffer_object") || checkForGLExtension("GL_EXT_pixel_buffer_object");
+#endif
+    _valueDict->setObject( Bool::create(_supportsPixelBufferObject), "gl.supports_pixel_buffer_object");
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    _supportsTimerQuery = checkForGLExtension("GL_ARB_timer_query");
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    _supportsTimerQuery = checkForGLExtension("GL_EXT_disjoint_timer_query");
+#endif
+    _valueDict->setObject( Bool::create(_supportsTimerQuery), "gl.supports_timer_query");
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    _supportsInstancing = checkForGLExtension("GL_ARB_instanced_arrays") && checkForGLExtension("GL_ARB_draw_instanced");
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    _supportsInstancing = checkForGLExtension("GL_EXT_instanced_arrays");
+#endif
+    _valueDict->setObject( Bool::create(_supportsInstancing), "gl.supports_instancing");
     
     CHECK_GL_ERROR_DEBUG();
 }
@@ -209,6 +265,11 @@ int Configuration::getMaxTextureUnits(void) const
 	return _maxTextureUnits;
 }
 
+float Configuration::getMaxAnisotropy(void) const
+{
+    return _maxAnisotropy;
+}
+
 bool Configuration::supportsNPOT(void) const
 {
 	return _supportsNPOT;
@@ -229,6 +290,21 @@ bool Configuration::supportsETC() const
 #endif
 }
 
+bool Configuration::supportsETC2(void) const
+{
+    return _supportsETC2;
+}
+
+bool Configuration::supportsASTC(void) const
+{
+    return _supportsASTC;
+}
+
+bool Configuration::supportsS3TC(void) const
+{
+    return _supportsS3TC;
+}
+
 bool Configuration::supportsBGRA8888(void) const
 {
 	return _supportsBGRA8888;
@@ -244,6 +320,26 @@ bool Configuration::supportsShareableVAO(void) const
 	return _supportsShareableVAO;
 }
 
+bool Configuration::supportsProgramBinary(void) const
+{
+    return _supportsProgramBinary;
+}
+
+bool Configuration::supportsPixelBufferObject(void) const
+{
+    return _supportsPixelBufferObject;
+}
+
+bool Configuration::supportsTimerQuery(void) const
+{
+    return _supportsTimerQuery;
+}
+
+bool Configuration::supportsInstancing(void) const
+{
+    return _supportsInstancing;
+}
+
 //
 // generic getters for properties
 //
@@ -74,6 +74,12 @@ public:
      */
 	int getMaxTextureUnits(void) const;
 
+    /** returns the maximum anisotropy of the texture filtering (GL_EXT_texture_filter_anisotropic),
+     1 when the anisotropic filtering isn't supported
+     @since v3.0
+     */
+    float getMaxAnisotropy(void) const;
+
     /** Whether or not the GPU supports NPOT (Non Power Of Two) textures.
      OpenGL ES 2.0 already supports NPOT (iOS).
      
@@ -86,6 +92,21 @@ public:
     
      /** Whether or not ETC Texture Compressed is supported */
     bool supportsETC(void) const;
+
+    /** Whether or not ETC2/EAC Texture Compressed is supported (always true on OpenGL ES 3.0)
+     @since v3.0
+     */
+    bool supportsETC2(void) const;
+
+    /** Whether or not ASTC (LDR profile) Texture Compressed is supported
+     @since v3.0
+     */
+    bool supportsASTC(void) const;
+
+    /** Whether or not S3TC (DXT1, DXT3 and DXT5) Texture Compressed is supported
+     @since v3.0
+     */
+    bool supportsS3TC(void) const;
     
     /** Whether or not BGRA8888 textures are supported.
      @since v0.99.2
@@ -102,6 +123,30 @@ public:
      */
 	bool supportsShareableVAO(void) const;
 
+    /** Whether or not the binaries of the linked programs can be saved and loaded again
+     (GL_OES_get_program_binary or GL_ARB_get_program_binary).
+     @since v3.0
+     */
+    bool supportsProgramBinary(void) const;
+
+    /** Whether or not pixels can be read into a buffer object without waiting for the GPU
+     (GL_ARB_pixel_buffer_object or GL_EXT_pixel_buffer_object, OpenGL only).
+     @since v3.0
+     */
+    bool supportsPixelBufferObject(void) const;
+
+    /** Whether or not the GPU time can be measured with timestamp queries
+     (GL_ARB_timer_query, or GL_EXT_disjoint_timer_query on Android).
+     @since v3.0
+     */
+    bool supportsTimerQuery(void) const;
+
+    /** Whether or not the quads can be drawn with instancing
+     (GL_ARB_instanced_arrays and GL_ARB_draw_instanced, or GL_EXT_instanced_arrays on Android).
+     @since v3.0
+     */
+    bool supportsInstancing(void) const;
+
     /** returns whether or not an OpenGL is supported */
     bool checkForGLExtension(const std::string &searchName) const;
 
@@ -144,12 +189,20 @@ protected:
     GLint           _maxModelviewStackDepth;
     bool            _supportsPVRTC;
     bool            _supportsETC;
+    bool            _supportsETC2;
+    bool            _supportsASTC;
+    bool            _supportsS3TC;
     bool            _supportsNPOT;
     bool            _supportsBGRA8888;
     bool            _supportsDiscardFramebuffer;
     bool            _supportsShareableVAO;
+    bool            _supportsProgramBinary;
+    bool            _supportsPixelBufferObject;
+    bool            _supportsTimerQuery;
+    bool            _supportsInstancing;
     GLint           _maxSamplesAllowed;
     GLint           _maxTextureUnits;
+    GLfloat         _maxAnisotropy;
     char *          _glExtensions;
 	
 	Dictionary	*_valueDict;
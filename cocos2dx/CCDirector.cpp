@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 // standard includes
 #include <string>
+#include <chrono>
 
 #include "ccFPSImages.h"
 #include "draw_nodes/CCDrawingPrimitives.h"
@@ -40,13 +41,26 @@ THE SOFTWARE.
 #include "ccMacros.h"
 #include "touch_dispatcher/CCTouchDispatcher.h"
 #include "support/CCNotificationCenter.h"
+#include "support/CCJobSystem.h"
+#include "support/CCSkeletonEvaluator.h"
+#include "support/CCNodeBuildQueue.h"
+#include "support/CCInputRecorder.h"
+#include "support/CCObjectPool.h"
+#include "support/CCStatsOverlay.h"
+#include "support/component/CCComponentSystem.h"
+#include "particle_nodes/CCParticleSystem.h"
+#include "particle_nodes/CCParticleSystemManager.h"
+#include "effects/CCGrid.h"
+#include "misc_nodes/CCRenderTexture.h"
 #include "layers_scenes_transitions_nodes/CCTransition.h"
 #include "textures/CCTextureCache.h"
 #include "sprite_nodes/CCSpriteFrameCache.h"
 #include "cocoa/CCAutoreleasePool.h"
+#include "cocoa/CCPoolAllocator.h"
 #include "platform/CCFileUtils.h"
 #include "CCApplication.h"
 #include "label_nodes/CCLabelBMFont.h"
+#include "label_nodes/CCFontAtlas.h"
 #include "label_nodes/CCLabelAtlas.h"
 #include "actions/CCActionManager.h"
 #include "CCConfiguration.h"
@@ -60,10 +74,16 @@ THE SOFTWARE.
 #include "kazmath/kazmath.h"
 #include "kazmath/GL/matrix.h"
 #include "support/CCProfiling.h"
+#include "support/CCFrameProfiler.h"
+#include "support/CCAssetLoadProfiler.h"
+#include "support/CCGPUProfiler.h"
 #include "platform/CCImage.h"
 #include "CCEGLView.h"
 #include "CCConfiguration.h"
 #include "keyboard_dispatcher/CCKeyboardDispatcher.h"
+#include "renderer/CCRenderer.h"
+#include "event_dispatcher/CCEventDispatcher.h"
+#include "script_support/CCScriptSupport.h"
 
 
 /**
@@ -78,13 +98,23 @@ THE SOFTWARE.
 using namespace std;
 
 unsigned int g_uNumberOfDraws = 0;
+unsigned int g_uNumberOfVertices = 0;
+unsigned int g_uNumberOfQuads = 0;
 
 NS_CC_BEGIN
+
+// seconds of a clock which isn't changed with the time of the system
+static double getMonotonicTime()
+{
+    return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 // XXX it should be a Director ivar. Move it there once support for multiple directors is added
 
 // singleton stuff
 static DisplayLinkDirector *s_SharedDirector = NULL;
 
+std::atomic<bool> Director::s_nextFrameDirty(true);
+
 #define kDefaultFPS        60  // 60 frames per second
 extern const char* cocos2dVersion(void);
 
@@ -111,6 +141,9 @@ bool Director::init(void)
     // scenes
     _runningScene = NULL;
     _nextScene = NULL;
+    _sceneHibernationEnabled = false;
+    _sceneHibernationKeepsPixels = false;
+    _wakingScene = NULL;
 
     _notificationNode = NULL;
 
@@ -126,9 +159,29 @@ bool Director::init(void)
     _FPSLabel = NULL;
     _SPFLabel = NULL;
     _drawsLabel = NULL;
+    _displayDetailedStats = false;
+    _statsOverlay = NULL;
     _totalFrames = _frames = 0;
+    _scriptGCBudget = 0.0f;
+    _scriptGCTime = 0.0f;
     _FPS = new char[10];
-    _lastUpdate = new struct timeval;
+    _lastUpdate = getMonotonicTime();
+
+    _fixedDeltaTime = 0.0f;
+
+    _renderOnDemand = false;
+    s_nextFrameDirty = true;
+
+    // frame pacing
+    _framePacing = false;
+    _maxDeltaTime = 0.25f;
+    _pacingDebt = 0.0;
+    _deltaTimeHistoryIndex = 0;
+    _deltaTimeHistoryCount = 0;
+    _fixedUpdateInterval = 0.0f;
+    _maxFixedUpdates = 5;
+    _fixedUpdateAccumulator = 0.0f;
+    _fixedUpdateInterpolation = 0.0f;
 
     // paused ?
     _paused = false;
@@ -160,6 +213,13 @@ bool Director::init(void)
     // Accelerometer
     _accelerometer = new Accelerometer();
 
+    // EventDispatcher
+    _eventDispatcher = new EventDispatcher();
+
+    // Renderer
+    _renderer = new Renderer();
+    _renderer->setParallelPreparationEnabled(Configuration::getInstance()->getBool("cocos2d.x.renderer.parallel_preparation", false));
+
     // create autorelease pool
     PoolManager::sharedPoolManager()->push();
 
@@ -173,6 +233,7 @@ Director::~Director(void)
     CC_SAFE_RELEASE(_FPSLabel);
     CC_SAFE_RELEASE(_SPFLabel);
     CC_SAFE_RELEASE(_drawsLabel);
+    CC_SAFE_RELEASE(_statsOverlay);
     
     CC_SAFE_RELEASE(_runningScene);
     CC_SAFE_RELEASE(_notificationNode);
@@ -182,14 +243,14 @@ Director::~Director(void)
     CC_SAFE_RELEASE(_touchDispatcher);
     CC_SAFE_RELEASE(_keyboardDispatcher);
     CC_SAFE_RELEASE(_keypadDispatcher);
+    CC_SAFE_RELEASE(_eventDispatcher);
     CC_SAFE_DELETE(_accelerometer);
+    CC_SAFE_RELEASE(_renderer);
 
     // pop the autorelease pool
     PoolManager::sharedPoolManager()->pop();
     PoolManager::purgePoolManager();
 
-    // delete _lastUpdate
-    CC_SAFE_DELETE(_lastUpdate);
     // delete fps string
     delete []_FPS;
 
@@ -206,6 +267,13 @@ void Director::setDefaultValues(void)
 
 	// Display FPS
 	_displayStats = conf->getBool("cocos2d.x.display_fps", false);
+	_displayDetailedStats = conf->getBool("cocos2d.x.display_detailed_stats", false);
+
+	// report of the assets loaded by the scenes
+	if (conf->getBool("cocos2d.x.profile_asset_loads", false))
+	{
+		AssetLoadProfiler::getInstance()->setEnabled(true);
+	}
 
 	// GL projection
 	const char *projection = conf->getCString("cocos2d.x.gl.projection", "3d");
@@ -253,10 +321,31 @@ void Director::drawScene(void)
     // calculate "global" dt
     calculateDeltaTime();
 
+    // the touch moves queued by the platform since the last frame
+    if (_openGLView)
+    {
+        _openGLView->dispatchPendingTouches();
+    }
+
     //tick before glClear: issue #533
     if (! _paused)
     {
-        _scheduler->update(_deltaTime);
+        CC_PROFILE_ZONE("Director - update");
+        update();
+    }
+
+    // nothing changed: the frame on screen is kept, and the GPU stays idle.
+    // The changes made while visiting are drawn next frame
+    bool frameDirty = s_nextFrameDirty.exchange(false, std::memory_order_relaxed);
+    if (_renderOnDemand && ! frameDirty && ! _nextScene)
+    {
+        endFrame();
+        return;
+    }
+
+    if (GPUProfiler::isEnabled())
+    {
+        GPUProfiler::getInstance()->beginFrame();
     }
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -270,16 +359,28 @@ void Director::drawScene(void)
 
     kmGLPushMatrix();
 
-    // draw the scene
-    if (_runningScene)
     {
-        _runningScene->visit();
+        CC_PROFILE_ZONE("Director - visit");
+
+        // draw the scene
+        if (_runningScene)
+        {
+            _runningScene->visit();
+        }
+
+        // draw the notifications node
+        if (_notificationNode)
+        {
+            _notificationNode->visit();
+        }
     }
 
-    // draw the notifications node
-    if (_notificationNode)
     {
-        _notificationNode->visit();
+        CC_PROFILE_ZONE("Director - render");
+        CC_PROFILE_GPU_ZONE("GPU - render");
+
+        // execute the commands recorded while visiting
+        _renderer->flush();
     }
     
     if (_displayStats)
@@ -289,6 +390,13 @@ void Director::drawScene(void)
 
     kmGLPopMatrix();
 
+    if (GPUProfiler::isEnabled())
+    {
+        GPUProfiler::getInstance()->endFrame();
+    }
+
+    _renderer->endFrame();
+
     _totalFrames++;
 
     // swap buffers
@@ -301,29 +409,50 @@ void Director::drawScene(void)
     {
         calculateMPF();
     }
+
+    endFrame();
 }
 
-void Director::calculateDeltaTime(void)
+void Director::endFrame()
 {
-    struct timeval now;
+    PoolAllocator::getInstance()->endFrame();
 
-    if (gettimeofday(&now, NULL) != 0)
+    if (_scriptGCBudget > 0)
     {
-        CCLOG("error in gettimeofday");
-        _deltaTime = 0;
-        return;
+        collectScriptGarbage();
+    }
+
+    if (FrameProfiler::isEnabled())
+    {
+        FrameProfiler::getInstance()->markFrame();
     }
+}
+
+void Director::calculateDeltaTime(void)
+{
+    double now = getMonotonicTime();
 
     // new delta time. Re-fixed issue #1277
     if (_nextDeltaTimeZero)
     {
         _deltaTime = 0;
         _nextDeltaTimeZero = false;
+        _pacingDebt = 0.0;
+        _deltaTimeHistoryCount = 0;
+    }
+    else if (_fixedDeltaTime > 0)
+    {
+        _deltaTime = _fixedDeltaTime;
     }
     else
     {
-        _deltaTime = (now.tv_sec - _lastUpdate->tv_sec) + (now.tv_usec - _lastUpdate->tv_usec) / 1000000.0f;
+        _deltaTime = (float)(now - _lastUpdate);
         _deltaTime = MAX(0, _deltaTime);
+
+        if (_framePacing)
+        {
+            _deltaTime = paceDeltaTime(_deltaTime);
+        }
     }
 
 #ifdef DEBUG
@@ -334,7 +463,93 @@ void Director::calculateDeltaTime(void)
     }
 #endif
 
-    *_lastUpdate = now;
+    // recorded, or replaced by the recorded one during a replay
+    if (InputRecorder::isActive())
+    {
+        _deltaTime = InputRecorder::getInstance()->onFrame(_deltaTime);
+    }
+
+    _lastUpdate = now;
+}
+
+float Director::paceDeltaTime(float deltaTime)
+{
+    // a hitch isn't caught up with
+    if (deltaTime > _maxDeltaTime)
+    {
+        deltaTime = _maxDeltaTime;
+        _pacingDebt = 0.0;
+    }
+
+    // the frames are presented at multiples of the refresh period, the measured time only adds jitter to it
+    float interval = (float)_animationInterval;
+    double time = deltaTime + _pacingDebt;
+    float frames = floorf((float)(time / interval) + 0.5f);
+    if (frames >= 1.0f && fabs(time - frames * interval) < interval * 0.2)
+    {
+        deltaTime = frames * interval;
+    }
+    else
+    {
+        deltaTime = (float)time;
+    }
+    _pacingDebt = time - deltaTime;
+
+    _deltaTimeHistory[_deltaTimeHistoryIndex] = deltaTime;
+    _deltaTimeHistoryIndex = (_deltaTimeHistoryIndex + 1) % CC_DIRECTOR_DELTA_TIME_HISTORY;
+    if (_deltaTimeHistoryCount < CC_DIRECTOR_DELTA_TIME_HISTORY)
+    {
+        ++_deltaTimeHistoryCount;
+    }
+
+    float sum = 0.0f;
+    for (unsigned int i = 0; i < _deltaTimeHistoryCount; ++i)
+    {
+        sum += _deltaTimeHistory[i];
+    }
+    float smoothed = sum / _deltaTimeHistoryCount;
+    // the averaging delays the time, it isn't lost
+    _pacingDebt += deltaTime - smoothed;
+
+    return smoothed;
+}
+
+void Director::update()
+{
+    if (_fixedUpdateInterval <= 0)
+    {
+        _scheduler->update(_deltaTime);
+        return;
+    }
+
+    _fixedUpdateAccumulator += _deltaTime;
+    unsigned int updates = 0;
+    while (_fixedUpdateAccumulator >= _fixedUpdateInterval && updates < _maxFixedUpdates)
+    {
+        _scheduler->update(_fixedUpdateInterval);
+        _fixedUpdateAccumulator -= _fixedUpdateInterval;
+        ++updates;
+    }
+    if (_fixedUpdateAccumulator >= _fixedUpdateInterval)
+    {
+        _fixedUpdateAccumulator = fmodf(_fixedUpdateAccumulator, _fixedUpdateInterval);
+    }
+    _fixedUpdateInterpolation = _fixedUpdateAccumulator / _fixedUpdateInterval;
+}
+
+void Director::setFramePacing(bool framePacing)
+{
+    _framePacing = framePacing;
+    _pacingDebt = 0.0;
+    _deltaTimeHistoryCount = 0;
+}
+
+void Director::setFixedUpdateInterval(float interval)
+{
+    CCASSERT(interval >= 0, "the interval can't be negative");
+    _fixedUpdateInterval = interval;
+    _fixedUpdateAccumulator = 0.0f;
+    _fixedUpdateInterpolation = 0.0f;
 }
 float Director::getDeltaTime() const
 {
@@ -351,6 +566,12 @@ void Director::setOpenGLView(EGLView *pobOpenGLView)
 		conf->gatherGPUInfo();
 		conf->dumpInfo();
 
+		// GPU time of the frames, needs the GL context
+		if (conf->getBool("cocos2d.x.profile_gpu", false))
+		{
+			GPUProfiler::getInstance()->setEnabled(true);
+		}
+
         // EAGLView is not a Object
         delete _openGLView; // [openGLView_ release]
         _openGLView = pobOpenGLView;
@@ -389,6 +610,12 @@ void Director::setProjection(Projection projection)
 {
     Size size = _winSizeInPoints;
 
+    // the view was resized, or the GL context was recreated
+    setNextFrameDirty();
+
+    // pending commands were recorded with the previous projection
+    _renderer->flush();
+
     setViewport();
 
     switch (projection)
@@ -446,11 +673,17 @@ void Director::setProjection(Projection projection)
 void Director::purgeCachedData(void)
 {
     LabelBMFont::purgeCachedData();
+    ParticleSystem::purgeCachedData();
+    GridBase::purgeCachedData();
+    RenderTexture::purgeCachedData();
+    ObjectPool::getInstance()->purgeAll();
     if (s_SharedDirector->getOpenGLView())
     {
         SpriteFrameCache::getInstance()->removeUnusedSpriteFrames();
         TextureCache::getInstance()->removeUnusedTextures();
+        FontAtlasCache::removeUnusedFontAtlases();
     }
+    Texture2D::purgeConversionBuffer();
     FileUtils::getInstance()->purgeCachedEntries();
 }
 
@@ -478,13 +711,13 @@ void Director::setDepthTest(bool bOn)
     if (bOn)
     {
         glClearDepth(1.0f);
-        glEnable(GL_DEPTH_TEST);
+        GL::enable(GL_DEPTH_TEST);
         glDepthFunc(GL_LEQUAL);
 //        glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
     }
     else
     {
-        glDisable(GL_DEPTH_TEST);
+        GL::disable(GL_DEPTH_TEST);
     }
     CHECK_GL_ERROR_DEBUG();
 }
@@ -590,6 +823,7 @@ void Director::replaceScene(Scene *pScene)
     _sendCleanupToScene = true;
     _scenesStack->replaceObjectAtIndex(index - 1, pScene);
 
+    _wakingScene = NULL;
     _nextScene = pScene;
 }
 
@@ -600,6 +834,7 @@ void Director::pushScene(Scene *pScene)
     _sendCleanupToScene = false;
 
     _scenesStack->addObject(pScene);
+    _wakingScene = NULL;
     _nextScene = pScene;
 }
 
@@ -617,7 +852,7 @@ void Director::popScene(void)
     else
     {
         _sendCleanupToScene = true;
-        _nextScene = (Scene*)_scenesStack->objectAtIndex(c - 1);
+        revealScene((Scene*)_scenesStack->objectAtIndex(c - 1));
     }
 }
 
@@ -658,10 +893,42 @@ void Director::popToSceneStackLevel(int level)
 		c--;
 	}
 
-	_nextScene = (Scene*)_scenesStack->lastObject();
+	revealScene((Scene*)_scenesStack->lastObject());
 	_sendCleanupToScene = false;
 }
 
+void Director::revealScene(Scene* scene)
+{
+    _wakingScene = NULL;
+    if (! scene->isHibernated())
+    {
+        _nextScene = scene;
+        return;
+    }
+
+    // the running scene is drawn until the revealed one has its textures back, unless another scene is set meanwhile
+    _wakingScene = scene;
+    scene->wake([this, scene]() {
+        if (_wakingScene == scene)
+        {
+            _wakingScene = NULL;
+            _nextScene = scene;
+        }
+    });
+}
+
+void Director::setSceneHibernationEnabled(bool enabled, bool keepPixels/* = false*/)
+{
+    _sceneHibernationEnabled = enabled;
+    _sceneHibernationKeepsPixels = keepPixels;
+}
+
+void Director::setRenderOnDemand(bool renderOnDemand)
+{
+    _renderOnDemand = renderOnDemand;
+    setNextFrameDirty();
+}
+
 void Director::end()
 {
     _purgeDirecotorInNextLoop = true;
@@ -686,6 +953,7 @@ void Director::purgeDirector()
     
     _runningScene = NULL;
     _nextScene = NULL;
+    _wakingScene = NULL;
 
     // remove all objects, but don't release it.
     // runWithScene might be executed after 'end'.
@@ -696,9 +964,14 @@ void Director::purgeDirector()
     CC_SAFE_RELEASE_NULL(_FPSLabel);
     CC_SAFE_RELEASE_NULL(_SPFLabel);
     CC_SAFE_RELEASE_NULL(_drawsLabel);
+    CC_SAFE_RELEASE_NULL(_statsOverlay);
 
     // purge bitmap cache
     LabelBMFont::purgeCachedData();
+    FontAtlasCache::purgeCachedData();
+    ParticleSystem::purgeCachedData();
+    GridBase::purgeCachedData();
+    RenderTexture::purgeCachedData();
 
     // purge all managed caches
     DrawPrimitives::free();
@@ -712,6 +985,16 @@ void Director::purgeDirector()
     // cocos2d-x specific data structures
     UserDefault::destroyInstance();
     NotificationCenter::destroyInstance();
+    ParticleSystemManager::destroyInstance();
+    SkeletonEvaluator::destroyInstance();
+    NodeBuildQueue::destroyInstance();
+    InputRecorder::destroyInstance();
+    ObjectPool::destroyInstance();
+    FrameProfiler::destroyInstance();
+    AssetLoadProfiler::destroyInstance();
+    GPUProfiler::destroyInstance();
+    ComponentSystem::destroyInstance();
+    JobSystem::destroyInstance();
 
     GL::invalidateStateCache();
     
@@ -760,6 +1043,27 @@ void Director::setNextScene(void)
         _runningScene->onEnter();
         _runningScene->onEnterTransitionDidFinish();
     }
+
+    // the transitions draw the scene they leave, the suspended scenes are hibernated once they are over
+    if (_sceneHibernationEnabled && ! newIsTransition)
+    {
+        Object* object = NULL;
+        CCARRAY_FOREACH(_scenesStack, object)
+        {
+            Scene* scene = static_cast<Scene*>(object);
+            if (scene != _runningScene && scene != _wakingScene)
+            {
+                scene->hibernate(_sceneHibernationKeepsPixels);
+            }
+        }
+    }
+
+    // the assets loaded since the previous scene, the textures loaded asynchronously are in the next report
+    if (! newIsTransition && AssetLoadProfiler::isEnabled() && AssetLoadProfiler::getInstance()->hasAssets())
+    {
+        AssetLoadProfiler::getInstance()->displayReport();
+        AssetLoadProfiler::getInstance()->reset();
+    }
 }
 
 void Director::pause(void)
@@ -785,10 +1089,7 @@ void Director::resume(void)
 
     setAnimationInterval(_oldAnimationInterval);
 
-    if (gettimeofday(_lastUpdate, NULL) != 0)
-    {
-        CCLOG("cocos2d: Director: Error in gettimeofday");
-    }
+    _lastUpdate = getMonotonicTime();
 
     _paused = false;
     _deltaTime = 0;
@@ -803,6 +1104,16 @@ void Director::showStats(void)
     
     if (_displayStats)
     {
+        if (_displayDetailedStats)
+        {
+            if (!_statsOverlay)
+            {
+                createStatsOverlay();
+            }
+            // before the stats are drawn, which are counted too
+            _statsOverlay->addFrame(_deltaTime);
+        }
+
         if (_FPSLabel && _SPFLabel && _drawsLabel)
         {
             if (_accumDt > CC_DIRECTOR_STATS_INTERVAL)
@@ -825,17 +1136,74 @@ void Director::showStats(void)
             _FPSLabel->visit();
             _SPFLabel->visit();
         }
+
+        if (_statsOverlay && _displayDetailedStats)
+        {
+            _statsOverlay->visit();
+            // the overlay is drawn by the renderer, which was flushed before the stats
+            _renderer->flush();
+        }
     }    
     
     g_uNumberOfDraws = 0;
+    g_uNumberOfVertices = 0;
+    g_uNumberOfQuads = 0;
+}
+
+void Director::setDisplayDetailedStats(bool displayDetailedStats)
+{
+    _displayDetailedStats = displayDetailedStats;
+    if (!displayDetailedStats)
+    {
+        // the frame times are recorded again from the next time it is displayed
+        CC_SAFE_RELEASE_NULL(_statsOverlay);
+    }
+}
+
+void Director::createStatsOverlay()
+{
+    // scaled and placed above the FPS labels, see createStatsLabel()
+    float factor = EGLView::getInstance()->getDesignResolutionSize().height / 320.0f;
+
+    _statsOverlay = StatsOverlay::create();
+    _statsOverlay->retain();
+    _statsOverlay->setScale(factor);
+    _statsOverlay->setPosition(Point(0, 51*factor) + CC_DIRECTOR_STATS_POSITION);
 }
 
 void Director::calculateMPF()
 {
-    struct timeval now;
-    gettimeofday(&now, NULL);
-    
-    _secondsPerFrame = (now.tv_sec - _lastUpdate->tv_sec) + (now.tv_usec - _lastUpdate->tv_usec) / 1000000.0f;
+    _secondsPerFrame = (float)(getMonotonicTime() - _lastUpdate);
+}
+
+void Director::setScriptGCBudget(float budget)
+{
+    ScriptEngineProtocol* engine = ScriptEngineManager::getInstance()->getScriptEngine();
+    if (engine && _scriptGCBudget > 0 && budget <= 0)
+    {
+        engine->resumeAutomaticGarbageCollection();
+    }
+    _scriptGCBudget = budget;
+    _scriptGCTime = 0.0f;
+}
+
+void Director::collectScriptGarbage()
+{
+    ScriptEngineProtocol* engine = ScriptEngineManager::getInstance()->getScriptEngine();
+    if (engine == NULL)
+    {
+        return;
+    }
+
+    CC_PROFILE_ZONE("Director - script GC");
+
+    double start = getMonotonicTime();
+
+    // the time left before the next frame is idle
+    float elapsed = (float)(start - _lastUpdate);
+    engine->collectGarbage(MAX(_scriptGCBudget, (float)_animationInterval - elapsed));
+
+    _scriptGCTime = (float)(getMonotonicTime() - start);
 }
 
 // returns the FPS image data pointer and len
@@ -911,6 +1279,9 @@ void Director::createStatsLabel()
     _drawsLabel->setPosition(Point(0, 34*factor) + CC_DIRECTOR_STATS_POSITION);
     _SPFLabel->setPosition(Point(0, 17*factor) + CC_DIRECTOR_STATS_POSITION);
     _FPSLabel->setPosition(CC_DIRECTOR_STATS_POSITION);
+
+    // created again with the new scale when it is displayed
+    CC_SAFE_RELEASE_NULL(_statsOverlay);
 }
 
 float Director::getContentScaleFactor(void) const
@@ -1041,10 +1412,10 @@ Accelerometer* Director::getAccelerometer() const
 // so we now only support DisplayLinkDirector
 void DisplayLinkDirector::startAnimation(void)
 {
-    if (gettimeofday(_lastUpdate, NULL) != 0)
-    {
-        CCLOG("cocos2d: DisplayLinkDirector: Error on gettimeofday");
-    }
+    _lastUpdate = getMonotonicTime();
+
+    // the surface may have been lost while the animation was stopped
+    setNextFrameDirty();
 
     _invalid = false;
 #ifndef EMSCRIPTEN
@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "kazmath/mat4.h"
 #include "label_nodes/CCLabelAtlas.h"
 #include "ccTypeInfo.h"
+#include <atomic>
 
 
 NS_CC_BEGIN
@@ -48,6 +49,7 @@ NS_CC_BEGIN
 
 /* Forward declarations. */
 class LabelAtlas;
+class StatsOverlay;
 class Scene;
 class EGLView;
 class DirectorDelegate;
@@ -58,6 +60,8 @@ class TouchDispatcher;
 class KeyboardDispatcher;
 class KeypadDispatcher;
 class Accelerometer;
+class Renderer;
+class EventDispatcher;
 
 /**
 @brief Class that creates and handle the main Window and manages how
@@ -128,10 +132,28 @@ public:
     inline bool isDisplayStats(void) { return _displayStats; }
     /** Display the FPS on the bottom-left corner */
     inline void setDisplayStats(bool displayStats) { _displayStats = displayStats; }
+
+    /** Whether or not to display the detailed stats above the FPS: draw calls, quads, vertices, GL state changes,
+     texture memory, autoreleased objects, scheduler and action counts, and a graph of the frame times.
+     They are displayed with the stats, see setDisplayStats().
+     @since v3.0
+     */
+    inline bool isDisplayDetailedStats(void) const { return _displayDetailedStats; }
+    void setDisplayDetailedStats(bool displayDetailedStats);
     
     /** seconds per frame */
     inline float getSecondsPerFrame() { return _secondsPerFrame; }
 
+    /** Seconds the script engine may spend collecting garbage at the end of each frame, on top of the
+     idle time left before the next frame. When it is set, the engine collects in these steps instead
+     of in the middle of the frames. 0, the default, leaves the collections to the engine.
+     */
+    void setScriptGCBudget(float budget);
+    inline float getScriptGCBudget() const { return _scriptGCBudget; }
+
+    /** seconds spent collecting the garbage of the script engine at the end of the last frame */
+    inline float getScriptGCTime() const { return _scriptGCTime; }
+
     /** Get the EGLView, where everything is rendered */
     inline EGLView* getOpenGLView(void) { return _openGLView; }
     void setOpenGLView(EGLView *pobOpenGLView);
@@ -139,6 +161,52 @@ public:
     inline bool isNextDeltaTimeZero(void) { return _nextDeltaTimeZero; }
     void setNextDeltaTimeZero(bool nextDeltaTimeZero);
 
+    /** Delta time given to every frame instead of the time measured, 0 (the default) to measure it.
+     With it, the frames are updated the same way whatever the time they take, to benchmark or replay them.
+     @since v3.0
+     */
+    inline void setFixedDeltaTime(float deltaTime) { _fixedDeltaTime = deltaTime; }
+    inline float getFixedDeltaTime() const { return _fixedDeltaTime; }
+
+    /** Whether the delta time given to the scheduler is paced, false by default.
+     When it is set, the time measured between two frames is snapped to a multiple of the animation interval when
+     it is close to one, which absorbs the jitter of the timers and of the vsync, averaged over the last
+     CC_DIRECTOR_DELTA_TIME_HISTORY frames, and limited to getMaxDeltaTime(). The time snapped away is given back
+     in the next frames, so that the game time doesn't drift from the real time.
+     @since v3.0
+     */
+    void setFramePacing(bool framePacing);
+    inline bool isFramePacing() const { return _framePacing; }
+
+    /** Longest delta time given to the scheduler when the frames are paced, 0.25 s by default.
+     The time of a longer frame, after a hitch or a pause of the application, is dropped.
+     @since v3.0
+     */
+    inline void setMaxDeltaTime(float maxDeltaTime) { _maxDeltaTime = maxDeltaTime; }
+    inline float getMaxDeltaTime() const { return _maxDeltaTime; }
+
+    /** Updates the scheduler with a fixed time step, 0 by default to update it once per frame with the delta time.
+     The scheduler is updated as many times as steps fit in the time elapsed, at most getMaxFixedUpdates() times
+     per frame, and possibly not at all in a frame. The time left, less than a step, is kept for the next frame:
+     getFixedUpdateInterpolation() gives it as a fraction of a step, to interpolate what is drawn between the
+     last two updates.
+     @since v3.0
+     */
+    void setFixedUpdateInterval(float interval);
+    inline float getFixedUpdateInterval() const { return _fixedUpdateInterval; }
+
+    /** Maximum number of fixed updates per frame, 5 by default. The time over it is dropped, so that a slow frame
+     doesn't make the next ones slower.
+     @since v3.0
+     */
+    inline void setMaxFixedUpdates(unsigned int updates) { _maxFixedUpdates = updates; }
+    inline unsigned int getMaxFixedUpdates() const { return _maxFixedUpdates; }
+
+    /** Time elapsed since the last fixed update, as a fraction of the fixed update interval, between 0 and 1
+     @since v3.0
+     */
+    inline float getFixedUpdateInterpolation() const { return _fixedUpdateInterpolation; }
+
     /** Whether or not the Director is paused */
     inline bool isPaused(void) { return _paused; }
 
@@ -253,6 +321,34 @@ public:
      */
     void replaceScene(Scene *scene);
 
+    /** Whether the scenes suspended on the stack are hibernated, see Scene::hibernate(), once the scene pushed over
+     * them runs and its transition is over. popScene() and popToSceneStackLevel() wake up the scene they reveal, and
+     * keep drawing the running scene until its textures are back. Disabled by default.
+     * @param keepPixels whether the label and render textures of the hibernated scenes are read back into memory
+     * @since v3.0
+     */
+    void setSceneHibernationEnabled(bool enabled, bool keepPixels = false);
+    inline bool isSceneHibernationEnabled() const { return _sceneHibernationEnabled; }
+
+    /** Whether the frames are only drawn when something changed, disabled by default.
+     * In this mode, the scheduler is still updated every frame, but the scene is only visited, drawn and swapped
+     * when the frame was marked dirty, see setNextFrameDirty(). The GPU stays idle on the screens that don't
+     * change, like menus and turn-based boards.
+     * @since v3.0
+     */
+    void setRenderOnDemand(bool renderOnDemand);
+    inline bool isRenderOnDemand() const { return _renderOnDemand; }
+
+    /** Marks the next frame dirty, so that it is drawn in the render-on-demand mode.
+     * The frame is marked by the changes that invalidate the render caches of the nodes, see
+     * Node::setRenderCacheEnabled(), by the running actions, by the updates of the nodes and of the
+     * components, by the timers, by the input and by the scene changes. It must be called when something is drawn
+     * differently in a way that isn't detected, like a custom draw(), a DrawNode or a TextureAtlas that changed.
+     * It can be called from any thread.
+     * @since v3.0
+     */
+    static inline void setNextFrameDirty() { s_nextFrameDirty.store(true, std::memory_order_relaxed); }
+
     /** Ends the execution, releases the running scene.
      It doesn't remove the OpenGL view from its parent. You have to do it manually.
      */
@@ -381,18 +477,39 @@ public:
      */
     void setAccelerometer(Accelerometer* acc);
 
+    /** Gets the EventDispatcher associated with this director
+     @since v3.0
+     */
+    EventDispatcher* getEventDispatcher() const { return _eventDispatcher; }
+
     /* Gets delta time since last tick to main loop */
 	float getDeltaTime() const;
 
+    /** Gets the Renderer that executes the render commands recorded while the scene is visited
+     @since v3.0
+     */
+    Renderer* getRenderer() const { return _renderer; }
+
 protected:
     void purgeDirector();
     bool _purgeDirecotorInNextLoop; // this flag will be set to true in end()
     
     void setNextScene(void);
+
+    /** makes the scene the next scene, once it is woken up when it is hibernated */
+    void revealScene(Scene* scene);
     
     void showStats();
+    /** the end of the frame, drawn or not: the frame allocator, the script garbage and the frame profiler */
+    void endFrame();
+    /** updates the scheduler with the delta time, or with the fixed updates */
+    void update();
+    /** snaps and smoothes the measured delta time, see setFramePacing() */
+    float paceDeltaTime(float deltaTime);
     void createStatsLabel();
+    void createStatsOverlay();
     void calculateMPF();
+    void collectScriptGarbage();
     void getFPSImageData(unsigned char** datapointer, unsigned int* length);
     
     /** calculates delta time since last time it was called */    
@@ -429,6 +546,16 @@ protected:
      @since v2.0
      */
     Accelerometer* _accelerometer;
+
+    /** EventDispatcher associated with this director
+     @since v3.0
+     */
+    EventDispatcher* _eventDispatcher;
+
+    /** Renderer associated with this director
+     @since v3.0
+     */
+    Renderer* _renderer;
     
     /* delta time since last tick to main loop */
 	float _deltaTime;
@@ -449,6 +576,9 @@ protected:
     LabelAtlas *_FPSLabel;
     LabelAtlas *_SPFLabel;
     LabelAtlas *_drawsLabel;
+
+    bool _displayDetailedStats;
+    StatsOverlay *_statsOverlay;
     
     /** Whether or not the Director is paused */
     bool _paused;
@@ -457,6 +587,9 @@ protected:
     unsigned int _totalFrames;
     unsigned int _frames;
     float _secondsPerFrame;
+
+    float _scriptGCBudget;
+    float _scriptGCTime;
      
     /* The running scene */
     Scene *_runningScene;
@@ -470,9 +603,36 @@ protected:
 
     /* scheduled scenes */
     Array* _scenesStack;
-    
-    /* last time the main loop was updated */
-    struct timeval *_lastUpdate;
+
+    bool _sceneHibernationEnabled;
+    bool _sceneHibernationKeepsPixels;
+    /* the scene revealed by a pop, which becomes the next scene once woken up. Weak reference */
+    Scene* _wakingScene;
+
+    /* render-on-demand mode, see setRenderOnDemand() */
+    bool _renderOnDemand;
+    static std::atomic<bool> s_nextFrameDirty;
+    
+    /* last time the main loop was updated, in seconds of the monotonic clock */
+    double _lastUpdate;
+
+    /* delta time of all the frames when it isn't 0, see setFixedDeltaTime() */
+    float _fixedDeltaTime;
+
+    /* frame pacing, see setFramePacing() */
+    bool _framePacing;
+    float _maxDeltaTime;
+    /* time measured but not given to the scheduler yet, negative when more was given */
+    double _pacingDebt;
+    float _deltaTimeHistory[CC_DIRECTOR_DELTA_TIME_HISTORY];
+    unsigned int _deltaTimeHistoryIndex;
+    unsigned int _deltaTimeHistoryCount;
+
+    /* fixed updates, see setFixedUpdateInterval() */
+    float _fixedUpdateInterval;
+    unsigned int _maxFixedUpdates;
+    float _fixedUpdateAccumulator;
+    float _fixedUpdateInterpolation;
 
     /* whether or not the next delta time will be zero */
     bool _nextDeltaTimeZero;
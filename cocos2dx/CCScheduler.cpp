@@ -27,47 +27,19 @@ THE SOFTWARE.
 #include "CCScheduler.h"
 #include "ccMacros.h"
 #include "CCDirector.h"
-#include "support/data_support/utlist.h"
-#include "support/data_support/ccCArray.h"
+#include "base_nodes/CCNode.h"
 #include "cocoa/CCArray.h"
+#include "cocoa/CCSet.h"
 #include "script_support/CCScriptSupport.h"
+#include "support/CCJobSystem.h"
+#include "support/CCFrameProfiler.h"
+
+#include <algorithm>
 
 using namespace std;
 
 NS_CC_BEGIN
 
-// data structures
-
-// A list double-linked list used for "updates with priority"
-typedef struct _listEntry
-{
-    struct _listEntry   *prev, *next;
-    Object            *target;        // not retained (retained by hashUpdateEntry)
-    int                 priority;
-    bool                paused;
-    bool                markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
-} tListEntry;
-
-typedef struct _hashUpdateEntry
-{
-    tListEntry          **list;        // Which list does it belong to ?
-    tListEntry          *entry;        // entry in the list
-    Object            *target;        // hash key (retained)
-    UT_hash_handle      hh;
-} tHashUpdateEntry;
-
-// Hash Element used for "selectors with interval"
-typedef struct _hashSelectorEntry
-{
-    ccArray             *timers;
-    Object            *target;    // hash key (retained)
-    unsigned int        timerIndex;
-    Timer             *currentTimer;
-    bool                currentTimerSalvaged;
-    bool                paused;
-    UT_hash_handle      hh;
-} tHashTimerEntry;
-
 // implementation Timer
 
 Timer::Timer()
@@ -81,6 +53,10 @@ Timer::Timer()
 , _interval(0.0f)
 , _selector(NULL)
 , _scriptHandler(0)
+, _deferred(false)
+, _heapIndex(-1)
+, _dueTime(0.0)
+, _lastUpdateTime(0.0)
 {
 }
 
@@ -246,14 +222,25 @@ const int Scheduler::PRIORITY_SYSTEM = INT_MIN;
 // Minimum priority level for user scheduling.
 const int Scheduler::PRIORITY_NON_SYSTEM_MIN = PRIORITY_SYSTEM + 1;
 
+// number of entries unscheduled outside of update() that are kept in the arrays before they are compacted
+#define SCHEDULER_MAX_TOMBSTONES 64
+
+// Timer::_heapIndex of the timers that are not in the queue
+#define TIMER_NOT_QUEUED    -1
+// Timer::_heapIndex of the timers taken out of the queue to be updated by the current tick
+#define TIMER_DUE           -2
+
+static inline bool isTimerDeferrable(float interval)
+{
+    return interval >= CC_SCHEDULER_TIMER_HEAP_MIN_INTERVAL;
+}
+
 Scheduler::Scheduler(void)
 : _timeScale(1.0f)
-, _updatesNegList(NULL)
-, _updates0List(NULL)
-, _updatesPosList(NULL)
-, _hashForUpdates(NULL)
-, _hashForTimers(NULL)
-, _currentTarget(NULL)
+, _updateTombstones(0)
+, _timerTombstones(0)
+, _currentTarget(-1)
+, _timerClock(0.0)
 , _currentTargetSalvaged(false)
 , _updateHashLocked(false)
 , _scriptHandlerEntries(NULL)
@@ -267,20 +254,199 @@ Scheduler::~Scheduler(void)
     CC_SAFE_RELEASE(_scriptHandlerEntries);
 }
 
-void Scheduler::removeHashElement(_hashSelectorEntry *element)
+void Scheduler::removeTimerTarget(unsigned int index)
 {
+    TimerTarget& element = _timerTargets[index];
+    Object *target = element.target;
 
-	cocos2d::Object *target = element->target;
+    for (auto timer : element.timers)
+    {
+        dequeueTimer(timer);
+        timer->release();
+    }
+    element.timers.clear();
+    element.frameTimers = 0;
 
-    ccArrayFree(element->timers);
-    HASH_DEL(_hashForTimers, element);
-    free(element);
+    // the slot is reused by compactTimerTargets()
+    element.target = NULL;
+    _timerTargetIndices.erase(target);
+    ++_timerTombstones;
 
-    // make sure the target is released after we have removed the hash element
+    // make sure the target is released after we have removed the element
     // otherwise we access invalid memory when the release call deletes the target
     // and the target calls removeAllSelectors() during its destructor
     target->release();
+}
+
+void Scheduler::compactTimerTargets()
+{
+    CCASSERT(_currentTarget < 0, "The timer targets can't be compacted while they are being updated");
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < _timerTargets.size(); ++i)
+    {
+        if (_timerTargets[i].target == NULL)
+        {
+            continue;
+        }
+
+        if (i != count)
+        {
+            _timerTargets[count] = std::move(_timerTargets[i]);
+            _timerTargetIndices[_timerTargets[count].target] = count;
+        }
+        ++count;
+    }
+
+    _timerTargets.erase(_timerTargets.begin() + count, _timerTargets.end());
+    _timerTombstones = 0;
+}
+
+void Scheduler::siftTimerUp(unsigned int index)
+{
+    Timer *timer = _timerHeap[index];
+    while (index > 0)
+    {
+        unsigned int parent = (index - 1) / 2;
+        if (_timerHeap[parent]->_dueTime <= timer->_dueTime)
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[parent];
+        _timerHeap[index]->_heapIndex = index;
+        index = parent;
+    }
+    _timerHeap[index] = timer;
+    timer->_heapIndex = index;
+}
+
+void Scheduler::siftTimerDown(unsigned int index)
+{
+    Timer *timer = _timerHeap[index];
+    unsigned int count = _timerHeap.size();
+    while (true)
+    {
+        unsigned int child = index * 2 + 1;
+        if (child >= count)
+        {
+            break;
+        }
+        if (child + 1 < count && _timerHeap[child + 1]->_dueTime < _timerHeap[child]->_dueTime)
+        {
+            ++child;
+        }
+        if (timer->_dueTime <= _timerHeap[child]->_dueTime)
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[child];
+        _timerHeap[index]->_heapIndex = index;
+        index = child;
+    }
+    _timerHeap[index] = timer;
+    timer->_heapIndex = index;
+}
+
+void Scheduler::removeFromTimerHeap(unsigned int index)
+{
+    Timer *timer = _timerHeap[index];
+    Timer *last = _timerHeap.back();
+    _timerHeap.pop_back();
+    timer->_heapIndex = TIMER_NOT_QUEUED;
+
+    if (last != timer)
+    {
+        _timerHeap[index] = last;
+        last->_heapIndex = index;
+        if (index > 0 && last->_dueTime < _timerHeap[(index - 1) / 2]->_dueTime)
+        {
+            siftTimerUp(index);
+        }
+        else
+        {
+            siftTimerDown(index);
+        }
+    }
+}
+
+void Scheduler::queueTimer(Timer *timer)
+{
+    CCASSERT(timer->_deferred && timer->_heapIndex == TIMER_NOT_QUEUED, "The timer is already queued");
+
+    // due when Timer::update() would do something: its first update, the end of its delay or of its interval
+    timer->_lastUpdateTime = _timerClock;
+    if (timer->_elapsed == -1)
+    {
+        timer->_dueTime = _timerClock;
+    }
+    else
+    {
+        float remaining = (timer->_useDelay ? timer->_delay : timer->_interval) - timer->_elapsed;
+        timer->_dueTime = _timerClock + std::max(remaining, 0.0f);
+    }
+
+    _timerHeap.push_back(timer);
+    siftTimerUp(_timerHeap.size() - 1);
+}
+
+void Scheduler::dequeueTimer(Timer *timer)
+{
+    if (timer->_heapIndex >= 0)
+    {
+        removeFromTimerHeap(timer->_heapIndex);
+    }
+    else if (timer->_heapIndex == TIMER_DUE)
+    {
+        timer->_heapIndex = TIMER_NOT_QUEUED;
+    }
+    else
+    {
+        return;
+    }
+
+    // keeps the time accumulated while the timer was queued
+    if (timer->_elapsed != -1)
+    {
+        timer->_elapsed += (float)(_timerClock - timer->_lastUpdateTime);
+    }
+    timer->_lastUpdateTime = _timerClock;
+}
+
+void Scheduler::updateDeferredTimers()
+{
+    // The due timers are taken out of the queue first: the callbacks may queue or dequeue timers.
+    // They are retained as they may be unscheduled by the callback of another one
+    while (! _timerHeap.empty() && _timerHeap[0]->_dueTime <= _timerClock)
+    {
+        Timer *timer = _timerHeap[0];
+        removeFromTimerHeap(0);
+        timer->_heapIndex = TIMER_DUE;
+        timer->retain();
+        _dueTimers.push_back(timer);
+    }
+
+    for (unsigned int i = 0; i < _dueTimers.size(); ++i)
+    {
+        Timer *timer = _dueTimers[i];
+
+        // still due, it wasn't unscheduled nor paused by another callback
+        if (timer->_heapIndex == TIMER_DUE)
+        {
+            float dt = (float)(_timerClock - timer->_lastUpdateTime);
+            timer->_lastUpdateTime = _timerClock;
+            timer->update(dt);
+            Director::setNextFrameDirty();
+
+            if (timer->_heapIndex == TIMER_DUE)
+            {
+                timer->_heapIndex = TIMER_NOT_QUEUED;
+                queueTimer(timer);
+            }
+        }
 
+        timer->release();
+    }
+    _dueTimers.clear();
 }
 
 void Scheduler::scheduleSelector(SEL_SCHEDULE selector, Object *target, float interval, bool paused)
@@ -293,51 +459,79 @@ void Scheduler::scheduleSelector(SEL_SCHEDULE selector, Object *target, float in
     CCASSERT(selector, "Argument selector must be non-NULL");
     CCASSERT(target, "Argument target must be non-NULL");
 
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_INT(_hashForTimers, &target, element);
+    TimerTarget *element = NULL;
+    auto iter = _timerTargetIndices.find(target);
 
-    if (! element)
+    if (iter == _timerTargetIndices.end())
     {
-        element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
-        element->target = target;
-        if (target)
+        if (_currentTarget < 0 && _timerTombstones > SCHEDULER_MAX_TOMBSTONES)
         {
-            target->retain();
+            compactTimerTargets();
         }
-        HASH_ADD_INT(_hashForTimers, target, element);
 
+        TimerTarget newElement;
+        newElement.target = target;
+        newElement.timerIndex = 0;
+        newElement.currentTimer = NULL;
+        newElement.currentTimerSalvaged = false;
         // Is this the 1st element ? Then set the pause level to all the selectors of this target
-        element->paused = paused;
+        newElement.paused = paused;
+        newElement.frameTimers = 0;
+        target->retain();
+
+        _timerTargetIndices[target] = _timerTargets.size();
+        _timerTargets.push_back(std::move(newElement));
+        element = &_timerTargets.back();
     }
     else
     {
+        element = &_timerTargets[iter->second];
         CCASSERT(element->paused == paused, "");
-    }
 
-    if (element->timers == NULL)
-    {
-        element->timers = ccArrayNew(10);
-    }
-    else 
-    {
-        for (unsigned int i = 0; i < element->timers->num; ++i)
+        for (auto timer : element->timers)
         {
-            Timer *timer = (Timer*)element->timers->arr[i];
-
             if (selector == timer->getSelector())
             {
                 CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
+                if (timer->_deferred)
+                {
+                    dequeueTimer(timer);
+                }
+                else
+                {
+                    --element->frameTimers;
+                }
+
                 timer->setInterval(interval);
+
+                timer->_deferred = isTimerDeferrable(interval);
+                if (! timer->_deferred)
+                {
+                    ++element->frameTimers;
+                }
+                else if (! element->paused)
+                {
+                    queueTimer(timer);
+                }
                 return;
-            }        
+            }
         }
-        ccArrayEnsureExtraCapacity(element->timers, 1);
     }
 
+    // the array keeps the reference of new
     Timer *pTimer = new Timer();
     pTimer->initWithTarget(target, selector, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, pTimer);
-    pTimer->release();    
+    element->timers.push_back(pTimer);
+
+    pTimer->_deferred = isTimerDeferrable(interval);
+    if (! pTimer->_deferred)
+    {
+        ++element->frameTimers;
+    }
+    else if (! element->paused)
+    {
+        queueTimer(pTimer);
+    }
 }
 
 void Scheduler::unscheduleSelector(SEL_SCHEDULE selector, Object *target)
@@ -348,43 +542,52 @@ void Scheduler::unscheduleSelector(SEL_SCHEDULE selector, Object *target)
         return;
     }
 
-    //CCASSERT(target);
-    //CCASSERT(selector);
-
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_INT(_hashForTimers, &target, element);
+    auto iter = _timerTargetIndices.find(target);
 
-    if (element)
+    if (iter != _timerTargetIndices.end())
     {
-        for (unsigned int i = 0; i < element->timers->num; ++i)
+        unsigned int index = iter->second;
+        TimerTarget& element = _timerTargets[index];
+
+        for (unsigned int i = 0; i < element.timers.size(); ++i)
         {
-            Timer *pTimer = (Timer*)(element->timers->arr[i]);
+            Timer *pTimer = element.timers[i];
 
             if (selector == pTimer->getSelector())
             {
-                if (pTimer == element->currentTimer && (! element->currentTimerSalvaged))
+                if (pTimer == element.currentTimer && (! element.currentTimerSalvaged))
+                {
+                    element.currentTimer->retain();
+                    element.currentTimerSalvaged = true;
+                }
+
+                if (pTimer->_deferred)
                 {
-                    element->currentTimer->retain();
-                    element->currentTimerSalvaged = true;
+                    dequeueTimer(pTimer);
+                }
+                else
+                {
+                    --element.frameTimers;
                 }
 
-                ccArrayRemoveObjectAtIndex(element->timers, i, true);
+                element.timers.erase(element.timers.begin() + i);
+                pTimer->release();
 
                 // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
+                if (element.timerIndex >= i)
                 {
-                    element->timerIndex--;
+                    element.timerIndex--;
                 }
 
-                if (element->timers->num == 0)
+                if (element.timers.empty())
                 {
-                    if (_currentTarget == element)
+                    if (_currentTarget == (int)index)
                     {
                         _currentTargetSalvaged = true;
                     }
                     else
                     {
-                        removeHashElement(element);
+                        removeTimerTarget(index);
                     }
                 }
 
@@ -394,169 +597,209 @@ void Scheduler::unscheduleSelector(SEL_SCHEDULE selector, Object *target)
     }
 }
 
-void Scheduler::priorityIn(tListEntry **list, Object *target, int priority, bool paused)
+void Scheduler::reindexUpdateEntries(std::vector<UpdateEntry>& list, unsigned int from)
 {
-    tListEntry *listElement = (tListEntry *)malloc(sizeof(*listElement));
+    for (unsigned int i = from; i < list.size(); ++i)
+    {
+        if (list[i].target)
+        {
+            UpdateLocation& location = _updateLocations[list[i].target];
+            location.list = &list;
+            location.index = i;
+        }
+    }
+}
 
-    listElement->target = target;
-    listElement->priority = priority;
-    listElement->paused = paused;
-    listElement->next = listElement->prev = NULL;
-    listElement->markedForDeletion = false;
+void Scheduler::insertUpdateEntry(std::vector<UpdateEntry>& list, const UpdateEntry& entry)
+{
+    unsigned int index = list.size();
 
-    // empty list ?
-    if (! *list)
+    if (&list == &_updatesNegList || &list == &_updatesPosList)
     {
-        DL_APPEND(*list, listElement);
+        // after the entries with the same priority, the lists stay sorted
+        auto pos = std::upper_bound(list.begin(), list.end(), entry, [](const UpdateEntry& a, const UpdateEntry& b) {
+            return a.priority < b.priority;
+        });
+        index = pos - list.begin();
+        list.insert(pos, entry);
     }
     else
     {
-        bool bAdded = false;
+        list.push_back(entry);
+    }
+
+    reindexUpdateEntries(list, index);
+}
 
-        for (tListEntry *element = *list; element; element = element->next)
+void Scheduler::compactUpdateEntries(std::vector<UpdateEntry>& list, std::vector<Object*>& targetsToRelease)
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < list.size(); ++i)
+    {
+        UpdateEntry& entry = list[i];
+        if (entry.markedForDeletion)
         {
-            if (priority < element->priority)
+            // tombstones have already released their target
+            if (entry.target)
             {
-                if (element == *list)
-                {
-                    DL_PREPEND(*list, listElement);
-                }
-                else
-                {
-                    listElement->next = element;
-                    listElement->prev = element->prev;
-
-                    element->prev->next = listElement;
-                    element->prev = listElement;
-                }
-
-                bAdded = true;
-                break;
+                _updateLocations.erase(entry.target);
+                targetsToRelease.push_back(entry.target);
             }
+            continue;
         }
 
-        // Not added? priority has the higher value. Append it.
-        if (! bAdded)
+        if (i != count)
         {
-            DL_APPEND(*list, listElement);
+            list[count] = entry;
+            _updateLocations[entry.target].index = count;
         }
+        ++count;
     }
 
-    // update hash entry for quick access
-    tHashUpdateEntry *pHashElement = (tHashUpdateEntry *)calloc(sizeof(*pHashElement), 1);
-    pHashElement->target = target;
-    target->retain();
-    pHashElement->list = list;
-    pHashElement->entry = listElement;
-    HASH_ADD_INT(_hashForUpdates, target, pHashElement);
+    list.erase(list.begin() + count, list.end());
 }
 
-void Scheduler::appendIn(_listEntry **list, Object *target, bool paused)
+void Scheduler::compactUpdateEntries()
 {
-    tListEntry *listElement = (tListEntry *)malloc(sizeof(*listElement));
-
-    listElement->target = target;
-    listElement->paused = paused;
-    listElement->markedForDeletion = false;
+    std::vector<Object*> targetsToRelease;
 
-    DL_APPEND(*list, listElement);
+    compactUpdateEntries(_updatesParallelList, targetsToRelease);
+    compactUpdateEntries(_updatesNegList, targetsToRelease);
+    compactUpdateEntries(_updates0List, targetsToRelease);
+    compactUpdateEntries(_updatesPosList, targetsToRelease);
+    _updateTombstones = 0;
 
-    // update hash entry for quicker access
-    tHashUpdateEntry *pHashElement = (tHashUpdateEntry *)calloc(sizeof(*pHashElement), 1);
-    pHashElement->target = target;
-    target->retain();
-    pHashElement->list = list;
-    pHashElement->entry = listElement;
-    HASH_ADD_INT(_hashForUpdates, target, pHashElement);
+    // released once the arrays are consistent: a target may unschedule itself from its destructor
+    for (auto target : targetsToRelease)
+    {
+        target->release();
+    }
 }
 
-void Scheduler::scheduleUpdateForTarget(Object *target, int priority, bool paused)
+std::vector<Scheduler::UpdateEntry>& Scheduler::getUpdateList(const UpdateEntry& entry)
 {
+    if (entry.parallel)
+    {
+        return _updatesParallelList;
+    }
 
-    tHashUpdateEntry *pHashElement = NULL;
-    HASH_FIND_INT(_hashForUpdates, &target, pHashElement);
-    if (pHashElement)
+    // most of the updates are going to be 0, that's way there
+    // is an special list for updates with priority 0
+    if (entry.priority == 0)
+    {
+        return _updates0List;
+    }
+    else if (entry.priority < 0)
     {
+        return _updatesNegList;
+    }
+
+    // priority > 0
+    return _updatesPosList;
+}
+
+void Scheduler::scheduleUpdateEntry(const UpdateEntry& entry)
+{
+    auto iter = _updateLocations.find(entry.target);
+    if (iter != _updateLocations.end())
+    {
+        UpdateEntry& scheduledEntry = (*iter->second.list)[iter->second.index];
 #if COCOS2D_DEBUG >= 1
-        CCASSERT(pHashElement->entry->markedForDeletion,"");
+        CCASSERT(scheduledEntry.markedForDeletion,"");
 #endif
         // TODO: check if priority has changed!
 
-        pHashElement->entry->markedForDeletion = false;
+        scheduledEntry.markedForDeletion = false;
         return;
     }
 
-    // most of the updates are going to be 0, that's way there
-    // is an special list for updates with priority 0
-    if (priority == 0)
-    {
-        appendIn(&_updates0List, target, paused);
-    }
-    else if (priority < 0)
+    entry.target->retain();
+
+    if (_updateHashLocked)
     {
-        priorityIn(&_updatesNegList, target, priority, paused);
+        // the arrays are being iterated, the entry is added at the end of the tick
+        insertUpdateEntry(_updatesToAdd, entry);
+        return;
     }
-    else
+
+    if (_updateTombstones > SCHEDULER_MAX_TOMBSTONES)
     {
-        // priority > 0
-        priorityIn(&_updatesPosList, target, priority, paused);
+        compactUpdateEntries();
     }
+
+    insertUpdateEntry(getUpdateList(entry), entry);
+}
+
+void Scheduler::scheduleUpdateForTarget(Object *target, int priority, bool paused)
+{
+    UpdateEntry entry = { target, priority, paused, false, false, dynamic_cast<Node*>(target) != NULL };
+    scheduleUpdateEntry(entry);
+}
+
+void Scheduler::scheduleParallelUpdateForTarget(Object *target, bool paused)
+{
+    CCASSERT(target, "Argument target must be non-NULL");
+
+    UpdateEntry entry = { target, 0, paused, false, true, dynamic_cast<Node*>(target) != NULL };
+    scheduleUpdateEntry(entry);
 }
 
 bool Scheduler::isScheduledForTarget(SEL_SCHEDULE selector, Object *target)
 {
     CCASSERT(selector, "Argument selector must be non-NULL");
     CCASSERT(target, "Argument target must be non-NULL");
-    
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_INT(_hashForTimers, &target, element);
-    
-    if (!element)
+
+    auto iter = _timerTargetIndices.find(target);
+
+    if (iter == _timerTargetIndices.end())
     {
         return false;
     }
-    
-    if (element->timers == NULL)
-    {
-        return false;
-    }else
+
+    for (auto timer : _timerTargets[iter->second].timers)
     {
-        for (unsigned int i = 0; i < element->timers->num; ++i)
+        if (selector == timer->getSelector())
         {
-            Timer *timer = (Timer*)element->timers->arr[i];
-            
-            if (selector == timer->getSelector())
-            {
-                return true;
-            }
+            return true;
         }
-        
-        return false;
     }
-    
-    return false;  // should never get here
+
+    return false;
 }
 
-void Scheduler::removeUpdateFromHash(struct _listEntry *entry)
+unsigned int Scheduler::getScheduledUpdateCount() const
 {
-    tHashUpdateEntry *element = NULL;
+    return (unsigned int)_updateLocations.size();
+}
 
-    HASH_FIND_INT(_hashForUpdates, &entry->target, element);
-    if (element)
+unsigned int Scheduler::getScheduledTimerCount() const
+{
+    size_t count = 0;
+    for (const auto& timerTarget : _timerTargets)
     {
-        // list entry
-        DL_DELETE(*element->list, element->entry);
-        free(element->entry);
+        if (timerTarget.target != NULL)
+        {
+            count += timerTarget.timers.size();
+        }
+    }
 
-        // hash entry
-        Object* target = element->target;
-        HASH_DEL(_hashForUpdates, element);
-        free(element);
+    return (unsigned int)count;
+}
 
-        // target#release should be the last one to prevent
-        // a possible double-free. eg: If the [target dealloc] might want to remove it itself from there
-        target->release();
-    }
+void Scheduler::removeUpdateEntry(UpdateLocation location)
+{
+    UpdateEntry& entry = (*location.list)[location.index];
+    Object* target = entry.target;
+
+    // the entry stays in the array as a tombstone until the array is compacted
+    entry.target = NULL;
+    entry.markedForDeletion = true;
+    _updateLocations.erase(target);
+    ++_updateTombstones;
+
+    // target#release should be the last one to prevent
+    // a possible double-free. eg: If the [target dealloc] might want to remove it itself from there
+    target->release();
 }
 
 void Scheduler::unscheduleUpdateForTarget(const Object *target)
@@ -566,17 +809,16 @@ void Scheduler::unscheduleUpdateForTarget(const Object *target)
         return;
     }
 
-    tHashUpdateEntry *element = NULL;
-    HASH_FIND_INT(_hashForUpdates, &target, element);
-    if (element)
+    auto iter = _updateLocations.find(target);
+    if (iter != _updateLocations.end())
     {
         if (_updateHashLocked)
         {
-            element->entry->markedForDeletion = true;
+            (*iter->second.list)[iter->second.index].markedForDeletion = true;
         }
         else
         {
-            this->removeUpdateFromHash(element->entry);
+            this->removeUpdateEntry(iter->second);
         }
     }
 }
@@ -588,45 +830,53 @@ void Scheduler::unscheduleAll(void)
 
 void Scheduler::unscheduleAllWithMinPriority(int nMinPriority)
 {
+    // The targets are collected first: releasing a target may unschedule or schedule other targets
+    std::vector<Object*> targets;
+
     // Custom Selectors
-    tHashTimerEntry *element = NULL;
-    tHashTimerEntry *pNextElement = NULL;
-    for (element = _hashForTimers; element != NULL;)
+    targets.reserve(_timerTargetIndices.size());
+    for (const auto& element : _timerTargets)
     {
-        // element may be removed in unscheduleAllSelectorsForTarget
-        pNextElement = (tHashTimerEntry *)element->hh.next;
-        unscheduleAllForTarget(element->target);
+        if (element.target)
+        {
+            targets.push_back(element.target);
+        }
+    }
 
-        element = pNextElement;
+    for (auto target : targets)
+    {
+        unscheduleAllForTarget(target);
     }
 
     // Updates selectors
-    tListEntry *pEntry, *pTmp;
-    if(nMinPriority < 0) 
-    {
-        DL_FOREACH_SAFE(_updatesNegList, pEntry, pTmp)
+    targets.clear();
+    auto collect = [&targets, nMinPriority](const std::vector<UpdateEntry>& list) {
+        for (const auto& entry : list)
         {
-            if(pEntry->priority >= nMinPriority) 
+            if (entry.target && entry.priority >= nMinPriority)
             {
-                unscheduleUpdateForTarget(pEntry->target);
+                targets.push_back(entry.target);
             }
         }
+    };
+
+    if(nMinPriority < 0)
+    {
+        collect(_updatesNegList);
     }
 
-    if(nMinPriority <= 0) 
+    if(nMinPriority <= 0)
     {
-        DL_FOREACH_SAFE(_updates0List, pEntry, pTmp)
-        {
-            unscheduleUpdateForTarget(pEntry->target);
-        }
+        collect(_updatesParallelList);
+        collect(_updates0List);
     }
 
-    DL_FOREACH_SAFE(_updatesPosList, pEntry, pTmp)
+    collect(_updatesPosList);
+    collect(_updatesToAdd);
+
+    for (auto target : targets)
     {
-        if(pEntry->priority >= nMinPriority) 
-        {
-            unscheduleUpdateForTarget(pEntry->target);
-        }
+        unscheduleUpdateForTarget(target);
     }
 
     if (_scriptHandlerEntries)
@@ -644,26 +894,35 @@ void Scheduler::unscheduleAllForTarget(Object *target)
     }
 
     // Custom Selectors
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_INT(_hashForTimers, &target, element);
+    auto iter = _timerTargetIndices.find(target);
 
-    if (element)
+    if (iter != _timerTargetIndices.end())
     {
-        if (ccArrayContainsObject(element->timers, element->currentTimer)
-            && (! element->currentTimerSalvaged))
+        unsigned int index = iter->second;
+        TimerTarget& element = _timerTargets[index];
+
+        if (element.currentTimer && (! element.currentTimerSalvaged)
+            && std::find(element.timers.begin(), element.timers.end(), element.currentTimer) != element.timers.end())
         {
-            element->currentTimer->retain();
-            element->currentTimerSalvaged = true;
+            element.currentTimer->retain();
+            element.currentTimerSalvaged = true;
         }
-        ccArrayRemoveAllObjects(element->timers);
 
-        if (_currentTarget == element)
+        for (auto timer : element.timers)
+        {
+            dequeueTimer(timer);
+            timer->release();
+        }
+        element.timers.clear();
+        element.frameTimers = 0;
+
+        if (_currentTarget == (int)index)
         {
             _currentTargetSalvaged = true;
         }
         else
         {
-            removeHashElement(element);
+            removeTimerTarget(index);
         }
     }
 
@@ -691,6 +950,12 @@ void Scheduler::unscheduleScriptEntry(unsigned int uScheduleScriptEntryID)
         if (pEntry->getEntryId() == (int)uScheduleScriptEntryID)
         {
             pEntry->markedForDeletion();
+            // it may have been queued in the current batch of script events
+            ScriptEngineProtocol* pEngine = ScriptEngineManager::getInstance()->getScriptEngine();
+            if (pEngine)
+            {
+                pEngine->cancelQueuedEvents(pEntry->getHandler());
+            }
             break;
         }
     }
@@ -701,20 +966,28 @@ void Scheduler::resumeTarget(Object *target)
     CCASSERT(target != NULL, "");
 
     // custom selectors
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_INT(_hashForTimers, &target, element);
-    if (element)
+    auto iter = _timerTargetIndices.find(target);
+    if (iter != _timerTargetIndices.end())
     {
-        element->paused = false;
+        TimerTarget& element = _timerTargets[iter->second];
+        if (element.paused)
+        {
+            element.paused = false;
+            for (auto timer : element.timers)
+            {
+                if (timer->_deferred)
+                {
+                    queueTimer(timer);
+                }
+            }
+        }
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = NULL;
-    HASH_FIND_INT(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    auto iterUpdate = _updateLocations.find(target);
+    if (iterUpdate != _updateLocations.end())
     {
-        CCASSERT(elementUpdate->entry != NULL, "");
-        elementUpdate->entry->paused = false;
+        (*iterUpdate->second.list)[iterUpdate->second.index].paused = false;
     }
 }
 
@@ -723,20 +996,25 @@ void Scheduler::pauseTarget(Object *target)
     CCASSERT(target != NULL, "");
 
     // custom selectors
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_INT(_hashForTimers, &target, element);
-    if (element)
+    auto iter = _timerTargetIndices.find(target);
+    if (iter != _timerTargetIndices.end())
     {
-        element->paused = true;
+        TimerTarget& element = _timerTargets[iter->second];
+        if (! element.paused)
+        {
+            element.paused = true;
+            for (auto timer : element.timers)
+            {
+                dequeueTimer(timer);
+            }
+        }
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = NULL;
-    HASH_FIND_INT(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    auto iterUpdate = _updateLocations.find(target);
+    if (iterUpdate != _updateLocations.end())
     {
-        CCASSERT(elementUpdate->entry != NULL, "");
-        elementUpdate->entry->paused = true;
+        (*iterUpdate->second.list)[iterUpdate->second.index].paused = true;
     }
 }
 
@@ -745,21 +1023,19 @@ bool Scheduler::isTargetPaused(Object *target)
     CCASSERT( target != NULL, "target must be non nil" );
 
     // Custom selectors
-    tHashTimerEntry *element = NULL;
-    HASH_FIND_INT(_hashForTimers, &target, element);
-    if( element )
+    auto iter = _timerTargetIndices.find(target);
+    if (iter != _timerTargetIndices.end())
     {
-        return element->paused;
+        return _timerTargets[iter->second].paused;
     }
-    
+
     // We should check update selectors if target does not have custom selectors
-	tHashUpdateEntry *elementUpdate = NULL;
-	HASH_FIND_INT(_hashForUpdates, &target, elementUpdate);
-	if ( elementUpdate )
+    auto iterUpdate = _updateLocations.find(target);
+    if (iterUpdate != _updateLocations.end())
     {
-		return elementUpdate->entry->paused;
+        return (*iterUpdate->second.list)[iterUpdate->second.index].paused;
     }
-    
+
     return false;  // should never get here
 }
 
@@ -774,45 +1050,48 @@ Set* Scheduler::pauseAllTargetsWithMinPriority(int nMinPriority)
     idsWithSelectors->autorelease();
 
     // Custom Selectors
-    for(tHashTimerEntry *element = _hashForTimers; element != NULL;
-        element = (tHashTimerEntry*)element->hh.next)
+    for (auto& element : _timerTargets)
     {
-        element->paused = true;
-        idsWithSelectors->addObject(element->target);
+        if (element.target)
+        {
+            if (! element.paused)
+            {
+                element.paused = true;
+                for (auto timer : element.timers)
+                {
+                    dequeueTimer(timer);
+                }
+            }
+            idsWithSelectors->addObject(element.target);
+        }
     }
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(nMinPriority < 0) 
-    {
-        DL_FOREACH_SAFE( _updatesNegList, entry, tmp ) 
+    auto pause = [idsWithSelectors, nMinPriority](std::vector<UpdateEntry>& list) {
+        for (auto& entry : list)
         {
-            if(entry->priority >= nMinPriority) 
+            if (entry.target && entry.priority >= nMinPriority)
             {
-                entry->paused = true;
-                idsWithSelectors->addObject(entry->target);
+                entry.paused = true;
+                idsWithSelectors->addObject(entry.target);
             }
         }
-    }
+    };
 
-    if(nMinPriority <= 0) 
+    if(nMinPriority < 0)
     {
-        DL_FOREACH_SAFE( _updates0List, entry, tmp )
-        {
-            entry->paused = true;
-            idsWithSelectors->addObject(entry->target);
-        }
+        pause(_updatesNegList);
     }
 
-    DL_FOREACH_SAFE( _updatesPosList, entry, tmp ) 
+    if(nMinPriority <= 0)
     {
-        if(entry->priority >= nMinPriority) 
-        {
-            entry->paused = true;
-            idsWithSelectors->addObject(entry->target);
-        }
+        pause(_updatesParallelList);
+        pause(_updates0List);
     }
 
+    pause(_updatesPosList);
+    pause(_updatesToAdd);
+
     return idsWithSelectors;
 }
 
@@ -835,123 +1114,210 @@ void Scheduler::update(float dt)
         dt *= _timeScale;
     }
 
-    // Iterate over all the Updates' selectors
-    tListEntry *pEntry, *pTmp;
+    // Iterate over all the Updates' selectors.
+    // The arrays can't be reallocated while locked: new entries go to _updatesToAdd
+    // and unscheduled entries are only marked for deletion
 
-    // updates with priority < 0
-    DL_FOREACH_SAFE(_updatesNegList, pEntry, pTmp)
     {
-        if ((! pEntry->paused) && (! pEntry->markedForDeletion))
+        CC_PROFILE_ZONE("Scheduler - updates");
+
+        // parallel updates, all done before the other ones
+        if (! _updatesParallelList.empty())
         {
-            pEntry->target->update(dt);
+            const std::vector<UpdateEntry>& list = _updatesParallelList;
+            JobSystem::getInstance()->parallelFor(list.size(), 0, [&list, dt](unsigned int begin, unsigned int end) {
+                for (unsigned int i = begin; i < end; ++i)
+                {
+                    const UpdateEntry& entry = list[i];
+                    if ((! entry.paused) && (! entry.markedForDeletion))
+                    {
+                        entry.target->update(dt);
+                        if (entry.node)
+                        {
+                            Director::setNextFrameDirty();
+                        }
+                    }
+                }
+            });
         }
-    }
 
-    // updates with priority == 0
-    DL_FOREACH_SAFE(_updates0List, pEntry, pTmp)
-    {
-        if ((! pEntry->paused) && (! pEntry->markedForDeletion))
+        // updates with priority < 0
+        for (const auto& entry : _updatesNegList)
         {
-            pEntry->target->update(dt);
+            if ((! entry.paused) && (! entry.markedForDeletion))
+            {
+                entry.target->update(dt);
+                if (entry.node)
+                {
+                    Director::setNextFrameDirty();
+                }
+            }
         }
-    }
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(_updatesPosList, pEntry, pTmp)
-    {
-        if ((! pEntry->paused) && (! pEntry->markedForDeletion))
+        // updates with priority == 0
+        for (const auto& entry : _updates0List)
         {
-            pEntry->target->update(dt);
+            if ((! entry.paused) && (! entry.markedForDeletion))
+            {
+                entry.target->update(dt);
+                if (entry.node)
+                {
+                    Director::setNextFrameDirty();
+                }
+            }
+        }
+
+        // updates with priority > 0
+        for (const auto& entry : _updatesPosList)
+        {
+            if ((! entry.paused) && (! entry.markedForDeletion))
+            {
+                entry.target->update(dt);
+                if (entry.node)
+                {
+                    Director::setNextFrameDirty();
+                }
+            }
         }
     }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != NULL; )
+    _timerClock += dt;
+
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+        CC_PROFILE_ZONE("Scheduler - timers");
 
-        if (! _currentTarget->paused)
+        // Iterate over all the custom selectors that are updated every frame.
+        // Targets scheduled by the callbacks are appended, so the element is fetched again after each timer
+        for (unsigned int i = 0; i < _timerTargets.size(); ++i)
         {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
+            if (_timerTargets[i].target == NULL || _timerTargets[i].frameTimers == 0)
             {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                elt->currentTimerSalvaged = false;
+                continue;
+            }
 
-                elt->currentTimer->update(dt);
+            _currentTarget = i;
+            _currentTargetSalvaged = false;
 
-                if (elt->currentTimerSalvaged)
+            TimerTarget *elt = &_timerTargets[i];
+            if (! elt->paused)
+            {
+                // The 'timers' array may change while inside this loop
+                for (elt->timerIndex = 0; elt->timerIndex < elt->timers.size(); ++(elt->timerIndex))
                 {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
+                    Timer *timer = elt->timers[elt->timerIndex];
+                    if (timer->_deferred)
+                    {
+                        continue;
+                    }
+
+                    elt->currentTimer = timer;
+                    elt->currentTimerSalvaged = false;
+
+                    timer->update(dt);
+                    Director::setNextFrameDirty();
+
+                    elt = &_timerTargets[i];
+                    if (elt->currentTimerSalvaged)
+                    {
+                        // The currentTimer told the remove itself. To prevent the timer from
+                        // accidentally deallocating itself before finishing its step, we retained
+                        // it. Now that step is done, it's safe to release it.
+                        timer->release();
+                    }
+
+                    elt->currentTimer = NULL;
                 }
+            }
 
-                elt->currentTimer = NULL;
+            // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
+            if (_currentTargetSalvaged && elt->timers.empty())
+            {
+                removeTimerTarget(i);
             }
         }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
+        _currentTarget = -1;
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
-        {
-            removeHashElement(_currentTarget);
-        }
+        // and over the custom selectors with a long interval that are due
+        updateDeferredTimers();
+    }
+
+    if (_timerTombstones > 0)
+    {
+        compactTimerTargets();
     }
 
-    // Iterate over all the script callbacks
-    if (_scriptHandlerEntries)
     {
-        for (int i = _scriptHandlerEntries->count() - 1; i >= 0; i--)
+        CC_PROFILE_ZONE("Scheduler - scripts");
+
+        // Iterate over all the script callbacks, they are dispatched to the script engine at once
+        if (_scriptHandlerEntries)
         {
-            SchedulerScriptHandlerEntry* pEntry = static_cast<SchedulerScriptHandlerEntry*>(_scriptHandlerEntries->objectAtIndex(i));
-            if (pEntry->isMarkedForDeletion())
-            {
-                _scriptHandlerEntries->removeObjectAtIndex(i);
-            }
-            else if (!pEntry->isPaused())
+            ScriptEventBatch batch;
+            for (int i = _scriptHandlerEntries->count() - 1; i >= 0; i--)
             {
-                pEntry->getTimer()->update(dt);
+                SchedulerScriptHandlerEntry* pEntry = static_cast<SchedulerScriptHandlerEntry*>(_scriptHandlerEntries->objectAtIndex(i));
+                if (pEntry->isMarkedForDeletion())
+                {
+                    _scriptHandlerEntries->removeObjectAtIndex(i);
+                }
+                else if (!pEntry->isPaused())
+                {
+                    pEntry->getTimer()->update(dt);
+                    Director::setNextFrameDirty();
+                }
             }
         }
     }
 
     // delete all updates that are marked for deletion
-    // updates with priority < 0
-    DL_FOREACH_SAFE(_updatesNegList, pEntry, pTmp)
+    std::vector<Object*> targetsToRelease;
+
+    compactUpdateEntries(_updatesParallelList, targetsToRelease);
+    compactUpdateEntries(_updatesNegList, targetsToRelease);
+    compactUpdateEntries(_updates0List, targetsToRelease);
+    compactUpdateEntries(_updatesPosList, targetsToRelease);
+    _updateTombstones = 0;
+
+    // add the updates scheduled during the tick
+    for (const auto& entry : _updatesToAdd)
     {
-        if (pEntry->markedForDeletion)
+        if (entry.markedForDeletion)
         {
-            this->removeUpdateFromHash(pEntry);
+            _updateLocations.erase(entry.target);
+            targetsToRelease.push_back(entry.target);
         }
-    }
-
-    // updates with priority == 0
-    DL_FOREACH_SAFE(_updates0List, pEntry, pTmp)
-    {
-        if (pEntry->markedForDeletion)
+        else
         {
-            this->removeUpdateFromHash(pEntry);
+            insertUpdateEntry(getUpdateList(entry), entry);
         }
     }
+    _updatesToAdd.clear();
+
+    _updateHashLocked = false;
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(_updatesPosList, pEntry, pTmp)
+    // released once the arrays are consistent: a target may unschedule itself from its destructor
+    for (auto target : targetsToRelease)
     {
-        if (pEntry->markedForDeletion)
-        {
-            this->removeUpdateFromHash(pEntry);
-        }
+        target->release();
     }
 
-    _updateHashLocked = false;
+    // Functions queued by the other threads
+    std::vector<std::function<void()>> functions;
+    _performMutex.lock();
+    functions.swap(_functionsToPerform);
+    _performMutex.unlock();
 
-    _currentTarget = NULL;
+    for (const auto& function : functions)
+    {
+        function();
+    }
+}
+
+void Scheduler::performFunctionInCocosThread(const std::function<void()>& function)
+{
+    std::lock_guard<std::mutex> lock(_performMutex);
+    _functionsToPerform.push_back(function);
 }
 
 
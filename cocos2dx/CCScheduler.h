@@ -28,7 +28,11 @@ THE SOFTWARE.
 #define __CCSCHEDULER_H__
 
 #include "cocoa/CCObject.h"
-#include "support/data_support/uthash.h"
+#include "cocoa/CCPoolAllocator.h"
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
 
 NS_CC_BEGIN
 
@@ -43,7 +47,7 @@ class Set;
 //
 /** @brief Light-weight timer */
 //
-class CC_DLL Timer : public Object
+class CC_DLL Timer : public Object, public PoolAllocated
 {
 public:
     /** Allocates a timer with a target and a selector. */
@@ -90,15 +94,18 @@ protected:
     SEL_SCHEDULE _selector;
     
     int _scriptHandler;
+
+    // Timers with a long interval are queued by the Scheduler instead of being updated every frame
+    friend class Scheduler;
+    bool _deferred;             // queued, see CC_SCHEDULER_TIMER_HEAP_MIN_INTERVAL
+    int _heapIndex;             // index in the queue, or a negative value if the timer isn't queued
+    double _dueTime;            // scheduler time at which the timer needs an update
+    double _lastUpdateTime;     // scheduler time of the last update of the timer
 };
 
 //
 // Scheduler
 //
-struct _listEntry;
-struct _hashSelectorEntry;
-struct _hashUpdateEntry;
-
 class Array;
 
 /** @brief Scheduler is responsible for triggering the scheduled callbacks.
@@ -158,12 +165,33 @@ public:
      @since v0.99.3
      */
     void scheduleUpdateForTarget(Object *target, int nPriority, bool bPaused);
+
+    /** Schedules the 'update' selector of a thread-safe target, called in parallel with the other ones scheduled this way.
+     The 'update' selectors scheduled with this method are called every frame before all the other selectors,
+     on the threads of the JobSystem. The scheduler waits for all of them before calling the other selectors,
+     so they don't run while the scene is visited.
+     The target must only modify its own state: it can't use the Scheduler, the nodes or OpenGL,
+     nor create, retain, release or autorelease objects.
+     It is unscheduled with unscheduleUpdateForTarget(), and the methods with a minimum priority handle it as priority 0.
+     @since v3.0
+     */
+    void scheduleParallelUpdateForTarget(Object *target, bool bPaused);
     
     /** Checks whether a selector for a given taget is scheduled.
      @since v3.0.0
      */
     bool isScheduledForTarget(SEL_SCHEDULE selector, Object *target);
 
+    /** Returns the number of targets whose "update" selector is scheduled
+     @since v3.0
+     */
+    unsigned int getScheduledUpdateCount() const;
+
+    /** Returns the number of custom selectors scheduled on all the targets
+     @since v3.0
+     */
+    unsigned int getScheduledTimerCount() const;
+
     /** Unschedule a selector for a given target.
      If you want to unschedule the "update", use unscheudleUpdateForTarget.
      @since v0.99.3
@@ -241,14 +269,67 @@ public:
       */
     void resumeTargets(Set* targetsToResume);
 
+    /** Calls a function on the cocos2d thread, at the end of the next tick.
+     This method is thread safe: it lets the other threads, like the tasks of the JobSystem,
+     create cocos2d objects or modify the scene graph.
+     The functions are called in the order they were added.
+     @since v3.0
+     */
+    void performFunctionInCocosThread(const std::function<void()>& function);
+
 private:
-    void removeHashElement(struct _hashSelectorEntry *pElement);
-    void removeUpdateFromHash(struct _listEntry *entry);
+    // An 'update' selector of a target. Entries are stored by value, sorted by priority,
+    // in one packed array per priority range, so ticking them does not chase pointers.
+    struct UpdateEntry
+    {
+        Object *target;         // retained. NULL once the entry has been removed (tombstone)
+        int priority;
+        bool paused;
+        bool markedForDeletion; // selector will no longer be called and entry will be removed at end of the tick
+        bool parallel;          // scheduled with scheduleParallelUpdateForTarget()
+        bool node;              // the target is a node: its update marks the frame dirty, see Director::setRenderOnDemand()
+    };
+
+    // The array and the index of the entry of a target, used to fetch it quickly for pause, delete, etc
+    struct UpdateLocation
+    {
+        std::vector<UpdateEntry> *list;
+        unsigned int index;
+    };
+
+    // The custom selectors of a target
+    struct TimerTarget
+    {
+        Object *target;         // retained. NULL once the entry has been removed (tombstone)
+        std::vector<Timer*> timers; // retained
+        unsigned int timerIndex;
+        Timer *currentTimer;
+        bool currentTimerSalvaged;
+        bool paused;
+        unsigned int frameTimers;   // number of timers that are not deferred, updated every frame
+    };
+
+    void removeTimerTarget(unsigned int index);
+    void compactTimerTargets();
+
+    // queue of the deferred timers, a binary min-heap on their due time
+
+    void queueTimer(Timer *timer);
+    void dequeueTimer(Timer *timer);
+    void removeFromTimerHeap(unsigned int index);
+    void siftTimerUp(unsigned int index);
+    void siftTimerDown(unsigned int index);
+    void updateDeferredTimers();
 
     // update specific
 
-    void priorityIn(struct _listEntry **ppList, Object *target, int nPriority, bool bPaused);
-    void appendIn(struct _listEntry **ppList, Object *target, bool bPaused);
+    std::vector<UpdateEntry>& getUpdateList(const UpdateEntry& entry);
+    void scheduleUpdateEntry(const UpdateEntry& entry);
+    void removeUpdateEntry(UpdateLocation location);
+    void insertUpdateEntry(std::vector<UpdateEntry>& list, const UpdateEntry& entry);
+    void reindexUpdateEntries(std::vector<UpdateEntry>& list, unsigned int from);
+    void compactUpdateEntries(std::vector<UpdateEntry>& list, std::vector<Object*>& targetsToRelease);
+    void compactUpdateEntries();
 
 protected:
     float _timeScale;
@@ -256,18 +337,31 @@ protected:
     //
     // "updates with priority" stuff
     //
-    struct _listEntry *_updatesNegList;        // list of priority < 0
-    struct _listEntry *_updates0List;            // list priority == 0
-    struct _listEntry *_updatesPosList;        // list priority > 0
-    struct _hashUpdateEntry *_hashForUpdates; // hash used to fetch quickly the list entries for pause,delete,etc
+    std::vector<UpdateEntry> _updatesParallelList;  // updated in parallel, before the other lists
+    std::vector<UpdateEntry> _updatesNegList;   // priority < 0
+    std::vector<UpdateEntry> _updates0List;     // priority == 0
+    std::vector<UpdateEntry> _updatesPosList;   // priority > 0
+    std::vector<UpdateEntry> _updatesToAdd;     // scheduled while updating, added at end of the tick
+    std::unordered_map<const Object*, UpdateLocation> _updateLocations;
+    unsigned int _updateTombstones;
 
     // Used for "selectors with interval"
-    struct _hashSelectorEntry *_hashForTimers;
-    struct _hashSelectorEntry *_currentTarget;
+    std::vector<TimerTarget> _timerTargets;
+    std::unordered_map<const Object*, unsigned int> _timerTargetIndices;
+    unsigned int _timerTombstones;
+    int _currentTarget;         // index of the target being ticked, -1 outside of update
+    // Used for the timers with a long interval
+    std::vector<Timer*> _timerHeap;     // not retained, the timers are retained by their target
+    std::vector<Timer*> _dueTimers;
+    double _timerClock;                 // scaled time elapsed since the scheduler was created
     bool _currentTargetSalvaged;
-    // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
+    // If true unschedule will not remove anything from the arrays. Elements will only be marked for deletion.
     bool _updateHashLocked;
     Array* _scriptHandlerEntries;
+
+    // Used for "perform Function"
+    std::vector<std::function<void()>> _functionsToPerform;
+    std::mutex _performMutex;
 };
 
 // end of global group
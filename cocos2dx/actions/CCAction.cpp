@@ -61,6 +61,12 @@ void Action::stop()
     _target = NULL;
 }
 
+void Action::resetForReuse()
+{
+    _originalTarget = _target = NULL;
+    _tag = kActionTagInvalid;
+}
+
 bool Action::isDone() const
 {
     return true;
@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include "cocoa/CCObject.h"
 #include "cocoa/CCGeometry.h"
+#include "cocoa/CCPoolAllocator.h"
 #include "platform/CCPlatformMacros.h"
 
 NS_CC_BEGIN
@@ -46,7 +47,7 @@ enum {
 /** 
 @brief Base class for Action objects.
  */
-class CC_DLL Action : public Object, public Clonable
+class CC_DLL Action : public Object, public Clonable, public PoolAllocated
 {
 public:
     Action(void);
@@ -101,6 +102,12 @@ public:
     inline int getTag(void) const { return _tag; }
     inline void setTag(int nTag) { _tag = nTag; }
 
+    /** Forgets the targets and the tag of a stopped action, to run it again as a new one.
+    The state of the running action is set again by startWithTarget.
+    @see ObjectPool
+    */
+    virtual void resetForReuse(void);
+
 protected:
     Node    *_originalTarget;
     /** The "target".
@@ -34,6 +34,8 @@
  */
 #include "ccMacros.h"
 #include "CCActionCatmullRom.h"
+#include <algorithm>
+#include <math.h>
 
 using namespace std;
 
@@ -43,6 +45,9 @@ NS_CC_BEGIN;
  *  Implementation of PointArray
  */
 
+// samples of the arc-length table between two control points
+static const int ARC_LENGTH_SAMPLES_PER_SEGMENT = 16;
+
 PointArray* PointArray::create(unsigned int capacity)
 {
     PointArray* ret = new PointArray();
@@ -65,23 +70,17 @@ PointArray* PointArray::create(unsigned int capacity)
 
 bool PointArray::initWithCapacity(unsigned int capacity)
 {
-    _controlPoints = new vector<Point*>();
+    _controlPoints.reserve(capacity);
     
     return true;
 }
 
 PointArray* PointArray::clone() const
 {
-    vector<Point*> *newArray = new vector<Point*>();
-    vector<Point*>::iterator iter;
-    for (iter = _controlPoints->begin(); iter != _controlPoints->end(); ++iter)
-    {
-        newArray->push_back(new Point((*iter)->x, (*iter)->y));
-    }
-    
     PointArray *points = new PointArray();
-    points->initWithCapacity(10);
-    points->setControlPoints(newArray);
+    points->_controlPoints = _controlPoints;
+    points->_arcLengths = _arcLengths;
+    points->_arcLengthTension = _arcLengthTension;
 
     points->autorelease();
     return points;
@@ -89,110 +88,154 @@ PointArray* PointArray::clone() const
 
 PointArray::~PointArray()
 {
-    vector<Point*>::iterator iter;
-    for (iter = _controlPoints->begin(); iter != _controlPoints->end(); ++iter)
-    {
-        delete *iter;
-    }
-    delete _controlPoints;
 }
 
-PointArray::PointArray() :_controlPoints(NULL){}
-
-const std::vector<Point*>* PointArray::getControlPoints() const
+PointArray::PointArray()
+: _arcLengthTension(0)
 {
-    return _controlPoints;
 }
 
-void PointArray::setControlPoints(vector<Point*> *controlPoints)
+void PointArray::setControlPoints(const vector<Point>& controlPoints)
 {
-    CCASSERT(controlPoints != NULL, "control points should not be NULL");
-    
-    // delete old points
-    vector<Point*>::iterator iter;
-    for (iter = _controlPoints->begin(); iter != _controlPoints->end(); ++iter)
-    {
-        delete *iter;
-    }
-    delete _controlPoints;
-    
     _controlPoints = controlPoints;
+    _arcLengths.clear();
 }
 
 void PointArray::addControlPoint(Point controlPoint)
 {    
-    _controlPoints->push_back(new Point(controlPoint.x, controlPoint.y));
+    _controlPoints.push_back(controlPoint);
+    _arcLengths.clear();
 }
 
 void PointArray::insertControlPoint(Point &controlPoint, unsigned int index)
 {
-    Point *temp = new Point(controlPoint.x, controlPoint.y);
-    _controlPoints->insert(_controlPoints->begin() + index, temp);
+    _controlPoints.insert(_controlPoints.begin() + index, controlPoint);
+    _arcLengths.clear();
 }
 
-Point PointArray::getControlPointAtIndex(unsigned int index)
+Point PointArray::getControlPointAtIndex(int index)
 {
-    index = MIN(_controlPoints->size()-1, MAX(index, 0));
-    return *(_controlPoints->at(index));
+    index = MIN((int)_controlPoints.size()-1, MAX(index, 0));
+    return _controlPoints.at(index);
 }
 
 void PointArray::replaceControlPoint(cocos2d::Point &controlPoint, unsigned int index)
 {
-
-    Point *temp = _controlPoints->at(index);
-    temp->x = controlPoint.x;
-    temp->y = controlPoint.y;
+    _controlPoints.at(index) = controlPoint;
+    _arcLengths.clear();
 }
 
 void PointArray::removeControlPointAtIndex(unsigned int index)
 {
-    vector<Point*>::iterator iter = _controlPoints->begin() + index;
-    Point* pRemovedPoint = *iter;
-    _controlPoints->erase(iter);
-    delete pRemovedPoint;
+    _controlPoints.erase(_controlPoints.begin() + index);
+    _arcLengths.clear();
 }
 
 unsigned int PointArray::count() const
 {
-    return _controlPoints->size();
+    return _controlPoints.size();
 }
 
 PointArray* PointArray::reverse() const
 {
-    vector<Point*> *newArray = new vector<Point*>();
-    vector<Point*>::reverse_iterator iter;
-    Point *point = NULL;
-    for (iter = _controlPoints->rbegin(); iter != _controlPoints->rend(); ++iter)
-    {
-        point = *iter;
-        newArray->push_back(new Point(point->x, point->y));
-    }
     PointArray *config = PointArray::create(0);
-    config->setControlPoints(newArray);
+    config->_controlPoints.assign(_controlPoints.rbegin(), _controlPoints.rend());
     
     return config;
 }
 
 void PointArray::reverseInline()
 {
-    unsigned long l = _controlPoints->size();
-    Point *p1 = NULL;
-    Point *p2 = NULL;
-    int x, y;
-    for (unsigned int i = 0; i < l/2; ++i)
+    std::reverse(_controlPoints.begin(), _controlPoints.end());
+    _arcLengths.clear();
+}
+
+Point PointArray::getSplinePoint(float time, float tension) const
+{
+    const int count = (int)_controlPoints.size();
+    if (count < 2)
     {
-        p1 = _controlPoints->at(i);
-        p2 = _controlPoints->at(l-i-1);
-        
-        x = p1->x;
-        y = p1->y;
-        
-        p1->x = p2->x;
-        p1->y = p2->y;
-        
-        p2->x = x;
-        p2->y = y;
+        return count > 0 ? _controlPoints[0] : Point::ZERO;
+    }
+
+    // Issue #1441
+    const float deltaT = 1.0f / (count - 1);
+    int p;
+    float lt;
+
+	// eg.
+	// p..p..p..p..p..p..p
+	// 1..2..3..4..5..6..7
+	// want p to be 1, 2, 3, 4, 5, 6
+    if (time >= 1)
+    {
+        p = count - 1;
+        lt = 1;
     }
+    else
+    {
+        p = (int)floorf(time / deltaT);
+        lt = (time - deltaT * (float)p) / deltaT;
+    }
+
+    // the points before the first one and after the last one are the first and the last ones
+    Point pp0 = _controlPoints[MIN(count - 1, MAX(p - 1, 0))];
+    Point pp1 = _controlPoints[MIN(count - 1, MAX(p + 0, 0))];
+    Point pp2 = _controlPoints[MIN(count - 1, MAX(p + 1, 0))];
+    Point pp3 = _controlPoints[MIN(count - 1, MAX(p + 2, 0))];
+
+    return ccCardinalSplineAt(pp0, pp1, pp2, pp3, tension, lt);
+}
+
+void PointArray::updateArcLengths(float tension) const
+{
+    if (! _arcLengths.empty() && _arcLengthTension == tension)
+    {
+        return;
+    }
+
+    const int samples = MAX(1, ((int)_controlPoints.size() - 1) * ARC_LENGTH_SAMPLES_PER_SEGMENT);
+    _arcLengths.resize(samples + 1);
+    _arcLengthTension = tension;
+
+    float length = 0;
+    Point previous = getSplinePoint(0, tension);
+    _arcLengths[0] = 0;
+    for (int i = 1; i <= samples; ++i)
+    {
+        Point point = getSplinePoint((float)i / samples, tension);
+        length += point.getDistance(previous);
+        _arcLengths[i] = length;
+        previous = point;
+    }
+}
+
+float PointArray::getSplineLength(float tension) const
+{
+    updateArcLengths(tension);
+    return _arcLengths.back();
+}
+
+float PointArray::getSplineTimeAtLength(float fraction, float tension) const
+{
+    updateArcLengths(tension);
+
+    const float length = _arcLengths.back();
+    // the eases which overshoot leave the spline at its ends
+    if (fraction <= 0 || fraction >= 1 || length <= 0)
+    {
+        return fraction;
+    }
+
+    const float distance = fraction * length;
+    const int samples = (int)_arcLengths.size() - 1;
+    int i = (int)(std::upper_bound(_arcLengths.begin(), _arcLengths.end(), distance) - _arcLengths.begin()) - 1;
+    i = MIN(samples - 1, MAX(i, 0));
+
+    const float sampleLength = _arcLengths[i + 1] - _arcLengths[i];
+    const float t = sampleLength > 0 ? (distance - _arcLengths[i]) / sampleLength : 0;
+
+    return (i + t) / samples;
 }
 
 // CatmullRom Spline formula:
@@ -260,19 +303,14 @@ CardinalSplineTo::~CardinalSplineTo()
 
 CardinalSplineTo::CardinalSplineTo()
 : _points(NULL)
-, _deltaT(0.f)
 , _tension(0.f)
+, _constantSpeed(false)
 {
 }
 
 void CardinalSplineTo::startWithTarget(cocos2d::Node *target)
 {
     ActionInterval::startWithTarget(target);
-	
-//    _deltaT = (float) 1 / _points->count();
-    
-    // Issue #1441
-    _deltaT = (float) 1 / (_points->count() - 1);
 
     _previousPosition = target->getPosition();
     _accumulatedDiff = Point::ZERO;
@@ -280,40 +318,22 @@ void CardinalSplineTo::startWithTarget(cocos2d::Node *target)
 
 CardinalSplineTo* CardinalSplineTo::clone() const
 {
-	// no copy constructor
+	// no copy constructor. The points are shared, not copied
 	auto a = new CardinalSplineTo();
-	a->initWithDuration(this->_duration, this->_points->clone(), this->_tension);
+	a->initWithDuration(this->_duration, this->_points, this->_tension);
+	a->setConstantSpeed(_constantSpeed);
 	a->autorelease();
 	return a;
 }
 
 void CardinalSplineTo::update(float time)
 {
-    unsigned int p;
-    float lt;
-	
-	// eg.
-	// p..p..p..p..p..p..p
-	// 1..2..3..4..5..6..7
-	// want p to be 1, 2, 3, 4, 5, 6
-    if (time == 1)
-    {
-        p = _points->count() - 1;
-        lt = 1;
-    }
-    else 
+    if (_constantSpeed)
     {
-        p = time / _deltaT;
-        lt = (time - _deltaT * (float)p) / _deltaT;
+        time = _points->getSplineTimeAtLength(time, _tension);
     }
-    
-	// Interpolate    
-    Point pp0 = _points->getControlPointAtIndex(p-1);
-    Point pp1 = _points->getControlPointAtIndex(p+0);
-    Point pp2 = _points->getControlPointAtIndex(p+1);
-    Point pp3 = _points->getControlPointAtIndex(p+2);
-	
-    Point newPos = ccCardinalSplineAt(pp0, pp1, pp2, pp3, _tension, lt);
+
+    Point newPos = _points->getSplinePoint(time, _tension);
 	
 #if CC_ENABLE_STACKABLE_ACTIONS
     // Support for stacked actions
@@ -338,7 +358,9 @@ CardinalSplineTo* CardinalSplineTo::reverse() const
 {
     PointArray *pReverse = _points->reverse();
     
-    return CardinalSplineTo::create(_duration, pReverse, _tension);
+    CardinalSplineTo *a = CardinalSplineTo::create(_duration, pReverse, _tension);
+    a->setConstantSpeed(_constantSpeed);
+    return a;
 }
 
 /* CardinalSplineBy
@@ -413,7 +435,9 @@ CardinalSplineBy* CardinalSplineBy::reverse() const
         p = abs;
     }
 	
-    return CardinalSplineBy::create(_duration, pReverse, _tension);
+    CardinalSplineBy *a = CardinalSplineBy::create(_duration, pReverse, _tension);
+    a->setConstantSpeed(_constantSpeed);
+    return a;
 }
 
 void CardinalSplineBy::startWithTarget(cocos2d::Node *target)
@@ -424,9 +448,10 @@ void CardinalSplineBy::startWithTarget(cocos2d::Node *target)
 
 CardinalSplineBy* CardinalSplineBy::clone() const
 {
-	// no copy constructor
+	// no copy constructor. The points are shared, not copied
 	auto a = new CardinalSplineBy();
-	a->initWithDuration(this->_duration, this->_points->clone(), this->_tension);
+	a->initWithDuration(this->_duration, this->_points, this->_tension);
+	a->setConstantSpeed(_constantSpeed);
 	a->autorelease();
 	return a;
 }
@@ -464,9 +489,10 @@ bool CatmullRomTo::initWithDuration(float dt, cocos2d::PointArray *points)
 
 CatmullRomTo* CatmullRomTo::clone() const
 {
-	// no copy constructor
+	// no copy constructor. The points are shared, not copied
 	auto a = new CatmullRomTo();
-	a->initWithDuration(this->_duration, this->_points->clone());
+	a->initWithDuration(this->_duration, this->_points);
+	a->setConstantSpeed(_constantSpeed);
 	a->autorelease();
 	return a;
 }
@@ -474,7 +500,9 @@ CatmullRomTo* CatmullRomTo::clone() const
 CatmullRomTo* CatmullRomTo::reverse() const
 {
     PointArray *pReverse = _points->reverse();
-    return CatmullRomTo::create(_duration, pReverse);
+    CatmullRomTo *a = CatmullRomTo::create(_duration, pReverse);
+    a->setConstantSpeed(_constantSpeed);
+    return a;
 }
 
 
@@ -511,9 +539,10 @@ bool CatmullRomBy::initWithDuration(float dt, cocos2d::PointArray *points)
 
 CatmullRomBy* CatmullRomBy::clone() const
 {
-	// no copy constructor	
+	// no copy constructor. The points are shared, not copied
 	auto a = new CatmullRomBy();
-	a->initWithDuration(this->_duration, this->_points->clone());
+	a->initWithDuration(this->_duration, this->_points);
+	a->setConstantSpeed(_constantSpeed);
 	a->autorelease();
 	return a;
 }
@@ -558,7 +587,9 @@ CatmullRomBy* CatmullRomBy::reverse() const
         p = abs;
     }
 
-    return CatmullRomBy::create(_duration, pReverse);
+    CatmullRomBy *a = CatmullRomBy::create(_duration, pReverse);
+    a->setConstantSpeed(_constantSpeed);
+    return a;
 }
 
 NS_CC_END;
@@ -52,6 +52,11 @@ NS_CC_BEGIN;
 
 /** An Array that contain control points.
  Used by CardinalSplineTo and (By) and CatmullRomTo (and By) actions.
+
+ The points are stored contiguously. The actions don't copy the array: their clones share it, so the
+ points must not be changed while actions use them.
+ The array keeps an arc-length table of its spline, computed when it is first needed and shared by all the
+ actions using the array, to move along the spline at constant speed (see CardinalSplineTo::setConstantSpeed()).
 @ingroup Actions
  */
 class CC_DLL PointArray : public Object, public Clonable
@@ -76,8 +81,8 @@ public:
     /** replaces an existing controlPoint at index */
     void replaceControlPoint(Point &controlPoint, unsigned int index);
     
-    /** get the value of a controlPoint at a given index */
-    Point getControlPointAtIndex(unsigned int index);
+    /** get the value of a controlPoint at a given index. The index is clamped to the first and the last points */
+    Point getControlPointAtIndex(int index);
     
     /** deletes a control point at a given index */
     void removeControlPointAtIndex(unsigned int index);
@@ -93,12 +98,36 @@ public:
 
     virtual PointArray* clone() const;
 
-    const std::vector<Point*>* getControlPoints() const;
+    inline const std::vector<Point>& getControlPoints() const { return _controlPoints; }
+
+    void setControlPoints(const std::vector<Point>& controlPoints);
+
+    /** Returns the position on the Cardinal Spline of the control points at time (0 to 1).
+     The control points are evenly spaced in time, like in CardinalSplineTo.
+     @since v3.0
+     */
+    Point getSplinePoint(float time, float tension) const;
+
+    /** Returns the length of the Cardinal Spline of the control points, measured on its arc-length table
+     @since v3.0
+     */
+    float getSplineLength(float tension) const;
+
+    /** Returns the time of getSplinePoint() where the length of the spline from the first point is fraction of its length.
+     Changing fraction at constant speed moves along the spline at constant speed.
+     The arc-length table is computed for the last tension asked, so the actions sharing an array should use the same tension.
+     @since v3.0
+     */
+    float getSplineTimeAtLength(float fraction, float tension) const;
 
-    void setControlPoints(std::vector<Point*> *controlPoints);
 private:
+    void updateArcLengths(float tension) const;
+
     /** Array that contains the control points */
-    std::vector<Point*> *_controlPoints;
+    std::vector<Point> _controlPoints;
+    /** length of the spline from the first point at evenly spaced times, for _arcLengthTension. Empty when the points change */
+    mutable std::vector<float> _arcLengths;
+    mutable float _arcLengthTension;
 };
 
 /** Cardinal Spline path.
@@ -128,6 +157,13 @@ public:
         _points = points;
     }
 
+    /** Sets whether the target moves along the spline at constant speed, using the arc-length table of the points.
+     By default the control points are evenly spaced in time, so the speed depends on their distances.
+     @since v3.0
+     */
+    inline void setConstantSpeed(bool constantSpeed) { _constantSpeed = constantSpeed; }
+    inline bool isConstantSpeed() const { return _constantSpeed; }
+
     // Overrides
 	virtual CardinalSplineTo *clone() const override;
     virtual CardinalSplineTo* reverse() const override;
@@ -137,8 +173,8 @@ public:
 protected:
     /** Array of control points */
     PointArray *_points;
-    float _deltaT;
     float _tension;
+    bool _constantSpeed;
     Point	_previousPosition;
     Point	_accumulatedDiff;
 };
@@ -28,16 +28,14 @@ THE SOFTWARE.
  * http://github.com/NikhilK/silverlightfx/
  *
  * by http://github.com/NikhilK
+ * The curves are implemented in CCTweenEasing.cpp
  */
 
 #include "CCActionEase.h"
+#include "CCTweenEasing.h"
 
 NS_CC_BEGIN
 
-#ifndef M_PI_X_2
-#define M_PI_X_2 (float)M_PI * 2.0f
-#endif
-
 //
 // EaseAction
 //
@@ -136,7 +134,7 @@ EaseIn* EaseIn::clone() const
 
 void EaseIn::update(float time)
 {
-    _inner->update(powf(time, _rate));
+    _inner->update(tweenfunc::easeIn(time, _rate));
 }
 
 EaseIn* EaseIn::reverse() const
@@ -176,7 +174,7 @@ EaseOut* EaseOut::clone() const
 
 void EaseOut::update(float time)
 {
-    _inner->update(powf(time, 1 / _rate));
+    _inner->update(tweenfunc::easeOut(time, _rate));
 }
 
 EaseOut* EaseOut::reverse() const
@@ -216,15 +214,7 @@ EaseInOut* EaseInOut::clone() const
 
 void EaseInOut::update(float time)
 {
-    time *= 2;
-    if (time < 1)
-    {
-        _inner->update(0.5f * powf(time, _rate));
-    }
-    else
-    {
-        _inner->update(1.0f - 0.5f * powf(2-time, _rate));
-    }
+    _inner->update(tweenfunc::easeInOut(time, _rate));
 }
 
 // InOut and OutIn are symmetrical
@@ -265,7 +255,7 @@ EaseExponentialIn* EaseExponentialIn::clone() const
 
 void EaseExponentialIn::update(float time)
 {
-    _inner->update(time == 0 ? 0 : powf(2, 10 * (time/1 - 1)) - 1 * 0.001f);
+    _inner->update(tweenfunc::exponentialIn(time));
 }
 
 ActionEase * EaseExponentialIn::reverse() const
@@ -305,7 +295,7 @@ EaseExponentialOut* EaseExponentialOut::clone() const
 
 void EaseExponentialOut::update(float time)
 {
-    _inner->update(time == 1 ? 1 : (-powf(2, -10 * time / 1) + 1));
+    _inner->update(tweenfunc::exponentialOut(time));
 }
 
 ActionEase* EaseExponentialOut::reverse() const
@@ -346,17 +336,7 @@ EaseExponentialInOut* EaseExponentialInOut::clone() const
 
 void EaseExponentialInOut::update(float time)
 {
-    time /= 0.5f;
-    if (time < 1)
-    {
-        time = 0.5f * powf(2, 10 * (time - 1));
-    }
-    else
-    {
-        time = 0.5f * (-powf(2, -10 * (time - 1)) + 2);
-    }
-
-    _inner->update(time);
+    _inner->update(tweenfunc::exponentialInOut(time));
 }
 
 EaseExponentialInOut* EaseExponentialInOut::reverse() const
@@ -397,7 +377,7 @@ EaseSineIn* EaseSineIn::clone() const
 
 void EaseSineIn::update(float time)
 {
-    _inner->update(-1 * cosf(time * (float)M_PI_2) + 1);
+    _inner->update(tweenfunc::sineIn(time));
 }
 
 ActionEase* EaseSineIn::reverse() const
@@ -438,7 +418,7 @@ EaseSineOut* EaseSineOut::clone() const
 
 void EaseSineOut::update(float time)
 {
-    _inner->update(sinf(time * (float)M_PI_2));
+    _inner->update(tweenfunc::sineOut(time));
 }
 
 ActionEase* EaseSineOut::reverse(void) const
@@ -479,7 +459,7 @@ EaseSineInOut* EaseSineInOut::clone() const
 
 void EaseSineInOut::update(float time)
 {
-    _inner->update(-0.5f * (cosf((float)M_PI * time) - 1));
+    _inner->update(tweenfunc::sineInOut(time));
 }
 
 EaseSineInOut* EaseSineInOut::reverse() const
@@ -540,19 +520,7 @@ EaseElasticIn* EaseElasticIn::clone() const
 
 void EaseElasticIn::update(float time)
 {
-    float newT = 0;
-    if (time == 0 || time == 1)
-    {
-        newT = time;
-    }
-    else
-    {
-        float s = _period / 4;
-        time = time - 1;
-        newT = -powf(2, 10 * time) * sinf((time - s) * M_PI_X_2 / _period);
-    }
-
-    _inner->update(newT);
+    _inner->update(tweenfunc::elasticIn(time, _period));
 }
 
 EaseElastic* EaseElasticIn::reverse() const
@@ -598,18 +566,7 @@ EaseElasticOut* EaseElasticOut::clone() const
 
 void EaseElasticOut::update(float time)
 {
-    float newT = 0;
-    if (time == 0 || time == 1)
-    {
-        newT = time;
-    }
-    else
-    {
-        float s = _period / 4;
-        newT = powf(2, -10 * time) * sinf((time - s) * M_PI_X_2 / _period) + 1;
-    }
-
-    _inner->update(newT);
+    _inner->update(tweenfunc::elasticOut(time, _period));
 }
 
 EaseElastic* EaseElasticOut::reverse() const
@@ -655,33 +612,12 @@ EaseElasticInOut* EaseElasticInOut::clone() const
 
 void EaseElasticInOut::update(float time)
 {
-    float newT = 0;
-    if (time == 0 || time == 1)
+    if (time != 0 && time != 1 && _period == 0)
     {
-        newT = time;
-    }
-    else
-    {
-        time = time * 2;
-        if ( _period == 0)
-        {
-            _period = 0.3f * 1.5f;
-        }
-
-        float s = _period / 4;
-
-        time = time - 1;
-        if (time < 0)
-        {
-            newT = -0.5f * powf(2, 10 * time) * sinf((time -s) * M_PI_X_2 / _period);
-        }
-        else
-        {
-            newT = powf(2, -10 * time) * sinf((time - s) * M_PI_X_2 / _period) * 0.5f + 1;
-        }
+        _period = 0.3f * 1.5f;
     }
 
-    _inner->update(newT);
+    _inner->update(tweenfunc::elasticInOut(time, _period));
 }
 
 EaseElasticInOut* EaseElasticInOut::reverse() const
@@ -695,23 +631,7 @@ EaseElasticInOut* EaseElasticInOut::reverse() const
 
 float EaseBounce::bounceTime(float time)
 {
-    if (time < 1 / 2.75)
-    {
-        return 7.5625f * time * time;
-    } else 
-    if (time < 2 / 2.75)
-    {
-        time -= 1.5f / 2.75f;
-        return 7.5625f * time * time + 0.75f;
-    } else
-    if(time < 2.5 / 2.75)
-    {
-        time -= 2.25f / 2.75f;
-        return 7.5625f * time * time + 0.9375f;
-    }
-
-    time -= 2.625f / 2.75f;
-    return 7.5625f * time * time + 0.984375f;
+    return tweenfunc::bounceTime(time);
 }
 
 //
@@ -747,8 +667,7 @@ EaseBounceIn* EaseBounceIn::clone() const
 
 void EaseBounceIn::update(float time)
 {
-    float newT = 1 - bounceTime(1 - time);
-    _inner->update(newT);
+    _inner->update(tweenfunc::bounceIn(time));
 }
 
 EaseBounce* EaseBounceIn::reverse() const
@@ -789,8 +708,7 @@ EaseBounceOut* EaseBounceOut::clone() const
 
 void EaseBounceOut::update(float time)
 {
-    float newT = bounceTime(time);
-    _inner->update(newT);
+    _inner->update(tweenfunc::bounceOut(time));
 }
 
 EaseBounce* EaseBounceOut::reverse() const
@@ -831,18 +749,7 @@ EaseBounceInOut* EaseBounceInOut::clone() const
 
 void EaseBounceInOut::update(float time)
 {
-    float newT = 0;
-    if (time < 0.5f)
-    {
-        time = time * 2;
-        newT = (1 - bounceTime(1 - time)) * 0.5f;
-    }
-    else
-    {
-        newT = bounceTime(time * 2 - 1) * 0.5f + 0.5f;
-    }
-
-    _inner->update(newT);
+    _inner->update(tweenfunc::bounceInOut(time));
 }
 
 EaseBounceInOut* EaseBounceInOut::reverse() const
@@ -883,8 +790,7 @@ EaseBackIn* EaseBackIn::clone() const
 
 void EaseBackIn::update(float time)
 {
-    float overshoot = 1.70158f;
-    _inner->update(time * time * ((overshoot + 1) * time - overshoot));
+    _inner->update(tweenfunc::backIn(time));
 }
 
 ActionEase* EaseBackIn::reverse() const
@@ -925,10 +831,7 @@ EaseBackOut* EaseBackOut::clone() const
 
 void EaseBackOut::update(float time)
 {
-    float overshoot = 1.70158f;
-
-    time = time - 1;
-    _inner->update(time * time * ((overshoot + 1) * time + overshoot) + 1);
+    _inner->update(tweenfunc::backOut(time));
 }
 
 ActionEase* EaseBackOut::reverse() const
@@ -969,18 +872,7 @@ EaseBackInOut* EaseBackInOut::clone() const
 
 void EaseBackInOut::update(float time)
 {
-    float overshoot = 1.70158f * 1.525f;
-
-    time = time * 2;
-    if (time < 1)
-    {
-        _inner->update((time * time * ((overshoot + 1) * time - overshoot)) / 2);
-    }
-    else
-    {
-        time = time - 2;
-        _inner->update((time * time * ((overshoot + 1) * time + overshoot)) / 2 + 1);
-    }
+    _inner->update(tweenfunc::backInOut(time));
 }
 
 EaseBackInOut* EaseBackInOut::reverse() const
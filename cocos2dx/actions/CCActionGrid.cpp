@@ -25,6 +25,8 @@ THE SOFTWARE.
 #include "CCActionGrid.h"
 #include "CCDirector.h"
 #include "effects/CCGrid.h"
+#include "shaders/CCGLProgram.h"
+#include "shaders/CCShaderCache.h"
 
 NS_CC_BEGIN
 // implementation of GridAction
@@ -113,6 +115,25 @@ void Grid3DAction::setVertex(const Point& position, const Vertex3F& vertex)
     g->setVertex(position, vertex);
 }
 
+void Grid3DAction::setVertexEffect(const GLfloat *params, float time)
+{
+    Grid3D *g = (Grid3D*)_target->getGrid();
+    g->setVertexEffect(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_GRID_EFFECT), params);
+    _vertexEffectTime = time;
+}
+
+void Grid3DAction::stop(void)
+{
+    // bake the last state of the effect, the grid may be reused by the next action
+    Grid3D *g = (Grid3D*)_target->getGrid();
+    if (g && g->hasVertexEffect())
+    {
+        updateVertices(_vertexEffectTime);
+    }
+
+    GridAction::stop();
+}
+
 // implementation of TiledGrid3DAction
 
 GridBase* TiledGrid3DAction::getGrid(void)
@@ -192,6 +213,12 @@ void AccelDeccelAmplitude::startWithTarget(Node *target)
     _other->startWithTarget(target);
 }
 
+void AccelDeccelAmplitude::stop(void)
+{
+    _other->stop();
+    ActionInterval::stop();
+}
+
 void AccelDeccelAmplitude::update(float time)
 {
     float f = time * 2;
@@ -264,6 +291,12 @@ void AccelAmplitude::startWithTarget(Node *target)
     _other->startWithTarget(target);
 }
 
+void AccelAmplitude::stop(void)
+{
+    _other->stop();
+    ActionInterval::stop();
+}
+
 void AccelAmplitude::update(float time)
 {
     ((AccelAmplitude*)(_other))->setAmplitudeRate(powf(time, _rate));
@@ -320,6 +353,12 @@ void DeccelAmplitude::startWithTarget(Node *target)
     _other->startWithTarget(target);
 }
 
+void DeccelAmplitude::stop(void)
+{
+    _other->stop();
+    ActionInterval::stop();
+}
+
 void DeccelAmplitude::update(float time)
 {
     ((DeccelAmplitude*)(_other))->setAmplitudeRate(powf((1 - time), _rate));
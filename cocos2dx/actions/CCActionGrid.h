@@ -83,6 +83,19 @@ public:
 
     // Overrides
 	virtual Grid3DAction * clone() const override = 0;
+    virtual void stop(void) override;
+
+protected:
+    Grid3DAction() : _vertexEffectTime(0) {}
+
+    /** displaces the vertices of the grid in the vertex shader, see Grid3D::setVertexEffect().
+     The vertices are only moved on the CPU, with updateVertices(), when the action stops.
+     */
+    void setVertexEffect(const GLfloat *params, float time);
+    /** moves the vertices of the grid on the CPU to their state at the given time */
+    virtual void updateVertices(float time) { CC_UNUSED_PARAM(time); }
+
+    float _vertexEffectTime;
 };
 
 /** @brief Base class for TiledGrid3D actions */
@@ -137,6 +150,7 @@ public:
 
     // Overrides
     virtual void startWithTarget(Node *target) override;
+    virtual void stop(void) override;
     virtual void update(float time) override;
 
 protected:
@@ -163,6 +177,7 @@ public:
 
     // Overrides
     virtual void startWithTarget(Node *target) override;
+    virtual void stop(void) override;
     virtual void update(float time) override;
 	virtual AccelAmplitude* clone() const override;
 	virtual AccelAmplitude* reverse() const override;
@@ -190,6 +205,7 @@ public:
 
     // overrides
     virtual void startWithTarget(Node *target) override;
+    virtual void stop(void) override;
     virtual void update(float time) override;
 	virtual DeccelAmplitude* clone() const;
 	virtual DeccelAmplitude* reverse() const;
@@ -24,6 +24,7 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "CCActionGrid3D.h"
 #include "CCDirector.h"
+#include "effects/CCGrid.h"
 #include <stdlib.h>
 
 NS_CC_BEGIN
@@ -72,6 +73,15 @@ Waves3D* Waves3D::clone() const
 }
 
 void Waves3D::update(float time)
+{
+    GLfloat params[8] = {
+        0, (float)M_PI * time * _waves * 2, _amplitude * _amplitudeRate, 0,
+        0, 0, 0, 0
+    };
+    setVertexEffect(params, time);
+}
+
+void Waves3D::updateVertices(float time)
 {
     int i, j;
     for (i = 0; i < _gridSize.width + 1; ++i)
@@ -445,6 +455,15 @@ Ripple3D* Ripple3D::clone() const
 }
 
 void Ripple3D::update(float time)
+{
+    GLfloat params[8] = {
+        1, time * (float)M_PI * _waves * 2, _amplitude * _amplitudeRate, _radius,
+        _position.x, _position.y, 0, 0
+    };
+    setVertexEffect(params, time);
+}
+
+void Ripple3D::updateVertices(float time)
 {
     int i, j;
 
@@ -512,6 +531,16 @@ Shaky3D* Shaky3D::clone() const
 }
 
 void Shaky3D::update(float time)
+{
+    // a new seed shakes the vertices again each frame
+    GLfloat params[8] = {
+        2, 0, 0, (float)(rand() % 1024),
+        (float)_randrange, _shakeZ ? 1.0f : 0.0f, 0, 0
+    };
+    setVertexEffect(params, time);
+}
+
+void Shaky3D::updateVertices(float time)
 {
     CC_UNUSED_PARAM(time);
     int i, j;
@@ -578,6 +607,17 @@ Liquid* Liquid::clone() const
 }
 
 void Liquid::update(float time)
+{
+    // the vertices of the border are recognized by their original position
+    const Point& step = _target->getGrid()->getStep();
+    GLfloat params[8] = {
+        3, time * (float)M_PI * _waves * 2, _amplitude * _amplitudeRate, 0,
+        _gridSize.width * step.x, _gridSize.height * step.y, step.x, step.y
+    };
+    setVertexEffect(params, time);
+}
+
+void Liquid::updateVertices(float time)
 {
     int i, j;
 
@@ -640,6 +680,15 @@ Waves* Waves::clone() const
 }
 
 void Waves::update(float time)
+{
+    GLfloat params[8] = {
+        4, time * (float)M_PI * _waves * 2, _amplitude * _amplitudeRate, 0,
+        _vertical ? 1.0f : 0.0f, _horizontal ? 1.0f : 0.0f, 0, 0
+    };
+    setVertexEffect(params, time);
+}
+
+void Waves::updateVertices(float time)
 {
     int i, j;
 
@@ -61,6 +61,8 @@ public:
     virtual void update(float time) override;
 
 protected:
+    virtual void updateVertices(float time) override;
+
     unsigned int _waves;
     float _amplitude;
     float _amplitudeRate;
@@ -156,6 +158,8 @@ public:
     virtual void update(float time) override;
 
 protected:
+    virtual void updateVertices(float time) override;
+
     /* center position */
     Point _position;
     float _radius;
@@ -179,6 +183,8 @@ public:
     virtual void update(float time) override;
 
 protected:
+    virtual void updateVertices(float time) override;
+
     int _randrange;
     bool _shakeZ;
 };
@@ -204,6 +210,8 @@ public:
     virtual void update(float time) override;
 
 protected:
+    virtual void updateVertices(float time) override;
+
     unsigned int _waves;
     float _amplitude;
     float _amplitudeRate;
@@ -230,6 +238,8 @@ public:
     virtual void update(float time) override;
 
 protected:
+    virtual void updateVertices(float time) override;
+
     unsigned int _waves;
     float _amplitude;
     float _amplitudeRate;
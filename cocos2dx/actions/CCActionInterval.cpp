@@ -2099,23 +2099,19 @@ void Animate::update(float t)
         t = fmodf(t, 1.0f);
     }
 
-    Array* frames = _animation->getFrames();
-    unsigned int numberOfFrames = frames->count();
-    SpriteFrame *frameToDisplay = NULL;
+    const std::vector<AnimationFlipbookFrame>& flipbook = _animation->getFlipbook();
+    int numberOfFrames = (int)flipbook.size();
+    int frameToDisplay = -1;
 
     for( int i=_nextFrame; i < numberOfFrames; i++ ) {
         float splitTime = _splitTimes->at(i);
 
         if( splitTime <= t ) {
-            AnimationFrame* frame = static_cast<AnimationFrame*>(frames->objectAtIndex(i));
-            frameToDisplay = frame->getSpriteFrame();
-            static_cast<Sprite*>(_target)->setDisplayFrame(frameToDisplay);
-
-            Dictionary* dict = frame->getUserInfo();
-            if( dict )
+            if( flipbook[i].hasUserInfo )
             {
                 //TODO: [[NSNotificationCenter defaultCenter] postNotificationName:AnimationFrameDisplayedNotification object:target_ userInfo:dict];
             }
+            frameToDisplay = i;
             _nextFrame = i+1;
         }
         // Issue 1438. Could be more than one frame per tick, due to low frame rate or frame delta < 1/FPS
@@ -2123,6 +2119,11 @@ void Animate::update(float t)
             break;
         }
     }
+
+    // only the last of the frames due in this tick is visible
+    if( frameToDisplay >= 0 ) {
+        static_cast<Sprite*>(_target)->setFlipbookFrame(flipbook[frameToDisplay]);
+    }
 }
 
 Animate* Animate::reverse() const
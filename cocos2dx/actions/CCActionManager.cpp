@@ -26,32 +26,98 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "CCActionManager.h"
+#include "CCActionTemplate.h"
 #include "base_nodes/CCNode.h"
 #include "CCScheduler.h"
+#include "CCDirector.h"
 #include "ccMacros.h"
-#include "support/data_support/ccCArray.h"
-#include "support/data_support/uthash.h"
 #include "cocoa/CCSet.h"
+#include "CCProtocols.h"
+#include <algorithm>
+#include <float.h>
 
 NS_CC_BEGIN
-//
-// singleton stuff
-//
-typedef struct _hashElement
-{
-    struct _ccArray             *actions;
-    Object                    *target;
-    unsigned int                actionIndex;
-    Action                    *currentAction;
-    bool                        currentActionSalvaged;
-    bool                        paused;
-    UT_hash_handle                hh;
-} tHashElement;
+
+// number of removed entries kept in the arrays before they are compacted
+#define ACTION_MANAGER_MAX_TOMBSTONES 64
+
+// the values of a tweened property. rgba is the target, for the opacity
+static void getTweenValues(Node *target, RGBAProtocol *rgba, ActionManager::TweenProperty property, float values[2])
+{
+    switch (property)
+    {
+    case ActionManager::TweenProperty::POSITION:
+        values[0] = target->getPositionX();
+        values[1] = target->getPositionY();
+        break;
+    case ActionManager::TweenProperty::SCALE:
+        values[0] = target->getScaleX();
+        values[1] = target->getScaleY();
+        break;
+    case ActionManager::TweenProperty::ROTATION:
+        values[0] = target->getRotationX();
+        values[1] = target->getRotationY();
+        break;
+    case ActionManager::TweenProperty::OPACITY:
+        values[0] = rgba->getOpacity();
+        values[1] = 0;
+        break;
+    }
+}
+
+static void setTweenValues(Node *target, RGBAProtocol *rgba, ActionManager::TweenProperty property, float x, float y)
+{
+    switch (property)
+    {
+    case ActionManager::TweenProperty::POSITION:
+        target->setPosition(Point(x, y));
+        break;
+    case ActionManager::TweenProperty::SCALE:
+        target->setScaleX(x);
+        target->setScaleY(y);
+        break;
+    case ActionManager::TweenProperty::ROTATION:
+        target->setRotationX(x);
+        target->setRotationY(y);
+        break;
+    case ActionManager::TweenProperty::OPACITY:
+        rgba->setOpacity((GLubyte)x);
+        break;
+    }
+}
+
+// the deltas from the values to (x, y). The rotations take the shortest way, like RotateTo
+static void getTweenDeltas(ActionManager::TweenProperty property, float x, float y, float from[2], float delta[2])
+{
+    delta[0] = x - from[0];
+    delta[1] = y - from[1];
+
+    if (property == ActionManager::TweenProperty::ROTATION)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            from[i] = fmodf(from[i], from[i] > 0 ? 360.0f : -360.0f);
+            delta[i] = (i == 0 ? x : y) - from[i];
+            if (delta[i] > 180)
+            {
+                delta[i] -= 360;
+            }
+            if (delta[i] < -180)
+            {
+                delta[i] += 360;
+            }
+        }
+    }
+}
 
 ActionManager::ActionManager(void)
-: _targets(NULL), 
-  _currentTarget(NULL),
-  _currentTargetSalvaged(false)
+: _actionTombstones(0)
+, _targetTombstones(0)
+, _tweenTombstones(0)
+, _templateTombstones(0)
+, _currentAction(NULL)
+, _currentActionSalvaged(false)
+, _updating(false)
 {
 
 }
@@ -65,78 +131,217 @@ ActionManager::~ActionManager(void)
 
 // private
 
-void ActionManager::deleteHashElement(tHashElement *pElement)
+void ActionManager::removeActionAtIndex(unsigned int position, unsigned int targetIndex)
+{
+    ActionTarget& element = _targets[targetIndex];
+    unsigned int index = element.actions[position];
+    Action *pAction = _actions[index].action;
+
+    element.actions.erase(element.actions.begin() + position);
+    _actions[index].action = NULL;
+    ++_actionTombstones;
+
+    if (pAction == _currentAction && (! _currentActionSalvaged))
+    {
+        // The action is being stepped: update() releases it once step is done
+        _currentActionSalvaged = true;
+    }
+    else
+    {
+        pAction->release();
+    }
+
+    removeTargetIfUnused(targetIndex);
+}
+
+void ActionManager::removeTargetIfUnused(unsigned int targetIndex)
 {
-    ccArrayFree(pElement->actions);
-    HASH_DEL(_targets, pElement);
-    pElement->target->release();
-    free(pElement);
+    ActionTarget& element = _targets[targetIndex];
+    if (! element.actions.empty() || element.templates > 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < TWEEN_PROPERTY_COUNT; ++i)
+    {
+        if (element.tweens[i] >= 0)
+        {
+            return;
+        }
+    }
+
+    removeTarget(targetIndex);
 }
 
-void ActionManager::actionAllocWithHashElement(tHashElement *pElement)
+unsigned int ActionManager::getTargetIndex(Node *target, bool paused)
 {
-    // 4 actions per Node by default
-    if (pElement->actions == NULL)
+    // we should convert it to Object*, because we save it as Object*
+    Object *tmp = target;
+    auto it = _targetIndices.find(tmp);
+    if (it != _targetIndices.end())
     {
-        pElement->actions = ccArrayNew(4);
-    }else 
-    if (pElement->actions->num == pElement->actions->max)
+        return it->second;
+    }
+
+    unsigned int targetIndex = _targets.size();
+    ActionTarget element;
+    element.target = tmp;
+    element.paused = paused;
+    std::fill(element.tweens, element.tweens + TWEEN_PROPERTY_COUNT, -1);
+    element.templates = 0;
+    _targets.push_back(std::move(element));
+    _targetIndices[tmp] = targetIndex;
+    target->retain();
+
+    return targetIndex;
+}
+
+void ActionManager::removeTweenAtIndex(TweenProperty property, unsigned int index)
+{
+    Tween& tween = _tweens[(int)property][index];
+    _targets[tween.targetIndex].tweens[(int)property] = -1;
+    tween.target = NULL;
+    ++_tweenTombstones;
+
+    removeTargetIfUnused(tween.targetIndex);
+}
+
+void ActionManager::compactTweens()
+{
+    CCASSERT(! _updating, "The tweens can't be compacted while they are being updated");
+
+    for (int property = 0; property < TWEEN_PROPERTY_COUNT; ++property)
     {
-        ccArrayDoubleCapacity(pElement->actions);
+        std::vector<Tween>& tweens = _tweens[property];
+        unsigned int count = 0;
+        for (unsigned int i = 0; i < tweens.size(); ++i)
+        {
+            if (tweens[i].target != NULL)
+            {
+                tweens[count] = tweens[i];
+                _targets[tweens[count].targetIndex].tweens[property] = count;
+                ++count;
+            }
+        }
+        tweens.resize(count);
     }
 
+    _tweenTombstones = 0;
+}
+
+void ActionManager::removeTarget(unsigned int targetIndex)
+{
+    ActionTarget& element = _targets[targetIndex];
+    Object *target = element.target;
+
+    element.target = NULL;
+    element.actions.clear();
+    _targetIndices.erase(target);
+    ++_targetTombstones;
+
+    if (_updating)
+    {
+        // the target may be the one of the action being stepped
+        _targetsToRelease.push_back(target);
+    }
+    else
+    {
+        target->release();
+    }
 }
 
-void ActionManager::removeActionAtIndex(unsigned int uIndex, tHashElement *pElement)
+void ActionManager::compact()
 {
-    Action *pAction = (Action*)pElement->actions->arr[uIndex];
+    if (! _updating && _tweenTombstones > ACTION_MANAGER_MAX_TOMBSTONES)
+    {
+        compactTweens();
+    }
 
-    if (pAction == pElement->currentAction && (! pElement->currentActionSalvaged))
+    if (! _updating && _templateTombstones > ACTION_MANAGER_MAX_TOMBSTONES)
     {
-        pElement->currentAction->retain();
-        pElement->currentActionSalvaged = true;
+        compactTemplates();
     }
 
-    ccArrayRemoveObjectAtIndex(pElement->actions, uIndex, true);
+    if (_updating || (_actionTombstones <= ACTION_MANAGER_MAX_TOMBSTONES && _targetTombstones <= ACTION_MANAGER_MAX_TOMBSTONES))
+    {
+        return;
+    }
 
-    // update actionIndex in case we are in tick. looping over the actions
-    if (pElement->actionIndex >= uIndex)
+    std::vector<unsigned int> newIndices(_actions.size());
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < _actions.size(); ++i)
     {
-        pElement->actionIndex--;
+        if (_actions[i].action != NULL)
+        {
+            newIndices[i] = count;
+            _actions[count++] = _actions[i];
+        }
     }
+    _actions.resize(count);
 
-    if (pElement->actions->num == 0)
+    std::vector<unsigned int> newTargetIndices(_targets.size());
+    count = 0;
+    for (unsigned int i = 0; i < _targets.size(); ++i)
     {
-        if (_currentTarget == pElement)
+        if (_targets[i].target == NULL)
         {
-            _currentTargetSalvaged = true;
+            continue;
         }
-        else
+
+        newTargetIndices[i] = count;
+
+        if (i != count)
         {
-            deleteHashElement(pElement);
+            _targets[count] = std::move(_targets[i]);
+            _targetIndices[_targets[count].target] = count;
+        }
+
+        std::vector<unsigned int>& actions = _targets[count].actions;
+        for (auto it = actions.begin(); it != actions.end(); ++it)
+        {
+            *it = newIndices[*it];
+            _actions[*it].target = count;
+        }
+        for (int property = 0; property < TWEEN_PROPERTY_COUNT; ++property)
+        {
+            if (_targets[count].tweens[property] >= 0)
+            {
+                _tweens[property][_targets[count].tweens[property]].targetIndex = count;
+            }
+        }
+        ++count;
+    }
+    _targets.erase(_targets.begin() + count, _targets.end());
+
+    for (auto it = _templates.begin(); it != _templates.end(); ++it)
+    {
+        if (it->actionTemplate != NULL)
+        {
+            it->targetIndex = newTargetIndices[it->targetIndex];
         }
     }
+
+    _actionTombstones = 0;
+    _targetTombstones = 0;
 }
 
 // pause / resume
 
 void ActionManager::pauseTarget(Object *target)
 {
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(_targets, &target, pElement);
-    if (pElement)
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
     {
-        pElement->paused = true;
+        _targets[it->second].paused = true;
     }
 }
 
 void ActionManager::resumeTarget(Object *target)
 {
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(_targets, &target, pElement);
-    if (pElement)
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
     {
-        pElement->paused = false;
+        _targets[it->second].paused = false;
     }
 }
 
@@ -145,12 +350,12 @@ Set* ActionManager::pauseAllRunningActions()
     Set *idsWithActions = new Set();
     idsWithActions->autorelease();
     
-    for (tHashElement *element=_targets; element != NULL; element = (tHashElement *)element->hh.next) 
+    for (auto it = _targets.begin(); it != _targets.end(); ++it)
     {
-        if (! element->paused) 
+        if (it->target != NULL && ! it->paused)
         {
-            element->paused = true;
-            idsWithActions->addObject(element->target);
+            it->paused = true;
+            idsWithActions->addObject(it->target);
         }
     }    
     
@@ -173,36 +378,36 @@ void ActionManager::addAction(Action *pAction, Node *target, bool paused)
     CCASSERT(pAction != NULL, "");
     CCASSERT(target != NULL, "");
 
-    tHashElement *pElement = NULL;
-    // we should convert it to Object*, because we save it as Object*
-    Object *tmp = target;
-    HASH_FIND_INT(_targets, &tmp, pElement);
-    if (! pElement)
-    {
-        pElement = (tHashElement*)calloc(sizeof(*pElement), 1);
-        pElement->paused = paused;
-        target->retain();
-        pElement->target = target;
-        HASH_ADD_INT(_targets, target, pElement);
-    }
+    unsigned int targetIndex = getTargetIndex(target, paused);
+    ActionTarget& element = _targets[targetIndex];
+    CCASSERT(std::find_if(element.actions.begin(), element.actions.end(),
+                          [&](unsigned int index) { return _actions[index].action == pAction; }) == element.actions.end(), "");
 
-     actionAllocWithHashElement(pElement);
- 
-     CCASSERT(! ccArrayContainsObject(pElement->actions, pAction), "");
-     ccArrayAppendObject(pElement->actions, pAction);
- 
-     pAction->startWithTarget(target);
+    element.actions.push_back(_actions.size());
+    ActionEntry entry = { pAction, targetIndex };
+    _actions.push_back(entry);
+    pAction->retain();
+
+    pAction->startWithTarget(target);
 }
 
 // remove
 
 void ActionManager::removeAllActions(void)
 {
-    for (tHashElement *pElement = _targets; pElement != NULL; )
+    std::vector<Object*> targets;
+    targets.reserve(_targetIndices.size());
+    for (auto it = _targets.begin(); it != _targets.end(); ++it)
+    {
+        if (it->target != NULL)
+        {
+            targets.push_back(it->target);
+        }
+    }
+
+    for (auto it = targets.begin(); it != targets.end(); ++it)
     {
-        Object *target = pElement->target;
-        pElement = (tHashElement*)pElement->hh.next;
-        removeAllActionsFromTarget(target);
+        removeAllActionsFromTarget(*it);
     }
 }
 
@@ -214,25 +419,57 @@ void ActionManager::removeAllActionsFromTarget(Object *target)
         return;
     }
 
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(_targets, &target, pElement);
-    if (pElement)
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
     {
-        if (ccArrayContainsObject(pElement->actions, pElement->currentAction) && (! pElement->currentActionSalvaged))
+        unsigned int targetIndex = it->second;
+        std::vector<unsigned int> actions;
+        actions.swap(_targets[targetIndex].actions);
+
+        int *tweens = _targets[targetIndex].tweens;
+        for (int property = 0; property < TWEEN_PROPERTY_COUNT; ++property)
         {
-            pElement->currentAction->retain();
-            pElement->currentActionSalvaged = true;
+            if (tweens[property] >= 0)
+            {
+                _tweens[property][tweens[property]].target = NULL;
+                ++_tweenTombstones;
+                tweens[property] = -1;
+            }
         }
 
-        ccArrayRemoveAllObjects(pElement->actions);
-        if (_currentTarget == pElement)
+        if (_targets[targetIndex].templates > 0)
         {
-            _currentTargetSalvaged = true;
+            for (auto instance = _templates.begin(); instance != _templates.end(); ++instance)
+            {
+                if (instance->actionTemplate != NULL && instance->targetIndex == targetIndex)
+                {
+                    // the template being updated is retained by updateTemplates()
+                    instance->actionTemplate->release();
+                    instance->actionTemplate = NULL;
+                    ++_templateTombstones;
+                }
+            }
+            _targets[targetIndex].templates = 0;
         }
-        else
+
+        for (auto index = actions.begin(); index != actions.end(); ++index)
         {
-            deleteHashElement(pElement);
+            Action *pAction = _actions[*index].action;
+            _actions[*index].action = NULL;
+            ++_actionTombstones;
+
+            if (pAction == _currentAction && (! _currentActionSalvaged))
+            {
+                _currentActionSalvaged = true;
+            }
+            else
+            {
+                pAction->release();
+            }
         }
+
+        removeTarget(targetIndex);
+        compact();
     }
     else
     {
@@ -248,15 +485,19 @@ void ActionManager::removeAction(Action *pAction)
         return;
     }
 
-    tHashElement *pElement = NULL;
     Object *target = pAction->getOriginalTarget();
-    HASH_FIND_INT(_targets, &target, pElement);
-    if (pElement)
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
     {
-        unsigned int i = ccArrayGetIndexOfObject(pElement->actions, pAction);
-        if (UINT_MAX != i)
+        const std::vector<unsigned int>& actions = _targets[it->second].actions;
+        for (unsigned int i = 0; i < actions.size(); ++i)
         {
-            removeActionAtIndex(i, pElement);
+            if (_actions[actions[i]].action == pAction)
+            {
+                removeActionAtIndex(i, it->second);
+                compact();
+                break;
+            }
         }
     }
     else
@@ -270,50 +511,409 @@ void ActionManager::removeActionByTag(unsigned int tag, Object *target)
     CCASSERT((int)tag != kActionTagInvalid, "");
     CCASSERT(target != NULL, "");
 
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(_targets, &target, pElement);
-
-    if (pElement)
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
     {
-        unsigned int limit = pElement->actions->num;
-        for (unsigned int i = 0; i < limit; ++i)
+        const std::vector<unsigned int>& actions = _targets[it->second].actions;
+        for (unsigned int i = 0; i < actions.size(); ++i)
         {
-            Action *pAction = (Action*)pElement->actions->arr[i];
+            Action *pAction = _actions[actions[i]].action;
 
             if (pAction->getTag() == (int)tag && pAction->getOriginalTarget() == target)
             {
-                removeActionAtIndex(i, pElement);
+                removeActionAtIndex(i, it->second);
+                compact();
                 break;
             }
         }
     }
 }
 
-// get
+// tweens
 
-// XXX: Passing "const O *" instead of "const O&" because HASH_FIND_IT requries the address of a pointer
-// and, it is not possible to get the address of a reference
-Action* ActionManager::getActionByTag(unsigned int tag, const Object *target) const
+void ActionManager::addTween(Node *target, TweenProperty property, float duration, float x, float y, tweenfunc::Easing easing, float easingParam)
 {
-    CCASSERT((int)tag != kActionTagInvalid, "");
+    CCASSERT(target != NULL, "");
+
+    Tween tween;
+    tween.target = target;
+    tween.rgba = NULL;
+    tween.elapsed = 0;
+    tween.duration = duration;
+    tween.easingParam = easingParam;
+    tween.easing = easing;
+    tween.firstTick = true;
+
+    if (property == TweenProperty::OPACITY)
+    {
+        tween.rgba = dynamic_cast<RGBAProtocol*>(target);
+        CCASSERT(tween.rgba != NULL, "Only the targets implementing RGBAProtocol can tween their opacity");
+        if (tween.rgba == NULL)
+        {
+            return;
+        }
+        y = 0;
+    }
+
+    getTweenValues(target, tween.rgba, property, tween.from);
+    getTweenDeltas(property, x, y, tween.from, tween.delta);
+
+    // same as Node::runAction()
+    tween.targetIndex = getTargetIndex(target, ! target->isRunning());
+    int *tweens = _targets[tween.targetIndex].tweens;
+    std::vector<Tween>& pool = _tweens[(int)property];
 
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(_targets, &target, pElement);
+    if (tweens[(int)property] >= 0)
+    {
+        pool[tweens[(int)property]].target = NULL;
+        ++_tweenTombstones;
+    }
 
-    if (pElement)
+    tweens[(int)property] = pool.size();
+    pool.push_back(tween);
+    compact();
+}
+
+void ActionManager::removeTween(Object *target, TweenProperty property)
+{
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
     {
-        if (pElement->actions != NULL)
+        int index = _targets[it->second].tweens[(int)property];
+        if (index >= 0)
         {
-            unsigned int limit = pElement->actions->num;
-            for (unsigned int i = 0; i < limit; ++i)
+            removeTweenAtIndex(property, index);
+            compact();
+        }
+    }
+}
+
+unsigned int ActionManager::getNumberOfRunningTweensInTarget(const Object *target) const
+{
+    unsigned int count = 0;
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
+    {
+        for (int property = 0; property < TWEEN_PROPERTY_COUNT; ++property)
+        {
+            if (_targets[it->second].tweens[property] >= 0)
             {
-                Action *pAction = (Action*)pElement->actions->arr[i];
+                ++count;
+            }
+        }
+    }
 
-                if (pAction->getTag() == (int)tag)
+    return count;
+}
+
+unsigned int ActionManager::getNumberOfRunningTweens() const
+{
+    size_t count = 0;
+    for (int property = 0; property < TWEEN_PROPERTY_COUNT; ++property)
+    {
+        count += _tweens[property].size();
+    }
+
+    return (unsigned int)count - _tweenTombstones;
+}
+
+void ActionManager::updateTweens(TweenProperty property, float dt)
+{
+    std::vector<Tween>& tweens = _tweens[(int)property];
+
+    // same as the actions: the tweens added meanwhile are updated from the next frame
+    unsigned int count = tweens.size();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Tween& tween = tweens[i];
+        if (tween.target == NULL || _targets[tween.targetIndex].paused)
+        {
+            continue;
+        }
+
+        // same as ActionInterval::step()
+        if (tween.firstTick)
+        {
+            tween.firstTick = false;
+        }
+        else
+        {
+            tween.elapsed += dt;
+        }
+
+        float time = tweenfunc::ease(tween.easing, MAX(0, MIN(1, tween.elapsed / MAX(tween.duration, FLT_EPSILON))), tween.easingParam);
+        float x = tween.from[0] + tween.delta[0] * time;
+        float y = tween.from[1] + tween.delta[1] * time;
+        Node *target = tween.target;
+        RGBAProtocol *rgba = tween.rgba;
+
+        // the tween is removed before the property is set, so that the setter can start a new one.
+        // The target is not released before the end of update()
+        if (tween.elapsed >= tween.duration)
+        {
+            removeTweenAtIndex(property, i);
+        }
+
+        setTweenValues(target, rgba, property, x, y);
+    }
+}
+
+// templates
+
+void ActionManager::addTemplate(ActionTemplate *actionTemplate, Node *target)
+{
+    CCASSERT(actionTemplate != NULL, "");
+    CCASSERT(target != NULL, "");
+    CCASSERT(actionTemplate->getRepeatCount() != ActionTemplate::REPEAT_FOREVER || actionTemplate->getDuration() > 0,
+             "A template repeated forever must last more than 0 seconds");
+
+    TemplateInstance instance;
+    instance.actionTemplate = actionTemplate;
+    instance.target = target;
+    instance.rgba = dynamic_cast<RGBAProtocol*>(target);
+    instance.values = _templateValues.size();
+    instance.startedSteps = 0;
+    instance.loops = 0;
+    instance.elapsed = 0;
+    instance.firstTick = true;
+
+    // same as Node::runAction()
+    instance.targetIndex = getTargetIndex(target, ! target->isRunning());
+    ++_targets[instance.targetIndex].templates;
+
+    // the steps are shared by all the instances from now on
+    actionTemplate->_locked = true;
+    actionTemplate->retain();
+
+    _templateValues.resize(_templateValues.size() + actionTemplate->getStepCount() * 4);
+    _templates.push_back(instance);
+    compact();
+}
+
+void ActionManager::removeTemplate(Object *target, ActionTemplate *actionTemplate)
+{
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end() && _targets[it->second].templates > 0)
+    {
+        unsigned int targetIndex = it->second;
+        for (unsigned int i = 0; i < _templates.size(); ++i)
+        {
+            if (_templates[i].actionTemplate == actionTemplate && _templates[i].targetIndex == targetIndex)
+            {
+                removeTemplateAtIndex(i);
+            }
+        }
+        compact();
+    }
+}
+
+unsigned int ActionManager::getNumberOfRunningTemplatesInTarget(const Object *target) const
+{
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
+    {
+        return _targets[it->second].templates;
+    }
+
+    return 0;
+}
+
+unsigned int ActionManager::getNumberOfRunningTemplates() const
+{
+    return (unsigned int)_templates.size() - _templateTombstones;
+}
+
+void ActionManager::removeTemplateAtIndex(unsigned int index)
+{
+    TemplateInstance& instance = _templates[index];
+    ActionTemplate *actionTemplate = instance.actionTemplate;
+    instance.actionTemplate = NULL;
+    ++_templateTombstones;
+    --_targets[instance.targetIndex].templates;
+
+    // the template being updated is retained by updateTemplates()
+    actionTemplate->release();
+
+    removeTargetIfUnused(instance.targetIndex);
+}
+
+void ActionManager::compactTemplates()
+{
+    CCASSERT(! _updating, "The templates can't be compacted while they are being updated");
+
+    unsigned int count = 0;
+    unsigned int valueCount = 0;
+    for (unsigned int i = 0; i < _templates.size(); ++i)
+    {
+        if (_templates[i].actionTemplate == NULL)
+        {
+            continue;
+        }
+
+        TemplateInstance instance = _templates[i];
+        unsigned int size = instance.actionTemplate->getStepCount() * 4;
+        // the values only move towards the beginning of the array
+        std::copy(_templateValues.begin() + instance.values, _templateValues.begin() + instance.values + size,
+                  _templateValues.begin() + valueCount);
+        instance.values = valueCount;
+        valueCount += size;
+        _templates[count++] = instance;
+    }
+    _templates.resize(count);
+    _templateValues.resize(valueCount);
+
+    _templateTombstones = 0;
+}
+
+bool ActionManager::applyTemplate(unsigned int index, float previous, float time)
+{
+    ActionTemplate *actionTemplate = _templates[index].actionTemplate;
+    const std::vector<ActionTemplate::Step>& steps = actionTemplate->_steps;
+
+    for (unsigned int i = 0; i < steps.size(); ++i)
+    {
+        const ActionTemplate::Step& step = steps[i];
+        if (step.start > time)
+        {
+            // the steps are sorted by start time
+            break;
+        }
+
+        // the setters and the functions may add templates: the arrays are indexed again after calling them
+        TemplateInstance& instance = _templates[index];
+        Node *target = instance.target;
+        RGBAProtocol *rgba = instance.rgba;
+        bool starting = i >= instance.startedSteps;
+
+        if (starting)
+        {
+            instance.startedSteps = i + 1;
+        }
+        else if (step.start + step.duration < previous)
+        {
+            // completed by a previous update
+            continue;
+        }
+
+        if (step.callback >= 0)
+        {
+            if (starting)
+            {
+                actionTemplate->_callbacks[step.callback](target);
+            }
+        }
+        else if (step.property == TweenProperty::OPACITY && rgba == NULL)
+        {
+            CCASSERT(false, "Only the targets implementing RGBAProtocol can tween their opacity");
+        }
+        else
+        {
+            float *values = &_templateValues[instance.values + i * 4];
+            if (starting)
+            {
+                // like the actions, the steps read the values of the target when they start
+                getTweenValues(target, rgba, step.property, values);
+                if (step.relative)
+                {
+                    values[2] = step.values[0];
+                    values[3] = step.values[1];
+                }
+                else
                 {
-                    return pAction;
+                    getTweenDeltas(step.property, step.values[0], step.values[1], values, values + 2);
                 }
             }
+
+            float t = tweenfunc::ease(step.easing, MAX(0, MIN(1, (time - step.start) / MAX(step.duration, FLT_EPSILON))), step.easingParam);
+            setTweenValues(target, rgba, step.property, values[0] + values[2] * t, values[1] + values[3] * t);
+        }
+
+        if (_templates[index].actionTemplate == NULL)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ActionManager::updateTemplates(float dt)
+{
+    // same as the actions: the templates added meanwhile are updated from the next frame
+    unsigned int count = _templates.size();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        TemplateInstance& instance = _templates[i];
+        if (instance.actionTemplate == NULL || _targets[instance.targetIndex].paused)
+        {
+            continue;
+        }
+
+        float previous = instance.elapsed;
+        // same as ActionInterval::step()
+        if (instance.firstTick)
+        {
+            instance.firstTick = false;
+        }
+        else
+        {
+            instance.elapsed += dt;
+        }
+
+        // a step may remove the instance, releasing the template
+        ActionTemplate *actionTemplate = instance.actionTemplate;
+        actionTemplate->retain();
+
+        const float duration = actionTemplate->getDuration();
+        for (;;)
+        {
+            if (_templates[i].elapsed < duration)
+            {
+                applyTemplate(i, previous, _templates[i].elapsed);
+                break;
+            }
+
+            // the loop ends: its remaining steps are completed
+            if (! applyTemplate(i, previous, duration))
+            {
+                break;
+            }
+
+            TemplateInstance& done = _templates[i];
+            if (++done.loops >= actionTemplate->getRepeatCount())
+            {
+                removeTemplateAtIndex(i);
+                break;
+            }
+
+            // like Repeat, the next loop starts its steps again, and they read the values of the target again
+            done.elapsed -= duration;
+            done.startedSteps = 0;
+            previous = 0;
+        }
+
+        actionTemplate->release();
+    }
+}
+
+// get
+
+Action* ActionManager::getActionByTag(unsigned int tag, const Object *target) const
+{
+    CCASSERT((int)tag != kActionTagInvalid, "");
+
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
+    {
+        const std::vector<unsigned int>& actions = _targets[it->second].actions;
+        for (auto index = actions.begin(); index != actions.end(); ++index)
+        {
+            Action *pAction = _actions[*index].action;
+
+            if (pAction->getTag() == (int)tag)
+            {
+                return pAction;
+            }
         }
         CCLOG("cocos2d : getActionByTag(tag = %d): Action not found", tag);
     }
@@ -325,78 +925,95 @@ Action* ActionManager::getActionByTag(unsigned int tag, const Object *target) co
     return NULL;
 }
 
-// XXX: Passing "const O *" instead of "const O&" because HASH_FIND_IT requries the address of a pointer
-// and, it is not possible to get the address of a reference
 unsigned int ActionManager::getNumberOfRunningActionsInTarget(const Object *target) const
 {
-    tHashElement *pElement = NULL;
-    HASH_FIND_INT(_targets, &target, pElement);
-    if (pElement)
+    auto it = _targetIndices.find(target);
+    if (it != _targetIndices.end())
     {
-        return pElement->actions ? pElement->actions->num : 0;
+        return _targets[it->second].actions.size();
     }
 
     return 0;
 }
 
+unsigned int ActionManager::getNumberOfRunningActions() const
+{
+    return (unsigned int)_actions.size() - _actionTombstones;
+}
+
 // main loop
 void ActionManager::update(float dt)
 {
-    for (tHashElement *elt = _targets; elt != NULL; )
-    {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+    _updating = true;
 
-        if (! _currentTarget->paused)
+    // The actions added while stepping are stepped from the next frame.
+    // Nothing is compacted meanwhile, so the indices stay valid even if the array grows.
+    unsigned int count = _actions.size();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Action *pAction = _actions[i].action;
+        if (pAction == NULL || _targets[_actions[i].target].paused)
         {
-            // The 'actions' MutableArray may change while inside this loop.
-            for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < _currentTarget->actions->num;
-                _currentTarget->actionIndex++)
-            {
-                _currentTarget->currentAction = (Action*)_currentTarget->actions->arr[_currentTarget->actionIndex];
-                if (_currentTarget->currentAction == NULL)
-                {
-                    continue;
-                }
-
-                _currentTarget->currentActionSalvaged = false;
+            continue;
+        }
 
-                _currentTarget->currentAction->step(dt);
+        _currentAction = pAction;
+        _currentActionSalvaged = false;
 
-                if (_currentTarget->currentActionSalvaged)
-                {
-                    // The currentAction told the node to remove it. To prevent the action from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    _currentTarget->currentAction->release();
-                } else
-                if (_currentTarget->currentAction->isDone())
-                {
-                    _currentTarget->currentAction->stop();
+        pAction->step(dt);
+        // the running actions mark the frame dirty, even those that don't change their target, like a DelayTime
+        Director::setNextFrameDirty();
 
-                    Action *pAction = _currentTarget->currentAction;
-                    // Make currentAction nil to prevent removeAction from salvaging it.
-                    _currentTarget->currentAction = NULL;
-                    removeAction(pAction);
-                }
+        if (! _currentActionSalvaged && pAction->isDone())
+        {
+            pAction->stop();
 
-                _currentTarget->currentAction = NULL;
+            if (! _currentActionSalvaged)
+            {
+                // Make currentAction nil to prevent removeActionAtIndex from salvaging it.
+                _currentAction = NULL;
+                const std::vector<unsigned int>& actions = _targets[_actions[i].target].actions;
+                removeActionAtIndex(std::find(actions.begin(), actions.end(), i) - actions.begin(), _actions[i].target);
             }
         }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashElement*)(elt->hh.next);
-
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->actions->num == 0)
+        if (_currentActionSalvaged)
         {
-            deleteHashElement(_currentTarget);
+            // The currentAction told the node to remove it. To prevent the action from
+            // accidentally deallocating itself before finishing its step, we kept
+            // it. Now that step is done, it's safe to release it.
+            pAction->release();
         }
+
+        _currentAction = NULL;
     }
 
-    // issue #635
-    _currentTarget = NULL;
+    for (int property = 0; property < TWEEN_PROPERTY_COUNT; ++property)
+    {
+        updateTweens((TweenProperty)property, dt);
+    }
+
+    updateTemplates(dt);
+
+    _updating = false;
+    // most frames complete some tweens, which are cheap to compact
+    if (_tweenTombstones > 0)
+    {
+        compactTweens();
+    }
+    if (_templateTombstones > 0)
+    {
+        compactTemplates();
+    }
+    compact();
+
+    // the targets are released once the arrays are consistent, since releasing them may delete them
+    std::vector<Object*> targets;
+    targets.swap(_targetsToRelease);
+    for (auto it = targets.begin(); it != targets.end(); ++it)
+    {
+        (*it)->release();
+    }
 }
 
 NS_CC_END
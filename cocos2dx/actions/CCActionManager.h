@@ -31,12 +31,15 @@ THE SOFTWARE.
 #include "CCAction.h"
 #include "cocoa/CCArray.h"
 #include "cocoa/CCObject.h"
+#include "CCTweenEasing.h"
+#include <vector>
+#include <unordered_map>
 
 NS_CC_BEGIN
 
 class Set;
-
-struct _hashElement;
+class RGBAProtocol;
+class ActionTemplate;
 
 /**
  * @addtogroup actions
@@ -51,12 +54,23 @@ struct _hashElement;
  Examples:
     - When you want to run an action where the target is different from a Node. 
     - When you want to pause / resume the actions
+    - When you want to tween a property without creating actions (see addTween())
+    - When you want to run the same animation on many nodes without cloning actions (see addTemplate())
  
  @since v0.8
  */
 class CC_DLL ActionManager : public Object
 {
 public:
+    /** The properties that can be tweened with addTween() */
+    enum class TweenProperty
+    {
+        POSITION,   // x and y are the position
+        SCALE,      // x and y are the scales on the X and Y axis
+        ROTATION,   // x and y are the rotations on the X and Y axis, in degrees. The shortest way is taken, like RotateTo
+        OPACITY,    // x is the opacity. The target must implement RGBAProtocol
+    };
+
     ActionManager(void);
     ~ActionManager(void);
 
@@ -97,6 +111,11 @@ public:
      */
     unsigned int getNumberOfRunningActionsInTarget(const Object *target) const;
 
+    /** Returns the number of actions running on all the targets
+     @since v3.0
+     */
+    unsigned int getNumberOfRunningActions() const;
+
     /** @deprecated use getNumberOfRunningActionsInTarget() instead */
     CC_DEPRECATED_ATTRIBUTE inline unsigned int numberOfRunningActionsInTarget(Object *target) const { return getNumberOfRunningActionsInTarget(target); }
 
@@ -116,18 +135,144 @@ public:
      */
     void resumeTargets(Set *targetsToResume);
 
+    // tweens
+
+    /** Tweens a property of a target from its current value to (x, y) in duration seconds, like MoveTo, ScaleTo, RotateTo or FadeTo.
+     Tweens are not actions: they are plain records stored in one array per property and don't allocate anything,
+     so they are cheaper than actions when lots of short animations are started.
+     A tween replaces the tween of the same property running on the target, if any.
+     Tweens are paused and resumed with their target, and removed by removeAllActionsFromTarget().
+     @since v3.0
+     */
+    void addTween(Node *target, TweenProperty property, float duration, float x, float y,
+                  tweenfunc::Easing easing = tweenfunc::Easing::LINEAR, float easingParam = 0);
+
+    /** Removes the tween of a property of a target, leaving the property at its current value
+     @since v3.0
+     */
+    void removeTween(Object *target, TweenProperty property);
+
+    /** Returns the number of tweens running on a target
+     @since v3.0
+     */
+    unsigned int getNumberOfRunningTweensInTarget(const Object *target) const;
+
+    /** Returns the number of tweens running on all the targets
+     @since v3.0
+     */
+    unsigned int getNumberOfRunningTweens() const;
+
+    // templates
+
+    /** Runs an ActionTemplate on a target. The steps are shared by all the targets running the template:
+     the target only gets a record of its elapsed time, and the start values of the steps in a shared array.
+     The template is retained while it runs, and can't be changed anymore.
+     Templates are paused and resumed with their target, and removed by removeAllActionsFromTarget().
+     A target can run several templates at once. Their steps don't replace the tweens of the same property.
+     @since v3.0
+     */
+    void addTemplate(ActionTemplate *actionTemplate, Node *target);
+
+    /** Removes the instances of a template running on a target, leaving the properties at their current values
+     @since v3.0
+     */
+    void removeTemplate(Object *target, ActionTemplate *actionTemplate);
+
+    /** Returns the number of templates running on a target
+     @since v3.0
+     */
+    unsigned int getNumberOfRunningTemplatesInTarget(const Object *target) const;
+
+    /** Returns the number of templates running on all the targets
+     @since v3.0
+     */
+    unsigned int getNumberOfRunningTemplates() const;
+
 protected:
-    // declared in ActionManager.m
+    // A running action. Entries are stored by value, in the order the actions were added,
+    // so stepping them does not chase pointers. The index of an entry is its handle until compact().
+    struct ActionEntry
+    {
+        Action *action;         // retained. NULL once the action has been removed (tombstone)
+        unsigned int target;    // index of its target in _targets
+    };
+
+    enum { TWEEN_PROPERTY_COUNT = (int)TweenProperty::OPACITY + 1 };
+
+    // A tween added with addTween()
+    struct Tween
+    {
+        Node *target;           // NULL once the tween has been removed (tombstone)
+        RGBAProtocol *rgba;     // the target, for the opacity tweens
+        unsigned int targetIndex;
+        float elapsed;
+        float duration;
+        float from[2];
+        float delta[2];
+        float easingParam;
+        tweenfunc::Easing easing;
+        bool firstTick;
+    };
+
+    // A template added with addTemplate()
+    struct TemplateInstance
+    {
+        ActionTemplate *actionTemplate;     // retained. NULL once the instance has been removed (tombstone)
+        Node *target;
+        RGBAProtocol *rgba;     // the target, if it implements RGBAProtocol
+        unsigned int targetIndex;
+        unsigned int values;    // index of the values of its steps in _templateValues: from[2] and delta[2] per step
+        unsigned int startedSteps;  // the steps of the current loop which read their start values
+        unsigned int loops;
+        float elapsed;          // in the current loop
+        bool firstTick;
+    };
+
+    // The actions, the tweens and the templates of a target
+    struct ActionTarget
+    {
+        Object *target;         // retained. NULL once the target has no more actions, tweens nor templates (tombstone)
+        std::vector<unsigned int> actions;  // indices of the entries of its actions, in the order they were added
+        int tweens[TWEEN_PROPERTY_COUNT];   // index of its tween of each property, or -1
+        unsigned int templates;             // number of its templates
+        bool paused;
+    };
 
-    void removeActionAtIndex(unsigned int uIndex, struct _hashElement *pElement);
-    void deleteHashElement(struct _hashElement *pElement);
-    void actionAllocWithHashElement(struct _hashElement *pElement);
+    /** removes the action at position in the actions of a target */
+    void removeActionAtIndex(unsigned int position, unsigned int targetIndex);
+    void removeTarget(unsigned int targetIndex);
+    /** removes the target if it has no more actions, tweens nor templates */
+    void removeTargetIfUnused(unsigned int targetIndex);
+    unsigned int getTargetIndex(Node *target, bool paused);
+    void removeTweenAtIndex(TweenProperty property, unsigned int index);
+    void updateTweens(TweenProperty property, float dt);
+    void compactTweens();
+    void removeTemplateAtIndex(unsigned int index);
+    /** applies the steps of a template which run between previous and time, in the current loop.
+     Returns false if the instance was removed meanwhile */
+    bool applyTemplate(unsigned int index, float previous, float time);
+    void updateTemplates(float dt);
+    void compactTemplates();
+    /** removes the tombstones, if there are enough of them and the actions are not being stepped */
+    void compact();
     void update(float dt);
 
 protected:
-    struct _hashElement    *_targets;
-    struct _hashElement    *_currentTarget;
-    bool            _currentTargetSalvaged;
+    std::vector<ActionEntry> _actions;
+    std::vector<ActionTarget> _targets;
+    std::unordered_map<const Object*, unsigned int> _targetIndices;
+    unsigned int _actionTombstones;
+    unsigned int _targetTombstones;
+    std::vector<Tween> _tweens[TWEEN_PROPERTY_COUNT];
+    unsigned int _tweenTombstones;
+    std::vector<TemplateInstance> _templates;
+    std::vector<float> _templateValues;
+    unsigned int _templateTombstones;
+    // targets which lost their last action while the actions were stepped, released at the end of update()
+    std::vector<Object*> _targetsToRelease;
+    Action *_currentAction;
+    bool _currentActionSalvaged;
+    bool _updating;
 };
 
 // end of actions group
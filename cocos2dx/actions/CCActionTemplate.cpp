@@ -0,0 +1,141 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCActionTemplate.h"
+#include "ccMacros.h"
+
+NS_CC_BEGIN
+
+ActionTemplate* ActionTemplate::create()
+{
+    ActionTemplate *ret = new ActionTemplate();
+    ret->autorelease();
+    return ret;
+}
+
+ActionTemplate::ActionTemplate()
+: _duration(0)
+, _times(1)
+, _locked(false)
+{
+}
+
+ActionTemplate::~ActionTemplate()
+{
+}
+
+ActionTemplate* ActionTemplate::addStep(float duration, ActionManager::TweenProperty property, bool relative, float x, float y,
+                                        tweenfunc::Easing easing, float easingParam)
+{
+    CCASSERT(! _locked, "A template can't be changed once it has been run");
+    CCASSERT(duration >= 0, "Invalid duration");
+
+    Step step;
+    step.start = _duration;
+    step.duration = duration;
+    step.values[0] = x;
+    step.values[1] = y;
+    step.easingParam = easingParam;
+    step.easing = easing;
+    step.property = property;
+    step.relative = relative;
+    step.callback = -1;
+    _steps.push_back(step);
+
+    _duration += duration;
+    return this;
+}
+
+ActionTemplate* ActionTemplate::moveTo(float duration, const Point& position, tweenfunc::Easing easing, float easingParam)
+{
+    return addStep(duration, ActionManager::TweenProperty::POSITION, false, position.x, position.y, easing, easingParam);
+}
+
+ActionTemplate* ActionTemplate::moveBy(float duration, const Point& delta, tweenfunc::Easing easing, float easingParam)
+{
+    return addStep(duration, ActionManager::TweenProperty::POSITION, true, delta.x, delta.y, easing, easingParam);
+}
+
+ActionTemplate* ActionTemplate::scaleTo(float duration, float scaleX, float scaleY, tweenfunc::Easing easing, float easingParam)
+{
+    return addStep(duration, ActionManager::TweenProperty::SCALE, false, scaleX, scaleY, easing, easingParam);
+}
+
+ActionTemplate* ActionTemplate::rotateTo(float duration, float angle, tweenfunc::Easing easing, float easingParam)
+{
+    return addStep(duration, ActionManager::TweenProperty::ROTATION, false, angle, angle, easing, easingParam);
+}
+
+ActionTemplate* ActionTemplate::rotateBy(float duration, float angle, tweenfunc::Easing easing, float easingParam)
+{
+    return addStep(duration, ActionManager::TweenProperty::ROTATION, true, angle, angle, easing, easingParam);
+}
+
+ActionTemplate* ActionTemplate::fadeTo(float duration, GLubyte opacity, tweenfunc::Easing easing, float easingParam)
+{
+    return addStep(duration, ActionManager::TweenProperty::OPACITY, false, opacity, 0, easing, easingParam);
+}
+
+ActionTemplate* ActionTemplate::callFunc(const std::function<void(Node*)>& func)
+{
+    addStep(0, ActionManager::TweenProperty::POSITION, false, 0, 0, tweenfunc::Easing::LINEAR, 0);
+    _steps.back().callback = (int)_callbacks.size();
+    _callbacks.push_back(func);
+    return this;
+}
+
+ActionTemplate* ActionTemplate::delay(float duration)
+{
+    CCASSERT(! _locked, "A template can't be changed once it has been run");
+    CCASSERT(duration >= 0, "Invalid duration");
+
+    _duration += duration;
+    return this;
+}
+
+ActionTemplate* ActionTemplate::withPrevious()
+{
+    CCASSERT(! _locked, "A template can't be changed once it has been run");
+    CCASSERT(_steps.size() >= 2, "withPrevious() needs two steps");
+
+    // the steps stay sorted by start time: the last step moves back to the start of the previous one
+    Step& step = _steps.back();
+    // the duration of the timeline before the step was added
+    float duration = step.start;
+    step.start = _steps[_steps.size() - 2].start;
+
+    _duration = MAX(duration, step.start + step.duration);
+    return this;
+}
+
+ActionTemplate* ActionTemplate::repeat(unsigned int times)
+{
+    CCASSERT(! _locked, "A template can't be changed once it has been run");
+    CCASSERT(times > 0, "Invalid repeat count");
+
+    _times = times;
+    return this;
+}
+
+NS_CC_END
@@ -0,0 +1,149 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __ACTION_CCACTION_TEMPLATE_H__
+#define __ACTION_CCACTION_TEMPLATE_H__
+
+#include "CCActionManager.h"
+#include "cocoa/CCGeometry.h"
+#include "ccTypes.h"
+#include <functional>
+#include <vector>
+
+NS_CC_BEGIN
+
+class Node;
+
+/**
+ * @addtogroup actions
+ * @{
+ */
+
+/** @brief An immutable animation, shared by all the nodes that run it.
+
+ Running an action on many nodes needs a clone of the action per node: a Sequence of 10 actions started
+ on 200 nodes allocates about 2000 objects. A template describes the animation once, as a timeline of steps
+ that tween the properties of ActionManager::addTween(), and each node that runs it only gets a record of
+ its elapsed time and of the start values of the steps, stored in the arrays of the ActionManager.
+
+ The steps are added one after the other, like in a Sequence. withPrevious() makes the last step start
+ with the one before it, like in a Spawn:
+
+ @code
+ static ActionTemplate* s_popIn = NULL;
+ if (!s_popIn)
+ {
+     s_popIn = ActionTemplate::create();
+     s_popIn->retain();
+     s_popIn->scaleTo(0, 0.5f, 0.5f)->fadeTo(0, 0)
+            ->scaleTo(0.2f, 1, 1, tweenfunc::Easing::BACK_OUT)->fadeTo(0.2f, 255)->withPrevious();
+ }
+ for (auto cell : cells)
+ {
+     cell->runTemplate(s_popIn);
+ }
+ @endcode
+
+ A template can't be changed once it has been run. Its steps ("To" steps) start from the values of the node
+ when they start, like the actions.
+
+ @since v3.0
+ */
+class CC_DLL ActionTemplate : public Object
+{
+public:
+    /** runs the template until it is removed */
+    static const unsigned int REPEAT_FOREVER = (unsigned int)-1;
+
+    static ActionTemplate* create();
+
+    ActionTemplate();
+    virtual ~ActionTemplate();
+
+    /** Moves the node to position, like MoveTo */
+    ActionTemplate* moveTo(float duration, const Point& position, tweenfunc::Easing easing = tweenfunc::Easing::LINEAR, float easingParam = 0);
+    /** Moves the node by delta, like MoveBy */
+    ActionTemplate* moveBy(float duration, const Point& delta, tweenfunc::Easing easing = tweenfunc::Easing::LINEAR, float easingParam = 0);
+    /** Scales the node to (scaleX, scaleY), like ScaleTo */
+    ActionTemplate* scaleTo(float duration, float scaleX, float scaleY, tweenfunc::Easing easing = tweenfunc::Easing::LINEAR, float easingParam = 0);
+    /** Rotates the node to angle, taking the shortest way, like RotateTo */
+    ActionTemplate* rotateTo(float duration, float angle, tweenfunc::Easing easing = tweenfunc::Easing::LINEAR, float easingParam = 0);
+    /** Rotates the node by angle, like RotateBy */
+    ActionTemplate* rotateBy(float duration, float angle, tweenfunc::Easing easing = tweenfunc::Easing::LINEAR, float easingParam = 0);
+    /** Fades the node to opacity, like FadeTo. The node must implement RGBAProtocol */
+    ActionTemplate* fadeTo(float duration, GLubyte opacity, tweenfunc::Easing easing = tweenfunc::Easing::LINEAR, float easingParam = 0);
+    /** Calls func with the node, like CallFunc */
+    ActionTemplate* callFunc(const std::function<void(Node*)>& func);
+    /** Waits before the next step, like DelayTime */
+    ActionTemplate* delay(float duration);
+
+    /** The last step starts at the same time as the step before it, instead of after it */
+    ActionTemplate* withPrevious();
+
+    /** Runs the timeline times times, like Repeat. The start values are read again at each loop */
+    ActionTemplate* repeat(unsigned int times);
+    /** Runs the timeline until it is removed, like RepeatForever. The duration of the timeline must not be 0 */
+    inline ActionTemplate* repeatForever() { return repeat(REPEAT_FOREVER); }
+
+    /** duration of the timeline, without the repeats */
+    inline float getDuration() const { return _duration; }
+    inline unsigned int getRepeatCount() const { return _times; }
+    inline unsigned int getStepCount() const { return (unsigned int)_steps.size(); }
+
+    /** Whether the template has been run, and can't be changed anymore */
+    inline bool isLocked() const { return _locked; }
+
+protected:
+    friend class ActionManager;
+
+    struct Step
+    {
+        float start;
+        float duration;
+        /** the target values, or the deltas of a relative step */
+        float values[2];
+        float easingParam;
+        tweenfunc::Easing easing;
+        ActionManager::TweenProperty property;
+        bool relative;
+        /** index of the function in _callbacks, or -1 for a tween */
+        int callback;
+    };
+
+    ActionTemplate* addStep(float duration, ActionManager::TweenProperty property, bool relative, float x, float y,
+                            tweenfunc::Easing easing, float easingParam);
+
+    std::vector<Step> _steps;
+    std::vector<std::function<void(Node*)>> _callbacks;
+    float _duration;
+    unsigned int _times;
+    bool _locked;
+};
+
+// end of actions group
+/// @}
+
+NS_CC_END
+
+#endif // __ACTION_CCACTION_TEMPLATE_H__
@@ -0,0 +1,429 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+/*
+ * Elastic, Back and Bounce curves based on code from:
+ * http://github.com/NikhilK/silverlightfx/
+ *
+ * by http://github.com/NikhilK
+ */
+
+#include "CCTweenEasing.h"
+#include "ccConfig.h"
+#include <math.h>
+
+NS_CC_BEGIN
+
+#ifndef M_PI_X_2
+#define M_PI_X_2 (float)M_PI * 2.0f
+#endif
+
+namespace tweenfunc {
+
+// the curves sampled in the lookup tables
+enum
+{
+    TABLE_EXPONENTIAL_IN,
+    TABLE_EXPONENTIAL_OUT,
+    TABLE_EXPONENTIAL_IN_OUT,
+    TABLE_SINE_IN,
+    TABLE_SINE_OUT,
+    TABLE_SINE_IN_OUT,
+    TABLE_ELASTIC_IN,
+    TABLE_ELASTIC_OUT,
+    TABLE_ELASTIC_IN_OUT,
+    TABLE_BOUNCE_IN,
+    TABLE_BOUNCE_OUT,
+    TABLE_BOUNCE_IN_OUT,
+    TABLE_BACK_IN,
+    TABLE_BACK_OUT,
+    TABLE_BACK_IN_OUT,
+    TABLE_COUNT
+};
+
+#define DEFAULT_ELASTIC_PERIOD          0.3f
+#define DEFAULT_ELASTIC_IN_OUT_PERIOD   (0.3f * 1.5f)
+
+static float s_tables[TABLE_COUNT][CC_EASING_LOOKUP_TABLE_SIZE + 1];
+static bool s_tablesBuilt = false;
+static bool s_lookupTablesEnabled = false;
+
+// times out of [0, 1], given by nested ease actions, are computed
+static inline bool useTable(float time)
+{
+    return s_lookupTablesEnabled && time >= 0 && time <= 1;
+}
+
+static inline float lookup(int table, float time)
+{
+    const float *samples = s_tables[table];
+    float position = time * CC_EASING_LOOKUP_TABLE_SIZE;
+    int index = (int)position;
+    if (index >= CC_EASING_LOOKUP_TABLE_SIZE)
+    {
+        return samples[CC_EASING_LOOKUP_TABLE_SIZE];
+    }
+
+    return samples[index] + (samples[index + 1] - samples[index]) * (position - index);
+}
+
+static float sampleCurve(int table, float time)
+{
+    switch (table)
+    {
+    case TABLE_EXPONENTIAL_IN:      return exponentialIn(time);
+    case TABLE_EXPONENTIAL_OUT:     return exponentialOut(time);
+    case TABLE_EXPONENTIAL_IN_OUT:  return exponentialInOut(time);
+    case TABLE_SINE_IN:             return sineIn(time);
+    case TABLE_SINE_OUT:            return sineOut(time);
+    case TABLE_SINE_IN_OUT:         return sineInOut(time);
+    case TABLE_ELASTIC_IN:          return elasticIn(time, DEFAULT_ELASTIC_PERIOD);
+    case TABLE_ELASTIC_OUT:         return elasticOut(time, DEFAULT_ELASTIC_PERIOD);
+    case TABLE_ELASTIC_IN_OUT:      return elasticInOut(time, DEFAULT_ELASTIC_IN_OUT_PERIOD);
+    case TABLE_BOUNCE_IN:           return bounceIn(time);
+    case TABLE_BOUNCE_OUT:          return bounceOut(time);
+    case TABLE_BOUNCE_IN_OUT:       return bounceInOut(time);
+    case TABLE_BACK_IN:             return backIn(time);
+    case TABLE_BACK_OUT:            return backOut(time);
+    case TABLE_BACK_IN_OUT:         return backInOut(time);
+    }
+
+    return time;
+}
+
+void setLookupTablesEnabled(bool enabled)
+{
+    // the tables are sampled from the computed curves
+    s_lookupTablesEnabled = false;
+
+    if (enabled && ! s_tablesBuilt)
+    {
+        for (int table = 0; table < TABLE_COUNT; ++table)
+        {
+            for (int i = 0; i <= CC_EASING_LOOKUP_TABLE_SIZE; ++i)
+            {
+                s_tables[table][i] = sampleCurve(table, (float)i / CC_EASING_LOOKUP_TABLE_SIZE);
+            }
+        }
+        s_tablesBuilt = true;
+    }
+
+    s_lookupTablesEnabled = enabled;
+}
+
+bool isLookupTablesEnabled()
+{
+    return s_lookupTablesEnabled;
+}
+
+float ease(Easing easing, float time, float param)
+{
+    switch (easing)
+    {
+    case Easing::LINEAR:                return time;
+    case Easing::EASE_IN:               return easeIn(time, param);
+    case Easing::EASE_OUT:              return easeOut(time, param);
+    case Easing::EASE_IN_OUT:           return easeInOut(time, param);
+    case Easing::EXPONENTIAL_IN:        return exponentialIn(time);
+    case Easing::EXPONENTIAL_OUT:       return exponentialOut(time);
+    case Easing::EXPONENTIAL_IN_OUT:    return exponentialInOut(time);
+    case Easing::SINE_IN:               return sineIn(time);
+    case Easing::SINE_OUT:              return sineOut(time);
+    case Easing::SINE_IN_OUT:           return sineInOut(time);
+    case Easing::ELASTIC_IN:            return elasticIn(time, param == 0 ? DEFAULT_ELASTIC_PERIOD : param);
+    case Easing::ELASTIC_OUT:           return elasticOut(time, param == 0 ? DEFAULT_ELASTIC_PERIOD : param);
+    case Easing::ELASTIC_IN_OUT:        return elasticInOut(time, param);
+    case Easing::BOUNCE_IN:             return bounceIn(time);
+    case Easing::BOUNCE_OUT:            return bounceOut(time);
+    case Easing::BOUNCE_IN_OUT:         return bounceInOut(time);
+    case Easing::BACK_IN:               return backIn(time);
+    case Easing::BACK_OUT:              return backOut(time);
+    case Easing::BACK_IN_OUT:           return backInOut(time);
+    }
+
+    return time;
+}
+
+float easeIn(float time, float rate)
+{
+    return powf(time, rate);
+}
+
+float easeOut(float time, float rate)
+{
+    return powf(time, 1 / rate);
+}
+
+float easeInOut(float time, float rate)
+{
+    time *= 2;
+    if (time < 1)
+    {
+        return 0.5f * powf(time, rate);
+    }
+    else
+    {
+        return 1.0f - 0.5f * powf(2 - time, rate);
+    }
+}
+
+float exponentialIn(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_EXPONENTIAL_IN, time);
+    }
+
+    return time == 0 ? 0 : powf(2, 10 * (time/1 - 1)) - 1 * 0.001f;
+}
+
+float exponentialOut(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_EXPONENTIAL_OUT, time);
+    }
+
+    return time == 1 ? 1 : (-powf(2, -10 * time / 1) + 1);
+}
+
+float exponentialInOut(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_EXPONENTIAL_IN_OUT, time);
+    }
+
+    time /= 0.5f;
+    if (time < 1)
+    {
+        return 0.5f * powf(2, 10 * (time - 1));
+    }
+    else
+    {
+        return 0.5f * (-powf(2, -10 * (time - 1)) + 2);
+    }
+}
+
+float sineIn(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_SINE_IN, time);
+    }
+
+    return -1 * cosf(time * (float)M_PI_2) + 1;
+}
+
+float sineOut(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_SINE_OUT, time);
+    }
+
+    return sinf(time * (float)M_PI_2);
+}
+
+float sineInOut(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_SINE_IN_OUT, time);
+    }
+
+    return -0.5f * (cosf((float)M_PI * time) - 1);
+}
+
+float elasticIn(float time, float period)
+{
+    if (useTable(time) && period == DEFAULT_ELASTIC_PERIOD)
+    {
+        return lookup(TABLE_ELASTIC_IN, time);
+    }
+
+    if (time == 0 || time == 1)
+    {
+        return time;
+    }
+
+    float s = period / 4;
+    time = time - 1;
+    return -powf(2, 10 * time) * sinf((time - s) * M_PI_X_2 / period);
+}
+
+float elasticOut(float time, float period)
+{
+    if (useTable(time) && period == DEFAULT_ELASTIC_PERIOD)
+    {
+        return lookup(TABLE_ELASTIC_OUT, time);
+    }
+
+    if (time == 0 || time == 1)
+    {
+        return time;
+    }
+
+    float s = period / 4;
+    return powf(2, -10 * time) * sinf((time - s) * M_PI_X_2 / period) + 1;
+}
+
+float elasticInOut(float time, float period)
+{
+    if (useTable(time) && (period == 0 || period == DEFAULT_ELASTIC_IN_OUT_PERIOD))
+    {
+        return lookup(TABLE_ELASTIC_IN_OUT, time);
+    }
+
+    if (time == 0 || time == 1)
+    {
+        return time;
+    }
+
+    time = time * 2;
+    if (period == 0)
+    {
+        period = DEFAULT_ELASTIC_IN_OUT_PERIOD;
+    }
+
+    float s = period / 4;
+
+    time = time - 1;
+    if (time < 0)
+    {
+        return -0.5f * powf(2, 10 * time) * sinf((time - s) * M_PI_X_2 / period);
+    }
+    else
+    {
+        return powf(2, -10 * time) * sinf((time - s) * M_PI_X_2 / period) * 0.5f + 1;
+    }
+}
+
+float bounceTime(float time)
+{
+    if (time < 1 / 2.75)
+    {
+        return 7.5625f * time * time;
+    } else 
+    if (time < 2 / 2.75)
+    {
+        time -= 1.5f / 2.75f;
+        return 7.5625f * time * time + 0.75f;
+    } else
+    if(time < 2.5 / 2.75)
+    {
+        time -= 2.25f / 2.75f;
+        return 7.5625f * time * time + 0.9375f;
+    }
+
+    time -= 2.625f / 2.75f;
+    return 7.5625f * time * time + 0.984375f;
+}
+
+float bounceIn(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_BOUNCE_IN, time);
+    }
+
+    return 1 - bounceTime(1 - time);
+}
+
+float bounceOut(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_BOUNCE_OUT, time);
+    }
+
+    return bounceTime(time);
+}
+
+float bounceInOut(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_BOUNCE_IN_OUT, time);
+    }
+
+    if (time < 0.5f)
+    {
+        time = time * 2;
+        return (1 - bounceTime(1 - time)) * 0.5f;
+    }
+    else
+    {
+        return bounceTime(time * 2 - 1) * 0.5f + 0.5f;
+    }
+}
+
+float backIn(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_BACK_IN, time);
+    }
+
+    float overshoot = 1.70158f;
+    return time * time * ((overshoot + 1) * time - overshoot);
+}
+
+float backOut(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_BACK_OUT, time);
+    }
+
+    float overshoot = 1.70158f;
+
+    time = time - 1;
+    return time * time * ((overshoot + 1) * time + overshoot) + 1;
+}
+
+float backInOut(float time)
+{
+    if (useTable(time))
+    {
+        return lookup(TABLE_BACK_IN_OUT, time);
+    }
+
+    float overshoot = 1.70158f * 1.525f;
+
+    time = time * 2;
+    if (time < 1)
+    {
+        return (time * time * ((overshoot + 1) * time - overshoot)) / 2;
+    }
+    else
+    {
+        time = time - 2;
+        return (time * time * ((overshoot + 1) * time + overshoot)) / 2 + 1;
+    }
+}
+
+} // namespace tweenfunc
+
+NS_CC_END
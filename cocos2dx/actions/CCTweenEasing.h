@@ -0,0 +1,112 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __ACTION_CCTWEEN_EASING_H__
+#define __ACTION_CCTWEEN_EASING_H__
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup actions
+ * @{
+ */
+
+/** @brief The curves of the ease actions, usable without creating actions.
+ The functions map a time between 0 and 1 to the eased time. They are used by the ease actions
+ and by the tweens of ActionManager.
+ @since v3.0
+ */
+namespace tweenfunc {
+
+/** The curves used by the tweens of ActionManager */
+enum class Easing
+{
+    LINEAR,
+    EASE_IN,                // uses a rate, like EaseIn
+    EASE_OUT,               // uses a rate, like EaseOut
+    EASE_IN_OUT,            // uses a rate, like EaseInOut
+    EXPONENTIAL_IN,
+    EXPONENTIAL_OUT,
+    EXPONENTIAL_IN_OUT,
+    SINE_IN,
+    SINE_OUT,
+    SINE_IN_OUT,
+    ELASTIC_IN,             // uses a period, like EaseElasticIn. 0 means the default period
+    ELASTIC_OUT,            // uses a period, like EaseElasticOut. 0 means the default period
+    ELASTIC_IN_OUT,         // uses a period, like EaseElasticInOut. 0 means the default period
+    BOUNCE_IN,
+    BOUNCE_OUT,
+    BOUNCE_IN_OUT,
+    BACK_IN,
+    BACK_OUT,
+    BACK_IN_OUT,
+};
+
+/** Eases time with the given curve. param is the rate or the period of the curves that use one */
+CC_DLL float ease(Easing easing, float time, float param = 0);
+
+/** Sets whether the exponential, sine, elastic, bounce and back curves are read from precomputed tables,
+ interpolated linearly, instead of being computed with sinf() and powf(). The tables are shared by all the
+ actions and tweens, and built when they are enabled. The elastic tables are only used with the default periods.
+ Disabled by default. It should be set from the main thread, when no action is running on another thread.
+ @see CC_EASING_LOOKUP_TABLE_SIZE
+ */
+CC_DLL void setLookupTablesEnabled(bool enabled);
+CC_DLL bool isLookupTablesEnabled();
+
+CC_DLL float easeIn(float time, float rate);
+CC_DLL float easeOut(float time, float rate);
+CC_DLL float easeInOut(float time, float rate);
+
+CC_DLL float exponentialIn(float time);
+CC_DLL float exponentialOut(float time);
+CC_DLL float exponentialInOut(float time);
+
+CC_DLL float sineIn(float time);
+CC_DLL float sineOut(float time);
+CC_DLL float sineInOut(float time);
+
+CC_DLL float elasticIn(float time, float period);
+CC_DLL float elasticOut(float time, float period);
+CC_DLL float elasticInOut(float time, float period);
+
+CC_DLL float bounceTime(float time);
+CC_DLL float bounceIn(float time);
+CC_DLL float bounceOut(float time);
+CC_DLL float bounceInOut(float time);
+
+CC_DLL float backIn(float time);
+CC_DLL float backOut(float time);
+CC_DLL float backInOut(float time);
+
+} // namespace tweenfunc
+
+// end of actions group
+/// @}
+
+NS_CC_END
+
+#endif // __ACTION_CCTWEEN_EASING_H__
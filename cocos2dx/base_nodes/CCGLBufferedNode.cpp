@@ -23,74 +23,17 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "CCGLBufferedNode.h"
+#include "CCDirector.h"
+#include "renderer/CCRenderer.h"
 
-GLBufferedNode::GLBufferedNode()
+const GLvoid* GLBufferedNode::setGLBufferData(void *buf, GLuint bufSize)
 {
-    for(int i = 0; i < BUFFER_SLOTS; i++)
-    {
-        _bufferObject[i] = 0;
-        _bufferSize[i] = 0;
-        _indexBufferObject[i] = 0;
-        _indexBufferSize[i] = 0;
-    }
+    // WebGL doesn't support client-side arrays, so load the data in a buffer first.
+    return cocos2d::Director::getInstance()->getRenderer()->getBufferArena()->upload(GL_ARRAY_BUFFER, buf, bufSize);
 }
 
-GLBufferedNode::~GLBufferedNode()
+const GLvoid* GLBufferedNode::setGLIndexData(void *buf, GLuint bufSize)
 {
-    for(int i = 0; i < BUFFER_SLOTS; i++)
-    {
-        if(_bufferSize[i])
-        {
-            glDeleteBuffers(1, &(_bufferObject[i]));
-        }
-        if(_indexBufferSize[i])
-        {
-            glDeleteBuffers(1, &(_indexBufferObject[i]));
-        }
-    }
+    // WebGL doesn't support client-side arrays, so load the data in a buffer first.
+    return cocos2d::Director::getInstance()->getRenderer()->getBufferArena()->upload(GL_ELEMENT_ARRAY_BUFFER, buf, bufSize);
 }
-
-void GLBufferedNode::setGLBufferData(void *buf, GLuint bufSize, int slot)
-{
-    // WebGL doesn't support client-side arrays, so generate a buffer and load the data first.
-    if(_bufferSize[slot] < bufSize)
-    {
-        if(_bufferObject[slot])
-        {
-            glDeleteBuffers(1, &(_bufferObject[slot]));
-        }
-        glGenBuffers(1, &(_bufferObject[slot]));
-        _bufferSize[slot] = bufSize;
-
-        glBindBuffer(GL_ARRAY_BUFFER, _bufferObject[slot]);
-        glBufferData(GL_ARRAY_BUFFER, bufSize, buf, GL_DYNAMIC_DRAW);
-    }
-    else
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, _bufferObject[slot]);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, bufSize, buf);
-    }
-}
-
-void GLBufferedNode::setGLIndexData(void *buf, GLuint bufSize, int slot)
-{
-    // WebGL doesn't support client-side arrays, so generate a buffer and load the data first.
-    if(_indexBufferSize[slot] < bufSize)
-    {
-        if(_indexBufferObject[slot])
-        {
-            glDeleteBuffers(1, &(_indexBufferObject[slot]));
-        }
-        glGenBuffers(1, &(_indexBufferObject[slot]));
-        _indexBufferSize[slot] = bufSize;
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferObject[slot]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufSize, buf, GL_DYNAMIC_DRAW);
-    }
-    else
-    {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBufferObject[slot]);
-        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, bufSize, buf);
-    }
-}
-
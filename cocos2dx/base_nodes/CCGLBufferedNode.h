@@ -29,21 +29,12 @@ THE SOFTWARE.
 class GLBufferedNode
 {
 public:
-    GLBufferedNode();
-    virtual ~GLBufferedNode();
-
     /**
-     * Load the given data into this Node's GL Buffer. Needed for WebGL, as it does not support client-side arrays.
+     * Load the given data into a GL Buffer. Needed for WebGL, as it does not support client-side arrays.
+     * The data is copied to the streaming buffers shared by the nodes (see BufferArena), and their buffer is bound.
+     * Returns the offset of the data in the buffer, to be used as the pointer of glVertexAttribPointer() or glDrawElements().
      */
-    void setGLBufferData(void *buf, GLuint bufSize, int slot);
-    void setGLIndexData(void *buf, GLuint bufSize, int slot);
-
-    // We allocate 4 buffer objs per node, and index into them as slots.
-#define BUFFER_SLOTS 4
-    GLuint _bufferObject[BUFFER_SLOTS];
-    GLuint _bufferSize[BUFFER_SLOTS];
-
-    GLuint _indexBufferObject[BUFFER_SLOTS];
-    GLuint _indexBufferSize[BUFFER_SLOTS];
+    const GLvoid* setGLBufferData(void *buf, GLuint bufSize);
+    const GLvoid* setGLIndexData(void *buf, GLuint bufSize);
 };
 #endif // __CC_GL_BUFFERED_NODE__
@@ -33,12 +33,18 @@ THE SOFTWARE.
 #include "CCScheduler.h"
 #include "touch_dispatcher/CCTouch.h"
 #include "actions/CCActionManager.h"
+#include "event_dispatcher/CCEventDispatcher.h"
 #include "script_support/CCScriptSupport.h"
 #include "shaders/CCGLProgram.h"
 // externals
 #include "kazmath/GL/matrix.h"
 #include "support/component/CCComponent.h"
 #include "support/component/CCComponentContainer.h"
+#include "support/CCGPUProfiler.h"
+#include "renderer/CCRenderer.h"
+#include "misc_nodes/CCRenderTexture.h"
+#include <string.h>
+#include <algorithm>
 
 #if CC_NODE_RENDER_SUBPIXEL
 #define RENDER_IN_SUBPIXEL
@@ -51,8 +57,49 @@ NS_CC_BEGIN
 // XXX: Yes, nodes might have a sort problem once every 15 days if the game runs at 60 FPS and each frame sprites are reordered.
 static int s_globalOrderOfArrival = 1;
 
+unsigned int Node::s_renderCacheCount = 0;
+unsigned int Node::s_renderCacheDepth = 0;
+
+// The fields of a Node that most nodes don't use. They would make every node bigger, and spread the fields
+// used every frame over more cache lines.
+struct Node::Extension
+{
+    Extension()
+    : camera(NULL)
+    , userData(NULL)
+    , userObject(NULL)
+    , updateScriptHandler(0)
+    , componentContainer(NULL)
+    , gpuProfileZone(0)
+    , renderCache(NULL)
+    {
+    }
+
+    Camera *camera;
+    void *userData;
+    Object *userObject;
+    int updateScriptHandler;
+    ComponentContainer *componentContainer;
+    unsigned int gpuProfileZone;
+    RenderTexture *renderCache;
+};
+
 Node::Node(void)
-: _rotationX(0.0f)
+: _parent(NULL)
+, _ZOrder(0)
+, _orderOfArrival(0)
+// "whole screen" objects. like Scenes and Layers, should set _ignoreAnchorPointForPosition to true
+, _tag(kNodeTagInvalid)
+, _indexInParent(0)
+, _running(false)
+, _visible(true)
+, _ignoreAnchorPointForPosition(false)
+, _reorderChildDirty(false)
+, _childIndicesDirty(false)
+, _isTransitionFinished(false)
+, _renderCacheEnabled(false)
+, _renderCacheDirty(true)
+, _rotationX(0.0f)
 , _rotationY(0.0f)
 , _scaleX(1.0f)
 , _scaleY(1.0f)
@@ -69,27 +116,15 @@ Node::Node(void)
 , _additionalTransformDirty(false)
 , _transformDirty(true)
 , _inverseDirty(true)
-, _camera(NULL)
-// children (lazy allocs)
+, _modelViewNodeToParent(AffineTransformMakeIdentity())
+, _modelViewVertexZ(0.0f)
+, _modelViewDirty(true)
 // lazy alloc
 , _grid(NULL)
-, _ZOrder(0)
-, _children(NULL)
-, _parent(NULL)
-// "whole screen" objects. like Scenes and Layers, should set _ignoreAnchorPointForPosition to true
-, _tag(kNodeTagInvalid)
-// userData is always inited as nil
-, _userData(NULL)
-, _userObject(NULL)
 , _shaderProgram(NULL)
-, _orderOfArrival(0)
-, _running(false)
-, _visible(true)
-, _ignoreAnchorPointForPosition(false)
-, _reorderChildDirty(false)
-, _isTransitionFinished(false)
-, _updateScriptHandler(0)
-, _componentContainer(NULL)
+, _childTagIndex(NULL)
+// camera, userData, components... are allocated when they are set
+, _extension(NULL)
 {
     // set default scheduler and actionManager
     Director *director = Director::getInstance();
@@ -97,49 +132,67 @@ Node::Node(void)
     _actionManager->retain();
     _scheduler = director->getScheduler();
     _scheduler->retain();
+    _eventDispatcher = director->getEventDispatcher();
+    _eventDispatcher->retain();
+
+    kmMat4Identity(&_modelViewTransform);
+    kmMat4Identity(&_parentModelViewTransform);
 
     ScriptEngineProtocol* pEngine = ScriptEngineManager::getInstance()->getScriptEngine();
     _scriptType = pEngine != NULL ? pEngine->getScriptType() : kScriptTypeNone;
-    _componentContainer = new ComponentContainer(this);
 }
 
 Node::~Node()
 {
     CCLOGINFO( "cocos2d: deallocing: %p", this );
+
+    setRenderCacheEnabled(false);
     
-    if (_updateScriptHandler)
+    if (_extension && _extension->updateScriptHandler)
     {
-        ScriptEngineManager::getInstance()->getScriptEngine()->removeScriptHandler(_updateScriptHandler);
+        ScriptEngineManager::getInstance()->getScriptEngine()->removeScriptHandler(_extension->updateScriptHandler);
     }
 
     CC_SAFE_RELEASE(_actionManager);
     CC_SAFE_RELEASE(_scheduler);
+
+    _eventDispatcher->removeEventListenersForNode(this);
+    CC_SAFE_RELEASE(_eventDispatcher);
     // attributes
-    CC_SAFE_RELEASE(_camera);
+    if (_extension)
+    {
+        CC_SAFE_RELEASE(_extension->camera);
+        CC_SAFE_RELEASE(_extension->userObject);
+    }
 
     CC_SAFE_RELEASE(_grid);
     CC_SAFE_RELEASE(_shaderProgram);
-    CC_SAFE_RELEASE(_userObject);
 
-    if(_children && _children->count() > 0)
+    for (auto child : _children)
     {
-        Object* child;
-        CCARRAY_FOREACH(_children, child)
+        child->_parent = NULL;
+    }
+    CC_SAFE_DELETE(_childTagIndex);
+    
+    if (_extension)
+    {
+        // _comsContainer
+        if (_extension->componentContainer)
         {
-            Node* node = static_cast<Node*>(child);
-            if (node)
-            {
-                node->_parent = NULL;
-            }
+            _extension->componentContainer->removeAll();
+            CC_SAFE_DELETE(_extension->componentContainer);
         }
+        CC_SAFE_DELETE(_extension);
     }
+}
 
-    // children
-    CC_SAFE_RELEASE(_children);
-    
-          // _comsContainer
-    _componentContainer->removeAll();
-    CC_SAFE_DELETE(_componentContainer);
+Node::Extension* Node::getExtension()
+{
+    if (!_extension)
+    {
+        _extension = new Extension();
+    }
+    return _extension;
 }
 
 bool Node::init()
@@ -156,6 +209,7 @@ void Node::setSkewX(float newSkewX)
 {
     _skewX = newSkewX;
     _transformDirty = _inverseDirty = true;
+    invalidateParentRenderCache();
 }
 
 float Node::getSkewY() const
@@ -168,6 +222,7 @@ void Node::setSkewY(float newSkewY)
     _skewY = newSkewY;
 
     _transformDirty = _inverseDirty = true;
+    invalidateParentRenderCache();
 }
 
 /// zOrder getter
@@ -218,6 +273,7 @@ void Node::setRotation(float newRotation)
 {
     _rotationX = _rotationY = newRotation;
     _transformDirty = _inverseDirty = true;
+    invalidateParentRenderCache();
 }
 
 float Node::getRotationX() const
@@ -229,6 +285,7 @@ void Node::setRotationX(float fRotationX)
 {
     _rotationX = fRotationX;
     _transformDirty = _inverseDirty = true;
+    invalidateParentRenderCache();
 }
 
 float Node::getRotationY() const
@@ -240,6 +297,7 @@ void Node::setRotationY(float fRotationY)
 {
     _rotationY = fRotationY;
     _transformDirty = _inverseDirty = true;
+    invalidateParentRenderCache();
 }
 
 /// scale getter
@@ -254,6 +312,7 @@ void Node::setScale(float scale)
 {
     _scaleX = _scaleY = scale;
     _transformDirty = _inverseDirty = true;
+    invalidateParentRenderCache();
 }
 
 /// scaleX getter
@@ -267,6 +326,7 @@ void Node::setScaleX(float newScaleX)
 {
     _scaleX = newScaleX;
     _transformDirty = _inverseDirty = true;
+    invalidateParentRenderCache();
 }
 
 /// scaleY getter
@@ -280,6 +340,7 @@ void Node::setScaleY(float newScaleY)
 {
     _scaleY = newScaleY;
     _transformDirty = _inverseDirty = true;
+    invalidateParentRenderCache();
 }
 
 /// position getter
@@ -293,6 +354,7 @@ void Node::setPosition(const Point& newPosition)
 {
     _position = newPosition;
     _transformDirty = _inverseDirty = true;
+    invalidateParentRenderCache();
 }
 
 void Node::getPosition(float* x, float* y) const
@@ -328,18 +390,19 @@ void Node::setPositionY(float y)
 
 unsigned int Node::getChildrenCount() const
 {
-    return _children ? _children->count() : 0;
+    return _children.size();
 }
 
 /// camera getter: lazy alloc
 Camera* Node::getCamera()
 {
-    if (!_camera)
+    Extension* extension = getExtension();
+    if (!extension->camera)
     {
-        _camera = new Camera();
+        extension->camera = new Camera();
     }
     
-    return _camera;
+    return extension->camera;
 }
 
 /// grid setter
@@ -360,7 +423,11 @@ bool Node::isVisible() const
 /// isVisible setter
 void Node::setVisible(bool var)
 {
-    _visible = var;
+    if (var != _visible)
+    {
+        _visible = var;
+        invalidateParentRenderCache();
+    }
 }
 
 const Point& Node::getAnchorPointInPoints() const
@@ -381,6 +448,7 @@ void Node::setAnchorPoint(const Point& point)
         _anchorPoint = point;
         _anchorPointInPoints = Point(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y );
         _transformDirty = _inverseDirty = true;
+        invalidateParentRenderCache();
     }
 }
 
@@ -398,6 +466,7 @@ void Node::setContentSize(const Size & size)
 
         _anchorPointInPoints = Point(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y );
         _transformDirty = _inverseDirty = true;
+        invalidateRenderCache();
     }
 }
 
@@ -410,7 +479,21 @@ bool Node::isRunning() const
 /// parent setter
 void Node::setParent(Node * var)
 {
+    if (_parent == var)
+    {
+        return;
+    }
+
+    // the children are added to and removed from the tag index here, as some subclasses add them without addChild
+    if (_parent && _parent->_childTagIndex)
+    {
+        _parent->removeFromChildTagIndex(this, _tag);
+    }
     _parent = var;
+    if (_parent && _parent->_childTagIndex)
+    {
+        _parent->_childTagIndex->insert(std::make_pair(_tag, this));
+    }
 }
 
 /// isRelativeAnchorPoint getter
@@ -425,6 +508,7 @@ void Node::ignoreAnchorPointForPosition(bool newValue)
     {
 		_ignoreAnchorPointForPosition = newValue;
 		_transformDirty = _inverseDirty = true;
+		invalidateParentRenderCache();
 	}
 }
 
@@ -437,13 +521,31 @@ int Node::getTag() const
 /// tag setter
 void Node::setTag(int var)
 {
+    if (_parent && _parent->_childTagIndex && _tag != var)
+    {
+        _parent->removeFromChildTagIndex(this, _tag);
+        _parent->_childTagIndex->insert(std::make_pair(var, this));
+    }
     _tag = var;
 }
 
+void* Node::getUserData()
+{
+    return _extension ? _extension->userData : NULL;
+}
+
+const void* Node::getUserData() const
+{
+    return _extension ? _extension->userData : NULL;
+}
+
 /// userData setter
 void Node::setUserData(void *var)
 {
-    _userData = var;
+    if (var || _extension)
+    {
+        getExtension()->userData = var;
+    }
 }
 
 int Node::getOrderOfArrival() const
@@ -457,11 +559,27 @@ void Node::setOrderOfArrival(int orderOfArrival)
     _orderOfArrival = orderOfArrival;
 }
 
+Object* Node::getUserObject()
+{
+    return _extension ? _extension->userObject : NULL;
+}
+
+const Object* Node::getUserObject() const
+{
+    return _extension ? _extension->userObject : NULL;
+}
+
 void Node::setUserObject(Object *pUserObject)
 {
+    if (!pUserObject && !_extension)
+    {
+        return;
+    }
+
+    Extension* extension = getExtension();
     CC_SAFE_RETAIN(pUserObject);
-    CC_SAFE_RELEASE(_userObject);
-    _userObject = pUserObject;
+    CC_SAFE_RELEASE(extension->userObject);
+    extension->userObject = pUserObject;
 }
 
 void Node::setShaderProgram(GLProgram *pShaderProgram)
@@ -506,9 +624,39 @@ void Node::cleanup()
     }
     
     // timers
-    arrayMakeObjectsPerformSelector(_children, cleanup, Node*);
+    for (auto child : _children)
+    {
+        child->cleanup();
+    }
 }
 
+void Node::resetForReuse()
+{
+    this->cleanup();
+    this->unscheduleUpdate();
+    this->removeAllChildrenWithCleanup(true);
+    _eventDispatcher->removeEventListenersForNode(this);
+    this->removeAllComponents();
+
+    this->setPosition(Point::ZERO);
+    this->setRotation(0.0f);
+    this->setScale(1.0f);
+    this->setSkewX(0.0f);
+    this->setSkewY(0.0f);
+    this->setVertexZ(0.0f);
+    this->setVisible(true);
+    this->setGrid(NULL);
+    this->setUserObject(NULL);
+    this->setUserData(NULL);
+    _tag = kNodeTagInvalid;
+    _ZOrder = 0;
+    _orderOfArrival = 0;
+
+    _additionalTransform = AffineTransformMakeIdentity();
+    _additionalTransformDirty = false;
+    _transformDirty = _inverseDirty = true;
+    _modelViewDirty = true;
+}
 
 const char* Node::description() const
 {
@@ -518,27 +666,72 @@ const char* Node::description() const
 // lazy allocs
 void Node::childrenAlloc(void)
 {
-    _children = Array::createWithCapacity(4);
-    _children->retain();
+    _children.reserve(4);
 }
 
 Node* Node::getChildByTag(int aTag)
 {
     CCASSERT( aTag != kNodeTagInvalid, "Invalid tag");
 
-    if(_children && _children->count() > 0)
+    if (_childTagIndex)
+    {
+        auto range = _childTagIndex->equal_range(aTag);
+        if (range.first == range.second)
+        {
+            return NULL;
+        }
+        auto next = range.first;
+        if (++next == range.second)
+        {
+            return range.first->second;
+        }
+        // several children have the tag: the 1st one in the children is returned, as without the index
+    }
+
+    for (auto child : _children)
     {
-        Object* child;
-        CCARRAY_FOREACH(_children, child)
+        if (child->_tag == aTag)
         {
-            Node* pNode = static_cast<Node*>(child);
-            if(pNode && pNode->_tag == aTag)
-                return pNode;
+            return child;
         }
     }
     return NULL;
 }
 
+void Node::setChildTagIndexEnabled(bool enabled)
+{
+    if (enabled == (_childTagIndex != NULL))
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        _childTagIndex = new std::unordered_multimap<int, Node*>();
+        for (auto child : _children)
+        {
+            _childTagIndex->insert(std::make_pair(child->_tag, child));
+        }
+    }
+    else
+    {
+        CC_SAFE_DELETE(_childTagIndex);
+    }
+}
+
+void Node::removeFromChildTagIndex(Node* child, int tag)
+{
+    auto range = _childTagIndex->equal_range(tag);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == child)
+        {
+            _childTagIndex->erase(it);
+            return;
+        }
+    }
+}
+
 /* "add" logic MUST only be on this method
 * If a class want's to extend the 'addChild' behavior it only needs
 * to override this method
@@ -548,7 +741,7 @@ void Node::addChild(Node *child, int zOrder, int tag)
     CCASSERT( child != NULL, "Argument must be non-nil");
     CCASSERT( child->_parent == NULL, "child already added. It can't be added again");
 
-    if( ! _children )
+    if (_children.empty())
     {
         this->childrenAlloc();
     }
@@ -601,13 +794,8 @@ void Node::removeFromParentAndCleanup(bool cleanup)
 */
 void Node::removeChild(Node* child, bool cleanup /* = true */)
 {
-    // explicit nil handling
-    if (_children == NULL)
-    {
-        return;
-    }
-
-    if ( _children->containsObject(child) )
+    // a node is the parent of the nodes in its children, and only of them
+    if (child && child->_parent == this)
     {
         this->detachChild(child,cleanup);
     }
@@ -637,34 +825,27 @@ void Node::removeAllChildren()
 void Node::removeAllChildrenWithCleanup(bool cleanup)
 {
     // not using detachChild improves speed here
-    if ( _children && _children->count() > 0 )
+    for (auto child : _children)
     {
-        Object* child;
-        CCARRAY_FOREACH(_children, child)
+        // IMPORTANT:
+        //  -1st do onExit
+        //  -2nd cleanup
+        if(_running)
         {
-            Node* pNode = static_cast<Node*>(child);
-            if (pNode)
-            {
-                // IMPORTANT:
-                //  -1st do onExit
-                //  -2nd cleanup
-                if(_running)
-                {
-                    pNode->onExitTransitionDidStart();
-                    pNode->onExit();
-                }
-
-                if (cleanup)
-                {
-                    pNode->cleanup();
-                }
-                // set parent nil at the end
-                pNode->setParent(NULL);
-            }
+            child->onExitTransitionDidStart();
+            child->onExit();
         }
-        
-        _children->removeAllObjects();
+
+        if (cleanup)
+        {
+            child->cleanup();
+        }
+        // set parent nil at the end
+        child->setParent(NULL);
     }
+
+    _children.clear();
+    invalidateRenderCache();
     
 }
 
@@ -689,7 +870,21 @@ void Node::detachChild(Node *child, bool doCleanup)
     // set parent nil at the end
     child->setParent(NULL);
 
-    _children->removeObject(child);
+    // The index of the child is exact, unless children before it were removed since the indices were refreshed:
+    // it is then a few slots before. The indices are refreshed once, at the next sortAllChildren().
+    int index = MIN(child->_indexInParent, (int)_children.size() - 1);
+    while (index >= 0 && _children.at(index) != child)
+    {
+        --index;
+    }
+    if (index < 0)
+    {
+        // the children were changed without addChild (eg: inserted by a subclass)
+        index = _children.getIndex(child);
+    }
+    _children.erase(index);
+    _childIndicesDirty = true;
+    invalidateRenderCache();
 }
 
 
@@ -697,45 +892,95 @@ void Node::detachChild(Node *child, bool doCleanup)
 void Node::insertChild(Node* child, int z)
 {
     _reorderChildDirty = true;
-    ccArrayAppendObjectWithResize(_children->data, child);
+    _eventDispatcher->setDirtyForSceneGraph();
+    _children.pushBack(child);
+    child->_indexInParent = _children.size() - 1;
     child->_setZOrder(z);
+    invalidateRenderCache();
 }
 
 void Node::reorderChild(Node *child, int zOrder)
 {
     CCASSERT( child != NULL, "Child must be non-nil");
     _reorderChildDirty = true;
+    _eventDispatcher->setDirtyForSceneGraph();
     child->setOrderOfArrival(s_globalOrderOfArrival++);
     child->_setZOrder(zOrder);
+    invalidateRenderCache();
 }
 
-void Node::sortAllChildren()
+// arrays smaller than this, or with less misplaced nodes than this, are sorted with an insertion sort
+static const int INSERTION_SORT_THRESHOLD = 32;
+
+bool Node::sortNodes(Node** x, int length)
 {
-    if (_reorderChildDirty)
+    auto nodeComparisonLess = [](const Node* n1, const Node* n2) {
+        return n1->_ZOrder < n2->_ZOrder || (n1->_ZOrder == n2->_ZOrder && n1->_orderOfArrival < n2->_orderOfArrival);
+    };
+
+    // detect already sorted arrays: the common case when nothing moved
+    int misplaced = 0;
+    for (int i = 1; i < length; i++)
     {
-        int i,j,length = _children->data->num;
-        Node ** x = (Node**)_children->data->arr;
-        Node *tempItem;
+        if (nodeComparisonLess(x[i], x[i-1]))
+        {
+            misplaced++;
+        }
+    }
 
-        // insertion sort
-        for(i=1; i<length; i++)
+    if (misplaced == 0)
+    {
+        return false;
+    }
+
+    if (length < INSERTION_SORT_THRESHOLD || misplaced < INSERTION_SORT_THRESHOLD)
+    {
+        // insertion sort: linear on mostly sorted arrays
+        for (int i = 1; i < length; i++)
         {
-            tempItem = x[i];
-            j = i-1;
+            Node* tempItem = x[i];
+            int j = i - 1;
 
             //continue moving element downwards while zOrder is smaller or when zOrder is the same but mutatedIndex is smaller
-            while(j>=0 && ( tempItem->_ZOrder < x[j]->_ZOrder || ( tempItem->_ZOrder== x[j]->_ZOrder && tempItem->_orderOfArrival < x[j]->_orderOfArrival ) ) )
+            while (j >= 0 && nodeComparisonLess(tempItem, x[j]))
             {
                 x[j+1] = x[j];
                 j = j-1;
             }
             x[j+1] = tempItem;
         }
+    }
+    else
+    {
+        // orderOfArrival makes the keys unique, but the sort must be stable for nodes added in the same frame
+        std::stable_sort(x, x + length, nodeComparisonLess);
+    }
+
+    return true;
+}
+
+void Node::sortAllChildren()
+{
+    if (_reorderChildDirty)
+    {
+        if (sortNodes(_children.data(), _children.size()))
+        {
+            _childIndicesDirty = true;
+        }
 
         //don't need to check children recursively, that's done in visit of each child
 
         _reorderChildDirty = false;
     }
+
+    if (_childIndicesDirty)
+    {
+        for (int i = 0, count = _children.size(); i < count; ++i)
+        {
+            _children.at(i)->_indexInParent = i;
+        }
+        _childIndicesDirty = false;
+    }
 }
 
 
@@ -754,6 +999,16 @@ void Node::visit()
     {
         return;
     }
+
+    // the commands of the subtree are executed apart to be measured
+    unsigned int gpuProfileZone = _extension ? _extension->gpuProfileZone : 0;
+    bool gpuZone = gpuProfileZone != 0 && GPUProfiler::isEnabled();
+    if (gpuZone)
+    {
+        Director::getInstance()->getRenderer()->flush();
+        GPUProfiler::getInstance()->beginZone(gpuProfileZone);
+    }
+
     kmGLPushMatrix();
 
      if (_grid && _grid->isActive())
@@ -763,17 +1018,45 @@ void Node::visit()
 
     this->transform();
 
+    // a cached subtree being rendered into the cache of an ancestor is drawn as it is
+    if (_renderCacheEnabled && s_renderCacheDepth == 0)
+    {
+        drawRenderCache();
+    }
+    else
+    {
+        drawSubtree();
+    }
+
+    // reset for next frame
+    _orderOfArrival = 0;
+
+     if (_grid && _grid->isActive())
+     {
+         _grid->afterDraw(this);
+    }
+
+    if (gpuZone)
+    {
+        Director::getInstance()->getRenderer()->flush();
+        GPUProfiler::getInstance()->endZone(gpuProfileZone);
+    }
+ 
+    kmGLPopMatrix();
+}
+
+void Node::drawSubtree()
+{
     Node* pNode = NULL;
     unsigned int i = 0;
 
-    if(_children && _children->count() > 0)
+    if(!_children.empty())
     {
         sortAllChildren();
         // draw children zOrder < 0
-        ccArray *arrayData = _children->data;
-        for( ; i < arrayData->num; i++ )
+        for( ; i < _children.size(); i++ )
         {
-            pNode = (Node*) arrayData->arr[i];
+            pNode = _children.at(i);
 
             if ( pNode && pNode->_ZOrder < 0 ) 
             {
@@ -787,29 +1070,122 @@ void Node::visit()
         // self draw
         this->draw();
 
-        for( ; i < arrayData->num; i++ )
+        for( ; i < _children.size(); i++ )
         {
-            pNode = (Node*) arrayData->arr[i];
-            if (pNode)
-            {
-                pNode->visit();
-            }
+            _children.at(i)->visit();
         }        
     }
     else
     {
         this->draw();
     }
+}
 
-    // reset for next frame
-    _orderOfArrival = 0;
+void Node::drawRenderCache()
+{
+    int width = (int)_contentSize.width;
+    int height = (int)_contentSize.height;
+    if (width <= 0 || height <= 0)
+    {
+        drawSubtree();
+        return;
+    }
 
-     if (_grid && _grid->isActive())
-     {
-         _grid->afterDraw(this);
+    RenderTexture*& renderCache = getExtension()->renderCache;
+    if (_renderCacheDirty || !renderCache)
+    {
+        if (renderCache && !renderCache->getSprite()->getContentSize().equals(Size(width, height)))
+        {
+            CC_SAFE_RELEASE_NULL(renderCache);
+        }
+        if (!renderCache)
+        {
+            renderCache = RenderTexture::create(width, height);
+            if (!renderCache)
+            {
+                drawSubtree();
+                return;
+            }
+            renderCache->retain();
+            renderCache->getSprite()->setAnchorPoint(Point(0, 0));
+            renderCache->getSprite()->setPosition(Point(0, 0));
+        }
+
+        // the subtree is rendered in the node space
+        ++s_renderCacheDepth;
+        renderCache->beginWithClear(0, 0, 0, 0);
+        drawSubtree();
+        renderCache->end();
+        --s_renderCacheDepth;
+
+        _renderCacheDirty = false;
     }
- 
-    kmGLPopMatrix();
+
+    renderCache->getSprite()->visit();
+}
+
+void Node::setRenderCacheEnabled(bool enabled)
+{
+    if (enabled == _renderCacheEnabled)
+    {
+        return;
+    }
+
+    _renderCacheEnabled = enabled;
+    _renderCacheDirty = true;
+    if (enabled)
+    {
+        ++s_renderCacheCount;
+    }
+    else
+    {
+        --s_renderCacheCount;
+        if (_extension)
+        {
+            CC_SAFE_RELEASE_NULL(_extension->renderCache);
+        }
+    }
+    invalidateParentRenderCache();
+}
+
+void Node::invalidateRenderCache()
+{
+    // what invalidates a render cache changes the frame as well
+    Director::setNextFrameDirty();
+
+    if (s_renderCacheCount == 0)
+    {
+        return;
+    }
+
+    for (Node* node = this; node; node = node->_parent)
+    {
+        node->_renderCacheDirty = true;
+    }
+}
+
+void Node::invalidateParentRenderCache()
+{
+    Director::setNextFrameDirty();
+
+    if (s_renderCacheCount > 0 && _parent)
+    {
+        _parent->invalidateRenderCache();
+    }
+}
+
+void Node::setGPUProfileZone(const char* name)
+{
+    if (name || _extension)
+    {
+        getExtension()->gpuProfileZone = name ? GPUProfiler::registerZone(name) : 0;
+    }
+}
+
+const char* Node::getGPUProfileZone() const
+{
+    unsigned int gpuProfileZone = _extension ? _extension->gpuProfileZone : 0;
+    return gpuProfileZone ? GPUProfiler::getZoneName(gpuProfileZone) : nullptr;
 }
 
 void Node::transformAncestors()
@@ -823,27 +1199,48 @@ void Node::transformAncestors()
 
 void Node::transform()
 {    
-    kmMat4 transfrom4x4;
+    kmMat4 parentTransform;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &parentTransform);
 
-    // Convert 3x3 into 4x4 matrix
     AffineTransform tmpAffine = this->getNodeToParentTransform();
-    CGAffineToGL(&tmpAffine, transfrom4x4.mat);
 
-    // Update Z vertex manually
-    transfrom4x4.mat[14] = _vertexZ;
+    // Nodes that didn't move, in a parent that didn't move, reuse the matrix of the previous frame.
+    // getNodeToParentTransform() is compared instead of using a dirty flag, because subclasses
+    // may compute it from other sources (eg: a physics body)
+    if (_modelViewDirty
+        || _modelViewVertexZ != _vertexZ
+        || memcmp(&_modelViewNodeToParent, &tmpAffine, sizeof(tmpAffine)) != 0
+        || memcmp(&_parentModelViewTransform, &parentTransform, sizeof(parentTransform)) != 0)
+    {
+        kmMat4 transfrom4x4;
+
+        // Convert 3x3 into 4x4 matrix
+        CGAffineToGL(&tmpAffine, transfrom4x4.mat);
+
+        // Update Z vertex manually
+        transfrom4x4.mat[14] = _vertexZ;
 
-    kmGLMultMatrix( &transfrom4x4 );
+        kmMat4Multiply(&_modelViewTransform, &parentTransform, &transfrom4x4);
+
+        _parentModelViewTransform = parentTransform;
+        _modelViewNodeToParent = tmpAffine;
+        _modelViewVertexZ = _vertexZ;
+        _modelViewDirty = false;
+    }
+
+    kmGLLoadMatrix(&_modelViewTransform);
 
 
     // XXX: Expensive calls. Camera should be integrated into the cached affine matrix
-    if ( _camera != NULL && !(_grid != NULL && _grid->isActive()) )
+    Camera* camera = _extension ? _extension->camera : NULL;
+    if ( camera != NULL && !(_grid != NULL && _grid->isActive()) )
     {
         bool translate = (_anchorPointInPoints.x != 0.0f || _anchorPointInPoints.y != 0.0f);
 
         if( translate )
             kmGLTranslatef(RENDER_IN_SUBPIXEL(_anchorPointInPoints.x), RENDER_IN_SUBPIXEL(_anchorPointInPoints.y), 0 );
 
-        _camera->locate();
+        camera->locate();
 
         if( translate )
             kmGLTranslatef(RENDER_IN_SUBPIXEL(-_anchorPointInPoints.x), RENDER_IN_SUBPIXEL(-_anchorPointInPoints.y), 0 );
@@ -856,7 +1253,10 @@ void Node::onEnter()
 {
     _isTransitionFinished = false;
 
-    arrayMakeObjectsPerformSelector(_children, onEnter, Node*);
+    for (auto child : _children)
+    {
+        child->onEnter();
+    }
 
     this->resumeSchedulerAndActions();
 
@@ -875,7 +1275,10 @@ void Node::onEnterTransitionDidFinish()
 {
     _isTransitionFinished = true;
 
-    arrayMakeObjectsPerformSelector(_children, onEnterTransitionDidFinish, Node*);
+    for (auto child : _children)
+    {
+        child->onEnterTransitionDidFinish();
+    }
 
     if (_scriptType != kScriptTypeNone)
     {
@@ -888,7 +1291,10 @@ void Node::onEnterTransitionDidFinish()
 
 void Node::onExitTransitionDidStart()
 {
-    arrayMakeObjectsPerformSelector(_children, onExitTransitionDidStart, Node*);
+    for (auto child : _children)
+    {
+        child->onExitTransitionDidStart();
+    }
     if (_scriptType != kScriptTypeNone)
     {
         int action = kNodeOnExitTransitionDidStart;
@@ -911,7 +1317,10 @@ void Node::onExit()
         ScriptEngineManager::getInstance()->getScriptEngine()->sendEvent(&scriptEvent);
     }
 
-    arrayMakeObjectsPerformSelector(_children, onExit, Node*);    
+    for (auto child : _children)
+    {
+        child->onExit();
+    }
 }
 
 void Node::setActionManager(ActionManager* actionManager)
@@ -931,6 +1340,12 @@ Action * Node::runAction(Action* action)
     return action;
 }
 
+void Node::runTemplate(ActionTemplate* actionTemplate)
+{
+    CCASSERT( actionTemplate != NULL, "Argument must be non-nil");
+    _actionManager->addTemplate(actionTemplate, this);
+}
+
 void Node::stopAllActions()
 {
     _actionManager->removeAllActionsFromTarget(this);
@@ -988,17 +1403,17 @@ void Node::scheduleUpdateWithPriority(int priority)
 void Node::scheduleUpdateWithPriorityLua(int nHandler, int priority)
 {
     unscheduleUpdate();
-    _updateScriptHandler = nHandler;
+    getExtension()->updateScriptHandler = nHandler;
     _scheduler->scheduleUpdateForTarget(this, priority, !_running);
 }
 
 void Node::unscheduleUpdate()
 {
     _scheduler->unscheduleUpdateForTarget(this);
-    if (_updateScriptHandler)
+    if (_extension && _extension->updateScriptHandler)
     {
-        ScriptEngineManager::getInstance()->getScriptEngine()->removeScriptHandler(_updateScriptHandler);
-        _updateScriptHandler = 0;
+        ScriptEngineManager::getInstance()->getScriptEngine()->removeScriptHandler(_extension->updateScriptHandler);
+        _extension->updateScriptHandler = 0;
     }
 }
 
@@ -1043,29 +1458,32 @@ void Node::resumeSchedulerAndActions()
 {
     _scheduler->resumeTarget(this);
     _actionManager->resumeTarget(this);
+    if (_extension && _extension->componentContainer)
+    {
+        _extension->componentContainer->_paused = false;
+    }
 }
 
 void Node::pauseSchedulerAndActions()
 {
     _scheduler->pauseTarget(this);
     _actionManager->pauseTarget(this);
+    if (_extension && _extension->componentContainer)
+    {
+        _extension->componentContainer->_paused = true;
+    }
 }
 
 // override me
 void Node::update(float fDelta)
 {
-    if (0 != _updateScriptHandler)
+    if (_extension && 0 != _extension->updateScriptHandler)
     {
         //only lua use
-        SchedulerScriptData data(_updateScriptHandler,fDelta);
+        SchedulerScriptData data(_extension->updateScriptHandler,fDelta);
         ScriptEvent event(kScheduleEvent,&data);
         ScriptEngineManager::getInstance()->getScriptEngine()->sendEvent(&event);
     }
-    
-    if (_componentContainer && !_componentContainer->isEmpty())
-    {
-        _componentContainer->visit(fDelta);
-    }
 }
 
 AffineTransform Node::getNodeToParentTransform() const
@@ -1148,6 +1566,7 @@ void Node::setAdditionalTransform(const AffineTransform& additionalTransform)
 {
     _additionalTransform = additionalTransform;
     _transformDirty = true;
+    invalidateParentRenderCache();
     _additionalTransformDirty = true;
 }
 
@@ -1221,27 +1640,48 @@ Point Node::convertTouchToNodeSpaceAR(Touch *touch) const
 void Node::updateTransform()
 {
     // Recursively iterate over children
-    arrayMakeObjectsPerformSelector(_children, updateTransform, Node*);
+    for (auto child : _children)
+    {
+        child->updateTransform();
+    }
 }
 
 Component* Node::getComponent(const char *pName)
 {
-    return _componentContainer->get(pName);
+    if (!_extension || !_extension->componentContainer)
+    {
+        return NULL;
+    }
+    return _extension->componentContainer->get(pName);
 }
 
 bool Node::addComponent(Component *pComponent)
 {
-    return _componentContainer->add(pComponent);
+    Extension* extension = getExtension();
+    if (!extension->componentContainer)
+    {
+        extension->componentContainer = new ComponentContainer(this);
+        // the components of a node are updated while it runs and isn't paused
+        extension->componentContainer->_paused = !_running || _scheduler->isTargetPaused(this);
+    }
+    return extension->componentContainer->add(pComponent);
 }
 
 bool Node::removeComponent(const char *pName)
 {
-    return _componentContainer->remove(pName);
+    if (!_extension || !_extension->componentContainer)
+    {
+        return false;
+    }
+    return _extension->componentContainer->remove(pName);
 }
 
 void Node::removeAllComponents()
 {
-    _componentContainer->removeAll();
+    if (_extension && _extension->componentContainer)
+    {
+        _extension->componentContainer->removeAll();
+    }
 }
 
 // NodeRGBA
@@ -1256,6 +1696,14 @@ NodeRGBA::NodeRGBA()
 
 NodeRGBA::~NodeRGBA() {}
 
+void NodeRGBA::resetForReuse()
+{
+    Node::resetForReuse();
+
+    this->setColor(Color3B::WHITE);
+    this->setOpacity(255);
+}
+
 bool NodeRGBA::init()
 {
     if (Node::init())
@@ -1281,6 +1729,7 @@ GLubyte NodeRGBA::getDisplayedOpacity(void) const
 void NodeRGBA::setOpacity(GLubyte opacity)
 {
     _displayedOpacity = _realOpacity = opacity;
+    invalidateRenderCache();
     
 	if (_cascadeOpacityEnabled)
     {
@@ -1297,13 +1746,13 @@ void NodeRGBA::setOpacity(GLubyte opacity)
 void NodeRGBA::updateDisplayedOpacity(GLubyte parentOpacity)
 {
 	_displayedOpacity = _realOpacity * parentOpacity/255.0;
+    invalidateRenderCache();
 	
     if (_cascadeOpacityEnabled)
     {
-        Object* pObj;
-        CCARRAY_FOREACH(_children, pObj)
+        for (auto child : _children)
         {
-            RGBAProtocol* item = dynamic_cast<RGBAProtocol*>(pObj);
+            RGBAProtocol* item = dynamic_cast<RGBAProtocol*>(child);
             if (item)
             {
                 item->updateDisplayedOpacity(_displayedOpacity);
@@ -1335,6 +1784,7 @@ const Color3B& NodeRGBA::getDisplayedColor() const
 void NodeRGBA::setColor(const Color3B& color)
 {
 	_displayedColor = _realColor = color;
+    invalidateRenderCache();
 	
 	if (_cascadeColorEnabled)
     {
@@ -1354,13 +1804,13 @@ void NodeRGBA::updateDisplayedColor(const Color3B& parentColor)
 	_displayedColor.r = _realColor.r * parentColor.r/255.0;
 	_displayedColor.g = _realColor.g * parentColor.g/255.0;
 	_displayedColor.b = _realColor.b * parentColor.b/255.0;
+    invalidateRenderCache();
     
     if (_cascadeColorEnabled)
     {
-        Object *obj = NULL;
-        CCARRAY_FOREACH(_children, obj)
+        for (auto child : _children)
         {
-            RGBAProtocol *item = dynamic_cast<RGBAProtocol*>(obj);
+            RGBAProtocol *item = dynamic_cast<RGBAProtocol*>(child);
             if (item)
             {
                 item->updateDisplayedColor(_displayedColor);
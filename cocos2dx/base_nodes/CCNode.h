@@ -31,12 +31,14 @@
 #include "ccMacros.h"
 #include "cocoa/CCAffineTransform.h"
 #include "cocoa/CCArray.h"
+#include "cocoa/CCVector.h"
 #include "CCGL.h"
 #include "shaders/ccGLStateCache.h"
 #include "shaders/CCGLProgram.h"
 #include "kazmath/kazmath.h"
 #include "script_support/CCScriptSupport.h"
 #include "CCProtocols.h"
+#include <unordered_map>
 
 NS_CC_BEGIN
 
@@ -45,13 +47,16 @@ class GridBase;
 class Point;
 class Touch;
 class Action;
+class ActionTemplate;
 class RGBAProtocol;
 class LabelProtocol;
 class Scheduler;
 class ActionManager;
+class EventDispatcher;
 class Component;
 class Dictionary;
 class ComponentContainer;
+class RenderTexture;
 
 /**
  * @addtogroup base_nodes
@@ -580,24 +585,32 @@ public:
      * @return a Node object whose tag equals to the input parameter
      */
     Node * getChildByTag(int tag);
+    /**
+     * Indexes the children by tag, so that getChildByTag() doesn't scan the children.
+     * It costs a hash map entry per child: enable it on nodes with many children looked up by tag.
+     *
+     * @since v3.0
+     */
+    void setChildTagIndexEnabled(bool enabled);
+    /** Returns whether the children are indexed by tag */
+    inline bool isChildTagIndexEnabled() const { return _childTagIndex != NULL; }
     /**
      * Return an array of children
      *
      * Composing a "tree" structure is a very important feature of Node
      * Here's a sample code of traversing children array:
      * @code
-     * Node* node = NULL;
-     * CCARRAY_FOREACH(parent->getChildren(), node)
+     * for (auto node : parent->getChildren())
      * {
      *     node->setPosition(0,0);
      * }
      * @endcode
      * This sample code traverses all children nodes, and set theie position to (0,0)
      *
-     * @return An array of children
+     * @return A vector of children. It is changed by addChild, removeChild and sortAllChildren.
      */
-    virtual Array* getChildren() { return _children; }
-    virtual const Array *getChildren() const { return _children; }
+    virtual Vector<Node*>& getChildren() { return _children; }
+    virtual const Vector<Node*>& getChildren() const { return _children; }
     
     /** 
      * Get the amount of children.
@@ -725,8 +738,7 @@ public:
      * parent->addChild(node2);
      * parent->addChild(node3);
      * // identify by tags
-     * Node* node = NULL;
-     * CCARRAY_FOREACH(parent->getChildren(), node)
+     * for (auto node : parent->getChildren())
      * {
      *     switch(node->getTag())
      *     {
@@ -759,8 +771,8 @@ public:
      * 
      * @return A custom user data pointer
      */
-    virtual void* getUserData() { return _userData; }
-    virtual const void* getUserData() const { return _userData; }
+    virtual void* getUserData();
+    virtual const void* getUserData() const;
 
     /**
      * Sets a custom user data pointer
@@ -780,8 +792,8 @@ public:
      *
      * @return A user assigned Object
      */
-    virtual Object* getUserObject() { return _userObject; }
-    virtual const Object* getUserObject() const { return _userObject; }
+    virtual Object* getUserObject();
+    virtual const Object* getUserObject() const;
 
     /**
      * Returns a user assigned Object
@@ -821,6 +833,45 @@ public:
      */
     virtual void setShaderProgram(GLProgram *shaderProgram);
     /// @} end of Shader Program
+
+
+    /// @{
+    /// @name GPU Profiling
+    /**
+     * Measures the GPU time of the subtree of this node in a zone of GPUProfiler, while it is enabled.
+     * The commands of the subtree are rendered apart, so they aren't batched with the ones around it.
+     *
+     * @param name  The name of the zone, a string literal, or nullptr to stop measuring the subtree.
+     */
+    void setGPUProfileZone(const char* name);
+    /**
+     * Returns the name of the GPU zone of the subtree, or nullptr when it isn't measured
+     */
+    const char* getGPUProfileZone() const;
+    /// @} end of GPU Profiling
+
+
+    /// @{
+    /// @name Render Cache
+    /**
+     * Renders the node and its children once into a RenderTexture, then draws the texture as a single quad
+     * until the render cache is invalidated. Meant for static subtrees, like the panels of a HUD.
+     *
+     * Only the content between (0,0) and the content size of the node is kept. The cached subtree isn't visited,
+     * so its nodes aren't drawn again, and the render caches of its nodes aren't used.
+     * The cache is invalidated by the transform, visibility, children, color and opacity changes of the subtree,
+     * and by the changes of the texture rect and frame of its sprites and of the strings of its labels.
+     */
+    void setRenderCacheEnabled(bool enabled);
+    inline bool isRenderCacheEnabled() const { return _renderCacheEnabled; }
+    /**
+     * Renders the subtree into the render caches of this node and of its ancestors again, the next time they are drawn.
+     * It marks the next frame dirty too, see Director::setNextFrameDirty().
+     * It must be called when a node of a cached subtree is drawn differently in a way that isn't detected,
+     * like a custom draw() or a change to a TextureAtlas.
+     */
+    void invalidateRenderCache();
+    /// @} end of Render Cache
     
     
     /**
@@ -892,6 +943,15 @@ public:
      */
     virtual void cleanup();
 
+    /**
+     * Puts back a node removed from its parent in the state of a new node, to reuse it instead of creating another one.
+     * Cleans it up, removes its children, event listeners and components, and resets its position, rotation, scale,
+     * skew, vertex Z, visibility, Z order, tag, user data and object, and grid. The content size, anchor point,
+     * shader program and the resources of the subclasses, like the texture of a sprite, are kept.
+     * @see ObjectPool
+     */
+    virtual void resetForReuse();
+
     /** 
      * Override this method to draw your own node.
      * The following GL states will be enabled by default:
@@ -924,6 +984,21 @@ public:
     /** @deprecated Use getBoundingBox instead */
     CC_DEPRECATED_ATTRIBUTE inline virtual Rect boundingBox() const { return getBoundingBox(); }
 
+    /// @{
+    /// @name Event Dispatcher
+
+    /**
+     * Gets the EventDispatcher of the listeners bound to this node.
+     * The listeners bound to a node are removed when the node is destroyed.
+     *
+     * @see EventDispatcher::addEventListenerWithSceneGraphPriority(EventListener*, Node*)
+     * @return An EventDispatcher object.
+     */
+    EventDispatcher* getEventDispatcher() const { return _eventDispatcher; }
+
+    /// @} end of Event Dispatcher
+
+
     /// @{
     /// @name Actions
 
@@ -953,6 +1028,14 @@ public:
      */
     Action* runAction(Action* action);
 
+    /**
+     * Runs an ActionTemplate on this node. The steps of the template are shared by all the nodes running it:
+     * unlike runAction(), nothing is cloned nor allocated per node.
+     * The template is stopped by stopAllActions().
+     * @since v3.0
+     */
+    void runTemplate(ActionTemplate* actionTemplate);
+
     /** 
      * Stops and removes all actions from the running action list .
      */
@@ -1131,6 +1214,7 @@ public:
     
     /**
      * Performs OpenGL view-matrix transformation based on position, scale, rotation and other attributes.
+     * The resulting model-view matrix is cached: it is only computed again when the node or its parent moved.
      */
     void transform();
     /**
@@ -1154,6 +1238,13 @@ public:
      */
     virtual AffineTransform getNodeToParentTransform() const;
 
+    /**
+     * Returns the model-view matrix computed by the last call to transform(), usually during the last visit.
+     * It doesn't include the transformation of the camera.
+     * @since v3.0
+     */
+    inline const kmMat4& getModelViewTransform() const { return _modelViewTransform; }
+
     /** @deprecated use getNodeToParentTransform() instead */
     CC_DEPRECATED_ATTRIBUTE inline virtual AffineTransform nodeToParentTransform() const { return getNodeToParentTransform(); }
 
@@ -1280,7 +1371,7 @@ public:
     Component* getComponent(const char *pName);
     
     /** 
-     *   adds a component
+     *   adds a component. The components are updated every frame by the ComponentSystem, while the node is running
      */
     virtual bool addComponent(Component *pComponent);
     
@@ -1304,11 +1395,51 @@ private:
     
     /// Removes a child, call child->onExit(), do cleanup, remove it from children array.
     void detachChild(Node *child, bool doCleanup);
+
+    /// Removes the child from the tag index, under the tag it was indexed with
+    void removeFromChildTagIndex(Node* child, int tag);
     
     /// Convert cocos2d coordinates to UI windows coordinate.
     Point convertToWindowSpace(const Point& nodePoint) const;
 
+    /// Draws the node and its children, in the node space.
+    void drawSubtree();
+
+    /// Renders the subtree into the render cache if needed, and draws it.
+    void drawRenderCache();
+
+    /// Invalidates the render caches of the ancestors, when the node moved, and marks the next frame dirty.
+    void invalidateParentRenderCache();
+
 protected:
+    /** Sorts nodes by zOrder, then by orderOfArrival.
+     * Already sorted arrays are detected with a single pass, mostly sorted or small arrays use
+     * an insertion sort, and big arrays with many misplaced nodes use a stable merge sort.
+     * @return true if the order of the nodes changed
+     * @since v3.0
+     */
+    static bool sortNodes(Node** nodes, int count);
+
+    // The fields used every frame come first. The ones that most nodes don't use are in _extension.
+
+    Vector<Node*> _children;        ///< array of children nodes
+    Node *_parent;                  ///< weak reference to parent node
+
+    int _ZOrder;                      ///< z-order value that affects the draw order
+    int _orderOfArrival;            ///< used to preserve sequence while sorting children with the same zOrder
+    int _tag;                         ///< a tag. Can be any number you assigned just to identify this node
+    int _indexInParent;               ///< index in the children of the parent, refreshed by sortAllChildren(). Too big after removals
+
+    bool _running;                    ///< is running
+    bool _visible;                    ///< is this node visible
+    bool _ignoreAnchorPointForPosition; ///< true if the Anchor Point will be (0,0) when you position the Node, false otherwise.
+                                          ///< Used by Layer and Scene.
+    bool _reorderChildDirty;          ///< children order dirty flag
+    bool _childIndicesDirty;          ///< the _indexInParent of the children must be refreshed
+    bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
+    bool _renderCacheEnabled;         ///< whether the subtree is drawn from the render cache
+    bool _renderCacheDirty;           ///< whether the subtree must be rendered into the render cache again
+
     float _rotationX;                 ///< rotation angle on x-axis
     float _rotationY;                 ///< rotation angle on y-axis
     
@@ -1335,43 +1466,36 @@ protected:
     mutable bool _transformDirty;             ///< transform dirty flag
     mutable bool _inverseDirty;               ///< inverse transform dirty flag
 
-    Camera *_camera;                ///< a camera
-    
+    kmMat4 _modelViewTransform;               ///< cached model-view matrix, computed by transform()
+    kmMat4 _parentModelViewTransform;         ///< model-view matrix of the parent used to compute _modelViewTransform
+    AffineTransform _modelViewNodeToParent;   ///< node to parent transform used to compute _modelViewTransform
+    float _modelViewVertexZ;                  ///< vertexZ used to compute _modelViewTransform
+    bool _modelViewDirty;                     ///< whether _modelViewTransform was never computed
+
     GridBase *_grid;                ///< a grid
     
-    int _ZOrder;                      ///< z-order value that affects the draw order
-    
-    Array *_children;               ///< array of children nodes
-    Node *_parent;                  ///< weak reference to parent node
-    
-    int _tag;                         ///< a tag. Can be any number you assigned just to identify this node
-    
-    void *_userData;                  ///< A user assingned void pointer, Can be point to any cpp object
-    Object *_userObject;            ///< A user assigned Object
-    
     GLProgram *_shaderProgram;      ///< OpenGL shader
 
-    int _orderOfArrival;            ///< used to preserve sequence while sorting children with the same zOrder
-    
     Scheduler *_scheduler;          ///< scheduler used to schedule timers and updates
     
     ActionManager *_actionManager;  ///< a pointer to ActionManager singleton, which is used to handle all the actions
-    
-    bool _running;                    ///< is running
-    
-    bool _visible;                    ///< is this node visible
-    
-    bool _ignoreAnchorPointForPosition; ///< true if the Anchor Point will be (0,0) when you position the Node, false otherwise.
-                                          ///< Used by Layer and Scene.
-    
-    bool _reorderChildDirty;          ///< children order dirty flag
-    bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
-    
-    int _scriptHandler;               ///< script handler for onEnter() & onExit(), used in Javascript binding and Lua binding.
-    int _updateScriptHandler;         ///< script handler for update() callback per frame, which is invoked from lua & javascript.
+
+    EventDispatcher *_eventDispatcher;  ///< dispatcher of the listeners bound to this node
+
+    std::unordered_multimap<int, Node*>* _childTagIndex; ///< children by tag, when enabled
+
     ccScriptType _scriptType;         ///< type of script binding, lua or javascript
-    
-    ComponentContainer *_componentContainer;        ///< Dictionary of components
+
+    /// The camera, user data, user object, update script handler, components, GPU profile zone and render cache.
+    /// Allocated by the 1st of them that is set.
+    struct Extension;
+    Extension *_extension;
+
+    /// Returns the extension, allocating it
+    Extension* getExtension();
+
+    static unsigned int s_renderCacheCount;  ///< nodes with a render cache, ancestors are only walked when there are some
+    static unsigned int s_renderCacheDepth;  ///< render caches being rendered
 
 };
 
@@ -1412,6 +1536,9 @@ public:
     virtual void setOpacityModifyRGB(bool bValue) override {CC_UNUSED_PARAM(bValue);};
     virtual bool isOpacityModifyRGB() const override { return false; };
 
+    /** also resets the color to white and the opacity to 255 */
+    virtual void resetForReuse() override;
+
 protected:
 	GLubyte		_displayedOpacity;
     GLubyte     _realOpacity;
@@ -28,58 +28,81 @@ NS_CC_BEGIN
 
 static PoolManager* s_pPoolManager = NULL;
 
+// objects autoreleased per frame by a simple scene, the vector grows beyond if needed and keeps its capacity
+#define AUTORELEASE_POOL_RESERVED_OBJECTS 256
+
 AutoreleasePool::AutoreleasePool(void)
+: _lastClearedCount(0)
+, _peakCount(0)
 {
-    _managedObjectArray = new Array();
-    _managedObjectArray->init();
+    _managedObjectArray.reserve(AUTORELEASE_POOL_RESERVED_OBJECTS);
 }
 
 AutoreleasePool::~AutoreleasePool(void)
 {
-    CC_SAFE_DELETE(_managedObjectArray);
+    clear();
 }
 
 void AutoreleasePool::addObject(Object* pObject)
 {
-    _managedObjectArray->addObject(pObject);
+    CCASSERT(pObject->_reference > 0, "reference count should be greater than 0");
 
-    CCASSERT(pObject->_reference > 1, "reference count should be greater than 1");
+    // the pool takes over the reference of the caller
+    _managedObjectArray.push_back(pObject);
     ++(pObject->_autoReleaseCount);
-    pObject->release(); // no ref count, in this case autorelease pool added.
+
+    if (_managedObjectArray.size() > _peakCount)
+    {
+        _peakCount = (unsigned int)_managedObjectArray.size();
+    }
 }
 
 void AutoreleasePool::removeObject(Object* pObject)
 {
-    for (unsigned int i = 0; i < pObject->_autoReleaseCount; ++i)
+    // the most recently added objects are the most likely to be removed
+    unsigned int count = pObject->_autoReleaseCount;
+    for (auto iter = _managedObjectArray.rbegin(); count > 0 && iter != _managedObjectArray.rend(); )
     {
-        _managedObjectArray->removeObject(pObject, false);
+        if (*iter == pObject)
+        {
+            iter = std::vector<Object*>::reverse_iterator(_managedObjectArray.erase(std::next(iter).base()));
+            --count;
+        }
+        else
+        {
+            ++iter;
+        }
     }
 }
 
 void AutoreleasePool::clear()
 {
-    if(_managedObjectArray->count() > 0)
+    if (_managedObjectArray.empty())
     {
-        //CCAutoreleasePool* pReleasePool;
-#ifdef _DEBUG
-        int nIndex = _managedObjectArray->count() - 1;
-#endif
+        _lastClearedCount = 0;
+        return;
+    }
 
-        Object* pObj = NULL;
-        CCARRAY_FOREACH_REVERSE(_managedObjectArray, pObj)
-        {
-            if(!pObj)
-                break;
-
-            --(pObj->_autoReleaseCount);
-            //(*it)->release();
-            //delete (*it);
-#ifdef _DEBUG
-            nIndex--;
-#endif
-        }
+    // the objects autoreleased by the destructors go to the emptied pool, and are released by the next clear()
+    std::vector<Object*> releasedObjects;
+    releasedObjects.swap(_managedObjectArray);
+    _lastClearedCount = (unsigned int)releasedObjects.size();
 
-        _managedObjectArray->removeAllObjects();
+    // the objects must not remove themselves from the pool when they are deleted
+    for (auto iter = releasedObjects.begin(); iter != releasedObjects.end(); ++iter)
+    {
+        --((*iter)->_autoReleaseCount);
+    }
+    for (auto iter = releasedObjects.rbegin(); iter != releasedObjects.rend(); ++iter)
+    {
+        (*iter)->release();
+    }
+
+    // keep the allocated vector for the next frame
+    if (_managedObjectArray.empty())
+    {
+        releasedObjects.clear();
+        _managedObjectArray.swap(releasedObjects);
     }
 }
 
@@ -106,8 +129,6 @@ void PoolManager::purgePoolManager()
 
 PoolManager::PoolManager()
 {
-    _releasePoolStack = new Array();    
-    _releasePoolStack->init();
     _curReleasePool = 0;
 }
 
@@ -118,24 +139,18 @@ PoolManager::~PoolManager()
  
      // we only release the last autorelease pool here 
     _curReleasePool = 0;
-     _releasePoolStack->removeObjectAtIndex(0);
- 
-     CC_SAFE_DELETE(_releasePoolStack);
+    for (auto iter = _releasePoolStack.begin(); iter != _releasePoolStack.end(); ++iter)
+    {
+        (*iter)->release();
+    }
+    _releasePoolStack.clear();
 }
 
 void PoolManager::finalize()
 {
-    if(_releasePoolStack->count() > 0)
+    for (auto iter = _releasePoolStack.begin(); iter != _releasePoolStack.end(); ++iter)
     {
-        //CCAutoreleasePool* pReleasePool;
-        Object* pObj = NULL;
-        CCARRAY_FOREACH(_releasePoolStack, pObj)
-        {
-            if(!pObj)
-                break;
-            AutoreleasePool* pPool = static_cast<AutoreleasePool*>(pObj);
-            pPool->clear();
-        }
+        (*iter)->clear();
     }
 }
 
@@ -144,9 +159,7 @@ void PoolManager::push()
     AutoreleasePool* pPool = new AutoreleasePool();       //ref = 1
     _curReleasePool = pPool;
 
-    _releasePoolStack->addObject(pPool);                   //ref = 2
-
-    pPool->release();                                       //ref = 1
+    _releasePoolStack.push_back(pPool);
 }
 
 void PoolManager::pop()
@@ -156,23 +169,17 @@ void PoolManager::pop()
         return;
     }
 
-     int nCount = _releasePoolStack->count();
+    size_t nCount = _releasePoolStack.size();
 
     _curReleasePool->clear();
  
-      if(nCount > 1)
-      {
-        _releasePoolStack->removeObjectAtIndex(nCount-1);
-
-//         if(nCount > 1)
-//         {
-//             _curReleasePool = _releasePoolStack->objectAtIndex(nCount - 2);
-//             return;
-//         }
-        _curReleasePool = (AutoreleasePool*)_releasePoolStack->objectAtIndex(nCount - 2);
-    }
+    if(nCount > 1)
+    {
+        _releasePoolStack.back()->release();
+        _releasePoolStack.pop_back();
 
-    /*_curReleasePool = NULL;*/
+        _curReleasePool = _releasePoolStack.back();
+    }
 }
 
 void PoolManager::removeObject(Object* pObject)
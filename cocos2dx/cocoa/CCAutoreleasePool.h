@@ -25,7 +25,7 @@ THE SOFTWARE.
 #define __AUTORELEASEPOOL_H__
 
 #include "CCObject.h"
-#include "CCArray.h"
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -36,23 +36,36 @@ NS_CC_BEGIN
 
 class CC_DLL AutoreleasePool : public Object
 {
-    Array*    _managedObjectArray;    
+    // the pool owns a reference of each object, released by clear()
+    std::vector<Object*> _managedObjectArray;
+    unsigned int _lastClearedCount;
+    unsigned int _peakCount;
 public:
     AutoreleasePool(void);
     ~AutoreleasePool(void);
 
     void addObject(Object *pObject);
+    /** Removes an object deleted before the pool was cleared, which means it was released too many times.
+     It searches the whole pool, it is not meant to be called in normal operation. */
     void removeObject(Object *pObject);
 
     void clear();
+
+    /** number of objects in the pool */
+    inline unsigned int getObjectCount() const { return (unsigned int)_managedObjectArray.size(); }
+    /** number of objects released by the last clear(), which is the number of objects autoreleased during the last frame for the pool of the Director
+     @since v3.0 */
+    inline unsigned int getLastClearedCount() const { return _lastClearedCount; }
+    /** highest number of objects the pool had
+     @since v3.0 */
+    inline unsigned int getPeakCount() const { return _peakCount; }
 };
 
 class CC_DLL PoolManager
 {
-    Array*    _releasePoolStack;    
+    std::vector<AutoreleasePool*> _releasePoolStack;
     AutoreleasePool*                    _curReleasePool;
 
-    AutoreleasePool* getCurReleasePool();
 public:
     PoolManager();
     ~PoolManager();
@@ -63,6 +76,10 @@ public:
     void removeObject(Object* pObject);
     void addObject(Object* pObject);
 
+    /** returns the pool the autoreleased objects are added to, it is created if needed
+     @since v3.0 */
+    AutoreleasePool* getCurReleasePool();
+
     static PoolManager* sharedPoolManager();
     static void purgePoolManager();
 
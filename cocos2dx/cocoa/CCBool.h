@@ -26,6 +26,7 @@
 #define __CCBOOL_H__
 
 #include "CCObject.h"
+#include "CCPoolAllocator.h"
 
 NS_CC_BEGIN
 
@@ -34,21 +35,21 @@ NS_CC_BEGIN
  * @{
  */
 
-class CC_DLL Bool : public Object, public Clonable
+class CC_DLL Bool : public Object, public Clonable, public PoolAllocated
 {
 public:
     Bool(bool v)
         : _value(v) {}
     bool getValue() const {return _value;}
 
+    /** Returns one of the two shared instances of Bool: Bool is immutable, so they never need to be allocated again.
+     Like autorelease(), it must be called from the main thread.
+     */
     static Bool* create(bool v)
     {
-        Bool* pRet = new Bool(v);
-        if (pRet)
-        {
-            pRet->autorelease();
-        }
-        return pRet;
+        static Bool* s_true = new Bool(true);
+        static Bool* s_false = new Bool(false);
+        return v ? s_true : s_false;
     }
 
     /* override functions */
@@ -26,6 +26,7 @@
 #define __CCFLOAT_H__
 
 #include "CCObject.h"
+#include "CCPoolAllocator.h"
 
 NS_CC_BEGIN
 
@@ -34,7 +35,7 @@ NS_CC_BEGIN
  * @{
  */
 
-class CC_DLL Float : public Object, public Clonable
+class CC_DLL Float : public Object, public Clonable, public PoolAllocated
 {
 public:
     Float(float v)
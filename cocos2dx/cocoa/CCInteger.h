@@ -2,6 +2,7 @@
 #define __CCINTEGER_H__
 
 #include "CCObject.h"
+#include "CCPoolAllocator.h"
 
 NS_CC_BEGIN
 
@@ -10,15 +11,29 @@ NS_CC_BEGIN
  * @{
  */
 
-class CC_DLL Integer : public Object, public Clonable
+class CC_DLL Integer : public Object, public Clonable, public PoolAllocated
 {
 public:
     Integer(int v)
         : _value(v) {}
     int getValue() const {return _value;}
 
+    /** Returns an Integer that the caller doesn't own, like the autoreleased objects.
+     Integer is immutable, so the values from 0 to 255 return shared instances instead of allocating new ones.
+     */
     static Integer* create(int v)
     {
+        if (v >= 0 && v < 256)
+        {
+            // created once, never released. Like autorelease(), it must be called from the main thread
+            static Integer* s_sharedValues[256] = {};
+            if (s_sharedValues[v] == nullptr)
+            {
+                s_sharedValues[v] = new Integer(v);
+            }
+            return s_sharedValues[v];
+        }
+
         Integer* pRet = new Integer(v);
         pRet->autorelease();
         return pRet;
@@ -0,0 +1,237 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCMAP_H__
+#define __CCMAP_H__
+
+#include "CCObject.h"
+#include "ccMacros.h"
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup data_structures
+ * @{
+ */
+
+/** @brief Map is a typed hash map of objects, which retains its values.
+
+ Unlike Dictionary, the keys can be of any hashable type, the values don't need to be cast,
+ Map isn't an Object and has no virtual method, it can be moved, and it can be iterated with a
+ range-based for loop over std::pair<const K, V>.
+
+ V must be a pointer to a subclass of Object. The values can't be NULL.
+
+ @since v3.0
+ */
+template<class K, class V>
+class Map
+{
+public:
+    static_assert(std::is_convertible<V, Object*>::value, "Map can only hold pointers to Object subclasses");
+
+    typedef std::unordered_map<K, V> RefMap;
+    typedef typename RefMap::iterator iterator;
+    typedef typename RefMap::const_iterator const_iterator;
+
+    Map()
+    {
+    }
+
+    /** creates an empty Map that can hold capacity values without rehashing */
+    explicit Map(unsigned int capacity)
+    {
+        _data.reserve(capacity);
+    }
+
+    Map(const Map<K, V>& other)
+    : _data(other._data)
+    {
+        retainAll();
+    }
+
+    Map(Map<K, V>&& other)
+    : _data(std::move(other._data))
+    {
+    }
+
+    ~Map()
+    {
+        clear();
+    }
+
+    Map<K, V>& operator=(const Map<K, V>& other)
+    {
+        if (this != &other)
+        {
+            for (auto& iter : other._data)
+            {
+                iter.second->retain();
+            }
+            clear();
+            _data = other._data;
+        }
+        return *this;
+    }
+
+    Map<K, V>& operator=(Map<K, V>&& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            _data = std::move(other._data);
+        }
+        return *this;
+    }
+
+    // iterators
+
+    inline iterator begin() { return _data.begin(); }
+    inline const_iterator begin() const { return _data.begin(); }
+    inline iterator end() { return _data.end(); }
+    inline const_iterator end() const { return _data.end(); }
+
+    // capacity
+
+    inline unsigned int size() const { return static_cast<unsigned int>(_data.size()); }
+    inline bool empty() const { return _data.empty(); }
+    inline void reserve(unsigned int capacity) { _data.reserve(capacity); }
+
+    // lookup
+
+    /** Returns the value of a key, or NULL */
+    V at(const K& key) const
+    {
+        auto iter = _data.find(key);
+        return iter != _data.end() ? iter->second : NULL;
+    }
+
+    inline iterator find(const K& key) { return _data.find(key); }
+    inline const_iterator find(const K& key) const { return _data.find(key); }
+
+    inline bool contains(const K& key) const { return _data.find(key) != _data.end(); }
+
+    std::vector<K> keys() const
+    {
+        std::vector<K> keys;
+        keys.reserve(_data.size());
+        for (auto& iter : _data)
+        {
+            keys.push_back(iter.first);
+        }
+        return keys;
+    }
+
+    /** Returns the keys of a value. The values are compared by address. */
+    std::vector<K> keys(V object) const
+    {
+        std::vector<K> keys;
+        for (auto& iter : _data)
+        {
+            if (iter.second == object)
+            {
+                keys.push_back(iter.first);
+            }
+        }
+        return keys;
+    }
+
+    // modifiers
+
+    /** Sets the value of a key, releasing the value it replaces */
+    void insert(const K& key, V object)
+    {
+        CCASSERT(object != NULL, "the object can't be NULL");
+        object->retain();
+        auto result = _data.insert(std::make_pair(key, object));
+        if (! result.second)
+        {
+            V old = result.first->second;
+            result.first->second = object;
+            old->release();
+        }
+    }
+
+    /** Removes a key. Returns the number of values removed, 0 or 1. */
+    unsigned int erase(const K& key)
+    {
+        auto iter = _data.find(key);
+        if (iter == _data.end())
+        {
+            return 0;
+        }
+        erase(iter);
+        return 1;
+    }
+
+    /** Removes a value, and returns the iterator of the next one */
+    iterator erase(const_iterator position)
+    {
+        CCASSERT(position != _data.end(), "invalid iterator");
+        V object = position->second;
+        iterator next = _data.erase(position);
+        object->release();
+        return next;
+    }
+
+    void erase(const std::vector<K>& keys)
+    {
+        for (auto& key : keys)
+        {
+            erase(key);
+        }
+    }
+
+    void clear()
+    {
+        // the values are released once the map is empty, their destructors may use it
+        RefMap data;
+        data.swap(_data);
+        for (auto& iter : data)
+        {
+            iter.second->release();
+        }
+    }
+
+protected:
+    void retainAll()
+    {
+        for (auto& iter : _data)
+        {
+            iter.second->retain();
+        }
+    }
+
+    RefMap _data;
+};
+
+// end of data_structures group
+/// @}
+
+NS_CC_END
+
+#endif // __CCMAP_H__
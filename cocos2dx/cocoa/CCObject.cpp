@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include "CCAutoreleasePool.h"
 #include "ccMacros.h"
 #include "script_support/CCScriptSupport.h"
+#include "support/CCObjectTracker.h"
 
 NS_CC_BEGIN
 
@@ -35,13 +36,25 @@ Object::Object(void)
 , _reference(1) // when the object is created, the reference count of it is 1
 , _autoReleaseCount(0)
 {
+#if CC_ENABLE_ATOMIC_REFERENCE_COUNT
+    static std::atomic<unsigned int> uObjectCount(0);
+#else
     static unsigned int uObjectCount = 0;
+#endif
 
     _ID = ++uObjectCount;
+
+#if CC_ENABLE_OBJECT_TRACKING
+    ObjectTracker::addObject(this);
+#endif
 }
 
 Object::~Object(void)
 {
+#if CC_ENABLE_OBJECT_TRACKING
+    ObjectTracker::removeObject(this);
+#endif
+
     // if the object is managed, we should remove it
     // from pool manager
     if (_autoReleaseCount > 0)
@@ -67,19 +80,31 @@ Object::~Object(void)
 void Object::release(void)
 {
     CCASSERT(_reference > 0, "reference count should greater than 0");
+#if CC_ENABLE_ATOMIC_REFERENCE_COUNT
+    // acquire the writes of the other threads that released the object before deleting it
+    if (_reference.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        delete this;
+    }
+#else
     --_reference;
 
     if (_reference == 0)
     {
         delete this;
     }
+#endif
 }
 
 void Object::retain(void)
 {
     CCASSERT(_reference > 0, "reference count should greater than 0");
 
+#if CC_ENABLE_ATOMIC_REFERENCE_COUNT
+    _reference.fetch_add(1, std::memory_order_relaxed);
+#else
     ++_reference;
+#endif
 }
 
 Object* Object::autorelease(void)
@@ -98,6 +123,18 @@ unsigned int Object::retainCount(void) const
     return _reference;
 }
 
+#if CC_ENABLE_OBJECT_TRACKING
+void* Object::operator new(std::size_t size)
+{
+    return ObjectTracker::allocate(size);
+}
+
+void Object::operator delete(void* ptr)
+{
+    ObjectTracker::deallocate(ptr);
+}
+#endif
+
 bool Object::isEqual(const Object *pObject)
 {
     return this == pObject;
@@ -27,6 +27,14 @@ THE SOFTWARE.
 
 #include "cocoa/CCDataVisitor.h"
 
+#if CC_ENABLE_ATOMIC_REFERENCE_COUNT
+#include <atomic>
+#endif
+
+#if CC_ENABLE_OBJECT_TRACKING
+#include <cstddef>
+#endif
+
 #ifdef EMSCRIPTEN
 #include <GLES2/gl2.h>
 #endif // EMSCRIPTEN
@@ -70,7 +78,11 @@ public:
     int                 _luaID;
 protected:
     // count of references
+#if CC_ENABLE_ATOMIC_REFERENCE_COUNT
+    std::atomic<unsigned int> _reference;
+#else
     unsigned int        _reference;
+#endif
     // count of autorelease
     unsigned int        _autoReleaseCount;
 public:
@@ -87,6 +99,12 @@ public:
     virtual void acceptVisitor(DataVisitor &visitor);
 
     virtual void update(float dt) {CC_UNUSED_PARAM(dt);};
+
+#if CC_ENABLE_OBJECT_TRACKING
+    // the size of the allocation is the size of the class of the object, recorded by ObjectTracker
+    static void* operator new(std::size_t size);
+    static void operator delete(void* ptr);
+#endif
     
     friend class AutoreleasePool;
 };
@@ -114,6 +132,7 @@ typedef int (Object::*SEL_Compare)(Object*);
 #define CC_CALLBACK_0(__selector__,__target__, ...) std::bind(&__selector__,__target__, ##__VA_ARGS__)
 #define CC_CALLBACK_1(__selector__,__target__, ...) std::bind(&__selector__,__target__, std::placeholders::_1, ##__VA_ARGS__)
 #define CC_CALLBACK_2(__selector__,__target__, ...) std::bind(&__selector__,__target__, std::placeholders::_1, std::placeholders::_2, ##__VA_ARGS__)
+#define CC_CALLBACK_3(__selector__,__target__, ...) std::bind(&__selector__,__target__, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, ##__VA_ARGS__)
 
 // end of base_nodes group
 /// @}
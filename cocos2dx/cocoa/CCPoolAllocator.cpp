@@ -0,0 +1,187 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCPoolAllocator.h"
+#include "ccConfig.h"
+#include "ccMacros.h"
+#include <cstring>
+#include <new>
+
+NS_CC_BEGIN
+
+// size of the chunks of memory split into blocks by the pools
+static const size_t CHUNK_SIZE = 16 * 1024;
+// minimum number of blocks in a chunk, for the biggest size classes
+static const size_t MIN_BLOCKS_PER_CHUNK = 8;
+
+PoolAllocator* PoolAllocator::getInstance()
+{
+    // never deleted: objects may still be released by the destructors of static objects
+    static PoolAllocator* s_sharedPoolAllocator = new PoolAllocator();
+    return s_sharedPoolAllocator;
+}
+
+PoolAllocator::PoolAllocator()
+{
+    Pool empty = { NULL, 0, 0 };
+    _pools.resize(CC_POOL_ALLOCATOR_MAX_SIZE / GRANULARITY, empty);
+    memset(&_currentFrame, 0, sizeof(_currentFrame));
+    memset(&_lastFrame, 0, sizeof(_lastFrame));
+}
+
+void PoolAllocator::addChunk(Pool& pool, size_t blockSize)
+{
+    size_t blockCount = CHUNK_SIZE / blockSize;
+    if (blockCount < MIN_BLOCKS_PER_CHUNK)
+    {
+        blockCount = MIN_BLOCKS_PER_CHUNK;
+    }
+
+    char* chunk = static_cast<char*>(::operator new(blockCount * blockSize));
+    _chunks.push_back(chunk);
+    ++pool.chunkCount;
+    _currentFrame.reservedBytes += blockCount * blockSize;
+
+    // the blocks are linked in address order, the first one is used first
+    for (size_t i = blockCount; i > 0; --i)
+    {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * blockSize);
+        block->next = pool.freeBlocks;
+        pool.freeBlocks = block;
+    }
+}
+
+void* PoolAllocator::allocate(size_t size)
+{
+#if CC_ENABLE_POOL_ALLOCATOR
+    size_t index = (size + GRANULARITY - 1) / GRANULARITY;
+    if (index == 0)
+    {
+        index = 1;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (index > _pools.size())
+    {
+        ++_currentFrame.heapAllocations;
+        return ::operator new(size);
+    }
+
+    Pool& pool = _pools[index - 1];
+    if (pool.freeBlocks == NULL)
+    {
+        addChunk(pool, index * GRANULARITY);
+    }
+
+    FreeBlock* block = pool.freeBlocks;
+    pool.freeBlocks = block->next;
+    ++pool.liveObjects;
+
+    ++_currentFrame.allocations;
+    ++_currentFrame.liveObjects;
+    _currentFrame.usedBytes += index * GRANULARITY;
+    return block;
+#else
+    return ::operator new(size);
+#endif
+}
+
+void PoolAllocator::deallocate(void* ptr, size_t size)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+
+#if CC_ENABLE_POOL_ALLOCATOR
+    size_t index = (size + GRANULARITY - 1) / GRANULARITY;
+    if (index == 0)
+    {
+        index = 1;
+    }
+
+    if (index > _pools.size())
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Pool& pool = _pools[index - 1];
+    CCASSERT(pool.liveObjects > 0, "the object wasn't allocated by this pool");
+
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = pool.freeBlocks;
+    pool.freeBlocks = block;
+    --pool.liveObjects;
+
+    ++_currentFrame.deallocations;
+    --_currentFrame.liveObjects;
+    _currentFrame.usedBytes -= index * GRANULARITY;
+#else
+    CC_UNUSED_PARAM(size);
+    ::operator delete(ptr);
+#endif
+}
+
+void PoolAllocator::endFrame()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _lastFrame = _currentFrame;
+
+    // the per frame counters restart, the memory counters go on
+    _currentFrame.allocations = 0;
+    _currentFrame.deallocations = 0;
+    _currentFrame.heapAllocations = 0;
+}
+
+PoolAllocator::Statistics PoolAllocator::getFrameStatistics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _lastFrame;
+}
+
+void PoolAllocator::dumpStatistics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (size_t i = 0; i < _pools.size(); ++i)
+    {
+        const Pool& pool = _pools[i];
+        if (pool.chunkCount > 0)
+        {
+            CCLOG("cocos2d: PoolAllocator: %4u bytes: %u live objects, %u chunks",
+                  (unsigned int)((i + 1) * GRANULARITY), pool.liveObjects, pool.chunkCount);
+        }
+    }
+    CCLOG("cocos2d: PoolAllocator: last frame: %u allocations, %u deallocations, %u heap allocations",
+          _lastFrame.allocations, _lastFrame.deallocations, _lastFrame.heapAllocations);
+    CCLOG("cocos2d: PoolAllocator: %u live objects, %.2f KB used, %.2f KB reserved",
+          _currentFrame.liveObjects, _currentFrame.usedBytes / 1024.0f, _currentFrame.reservedBytes / 1024.0f);
+}
+
+NS_CC_END
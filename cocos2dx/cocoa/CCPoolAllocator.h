@@ -0,0 +1,203 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCPOOLALLOCATOR_H__
+#define __CCPOOLALLOCATOR_H__
+
+#include "platform/CCPlatformMacros.h"
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base_nodes
+ * @{
+ */
+
+/** @brief PoolAllocator keeps the small objects of the engine in pools, one pool per size class.
+
+ The memory of an object goes back to the pool of its size when it is deleted, and is reused by the next
+ object of this size. Objects of the same size share their chunks instead of being scattered in the heap,
+ which keeps the heap from fragmenting when many short lived objects (actions, strings, touches...) are
+ created and released in an unpredictable order.
+
+ The size classes are multiples of 16 bytes, up to CC_POOL_ALLOCATOR_MAX_SIZE. Bigger objects are allocated
+ in the heap. The chunks are kept until the end of the application.
+
+ The classes use the allocator by inheriting PoolAllocated. It is thread safe.
+
+ @since v3.0
+ */
+class CC_DLL PoolAllocator
+{
+public:
+    /** Allocations and deallocations of a frame, and the memory held by the pools */
+    struct Statistics
+    {
+        /** objects allocated from the pools */
+        unsigned int allocations;
+        /** objects given back to the pools */
+        unsigned int deallocations;
+        /** objects too big for the pools, allocated in the heap */
+        unsigned int heapAllocations;
+        /** objects living in the pools */
+        unsigned int liveObjects;
+        /** bytes used by the living objects */
+        size_t usedBytes;
+        /** bytes of the chunks of the pools */
+        size_t reservedBytes;
+    };
+
+    static PoolAllocator* getInstance();
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr, size_t size);
+
+    /** Ends the statistics of a frame. Called by the Director after drawing a scene. */
+    void endFrame();
+
+    /** statistics of the last frame */
+    Statistics getFrameStatistics() const;
+
+    /** logs the statistics of the pools */
+    void dumpStatistics() const;
+
+private:
+    static const size_t GRANULARITY = 16;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct Pool
+    {
+        FreeBlock* freeBlocks;
+        unsigned int liveObjects;
+        unsigned int chunkCount;
+    };
+
+    PoolAllocator();
+    void addChunk(Pool& pool, size_t blockSize);
+
+    mutable std::mutex _mutex;
+    std::vector<Pool> _pools;
+    std::vector<void*> _chunks;
+    Statistics _currentFrame;
+    Statistics _lastFrame;
+};
+
+/** @brief Base class of the classes whose objects are allocated by the PoolAllocator.
+
+ @code
+ class MyAction : public ActionInterval, public PoolAllocated
+ @endcode
+
+ The subclasses of a pool allocated class are pool allocated too. Arrays of objects are allocated in the heap.
+ When CC_ENABLE_OBJECT_TRACKING is enabled, the Objects are allocated by Object::operator new instead.
+ @since v3.0
+ */
+class CC_DLL PoolAllocated
+{
+public:
+#if !CC_ENABLE_OBJECT_TRACKING
+    static void* operator new(size_t size)
+    {
+        return PoolAllocator::getInstance()->allocate(size);
+    }
+
+    // the destructors of the Objects are virtual: size is the one of the object being deleted
+    static void operator delete(void* ptr, size_t size)
+    {
+        PoolAllocator::getInstance()->deallocate(ptr, size);
+    }
+#endif
+};
+
+/** @brief STL allocator taking the nodes of the node based containers (std::set, std::map, std::list) from the PoolAllocator.
+
+ @code
+ std::set<Object*, std::less<Object*>, PoolSTLAllocator<Object*> > objects;
+ @endcode
+
+ Containers that are filled and emptied at a high rate, like the sets of touches, then don't go to the heap.
+ @since v3.0
+ */
+template <class T>
+class PoolSTLAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef PoolSTLAllocator<U> other;
+    };
+
+    PoolSTLAllocator() {}
+    PoolSTLAllocator(const PoolSTLAllocator&) {}
+    template <class U>
+    PoolSTLAllocator(const PoolSTLAllocator<U>&) {}
+
+    pointer address(reference value) const { return &value; }
+    const_pointer address(const_reference value) const { return &value; }
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+        return static_cast<pointer>(PoolAllocator::getInstance()->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(pointer ptr, size_type n)
+    {
+        PoolAllocator::getInstance()->deallocate(ptr, n * sizeof(T));
+    }
+
+    size_type max_size() const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+    void construct(pointer ptr, const T& value) { new (static_cast<void*>(ptr)) T(value); }
+    void destroy(pointer ptr) { ptr->~T(); }
+
+    template <class U>
+    bool operator==(const PoolSTLAllocator<U>&) const { return true; }
+    template <class U>
+    bool operator!=(const PoolSTLAllocator<U>&) const { return false; }
+};
+
+// end of base_nodes group
+/// @}
+
+NS_CC_END
+
+#endif // __CCPOOLALLOCATOR_H__
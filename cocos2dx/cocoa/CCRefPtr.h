@@ -0,0 +1,189 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCREFPTR_H__
+#define __CCREFPTR_H__
+
+#include "CCObject.h"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base_nodes
+ * @{
+ */
+
+/** @brief RefPtr holds a reference to an Object: it retains the object, and releases it when it is destroyed.
+
+ Moving a RefPtr gives its reference to the other RefPtr, without retaining or releasing the object.
+ adopt() takes the reference of an object created with new, so it isn't retained twice:
+ @code
+ RefPtr<Image> image = RefPtr<Image>::adopt(new Image());
+ @endcode
+
+ Unlike autorelease(), RefPtr doesn't need the AutoreleasePool of the main thread. When
+ CC_ENABLE_ATOMIC_REFERENCE_COUNT is enabled, an object can be created by a worker thread and moved to the main
+ thread in a RefPtr. Otherwise, the reference count of an object must only be changed by one thread at a time.
+
+ @since v3.0
+ */
+template<class T>
+class RefPtr
+{
+public:
+    RefPtr()
+    : _ptr(nullptr)
+    {
+    }
+
+    RefPtr(std::nullptr_t)
+    : _ptr(nullptr)
+    {
+    }
+
+    /** retains ptr */
+    RefPtr(T* ptr)
+    : _ptr(ptr)
+    {
+        static_assert(std::is_base_of<Object, T>::value, "RefPtr can only hold Object subclasses");
+        if (_ptr)
+        {
+            _ptr->retain();
+        }
+    }
+
+    RefPtr(const RefPtr<T>& other)
+    : RefPtr(other._ptr)
+    {
+    }
+
+    RefPtr(RefPtr<T>&& other)
+    : _ptr(other._ptr)
+    {
+        other._ptr = nullptr;
+    }
+
+    ~RefPtr()
+    {
+        if (_ptr)
+        {
+            _ptr->release();
+        }
+    }
+
+    /** Returns a RefPtr holding the reference of ptr, without retaining it: the RefPtr will release it */
+    static RefPtr<T> adopt(T* ptr)
+    {
+        RefPtr<T> ref;
+        ref._ptr = ptr;
+        return ref;
+    }
+
+    RefPtr<T>& operator=(const RefPtr<T>& other)
+    {
+        reset(other._ptr);
+        return *this;
+    }
+
+    RefPtr<T>& operator=(RefPtr<T>&& other)
+    {
+        if (this != &other)
+        {
+            T* old = _ptr;
+            _ptr = other._ptr;
+            other._ptr = nullptr;
+            if (old)
+            {
+                old->release();
+            }
+        }
+        return *this;
+    }
+
+    RefPtr<T>& operator=(T* ptr)
+    {
+        reset(ptr);
+        return *this;
+    }
+
+    RefPtr<T>& operator=(std::nullptr_t)
+    {
+        reset();
+        return *this;
+    }
+
+    /** retains ptr, and releases the object held until now */
+    void reset(T* ptr = nullptr)
+    {
+        // retain first: ptr may only be referenced by the object being released
+        if (ptr)
+        {
+            ptr->retain();
+        }
+        T* old = _ptr;
+        _ptr = ptr;
+        if (old)
+        {
+            old->release();
+        }
+    }
+
+    /** Returns the object and forgets it without releasing it: the caller owns its reference */
+    T* detach()
+    {
+        T* ptr = _ptr;
+        _ptr = nullptr;
+        return ptr;
+    }
+
+    void swap(RefPtr<T>& other)
+    {
+        std::swap(_ptr, other._ptr);
+    }
+
+    inline T* get() const { return _ptr; }
+    inline T* operator->() const { return _ptr; }
+    inline T& operator*() const { return *_ptr; }
+    /** lets a RefPtr be passed to the functions taking a T*, and be tested like a pointer */
+    inline operator T*() const { return _ptr; }
+
+private:
+    T* _ptr;
+};
+
+template<class T, class U>
+inline bool operator==(const RefPtr<T>& a, const RefPtr<U>& b) { return a.get() == b.get(); }
+
+template<class T, class U>
+inline bool operator!=(const RefPtr<T>& a, const RefPtr<U>& b) { return a.get() != b.get(); }
+
+// end of base_nodes group
+/// @}
+
+NS_CC_END
+
+#endif // __CCREFPTR_H__
@@ -30,16 +30,14 @@ NS_CC_BEGIN
 
 Set::Set(void)
 {
-    _set = new set<Object *>;
 }
 
 Set::Set(const Set &rSetObject)
+: _set(rSetObject._set)
 {
-    _set = new set<Object *>(*rSetObject._set);
-
     // call retain of members
     SetIterator iter;
-    for (iter = _set->begin(); iter != _set->end(); ++iter)
+    for (iter = _set.begin(); iter != _set.end(); ++iter)
     {
         if (! (*iter))
         {
@@ -53,7 +51,6 @@ Set::Set(const Set &rSetObject)
 Set::~Set(void)
 {
     removeAllObjects();
-    CC_SAFE_DELETE(_set);
 }
 
 void Set::acceptVisitor(DataVisitor &visitor)
@@ -87,21 +84,21 @@ Set* Set::mutableCopy(void)
 
 int Set::count(void)
 {
-    return (int)_set->size();
+    return (int)_set.size();
 }
 
 void Set::addObject(Object *pObject)
 {
-    if (_set->count(pObject) == 0)
+    if (_set.count(pObject) == 0)
     {
         CC_SAFE_RETAIN(pObject);
-        _set->insert(pObject);
+        _set.insert(pObject);
     }
 }
 
 void Set::removeObject(Object *pObject)
 {
-    if (_set->erase(pObject) > 0)
+    if (_set.erase(pObject) > 0)
     {
         CC_SAFE_RELEASE(pObject);
     }
@@ -109,10 +106,10 @@ void Set::removeObject(Object *pObject)
 
 void Set::removeAllObjects()
 {
-    SetIterator it = _set->begin();
+    SetIterator it = _set.begin();
     SetIterator tmp;
 
-    while (it != _set->end())
+    while (it != _set.end())
     {
         if (!(*it))
         {
@@ -121,36 +118,39 @@ void Set::removeAllObjects()
         
         tmp = it;
         ++tmp;
-        _set->erase(it);
+        Object* pObject = *it;
+        _set.erase(it);
+        // the elements were retained by addObject() or the copy constructor
+        pObject->release();
         it = tmp;
     }
 }
 
 bool Set::containsObject(Object *pObject)
 {
-    return _set->find(pObject) != _set->end();
+    return _set.find(pObject) != _set.end();
 }
 
 SetIterator Set::begin(void)
 {
-    return _set->begin();
+    return _set.begin();
 }
 
 SetIterator Set::end(void)
 {
-    return _set->end();
+    return _set.end();
 }
 
 Object* Set::anyObject()
 {
-    if (!_set || _set->empty())
+    if (_set.empty())
     {
         return 0;
     }
     
     SetIterator it;
 
-    for( it = _set->begin(); it != _set->end(); ++it)
+    for( it = _set.begin(); it != _set.end(); ++it)
     {
         if (*it)
         {
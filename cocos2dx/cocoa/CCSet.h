@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include <set>
 #include "CCObject.h"
+#include "CCPoolAllocator.h"
 
 NS_CC_BEGIN
 
@@ -35,9 +36,11 @@ NS_CC_BEGIN
  * @{
  */
 
-typedef std::set<Object *>::iterator SetIterator;
+// the nodes of the sets come from the PoolAllocator: the sets of touches are filled and emptied several times per frame
+typedef std::set<Object *, std::less<Object *>, PoolSTLAllocator<Object *> > SetContainer;
+typedef SetContainer::iterator SetIterator;
 
-class CC_DLL Set : public Object
+class CC_DLL Set : public Object, public PoolAllocated
 {
 public:
     Set(void);
@@ -70,7 +73,7 @@ public:
     */
     void removeObject(Object *pObject);
     /**
-     *@brief Remove all elements of the set
+     *@brief Remove all elements of the set, they are released
      */
     void removeAllObjects();
     /**
@@ -93,7 +96,7 @@ public:
     virtual void acceptVisitor(DataVisitor &visitor);
 
 private:
-    std::set<Object *> *_set;
+    SetContainer _set;
 };
 
 // end of data_structure group
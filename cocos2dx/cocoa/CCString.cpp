@@ -3,11 +3,13 @@
 #include "ccMacros.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "CCArray.h"
 
 NS_CC_BEGIN
 
-#define kMaxStringLen (1024*100)
+// size of the buffer on the stack used by the formatting functions, bigger strings are formatted in the heap
+#define kFormatBufferLen 512
 
 String::String()
     :_string("")
@@ -21,6 +23,10 @@ String::String(const std::string& str)
     :_string(str)
 {}
 
+String::String(std::string&& str)
+    :_string(std::move(str))
+{}
+
 String::String(const String& str)
     :_string(str.getCString())
 {}
@@ -38,22 +44,41 @@ String& String::operator= (const String& other)
 
 bool String::initWithFormatAndValist(const char* format, va_list ap)
 {
+    _string.clear();
+    return appendWithFormatAndValist(format, ap);
+}
+
+bool String::appendWithFormatAndValist(const char* format, va_list ap)
+{
+    // vsnprintf consumes its va_list: keep a copy for the second pass
+    va_list apCopy;
+    va_copy(apCopy, ap);
+
+    char buf[kFormatBufferLen];
+    int len = vsnprintf(buf, kFormatBufferLen, format, ap);
     bool bRet = false;
-    char* pBuf = (char*)malloc(kMaxStringLen);
-    if (pBuf != NULL)
+    if (len >= 0 && len < kFormatBufferLen)
     {
-        vsnprintf(pBuf, kMaxStringLen, format, ap);
-        _string = pBuf;
-        free(pBuf);
+        _string.append(buf, len);
         bRet = true;
     }
+    else if (len >= 0)
+    {
+        // too long for the buffer: format directly in the string, with room for the terminating null character
+        std::string::size_type offset = _string.size();
+        _string.resize(offset + len + 1);
+        vsnprintf(&_string[offset], len + 1, format, apCopy);
+        _string.resize(offset + len);
+        bRet = true;
+    }
+
+    va_end(apCopy);
     return bRet;
 }
 
 bool String::initWithFormat(const char* format, ...)
 {
     bool bRet = false;
-    _string.clear();
 
     va_list ap;
     va_start(ap, format);
@@ -139,17 +164,10 @@ void String::appendWithFormat(const char* format, ...)
 {
     va_list ap;
     va_start(ap, format);
-    
-    char* pBuf = (char*)malloc(kMaxStringLen);
-    if (pBuf != NULL)
-    {
-        vsnprintf(pBuf, kMaxStringLen, format, ap);
-        _string.append(pBuf);
-        free(pBuf);
-    }
-    
+
+    appendWithFormatAndValist(format, ap);
+
     va_end(ap);
-    
 }
 
 Array* String::componentsSeparatedByString(const char *delimiter)
@@ -195,30 +213,30 @@ String* String::create(const std::string& str)
     return pRet;
 }
 
+String* String::create(std::string&& str)
+{
+    String* pRet = new String(std::move(str));
+    pRet->autorelease();
+    return pRet;
+}
+
 String* String::createWithData(const unsigned char* pData, unsigned long nLen)
 {
     String* pRet = NULL;
     if (pData != NULL)
     {
-        char* pStr = (char*)malloc(nLen+1);
-        if (pStr != NULL)
-        {
-            pStr[nLen] = '\0';
-            if (nLen > 0)
-            {
-                memcpy(pStr, pData, nLen);
-            }
-            
-            pRet = String::create(pStr);
-            free(pStr);
-        }
+        // like a C string, the string stops at the first null character
+        const char* pStr = reinterpret_cast<const char*>(pData);
+        const void* pEnd = memchr(pStr, '\0', nLen);
+        pRet = String::create(std::string(pStr, pEnd ? static_cast<const char*>(pEnd) - pStr : nLen));
     }
     return pRet;
 }
 
 String* String::createWithFormat(const char* format, ...)
 {
-    String* pRet = String::create("");
+    String* pRet = new String();
+    pRet->autorelease();
     va_list ap;
     va_start(ap, format);
     pRet->initWithFormatAndValist(format, ap);
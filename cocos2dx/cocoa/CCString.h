@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include <string>
 #include <functional>
 #include "CCObject.h"
+#include "CCPoolAllocator.h"
 
 NS_CC_BEGIN
 
@@ -40,12 +41,16 @@ NS_CC_BEGIN
  * @{
  */
 
-class CC_DLL String : public Object, public Clonable
+class CC_DLL String : public Object, public Clonable, public PoolAllocated
 {
 public:
     String();
     String(const char* str);
     String(const std::string& str);
+    /** takes the characters of str without copying them
+     @since v3.0
+     */
+    String(std::string&& str);
     String(const String& str);
 
     virtual ~String();
@@ -98,8 +103,13 @@ public:
      */
     static String* create(const std::string& str);
 
-    /** create a string with format, it's similar with the c function 'sprintf', the default buffer size is (1024*100) bytes,
-     *  if you want to change it, you should modify the kMaxStringLen macro in String.cpp file.
+    /** creates a string that takes the characters of str without copying them
+     @since v3.0
+     */
+    static String* create(std::string&& str);
+
+    /** create a string with format, it's similar with the c function 'sprintf'.
+     *  The short strings are formatted in a buffer on the stack, the longer ones directly in the string.
      *  @return A String pointer which is an autorelease object pointer,
      *          it means that you needn't do a release operation unless you retain it.
      */ 
@@ -124,6 +134,8 @@ private:
 
     /** only for internal use */
     bool initWithFormatAndValist(const char* format, va_list ap);
+    /** formats at the end of _string */
+    bool appendWithFormatAndValist(const char* format, va_list ap);
 
 public:
     std::string _string;
@@ -0,0 +1,307 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCStringDictionary.h"
+#include "CCDictionary.h"
+#include <string.h>
+
+NS_CC_BEGIN
+
+// the table is grown when it is 3/4 full
+static const unsigned int MIN_CAPACITY = 16;
+// the keys of the removed objects are reclaimed when they use more than half of the buffer, and at least this size
+static const unsigned int MIN_REMOVED_KEYS_SIZE = 4096;
+
+static inline bool isOverloaded(unsigned int count, unsigned int capacity)
+{
+    return count * 4 > capacity * 3;
+}
+
+//
+// Key
+//
+StringDictionary::Key::Key(const char* key)
+: str(key)
+, length(0)
+, hash(2166136261u)
+{
+    CCASSERT(key, "The key can't be NULL");
+    // FNV-1a, the length is computed in the same loop
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(key); *p; ++p)
+    {
+        hash = (hash ^ *p) * 16777619u;
+        ++length;
+    }
+}
+
+StringDictionary::Key::Key(const std::string& key)
+: str(key.c_str())
+, length(static_cast<unsigned int>(key.length()))
+, hash(2166136261u)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(key.data());
+    for (unsigned int i = 0; i < length; ++i)
+    {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+}
+
+//
+// Iterator
+//
+StringDictionary::Iterator::Iterator(const StringDictionary* dictionary, unsigned int slot)
+: _dictionary(dictionary)
+, _slot(slot)
+{
+    skipEmptySlots();
+}
+
+StringDictionary::Iterator& StringDictionary::Iterator::operator++()
+{
+    ++_slot;
+    skipEmptySlots();
+    return *this;
+}
+
+void StringDictionary::Iterator::skipEmptySlots()
+{
+    const unsigned int capacity = static_cast<unsigned int>(_dictionary->_slots.size());
+    while (_slot < capacity && ! _dictionary->_slots[_slot].object)
+    {
+        ++_slot;
+    }
+}
+
+//
+// StringDictionary
+//
+StringDictionary::StringDictionary()
+: _removedKeysSize(0)
+, _count(0)
+{
+}
+
+StringDictionary::~StringDictionary()
+{
+    removeAllObjects();
+}
+
+unsigned int StringDictionary::findSlot(const Key& key) const
+{
+    const unsigned int mask = static_cast<unsigned int>(_slots.size()) - 1;
+    unsigned int slot = key.hash & mask;
+    while (_slots[slot].object)
+    {
+        const Slot& candidate = _slots[slot];
+        if (candidate.hash == key.hash && candidate.keyLength == key.length
+            && memcmp(&_keys[candidate.keyOffset], key.str, key.length) == 0)
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+Object* StringDictionary::objectForKey(const Key& key) const
+{
+    if (_count == 0)
+    {
+        return NULL;
+    }
+    return _slots[findSlot(key)].object;
+}
+
+void StringDictionary::setObject(Object* object, const Key& key)
+{
+    CCASSERT(object, "The object can't be NULL");
+
+    if (_slots.empty() || isOverloaded(_count + 1, static_cast<unsigned int>(_slots.size())))
+    {
+        rehash(MAX(MIN_CAPACITY, static_cast<unsigned int>(_slots.size()) * 2));
+    }
+
+    Slot& slot = _slots[findSlot(key)];
+    if (slot.object)
+    {
+        object->retain();
+        slot.object->release();
+        slot.object = object;
+        return;
+    }
+
+    // the key can come from this buffer, which can move while it grows
+    const unsigned int keyOffset = static_cast<unsigned int>(_keys.size());
+    if (! _keys.empty() && key.str >= &_keys.front() && key.str <= &_keys.back())
+    {
+        std::string copy(key.str, key.length);
+        _keys.insert(_keys.end(), copy.begin(), copy.end());
+    }
+    else
+    {
+        _keys.insert(_keys.end(), key.str, key.str + key.length);
+    }
+    _keys.push_back('\0');
+
+    object->retain();
+    slot.hash = key.hash;
+    slot.keyOffset = keyOffset;
+    slot.keyLength = key.length;
+    slot.object = object;
+    ++_count;
+}
+
+bool StringDictionary::removeObjectForKey(const Key& key)
+{
+    if (_count == 0)
+    {
+        return false;
+    }
+
+    unsigned int hole = findSlot(key);
+    Object* object = _slots[hole].object;
+    if (! object)
+    {
+        return false;
+    }
+    _removedKeysSize += _slots[hole].keyLength + 1;
+
+    // moves back the following entries that can't be found any more once the slot is empty
+    const unsigned int mask = static_cast<unsigned int>(_slots.size()) - 1;
+    for (unsigned int slot = (hole + 1) & mask; _slots[slot].object; slot = (slot + 1) & mask)
+    {
+        const unsigned int ideal = _slots[slot].hash & mask;
+        const bool reachable = (hole <= slot) ? (hole < ideal && ideal <= slot) : (hole < ideal || ideal <= slot);
+        if (! reachable)
+        {
+            _slots[hole] = _slots[slot];
+            hole = slot;
+        }
+    }
+    _slots[hole].object = NULL;
+    --_count;
+
+    if (_removedKeysSize > MIN_REMOVED_KEYS_SIZE && _removedKeysSize * 2 > _keys.size())
+    {
+        rehash(static_cast<unsigned int>(_slots.size()));
+    }
+
+    object->release();
+    return true;
+}
+
+void StringDictionary::removeObjectsIf(const std::function<bool(const char* key, Object* object)>& predicate)
+{
+    std::vector<Object*> removedObjects;
+    for (auto& slot : _slots)
+    {
+        if (slot.object && predicate(&_keys[slot.keyOffset], slot.object))
+        {
+            removedObjects.push_back(slot.object);
+            _removedKeysSize += slot.keyLength + 1;
+            slot.object = NULL;
+            --_count;
+        }
+    }
+
+    if (! removedObjects.empty())
+    {
+        // the holes break the probe sequences: the table is rebuilt before the objects are released
+        rehash(static_cast<unsigned int>(_slots.size()));
+        for (auto object : removedObjects)
+        {
+            object->release();
+        }
+    }
+}
+
+void StringDictionary::removeAllObjects()
+{
+    std::vector<Slot> slots;
+    slots.swap(_slots);
+    _keys.clear();
+    _removedKeysSize = 0;
+    _count = 0;
+
+    for (auto& slot : slots)
+    {
+        if (slot.object)
+        {
+            slot.object->release();
+        }
+    }
+}
+
+void StringDictionary::reserve(unsigned int count)
+{
+    unsigned int capacity = MIN_CAPACITY;
+    while (isOverloaded(count, capacity))
+    {
+        capacity *= 2;
+    }
+    if (capacity > _slots.size())
+    {
+        rehash(capacity);
+    }
+}
+
+void StringDictionary::rehash(unsigned int capacity)
+{
+    Slot empty = { 0, 0, 0, NULL };
+    std::vector<Slot> slots(capacity, empty);
+    std::vector<char> keys;
+    keys.reserve(_keys.size() - _removedKeysSize);
+
+    const unsigned int mask = capacity - 1;
+    for (const auto& slot : _slots)
+    {
+        if (slot.object)
+        {
+            unsigned int index = slot.hash & mask;
+            while (slots[index].object)
+            {
+                index = (index + 1) & mask;
+            }
+            slots[index] = slot;
+            slots[index].keyOffset = static_cast<unsigned int>(keys.size());
+            keys.insert(keys.end(), _keys.begin() + slot.keyOffset, _keys.begin() + slot.keyOffset + slot.keyLength + 1);
+        }
+    }
+
+    _slots.swap(slots);
+    _keys.swap(keys);
+    _removedKeysSize = 0;
+}
+
+Dictionary* StringDictionary::toDictionary() const
+{
+    Dictionary* dictionary = Dictionary::create();
+    for (auto entry : *this)
+    {
+        dictionary->setObject(entry.object, entry.key);
+    }
+    return dictionary;
+}
+
+NS_CC_END
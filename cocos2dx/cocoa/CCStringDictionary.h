@@ -0,0 +1,163 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCSTRINGDICTIONARY_H__
+#define __CCSTRINGDICTIONARY_H__
+
+#include "CCObject.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+NS_CC_BEGIN
+
+class Dictionary;
+
+/**
+ * @addtogroup data_structures
+ * @{
+ */
+
+/** @brief StringDictionary is a retaining dictionary of objects indexed by strings, used by the engine caches.
+
+ Unlike Dictionary, it doesn't allocate a node per element: the entries are stored in an open addressing table,
+ and the keys in a single buffer. The hash of a key is computed once, when its Key is built, so a Key kept by the
+ caller can be looked up again without hashing the string, and a const char* doesn't need to be copied into a
+ std::string.
+
+ The dictionary must not be modified while it is iterated: use removeObjectsIf() to remove several objects.
+ @code
+ for (auto entry : dictionary)
+ {
+     CCLOG("%s: %p", entry.key, entry.object);
+ }
+ @endcode
+
+ @since v3.0
+ */
+class CC_DLL StringDictionary
+{
+public:
+    /** A string with its hash. It references the string, which must stay valid while the Key is used. */
+    class CC_DLL Key
+    {
+    public:
+        Key(const char* str);
+        Key(const std::string& str);
+
+        const char* str;
+        unsigned int length;
+        unsigned int hash;
+    };
+
+    /** An entry of the dictionary, valid until the dictionary is modified */
+    struct Entry
+    {
+        const char* key;
+        Object* object;
+    };
+
+    class CC_DLL Iterator
+    {
+    public:
+        Iterator(const StringDictionary* dictionary, unsigned int slot);
+
+        inline Entry operator*() const
+        {
+            Entry entry = { _dictionary->getSlotKey(_slot), _dictionary->_slots[_slot].object };
+            return entry;
+        }
+        Iterator& operator++();
+        inline bool operator==(const Iterator& other) const { return _slot == other._slot; }
+        inline bool operator!=(const Iterator& other) const { return _slot != other._slot; }
+
+    private:
+        void skipEmptySlots();
+
+        const StringDictionary* _dictionary;
+        unsigned int _slot;
+    };
+
+    StringDictionary();
+    ~StringDictionary();
+
+    /** Returns the object of a key, or NULL */
+    Object* objectForKey(const Key& key) const;
+
+    /** Adds an object, or replaces the object of the key. The object is retained */
+    void setObject(Object* object, const Key& key);
+
+    /** Removes the object of a key. Returns false if there was no object for this key */
+    bool removeObjectForKey(const Key& key);
+
+    /** Removes the objects for which predicate returns true. The objects are released once all of them are removed */
+    void removeObjectsIf(const std::function<bool(const char* key, Object* object)>& predicate);
+
+    void removeAllObjects();
+
+    inline unsigned int count() const { return _count; }
+
+    /** makes room for count objects, so that the table isn't rebuilt while they are added */
+    void reserve(unsigned int count);
+
+    /** Returns an autoreleased Dictionary with the same objects, for the APIs returning a Dictionary */
+    Dictionary* toDictionary() const;
+
+    inline Iterator begin() const { return Iterator(this, 0); }
+    inline Iterator end() const { return Iterator(this, static_cast<unsigned int>(_slots.size())); }
+
+private:
+    struct Slot
+    {
+        unsigned int hash;
+        unsigned int keyOffset;
+        unsigned int keyLength;
+        // NULL for the empty slots
+        Object* object;
+    };
+
+    // returns the slot of the key, or the empty slot where it can be inserted
+    unsigned int findSlot(const Key& key) const;
+    inline const char* getSlotKey(unsigned int slot) const { return &_keys[_slots[slot].keyOffset]; }
+    // rebuilds the table with capacity slots, and packs the keys
+    void rehash(unsigned int capacity);
+
+    std::vector<Slot> _slots;
+    // the keys, null terminated
+    std::vector<char> _keys;
+    // size of the keys of the removed objects, reclaimed when the table is rebuilt
+    unsigned int _removedKeysSize;
+    unsigned int _count;
+
+    // the objects are retained: the dictionary can't be copied
+    StringDictionary(const StringDictionary&);
+    StringDictionary& operator=(const StringDictionary&);
+};
+
+// end of data_structures group
+/// @}
+
+NS_CC_END
+
+#endif // __CCSTRINGDICTIONARY_H__
@@ -0,0 +1,327 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCVECTOR_H__
+#define __CCVECTOR_H__
+
+#include "CCObject.h"
+#include "ccMacros.h"
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup data_structures
+ * @{
+ */
+
+/** @brief Vector is a typed array of objects, which retains its elements.
+
+ Unlike Array, the elements don't need to be cast, Vector isn't an Object and has no virtual method,
+ it can be moved, and it can be iterated with a range-based for loop:
+ @code
+ for (auto child : node->getChildren())
+ {
+     child->setVisible(false);
+ }
+ @endcode
+
+ T must be a pointer to a subclass of Object. The elements can't be NULL.
+ A copy of a Vector retains the elements again, a moved Vector gives them to the new one.
+
+ @since v3.0
+ */
+template<class T>
+class Vector
+{
+public:
+    static_assert(std::is_convertible<T, Object*>::value, "Vector can only hold pointers to Object subclasses");
+
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+    typedef typename std::vector<T>::reverse_iterator reverse_iterator;
+    typedef typename std::vector<T>::const_reverse_iterator const_reverse_iterator;
+
+    Vector()
+    {
+    }
+
+    /** creates an empty Vector that can hold capacity elements without growing */
+    explicit Vector(unsigned int capacity)
+    {
+        _data.reserve(capacity);
+    }
+
+    Vector(const Vector<T>& other)
+    : _data(other._data)
+    {
+        retainAll();
+    }
+
+    Vector(Vector<T>&& other)
+    : _data(std::move(other._data))
+    {
+    }
+
+    ~Vector()
+    {
+        clear();
+    }
+
+    Vector<T>& operator=(const Vector<T>& other)
+    {
+        if (this != &other)
+        {
+            // retain first, other may hold the only references to some of our elements
+            for (auto object : other._data)
+            {
+                object->retain();
+            }
+            clear();
+            _data = other._data;
+        }
+        return *this;
+    }
+
+    Vector<T>& operator=(Vector<T>&& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            _data = std::move(other._data);
+        }
+        return *this;
+    }
+
+    // iterators
+
+    inline iterator begin() { return _data.begin(); }
+    inline const_iterator begin() const { return _data.begin(); }
+    inline iterator end() { return _data.end(); }
+    inline const_iterator end() const { return _data.end(); }
+    inline reverse_iterator rbegin() { return _data.rbegin(); }
+    inline const_reverse_iterator rbegin() const { return _data.rbegin(); }
+    inline reverse_iterator rend() { return _data.rend(); }
+    inline const_reverse_iterator rend() const { return _data.rend(); }
+
+    // capacity
+
+    inline unsigned int size() const { return static_cast<unsigned int>(_data.size()); }
+    inline bool empty() const { return _data.empty(); }
+    inline unsigned int capacity() const { return static_cast<unsigned int>(_data.capacity()); }
+    inline void reserve(unsigned int capacity) { _data.reserve(capacity); }
+    inline void shrinkToFit() { _data.shrink_to_fit(); }
+
+    // accessors
+
+    /** the elements, for the loops that can't afford the checks of the iterators */
+    inline T* data() { return _data.empty() ? NULL : &_data[0]; }
+    inline const T* data() const { return _data.empty() ? NULL : &_data[0]; }
+
+    inline T at(unsigned int index) const
+    {
+        CCASSERT(index < _data.size(), "index out of range");
+        return _data[index];
+    }
+
+    inline T front() const
+    {
+        CCASSERT(! _data.empty(), "the vector is empty");
+        return _data.front();
+    }
+
+    inline T back() const
+    {
+        CCASSERT(! _data.empty(), "the vector is empty");
+        return _data.back();
+    }
+
+    /** Returns the index of the first occurrence of object, or -1 */
+    int getIndex(T object) const
+    {
+        auto iter = std::find(_data.begin(), _data.end(), object);
+        return iter != _data.end() ? static_cast<int>(iter - _data.begin()) : -1;
+    }
+
+    inline const_iterator find(T object) const { return std::find(_data.begin(), _data.end(), object); }
+    inline iterator find(T object) { return std::find(_data.begin(), _data.end(), object); }
+
+    inline bool contains(T object) const { return find(object) != _data.end(); }
+
+    /** Returns a random element, or NULL if the vector is empty */
+    T getRandomObject() const
+    {
+        if (_data.empty())
+        {
+            return NULL;
+        }
+        unsigned int index = static_cast<unsigned int>(CCRANDOM_0_1() * _data.size());
+        return _data[MIN(index, size() - 1)];
+    }
+
+    // modifiers
+
+    void pushBack(T object)
+    {
+        CCASSERT(object != NULL, "the object can't be NULL");
+        _data.push_back(object);
+        object->retain();
+    }
+
+    void pushBack(const Vector<T>& other)
+    {
+        _data.reserve(_data.size() + other._data.size());
+        for (auto object : other._data)
+        {
+            pushBack(object);
+        }
+    }
+
+    void insert(unsigned int index, T object)
+    {
+        CCASSERT(index <= _data.size(), "index out of range");
+        CCASSERT(object != NULL, "the object can't be NULL");
+        _data.insert(_data.begin() + index, object);
+        object->retain();
+    }
+
+    void popBack()
+    {
+        CCASSERT(! _data.empty(), "the vector is empty");
+        T object = _data.back();
+        _data.pop_back();
+        object->release();
+    }
+
+    /** Removes the first occurrence of object, or all of them */
+    void eraseObject(T object, bool removeAll = false)
+    {
+        CCASSERT(object != NULL, "the object can't be NULL");
+        if (removeAll)
+        {
+            unsigned int count = static_cast<unsigned int>(std::count(_data.begin(), _data.end(), object));
+            _data.erase(std::remove(_data.begin(), _data.end(), object), _data.end());
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                object->release();
+            }
+        }
+        else
+        {
+            auto iter = find(object);
+            if (iter != _data.end())
+            {
+                _data.erase(iter);
+                object->release();
+            }
+        }
+    }
+
+    /** Removes an element, and returns the iterator of the next one */
+    iterator erase(iterator position)
+    {
+        CCASSERT(position >= _data.begin() && position < _data.end(), "iterator out of range");
+        T object = *position;
+        iterator next = _data.erase(position);
+        object->release();
+        return next;
+    }
+
+    iterator erase(unsigned int index)
+    {
+        CCASSERT(index < _data.size(), "index out of range");
+        return erase(_data.begin() + index);
+    }
+
+    /** Removes the elements for which predicate returns true, keeping the order of the others */
+    template<class Predicate>
+    void eraseIf(Predicate predicate)
+    {
+        auto last = std::stable_partition(_data.begin(), _data.end(), [&](T object) { return ! predicate(object); });
+        std::vector<T> removed(last, _data.end());
+        _data.erase(last, _data.end());
+        for (auto object : removed)
+        {
+            object->release();
+        }
+    }
+
+    void clear()
+    {
+        // the elements are released once the vector is empty, their destructors may use it
+        std::vector<T> data;
+        data.swap(_data);
+        for (auto object : data)
+        {
+            object->release();
+        }
+    }
+
+    void replace(unsigned int index, T object)
+    {
+        CCASSERT(index < _data.size(), "index out of range");
+        CCASSERT(object != NULL, "the object can't be NULL");
+        object->retain();
+        _data[index]->release();
+        _data[index] = object;
+    }
+
+    void swap(unsigned int index1, unsigned int index2)
+    {
+        CCASSERT(index1 < _data.size() && index2 < _data.size(), "index out of range");
+        std::swap(_data[index1], _data[index2]);
+    }
+
+    void swap(T object1, T object2)
+    {
+        int index1 = getIndex(object1);
+        int index2 = getIndex(object2);
+        CCASSERT(index1 >= 0 && index2 >= 0, "the objects must be in the vector");
+        std::swap(_data[index1], _data[index2]);
+    }
+
+    inline void reverse() { std::reverse(_data.begin(), _data.end()); }
+
+    inline bool equals(const Vector<T>& other) const { return _data == other._data; }
+
+protected:
+    void retainAll()
+    {
+        for (auto object : _data)
+        {
+            object->retain();
+        }
+    }
+
+    std::vector<T> _data;
+};
+
+// end of data_structures group
+/// @}
+
+NS_CC_END
+
+#endif // __CCVECTOR_H__
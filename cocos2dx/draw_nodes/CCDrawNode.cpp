@@ -23,8 +23,9 @@
 #include "CCDrawNode.h"
 #include "shaders/CCShaderCache.h"
 #include "CCGL.h"
-#include "support/CCNotificationCenter.h"
-#include "CCEventType.h"
+#include "CCDirector.h"
+#include "renderer/CCRenderer.h"
+#include "kazmath/GL/matrix.h"
 
 NS_CC_BEGIN
 
@@ -96,12 +97,9 @@ static inline Tex2F __t(const Vertex2F &v)
 // implementation of DrawNode
 
 DrawNode::DrawNode()
-: _vao(0)
-, _vbo(0)
-, _bufferCapacity(0)
+: _bufferCapacity(0)
 , _bufferCount(0)
 , _buffer(NULL)
-, _dirty(false)
 {
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
 }
@@ -110,19 +108,6 @@ DrawNode::~DrawNode()
 {
     free(_buffer);
     _buffer = NULL;
-    
-    glDeleteBuffers(1, &_vbo);
-    _vbo = 0;
-    
-#if CC_TEXTURE_ATLAS_USE_VAO      
-    glDeleteVertexArrays(1, &_vao);
-    GL::bindVAO(0);
-    _vao = 0;
-#endif
-    
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    NotificationCenter::getInstance()->removeObserver(this, EVNET_COME_TO_FOREGROUND);
-#endif
 }
 
 DrawNode* DrawNode::create()
@@ -158,83 +143,22 @@ bool DrawNode::init()
     setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR));
     
     ensureCapacity(512);
-    
-#if CC_TEXTURE_ATLAS_USE_VAO    
-    glGenVertexArrays(1, &_vao);
-    GL::bindVAO(_vao);
-#endif
-    
-    glGenBuffers(1, &_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)* _bufferCapacity, _buffer, GL_STREAM_DRAW);
-    
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
-    
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
-    
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORDS);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-#if CC_TEXTURE_ATLAS_USE_VAO 
-    GL::bindVAO(0);
-#endif
-    
-    CHECK_GL_ERROR_DEBUG();
-    
-    _dirty = true;
-    
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    // Need to listen the event only when not use batchnode, because it will use VBO
-    NotificationCenter::getInstance()->addObserver(this,
-                                                   callfuncO_selector(DrawNode::listenBackToForeground),
-                                                   EVNET_COME_TO_FOREGROUND,
-                                                   NULL);
-#endif
-    
+
     return true;
 }
 
-void DrawNode::render()
+void DrawNode::draw()
 {
-    if (_dirty)
+    if (_bufferCount == 0)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacity, _buffer, GL_STREAM_DRAW);
-        _dirty = false;
+        return;
     }
-#if CC_TEXTURE_ATLAS_USE_VAO     
-    GL::bindVAO(_vao);
-#else
-    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-    // vertex
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
-    
-    // color
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, colors));
-    
-    // texcood
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, texCoords));
-#endif
 
-    glDrawArrays(GL_TRIANGLES, 0, _bufferCount);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-    CC_INCREMENT_GL_DRAWS(1);
-    CHECK_GL_ERROR_DEBUG();
-}
+    kmMat4 mv;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
 
-void DrawNode::draw()
-{
-    CC_NODE_DRAW_SETUP();
-    GL::blendFunc(_blendFunc.src, _blendFunc.dst);
-
-    render();
+    _primitiveCommand.init(GL_TRIANGLES, getShaderProgram(), _blendFunc, _buffer, _bufferCount, mv);
+    Director::getInstance()->getRenderer()->addCommand(&_primitiveCommand);
 }
 
 void DrawNode::drawDot(const Point &pos, float radius, const Color4F &color)
@@ -254,8 +178,6 @@ void DrawNode::drawDot(const Point &pos, float radius, const Color4F &color)
 	triangles[1] = triangle1;
 	
 	_bufferCount += vertex_count;
-	
-	_dirty = true;
 }
 
 void DrawNode::drawSegment(const Point &from, const Point &to, float radius, const Color4F &color)
@@ -327,8 +249,6 @@ void DrawNode::drawSegment(const Point &from, const Point &to, float radius, con
 	triangles[5] = triangles5;
 	
 	_bufferCount += vertex_count;
-	
-	_dirty = true;
 }
 
 void DrawNode::drawPolygon(Point *verts, unsigned int count, const Color4F &fillColor, float borderWidth, const Color4F &borderColor)
@@ -431,8 +351,6 @@ void DrawNode::drawPolygon(Point *verts, unsigned int count, const Color4F &fill
 	}
 	
 	_bufferCount += vertex_count;
-	
-	_dirty = true;
 
     free(extrude);
 }
@@ -440,7 +358,6 @@ void DrawNode::drawPolygon(Point *verts, unsigned int count, const Color4F &fill
 void DrawNode::clear()
 {
     _bufferCount = 0;
-    _dirty = true;
 }
 
 const BlendFunc& DrawNode::getBlendFunc() const
@@ -457,7 +374,8 @@ void DrawNode::setBlendFunc(const BlendFunc &blendFunc)
  */
 void DrawNode::listenBackToForeground(Object *obj)
 {
-    init();
+    CC_UNUSED_PARAM(obj);
+    // the geometry is drawn by the Renderer: there is no GL object to re-create
 }
 
 NS_CC_END
@@ -32,12 +32,14 @@
 
 #include "base_nodes/CCNode.h"
 #include "ccTypes.h"
+#include "renderer/CCPrimitiveCommand.h"
 
 NS_CC_BEGIN
 
 /** DrawNode
  Node that draws dots, segments and polygons.
  Faster than the "drawing primitives" since they it draws everything in one single batch.
+ The geometry is kept on the CPU, and drawn by the Renderer with the consecutive DrawNodes and drawing primitives.
  
  @since v2.1
  */
@@ -75,10 +77,6 @@ public:
 
 protected:
     void ensureCapacity(int count);
-    void render();
-
-    GLuint      _vao;
-    GLuint      _vbo;
 
     int         _bufferCapacity;
     GLsizei     _bufferCount;
@@ -86,7 +84,7 @@ protected:
 
     BlendFunc   _blendFunc;
 
-    bool        _dirty;
+    PrimitiveCommand _primitiveCommand;
 };
 
 NS_CC_END
@@ -44,8 +44,11 @@ THE SOFTWARE.
 #include "shaders/CCShaderCache.h"
 #include "shaders/CCGLProgram.h"
 #include "actions/CCActionCatmullRom.h"
+#include "renderer/CCRenderer.h"
+#include "kazmath/GL/matrix.h"
 #include <string.h>
 #include <cmath>
+#include <vector>
 
 NS_CC_BEGIN
 #ifndef M_PI
@@ -56,34 +59,18 @@ namespace DrawPrimitives {
 
 static bool s_initialized = false;
 static GLProgram* s_shader = NULL;
+// shader of the lines and polygons, which are batched by the Renderer
+static GLProgram* s_batchShader = NULL;
+static std::vector<V2F_C4B_T2F> s_batchVertices;
 static int s_colorLocation = -1;
 static Color4F s_color(1.0f,1.0f,1.0f,1.0f);
 static int s_pointSizeLocation = -1;
 static GLfloat s_pointSize = 1.0f;
 
 #ifdef EMSCRIPTEN
-static GLuint s_bufferObject = 0;
-static GLuint s_bufferSize = 0;
-
-static void setGLBufferData(void *buf, GLuint bufSize)
+static const GLvoid* setGLBufferData(void *buf, GLuint bufSize)
 {
-    if(s_bufferSize < bufSize)
-    {
-        if(s_bufferObject)
-        {
-            glDeleteBuffers(1, &s_bufferObject);
-        }
-        glGenBuffers(1, &s_bufferObject);
-        s_bufferSize = bufSize;
-
-        glBindBuffer(GL_ARRAY_BUFFER, s_bufferObject);
-        glBufferData(GL_ARRAY_BUFFER, bufSize, buf, GL_DYNAMIC_DRAW);
-    }
-    else
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, s_bufferObject);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, bufSize, buf);
-    }
+    return Director::getInstance()->getRenderer()->getBufferArena()->upload(GL_ARRAY_BUFFER, buf, bufSize);
 }
 
 #endif // EMSCRIPTEN
@@ -103,6 +90,10 @@ static void lazy_init( void )
         s_pointSizeLocation = glGetUniformLocation( s_shader->getProgram(), "u_pointSize");
     CHECK_GL_ERROR_DEBUG();
 
+        // Position, color and a texture coordinate set to 0 so the color is not faded, as DrawNode
+        s_batchShader = ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR);
+        s_batchShader->retain();
+
         s_initialized = true;
     }
 }
@@ -116,9 +107,70 @@ void init()
 void free()
 {
 	CC_SAFE_RELEASE_NULL(s_shader);
+	CC_SAFE_RELEASE_NULL(s_batchShader);
 	s_initialized = false;
 }
 
+static void addBatchVertex(float x, float y, const Color4B& color)
+{
+    V2F_C4B_T2F vertex = { Vertex2F(x, y), color, Tex2F(0.0f, 0.0f) };
+    s_batchVertices.push_back(vertex);
+}
+
+static void addBatchVertices(GLenum mode, float lineWidth)
+{
+    kmMat4 mv;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
+
+    Director::getInstance()->getRenderer()->addPrimitives(mode, s_batchShader, BlendFunc::ALPHA_PREMULTIPLIED, lineWidth,
+                                                          &s_batchVertices[0], (int)s_batchVertices.size(), mv);
+    s_batchVertices.clear();
+}
+
+// adds the segments of a line strip, or of a line loop, to the primitives of the Renderer
+template <typename T>
+static void addLineStrip( const T* points, unsigned int numberOfPoints, bool closePolygon )
+{
+    if( numberOfPoints < 2 )
+        return;
+
+    const Color4B color(s_color);
+    for( unsigned int i = 0; i + 1 < numberOfPoints; i++ )
+    {
+        addBatchVertex(points[i].x, points[i].y, color);
+        addBatchVertex(points[i+1].x, points[i+1].y, color);
+    }
+    if( closePolygon && numberOfPoints > 2 )
+    {
+        addBatchVertex(points[numberOfPoints-1].x, points[numberOfPoints-1].y, color);
+        addBatchVertex(points[0].x, points[0].y, color);
+    }
+
+    // the lines are drawn later: they keep the current width
+    GLfloat lineWidth = 1.0f;
+    glGetFloatv(GL_LINE_WIDTH, &lineWidth);
+
+    addBatchVertices(GL_LINES, lineWidth);
+}
+
+// adds the triangles of a triangle fan to the primitives of the Renderer
+template <typename T>
+static void addTriangleFan( const T* points, unsigned int numberOfPoints, const Color4F& fillColor )
+{
+    if( numberOfPoints < 3 )
+        return;
+
+    const Color4B color(fillColor);
+    for( unsigned int i = 1; i + 1 < numberOfPoints; i++ )
+    {
+        addBatchVertex(points[0].x, points[0].y, color);
+        addBatchVertex(points[i].x, points[i].y, color);
+        addBatchVertex(points[i+1].x, points[i+1].y, color);
+    }
+
+    addBatchVertices(GL_TRIANGLES, 1.0f);
+}
+
 void drawPoint( const Point& point )
 {
     lazy_init();
@@ -135,8 +187,8 @@ void drawPoint( const Point& point )
     s_shader->setUniformLocationWith1f(s_pointSizeLocation, s_pointSize);
 
 #ifdef EMSCRIPTEN
-    setGLBufferData(&p, 8);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    const GLvoid* offset = setGLBufferData(&p, 8);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, offset);
 #else
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, &p);
 #endif // EMSCRIPTEN
@@ -163,8 +215,8 @@ void drawPoints( const Point *points, unsigned int numberOfPoints )
     if( sizeof(Point) == sizeof(Vertex2F) )
     {
 #ifdef EMSCRIPTEN
-        setGLBufferData((void*) points, numberOfPoints * sizeof(Point));
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
+        const GLvoid* offset = setGLBufferData((void*) points, numberOfPoints * sizeof(Point));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, offset);
 #else
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, points);
 #endif // EMSCRIPTEN
@@ -179,8 +231,8 @@ void drawPoints( const Point *points, unsigned int numberOfPoints )
 #ifdef EMSCRIPTEN
         // Suspect Emscripten won't be emitting 64-bit code for a while yet,
         // but want to make sure this continues to work even if they do.
-        setGLBufferData(newPoints, numberOfPoints * sizeof(Vertex2F));
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
+        const GLvoid* offset = setGLBufferData(newPoints, numberOfPoints * sizeof(Vertex2F));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, offset);
 #else
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, newPoints);
 #endif // EMSCRIPTEN
@@ -198,25 +250,8 @@ void drawLine( const Point& origin, const Point& destination )
 {
     lazy_init();
 
-    Vertex2F vertices[2] = {
-        Vertex2F(origin.x, origin.y),
-        Vertex2F(destination.x, destination.y)
-    };
-
-    s_shader->use();
-    s_shader->setUniformsForBuiltins();
-    s_shader->setUniformLocationWith4fv(s_colorLocation, (GLfloat*) &s_color.r, 1);
-
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION );
-#ifdef EMSCRIPTEN
-    setGLBufferData(vertices, 16);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-#endif // EMSCRIPTEN
-    glDrawArrays(GL_LINES, 0, 2);
-
-    CC_INCREMENT_GL_DRAWS(1);
+    Point vertices[2] = { origin, destination };
+    addLineStrip(vertices, 2, false);
 }
 
 void drawRect( Point origin, Point destination )
@@ -243,96 +278,14 @@ void drawPoly( const Point *poli, unsigned int numberOfPoints, bool closePolygon
 {
     lazy_init();
 
-    s_shader->use();
-    s_shader->setUniformsForBuiltins();
-    s_shader->setUniformLocationWith4fv(s_colorLocation, (GLfloat*) &s_color.r, 1);
-
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION );
-
-    // iPhone and 32-bit machines optimization
-    if( sizeof(Point) == sizeof(Vertex2F) )
-    {
-#ifdef EMSCRIPTEN
-        setGLBufferData((void*) poli, numberOfPoints * sizeof(Point));
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, poli);
-#endif // EMSCRIPTEN
-
-        if( closePolygon )
-            glDrawArrays(GL_LINE_LOOP, 0, (GLsizei) numberOfPoints);
-        else
-            glDrawArrays(GL_LINE_STRIP, 0, (GLsizei) numberOfPoints);
-    }
-    else
-    {
-        // Mac on 64-bit
-        // XXX: Mac OpenGL error. arrays can't go out of scope before draw is executed
-        Vertex2F* newPoli = new Vertex2F[numberOfPoints];
-        for( unsigned int i=0; i<numberOfPoints;i++) {
-            newPoli[i].x = poli[i].x;
-            newPoli[i].y = poli[i].y;
-        }
-#ifdef EMSCRIPTEN
-        setGLBufferData(newPoli, numberOfPoints * sizeof(Vertex2F));
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, newPoli);
-#endif // EMSCRIPTEN
-
-        if( closePolygon )
-            glDrawArrays(GL_LINE_LOOP, 0, (GLsizei) numberOfPoints);
-        else
-            glDrawArrays(GL_LINE_STRIP, 0, (GLsizei) numberOfPoints);
-
-        CC_SAFE_DELETE_ARRAY(newPoli);
-    }
-
-    CC_INCREMENT_GL_DRAWS(1);
+    addLineStrip(poli, numberOfPoints, closePolygon);
 }
 
 void drawSolidPoly( const Point *poli, unsigned int numberOfPoints, Color4F color )
 {
     lazy_init();
 
-    s_shader->use();
-    s_shader->setUniformsForBuiltins();
-    s_shader->setUniformLocationWith4fv(s_colorLocation, (GLfloat*) &color.r, 1);
-
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION );
-
-    // XXX: Mac OpenGL error. arrays can't go out of scope before draw is executed
-    Vertex2F* newPoli = new Vertex2F[numberOfPoints];
-
-    // iPhone and 32-bit machines optimization
-    if( sizeof(Point) == sizeof(Vertex2F) )
-    {
-#ifdef EMSCRIPTEN
-        setGLBufferData((void*) poli, numberOfPoints * sizeof(Point));
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, poli);
-#endif // EMSCRIPTEN
-    }
-    else
-    {
-        // Mac on 64-bit
-        for( unsigned int i=0; i<numberOfPoints;i++)
-        {
-            newPoli[i] = Vertex2F( poli[i].x, poli[i].y );
-        }
-#ifdef EMSCRIPTEN
-        setGLBufferData(newPoli, numberOfPoints * sizeof(Vertex2F));
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, newPoli);
-#endif // EMSCRIPTEN
-    }    
-
-    glDrawArrays(GL_TRIANGLE_FAN, 0, (GLsizei) numberOfPoints);
-
-    CC_SAFE_DELETE_ARRAY(newPoli);
-    CC_INCREMENT_GL_DRAWS(1);
+    addTriangleFan(poli, numberOfPoints, color);
 }
 
 void drawCircle( const Point& center, float radius, float angle, unsigned int segments, bool drawLineToCenter, float scaleX, float scaleY)
@@ -345,38 +298,20 @@ void drawCircle( const Point& center, float radius, float angle, unsigned int se
 
     const float coef = 2.0f * (float)M_PI/segments;
 
-    GLfloat *vertices = (GLfloat*)calloc( sizeof(GLfloat)*2*(segments+2), 1);
-    if( ! vertices )
-        return;
+    Vertex2F *vertices = new Vertex2F[segments + 2];
 
     for(unsigned int i = 0;i <= segments; i++) {
         float rads = i*coef;
         GLfloat j = radius * cosf(rads + angle) * scaleX + center.x;
         GLfloat k = radius * sinf(rads + angle) * scaleY + center.y;
 
-        vertices[i*2] = j;
-        vertices[i*2+1] = k;
+        vertices[i] = Vertex2F(j, k);
     }
-    vertices[(segments+1)*2] = center.x;
-    vertices[(segments+1)*2+1] = center.y;
-
-    s_shader->use();
-    s_shader->setUniformsForBuiltins();
-    s_shader->setUniformLocationWith4fv(s_colorLocation, (GLfloat*) &s_color.r, 1);
+    vertices[segments+1] = Vertex2F(center.x, center.y);
 
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION );
+    addLineStrip(vertices, segments+additionalSegment, false);
 
-#ifdef EMSCRIPTEN
-    setGLBufferData(vertices, sizeof(GLfloat)*2*(segments+2));
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-#endif // EMSCRIPTEN
-    glDrawArrays(GL_LINE_STRIP, 0, (GLsizei) segments+additionalSegment);
-
-    ::free( vertices );
-
-    CC_INCREMENT_GL_DRAWS(1);
+    CC_SAFE_DELETE_ARRAY(vertices);
 }
 
 void drawCircle( const Point& center, float radius, float angle, unsigned int segments, bool drawLineToCenter)
@@ -390,39 +325,20 @@ void drawSolidCircle( const Point& center, float radius, float angle, unsigned i
     
     const float coef = 2.0f * (float)M_PI/segments;
     
-    GLfloat *vertices = (GLfloat*)calloc( sizeof(GLfloat)*2*(segments+2), 1);
-    if( ! vertices )
-        return;
+    Vertex2F *vertices = new Vertex2F[segments + 2];
     
     for(unsigned int i = 0;i <= segments; i++) {
         float rads = i*coef;
         GLfloat j = radius * cosf(rads + angle) * scaleX + center.x;
         GLfloat k = radius * sinf(rads + angle) * scaleY + center.y;
         
-        vertices[i*2] = j;
-        vertices[i*2+1] = k;
+        vertices[i] = Vertex2F(j, k);
     }
-    vertices[(segments+1)*2] = center.x;
-    vertices[(segments+1)*2+1] = center.y;
+    vertices[segments+1] = Vertex2F(center.x, center.y);
     
-    s_shader->use();
-    s_shader->setUniformsForBuiltins();
-    s_shader->setUniformLocationWith4fv(s_colorLocation, (GLfloat*) &s_color.r, 1);
+    addTriangleFan(vertices, segments+1, s_color);
     
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION );
-    
-#ifdef EMSCRIPTEN
-    setGLBufferData(vertices, sizeof(GLfloat)*2*(segments+2));
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-#endif // EMSCRIPTEN
-    
-    glDrawArrays(GL_TRIANGLE_FAN, 0, (GLsizei) segments+1);
-    
-    ::free( vertices );
-    
-    CC_INCREMENT_GL_DRAWS(1);
+    CC_SAFE_DELETE_ARRAY(vertices);
 }
 
 void drawSolidCircle( const Point& center, float radius, float angle, unsigned int segments)
@@ -446,22 +362,9 @@ void drawQuadBezier(const Point& origin, const Point& control, const Point& dest
     vertices[segments].x = destination.x;
     vertices[segments].y = destination.y;
 
-    s_shader->use();
-    s_shader->setUniformsForBuiltins();
-    s_shader->setUniformLocationWith4fv(s_colorLocation, (GLfloat*) &s_color.r, 1);
+    addLineStrip(vertices, segments + 1, false);
 
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION );
-
-#ifdef EMSCRIPTEN
-    setGLBufferData(vertices, (segments + 1) * sizeof(Vertex2F));
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-#endif // EMSCRIPTEN
-    glDrawArrays(GL_LINE_STRIP, 0, (GLsizei) segments + 1);
     CC_SAFE_DELETE_ARRAY(vertices);
-
-    CC_INCREMENT_GL_DRAWS(1);
 }
 
 void drawCatmullRom( PointArray *points, unsigned int segments )
@@ -503,22 +406,9 @@ void drawCardinalSpline( PointArray *config, float tension,  unsigned int segmen
         vertices[i].y = newPos.y;
     }
 
-    s_shader->use();
-    s_shader->setUniformsForBuiltins();
-    s_shader->setUniformLocationWith4fv(s_colorLocation, (GLfloat*)&s_color.r, 1);
-
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION );
-
-#ifdef EMSCRIPTEN
-    setGLBufferData(vertices, (segments + 1) * sizeof(Vertex2F));
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-#endif // EMSCRIPTEN
-    glDrawArrays(GL_LINE_STRIP, 0, (GLsizei) segments + 1);
+    addLineStrip(vertices, segments + 1, false);
 
     CC_SAFE_DELETE_ARRAY(vertices);
-    CC_INCREMENT_GL_DRAWS(1);
 }
 
 void drawCubicBezier(const Point& origin, const Point& control1, const Point& control2, const Point& destination, unsigned int segments)
@@ -537,22 +427,9 @@ void drawCubicBezier(const Point& origin, const Point& control1, const Point& co
     vertices[segments].x = destination.x;
     vertices[segments].y = destination.y;
 
-    s_shader->use();
-    s_shader->setUniformsForBuiltins();
-    s_shader->setUniformLocationWith4fv(s_colorLocation, (GLfloat*) &s_color.r, 1);
+    addLineStrip(vertices, segments + 1, false);
 
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION );
-
-#ifdef EMSCRIPTEN
-    setGLBufferData(vertices, (segments + 1) * sizeof(Vertex2F));
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-#endif // EMSCRIPTEN
-    glDrawArrays(GL_LINE_STRIP, 0, (GLsizei) segments + 1);
     CC_SAFE_DELETE_ARRAY(vertices);
-
-    CC_INCREMENT_GL_DRAWS(1);
 }
 
 void setDrawColor4F( GLfloat r, GLfloat g, GLfloat b, GLfloat a )
@@ -62,7 +62,12 @@ THE SOFTWARE.
  - ccPointSize()
  - glLineWidth()
  
- @warning These functions draws the Line, Point, Polygon, immediately. They aren't batched. If you are going to make a game that depends on these primitives, I suggest creating a batch. Instead you should use DrawNode
+ The lines, polygons, circles and curves are added to the batch of primitives of the Renderer: they are transformed
+ with the current model-view matrix, and drawn with a single draw call with the consecutive primitives and DrawNodes,
+ before the next draw call. They use the line width that is current when they are added.
+
+ @warning The points are still drawn immediately, one draw call per function. If you are going to make a game that
+ depends on these primitives, you should use DrawNode, which keeps its geometry between frames.
  
  */
 
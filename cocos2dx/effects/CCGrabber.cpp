@@ -25,6 +25,7 @@ THE SOFTWARE.
 #include "CCGrabber.h"
 #include "ccMacros.h"
 #include "textures/CCTexture2D.h"
+#include "shaders/ccGLStateCache.h"
 
 NS_CC_BEGIN
 
@@ -40,10 +41,10 @@ Grabber::Grabber(void)
 
 void Grabber::grab(Texture2D *texture)
 {
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
+    _oldFBO = GL::getBoundFramebuffer();
 
     // bind
-    glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+    GL::bindFramebuffer(_FBO);
 
     // associate texture with FBO
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->getName(), 0);
@@ -55,15 +56,15 @@ void Grabber::grab(Texture2D *texture)
         CCASSERT(0, "Frame Grabber: could not attach texture to framebuffer");
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
+    GL::bindFramebuffer(_oldFBO);
 }
 
 void Grabber::beforeRender(Texture2D *texture)
 {
     CC_UNUSED_PARAM(texture);
 
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+    _oldFBO = GL::getBoundFramebuffer();
+    GL::bindFramebuffer(_FBO);
     
     // save clear color
     glGetFloatv(GL_COLOR_CLEAR_VALUE, _oldClearColor);
@@ -84,7 +85,7 @@ void Grabber::afterRender(cocos2d::Texture2D *texture)
 {
     CC_UNUSED_PARAM(texture);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
+    GL::bindFramebuffer(_oldFBO);
 //  glColorMask(true, true, true, true);    // #631
     
     // Restore clear color
@@ -94,7 +95,7 @@ void Grabber::afterRender(cocos2d::Texture2D *texture)
 Grabber::~Grabber()
 {
     CCLOGINFO("cocos2d: deallocing %p", this);
-    glDeleteFramebuffers(1, &_FBO);
+    GL::deleteFramebuffer(_FBO);
 }
 
 NS_CC_END
@@ -34,8 +34,106 @@ THE SOFTWARE.
 #include "support/TransformUtils.h"
 #include "kazmath/kazmath.h"
 #include "kazmath/GL/matrix.h"
+#include "renderer/CCRenderer.h"
+#include <vector>
 
 NS_CC_BEGIN
+
+// Window sized render targets shared by the grids that don't bring their own texture.
+// A grid renders its target between beforeDraw() and afterDraw(), so only nested grids
+// (an effect on a child of a node running an effect) need targets of their own:
+// there is one per nesting level instead of a texture and an FBO per grid.
+struct GridTarget
+{
+    Texture2D *texture;
+    Grabber *grabber;
+};
+
+static std::vector<GridTarget> s_gridTargets;
+static unsigned int s_gridTargetDepth = 0;
+
+static bool createGridTarget(const Size& size, GridTarget *target)
+{
+    unsigned long POTWide = ccNextPOT((unsigned int)size.width);
+    unsigned long POTHigh = ccNextPOT((unsigned int)size.height);
+
+    // we only use rgba8888
+    Texture2D::PixelFormat format = Texture2D::PixelFormat::RGBA8888;
+
+    void *data = calloc((int)(POTWide * POTHigh * 4), 1);
+    if (! data)
+    {
+        CCLOG("cocos2d: Grid: not enough memory.");
+        return false;
+    }
+
+    Texture2D *texture = new Texture2D();
+    bool ret = texture->initWithData(data, format, POTWide, POTHigh, size);
+    free(data);
+
+    if (! ret)
+    {
+        CCLOG("cocos2d: Grid: error creating texture");
+        texture->release();
+        return false;
+    }
+
+    target->texture = texture;
+    target->grabber = new Grabber();
+    target->grabber->grab(texture);
+
+    return true;
+}
+
+// returns the target of the given nesting level, recreated if the window was resized
+static GridTarget* getGridTarget(unsigned int level)
+{
+    CCASSERT(level <= s_gridTargets.size(), "Grid targets are taken one level at a time");
+
+    Size size = Director::getInstance()->getWinSizeInPixels();
+
+    if (level < s_gridTargets.size())
+    {
+        GridTarget& target = s_gridTargets[level];
+        if (target.texture->getContentSizeInPixels().equals(size))
+        {
+            return &target;
+        }
+
+        GridTarget resized;
+        if (! createGridTarget(size, &resized))
+        {
+            return NULL;
+        }
+
+        target.texture->release();
+        target.grabber->release();
+        target = resized;
+        return &target;
+    }
+
+    GridTarget target;
+    if (! createGridTarget(size, &target))
+    {
+        return NULL;
+    }
+
+    s_gridTargets.push_back(target);
+    return &s_gridTargets.back();
+}
+
+void GridBase::purgeCachedData()
+{
+    // the targets in use are still referenced by their grids
+    for (auto it = s_gridTargets.begin(); it != s_gridTargets.end(); ++it)
+    {
+        it->texture->release();
+        it->grabber->release();
+    }
+
+    s_gridTargets.clear();
+}
+
 // implementation of GridBase
 
 GridBase* GridBase::create(const Size& gridSize)
@@ -87,6 +185,7 @@ bool GridBase::initWithSize(const Size& gridSize, Texture2D *texture, bool bFlip
     _texture = texture;
     CC_SAFE_RETAIN(_texture);
     _isTextureFlipped = bFlipped;
+    _sharesTarget = false;
 
     Size texSize = _texture->getContentSize();
     _step.x = texSize.width / _gridSize.width;
@@ -110,37 +209,31 @@ bool GridBase::initWithSize(const Size& gridSize, Texture2D *texture, bool bFlip
 
 bool GridBase::initWithSize(const Size& gridSize)
 {
-    Director *pDirector = Director::getInstance();
-    Size s = pDirector->getWinSizeInPixels();
-    
-    unsigned long POTWide = ccNextPOT((unsigned int)s.width);
-    unsigned long POTHigh = ccNextPOT((unsigned int)s.height);
-
-    // we only use rgba8888
-    Texture2D::PixelFormat format = Texture2D::PixelFormat::RGBA8888;
-
-    void *data = calloc((int)(POTWide * POTHigh * 4), 1);
-    if (! data)
+    // the texture of the first level only gives the size of the grid,
+    // the target is taken again for the nesting level in beforeDraw()
+    GridTarget *target = getGridTarget(0);
+    if (! target)
     {
-        CCLOG("cocos2d: Grid: not enough memory.");
-        this->release();
         return false;
     }
 
-    Texture2D *texture = new Texture2D();
-    texture->initWithData(data, format, POTWide, POTHigh, s);
-
-    free(data);
+    _active = false;
+    _reuseGrid = 0;
+    _gridSize = gridSize;
 
-    if (! texture)
-    {
-        CCLOG("cocos2d: Grid: error creating texture");
-        return false;
-    }
+    _texture = target->texture;
+    _texture->retain();
+    _grabber = target->grabber;
+    _grabber->retain();
+    _isTextureFlipped = false;
+    _sharesTarget = true;
 
-    initWithSize(gridSize, texture, false);
+    Size texSize = _texture->getContentSize();
+    _step.x = texSize.width / _gridSize.width;
+    _step.y = texSize.height / _gridSize.height;
 
-    texture->release();
+    _shaderProgram = ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE);
+    calculateVertexPoints();
 
     return true;
 }
@@ -199,18 +292,54 @@ void GridBase::beforeDraw(void)
 {
     // save projection
     Director *director = Director::getInstance();
+    director->getRenderer()->flush();
     _directorProjection = director->getProjection();
 
     // 2d projection
     //    [director setProjection:Director::Projection::_2D];
     set2DProjection();
+
+    if (_sharesTarget)
+    {
+        GridTarget *target = getGridTarget(s_gridTargetDepth);
+        if (target)
+        {
+            if (target->texture != _texture)
+            {
+                bool resized = ! target->texture->getContentSize().equals(_texture->getContentSize());
+
+                target->texture->retain();
+                _texture->release();
+                _texture = target->texture;
+                target->grabber->retain();
+                _grabber->release();
+                _grabber = target->grabber;
+
+                if (resized)
+                {
+                    Size texSize = _texture->getContentSize();
+                    _step.x = texSize.width / _gridSize.width;
+                    _step.y = texSize.height / _gridSize.height;
+                    calculateVertexPoints();
+                }
+            }
+        }
+        ++s_gridTargetDepth;
+    }
+
     _grabber->beforeRender(_texture);
 }
 
 void GridBase::afterDraw(cocos2d::Node *target)
 {
+    Director::getInstance()->getRenderer()->flush();
     _grabber->afterRender(_texture);
 
+    if (_sharesTarget)
+    {
+        --s_gridTargetDepth;
+    }
+
     // restore projection
     Director *director = Director::getInstance();
     director->setProjection(_directorProjection);
@@ -298,6 +427,7 @@ Grid3D::Grid3D()
     , _vertices(NULL)
     , _originalVertices(NULL)
     , _indices(NULL)
+    , _effectProgram(NULL)
 {
 
 }
@@ -315,8 +445,21 @@ void Grid3D::blit(void)
     int n = _gridSize.width * _gridSize.height;
 
     GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION | GL::VERTEX_ATTRIB_FLAG_TEX_COORDS );
-    _shaderProgram->use();
-    _shaderProgram->setUniformsForBuiltins();;
+
+    // the effect displaces the original vertices, _vertices are only updated on the CPU when it is cleared
+    GLvoid *vertices = _vertices;
+    if (_effectProgram)
+    {
+        vertices = _originalVertices;
+        _effectProgram->use();
+        _effectProgram->setUniformsForBuiltins();
+        _effectProgram->setUniformLocationWith4fv(_effectProgram->getUniformLocationForName("u_effect"), _effectParams, 2);
+    }
+    else
+    {
+        _shaderProgram->use();
+        _shaderProgram->setUniformsForBuiltins();
+    }
 
     //
     // Attributes
@@ -326,18 +469,18 @@ void Grid3D::blit(void)
     unsigned int numOfPoints = (_gridSize.width+1) * (_gridSize.height+1);
 
     // position
-    setGLBufferData(_vertices, numOfPoints * sizeof(Vertex3F), 0);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    const GLvoid* offset = setGLBufferData(vertices, numOfPoints * sizeof(Vertex3F));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, offset);
 
     // texCoords
-    setGLBufferData(_texCoordinates, numOfPoints * sizeof(Vertex2F), 1);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    offset = setGLBufferData(_texCoordinates, numOfPoints * sizeof(Vertex2F));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, offset);
 
-    setGLIndexData(_indices, n * 12, 0);
-    glDrawElements(GL_TRIANGLES, (GLsizei) n*6, GL_UNSIGNED_SHORT, 0);
+    offset = setGLIndexData(_indices, n * 12);
+    glDrawElements(GL_TRIANGLES, (GLsizei) n*6, GL_UNSIGNED_SHORT, offset);
 #else
     // position
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, _vertices);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, vertices);
 
     // texCoords
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, _texCoordinates);
@@ -345,6 +488,7 @@ void Grid3D::blit(void)
     glDrawElements(GL_TRIANGLES, (GLsizei) n*6, GL_UNSIGNED_SHORT, _indices);
 #endif // EMSCRIPTEN
     CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_QUADS(n);
 }
 
 void Grid3D::calculateVertexPoints(void)
@@ -455,12 +599,26 @@ void Grid3D::setVertex(const Point& pos, const Vertex3F& vertex)
     vertArray[index] = vertex.x;
     vertArray[index+1] = vertex.y;
     vertArray[index+2] = vertex.z;
+
+    _effectProgram = NULL;
+}
+
+void Grid3D::setVertexEffect(GLProgram *program, const GLfloat *params)
+{
+    _effectProgram = program;
+    memcpy(_effectParams, params, sizeof(_effectParams));
+}
+
+void Grid3D::clearVertexEffect()
+{
+    _effectProgram = NULL;
 }
 
 void Grid3D::reuse(void)
 {
     if (_reuseGrid > 0)
     {
+        _effectProgram = NULL;
         memcpy(_originalVertices, _vertices, (_gridSize.width+1) * (_gridSize.height+1) * sizeof(Vertex3F));
         --_reuseGrid;
     }
@@ -541,15 +699,15 @@ void TiledGrid3D::blit(void)
     int numQuads = _gridSize.width * _gridSize.height;
 
     // position
-    setGLBufferData(_vertices, (numQuads*4*sizeof(Vertex3F)), 0);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    const GLvoid* offset = setGLBufferData(_vertices, (numQuads*4*sizeof(Vertex3F)));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, offset);
 
     // texCoords
-    setGLBufferData(_texCoordinates, (numQuads*4*sizeof(Vertex2F)), 1);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    offset = setGLBufferData(_texCoordinates, (numQuads*4*sizeof(Vertex2F)));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, offset);
 
-    setGLIndexData(_indices, n * 12, 0);
-    glDrawElements(GL_TRIANGLES, (GLsizei) n*6, GL_UNSIGNED_SHORT, 0);
+    offset = setGLIndexData(_indices, n * 12);
+    glDrawElements(GL_TRIANGLES, (GLsizei) n*6, GL_UNSIGNED_SHORT, offset);
 #else
     // position
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, _vertices);
@@ -562,6 +720,7 @@ void TiledGrid3D::blit(void)
 
 
     CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_QUADS(n);
 }
 
 void TiledGrid3D::calculateVertexPoints(void)
@@ -60,8 +60,12 @@ public:
     virtual ~GridBase(void);
 
     bool initWithSize(const Size& gridSize, Texture2D *texture, bool bFlipped);
+    /** initializes a grid that renders into a window sized texture shared with the other grids */
     bool initWithSize(const Size& gridSize);
 
+    /** releases the shared render targets that aren't in use */
+    static void purgeCachedData();
+
     /** whether or not the grid is active */
     inline bool isActive(void) { return _active; }
     void setActive(bool bActive);
@@ -98,6 +102,8 @@ protected:
     Point _step;
     Grabber *_grabber;
     bool _isTextureFlipped;
+    /** whether _texture and _grabber are taken from the shared render targets */
+    bool _sharesTarget;
     GLProgram* _shaderProgram;
     Director::Projection _directorProjection;
 };
@@ -131,6 +137,15 @@ public:
     /** sets a new vertex at a given position */
     void setVertex(const Point& pos, const Vertex3F& vertex);
 
+    /** displaces the original vertices in the vertex shader instead of drawing the vertices set on the CPU.
+     params are the 8 floats of the u_effect uniform of the program; the effect is cleared by setVertex() and reuse().
+     */
+    void setVertexEffect(GLProgram *program, const GLfloat *params);
+    /** clears the effect set with setVertexEffect() */
+    void clearVertexEffect();
+    /** whether the vertices are displaced in the vertex shader */
+    inline bool hasVertexEffect() const { return _effectProgram != NULL; }
+
     // Overrides
     virtual void blit() override;
     virtual void reuse() override;
@@ -141,6 +156,8 @@ protected:
     GLvoid *_vertices;
     GLvoid *_originalVertices;
     GLushort *_indices;
+    GLProgram *_effectProgram;
+    GLfloat _effectParams[8];
 };
 
 /**
@@ -0,0 +1,76 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCEvent.h"
+
+NS_CC_BEGIN
+
+Event::Event(Type type)
+: _type(type)
+, _isStopped(false)
+, _currentTarget(NULL)
+{
+}
+
+EventTouch::EventTouch(EventCode eventCode, const std::vector<Touch*>& touches)
+: Event(Type::TOUCH)
+, _eventCode(eventCode)
+, _touches(touches)
+{
+}
+
+EventTouch::EventTouch(EventCode eventCode, std::vector<Touch*>&& touches)
+: Event(Type::TOUCH)
+, _eventCode(eventCode)
+, _touches(std::move(touches))
+{
+}
+
+EventKeyboard::EventKeyboard(int keyCode, bool isPressed)
+: Event(Type::KEYBOARD)
+, _keyCode(keyCode)
+, _isPressed(isPressed)
+{
+}
+
+EventKeypad::EventKeypad(ccKeypadMSGType msgType)
+: Event(Type::KEYPAD)
+, _msgType(msgType)
+{
+}
+
+EventAcceleration::EventAcceleration(const Acceleration& acceleration)
+: Event(Type::ACCELERATION)
+, _acceleration(acceleration)
+{
+}
+
+EventCustom::EventCustom(const std::string& eventName, void* userData)
+: Event(Type::CUSTOM)
+, _eventName(eventName)
+, _userData(userData)
+{
+}
+
+NS_CC_END
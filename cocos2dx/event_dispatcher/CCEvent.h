@@ -0,0 +1,181 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __EVENT_DISPATCHER_CCEVENT_H__
+#define __EVENT_DISPATCHER_CCEVENT_H__
+
+#include "cocoa/CCObject.h"
+#include "keypad_dispatcher/CCKeypadDispatcher.h"
+#include "platform/CCAccelerometerDelegate.h"
+#include <string>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup input
+ * @{
+ */
+
+class Node;
+class Touch;
+
+/** @brief Base class of the events.
+ The legacy dispatchers pass NULL or an Event of type UNKNOWN to their delegates.
+ */
+class CC_DLL Event : public Object
+{
+public:
+    enum class Type
+    {
+        UNKNOWN,
+        TOUCH,
+        KEYBOARD,
+        KEYPAD,
+        ACCELERATION,
+        CUSTOM,
+    };
+
+    Event(Type type = Type::UNKNOWN);
+
+    Type getType() const { return _type; }
+
+    /** Stops the propagation of the event: the listeners after the current one don't get it.
+     @since v3.0
+     */
+    void stopPropagation() { _isStopped = true; }
+    bool isStopped() const { return _isStopped; }
+
+    /** Node of the listener being called, NULL for the listeners with a fixed priority.
+     @since v3.0
+     */
+    Node* getCurrentTarget() const { return _currentTarget; }
+
+protected:
+    Type _type;
+    bool _isStopped;
+    Node* _currentTarget;
+
+    friend class EventDispatcher;
+};
+
+/** @brief Touches that began, moved, ended or were cancelled.
+ @since v3.0
+ */
+class CC_DLL EventTouch : public Event
+{
+public:
+    enum class EventCode
+    {
+        BEGAN,
+        MOVED,
+        ENDED,
+        CANCELLED,
+    };
+
+    EventTouch(EventCode eventCode, const std::vector<Touch*>& touches);
+    /** takes the storage of touches, so that a caller dispatching many events can reuse it */
+    EventTouch(EventCode eventCode, std::vector<Touch*>&& touches);
+
+    EventCode getEventCode() const { return _eventCode; }
+
+    /** The touches of the event. Once dispatched, only the touches that no listener swallowed are left. */
+    const std::vector<Touch*>& getTouches() const { return _touches; }
+
+protected:
+    EventCode _eventCode;
+    std::vector<Touch*> _touches;
+
+    friend class EventDispatcher;
+    friend class TouchDispatcher;
+};
+
+/** @brief A key pressed or released on a keyboard.
+ @since v3.0
+ */
+class CC_DLL EventKeyboard : public Event
+{
+public:
+    EventKeyboard(int keyCode, bool isPressed);
+
+    int getKeyCode() const { return _keyCode; }
+    bool isPressed() const { return _isPressed; }
+
+protected:
+    int _keyCode;
+    bool _isPressed;
+};
+
+/** @brief The back or menu key of a phone.
+ @since v3.0
+ */
+class CC_DLL EventKeypad : public Event
+{
+public:
+    EventKeypad(ccKeypadMSGType msgType);
+
+    ccKeypadMSGType getMsgType() const { return _msgType; }
+
+protected:
+    ccKeypadMSGType _msgType;
+};
+
+/** @brief A sample of the accelerometer.
+ @since v3.0
+ */
+class CC_DLL EventAcceleration : public Event
+{
+public:
+    EventAcceleration(const Acceleration& acceleration);
+
+    const Acceleration& getAcceleration() const { return _acceleration; }
+
+protected:
+    Acceleration _acceleration;
+};
+
+/** @brief An event of the game, identified by its name.
+ @since v3.0
+ */
+class CC_DLL EventCustom : public Event
+{
+public:
+    EventCustom(const std::string& eventName, void* userData = NULL);
+
+    const std::string& getEventName() const { return _eventName; }
+
+    void* getUserData() const { return _userData; }
+    void setUserData(void* userData) { _userData = userData; }
+
+protected:
+    std::string _eventName;
+    void* _userData;
+};
+
+// end of input group
+/// @}
+
+NS_CC_END
+
+#endif // __EVENT_DISPATCHER_CCEVENT_H__
@@ -0,0 +1,698 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCEventDispatcher.h"
+#include "CCDirector.h"
+#include "base_nodes/CCNode.h"
+#include "layers_scenes_transitions_nodes/CCScene.h"
+#include "CCAccelerometer.h"
+#include "ccMacros.h"
+#include "support/CCInputRecorder.h"
+#include <algorithm>
+
+NS_CC_BEGIN
+
+EventDispatcher::EventDispatcher()
+: _sceneGraphOrderVersion(0)
+, _sceneGraphDirty(true)
+, _orderedScene(NULL)
+, _inDispatch(0)
+, _isEnabled(true)
+, _isListeningAccelerometer(false)
+{
+}
+
+EventDispatcher::~EventDispatcher()
+{
+    for (auto& iter : _listeners)
+    {
+        for (auto listener : iter.second.fixedListeners)
+        {
+            listener->_isRegistered = false;
+            listener->release();
+        }
+        for (auto listener : iter.second.sceneGraphListeners)
+        {
+            listener->_isRegistered = false;
+            listener->release();
+        }
+    }
+
+    for (auto& pending : _toAddedListeners)
+    {
+        pending.listener->_isRegistered = false;
+        pending.listener->release();
+    }
+}
+
+//
+// listeners management
+//
+void EventDispatcher::addEventListenerWithSceneGraphPriority(EventListener* listener, Node* node)
+{
+    CCASSERT(listener != NULL && node != NULL, "Invalid parameters.");
+
+    addEventListener(listener, node, 0);
+}
+
+void EventDispatcher::addEventListenerWithFixedPriority(EventListener* listener, int fixedPriority)
+{
+    CCASSERT(listener != NULL, "Invalid parameters.");
+    CCASSERT(fixedPriority != 0, "0 is reserved for the listeners bound to nodes");
+
+    addEventListener(listener, NULL, fixedPriority);
+}
+
+void EventDispatcher::addEventListener(EventListener* listener, Node* node, int fixedPriority)
+{
+    CCASSERT(! listener->_isRegistered, "The listener has already been added.");
+
+    listener->_isRegistered = true;
+    listener->retain();
+
+    if (_inDispatch > 0)
+    {
+        PendingListener pending = { listener, node, fixedPriority };
+        _toAddedListeners.push_back(pending);
+    }
+    else
+    {
+        forceAddEventListener(listener, node, fixedPriority);
+    }
+}
+
+void EventDispatcher::forceAddEventListener(EventListener* listener, Node* node, int fixedPriority)
+{
+    listener->_node = node;
+    listener->_fixedPriority = fixedPriority;
+
+    Listeners& listeners = _listeners[listener->_listenerID];
+    if (node)
+    {
+        listeners.sceneGraphListeners.push_back(listener);
+        listeners.sceneGraphDirty = true;
+        _nodeListeners[node].push_back(listener);
+
+        // only the nodes that have listeners are in the cached order
+        if (_nodeOrder.find(node) == _nodeOrder.end())
+        {
+            _sceneGraphDirty = true;
+        }
+    }
+    else
+    {
+        listeners.fixedListeners.push_back(listener);
+        listeners.fixedDirty = true;
+    }
+
+    if (listener->_type == Event::Type::ACCELERATION)
+    {
+        updateAccelerometer();
+    }
+}
+
+void EventDispatcher::removeEventListener(EventListener* listener)
+{
+    if (listener == NULL || ! listener->_isRegistered)
+    {
+        return;
+    }
+
+    listener->_isRegistered = false;
+
+    for (auto iter = _toAddedListeners.begin(); iter != _toAddedListeners.end(); ++iter)
+    {
+        if (iter->listener == listener)
+        {
+            _toAddedListeners.erase(iter);
+            listener->release();
+            return;
+        }
+    }
+
+    if (_inDispatch > 0)
+    {
+        // the vectors are being iterated: the listener is skipped, and removed once the event is dispatched
+        _toRemovedListeners.push_back(listener);
+    }
+    else
+    {
+        forceRemoveEventListener(listener);
+    }
+}
+
+void EventDispatcher::forceRemoveEventListener(EventListener* listener)
+{
+    Listeners& listeners = _listeners[listener->_listenerID];
+    std::vector<EventListener*>& vec = (listener->_node ? listeners.sceneGraphListeners : listeners.fixedListeners);
+
+    auto iter = std::find(vec.begin(), vec.end(), listener);
+    if (iter != vec.end())
+    {
+        vec.erase(iter);
+    }
+
+    if (listener->_node)
+    {
+        auto nodeIter = _nodeListeners.find(listener->_node);
+        if (nodeIter != _nodeListeners.end())
+        {
+            std::vector<EventListener*>& nodeListeners = nodeIter->second;
+            nodeListeners.erase(std::remove(nodeListeners.begin(), nodeListeners.end(), listener), nodeListeners.end());
+            if (nodeListeners.empty())
+            {
+                _nodeListeners.erase(nodeIter);
+            }
+        }
+        listener->_node = NULL;
+    }
+
+    if (listener->_type == Event::Type::ACCELERATION)
+    {
+        updateAccelerometer();
+    }
+
+    listener->release();
+}
+
+void EventDispatcher::removeEventListenersForNode(Node* node)
+{
+    std::vector<EventListener*> removed;
+
+    auto nodeIter = _nodeListeners.find(node);
+    if (nodeIter != _nodeListeners.end())
+    {
+        removed = nodeIter->second;
+    }
+
+    for (auto& pending : _toAddedListeners)
+    {
+        if (pending.node == node)
+        {
+            removed.push_back(pending.listener);
+        }
+    }
+
+    for (auto listener : removed)
+    {
+        removeEventListener(listener);
+    }
+}
+
+void EventDispatcher::removeEventListeners(Event::Type type)
+{
+    removeCustomEventListeners(EventListener::getListenerIDForType(type));
+}
+
+void EventDispatcher::removeCustomEventListeners(const std::string& eventName)
+{
+    std::vector<EventListener*> removed;
+
+    auto iter = _listeners.find(eventName);
+    if (iter != _listeners.end())
+    {
+        removed = iter->second.fixedListeners;
+        removed.insert(removed.end(), iter->second.sceneGraphListeners.begin(), iter->second.sceneGraphListeners.end());
+    }
+
+    for (auto& pending : _toAddedListeners)
+    {
+        if (pending.listener->_listenerID == eventName)
+        {
+            removed.push_back(pending.listener);
+        }
+    }
+
+    for (auto listener : removed)
+    {
+        removeEventListener(listener);
+    }
+}
+
+void EventDispatcher::removeAllEventListeners()
+{
+    std::vector<EventListener*> removed;
+    for (auto& iter : _listeners)
+    {
+        removed.insert(removed.end(), iter.second.fixedListeners.begin(), iter.second.fixedListeners.end());
+        removed.insert(removed.end(), iter.second.sceneGraphListeners.begin(), iter.second.sceneGraphListeners.end());
+    }
+
+    for (auto& pending : _toAddedListeners)
+    {
+        removed.push_back(pending.listener);
+    }
+
+    for (auto listener : removed)
+    {
+        removeEventListener(listener);
+    }
+}
+
+void EventDispatcher::setPriority(EventListener* listener, int fixedPriority)
+{
+    CCASSERT(listener != NULL && listener->_node == NULL, "Only the listeners with a fixed priority have a priority");
+    CCASSERT(fixedPriority != 0, "0 is reserved for the listeners bound to nodes");
+
+    if (listener->_fixedPriority != fixedPriority)
+    {
+        listener->_fixedPriority = fixedPriority;
+        _listeners[listener->_listenerID].fixedDirty = true;
+    }
+}
+
+bool EventDispatcher::hasEventListeners(const std::string& listenerID) const
+{
+    auto iter = _listeners.find(listenerID);
+    return iter != _listeners.end() && (! iter->second.fixedListeners.empty() || ! iter->second.sceneGraphListeners.empty());
+}
+
+//
+// ordering
+//
+void EventDispatcher::visitTarget(Node* node, int& order)
+{
+    auto& children = node->getChildren();
+    unsigned int i = 0;
+
+    if (!children.empty())
+    {
+        // same order as Node::visit()
+        node->sortAllChildren();
+
+        for ( ; i < children.size(); i++)
+        {
+            Node* child = children.at(i);
+            if (child->getZOrder() < 0)
+            {
+                visitTarget(child, order);
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    if (_nodeListeners.find(node) != _nodeListeners.end())
+    {
+        _nodeOrder[node] = order++;
+    }
+
+    for ( ; i < children.size(); i++)
+    {
+        visitTarget(children.at(i), order);
+    }
+}
+
+void EventDispatcher::updateSceneGraphOrder(void)
+{
+    Director* director = Director::getInstance();
+    Node* scene = director->getRunningScene();
+    if (! _sceneGraphDirty && scene == _orderedScene)
+    {
+        return;
+    }
+
+    _sceneGraphDirty = false;
+    _orderedScene = scene;
+    _nodeOrder.clear();
+
+    int order = 0;
+    if (scene)
+    {
+        visitTarget(scene, order);
+    }
+
+    // drawn after the scene
+    Node* notificationNode = director->getNotificationNode();
+    if (notificationNode)
+    {
+        visitTarget(notificationNode, order);
+    }
+
+    ++_sceneGraphOrderVersion;
+}
+
+void EventDispatcher::sortListeners(Listeners& listeners)
+{
+    if (listeners.fixedDirty)
+    {
+        listeners.fixedDirty = false;
+
+        std::vector<EventListener*>& fixed = listeners.fixedListeners;
+        std::stable_sort(fixed.begin(), fixed.end(), [](const EventListener* l1, const EventListener* l2) {
+            return l1->_fixedPriority < l2->_fixedPriority;
+        });
+
+        listeners.firstPositiveIndex = 0;
+        while (listeners.firstPositiveIndex < fixed.size() && fixed[listeners.firstPositiveIndex]->_fixedPriority < 0)
+        {
+            ++listeners.firstPositiveIndex;
+        }
+    }
+
+    if (! listeners.sceneGraphListeners.empty())
+    {
+        updateSceneGraphOrder();
+
+        if (listeners.sceneGraphDirty || listeners.sceneGraphOrderVersion != _sceneGraphOrderVersion)
+        {
+            listeners.sceneGraphDirty = false;
+            listeners.sceneGraphOrderVersion = _sceneGraphOrderVersion;
+
+            // the nodes that aren't in the running scene go last
+            auto& nodeOrder = _nodeOrder;
+            auto orderOf = [&nodeOrder](const EventListener* listener) -> int {
+                auto iter = nodeOrder.find(listener->_node);
+                return iter != nodeOrder.end() ? iter->second : -1;
+            };
+
+            // front-most first
+            std::stable_sort(listeners.sceneGraphListeners.begin(), listeners.sceneGraphListeners.end(),
+                             [&orderOf](const EventListener* l1, const EventListener* l2) {
+                return orderOf(l1) > orderOf(l2);
+            });
+        }
+    }
+}
+
+//
+// dispatch events
+//
+template <typename Fn>
+void EventDispatcher::dispatchToListeners(Listeners& listeners, Event* event, const Fn& onListener)
+{
+    // the vectors don't grow while an event is dispatched, iterate by index anyway
+    std::vector<EventListener*>& fixed = listeners.fixedListeners;
+    std::vector<EventListener*>& sceneGraph = listeners.sceneGraphListeners;
+
+    size_t i = 0;
+    for ( ; i < listeners.firstPositiveIndex && i < fixed.size(); ++i)
+    {
+        EventListener* listener = fixed[i];
+        if (listener->_isRegistered && listener->_isEnabled)
+        {
+            event->_currentTarget = NULL;
+            if (onListener(listener) || event->isStopped())
+            {
+                return;
+            }
+        }
+    }
+
+    for (size_t j = 0; j < sceneGraph.size(); ++j)
+    {
+        EventListener* listener = sceneGraph[j];
+        if (listener->_isRegistered && listener->_isEnabled && listener->_node->isRunning())
+        {
+            event->_currentTarget = listener->_node;
+            if (onListener(listener) || event->isStopped())
+            {
+                return;
+            }
+        }
+    }
+
+    for ( ; i < fixed.size(); ++i)
+    {
+        EventListener* listener = fixed[i];
+        if (listener->_isRegistered && listener->_isEnabled)
+        {
+            event->_currentTarget = NULL;
+            if (onListener(listener) || event->isStopped())
+            {
+                return;
+            }
+        }
+    }
+}
+
+void EventDispatcher::dispatchEvent(Event* event)
+{
+    if (! _isEnabled)
+    {
+        return;
+    }
+
+    auto iter = _listeners.find(EventListener::getListenerIDForEvent(event));
+    if (iter == _listeners.end())
+    {
+        return;
+    }
+
+    Listeners& listeners = iter->second;
+    sortListeners(listeners);
+
+    ++_inDispatch;
+
+    if (event->getType() == Event::Type::TOUCH)
+    {
+        dispatchTouchEvent(listeners, static_cast<EventTouch*>(event));
+    }
+    else
+    {
+        dispatchToListeners(listeners, event, [event](EventListener* listener) -> bool {
+            if (listener->_onEvent)
+            {
+                listener->_onEvent(event);
+            }
+            return false;
+        });
+    }
+
+    event->_currentTarget = NULL;
+
+    if (--_inDispatch == 0)
+    {
+        if (! _toRemovedListeners.empty())
+        {
+            std::vector<EventListener*> removed;
+            removed.swap(_toRemovedListeners);
+            for (auto listener : removed)
+            {
+                forceRemoveEventListener(listener);
+            }
+        }
+
+        if (! _toAddedListeners.empty())
+        {
+            std::vector<PendingListener> added;
+            added.swap(_toAddedListeners);
+            for (auto& pending : added)
+            {
+                forceAddEventListener(pending.listener, pending.node, pending.fixedPriority);
+            }
+        }
+    }
+}
+
+void EventDispatcher::dispatchCustomEvent(const std::string& eventName, void* userData)
+{
+    EventCustom event(eventName, userData);
+    dispatchEvent(&event);
+}
+
+void EventDispatcher::dispatchTouchEvent(Listeners& listeners, EventTouch* event)
+{
+    std::vector<Touch*>& remainingTouches = event->_touches;
+    EventTouch::EventCode eventCode = event->getEventCode();
+
+    // the touches are iterated over a copy, as the swallowed ones are erased from the event.
+    // The few touches of a platform event are copied on the stack.
+    static const size_t kStackTouches = 16;
+    Touch* stackTouches[kStackTouches];
+    std::vector<Touch*> heapTouches;
+    Touch** touches = stackTouches;
+    size_t touchCount = remainingTouches.size();
+    if (touchCount > kStackTouches)
+    {
+        heapTouches = remainingTouches;
+        touches = &heapTouches[0];
+    }
+    else
+    {
+        std::copy(remainingTouches.begin(), remainingTouches.end(), stackTouches);
+    }
+
+    //
+    // ONE_BY_ONE listeners 1st
+    //
+    for (size_t t = 0; t < touchCount; ++t)
+    {
+        Touch* touch = touches[t];
+        bool swallowed = false;
+
+        dispatchToListeners(listeners, event, [&](EventListener* listener) -> bool {
+            EventListenerTouch* touchListener = static_cast<EventListenerTouch*>(listener);
+            if (touchListener->_dispatchMode != Touch::DispatchMode::ONE_BY_ONE)
+            {
+                return false;
+            }
+
+            std::vector<Touch*>& claimedTouches = touchListener->_claimedTouches;
+            bool claimed = false;
+            if (eventCode == EventTouch::EventCode::BEGAN)
+            {
+                if (touchListener->onTouchBegan)
+                {
+                    claimed = touchListener->onTouchBegan(touch, event);
+                    if (claimed)
+                    {
+                        claimedTouches.push_back(touch);
+                    }
+                }
+            }
+            else
+            {
+                auto claimedIter = std::find(claimedTouches.begin(), claimedTouches.end(), touch);
+                if (claimedIter != claimedTouches.end())
+                {
+                    claimed = true;
+
+                    switch (eventCode)
+                    {
+                    case EventTouch::EventCode::MOVED:
+                        if (touchListener->onTouchMoved)
+                        {
+                            touchListener->onTouchMoved(touch, event);
+                        }
+                        break;
+                    case EventTouch::EventCode::ENDED:
+                        claimedTouches.erase(claimedIter);
+                        if (touchListener->onTouchEnded)
+                        {
+                            touchListener->onTouchEnded(touch, event);
+                        }
+                        break;
+                    case EventTouch::EventCode::CANCELLED:
+                        claimedTouches.erase(claimedIter);
+                        if (touchListener->onTouchCancelled)
+                        {
+                            touchListener->onTouchCancelled(touch, event);
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+
+            swallowed = claimed && touchListener->_swallowTouches;
+            return swallowed;
+        });
+
+        if (swallowed)
+        {
+            remainingTouches.erase(std::remove(remainingTouches.begin(), remainingTouches.end(), touch), remainingTouches.end());
+        }
+
+        if (event->isStopped())
+        {
+            return;
+        }
+    }
+
+    //
+    // ALL_AT_ONCE listeners 2nd, with the touches that are left
+    //
+    if (remainingTouches.empty())
+    {
+        return;
+    }
+
+    dispatchToListeners(listeners, event, [&](EventListener* listener) -> bool {
+        EventListenerTouch* touchListener = static_cast<EventListenerTouch*>(listener);
+        if (touchListener->_dispatchMode != Touch::DispatchMode::ALL_AT_ONCE)
+        {
+            return false;
+        }
+
+        switch (eventCode)
+        {
+        case EventTouch::EventCode::BEGAN:
+            if (touchListener->onTouchesBegan)
+            {
+                touchListener->onTouchesBegan(remainingTouches, event);
+            }
+            break;
+        case EventTouch::EventCode::MOVED:
+            if (touchListener->onTouchesMoved)
+            {
+                touchListener->onTouchesMoved(remainingTouches, event);
+            }
+            break;
+        case EventTouch::EventCode::ENDED:
+            if (touchListener->onTouchesEnded)
+            {
+                touchListener->onTouchesEnded(remainingTouches, event);
+            }
+            break;
+        case EventTouch::EventCode::CANCELLED:
+            if (touchListener->onTouchesCancelled)
+            {
+                touchListener->onTouchesCancelled(remainingTouches, event);
+            }
+            break;
+        }
+        return false;
+    });
+}
+
+//
+// accelerometer
+//
+void EventDispatcher::updateAccelerometer(void)
+{
+    bool listening = hasEventListeners(EventListener::getListenerIDForType(Event::Type::ACCELERATION));
+    if (listening != _isListeningAccelerometer)
+    {
+        _isListeningAccelerometer = listening;
+
+        Accelerometer* accelerometer = Director::getInstance()->getAccelerometer();
+        if (listening)
+        {
+            accelerometer->setDelegate(CC_CALLBACK_1(EventDispatcher::onAcceleration, this));
+        }
+        else
+        {
+            accelerometer->setDelegate(nullptr);
+        }
+    }
+}
+
+void EventDispatcher::onAcceleration(Acceleration* acceleration)
+{
+    if (InputRecorder::isActive() && !InputRecorder::getInstance()->onAcceleration(*acceleration))
+    {
+        return;
+    }
+
+    Director::setNextFrameDirty();
+
+    EventAcceleration event(*acceleration);
+    dispatchEvent(&event);
+}
+
+NS_CC_END
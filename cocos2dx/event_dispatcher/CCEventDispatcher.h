@@ -0,0 +1,168 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __EVENT_DISPATCHER_CCEVENT_DISPATCHER_H__
+#define __EVENT_DISPATCHER_CCEVENT_DISPATCHER_H__
+
+#include "CCEvent.h"
+#include "CCEventListener.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup input
+ * @{
+ */
+
+/** @brief Dispatches the touch, keyboard, keypad, acceleration and custom events to EventListeners.
+
+ The listeners of an event are called in this order:
+   - the listeners with a negative fixed priority, the lowest priority first
+   - the listeners bound to a node, the node drawn last (the front-most one) first
+   - the listeners with a positive fixed priority, the lowest priority first
+
+ The order of the nodes is cached: it is only computed again, by walking the running scene, after children
+ were added or reordered somewhere, or the running scene changed, and only for the events that have listeners
+ bound to nodes. The listeners of a node that isn't running don't get the events.
+
+ Listeners added or removed while an event is dispatched are added or removed once it has been dispatched.
+
+ The TouchDispatcher, the KeyboardDispatcher and the KeypadDispatcher forward their events to the EventDispatcher
+ before calling their delegates, and the touches swallowed by listeners aren't given to the touch delegates.
+ @since v3.0
+ */
+class CC_DLL EventDispatcher : public Object
+{
+public:
+    EventDispatcher();
+    virtual ~EventDispatcher();
+
+    /** Adds a listener called in the drawing order of the node, the front-most node first.
+     The listener is retained. It is removed when the node is destroyed.
+     */
+    void addEventListenerWithSceneGraphPriority(EventListener* listener, Node* node);
+
+    /** Adds a listener with a fixed priority: the lower the number, the higher the priority.
+     Listeners with a negative priority are called before the listeners bound to nodes, listeners with a positive
+     priority after them. 0 is reserved for the listeners bound to nodes.
+     The listener is retained.
+     */
+    void addEventListenerWithFixedPriority(EventListener* listener, int fixedPriority);
+
+    /** Removes a listener, releasing it */
+    void removeEventListener(EventListener* listener);
+
+    /** Removes the listeners bound to a node */
+    void removeEventListenersForNode(Node* node);
+
+    /** Removes the listeners of the touch, keyboard, keypad or acceleration events */
+    void removeEventListeners(Event::Type type);
+
+    /** Removes the listeners of the custom events named eventName */
+    void removeCustomEventListeners(const std::string& eventName);
+
+    /** Removes all the listeners */
+    void removeAllEventListeners();
+
+    /** Changes the priority of a listener with a fixed priority */
+    void setPriority(EventListener* listener, int fixedPriority);
+
+    /** Whether or not the events are dispatched. Default: true */
+    bool isEnabled() const { return _isEnabled; }
+    void setEnabled(bool enabled) { _isEnabled = enabled; }
+
+    /** Whether or not listeners are registered with the identifier, see EventListener::getListenerIDForEvent() */
+    bool hasEventListeners(const std::string& listenerID) const;
+
+    /** Dispatches an event to its listeners */
+    void dispatchEvent(Event* event);
+
+    /** Dispatches an EventCustom named eventName to its listeners */
+    void dispatchCustomEvent(const std::string& eventName, void* userData = NULL);
+
+    /** Invalidates the cached order of the nodes. Called by Node when children are added or reordered. */
+    void setDirtyForSceneGraph() { _sceneGraphDirty = true; }
+
+protected:
+    /** listeners of one identifier */
+    struct Listeners
+    {
+        Listeners() : fixedDirty(false), sceneGraphDirty(false), sceneGraphOrderVersion(0), firstPositiveIndex(0) {}
+
+        // sorted by priority
+        std::vector<EventListener*> fixedListeners;
+        // sorted by the order of their node, front-most first
+        std::vector<EventListener*> sceneGraphListeners;
+        bool fixedDirty;
+        bool sceneGraphDirty;
+        unsigned int sceneGraphOrderVersion;
+        // index in fixedListeners of the first listener with a positive priority
+        size_t firstPositiveIndex;
+    };
+
+    /** listener added while an event is dispatched */
+    struct PendingListener
+    {
+        EventListener* listener;
+        Node* node;
+        int fixedPriority;
+    };
+
+    void addEventListener(EventListener* listener, Node* node, int fixedPriority);
+    void forceAddEventListener(EventListener* listener, Node* node, int fixedPriority);
+    void forceRemoveEventListener(EventListener* listener);
+    void sortListeners(Listeners& listeners);
+    void updateSceneGraphOrder(void);
+    void visitTarget(Node* node, int& order);
+    void dispatchTouchEvent(Listeners& listeners, EventTouch* event);
+    void updateAccelerometer(void);
+    void onAcceleration(Acceleration* acceleration);
+
+    template <typename Fn>
+    void dispatchToListeners(Listeners& listeners, Event* event, const Fn& onListener);
+
+protected:
+    std::unordered_map<std::string, Listeners> _listeners;
+    std::unordered_map<Node*, std::vector<EventListener*> > _nodeListeners;
+    // order in which the nodes with listeners are drawn
+    std::unordered_map<Node*, int> _nodeOrder;
+    std::vector<PendingListener> _toAddedListeners;
+    std::vector<EventListener*> _toRemovedListeners;
+    unsigned int _sceneGraphOrderVersion;
+    bool _sceneGraphDirty;
+    Node* _orderedScene;
+    int _inDispatch;
+    bool _isEnabled;
+    bool _isListeningAccelerometer;
+};
+
+// end of input group
+/// @}
+
+NS_CC_END
+
+#endif // __EVENT_DISPATCHER_CCEVENT_DISPATCHER_H__
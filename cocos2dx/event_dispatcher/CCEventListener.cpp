@@ -0,0 +1,141 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCEventListener.h"
+#include "ccMacros.h"
+
+NS_CC_BEGIN
+
+static const std::string s_listenerIDs[] = {
+    "__cc_unknown",
+    "__cc_touch",
+    "__cc_keyboard",
+    "__cc_keypad",
+    "__cc_acceleration",
+};
+
+EventListener* EventListener::create(Event::Type type, const Callback& callback)
+{
+    CCASSERT(type != Event::Type::CUSTOM, "Use createCustom() for the custom events");
+    CCASSERT(type != Event::Type::TOUCH, "Use EventListenerTouch for the touch events");
+
+    EventListener* listener = new EventListener();
+    if (listener && listener->init(type, s_listenerIDs[(int)type], callback))
+    {
+        listener->autorelease();
+        return listener;
+    }
+    CC_SAFE_DELETE(listener);
+    return NULL;
+}
+
+EventListener* EventListener::createCustom(const std::string& eventName, const Callback& callback)
+{
+    EventListener* listener = new EventListener();
+    if (listener && listener->init(Event::Type::CUSTOM, eventName, callback))
+    {
+        listener->autorelease();
+        return listener;
+    }
+    CC_SAFE_DELETE(listener);
+    return NULL;
+}
+
+const std::string& EventListener::getListenerIDForEvent(Event* event)
+{
+    if (event->getType() == Event::Type::CUSTOM)
+    {
+        return static_cast<EventCustom*>(event)->getEventName();
+    }
+    return s_listenerIDs[(int)event->getType()];
+}
+
+const std::string& EventListener::getListenerIDForType(Event::Type type)
+{
+    CCASSERT(type != Event::Type::CUSTOM, "The custom events are identified by their name");
+    return s_listenerIDs[(int)type];
+}
+
+EventListener::EventListener()
+: _onEvent(nullptr)
+, _type(Event::Type::UNKNOWN)
+, _isEnabled(true)
+, _isRegistered(false)
+, _node(NULL)
+, _fixedPriority(0)
+{
+}
+
+EventListener::~EventListener()
+{
+}
+
+bool EventListener::init(Event::Type type, const std::string& listenerID, const Callback& callback)
+{
+    _type = type;
+    _listenerID = listenerID;
+    _onEvent = callback;
+    return true;
+}
+
+//
+// EventListenerTouch
+//
+EventListenerTouch* EventListenerTouch::create(Touch::DispatchMode dispatchMode)
+{
+    EventListenerTouch* listener = new EventListenerTouch();
+    if (listener && listener->init(dispatchMode))
+    {
+        listener->autorelease();
+        return listener;
+    }
+    CC_SAFE_DELETE(listener);
+    return NULL;
+}
+
+EventListenerTouch::EventListenerTouch()
+: onTouchBegan(nullptr)
+, onTouchMoved(nullptr)
+, onTouchEnded(nullptr)
+, onTouchCancelled(nullptr)
+, onTouchesBegan(nullptr)
+, onTouchesMoved(nullptr)
+, onTouchesEnded(nullptr)
+, onTouchesCancelled(nullptr)
+, _dispatchMode(Touch::DispatchMode::ALL_AT_ONCE)
+, _swallowTouches(false)
+{
+}
+
+bool EventListenerTouch::init(Touch::DispatchMode dispatchMode)
+{
+    if (EventListener::init(Event::Type::TOUCH, s_listenerIDs[(int)Event::Type::TOUCH], nullptr))
+    {
+        _dispatchMode = dispatchMode;
+        return true;
+    }
+    return false;
+}
+
+NS_CC_END
@@ -0,0 +1,139 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __EVENT_DISPATCHER_CCEVENT_LISTENER_H__
+#define __EVENT_DISPATCHER_CCEVENT_LISTENER_H__
+
+#include "CCEvent.h"
+#include "touch_dispatcher/CCTouch.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup input
+ * @{
+ */
+
+/** @brief Receives the events of one type from the EventDispatcher.
+ A listener is either bound to a node, and called in the order the nodes are drawn in (the front-most node first),
+ or has a fixed priority.
+ @since v3.0
+ */
+class CC_DLL EventListener : public Object
+{
+public:
+    typedef std::function<void(Event*)> Callback;
+
+    /** creates a listener of the keyboard, keypad or acceleration events */
+    static EventListener* create(Event::Type type, const Callback& callback);
+
+    /** creates a listener of the custom events named eventName */
+    static EventListener* createCustom(const std::string& eventName, const Callback& callback);
+
+    /** identifier of the listeners of an event: the listeners of a type, or of a custom event name */
+    static const std::string& getListenerIDForEvent(Event* event);
+
+    /** identifier of the listeners of the touch, keyboard, keypad or acceleration events */
+    static const std::string& getListenerIDForType(Event::Type type);
+
+    EventListener();
+    virtual ~EventListener();
+
+    bool init(Event::Type type, const std::string& listenerID, const Callback& callback);
+
+    Event::Type getType() const { return _type; }
+    const std::string& getListenerID() const { return _listenerID; }
+
+    /** A disabled listener stays registered but doesn't get the events. Default: true */
+    bool isEnabled() const { return _isEnabled; }
+    void setEnabled(bool enabled) { _isEnabled = enabled; }
+
+    /** node the listener is bound to, NULL if it has a fixed priority */
+    Node* getSceneGraphNode() const { return _node; }
+    int getFixedPriority() const { return _fixedPriority; }
+
+protected:
+    Callback _onEvent;
+    Event::Type _type;
+    std::string _listenerID;
+    bool _isEnabled;
+
+    // set by the EventDispatcher
+    bool _isRegistered;
+    Node* _node;
+    int _fixedPriority;
+
+    friend class EventDispatcher;
+};
+
+/** @brief Listener of the touch events.
+ In ONE_BY_ONE mode, a touch only moves and ends on the listeners whose onTouchBegan() claimed it,
+ and the touches claimed by a listener that swallows touches aren't dispatched further.
+ ALL_AT_ONCE listeners get the touches that are left, after the ONE_BY_ONE listeners.
+ @since v3.0
+ */
+class CC_DLL EventListenerTouch : public EventListener
+{
+public:
+    static EventListenerTouch* create(Touch::DispatchMode dispatchMode);
+
+    EventListenerTouch();
+
+    bool init(Touch::DispatchMode dispatchMode);
+
+    Touch::DispatchMode getDispatchMode() const { return _dispatchMode; }
+
+    /** whether the touches claimed by onTouchBegan() are swallowed. Default: false */
+    bool isSwallowTouches() const { return _swallowTouches; }
+    void setSwallowTouches(bool swallowTouches) { _swallowTouches = swallowTouches; }
+
+    // ONE_BY_ONE callbacks
+    std::function<bool(Touch*, Event*)> onTouchBegan;
+    std::function<void(Touch*, Event*)> onTouchMoved;
+    std::function<void(Touch*, Event*)> onTouchEnded;
+    std::function<void(Touch*, Event*)> onTouchCancelled;
+
+    // ALL_AT_ONCE callbacks
+    std::function<void(const std::vector<Touch*>&, Event*)> onTouchesBegan;
+    std::function<void(const std::vector<Touch*>&, Event*)> onTouchesMoved;
+    std::function<void(const std::vector<Touch*>&, Event*)> onTouchesEnded;
+    std::function<void(const std::vector<Touch*>&, Event*)> onTouchesCancelled;
+
+protected:
+    Touch::DispatchMode _dispatchMode;
+    bool _swallowTouches;
+    std::vector<Touch*> _claimedTouches;
+
+    friend class EventDispatcher;
+};
+
+// end of input group
+/// @}
+
+NS_CC_END
+
+#endif // __EVENT_DISPATCHER_CCEVENT_LISTENER_H__
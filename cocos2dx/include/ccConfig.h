@@ -102,6 +102,52 @@ To enabled set it to 1. Disabled by default.
 #define CC_DIRECTOR_STATS_INTERVAL (0.5f)
 #endif
 
+/** @def CC_DIRECTOR_DELTA_TIME_HISTORY
+ Number of frames the delta time is averaged over when the Director paces the frames, see Director::setFramePacing().
+ A longer history hides more jitter, but follows the changes of frame rate later.
+
+ Default value: 4
+ */
+#ifndef CC_DIRECTOR_DELTA_TIME_HISTORY
+#define CC_DIRECTOR_DELTA_TIME_HISTORY 4
+#endif
+
+/** @def CC_SCHEDULER_TIMER_HEAP_MIN_INTERVAL
+ Minimum interval, in seconds, of the custom selectors that the Scheduler keeps in a queue sorted by
+ due time instead of updating them every frame.
+ Only the timers of the queue that are due are touched by a tick, so long intervals (cooldowns,
+ regeneration, ...) don't cost anything on the frames where they don't fire.
+
+ Default value: 0.1f
+ @since v3.0
+ */
+#ifndef CC_SCHEDULER_TIMER_HEAP_MIN_INTERVAL
+#define CC_SCHEDULER_TIMER_HEAP_MIN_INTERVAL (0.1f)
+#endif
+
+/** @def CC_EASING_LOOKUP_TABLE_SIZE
+ Number of intervals of the tables sampling the ease curves, used when tweenfunc::setLookupTablesEnabled() is on.
+ The curves are interpolated linearly between the samples.
+
+ Default value: 256
+ @since v3.0
+ */
+#ifndef CC_EASING_LOOKUP_TABLE_SIZE
+#define CC_EASING_LOOKUP_TABLE_SIZE 256
+#endif
+
+/** @def CC_TOUCH_AREA_CELL_SIZE
+ Size, in points, of the cells of the grid in which TouchDispatcher indexes the touch areas of the
+ targeted delegates (see TouchDispatcher::setTouchArea()).
+ A touch only begins on the delegates whose area overlaps the cell under it, and on the delegates without an area.
+
+ Default value: 128
+ @since v3.0
+ */
+#ifndef CC_TOUCH_AREA_CELL_SIZE
+#define CC_TOUCH_AREA_CELL_SIZE (128.0f)
+#endif
+
 /** @def CC_DIRECTOR_FPS_POSITION
  Position of the FPS
 
@@ -160,6 +206,40 @@ Only valid for cocos2d-mac. Not supported on cocos2d-ios.
 #define CC_SPRITEBATCHNODE_RENDER_SUBPIXEL    1
 #endif
 
+/** @def CC_USE_CULLING
+ If enabled, the Sprite objects that are outside the viewport are not drawn, and
+ SpriteBatchNode only draws the quads of its children that are inside the viewport.
+ 
+ To enable set it to 1. Enabled by default.
+ @since v3.0
+ */
+#ifndef CC_USE_CULLING
+#define CC_USE_CULLING 1
+#endif
+
+/** @def CC_USE_SHADER_VARIANTS
+ If enabled, Sprite and SpriteBatchNode draw their quads with the cheapest variant of the textured quad program,
+ see ShaderCache::programForQuads(). A scene that mixes tinted and untinted sprites of the same texture may need
+ more draw calls.
+ 
+ To enable set it to 1. Enabled by default.
+ @since v3.0
+ */
+#ifndef CC_USE_SHADER_VARIANTS
+#define CC_USE_SHADER_VARIANTS 1
+#endif
+
+/** @def CC_TMX_LAYER_CHUNK_SIZE
+ TMXLayer splits its tiles in chunks of CC_TMX_LAYER_CHUNK_SIZE x CC_TMX_LAYER_CHUNK_SIZE tiles.
+ The quads of a chunk are only built, in a TextureAtlas of their own, while the chunk is near the visible area.
+ 
+ Defaults to 16 tiles.
+ @since v3.0
+ */
+#ifndef CC_TMX_LAYER_CHUNK_SIZE
+#define CC_TMX_LAYER_CHUNK_SIZE 16
+#endif
+
 /** @def CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP
  Use GL_TRIANGLE_STRIP instead of GL_TRIANGLES when rendering the texture atlas.
  It seems it is the recommend way, but it is much slower, so, enable it at your own risk
@@ -171,6 +251,19 @@ Only valid for cocos2d-mac. Not supported on cocos2d-ios.
 #define CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP 0
 #endif
 
+/** @def CC_ENABLE_PROGRAM_BINARY_CACHE
+ If enabled, the default shaders are saved as program binaries in the writable path once they are linked,
+ and loaded from there at the next start or after the OpenGL context is lost, instead of being compiled again.
+ The binaries are compiled again when the sources of the shaders or the driver change.
+ It's only used when the driver supports GL_OES_get_program_binary or GL_ARB_get_program_binary.
+
+ Default value: 1
+ @since v3.0
+ */
+#ifndef CC_ENABLE_PROGRAM_BINARY_CACHE
+#define CC_ENABLE_PROGRAM_BINARY_CACHE 1
+#endif
+
 /** @def CC_TEXTURE_ATLAS_USE_VAO
  By default, TextureAtlas (used by many cocos2d classes) will use VAO (Vertex Array Objects).
  Apple recommends its usage but they might consume a lot of memory, specially if you use many of them.
@@ -190,6 +283,71 @@ Only valid for cocos2d-mac. Not supported on cocos2d-ios.
     #endif
 #endif
 
+/** @def CC_TEXTURE_ATLAS_VBO_COUNT
+ Number of vertex buffers used in turn by each TextureAtlas.
+ When its quads change, a TextureAtlas writes them in the buffer that was used the longest time ago,
+ so the driver doesn't have to wait for the GPU to finish drawing the previous frames with it.
+ Tile-based GPUs usually work one or two frames behind the CPU.
+
+ Set it to 1 to save memory. Default value: 3.
+
+ @since v3.0
+ */
+#ifndef CC_TEXTURE_ATLAS_VBO_COUNT
+#define CC_TEXTURE_ATLAS_VBO_COUNT 3
+#endif
+
+/** @def CC_PVR_STREAMING_INITIAL_SIZE
+ Largest side, in pixels, of the first mipmap level uploaded for the PVR files whose mipmaps are streamed,
+ see TextureCache::TexturePolicy::streamed. The larger levels are uploaded one per frame afterwards.
+
+ Default value: 256.
+
+ @since v3.0
+ */
+#ifndef CC_PVR_STREAMING_INITIAL_SIZE
+#define CC_PVR_STREAMING_INITIAL_SIZE 256
+#endif
+
+/** @def CC_RENDER_TEXTURE_DIRTY_TILE_SIZE
+ Side, in pixels, of the tiles in which RenderTexture tracks the changes of its content. When the app goes to background
+ on Android, only the tiles changed since the previous time are read back. Smaller tiles read back less pixels,
+ but with more calls.
+
+ Default value: 64.
+
+ @since v3.0
+ */
+#ifndef CC_RENDER_TEXTURE_DIRTY_TILE_SIZE
+#define CC_RENDER_TEXTURE_DIRTY_TILE_SIZE 64
+#endif
+
+/** @def CC_BUFFER_ARENA_FRAMES
+ Number of frames of streaming buffers of the BufferArena of the Renderer.
+ The small meshes written every frame (particles, motion streaks, primitives) are copied to ranges of
+ large buffers shared by all the nodes, and the buffers of a frame are written again CC_BUFFER_ARENA_FRAMES
+ frames later, once the GPU is done drawing them.
+
+ Default value: 3.
+
+ @since v3.0
+ */
+#ifndef CC_BUFFER_ARENA_FRAMES
+#define CC_BUFFER_ARENA_FRAMES 3
+#endif
+
+/** @def CC_BUFFER_ARENA_BLOCK_SIZE
+ Size in bytes of the streaming buffers of the BufferArena. A frame uses as many buffers as its meshes need,
+ and a mesh bigger than this size gets a buffer of its own.
+
+ Default value: 256 KB.
+
+ @since v3.0
+ */
+#ifndef CC_BUFFER_ARENA_BLOCK_SIZE
+#define CC_BUFFER_ARENA_BLOCK_SIZE (256 * 1024)
+#endif
+
 
 /** @def CC_USE_LA88_LABELS
  If enabled, it will use LA88 (Luminance Alpha 16-bit textures) for LabelTTF objects.
@@ -204,6 +362,105 @@ Only valid for cocos2d-mac. Not supported on cocos2d-ios.
 #define CC_USE_LA88_LABELS 1
 #endif
 
+/** @def CC_USE_FONT_ATLAS
+ If enabled, LabelTTF renders its string with quads referencing the glyphs of a FontAtlas shared by all
+ the labels using the same font and size, rasterized with FreeType. Changing the string of a label
+ doesn't create a texture any more.
+ If it is disabled, or if the font can't be loaded by FreeType, LabelTTF renders its string into a texture.
+
+ Default value: enabled on Linux, where FreeType is available, disabled on the other platforms.
+ @since v3.0
+ */
+#ifndef CC_USE_FONT_ATLAS
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+#define CC_USE_FONT_ATLAS 1
+#else
+#define CC_USE_FONT_ATLAS 0
+#endif
+#endif
+
+/** @def CC_FONT_ATLAS_PAGE_SIZE
+ Width and height, in pixels, of the A8 textures of a FontAtlas.
+
+ Default value: 512
+ @since v3.0
+ */
+#ifndef CC_FONT_ATLAS_PAGE_SIZE
+#define CC_FONT_ATLAS_PAGE_SIZE 512
+#endif
+
+/** @def CC_FONT_ATLAS_DISTANCE_FIELD_SIZE
+ Size, in pixels, at which the glyphs of the distance field atlases are rasterized.
+ A distance field atlas serves all the sizes of a font: the labels scale its glyphs.
+ Bigger values keep the corners sharper on big labels, but use more texture memory.
+
+ Default value: 32
+ @since v3.0
+ */
+#ifndef CC_FONT_ATLAS_DISTANCE_FIELD_SIZE
+#define CC_FONT_ATLAS_DISTANCE_FIELD_SIZE 32
+#endif
+
+/** @def CC_DYNAMIC_ATLAS_PAGE_SIZE
+ Width and height, in pixels, of the RGBA8888 textures of a DynamicAtlas.
+
+ Default value: 1024
+ @since v3.0
+ */
+#ifndef CC_DYNAMIC_ATLAS_PAGE_SIZE
+#define CC_DYNAMIC_ATLAS_PAGE_SIZE 1024
+#endif
+
+/** @def CC_ENABLE_POOL_ALLOCATOR
+ If enabled, the objects of the classes inheriting PoolAllocated (sprites, actions, touches, timers, strings...)
+ are allocated in pools of objects of the same size, which limits the fragmentation of the heap.
+ If disabled, they are allocated in the heap like the other objects.
+
+ Default value: 1
+ @since v3.0
+ */
+#ifndef CC_ENABLE_POOL_ALLOCATOR
+#define CC_ENABLE_POOL_ALLOCATOR 1
+#endif
+
+/** @def CC_POOL_ALLOCATOR_MAX_SIZE
+ Size, in bytes, of the biggest objects allocated by the PoolAllocator. Bigger objects are allocated in the heap.
+ It must be a multiple of 16.
+
+ Default value: 1024
+ @since v3.0
+ */
+#ifndef CC_POOL_ALLOCATOR_MAX_SIZE
+#define CC_POOL_ALLOCATOR_MAX_SIZE 1024
+#endif
+
+/** @def CC_ENABLE_OBJECT_TRACKING
+ If enabled, ObjectTracker counts the living Objects by class and by allocation site, with their size and the
+ high-water marks, and the detailed stats overlay shows them. Every Object is then registered in a table when
+ it is created and removed when it is deleted, and the Objects are allocated in the heap instead of the pools
+ of the PoolAllocator.
+ To be enabled while looking for the memory used by the Objects, not in the shipped builds.
+
+ Default value: 0
+ @since v3.0
+ */
+#ifndef CC_ENABLE_OBJECT_TRACKING
+#define CC_ENABLE_OBJECT_TRACKING 0
+#endif
+
+/** @def CC_ENABLE_ATOMIC_REFERENCE_COUNT
+ If enabled, retain() and release() change the reference count of the objects atomically, so the objects can be
+ shared by several threads, eg: an Image decoded by a worker thread and handed to the main thread in a RefPtr.
+ autorelease() and the AutoreleasePool still have to be used from the main thread only.
+ If disabled, the reference count is a plain integer, which is faster.
+
+ Default value: 0
+ @since v3.0
+ */
+#ifndef CC_ENABLE_ATOMIC_REFERENCE_COUNT
+#define CC_ENABLE_ATOMIC_REFERENCE_COUNT 0
+#endif
+
 /** @def CC_SPRITE_DEBUG_DRAW
  If enabled, all subclasses of Sprite will draw a bounding box
  Useful for debugging purposes only. It is recommended to leave it disabled.
@@ -240,6 +497,18 @@ To enable set it to a value different than 0. Disabled by default.
 #define CC_LABELBMFONT_DEBUG_DRAW 0
 #endif
 
+/** @def CC_LABELBMFONT_LETTER_SPRITES
+ Default value of LabelBMFont::isLetterSpritesEnabled().
+ If enabled, each character of a LabelBMFont is a Sprite child. If disabled, the characters are quads written
+ directly into the TextureAtlas of the label.
+
+ Default value: 0
+ @since v3.0
+ */
+#ifndef CC_LABELBMFONT_LETTER_SPRITES
+#define CC_LABELBMFONT_LETTER_SPRITES 0
+#endif
+
 /** @def CC_LABELATLAS_DEBUG_DRAW
  If enabled, all subclasses of LabeltAtlas will draw a bounding box
  Useful for debugging purposes only. It is recommended to leave it disabled.
@@ -261,6 +530,26 @@ To enable set it to a value different than 0. Disabled by default.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_FRAME_PROFILER
+ If enabled, the zones marked with CC_PROFILE_ZONE are compiled. They are recorded by FrameProfiler once it is
+ enabled at runtime, otherwise they cost one test each, so they can be kept in the release builds.
+
+ To disable set it to 0. Enabled by default.
+ */
+#ifndef CC_ENABLE_FRAME_PROFILER
+#define CC_ENABLE_FRAME_PROFILER 1
+#endif
+
+/** @def CC_GPU_PROFILER_FRAME_LATENCY
+ Number of frames GPUProfiler keeps queries for, so the results of a frame are read that many frames later
+ without waiting for the GPU. The drivers queuing more frames need more.
+
+ Default value: 4
+ */
+#ifndef CC_GPU_PROFILER_FRAME_LATENCY
+#define CC_GPU_PROFILER_FRAME_LATENCY 4
+#endif
+
 /** Enable Lua engine debug log */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
@@ -193,6 +193,7 @@ It should work same as apples CFSwapInt32LittleToHost(..)
 /**********************/
 /** Profiling Macros **/
 /**********************/
+// Profiler and these macros are kept for the existing code, the engine uses CC_PROFILE_ZONE and FrameProfiler
 #if CC_ENABLE_PROFILERS
 
 #define CC_PROFILER_DISPLAY_TIMERS() Profiler::getInstance()->displayTimers()
@@ -249,6 +250,20 @@ It should work same as apples CFSwapInt32LittleToHost(..)
 extern unsigned int CC_DLL g_uNumberOfDraws;
 #define CC_INCREMENT_GL_DRAWS(__n__) g_uNumberOfDraws += __n__
 
+/** @def CC_INCREMENT_GL_VERTICES
+ Increments the number of vertices drawn.
+ The number of vertices per frame is displayed by the detailed stats of the Director.
+ */
+extern unsigned int CC_DLL g_uNumberOfVertices;
+#define CC_INCREMENT_GL_VERTICES(__n__) g_uNumberOfVertices += __n__
+
+/** @def CC_INCREMENT_GL_QUADS
+ Increments the number of quads drawn in batches, and the number of vertices by 4 per quad.
+ The number of quads per frame is displayed by the detailed stats of the Director.
+ */
+extern unsigned int CC_DLL g_uNumberOfQuads;
+#define CC_INCREMENT_GL_QUADS(__n__) do { g_uNumberOfQuads += __n__; g_uNumberOfVertices += 4 * (__n__); } while (0)
+
 /*******************/
 /** Notifications **/
 /*******************/
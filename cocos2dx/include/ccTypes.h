@@ -280,6 +280,36 @@ struct V3F_C4B_T2F_Quad
     V3F_C4B_T2F    br;
 };
 
+/** a Point with a vertex point, a color 4B and the tex coords normalized on 16 bits: 0 to 65535 for 0 to 1
+ @since v3.0
+ */
+struct V2F_C4B_T2US
+{
+    //! vertices (2F)
+    Vertex2F     vertices;            // 8 bytes
+
+    //! colors (4B)
+    Color4B      colors;              // 4 bytes
+
+    //! tex coords (2US)
+    GLushort     texCoords[2];        // 4 bytes
+};
+
+/** 4 V2F_C4B_T2US, in the order of the vertices of V3F_C4B_T2F_Quad
+ @since v3.0
+ */
+struct V2F_C4B_T2US_Quad
+{
+    //! top left
+    V2F_C4B_T2US   tl;
+    //! bottom left
+    V2F_C4B_T2US   bl;
+    //! top right
+    V2F_C4B_T2US   tr;
+    //! bottom right
+    V2F_C4B_T2US   br;
+};
+
 //! 4 Vertex2FTex2FColor4F Quad
 struct V2F_C4F_T2F_Quad
 {
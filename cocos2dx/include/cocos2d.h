@@ -42,6 +42,8 @@ THE SOFTWARE.
 #include "actions/CCActionCamera.h"
 #include "actions/CCActionManager.h"
 #include "actions/CCActionEase.h"
+#include "actions/CCTweenEasing.h"
+#include "actions/CCActionTemplate.h"
 #include "actions/CCActionPageTurn3D.h"
 #include "actions/CCActionGrid.h"
 #include "actions/CCActionProgressTimer.h"
@@ -58,11 +60,16 @@ THE SOFTWARE.
 // cocoa
 #include "cocoa/CCAffineTransform.h"
 #include "cocoa/CCDictionary.h"
+#include "cocoa/CCStringDictionary.h"
+#include "cocoa/CCVector.h"
+#include "cocoa/CCMap.h"
 #include "cocoa/CCObject.h"
 #include "cocoa/CCArray.h"
 #include "cocoa/CCGeometry.h"
 #include "cocoa/CCSet.h"
 #include "cocoa/CCAutoreleasePool.h"
+#include "cocoa/CCPoolAllocator.h"
+#include "cocoa/CCRefPtr.h"
 #include "cocoa/CCInteger.h"
 #include "cocoa/CCFloat.h"
 #include "cocoa/CCDouble.h"
@@ -75,6 +82,15 @@ THE SOFTWARE.
 #include "draw_nodes/CCDrawingPrimitives.h"
 #include "draw_nodes/CCDrawNode.h"
 
+// renderer
+#include "renderer/CCRenderer.h"
+#include "renderer/CCRenderCommand.h"
+#include "renderer/CCQuadCommand.h"
+#include "renderer/CCCustomCommand.h"
+#include "renderer/CCGroupCommand.h"
+#include "renderer/CCPrimitiveCommand.h"
+#include "renderer/CCBufferArena.h"
+
 // effects
 #include "effects/CCGrabber.h"
 #include "effects/CCGrid.h"
@@ -98,6 +114,7 @@ THE SOFTWARE.
 // label_nodes
 #include "label_nodes/CCLabelAtlas.h"
 #include "label_nodes/CCLabelTTF.h"
+#include "label_nodes/CCFontAtlas.h"
 #include "label_nodes/CCLabelBMFont.h"
 
 // layers_scenes_transitions_nodes
@@ -122,6 +139,8 @@ THE SOFTWARE.
 #include "particle_nodes/CCParticleSystem.h"
 #include "particle_nodes/CCParticleExamples.h"
 #include "particle_nodes/CCParticleSystemQuad.h"
+#include "particle_nodes/CCParticleSystemGPU.h"
+#include "particle_nodes/CCParticleSystemManager.h"
 
 // platform
 #include "platform/CCDevice.h"
@@ -237,13 +256,25 @@ THE SOFTWARE.
 #include "sprite_nodes/CCAnimationCache.h"
 #include "sprite_nodes/CCSprite.h"
 #include "sprite_nodes/CCSpriteBatchNode.h"
+#include "sprite_nodes/CCInstancedSpriteBatch.h"
 #include "sprite_nodes/CCSpriteFrame.h"
 #include "sprite_nodes/CCSpriteFrameCache.h"
 
 // support
 #include "support/ccUTF8.h"
 #include "support/CCNotificationCenter.h"
+#include "support/CCJobSystem.h"
+#include "support/CCSkeletonEvaluator.h"
+#include "support/CCNodeBuildQueue.h"
+#include "support/CCResourceGroupManager.h"
+#include "support/CCInputRecorder.h"
+#include "support/CCObjectPool.h"
 #include "support/CCProfiling.h"
+#include "support/CCFrameProfiler.h"
+#include "support/CCStatsOverlay.h"
+#include "support/CCAssetLoadProfiler.h"
+#include "support/CCGPUProfiler.h"
+#include "support/CCObjectTracker.h"
 #include "support/user_default/CCUserDefault.h"
 #include "support/CCVertex.h"
 #include "support/tinyxml2/tinyxml2.h"
@@ -257,7 +288,9 @@ THE SOFTWARE.
 #include "textures/CCTexture2D.h"
 #include "textures/CCTextureAtlas.h"
 #include "textures/CCTextureCache.h"
+#include "textures/CCDynamicAtlas.h"
 #include "textures/CCTexturePVR.h"
+#include "textures/CCTextureKTX.h"
 
 // tilemap_parallax_nodes
 #include "tilemap_parallax_nodes/CCParallaxNode.h"
@@ -273,8 +306,14 @@ THE SOFTWARE.
 #include "touch_dispatcher/CCTouchDispatcher.h"
 #include "touch_dispatcher/CCTouchHandler.h"
 
+// event_dispatcher
+#include "event_dispatcher/CCEvent.h"
+#include "event_dispatcher/CCEventListener.h"
+#include "event_dispatcher/CCEventDispatcher.h"
+
 // root
 #include "CCCamera.h"
+#include "CCCamera2D.h"
 #include "CCConfiguration.h"
 #include "CCDirector.h"
 #include "CCScheduler.h"
@@ -282,6 +321,7 @@ THE SOFTWARE.
 // component
 #include "support/component/CCComponent.h"
 #include "support/component/CCComponentContainer.h"
+#include "support/component/CCComponentSystem.h"
 
 // Deprecated include
 #include "CCDeprecated.h"
@@ -54,6 +54,17 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define kmPIUnder180 57.295779f // 180 / PI
 #define kmEpsilon 1.0 / 64.0
 
+/* SIMD kernels used by the matrix and vector functions.
+   The ARMv7 NEON kernels (neon_matrix_impl.c) are written in assembly, the other ones use intrinsics. */
+#if !defined(KM_NO_SIMD)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define KM_USE_SSE 1
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && (defined(__aarch64__) || defined(__arm64__))
+#define KM_USE_NEON64 1
+#elif defined(__ARM_NEON__)
+#define KM_USE_NEON 1
+#endif
+#endif // KM_NO_SIMD
 
 
 #ifdef __cplusplus
@@ -39,6 +39,12 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "kazmath/neon_matrix_impl.h"
 
+#if defined(KM_USE_SSE)
+#include <xmmintrin.h>
+#elif defined(KM_USE_NEON64)
+#include <arm_neon.h>
+#endif
+
 /**
  * Fills a kmMat4 structure with the values from a 16
  * element array of floats
@@ -216,13 +222,55 @@ kmMat4* const kmMat4Transpose(kmMat4* pOut, const kmMat4* pIn)
  */
 kmMat4* const kmMat4Multiply(kmMat4* pOut, const kmMat4* pM1, const kmMat4* pM2)
 {
-#if defined(__ARM_NEON__)
+#if defined(KM_USE_NEON)
 
     float mat[16];
 
     // Invert column-order with row-order
     NEON_Matrix4Mul( &pM2->mat[0], &pM1->mat[0], &mat[0] );
 
+#elif defined(KM_USE_SSE)
+
+    float mat[16];
+    const float *m1 = pM1->mat, *m2 = pM2->mat;
+    int i;
+
+    // each column of the result is a linear combination of the columns of m1
+    __m128 c0 = _mm_loadu_ps(&m1[0]);
+    __m128 c1 = _mm_loadu_ps(&m1[4]);
+    __m128 c2 = _mm_loadu_ps(&m1[8]);
+    __m128 c3 = _mm_loadu_ps(&m1[12]);
+
+    for (i = 0; i < 16; i += 4)
+    {
+        __m128 r = _mm_mul_ps(c0, _mm_set1_ps(m2[i]));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(m2[i + 1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(m2[i + 2])));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(m2[i + 3])));
+        _mm_storeu_ps(&mat[i], r);
+    }
+
+#elif defined(KM_USE_NEON64)
+
+    float mat[16];
+    const float *m1 = pM1->mat, *m2 = pM2->mat;
+    int i;
+
+    // each column of the result is a linear combination of the columns of m1
+    float32x4_t c0 = vld1q_f32(&m1[0]);
+    float32x4_t c1 = vld1q_f32(&m1[4]);
+    float32x4_t c2 = vld1q_f32(&m1[8]);
+    float32x4_t c3 = vld1q_f32(&m1[12]);
+
+    for (i = 0; i < 16; i += 4)
+    {
+        float32x4_t r = vmulq_n_f32(c0, m2[i]);
+        r = vmlaq_n_f32(r, c1, m2[i + 1]);
+        r = vmlaq_n_f32(r, c2, m2[i + 2]);
+        r = vmlaq_n_f32(r, c3, m2[i + 3]);
+        vst1q_f32(&mat[i], r);
+    }
+
 #else
     float mat[16];
 
@@ -22,8 +22,9 @@
 */
 
 #include "kazmath/neon_matrix_impl.h"
+#include "kazmath/utility.h"
 
-#if defined(__ARM_NEON__)
+#if defined(KM_USE_NEON)
 
 void NEON_Matrix4Mul(const float* a, const float* b, float* output )
 {
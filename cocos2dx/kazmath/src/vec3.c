@@ -35,6 +35,12 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "kazmath/mat4.h"
 #include "kazmath/vec3.h"
 
+#if defined(KM_USE_SSE)
+#include <xmmintrin.h>
+#elif defined(KM_USE_NEON64) || defined(KM_USE_NEON)
+#include <arm_neon.h>
+#endif
+
 /**
  * Fill a kmVec3 structure using 3 floating point values
  * The result is store in pOut, returns pOut
@@ -84,6 +90,68 @@ kmVec3* kmVec3Normalize(kmVec3* pOut, const kmVec3* pIn)
     return pOut;
 }
 
+/**
+ * Transforms count vectors by the matrix pM, assuming w = 1.
+ * The vectors are read every vStride bytes from pV and written every
+ * outStride bytes to pOut, so they can be part of interleaved vertices.
+ * pOut and pV may be the same array.
+ */
+void kmVec3TransformArray(kmVec3* pOut, unsigned int outStride, const kmVec3* pV, unsigned int vStride, const kmMat4* pM, unsigned int count)
+{
+    const unsigned char* in = (const unsigned char*)pV;
+    unsigned char* out = (unsigned char*)pOut;
+    const float* m = pM->mat;
+    unsigned int i;
+
+#if defined(KM_USE_SSE)
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+
+    for (i = 0; i < count; i++, in += vStride, out += outStride)
+    {
+        const kmVec3* v = (const kmVec3*)in;
+        kmVec3* o = (kmVec3*)out;
+        __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(v->x)), c3);
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(v->y)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(v->z)));
+        // store x, y and z only
+        _mm_storel_pi((__m64*)o, r);
+        _mm_store_ss(&o->z, _mm_movehl_ps(r, r));
+    }
+#elif defined(KM_USE_NEON64) || defined(KM_USE_NEON)
+    float32x4_t c0 = vld1q_f32(&m[0]);
+    float32x4_t c1 = vld1q_f32(&m[4]);
+    float32x4_t c2 = vld1q_f32(&m[8]);
+    float32x4_t c3 = vld1q_f32(&m[12]);
+
+    for (i = 0; i < count; i++, in += vStride, out += outStride)
+    {
+        const kmVec3* v = (const kmVec3*)in;
+        kmVec3* o = (kmVec3*)out;
+        float32x4_t r = vmlaq_n_f32(c3, c0, v->x);
+        r = vmlaq_n_f32(r, c1, v->y);
+        r = vmlaq_n_f32(r, c2, v->z);
+        // store x, y and z only
+        vst1_f32(&o->x, vget_low_f32(r));
+        vst1q_lane_f32(&o->z, r, 2);
+    }
+#else
+    for (i = 0; i < count; i++, in += vStride, out += outStride)
+    {
+        const kmVec3* v = (const kmVec3*)in;
+        kmVec3* o = (kmVec3*)out;
+        float x = v->x * m[0] + v->y * m[4] + v->z * m[8] + m[12];
+        float y = v->x * m[1] + v->y * m[5] + v->z * m[9] + m[13];
+        float z = v->x * m[2] + v->y * m[6] + v->z * m[10] + m[14];
+        o->x = x;
+        o->y = y;
+        o->z = z;
+    }
+#endif
+}
+
 /**
  * Returns a vector perpendicular to 2 other vectors.
  * The result is stored in pOut.
@@ -24,6 +24,9 @@ THE SOFTWARE.
 
 #include "CCKeyboardDispatcher.h"
 #include "support/data_support/ccCArray.h"
+#include "event_dispatcher/CCEventDispatcher.h"
+#include "CCDirector.h"
+#include "support/CCInputRecorder.h"
 
 NS_CC_BEGIN
 
@@ -54,6 +57,22 @@ void KeyboardDispatcher::setKeyReleaseDelegate(KeyboardDelegate delegate)
 
 bool KeyboardDispatcher::dispatchKeyboardEvent(int keyCode, bool pressed)
 {
+    // the live keys are swallowed during a replay
+    if (InputRecorder::isActive() && !InputRecorder::getInstance()->onKeyboard(keyCode, pressed))
+    {
+        return true;
+    }
+
+    Director::setNextFrameDirty();
+
+    EventDispatcher* eventDispatcher = Director::getInstance()->getEventDispatcher();
+    bool hasListeners = eventDispatcher->hasEventListeners(EventListener::getListenerIDForType(Event::Type::KEYBOARD));
+    if (hasListeners)
+    {
+        EventKeyboard event(keyCode, pressed);
+        eventDispatcher->dispatchEvent(&event);
+    }
+
     if (_keyPressDelegate != nullptr && pressed)
     {
         _keyPressDelegate(keyCode);
@@ -64,7 +83,7 @@ bool KeyboardDispatcher::dispatchKeyboardEvent(int keyCode, bool pressed)
     }
     else
     {
-        return false;
+        return hasListeners;
     }
 
     return true;
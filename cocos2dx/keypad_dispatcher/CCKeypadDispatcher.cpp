@@ -24,6 +24,9 @@ THE SOFTWARE.
 
 #include "CCKeypadDispatcher.h"
 #include "support/data_support/ccCArray.h"
+#include "event_dispatcher/CCEventDispatcher.h"
+#include "CCDirector.h"
+#include "support/CCInputRecorder.h"
 
 NS_CC_BEGIN
 
@@ -120,9 +123,20 @@ void KeypadDispatcher::forceRemoveDelegate(KeypadDelegate* pDelegate)
 
 bool KeypadDispatcher::dispatchKeypadMSG(ccKeypadMSGType nMsgType)
 {
+    // the live keys are swallowed during a replay
+    if (InputRecorder::isActive() && !InputRecorder::getInstance()->onKeypad(nMsgType))
+    {
+        return true;
+    }
+
+    Director::setNextFrameDirty();
+
     KeypadHandler*  pHandler = NULL;
     KeypadDelegate* pDelegate = NULL;
 
+    EventKeypad event(nMsgType);
+    Director::getInstance()->getEventDispatcher()->dispatchEvent(&event);
+
     _locked = true;
 
     if (_delegates->count() > 0)
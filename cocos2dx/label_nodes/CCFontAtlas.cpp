@@ -0,0 +1,446 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCFontAtlas.h"
+#include "ccConfig.h"
+#include "textures/CCTexture2D.h"
+#include "platform/CCFileUtils.h"
+#include "shaders/ccGLStateCache.h"
+#include "CCGL.h"
+#include <algorithm>
+#include <math.h>
+#include <sstream>
+
+#if CC_USE_FONT_ATLAS
+#include "ft2build.h"
+#include FT_FREETYPE_H
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+#include <fontconfig/fontconfig.h>
+#endif
+#endif // CC_USE_FONT_ATLAS
+
+NS_CC_BEGIN
+
+// space between the glyphs, so that the linear filtering doesn't sample the neighbours
+static const int GLYPH_PADDING = 1;
+
+static std::unordered_map<std::string, FontAtlas*> s_fontAtlases;
+
+#if CC_USE_FONT_ATLAS
+
+static FT_Library s_library = NULL;
+static bool s_libraryError = false;
+
+static FT_Library getFreeTypeLibrary()
+{
+    if (s_library == NULL && ! s_libraryError)
+    {
+        s_libraryError = (FT_Init_FreeType(&s_library) != 0);
+    }
+    return s_libraryError ? NULL : s_library;
+}
+
+// resolves a font file shipped with the game, or on Linux a font family installed on the system
+static std::string getFontFile(const char* fontName)
+{
+    std::string fontPath = fontName;
+    std::string lowerCasePath = fontPath;
+    std::transform(lowerCasePath.begin(), lowerCasePath.end(), lowerCasePath.begin(), ::tolower);
+    if (lowerCasePath.find(".ttf") != std::string::npos || lowerCasePath.find(".otf") != std::string::npos)
+    {
+        return FileUtils::getInstance()->fullPathForFilename(fontPath.c_str());
+    }
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    FcInit();
+    FcPattern *pattern = FcPatternBuild(0, FC_FAMILY, FcTypeString, fontName, (char *) 0);
+    FcConfigSubstitute(0, pattern, FcMatchPattern);
+    FcDefaultSubstitute(pattern);
+
+    FcResult result;
+    FcPattern *font = FcFontMatch(0, pattern, &result);
+    if (font)
+    {
+        FcChar8 *s = NULL;
+        if (FcPatternGetString(font, FC_FILE, 0, &s) == FcResultMatch)
+        {
+            fontPath = (const char*)s;
+        }
+        FcPatternDestroy(font);
+    }
+    FcPatternDestroy(pattern);
+#endif
+
+    return fontPath;
+}
+
+// Computes the distance field of a glyph from its coverage. The field is padded by spread pixels on each side,
+// and maps the distances from -spread (outside) to spread (inside) to 0..255, the edge being at 127.5.
+static void computeDistanceField(const unsigned char* coverage, int pitch, int width, int height, int spread, unsigned char* field)
+{
+    const int fieldWidth = width + 2 * spread;
+    const int fieldHeight = height + 2 * spread;
+    const int maxDistance2 = (spread + 1) * (spread + 1);
+
+    auto isInside = [=](int x, int y) -> bool {
+        return x >= 0 && y >= 0 && x < width && y < height && coverage[y * pitch + x] >= 128;
+    };
+
+    for (int y = 0; y < fieldHeight; ++y)
+    {
+        for (int x = 0; x < fieldWidth; ++x)
+        {
+            const int gx = x - spread;
+            const int gy = y - spread;
+            const bool inside = isInside(gx, gy);
+
+            // nearest pixel on the other side of the edge
+            int distance2 = maxDistance2;
+            for (int dy = -spread; dy <= spread; ++dy)
+            {
+                for (int dx = -spread; dx <= spread; ++dx)
+                {
+                    const int d2 = dx * dx + dy * dy;
+                    if (d2 < distance2 && isInside(gx + dx, gy + dy) != inside)
+                    {
+                        distance2 = d2;
+                    }
+                }
+            }
+
+            // the edge is between the two pixels
+            float distance = MIN(sqrtf((float)distance2) - 0.5f, (float)spread);
+            if (! inside)
+            {
+                distance = -distance;
+            }
+            const float value = 0.5f + distance / (2.0f * spread);
+            field[y * fieldWidth + x] = (unsigned char)(clampf(value, 0.0f, 1.0f) * 255.0f);
+        }
+    }
+}
+
+#endif // CC_USE_FONT_ATLAS
+
+//
+// FontAtlas
+//
+FontAtlas* FontAtlas::create(const std::string& fontFile, int fontSize, bool distanceField)
+{
+    FontAtlas* atlas = new FontAtlas();
+    if (atlas && atlas->initWithFontFile(fontFile, fontSize, distanceField))
+    {
+        atlas->autorelease();
+        return atlas;
+    }
+    CC_SAFE_DELETE(atlas);
+    return NULL;
+}
+
+FontAtlas::FontAtlas()
+: _face(NULL)
+, _hasKerning(false)
+, _distanceField(false)
+, _distanceFieldSpread(0)
+, _fontSize(0)
+, _lineHeight(0)
+, _ascender(0)
+, _penX(0)
+, _penY(0)
+, _rowHeight(0)
+{
+}
+
+FontAtlas::~FontAtlas()
+{
+    for (auto page : _pages)
+    {
+        page->release();
+    }
+
+#if CC_USE_FONT_ATLAS
+    if (_face)
+    {
+        FT_Done_Face(_face);
+    }
+#endif
+}
+
+bool FontAtlas::initWithFontFile(const std::string& fontFile, int fontSize, bool distanceField)
+{
+#if CC_USE_FONT_ATLAS
+    FT_Library library = getFreeTypeLibrary();
+    if (! library || fontSize <= 0)
+    {
+        return false;
+    }
+
+    FT_Face face;
+    if (FT_New_Face(library, fontFile.c_str(), 0, &face))
+    {
+        return false;
+    }
+
+    if (FT_Select_Charmap(face, FT_ENCODING_UNICODE) || FT_Set_Pixel_Sizes(face, fontSize, fontSize))
+    {
+        FT_Done_Face(face);
+        return false;
+    }
+
+    _face = face;
+    _hasKerning = FT_HAS_KERNING(face);
+    _distanceField = distanceField;
+    // enough for the outlines and glows of a few pixels at the size of the atlas
+    _distanceFieldSpread = distanceField ? MAX(fontSize / 8, 2) : 0;
+    _fontSize = fontSize;
+    _lineHeight = face->size->metrics.height >> 6;
+    _ascender = face->size->metrics.ascender >> 6;
+
+    return addPage();
+#else
+    CC_UNUSED_PARAM(fontFile);
+    CC_UNUSED_PARAM(fontSize);
+    CC_UNUSED_PARAM(distanceField);
+    return false;
+#endif
+}
+
+Texture2D* FontAtlas::getPageTexture(int page) const
+{
+    CCASSERT(page >= 0 && page < getPageCount(), "invalid page");
+    return _pages[page];
+}
+
+bool FontAtlas::addPage()
+{
+    const int size = CC_FONT_ATLAS_PAGE_SIZE;
+    std::vector<unsigned char> pixels(size * size, 0);
+
+    Texture2D* texture = new Texture2D();
+    if (! texture->initWithData(&pixels[0], Texture2D::PixelFormat::A8, size, size, Size(size, size)))
+    {
+        texture->release();
+        return false;
+    }
+
+    _pages.push_back(texture);
+    _penX = GLYPH_PADDING;
+    _penY = GLYPH_PADDING;
+    _rowHeight = 0;
+    return true;
+}
+
+bool FontAtlas::reserveGlyphRect(int width, int height, int* page, int* x, int* y)
+{
+    const int size = CC_FONT_ATLAS_PAGE_SIZE;
+    if (width + 2 * GLYPH_PADDING > size || height + 2 * GLYPH_PADDING > size)
+    {
+        return false;
+    }
+
+    // next row
+    if (_penX + width + GLYPH_PADDING > size)
+    {
+        _penX = GLYPH_PADDING;
+        _penY += _rowHeight + GLYPH_PADDING;
+        _rowHeight = 0;
+    }
+
+    // next page
+    if (_penY + height + GLYPH_PADDING > size)
+    {
+        if (! addPage())
+        {
+            return false;
+        }
+    }
+
+    *page = getPageCount() - 1;
+    *x = _penX;
+    *y = _penY;
+
+    _penX += width + GLYPH_PADDING;
+    _rowHeight = std::max(_rowHeight, height);
+    return true;
+}
+
+const FontAtlas::Glyph* FontAtlas::getGlyph(unsigned int charCode)
+{
+    auto iter = _glyphs.find(charCode);
+    if (iter != _glyphs.end())
+    {
+        return iter->second.index ? &iter->second : NULL;
+    }
+
+    Glyph glyph;
+    glyph.page = -1;
+    glyph.rect = Rect::ZERO;
+    glyph.bearingX = 0;
+    glyph.bearingY = 0;
+    glyph.advance = 0;
+    glyph.index = 0;
+
+#if CC_USE_FONT_ATLAS
+    glyph.index = FT_Get_Char_Index(_face, charCode);
+    if (glyph.index && FT_Load_Glyph(_face, glyph.index, FT_LOAD_RENDER) == 0)
+    {
+        FT_GlyphSlot slot = _face->glyph;
+        FT_Bitmap& bitmap = slot->bitmap;
+
+        glyph.bearingX = slot->metrics.horiBearingX >> 6;
+        glyph.bearingY = slot->metrics.horiBearingY >> 6;
+        glyph.advance = slot->metrics.horiAdvance >> 6;
+
+        int page, x, y;
+        const int spread = _distanceFieldSpread;
+        const int width = bitmap.width > 0 ? bitmap.width + 2 * spread : 0;
+        const int height = bitmap.rows > 0 ? bitmap.rows + 2 * spread : 0;
+        if (width > 0 && height > 0 && reserveGlyphRect(width, height, &page, &x, &y))
+        {
+            static std::vector<unsigned char> s_pixels;
+            s_pixels.resize(width * height);
+            if (_distanceField)
+            {
+                computeDistanceField(bitmap.buffer, bitmap.pitch, bitmap.width, bitmap.rows, spread, &s_pixels[0]);
+                // the quad of the glyph covers its padding
+                glyph.bearingX -= spread;
+                glyph.bearingY += spread;
+            }
+            else
+            {
+                // the rows of the FreeType bitmap can be padded
+                for (int row = 0; row < height; ++row)
+                {
+                    memcpy(&s_pixels[row * width], bitmap.buffer + row * bitmap.pitch, width);
+                }
+            }
+
+            GL::bindTexture2D(_pages[page]->getName());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_ALPHA, GL_UNSIGNED_BYTE, &s_pixels[0]);
+
+            glyph.page = page;
+            glyph.rect = Rect(x, y, width, height);
+        }
+    }
+    else
+    {
+        glyph.index = 0;
+    }
+#endif // CC_USE_FONT_ATLAS
+
+    // the characters without glyph are cached too, with an index of 0
+    Glyph& cached = _glyphs[charCode];
+    cached = glyph;
+    return cached.index ? &cached : NULL;
+}
+
+float FontAtlas::getKerning(const Glyph* left, const Glyph* right) const
+{
+#if CC_USE_FONT_ATLAS
+    if (_hasKerning && left && right)
+    {
+        FT_Vector delta;
+        if (FT_Get_Kerning(_face, left->index, right->index, FT_KERNING_DEFAULT, &delta) == 0)
+        {
+            return delta.x >> 6;
+        }
+    }
+#else
+    CC_UNUSED_PARAM(left);
+    CC_UNUSED_PARAM(right);
+#endif
+    return 0;
+}
+
+//
+// FontAtlasCache
+//
+static FontAtlas* getCachedFontAtlas(const char* fontName, int fontSize, bool distanceField)
+{
+#if CC_USE_FONT_ATLAS
+    if (! fontName || fontSize <= 0)
+    {
+        return NULL;
+    }
+
+    std::stringstream key;
+    key << fontName << (distanceField ? "@df" : "@") << fontSize;
+
+    auto iter = s_fontAtlases.find(key.str());
+    if (iter != s_fontAtlases.end())
+    {
+        return iter->second;
+    }
+
+    // the fonts that can't be loaded are cached too, as NULL
+    FontAtlas* atlas = FontAtlas::create(getFontFile(fontName), fontSize, distanceField);
+    CC_SAFE_RETAIN(atlas);
+    s_fontAtlases[key.str()] = atlas;
+    return atlas;
+#else
+    CC_UNUSED_PARAM(fontName);
+    CC_UNUSED_PARAM(fontSize);
+    CC_UNUSED_PARAM(distanceField);
+    return NULL;
+#endif
+}
+
+FontAtlas* FontAtlasCache::getFontAtlas(const char* fontName, int fontSize)
+{
+    return getCachedFontAtlas(fontName, fontSize, false);
+}
+
+FontAtlas* FontAtlasCache::getDistanceFieldFontAtlas(const char* fontName)
+{
+    return getCachedFontAtlas(fontName, CC_FONT_ATLAS_DISTANCE_FIELD_SIZE, true);
+}
+
+void FontAtlasCache::removeUnusedFontAtlases()
+{
+    for (auto iter = s_fontAtlases.begin(); iter != s_fontAtlases.end();)
+    {
+        FontAtlas* atlas = iter->second;
+        if (atlas && atlas->retainCount() == 1)
+        {
+            atlas->release();
+            iter = s_fontAtlases.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void FontAtlasCache::purgeCachedData()
+{
+    for (auto& iter : s_fontAtlases)
+    {
+        CC_SAFE_RELEASE(iter.second);
+    }
+    s_fontAtlases.clear();
+}
+
+NS_CC_END
@@ -0,0 +1,170 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCFONTATLAS_H__
+#define __CCFONTATLAS_H__
+
+#include "cocoa/CCObject.h"
+#include "cocoa/CCGeometry.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FT_FaceRec_;
+
+NS_CC_BEGIN
+
+class Texture2D;
+
+/**
+ * @addtogroup GUI
+ * @{
+ * @addtogroup label
+ * @{
+ */
+
+/** @brief FontAtlas rasterizes the glyphs of a TrueType font, at one size, into shared A8 textures.
+
+ The glyphs are rendered with FreeType the first time they are requested and packed in rows into
+ pages of CC_FONT_ATLAS_PAGE_SIZE pixels. A new page is added when the current one is full.
+ The labels draw quads that reference the glyphs, so changing their string doesn't create textures.
+
+ A distance field atlas stores, instead of the coverage of the glyphs, their distance to the edge of the glyph:
+ 0.5 on the edge, growing inside. It is drawn with the SHADER_NAME_LABEL_DISTANCEFIELD shaders, and the same
+ atlas serves all the sizes of the font, as well as outlines and glows.
+
+ FontAtlas is only available when CC_USE_FONT_ATLAS is enabled: otherwise FontAtlasCache returns NULL.
+
+ @since v3.0
+ */
+class CC_DLL FontAtlas : public Object
+{
+public:
+    /** A rasterized glyph. All the values are in pixels. */
+    struct Glyph
+    {
+        /** page of the glyph, -1 for the glyphs without pixels (eg: spaces) */
+        int page;
+        /** rectangle of the glyph in its page */
+        Rect rect;
+        /** horizontal distance from the pen to the left of the glyph */
+        float bearingX;
+        /** vertical distance from the baseline to the top of the glyph */
+        float bearingY;
+        /** horizontal distance from the pen to the next pen */
+        float advance;
+        /** index of the glyph in the font, used for the kerning */
+        unsigned int index;
+    };
+
+    /** creates an atlas for a font file, at a size in pixels. Returns NULL if the font can't be loaded. */
+    static FontAtlas* create(const std::string& fontFile, int fontSize, bool distanceField = false);
+
+    FontAtlas();
+    virtual ~FontAtlas();
+
+    bool initWithFontFile(const std::string& fontFile, int fontSize, bool distanceField = false);
+
+    /** Returns the glyph of a character, rasterizing it if it isn't in the atlas yet.
+     Returns NULL if the font has no glyph for the character.
+     */
+    const Glyph* getGlyph(unsigned int charCode);
+
+    /** horizontal kerning, in pixels, between two glyphs */
+    float getKerning(const Glyph* left, const Glyph* right) const;
+
+    /** distance between two baselines, in pixels */
+    inline float getLineHeight() const { return _lineHeight; }
+    /** distance from the top of a line to its baseline, in pixels */
+    inline float getAscender() const { return _ascender; }
+
+    inline int getFontSize() const { return _fontSize; }
+
+    /** whether or not the pages store distance fields
+     @since v3.0
+     */
+    inline bool isDistanceField() const { return _distanceField; }
+    /** Distance, in pixels, from the edge of the glyphs to the 0 and 1 values of the distance field.
+     The glyphs are padded by this distance on each side.
+     */
+    inline int getDistanceFieldSpread() const { return _distanceFieldSpread; }
+
+    inline int getPageCount() const { return static_cast<int>(_pages.size()); }
+    Texture2D* getPageTexture(int page) const;
+
+protected:
+    /** finds room for a glyph of width x height pixels, adding a page if needed. Returns false if it can't fit. */
+    bool reserveGlyphRect(int width, int height, int* page, int* x, int* y);
+    bool addPage();
+
+    FT_FaceRec_* _face;
+    bool _hasKerning;
+    bool _distanceField;
+    int _distanceFieldSpread;
+    int _fontSize;
+    float _lineHeight;
+    float _ascender;
+
+    std::unordered_map<unsigned int, Glyph> _glyphs;
+    std::vector<Texture2D*> _pages;
+
+    // shelf packing of the last page
+    int _penX;
+    int _penY;
+    int _rowHeight;
+};
+
+/** @brief FontAtlasCache shares the font atlases between the labels: one atlas per font and size.
+
+ @since v3.0
+ */
+class CC_DLL FontAtlasCache
+{
+public:
+    /** Returns the atlas of a font at a size in pixels, creating it if needed.
+     The font name can be a font file or, on Linux, a font family installed on the system.
+     Returns NULL if the font can't be found or if CC_USE_FONT_ATLAS is disabled.
+     */
+    static FontAtlas* getFontAtlas(const char* fontName, int fontSize);
+
+    /** Returns the distance field atlas of a font, rasterized at CC_FONT_ATLAS_DISTANCE_FIELD_SIZE, creating it if needed.
+     Returns NULL if the font can't be found or if CC_USE_FONT_ATLAS is disabled.
+     @since v3.0
+     */
+    static FontAtlas* getDistanceFieldFontAtlas(const char* fontName);
+
+    /** releases the atlases that no label uses */
+    static void removeUnusedFontAtlases();
+
+    /** releases all the atlases */
+    static void purgeCachedData();
+};
+
+// end of label group
+/// @}
+/// @}
+
+NS_CC_END
+
+#endif // __CCFONTATLAS_H__
@@ -196,6 +196,7 @@ void LabelAtlas::setString(const char *label)
     _string.clear();
     _string = label;
     this->updateAtlasValues();
+    invalidateRenderCache();
 
     Size s = Size(len * _itemWidth, _itemHeight);
 
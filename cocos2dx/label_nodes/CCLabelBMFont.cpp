@@ -37,6 +37,7 @@ http://www.angelcode.com/products/bmfont/ (Free, Windows only)
 #include "draw_nodes/CCDrawingPrimitives.h"
 #include "sprite_nodes/CCSprite.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
 #include "CCDirector.h"
 #include "textures/CCTextureCache.h"
 #include "support/ccUTF8.h"
@@ -84,6 +85,14 @@ CCBMFontConfiguration* FNTConfigLoadFile( const char *fntFile)
     return pRet;
 }
 
+void FNTConfigRemoveFile( const char *fntFile )
+{
+    if (s_pConfigurations)
+    {
+        s_pConfigurations->removeObjectForKey(fntFile);
+    }
+}
+
 void FNTConfigRemoveCache( void )
 {
     if (s_pConfigurations)
@@ -97,6 +106,91 @@ void FNTConfigRemoveCache( void )
 //BitmapFontConfiguration
 //
 
+// the empty slots of the kerning table. Not a valid pair: the characters are 16-bit
+static const unsigned int KERNING_EMPTY_KEY = 0xffffffff;
+
+static inline unsigned int hashKey(unsigned int key)
+{
+    key ^= key >> 16;
+    key *= 0x45d9f3b;
+    key ^= key >> 16;
+    return key;
+}
+
+// power of two size of an open addressing table of count entries, at most half full
+static unsigned int hashTableSize(unsigned int count)
+{
+    unsigned int size = 16;
+    while (size < count * 2)
+    {
+        size <<= 1;
+    }
+    return size;
+}
+
+// little endian fields of the binary format
+static inline unsigned int readUInt16(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline short readInt16(const unsigned char* p)
+{
+    return static_cast<short>(readUInt16(p));
+}
+
+static inline unsigned int readUInt32(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>(p[3]) << 24);
+}
+
+// the text files are parsed in place, the lines aren't null terminated
+static bool lineStartsWith(const char* line, const char* lineEnd, const char* prefix)
+{
+    size_t length = strlen(prefix);
+    return static_cast<size_t>(lineEnd - line) >= length && memcmp(line, prefix, length) == 0;
+}
+
+// returns the value of the attribute name=value of a line, or NULL
+static const char* findAttribute(const char* line, const char* lineEnd, const char* name)
+{
+    size_t length = strlen(name);
+    for (const char* p = line; p + length < lineEnd; ++p)
+    {
+        if ((p == line || p[-1] == ' ' || p[-1] == '\t') && p[length] == '=' && memcmp(p, name, length) == 0)
+        {
+            return p + length + 1;
+        }
+    }
+    return NULL;
+}
+
+// parses an integer at *p and moves *p after it
+static int parseInt(const char** p, const char* lineEnd)
+{
+    const char* s = *p;
+    bool negative = false;
+    if (s < lineEnd && (*s == '-' || *s == '+'))
+    {
+        negative = (*s == '-');
+        ++s;
+    }
+    int value = 0;
+    while (s < lineEnd && *s >= '0' && *s <= '9')
+    {
+        value = value * 10 + (*s - '0');
+        ++s;
+    }
+    *p = s;
+    return negative ? -value : value;
+}
+
+static int parseIntAttribute(const char* line, const char* lineEnd, const char* name)
+{
+    const char* value = findAttribute(line, lineEnd, name);
+    return value ? parseInt(&value, lineEnd) : 0;
+}
+
 CCBMFontConfiguration * CCBMFontConfiguration::create(const char *FNTfile)
 {
     CCBMFontConfiguration * pRet = new CCBMFontConfiguration();
@@ -111,154 +205,322 @@ CCBMFontConfiguration * CCBMFontConfiguration::create(const char *FNTfile)
 
 bool CCBMFontConfiguration::initWithFNTfile(const char *FNTfile)
 {
-    _kerningDictionary = NULL;
-    _fontDefDictionary = NULL;
-    
-    _characterSet = this->parseConfigFile(FNTfile);
-    
-    if (! _characterSet)
+    _fontDefs.clear();
+    _kerningEntries.clear();
+    CC_SAFE_DELETE(_characterSet);
+
+    if (! this->parseConfigFile(FNTfile))
     {
         return false;
     }
 
+    this->buildFontDefIndex();
+    this->buildKerningTable();
     return true;
 }
 
 std::set<unsigned int>* CCBMFontConfiguration::getCharacterSet() const
 {
+    if (! _characterSet)
+    {
+        _characterSet = new set<unsigned int>();
+        for (const auto& fontDef : _fontDefs)
+        {
+            _characterSet->insert(fontDef.charID);
+        }
+    }
     return _characterSet;
 }
 
 CCBMFontConfiguration::CCBMFontConfiguration()
-: _fontDefDictionary(NULL)
-, _commonHeight(0)
-, _kerningDictionary(NULL)
+: _commonHeight(0)
 , _characterSet(NULL)
 {
-
+    _padding.left = _padding.top = _padding.right = _padding.bottom = 0;
 }
 
 CCBMFontConfiguration::~CCBMFontConfiguration()
 {
     CCLOGINFO( "cocos2d: deallocing CCBMFontConfiguration %p", this );
-    this->purgeFontDefDictionary();
-    this->purgeKerningDictionary();
     _atlasName.clear();
     CC_SAFE_DELETE(_characterSet);
 }
 
 const char* CCBMFontConfiguration::description(void) const
 {
+    unsigned int kerningCount = 0;
+    for (const auto& entry : _kerningTable)
+    {
+        if (entry.key != KERNING_EMPTY_KEY)
+        {
+            ++kerningCount;
+        }
+    }
+
     return String::createWithFormat(
         "<CCBMFontConfiguration = " CC_FORMAT_PRINTF_SIZE_T " | Glphys:%d Kernings:%d | Image = %s>",
         (size_t)this,
-        HASH_COUNT(_fontDefDictionary),
-        HASH_COUNT(_kerningDictionary),
+        (int)_fontDefs.size(),
+        (int)kerningCount,
         _atlasName.c_str()
     )->getCString();
 }
 
-void CCBMFontConfiguration::purgeKerningDictionary()
+const ccBMFontDef* CCBMFontConfiguration::getFontDef(unsigned int charID) const
 {
-    tKerningHashElement *current;
-    while(_kerningDictionary) 
+    if (_fontDefIndex.empty())
+    {
+        return NULL;
+    }
+
+    const unsigned int mask = _fontDefIndex.size() - 1;
+    for (unsigned int slot = hashKey(charID) & mask; _fontDefIndex[slot]; slot = (slot + 1) & mask)
     {
-        current = _kerningDictionary; 
-        HASH_DEL(_kerningDictionary,current);
-        free(current);
+        const ccBMFontDef& fontDef = _fontDefs[_fontDefIndex[slot] - 1];
+        if (fontDef.charID == charID)
+        {
+            return &fontDef;
+        }
     }
+    return NULL;
 }
 
-void CCBMFontConfiguration::purgeFontDefDictionary()
-{    
-    tFontDefHashElement *current, *tmp;
+int CCBMFontConfiguration::getKerningAmount(unsigned short first, unsigned short second) const
+{
+    if (_kerningTable.empty())
+    {
+        return 0;
+    }
 
-    HASH_ITER(hh, _fontDefDictionary, current, tmp) {
-        HASH_DEL(_fontDefDictionary, current);
-        free(current);
+    const unsigned int key = (first << 16) | (second & 0xffff);
+    const unsigned int mask = _kerningTable.size() - 1;
+    for (unsigned int slot = hashKey(key) & mask; _kerningTable[slot].key != KERNING_EMPTY_KEY; slot = (slot + 1) & mask)
+    {
+        if (_kerningTable[slot].key == key)
+        {
+            return _kerningTable[slot].amount;
+        }
     }
+    return 0;
 }
 
-std::set<unsigned int>* CCBMFontConfiguration::parseConfigFile(const char *controlFile)
+void CCBMFontConfiguration::buildFontDefIndex()
+{
+    _fontDefIndex.clear();
+    if (_fontDefs.empty())
+    {
+        return;
+    }
+
+    _fontDefIndex.resize(hashTableSize(_fontDefs.size()), 0);
+    const unsigned int mask = _fontDefIndex.size() - 1;
+    for (unsigned int i = 0; i < _fontDefs.size(); ++i)
+    {
+        unsigned int slot = hashKey(_fontDefs[i].charID) & mask;
+        while (_fontDefIndex[slot] && _fontDefs[_fontDefIndex[slot] - 1].charID != _fontDefs[i].charID)
+        {
+            slot = (slot + 1) & mask;
+        }
+        // the last definition of a character wins
+        _fontDefIndex[slot] = i + 1;
+    }
+}
+
+void CCBMFontConfiguration::buildKerningTable()
+{
+    _kerningTable.clear();
+    if (! _kerningEntries.empty())
+    {
+        KerningEntry empty = { KERNING_EMPTY_KEY, 0 };
+        _kerningTable.resize(hashTableSize(_kerningEntries.size()), empty);
+        const unsigned int mask = _kerningTable.size() - 1;
+        for (const auto& entry : _kerningEntries)
+        {
+            unsigned int slot = hashKey(entry.key) & mask;
+            while (_kerningTable[slot].key != KERNING_EMPTY_KEY && _kerningTable[slot].key != entry.key)
+            {
+                slot = (slot + 1) & mask;
+            }
+            _kerningTable[slot] = entry;
+        }
+    }
+
+    // only the table is needed to render
+    std::vector<KerningEntry>().swap(_kerningEntries);
+}
+
+void CCBMFontConfiguration::addKerningEntry(unsigned int first, unsigned int second, int amount)
+{
+    KerningEntry entry;
+    entry.key = ((first & 0xffff) << 16) | (second & 0xffff);
+    entry.amount = amount;
+    _kerningEntries.push_back(entry);
+}
+
+bool CCBMFontConfiguration::parseConfigFile(const char *controlFile)
 {    
     std::string fullpath = FileUtils::getInstance()->fullPathForFilename(controlFile);
-    String *contents = String::createWithContentsOfFile(fullpath.c_str());
+    MappedFile* file = FileUtils::getInstance()->getMappedFileData(fullpath.c_str());
 
-    CCASSERT(contents, "CCBMFontConfiguration::parseConfigFile | Open file error.");
-    
-    set<unsigned int> *validCharsString = new set<unsigned int>();
+    CCASSERT(file, "CCBMFontConfiguration::parseConfigFile | Open file error.");
 
-    if (!contents)
+    if (!file || file->getSize() == 0)
     {
         CCLOG("cocos2d: Error parsing FNTfile %s", controlFile);
-        return NULL;
+        return false;
     }
 
-    // parse spacing / padding
-    std::string line;
-    std::string strLeft = contents->getCString();
-    while (strLeft.length() > 0)
-    {
-        int pos = strLeft.find('\n');
+    const unsigned char* data = file->getBytes();
+    unsigned long size = file->getSize();
 
-        if (pos != (int)std::string::npos)
+    // the binary files begin with "BMF" and their version
+    if (size >= 4 && memcmp(data, "BMF", 3) == 0)
+    {
+        if (data[3] != 3)
         {
-            // the data is more than a line.get one line
-            line = strLeft.substr(0, pos);
-            strLeft = strLeft.substr(pos + 1);
+            CCLOG("cocos2d: Error parsing FNTfile %s: version %d of the binary format isn't supported", controlFile, data[3]);
+            return false;
         }
-        else
+        return this->parseBinaryFile(data, size, controlFile);
+    }
+
+    return this->parseTextFile(reinterpret_cast<const char*>(data), size, controlFile);
+}
+
+bool CCBMFontConfiguration::parseTextFile(const char* data, unsigned long size, const char *controlFile)
+{
+    const char* dataEnd = data + size;
+    for (const char* line = data; line < dataEnd;)
+    {
+        const char* lineEnd = static_cast<const char*>(memchr(line, '\n', dataEnd - line));
+        if (! lineEnd)
         {
-            // get the left data
-            line = strLeft;
-            strLeft.erase();
+            lineEnd = dataEnd;
         }
 
-        if(line.substr(0,strlen("info face")) == "info face") 
+        if (lineStartsWith(line, lineEnd, "info face"))
         {
             // XXX: info parsing is incomplete
             // Not needed for the Hiero editors, but needed for the AngelCode editor
-            //            [self parseInfoArguments:line];
-            this->parseInfoArguments(line);
+            this->parseInfoArguments(line, lineEnd);
         }
         // Check to see if the start of the line is something we are interested in
-        else if(line.substr(0,strlen("common lineHeight")) == "common lineHeight")
+        else if (lineStartsWith(line, lineEnd, "common lineHeight"))
         {
-            this->parseCommonArguments(line);
+            this->parseCommonArguments(line, lineEnd);
         }
-        else if(line.substr(0,strlen("page id")) == "page id")
+        else if (lineStartsWith(line, lineEnd, "page id"))
         {
-            this->parseImageFileName(line, controlFile);
+            this->parseImageFileName(line, lineEnd, controlFile);
         }
-        else if(line.substr(0,strlen("chars c")) == "chars c")
+        else if (lineStartsWith(line, lineEnd, "chars c"))
         {
-            // Ignore this line
+            _fontDefs.reserve(parseIntAttribute(line, lineEnd, "count"));
         }
-        else if(line.substr(0,strlen("char")) == "char")
+        else if (lineStartsWith(line, lineEnd, "char"))
         {
             // Parse the current line and create a new CharDef
-            tFontDefHashElement* element = (tFontDefHashElement*)malloc( sizeof(*element) );
-            this->parseCharacterDefinition(line, &element->fontDef);
+            ccBMFontDef fontDef;
+            this->parseCharacterDefinition(line, lineEnd, &fontDef);
+            _fontDefs.push_back(fontDef);
+        }
+        else if (lineStartsWith(line, lineEnd, "kernings count"))
+        {
+            _kerningEntries.reserve(parseIntAttribute(line, lineEnd, "count"));
+        }
+        else if (lineStartsWith(line, lineEnd, "kerning first"))
+        {
+            this->parseKerningEntry(line, lineEnd);
+        }
 
-            element->key = element->fontDef.charID;
-            HASH_ADD_INT(_fontDefDictionary, key, element);
-            
-            validCharsString->insert(element->fontDef.charID);
+        line = lineEnd + 1;
+    }
+
+    return true;
+}
+
+bool CCBMFontConfiguration::parseBinaryFile(const unsigned char* data, unsigned long size, const char *controlFile)
+{
+    //////////////////////////////////////////////////////////////////////////
+    // "BMF", the version, then blocks made of:
+    // a type (1 byte), the size of the block (4 bytes), and the block
+    // http://www.angelcode.com/products/bmfont/doc/file_format.html
+    //////////////////////////////////////////////////////////////////////////
+
+    unsigned long offset = 4;
+    while (offset + 5 <= size)
+    {
+        const unsigned char type = data[offset];
+        const unsigned long blockSize = readUInt32(data + offset + 1);
+        offset += 5;
+        if (blockSize > size - offset)
+        {
+            CCLOG("cocos2d: Error parsing FNTfile %s: truncated block %d", controlFile, type);
+            return false;
+        }
+        const unsigned char* block = data + offset;
+        offset += blockSize;
+
+        if (type == 1 && blockSize >= 11)
+        {
+            // info: fontSize (2 bytes), bitField, charSet, stretchH (2 bytes), aa, paddingUp, paddingRight, paddingDown, paddingLeft, ...
+            _padding.top = block[7];
+            _padding.right = block[8];
+            _padding.bottom = block[9];
+            _padding.left = block[10];
         }
-//        else if(line.substr(0,strlen("kernings count")) == "kernings count")
-//        {
-//            this->parseKerningCapacity(line);
-//        }
-        else if(line.substr(0,strlen("kerning first")) == "kerning first")
+        else if (type == 2 && blockSize >= 10)
         {
-            this->parseKerningEntry(line);
+            // common: lineHeight, base, scaleW, scaleH, pages (2 bytes each), ...
+            _commonHeight = readUInt16(block);
+            CCASSERT((int)readUInt16(block + 4) <= Configuration::getInstance()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
+            CCASSERT((int)readUInt16(block + 6) <= Configuration::getInstance()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
+            CCASSERT(readUInt16(block + 8) == 1, "CCBitfontAtlas: only supports 1 page");
+        }
+        else if (type == 3 && blockSize > 0)
+        {
+            // pages: the null terminated file names. Only the first page is supported
+            const unsigned char* nameEnd = static_cast<const unsigned char*>(memchr(block, 0, blockSize));
+            std::string value(reinterpret_cast<const char*>(block), nameEnd ? nameEnd - block : blockSize);
+            _atlasName = FileUtils::getInstance()->fullPathFromRelativeFile(value.c_str(), controlFile);
+        }
+        else if (type == 4)
+        {
+            // chars: id (4 bytes), x, y, width, height, xoffset, yoffset, xadvance (2 bytes each), page, chnl
+            const unsigned long count = blockSize / 20;
+            _fontDefs.reserve(_fontDefs.size() + count);
+            for (unsigned long i = 0; i < count; ++i)
+            {
+                const unsigned char* p = block + i * 20;
+                ccBMFontDef fontDef;
+                fontDef.charID = readUInt32(p);
+                fontDef.rect.origin.x = readUInt16(p + 4);
+                fontDef.rect.origin.y = readUInt16(p + 6);
+                fontDef.rect.size.width = readUInt16(p + 8);
+                fontDef.rect.size.height = readUInt16(p + 10);
+                fontDef.xOffset = readInt16(p + 12);
+                fontDef.yOffset = readInt16(p + 14);
+                fontDef.xAdvance = readInt16(p + 16);
+                _fontDefs.push_back(fontDef);
+            }
+        }
+        else if (type == 5)
+        {
+            // kerning pairs: first (4 bytes), second (4 bytes), amount (2 bytes)
+            const unsigned long count = blockSize / 10;
+            _kerningEntries.reserve(_kerningEntries.size() + count);
+            for (unsigned long i = 0; i < count; ++i)
+            {
+                const unsigned char* p = block + i * 10;
+                this->addKerningEntry(readUInt32(p), readUInt32(p + 4), readInt16(p + 8));
+            }
         }
     }
-    
-    return validCharsString;
+
+    return true;
 }
 
-void CCBMFontConfiguration::parseImageFileName(std::string line, const char *fntFile)
+void CCBMFontConfiguration::parseImageFileName(const char* line, const char* lineEnd, const char *fntFile)
 {
     //////////////////////////////////////////////////////////////////////////
     // line to parse:
@@ -266,19 +528,27 @@ void CCBMFontConfiguration::parseImageFileName(std::string line, const char *fnt
     //////////////////////////////////////////////////////////////////////////
 
     // page ID. Sanity check
-    int index = line.find('=')+1;
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    CCASSERT(atoi(value.c_str()) == 0, "LabelBMFont file could not be found");
+    CCASSERT(parseIntAttribute(line, lineEnd, "id") == 0, "LabelBMFont file could not be found");
     // file 
-    index = line.find('"')+1;
-    index2 = line.find('"', index);
-    value = line.substr(index, index2-index);
+    const char* value = findAttribute(line, lineEnd, "file");
+    if (! value)
+    {
+        return;
+    }
+    if (value < lineEnd && *value == '"')
+    {
+        ++value;
+    }
+    const char* valueEnd = value;
+    while (valueEnd < lineEnd && *valueEnd != '"' && *valueEnd != '\r')
+    {
+        ++valueEnd;
+    }
 
-    _atlasName = FileUtils::getInstance()->fullPathFromRelativeFile(value.c_str(), fntFile);
+    _atlasName = FileUtils::getInstance()->fullPathFromRelativeFile(std::string(value, valueEnd).c_str(), fntFile);
 }
 
-void CCBMFontConfiguration::parseInfoArguments(std::string line)
+void CCBMFontConfiguration::parseInfoArguments(const char* line, const char* lineEnd)
 {
     //////////////////////////////////////////////////////////////////////////
     // possible lines to parse:
@@ -287,14 +557,23 @@ void CCBMFontConfiguration::parseInfoArguments(std::string line)
     //////////////////////////////////////////////////////////////////////////
 
     // padding
-    int index = line.find("padding=");
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "padding=%d,%d,%d,%d", &_padding.top, &_padding.right, &_padding.bottom, &_padding.left);
+    const char* value = findAttribute(line, lineEnd, "padding");
+    if (value)
+    {
+        int* paddings[] = { &_padding.top, &_padding.right, &_padding.bottom, &_padding.left };
+        for (int i = 0; i < 4; ++i)
+        {
+            *paddings[i] = parseInt(&value, lineEnd);
+            if (value < lineEnd && *value == ',')
+            {
+                ++value;
+            }
+        }
+    }
     CCLOG("cocos2d: padding: %d,%d,%d,%d", _padding.left, _padding.top, _padding.right, _padding.bottom);
 }
 
-void CCBMFontConfiguration::parseCommonArguments(std::string line)
+void CCBMFontConfiguration::parseCommonArguments(const char* line, const char* lineEnd)
 {
     //////////////////////////////////////////////////////////////////////////
     // line to parse:
@@ -302,111 +581,46 @@ void CCBMFontConfiguration::parseCommonArguments(std::string line)
     //////////////////////////////////////////////////////////////////////////
 
     // Height
-    int index = line.find("lineHeight=");
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "lineHeight=%d", &_commonHeight);
+    _commonHeight = parseIntAttribute(line, lineEnd, "lineHeight");
     // scaleW. sanity check
-    index = line.find("scaleW=") + strlen("scaleW=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    CCASSERT(atoi(value.c_str()) <= Configuration::getInstance()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
+    CCASSERT(parseIntAttribute(line, lineEnd, "scaleW") <= Configuration::getInstance()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
     // scaleH. sanity check
-    index = line.find("scaleH=") + strlen("scaleH=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    CCASSERT(atoi(value.c_str()) <= Configuration::getInstance()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
+    CCASSERT(parseIntAttribute(line, lineEnd, "scaleH") <= Configuration::getInstance()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
     // pages. sanity check
-    index = line.find("pages=") + strlen("pages=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    CCASSERT(atoi(value.c_str()) == 1, "CCBitfontAtlas: only supports 1 page");
+    CCASSERT(parseIntAttribute(line, lineEnd, "pages") == 1, "CCBitfontAtlas: only supports 1 page");
 
     // packed (ignore) What does this mean ??
 }
 
-void CCBMFontConfiguration::parseCharacterDefinition(std::string line, ccBMFontDef *characterDefinition)
+void CCBMFontConfiguration::parseCharacterDefinition(const char* line, const char* lineEnd, ccBMFontDef *characterDefinition)
 {    
     //////////////////////////////////////////////////////////////////////////
     // line to parse:
     // char id=32   x=0     y=0     width=0     height=0     xoffset=0     yoffset=44    xadvance=14     page=0  chnl=0 
     //////////////////////////////////////////////////////////////////////////
 
-    // Character ID
-    int index = line.find("id=");
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "id=%u", &characterDefinition->charID);
-
-    // Character x
-    index = line.find("x=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "x=%f", &characterDefinition->rect.origin.x);
-    // Character y
-    index = line.find("y=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "y=%f", &characterDefinition->rect.origin.y);
-    // Character width
-    index = line.find("width=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "width=%f", &characterDefinition->rect.size.width);
-    // Character height
-    index = line.find("height=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "height=%f", &characterDefinition->rect.size.height);
-    // Character xoffset
-    index = line.find("xoffset=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "xoffset=%hd", &characterDefinition->xOffset);
-    // Character yoffset
-    index = line.find("yoffset=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "yoffset=%hd", &characterDefinition->yOffset);
-    // Character xadvance
-    index = line.find("xadvance=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "xadvance=%hd", &characterDefinition->xAdvance);
-}
-
-void CCBMFontConfiguration::parseKerningEntry(std::string line)
+    characterDefinition->charID = parseIntAttribute(line, lineEnd, "id");
+    characterDefinition->rect.origin.x = parseIntAttribute(line, lineEnd, "x");
+    characterDefinition->rect.origin.y = parseIntAttribute(line, lineEnd, "y");
+    characterDefinition->rect.size.width = parseIntAttribute(line, lineEnd, "width");
+    characterDefinition->rect.size.height = parseIntAttribute(line, lineEnd, "height");
+    characterDefinition->xOffset = parseIntAttribute(line, lineEnd, "xoffset");
+    characterDefinition->yOffset = parseIntAttribute(line, lineEnd, "yoffset");
+    characterDefinition->xAdvance = parseIntAttribute(line, lineEnd, "xadvance");
+}
+
+void CCBMFontConfiguration::parseKerningEntry(const char* line, const char* lineEnd)
 {        
     //////////////////////////////////////////////////////////////////////////
     // line to parse:
     // kerning first=121  second=44  amount=-7
     //////////////////////////////////////////////////////////////////////////
 
-    // first
-    int first;
-    int index = line.find("first=");
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "first=%d", &first);
-
-    // second
-    int second;
-    index = line.find("second=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "second=%d", &second);
-
-    // amount
-    int amount;
-    index = line.find("amount=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "amount=%d", &amount);
-
-    tKerningHashElement *element = (tKerningHashElement *)calloc( sizeof( *element ), 1 );
-    element->amount = amount;
-    element->key = (first<<16) | (second&0xffff);
-    HASH_ADD_INT(_kerningDictionary,key, element);
+    int first = parseIntAttribute(line, lineEnd, "first");
+    int second = parseIntAttribute(line, lineEnd, "second");
+    int amount = parseIntAttribute(line, lineEnd, "amount");
+
+    this->addKerningEntry(first, second, amount);
 }
 //
 //CCLabelBMFont
@@ -519,6 +733,9 @@ bool LabelBMFont::initWithString(const char *theString, const char *fntFile, flo
         _reusedChar = new Sprite();
         _reusedChar->initWithTexture(_textureAtlas->getTexture(), Rect(0, 0, 0, 0), false);
         _reusedChar->setBatchNode(this);
+
+        // the letters are looked up by their index in the string
+        setChildTagIndexEnabled(true);
         
         this->setString(theString, true);
         
@@ -543,6 +760,7 @@ LabelBMFont::LabelBMFont()
 , _cascadeColorEnabled(true)
 , _cascadeOpacityEnabled(true)
 , _isOpacityModifyRGB(false)
+, _letterSpritesEnabled(CC_LABELBMFONT_LETTER_SPRITES != 0)
 {
 
 }
@@ -558,20 +776,17 @@ LabelBMFont::~LabelBMFont()
 // LabelBMFont - Atlas generation
 int LabelBMFont::kerningAmountForFirst(unsigned short first, unsigned short second)
 {
-    int ret = 0;
-    unsigned int key = (first<<16) | (second & 0xffff);
-
-    if( _configuration->_kerningDictionary ) {
-        tKerningHashElement *element = NULL;
-        HASH_FIND_INT(_configuration->_kerningDictionary, &key, element);        
-        if(element)
-            ret = element->amount;
-    }
-    return ret;
+    return _configuration->getKerningAmount(first, second);
 }
 
 void LabelBMFont::createFontChars()
 {
+    if (! _letterSpritesEnabled)
+    {
+        this->updateGlyphQuads();
+        return;
+    }
+
     int nextFontPositionX = 0;
     int nextFontPositionY = 0;
     unsigned short prev = -1;
@@ -589,8 +804,6 @@ void LabelBMFont::createFontChars()
         return;
     }
 
-    set<unsigned int> *charSet = _configuration->getCharacterSet();
-
     for (unsigned int i = 0; i < stringLen - 1; ++i)
     {
         unsigned short c = _string[i];
@@ -617,26 +830,16 @@ void LabelBMFont::createFontChars()
             continue;
         }
         
-        if (charSet->find(c) == charSet->end())
+        const ccBMFontDef* element = _configuration->getFontDef(c);
+        if (! element)
         {
             CCLOGWARN("cocos2d::LabelBMFont: Attempted to use character not defined in this bitmap: %d", c);
-            continue;      
+            continue;
         }
 
         kerningAmount = this->kerningAmountForFirst(prev, c);
-        
-        tFontDefHashElement *element = NULL;
-
-        // unichar is a short, and an int is needed on HASH_FIND_INT
-        unsigned int key = c;
-        HASH_FIND_INT(_configuration->_fontDefDictionary, &key, element);
-        if (! element)
-        {
-            CCLOGWARN("cocos2d::LabelBMFont: characer not found %d", c);
-            continue;
-        }
 
-        fontDef = element->fontDef;
+        fontDef = *element;
 
         rect = fontDef.rect;
         rect = CC_RECT_PIXELS_TO_POINTS(rect);
@@ -736,13 +939,31 @@ void LabelBMFont::setString(const char *newString, bool needUpdateLabel)
     if (needUpdateLabel) {
         _initialStringUTF8 = newString;
     }
-    unsigned short* utf16String = cc_utf8_to_utf16(newString);
-    setString(utf16String, needUpdateLabel);
-    CC_SAFE_DELETE_ARRAY(utf16String);
- }
+    // re-layouts and repeated sets of the same text reuse the last conversion
+    if (_utf16Buffer.empty() || _utf16Source != newString)
+    {
+        int bytes = strlen(newString);
+        _utf16Buffer.resize(bytes + 1);
+        int units = cc_utf8_to_utf16_buffer(newString, bytes, &_utf16Buffer[0], bytes + 1);
+        _utf16Buffer.resize(units + 1);
+        _utf16Source = newString;
+    }
+    setString(&_utf16Buffer[0], needUpdateLabel);
+}
 
 void LabelBMFont::setString(unsigned short *newString, bool needUpdateLabel)
 {
+    if (! _letterSpritesEnabled)
+    {
+        // the quads are always laid out from the initial string
+        unsigned short* tmp = _initialString;
+        _initialString = copyUTF16StringN(newString);
+        CC_SAFE_DELETE_ARRAY(tmp);
+
+        this->updateGlyphQuads();
+        return;
+    }
+
     if (!needUpdateLabel)
     {
         unsigned short* tmp = _string;
@@ -756,17 +977,9 @@ void LabelBMFont::setString(unsigned short *newString, bool needUpdateLabel)
         CC_SAFE_DELETE_ARRAY(tmp);
     }
     
-    if (_children && _children->count() != 0)
+    for (auto child : _children)
     {
-        Object* child;
-        CCARRAY_FOREACH(_children, child)
-        {
-            Node* pNode = static_cast<Node*>( child );
-            if (pNode)
-            {
-                pNode->setVisible(false);
-            }
-        }
+        child->setVisible(false);
     }
     this->createFontChars();
     
@@ -840,20 +1053,13 @@ void LabelBMFont::setOpacity(GLubyte opacity)
 void LabelBMFont::setOpacityModifyRGB(bool var)
 {
     _isOpacityModifyRGB = var;
-    if (_children && _children->count() != 0)
+    this->updateGlyphQuadColors();
+    for (auto child : _children)
     {
-        Object* child;
-        CCARRAY_FOREACH(_children, child)
+        RGBAProtocol *pRGBAProtocol = dynamic_cast<RGBAProtocol*>(child);
+        if (pRGBAProtocol)
         {
-            Node* pNode = static_cast<Node*>( child );
-            if (pNode)
-            {
-                RGBAProtocol *pRGBAProtocol = dynamic_cast<RGBAProtocol*>(pNode);
-                if (pRGBAProtocol)
-                {
-                    pRGBAProtocol->setOpacityModifyRGB(_isOpacityModifyRGB);
-                }
-            }
+            pRGBAProtocol->setOpacityModifyRGB(_isOpacityModifyRGB);
         }
     }
 }
@@ -866,12 +1072,12 @@ void LabelBMFont::updateDisplayedOpacity(GLubyte parentOpacity)
 {
 	_displayedOpacity = _realOpacity * parentOpacity/255.0;
     
-	Object* pObj;
-	CCARRAY_FOREACH(_children, pObj)
+    for (auto child : _children)
     {
-        Sprite *item = static_cast<Sprite*>( pObj );
+        Sprite *item = static_cast<Sprite*>( child );
 		item->updateDisplayedOpacity(_displayedOpacity);
 	}
+    this->updateGlyphQuadColors();
 }
 
 void LabelBMFont::updateDisplayedColor(const Color3B& parentColor)
@@ -880,12 +1086,12 @@ void LabelBMFont::updateDisplayedColor(const Color3B& parentColor)
 	_displayedColor.g = _realColor.g * parentColor.g/255.0;
 	_displayedColor.b = _realColor.b * parentColor.b/255.0;
     
-    Object* pObj;
-	CCARRAY_FOREACH(_children, pObj)
+    for (auto child : _children)
     {
-        Sprite *item = static_cast<Sprite*>( pObj );
+        Sprite *item = static_cast<Sprite*>( child );
 		item->updateDisplayedColor(_displayedColor);
 	}
+    this->updateGlyphQuadColors();
 }
 
 bool LabelBMFont::isCascadeColorEnabled() const
@@ -921,6 +1127,12 @@ void LabelBMFont::setAnchorPoint(const Point& point)
 // LabelBMFont - Alignment
 void LabelBMFont::updateLabel()
 {
+    if (! _letterSpritesEnabled)
+    {
+        this->updateGlyphQuads();
+        return;
+    }
+
     this->setString(_initialString, false);
 
     if (_width > 0)
@@ -938,8 +1150,8 @@ void LabelBMFont::updateLabel()
         float startOfLine = -1, startOfWord = -1;
         int skip = 0;
 
-        Array* children = getChildren();
-        for (unsigned int j = 0; j < children->count(); j++)
+        unsigned int childrenCount = getChildrenCount();
+        for (unsigned int j = 0; j < childrenCount; j++)
         {
             Sprite* characterSprite;
             unsigned int justSkipped = 0;
@@ -1078,19 +1290,9 @@ void LabelBMFont::updateLabel()
 
         multiline_string.insert(multiline_string.end(), last_word.begin(), last_word.end());
 
-        int size = multiline_string.size();
-        unsigned short* str_new = new unsigned short[size + 1];
+        multiline_string.push_back('\0');
 
-        for (int i = 0; i < size; ++i)
-        {
-            str_new[i] = multiline_string[i];
-        }
-
-        str_new[size] = '\0';
-
-        this->setString(str_new, false);
-        
-        CC_SAFE_DELETE_ARRAY(str_new);
+        this->setString(&multiline_string[0], false);
     }
 
     // Step 2: Make alignment
@@ -1206,6 +1408,251 @@ float LabelBMFont::getLetterPosXRight( Sprite* sp )
     return sp->getPosition().x * _scaleX + (sp->getContentSize().width * _scaleX * sp->getAnchorPoint().x);
 }
 
+// LabelBMFont - Quads
+void LabelBMFont::setLetterSpritesEnabled(bool enabled)
+{
+    if (enabled == _letterSpritesEnabled)
+    {
+        return;
+    }
+
+    _letterSpritesEnabled = enabled;
+    if (enabled)
+    {
+        // the sprites write their own quads
+        _textureAtlas->removeAllQuads();
+        _glyphQuads.clear();
+    }
+    else
+    {
+        this->removeAllChildrenWithCleanup(true);
+    }
+    this->updateLabel();
+}
+
+void LabelBMFont::updateGlyphQuads()
+{
+    _glyphQuads.clear();
+    _glyphLineStarts.clear();
+    _glyphLineStarts.push_back(0);
+
+    unsigned int stringLen = _initialString ? cc_wcslen(_initialString) : 0;
+    if (stringLen == 0 || ! _configuration)
+    {
+        _textureAtlas->removeAllQuads();
+        this->setContentSize(Size::ZERO);
+        return;
+    }
+
+    // the layout is done in pixels
+    const float scaleFactor = CC_CONTENT_SCALE_FACTOR();
+    Texture2D* texture = _textureAtlas->getTexture();
+    const float atlasWidth = (float)texture->getPixelsWide();
+    const float atlasHeight = (float)texture->getPixelsHigh();
+    // like the letter sprites, the lines are wrapped when the scaled string is wider than _width
+    const float maxWidth = (_width > 0 && _scaleX != 0) ? _width * scaleFactor / fabsf(_scaleX) : 0;
+
+    float penX = 0;
+    unsigned short prev = -1;
+    // first quad and pen of the current word, where the line can be wrapped
+    int wordStart = -1;
+    float wordPenX = 0;
+    bool lineWrapped = false;
+
+    for (unsigned int i = 0; i < stringLen; ++i)
+    {
+        unsigned short c = _initialString[i];
+
+        if (c == '\n')
+        {
+            _glyphLineStarts.push_back(static_cast<int>(_glyphQuads.size()));
+            penX = 0;
+            wordStart = -1;
+            lineWrapped = false;
+            continue;
+        }
+
+        const ccBMFontDef* element = _configuration->getFontDef(c);
+        if (! element)
+        {
+            CCLOGWARN("cocos2d::LabelBMFont: Attempted to use character not defined in this bitmap: %d", c);
+            continue;
+        }
+        const ccBMFontDef& fontDef = *element;
+
+        if (isspace_unicode(c))
+        {
+            // the spaces have no quad, and the wrapped lines don't begin with spaces
+            if (! lineWrapped)
+            {
+                penX += fontDef.xAdvance + this->kerningAmountForFirst(prev, c);
+            }
+            wordStart = -1;
+            prev = c;
+            continue;
+        }
+        lineWrapped = false;
+
+        int kerningAmount = this->kerningAmountForFirst(prev, c);
+        if (wordStart < 0)
+        {
+            wordStart = static_cast<int>(_glyphQuads.size());
+            wordPenX = penX;
+        }
+
+        float left = penX + fontDef.xOffset + kerningAmount;
+        const int lineStart = _glyphLineStarts.back();
+        if (maxWidth > 0 && left + fontDef.rect.size.width > maxWidth && static_cast<int>(_glyphQuads.size()) > lineStart)
+        {
+            if (! _lineBreakWithoutSpaces && wordStart > lineStart)
+            {
+                // moves the current word to a new line
+                _glyphLineStarts.push_back(wordStart);
+                for (size_t q = wordStart; q < _glyphQuads.size(); ++q)
+                {
+                    V3F_C4B_T2F_Quad& quad = _glyphQuads[q];
+                    quad.bl.vertices.x -= wordPenX;
+                    quad.br.vertices.x -= wordPenX;
+                    quad.tl.vertices.x -= wordPenX;
+                    quad.tr.vertices.x -= wordPenX;
+                }
+                penX -= wordPenX;
+                left -= wordPenX;
+            }
+            else
+            {
+                _glyphLineStarts.push_back(static_cast<int>(_glyphQuads.size()));
+                penX = 0;
+                left = fontDef.xOffset;
+                kerningAmount = 0;
+            }
+            wordStart = _glyphLineStarts.back();
+            wordPenX = 0;
+        }
+
+        // y is relative to the top of the line for now
+        const float right = left + fontDef.rect.size.width;
+        const float top = -fontDef.yOffset;
+        const float bottom = top - fontDef.rect.size.height;
+
+        V3F_C4B_T2F_Quad quad;
+        quad.bl.vertices = Vertex3F(left, bottom, 0);
+        quad.br.vertices = Vertex3F(right, bottom, 0);
+        quad.tl.vertices = Vertex3F(left, top, 0);
+        quad.tr.vertices = Vertex3F(right, top, 0);
+
+        Rect rect = fontDef.rect;
+        rect.origin.x += _imageOffset.x * scaleFactor;
+        rect.origin.y += _imageOffset.y * scaleFactor;
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+        float u0 = (2 * rect.origin.x + 1) / (2 * atlasWidth);
+        float u1 = u0 + (rect.size.width * 2 - 2) / (2 * atlasWidth);
+        float v0 = (2 * rect.origin.y + 1) / (2 * atlasHeight);
+        float v1 = v0 + (rect.size.height * 2 - 2) / (2 * atlasHeight);
+#else
+        float u0 = rect.origin.x / atlasWidth;
+        float u1 = (rect.origin.x + rect.size.width) / atlasWidth;
+        float v0 = rect.origin.y / atlasHeight;
+        float v1 = (rect.origin.y + rect.size.height) / atlasHeight;
+#endif // CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+        quad.bl.texCoords = Tex2F(u0, v1);
+        quad.br.texCoords = Tex2F(u1, v1);
+        quad.tl.texCoords = Tex2F(u0, v0);
+        quad.tr.texCoords = Tex2F(u1, v0);
+
+        _glyphQuads.push_back(quad);
+
+        penX += fontDef.xAdvance + kerningAmount;
+        prev = c;
+    }
+    _glyphLineStarts.push_back(static_cast<int>(_glyphQuads.size()));
+
+    // the width of a line is the right of its last character
+    const int lineCount = static_cast<int>(_glyphLineStarts.size()) - 1;
+    float width = 0;
+    for (int line = 0; line < lineCount; ++line)
+    {
+        int last = _glyphLineStarts[line + 1] - 1;
+        if (last >= _glyphLineStarts[line])
+        {
+            width = MAX(width, _glyphQuads[last].br.vertices.x);
+        }
+    }
+    const float height = (float)(_configuration->_commonHeight * lineCount);
+
+    for (int line = 0; line < lineCount; ++line)
+    {
+        const int first = _glyphLineStarts[line];
+        const int last = _glyphLineStarts[line + 1];
+        if (first == last)
+        {
+            continue;
+        }
+
+        float shift = 0;
+        const float lineWidth = _glyphQuads[last - 1].br.vertices.x;
+        if (_alignment == Label::HAlignment::CENTER)
+        {
+            shift = width / 2 - lineWidth / 2;
+        }
+        else if (_alignment == Label::HAlignment::RIGHT)
+        {
+            shift = width - lineWidth;
+        }
+        const float lineTop = (float)(_configuration->_commonHeight * (lineCount - line));
+
+        for (int q = first; q < last; ++q)
+        {
+            V3F_C4B_T2F_Quad& quad = _glyphQuads[q];
+            quad.bl.vertices = Vertex3F((quad.bl.vertices.x + shift) / scaleFactor, (quad.bl.vertices.y + lineTop) / scaleFactor, 0);
+            quad.br.vertices = Vertex3F((quad.br.vertices.x + shift) / scaleFactor, (quad.br.vertices.y + lineTop) / scaleFactor, 0);
+            quad.tl.vertices = Vertex3F((quad.tl.vertices.x + shift) / scaleFactor, (quad.tl.vertices.y + lineTop) / scaleFactor, 0);
+            quad.tr.vertices = Vertex3F((quad.tr.vertices.x + shift) / scaleFactor, (quad.tr.vertices.y + lineTop) / scaleFactor, 0);
+        }
+    }
+
+    const int quadCount = static_cast<int>(_glyphQuads.size());
+    if (quadCount > _textureAtlas->getCapacity())
+    {
+        _textureAtlas->resizeCapacity(quadCount);
+    }
+    _textureAtlas->removeAllQuads();
+    for (int i = 0; i < quadCount; ++i)
+    {
+        _textureAtlas->updateQuad(&_glyphQuads[i], i);
+    }
+    this->updateGlyphQuadColors();
+
+    this->setContentSize(CC_SIZE_PIXELS_TO_POINTS(Size(width, height)));
+}
+
+void LabelBMFont::updateGlyphQuadColors()
+{
+    if (_letterSpritesEnabled)
+    {
+        return;
+    }
+
+    Color4B color4(_displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity);
+    if (_isOpacityModifyRGB)
+    {
+        color4.r *= _displayedOpacity/255.0f;
+        color4.g *= _displayedOpacity/255.0f;
+        color4.b *= _displayedOpacity/255.0f;
+    }
+
+    V3F_C4B_T2F_Quad* quads = _textureAtlas->getQuads();
+    const int quadCount = _textureAtlas->getTotalQuads();
+    for (int i = 0; i < quadCount; ++i)
+    {
+        quads[i].bl.colors = color4;
+        quads[i].br.colors = color4;
+        quads[i].tl.colors = color4;
+        quads[i].tr.colors = color4;
+    }
+    _textureAtlas->setDirty(true);
+}
+
 // LabelBMFont - FntFile
 void LabelBMFont::setFntFile(const char* fntFile)
 {
@@ -34,8 +34,8 @@ Use any of these editors to generate BMFonts:
 #define __CCBITMAP_FONT_ATLAS_H__
 
 #include "sprite_nodes/CCSpriteBatchNode.h"
-#include "support/data_support/uthash.h"
 #include <map>
+#include <set>
 #include <sstream>
 #include <iostream>
 #include <vector>
@@ -53,8 +53,6 @@ enum {
     kLabelAutomaticWidth = -1,
 };
 
-struct _FontDefHashElement;
-
 /**
 @struct ccBMFontDef
 BMFont definition
@@ -87,21 +85,6 @@ typedef struct _BMFontPadding {
     int bottom;
 } ccBMFontPadding;
 
-typedef struct _FontDefHashElement
-{
-	unsigned int	key;		// key. Font Unicode value
-	ccBMFontDef		fontDef;	// font definition
-	UT_hash_handle	hh;
-} tFontDefHashElement;
-
-// Equal function for targetSet.
-typedef struct _KerningHashElement
-{
-	int				key;		// key for the hash. 16-bit for 1st element, 16-bit for 2nd element
-	int				amount;
-	UT_hash_handle	hh;
-} tKerningHashElement;
-
 /** @brief CCBMFontConfiguration has parsed configuration of the the .fnt file
 @since v0.8
 */
@@ -109,44 +92,74 @@ class CC_DLL CCBMFontConfiguration : public Object
 {
     // XXX: Creating a public interface so that the bitmapFontArray[] is accessible
 public://@public
-    // BMFont definitions
-    tFontDefHashElement *_fontDefDictionary;
-
     //! FNTConfig: Common Height Should be signed (issue #1343)
     int _commonHeight;
     //! Padding
     ccBMFontPadding    _padding;
     //! atlas name
     std::string _atlasName;
-    //! values for kerning
-    tKerningHashElement *_kerningDictionary;
-    
-    // Character Set defines the letters that actually exist in the font
-    std::set<unsigned int> *_characterSet;
 public:
     CCBMFontConfiguration();
     virtual ~CCBMFontConfiguration();
     const char * description() const;
 
-    /** allocates a CCBMFontConfiguration with a FNT file */
+    /** allocates a CCBMFontConfiguration with a FNT file, in the text or the binary (version 3) format */
     static CCBMFontConfiguration * create(const char *FNTfile);
 
-    /** initializes a BitmapFontConfiguration with a FNT file */
+    /** initializes a BitmapFontConfiguration with a FNT file, in the text or the binary (version 3) format */
     bool initWithFNTfile(const char *FNTfile);
     
     inline const char* getAtlasName(){ return _atlasName.c_str(); }
     inline void setAtlasName(const char* atlasName) { _atlasName = atlasName; }
-    
+
+    /** Returns the definition of a character, or NULL if the font doesn't have it.
+     @since v3.0
+     */
+    const ccBMFontDef* getFontDef(unsigned int charID) const;
+
+    /** Returns the kerning, in pixels, between two characters.
+     @since v3.0
+     */
+    int getKerningAmount(unsigned short first, unsigned short second) const;
+
+    /** Returns the number of characters of the font.
+     @since v3.0
+     */
+    inline unsigned int getFontDefCount() const { return static_cast<unsigned int>(_fontDefs.size()); }
+
+    /** Returns the characters of the font. The set is built the first time it is requested: use getFontDef() to test a character. */
     std::set<unsigned int>* getCharacterSet() const;
 private:
-    std::set<unsigned int>* parseConfigFile(const char *controlFile);
-    void parseCharacterDefinition(std::string line, ccBMFontDef *characterDefinition);
-    void parseInfoArguments(std::string line);
-    void parseCommonArguments(std::string line);
-    void parseImageFileName(std::string line, const char *fntFile);
-    void parseKerningEntry(std::string line);
-    void purgeKerningDictionary();
-    void purgeFontDefDictionary();
+    bool parseConfigFile(const char *controlFile);
+    bool parseTextFile(const char* data, unsigned long size, const char *controlFile);
+    bool parseBinaryFile(const unsigned char* data, unsigned long size, const char *controlFile);
+    void parseCharacterDefinition(const char* line, const char* lineEnd, ccBMFontDef *characterDefinition);
+    void parseInfoArguments(const char* line, const char* lineEnd);
+    void parseCommonArguments(const char* line, const char* lineEnd);
+    void parseImageFileName(const char* line, const char* lineEnd, const char *fntFile);
+    void parseKerningEntry(const char* line, const char* lineEnd);
+    void addKerningEntry(unsigned int first, unsigned int second, int amount);
+    void buildFontDefIndex();
+    void buildKerningTable();
+
+    struct KerningEntry
+    {
+        // 16-bit for the first character, 16-bit for the second
+        unsigned int key;
+        int amount;
+    };
+
+    // definitions of the characters, in the order of the file
+    std::vector<ccBMFontDef> _fontDefs;
+    // open addressing table of the characters: index in _fontDefs + 1, 0 for the empty slots
+    std::vector<unsigned int> _fontDefIndex;
+    // open addressing table of the kerning pairs, the empty slots have the key KERNING_EMPTY_KEY
+    std::vector<KerningEntry> _kerningTable;
+    // the kerning pairs are added here while parsing, then hashed into _kerningTable
+    std::vector<KerningEntry> _kerningEntries;
+
+    // Character Set defines the letters that actually exist in the font
+    mutable std::set<unsigned int> *_characterSet;
 };
 
 /** @brief LabelBMFont is a subclass of SpriteBatchNode.
@@ -166,6 +179,10 @@ Limitations:
 - All inner characters are using an anchorPoint of (0.5f, 0.5f) and it is not recommend to change it
 because it might affect the rendering
 
+Unless CC_LABELBMFONT_LETTER_SPRITES is enabled, the characters are not Sprites: the label writes one quad per
+character into its TextureAtlas, and has no children. Call setLetterSpritesEnabled(true) to get one Sprite child
+per character, tagged by its index, for the features above.
+
 LabelBMFont implements the protocol LabelProtocol, like Label and LabelAtlas.
 LabelBMFont has the flexibility of Label, the speed of LabelAtlas and all the features of Sprite.
 If in doubt, use LabelBMFont instead of LabelAtlas / Label.
@@ -243,6 +260,14 @@ public:
 
     void setFntFile(const char* fntFile);
     const char* getFntFile();
+
+    /** Whether each character is a Sprite child, tagged by its index, that can be moved, rotated, scaled or tinted.
+     When disabled, the label writes one quad per character into its TextureAtlas and has no children:
+     laying out a string is linear and doesn't create any node. The default value is CC_LABELBMFONT_LETTER_SPRITES.
+     @since v3.0
+     */
+    void setLetterSpritesEnabled(bool enabled);
+    inline bool isLetterSpritesEnabled() const { return _letterSpritesEnabled; }
 #if CC_LABELBMFONT_DEBUG_DRAW
     virtual void draw();
 #endif // CC_LABELBMFONT_DEBUG_DRAW
@@ -251,6 +276,9 @@ private:
     int kerningAmountForFirst(unsigned short first, unsigned short second);
     float getLetterPosXLeft( Sprite* characterSprite );
     float getLetterPosXRight( Sprite* characterSprite );
+    /** lays out the quads of the characters when the letters are not sprites */
+    void updateGlyphQuads();
+    void updateGlyphQuadColors();
     
 protected:
     virtual void setString(unsigned short *newString, bool needUpdateLabel);
@@ -263,6 +291,10 @@ protected:
     // initial string without line breaks
     unsigned short* _initialString;
     std::string _initialStringUTF8;
+
+    // last UTF-8 string passed to setString and its UTF-16 form
+    std::string _utf16Source;
+    std::vector<unsigned short> _utf16Buffer;
     
     // alignment of all lines
     Label::HAlignment _alignment;
@@ -288,11 +320,20 @@ protected:
     /** conforms to RGBAProtocol protocol */
     bool        _isOpacityModifyRGB;
 
+    bool _letterSpritesEnabled;
+    // quads of the characters and first quad of each line, while laying them out
+    std::vector<V3F_C4B_T2F_Quad> _glyphQuads;
+    std::vector<int> _glyphLineStarts;
+
 };
 
 /** Free function that parses a FNT file a place it on the cache
 */
 CC_DLL CCBMFontConfiguration * FNTConfigLoadFile( const char *file );
+/** Free function that removes a FNT file from the cache. Its atlas texture stays in the TextureCache.
+ @since v3.0
+*/
+CC_DLL void FNTConfigRemoveFile( const char *file );
 /** Purges the FNT config cache
 */
 CC_DLL void FNTConfigRemoveCache( void );
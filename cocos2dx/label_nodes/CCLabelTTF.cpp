@@ -27,6 +27,10 @@ THE SOFTWARE.
 #include "shaders/CCGLProgram.h"
 #include "shaders/CCShaderCache.h"
 #include "CCApplication.h"
+#include "CCFontAtlas.h"
+#include "platform/CCImage.h"
+#include "renderer/CCRenderer.h"
+#include "kazmath/GL/matrix.h"
 
 NS_CC_BEGIN
 
@@ -48,12 +52,22 @@ LabelTTF::LabelTTF()
 , _shadowEnabled(false)
 , _strokeEnabled(false)
 , _textFillColor(Color3B::WHITE)
+, _fontAtlas(NULL)
+, _glyphShader(NULL)
+, _distanceFieldEnabled(false)
+, _glyphScale(1.0f)
+, _glyphEffectEnabled(false)
+, _glowEnabled(false)
+, _glowColor(Color3B::WHITE)
+, _glowSize(0)
 {
+    _glyphEffectCommand.func = std::bind(&LabelTTF::onDrawGlyphEffect, this);
 }
 
 LabelTTF::~LabelTTF()
 {
     CC_SAFE_DELETE(_fontName);
+    CC_SAFE_RELEASE(_fontAtlas);
 }
 
 LabelTTF * LabelTTF::create()
@@ -292,6 +306,11 @@ void LabelTTF::setFontName(const char *fontName)
 // Helper
 bool LabelTTF::updateTexture()
 {
+    if (this->updateGlyphQuads())
+    {
+        return true;
+    }
+
     Texture2D *tex;
     tex = new Texture2D();
     
@@ -328,6 +347,538 @@ bool LabelTTF::updateTexture()
     return true;
 }
 
+// decodes the UTF-8 character at p, and moves p to the next one
+static unsigned int nextCharCode(const char*& p)
+{
+    const unsigned char* c = reinterpret_cast<const unsigned char*>(p);
+    unsigned int code = c[0];
+    int length = 1;
+    if ((code & 0xE0) == 0xC0 && c[1])
+    {
+        code = ((code & 0x1F) << 6) | (c[1] & 0x3F);
+        length = 2;
+    }
+    else if ((code & 0xF0) == 0xE0 && c[1] && c[2])
+    {
+        code = ((code & 0x0F) << 12) | ((c[1] & 0x3F) << 6) | (c[2] & 0x3F);
+        length = 3;
+    }
+    else if ((code & 0xF8) == 0xF0 && c[1] && c[2] && c[3])
+    {
+        code = ((code & 0x07) << 18) | ((c[1] & 0x3F) << 12) | ((c[2] & 0x3F) << 6) | (c[3] & 0x3F);
+        length = 4;
+    }
+    p += length;
+    return code;
+}
+
+bool LabelTTF::updateGlyphQuads()
+{
+    FontAtlas* atlas = NULL;
+    if (! _batchNode)
+    {
+        if (_distanceFieldEnabled)
+        {
+            atlas = FontAtlasCache::getDistanceFieldFontAtlas(_fontName->c_str());
+        }
+        else
+        {
+            atlas = FontAtlasCache::getFontAtlas(_fontName->c_str(), (int)(_fontSize * CC_CONTENT_SCALE_FACTOR()));
+        }
+    }
+
+    if (atlas != _fontAtlas)
+    {
+        CC_SAFE_RETAIN(atlas);
+        CC_SAFE_RELEASE(_fontAtlas);
+        _fontAtlas = atlas;
+
+        // the texture of the string isn't used any more
+        if (_fontAtlas)
+        {
+            this->setTexture(NULL);
+        }
+    }
+
+    if (! _fontAtlas)
+    {
+        _glyphQuads.clear();
+        _glyphRanges.clear();
+        return false;
+    }
+
+    this->updateGlyphShader();
+
+    // the layout is done in pixels, the quads are scaled to points at the end.
+    // The glyphs of a distance field atlas are scaled from the size of the atlas to the size of the label
+    _glyphScale = _fontAtlas->isDistanceField() ? _fontSize * CC_CONTENT_SCALE_FACTOR() / _fontAtlas->getFontSize() : 1.0f;
+    const float glyphScale = _glyphScale;
+    const float maxWidth = _dimensions.width * CC_CONTENT_SCALE_FACTOR();
+    const float pageSize = CC_FONT_ATLAS_PAGE_SIZE;
+    const float lineHeight = _fontAtlas->getLineHeight() * glyphScale;
+
+    _glyphQuads.clear();
+    _glyphPages.clear();
+    _glyphLineStarts.clear();
+    _glyphLineStarts.push_back(0);
+
+    float penX = 0;
+    int line = 0;
+    // first quad and pen after the last space of the line, where it can be wrapped
+    int breakQuad = -1;
+    float breakPenX = 0;
+    const FontAtlas::Glyph* previous = NULL;
+
+    const char* p = _string.c_str();
+    while (*p)
+    {
+        unsigned int charCode = nextCharCode(p);
+        if (charCode == '\n')
+        {
+            _glyphLineStarts.push_back(static_cast<int>(_glyphQuads.size()));
+            ++line;
+            penX = 0;
+            breakQuad = -1;
+            previous = NULL;
+            continue;
+        }
+
+        const FontAtlas::Glyph* glyph = _fontAtlas->getGlyph(charCode);
+        if (! glyph)
+        {
+            continue;
+        }
+
+        penX += _fontAtlas->getKerning(previous, glyph) * glyphScale;
+        previous = glyph;
+
+        if (charCode == ' ' || charCode == '\t')
+        {
+            penX += glyph->advance * glyphScale;
+            breakQuad = static_cast<int>(_glyphQuads.size());
+            breakPenX = penX;
+            continue;
+        }
+
+        if (maxWidth > 0 && penX + (glyph->bearingX + glyph->rect.size.width) * glyphScale > maxWidth && penX > 0)
+        {
+            const int lineStart = _glyphLineStarts.back();
+            _glyphLineStarts.push_back(static_cast<int>(_glyphQuads.size()));
+            ++line;
+
+            if (breakQuad > lineStart)
+            {
+                // wrap the current word
+                _glyphLineStarts.back() = breakQuad;
+                for (size_t i = breakQuad; i < _glyphQuads.size(); ++i)
+                {
+                    V3F_C4B_T2F_Quad& quad = _glyphQuads[i];
+                    quad.bl.vertices.x -= breakPenX;
+                    quad.br.vertices.x -= breakPenX;
+                    quad.tl.vertices.x -= breakPenX;
+                    quad.tr.vertices.x -= breakPenX;
+                    quad.bl.vertices.y -= lineHeight;
+                    quad.br.vertices.y -= lineHeight;
+                    quad.tl.vertices.y -= lineHeight;
+                    quad.tr.vertices.y -= lineHeight;
+                }
+                penX -= breakPenX;
+            }
+            else
+            {
+                penX = 0;
+            }
+            breakQuad = -1;
+        }
+
+        if (glyph->page >= 0)
+        {
+            // y is relative to the top of the text for now
+            const float left = penX + glyph->bearingX * glyphScale;
+            const float top = -line * lineHeight + (glyph->bearingY - _fontAtlas->getAscender()) * glyphScale;
+            const float right = left + glyph->rect.size.width * glyphScale;
+            const float bottom = top - glyph->rect.size.height * glyphScale;
+
+            V3F_C4B_T2F_Quad quad;
+            quad.bl.vertices = Vertex3F(left, bottom, 0);
+            quad.br.vertices = Vertex3F(right, bottom, 0);
+            quad.tl.vertices = Vertex3F(left, top, 0);
+            quad.tr.vertices = Vertex3F(right, top, 0);
+
+            const float u0 = glyph->rect.origin.x / pageSize;
+            const float u1 = (glyph->rect.origin.x + glyph->rect.size.width) / pageSize;
+            const float v0 = glyph->rect.origin.y / pageSize;
+            const float v1 = (glyph->rect.origin.y + glyph->rect.size.height) / pageSize;
+            quad.bl.texCoords = Tex2F(u0, v1);
+            quad.br.texCoords = Tex2F(u1, v1);
+            quad.tl.texCoords = Tex2F(u0, v0);
+            quad.tr.texCoords = Tex2F(u1, v0);
+
+            _glyphQuads.push_back(quad);
+            _glyphPages.push_back(glyph->page);
+        }
+
+        penX += glyph->advance * glyphScale;
+    }
+    _glyphLineStarts.push_back(static_cast<int>(_glyphQuads.size()));
+
+    // the width of a line is the right of its last glyph
+    const int lineCount = static_cast<int>(_glyphLineStarts.size()) - 1;
+    float textWidth = 0;
+    for (int i = 0; i < lineCount; ++i)
+    {
+        for (int q = _glyphLineStarts[i]; q < _glyphLineStarts[i + 1]; ++q)
+        {
+            textWidth = MAX(textWidth, _glyphQuads[q].br.vertices.x);
+        }
+    }
+    const float textHeight = lineCount * lineHeight;
+
+    const float width = maxWidth > 0 ? maxWidth : textWidth;
+    const float height = _dimensions.height > 0 ? _dimensions.height * CC_CONTENT_SCALE_FACTOR() : textHeight;
+
+    float top = height;
+    if (_vAlignment == Label::VAlignment::CENTER)
+    {
+        top -= (height - textHeight) / 2;
+    }
+    else if (_vAlignment == Label::VAlignment::BOTTOM)
+    {
+        top -= height - textHeight;
+    }
+
+    const float scale = 1.0f / CC_CONTENT_SCALE_FACTOR();
+    for (int i = 0; i < lineCount; ++i)
+    {
+        const int first = _glyphLineStarts[i];
+        const int last = _glyphLineStarts[i + 1];
+
+        float lineWidth = 0;
+        for (int q = first; q < last; ++q)
+        {
+            lineWidth = MAX(lineWidth, _glyphQuads[q].br.vertices.x);
+        }
+
+        float left = 0;
+        if (_alignment == Label::HAlignment::CENTER)
+        {
+            left = (width - lineWidth) / 2;
+        }
+        else if (_alignment == Label::HAlignment::RIGHT)
+        {
+            left = width - lineWidth;
+        }
+
+        for (int q = first; q < last; ++q)
+        {
+            V3F_C4B_T2F_Quad& quad = _glyphQuads[q];
+            quad.bl.vertices = Vertex3F((quad.bl.vertices.x + left) * scale, (quad.bl.vertices.y + top) * scale, 0);
+            quad.br.vertices = Vertex3F((quad.br.vertices.x + left) * scale, (quad.br.vertices.y + top) * scale, 0);
+            quad.tl.vertices = Vertex3F((quad.tl.vertices.x + left) * scale, (quad.tl.vertices.y + top) * scale, 0);
+            quad.tr.vertices = Vertex3F((quad.tr.vertices.x + left) * scale, (quad.tr.vertices.y + top) * scale, 0);
+        }
+    }
+
+    // group the quads by page, most strings use a single page
+    _glyphRanges.clear();
+    const int quadCount = static_cast<int>(_glyphQuads.size());
+    bool singlePage = true;
+    for (int q = 1; q < quadCount && singlePage; ++q)
+    {
+        singlePage = (_glyphPages[q] == _glyphPages[0]);
+    }
+
+    if (singlePage)
+    {
+        if (quadCount > 0)
+        {
+            GlyphRange range = { _glyphPages[0], 0, quadCount };
+            _glyphRanges.push_back(range);
+        }
+    }
+    else
+    {
+        std::vector<V3F_C4B_T2F_Quad> sorted;
+        sorted.reserve(quadCount);
+        for (int page = 0; page < _fontAtlas->getPageCount(); ++page)
+        {
+            GlyphRange range = { page, static_cast<int>(sorted.size()), 0 };
+            for (int q = 0; q < quadCount; ++q)
+            {
+                if (_glyphPages[q] == page)
+                {
+                    sorted.push_back(_glyphQuads[q]);
+                }
+            }
+            range.count = static_cast<int>(sorted.size()) - range.first;
+            if (range.count > 0)
+            {
+                _glyphRanges.push_back(range);
+            }
+        }
+        _glyphQuads.swap(sorted);
+    }
+
+    if (_glyphCommands.size() < _glyphRanges.size())
+    {
+        _glyphCommands.resize(_glyphRanges.size());
+    }
+
+    this->updateGlyphColors();
+    this->setContentSize(Size(width * scale, height * scale));
+    return true;
+}
+
+Size LabelTTF::measureString(const char *string, const char *fontName, float fontSize, const Size& dimensions/* = Size::ZERO*/)
+{
+    const float scale = 1.0f / CC_CONTENT_SCALE_FACTOR();
+    const float maxWidth = dimensions.width * CC_CONTENT_SCALE_FACTOR();
+
+    FontAtlas* atlas = FontAtlasCache::getFontAtlas(fontName, (int)(fontSize * CC_CONTENT_SCALE_FACTOR()));
+    if (atlas)
+    {
+        // same line breaks as updateGlyphQuads(), the rights of the glyphs of the current line are kept for the wraps
+        const float lineHeight = atlas->getLineHeight();
+        static std::vector<float> s_rights;
+        s_rights.clear();
+
+        float textWidth = 0;
+        int lineCount = 1;
+        float penX = 0;
+        int breakGlyph = -1;
+        float breakPenX = 0;
+        const FontAtlas::Glyph* previous = NULL;
+
+        const char* p = string;
+        while (*p)
+        {
+            unsigned int charCode = nextCharCode(p);
+            if (charCode == '\n')
+            {
+                for (auto right : s_rights)
+                {
+                    textWidth = MAX(textWidth, right);
+                }
+                s_rights.clear();
+                ++lineCount;
+                penX = 0;
+                breakGlyph = -1;
+                previous = NULL;
+                continue;
+            }
+
+            const FontAtlas::Glyph* glyph = atlas->getGlyph(charCode);
+            if (! glyph)
+            {
+                continue;
+            }
+
+            penX += atlas->getKerning(previous, glyph);
+            previous = glyph;
+
+            if (charCode == ' ' || charCode == '\t')
+            {
+                penX += glyph->advance;
+                breakGlyph = static_cast<int>(s_rights.size());
+                breakPenX = penX;
+                continue;
+            }
+
+            if (maxWidth > 0 && penX + glyph->bearingX + glyph->rect.size.width > maxWidth && penX > 0)
+            {
+                ++lineCount;
+                const int wrapped = breakGlyph > 0 ? breakGlyph : static_cast<int>(s_rights.size());
+                for (int i = 0; i < wrapped; ++i)
+                {
+                    textWidth = MAX(textWidth, s_rights[i]);
+                }
+                s_rights.erase(s_rights.begin(), s_rights.begin() + wrapped);
+
+                if (breakGlyph > 0)
+                {
+                    // wrap the current word
+                    for (auto& right : s_rights)
+                    {
+                        right -= breakPenX;
+                    }
+                    penX -= breakPenX;
+                }
+                else
+                {
+                    penX = 0;
+                }
+                breakGlyph = -1;
+            }
+
+            if (glyph->page >= 0)
+            {
+                s_rights.push_back(penX + glyph->bearingX + glyph->rect.size.width);
+            }
+
+            penX += glyph->advance;
+        }
+        for (auto right : s_rights)
+        {
+            textWidth = MAX(textWidth, right);
+        }
+
+        const float width = maxWidth > 0 ? maxWidth : textWidth;
+        const float height = dimensions.height > 0 ? dimensions.height * CC_CONTENT_SCALE_FACTOR() : lineCount * lineHeight;
+        return Size(width * scale, height * scale);
+    }
+
+    Size pixels = CC_SIZE_POINTS_TO_PIXELS(dimensions);
+    int width = 0;
+    int height = 0;
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    if (! Image::getStringSize(string, (int)pixels.width, (int)pixels.height, fontName, (int)(fontSize * CC_CONTENT_SCALE_FACTOR()), &width, &height))
+    {
+        return Size::ZERO;
+    }
+#else
+    Image* image = new Image();
+    if (image->initWithString(string, (int)pixels.width, (int)pixels.height, Image::TextAlign::CENTER, fontName, (int)(fontSize * CC_CONTENT_SCALE_FACTOR())))
+    {
+        width = image->getWidth();
+        height = image->getHeight();
+    }
+    image->release();
+#endif
+
+    return Size(width * scale, height * scale);
+}
+
+void LabelTTF::updateGlyphColors()
+{
+    Color4B color4(_displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity);
+    for (auto& quad : _glyphQuads)
+    {
+        quad.bl.colors = color4;
+        quad.br.colors = color4;
+        quad.tl.colors = color4;
+        quad.tr.colors = color4;
+    }
+}
+
+void LabelTTF::draw()
+{
+    if (! _fontAtlas)
+    {
+        Sprite::draw();
+        return;
+    }
+
+    if (_glyphRanges.empty())
+    {
+        return;
+    }
+
+    // the quads are drawn by the Renderer when it is flushed, batched with the labels using the same pages
+    kmMat4 mv;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
+
+    Renderer* renderer = Director::getInstance()->getRenderer();
+    if (_glyphEffectEnabled)
+    {
+        // the uniforms of the effect are set before the quads are drawn, which ends the batch of the previous labels
+        _glyphEffectCommand.init(mv);
+        renderer->addCommand(&_glyphEffectCommand);
+    }
+
+    for (size_t i = 0; i < _glyphRanges.size(); ++i)
+    {
+        const GlyphRange& range = _glyphRanges[i];
+        _glyphCommands[i].init(_fontAtlas->getPageTexture(range.page)->getName(), _glyphShader, BlendFunc::ALPHA_NON_PREMULTIPLIED,
+                               &_glyphQuads[range.first], range.count, mv);
+        renderer->addCommand(&_glyphCommands[i]);
+    }
+}
+
+void LabelTTF::updateGlyphShader()
+{
+    _glyphEffectEnabled = false;
+
+    const char* shaderName = GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR;
+    if (_fontAtlas && _fontAtlas->isDistanceField())
+    {
+        _glyphEffectEnabled = (_strokeEnabled && _strokeSize > 0) || (_glowEnabled && _glowSize > 0);
+        shaderName = _glyphEffectEnabled ? GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_EFFECT : GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD;
+    }
+    _glyphShader = ShaderCache::getInstance()->programForKey(shaderName);
+}
+
+void LabelTTF::onDrawGlyphEffect()
+{
+    if (! _fontAtlas)
+    {
+        return;
+    }
+
+    // the outline wins over the glow
+    const bool glow = ! (_strokeEnabled && _strokeSize > 0);
+    const Color3B& color = glow ? _glowColor : _strokeColor;
+    const float size = glow ? _glowSize : _strokeSize;
+
+    // from points to the distances stored in the atlas, where the spread maps to 0.5.
+    // The effect can't go further than the spread
+    const float spread = (float)_fontAtlas->getDistanceFieldSpread();
+    const float width = MIN(size * CC_CONTENT_SCALE_FACTOR() / _glyphScale / (2.0f * spread), 0.49f);
+
+    _glyphShader->use();
+    _glyphShader->setUniformLocationWith4f(_glyphShader->getUniformLocationForName("u_effectColor"),
+                                           color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, 1.0f);
+    _glyphShader->setUniformLocationWith1f(_glyphShader->getUniformLocationForName("u_effectWidth"), width);
+    _glyphShader->setUniformLocationWith1f(_glyphShader->getUniformLocationForName("u_effectGlow"), glow ? 1.0f : 0.0f);
+}
+
+void LabelTTF::setDistanceFieldEnabled(bool enabled)
+{
+    if (_distanceFieldEnabled != enabled)
+    {
+        _distanceFieldEnabled = enabled;
+        this->updateTexture();
+    }
+}
+
+void LabelTTF::enableGlow(const Color3B &glowColor, float glowSize)
+{
+    _glowEnabled = true;
+    _glowColor = glowColor;
+    _glowSize = glowSize;
+    this->updateGlyphShader();
+}
+
+void LabelTTF::disableGlow()
+{
+    _glowEnabled = false;
+    this->updateGlyphShader();
+}
+
+void LabelTTF::setColor(const Color3B& color3)
+{
+    Sprite::setColor(color3);
+    this->updateGlyphColors();
+}
+
+void LabelTTF::updateDisplayedColor(const Color3B& parentColor)
+{
+    Sprite::updateDisplayedColor(parentColor);
+    this->updateGlyphColors();
+}
+
+void LabelTTF::setOpacity(GLubyte opacity)
+{
+    Sprite::setOpacity(opacity);
+    this->updateGlyphColors();
+}
+
+void LabelTTF::updateDisplayedOpacity(GLubyte parentOpacity)
+{
+    Sprite::updateDisplayedOpacity(parentOpacity);
+    this->updateGlyphColors();
+}
+
 void LabelTTF::enableShadow(const Size &shadowOffset, float shadowOpacity, float shadowBlur, bool updateTexture)
 {
     #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
@@ -392,6 +943,16 @@ void LabelTTF::disableShadow(bool updateTexture)
 
 void LabelTTF::enableStroke(const Color3B &strokeColor, float strokeSize, bool updateTexture)
 {
+    if (_fontAtlas && _fontAtlas->isDistanceField())
+    {
+        // the outline is drawn by the shader, the quads don't change
+        _strokeEnabled = true;
+        _strokeColor = strokeColor;
+        _strokeSize = strokeSize;
+        this->updateGlyphShader();
+        return;
+    }
+
     #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
     
         bool valueChanged = false;
@@ -427,6 +988,13 @@ void LabelTTF::enableStroke(const Color3B &strokeColor, float strokeSize, bool u
 
 void LabelTTF::disableStroke(bool updateTexture)
 {
+    if (_fontAtlas && _fontAtlas->isDistanceField())
+    {
+        _strokeEnabled = false;
+        this->updateGlyphShader();
+        return;
+    }
+
     #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
     
         if (_strokeEnabled)
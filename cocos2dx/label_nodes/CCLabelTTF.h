@@ -27,9 +27,14 @@ THE SOFTWARE.
 
 #include "sprite_nodes/CCSprite.h"
 #include "textures/CCTexture2D.h"
+#include "renderer/CCQuadCommand.h"
+#include "renderer/CCCustomCommand.h"
+#include <vector>
 
 NS_CC_BEGIN
 
+class FontAtlas;
+
 /**
  * @addtogroup GUI
  * @{
@@ -45,6 +50,10 @@ NS_CC_BEGIN
  *
  * LabelTTF objects are slow. Consider using LabelAtlas or LabelBMFont instead.
  *
+ * When CC_USE_FONT_ATLAS is enabled and the font can be loaded by FreeType, the string is drawn with quads
+ * referencing the glyphs of a FontAtlas shared by the labels with the same font and size: changing the string
+ * only lays out the quads. getTexture() doesn't return the rendered string in that case.
+ *
  * Custom ttf file can be put in assets/ or external storage that the Application can access.
  * @code
  * LabelTTF *label1 = LabelTTF::create("alignment left", "A Damn Mess", fontSize, blockSize, 
@@ -82,6 +91,14 @@ public:
     
     /** Create a lable with string and a font definition*/
     static LabelTTF * createWithFontDefinition(const char *string, FontDefinition &textDefinition);
+
+    /** Returns the content size, in points, of a LabelTTF created with these parameters, without creating a texture.
+     The glyphs of a FontAtlas are measured with their metrics, and Linux lays the string out with FreeType
+     without rendering it. The other platforms render the string in memory, without uploading it.
+     Meant for layouts that fit text in a box, and try several font sizes.
+     @since v3.0
+     */
+    static Size measureString(const char *string, const char *fontName, float fontSize, const Size& dimensions = Size::ZERO);
     
     /** initializes the LabelTTF with a font name and font size */
     bool initWithString(const char *string, const char *fontName, float fontSize);
@@ -112,7 +129,9 @@ public:
     /** disable shadow rendering */
     void disableShadow(bool mustUpdateTexture = true);
     
-    /** enable or disable stroke */
+    /** enable or disable stroke.
+     With a distance field, the stroke is an outline drawn by the shader, on all the platforms.
+     */
     void enableStroke(const Color3B &strokeColor, float strokeSize, bool mustUpdateTexture = true);
     
     /** disable stroke */
@@ -121,6 +140,19 @@ public:
     /** set text tinting */
     void setFontFillColor(const Color3B &tintColor, bool mustUpdateTexture = true);
 
+    /** Draws the string with the glyphs of a distance field FontAtlas: one atlas serves all the sizes of the font,
+     and the stroke and the glow are drawn by the shader. Only used when the label is drawn with a FontAtlas.
+     @since v3.0
+     */
+    void setDistanceFieldEnabled(bool enabled);
+    inline bool isDistanceFieldEnabled() const { return _distanceFieldEnabled; }
+
+    /** Adds a glow of glowSize points around the glyphs. Only drawn with a distance field.
+     @since v3.0
+     */
+    void enableGlow(const Color3B &glowColor, float glowSize);
+    void disableGlow();
+
     
     
     /** initializes the LabelTTF */
@@ -150,9 +182,23 @@ public:
     
     const char* getFontName() const;
     void setFontName(const char *fontName);
+
+    // Overrides
+    virtual void draw(void) override;
+    virtual void setColor(const Color3B& color3) override;
+    virtual void updateDisplayedColor(const Color3B& parentColor) override;
+    virtual void setOpacity(GLubyte opacity) override;
+    virtual void updateDisplayedOpacity(GLubyte parentOpacity) override;
     
 private:
     bool updateTexture();
+    /** lays out the glyph quads of the string. Returns false if the font has no atlas */
+    bool updateGlyphQuads();
+    void updateGlyphColors();
+    /** picks the shader of the glyphs, and the effect drawn with a distance field */
+    void updateGlyphShader();
+    /** sets the uniforms of the outline or of the glow */
+    void onDrawGlyphEffect();
 protected:
     
     /** set the text definition for this label */
@@ -187,7 +233,34 @@ protected:
     /** font tint */
     Color3B   _textFillColor;
 
-    
+    /** quads of the pages of the atlas, drawn by one command each */
+    struct GlyphRange
+    {
+        int page;
+        int first;
+        int count;
+    };
+
+    /** atlas of the glyphs, NULL when the string is rendered into a texture */
+    FontAtlas* _fontAtlas;
+    GLProgram* _glyphShader;
+    std::vector<V3F_C4B_T2F_Quad> _glyphQuads;
+    /** page of each quad, and first quad of each line, while laying out the string */
+    std::vector<int> _glyphPages;
+    std::vector<int> _glyphLineStarts;
+    std::vector<GlyphRange> _glyphRanges;
+    std::vector<QuadCommand> _glyphCommands;
+
+    /** distance field glyphs, scaled from the size of the atlas to the size of the label */
+    bool _distanceFieldEnabled;
+    float _glyphScale;
+    bool _glyphEffectEnabled;
+    CustomCommand _glyphEffectCommand;
+
+    /** glow, drawn with a distance field */
+    bool _glowEnabled;
+    Color3B _glowColor;
+    float _glowSize;
 };
 
 
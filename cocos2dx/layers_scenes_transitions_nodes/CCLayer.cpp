@@ -38,6 +38,9 @@ THE SOFTWARE.
 // extern
 #include "kazmath/GL/matrix.h"
 #include "keyboard_dispatcher/CCKeyboardDispatcher.h"
+#include "event_dispatcher/CCEventDispatcher.h"
+#include "textures/CCTextureCache.h"
+#include "renderer/CCRenderer.h"
 
 NS_CC_BEGIN
 
@@ -50,6 +53,7 @@ Layer::Layer()
 , _touchPriority(0)
 , _touchMode(Touch::DispatchMode::ALL_AT_ONCE)
 , _swallowsTouches(true)
+, _accelerationListener(NULL)
 {
     _ignoreAnchorPointForPosition = true;
     setAnchorPoint(Point(0.5f, 0.5f));
@@ -57,7 +61,7 @@ Layer::Layer()
 
 Layer::~Layer()
 {
-
+    CC_SAFE_RELEASE(_accelerationListener);
 }
 
 bool Layer::init()
@@ -230,14 +234,13 @@ void Layer::setAccelerometerEnabled(bool enabled)
 
         if (_running)
         {
-            Director* pDirector = Director::getInstance();
             if (enabled)
             {
-                pDirector->getAccelerometer()->setDelegate(CC_CALLBACK_1(Layer::didAccelerate, this));
+                _eventDispatcher->addEventListenerWithSceneGraphPriority(getAccelerationListener(), this);
             }
             else
             {
-                pDirector->getAccelerometer()->setDelegate(nullptr);
+                _eventDispatcher->removeEventListener(_accelerationListener);
             }
         }
     }
@@ -256,6 +259,19 @@ void Layer::setAccelerometerInterval(double interval) {
 }
 
 
+EventListener* Layer::getAccelerationListener()
+{
+    if (! _accelerationListener)
+    {
+        _accelerationListener = EventListener::create(Event::Type::ACCELERATION, [this](Event* event) {
+            Acceleration acceleration = static_cast<EventAcceleration*>(event)->getAcceleration();
+            this->didAccelerate(&acceleration);
+        });
+        _accelerationListener->retain();
+    }
+    return _accelerationListener;
+}
+
 void Layer::didAccelerate(Acceleration* pAccelerationValue)
 {
     CC_UNUSED_PARAM(pAccelerationValue);
@@ -358,7 +374,7 @@ void Layer::onEnter()
     // add this layer to concern the Accelerometer Sensor
     if (_accelerometerEnabled)
     {
-        pDirector->getAccelerometer()->setDelegate(CC_CALLBACK_1(Layer::didAccelerate, this));
+        _eventDispatcher->addEventListenerWithSceneGraphPriority(getAccelerationListener(), this);
     }
 
     // add this layer to concern the keypad msg
@@ -379,7 +395,7 @@ void Layer::onExit()
     // remove this layer from the delegates who concern Accelerometer Sensor
     if (_accelerometerEnabled)
     {
-		pDirector->getAccelerometer()->setDelegate(nullptr);
+        _eventDispatcher->removeEventListener(_accelerationListener);
     }
 
     // remove this layer from the delegates who concern the keypad msg
@@ -393,12 +409,6 @@ void Layer::onExit()
 
 void Layer::onEnterTransitionDidFinish()
 {
-    if (_accelerometerEnabled)
-    {
-        Director* pDirector = Director::getInstance();
-        pDirector->getAccelerometer()->setDelegate(CC_CALLBACK_1(Layer::didAccelerate, this));
-    }
-    
     Node::onEnterTransitionDidFinish();
 }
 
@@ -588,10 +598,9 @@ void LayerRGBA::updateDisplayedOpacity(GLubyte parentOpacity)
     
     if (_cascadeOpacityEnabled)
     {
-        Object *obj = NULL;
-        CCARRAY_FOREACH(_children, obj)
+        for (auto child : _children)
         {
-            RGBAProtocol *item = dynamic_cast<RGBAProtocol*>(obj);
+            RGBAProtocol *item = dynamic_cast<RGBAProtocol*>(child);
             if (item)
             {
                 item->updateDisplayedOpacity(_displayedOpacity);
@@ -608,10 +617,9 @@ void LayerRGBA::updateDisplayedColor(const Color3B& parentColor)
     
     if (_cascadeColorEnabled)
     {
-        Object *obj = NULL;
-        CCARRAY_FOREACH(_children, obj)
+        for (auto child : _children)
         {
-            RGBAProtocol *item = dynamic_cast<RGBAProtocol*>(obj);
+            RGBAProtocol *item = dynamic_cast<RGBAProtocol*>(child);
             if (item)
             {
                 item->updateDisplayedColor(_displayedColor);
@@ -729,7 +737,7 @@ bool LayerColor::initWithColor(const Color4B& color, GLfloat w, GLfloat h)
         updateColor();
         setContentSize(Size(w, h));
 
-        setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_COLOR));
+        setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR));
         return true;
     }
     return false;
@@ -781,29 +789,39 @@ void LayerColor::updateColor()
 
 void LayerColor::draw()
 {
-    CC_NODE_DRAW_SETUP();
-
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POSITION | GL::VERTEX_ATTRIB_FLAG_COLOR );
-
-    //
-    // Attributes
-    //
-#ifdef EMSCRIPTEN
-    setGLBufferData(_squareVertices, 4 * sizeof(Vertex2F), 0);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    Texture2D* texture = TextureCache::getInstance()->getWhiteTexture();
+    if (!texture)
+    {
+        return;
+    }
 
-    setGLBufferData(_squareColors, 4 * sizeof(Color4F), 1);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, 0, 0);
-#else
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, _squareVertices);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, 0, _squareColors);
-#endif // EMSCRIPTEN
+    // the quad is drawn by the Renderer when it is flushed, with premultiplied colors when possible
+    // so that it shares the blending function of the sprites
+    BlendFunc blendFunc = _blendFunc;
+    bool premultiply = (blendFunc.src == BlendFunc::ALPHA_NON_PREMULTIPLIED.src && blendFunc.dst == BlendFunc::ALPHA_NON_PREMULTIPLIED.dst);
+    if (premultiply)
+    {
+        blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+    }
 
-    GL::blendFunc( _blendFunc.src, _blendFunc.dst );
+    // _squareVertices are in triangle strip order: bottom left, bottom right, top left, top right
+    V3F_C4B_T2F* corners[4] = { &_quad.bl, &_quad.br, &_quad.tl, &_quad.tr };
+    for (int i = 0; i < 4; i++)
+    {
+        const Color4F& color = _squareColors[i];
+        float multiplier = premultiply ? color.a : 1.0f;
+        corners[i]->vertices = Vertex3F(_squareVertices[i].x, _squareVertices[i].y, 0);
+        corners[i]->colors = Color4B((GLubyte)(color.r * multiplier * 255), (GLubyte)(color.g * multiplier * 255),
+                                     (GLubyte)(color.b * multiplier * 255), (GLubyte)(color.a * 255));
+        // the center of the texture, away from its edges
+        corners[i]->texCoords = Tex2F(0.5f, 0.5f);
+    }
 
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    kmMat4 mv;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
 
-    CC_INCREMENT_GL_DRAWS(1);
+    _quadCommand.init(texture->getName(), _shaderProgram, blendFunc, &_quad, 1, mv);
+    Director::getInstance()->getRenderer()->addCommand(&_quadCommand);
 }
 
 void LayerColor::setColor(const Color3B &color)
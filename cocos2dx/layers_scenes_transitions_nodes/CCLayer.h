@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "platform/CCAccelerometerDelegate.h"
 #include "keypad_dispatcher/CCKeypadDelegate.h"
 #include "cocoa/CCArray.h"
+#include "renderer/CCQuadCommand.h"
 #ifdef EMSCRIPTEN
 #include "base_nodes/CCGLBufferedNode.h"
 #endif // EMSCRIPTEN
@@ -45,6 +46,7 @@ NS_CC_BEGIN
  */
 
 class TouchScriptHandlerEntry;
+class EventListener;
 
 //
 // Layer
@@ -149,7 +151,9 @@ private:
     int _touchPriority;
     Touch::DispatchMode _touchMode;
     bool _swallowsTouches;
+    EventListener* _accelerationListener;
     
+    EventListener* getAccelerationListener();
     int executeScriptTouchHandler(int eventType, Touch* touch);
     int executeScriptTouchesHandler(int eventType, Set* touches);
 };
@@ -209,6 +213,9 @@ protected:
 All features from Layer are valid, plus the following new features:
 - opacity
 - RGB colors
+
+The layer is drawn as a quad of the white texture of the TextureCache, so it is batched with the
+sprites without texture and the other color layers.
 */
 class CC_DLL LayerColor : public LayerRGBA, public BlendProtocol
 #ifdef EMSCRIPTEN
@@ -258,6 +265,9 @@ protected:
     BlendFunc _blendFunc;
     Vertex2F _squareVertices[4];
     Color4F  _squareColors[4];
+
+    V3F_C4B_T2F_Quad _quad;
+    QuadCommand _quadCommand;
 };
 
 //
@@ -26,10 +26,16 @@ THE SOFTWARE.
 
 #include "CCScene.h"
 #include "CCDirector.h"
+#include "CCCamera2D.h"
+#include "renderer/CCRenderer.h"
+#include "textures/CCTextureCache.h"
+#include "kazmath/GL/matrix.h"
 
 NS_CC_BEGIN
 
 Scene::Scene()
+: _camera2D(NULL)
+, _hibernated(false)
 {
     _ignoreAnchorPointForPosition = true;
     setAnchorPoint(Point(0.5f, 0.5f));
@@ -37,6 +43,11 @@ Scene::Scene()
 
 Scene::~Scene()
 {
+    CC_SAFE_RELEASE(_camera2D);
+    for (auto texture : _hibernatedTextures)
+    {
+        texture->release();
+    }
 }
 
 bool Scene::init()
@@ -68,4 +79,83 @@ Scene *Scene::create()
     }
 }
 
+void Scene::hibernate(bool keepPixels/* = false*/)
+{
+    if (_hibernated)
+    {
+        return;
+    }
+
+    std::set<Texture2D*> textures;
+    TextureCache::collectTextures(this, textures);
+
+    // the textures shared with the running scene stay
+    Scene* runningScene = Director::getInstance()->getRunningScene();
+    if (runningScene && runningScene != this)
+    {
+        std::set<Texture2D*> runningTextures;
+        TextureCache::collectTextures(runningScene, runningTextures);
+        for (auto texture : runningTextures)
+        {
+            textures.erase(texture);
+        }
+    }
+
+    _hibernatedTextures = TextureCache::getInstance()->hibernateTextures(textures, keepPixels);
+    for (auto texture : _hibernatedTextures)
+    {
+        texture->retain();
+    }
+    _hibernated = true;
+}
+
+void Scene::wake(const std::function<void()>& callback)
+{
+    _hibernated = false;
+
+    // the textures are only needed until the requests are made, the TextureCache keeps the ones it reloads
+    std::vector<Texture2D*> textures;
+    textures.swap(_hibernatedTextures);
+    TextureCache::getInstance()->wakeTextures(textures, callback);
+    for (auto texture : textures)
+    {
+        texture->release();
+    }
+}
+
+Camera2D* Scene::getCamera2D()
+{
+    if (!_camera2D)
+    {
+        _camera2D = new Camera2D();
+    }
+    return _camera2D;
+}
+
+void Scene::visit()
+{
+    if (!_camera2D || !_visible || _camera2D->isIdentity())
+    {
+        Node::visit();
+        return;
+    }
+
+    // The camera is multiplied into the projection, so the cached model-view matrices of the nodes stay valid.
+    // The Renderer reads the projection when it flushes: the commands of the scene are flushed with the camera.
+    Renderer* renderer = Director::getInstance()->getRenderer();
+    renderer->flush();
+
+    kmGLMatrixMode(KM_GL_PROJECTION);
+    kmGLPushMatrix();
+    kmGLMultMatrix(&_camera2D->getViewMatrix());
+    kmGLMatrixMode(KM_GL_MODELVIEW);
+
+    Node::visit();
+    renderer->flush();
+
+    kmGLMatrixMode(KM_GL_PROJECTION);
+    kmGLPopMatrix();
+    kmGLMatrixMode(KM_GL_MODELVIEW);
+}
+
 NS_CC_END
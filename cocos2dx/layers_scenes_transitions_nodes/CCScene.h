@@ -28,9 +28,14 @@ THE SOFTWARE.
 #define __CCSCENE_H__
 
 #include "base_nodes/CCNode.h"
+#include <functional>
+#include <vector>
 
 NS_CC_BEGIN
 
+class Camera2D;
+class Texture2D;
+
 /**
  * @addtogroup scene
  * @{
@@ -57,6 +62,39 @@ public:
     
     bool init();
 
+    /** returns the 2D camera of the scene, created on first use.
+     It is applied once to the whole scene, instead of moving a root layer.
+     @since v3.0
+     */
+    Camera2D* getCamera2D();
+
+    virtual void visit() override;
+
+    /** Releases the video memory of the textures of the scene that the running scene doesn't use, keeping the
+     Texture2D objects, see TextureCache::hibernateTextures(). The Director calls it for the scenes of its stack
+     when scene hibernation is enabled. A texture used before the scene is woken up is reloaded immediately.
+     @param keepPixels whether the textures that aren't loaded from a file, like the ones of the labels and the
+     render textures, are read back into memory to release their video memory too
+     @since v3.0
+     */
+    void hibernate(bool keepPixels = false);
+
+    /** Reloads the textures released by hibernate(), asynchronously for the ones loaded from a file.
+     @param callback called once all the textures are back. Can be nullptr
+     @since v3.0
+     */
+    void wake(const std::function<void()>& callback);
+
+    /** Whether hibernate() was called and wake() wasn't since
+     @since v3.0
+     */
+    inline bool isHibernated() const { return _hibernated; }
+
+protected:
+    Camera2D* _camera2D;
+    // the hibernated textures, retained
+    std::vector<Texture2D*> _hibernatedTextures;
+    bool _hibernated;
 };
 
 // end of scene group
@@ -36,21 +36,40 @@ THE SOFTWARE.
 #include "actions/CCActionGrid.h"
 #include "CCLayer.h"
 #include "misc_nodes/CCRenderTexture.h"
+#include "effects/CCGrid.h"
+#include "CCScheduler.h"
+#include "kazmath/GL/matrix.h"
 
 
 NS_CC_BEGIN
 
 const unsigned int kSceneFade = 0xFADEFADE;
 
+bool TransitionScene::s_defaultSnapshotEnabled = false;
+
 TransitionScene::TransitionScene()
+: _snapshotEnabled(s_defaultSnapshotEnabled)
+, _inSnapshot(NULL)
+, _outSnapshot(NULL)
 {
 }
 TransitionScene::~TransitionScene()
 {
+    releaseSnapshots();
     _inScene->release();
     _outScene->release();
 }
 
+void TransitionScene::setDefaultSnapshotEnabled(bool enabled)
+{
+    s_defaultSnapshotEnabled = enabled;
+}
+
+bool TransitionScene::isDefaultSnapshotEnabled()
+{
+    return s_defaultSnapshotEnabled;
+}
+
 TransitionScene * TransitionScene::create(float t, Scene *scene)
 {
     TransitionScene * pScene = new TransitionScene();
@@ -104,12 +123,111 @@ void TransitionScene::draw()
     Scene::draw();
 
     if( _isInSceneOnTop ) {
-        _outScene->visit();
-        _inScene->visit();
+        visitScene(_outScene);
+        visitScene(_inScene);
     } else {
-        _inScene->visit();
-        _outScene->visit();
+        visitScene(_inScene);
+        visitScene(_outScene);
+    }
+}
+
+void TransitionScene::visitScene(Scene* scene)
+{
+    RenderTexture* snapshot = (scene == _inScene) ? _inSnapshot : _outSnapshot;
+    if (! snapshot)
+    {
+        scene->visit();
+        return;
+    }
+
+    if (! scene->isVisible())
+    {
+        return;
+    }
+
+    // same as Node::visit(), with the snapshot instead of the children
+    kmGLPushMatrix();
+
+    GridBase* grid = scene->getGrid();
+    if (grid && grid->isActive())
+    {
+        grid->beforeDraw();
     }
+
+    scene->transform();
+    snapshot->getSprite()->visit();
+
+    if (grid && grid->isActive())
+    {
+        grid->afterDraw(scene);
+    }
+
+    kmGLPopMatrix();
+}
+
+void TransitionScene::takeSnapshots()
+{
+    Size size = Director::getInstance()->getWinSize();
+    Scene* scenes[] = { _inScene, _outScene };
+    RenderTexture** snapshots[] = { &_inSnapshot, &_outSnapshot };
+
+    for (int i = 0; i < 2; ++i)
+    {
+        RenderTexture* snapshot = RenderTexture::createTransient((int)size.width, (int)size.height);
+        if (! snapshot)
+        {
+            // the scenes are visited instead
+            releaseSnapshots();
+            return;
+        }
+        snapshot->retain();
+        snapshot->getSprite()->setAnchorPoint(Point(0, 0));
+        snapshot->getSprite()->setPosition(Point(0, 0));
+
+        // the scene is rendered without the transform the transition may have given to it already
+        Scene* scene = scenes[i];
+        bool visible = scene->isVisible();
+        scene->setVisible(true);
+        snapshot->beginWithClear(0, 0, 0, 0);
+        scene->visit();
+        snapshot->end();
+        scene->setVisible(visible);
+
+        *snapshots[i] = snapshot;
+    }
+
+    pauseChildren(_inScene);
+    pauseChildren(_outScene);
+}
+
+void TransitionScene::pauseChildren(Node* node)
+{
+    Scheduler* scheduler = Director::getInstance()->getScheduler();
+    for (auto child : node->getChildren())
+    {
+        // the nodes paused already are left paused
+        if (! scheduler->isTargetPaused(child))
+        {
+            child->pauseSchedulerAndActions();
+            _pausedNodes.pushBack(child);
+        }
+        pauseChildren(child);
+    }
+}
+
+void TransitionScene::releaseSnapshots()
+{
+    for (auto node : _pausedNodes)
+    {
+        if (node->isRunning())
+        {
+            node->resumeSchedulerAndActions();
+        }
+    }
+    _pausedNodes.clear();
+
+    CC_SAFE_RELEASE_NULL(_inSnapshot);
+    CC_SAFE_RELEASE_NULL(_outSnapshot);
 }
 
 void TransitionScene::finish()
@@ -168,12 +286,19 @@ void TransitionScene::onEnter()
     _outScene->onExitTransitionDidStart();
     
     _inScene->onEnter();
+
+    if (_snapshotEnabled)
+    {
+        takeSnapshots();
+    }
 }
 
 // custom onExit
 void TransitionScene::onExit()
 {
     Scene::onExit();
+
+    releaseSnapshots();
     
     // enable events while transitions
     Director::getInstance()->getTouchDispatcher()->setDispatchEvents(true);
@@ -1275,7 +1400,7 @@ void TransitionCrossFade::onEnter()
     LayerColor* layer = LayerColor::create(color);
 
     // create the first render texture for inScene
-    RenderTexture* inTexture = RenderTexture::create((int)size.width, (int)size.height);
+    RenderTexture* inTexture = RenderTexture::createTransient((int)size.width, (int)size.height);
 
     if (NULL == inTexture)
     {
@@ -1288,18 +1413,18 @@ void TransitionCrossFade::onEnter()
 
     // render inScene to its texturebuffer
     inTexture->begin();
-    _inScene->visit();
+    visitScene(_inScene);
     inTexture->end();
 
     // create the second render texture for outScene
-    RenderTexture* outTexture = RenderTexture::create((int)size.width, (int)size.height);
+    RenderTexture* outTexture = RenderTexture::createTransient((int)size.width, (int)size.height);
     outTexture->getSprite()->setAnchorPoint( Point(0.5f,0.5f) );
     outTexture->setPosition( Point(size.width/2, size.height/2) );
     outTexture->setAnchorPoint( Point(0.5f,0.5f) );
 
     // render outScene to its texturebuffer
     outTexture->begin();
-    _outScene->visit();
+    visitScene(_outScene);
     outTexture->end();
 
     // create blend functions
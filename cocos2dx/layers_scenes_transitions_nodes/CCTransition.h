@@ -43,6 +43,7 @@ NS_CC_BEGIN
 
 class ActionInterval;
 class Node;
+class RenderTexture;
 
 /** @brief TransitionEaseScene can ease the actions of the scene protocol.
 @since v0.8.2
@@ -90,6 +91,20 @@ public:
     /** used by some transitions to hide the outer scene */
     void hideOutShowIn(void);
 
+    /** Whether or not both scenes are rendered once into textures when the transition starts.
+     The transition then moves the textures instead of the scenes, and the nodes of both scenes are paused until it ends,
+     so they are neither updated nor drawn meanwhile. Must be set before the transition is run.
+     @since v3.0
+     */
+    inline void setSnapshotEnabled(bool enabled) { _snapshotEnabled = enabled; }
+    inline bool isSnapshotEnabled() const { return _snapshotEnabled; }
+
+    /** Sets the snapshot mode of the transitions created afterwards. Disabled by default.
+     @since v3.0
+     */
+    static void setDefaultSnapshotEnabled(bool enabled);
+    static bool isDefaultSnapshotEnabled();
+
     //
     // Overrides
     //
@@ -101,8 +116,16 @@ public:
 protected:
     virtual void sceneOrder();
 
+    /** visits the scene, or draws its snapshot with the transform and the grid of the scene */
+    void visitScene(Scene* scene);
+
 private:
     void setNewScene(float dt);
+    /** renders the scenes into their snapshots and pauses their nodes */
+    void takeSnapshots();
+    /** resumes the nodes of the scenes and releases the snapshots */
+    void releaseSnapshots();
+    void pauseChildren(Node* node);
 
 protected:
     Scene    * _inScene;
@@ -110,6 +133,14 @@ protected:
     float    _duration;
     bool    _isInSceneOnTop;
     bool    _isSendCleanupToScene;
+
+    bool _snapshotEnabled;
+    RenderTexture* _inSnapshot;
+    RenderTexture* _outSnapshot;
+    // the nodes paused by takeSnapshots()
+    Vector<Node*> _pausedNodes;
+
+    static bool s_defaultSnapshotEnabled;
 };
 
 /** @brief A Transition that supports orientation like.
@@ -71,7 +71,7 @@ void TransitionProgress::onEnter()
     Size size = Director::getInstance()->getWinSize();
 
     // create the second render texture for outScene
-    RenderTexture *texture = RenderTexture::create((int)size.width, (int)size.height);
+    RenderTexture *texture = RenderTexture::createTransient((int)size.width, (int)size.height);
     texture->getSprite()->setAnchorPoint(Point(0.5f,0.5f));
     texture->setPosition(Point(size.width/2, size.height/2));
     texture->setAnchorPoint(Point(0.5f,0.5f));
@@ -79,7 +79,7 @@ void TransitionProgress::onEnter()
     // render outScene to its texturebuffer
     texture->clear(0, 0, 0, 1);
     texture->begin();
-    _sceneToBeModified->visit();
+    visitScene(_sceneToBeModified);
     texture->end();
 
 
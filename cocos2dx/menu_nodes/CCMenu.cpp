@@ -177,6 +177,7 @@ void Menu::addChild(Node * child, int zOrder, int tag)
 {
     CCASSERT( dynamic_cast<MenuItem*>(child) != NULL, "Menu only supports MenuItem objects as children");
     Layer::addChild(child, zOrder, tag);
+    _hitGridDirty = true;
 }
 
 void Menu::onExit()
@@ -206,6 +207,7 @@ void Menu::removeChild(Node* child, bool cleanup)
     }
     
     Node::removeChild(child, cleanup);
+    _hitGridDirty = true;
 }
 
 //Menu - Events
@@ -238,6 +240,9 @@ bool Menu::ccTouchBegan(Touch* touch, Event* event)
         }
     }
 
+    // items may have been moved since the last touch, even within this frame
+    validateHitGrid();
+
     _selectedItem = this->itemForTouch(touch);
     if (_selectedItem)
     {
@@ -301,32 +306,16 @@ void Menu::alignItemsVertically()
 void Menu::alignItemsVerticallyWithPadding(float padding)
 {
     float height = -padding;
-    if (_children && _children->count() > 0)
+    for (auto child : _children)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
-        {
-            Node* child = dynamic_cast<Node*>(pObject);
-            if (child)
-            {
-                height += child->getContentSize().height * child->getScaleY() + padding;
-            }
-        }
+        height += child->getContentSize().height * child->getScaleY() + padding;
     }
 
     float y = height / 2.0f;
-    if (_children && _children->count() > 0)
+    for (auto child : _children)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
-        {
-            Node* child = dynamic_cast<Node*>(pObject);
-            if (child)
-            {
-                child->setPosition(Point(0, y - child->getContentSize().height * child->getScaleY() / 2.0f));
-                y -= child->getContentSize().height * child->getScaleY() + padding;
-            }
-        }
+        child->setPosition(Point(0, y - child->getContentSize().height * child->getScaleY() / 2.0f));
+        y -= child->getContentSize().height * child->getScaleY() + padding;
     }
 }
 
@@ -339,32 +328,16 @@ void Menu::alignItemsHorizontallyWithPadding(float padding)
 {
 
     float width = -padding;
-    if (_children && _children->count() > 0)
+    for (auto child : _children)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
-        {
-            Node* child = dynamic_cast<Node*>(pObject);
-            if (child)
-            {
-                width += child->getContentSize().width * child->getScaleX() + padding;
-            }
-        }
+        width += child->getContentSize().width * child->getScaleX() + padding;
     }
 
     float x = -width / 2.0f;
-    if (_children && _children->count() > 0)
+    for (auto child : _children)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
-        {
-            Node* child = dynamic_cast<Node*>(pObject);
-            if (child)
-            {
-                child->setPosition(Point(x + child->getContentSize().width * child->getScaleX() / 2.0f, 0));
-                 x += child->getContentSize().width * child->getScaleX() + padding;
-            }
-        }
+        child->setPosition(Point(x + child->getContentSize().width * child->getScaleX() / 2.0f, 0));
+         x += child->getContentSize().width * child->getScaleX() + padding;
     }
 }
 
@@ -400,33 +373,25 @@ void Menu::alignItemsInColumnsWithArray(Array* rowsArray)
     unsigned int columnsOccupied = 0;
     unsigned int rowColumns;
 
-    if (_children && _children->count() > 0)
+    for (auto child : _children)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
-        {
-            Node* child = dynamic_cast<Node*>(pObject);
-            if (child)
-            {
-                CCASSERT(row < rows.size(), "");
+        CCASSERT(row < rows.size(), "");
 
-                rowColumns = rows[row];
-                // can not have zero columns on a row
-                CCASSERT(rowColumns, "");
+        rowColumns = rows[row];
+        // can not have zero columns on a row
+        CCASSERT(rowColumns, "");
 
-                float tmp = child->getContentSize().height;
-                rowHeight = (unsigned int)((rowHeight >= tmp || isnan(tmp)) ? rowHeight : tmp);
+        float tmp = child->getContentSize().height;
+        rowHeight = (unsigned int)((rowHeight >= tmp || isnan(tmp)) ? rowHeight : tmp);
 
-                ++columnsOccupied;
-                if (columnsOccupied >= rowColumns)
-                {
-                    height += rowHeight + 5;
+        ++columnsOccupied;
+        if (columnsOccupied >= rowColumns)
+        {
+            height += rowHeight + 5;
 
-                    columnsOccupied = 0;
-                    rowHeight = 0;
-                    ++row;
-                }
-            }
+            columnsOccupied = 0;
+            rowHeight = 0;
+            ++row;
         }
     }    
 
@@ -442,40 +407,32 @@ void Menu::alignItemsInColumnsWithArray(Array* rowsArray)
     float x = 0.0;
     float y = (float)(height / 2);
 
-    if (_children && _children->count() > 0)
+    for (auto child : _children)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
+        if (rowColumns == 0)
         {
-            Node* child = dynamic_cast<Node*>(pObject);
-            if (child)
-            {
-                if (rowColumns == 0)
-                {
-                    rowColumns = rows[row];
-                    w = winSize.width / (1 + rowColumns);
-                    x = w;
-                }
+            rowColumns = rows[row];
+            w = winSize.width / (1 + rowColumns);
+            x = w;
+        }
 
-                float tmp = child->getContentSize().height;
-                rowHeight = (unsigned int)((rowHeight >= tmp || isnan(tmp)) ? rowHeight : tmp);
+        float tmp = child->getContentSize().height;
+        rowHeight = (unsigned int)((rowHeight >= tmp || isnan(tmp)) ? rowHeight : tmp);
 
-                child->setPosition(Point(x - winSize.width / 2,
-                                       y - child->getContentSize().height / 2));
+        child->setPosition(Point(x - winSize.width / 2,
+                               y - child->getContentSize().height / 2));
 
-                x += w;
-                ++columnsOccupied;
+        x += w;
+        ++columnsOccupied;
 
-                if (columnsOccupied >= rowColumns)
-                {
-                    y -= rowHeight + 5;
+        if (columnsOccupied >= rowColumns)
+        {
+            y -= rowHeight + 5;
 
-                    columnsOccupied = 0;
-                    rowColumns = 0;
-                    rowHeight = 0;
-                    ++row;
-                }
-            }
+            columnsOccupied = 0;
+            rowColumns = 0;
+            rowHeight = 0;
+            ++row;
         }
     }    
 }
@@ -515,40 +472,32 @@ void Menu::alignItemsInRowsWithArray(Array* columnArray)
     unsigned int rowsOccupied = 0;
     unsigned int columnRows;
 
-    if (_children && _children->count() > 0)
+    for (auto child : _children)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
-        {
-            Node* child = dynamic_cast<Node*>(pObject);
-            if (child)
-            {
-                // check if too many menu items for the amount of rows/columns
-                CCASSERT(column < columns.size(), "");
+        // check if too many menu items for the amount of rows/columns
+        CCASSERT(column < columns.size(), "");
 
-                columnRows = columns[column];
-                // can't have zero rows on a column
-                CCASSERT(columnRows, "");
+        columnRows = columns[column];
+        // can't have zero rows on a column
+        CCASSERT(columnRows, "");
 
-                // columnWidth = fmaxf(columnWidth, [item contentSize].width);
-                float tmp = child->getContentSize().width;
-                columnWidth = (unsigned int)((columnWidth >= tmp || isnan(tmp)) ? columnWidth : tmp);
+        // columnWidth = fmaxf(columnWidth, [item contentSize].width);
+        float tmp = child->getContentSize().width;
+        columnWidth = (unsigned int)((columnWidth >= tmp || isnan(tmp)) ? columnWidth : tmp);
 
-                columnHeight += (int)(child->getContentSize().height + 5);
-                ++rowsOccupied;
+        columnHeight += (int)(child->getContentSize().height + 5);
+        ++rowsOccupied;
 
-                if (rowsOccupied >= columnRows)
-                {
-                    columnWidths.push_back(columnWidth);
-                    columnHeights.push_back(columnHeight);
-                    width += columnWidth + 10;
-
-                    rowsOccupied = 0;
-                    columnWidth = 0;
-                    columnHeight = -5;
-                    ++column;
-                }
-            }
+        if (rowsOccupied >= columnRows)
+        {
+            columnWidths.push_back(columnWidth);
+            columnHeights.push_back(columnHeight);
+            width += columnWidth + 10;
+
+            rowsOccupied = 0;
+            columnWidth = 0;
+            columnHeight = -5;
+            ++column;
         }
     }
 
@@ -563,38 +512,159 @@ void Menu::alignItemsInRowsWithArray(Array* columnArray)
     float x = (float)(-width / 2);
     float y = 0.0;
 
-    if (_children && _children->count() > 0)
+    for (auto child : _children)
+    {
+        if (columnRows == 0)
+        {
+            columnRows = columns[column];
+            y = (float) columnHeights[column];
+        }
+
+        // columnWidth = fmaxf(columnWidth, [item contentSize].width);
+        float tmp = child->getContentSize().width;
+        columnWidth = (unsigned int)((columnWidth >= tmp || isnan(tmp)) ? columnWidth : tmp);
+
+        child->setPosition(Point(x + columnWidths[column] / 2,
+                               y - winSize.height / 2));
+
+        y -= child->getContentSize().height + 10;
+        ++rowsOccupied;
+
+        if (rowsOccupied >= columnRows)
+        {
+            x += columnWidth + 5;
+            rowsOccupied = 0;
+            columnRows = 0;
+            columnWidth = 0;
+            ++column;
+        }
+    }
+}
+
+void Menu::validateHitGrid()
+{
+    _hitGridFrame = Director::getInstance()->getTotalFrames();
+
+    if (! _hitGridDirty)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
+        // cheap checks against the cached transforms. Each of them is cached by the child itself
+        if (_hitEntries.size() != _children.size())
+        {
+            _hitGridDirty = true;
+        }
+        else
         {
-            Node* child = dynamic_cast<Node*>(pObject);
-            if (child)
+            unsigned int i = 0;
+            for (auto node : _children)
             {
-                if (columnRows == 0)
+                const HitEntry& entry = _hitEntries[i++];
+                if (entry.node != node
+                    || ! entry.size.equals(node->getContentSize())
+                    || ! AffineTransformEqualToTransform(entry.transform, node->getNodeToParentTransform()))
                 {
-                    columnRows = columns[column];
-                    y = (float) columnHeights[column];
+                    _hitGridDirty = true;
+                    break;
                 }
+            }
+        }
+    }
 
-                // columnWidth = fmaxf(columnWidth, [item contentSize].width);
-                float tmp = child->getContentSize().width;
-                columnWidth = (unsigned int)((columnWidth >= tmp || isnan(tmp)) ? columnWidth : tmp);
+    if (_hitGridDirty)
+    {
+        rebuildHitGrid();
+        _hitGridDirty = false;
+    }
+}
 
-                child->setPosition(Point(x + columnWidths[column] / 2,
-                                       y - winSize.height / 2));
+void Menu::rebuildHitGrid()
+{
+    _hitEntries.clear();
+    _hitEntries.reserve(_children.size());
 
-                y -= child->getContentSize().height + 10;
-                ++rowsOccupied;
+    std::vector<Rect> bounds;
+    bounds.reserve(_children.size());
 
-                if (rowsOccupied >= columnRows)
-                {
-                    x += columnWidth + 5;
-                    rowsOccupied = 0;
-                    columnRows = 0;
-                    columnWidth = 0;
-                    ++column;
-                }
+    for (auto node : _children)
+    {
+        HitEntry entry;
+        entry.node = node;
+        entry.size = node->getContentSize();
+        entry.transform = node->getNodeToParentTransform();
+        entry.inverse = AffineTransformInvert(entry.transform);
+        _hitEntries.push_back(entry);
+
+        Rect r = RectApplyAffineTransform(Rect(0, 0, entry.size.width, entry.size.height), entry.transform);
+        _hitBounds = bounds.empty() ? r : _hitBounds.unionWithRect(r);
+        bounds.push_back(r);
+    }
+
+    _hitCells.clear();
+    _hitItems.clear();
+    _hitColumns = _hitRows = 0;
+
+    unsigned int count = static_cast<unsigned int>(_hitEntries.size());
+    if (count == 0)
+    {
+        return;
+    }
+
+    // about one child per cell, whatever the shape of the layout
+    float width = _hitBounds.size.width;
+    float height = _hitBounds.size.height;
+    float cell = sqrtf(width * height / count);
+    if (cell > 0)
+    {
+        _hitColumns = MIN(static_cast<int>(ceilf(width / cell)), static_cast<int>(count));
+        _hitRows = MIN(static_cast<int>(ceilf(height / cell)), static_cast<int>(count));
+    }
+    else
+    {
+        // a single line of children
+        _hitColumns = width > 0 ? count : 1;
+        _hitRows = height > 0 ? count : 1;
+    }
+    _hitColumns = MAX(_hitColumns, 1);
+    _hitRows = MAX(_hitRows, 1);
+    _hitCellSize = Size(width / _hitColumns, height / _hitRows);
+
+    // counting sort of the children into their cells, which keeps them in child order
+    _hitCells.assign(_hitColumns * _hitRows + 1, 0);
+    std::vector<int> ranges(count * 4);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const Rect& r = bounds[i];
+        int x0 = static_cast<int>((r.getMinX() - _hitBounds.getMinX()) / MAX(_hitCellSize.width, FLT_EPSILON));
+        int x1 = static_cast<int>((r.getMaxX() - _hitBounds.getMinX()) / MAX(_hitCellSize.width, FLT_EPSILON));
+        int y0 = static_cast<int>((r.getMinY() - _hitBounds.getMinY()) / MAX(_hitCellSize.height, FLT_EPSILON));
+        int y1 = static_cast<int>((r.getMaxY() - _hitBounds.getMinY()) / MAX(_hitCellSize.height, FLT_EPSILON));
+        ranges[i * 4 + 0] = MIN(MAX(x0, 0), _hitColumns - 1);
+        ranges[i * 4 + 1] = MIN(MAX(x1, 0), _hitColumns - 1);
+        ranges[i * 4 + 2] = MIN(MAX(y0, 0), _hitRows - 1);
+        ranges[i * 4 + 3] = MIN(MAX(y1, 0), _hitRows - 1);
+
+        for (int y = ranges[i * 4 + 2]; y <= ranges[i * 4 + 3]; ++y)
+        {
+            for (int x = ranges[i * 4 + 0]; x <= ranges[i * 4 + 1]; ++x)
+            {
+                ++_hitCells[y * _hitColumns + x + 1];
+            }
+        }
+    }
+
+    for (size_t c = 1; c < _hitCells.size(); ++c)
+    {
+        _hitCells[c] += _hitCells[c - 1];
+    }
+
+    _hitItems.resize(_hitCells.back());
+    std::vector<unsigned int> fill(_hitCells.begin(), _hitCells.end() - 1);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        for (int y = ranges[i * 4 + 2]; y <= ranges[i * 4 + 3]; ++y)
+        {
+            for (int x = ranges[i * 4 + 0]; x <= ranges[i * 4 + 1]; ++x)
+            {
+                _hitItems[fill[y * _hitColumns + x]++] = i;
             }
         }
     }
@@ -602,24 +672,39 @@ void Menu::alignItemsInRowsWithArray(Array* columnArray)
 
 MenuItem* Menu::itemForTouch(Touch *touch)
 {
-    Point touchLocation = touch->getLocation();
+    if (_hitGridDirty || _hitGridFrame != Director::getInstance()->getTotalFrames())
+    {
+        validateHitGrid();
+    }
+
+    if (_hitColumns == 0)
+    {
+        return NULL;
+    }
+
+    // a single conversion to the space of the menu, the children are tested with their cached transforms
+    Point location = convertToNodeSpace(touch->getLocation());
+    if (! _hitBounds.containsPoint(location))
+    {
+        return NULL;
+    }
+
+    int x = static_cast<int>((location.x - _hitBounds.getMinX()) / MAX(_hitCellSize.width, FLT_EPSILON));
+    int y = static_cast<int>((location.y - _hitBounds.getMinY()) / MAX(_hitCellSize.height, FLT_EPSILON));
+    int cell = MIN(y, _hitRows - 1) * _hitColumns + MIN(x, _hitColumns - 1);
 
-    if (_children && _children->count() > 0)
+    for (unsigned int i = _hitCells[cell]; i < _hitCells[cell + 1]; ++i)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
+        const HitEntry& entry = _hitEntries[_hitItems[i]];
+        MenuItem* child = dynamic_cast<MenuItem*>(entry.node);
+        if (child && child->isVisible() && child->isEnabled())
         {
-            MenuItem* child = dynamic_cast<MenuItem*>(pObject);
-            if (child && child->isVisible() && child->isEnabled())
-            {
-                Point local = child->convertToNodeSpace(touchLocation);
-                Rect r = child->rect();
-                r.origin = Point::ZERO;
+            Point local = PointApplyAffineTransform(location, entry.inverse);
+            Rect r(0, 0, entry.size.width, entry.size.height);
 
-                if (r.containsPoint(local))
-                {
-                    return child;
-                }
+            if (r.containsPoint(local))
+            {
+                return child;
             }
         }
     }
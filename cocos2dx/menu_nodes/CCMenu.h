@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include "CCMenuItem.h"
 #include "layers_scenes_transitions_nodes/CCLayer.h"
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -77,7 +78,7 @@ public:
     /** creates a Menu with MenuItem objects */
     static Menu* createWithItems(MenuItem *firstItem, va_list args);
 
-    Menu() : _selectedItem(NULL) {}
+    Menu() : _selectedItem(NULL), _hitColumns(0), _hitRows(0), _hitGridFrame(0), _hitGridDirty(true) {}
     virtual ~Menu(){}
 
     /** initializes an empty Menu */
@@ -138,6 +139,33 @@ protected:
     MenuItem* itemForTouch(Touch * touch);
     State _state;
     MenuItem *_selectedItem;
+
+    /** cached hit area of a child, in the space of the menu */
+    struct HitEntry
+    {
+        Node *node;
+        AffineTransform transform;
+        AffineTransform inverse;
+        Size size;
+    };
+
+    /** rebuilds the hit grid if the children, their transforms or their sizes changed since it was built */
+    void validateHitGrid();
+    void rebuildHitGrid();
+
+    std::vector<HitEntry> _hitEntries;
+    /** uniform grid over the bounds of the children. The entries of cell i are
+     _hitItems[_hitCells[i]] ... _hitItems[_hitCells[i + 1] - 1], in the order of the children
+     */
+    std::vector<unsigned int> _hitCells;
+    std::vector<unsigned int> _hitItems;
+    Rect _hitBounds;
+    Size _hitCellSize;
+    int _hitColumns;
+    int _hitRows;
+    /** frame in which the grid was last validated. Touches moving within a frame reuse it as is */
+    unsigned int _hitGridFrame;
+    bool _hitGridDirty;
 };
 
 // end of GUI group
@@ -26,11 +26,17 @@
  */
 
 #include "CCClippingNode.h"
+#include "kazmath/vec4.h"
 #include "kazmath/GL/matrix.h"
 #include "shaders/CCGLProgram.h"
 #include "shaders/CCShaderCache.h"
 #include "CCDirector.h"
 #include "draw_nodes/CCDrawingPrimitives.h"
+#include "renderer/CCRenderer.h"
+#include "sprite_nodes/CCSprite.h"
+#include "layers_scenes_transitions_nodes/CCLayer.h"
+#include "effects/CCGrid.h"
+#include "support/CCGPUProfiler.h"
 
 NS_CC_BEGIN
 
@@ -39,12 +45,10 @@ static GLint g_sStencilBits = -1;
 static void setProgram(Node *n, GLProgram *p)
 {
     n->setShaderProgram(p);
-    if (!n->getChildren()) return;
-    
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(n->getChildren(), pObj)
+
+    for (auto child : n->getChildren())
     {
-        setProgram(static_cast<Node*>(pObj), p);
+        setProgram(child, p);
     }
 }
 
@@ -159,8 +163,156 @@ void ClippingNode::drawFullScreenQuadClearStencil()
     kmGLPopMatrix();
 }
 
+bool ClippingNode::getStencilScissorBox(GLint *box)
+{
+    // with an alpha threshold, the transparent pixels of the stencil don't clip,
+    // otherwise all the pixels of its geometry are written in the stencil buffer
+    if (_inverted || _alphaThreshold < 1 || _stencil->getChildrenCount() > 0)
+    {
+        return false;
+    }
+
+    GridBase *grid = _stencil->getGrid();
+    if (grid && grid->isActive())
+    {
+        return false;
+    }
+
+    Rect rect;
+    if (Sprite *sprite = dynamic_cast<Sprite*>(_stencil))
+    {
+        rect.origin = sprite->getOffsetPosition();
+        rect.size = sprite->getTextureRect().size;
+    }
+    else if (dynamic_cast<LayerColor*>(_stencil))
+    {
+        rect.size = _stencil->getContentSize();
+    }
+    else
+    {
+        return false;
+    }
+
+    // the transform the stencil is drawn with, as in visit()
+    kmMat4 modelView, projection, mvp;
+    kmGLPushMatrix();
+    transform();
+    _stencil->transform();
+    kmGLGetMatrix(KM_GL_MODELVIEW, &modelView);
+    kmGLPopMatrix();
+    kmGLGetMatrix(KM_GL_PROJECTION, &projection);
+    kmMat4Multiply(&mvp, &projection, &modelView);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    const float corners[4][2] = {
+        { rect.getMinX(), rect.getMinY() },
+        { rect.getMaxX(), rect.getMinY() },
+        { rect.getMaxX(), rect.getMaxY() },
+        { rect.getMinX(), rect.getMaxY() },
+    };
+
+    float x[4], y[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        kmVec4 corner = { corners[i][0], corners[i][1], 0, 1 };
+        kmVec4 clip;
+        kmVec4Transform(&clip, &corner, &mvp);
+        if (clip.w <= 0)
+        {
+            return false;
+        }
+
+        x[i] = viewport[0] + (clip.x / clip.w + 1) * 0.5f * viewport[2];
+        y[i] = viewport[1] + (clip.y / clip.w + 1) * 0.5f * viewport[3];
+    }
+
+    // each side must be horizontal or vertical, up to a tenth of pixel
+    const float tolerance = 0.1f;
+    bool aligned = (fabsf(x[0] - x[3]) < tolerance && fabsf(x[1] - x[2]) < tolerance
+                    && fabsf(y[0] - y[1]) < tolerance && fabsf(y[2] - y[3]) < tolerance)
+                || (fabsf(y[0] - y[3]) < tolerance && fabsf(y[1] - y[2]) < tolerance
+                    && fabsf(x[0] - x[1]) < tolerance && fabsf(x[2] - x[3]) < tolerance);
+    if (!aligned)
+    {
+        return false;
+    }
+
+    // the pixels whose center is inside the rectangle, as the rasterization of the stencil
+    GLint left = (GLint)floorf(MIN(MIN(x[0], x[1]), MIN(x[2], x[3])) + 0.5f);
+    GLint right = (GLint)floorf(MAX(MAX(x[0], x[1]), MAX(x[2], x[3])) + 0.5f);
+    GLint bottom = (GLint)floorf(MIN(MIN(y[0], y[1]), MIN(y[2], y[3])) + 0.5f);
+    GLint top = (GLint)floorf(MAX(MAX(y[0], y[1]), MAX(y[2], y[3])) + 0.5f);
+
+    box[0] = left;
+    box[1] = bottom;
+    box[2] = right - left;
+    box[3] = top - bottom;
+
+    return true;
+}
+
+// the zone of GPUProfiler measuring the stencils
+static unsigned int getStencilGPUZone()
+{
+    static unsigned int zone = GPUProfiler::registerZone("GPU - ClippingNode stencil");
+    return zone;
+}
+
+void ClippingNode::visitWithScissor(const GLint *box)
+{
+    // the pending render commands must not be affected by the scissor test
+    Renderer* renderer = Director::getInstance()->getRenderer();
+    renderer->flush();
+
+    // manually save the scissor state
+    bool currentScissorEnabled = GL::isEnabled(GL_SCISSOR_TEST);
+    GLint currentScissorBox[4];
+    GL::getScissorBox(currentScissorBox);
+
+    GLint left = box[0];
+    GLint bottom = box[1];
+    GLint right = box[0] + box[2];
+    GLint top = box[1] + box[3];
+
+    // nested clipping: draw only in the intersection with the current box
+    if (currentScissorEnabled)
+    {
+        left = MAX(left, currentScissorBox[0]);
+        bottom = MAX(bottom, currentScissorBox[1]);
+        right = MIN(right, currentScissorBox[0] + currentScissorBox[2]);
+        top = MIN(top, currentScissorBox[1] + currentScissorBox[3]);
+    }
+    else
+    {
+        GL::enable(GL_SCISSOR_TEST);
+    }
+
+    GL::scissor(left, bottom, MAX(right - left, 0), MAX(top - bottom, 0));
+
+    Node::visit();
+    renderer->flush();
+
+    // manually restore the scissor state
+    GL::scissor(currentScissorBox[0], currentScissorBox[1], currentScissorBox[2], currentScissorBox[3]);
+    if (!currentScissorEnabled)
+    {
+        GL::disable(GL_SCISSOR_TEST);
+    }
+}
+
 void ClippingNode::visit()
 {
+    // a rectangular stencil clips with the scissor test,
+    // which doesn't need to clear and draw the stencil buffer
+    GLint scissorBox[4];
+    if (_stencil && _stencil->isVisible() && getStencilScissorBox(scissorBox))
+    {
+        visitWithScissor(scissorBox);
+        return;
+    }
+
     // if stencil buffer disabled
     if (g_sStencilBits < 1)
     {
@@ -227,29 +379,35 @@ void ClippingNode::visit()
     GLenum currentStencilFail = GL_KEEP;
     GLenum currentStencilPassDepthFail = GL_KEEP;
     GLenum currentStencilPassDepthPass = GL_KEEP;
-    currentStencilEnabled = glIsEnabled(GL_STENCIL_TEST);
-    glGetIntegerv(GL_STENCIL_WRITEMASK, (GLint *)&currentStencilWriteMask);
-    glGetIntegerv(GL_STENCIL_FUNC, (GLint *)&currentStencilFunc);
-    glGetIntegerv(GL_STENCIL_REF, &currentStencilRef);
-    glGetIntegerv(GL_STENCIL_VALUE_MASK, (GLint *)&currentStencilValueMask);
-    glGetIntegerv(GL_STENCIL_FAIL, (GLint *)&currentStencilFail);
-    glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, (GLint *)&currentStencilPassDepthFail);
-    glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, (GLint *)&currentStencilPassDepthPass);
-    
+    currentStencilEnabled = GL::isEnabled(GL_STENCIL_TEST);
+    currentStencilWriteMask = GL::getStencilMask();
+    GL::getStencilFunc(&currentStencilFunc, &currentStencilRef, &currentStencilValueMask);
+    GL::getStencilOp(&currentStencilFail, &currentStencilPassDepthFail, &currentStencilPassDepthPass);
+    
+    // the pending render commands must not be affected by the stencil state
+    Renderer* renderer = Director::getInstance()->getRenderer();
+    renderer->flush();
+
+    bool gpuZone = GPUProfiler::isEnabled();
+    if (gpuZone)
+    {
+        GPUProfiler::getInstance()->beginZone(getStencilGPUZone());
+    }
+
     // enable stencil use
-    glEnable(GL_STENCIL_TEST);
+    GL::enable(GL_STENCIL_TEST);
     // check for OpenGL error while enabling stencil test
     CHECK_GL_ERROR_DEBUG();
     
     // all bits on the stencil buffer are readonly, except the current layer bit,
     // this means that operation like glClear or glStencilOp will be masked with this value
-    glStencilMask(mask_layer);
+    GL::stencilMask(mask_layer);
     
     // manually save the depth test state
     //GLboolean currentDepthTestEnabled = GL_TRUE;
     GLboolean currentDepthWriteMask = GL_TRUE;
     //currentDepthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &currentDepthWriteMask);
+    currentDepthWriteMask = GL::getDepthMask();
     
     // disable depth test while drawing the stencil
     //glDisable(GL_DEPTH_TEST);
@@ -257,7 +415,7 @@ void ClippingNode::visit()
     // as the stencil is not meant to be rendered in the real scene,
     // it should never prevent something else to be drawn,
     // only disabling depth buffer update should do
-    glDepthMask(GL_FALSE);
+    GL::depthMask(GL_FALSE);
     
     ///////////////////////////////////
     // CLEAR STENCIL BUFFER
@@ -268,8 +426,8 @@ void ClippingNode::visit()
     //     never draw it into the frame buffer
     //     if not in inverted mode: set the current layer value to 0 in the stencil buffer
     //     if in inverted mode: set the current layer value to 1 in the stencil buffer
-    glStencilFunc(GL_NEVER, mask_layer, mask_layer);
-    glStencilOp(!_inverted ? GL_ZERO : GL_REPLACE, GL_KEEP, GL_KEEP);
+    GL::stencilFunc(GL_NEVER, mask_layer, mask_layer);
+    GL::stencilOp(!_inverted ? GL_ZERO : GL_REPLACE, GL_KEEP, GL_KEEP);
     
     // draw a fullscreen solid rectangle to clear the stencil buffer
     //ccDrawSolidRect(Point::ZERO, ccpFromSize([[Director sharedDirector] winSize]), Color4F(1, 1, 1, 1));
@@ -283,8 +441,8 @@ void ClippingNode::visit()
     //     never draw it into the frame buffer
     //     if not in inverted mode: set the current layer value to 1 in the stencil buffer
     //     if in inverted mode: set the current layer value to 0 in the stencil buffer
-    glStencilFunc(GL_NEVER, mask_layer, mask_layer);
-    glStencilOp(!_inverted ? GL_REPLACE : GL_ZERO, GL_KEEP, GL_KEEP);
+    GL::stencilFunc(GL_NEVER, mask_layer, mask_layer);
+    GL::stencilOp(!_inverted ? GL_REPLACE : GL_ZERO, GL_KEEP, GL_KEEP);
     
     // enable alpha test only if the alpha threshold < 1,
     // indeed if alpha threshold == 1, every pixel will be drawn anyways
@@ -309,7 +467,7 @@ void ClippingNode::visit()
         // since glAlphaTest do not exists in OES, use a shader that writes
         // pixel only if greater than an alpha threshold
         GLProgram *program = ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST);
-        GLint alphaValueLocation = glGetUniformLocation(program->getProgram(), GLProgram::UNIFORM_NAME_ALPHA_TEST_VALUE);
+        GLint alphaValueLocation = program->getUniformLocationForName(GLProgram::UNIFORM_NAME_ALPHA_TEST_VALUE);
         // set our alphaThreshold
         program->setUniformLocationWith1f(alphaValueLocation, _alphaThreshold);
         // we need to recursively apply this shader to all the nodes in the stencil node
@@ -325,6 +483,14 @@ void ClippingNode::visit()
     transform();
     _stencil->visit();
     kmGLPopMatrix();
+
+    // render the stencil before the stencil func/op are changed
+    renderer->flush();
+
+    if (gpuZone)
+    {
+        GPUProfiler::getInstance()->endZone(getStencilGPUZone());
+    }
     
     // restore alpha test state
     if (_alphaThreshold < 1)
@@ -342,7 +508,7 @@ void ClippingNode::visit()
     }
     
     // restore the depth test state
-    glDepthMask(currentDepthWriteMask);
+    GL::depthMask(currentDepthWriteMask);
     //if (currentDepthTestEnabled) {
     //    glEnable(GL_DEPTH_TEST);
     //}
@@ -356,22 +522,26 @@ void ClippingNode::visit()
     //         draw the pixel and keep the current layer in the stencil buffer
     //     else
     //         do not draw the pixel but keep the current layer in the stencil buffer
-    glStencilFunc(GL_EQUAL, mask_layer_le, mask_layer_le);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    GL::stencilFunc(GL_EQUAL, mask_layer_le, mask_layer_le);
+    GL::stencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
     
     // draw (according to the stencil test func) this node and its childs
-    Node::visit();
+    {
+        CC_PROFILE_GPU_ZONE("GPU - ClippingNode content");
+        Node::visit();
+        renderer->flush();
+    }
     
     ///////////////////////////////////
     // CLEANUP
     
     // manually restore the stencil state
-    glStencilFunc(currentStencilFunc, currentStencilRef, currentStencilValueMask);
-    glStencilOp(currentStencilFail, currentStencilPassDepthFail, currentStencilPassDepthPass);
-    glStencilMask(currentStencilWriteMask);
+    GL::stencilFunc(currentStencilFunc, currentStencilRef, currentStencilValueMask);
+    GL::stencilOp(currentStencilFail, currentStencilPassDepthFail, currentStencilPassDepthPass);
+    GL::stencilMask(currentStencilWriteMask);
     if (!currentStencilEnabled)
     {
-        glDisable(GL_STENCIL_TEST);
+        GL::disable(GL_STENCIL_TEST);
     }
     
     // we are done using this layer, decrement
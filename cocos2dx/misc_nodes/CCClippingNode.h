@@ -37,6 +37,9 @@ NS_CC_BEGIN
  It draws its content (childs) clipped using a stencil.
  The stencil is an other Node that will not be drawn.
  The clipping is done using the alpha part of the stencil (adjusted with an alphaThreshold).
+ When the stencil is a Sprite or a LayerColor without childs, the alpha threshold is 1 and it is
+ not inverted, it is an axis aligned rectangle on the screen as long as it isn't rotated:
+ the content is then clipped with the scissor test, without using the stencil buffer.
  */
 class CC_DLL ClippingNode : public Node
 {
@@ -95,6 +98,15 @@ private:
     */
     void drawFullScreenQuadClearStencil();
 
+    /** returns whether the stencil is a rectangle aligned with the axes of the window,
+     and its box (x, y, width, height) in pixels
+     */
+    bool getStencilScissorBox(GLint *box);
+
+    /** draws the content clipped to the box with the scissor test, intersected with the box of the clipping nodes above
+     */
+    void visitWithScissor(const GLint *box);
+
 private:
     ClippingNode();
 
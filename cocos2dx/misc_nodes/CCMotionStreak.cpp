@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "ccMacros.h"
 
 #include "support/CCVertex.h"
+#include <algorithm>
 
 NS_CC_BEGIN
 
@@ -43,10 +44,10 @@ MotionStreak::MotionStreak()
 , _fadeDelta(0.0f)
 , _minSeg(0.0f)
 , _maxPoints(0)
+, _firstPoint(0)
 , _nuPoints(0)
-, _previousNuPoints(0)
+, _time(0.0f)
 , _pointVertexes(NULL)
-, _pointState(NULL)
 , _vertices(NULL)
 , _colorPointer(NULL)
 , _texCoords(NULL)
@@ -56,7 +57,6 @@ MotionStreak::MotionStreak()
 MotionStreak::~MotionStreak()
 {
     CC_SAFE_RELEASE(_texture);
-    CC_SAFE_FREE(_pointState);
     CC_SAFE_FREE(_pointVertexes);
     CC_SAFE_FREE(_vertices);
     CC_SAFE_FREE(_colorPointer);
@@ -113,19 +113,22 @@ bool MotionStreak::initWithFade(float fade, float minSeg, float stroke, const Co
     _fadeDelta = 1.0f/fade;
 
     _maxPoints = (int)(fade*60.0f)+2;
+    _firstPoint = 0;
     _nuPoints = 0;
-    _pointState = (float *)malloc(sizeof(float) * _maxPoints);
-    _pointVertexes = (Point*)malloc(sizeof(Point) * _maxPoints);
+    _time = 0.0f;
 
-    _vertices = (Vertex2F*)malloc(sizeof(Vertex2F) * _maxPoints * 2);
-    _texCoords = (Tex2F*)malloc(sizeof(Tex2F) * _maxPoints * 2);
-    _colorPointer =  (GLubyte*)malloc(sizeof(GLubyte) * _maxPoints * 2 * 4);
+    // twice the maximum number of points, the buffers are compacted when they are full
+    _pointVertexes = (Point*)malloc(sizeof(Point) * _maxPoints * 2);
+
+    _vertices = (Vertex2F*)malloc(sizeof(Vertex2F) * _maxPoints * 2 * 2);
+    _texCoords = (Vertex3F*)malloc(sizeof(Vertex3F) * _maxPoints * 2 * 2);
+    _colorPointer =  (GLubyte*)malloc(sizeof(GLubyte) * _maxPoints * 2 * 2 * 4);
 
     // Set blend mode
     _blendFunc = BlendFunc::ALPHA_NON_PREMULTIPLIED;
 
     // shader program
-    setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR));
+    setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_MOTION_STREAK));
 
     setTexture(texture);
     setColor(color);
@@ -145,7 +148,7 @@ void MotionStreak::tintWithColor(const Color3B& colors)
     setColor(colors);
 
     // Fast assignation
-    for(unsigned int i = 0; i<_nuPoints*2; i++) 
+    for(unsigned int i = _firstPoint*2; i<(_firstPoint+_nuPoints)*2; i++) 
     {
         *((Color3B*) (_colorPointer+i*4)) = colors;
     }
@@ -203,55 +206,21 @@ void MotionStreak::update(float delta)
     {
         return;
     }
-    
-    delta *= _fadeDelta;
 
-    unsigned int newIdx, newIdx2, i, i2;
-    unsigned int mov = 0;
+    _time += delta;
 
-    // Update current points
-    for(i = 0; i<_nuPoints; i++)
+    // Remove the faded points, the oldest ones are first
+    while(_nuPoints > 0 && (_time - _texCoords[_firstPoint*2].z) * _fadeDelta >= 1.0f)
     {
-        _pointState[i]-=delta;
-
-        if(_pointState[i] <= 0)
-            mov++;
-        else
-        {
-            newIdx = i-mov;
+        _firstPoint++;
+        _nuPoints--;
+    }
 
-            if(mov>0)
-            {
-                // Move data
-                _pointState[newIdx] = _pointState[i];
-
-                // Move point
-                _pointVertexes[newIdx] = _pointVertexes[i];
-
-                // Move vertices
-                i2 = i*2;
-                newIdx2 = newIdx*2;
-                _vertices[newIdx2] = _vertices[i2];
-                _vertices[newIdx2+1] = _vertices[i2+1];
-
-                // Move color
-                i2 *= 4;
-                newIdx2 *= 4;
-                _colorPointer[newIdx2+0] = _colorPointer[i2+0];
-                _colorPointer[newIdx2+1] = _colorPointer[i2+1];
-                _colorPointer[newIdx2+2] = _colorPointer[i2+2];
-                _colorPointer[newIdx2+4] = _colorPointer[i2+4];
-                _colorPointer[newIdx2+5] = _colorPointer[i2+5];
-                _colorPointer[newIdx2+6] = _colorPointer[i2+6];
-            }else
-                newIdx2 = newIdx*8;
-
-            const GLubyte op = (GLubyte)(_pointState[newIdx] * 255.0f);
-            _colorPointer[newIdx2+3] = op;
-            _colorPointer[newIdx2+7] = op;
-        }
+    if(_nuPoints == 0)
+    {
+        _firstPoint = 0;
+        _time = 0.0f;
     }
-    _nuPoints-=mov;
 
     // Append new point
     bool appendNewPoint = true;
@@ -262,8 +231,9 @@ void MotionStreak::update(float delta)
 
     else if(_nuPoints>0)
     {
-        bool a1 = _pointVertexes[_nuPoints-1].getDistanceSq(_positionR) < _minSeg;
-        bool a2 = (_nuPoints == 1) ? false : (_pointVertexes[_nuPoints-2].getDistanceSq(_positionR)< (_minSeg * 2.0f));
+        const unsigned int last = _firstPoint+_nuPoints-1;
+        bool a1 = _pointVertexes[last].getDistanceSq(_positionR) < _minSeg;
+        bool a2 = (_nuPoints == 1) ? false : (_pointVertexes[last-1].getDistanceSq(_positionR)< (_minSeg * 2.0f));
         if(a1 || a2)
         {
             appendNewPoint = false;
@@ -272,28 +242,35 @@ void MotionStreak::update(float delta)
 
     if(appendNewPoint)
     {
-        _pointVertexes[_nuPoints] = _positionR;
-        _pointState[_nuPoints] = 1.0f;
+        if(_firstPoint+_nuPoints == _maxPoints*2)
+        {
+            compactPoints();
+        }
 
-        // Color assignment
-        const unsigned int offset = _nuPoints*8;
+        const unsigned int idx = _firstPoint+_nuPoints;
+        _pointVertexes[idx] = _positionR;
+
+        // Color assignment, the opacity is faded by the shader
+        const unsigned int offset = idx*8;
         *((Color3B*)(_colorPointer + offset)) = _displayedColor;
         *((Color3B*)(_colorPointer + offset+4)) = _displayedColor;
-
-        // Opacity
         _colorPointer[offset+3] = 255;
         _colorPointer[offset+7] = 255;
 
+        // Tex coords are relative to the first point, the shader computes them
+        _texCoords[idx*2] = Vertex3F(0, idx, _time);
+        _texCoords[idx*2+1] = Vertex3F(1, idx, _time);
+
         // Generate polygon
         if(_nuPoints > 0 && _fastMode )
         {
             if(_nuPoints > 1)
             {
-                ccVertexLineToPolygon(_pointVertexes, _stroke, _vertices, _nuPoints, 1);
+                ccVertexLineToPolygon(_pointVertexes + _firstPoint, _stroke, _vertices + _firstPoint*2, _nuPoints, 1);
             }
             else
             {
-                ccVertexLineToPolygon(_pointVertexes, _stroke, _vertices, 0, 2);
+                ccVertexLineToPolygon(_pointVertexes + _firstPoint, _stroke, _vertices + _firstPoint*2, 0, 2);
             }
         }
 
@@ -302,24 +279,33 @@ void MotionStreak::update(float delta)
 
     if( ! _fastMode )
     {
-        ccVertexLineToPolygon(_pointVertexes, _stroke, _vertices, 0, _nuPoints);
+        ccVertexLineToPolygon(_pointVertexes + _firstPoint, _stroke, _vertices + _firstPoint*2, 0, _nuPoints);
     }
+}
 
-    // Updated Tex Coords only if they are different than previous step
-    if( _nuPoints  && _previousNuPoints != _nuPoints ) {
-        float texDelta = 1.0f / _nuPoints;
-        for( i=0; i < _nuPoints; i++ ) {
-            _texCoords[i*2] = Tex2F(0, texDelta*i);
-            _texCoords[i*2+1] = Tex2F(1, texDelta*i);
-        }
+void MotionStreak::compactPoints()
+{
+    // at most _maxPoints points are moved, after at least _maxPoints points were added
+    std::copy(_pointVertexes + _firstPoint, _pointVertexes + _firstPoint + _nuPoints, _pointVertexes);
+    std::copy(_vertices + _firstPoint*2, _vertices + (_firstPoint + _nuPoints)*2, _vertices);
+    std::copy(_colorPointer + _firstPoint*8, _colorPointer + (_firstPoint + _nuPoints)*8, _colorPointer);
 
-        _previousNuPoints = _nuPoints;
+    // the times are made relative to the current one, so that they keep their precision
+    for(unsigned int i = 0; i < _nuPoints*2; i++)
+    {
+        const Vertex3F& texCoord = _texCoords[_firstPoint*2 + i];
+        _texCoords[i] = Vertex3F(texCoord.x, i/2, texCoord.z - _time);
     }
+
+    _firstPoint = 0;
+    _time = 0.0f;
 }
 
 void MotionStreak::reset()
 {
+    _firstPoint = 0;
     _nuPoints = 0;
+    _time = 0.0f;
 }
 
 void MotionStreak::draw()
@@ -329,30 +315,33 @@ void MotionStreak::draw()
 
     CC_NODE_DRAW_SETUP();
 
+    GLProgram* program = getShaderProgram();
+    program->setUniformLocationWith4f(program->getUniformLocationForName("u_streak"), _time, _firstPoint, _nuPoints, _fadeDelta);
+
     GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
     GL::blendFunc( _blendFunc.src, _blendFunc.dst );
 
     GL::bindTexture2D( _texture->getName() );
 
 #ifdef EMSCRIPTEN
-    // Size calculations from ::initWithFade
-    setGLBufferData(_vertices, (sizeof(Vertex2F) * _maxPoints * 2), 0);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    const GLvoid* offset = setGLBufferData(_vertices + _firstPoint*2, (sizeof(Vertex2F) * _nuPoints * 2));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, offset);
 
-    setGLBufferData(_texCoords, (sizeof(Tex2F) * _maxPoints * 2), 1);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    offset = setGLBufferData(_texCoords + _firstPoint*2, (sizeof(Vertex3F) * _nuPoints * 2));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 3, GL_FLOAT, GL_FALSE, 0, offset);
 
-    setGLBufferData(_colorPointer, (sizeof(GLubyte) * _maxPoints * 2 * 4), 2);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, 0);
+    offset = setGLBufferData(_colorPointer + _firstPoint*8, (sizeof(GLubyte) * _nuPoints * 2 * 4));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, offset);
 #else
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, _vertices);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, _texCoords);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, _colorPointer);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, _vertices + _firstPoint*2);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 3, GL_FLOAT, GL_FALSE, 0, _texCoords + _firstPoint*2);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, _colorPointer + _firstPoint*8);
 #endif // EMSCRIPTEN
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei)_nuPoints*2);
 
     CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_VERTICES(_nuPoints*2);
 }
 
 NS_CC_END
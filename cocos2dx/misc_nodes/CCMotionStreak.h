@@ -42,6 +42,10 @@ NS_CC_BEGIN
 
 /** MotionStreak.
  Creates a trailing path.
+
+ The points are appended to a buffer twice as large as the number of living points, and the dead ones are dropped
+ from its beginning, so an update only computes the vertices of the new point: the buffer is compacted when its end is
+ reached. The points are faded by the vertex shader, from the time they were added.
  */
 class CC_DLL MotionStreak : public NodeRGBA, public TextureProtocol
 #ifdef EMSCRIPTEN
@@ -95,6 +99,9 @@ protected:
     bool _fastMode;
     bool _startingPositionInitialized;
 private:
+    // moves the living points to the beginning of the buffers
+    void compactPoints();
+
     /** texture used for the motion streak */
     Texture2D* _texture;
     BlendFunc _blendFunc;
@@ -104,18 +111,21 @@ private:
     float _fadeDelta;
     float _minSeg;
 
+    // the living points are in [_firstPoint, _firstPoint + _nuPoints) of buffers of _maxPoints * 2 points
     unsigned int _maxPoints;
+    unsigned int _firstPoint;
     unsigned int _nuPoints;
-    unsigned int _previousNuPoints;
+    // time of the streak, reset when the buffers are compacted
+    float _time;
 
     /** Pointers */
     Point* _pointVertexes;
-    float* _pointState;
 
     // Opengl
     Vertex2F* _vertices;
     GLubyte* _colorPointer;
-    Tex2F* _texCoords;
+    // side of the streak (0 or 1), index of the point in the buffers, time at which the point was added
+    Vertex3F* _texCoords;
 };
 
 // end of misc_nodes group
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "draw_nodes/CCDrawingPrimitives.h"
 // extern
 #include "kazmath/GL/matrix.h"
+#include "renderer/CCRenderer.h"
 
 #include <float.h>
 
@@ -497,55 +498,67 @@ Point ProgressTimer::boundaryTexCoord(char index)
     return Point::ZERO;
 }
 
-void ProgressTimer::draw(void)
+static inline void setQuadVertex(V3F_C4B_T2F& out, const V2F_C4B_T2F& in)
 {
-    if( ! _vertexData || ! _sprite)
-        return;
-
-    CC_NODE_DRAW_SETUP();
-
-    GL::blendFunc( _sprite->getBlendFunc().src, _sprite->getBlendFunc().dst );
-
-    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
-
-    GL::bindTexture2D( _sprite->getTexture()->getName() );
-
-#ifdef EMSCRIPTEN
-    setGLBufferData((void*) _vertexData, (_vertexDataCount * sizeof(V2F_C4B_T2F)), 0);
-
-    int offset = 0;
-    glVertexAttribPointer( GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid*)offset);
-
-    offset += sizeof(Vertex2F);
-    glVertexAttribPointer( GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2F), (GLvoid*)offset);
+    out.vertices = Vertex3F(in.vertices.x, in.vertices.y, 0);
+    out.colors = in.colors;
+    out.texCoords = in.texCoords;
+}
 
-    offset += sizeof(Color4B);
-    glVertexAttribPointer( GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid*)offset);
-#else
-    glVertexAttribPointer( GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(_vertexData[0]) , &_vertexData[0].vertices);
-    glVertexAttribPointer( GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, sizeof(_vertexData[0]), &_vertexData[0].texCoords);
-    glVertexAttribPointer( GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(_vertexData[0]), &_vertexData[0].colors);
-#endif // EMSCRIPTEN
+void ProgressTimer::updateQuads(void)
+{
+    _quads.clear();
 
-    if(_type == Type::RADIAL)
+    if (_type == Type::RADIAL)
     {
-        glDrawArrays(GL_TRIANGLE_FAN, 0, _vertexDataCount);
-    } 
-    else if (_type == Type::BAR)
-    {
-        if (!_reverseDirection) 
+        // the triangles of the fan, around _vertexData[0], are drawn two by two:
+        // the quad (tl, bl, tr, br) is made of the triangles (tl, bl, tr) and (br, tr, bl)
+        for (int i = 1; i + 1 < _vertexDataCount; i += 2)
         {
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, _vertexDataCount);
-        } 
-        else 
+            V3F_C4B_T2F_Quad quad;
+            setQuadVertex(quad.bl, _vertexData[0]);
+            setQuadVertex(quad.tl, _vertexData[i]);
+            setQuadVertex(quad.tr, _vertexData[i + 1]);
+            // a single triangle is left at the end of the odd fans
+            setQuadVertex(quad.br, _vertexData[i + 2 < _vertexDataCount ? i + 2 : i + 1]);
+            _quads.push_back(quad);
+        }
+    }
+    else
+    {
+        // strips of 4 vertices: top left, bottom left, top right, bottom right
+        for (int i = 0; i + 3 < _vertexDataCount; i += 4)
         {
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, _vertexDataCount/2);
-            glDrawArrays(GL_TRIANGLE_STRIP, 4, _vertexDataCount/2);
-            // 2 draw calls
-            CC_INCREMENT_GL_DRAWS(1);
+            V3F_C4B_T2F_Quad quad;
+            setQuadVertex(quad.tl, _vertexData[i]);
+            setQuadVertex(quad.bl, _vertexData[i + 1]);
+            setQuadVertex(quad.tr, _vertexData[i + 2]);
+            setQuadVertex(quad.br, _vertexData[i + 3]);
+            _quads.push_back(quad);
         }
     }
-    CC_INCREMENT_GL_DRAWS(1);
+}
+
+void ProgressTimer::draw(void)
+{
+    if( ! _vertexData || ! _sprite)
+        return;
+
+    updateQuads();
+    if (_quads.empty())
+    {
+        return;
+    }
+
+    // the quads are drawn by the Renderer when it is flushed, batched with the sprites of the same texture
+    kmMat4 mv;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
+
+    Texture2D* texture = _sprite->getTexture();
+    Texture2D* alphaTexture = texture->getAlphaTexture();
+    GLProgram* shader = ShaderCache::getInstance()->programForTexture(_shaderProgram, texture);
+    _quadCommand.init(texture->getName(), shader, _sprite->getBlendFunc(), &_quads[0], (int)_quads.size(), mv, alphaTexture ? alphaTexture->getName() : 0);
+    Director::getInstance()->getRenderer()->addCommand(&_quadCommand);
 }
 
 NS_CC_END
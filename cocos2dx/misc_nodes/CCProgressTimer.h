@@ -26,6 +26,8 @@ THE SOFTWARE.
 #define __MISC_NODE_CCPROGRESS_TIMER_H__
 
 #include "sprite_nodes/CCSprite.h"
+#include "renderer/CCQuadCommand.h"
+#include <vector>
 #ifdef EMSCRIPTEN
 #include "base_nodes/CCGLBufferedNode.h"
 #endif // EMSCRIPTEN
@@ -126,6 +128,8 @@ protected:
     void updateRadial(void);
     void updateColor(void);
     Point boundaryTexCoord(char index);
+    /** converts the triangle fan or strips of _vertexData to the quads drawn by the Renderer */
+    void updateQuads(void);
 
     Type _type;
     Point _midpoint;
@@ -134,6 +138,8 @@ protected:
     Sprite *_sprite;
     int _vertexDataCount;
     V2F_C4B_T2F *_vertexData;
+    std::vector<V3F_C4B_T2F_Quad> _quads;
+    QuadCommand _quadCommand;
 
     bool _reverseDirection;
 };
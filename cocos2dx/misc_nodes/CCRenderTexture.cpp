@@ -37,15 +37,82 @@ THE SOFTWARE.
 #include "support/CCNotificationCenter.h"
 #include "CCEventType.h"
 #include "effects/CCGrid.h"
+#include "renderer/CCRenderer.h"
+#include "support/CCJobSystem.h"
+#include "support/CCGPUProfiler.h"
+#include "CCScheduler.h"
 // extern
 #include "kazmath/GL/matrix.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 NS_CC_BEGIN
 
+// render targets of deallocated transient render textures, waiting to be reused
+struct RenderTarget
+{
+    int width;
+    int height;
+    Texture2D::PixelFormat pixelFormat;
+    GLuint depthStencilFormat;
+    Texture2D *texture;
+    Texture2D *textureCopy;
+    GLuint FBO;
+    GLuint depthRenderBuffer;
+};
+
+static const unsigned int kMaxPooledRenderTargets = 8;
+static std::vector<RenderTarget> s_renderTargetPool;
+
+static void deleteRenderTarget(const RenderTarget& target)
+{
+    GL::deleteFramebuffer(target.FBO);
+    if (target.depthRenderBuffer)
+    {
+        glDeleteRenderbuffers(1, &target.depthRenderBuffer);
+    }
+    target.texture->release();
+    CC_SAFE_RELEASE(target.textureCopy);
+}
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+// the pooled render targets don't survive the loss of the GL context: they are deleted while it is still alive
+class RenderTargetPoolListener : public Object
+{
+public:
+    RenderTargetPoolListener()
+    {
+        NotificationCenter::getInstance()->addObserver(this,
+                                                       callfuncO_selector(RenderTargetPoolListener::listenToBackground),
+                                                       EVENT_COME_TO_BACKGROUND,
+                                                       NULL);
+    }
+
+    void listenToBackground(Object *obj)
+    {
+        RenderTexture::purgeCachedData();
+    }
+};
+
+static RenderTargetPoolListener *s_renderTargetPoolListener = nullptr;
+#endif
+
+void RenderTexture::purgeCachedData()
+{
+    for (const auto& target : s_renderTargetPool)
+    {
+        deleteRenderTarget(target);
+    }
+    s_renderTargetPool.clear();
+}
+
 // implementation RenderTexture
 RenderTexture::RenderTexture()
 : _FBO(0)
 , _depthRenderBufffer(0)
+, _depthStencilFormat(0)
 , _oldFBO(0)
 , _texture(0)
 , _textureCopy(0)
@@ -56,6 +123,11 @@ RenderTexture::RenderTexture()
 , _clearDepth(0.0f)
 , _clearStencil(0)
 , _autoDraw(false)
+, _preserveContent(true)
+, _transient(false)
+, _scissored(false)
+, _oldScissorEnabled(false)
+, _dirtyTileColumns(0)
 , _sprite(NULL)
 {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -75,10 +147,16 @@ RenderTexture::RenderTexture()
 
 RenderTexture::~RenderTexture()
 {
+    if (_transient && _texture && ! recycleRenderTarget())
+    {
+        // the reference kept for the pool
+        _texture->release();
+    }
+
     CC_SAFE_RELEASE(_sprite);
     CC_SAFE_RELEASE(_textureCopy);
     
-    glDeleteFramebuffers(1, &_FBO);
+    GL::deleteFramebuffer(_FBO);
     if (_depthRenderBufffer)
     {
         glDeleteRenderbuffers(1, &_depthRenderBufffer);
@@ -94,28 +172,45 @@ RenderTexture::~RenderTexture()
 void RenderTexture::listenToBackground(cocos2d::Object *obj)
 {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
-    CC_SAFE_DELETE(_UITextureImage);
-    
-    // to get the rendered texture data
-    _UITextureImage = newImage(false);
-
-    if (_UITextureImage)
+    const Size& s = _texture->getContentSizeInPixels();
+    if (_preserveContent)
     {
-        const Size& s = _texture->getContentSizeInPixels();
-        VolatileTexture::addDataTexture(_texture, _UITextureImage->getData(), Texture2D::PixelFormat::RGBA8888, s);
-        
-        if ( _textureCopy )
+        // to get the rendered texture data
+        if (readBackContent())
         {
-            VolatileTexture::addDataTexture(_textureCopy, _UITextureImage->getData(), Texture2D::PixelFormat::RGBA8888, s);
+            VolatileTexture::addDataTexture(_texture, _UITextureImage->getData(), Texture2D::PixelFormat::RGBA8888, s);
+
+            if ( _textureCopy )
+            {
+                VolatileTexture::addDataTexture(_textureCopy, _UITextureImage->getData(), Texture2D::PixelFormat::RGBA8888, s);
+            }
+        }
+        else
+        {
+            CCLOG("Cache rendertexture failed!");
         }
     }
     else
     {
-        CCLOG("Cache rendertexture failed!");
+        CC_SAFE_DELETE(_UITextureImage);
+        _dirtyTiles.clear();
+
+        // the textures are recreated empty, without reading them back
+        VolatileTexture::addDataTexture(_texture, nullptr, _pixelFormat, s);
+
+        if ( _textureCopy )
+        {
+            VolatileTexture::addDataTexture(_textureCopy, nullptr, _pixelFormat, s);
+        }
     }
     
-    glDeleteFramebuffers(1, &_FBO);
+    GL::deleteFramebuffer(_FBO);
     _FBO = 0;
+    if (_depthRenderBufffer)
+    {
+        glDeleteRenderbuffers(1, &_depthRenderBufffer);
+        _depthRenderBufffer = 0;
+    }
 #endif
 }
 
@@ -123,10 +218,10 @@ void RenderTexture::listenToForeground(cocos2d::Object *obj)
 {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     // -- regenerate frame buffer object and attach the texture
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
+    _oldFBO = GL::getBoundFramebuffer();
     
     glGenFramebuffers(1, &_FBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+    GL::bindFramebuffer(_FBO);
     
     _texture->setAliasTexParameters();
     
@@ -136,10 +231,119 @@ void RenderTexture::listenToForeground(cocos2d::Object *obj)
     }
     
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getName(), 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
+
+    if (_depthStencilFormat != 0)
+    {
+        GLint oldRBO;
+        glGetIntegerv(GL_RENDERBUFFER_BINDING, &oldRBO);
+
+        glGenRenderbuffers(1, &_depthRenderBufffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, _depthRenderBufffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, _depthStencilFormat, (GLsizei)_texture->getPixelsWide(), (GLsizei)_texture->getPixelsHigh());
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthRenderBufffer);
+        if (_depthStencilFormat == GL_DEPTH24_STENCIL8)
+        {
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthRenderBufffer);
+        }
+        glBindRenderbuffer(GL_RENDERBUFFER, oldRBO);
+    }
+    GL::bindFramebuffer(_oldFBO);
+#endif
+}
+
+void RenderTexture::markDirty(int x, int y, int width, int height)
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // without a previous copy, the whole content is read back anyway
+    if (! _UITextureImage || _dirtyTiles.empty() || width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    const int tileSize = CC_RENDER_TEXTURE_DIRTY_TILE_SIZE;
+    int rows = (int)_dirtyTiles.size() / _dirtyTileColumns;
+    int lastColumn = std::min((x + width - 1) / tileSize, _dirtyTileColumns - 1);
+    int lastRow = std::min((y + height - 1) / tileSize, rows - 1);
+
+    for (int row = y / tileSize; row <= lastRow; ++row)
+    {
+        for (int column = x / tileSize; column <= lastColumn; ++column)
+        {
+            _dirtyTiles[row * _dirtyTileColumns + column] = true;
+        }
+    }
 #endif
 }
 
+bool RenderTexture::readBackContent()
+{
+    const Size& s = _texture->getContentSizeInPixels();
+    int width = (int)s.width;
+    int height = (int)s.height;
+
+    const int tileSize = CC_RENDER_TEXTURE_DIRTY_TILE_SIZE;
+    int columns = (width + tileSize - 1) / tileSize;
+    int rows = (height + tileSize - 1) / tileSize;
+
+    size_t dirtyCount = std::count(_dirtyTiles.begin(), _dirtyTiles.end(), true);
+
+    // once most of the tiles changed, reading back the whole texture at once is faster
+    if (_UITextureImage && _dirtyTiles.size() == (size_t)(columns * rows) && dirtyCount * 2 <= _dirtyTiles.size())
+    {
+        if (dirtyCount > 0)
+        {
+            GLubyte *data = _UITextureImage->getData();
+            std::vector<GLubyte> pixels;
+
+            this->beginRendering();
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            for (int row = 0; row < rows; ++row)
+            {
+                int column = 0;
+                while (column < columns)
+                {
+                    if (! _dirtyTiles[row * columns + column])
+                    {
+                        ++column;
+                        continue;
+                    }
+
+                    // the consecutive changed tiles of a row are read at once
+                    int first = column;
+                    while (column < columns && _dirtyTiles[row * columns + column])
+                    {
+                        ++column;
+                    }
+
+                    int x = first * tileSize;
+                    int y = row * tileSize;
+                    int w = std::min(column * tileSize, width) - x;
+                    int h = std::min(y + tileSize, height) - y;
+
+                    pixels.resize(w * h * 4);
+                    glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+                    for (int i = 0; i < h; ++i)
+                    {
+                        memcpy(&data[((y + i) * width + x) * 4], &pixels[i * w * 4], w * 4);
+                    }
+                }
+            }
+            this->end();
+
+            std::fill(_dirtyTiles.begin(), _dirtyTiles.end(), false);
+        }
+        return true;
+    }
+
+    CC_SAFE_DELETE(_UITextureImage);
+    _UITextureImage = newImage(false);
+
+    _dirtyTiles.assign(columns * rows, false);
+    _dirtyTileColumns = columns;
+
+    return _UITextureImage != NULL;
+}
+
 RenderTexture * RenderTexture::create(int w, int h, Texture2D::PixelFormat eFormat)
 {
     RenderTexture *pRet = new RenderTexture();
@@ -166,6 +370,30 @@ RenderTexture * RenderTexture::create(int w ,int h, Texture2D::PixelFormat eForm
     return NULL;
 }
 
+RenderTexture * RenderTexture::createTransient(int w, int h, Texture2D::PixelFormat format, GLuint depthStencilFormat)
+{
+    RenderTexture *pRet = new RenderTexture();
+
+    if (pRet)
+    {
+        pRet->_transient = true;
+        pRet->_preserveContent = false;
+    }
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    if (! s_renderTargetPoolListener)
+    {
+        s_renderTargetPoolListener = new RenderTargetPoolListener();
+    }
+#endif
+    if(pRet && pRet->initWithWidthAndHeight(w, h, format, depthStencilFormat))
+    {
+        pRet->autorelease();
+        return pRet;
+    }
+    CC_SAFE_DELETE(pRet);
+    return NULL;
+}
+
 RenderTexture * RenderTexture::create(int w, int h)
 {
     RenderTexture *pRet = new RenderTexture();
@@ -189,13 +417,56 @@ bool RenderTexture::initWithWidthAndHeight(int w, int h, Texture2D::PixelFormat
     CCASSERT(eFormat != Texture2D::PixelFormat::A8, "only RGB and RGBA formats are valid for a render texture");
 
     bool bRet = false;
-    void *data = NULL;
     do 
     {
         w = (int)(w * CC_CONTENT_SCALE_FACTOR());
         h = (int)(h * CC_CONTENT_SCALE_FACTOR());
 
-        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
+        _pixelFormat = eFormat;
+        _depthStencilFormat = uDepthStencilFormat;
+
+        bool reused = _transient && reuseRenderTarget(w, h);
+        CC_BREAK_IF(! reused && ! createRenderTarget(w, h));
+
+        _texture->setAliasTexParameters();
+
+        // retained
+        setSprite(Sprite::createWithTexture(_texture));
+
+        // transient render textures keep a reference to give the texture back to the pool
+        if (! _transient)
+        {
+            _texture->release();
+        }
+        _sprite->setScaleY(-1);
+
+        _sprite->setBlendFunc( BlendFunc::ALPHA_PREMULTIPLIED );
+
+        // Diabled by default.
+        _autoDraw = false;
+        
+        // add sprite for backward compatibility
+        addChild(_sprite);
+
+        if (reused)
+        {
+            // remove the content drawn by the previous user
+            clear(0, 0, 0, 0);
+        }
+        
+        bRet = true;
+    } while (0);
+    
+    return bRet;
+}
+
+bool RenderTexture::createRenderTarget(int w, int h)
+{
+    bool bRet = false;
+    void *data = NULL;
+    do
+    {
+        _oldFBO = GL::getBoundFramebuffer();
 
         // textures must be power of two squared
         unsigned int powW = 0;
@@ -216,7 +487,6 @@ bool RenderTexture::initWithWidthAndHeight(int w, int h, Texture2D::PixelFormat
         CC_BREAK_IF(! data);
 
         memset(data, 0, (int)(powW * powH * 4));
-        _pixelFormat = eFormat;
 
         _texture = new Texture2D();
         if (_texture)
@@ -245,21 +515,21 @@ bool RenderTexture::initWithWidthAndHeight(int w, int h, Texture2D::PixelFormat
 
         // generate FBO
         glGenFramebuffers(1, &_FBO);
-        glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+        GL::bindFramebuffer(_FBO);
 
         // associate texture with FBO
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getName(), 0);
 
-        if (uDepthStencilFormat != 0)
+        if (_depthStencilFormat != 0)
         {
             //create and attach depth buffer
             glGenRenderbuffers(1, &_depthRenderBufffer);
             glBindRenderbuffer(GL_RENDERBUFFER, _depthRenderBufffer);
-            glRenderbufferStorage(GL_RENDERBUFFER, uDepthStencilFormat, (GLsizei)powW, (GLsizei)powH);
+            glRenderbufferStorage(GL_RENDERBUFFER, _depthStencilFormat, (GLsizei)powW, (GLsizei)powH);
             glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthRenderBufffer);
 
             // if depth format is the one with stencil part, bind same render buffer as stencil attachment
-            if (uDepthStencilFormat == GL_DEPTH24_STENCIL8)
+            if (_depthStencilFormat == GL_DEPTH24_STENCIL8)
             {
                 glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthRenderBufffer);
             }
@@ -268,35 +538,117 @@ bool RenderTexture::initWithWidthAndHeight(int w, int h, Texture2D::PixelFormat
         // check if it worked (probably worth doing :) )
         CCASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Could not attach texture to framebuffer");
 
-        _texture->setAliasTexParameters();
-
-        // retained
-        setSprite(Sprite::createWithTexture(_texture));
-
-        _texture->release();
-        _sprite->setScaleY(-1);
-
-        _sprite->setBlendFunc( BlendFunc::ALPHA_PREMULTIPLIED );
-
         glBindRenderbuffer(GL_RENDERBUFFER, oldRBO);
-        glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
-        
-        // Diabled by default.
-        _autoDraw = false;
-        
-        // add sprite for backward compatibility
-        addChild(_sprite);
-        
+        GL::bindFramebuffer(_oldFBO);
+
         bRet = true;
     } while (0);
-    
+
     CC_SAFE_FREE(data);
-    
+
     return bRet;
 }
 
+bool RenderTexture::reuseRenderTarget(int w, int h)
+{
+    for (auto iter = s_renderTargetPool.begin(); iter != s_renderTargetPool.end(); ++iter)
+    {
+        if (iter->width == w && iter->height == h
+            && iter->pixelFormat == _pixelFormat && iter->depthStencilFormat == _depthStencilFormat)
+        {
+            // the references of the pool are taken over
+            _texture = iter->texture;
+            _textureCopy = iter->textureCopy;
+            _FBO = iter->FBO;
+            _depthRenderBufffer = iter->depthRenderBuffer;
+            s_renderTargetPool.erase(iter);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RenderTexture::recycleRenderTarget()
+{
+    // the sprite is a child as well. If nobody else uses the sprite and the textures,
+    // they will be released with the render texture
+    unsigned int spriteReferences = (_sprite->getParent() == this) ? 2 : 1;
+    if (! _FBO || _sprite->retainCount() != spriteReferences || _texture->retainCount() != 2
+        || (_textureCopy && _textureCopy->retainCount() != 1))
+    {
+        return false;
+    }
+
+    if (s_renderTargetPool.size() >= kMaxPooledRenderTargets)
+    {
+        deleteRenderTarget(s_renderTargetPool.front());
+        s_renderTargetPool.erase(s_renderTargetPool.begin());
+    }
+
+    const Size& s = _texture->getContentSizeInPixels();
+    RenderTarget target = { (int)s.width, (int)s.height, _pixelFormat, _depthStencilFormat,
+                            _texture, _textureCopy, _FBO, _depthRenderBufffer };
+    s_renderTargetPool.push_back(target);
+
+    // the references are taken over by the pool
+    _textureCopy = nullptr;
+    _FBO = 0;
+    _depthRenderBufffer = 0;
+    return true;
+}
+
+// the zone of GPUProfiler measuring the passes between begin() and end()
+static unsigned int getGPUZone()
+{
+    static unsigned int zone = GPUProfiler::registerZone("GPU - RenderTexture");
+    return zone;
+}
+
 void RenderTexture::begin()
 {
+    const Size& texSize = _texture->getContentSizeInPixels();
+    markDirty(0, 0, (int)texSize.width, (int)texSize.height);
+
+    beginRendering();
+}
+
+void RenderTexture::beginWithRect(const Rect& rect)
+{
+    const Size& texSize = _texture->getContentSizeInPixels();
+    Rect pixels = CC_RECT_POINTS_TO_PIXELS(rect);
+
+    // rounded outwards, so that the pixels partly covered are drawn
+    int left = std::max(0, (int)floorf(pixels.getMinX()));
+    int bottom = std::max(0, (int)floorf(pixels.getMinY()));
+    int right = std::min((int)texSize.width, (int)ceilf(pixels.getMaxX()));
+    int top = std::min((int)texSize.height, (int)ceilf(pixels.getMaxY()));
+
+    _scissored = true;
+    _scissorBox[0] = left;
+    _scissorBox[1] = bottom;
+    _scissorBox[2] = std::max(0, right - left);
+    _scissorBox[3] = std::max(0, top - bottom);
+    markDirty(_scissorBox[0], _scissorBox[1], _scissorBox[2], _scissorBox[3]);
+
+    beginRendering();
+}
+
+void RenderTexture::beginWithRectAndClear(const Rect& rect, float r, float g, float b, float a)
+{
+    beginWithRect(rect);
+    clearBuffers(r, g, b, a, 0, 0, GL_COLOR_BUFFER_BIT);
+}
+
+void RenderTexture::beginRendering()
+{
+    // commands recorded so far belong to the previous framebuffer
+    Director::getInstance()->getRenderer()->flush();
+
+    if (GPUProfiler::isEnabled())
+    {
+        GPUProfiler::getInstance()->beginZone(getGPUZone());
+    }
+
     kmGLMatrixMode(KM_GL_PROJECTION);
 	kmGLPushMatrix();
 	kmGLMatrixMode(KM_GL_MODELVIEW);
@@ -321,8 +673,8 @@ void RenderTexture::begin()
         (float)-1.0 / heightRatio, (float)1.0 / heightRatio, -1,1 );
     kmGLMultMatrix(&orthoMatrix);
 
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+    _oldFBO = GL::getBoundFramebuffer();
+    GL::bindFramebuffer(_FBO);
     
     /*  Certain Qualcomm Andreno gpu's will retain data in memory after a frame buffer switch which corrupts the render to the texture. The solution is to clear the frame buffer before rendering to the texture. However, calling glClear has the unintended result of clearing the current texture. Create a temporary texture to overcome this. At the end of RenderTexture::begin(), switch the attached texture to the second one, call glClear, and then switch back to the original texture. This solution is unnecessary for other devices as they don't have the same issue with switching frame buffers.
      */
@@ -334,6 +686,19 @@ void RenderTexture::begin()
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getName(), 0);
     }
+
+    // the scissor box of the framebuffer drawn before doesn't apply to the texture
+    _oldScissorEnabled = GL::isEnabled(GL_SCISSOR_TEST);
+    GL::getScissorBox(_oldScissorBox);
+    if (_scissored)
+    {
+        GL::enable(GL_SCISSOR_TEST);
+        GL::scissor(_scissorBox[0], _scissorBox[1], _scissorBox[2], _scissorBox[3]);
+    }
+    else
+    {
+        GL::disable(GL_SCISSOR_TEST);
+    }
 }
 
 void RenderTexture::beginWithClear(float r, float g, float b, float a)
@@ -354,7 +719,11 @@ void RenderTexture::beginWithClear(float r, float g, float b, float a, float dep
 void RenderTexture::beginWithClear(float r, float g, float b, float a, float depthValue, int stencilValue, GLbitfield flags)
 {
     this->begin();
+    clearBuffers(r, g, b, a, depthValue, stencilValue, flags);
+}
 
+void RenderTexture::clearBuffers(float r, float g, float b, float a, float depthValue, int stencilValue, GLbitfield flags)
+{
     // save clear color
     GLfloat	clearColor[4] = {0.0f};
     GLfloat depthClearValue = 0.0f;
@@ -398,12 +767,29 @@ void RenderTexture::beginWithClear(float r, float g, float b, float a, float dep
 void RenderTexture::end()
 {
     Director *director = Director::getInstance();
+    director->getRenderer()->flush();
+
+    if (GPUProfiler::isEnabled())
+    {
+        GPUProfiler::getInstance()->endZone(getGPUZone());
+    }
     
-    glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
+    GL::bindFramebuffer(_oldFBO);
 
     // restore viewport
     director->setViewport();
 
+    if (_oldScissorEnabled)
+    {
+        GL::enable(GL_SCISSOR_TEST);
+    }
+    else
+    {
+        GL::disable(GL_SCISSOR_TEST);
+    }
+    GL::scissor(_oldScissorBox[0], _oldScissorBox[1], _oldScissorBox[2], _oldScissorBox[3]);
+    _scissored = false;
+
     kmGLMatrixMode(KM_GL_PROJECTION);
 	kmGLPopMatrix();
 	kmGLMatrixMode(KM_GL_MODELVIEW);
@@ -416,9 +802,16 @@ void RenderTexture::clear(float r, float g, float b, float a)
     this->end();
 }
 
+void RenderTexture::clearRect(const Rect& rect, float r, float g, float b, float a)
+{
+    this->beginWithRectAndClear(rect, r, g, b, a);
+    this->end();
+}
+
 void RenderTexture::clearDepth(float depthValue)
 {
-    this->begin();
+    // only the color is read back, the content isn't changed
+    this->beginRendering();
     //! save old depth value
     GLfloat depthClearValue;
     glGetFloatv(GL_DEPTH_CLEAR_VALUE, &depthClearValue);
@@ -433,6 +826,8 @@ void RenderTexture::clearDepth(float depthValue)
 
 void RenderTexture::clearStencil(int stencilValue)
 {
+    Director::getInstance()->getRenderer()->flush();
+
     // save old stencil value
     int stencilClearValue;
     glGetIntegerv(GL_STENCIL_CLEAR_VALUE, &stencilClearValue);
@@ -527,11 +922,8 @@ void RenderTexture::draw()
 		//! make sure all children are drawn
         sortAllChildren();
 		
-		Object *pElement;
-		CCARRAY_FOREACH(_children, pElement)
+        for (auto child : _children)
         {
-            Node *child = static_cast<Node*>(pElement);
-
             if (child != _sprite)
             {
                 child->visit();
@@ -574,6 +966,21 @@ bool RenderTexture::saveToFile(const char *fileName, Image::Format format)
     return bRet;
 }
 
+void RenderTexture::saveToFileAsync(const char *fileName, Image::Format format, const std::function<void(bool, const std::string&)>& callback)
+{
+    CCASSERT(format == Image::Format::JPG || format == Image::Format::PNG,
+             "the image can only be saved as JPG or PNG format");
+
+    std::string fullpath = FileUtils::getInstance()->getWritablePath() + fileName;
+
+    readImageAsync(true, fullpath, [callback, fullpath](Image *image, bool saved) {
+        if (callback)
+        {
+            callback(saved, fullpath);
+        }
+    });
+}
+
 /* get buffer as Image */
 Image* RenderTexture::newImage(bool fliimage)
 {
@@ -607,7 +1014,7 @@ Image* RenderTexture::newImage(bool fliimage)
             break;
         }
 
-        this->begin();
+        this->beginRendering();
         glPixelStorei(GL_PACK_ALIGNMENT, 1);
         glReadPixels(0,0,nSavedBufferWidth, nSavedBufferHeight,GL_RGBA,GL_UNSIGNED_BYTE, pTempData);
         this->end();
@@ -638,4 +1045,129 @@ Image* RenderTexture::newImage(bool fliimage)
     return image;
 }
 
+// the pixels of an asynchronous read back, turned into an Image by a task of the JobSystem
+struct ImageReadback
+{
+    std::vector<GLubyte> pixels;
+    int width;
+    int height;
+    bool flip;
+    std::string path;
+    Image *image;
+    bool saved;
+};
+
+static void createImageInTask(const std::shared_ptr<ImageReadback>& readback, const std::function<void(Image*, bool)>& callback)
+{
+    JobSystem::getInstance()->addTask([readback]() {
+        int rowSize = readback->width * 4;
+        if (readback->flip)
+        {
+            std::vector<GLubyte> flipped(readback->pixels.size());
+            for (int i = 0; i < readback->height; ++i)
+            {
+                memcpy(&flipped[i * rowSize], &readback->pixels[(readback->height - i - 1) * rowSize], rowSize);
+            }
+            readback->pixels.swap(flipped);
+        }
+
+        Image *image = new Image();
+        if (image->initWithImageData(readback->pixels.data(), rowSize * readback->height, Image::Format::RAW_DATA, readback->width, readback->height, 8))
+        {
+            readback->image = image;
+            if (! readback->path.empty())
+            {
+                readback->saved = image->saveToFile(readback->path.c_str(), true);
+            }
+        }
+        else
+        {
+            image->release();
+        }
+        std::vector<GLubyte>().swap(readback->pixels);
+    }, [readback, callback]() {
+        callback(readback->image, readback->saved);
+        CC_SAFE_RELEASE(readback->image);
+    });
+}
+
+void RenderTexture::readImageAsync(bool flipImage, const std::string& path, const std::function<void(Image*, bool)>& callback)
+{
+    CCASSERT(_pixelFormat == Texture2D::PixelFormat::RGBA8888, "only RGBA8888 can be saved as image");
+
+    if (NULL == _texture)
+    {
+        callback(NULL, false);
+        return;
+    }
+
+    const Size& s = _texture->getContentSizeInPixels();
+
+    auto readback = std::make_shared<ImageReadback>();
+    readback->width = (int)s.width;
+    readback->height = (int)s.height;
+    readback->flip = flipImage;
+    readback->path = path;
+    readback->image = NULL;
+    readback->saved = false;
+    GLsizeiptr size = readback->width * readback->height * 4;
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    if (Configuration::getInstance()->supportsPixelBufferObject())
+    {
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+
+        this->beginRendering();
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, readback->width, readback->height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        this->end();
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        // the GPU copies the pixels meanwhile, the buffer is read in the next frame
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([readback, buffer, size, callback]() {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+            const GLubyte *data = (const GLubyte*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+            if (data)
+            {
+                readback->pixels.assign(data, data + size);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glDeleteBuffers(1, &buffer);
+
+            if (data)
+            {
+                createImageInTask(readback, callback);
+            }
+            else
+            {
+                callback(NULL, false);
+            }
+        });
+        return;
+    }
+#endif
+
+    // without pixel buffer objects, only creating the image doesn't block
+    readback->pixels.resize(size);
+
+    this->beginRendering();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, readback->width, readback->height, GL_RGBA, GL_UNSIGNED_BYTE, readback->pixels.data());
+    this->end();
+
+    createImageInTask(readback, callback);
+}
+
+void RenderTexture::newImageAsync(const std::function<void(Image*)>& callback, bool flipImage)
+{
+    readImageAsync(flipImage, "", [callback](Image *image, bool saved) {
+        callback(image);
+    });
+}
+
 NS_CC_END
@@ -30,6 +30,10 @@ THE SOFTWARE.
 #include "kazmath/mat4.h"
 #include "platform/CCImage.h"
 
+#include <functional>
+#include <string>
+#include <vector>
+
 NS_CC_BEGIN
 
 /**
@@ -59,6 +63,19 @@ public:
     /** creates a RenderTexture object with width and height in Points, pixel format is RGBA8888 */
     static RenderTexture * create(int w, int h);
 
+    /** creates a RenderTexture object whose framebuffer, textures and depth buffer are taken from a pool of render targets
+     of the same size and formats, and given back to it when the RenderTexture is deallocated.
+     It is meant for short lived uses like transitions, blur passes or screenshots. A reused target is cleared to transparent,
+     and its content is not preserved when the app goes to background.
+     @since v3.0
+     */
+    static RenderTexture * createTransient(int w, int h, Texture2D::PixelFormat format = Texture2D::PixelFormat::RGBA8888, GLuint depthStencilFormat = 0);
+
+    /** releases the pooled render targets that aren't used by a RenderTexture
+     @since v3.0
+     */
+    static void purgeCachedData();
+
     RenderTexture();
     virtual ~RenderTexture();
     
@@ -83,6 +100,18 @@ public:
      This is more efficient then calling -clear first and then -begin */
     void beginWithClear(float r, float g, float b, float a, float depthValue, int stencilValue);
 
+    /** starts rendering to a region of the texture, in points from its bottom left corner. The clears and the drawing
+     are scissored to the region until end() is called, and only the region is marked as changed: when the app goes
+     to background on Android, only the tiles changed since the previous time are read back.
+     @since v3.0
+     */
+    void beginWithRect(const Rect& rect);
+
+    /** starts rendering to a region of the texture while clearing the region first, see beginWithRect()
+     @since v3.0
+     */
+    void beginWithRectAndClear(const Rect& rect, float r, float g, float b, float a);
+
     /** end is key word of lua, use other name to export to lua. */
     inline void endToLua(){ end();};
 
@@ -92,6 +121,11 @@ public:
     /** clears the texture with a color */
     void clear(float r, float g, float b, float a);
 
+    /** clears a region of the texture, in points from its bottom left corner, with a color
+     @since v3.0
+     */
+    void clearRect(const Rect& rect, float r, float g, float b, float a);
+
     /** clears the texture with a specified depth value */
     void clearDepth(float depthValue);
 
@@ -105,6 +139,23 @@ public:
     
     CC_DEPRECATED_ATTRIBUTE Image* newCCImage(bool flipImage = true) { return newImage(flipImage); };
 
+    /** creates a new Image with the texture's data without blocking the game.
+     The pixels are copied by the GPU into a pixel buffer object, when supported, and read in the next frame;
+     otherwise they are read immediately. The Image is created by a task of the JobSystem.
+     The callback is called on the main thread with the Image, or NULL if it failed. The Image is released
+     once the callback returns: retain it to keep it.
+     @since v3.0
+     */
+    void newImageAsync(const std::function<void(Image*)>& callback, bool flipImage = true);
+
+    /** saves the texture into a file without blocking the game, see newImageAsync(). The format could be JPG or PNG,
+     and the image is encoded by a task of the JobSystem. The file will be saved in the Documents folder.
+     The callback, which can be nullptr, is called on the main thread with whether the operation is successful
+     and the full path of the file.
+     @since v3.0
+     */
+    void saveToFileAsync(const char *name, Image::Format format, const std::function<void(bool, const std::string&)>& callback);
+
     /** saves the texture into a file using JPEG format. The file will be saved in the Documents folder.
         Returns YES if the operation is successful.
      */
@@ -147,6 +198,14 @@ public:
     inline bool isAutoDraw() const { return _autoDraw; };
     inline void setAutoDraw(bool isAutoDraw) { _autoDraw = isAutoDraw; };
 
+    /** When enabled, the content of the texture is read back when the app goes to background and restored when the GL context
+     is recreated. It only has effect on Android. Enabled by default, except for transient render textures.
+     Disable it for render textures whose content is redrawn or can be regenerated: the read back blocks the app while pausing.
+     @since v3.0
+     */
+    inline bool isPreserveContent() const { return _preserveContent; };
+    inline void setPreserveContent(bool preserveContent) { _preserveContent = preserveContent; };
+
     /** Gets the Sprite being used. */
     inline Sprite* getSprite() const { return _sprite; };
     
@@ -163,10 +222,27 @@ public:
 
 private:
     void beginWithClear(float r, float g, float b, float a, float depthValue, int stencilValue, GLbitfield flags);
+    /* binds the framebuffer and sets the projection, without marking the content as changed */
+    void beginRendering();
+    /* clears the buffers of the flags, within the scissor box if a region is rendered */
+    void clearBuffers(float r, float g, float b, float a, float depthValue, int stencilValue, GLbitfield flags);
+    /* marks the tiles covering a region, in pixels, as changed since the content was read back */
+    void markDirty(int x, int y, int width, int height);
+    /* reads back the content into _UITextureImage, only the changed tiles if it holds a previous copy */
+    bool readBackContent();
+    /* reads the pixels, then creates the image in a task, and saves it if a path is given */
+    void readImageAsync(bool flipImage, const std::string& path, const std::function<void(Image*, bool)>& callback);
+    /* creates the framebuffer, the textures and the depth buffer */
+    bool createRenderTarget(int w, int h);
+    /* takes them from the pool of transient render targets, returns false if none matches */
+    bool reuseRenderTarget(int w, int h);
+    /* gives them back to the pool, returns false if they are still used elsewhere */
+    bool recycleRenderTarget();
 
 protected:
     GLuint       _FBO;
     GLuint       _depthRenderBufffer;
+    GLuint       _depthStencilFormat;
     GLint        _oldFBO;
     Texture2D* _texture;
     Texture2D* _textureCopy;    // a copy of _texture
@@ -179,6 +255,19 @@ protected:
     GLclampf     _clearDepth;
     GLint        _clearStencil;
     bool         _autoDraw;
+    bool         _preserveContent;
+    //! whether the render target comes from, and goes back to, the pool
+    bool         _transient;
+
+    //! whether the rendering is scissored to the region given to beginWithRect(), in pixels
+    bool         _scissored;
+    GLint        _scissorBox[4];
+    //! the scissor test of the framebuffer bound before begin(), restored by end()
+    bool         _oldScissorEnabled;
+    GLint        _oldScissorBox[4];
+    //! the tiles changed since _UITextureImage was read back, row by row
+    std::vector<bool> _dirtyTiles;
+    int          _dirtyTileColumns;
 
     /** The Sprite being used.
      The sprite, by default, will use the following blending function: GL_ONE, GL_ONE_MINUS_SRC_ALPHA.
@@ -41,7 +41,7 @@
 #include "support/zip_support/ZipUtils.h"
 #include "platform/CCFileUtils.h"
 #include "kazmath/GL/matrix.h"
-#include "support/CCProfiling.h"
+#include "support/CCFrameProfiler.h"
 
 NS_CC_BEGIN
 
@@ -96,8 +96,7 @@ bool ParticleBatchNode::initWithTexture(Texture2D *tex, unsigned int capacity)
     _textureAtlas->initWithTexture(tex, capacity);
 
     // no lazy alloc in this node
-    _children = new Array();
-    _children->initWithCapacity(capacity);
+    _children.reserve(capacity);
 
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
 
@@ -171,7 +170,7 @@ void ParticleBatchNode::addChild(Node * aChild, int zOrder, int tag)
     ParticleSystem* child = static_cast<ParticleSystem*>(aChild);
     CCASSERT( child->getTexture()->getName() == _textureAtlas->getTexture()->getName(), "CCParticleSystem is not using the same texture id");
     // If this is the 1st children, then copy blending function
-    if( _children->count() == 0 ) 
+    if( _children.empty() ) 
     {
         setBlendFunc(child->getBlendFunc());
     }
@@ -186,7 +185,7 @@ void ParticleBatchNode::addChild(Node * aChild, int zOrder, int tag)
 
     if (pos != 0) 
     {
-        ParticleSystem* p = (ParticleSystem*)_children->objectAtIndex(pos-1);
+        ParticleSystem* p = static_cast<ParticleSystem*>(_children.at(pos-1));
         atlasIndex = p->getAtlasIndex() + p->getTotalParticles();
 
     }
@@ -210,16 +209,10 @@ unsigned int ParticleBatchNode::addChildHelper(ParticleSystem* child, int z, int
     CCASSERT( child != NULL, "Argument must be non-nil");
     CCASSERT( child->getParent() == NULL, "child already added. It can't be added again");
 
-    if( ! _children ) 
-    {
-        _children = new Array();
-        _children->initWithCapacity(4);
-    }
-
     //don't use a lazy insert
     unsigned int pos = searchNewPositionInChildrenForZ(z);
 
-    _children->insertObject(child, pos);
+    _children.insert(pos, child);
 
     child->setTag(aTag);
     child->_setZOrder(z);
@@ -239,7 +232,7 @@ void ParticleBatchNode::reorderChild(Node * aChild, int zOrder)
 {
     CCASSERT( aChild != NULL, "Child must be non-NULL");
     CCASSERT( dynamic_cast<ParticleSystem*>(aChild) != NULL, "CCParticleBatchNode only supports QuadParticleSystems as children");
-    CCASSERT( _children->containsObject(aChild), "Child doesn't belong to batch" );
+    CCASSERT( _children.contains(aChild), "Child doesn't belong to batch" );
 
     ParticleSystem* child = static_cast<ParticleSystem*>(aChild);
 
@@ -249,7 +242,7 @@ void ParticleBatchNode::reorderChild(Node * aChild, int zOrder)
     }
 
     // no reordering if only 1 child
-    if( _children->count() > 1)
+    if( _children.size() > 1)
     {
         unsigned int newIndex = 0, oldIndex = 0;
 
@@ -258,10 +251,10 @@ void ParticleBatchNode::reorderChild(Node * aChild, int zOrder)
         if( oldIndex != newIndex )
         {
 
-            // reorder _children->array
+            // reorder _children
             child->retain();
-            _children->removeObjectAtIndex(oldIndex);
-            _children->insertObject(child, newIndex);
+            _children.erase(oldIndex);
+            _children.insert(newIndex, child);
             child->release();
 
             // save old altasIndex
@@ -272,9 +265,9 @@ void ParticleBatchNode::reorderChild(Node * aChild, int zOrder)
 
             // Find new AtlasIndex
             int newAtlasIndex = 0;
-            for( unsigned int i=0;i < _children->count();i++)
+            for( unsigned int i=0;i < _children.size();i++)
             {
-                ParticleSystem* pNode = (ParticleSystem*)_children->objectAtIndex(i);
+                Node* pNode = _children.at(i);
                 if( pNode == child ) 
                 {
                     newAtlasIndex = child->getAtlasIndex();
@@ -298,11 +291,11 @@ void ParticleBatchNode::getCurrentIndex(unsigned int* oldIndex, unsigned int* ne
     bool foundNewIdx = false;
 
     int  minusOne = 0;
-    unsigned int count = _children->count();
+    unsigned int count = _children.size();
 
     for( unsigned int i=0; i < count; i++ ) 
     {
-        Node* pNode = (Node *)_children->objectAtIndex(i);
+        Node* pNode = _children.at(i);
 
         // new index
         if( pNode->getZOrder() > z &&  ! foundNewIdx ) 
@@ -345,11 +338,11 @@ void ParticleBatchNode::getCurrentIndex(unsigned int* oldIndex, unsigned int* ne
 
 unsigned int ParticleBatchNode::searchNewPositionInChildrenForZ(int z)
 {
-    unsigned int count = _children->count();
+    unsigned int count = _children.size();
 
     for( unsigned int i=0; i < count; i++ ) 
     {
-        Node *child = (Node *)_children->objectAtIndex(i);
+        Node *child = _children.at(i);
         if (child->getZOrder() > z)
         {
             return i;
@@ -366,7 +359,7 @@ void  ParticleBatchNode::removeChild(Node* aChild, bool cleanup)
         return;
     
     CCASSERT( dynamic_cast<ParticleSystem*>(aChild) != NULL, "CCParticleBatchNode only supports QuadParticleSystems as children");
-    CCASSERT(_children->containsObject(aChild), "CCParticleBatchNode doesn't contain the sprite. Can't remove it");
+    CCASSERT(_children.contains(aChild), "CCParticleBatchNode doesn't contain the sprite. Can't remove it");
 
     ParticleSystem* child = static_cast<ParticleSystem*>(aChild);
     Node::removeChild(child, cleanup);
@@ -385,12 +378,15 @@ void  ParticleBatchNode::removeChild(Node* aChild, bool cleanup)
 
 void ParticleBatchNode::removeChildAtIndex(unsigned int index, bool doCleanup)
 {
-    removeChild((ParticleSystem *)_children->objectAtIndex(index),doCleanup);
+    removeChild(_children.at(index),doCleanup);
 }
 
 void ParticleBatchNode::removeAllChildrenWithCleanup(bool doCleanup)
 {
-    arrayMakeObjectsPerformSelectorWithObject(_children, setBatchNode, NULL, ParticleSystem*);
+    for (auto child : _children)
+    {
+        static_cast<ParticleSystem*>(child)->setBatchNode(NULL);
+    }
 
     Node::removeAllChildrenWithCleanup(doCleanup);
 
@@ -399,7 +395,7 @@ void ParticleBatchNode::removeAllChildrenWithCleanup(bool doCleanup)
 
 void ParticleBatchNode::draw(void)
 {
-    CC_PROFILER_START("CCParticleBatchNode - draw");
+    CC_PROFILE_ZONE("CCParticleBatchNode - draw");
 
     if( _textureAtlas->getTotalQuads() == 0 )
     {
@@ -411,8 +407,6 @@ void ParticleBatchNode::draw(void)
     GL::blendFunc( _blendFunc.src, _blendFunc.dst );
 
     _textureAtlas->drawQuads();
-
-    CC_PROFILER_STOP("CCParticleBatchNode - draw");
 }
 
 
@@ -467,12 +461,11 @@ void ParticleBatchNode::insertChild(ParticleSystem* system, int index)
 //rebuild atlas indexes
 void ParticleBatchNode::updateAllAtlasIndexes()
 {
-    Object *pObj = NULL;
     unsigned int index = 0;
 
-    CCARRAY_FOREACH(_children,pObj)
+    for (auto node : _children)
     {
-        ParticleSystem* child = static_cast<ParticleSystem*>(pObj);
+        ParticleSystem* child = static_cast<ParticleSystem*>(node);
         child->setAtlasIndex(index);
         index += child->getTotalParticles();
     }
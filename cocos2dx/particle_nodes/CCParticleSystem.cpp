@@ -46,6 +46,7 @@ THE SOFTWARE.
 #include <string>
 
 #include "CCParticleBatchNode.h"
+#include "CCParticleSystemManager.h"
 #include "ccTypes.h"
 #include "textures/CCTextureCache.h"
 #include "textures/CCTextureAtlas.h"
@@ -53,8 +54,9 @@ THE SOFTWARE.
 #include "platform/CCFileUtils.h"
 #include "platform/CCImage.h"
 #include "support/zip_support/ZipUtils.h"
+#include "cocoa/CCStringDictionary.h"
 #include "CCDirector.h"
-#include "support/CCProfiling.h"
+#include "support/CCFrameProfiler.h"
 // opengl
 #include "CCGL.h"
 
@@ -80,14 +82,84 @@ NS_CC_BEGIN
 //  cocos2d uses a another approach, but the results are almost identical. 
 //
 
+// number of arrays in ParticleData, all made of 4 byte values
+static const unsigned int kParticleDataArrayCount = 26;
+
+ParticleData::ParticleData()
+: maxCount(0)
+, _data(nullptr)
+, _stride(0)
+{
+    assignArrays(nullptr, 0);
+}
+
+ParticleData::~ParticleData()
+{
+    release();
+}
+
+bool ParticleData::init(unsigned int count)
+{
+    release();
+
+    // a multiple of 4 values keeps all the arrays 16 bytes aligned, for the vectorized loops
+    unsigned int stride = (count + 3) & ~3u;
+    _data = calloc(MAX(stride, 4u) * kParticleDataArrayCount, sizeof(float));
+    if (_data == nullptr)
+    {
+        return false;
+    }
+
+    assignArrays(static_cast<float*>(_data), stride);
+    maxCount = count;
+    return true;
+}
+
+void ParticleData::release()
+{
+    CC_SAFE_FREE(_data);
+    assignArrays(nullptr, 0);
+    maxCount = 0;
+}
+
+void ParticleData::assignArrays(float* block, unsigned int stride)
+{
+    _stride = stride;
+    float** arrays[] = {
+        &posx, &posy, &startPosX, &startPosY,
+        &colorR, &colorG, &colorB, &colorA,
+        &deltaColorR, &deltaColorG, &deltaColorB, &deltaColorA,
+        &size, &deltaSize, &rotation, &deltaRotation, &timeToLive,
+        &modeA.dirX, &modeA.dirY, &modeA.radialAccel, &modeA.tangentialAccel,
+        &modeB.angle, &modeB.degreesPerSecond, &modeB.radius, &modeB.deltaRadius,
+    };
+    static_assert(sizeof(arrays) / sizeof(arrays[0]) == kParticleDataArrayCount - 1, "ParticleData: wrong number of arrays");
+
+    for (unsigned int i = 0; i < kParticleDataArrayCount - 1; ++i)
+    {
+        *arrays[i] = block ? block + i * stride : nullptr;
+    }
+    atlasIndex = block ? reinterpret_cast<unsigned int*>(block + (kParticleDataArrayCount - 1) * stride) : nullptr;
+}
+
+void ParticleData::copyParticle(unsigned int dst, unsigned int src)
+{
+    // the arrays are contiguous: copy the value of each one, the atlas index included
+    char* block = static_cast<char*>(_data);
+    for (unsigned int i = 0; i < kParticleDataArrayCount; ++i)
+    {
+        char* array = block + i * _stride * sizeof(float);
+        memcpy(array + dst * sizeof(float), array + src * sizeof(float), sizeof(float));
+    }
+}
+
 ParticleSystem::ParticleSystem()
 : _isBlendAdditive(false)
 , _isAutoRemoveOnFinish(false)
+, _simulatedInParallel(false)
 , _plistFile("")
 , _elapsed(0)
-, _particles(NULL)
 , _emitCounter(0)
-, _particleIdx(0)
 , _batchNode(NULL)
 , _atlasIndex(0)
 , _transformSystemDirty(false)
@@ -163,29 +235,305 @@ bool ParticleSystem::init()
     return initWithTotalParticles(150);
 }
 
+//
+// ParticleTemplate - the parsed plist files
+//
+
+/** The values of a particle plist file, parsed once and copied in the systems created from the same file */
+class ParticleTemplate : public Object
+{
+public:
+    /** the values of the emitter, copied in the systems */
+    struct Config
+    {
+        int maxParticles;
+        float angle;
+        float angleVar;
+        float duration;
+        BlendFunc blendFunc;
+        Color4F startColor;
+        Color4F startColorVar;
+        Color4F endColor;
+        Color4F endColorVar;
+        float startSize;
+        float startSizeVar;
+        float endSize;
+        float endSizeVar;
+        Point sourcePosition;
+        Point posVar;
+        float startSpin;
+        float startSpinVar;
+        float endSpin;
+        float endSpinVar;
+        ParticleSystem::Mode emitterMode;
+        // mode A
+        Point gravity;
+        float speed;
+        float speedVar;
+        float radialAccel;
+        float radialAccelVar;
+        float tangentialAccel;
+        float tangentialAccelVar;
+        bool rotationIsDir;
+        // mode B
+        float startRadius;
+        float startRadiusVar;
+        float endRadius;
+        float endRadiusVar;
+        float rotatePerSecond;
+        float rotatePerSecondVar;
+        float life;
+        float lifeVar;
+    };
+
+    /** Parses a dictionary. The embedded textures without name are cached with plistFile */
+    bool initWithDictionary(Dictionary *dictionary, const char *dirname, const std::string& plistFile);
+
+    /** Returns the texture, loading it again if it isn't in the TextureCache anymore. NULL if there is none */
+    Texture2D* getTexture() const;
+
+    Config config;
+    // key of the texture in the TextureCache, empty if it isn't cached
+    std::string textureKey;
+    // whether or not textureKey is the name of an image file
+    bool textureKeyIsFile;
+    // the base64 gzipped image, used if textureKey isn't an image file
+    std::string textureData;
+};
+
+bool ParticleTemplate::initWithDictionary(Dictionary *dictionary, const char *dirname, const std::string& plistFile)
+{
+    config.maxParticles = dictionary->valueForKey("maxParticles")->intValue();
+
+    // angle
+    config.angle = dictionary->valueForKey("angle")->floatValue();
+    config.angleVar = dictionary->valueForKey("angleVariance")->floatValue();
+
+    // duration
+    config.duration = dictionary->valueForKey("duration")->floatValue();
+
+    // blend function 
+    config.blendFunc.src = dictionary->valueForKey("blendFuncSource")->intValue();
+    config.blendFunc.dst = dictionary->valueForKey("blendFuncDestination")->intValue();
+
+    // color
+    config.startColor.r = dictionary->valueForKey("startColorRed")->floatValue();
+    config.startColor.g = dictionary->valueForKey("startColorGreen")->floatValue();
+    config.startColor.b = dictionary->valueForKey("startColorBlue")->floatValue();
+    config.startColor.a = dictionary->valueForKey("startColorAlpha")->floatValue();
+
+    config.startColorVar.r = dictionary->valueForKey("startColorVarianceRed")->floatValue();
+    config.startColorVar.g = dictionary->valueForKey("startColorVarianceGreen")->floatValue();
+    config.startColorVar.b = dictionary->valueForKey("startColorVarianceBlue")->floatValue();
+    config.startColorVar.a = dictionary->valueForKey("startColorVarianceAlpha")->floatValue();
+
+    config.endColor.r = dictionary->valueForKey("finishColorRed")->floatValue();
+    config.endColor.g = dictionary->valueForKey("finishColorGreen")->floatValue();
+    config.endColor.b = dictionary->valueForKey("finishColorBlue")->floatValue();
+    config.endColor.a = dictionary->valueForKey("finishColorAlpha")->floatValue();
+
+    config.endColorVar.r = dictionary->valueForKey("finishColorVarianceRed")->floatValue();
+    config.endColorVar.g = dictionary->valueForKey("finishColorVarianceGreen")->floatValue();
+    config.endColorVar.b = dictionary->valueForKey("finishColorVarianceBlue")->floatValue();
+    config.endColorVar.a = dictionary->valueForKey("finishColorVarianceAlpha")->floatValue();
+
+    // particle size
+    config.startSize = dictionary->valueForKey("startParticleSize")->floatValue();
+    config.startSizeVar = dictionary->valueForKey("startParticleSizeVariance")->floatValue();
+    config.endSize = dictionary->valueForKey("finishParticleSize")->floatValue();
+    config.endSizeVar = dictionary->valueForKey("finishParticleSizeVariance")->floatValue();
+
+    // position
+    config.sourcePosition.x = dictionary->valueForKey("sourcePositionx")->floatValue();
+    config.sourcePosition.y = dictionary->valueForKey("sourcePositiony")->floatValue();
+    config.posVar.x = dictionary->valueForKey("sourcePositionVariancex")->floatValue();
+    config.posVar.y = dictionary->valueForKey("sourcePositionVariancey")->floatValue();
+
+    // Spinning
+    config.startSpin = dictionary->valueForKey("rotationStart")->floatValue();
+    config.startSpinVar = dictionary->valueForKey("rotationStartVariance")->floatValue();
+    config.endSpin= dictionary->valueForKey("rotationEnd")->floatValue();
+    config.endSpinVar= dictionary->valueForKey("rotationEndVariance")->floatValue();
+
+    config.emitterMode = (ParticleSystem::Mode) dictionary->valueForKey("emitterType")->intValue();
+
+    // Mode A: Gravity + tangential accel + radial accel
+    config.gravity.x = dictionary->valueForKey("gravityx")->floatValue();
+    config.gravity.y = dictionary->valueForKey("gravityy")->floatValue();
+    config.speed = dictionary->valueForKey("speed")->floatValue();
+    config.speedVar = dictionary->valueForKey("speedVariance")->floatValue();
+    config.radialAccel = dictionary->valueForKey("radialAcceleration")->floatValue();
+    config.radialAccelVar = dictionary->valueForKey("radialAccelVariance")->floatValue();
+    config.tangentialAccel = dictionary->valueForKey("tangentialAcceleration")->floatValue();
+    config.tangentialAccelVar = dictionary->valueForKey("tangentialAccelVariance")->floatValue();
+    config.rotationIsDir = dictionary->valueForKey("rotationIsDir")->boolValue();
+
+    // or Mode B: radius movement
+    config.startRadius = dictionary->valueForKey("maxRadius")->floatValue();
+    config.startRadiusVar = dictionary->valueForKey("maxRadiusVariance")->floatValue();
+    config.endRadius = dictionary->valueForKey("minRadius")->floatValue();
+    config.endRadiusVar = 0.0f;
+    config.rotatePerSecond = dictionary->valueForKey("rotatePerSecond")->floatValue();
+    config.rotatePerSecondVar = dictionary->valueForKey("rotatePerSecondVariance")->floatValue();
+
+    if (config.emitterMode != ParticleSystem::Mode::GRAVITY && config.emitterMode != ParticleSystem::Mode::RADIUS)
+    {
+        CCASSERT( false, "Invalid emitterType in config file");
+        return false;
+    }
+
+    // life span
+    config.life = dictionary->valueForKey("particleLifespan")->floatValue();
+    config.lifeVar = dictionary->valueForKey("particleLifespanVariance")->floatValue();
+
+    // texture
+    std::string textureName = dictionary->valueForKey("textureFileName")->getCString();
+
+    size_t rPos = textureName.rfind('/');
+
+    if (rPos != string::npos)
+    {
+        string textureDir = textureName.substr(0, rPos + 1);
+
+        if (dirname != NULL && textureDir != dirname)
+        {
+            textureName = textureName.substr(rPos+1);
+            textureName = string(dirname) + textureName;
+        }
+    }
+    else
+    {
+        if (dirname != NULL)
+        {
+            textureName = string(dirname) + textureName;
+        }
+    }
+
+    textureKeyIsFile = false;
+    if (textureName.length() > 0)
+    {
+        // set not pop-up message box when load image failed
+        bool bNotify = FileUtils::getInstance()->isPopupNotify();
+        FileUtils::getInstance()->setPopupNotify(false);
+        textureKeyIsFile = TextureCache::getInstance()->addImage(textureName.c_str()) != NULL;
+        // reset the value of UIImage notify
+        FileUtils::getInstance()->setPopupNotify(bNotify);
+    }
+
+    // the embedded textures are cached with the name of the texture, or of the plist file
+    textureKey = textureName.length() > 0 ? textureName : plistFile;
+    if (!textureKeyIsFile)
+    {
+        textureData = dictionary->valueForKey("textureImageData")->getCString();
+    }
+
+    return true;
+}
+
+Texture2D* ParticleTemplate::getTexture() const
+{
+    Texture2D *tex = NULL;
+    if (textureKey.length() > 0)
+    {
+        tex = TextureCache::getInstance()->textureForKey(textureKey.c_str());
+        if (tex)
+        {
+            return tex;
+        }
+
+        // the texture was removed from the cache
+        if (textureKeyIsFile)
+        {
+            return TextureCache::getInstance()->addImage(textureKey.c_str());
+        }
+    }
+
+    if (textureData.empty())
+    {
+        return NULL;
+    }
+
+    unsigned char *buffer = NULL;
+    unsigned char *deflated = NULL;
+    do 
+    {
+        // if it fails, try to get it from the base64-gzipped data    
+        int decodeLen = base64Decode((unsigned char*)textureData.c_str(), (unsigned int)textureData.length(), &buffer);
+        CCASSERT( buffer != NULL, "CCParticleSystem: error decoding textureImageData");
+        CC_BREAK_IF(!buffer);
+
+        int deflatedLen = ZipUtils::ccInflateMemory(buffer, decodeLen, &deflated);
+        CCASSERT( deflated != NULL, "CCParticleSystem: error ungzipping textureImageData");
+        CC_BREAK_IF(!deflated);
+
+        // For android, we should retain it in VolatileTexture::addImage which invoked in TextureCache::getInstance()->addUIImage()
+        Image *image = new Image();
+        bool isOK = image->initWithImageData(deflated, deflatedLen);
+        CCASSERT(isOK, "CCParticleSystem: error init image with Data");
+        if (isOK)
+        {
+            tex = TextureCache::getInstance()->addUIImage(image, textureKey.length() > 0 ? textureKey.c_str() : NULL);
+        }
+        image->release();
+    } while (0);
+    CC_SAFE_DELETE_ARRAY(buffer);
+    CC_SAFE_DELETE_ARRAY(deflated);
+
+    return tex;
+}
+
+// the templates of the plist files, by full path
+static StringDictionary* s_particleTemplates = NULL;
+
+void ParticleSystem::purgeCachedData()
+{
+    CC_SAFE_DELETE(s_particleTemplates);
+}
+
 bool ParticleSystem::initWithFile(const char *plistFile)
 {
-    bool bRet = false;
     _plistFile = FileUtils::getInstance()->fullPathForFilename(plistFile);
-    Dictionary *dict = Dictionary::createWithContentsOfFileThreadSafe(_plistFile.c_str());
 
-    CCASSERT( dict != NULL, "Particles: file not found");
-    
-    // XXX compute path from a path, should define a function somewhere to do it
-    string listFilePath = plistFile;
-    if (listFilePath.find('/') != string::npos)
+    if (s_particleTemplates == NULL)
     {
-        listFilePath = listFilePath.substr(0, listFilePath.rfind('/') + 1);
-        bRet = this->initWithDictionary(dict, listFilePath.c_str());
+        s_particleTemplates = new StringDictionary();
     }
-    else
+
+    ParticleTemplate* particleTemplate = static_cast<ParticleTemplate*>(s_particleTemplates->objectForKey(_plistFile));
+    if (particleTemplate == NULL)
     {
-        bRet = this->initWithDictionary(dict, "");
+        Dictionary *dict = Dictionary::createWithContentsOfFileThreadSafe(_plistFile.c_str());
+
+        CCASSERT( dict != NULL, "Particles: file not found");
+        if (dict == NULL)
+        {
+            return false;
+        }
+
+        // XXX compute path from a path, should define a function somewhere to do it
+        string listFilePath = plistFile;
+        if (listFilePath.find('/') != string::npos)
+        {
+            listFilePath = listFilePath.substr(0, listFilePath.rfind('/') + 1);
+        }
+        else
+        {
+            listFilePath = "";
+        }
+
+        particleTemplate = new ParticleTemplate();
+        bool parsed = particleTemplate->initWithDictionary(dict, listFilePath.c_str(), _plistFile);
+        dict->release();
+        if (! parsed)
+        {
+            particleTemplate->release();
+            return false;
+        }
+        s_particleTemplates->setObject(particleTemplate, _plistFile);
+        particleTemplate->release();
     }
-    
-    dict->release();
 
-    return bRet;
+    return initWithTemplate(particleTemplate);
 }
 
 bool ParticleSystem::initWithDictionary(Dictionary *dictionary)
@@ -195,207 +543,94 @@ bool ParticleSystem::initWithDictionary(Dictionary *dictionary)
 
 bool ParticleSystem::initWithDictionary(Dictionary *dictionary, const char *dirname)
 {
-    bool bRet = false;
-    unsigned char *buffer = NULL;
-    unsigned char *deflated = NULL;
-    Image *image = NULL;
-    do 
+    ParticleTemplate particleTemplate;
+    if (! particleTemplate.initWithDictionary(dictionary, dirname, _plistFile))
     {
-        int maxParticles = dictionary->valueForKey("maxParticles")->intValue();
-        // self, not super
-        if(this->initWithTotalParticles(maxParticles))
-        {
-            // angle
-            _angle = dictionary->valueForKey("angle")->floatValue();
-            _angleVar = dictionary->valueForKey("angleVariance")->floatValue();
-
-            // duration
-            _duration = dictionary->valueForKey("duration")->floatValue();
-
-            // blend function 
-            _blendFunc.src = dictionary->valueForKey("blendFuncSource")->intValue();
-            _blendFunc.dst = dictionary->valueForKey("blendFuncDestination")->intValue();
-
-            // color
-            _startColor.r = dictionary->valueForKey("startColorRed")->floatValue();
-            _startColor.g = dictionary->valueForKey("startColorGreen")->floatValue();
-            _startColor.b = dictionary->valueForKey("startColorBlue")->floatValue();
-            _startColor.a = dictionary->valueForKey("startColorAlpha")->floatValue();
-
-            _startColorVar.r = dictionary->valueForKey("startColorVarianceRed")->floatValue();
-            _startColorVar.g = dictionary->valueForKey("startColorVarianceGreen")->floatValue();
-            _startColorVar.b = dictionary->valueForKey("startColorVarianceBlue")->floatValue();
-            _startColorVar.a = dictionary->valueForKey("startColorVarianceAlpha")->floatValue();
-
-            _endColor.r = dictionary->valueForKey("finishColorRed")->floatValue();
-            _endColor.g = dictionary->valueForKey("finishColorGreen")->floatValue();
-            _endColor.b = dictionary->valueForKey("finishColorBlue")->floatValue();
-            _endColor.a = dictionary->valueForKey("finishColorAlpha")->floatValue();
-
-            _endColorVar.r = dictionary->valueForKey("finishColorVarianceRed")->floatValue();
-            _endColorVar.g = dictionary->valueForKey("finishColorVarianceGreen")->floatValue();
-            _endColorVar.b = dictionary->valueForKey("finishColorVarianceBlue")->floatValue();
-            _endColorVar.a = dictionary->valueForKey("finishColorVarianceAlpha")->floatValue();
-
-            // particle size
-            _startSize = dictionary->valueForKey("startParticleSize")->floatValue();
-            _startSizeVar = dictionary->valueForKey("startParticleSizeVariance")->floatValue();
-            _endSize = dictionary->valueForKey("finishParticleSize")->floatValue();
-            _endSizeVar = dictionary->valueForKey("finishParticleSizeVariance")->floatValue();
-
-            // position
-            float x = dictionary->valueForKey("sourcePositionx")->floatValue();
-            float y = dictionary->valueForKey("sourcePositiony")->floatValue();
-            this->setPosition( Point(x,y) );            
-            _posVar.x = dictionary->valueForKey("sourcePositionVariancex")->floatValue();
-            _posVar.y = dictionary->valueForKey("sourcePositionVariancey")->floatValue();
-
-            // Spinning
-            _startSpin = dictionary->valueForKey("rotationStart")->floatValue();
-            _startSpinVar = dictionary->valueForKey("rotationStartVariance")->floatValue();
-            _endSpin= dictionary->valueForKey("rotationEnd")->floatValue();
-            _endSpinVar= dictionary->valueForKey("rotationEndVariance")->floatValue();
-
-            _emitterMode = (Mode) dictionary->valueForKey("emitterType")->intValue();
-
-            // Mode A: Gravity + tangential accel + radial accel
-            if (_emitterMode == Mode::GRAVITY)
-            {
-                // gravity
-                modeA.gravity.x = dictionary->valueForKey("gravityx")->floatValue();
-                modeA.gravity.y = dictionary->valueForKey("gravityy")->floatValue();
-
-                // speed
-                modeA.speed = dictionary->valueForKey("speed")->floatValue();
-                modeA.speedVar = dictionary->valueForKey("speedVariance")->floatValue();
-
-                // radial acceleration
-                modeA.radialAccel = dictionary->valueForKey("radialAcceleration")->floatValue();
-                modeA.radialAccelVar = dictionary->valueForKey("radialAccelVariance")->floatValue();
-
-                // tangential acceleration
-                modeA.tangentialAccel = dictionary->valueForKey("tangentialAcceleration")->floatValue();
-                modeA.tangentialAccelVar = dictionary->valueForKey("tangentialAccelVariance")->floatValue();
-                
-                // rotation is dir
-                modeA.rotationIsDir = dictionary->valueForKey("rotationIsDir")->boolValue();
-            }
+        return false;
+    }
+    return initWithTemplate(&particleTemplate);
+}
 
-            // or Mode B: radius movement
-            else if (_emitterMode == Mode::RADIUS)
-            {
-                modeB.startRadius = dictionary->valueForKey("maxRadius")->floatValue();
-                modeB.startRadiusVar = dictionary->valueForKey("maxRadiusVariance")->floatValue();
-                modeB.endRadius = dictionary->valueForKey("minRadius")->floatValue();
-                modeB.endRadiusVar = 0.0f;
-                modeB.rotatePerSecond = dictionary->valueForKey("rotatePerSecond")->floatValue();
-                modeB.rotatePerSecondVar = dictionary->valueForKey("rotatePerSecondVariance")->floatValue();
-
-            } else {
-                CCASSERT( false, "Invalid emitterType in config file");
-                CC_BREAK_IF(true);
-            }
+bool ParticleSystem::initWithTemplate(ParticleTemplate *particleTemplate)
+{
+    const ParticleTemplate::Config& config = particleTemplate->config;
 
-            // life span
-            _life = dictionary->valueForKey("particleLifespan")->floatValue();
-            _lifeVar = dictionary->valueForKey("particleLifespanVariance")->floatValue();
+    // self, not super
+    if (! this->initWithTotalParticles(config.maxParticles))
+    {
+        return false;
+    }
 
-            // emission Rate
-            _emissionRate = _totalParticles / _life;
+    _angle = config.angle;
+    _angleVar = config.angleVar;
+    _duration = config.duration;
+    _blendFunc = config.blendFunc;
+    _startColor = config.startColor;
+    _startColorVar = config.startColorVar;
+    _endColor = config.endColor;
+    _endColorVar = config.endColorVar;
+    _startSize = config.startSize;
+    _startSizeVar = config.startSizeVar;
+    _endSize = config.endSize;
+    _endSizeVar = config.endSizeVar;
+    this->setPosition(config.sourcePosition);
+    _posVar = config.posVar;
+    _startSpin = config.startSpin;
+    _startSpinVar = config.startSpinVar;
+    _endSpin = config.endSpin;
+    _endSpinVar = config.endSpinVar;
+
+    _emitterMode = config.emitterMode;
+    if (_emitterMode == Mode::GRAVITY)
+    {
+        modeA.gravity = config.gravity;
+        modeA.speed = config.speed;
+        modeA.speedVar = config.speedVar;
+        modeA.radialAccel = config.radialAccel;
+        modeA.radialAccelVar = config.radialAccelVar;
+        modeA.tangentialAccel = config.tangentialAccel;
+        modeA.tangentialAccelVar = config.tangentialAccelVar;
+        modeA.rotationIsDir = config.rotationIsDir;
+    }
+    else
+    {
+        modeB.startRadius = config.startRadius;
+        modeB.startRadiusVar = config.startRadiusVar;
+        modeB.endRadius = config.endRadius;
+        modeB.endRadiusVar = config.endRadiusVar;
+        modeB.rotatePerSecond = config.rotatePerSecond;
+        modeB.rotatePerSecondVar = config.rotatePerSecondVar;
+    }
 
-            //don't get the internal texture if a batchNode is used
-            if (!_batchNode)
-            {
-                // Set a compatible default for the alpha transfer
-                _opacityModifyRGB = false;
-
-                // texture        
-                // Try to get the texture from the cache
-                std::string textureName = dictionary->valueForKey("textureFileName")->getCString();
-                
-                size_t rPos = textureName.rfind('/');
-               
-                if (rPos != string::npos)
-                {
-                    string textureDir = textureName.substr(0, rPos + 1);
-                    
-                    if (dirname != NULL && textureDir != dirname)
-                    {
-                        textureName = textureName.substr(rPos+1);
-                        textureName = string(dirname) + textureName;
-                    }
-                }
-                else
-                {
-                    if (dirname != NULL)
-                    {
-                        textureName = string(dirname) + textureName;
-                    }
-                }
-                
-                Texture2D *tex = NULL;
-                
-                if (textureName.length() > 0)
-                {
-                    // set not pop-up message box when load image failed
-                    bool bNotify = FileUtils::getInstance()->isPopupNotify();
-                    FileUtils::getInstance()->setPopupNotify(false);
-                    tex = TextureCache::getInstance()->addImage(textureName.c_str());
-                    // reset the value of UIImage notify
-                    FileUtils::getInstance()->setPopupNotify(bNotify);
-                }
-                
-                if (tex)
-                {
-                    setTexture(tex);
-                }
-                else
-                {                        
-                    const char *textureData = dictionary->valueForKey("textureImageData")->getCString();
-                    CCASSERT(textureData, "");
-                    
-                    int dataLen = strlen(textureData);
-                    if(dataLen != 0)
-                    {
-                        // if it fails, try to get it from the base64-gzipped data    
-                        int decodeLen = base64Decode((unsigned char*)textureData, (unsigned int)dataLen, &buffer);
-                        CCASSERT( buffer != NULL, "CCParticleSystem: error decoding textureImageData");
-                        CC_BREAK_IF(!buffer);
-                        
-                        int deflatedLen = ZipUtils::ccInflateMemory(buffer, decodeLen, &deflated);
-                        CCASSERT( deflated != NULL, "CCParticleSystem: error ungzipping textureImageData");
-                        CC_BREAK_IF(!deflated);
-                        
-                        // For android, we should retain it in VolatileTexture::addImage which invoked in TextureCache::getInstance()->addUIImage()
-                        image = new Image();
-                        bool isOK = image->initWithImageData(deflated, deflatedLen);
-                        CCASSERT(isOK, "CCParticleSystem: error init image with Data");
-                        CC_BREAK_IF(!isOK);
-                        
-                        setTexture(TextureCache::getInstance()->addUIImage(image, textureName.c_str()));
-
-                        image->release();
-                    }
-                }
-                CCASSERT( this->_texture != NULL, "CCParticleSystem: error loading the texture");
-            }
-            bRet = true;
+    // life span
+    _life = config.life;
+    _lifeVar = config.lifeVar;
+
+    // emission Rate
+    _emissionRate = _totalParticles / _life;
+
+    //don't get the internal texture if a batchNode is used
+    if (!_batchNode)
+    {
+        // Set a compatible default for the alpha transfer
+        _opacityModifyRGB = false;
+
+        Texture2D *tex = particleTemplate->getTexture();
+        if (tex)
+        {
+            setTexture(tex);
         }
-    } while (0);
-    CC_SAFE_DELETE_ARRAY(buffer);
-    CC_SAFE_DELETE_ARRAY(deflated);
-    return bRet;
+        CCASSERT( this->_texture != NULL, "CCParticleSystem: error loading the texture");
+    }
+
+    return true;
 }
 
 bool ParticleSystem::initWithTotalParticles(unsigned int numberOfParticles)
 {
     _totalParticles = numberOfParticles;
 
-    CC_SAFE_FREE(_particles);
-    
-    _particles = (tParticle*)calloc(_totalParticles, sizeof(tParticle));
-
-    if( ! _particles )
+    if( ! _particleData.init(_totalParticles) )
     {
         CCLOG("Particle system: not enough memory");
         this->release();
@@ -407,7 +642,7 @@ bool ParticleSystem::initWithTotalParticles(unsigned int numberOfParticles)
     {
         for (unsigned int i = 0; i < _totalParticles; i++)
         {
-            _particles[i].atlasIndex=i;
+            _particleData.atlasIndex[i] = i;
         }
     }
     // default, active
@@ -444,7 +679,6 @@ ParticleSystem::~ParticleSystem()
     // Since the scheduler retains the "target (in this case the ParticleSystem)
 	// it is not needed to call "unscheduleUpdate" here. In fact, it will be called in "cleanup"
     //unscheduleUpdate();
-    CC_SAFE_FREE(_particles);
     CC_SAFE_RELEASE(_texture);
 }
 
@@ -455,123 +689,178 @@ bool ParticleSystem::addParticle()
         return false;
     }
 
-    tParticle * particle = &_particles[ _particleCount ];
-    this->initParticle(particle);
-    ++_particleCount;
+    this->addParticles(1);
 
     return true;
 }
 
-void ParticleSystem::initParticle(tParticle* particle)
+void ParticleSystem::addParticles(unsigned int count)
 {
+    unsigned int start = _particleCount;
+    _particleCount += count;
+
     // timeToLive
     // no negative life. prevent division by 0
-    particle->timeToLive = _life + _lifeVar * CCRANDOM_MINUS1_1();
-    particle->timeToLive = MAX(0, particle->timeToLive);
+    for (unsigned int i = start; i < _particleCount; ++i)
+    {
+        float timeToLive = _life + _lifeVar * CCRANDOM_MINUS1_1();
+        _particleData.timeToLive[i] = MAX(0, timeToLive);
+    }
 
     // position
-    particle->pos.x = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
-
-    particle->pos.y = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
-
-
-    // Color
-    Color4F start;
-    start.r = clampf(_startColor.r + _startColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    start.g = clampf(_startColor.g + _startColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    start.b = clampf(_startColor.b + _startColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    start.a = clampf(_startColor.a + _startColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
-
-    Color4F end;
-    end.r = clampf(_endColor.r + _endColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    end.g = clampf(_endColor.g + _endColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    end.b = clampf(_endColor.b + _endColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    end.a = clampf(_endColor.a + _endColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
+    for (unsigned int i = start; i < _particleCount; ++i)
+    {
+        _particleData.posx[i] = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
+    }
+    for (unsigned int i = start; i < _particleCount; ++i)
+    {
+        _particleData.posy[i] = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
+    }
 
-    particle->color = start;
-    particle->deltaColor.r = (end.r - start.r) / particle->timeToLive;
-    particle->deltaColor.g = (end.g - start.g) / particle->timeToLive;
-    particle->deltaColor.b = (end.b - start.b) / particle->timeToLive;
-    particle->deltaColor.a = (end.a - start.a) / particle->timeToLive;
+    // Color: the end colors are stored in the delta arrays until the deltas are computed
+#define SET_COLOR(array, value, variance)                                               \
+    for (unsigned int i = start; i < _particleCount; ++i)                               \
+    {                                                                                   \
+        array[i] = clampf(value + variance * CCRANDOM_MINUS1_1(), 0, 1);                \
+    }
+    SET_COLOR(_particleData.colorR, _startColor.r, _startColorVar.r);
+    SET_COLOR(_particleData.colorG, _startColor.g, _startColorVar.g);
+    SET_COLOR(_particleData.colorB, _startColor.b, _startColorVar.b);
+    SET_COLOR(_particleData.colorA, _startColor.a, _startColorVar.a);
+
+    SET_COLOR(_particleData.deltaColorR, _endColor.r, _endColorVar.r);
+    SET_COLOR(_particleData.deltaColorG, _endColor.g, _endColorVar.g);
+    SET_COLOR(_particleData.deltaColorB, _endColor.b, _endColorVar.b);
+    SET_COLOR(_particleData.deltaColorA, _endColor.a, _endColorVar.a);
+#undef SET_COLOR
+
+    for (unsigned int i = start; i < _particleCount; ++i)
+    {
+        _particleData.deltaColorR[i] = (_particleData.deltaColorR[i] - _particleData.colorR[i]) / _particleData.timeToLive[i];
+        _particleData.deltaColorG[i] = (_particleData.deltaColorG[i] - _particleData.colorG[i]) / _particleData.timeToLive[i];
+        _particleData.deltaColorB[i] = (_particleData.deltaColorB[i] - _particleData.colorB[i]) / _particleData.timeToLive[i];
+        _particleData.deltaColorA[i] = (_particleData.deltaColorA[i] - _particleData.colorA[i]) / _particleData.timeToLive[i];
+    }
 
     // size
-    float startS = _startSize + _startSizeVar * CCRANDOM_MINUS1_1();
-    startS = MAX(0, startS); // No negative value
-
-    particle->size = startS;
+    for (unsigned int i = start; i < _particleCount; ++i)
+    {
+        float startS = _startSize + _startSizeVar * CCRANDOM_MINUS1_1();
+        _particleData.size[i] = MAX(0, startS); // No negative value
+    }
 
     if (_endSize == START_SIZE_EQUAL_TO_END_SIZE)
     {
-        particle->deltaSize = 0;
+        for (unsigned int i = start; i < _particleCount; ++i)
+        {
+            _particleData.deltaSize[i] = 0;
+        }
     }
     else
     {
-        float endS = _endSize + _endSizeVar * CCRANDOM_MINUS1_1();
-        endS = MAX(0, endS); // No negative values
-        particle->deltaSize = (endS - startS) / particle->timeToLive;
+        for (unsigned int i = start; i < _particleCount; ++i)
+        {
+            float endS = _endSize + _endSizeVar * CCRANDOM_MINUS1_1();
+            endS = MAX(0, endS); // No negative values
+            _particleData.deltaSize[i] = (endS - _particleData.size[i]) / _particleData.timeToLive[i];
+        }
     }
 
     // rotation
-    float startA = _startSpin + _startSpinVar * CCRANDOM_MINUS1_1();
-    float endA = _endSpin + _endSpinVar * CCRANDOM_MINUS1_1();
-    particle->rotation = startA;
-    particle->deltaRotation = (endA - startA) / particle->timeToLive;
+    for (unsigned int i = start; i < _particleCount; ++i)
+    {
+        _particleData.rotation[i] = _startSpin + _startSpinVar * CCRANDOM_MINUS1_1();
+    }
+    for (unsigned int i = start; i < _particleCount; ++i)
+    {
+        float endA = _endSpin + _endSpinVar * CCRANDOM_MINUS1_1();
+        _particleData.deltaRotation[i] = (endA - _particleData.rotation[i]) / _particleData.timeToLive[i];
+    }
 
     // position
+    Point startPos = Point::ZERO;
     if (_positionType == PositionType::FREE)
     {
-        particle->startPos = this->convertToWorldSpace(Point::ZERO);
+        startPos = this->convertToWorldSpace(Point::ZERO);
     }
     else if (_positionType == PositionType::RELATIVE)
     {
-        particle->startPos = _position;
+        startPos = _position;
+    }
+    for (unsigned int i = start; i < _particleCount; ++i)
+    {
+        _particleData.startPosX[i] = startPos.x;
+        _particleData.startPosY[i] = startPos.y;
     }
-
-    // direction
-    float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );    
 
     // Mode Gravity: A
     if (_emitterMode == Mode::GRAVITY)
     {
-        Point v(cosf( a ), sinf( a ));
-        float s = modeA.speed + modeA.speedVar * CCRANDOM_MINUS1_1();
-
         // direction
-        particle->modeA.dir = v * s ;
+        for (unsigned int i = start; i < _particleCount; ++i)
+        {
+            float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );
+            float s = modeA.speed + modeA.speedVar * CCRANDOM_MINUS1_1();
+            _particleData.modeA.dirX[i] = cosf( a ) * s;
+            _particleData.modeA.dirY[i] = sinf( a ) * s;
+        }
 
         // radial accel
-        particle->modeA.radialAccel = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
- 
+        for (unsigned int i = start; i < _particleCount; ++i)
+        {
+            _particleData.modeA.radialAccel[i] = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
+        }
 
         // tangential accel
-        particle->modeA.tangentialAccel = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
+        for (unsigned int i = start; i < _particleCount; ++i)
+        {
+            _particleData.modeA.tangentialAccel[i] = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
+        }
 
         // rotation is dir
-        if(modeA.rotationIsDir)
-            particle->rotation = -CC_RADIANS_TO_DEGREES(particle->modeA.dir.getAngle());
+        if (modeA.rotationIsDir)
+        {
+            for (unsigned int i = start; i < _particleCount; ++i)
+            {
+                _particleData.rotation[i] = -CC_RADIANS_TO_DEGREES(atan2f(_particleData.modeA.dirY[i], _particleData.modeA.dirX[i]));
+            }
+        }
     }
 
     // Mode Radius: B
     else 
     {
         // Set the default diameter of the particle from the source position
-        float startRadius = modeB.startRadius + modeB.startRadiusVar * CCRANDOM_MINUS1_1();
-        float endRadius = modeB.endRadius + modeB.endRadiusVar * CCRANDOM_MINUS1_1();
-
-        particle->modeB.radius = startRadius;
+        for (unsigned int i = start; i < _particleCount; ++i)
+        {
+            _particleData.modeB.radius[i] = modeB.startRadius + modeB.startRadiusVar * CCRANDOM_MINUS1_1();
+        }
 
         if (modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
         {
-            particle->modeB.deltaRadius = 0;
+            for (unsigned int i = start; i < _particleCount; ++i)
+            {
+                _particleData.modeB.deltaRadius[i] = 0;
+            }
         }
         else
         {
-            particle->modeB.deltaRadius = (endRadius - startRadius) / particle->timeToLive;
+            for (unsigned int i = start; i < _particleCount; ++i)
+            {
+                float endRadius = modeB.endRadius + modeB.endRadiusVar * CCRANDOM_MINUS1_1();
+                _particleData.modeB.deltaRadius[i] = (endRadius - _particleData.modeB.radius[i]) / _particleData.timeToLive[i];
+            }
         }
 
-        particle->modeB.angle = a;
-        particle->modeB.degreesPerSecond = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
-    }    
+        for (unsigned int i = start; i < _particleCount; ++i)
+        {
+            _particleData.modeB.angle[i] = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );
+        }
+        for (unsigned int i = start; i < _particleCount; ++i)
+        {
+            _particleData.modeB.degreesPerSecond[i] = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
+        }
+    }
 }
 
 void ParticleSystem::stopSystem()
@@ -585,10 +874,9 @@ void ParticleSystem::resetSystem()
 {
     _isActive = true;
     _elapsed = 0;
-    for (_particleIdx = 0; _particleIdx < _particleCount; ++_particleIdx)
+    for (unsigned int i = 0; i < _particleCount; ++i)
     {
-        tParticle *p = &_particles[_particleIdx];
-        p->timeToLive = 0;
+        _particleData.timeToLive[i] = 0;
     }
 }
 bool ParticleSystem::isFull()
@@ -597,10 +885,67 @@ bool ParticleSystem::isFull()
 }
 
 // ParticleSystem - MainLoop
+
+// Mode A: gravity, direction, tangential accel & radial accel
+static void updateGravityMode(ParticleData& data, unsigned int count, const Point& gravity, float dt)
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        // radial acceleration, along the normalized position. None at the origin
+        float x = data.posx[i];
+        float y = data.posy[i];
+        float length = sqrtf(x * x + y * y);
+        float invLength = length > 0 ? 1.0f / length : 0.0f;
+        float radialX = x * invLength;
+        float radialY = y * invLength;
+
+        // tangential acceleration, perpendicular to the radial one
+        float tangentialX = -radialY;
+        float tangentialY = radialX;
+
+        // (gravity + radial + tangential) * dt
+        float radialAccel = data.modeA.radialAccel[i];
+        float tangentialAccel = data.modeA.tangentialAccel[i];
+        data.modeA.dirX[i] += (radialX * radialAccel + tangentialX * tangentialAccel + gravity.x) * dt;
+        data.modeA.dirY[i] += (radialY * radialAccel + tangentialY * tangentialAccel + gravity.y) * dt;
+
+        data.posx[i] = x + data.modeA.dirX[i] * dt;
+        data.posy[i] = y + data.modeA.dirY[i] * dt;
+    }
+}
+
+// Mode B: radius movement
+static void updateRadiusMode(ParticleData& data, unsigned int count, float dt)
+{
+    // Update the angle and radius of the particle.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        data.modeB.angle[i] += data.modeB.degreesPerSecond[i] * dt;
+        data.modeB.radius[i] += data.modeB.deltaRadius[i] * dt;
+    }
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        data.posx[i] = - cosf(data.modeB.angle[i]) * data.modeB.radius[i];
+        data.posy[i] = - sinf(data.modeB.angle[i]) * data.modeB.radius[i];
+    }
+}
+
 void ParticleSystem::update(float dt)
 {
-    CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+    emitParticles(dt);
+
+    if (_simulatedInParallel)
+    {
+        ParticleSystemManager::getInstance()->addSystem(this, dt);
+        return;
+    }
+
+    CC_PROFILE_ZONE("CCParticleSystem - update");
+    finishUpdate(simulateParticles(dt));
+}
 
+void ParticleSystem::emitParticles(float dt)
+{
     if (_isActive && _emissionRate)
     {
         float rate = 1.0f / _emissionRate;
@@ -609,12 +954,18 @@ void ParticleSystem::update(float dt)
         {
             _emitCounter += dt;
         }
-        
-        while (_particleCount < _totalParticles && _emitCounter > rate) 
+
+        // the particles of the frame are initialized together
+        unsigned int emitCount = 0;
+        while (_particleCount + emitCount < _totalParticles && _emitCounter > rate) 
         {
-            this->addParticle();
+            ++emitCount;
             _emitCounter -= rate;
         }
+        if (emitCount > 0)
+        {
+            this->addParticles(emitCount);
+        }
 
         _elapsed += dt;
         if (_duration != -1 && _duration < _elapsed)
@@ -623,158 +974,159 @@ void ParticleSystem::update(float dt)
         }
     }
 
-    _particleIdx = 0;
-
-    Point currentPosition = Point::ZERO;
+    // the simulation can't use the parents of the node
     if (_positionType == PositionType::FREE)
     {
-        currentPosition = this->convertToWorldSpace(Point::ZERO);
+        _worldPosition = this->convertToWorldSpace(Point::ZERO);
     }
-    else if (_positionType == PositionType::RELATIVE)
+}
+
+bool ParticleSystem::simulateParticles(float dt)
+{
+    if (! _visible)
     {
-        currentPosition = _position;
+        return false;
     }
 
-    if (_visible)
+    if (integrateParticles(dt))
     {
-        while (_particleIdx < _particleCount)
+        return true;
+    }
+
+    updateParticleQuads();
+    _transformSystemDirty = false;
+
+    return false;
+}
+
+bool ParticleSystem::integrateParticles(float dt)
+{
+    // life
+    for (unsigned int i = 0; i < _particleCount; ++i)
+    {
+        _particleData.timeToLive[i] -= dt;
+    }
+
+    // the dead particles are replaced by the last ones
+    for (unsigned int i = 0; i < _particleCount; )
+    {
+        if (_particleData.timeToLive[i] > 0)
         {
-            tParticle *p = &_particles[_particleIdx];
+            ++i;
+            continue;
+        }
 
-            // life
-            p->timeToLive -= dt;
+        // life < 0
+        unsigned int currentIndex = _particleData.atlasIndex[i];
+        if( i != _particleCount-1 )
+        {
+            _particleData.copyParticle(i, _particleCount-1);
+        }
+        if (_batchNode)
+        {
+            //disable the switched particle
+            _batchNode->disableParticle(_atlasIndex+currentIndex);
 
-            if (p->timeToLive > 0) 
-            {
-                // Mode A: gravity, direction, tangential accel & radial accel
-                if (_emitterMode == Mode::GRAVITY)
-                {
-                    Point tmp, radial, tangential;
-
-                    radial = Point::ZERO;
-                    // radial acceleration
-                    if (p->pos.x || p->pos.y)
-                    {
-                        radial = p->pos.normalize();
-                    }
-                    tangential = radial;
-                    radial = radial * p->modeA.radialAccel;
-
-                    // tangential acceleration
-                    float newy = tangential.x;
-                    tangential.x = -tangential.y;
-                    tangential.y = newy;
-                    tangential = tangential * p->modeA.tangentialAccel;
-
-                    // (gravity + radial + tangential) * dt
-                    tmp = radial + tangential + modeA.gravity;
-                    tmp = tmp * dt;
-                    p->modeA.dir = p->modeA.dir + tmp;
-                    tmp = p->modeA.dir * dt;
-                    p->pos = p->pos + tmp;
-                }
-
-                // Mode B: radius movement
-                else 
-                {                
-                    // Update the angle and radius of the particle.
-                    p->modeB.angle += p->modeB.degreesPerSecond * dt;
-                    p->modeB.radius += p->modeB.deltaRadius * dt;
-
-                    p->pos.x = - cosf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y = - sinf(p->modeB.angle) * p->modeB.radius;
-                }
-
-                // color
-                p->color.r += (p->deltaColor.r * dt);
-                p->color.g += (p->deltaColor.g * dt);
-                p->color.b += (p->deltaColor.b * dt);
-                p->color.a += (p->deltaColor.a * dt);
-
-                // size
-                p->size += (p->deltaSize * dt);
-                p->size = MAX( 0, p->size );
-
-                // angle
-                p->rotation += (p->deltaRotation * dt);
-
-                //
-                // update values in quad
-                //
-
-                Point    newPos;
-
-                if (_positionType == PositionType::FREE || _positionType == PositionType::RELATIVE)
-                {
-                    Point diff = currentPosition - p->startPos;
-                    newPos = p->pos - diff;
-                } 
-                else
-                {
-                    newPos = p->pos;
-                }
-
-                // translate newPos to correct position, since matrix transform isn't performed in batchnode
-                // don't update the particle with the new position information, it will interfere with the radius and tangential calculations
-                if (_batchNode)
-                {
-                    newPos.x+=_position.x;
-                    newPos.y+=_position.y;
-                }
-
-                updateQuadWithParticle(p, newPos);
-                //updateParticleImp(self, updateParticleSel, p, newPos);
-
-                // update particle counter
-                ++_particleIdx;
-            } 
-            else 
+            //switch indexes
+            _particleData.atlasIndex[_particleCount-1] = currentIndex;
+        }
+
+        --_particleCount;
+
+        if( _particleCount == 0 && _isAutoRemoveOnFinish )
+        {
+            return true;
+        }
+    }
+
+    // position: each mode has its own loop, instead of testing the mode for each particle
+    if (_emitterMode == Mode::GRAVITY)
+    {
+        updateGravityMode(_particleData, _particleCount, modeA.gravity, dt);
+    }
+    else
+    {
+        updateRadiusMode(_particleData, _particleCount, dt);
+    }
+
+    // color
+    for (unsigned int i = 0; i < _particleCount; ++i)
+    {
+        _particleData.colorR[i] += _particleData.deltaColorR[i] * dt;
+        _particleData.colorG[i] += _particleData.deltaColorG[i] * dt;
+        _particleData.colorB[i] += _particleData.deltaColorB[i] * dt;
+        _particleData.colorA[i] += _particleData.deltaColorA[i] * dt;
+    }
+
+    // size
+    for (unsigned int i = 0; i < _particleCount; ++i)
+    {
+        float size = _particleData.size[i] + _particleData.deltaSize[i] * dt;
+        _particleData.size[i] = MAX( 0, size );
+    }
+
+    // angle
+    for (unsigned int i = 0; i < _particleCount; ++i)
+    {
+        _particleData.rotation[i] += _particleData.deltaRotation[i] * dt;
+    }
+
+    return false;
+}
+
+void ParticleSystem::prewarm(float duration)
+{
+    // the particles emitted during a step start together: it is only noticeable with short lives
+    static const float kPrewarmStep = 1.0f / 15;
+
+    while (duration > 0)
+    {
+        float dt = MIN(duration, kPrewarmStep);
+        duration -= dt;
+
+        emitParticles(dt);
+        if (integrateParticles(dt))
+        {
+            // all the particles died, and the system is removed on finish
+            if (_parent)
             {
-                // life < 0
-                int currentIndex = p->atlasIndex;
-                if( _particleIdx != _particleCount-1 )
-                {
-                    _particles[_particleIdx] = _particles[_particleCount-1];
-                }
-                if (_batchNode)
-                {
-                    //disable the switched particle
-                    _batchNode->disableParticle(_atlasIndex+currentIndex);
-
-                    //switch indexes
-                    _particles[_particleCount-1].atlasIndex = currentIndex;
-                }
-
-
-                --_particleCount;
-
-                if( _particleCount == 0 && _isAutoRemoveOnFinish )
-                {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
-                    return;
-                }
+                finishUpdate(true);
             }
-        } //while
-        _transformSystemDirty = false;
+            return;
+        }
     }
+
+    updateParticleQuads();
     if (! _batchNode)
     {
         postStep();
     }
+}
 
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+void ParticleSystem::finishUpdate(bool finished)
+{
+    if (finished)
+    {
+        this->unscheduleUpdate();
+        _parent->removeChild(this, true);
+        return;
+    }
+
+    if (! _batchNode)
+    {
+        postStep();
+    }
 }
 
 void ParticleSystem::updateWithNoTime(void)
 {
-    this->update(0.0f);
+    // always simulated immediately: the batch node uses the quads right away
+    emitParticles(0.0f);
+    finishUpdate(simulateParticles(0.0f));
 }
 
-void ParticleSystem::updateQuadWithParticle(tParticle* particle, const Point& newPosition)
+void ParticleSystem::updateParticleQuads()
 {
-    CC_UNUSED_PARAM(particle);
-    CC_UNUSED_PARAM(newPosition);
     // should be overridden
 }
 
@@ -1072,7 +1424,7 @@ void ParticleSystem::setBatchNode(ParticleBatchNode* batchNode)
             //each particle needs a unique index
             for (unsigned int i = 0; i < _totalParticles; i++)
             {
-                _particles[i].atlasIndex=i;
+                _particleData.atlasIndex[i] = i;
             }
         }
     }
@@ -39,45 +39,79 @@ NS_CC_BEGIN
  */
 
 class ParticleBatchNode;
+class ParticleTemplate;
 
-/**
-Structure that contains the values of each particle
-*/
-typedef struct sParticle {
-    Point     pos;
-    Point     startPos;
-
-    Color4F    color;
-    Color4F    deltaColor;
-
-    float        size;
-    float        deltaSize;
+/** @brief The particles of a ParticleSystem, stored as a structure of arrays: one array per value.
 
-    float        rotation;
-    float        deltaRotation;
-
-    float        timeToLive;
-
-    unsigned int    atlasIndex;
+The update loops of ParticleSystem read and write each value of all the particles in sequence,
+without branches, so the compilers can vectorize them. All the arrays are allocated in one block.
+@since v3.0
+*/
+class CC_DLL ParticleData
+{
+public:
+    float* posx;
+    float* posy;
+    float* startPosX;
+    float* startPosY;
+
+    float* colorR;
+    float* colorG;
+    float* colorB;
+    float* colorA;
+
+    float* deltaColorR;
+    float* deltaColorG;
+    float* deltaColorB;
+    float* deltaColorA;
+
+    float* size;
+    float* deltaSize;
+    float* rotation;
+    float* deltaRotation;
+    float* timeToLive;
+    unsigned int* atlasIndex;
 
     //! Mode A: gravity, direction, radial accel, tangential accel
     struct {
-        Point        dir;
-        float        radialAccel;
-        float        tangentialAccel;
+        float* dirX;
+        float* dirY;
+        float* radialAccel;
+        float* tangentialAccel;
     } modeA;
 
     //! Mode B: radius mode
     struct {
-        float        angle;
-        float        degreesPerSecond;
-        float        radius;
-        float        deltaRadius;
+        float* angle;
+        float* degreesPerSecond;
+        float* radius;
+        float* deltaRadius;
     } modeB;
 
-}tParticle;
+    unsigned int maxCount;
+
+    ParticleData();
+    ~ParticleData();
+
+    /** allocates the arrays for count particles, set to 0. The previous particles are freed. */
+    bool init(unsigned int count);
+    void release();
+
+    /** copies the values of the particle at index src to the particle at index dst */
+    void copyParticle(unsigned int dst, unsigned int src);
+
+private:
+    /** points the arrays to their part of the block */
+    void assignArrays(float* block, unsigned int stride);
+
+    // the block of all the arrays, each one made of _stride values
+    void* _data;
+    unsigned int _stride;
+
+    ParticleData(const ParticleData&);
+    ParticleData& operator=(const ParticleData&);
+};
 
-//typedef void (*CC_UPDATE_PARTICLE_IMP)(id, SEL, tParticle*, Point);
 
 class Texture2D;
 
@@ -199,17 +233,33 @@ public:
 
     //! Add a particle to the emitter
     bool addParticle();
-    //! Initializes a particle
-    void initParticle(tParticle* particle);
+    /** Adds count particles to the emitter, without checking if it is full
+     @since v3.0
+     */
+    void addParticles(unsigned int count);
     //! stop emitting particles. Running particles will continue to run until they die
-    void stopSystem();
+    virtual void stopSystem();
     //! Kill all living particles.
-    void resetSystem();
+    virtual void resetSystem();
     //! whether or not the system is full
     bool isFull();
 
-    //! should be overridden by subclasses
-    virtual void updateQuadWithParticle(tParticle* particle, const Point& newPosition);
+    /** Simulates the system for duration seconds, as if it was running before being shown, then writes the quads.
+     The time is advanced in steps of 1/15 s, instead of one step per frame.
+     @since v3.0
+     */
+    virtual void prewarm(float duration);
+
+    /** Releases the parsed plist files kept by initWithFile(). The systems created from the same file copy
+     the values parsed the first time, and look up its texture in the TextureCache.
+     @since v3.0
+     */
+    static void purgeCachedData();
+
+    /** Writes the quads of all the living particles. Should be overridden by subclasses
+     @since v3.0
+     */
+    virtual void updateParticleQuads();
     //! should be overridden by subclasses
     virtual void postStep();
 
@@ -218,6 +268,14 @@ public:
     virtual bool isAutoRemoveOnFinish() const;
     virtual void setAutoRemoveOnFinish(bool var);
 
+    /** Whether or not the particles are simulated by the ParticleSystemManager, on the threads of the JobSystem,
+     together with the other systems simulated in parallel. By default it is false.
+     The particles are then emitted by update(), and simulated once all the update selectors were called.
+     @since v3.0
+     */
+    inline bool isSimulatedInParallel() const { return _simulatedInParallel; }
+    inline void setSimulatedInParallel(bool simulatedInParallel) { _simulatedInParallel = simulatedInParallel; }
+
     // mode A
     virtual const Point& getGravity();
     virtual void setGravity(const Point& g);
@@ -379,6 +437,23 @@ public:
 protected:
     virtual void updateBlendFunc();
 
+    /** emits the particles of the frame, and stops the system at the end of its duration */
+    void emitParticles(float dt);
+    /** Moves the particles, removes the dead ones and writes the quads.
+     It doesn't use the other nodes, so the systems can be simulated in parallel.
+     Returns true if the last particle died and the system has to be removed.
+     */
+    bool simulateParticles(float dt);
+    /** advances the particles of dt without writing the quads. Returns true like simulateParticles() */
+    bool integrateParticles(float dt);
+    /** called on the main thread after simulateParticles(): removes the finished system or uploads its quads */
+    void finishUpdate(bool finished);
+
+    /** initializes the system with the values of a parsed plist file */
+    bool initWithTemplate(ParticleTemplate *particleTemplate);
+
+    friend class ParticleSystemManager;
+
 protected:
     /** whether or not the particles are using blend additive.
      If enabled, the following blending function will be used.
@@ -395,6 +470,9 @@ protected:
      */
     bool _isAutoRemoveOnFinish;
 
+    // whether or not the particles are simulated by the ParticleSystemManager
+    bool _simulatedInParallel;
+
     std::string _plistFile;
     //! time elapsed since the start of the system (in seconds)
     float _elapsed;
@@ -436,8 +514,8 @@ protected:
         float rotatePerSecondVar;
     } modeB;
 
-    //! Array of particles
-    tParticle *_particles;
+    //! The particles
+    ParticleData _particleData;
 
     // color modulate
     //    BOOL colorModulate;
@@ -445,9 +523,6 @@ protected:
     //! How many particles can be emitted per second
     float _emitCounter;
 
-    //!  particle idx
-    unsigned int _particleIdx;
-
     // Optimization
     //CC_UPDATE_PARTICLE_IMP    updateParticleImp;
     //SEL                        updateParticleSel;
@@ -460,6 +535,8 @@ protected:
 
     //true if scaled or rotated
     bool _transformSystemDirty;
+    // position of the emitter in the world, computed before the simulation for the free particles
+    Point _worldPosition;
     // Number of allocated particles
     unsigned int _allocatedParticles;
 
@@ -0,0 +1,379 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCParticleSystemGPU.h"
+#include "CCDirector.h"
+#include "textures/CCTexture2D.h"
+#include "shaders/CCShaderCache.h"
+#include "shaders/ccGLStateCache.h"
+#include "shaders/CCGLProgram.h"
+#include "support/TransformUtils.h"
+#include "support/CCNotificationCenter.h"
+#include "CCEventType.h"
+#include <vector>
+#include <stddef.h>
+
+NS_CC_BEGIN
+
+// 16 bits indices address at most 65536 vertices: the particles are drawn by chunks of this number of quads
+static const unsigned int kMaxQuadsPerDraw = 65536 / 4;
+
+ParticleSystemGPU * ParticleSystemGPU::create(const char *plistFile)
+{
+    ParticleSystemGPU *pRet = new ParticleSystemGPU();
+    if (pRet && pRet->initWithFile(plistFile))
+    {
+        pRet->autorelease();
+        return pRet;
+    }
+    CC_SAFE_DELETE(pRet);
+    return pRet;
+}
+
+ParticleSystemGPU * ParticleSystemGPU::createWithTotalParticles(unsigned int numberOfParticles)
+{
+    ParticleSystemGPU *pRet = new ParticleSystemGPU();
+    if (pRet && pRet->initWithTotalParticles(numberOfParticles))
+    {
+        pRet->autorelease();
+        return pRet;
+    }
+    CC_SAFE_DELETE(pRet);
+    return pRet;
+}
+
+ParticleSystemGPU::ParticleSystemGPU()
+: _dirty(true)
+, _time(0)
+, _stopTime(-1)
+, _period(0)
+, _texRect(0, 0, 1, 1)
+{
+    memset(_buffersVBO, 0, sizeof(_buffersVBO));
+}
+
+ParticleSystemGPU::~ParticleSystemGPU()
+{
+    GL::deleteBuffers(2, &_buffersVBO[0]);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    NotificationCenter::getInstance()->removeObserver(this, EVNET_COME_TO_FOREGROUND);
+#endif
+}
+
+bool ParticleSystemGPU::initWithTotalParticles(unsigned int numberOfParticles)
+{
+    if( ParticleSystem::initWithTotalParticles(numberOfParticles) )
+    {
+        // the particles are only stored in the VBO: setupVBO() generates them when they are drawn.
+        // All of them are drawn, so the system is always full
+        _particleData.release();
+        _particleCount = _totalParticles;
+        _dirty = true;
+
+        setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_PARTICLE_GPU));
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+        NotificationCenter::getInstance()->addObserver(this,
+                                                       callfuncO_selector(ParticleSystemGPU::listenBackToForeground),
+                                                       EVNET_COME_TO_FOREGROUND,
+                                                       NULL);
+#endif
+
+        return true;
+    }
+    return false;
+}
+
+void ParticleSystemGPU::setTextureWithRect(Texture2D *texture, const Rect& rect)
+{
+    // Only update the texture if is different from the current one
+    if( !_texture || texture->getName() != _texture->getName() )
+    {
+        ParticleSystem::setTexture(texture);
+    }
+
+    Rect pixelRect = Rect(
+        rect.origin.x * CC_CONTENT_SCALE_FACTOR(),
+        rect.origin.y * CC_CONTENT_SCALE_FACTOR(),
+        rect.size.width * CC_CONTENT_SCALE_FACTOR(),
+        rect.size.height * CC_CONTENT_SCALE_FACTOR());
+
+    float wide = (float)texture->getPixelsWide();
+    float high = (float)texture->getPixelsHigh();
+
+    // Important. Texture in cocos2d are inverted: the bottom of the particles uses the top of the rect
+    _texRect = Rect(pixelRect.origin.x / wide,
+                    (pixelRect.origin.y + pixelRect.size.height) / high,
+                    pixelRect.size.width / wide,
+                    -pixelRect.size.height / high);
+}
+
+void ParticleSystemGPU::setTexture(Texture2D* texture)
+{
+    const Size& s = texture->getContentSize();
+    this->setTextureWithRect(texture, Rect(0, 0, s.width, s.height));
+}
+
+void ParticleSystemGPU::setTotalParticles(unsigned int tp)
+{
+    _totalParticles = tp;
+    _allocatedParticles = tp;
+    _particleCount = tp;
+    _dirty = true;
+}
+
+void ParticleSystemGPU::setBatchNode(ParticleBatchNode* batchNode)
+{
+    CC_UNUSED_PARAM(batchNode);
+    CCASSERT(batchNode == NULL, "ParticleSystemGPU can't be added to a ParticleBatchNode");
+}
+
+void ParticleSystemGPU::listenBackToForeground(Object *obj)
+{
+    CC_UNUSED_PARAM(obj);
+    // the buffers were lost with the context
+    memset(_buffersVBO, 0, sizeof(_buffersVBO));
+    _dirty = true;
+}
+
+void ParticleSystemGPU::stopSystem()
+{
+    ParticleSystem::stopSystem();
+    _stopTime = _time;
+}
+
+void ParticleSystemGPU::resetSystem()
+{
+    _isActive = true;
+    _elapsed = 0;
+    _time = 0;
+    _stopTime = -1;
+    // the properties of the particles may have changed
+    _dirty = true;
+}
+
+float ParticleSystemGPU::getEmissionEnd() const
+{
+    float end = (_duration == DURATION_INFINITY) ? -1 : _duration;
+    if (_stopTime >= 0 && (end < 0 || _stopTime < end))
+    {
+        end = _stopTime;
+    }
+    return end;
+}
+
+void ParticleSystemGPU::prewarm(float duration)
+{
+    // the shader computes the particles from the time
+    advanceTime(duration);
+}
+
+void ParticleSystemGPU::update(float dt)
+{
+    advanceTime(dt);
+
+    if (!_isActive && _isAutoRemoveOnFinish && _time > getEmissionEnd() + _life + _lifeVar)
+    {
+        this->unscheduleUpdate();
+        _parent->removeChild(this, true);
+    }
+}
+
+void ParticleSystemGPU::advanceTime(float dt)
+{
+    _time += dt;
+    _elapsed = _time;
+
+    float emissionEnd = getEmissionEnd();
+    if (_isActive && emissionEnd >= 0 && _time > emissionEnd)
+    {
+        _isActive = false;
+    }
+
+    if (emissionEnd < 0 && _period > 0 && _time >= 2 * _period)
+    {
+        // the particles are periodic: keep the time small, so it keeps its precision in the shader
+        _time -= _period * (floorf(_time / _period) - 1);
+    }
+}
+
+void ParticleSystemGPU::setupVBO()
+{
+    _dirty = false;
+
+    // the particles are generated like ParticleSystem emits them, then converted to vertices
+    _particleCount = 0;
+    if (! _particleData.init(_totalParticles))
+    {
+        CCLOG("Particle system: not enough memory");
+        _particleCount = _totalParticles;
+        return;
+    }
+    addParticles(_totalParticles);
+
+    // the emission rate is lowered if the particles would be emitted again before they die, like when a ParticleSystem is full
+    _period = MAX(_emissionRate > 0 ? _totalParticles / _emissionRate : 0, _life + _lifeVar);
+    _period = MAX(_period, FLT_EPSILON);
+
+    // corners of the quads, in the order of V3F_C4B_T2F_Quad: top left, bottom left, top right, bottom right
+    static const GLfloat corners[4][2] = { {-0.5f, 0.5f}, {-0.5f, -0.5f}, {0.5f, 0.5f}, {0.5f, -0.5f} };
+
+    std::vector<Vertex> vertices(_totalParticles * 4);
+    for (unsigned int i = 0; i < _totalParticles; ++i)
+    {
+        // the deltas are infinite for the particles without life, which are never drawn
+        float life = _particleData.timeToLive[i];
+        auto end = [life](float start, float delta) { return life > 0 ? start + delta * life : start; };
+
+        Vertex vertex;
+        vertex.spawn[2] = i * _period / _totalParticles;
+        vertex.spawn[3] = life;
+
+        vertex.startColor = Color4B(_particleData.colorR[i] * 255, _particleData.colorG[i] * 255,
+                                    _particleData.colorB[i] * 255, _particleData.colorA[i] * 255);
+        vertex.endColor = Color4B(clampf(end(_particleData.colorR[i], _particleData.deltaColorR[i]), 0, 1) * 255,
+                                  clampf(end(_particleData.colorG[i], _particleData.deltaColorG[i]), 0, 1) * 255,
+                                  clampf(end(_particleData.colorB[i], _particleData.deltaColorB[i]), 0, 1) * 255,
+                                  clampf(end(_particleData.colorA[i], _particleData.deltaColorA[i]), 0, 1) * 255);
+
+        if (_emitterMode == Mode::GRAVITY)
+        {
+            vertex.motion[0] = _particleData.posx[i];
+            vertex.motion[1] = _particleData.posy[i];
+            vertex.motion[2] = _particleData.modeA.dirX[i];
+            vertex.motion[3] = _particleData.modeA.dirY[i];
+        }
+        else
+        {
+            vertex.motion[0] = _particleData.modeB.angle[i];
+            vertex.motion[1] = _particleData.modeB.degreesPerSecond[i];
+            vertex.motion[2] = _particleData.modeB.radius[i];
+            vertex.motion[3] = end(_particleData.modeB.radius[i], _particleData.modeB.deltaRadius[i]);
+        }
+
+        vertex.size[0] = _particleData.size[i];
+        vertex.size[1] = end(_particleData.size[i], _particleData.deltaSize[i]);
+        vertex.size[2] = _particleData.rotation[i];
+        vertex.size[3] = end(_particleData.rotation[i], _particleData.deltaRotation[i]);
+
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            vertex.spawn[0] = corners[corner][0];
+            vertex.spawn[1] = corners[corner][1];
+            vertices[i * 4 + corner] = vertex;
+        }
+    }
+
+    _particleData.release();
+    _particleCount = _totalParticles;
+
+    // one chunk of indices serves all the chunks of quads
+    unsigned int quadCount = MIN(_totalParticles, kMaxQuadsPerDraw);
+    std::vector<GLushort> indices(quadCount * 6);
+    for (unsigned int i = 0; i < quadCount; ++i)
+    {
+        const unsigned int i6 = i*6;
+        const unsigned int i4 = i*4;
+        indices[i6+0] = (GLushort) i4+0;
+        indices[i6+1] = (GLushort) i4+1;
+        indices[i6+2] = (GLushort) i4+2;
+
+        indices[i6+5] = (GLushort) i4+1;
+        indices[i6+4] = (GLushort) i4+2;
+        indices[i6+3] = (GLushort) i4+3;
+    }
+
+    GL::deleteBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(2, &_buffersVBO[0]);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void ParticleSystemGPU::draw()
+{
+    if (_dirty)
+    {
+        setupVBO();
+    }
+
+    if (_totalParticles == 0 || _emissionRate <= 0 || _texture == NULL)
+    {
+        return;
+    }
+
+    CC_NODE_DRAW_SETUP();
+
+    GLProgram* program = getShaderProgram();
+    program->setUniformLocationWith4f(program->getUniformLocationForName("u_time"),
+                                      _time, _period, getEmissionEnd(), _emitterMode == Mode::RADIUS ? 1 : 0);
+    program->setUniformLocationWith2f(program->getUniformLocationForName("u_gravity"), modeA.gravity.x, modeA.gravity.y);
+    program->setUniformLocationWith4f(program->getUniformLocationForName("u_texRect"),
+                                      _texRect.origin.x, _texRect.origin.y, _texRect.size.width, _texRect.size.height);
+    program->setUniformLocationWith1f(program->getUniformLocationForName("u_opacityModifyRGB"), _opacityModifyRGB ? 1 : 0);
+
+    GL::bindTexture2D( _texture->getName() );
+    GL::blendFunc( _blendFunc.src, _blendFunc.dst );
+
+    // the motion and the size use the attributes after the ones of GLProgram
+    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
+    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_MAX);
+    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_MAX + 1);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+
+    for (unsigned int first = 0; first < _totalParticles; first += kMaxQuadsPerDraw)
+    {
+        unsigned int count = MIN(_totalParticles - first, kMaxQuadsPerDraw);
+        size_t offset = first * 4 * sizeof(Vertex);
+
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*) (offset + offsetof(Vertex, spawn)));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (GLvoid*) (offset + offsetof(Vertex, startColor)));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (GLvoid*) (offset + offsetof(Vertex, endColor)));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_MAX, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*) (offset + offsetof(Vertex, motion)));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_MAX + 1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*) (offset + offsetof(Vertex, size)));
+
+        glDrawElements(GL_TRIANGLES, (GLsizei) count*6, GL_UNSIGNED_SHORT, 0);
+        CC_INCREMENT_GL_DRAWS(1);
+        CC_INCREMENT_GL_QUADS(count);
+    }
+
+    glDisableVertexAttribArray(GLProgram::VERTEX_ATTRIB_MAX);
+    glDisableVertexAttribArray(GLProgram::VERTEX_ATTRIB_MAX + 1);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+NS_CC_END
@@ -0,0 +1,122 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_PARTICLE_SYSTEM_GPU_H__
+#define __CC_PARTICLE_SYSTEM_GPU_H__
+
+#include "CCParticleSystem.h"
+#include "CCGL.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup particle_nodes
+ * @{
+ */
+
+/** @brief ParticleSystemGPU is a particle system simulated by the vertex shader.
+
+The parameters of the particles are generated and uploaded once, like ParticleSystemQuad would emit them.
+Each frame, the shader computes the position, color, size and rotation of the particles from the elapsed time,
+so updating the system costs the same for 50 or 50000 particles. It reads the same plist files as ParticleSystemQuad.
+
+It is meant for ambient effects (rain, snow, dust), and has some limitations:
+- The particles are emitted at a constant rate, and emitted again with the same parameters every period:
+  totalParticles / emissionRate, or the maximum life if it is longer.
+- The gravity mode uses the gravity but ignores the radial and tangential accelerations.
+- The particles always move with the emitter, like with PositionType::GROUPED.
+- It can't be added to a ParticleBatchNode.
+- After changing the properties of the particles, resetSystem() must be called to generate them again.
+
+@since v3.0
+*/
+class CC_DLL ParticleSystemGPU : public ParticleSystem
+{
+public:
+    /** creates an initializes a ParticleSystemGPU from a plist file */
+    static ParticleSystemGPU * create(const char *plistFile);
+    /** creates a ParticleSystemGPU with a number of particles */
+    static ParticleSystemGPU * createWithTotalParticles(unsigned int numberOfParticles);
+
+    ParticleSystemGPU();
+    virtual ~ParticleSystemGPU();
+
+    /** Sets a new texture with a rect. The rect is in Points. */
+    void setTextureWithRect(Texture2D *texture, const Rect& rect);
+
+    /** listen the event that coming to foreground on Android */
+    void listenBackToForeground(Object *obj);
+
+    // Overrides
+    virtual bool initWithTotalParticles(unsigned int numberOfParticles) override;
+    virtual void setTexture(Texture2D* texture) override;
+    virtual void setTotalParticles(unsigned int tp) override;
+    virtual void setBatchNode(ParticleBatchNode* batchNode) override;
+    virtual void stopSystem() override;
+    virtual void resetSystem() override;
+    virtual void prewarm(float duration) override;
+    virtual void update(float dt) override;
+    virtual void draw() override;
+
+protected:
+    /** A vertex of the quad of a particle */
+    struct Vertex
+    {
+        // corner x, corner y, emission time, life
+        GLfloat spawn[4];
+        Color4B startColor;
+        Color4B endColor;
+        // gravity mode: position, direction. Radius mode: angle, radians per second, start radius, end radius
+        GLfloat motion[4];
+        // start size, end size, start rotation, end rotation
+        GLfloat size[4];
+    };
+
+    /** advances the time of the particles, and stops the emission at its end */
+    void advanceTime(float dt);
+    /** time when the emission ends, -1 if it never ends */
+    float getEmissionEnd() const;
+    /** generates the particles and uploads them */
+    void setupVBO();
+
+    GLuint _buffersVBO[2]; //0: vertex  1: indices
+    // whether or not the particles have to be generated again
+    bool _dirty;
+
+    // time since the system was reset
+    float _time;
+    // time when stopSystem() was called, -1 if it wasn't
+    float _stopTime;
+    // time between two emissions of the same particle
+    float _period;
+    // texture coordinates of the bottom left corner of the particles, and size
+    Rect _texRect;
+};
+
+// end of particle_nodes group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_PARTICLE_SYSTEM_GPU_H__
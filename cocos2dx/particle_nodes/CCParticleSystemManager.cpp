@@ -0,0 +1,120 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCParticleSystemManager.h"
+#include "CCParticleSystem.h"
+#include "CCDirector.h"
+#include "CCScheduler.h"
+#include "support/CCJobSystem.h"
+#include "support/CCFrameProfiler.h"
+#include <limits.h>
+
+NS_CC_BEGIN
+
+static ParticleSystemManager *s_sharedParticleSystemManager = NULL;
+
+ParticleSystemManager* ParticleSystemManager::getInstance()
+{
+    if (!s_sharedParticleSystemManager)
+    {
+        s_sharedParticleSystemManager = new ParticleSystemManager();
+    }
+    return s_sharedParticleSystemManager;
+}
+
+void ParticleSystemManager::destroyInstance()
+{
+    if (s_sharedParticleSystemManager)
+    {
+        // the scheduler may still retain it
+        Director::getInstance()->getScheduler()->unscheduleUpdateForTarget(s_sharedParticleSystemManager);
+        s_sharedParticleSystemManager->clear(s_sharedParticleSystemManager->_systems);
+        CC_SAFE_RELEASE_NULL(s_sharedParticleSystemManager);
+    }
+}
+
+ParticleSystemManager::ParticleSystemManager()
+: _scheduled(false)
+{
+}
+
+ParticleSystemManager::~ParticleSystemManager()
+{
+    clear(_systems);
+}
+
+void ParticleSystemManager::clear(std::vector<Entry>& entries)
+{
+    for (auto& entry : entries)
+    {
+        entry.system->release();
+    }
+    entries.clear();
+}
+
+void ParticleSystemManager::addSystem(ParticleSystem* system, float dt)
+{
+    if (! _scheduled)
+    {
+        Director::getInstance()->getScheduler()->scheduleUpdateForTarget(this, INT_MAX, false);
+        _scheduled = true;
+    }
+
+    // retained until its update is finished: an update selector may remove it
+    system->retain();
+    Entry entry = { system, dt, false };
+    _systems.push_back(entry);
+}
+
+void ParticleSystemManager::update(float dt)
+{
+    CC_UNUSED_PARAM(dt);
+
+    if (_systems.empty())
+    {
+        return;
+    }
+
+    CC_PROFILE_ZONE("CCParticleSystemManager - update");
+
+    // the systems added while the others finish are simulated next frame
+    _simulatedSystems.swap(_systems);
+
+    std::vector<Entry>& entries = _simulatedSystems;
+    JobSystem::getInstance()->parallelFor(entries.size(), 1, [&entries](unsigned int begin, unsigned int end) {
+        CC_PROFILE_ZONE("CCParticleSystem - simulate");
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            entries[i].finished = entries[i].system->simulateParticles(entries[i].dt);
+        }
+    });
+
+    for (auto& entry : entries)
+    {
+        entry.system->finishUpdate(entry.finished);
+    }
+    clear(entries);
+}
+
+NS_CC_END
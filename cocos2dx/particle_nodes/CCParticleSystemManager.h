@@ -0,0 +1,90 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_PARTICLE_SYSTEM_MANAGER_H__
+#define __CC_PARTICLE_SYSTEM_MANAGER_H__
+
+#include "cocoa/CCObject.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+class ParticleSystem;
+
+/**
+ * @addtogroup particle_nodes
+ * @{
+ */
+
+/** @brief ParticleSystemManager simulates the particle systems in parallel.
+
+The systems with isSimulatedInParallel() emit their particles in update(), then add themselves to the manager.
+Once all the update selectors were called, the manager simulates the systems on the threads of the JobSystem,
+then removes the finished systems and uploads the quads of the others, in one pass on the main thread.
+
+The manager is scheduled with the highest priority, so it runs after the other update selectors.
+
+@since v3.0
+*/
+class CC_DLL ParticleSystemManager : public Object
+{
+public:
+    /** Gets the single instance of ParticleSystemManager. */
+    static ParticleSystemManager* getInstance();
+
+    /** Destroys the single instance of ParticleSystemManager. The systems waiting for their simulation are dropped. */
+    static void destroyInstance();
+
+    ParticleSystemManager();
+    virtual ~ParticleSystemManager();
+
+    /** Adds a system to simulate this frame. Called by ParticleSystem::update(). */
+    void addSystem(ParticleSystem* system, float dt);
+
+    /** simulates the systems added this frame */
+    virtual void update(float dt) override;
+
+protected:
+    struct Entry
+    {
+        ParticleSystem* system;
+        float dt;
+        bool finished;
+    };
+
+    void clear(std::vector<Entry>& entries);
+
+    // systems added this frame, retained
+    std::vector<Entry> _systems;
+    // systems being simulated, swapped with _systems to reuse the memory
+    std::vector<Entry> _simulatedSystems;
+    bool _scheduled;
+};
+
+// end of particle_nodes group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_PARTICLE_SYSTEM_MANAGER_H__
@@ -29,14 +29,13 @@ THE SOFTWARE.
 #include "CCParticleSystemQuad.h"
 #include "sprite_nodes/CCSpriteFrame.h"
 #include "CCDirector.h"
+#include "renderer/CCRenderer.h"
 #include "CCParticleBatchNode.h"
 #include "textures/CCTextureAtlas.h"
 #include "shaders/CCShaderCache.h"
 #include "shaders/ccGLStateCache.h"
 #include "shaders/CCGLProgram.h"
 #include "support/TransformUtils.h"
-#include "support/CCNotificationCenter.h"
-#include "CCEventType.h"
 
 // extern
 #include "kazmath/GL/matrix.h"
@@ -56,22 +55,7 @@ bool ParticleSystemQuad::initWithTotalParticles(unsigned int numberOfParticles)
             return false;
         }
 
-        initIndices();
-#if CC_TEXTURE_ATLAS_USE_VAO
-        setupVBOandVAO();
-#else
-        setupVBO();
-#endif
-
         setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR));
-        
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-        // Need to listen the event only when not use batchnode, because it will use VBO
-        NotificationCenter::getInstance()->addObserver(this,
-                                                                      callfuncO_selector(ParticleSystemQuad::listenBackToForeground),
-                                                                      EVNET_COME_TO_FOREGROUND,
-                                                                      NULL);
-#endif
 
         return true;
     }
@@ -80,12 +64,7 @@ bool ParticleSystemQuad::initWithTotalParticles(unsigned int numberOfParticles)
 
 ParticleSystemQuad::ParticleSystemQuad()
 :_quads(NULL)
-,_indices(NULL)
-#if CC_TEXTURE_ATLAS_USE_VAO
-,_VAOname(0)
-#endif
 {
-    memset(_buffersVBO, 0, sizeof(_buffersVBO));
 }
 
 ParticleSystemQuad::~ParticleSystemQuad()
@@ -93,17 +72,7 @@ ParticleSystemQuad::~ParticleSystemQuad()
     if (NULL == _batchNode)
     {
         CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
-        glDeleteBuffers(2, &_buffersVBO[0]);
-#if CC_TEXTURE_ATLAS_USE_VAO
-        glDeleteVertexArrays(1, &_VAOname);
-        GL::bindVAO(0);
-#endif
     }
-    
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    NotificationCenter::getInstance()->removeObserver(this, EVNET_COME_TO_FOREGROUND);
-#endif
 }
 
 // implementation ParticleSystemQuad
@@ -225,179 +194,169 @@ void ParticleSystemQuad::setDisplayFrame(SpriteFrame *spriteFrame)
     }
 }
 
-void ParticleSystemQuad::initIndices()
+void ParticleSystemQuad::updateParticleQuads()
 {
-    for(unsigned int i = 0; i < _totalParticles; ++i)
+    if (_particleCount == 0)
     {
-        const unsigned int i6 = i*6;
-        const unsigned int i4 = i*4;
-        _indices[i6+0] = (GLushort) i4+0;
-        _indices[i6+1] = (GLushort) i4+1;
-        _indices[i6+2] = (GLushort) i4+2;
-
-        _indices[i6+5] = (GLushort) i4+1;
-        _indices[i6+4] = (GLushort) i4+2;
-        _indices[i6+3] = (GLushort) i4+3;
+        return;
     }
-}
-
-void ParticleSystemQuad::updateQuadWithParticle(tParticle* particle, const Point& newPosition)
-{
-    V3F_C4B_T2F_Quad *quad;
 
+    V3F_C4B_T2F_Quad *startQuad;
     if (_batchNode)
     {
-        V3F_C4B_T2F_Quad *batchQuads = _batchNode->getTextureAtlas()->getQuads();
-        quad = &(batchQuads[_atlasIndex+particle->atlasIndex]);
+        startQuad = &(_batchNode->getTextureAtlas()->getQuads()[_atlasIndex]);
     }
     else
     {
-        quad = &(_quads[_particleIdx]);
+        startQuad = _quads;
     }
-    Color4B color = (_opacityModifyRGB)
-        ? Color4B( particle->color.r*particle->color.a*255, particle->color.g*particle->color.a*255, particle->color.b*particle->color.a*255, particle->color.a*255)
-        : Color4B( particle->color.r*255, particle->color.g*255, particle->color.b*255, particle->color.a*255);
 
-    quad->bl.colors = color;
-    quad->br.colors = color;
-    quad->tl.colors = color;
-    quad->tr.colors = color;
+    // the free and relative particles keep the position of the emitter when they were emitted
+    bool moveWithStartPos = (_positionType == PositionType::FREE || _positionType == PositionType::RELATIVE);
+    Point offset = Point::ZERO;
+    if (_positionType == PositionType::FREE)
+    {
+        offset = -_worldPosition;
+    }
+    else if (_positionType == PositionType::RELATIVE)
+    {
+        offset = -_position;
+    }
+
+    // translate newPos to correct position, since matrix transform isn't performed in batchnode
+    // don't update the particle with the new position information, it will interfere with the radius and tangential calculations
+    if (_batchNode)
+    {
+        offset = offset + _position;
+    }
 
     // vertices
-    GLfloat size_2 = particle->size/2;
-    if (particle->rotation) 
+    for (unsigned int i = 0; i < _particleCount; ++i)
     {
-        GLfloat x1 = -size_2;
-        GLfloat y1 = -size_2;
-
-        GLfloat x2 = size_2;
-        GLfloat y2 = size_2;
-        GLfloat x = newPosition.x;
-        GLfloat y = newPosition.y;
-
-        GLfloat r = (GLfloat)-CC_DEGREES_TO_RADIANS(particle->rotation);
-        GLfloat cr = cosf(r);
-        GLfloat sr = sinf(r);
-        GLfloat ax = x1 * cr - y1 * sr + x;
-        GLfloat ay = x1 * sr + y1 * cr + y;
-        GLfloat bx = x2 * cr - y1 * sr + x;
-        GLfloat by = x2 * sr + y1 * cr + y;
-        GLfloat cx = x2 * cr - y2 * sr + x;
-        GLfloat cy = x2 * sr + y2 * cr + y;
-        GLfloat dx = x1 * cr - y2 * sr + x;
-        GLfloat dy = x1 * sr + y2 * cr + y;
-
-        // bottom-left
-        quad->bl.vertices.x = ax;
-        quad->bl.vertices.y = ay;
+        V3F_C4B_T2F_Quad *quad = _batchNode ? &startQuad[_particleData.atlasIndex[i]] : &startQuad[i];
 
-        // bottom-right vertex:
-        quad->br.vertices.x = bx;
-        quad->br.vertices.y = by;
+        GLfloat x = _particleData.posx[i] + offset.x;
+        GLfloat y = _particleData.posy[i] + offset.y;
+        if (moveWithStartPos)
+        {
+            x += _particleData.startPosX[i];
+            y += _particleData.startPosY[i];
+        }
+        GLfloat size_2 = _particleData.size[i]/2;
+        GLfloat rotation = _particleData.rotation[i];
 
-        // top-left vertex:
-        quad->tl.vertices.x = dx;
-        quad->tl.vertices.y = dy;
+        if (rotation) 
+        {
+            GLfloat x1 = -size_2;
+            GLfloat y1 = -size_2;
+
+            GLfloat x2 = size_2;
+            GLfloat y2 = size_2;
+
+            GLfloat r = (GLfloat)-CC_DEGREES_TO_RADIANS(rotation);
+            GLfloat cr = cosf(r);
+            GLfloat sr = sinf(r);
+            GLfloat ax = x1 * cr - y1 * sr + x;
+            GLfloat ay = x1 * sr + y1 * cr + y;
+            GLfloat bx = x2 * cr - y1 * sr + x;
+            GLfloat by = x2 * sr + y1 * cr + y;
+            GLfloat cx = x2 * cr - y2 * sr + x;
+            GLfloat cy = x2 * sr + y2 * cr + y;
+            GLfloat dx = x1 * cr - y2 * sr + x;
+            GLfloat dy = x1 * sr + y2 * cr + y;
+
+            // bottom-left
+            quad->bl.vertices.x = ax;
+            quad->bl.vertices.y = ay;
+
+            // bottom-right vertex:
+            quad->br.vertices.x = bx;
+            quad->br.vertices.y = by;
+
+            // top-left vertex:
+            quad->tl.vertices.x = dx;
+            quad->tl.vertices.y = dy;
+
+            // top-right vertex:
+            quad->tr.vertices.x = cx;
+            quad->tr.vertices.y = cy;
+        } 
+        else 
+        {
+            // bottom-left vertex:
+            quad->bl.vertices.x = x - size_2;
+            quad->bl.vertices.y = y - size_2;
 
-        // top-right vertex:
-        quad->tr.vertices.x = cx;
-        quad->tr.vertices.y = cy;
-    } 
-    else 
-    {
-        // bottom-left vertex:
-        quad->bl.vertices.x = newPosition.x - size_2;
-        quad->bl.vertices.y = newPosition.y - size_2;
+            // bottom-right vertex:
+            quad->br.vertices.x = x + size_2;
+            quad->br.vertices.y = y - size_2;
 
-        // bottom-right vertex:
-        quad->br.vertices.x = newPosition.x + size_2;
-        quad->br.vertices.y = newPosition.y - size_2;
+            // top-left vertex:
+            quad->tl.vertices.x = x - size_2;
+            quad->tl.vertices.y = y + size_2;
 
-        // top-left vertex:
-        quad->tl.vertices.x = newPosition.x - size_2;
-        quad->tl.vertices.y = newPosition.y + size_2;
+            // top-right vertex:
+            quad->tr.vertices.x = x + size_2;
+            quad->tr.vertices.y = y + size_2;                
+        }
+    }
 
-        // top-right vertex:
-        quad->tr.vertices.x = newPosition.x + size_2;
-        quad->tr.vertices.y = newPosition.y + size_2;                
+    // colors, premultiplied by the alpha if needed
+    for (unsigned int i = 0; i < _particleCount; ++i)
+    {
+        V3F_C4B_T2F_Quad *quad = _batchNode ? &startQuad[_particleData.atlasIndex[i]] : &startQuad[i];
+
+        GLfloat a = _particleData.colorA[i];
+        GLfloat rgbScale = _opacityModifyRGB ? a * 255 : 255;
+        Color4B color( _particleData.colorR[i] * rgbScale, _particleData.colorG[i] * rgbScale, _particleData.colorB[i] * rgbScale, a * 255);
+
+        quad->bl.colors = color;
+        quad->br.colors = color;
+        quad->tl.colors = color;
+        quad->tr.colors = color;
     }
 }
-void ParticleSystemQuad::postStep()
-{
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-	
-	// Option 1: Sub Data
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_quads[0])*_totalParticles, _quads);
-	
-	// Option 2: Data
-    //	glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * particleCount, quads_, GL_DYNAMIC_DRAW);
-	
-	// Option 3: Orphaning + glMapBuffer
-	// glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0])*_totalParticles, NULL, GL_STREAM_DRAW);
-	// void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-	// memcpy(buf, _quads, sizeof(_quads[0])*_totalParticles);
-	// glUnmapBuffer(GL_ARRAY_BUFFER);
-    
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-	CHECK_GL_ERROR_DEBUG();
-}
 
 // overriding draw method
 void ParticleSystemQuad::draw()
 {    
     CCASSERT(!_batchNode,"draw should not be called when added to a particleBatchNode");
 
+    if (_particleCount == 0)
+    {
+        return;
+    }
+
     CC_NODE_DRAW_SETUP();
 
     GL::bindTexture2D( _texture->getName() );
     GL::blendFunc( _blendFunc.src, _blendFunc.dst );
 
-    CCASSERT( _particleIdx == _particleCount, "Abnormal error in particle quad");
-
-#if CC_TEXTURE_ATLAS_USE_VAO
-    //
-    // Using VBO and VAO
-    //
-    GL::bindVAO(_VAOname);
-
-#if CC_REBIND_INDICES_BUFFER
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-#endif
-
-    glDrawElements(GL_TRIANGLES, (GLsizei) _particleIdx*6, GL_UNSIGNED_SHORT, 0);
-
-#if CC_REBIND_INDICES_BUFFER
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-#endif
-
-#else
-    //
-    // Using VBO without VAO
-    //
+    // the living particles are copied to the streaming buffers shared with the other dynamic meshes,
+    // instead of a buffer of their own: only the visible systems are uploaded, and they don't bind a buffer each
+    BufferArena* arena = Director::getInstance()->getRenderer()->getBufferArena();
+    const char* offset = (const char*) arena->upload(GL_ARRAY_BUFFER, _quads, sizeof(_quads[0]) * _particleCount);
 
     #define kQuadSize sizeof(_quads[0].bl)
 
     GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
     // vertices
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, offset + offsetof( V3F_C4B_T2F, vertices));
     // colors
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, offset + offsetof( V3F_C4B_T2F, colors));
     // tex coords
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, offset + offsetof( V3F_C4B_T2F, texCoords));
 
-    glDrawElements(GL_TRIANGLES, (GLsizei) _particleIdx*6, GL_UNSIGNED_SHORT, 0);
+    arena->bindQuadIndices(_particleCount);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDrawElements(GL_TRIANGLES, (GLsizei) _particleCount*6, GL_UNSIGNED_SHORT, 0);
 
-#endif
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_QUADS(_particleCount);
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -408,35 +367,31 @@ void ParticleSystemQuad::setTotalParticles(unsigned int tp)
     if( tp > _allocatedParticles )
     {
         // Allocate new memory
-        size_t particlesSize = tp * sizeof(tParticle);
         size_t quadsSize = sizeof(_quads[0]) * tp * 1;
-        size_t indicesSize = sizeof(_indices[0]) * tp * 6 * 1;
 
-        tParticle* particlesNew = (tParticle*)realloc(_particles, particlesSize);
+        bool particlesAllocated = _particleData.init(tp);
         V3F_C4B_T2F_Quad* quadsNew = (V3F_C4B_T2F_Quad*)realloc(_quads, quadsSize);
-        GLushort* indicesNew = (GLushort*)realloc(_indices, indicesSize);
 
-        if (particlesNew && quadsNew && indicesNew)
+        if (particlesAllocated && quadsNew)
         {
             // Assign pointers
-            _particles = particlesNew;
             _quads = quadsNew;
-            _indices = indicesNew;
 
             // Clear the memory
             // XXX: Bug? If the quads are cleared, then drawing doesn't work... WHY??? XXX
-            memset(_particles, 0, particlesSize);
             memset(_quads, 0, quadsSize);
-            memset(_indices, 0, indicesSize);
 
             _allocatedParticles = tp;
         }
         else
         {
             // Out of memory, failed to resize some array
-            if (particlesNew) _particles = particlesNew;
             if (quadsNew) _quads = quadsNew;
-            if (indicesNew) _indices = indicesNew;
+            if (!particlesAllocated)
+            {
+                // the previous particles were freed by init()
+                _allocatedParticles = _totalParticles = _particleCount = 0;
+            }
 
             CCLOG("Particle system: out of memory");
             return;
@@ -449,16 +404,9 @@ void ParticleSystemQuad::setTotalParticles(unsigned int tp)
         {
             for (unsigned int i = 0; i < _totalParticles; i++)
             {
-                _particles[i].atlasIndex=i;
+                _particleData.atlasIndex[i] = i;
             }
         }
-
-        initIndices();
-#if CC_TEXTURE_ATLAS_USE_VAO
-        setupVBOandVAO();
-#else
-        setupVBO();
-#endif
     }
     else
     {
@@ -468,98 +416,23 @@ void ParticleSystemQuad::setTotalParticles(unsigned int tp)
     resetSystem();
 }
 
-#if CC_TEXTURE_ATLAS_USE_VAO
-void ParticleSystemQuad::setupVBOandVAO()
-{
-    // clean VAO
-    glDeleteBuffers(2, &_buffersVBO[0]);
-    glDeleteVertexArrays(1, &_VAOname);
-    GL::bindVAO(0);
-    
-    glGenVertexArrays(1, &_VAOname);
-    GL::bindVAO(_VAOname);
-
-#define kQuadSize sizeof(_quads[0].bl)
-
-    glGenBuffers(2, &_buffersVBO[0]);
-
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_DYNAMIC_DRAW);
-
-    // vertices
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
-
-    // colors
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
-
-    // tex coords
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORDS);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _totalParticles * 6, _indices, GL_STATIC_DRAW);
-
-    // Must unbind the VAO before changing the element buffer.
-    GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    CHECK_GL_ERROR_DEBUG();
-}
-#else
-
-void ParticleSystemQuad::setupVBO()
-{
-    glDeleteBuffers(2, &_buffersVBO[0]);
-    
-    glGenBuffers(2, &_buffersVBO[0]);
-
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _totalParticles, _quads, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _totalParticles * 6, _indices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    CHECK_GL_ERROR_DEBUG();
-}
-
-#endif
-
-void ParticleSystemQuad::listenBackToForeground(Object *obj)
-{
-#if CC_TEXTURE_ATLAS_USE_VAO
-        setupVBOandVAO();
-#else
-        setupVBO();
-#endif
-}
-
 bool ParticleSystemQuad::allocMemory()
 {
-    CCASSERT( ( !_quads && !_indices), "Memory already alloced");
+    CCASSERT( !_quads, "Memory already alloced");
     CCASSERT( !_batchNode, "Memory should not be alloced when not using batchNode");
 
     CC_SAFE_FREE(_quads);
-    CC_SAFE_FREE(_indices);
 
     _quads = (V3F_C4B_T2F_Quad*)malloc(_totalParticles * sizeof(V3F_C4B_T2F_Quad));
-    _indices = (GLushort*)malloc(_totalParticles * 6 * sizeof(GLushort));
     
-    if( !_quads || !_indices) 
+    if( !_quads ) 
     {
         CCLOG("cocos2d: Particle system: not enough memory");
-        CC_SAFE_FREE(_quads);
-        CC_SAFE_FREE(_indices);
 
         return false;
     }
 
     memset(_quads, 0, _totalParticles * sizeof(V3F_C4B_T2F_Quad));
-    memset(_indices, 0, _totalParticles * 6 * sizeof(GLushort));
 
     return true;
 }
@@ -576,13 +449,7 @@ void ParticleSystemQuad::setBatchNode(ParticleBatchNode * batchNode)
         if( ! batchNode ) 
         {
             allocMemory();
-            initIndices();
             setTexture(oldBatch->getTexture());
-#if CC_TEXTURE_ATLAS_USE_VAO
-            setupVBOandVAO();
-#else
-            setupVBO();
-#endif
         }
         // OLD: was it self render ? cleanup
         else if( !oldBatch )
@@ -593,13 +460,6 @@ void ParticleSystemQuad::setBatchNode(ParticleBatchNode * batchNode)
             memcpy( quad, _quads, _totalParticles * sizeof(_quads[0]) );
 
             CC_SAFE_FREE(_quads);
-            CC_SAFE_FREE(_indices);
-
-            glDeleteBuffers(2, &_buffersVBO[0]);
-#if CC_TEXTURE_ATLAS_USE_VAO
-            glDeleteVertexArrays(1, &_VAOname);
-            GL::bindVAO(0);
-#endif
         }
     }
 }
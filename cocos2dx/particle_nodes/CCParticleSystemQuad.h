@@ -66,9 +66,6 @@ public:
     ParticleSystemQuad();
     virtual ~ParticleSystemQuad();
 
-    /** initializes the indices for the vertices*/
-    void initIndices();
-
     /** initializes the texture with a rectangle measured Points */
     void initTexCoordsWithRect(const Rect& rect);
 
@@ -83,36 +80,19 @@ public:
     */
     void setTextureWithRect(Texture2D *texture, const Rect& rect);
 
-    /** listen the event that coming to foreground on Android
-     */
-    void listenBackToForeground(Object *obj);
-
     // Overrides
     virtual bool initWithTotalParticles(unsigned int numberOfParticles) override;
     virtual void setTexture(Texture2D* texture) override;
-    virtual void updateQuadWithParticle(tParticle* particle, const Point& newPosition) override;
-    virtual void postStep() override;
+    virtual void updateParticleQuads() override;
     virtual void draw() override;
     virtual void setBatchNode(ParticleBatchNode* batchNode) override;
     virtual void setTotalParticles(unsigned int tp) override;
 
 private:
-#if CC_TEXTURE_ATLAS_USE_VAO
-    void setupVBOandVAO();
-#else
-    void setupVBO();
-#endif
     bool allocMemory();
     
 protected:
-    V3F_C4B_T2F_Quad    *_quads;        // quads to be rendered
-    GLushort            *_indices;    // indices
-    
-#if CC_TEXTURE_ATLAS_USE_VAO
-    GLuint                _VAOname;
-#endif
-    
-    GLuint                _buffersVBO[2]; //0: vertex  1: indices
+    V3F_C4B_T2F_Quad    *_quads;        // quads to be rendered, copied to the BufferArena of the Renderer when drawn
 };
 
 // end of particle_nodes group
@@ -3,14 +3,19 @@
 #include "touch_dispatcher/CCTouch.h"
 #include "CCDirector.h"
 #include "cocoa/CCSet.h"
-#include "cocoa/CCDictionary.h"
-#include "cocoa/CCInteger.h"
+#include "shaders/ccGLStateCache.h"
+#include "support/CCInputRecorder.h"
 
 NS_CC_BEGIN
 
 static Touch* s_pTouches[CC_MAX_TOUCHES] = { NULL };
 static unsigned int s_indexBitsUsed = 0;
-static Dictionary s_TouchesIntergerDict;
+// platform id of the touch at each index, valid when the bit of the index is used
+static int s_touchIDs[CC_MAX_TOUCHES];
+
+// latest location of the touches moved since the last dispatchPendingTouches(), by touch index
+static Point s_pendingMoves[CC_MAX_TOUCHES];
+static unsigned int s_pendingMoveBits = 0;
 
 static int getUnUsedIndex()
 {
@@ -30,6 +35,19 @@ static int getUnUsedIndex()
     return -1;
 }
 
+// the index of the touch with the platform id, or -1: a scan of CC_MAX_TOUCHES ints, no allocation per touch
+static int getIndexOfTouchID(int id)
+{
+    for (int i = 0; i < CC_MAX_TOUCHES; i++)
+    {
+        if ((s_indexBitsUsed & (1 << i)) && s_touchIDs[i] == id)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
 static void removeUsedIndexBit(int index)
 {
     if (index < 0 || index >= CC_MAX_TOUCHES) 
@@ -47,6 +65,7 @@ EGLViewProtocol::EGLViewProtocol()
 , _scaleX(1.0f)
 , _scaleY(1.0f)
 , _resolutionPolicy(ResolutionPolicy::UNKNOWN)
+, _touchHistoryEnabled(false)
 {
 }
 
@@ -158,21 +177,21 @@ void EGLViewProtocol::setViewPortInPoints(float x , float y , float w , float h)
 
 void EGLViewProtocol::setScissorInPoints(float x , float y , float w , float h)
 {
-    glScissor((GLint)(x * _scaleX + _viewPortRect.origin.x),
-              (GLint)(y * _scaleY + _viewPortRect.origin.y),
-              (GLsizei)(w * _scaleX),
-              (GLsizei)(h * _scaleY));
+    GL::scissor((GLint)(x * _scaleX + _viewPortRect.origin.x),
+                (GLint)(y * _scaleY + _viewPortRect.origin.y),
+                (GLsizei)(w * _scaleX),
+                (GLsizei)(h * _scaleY));
 }
 
 bool EGLViewProtocol::isScissorEnabled()
 {
-	return (GL_FALSE == glIsEnabled(GL_SCISSOR_TEST)) ? false : true;
+	return GL::isEnabled(GL_SCISSOR_TEST);
 }
 
 Rect EGLViewProtocol::getScissorRect()
 {
-	GLfloat params[4];
-	glGetFloatv(GL_SCISSOR_BOX, params);
+	GLint params[4];
+	GL::getScissorBox(params);
 	float x = (params[0] - _viewPortRect.origin.x) / _scaleX;
 	float y = (params[1] - _viewPortRect.origin.y) / _scaleY;
 	float w = params[2] / _scaleX;
@@ -195,6 +214,15 @@ const char* EGLViewProtocol::getViewName()
 
 void EGLViewProtocol::handleTouchesBegin(int num, int ids[], float xs[], float ys[])
 {
+    if (InputRecorder::isActive() && !InputRecorder::getInstance()->onTouches(InputRecorder::TouchPhase::BEGAN, num, ids, xs, ys))
+    {
+        return;
+    }
+
+    Director::setNextFrameDirty();
+
+    dispatchPendingTouches();
+
     Set set;
     for (int i = 0; i < num; ++i)
     {
@@ -202,11 +230,10 @@ void EGLViewProtocol::handleTouchesBegin(int num, int ids[], float xs[], float y
         float x = xs[i];
         float y = ys[i];
 
-        Integer* pIndex = (Integer*)s_TouchesIntergerDict.objectForKey(id);
         int nUnusedIndex = 0;
 
         // it is a new touch
-        if (pIndex == NULL)
+        if (getIndexOfTouchID(id) == -1)
         {
             nUnusedIndex = getUnUsedIndex();
 
@@ -222,10 +249,8 @@ void EGLViewProtocol::handleTouchesBegin(int num, int ids[], float xs[], float y
             
             //CCLOG("x = %f y = %f", pTouch->getLocationInView().x, pTouch->getLocationInView().y);
             
-            Integer* pInterObj = new Integer(nUnusedIndex);
-            s_TouchesIntergerDict.setObject(pInterObj, id);
+            s_touchIDs[nUnusedIndex] = id;
             set.addObject(pTouch);
-            pInterObj->release();
         }
     }
 
@@ -240,27 +265,42 @@ void EGLViewProtocol::handleTouchesBegin(int num, int ids[], float xs[], float y
 
 void EGLViewProtocol::handleTouchesMove(int num, int ids[], float xs[], float ys[])
 {
-    Set set;
+    if (InputRecorder::isActive() && !InputRecorder::getInstance()->onTouches(InputRecorder::TouchPhase::MOVED, num, ids, xs, ys))
+    {
+        return;
+    }
+
+    Director::setNextFrameDirty();
+
     for (int i = 0; i < num; ++i)
     {
         int id = ids[i];
         float x = xs[i];
         float y = ys[i];
 
-        Integer* pIndex = (Integer*)s_TouchesIntergerDict.objectForKey(id);
-        if (pIndex == NULL) {
+        int index = getIndexOfTouchID(id);
+        if (index == -1) {
             CCLOG("if the index doesn't exist, it is an error");
             continue;
         }
 
         CCLOGINFO("Moving touches with id: %d, x=%f, y=%f", id, x, y);
-        Touch* pTouch = s_pTouches[pIndex->getValue()];
+        Touch* pTouch = s_pTouches[index];
         if (pTouch)
         {
-			pTouch->setTouchInfo(pIndex->getValue(), (x - _viewPortRect.origin.x) / _scaleX, 
-								(y - _viewPortRect.origin.y) / _scaleY);
-            
-            set.addObject(pTouch);
+            // only the latest location is dispatched, in dispatchPendingTouches()
+            Point location((x - _viewPortRect.origin.x) / _scaleX, (y - _viewPortRect.origin.y) / _scaleY);
+            unsigned int bit = 1 << index;
+            if (_touchHistoryEnabled)
+            {
+                if (! (s_pendingMoveBits & bit))
+                {
+                    pTouch->_history.clear();
+                }
+                pTouch->_history.push_back(location);
+            }
+            s_pendingMoves[index] = location;
+            s_pendingMoveBits |= bit;
         }
         else
         {
@@ -269,6 +309,26 @@ void EGLViewProtocol::handleTouchesMove(int num, int ids[], float xs[], float ys
             return;
         }
     }
+}
+
+void EGLViewProtocol::dispatchPendingTouches()
+{
+    if (s_pendingMoveBits == 0)
+    {
+        return;
+    }
+
+    Set set;
+    for (int i = 0; i < CC_MAX_TOUCHES; ++i)
+    {
+        Touch* pTouch = s_pTouches[i];
+        if ((s_pendingMoveBits & (1 << i)) && pTouch)
+        {
+            pTouch->setTouchInfo(i, s_pendingMoves[i].x, s_pendingMoves[i].y);
+            set.addObject(pTouch);
+        }
+    }
+    s_pendingMoveBits = 0;
 
     if (set.count() == 0)
     {
@@ -287,28 +347,26 @@ void EGLViewProtocol::getSetOfTouchesEndOrCancel(Set& set, int num, int ids[], f
         float x = xs[i];
         float y = ys[i];
 
-        Integer* pIndex = (Integer*)s_TouchesIntergerDict.objectForKey(id);
-        if (pIndex == NULL)
+        int index = getIndexOfTouchID(id);
+        if (index == -1)
         {
             CCLOG("if the index doesn't exist, it is an error");
             continue;
         }
         /* Add to the set to send to the director */
-        Touch* pTouch = s_pTouches[pIndex->getValue()];        
+        Touch* pTouch = s_pTouches[index];
         if (pTouch)
         {
             CCLOGINFO("Ending touches with id: %d, x=%f, y=%f", id, x, y);
-			pTouch->setTouchInfo(pIndex->getValue(), (x - _viewPortRect.origin.x) / _scaleX, 
+			pTouch->setTouchInfo(index, (x - _viewPortRect.origin.x) / _scaleX, 
 								(y - _viewPortRect.origin.y) / _scaleY);
 
             set.addObject(pTouch);
 
             // release the object
             pTouch->release();
-            s_pTouches[pIndex->getValue()] = NULL;
-            removeUsedIndexBit(pIndex->getValue());
-
-            s_TouchesIntergerDict.removeObjectForKey(id);
+            s_pTouches[index] = NULL;
+            removeUsedIndexBit(index);
 
         } 
         else
@@ -328,6 +386,15 @@ void EGLViewProtocol::getSetOfTouchesEndOrCancel(Set& set, int num, int ids[], f
 
 void EGLViewProtocol::handleTouchesEnd(int num, int ids[], float xs[], float ys[])
 {
+    if (InputRecorder::isActive() && !InputRecorder::getInstance()->onTouches(InputRecorder::TouchPhase::ENDED, num, ids, xs, ys))
+    {
+        return;
+    }
+
+    Director::setNextFrameDirty();
+
+    dispatchPendingTouches();
+
     Set set;
     getSetOfTouchesEndOrCancel(set, num, ids, xs, ys);
     _delegate->touchesEnded(&set, NULL);
@@ -335,6 +402,15 @@ void EGLViewProtocol::handleTouchesEnd(int num, int ids[], float xs[], float ys[
 
 void EGLViewProtocol::handleTouchesCancel(int num, int ids[], float xs[], float ys[])
 {
+    if (InputRecorder::isActive() && !InputRecorder::getInstance()->onTouches(InputRecorder::TouchPhase::CANCELLED, num, ids, xs, ys))
+    {
+        return;
+    }
+
+    Director::setNextFrameDirty();
+
+    dispatchPendingTouches();
+
     Set set;
     getSetOfTouchesEndOrCancel(set, num, ids, xs, ys);
     _delegate->touchesCancelled(&set, NULL);
@@ -128,6 +128,19 @@ public:
     virtual void handleTouchesEnd(int num, int ids[], float xs[], float ys[]);
     virtual void handleTouchesCancel(int num, int ids[], float xs[], float ys[]);
 
+    /** Dispatches the touch moves queued since the last call as a single touchesMoved.
+     handleTouchesMove only records the latest location of each touch; the Director calls this once per frame.
+     Begin, end and cancel events dispatch the pending moves first, so the order of events is kept.
+     @since v3.0
+     */
+    void dispatchPendingTouches();
+
+    /** Records every coalesced move location in Touch::getHistoryInView(). Disabled by default.
+     @since v3.0
+     */
+    void setTouchHistoryEnabled(bool enabled) { _touchHistoryEnabled = enabled; }
+    bool isTouchHistoryEnabled() const { return _touchHistoryEnabled; }
+
     /**
      * Get the opengl view port rectangle.
      */
@@ -160,6 +173,7 @@ protected:
     float  _scaleX;
     float  _scaleY;
     ResolutionPolicy _resolutionPolicy;
+    bool _touchHistoryEnabled;
 };
 
 // end of platform group
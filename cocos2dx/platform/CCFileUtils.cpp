@@ -27,9 +27,14 @@ THE SOFTWARE.
 #include "cocoa/CCDictionary.h"
 #include "cocoa/CCString.h"
 #include "CCSAXParser.h"
+#include "CCMappedFile.h"
+#include "support/CCAssetLoadProfiler.h"
 #include "support/tinyxml2/tinyxml2.h"
 #include "support/zip_support/unzip.h"
+#include "support/zip_support/ZipUtils.h"
+#include "support/ccUTF8.h"
 #include <stack>
+#include <algorithm>
 
 using namespace std;
 
@@ -86,7 +91,7 @@ public:
     {
     }
 
-    Dictionary* dictionaryWithContentsOfFile(const char *pFileName)
+    Dictionary* dictionaryWithContentsOfData(const char *data, unsigned int size)
     {
         _resultType = SAX_RESULT_DICT;
         SAXParser parser;
@@ -97,11 +102,11 @@ public:
         }
         parser.setDelegator(this);
 
-        parser.parse(pFileName);
+        parser.parse(data, size);
         return _rootDict;
     }
 
-    Array* arrayWithContentsOfFile(const char* pFileName)
+    Array* arrayWithContentsOfData(const char *data, unsigned int size)
     {
         _resultType = SAX_RESULT_ARRAY;
         SAXParser parser;
@@ -112,7 +117,7 @@ public:
         }
         parser.setDelegator(this);
 
-        parser.parse(pFileName);
+        parser.parse(data, size);
         return _array;
     }
 
@@ -260,7 +265,8 @@ public:
         }
         else if (sName == "string" || sName == "integer" || sName == "real")
         {
-            String* pStrValue = new String(_curValue);
+            // the String takes the characters of the value, _curValue is cleared below
+            String* pStrValue = new String(std::move(_curValue));
 
             if (SAX_ARRAY == curState)
             {
@@ -287,12 +293,11 @@ public:
         }
 
         SAXState curState = _stateStack.empty() ? SAX_DICT : _stateStack.top();
-        String *pText = new String(std::string((char*)ch,0,len));
 
         switch(_state)
         {
         case SAX_KEY:
-            _curKey = pText->getCString();
+            _curKey.assign(ch, len);
             break;
         case SAX_INT:
         case SAX_REAL:
@@ -303,28 +308,316 @@ public:
                     CCASSERT(!_curKey.empty(), "key not found : <integer/real>");
                 }
                 
-                _curValue.append(pText->getCString());
+                _curValue.append(ch, len);
             }
             break;
         default:
             break;
         }
-        pText->release();
     }
 };
 
+/**
+ * Reads Apple binary property lists ("bplist00") into the same tree DictMaker builds.
+ *
+ * As in XML plists loaded by DictMaker, integers, reals and booleans become
+ * Strings, and dates, data and UIDs are left out. Sets are read as Arrays.
+ */
+class BinaryPlistReader
+{
+public:
+    BinaryPlistReader(const unsigned char* data, size_t size)
+        : _data(data)
+        , _size(size)
+        , _offsetTable(NULL)
+        , _offsetSize(0)
+        , _refSize(0)
+        , _objectCount(0)
+        , _topObject(0)
+    {
+    }
+
+    static bool isBinaryPlist(const unsigned char* data, size_t size)
+    {
+        return size >= sizeof(s_magic) + s_trailerSize && memcmp(data, s_magic, sizeof(s_magic)) == 0;
+    }
+
+    /** Returns the root object, retained, or NULL if the file is malformed */
+    Object* createRootObject()
+    {
+        if (!isBinaryPlist(_data, _size))
+            return NULL;
+
+        const unsigned char* trailer = _data + _size - s_trailerSize;
+        _offsetSize = trailer[6];
+        _refSize = trailer[7];
+        _objectCount = readUInt(trailer + 8, 8);
+        _topObject = readUInt(trailer + 16, 8);
+        uint64_t tableOffset = readUInt(trailer + 24, 8);
+
+        if (_offsetSize < 1 || _offsetSize > 8 || _refSize < 1 || _refSize > 8
+            || _topObject >= _objectCount
+            || tableOffset >= _size - s_trailerSize
+            || _objectCount > (_size - s_trailerSize - tableOffset) / _offsetSize)
+        {
+            CCLOG("cocos2d: BinaryPlistReader: invalid trailer");
+            return NULL;
+        }
+        _offsetTable = _data + tableOffset;
+        _visiting.assign((size_t)_objectCount, false);
+
+        return readObject(_topObject);
+    }
+
+private:
+    static const char s_magic[8];
+    static const size_t s_trailerSize = 32;
+
+    static uint64_t readUInt(const unsigned char* p, int bytes)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i)
+        {
+            value = (value << 8) | p[i];
+        }
+        return value;
+    }
+
+    /** Reads the element count of a marker, which can follow as an int object; returns the first byte after it */
+    const unsigned char* readCount(const unsigned char* p, const unsigned char* end, uint64_t* count)
+    {
+        *count = p[0] & 0x0F;
+        ++p;
+        if (*count != 0x0F)
+            return p;
+
+        if (p >= end || (p[0] & 0xF0) != 0x10)
+            return NULL;
+        int bytes = 1 << (p[0] & 0x0F);
+        if (bytes > 8 || end - p - 1 < bytes)
+            return NULL;
+        *count = readUInt(p + 1, bytes);
+        return p + 1 + bytes;
+    }
+
+    static std::string formatNumber(double value, bool single)
+    {
+        // the shortest text that reads back as the same value, as a plist editor writes it
+        char buffer[32];
+        for (int precision = single ? 6 : 15; precision <= 17; ++precision)
+        {
+            snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+            double parsed = strtod(buffer, NULL);
+            if (single ? (float)parsed == (float)value : parsed == value)
+                break;
+        }
+        return buffer;
+    }
+
+    Object* readObject(uint64_t ref)
+    {
+        if (ref >= _objectCount || _visiting[(size_t)ref])
+            return NULL;
+
+        uint64_t offset = readUInt(_offsetTable + ref * _offsetSize, _offsetSize);
+        if (offset < sizeof(s_magic) || offset >= _size - s_trailerSize)
+            return NULL;
+
+        const unsigned char* p = _data + offset;
+        const unsigned char* end = _data + _size - s_trailerSize;
+        unsigned char marker = p[0];
+
+        switch (marker >> 4)
+        {
+        case 0x0:
+            if (marker == 0x08 || marker == 0x09)
+                return new String(marker == 0x09 ? "1" : "0");
+            return NULL;
+
+        case 0x1:
+            {
+                int bytes = 1 << (marker & 0x0F);
+                if (bytes > 16 || end - p - 1 < bytes)
+                    return NULL;
+                // 16 byte integers keep their value in the low 8 bytes
+                const unsigned char* digits = p + 1 + (bytes > 8 ? bytes - 8 : 0);
+                uint64_t value = readUInt(digits, bytes > 8 ? 8 : bytes);
+                char buffer[24];
+                if (bytes >= 8)
+                    snprintf(buffer, sizeof(buffer), "%lld", (long long)value);
+                else
+                    snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)value);
+                return new String(buffer);
+            }
+
+        case 0x2:
+            {
+                int bytes = 1 << (marker & 0x0F);
+                if ((bytes != 4 && bytes != 8) || end - p - 1 < bytes)
+                    return NULL;
+                uint64_t bits = readUInt(p + 1, bytes);
+                double value;
+                if (bytes == 4)
+                {
+                    uint32_t bits32 = (uint32_t)bits;
+                    float f;
+                    memcpy(&f, &bits32, sizeof(f));
+                    value = f;
+                }
+                else
+                {
+                    memcpy(&value, &bits, sizeof(value));
+                }
+                return new String(formatNumber(value, bytes == 4));
+            }
+
+        case 0x5:
+        case 0x6:
+            {
+                uint64_t count;
+                const unsigned char* chars = readCount(p, end, &count);
+                uint64_t unit = (marker >> 4) == 0x6 ? 2 : 1;
+                if (chars == NULL || count > (uint64_t)(end - chars) / unit)
+                    return NULL;
+
+                if (unit == 1)
+                    return new String(std::string((const char*)chars, (size_t)count));
+
+                std::vector<unsigned short> utf16((size_t)count + 1, 0);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    utf16[i] = (unsigned short)((chars[i * 2] << 8) | chars[i * 2 + 1]);
+                }
+                char* utf8 = cc_utf16_to_utf8(&utf16[0], (long)count, NULL, NULL);
+                if (utf8 == NULL)
+                    return NULL;
+                String* str = new String(utf8);
+                delete [] utf8;
+                return str;
+            }
+
+        case 0xA:
+        case 0xC:
+            {
+                uint64_t count;
+                const unsigned char* refs = readCount(p, end, &count);
+                if (refs == NULL || count > (uint64_t)(end - refs) / _refSize)
+                    return NULL;
+
+                Array* array = new Array((unsigned int)count);
+                _visiting[(size_t)ref] = true;
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    Object* element = readObject(readUInt(refs + i * _refSize, _refSize));
+                    if (element)
+                    {
+                        array->addObject(element);
+                        element->release();
+                    }
+                }
+                _visiting[(size_t)ref] = false;
+                return array;
+            }
+
+        case 0xD:
+            {
+                uint64_t count;
+                const unsigned char* keys = readCount(p, end, &count);
+                if (keys == NULL || count > (uint64_t)(end - keys) / _refSize / 2)
+                    return NULL;
+                const unsigned char* values = keys + count * _refSize;
+
+                Dictionary* dict = new Dictionary();
+                _visiting[(size_t)ref] = true;
+                for (uint64_t i = 0; i < count; ++i)
+                {
+                    Object* key = readObject(readUInt(keys + i * _refSize, _refSize));
+                    String* keyString = dynamic_cast<String*>(key);
+                    Object* value = keyString ? readObject(readUInt(values + i * _refSize, _refSize)) : NULL;
+                    if (value)
+                    {
+                        dict->setObject(value, keyString->getCString());
+                        value->release();
+                    }
+                    CC_SAFE_RELEASE(key);
+                }
+                _visiting[(size_t)ref] = false;
+                return dict;
+            }
+
+        default:
+            // dates, data and UIDs have no counterpart in the XML loader
+            return NULL;
+        }
+    }
+
+    const unsigned char* _data;
+    size_t _size;
+    const unsigned char* _offsetTable;
+    int _offsetSize;
+    int _refSize;
+    uint64_t _objectCount;
+    uint64_t _topObject;
+    // containers being read, so that a reference cycle can't recurse forever
+    std::vector<bool> _visiting;
+};
+
+const char BinaryPlistReader::s_magic[8] = { 'b', 'p', 'l', 'i', 's', 't', '0', '0' };
+
 Dictionary* FileUtils::createDictionaryWithContentsOfFile(const std::string& filename)
 {
     std::string fullPath = fullPathForFilename(filename.c_str());
+    CC_PROFILE_ASSET(fullPath.c_str());
+    MappedFile* file = getMappedFileData(fullPath.c_str());
+    if (file == NULL || file->getSize() == 0)
+    {
+        return NULL;
+    }
+
+    CC_PROFILE_ASSET_STAGE(stage, PARSE, fullPath.c_str());
+    CC_PROFILE_ASSET_BYTES(stage, file->getSize());
+    if (BinaryPlistReader::isBinaryPlist(file->getBytes(), file->getSize()))
+    {
+        BinaryPlistReader reader(file->getBytes(), file->getSize());
+        Object* root = reader.createRootObject();
+        Dictionary* dict = dynamic_cast<Dictionary*>(root);
+        if (dict == NULL)
+        {
+            CC_SAFE_RELEASE(root);
+        }
+        return dict;
+    }
+
     DictMaker tMaker;
-    return tMaker.dictionaryWithContentsOfFile(fullPath.c_str());
+    return tMaker.dictionaryWithContentsOfData((const char*)file->getBytes(), (unsigned int)file->getSize());
 }
 
 Array* FileUtils::createArrayWithContentsOfFile(const std::string& filename)
 {
     std::string fullPath = fullPathForFilename(filename.c_str());
+    CC_PROFILE_ASSET(fullPath.c_str());
+    MappedFile* file = getMappedFileData(fullPath.c_str());
+    if (file == NULL || file->getSize() == 0)
+    {
+        return NULL;
+    }
+
+    CC_PROFILE_ASSET_STAGE(stage, PARSE, fullPath.c_str());
+    CC_PROFILE_ASSET_BYTES(stage, file->getSize());
+    if (BinaryPlistReader::isBinaryPlist(file->getBytes(), file->getSize()))
+    {
+        BinaryPlistReader reader(file->getBytes(), file->getSize());
+        Object* root = reader.createRootObject();
+        Array* array = dynamic_cast<Array*>(root);
+        if (array == NULL)
+        {
+            CC_SAFE_RELEASE(root);
+        }
+        return array;
+    }
+
     DictMaker tMaker;
-    return tMaker.arrayWithContentsOfFile(fullPath.c_str());
+    return tMaker.arrayWithContentsOfData((const char*)file->getBytes(), (unsigned int)file->getSize());
 }
 
 
@@ -483,6 +776,11 @@ FileUtils::FileUtils()
 FileUtils::~FileUtils()
 {
     CC_SAFE_RELEASE(_filenameLookupDict);
+
+    for (auto iter = _packFiles.begin(); iter != _packFiles.end(); ++iter)
+    {
+        delete iter->zipFile;
+    }
 }
 
 
@@ -496,6 +794,7 @@ bool FileUtils::init()
 void FileUtils::purgeCachedEntries()
 {
     _fullPathCache.clear();
+    _missingPathCache.clear();
 }
 
 unsigned char* FileUtils::getFileData(const char* filename, const char* pszMode, unsigned long * pSize)
@@ -503,10 +802,20 @@ unsigned char* FileUtils::getFileData(const char* filename, const char* pszMode,
     unsigned char * pBuffer = NULL;
     CCASSERT(filename != NULL && pSize != NULL && pszMode != NULL, "Invalid parameters.");
     *pSize = 0;
+    CC_PROFILE_ASSET_STAGE(stage, READ, filename);
     do
     {
         // read the file from hardware
         std::string fullPath = fullPathForFilename(filename);
+
+        std::string entryName;
+        ZipFile* packFile = findPackFile(fullPath, &entryName);
+        if (packFile)
+        {
+            pBuffer = packFile->getFileData(entryName, pSize);
+            break;
+        }
+
         FILE *fp = fopen(fullPath.c_str(), pszMode);
         CC_BREAK_IF(!fp);
         
@@ -517,6 +826,7 @@ unsigned char* FileUtils::getFileData(const char* filename, const char* pszMode,
         *pSize = fread(pBuffer,sizeof(unsigned char), *pSize,fp);
         fclose(fp);
     } while (0);
+    CC_PROFILE_ASSET_BYTES(stage, *pSize);
     
     if (! pBuffer)
     {
@@ -528,6 +838,43 @@ unsigned char* FileUtils::getFileData(const char* filename, const char* pszMode,
     return pBuffer;
 }
 
+MappedFile* FileUtils::getMappedFileData(const char* filename)
+{
+    CCASSERT(filename != NULL, "Invalid parameters.");
+
+    std::string fullPath = fullPathForFilename(filename);
+    // the pages are read when they are accessed, by the next stage
+    CC_PROFILE_ASSET_STAGE(stage, READ, filename);
+
+    std::string entryName;
+    ZipFile* packFile = findPackFile(fullPath, &entryName);
+    if (packFile)
+    {
+        MappedFile* file = packFile->getMappedFileData(entryName);
+        if (file)
+        {
+            CC_PROFILE_ASSET_BYTES(stage, file->getSize());
+        }
+        return file;
+    }
+
+    MappedFile* file = MappedFile::createWithFile(fullPath);
+    if (file)
+    {
+        CC_PROFILE_ASSET_BYTES(stage, file->getSize());
+    }
+    else
+    {
+        unsigned long size = 0;
+        unsigned char* buffer = getFileData(fullPath.c_str(), "rb", &size);
+        if (buffer)
+        {
+            file = MappedFile::createWithBuffer(buffer, size);
+        }
+    }
+    return file;
+}
+
 unsigned char* FileUtils::getFileDataFromZip(const char* pszZipFilePath, const char* filename, unsigned long * pSize)
 {
     unsigned char * pBuffer = NULL;
@@ -625,6 +972,12 @@ std::string FileUtils::fullPathForFilename(const char* filename)
         //CCLOG("Return full path from cache: %s", cacheIter->second.c_str());
         return cacheIter->second;
     }
+
+    // Already searched and not found ?
+    if (_missingPathCache.find(strFileName) != _missingPathCache.end())
+    {
+        return filename;
+    }
     
     // Get the new file name.
     std::string newFilename = getNewFilename(filename);
@@ -653,6 +1006,7 @@ std::string FileUtils::fullPathForFilename(const char* filename)
 //    CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename);
 
     // The file wasn't found, return the file name passed in.
+    _missingPathCache.insert(strFileName);
     return filename;
 }
 
@@ -669,6 +1023,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 {
     bool bExistDefault = false;
     _fullPathCache.clear();
+    _missingPathCache.clear();
     _searchResolutionsOrderArray.clear();
     for (std::vector<std::string>::const_iterator iter = searchResolutionsOrder.begin(); iter != searchResolutionsOrder.end(); ++iter)
     {
@@ -693,6 +1048,8 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 
 void FileUtils::addSearchResolutionsOrder(const char* order)
 {
+    // the order is appended: the files already found keep their path
+    _missingPathCache.clear();
     _searchResolutionsOrderArray.push_back(order);
 }
 
@@ -711,6 +1068,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
     bool bExistDefaultRootPath = false;
     
     _fullPathCache.clear();
+    _missingPathCache.clear();
     _searchPathArray.clear();
     for (std::vector<std::string>::const_iterator iter = searchPaths.begin(); iter != searchPaths.end(); ++iter)
     {
@@ -752,12 +1110,15 @@ void FileUtils::addSearchPath(const char* path_)
     {
         path += "/";
     }
+    // the path is appended: the files already found keep their path
+    _missingPathCache.clear();
     _searchPathArray.push_back(path);
 }
 
 void FileUtils::setFilenameLookupDictionary(Dictionary* pFilenameLookupDict)
 {
     _fullPathCache.clear();    
+    _missingPathCache.clear();
     CC_SAFE_RELEASE(_filenameLookupDict);
     _filenameLookupDict = pFilenameLookupDict;
     CC_SAFE_RETAIN(_filenameLookupDict);
@@ -797,6 +1158,76 @@ bool FileUtils::isAbsolutePath(const std::string& strPath)
     return strPath[0] == '/' ? true : false;
 }
 
+bool FileUtils::addPackFile(const std::string& packPath, const std::string& mountPath, const std::string& entryPrefix)
+{
+    ZipFile* zipFile = new ZipFile(packPath, entryPrefix);
+    if (! zipFile->isOpen())
+    {
+        CCLOG("cocos2d: FileUtils: can't open the pack file %s", packPath.c_str());
+        delete zipFile;
+        return false;
+    }
+
+    PackFile packFile;
+    packFile.mountPath = isAbsolutePath(mountPath) ? mountPath : _defaultResRootPath + mountPath;
+    if (packFile.mountPath.length() > 0 && packFile.mountPath[packFile.mountPath.length()-1] != '/')
+    {
+        packFile.mountPath += "/";
+    }
+    packFile.entryPrefix = entryPrefix;
+    packFile.zipFile = zipFile;
+    _packFiles.push_back(packFile);
+
+    _fullPathCache.clear();
+    _missingPathCache.clear();
+    return true;
+}
+
+void FileUtils::removePackFile(const std::string& packPath)
+{
+    for (auto iter = _packFiles.begin(); iter != _packFiles.end(); ++iter)
+    {
+        if (iter->zipFile->getPath() == packPath)
+        {
+            delete iter->zipFile;
+            _packFiles.erase(iter);
+
+            _fullPathCache.clear();
+            _missingPathCache.clear();
+            return;
+        }
+    }
+}
+
+ZipFile* FileUtils::findPackFile(const std::string& fullPath, std::string* entryName)
+{
+    if (_packFiles.empty())
+    {
+        return NULL;
+    }
+
+    // FileUtilsWin32 builds paths with '\\'
+    std::string path(fullPath);
+    std::replace(path.begin(), path.end(), '\\', '/');
+
+    for (auto iter = _packFiles.rbegin(); iter != _packFiles.rend(); ++iter)
+    {
+        if (path.compare(0, iter->mountPath.length(), iter->mountPath) == 0)
+        {
+            std::string entry = iter->entryPrefix + path.substr(iter->mountPath.length());
+            if (iter->zipFile->fileExists(entry))
+            {
+                if (entryName)
+                {
+                    *entryName = entry;
+                }
+                return iter->zipFile;
+            }
+        }
+    }
+    return NULL;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Notification support when getFileData from invalid file path.
 //////////////////////////////////////////////////////////////////////////
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_set>
 #include "CCPlatformMacros.h"
 #include "ccTypes.h"
 #include "ccTypeInfo.h"
@@ -35,6 +36,8 @@ NS_CC_BEGIN
 
 class Dictionary;
 class Array;
+class MappedFile;
+class ZipFile;
 /**
  * @addtogroup platform
  * @{
@@ -84,6 +87,8 @@ public:
      *        For instance, in the CocosPlayer sample, every time you run application from CocosBuilder,
      *        All the resources will be downloaded to the writable folder, before new js app launchs,
      *        this method should be invoked to clean the file search cache.
+     *        Files that were not found are cached too: it must also be invoked after a file is created
+     *        in a search path, if its full path was searched before.
      */
     virtual void purgeCachedEntries();
     
@@ -108,6 +113,16 @@ public:
      */
     virtual unsigned char* getFileDataFromZip(const char* pszZipFilePath, const char* filename, unsigned long * pSize);
 
+    /**
+     *  Gets a read-only view of resource file data, without copying it when the file can be mapped in memory.
+     *
+     *  @param[in]  filename The resource file name which contains the path.
+     *  @return Upon success, an autoreleased MappedFile, otherwise NULL.
+     *  @note Files that can't be mapped are read into a buffer, as getFileData() does.
+     *  @since v3.0
+     */
+    virtual MappedFile* getMappedFileData(const char* filename);
+
     
     /** Returns the fullpath for a given filename.
      
@@ -293,6 +308,28 @@ public:
      */
     virtual bool isAbsolutePath(const std::string& strPath);
     
+    /**
+     *  Mounts a zip file, like a downloaded package or the APK: its entries are seen as the files of a directory.
+     *
+     *  The entries are indexed once, so finding a file costs a hash lookup instead of a file system (or APK) lookup,
+     *  and the entries stored without compression are mapped by getMappedFileData() instead of being copied.
+     *  The directory is not added to the search paths, add it with addSearchPath() to find the entries with relative names.
+     *  Zip files must be mounted or removed while no texture is loaded asynchronously.
+     *
+     *  @param packPath The full path of the zip file.
+     *  @param mountPath The directory where the entries are seen. A relative directory is relative to the default root path of resources, like search paths.
+     *  @param entryPrefix Only the entries whose names start with it are seen, without it.
+     *                     For instance, addPackFile(apkPath, "", "assets/") mounts the assets of the APK where the asset manager finds them.
+     *  @return false if the zip file can't be opened.
+     *  @since v3.0
+     */
+    virtual bool addPackFile(const std::string& packPath, const std::string& mountPath, const std::string& entryPrefix = "");
+
+    /**
+     *  Unmounts a zip file mounted with addPackFile().
+     *  @since v3.0
+     */
+    virtual void removePackFile(const std::string& packPath);
     
     /**
      *  Sets/Gets whether to pop-up a message box when failed to load an image.
@@ -348,6 +385,7 @@ protected:
     
     /**
      *  Creates a dictionary by the contents of a file.
+     *  XML and binary ("bplist00") property lists are both accepted; the format is detected from the file contents.
      *  @note This method is used internally.
      */
     virtual Dictionary* createDictionaryWithContentsOfFile(const std::string& filename);
@@ -360,9 +398,16 @@ protected:
     
     /**
      *  Creates an array by the contents of a file.
+     *  XML and binary ("bplist00") property lists are both accepted; the format is detected from the file contents.
      *  @note This method is used internally.
      */
     virtual Array* createArrayWithContentsOfFile(const std::string& filename);
+
+    /**
+     *  Returns the mounted zip file which has the file at fullPath, and the name of its entry in entryName (if not NULL).
+     *  The zip files mounted last are checked first.
+     */
+    ZipFile* findPackFile(const std::string& fullPath, std::string* entryName);
     
     /** Dictionary used to lookup filenames based on a key.
      *  It is used internally by the following methods:
@@ -399,6 +444,25 @@ protected:
      *  This variable is used for improving the performance of file search.
      */
     std::map<std::string, std::string> _fullPathCache;
+
+    /**
+     *  The names of the files that were not found in any search path.
+     *  Missing optional resources are probed often, and each search costs a file system (or APK) lookup per search path and resolution.
+     *  It is cleared, along with _fullPathCache, when the search paths or the resolutions order change.
+     */
+    std::unordered_set<std::string> _missingPathCache;
+
+    struct PackFile
+    {
+        std::string mountPath;
+        std::string entryPrefix;
+        ZipFile* zipFile;
+    };
+
+    /**
+     *  The zip files mounted by addPackFile().
+     */
+    std::vector<PackFile> _packFiles;
     
     /**
      *  The singleton pointer of FileUtils.
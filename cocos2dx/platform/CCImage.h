@@ -46,6 +46,7 @@ class CC_DLL Image : public Object
 {
 public:
     friend class TextureCache;
+    friend class VolatileTexture;
     
     Image();
     virtual ~Image();
@@ -150,6 +151,26 @@ public:
                                         );
     
     #endif
+
+    #if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+
+    /**
+    @brief    Computes the size of the image initWithString() would create, without rendering the text.
+    @param  pOutWidth   receives the width the image would have.
+    @param  pOutHeight  receives the height the image would have.
+    @return false if the font can't be loaded.
+    @since v3.0
+    */
+    static bool getStringSize(
+        const char *    pText,
+        int             nWidth,
+        int             nHeight,
+        const char *    pFontName,
+        int             nSize,
+        int *           pOutWidth,
+        int *           pOutHeight);
+
+    #endif
     
 
     /**
@@ -169,11 +190,28 @@ public:
     inline unsigned short getWidth() { return _width; };
     inline unsigned short getHeight() { return _height; };
     inline int getBitsPerComponent() { return _bitsPerComponent; };
+
+    /** Divides the width and the height of the image by 2^shift while it is decoded, for low-memory devices.
+     Must be called before the image is initialized. JPEG images are decoded by the scaled IDCT of libjpeg,
+     and the rows of the PNG images are averaged while they are read. The shift is limited to 3,
+     and the other formats, as well as the interlaced PNG images, are decoded at their full size.
+     @since v3.0
+     */
+    inline void setDecodeDownscale(unsigned int shift) { _decodeDownscale = shift; }
+    /** Number of halvings applied by the decoder: 0 when the image has the size of its file.
+     @since v3.0
+     */
+    inline unsigned int getDownscale() const { return _downscale; }
     //
     
 protected:
     bool initWithJpgData(void *pData, int nDatalen);
     bool initWithPngData(void *pData, int nDatalen);
+    /** decodes a PNG file while it is read, without loading the whole file first.
+     Returns false if the file can't be opened with fopen(), files in archives (Android assets) must use initWithPngData() */
+    bool initWithPngFile(const char *fullpath);
+    /** io is a FILE* when fromFile is true, a tImageSource* otherwise */
+    bool decodePng(void *io, bool fromFile);
     bool initWithTiffData(void *pData, int nDataLen);
     bool initWithWebpData(void *pData, int nDataLen);
 
@@ -187,6 +225,8 @@ protected:
     unsigned char *_data;
     bool _hasAlpha;
     bool _preMulti;
+    unsigned int _decodeDownscale;
+    unsigned int _downscale;
 
 
 private:
@@ -48,17 +48,23 @@ bool Image::initWithWebpData(void *pData, int nDataLen)
         if (WebPGetFeatures((uint8_t*)pData, nDataLen, &config.input) != VP8_STATUS_OK) break;
         if (config.input.width == 0 || config.input.height == 0) break;
         
-        config.output.colorspace = MODE_RGBA;
+        // Decode straight into the layout Texture2D uploads, so it needs no extra pass:
+        // premultiplied RGBA like the other loaders, or RGB888 when there is no alpha.
+        _hasAlpha = config.input.has_alpha != 0;
+        _preMulti = _hasAlpha;
+        config.output.colorspace = _hasAlpha ? MODE_rgbA : MODE_RGB;
+        // lets the lossy decoder filter on a second thread while it decodes
+        config.options.use_threads = 1;
         _bitsPerComponent = 8;
         _width    = config.input.width;
         _height   = config.input.height;
-        _hasAlpha = true;
         
-        int bufferSize = _width * _height * 4;
+        int bytesPerPixel = _hasAlpha ? 4 : 3;
+        int bufferSize = _width * _height * bytesPerPixel;
         _data = new unsigned char[bufferSize];
         
         config.output.u.RGBA.rgba = (uint8_t*)_data;
-        config.output.u.RGBA.stride = _width * 4;
+        config.output.u.RGBA.stride = _width * bytesPerPixel;
         config.output.u.RGBA.size = bufferSize;
         config.output.is_external_memory = 1;
 
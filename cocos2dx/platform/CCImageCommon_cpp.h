@@ -30,9 +30,13 @@ THE SOFTWARE.
 #include "CCCommon.h"
 #include "CCStdC.h"
 #include "CCFileUtils.h"
+#include "CCMappedFile.h"
+#include "support/CCAssetLoadProfiler.h"
 #include "png.h"
 #include "jpeglib.h"
 #include "tiffio.h"
+#include <vector>
+#include <algorithm>
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "platform/android/CCFileUtilsAndroid.h"
 #endif
@@ -71,6 +75,23 @@ static void pngReadCallback(png_structp png_ptr, png_bytep data, png_size_t leng
     }
 }
 
+static void pngFileReadCallback(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+    FILE* fp = (FILE*)png_get_io_ptr(png_ptr);
+    size_t read = 0;
+    {
+        // png_error() doesn't return: the stage must be left before
+        CC_PROFILE_ASSET_STAGE(stage, READ, NULL);
+        CC_PROFILE_ASSET_BYTES(stage, length);
+        read = fread(data, 1, length, fp);
+    }
+
+    if (read != length)
+    {
+        png_error(png_ptr, "pngFileReadCallback failed");
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Implement Image
 //////////////////////////////////////////////////////////////////////////
@@ -82,6 +103,8 @@ Image::Image()
 , _data(0)
 , _hasAlpha(false)
 , _preMulti(false)
+, _decodeDownscale(0)
+, _downscale(0)
 {
 
 }
@@ -95,6 +118,7 @@ bool Image::initWithImageFile(const char * strPath, Format eImgFmt/* = eFmtPng*/
 {
     bool bRet = false;
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(strPath);
+    CC_PROFILE_ASSET(fullPath);
 
 #ifdef EMSCRIPTEN
     // Emscripten includes a re-implementation of SDL that uses HTML5 canvas
@@ -116,13 +140,18 @@ bool Image::initWithImageFile(const char * strPath, Format eImgFmt/* = eFmtPng*/
 
     SDL_FreeSurface(iSurf);
 #else
-    unsigned long nSize = 0;
-    unsigned char* pBuffer = FileUtils::getInstance()->getFileData(fullPath.c_str(), "rb", &nSize);
-    if (pBuffer != NULL && nSize > 0)
+    // PNG files are decoded while they are read, when they are not in an archive
+    if (Format::PNG == eImgFmt && initWithPngFile(fullPath.c_str()))
     {
-        bRet = initWithImageData(pBuffer, nSize, eImgFmt);
+        return true;
+    }
+
+    // the decoders only read the data
+    MappedFile* file = FileUtils::getInstance()->getMappedFileData(fullPath.c_str());
+    if (file != NULL && file->getSize() > 0)
+    {
+        bRet = initWithImageData((void*)file->getBytes(), file->getSize(), eImgFmt);
     }
-    CC_SAFE_DELETE_ARRAY(pBuffer);
 #endif // EMSCRIPTEN
 
     return bRet;
@@ -130,6 +159,13 @@ bool Image::initWithImageFile(const char * strPath, Format eImgFmt/* = eFmtPng*/
 
 bool Image::initWithImageFileThreadSafe(const char *fullpath, Format imageType)
 {
+    CC_PROFILE_ASSET(fullpath);
+
+    if (Format::PNG == imageType && initWithPngFile(fullpath))
+    {
+        return true;
+    }
+
     bool bRet = false;
     unsigned long nSize = 0;
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
@@ -154,6 +190,8 @@ bool Image::initWithImageData(void * pData,
                                 int nBitsPerComponent/* = 8*/)
 {
     bool bRet = false;
+    CC_PROFILE_ASSET_STAGE(stage, DECODE, NULL);
+    CC_PROFILE_ASSET_BYTES(stage, nDataLen > 0 ? nDataLen : 0);
     do 
     {
         CC_BREAK_IF(! pData || nDataLen <= 0);
@@ -227,6 +265,18 @@ bool Image::initWithImageData(void * pData,
                     break;
                 }
             }
+
+            // if it is a webp file buffer ("RIFF" size "WEBP").
+            if (nDataLen > 12)
+            {
+                unsigned char* pHead = (unsigned char*)pData;
+                if (   memcmp(pHead, "RIFF", 4) == 0
+                    && memcmp(pHead + 8, "WEBP", 4) == 0)
+                {
+                    bRet = initWithWebpData(pData, nDataLen);
+                    break;
+                }
+            }
         }
     } while (0);
     return bRet;
@@ -296,6 +346,7 @@ bool Image::initWithJpgData(void * data, int nSize)
     unsigned int i = 0;
 
     bool bRet = false;
+    _downscale = 0;
     do 
     {
         /* We set up the normal JPEG error routines, then override error_exit. */
@@ -339,6 +390,14 @@ bool Image::initWithJpgData(void * data, int nSize)
             break;
         }
 
+        // libjpeg decodes at 1/2, 1/4 or 1/8 of the size with a scaled IDCT
+        if (_decodeDownscale > 0)
+        {
+            _downscale = MIN(_decodeDownscale, 3u);
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = 1 << _downscale;
+        }
+
         /* Start decompression jpeg here */
         jpeg_start_decompress( &cinfo );
 
@@ -382,6 +441,32 @@ bool Image::initWithJpgData(void * data, int nSize)
 
 bool Image::initWithPngData(void * pData, int nDatalen)
 {
+    tImageSource imageSource;
+    imageSource.data    = (unsigned char*)pData;
+    imageSource.size    = nDatalen;
+    imageSource.offset  = 0;
+    return decodePng(&imageSource, false);
+}
+
+bool Image::initWithPngFile(const char * fullpath)
+{
+    // files in archives (Android assets, ...) can't be opened with fopen()
+    FILE* fp = fopen(fullpath, "rb");
+    if (! fp)
+    {
+        return false;
+    }
+
+    // the file is read while it is decoded: the reads are a stage of their own
+    CC_PROFILE_ASSET_STAGE(stage, DECODE, fullpath);
+    bool bRet = decodePng(fp, true);
+    fclose(fp);
+    return bRet;
+}
+
+bool Image::decodePng(void * io, bool fromFile)
+{
+    png_rw_ptr readFn = fromFile ? pngFileReadCallback : pngReadCallback;
 // length of bytes to check if it is a valid png file
 #define PNGSIGSIZE  8
     bool bRet = false;
@@ -389,15 +474,9 @@ bool Image::initWithPngData(void * pData, int nDatalen)
     png_structp     png_ptr     =   0;
     png_infop       info_ptr    = 0;
 
+    _downscale = 0;
     do 
     {
-        // png header len is 8 bytes
-        CC_BREAK_IF(nDatalen < PNGSIGSIZE);
-
-        // check the data is png or not
-        memcpy(header, pData, PNGSIGSIZE);
-        CC_BREAK_IF(png_sig_cmp(header, 0, PNGSIGSIZE));
-
         // init png_struct
         png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
         CC_BREAK_IF(! png_ptr);
@@ -407,18 +486,21 @@ bool Image::initWithPngData(void * pData, int nDatalen)
         CC_BREAK_IF(!info_ptr);
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_BADA && CC_TARGET_PLATFORM != CC_PLATFORM_NACL)
-        CC_BREAK_IF(setjmp(png_jmpbuf(png_ptr)));
+        if (setjmp(png_jmpbuf(png_ptr)))
+        {
+            CC_SAFE_DELETE_ARRAY(_data);
+            break;
+        }
 #endif
 
         // set the read call back function
-        tImageSource imageSource;
-        imageSource.data    = (unsigned char*)pData;
-        imageSource.size    = nDatalen;
-        imageSource.offset  = 0;
-        png_set_read_fn(png_ptr, &imageSource, pngReadCallback);
+        png_set_read_fn(png_ptr, io, readFn);
+
+        // check the data is png or not, png header len is 8 bytes
+        readFn(png_ptr, header, PNGSIGSIZE);
+        CC_BREAK_IF(png_sig_cmp(header, 0, PNGSIGSIZE));
+        png_set_sig_bytes(png_ptr, PNGSIGSIZE);
 
-        // read png header info
-        
         // read png file info
         png_read_info(png_ptr, info_ptr);
         
@@ -455,46 +537,107 @@ bool Image::initWithPngData(void * pData, int nDatalen)
         {
             png_set_gray_to_rgb(png_ptr);
         }
+        // interlaced images are decoded in several passes over the rows
+        int passes = png_set_interlace_handling(png_ptr);
 
         // read png data
         // _bitsPerComponent will always be 8
         _bitsPerComponent = 8;
-        png_uint_32 rowbytes;
-        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
         
         png_read_update_info(png_ptr, info_ptr);
         
-        rowbytes = png_get_rowbytes(png_ptr, info_ptr);
-        
-        _data = new unsigned char[rowbytes * _height];
-        CC_BREAK_IF(!_data);
-        
-        for (unsigned short i = 0; i < _height; ++i)
+        png_uint_32 rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+        png_uint_32 channel = rowbytes/_width;
+        _hasAlpha = (channel == 4);
+
+        if (_decodeDownscale > 0 && passes == 1)
         {
-            row_pointers[i] = _data + i*rowbytes;
+            // each pixel averages a block of 2^n x 2^n pixels, summed while the rows are read.
+            // The rows are premultiplied first, so the transparent pixels don't bleed
+            _downscale = MIN(_decodeDownscale, 3u);
+            const unsigned int factor = 1 << _downscale;
+            const unsigned int width = (_width + factor - 1) >> _downscale;
+            const unsigned int height = (_height + factor - 1) >> _downscale;
+
+            std::vector<png_byte> row(rowbytes);
+            std::vector<unsigned int> sums(width * channel);
+            _data = new unsigned char[width * channel * height];
+            CC_BREAK_IF(!_data);
+
+            for (unsigned int y = 0; y < height; ++y)
+            {
+                std::fill(sums.begin(), sums.end(), 0);
+                const unsigned int rows = MIN(factor, _height - y * factor);
+                for (unsigned int r = 0; r < rows; ++r)
+                {
+                    png_read_row(png_ptr, &row[0], NULL);
+
+                    if (_hasAlpha)
+                    {
+                        unsigned int *tmp = (unsigned int *)&row[0];
+                        for (png_uint_32 j = 0; j < rowbytes; j += 4)
+                        {
+                            *tmp++ = CC_RGB_PREMULTIPLY_ALPHA( row[j], row[j + 1], row[j + 2], row[j + 3] );
+                        }
+                    }
+
+                    for (unsigned int x = 0; x < _width; ++x)
+                    {
+                        unsigned int* sum = &sums[(x >> _downscale) * channel];
+                        const png_byte* pixel = &row[x * channel];
+                        for (png_uint_32 c = 0; c < channel; ++c)
+                        {
+                            sum[c] += pixel[c];
+                        }
+                    }
+                }
+
+                unsigned char* out = _data + y * width * channel;
+                for (unsigned int x = 0; x < width; ++x)
+                {
+                    const unsigned int count = MIN(factor, _width - x * factor) * rows;
+                    for (png_uint_32 c = 0; c < channel; ++c)
+                    {
+                        out[x * channel + c] = (unsigned char)((sums[x * channel + c] + count / 2) / count);
+                    }
+                }
+            }
+
+            png_read_end(png_ptr, NULL);
+
+            _width = width;
+            _height = height;
+            _preMulti = _hasAlpha;
+            bRet = true;
+            break;
         }
-        png_read_image(png_ptr, row_pointers);
         
-        png_read_end(png_ptr, NULL);
+        _data = new unsigned char[rowbytes * _height];
+        CC_BREAK_IF(!_data);
         
-        png_uint_32 channel = rowbytes/_width;
-        if (channel == 4)
+        // decode the image row by row, and premultiply each row while it is still in the cache
+        for (int pass = 0; pass < passes; ++pass)
         {
-            _hasAlpha = true;
-            unsigned int *tmp = (unsigned int *)_data;
-            for(unsigned short i = 0; i < _height; i++)
+            bool lastPass = (pass == passes - 1);
+            for (unsigned short i = 0; i < _height; ++i)
             {
-                for(unsigned int j = 0; j < rowbytes; j += 4)
+                png_bytep row = _data + i * rowbytes;
+                png_read_row(png_ptr, row, NULL);
+
+                if (_hasAlpha && lastPass)
                 {
-                    *tmp++ = CC_RGB_PREMULTIPLY_ALPHA( row_pointers[i][j], row_pointers[i][j + 1], 
-                                                      row_pointers[i][j + 2], row_pointers[i][j + 3] );
+                    unsigned int *tmp = (unsigned int *)row;
+                    for (png_uint_32 j = 0; j < rowbytes; j += 4)
+                    {
+                        *tmp++ = CC_RGB_PREMULTIPLY_ALPHA( row[j], row[j + 1], row[j + 2], row[j + 3] );
+                    }
                 }
             }
-            
-            _preMulti = true;
         }
-
-        CC_SAFE_FREE(row_pointers);
+        
+        png_read_end(png_ptr, NULL);
+        
+        _preMulti = _hasAlpha;
 
         bRet = true;
     } while (0);
@@ -0,0 +1,152 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCMappedFile.h"
+#include "ccMacros.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+NS_CC_BEGIN
+
+MappedFile* MappedFile::createWithFile(const std::string& fullPath)
+{
+    return createWithFile(fullPath, 0, 0);
+}
+
+MappedFile* MappedFile::createWithFile(const std::string& fullPath, unsigned long offset, unsigned long length)
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    WCHAR wszBuf[MAX_PATH] = {0};
+    MultiByteToWideChar(CP_UTF8, 0, fullPath.c_str(), -1, wszBuf, sizeof(wszBuf) / sizeof(wszBuf[0]));
+
+    HANDLE fileHandle = ::CreateFileW(wszBuf, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return NULL;
+    }
+
+    // an empty file can't be mapped
+    DWORD size = ::GetFileSize(fileHandle, NULL);
+    if (length == 0 && size > offset)
+    {
+        length = size - offset;
+    }
+    bool valid = (size != INVALID_FILE_SIZE && length > 0 && offset + length <= size);
+    HANDLE mappingHandle = valid ? ::CreateFileMappingW(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    // the view keeps the file open
+    ::CloseHandle(fileHandle);
+    if (! mappingHandle)
+    {
+        return NULL;
+    }
+
+    // the view must start at a multiple of the allocation granularity
+    SYSTEM_INFO systemInfo;
+    ::GetSystemInfo(&systemInfo);
+    unsigned long delta = offset % systemInfo.dwAllocationGranularity;
+    void* view = ::MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, offset - delta, length + delta);
+    ::CloseHandle(mappingHandle);
+    if (! view)
+    {
+        return NULL;
+    }
+
+    return create((const unsigned char*)view + delta, length, true, [view]() {
+        ::UnmapViewOfFile(view);
+    });
+#else
+    int fd = ::open(fullPath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    // an empty file can't be mapped
+    struct stat st;
+    void* view = MAP_FAILED;
+    // the mapping must start at a multiple of the page size
+    unsigned long delta = offset % sysconf(_SC_PAGESIZE);
+    if (fstat(fd, &st) == 0 && (unsigned long)st.st_size > offset)
+    {
+        if (length == 0)
+        {
+            length = st.st_size - offset;
+        }
+        if (offset + length <= (unsigned long)st.st_size)
+        {
+            view = mmap(NULL, length + delta, PROT_READ, MAP_PRIVATE, fd, offset - delta);
+        }
+    }
+    // the mapping keeps the file open
+    close(fd);
+    if (view == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    size_t size = length + delta;
+    return create((const unsigned char*)view + delta, length, true, [view, size]() {
+        munmap(view, size);
+    });
+#endif
+}
+
+MappedFile* MappedFile::createWithBuffer(unsigned char* buffer, unsigned long size)
+{
+    return create(buffer, size, false, [buffer]() {
+        delete [] buffer;
+    });
+}
+
+MappedFile* MappedFile::create(const unsigned char* bytes, unsigned long size, bool mapped, const std::function<void()>& release)
+{
+    MappedFile* ret = new MappedFile(bytes, size, mapped, release);
+    ret->autorelease();
+    return ret;
+}
+
+MappedFile::MappedFile(const unsigned char* bytes, unsigned long size, bool mapped, const std::function<void()>& release)
+: _bytes(bytes)
+, _size(size)
+, _mapped(mapped)
+, _release(release)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    if (_release)
+    {
+        _release();
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,82 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_PLATFORM_MAPPEDFILE_H__
+#define __CC_PLATFORM_MAPPEDFILE_H__
+
+#include <string>
+#include <functional>
+#include "platform/CCPlatformMacros.h"
+#include "cocoa/CCObject.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/** @brief Read-only view of the content of a file.
+
+ The file is mapped in memory when the platform allows it (mmap(), MapViewOfFile(), uncompressed Android assets),
+ otherwise it is read into a buffer. The view is released with the object: keep a reference to it
+ as long as the bytes are used.
+
+ @since v3.0
+ */
+class CC_DLL MappedFile : public Object
+{
+public:
+    /** maps the file at the full path fullPath in memory.
+     Returns NULL if the file can't be mapped, use FileUtils::getMappedFileData() to read it in this case */
+    static MappedFile* createWithFile(const std::string& fullPath);
+    /** maps length bytes of the file at the full path fullPath, from offset. Used for the entries stored uncompressed in zip files */
+    static MappedFile* createWithFile(const std::string& fullPath, unsigned long offset, unsigned long length);
+    /** takes the ownership of a buffer allocated with new[] */
+    static MappedFile* createWithBuffer(unsigned char* buffer, unsigned long size);
+    /** wraps bytes that are released by release, when the object is deleted */
+    static MappedFile* create(const unsigned char* bytes, unsigned long size, bool mapped, const std::function<void()>& release);
+
+    virtual ~MappedFile();
+
+    inline const unsigned char* getBytes() const { return _bytes; }
+    inline unsigned long getSize() const { return _size; }
+    /** whether or not the bytes are mapped, rather than copied in a buffer */
+    inline bool isMapped() const { return _mapped; }
+
+protected:
+    MappedFile(const unsigned char* bytes, unsigned long size, bool mapped, const std::function<void()>& release);
+
+    const unsigned char* _bytes;
+    unsigned long _size;
+    bool _mapped;
+    std::function<void()> _release;
+};
+
+// end of platform group
+/// @}
+
+NS_CC_END
+
+#endif    // __CC_PLATFORM_MAPPEDFILE_H__
@@ -25,65 +25,430 @@
 #include "CCSAXParser.h"
 #include "cocoa/CCDictionary.h"
 #include "CCFileUtils.h"
-#include "support/tinyxml2/tinyxml2.h"
+#include "CCMappedFile.h"
+#include "support/CCAssetLoadProfiler.h"
 
+#include <string.h>
 #include <vector> // because its based on windows 8 build :P
 
 NS_CC_BEGIN
 
-class XmlSaxHander : public tinyxml2::XMLVisitor
+/**
+ * Streaming XML tokenizer used by SAXParser.
+ *
+ * The input is read in place and never copied as a whole, so it can point
+ * straight into a read-only MappedFile. Text is handed to the delegator as a
+ * pointer into the input unless it contains entities or carriage returns.
+ * Only element and attribute names and attribute values are copied, into a
+ * scratch buffer that is reused for every element because the delegator
+ * expects 0-terminated strings. Comments, processing instructions and the
+ * DOCTYPE are skipped, and whitespace-only text between tags is dropped.
+ */
+class XmlSaxStream
 {
 public:
-	XmlSaxHander():_ccsaxParserImp(0){};
-	
-	virtual bool VisitEnter( const tinyxml2::XMLElement& element, const tinyxml2::XMLAttribute* firstAttribute );
-	virtual bool VisitExit( const tinyxml2::XMLElement& element );
-	virtual bool Visit( const tinyxml2::XMLText& text );
-	virtual bool Visit( const tinyxml2::XMLUnknown&){ return true; }
-
-	void setSAXParserImp(SAXParser* parser)
-	{
-		_ccsaxParserImp = parser;
-	}
+    XmlSaxStream(SAXParser* parser, const char* data, unsigned int length)
+    : _parser(parser)
+    , _begin(data)
+    , _p(data)
+    , _end(data + length)
+    {
+    }
+
+    bool parse();
 
 private:
-	SAXParser *_ccsaxParserImp;
+    bool parseElement();
+    bool parseEndElement();
+    bool parseText();
+    bool skipPast(const char* terminator);
+    bool skipDoctype();
+
+    // Appends [begin, end) to _scratch, decoding entities and newlines.
+    bool appendDecoded(const char* begin, const char* end);
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+    static bool isNameEnd(char c) { return isSpace(c) || c == '/' || c == '>' || c == '=' || c == '\0'; }
+
+    void skipSpaces()
+    {
+        while (_p < _end && isSpace(*_p))
+            ++_p;
+    }
+
+    const char* scanName()
+    {
+        const char* begin = _p;
+        while (_p < _end && !isNameEnd(*_p))
+            ++_p;
+        return begin;
+    }
+
+    SAXParser* _parser;
+    const char* _begin;
+    const char* _p;
+    const char* _end;
+
+    // names and values of the element being reported
+    std::vector<char> _scratch;
+    std::vector<size_t> _offsets;
+    std::vector<const char*> _atts;
+    // open elements, as spans of the input
+    std::vector<std::pair<const char*, size_t> > _open;
 };
 
+bool XmlSaxStream::parse()
+{
+    // UTF-8 byte order mark
+    if (_end - _p >= 3 && (unsigned char)_p[0] == 0xEF && (unsigned char)_p[1] == 0xBB && (unsigned char)_p[2] == 0xBF)
+    {
+        _p += 3;
+    }
+
+    while (_p < _end && *_p)
+    {
+        bool ok;
+        if (*_p != '<')
+        {
+            ok = parseText();
+        }
+        else if (_end - _p >= 4 && memcmp(_p, "<!--", 4) == 0)
+        {
+            ok = skipPast("-->");
+        }
+        else if (_end - _p >= 9 && memcmp(_p, "<![CDATA[", 9) == 0)
+        {
+            const char* begin = _p + 9;
+            _p = begin;
+            ok = skipPast("]]>");
+            if (ok && !_open.empty())
+            {
+                SAXParser::textHandler(_parser, (const CC_XML_CHAR*)begin, (int)(_p - 3 - begin));
+            }
+        }
+        else if (_end - _p >= 2 && _p[1] == '?')
+        {
+            ok = skipPast("?>");
+        }
+        else if (_end - _p >= 2 && _p[1] == '!')
+        {
+            ok = skipDoctype();
+        }
+        else if (_end - _p >= 2 && _p[1] == '/')
+        {
+            ok = parseEndElement();
+        }
+        else
+        {
+            ok = parseElement();
+        }
+
+        if (!ok)
+        {
+            CCLOG("cocos2d: SAXParser: malformed XML at offset %d", (int)(_p - _begin));
+            return false;
+        }
+    }
+
+    return _open.empty();
+}
 
-bool XmlSaxHander::VisitEnter( const tinyxml2::XMLElement& element, const tinyxml2::XMLAttribute* firstAttribute )
+bool XmlSaxStream::skipPast(const char* terminator)
 {
-	//log(" VisitEnter %s",element.Value());
+    size_t len = strlen(terminator);
+    while (_end - _p >= (ptrdiff_t)len)
+    {
+        if (memcmp(_p, terminator, len) == 0)
+        {
+            _p += len;
+            return true;
+        }
+        ++_p;
+    }
+    return false;
+}
 
-	std::vector<const char*> attsVector;
-	for( const tinyxml2::XMLAttribute* attrib = firstAttribute; attrib; attrib = attrib->Next() )
-	{
-		//log("%s", attrib->Name());
-		attsVector.push_back(attrib->Name());
-		//log("%s",attrib->Value());
-		attsVector.push_back(attrib->Value());
-	}
-    
-    // nullptr is used in c++11
-	//attsVector.push_back(nullptr);
-    attsVector.push_back(NULL);
+bool XmlSaxStream::skipDoctype()
+{
+    int depth = 0;
+    char quote = 0;
+    for (++_p; _p < _end; ++_p)
+    {
+        char c = *_p;
+        if (quote)
+        {
+            if (c == quote)
+                quote = 0;
+        }
+        else if (c == '"' || c == '\'')
+            quote = c;
+        else if (c == '[')
+            ++depth;
+        else if (c == ']')
+            --depth;
+        else if (c == '>' && depth <= 0)
+        {
+            ++_p;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool XmlSaxStream::parseElement()
+{
+    ++_p;
+    const char* name = scanName();
+    size_t nameLen = _p - name;
+    if (nameLen == 0)
+    {
+        return false;
+    }
 
-	SAXParser::startElement(_ccsaxParserImp, (const CC_XML_CHAR *)element.Value(), (const CC_XML_CHAR **)(&attsVector[0]));
-	return true;
+    _scratch.clear();
+    _offsets.clear();
+    _scratch.insert(_scratch.end(), name, _p);
+    _scratch.push_back('\0');
+
+    for (;;)
+    {
+        skipSpaces();
+        if (_p >= _end)
+        {
+            return false;
+        }
+        if (*_p == '>' || *_p == '/')
+        {
+            break;
+        }
+
+        const char* attName = scanName();
+        if (_p == attName)
+        {
+            return false;
+        }
+        _offsets.push_back(_scratch.size());
+        _scratch.insert(_scratch.end(), attName, _p);
+        _scratch.push_back('\0');
+
+        skipSpaces();
+        if (_p >= _end || *_p != '=')
+        {
+            return false;
+        }
+        ++_p;
+        skipSpaces();
+        if (_p >= _end || (*_p != '"' && *_p != '\''))
+        {
+            return false;
+        }
+        char quote = *_p++;
+        const char* value = _p;
+        const char* valueEnd = (const char*)memchr(value, quote, _end - value);
+        if (valueEnd == NULL)
+        {
+            return false;
+        }
+        _offsets.push_back(_scratch.size());
+        if (!appendDecoded(value, valueEnd))
+        {
+            return false;
+        }
+        _scratch.push_back('\0');
+        _p = valueEnd + 1;
+    }
+
+    bool empty = (*_p == '/');
+    if (empty)
+    {
+        ++_p;
+        if (_p >= _end || *_p != '>')
+        {
+            return false;
+        }
+    }
+    ++_p;
+
+    // the scratch buffer is complete, so its pointers are stable now
+    _atts.clear();
+    for (size_t i = 0; i < _offsets.size(); ++i)
+    {
+        _atts.push_back(&_scratch[_offsets[i]]);
+    }
+    _atts.push_back(NULL);
+
+    SAXParser::startElement(_parser, (const CC_XML_CHAR*)&_scratch[0], (const CC_XML_CHAR**)&_atts[0]);
+
+    if (empty)
+    {
+        SAXParser::endElement(_parser, (const CC_XML_CHAR*)&_scratch[0]);
+    }
+    else
+    {
+        _open.push_back(std::make_pair(name, nameLen));
+    }
+    return true;
 }
-bool XmlSaxHander::VisitExit( const tinyxml2::XMLElement& element )
+
+bool XmlSaxStream::parseEndElement()
 {
-	//log("VisitExit %s",element.Value());
+    _p += 2;
+    const char* name = scanName();
+    size_t nameLen = _p - name;
+    skipSpaces();
+    if (_p >= _end || *_p != '>' || _open.empty())
+    {
+        return false;
+    }
+    ++_p;
+
+    const std::pair<const char*, size_t>& open = _open.back();
+    if (open.second != nameLen || memcmp(open.first, name, nameLen) != 0)
+    {
+        return false;
+    }
+    _open.pop_back();
+
+    _scratch.assign(name, name + nameLen);
+    _scratch.push_back('\0');
+    SAXParser::endElement(_parser, (const CC_XML_CHAR*)&_scratch[0]);
+    return true;
+}
+
+bool XmlSaxStream::parseText()
+{
+    const char* begin = _p;
+    const char* end = (const char*)memchr(begin, '<', _end - begin);
+    if (end == NULL)
+    {
+        end = _end;
+    }
+    _p = end;
 
-	SAXParser::endElement(_ccsaxParserImp, (const CC_XML_CHAR *)element.Value());
-	return true;
+    bool blank = true;
+    bool plain = true;
+    for (const char* c = begin; c < end; ++c)
+    {
+        if (!isSpace(*c))
+            blank = false;
+        if (*c == '&' || *c == '\r')
+            plain = false;
+    }
+    if (blank || _open.empty())
+    {
+        return true;
+    }
+
+    if (plain)
+    {
+        SAXParser::textHandler(_parser, (const CC_XML_CHAR*)begin, (int)(end - begin));
+        return true;
+    }
+
+    _scratch.clear();
+    if (!appendDecoded(begin, end))
+    {
+        return false;
+    }
+    _scratch.push_back('\0');
+    SAXParser::textHandler(_parser, (const CC_XML_CHAR*)&_scratch[0], (int)_scratch.size() - 1);
+    return true;
 }
 
-bool XmlSaxHander::Visit( const tinyxml2::XMLText& text )
+bool XmlSaxStream::appendDecoded(const char* begin, const char* end)
 {
-	//log("Visit %s",text.Value());
-	SAXParser::textHandler(_ccsaxParserImp, (const CC_XML_CHAR *)text.Value(), strlen(text.Value()));
-	return true;
+    static const struct { const char* name; size_t len; char value; } entities[] = {
+        { "amp;", 4, '&' }, { "lt;", 3, '<' }, { "gt;", 3, '>' }, { "quot;", 5, '"' }, { "apos;", 5, '\'' }
+    };
+
+    const char* p = begin;
+    while (p < end)
+    {
+        char c = *p;
+        if (c == '\r')
+        {
+            // normalize \r\n and lone \r to \n
+            _scratch.push_back('\n');
+            ++p;
+            if (p < end && *p == '\n')
+                ++p;
+            continue;
+        }
+        if (c != '&')
+        {
+            _scratch.push_back(c);
+            ++p;
+            continue;
+        }
+
+        ++p;
+        const char* semi = (const char*)memchr(p, ';', end - p);
+        if (semi == NULL)
+        {
+            return false;
+        }
+
+        if (*p == '#')
+        {
+            unsigned int code = 0;
+            bool hex = (p + 1 < semi && (p[1] == 'x' || p[1] == 'X'));
+            for (const char* d = p + (hex ? 2 : 1); d < semi; ++d)
+            {
+                unsigned int digit;
+                if (*d >= '0' && *d <= '9')
+                    digit = *d - '0';
+                else if (hex && *d >= 'a' && *d <= 'f')
+                    digit = *d - 'a' + 10;
+                else if (hex && *d >= 'A' && *d <= 'F')
+                    digit = *d - 'A' + 10;
+                else
+                    return false;
+                code = code * (hex ? 16 : 10) + digit;
+                if (code > 0x10FFFF)
+                    return false;
+            }
+
+            if (code < 0x80)
+            {
+                _scratch.push_back((char)code);
+            }
+            else if (code < 0x800)
+            {
+                _scratch.push_back((char)(0xC0 | (code >> 6)));
+                _scratch.push_back((char)(0x80 | (code & 0x3F)));
+            }
+            else if (code < 0x10000)
+            {
+                _scratch.push_back((char)(0xE0 | (code >> 12)));
+                _scratch.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                _scratch.push_back((char)(0x80 | (code & 0x3F)));
+            }
+            else
+            {
+                _scratch.push_back((char)(0xF0 | (code >> 18)));
+                _scratch.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+                _scratch.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                _scratch.push_back((char)(0x80 | (code & 0x3F)));
+            }
+        }
+        else
+        {
+            size_t len = semi + 1 - p;
+            size_t i = 0;
+            for (; i < sizeof(entities) / sizeof(entities[0]); ++i)
+            {
+                if (entities[i].len == len && memcmp(p, entities[i].name, len) == 0)
+                    break;
+            }
+            if (i == sizeof(entities) / sizeof(entities[0]))
+            {
+                return false;
+            }
+            _scratch.push_back(entities[i].value);
+        }
+        p = semi + 1;
+    }
+    return true;
 }
 
 SAXParser::SAXParser()
@@ -104,24 +469,26 @@ bool SAXParser::init(const char *pszEncoding)
 
 bool SAXParser::parse(const char* pXMLData, unsigned int uDataLength)
 {
-	tinyxml2::XMLDocument tinyDoc;
-	tinyDoc.Parse(pXMLData, uDataLength);
-	XmlSaxHander printer;
-	printer.setSAXParserImp(this);
-	
-	return tinyDoc.Accept( &printer );	
+    if (pXMLData == NULL || _delegator == NULL)
+    {
+        return false;
+    }
+
+    XmlSaxStream stream(this, pXMLData, uDataLength);
+    return stream.parse();
 }
 
 bool SAXParser::parse(const char *pszFile)
 {
     bool bRet = false;
-    unsigned long size = 0;
-    char* pBuffer = (char*)FileUtils::getInstance()->getFileData(pszFile, "rt", &size);
-    if (pBuffer != NULL && size > 0)
+    CC_PROFILE_ASSET(pszFile);
+    MappedFile* file = FileUtils::getInstance()->getMappedFileData(pszFile);
+    if (file != NULL && file->getSize() > 0)
     {
-        bRet = parse(pBuffer, size);
+        CC_PROFILE_ASSET_STAGE(stage, PARSE, pszFile);
+        CC_PROFILE_ASSET_BYTES(stage, file->getSize());
+        bRet = parse((const char*)file->getBytes(), file->getSize());
     }
-    CC_SAFE_DELETE_ARRAY(pBuffer);
     return bRet;
 }
 
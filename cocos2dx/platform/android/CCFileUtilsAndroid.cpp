@@ -23,6 +23,9 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "CCFileUtilsAndroid.h"
 #include "platform/CCCommon.h"
+#include "platform/CCMappedFile.h"
+#include "support/CCAssetLoadProfiler.h"
+#include "support/zip_support/ZipUtils.h"
 #include "jni/Java_org_cocos2dx_lib_Cocos2dxHelper.h"
 #include "android/asset_manager.h"
 #include "android/asset_manager_jni.h"
@@ -90,6 +93,12 @@ bool FileUtilsAndroid::isFileExist(const std::string& strFilePath)
         return false;
     }
 
+    // the files of the mounted zip files
+    if (findPackFile(strFilePath, NULL))
+    {
+        return true;
+    }
+
     bool bFound = false;
     
     // Check whether file exists in apk.
@@ -142,6 +151,40 @@ unsigned char* FileUtilsAndroid::getFileData(const char* filename, const char* p
     return doGetFileData(filename, pszMode, pSize, false);
 }
 
+MappedFile* FileUtilsAndroid::getMappedFileData(const char* filename)
+{
+    if ((! filename) || 0 == strlen(filename))
+    {
+        return NULL;
+    }
+
+    // the files of the mounted zip files are mapped by FileUtils
+    string fullPath = fullPathForFilename(filename);
+    if (fullPath[0] != '/' && s_assetmanager && ! findPackFile(fullPath, NULL))
+    {
+        // "assets/" is at the beginning of the path and we don't want it
+        const char* relativepath = fullPath.c_str() + strlen("assets/");
+
+        // the assets stored uncompressed in the APK are mapped, the others are inflated by the asset manager
+        CC_PROFILE_ASSET_STAGE(stage, READ, filename);
+        AAsset* asset = AAssetManager_open(s_assetmanager, relativepath, AASSET_MODE_BUFFER);
+        if (asset)
+        {
+            const void* buffer = AAsset_getBuffer(asset);
+            if (buffer)
+            {
+                CC_PROFILE_ASSET_BYTES(stage, AAsset_getLength(asset));
+                return MappedFile::create((const unsigned char*)buffer, AAsset_getLength(asset), true, [asset]() {
+                    AAsset_close(asset);
+                });
+            }
+            AAsset_close(asset);
+        }
+    }
+
+    return FileUtils::getMappedFileData(filename);
+}
+
 unsigned char* FileUtilsAndroid::getFileDataForAsync(const char* filename, const char* pszMode, unsigned long * pSize)
 {
     return doGetFileData(filename, pszMode, pSize, true);
@@ -157,8 +200,21 @@ unsigned char* FileUtilsAndroid::doGetFileData(const char* filename, const char*
     }
     
     string fullPath = fullPathForFilename(filename);
-    
-    if (fullPath[0] != '/')
+    CC_PROFILE_ASSET_STAGE(stage, READ, filename);
+
+    // the files of the mounted zip files
+    string entryName;
+    ZipFile* packFile = findPackFile(fullPath, &entryName);
+    if (packFile)
+    {
+        unsigned long size = 0;
+        pData = packFile->getFileData(entryName, &size);
+        if (pSize)
+        {
+            *pSize = size;
+        }
+    }
+    else if (fullPath[0] != '/')
     {
         
         string fullPath(filename);
@@ -230,6 +286,10 @@ unsigned char* FileUtilsAndroid::doGetFileData(const char* filename, const char*
         msg.append(filename).append(") failed!");
         CCLOG("%s", msg.c_str());
     }
+    else if (pSize)
+    {
+        CC_PROFILE_ASSET_BYTES(stage, *pSize);
+    }
     
     return pData;
 }
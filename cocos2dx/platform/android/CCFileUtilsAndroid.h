@@ -55,6 +55,7 @@ public:
     /* override funtions */
     bool init();
     virtual unsigned char* getFileData(const char* filename, const char* pszMode, unsigned long * pSize);
+    virtual MappedFile* getMappedFileData(const char* filename);
     virtual std::string getWritablePath();
     virtual bool isFileExist(const std::string& strFilePath);
     virtual bool isAbsolutePath(const std::string& strPath);
@@ -23,10 +23,16 @@ THE SOFTWARE.
 ****************************************************************************/
 package org.cocos2dx.lib;
 
+import java.util.HashMap;
+import java.util.Map;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+
 import android.content.Context;
 import android.database.Cursor;
 import android.database.sqlite.SQLiteDatabase;
 import android.database.sqlite.SQLiteOpenHelper;
+import android.os.Build;
 import android.util.Log;
 
 
@@ -40,6 +46,19 @@ public class Cocos2dxLocalStorage {
 	
     private static DBOpenHelper mDatabaseOpenHelper = null;
     private static SQLiteDatabase mDatabase = null;
+    
+    // write-behind: the items set (null when removed), until the writer thread writes them
+    private static boolean mWriteBehind = false;
+    private static final HashMap<String, String> mPendingItems = new HashMap<String, String>();
+    private static boolean mWriteScheduled = false;
+    private static ExecutorService mWriter = null;
+    private static final Runnable mWritePendingItems = new Runnable() {
+        @Override
+        public void run() {
+            writePendingItems();
+        }
+    };
+    
     /**
      * Constructor
      * @param context The Context within which to work, used to create the DB
@@ -51,18 +70,32 @@ public class Cocos2dxLocalStorage {
     		TABLE_NAME = tableName;
     		mDatabaseOpenHelper = new DBOpenHelper(Cocos2dxActivity.getContext());
     		mDatabase = mDatabaseOpenHelper.getWritableDatabase();
+    		// with a write-ahead log, a commit appends to the log and doesn't wait for the disk
+    		if (Build.VERSION.SDK_INT >= 11) {
+    			mDatabase.enableWriteAheadLogging();
+    		}
     		return true;
     	}
         return false;
     }
     
     public static void destory() {
+    	if (mWriter != null) {
+    		flush();
+    		mWriter.shutdown();
+    		mWriter = null;
+    	}
+    	mWriteBehind = false;
     	if (mDatabase != null) {
     		mDatabase.close();
     	}
     }
     
     public static void setItem(String key, String value) {
+    	if (mWriteBehind) {
+    		queueItem(key, value);
+    		return;
+    	}
     	try {
     		String sql = "replace into "+TABLE_NAME+"(key,value)values(?,?)";
     		mDatabase.execSQL(sql, new Object[] { key, value });
@@ -72,6 +105,14 @@ public class Cocos2dxLocalStorage {
     }
     
     public static String getItem(String key) {
+    	if (mWriteBehind) {
+    		synchronized (mPendingItems) {
+    			if (mPendingItems.containsKey(key)) {
+    				String value = mPendingItems.get(key);
+    				return value == null ? "" : value;
+    			}
+    		}
+    	}
     	String ret = null;
     	try {
     	String sql = "select value from "+TABLE_NAME+" where key=?";
@@ -93,6 +134,10 @@ public class Cocos2dxLocalStorage {
     }
     
     public static void removeItem(String key) {
+    	if (mWriteBehind) {
+    		queueItem(key, null);
+    		return;
+    	}
     	try {
     		String sql = "delete from "+TABLE_NAME+" where key=?";
     		mDatabase.execSQL(sql, new Object[] {key});
@@ -101,6 +146,104 @@ public class Cocos2dxLocalStorage {
     	}
     }
     
+    /**
+     * The items set or removed until commit() are written in one transaction.
+     * Ignored in write-behind mode, where the items are already written in batches.
+     */
+    public static void beginTransaction() {
+    	if (!mWriteBehind) {
+    		mDatabase.beginTransaction();
+    	}
+    }
+    
+    public static void commit() {
+    	if (!mWriteBehind && mDatabase.inTransaction()) {
+    		mDatabase.setTransactionSuccessful();
+    		mDatabase.endTransaction();
+    	}
+    }
+    
+    /**
+     * When enabled, the items are written by a background thread, in batches.
+     */
+    public static void setWriteBehind(boolean enabled) {
+    	if (enabled == mWriteBehind) {
+    		return;
+    	}
+    	if (enabled) {
+    		// the open transaction would block the writer thread
+    		while (mDatabase.inTransaction()) {
+    			commit();
+    		}
+    		if (mWriter == null) {
+    			mWriter = Executors.newSingleThreadExecutor();
+    		}
+    	} else {
+    		flush();
+    	}
+    	mWriteBehind = enabled;
+    }
+    
+    /**
+     * Waits until the items set or removed in write-behind mode are written.
+     */
+    public static void flush() {
+    	if (mWriter != null) {
+    		try {
+    			mWriter.submit(mWritePendingItems).get();
+    		} catch (Exception e) {
+    			e.printStackTrace();
+    		}
+    	}
+    }
+    
+    private static void queueItem(String key, String value) {
+    	synchronized (mPendingItems) {
+    		mPendingItems.put(key, value);
+    		if (!mWriteScheduled) {
+    			mWriteScheduled = true;
+    			mWriter.execute(mWritePendingItems);
+    		}
+    	}
+    }
+    
+    private static void writePendingItems() {
+    	HashMap<String, String> items;
+    	synchronized (mPendingItems) {
+    		mWriteScheduled = false;
+    		if (mPendingItems.isEmpty()) {
+    			return;
+    		}
+    		// the items stay visible to getItem() until they are written
+    		items = new HashMap<String, String>(mPendingItems);
+    	}
+    	
+    	mDatabase.beginTransaction();
+    	try {
+    		for (Map.Entry<String, String> item : items.entrySet()) {
+    			if (item.getValue() != null) {
+    				mDatabase.execSQL("replace into "+TABLE_NAME+"(key,value)values(?,?)", new Object[] { item.getKey(), item.getValue() });
+    			} else {
+    				mDatabase.execSQL("delete from "+TABLE_NAME+" where key=?", new Object[] { item.getKey() });
+    			}
+    		}
+    		mDatabase.setTransactionSuccessful();
+    	} catch (Exception e) {
+    		e.printStackTrace();
+    	} finally {
+    		mDatabase.endTransaction();
+    	}
+    	
+    	synchronized (mPendingItems) {
+    		// the items set again meanwhile are written by the next batch
+    		for (Map.Entry<String, String> item : items.entrySet()) {
+    			if (mPendingItems.containsKey(item.getKey()) && mPendingItems.get(item.getKey()) == item.getValue()) {
+    				mPendingItems.remove(item.getKey());
+    			}
+    		}
+    	}
+    }
+    
 
     /**
      * This creates/opens the database.
@@ -4,9 +4,28 @@
 #include "CCApplication.h"
 #include "cocoa/CCString.h"
 #include <unistd.h>
+#include <memory>
 
 using namespace std;
 
+// Following methods are implemented in TextureCacheEmscripten.js:
+extern "C" {
+void cocos2dx_setAssetSource(const char *baseURL, const char *version);
+void cocos2dx_fetchAsset(const char *path, void *userData);
+};
+
+extern "C" {
+// Called by TextureCacheEmscripten.js when a file requested by fetchFileAsync() is available, or failed.
+void FileUtilsEmscripten_fetchCallback(void *userData, int ok);
+};
+
+void FileUtilsEmscripten_fetchCallback(void *userData, int ok)
+{
+    std::function<void(bool)>* callback = static_cast<std::function<void(bool)>*>(userData);
+    (*callback)(ok != 0);
+    delete callback;
+}
+
 NS_CC_BEGIN
 
 FileUtils* FileUtils::getInstance()
@@ -25,7 +44,13 @@ FileUtils* FileUtils::getInstance()
 }
 
 FileUtilsEmscripten::FileUtilsEmscripten()
-{}
+{
+    // Add a dummy reference so that the compiler emits the callback used by the JavaScript code.
+    int deps[] = {
+        (int)&FileUtilsEmscripten_fetchCallback
+    };
+    CC_UNUSED_PARAM(deps);
+}
 
 bool FileUtilsEmscripten::init()
 {
@@ -58,6 +83,12 @@ bool FileUtilsEmscripten::isAbsolutePath(const std::string& strPath)
 
 bool FileUtilsEmscripten::isFileExist(const std::string& strFilePath)
 {
+    // the files of the mounted zip files
+    if (findPackFile(strFilePath, NULL))
+    {
+        return true;
+    }
+
     std::string strPath = strFilePath;
     if (strPath[0] != '/')
     { // Not absolute path, add the default root path at the beginning.
@@ -70,4 +101,55 @@ bool FileUtilsEmscripten::isFileExist(const std::string& strFilePath)
     return access(strPath.c_str(), F_OK) != -1 ? true : false;
 }
 
+void FileUtilsEmscripten::setRemoteAssetSource(const std::string& baseURL, const std::string& version)
+{
+    std::string url = baseURL;
+    if (!url.empty() && url[url.length() - 1] != '/')
+    {
+        url += '/';
+    }
+    cocos2dx_setAssetSource(url.c_str(), version.c_str());
+}
+
+void FileUtilsEmscripten::fetchFileAsync(const std::string& filename, const std::function<void(bool)>& callback)
+{
+    std::string path = fullPathForFilename(filename.c_str());
+    if (isFileExist(path))
+    {
+        callback(true);
+        return;
+    }
+
+    if (path[0] != '/')
+    {
+        path.insert(0, _defaultResRootPath);
+    }
+    cocos2dx_fetchAsset(path.c_str(), new std::function<void(bool)>(callback));
+}
+
+void FileUtilsEmscripten::fetchFilesAsync(const std::vector<std::string>& filenames, const std::function<void(int)>& callback)
+{
+    if (filenames.empty())
+    {
+        callback(0);
+        return;
+    }
+
+    // counts the files still being fetched, and the ones that failed
+    std::shared_ptr<std::pair<int, int> > state = std::make_shared<std::pair<int, int> >((int)filenames.size(), 0);
+    for (auto it = filenames.begin(); it != filenames.end(); ++it)
+    {
+        fetchFileAsync(*it, [state, callback](bool ok) {
+            if (!ok)
+            {
+                ++state->second;
+            }
+            if (--state->first == 0)
+            {
+                callback(state->second);
+            }
+        });
+    }
+}
+
 NS_CC_END
@@ -30,6 +30,7 @@
 #include "ccTypeInfo.h"
 #include <string>
 #include <vector>
+#include <functional>
 
 NS_CC_BEGIN
 
@@ -49,6 +50,25 @@ public:
     virtual std::string getWritablePath();
     virtual bool isFileExist(const std::string& strFilePath);
     virtual bool isAbsolutePath(const std::string& strPath);
+
+    /** Sets the URL the files missing from the preloaded data package are fetched from,
+     and the version of the assets. The fetched files are kept in IndexedDB, the ones
+     cached for another version are fetched again.
+     @since v3.0
+     */
+    void setRemoteAssetSource(const std::string& baseURL, const std::string& version);
+
+    /** Makes a file readable by the synchronous file functions, reading it from the
+     IndexedDB cache or downloading it from the remote asset source when it is not
+     in the virtual file system yet. The callback is told whether it succeeded.
+     @since v3.0
+     */
+    void fetchFileAsync(const std::string& filename, const std::function<void(bool)>& callback);
+
+    /** Fetches several files, see fetchFileAsync(). The callback gets the number of files that failed.
+     @since v3.0
+     */
+    void fetchFilesAsync(const std::vector<std::string>& filenames, const std::function<void(int)>& callback);
 };
 
 // end of platform group
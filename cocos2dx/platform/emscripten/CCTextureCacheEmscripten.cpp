@@ -125,6 +125,17 @@ void TextureCacheEmscripten::addImageAsyncCallBack_emscripten(AsyncStruct *data,
 {
     const char *filename = data->filename.c_str();
 
+    if (imgData == NULL)
+    {
+        // the file could not be fetched or decoded, the request ends without a texture
+        if (data->target)
+        {
+            data->target->release();
+        }
+        delete data;
+        return;
+    }
+
     Image *pImage = new Image();
     pImage->initWithRawData((unsigned char*) imgData, 4 * width * height, width, height, 8, true);
 
@@ -139,7 +150,7 @@ void TextureCacheEmscripten::addImageAsyncCallBack_emscripten(AsyncStruct *data,
 #endif
 
     // cache the texture
-    _textures->setObject(texture, filename);
+    cacheTexture(texture, filename);
     texture->autorelease();
 
     Object *target = data->target;
@@ -163,11 +174,12 @@ void TextureCacheEmscripten::addImageAsync(const char *path, Object *target, SEL
 
     // optimization
     std::string pathKey = FileUtils::getInstance()->fullPathForFilename(path);
-    texture = (Texture2D*)_textures->objectForKey(pathKey.c_str());
+    texture = static_cast<Texture2D*>(_textures.objectForKey(pathKey));
 
     std::string fullpath = pathKey;
     if (texture != NULL)
     {
+        touchTexture(texture);
         if (target && selector)
         {
             (target->*selector)(texture);
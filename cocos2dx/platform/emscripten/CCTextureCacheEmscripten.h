@@ -36,6 +36,8 @@ public:
     virtual ~TextureCacheEmscripten();
 
     void addImageAsync(const char *path, Object *target, SEL_CallFuncO selector);
+    /** the images are loaded by the browser: the priority is ignored */
+    void addImageAsync(const char *path, Object *target, SEL_CallFuncO selector, int priority) { addImageAsync(path, target, selector); }
 
     /* Public method since we need to call it from C code to workaround linkage from JS.
     */
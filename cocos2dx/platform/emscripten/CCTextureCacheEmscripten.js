@@ -37,10 +37,217 @@ THE SOFTWARE.
 
 
 var LibraryCocosHelper = {
-    $cocos2dx__deps: [ '_CCTextureCacheEmscripten_preMultiplyImageRegion' ],
+    $cocos2dx__deps: [ '_CCTextureCacheEmscripten_preMultiplyImageRegion', '_FileUtilsEmscripten_fetchCallback' ],
     $cocos2dx: {
         objects: {},
+
+        /**
+         * Return the AssetStore singleton, creating it on first use.
+         */
+        getAssetStore: function()
+        {
+            if(!cocos2dx.objects.assetStore)
+            {
+                cocos2dx.objects.assetStore = new cocos2dx.classes.AssetStore();
+            }
+            return cocos2dx.objects.assetStore;
+        },
+
         classes: {
+            // AssetStore -- fetches the files that are not in the preloaded
+            // data package on demand, and keeps them in IndexedDB so that the
+            // next session reads them locally. Fetched files are also written
+            // into the virtual file system, so the synchronous FileUtils
+            // functions can read them afterwards.
+            AssetStore: function()
+            {
+                this.baseURL = '';
+                this.version = '';
+                this.db = null;
+                this.waiting = [];
+
+                var that = this;
+
+                /**
+                 * Call @fn once the database is opened, or failed to open. In the
+                 * latter case (private browsing, quota...) files are only
+                 * downloaded.
+                 */
+                this.whenReady = function(fn)
+                {
+                    if(this.waiting === null)
+                    {
+                        fn();
+                    }
+                    else
+                    {
+                        this.waiting.push(fn);
+                    }
+                };
+
+                this._opened = function(db)
+                {
+                    that.db = db;
+                    var waiting = that.waiting;
+                    that.waiting = null;
+                    for(var i = 0; i < waiting.length; i++)
+                    {
+                        waiting[i]();
+                    }
+                };
+
+                var indexedDB = window.indexedDB || window.mozIndexedDB || window.webkitIndexedDB;
+                try
+                {
+                    var request = indexedDB.open('cocos2dx-assets', 1);
+                    request.onupgradeneeded = function()
+                    {
+                        request.result.createObjectStore('files');
+                    };
+                    request.onsuccess = function() { that._opened(request.result); };
+                    request.onerror = function() { that._opened(null); };
+                }
+                catch(e)
+                {
+                    this._opened(null);
+                }
+
+                this._key = function(path)
+                {
+                    return this.version + ':' + path;
+                };
+
+                /**
+                 * Write @data into the virtual file system at @path, creating
+                 * its directories.
+                 */
+                this._writeToFS = function(path, data)
+                {
+                    var slash = path.lastIndexOf('/');
+                    var dir = slash > 0 ? path.substring(0, slash) : '/';
+                    var name = path.substring(slash + 1);
+                    if(FS.analyzePath(path).exists)
+                    {
+                        return;
+                    }
+                    FS.createPath('/', dir, true, true);
+                    FS.createDataFile(dir, name, data, true, true);
+                };
+
+                /**
+                 * Return the contents of @path if it is already in the virtual
+                 * file system (preloaded or fetched before), null otherwise.
+                 */
+                this.readLocal = function(path)
+                {
+                    var found = FS.analyzePath(path);
+                    if(found.exists && found.object && found.object.contents)
+                    {
+                        return new Uint8Array(found.object.contents);
+                    }
+                    return null;
+                };
+
+                this._download = function(path, onload, onerror)
+                {
+                    var xhr = new XMLHttpRequest();
+                    xhr.open('GET', this.baseURL + path.replace(/^\//, ''), true);
+                    xhr.responseType = 'arraybuffer';
+                    xhr.onload = function()
+                    {
+                        if((xhr.status == 200 || xhr.status == 0) && xhr.response)
+                        {
+                            if(that.db)
+                            {
+                                try
+                                {
+                                    that.db.transaction(['files'], 'readwrite').objectStore('files').put(xhr.response, that._key(path));
+                                }
+                                catch(e)
+                                {
+                                    // the cache is best effort
+                                }
+                            }
+                            onload(new Uint8Array(xhr.response));
+                        }
+                        else
+                        {
+                            onerror();
+                        }
+                    };
+                    xhr.onerror = onerror;
+                    xhr.send(null);
+                };
+
+                /**
+                 * Get the contents of @path: from the virtual file system, then
+                 * IndexedDB, then the network. @onload receives a Uint8Array.
+                 */
+                this.load = function(path, onload, onerror)
+                {
+                    // the data package is mounted at the root
+                    if(path.charAt(0) != '/')
+                    {
+                        path = '/' + path;
+                    }
+
+                    var local = this.readLocal(path);
+                    if(local)
+                    {
+                        onload(local);
+                        return;
+                    }
+
+                    var loaded = function(data)
+                    {
+                        try
+                        {
+                            that._writeToFS(path, data);
+                        }
+                        catch(e)
+                        {
+                            console.log("Can't write '" + path + "' to the file system");
+                        }
+                        onload(data);
+                    };
+
+                    this.whenReady(function()
+                    {
+                        if(!that.db)
+                        {
+                            that._download(path, loaded, onerror);
+                            return;
+                        }
+
+                        var get;
+                        try
+                        {
+                            get = that.db.transaction(['files'], 'readonly').objectStore('files').get(that._key(path));
+                        }
+                        catch(e)
+                        {
+                            that._download(path, loaded, onerror);
+                            return;
+                        }
+                        get.onsuccess = function()
+                        {
+                            if(get.result)
+                            {
+                                loaded(new Uint8Array(get.result));
+                            }
+                            else
+                            {
+                                that._download(path, loaded, onerror);
+                            }
+                        };
+                        get.onerror = function()
+                        {
+                            that._download(path, loaded, onerror);
+                        };
+                    });
+                };
+            },
+
             // AsyncOperationQueue -- simple worker queue. Note that all functions
             // passed in should effectively be "static", and have all requisite
             // information contained in their args object.
@@ -194,9 +401,12 @@ var LibraryCocosHelper = {
                 {
                     var img = new Image();
                     var that = this;
+                    var url = null;
 
                     img.onload = function()
                     {
+                        URL.revokeObjectURL(url);
+
                         var w = img.width;
                         var h = img.height;
 
@@ -239,12 +449,25 @@ var LibraryCocosHelper = {
                         that.operationQueue.enqueue(fireCallback, opArgs);
                     };
 
-                    img.onerror = function()
+                    var failed = function()
                     {
                         console.log("Error loading '" + path + "'");
+                        // completes the request in cocos2dx, without a texture
+                        _CCTextureCacheEmscripten_addImageAsyncCallBack(that.cxxTextureCache, asyncData, 0, 0, 0);
+                    };
+
+                    img.onerror = function()
+                    {
+                        URL.revokeObjectURL(url);
+                        failed();
                     };
 
-                    img.src = path;
+                    // the browser decodes the bytes, which come from the asset store
+                    cocos2dx.getAssetStore().load(path, function(data)
+                    {
+                        url = URL.createObjectURL(new Blob([data]));
+                        img.src = url;
+                    }, failed);
                 };
 
                 /**
@@ -267,9 +490,36 @@ var LibraryCocosHelper = {
      */
     cocos2dx_newAsyncImageLoader: function(cxxTextureCache, deps__ignored)
     {
+        cocos2dx.getAssetStore();
         cocos2dx.objects.asyncImageLoader = new cocos2dx.classes.AsyncImageLoader(cxxTextureCache);
     },
 
+    /**
+     * Set the URL the missing files are fetched from, and the version of
+     * the assets. Files cached by another version are not used.
+     */
+    cocos2dx_setAssetSource: function(baseURL, version)
+    {
+        var store = cocos2dx.getAssetStore();
+        store.baseURL = Pointer_stringify(baseURL);
+        store.version = Pointer_stringify(version);
+    },
+
+    /**
+     * Make the file at @path available in the virtual file system, then
+     * call FileUtilsEmscripten_fetchCallback with @userData.
+     */
+    cocos2dx_fetchAsset: function(path, userData)
+    {
+        cocos2dx.getAssetStore().load(Pointer_stringify(path), function()
+        {
+            _FileUtilsEmscripten_fetchCallback(userData, 1);
+        }, function()
+        {
+            _FileUtilsEmscripten_fetchCallback(userData, 0);
+        });
+    },
+
     /**
      * Shutdown the current image loader object. Used by the cocos2dx
      * destructor method.
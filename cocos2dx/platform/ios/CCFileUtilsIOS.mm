@@ -243,6 +243,12 @@ bool FileUtilsIOS::isFileExist(const std::string& strFilePath)
         return false;
     }
 
+    // the files of the mounted zip files
+    if (findPackFile(strFilePath, NULL))
+    {
+        return true;
+    }
+
     bool bRet = false;
     
     if (strFilePath[0] != '/')
@@ -6,7 +6,8 @@
  */
 #include "CCApplication.h"
 #include <unistd.h>
-#include <sys/time.h>
+#include <time.h>
+#include <sched.h>
 #include <string>
 #include "CCDirector.h"
 #include "platform/CCFileUtils.h"
@@ -17,16 +18,17 @@ NS_CC_BEGIN
 // sharedApplication pointer
 Application * Application::sm_pSharedApplication = 0;
 
-static long getCurrentMillSecond() {
-	long lLastTime;
-	struct timeval stCurrentTime;
+// the sleeps of the kernel can end about a millisecond late, the end of the wait yields instead
+static const long long SLEEP_MARGIN = 1000000LL;
 
-	gettimeofday(&stCurrentTime,NULL);
-	lLastTime = stCurrentTime.tv_sec*1000+stCurrentTime.tv_usec*0.001; //millseconds
-	return lLastTime;
+static long long getMonotonicNanoSecond() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
 }
 
 Application::Application()
+: _animationInterval(1000000000LL / 60)
 {
 	CC_ASSERT(! sm_pSharedApplication);
 	sm_pSharedApplication = this;
@@ -36,7 +38,6 @@ Application::~Application()
 {
 	CC_ASSERT(this == sm_pSharedApplication);
 	sm_pSharedApplication = NULL;
-	_animationInterval = 1.0f/60.0f*1000.0f;
 }
 
 int Application::run()
@@ -48,22 +49,36 @@ int Application::run()
 	}
 
 
+	// the frames start at regular deadlines, whatever the time they take, rather than an interval after the last one ended
+	long long nextFrame = getMonotonicNanoSecond();
 	for (;;) {
-		long iLastTime = getCurrentMillSecond();
 		Director::getInstance()->mainLoop();
-		long iCurTime = getCurrentMillSecond();
-		if (iCurTime-iLastTime<_animationInterval){
-			usleep((_animationInterval - iCurTime+iLastTime)*1000);
+
+		long long now = getMonotonicNanoSecond();
+		nextFrame += _animationInterval;
+		if (nextFrame <= now) {
+			// late, or waiting for the vsync: the next frame starts now, without catching up with shorter frames
+			nextFrame = now;
+			continue;
 		}
 
+		if (nextFrame - now > SLEEP_MARGIN) {
+			long long wait = nextFrame - now - SLEEP_MARGIN;
+			struct timespec sleepTime;
+			sleepTime.tv_sec = wait / 1000000000LL;
+			sleepTime.tv_nsec = wait % 1000000000LL;
+			nanosleep(&sleepTime, NULL);
+		}
+		while (getMonotonicNanoSecond() < nextFrame) {
+			sched_yield();
+		}
 	}
 	return -1;
 }
 
 void Application::setAnimationInterval(double interval)
 {
-	//TODO do something else
-	_animationInterval = interval*1000.0f;
+	_animationInterval = (long long)(interval * 1000000000.0);
 }
 
 void Application::setResourceRootPath(const std::string& rootResDir)
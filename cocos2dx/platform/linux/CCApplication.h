@@ -61,7 +61,7 @@ public:
      */
     virtual Platform getTargetPlatform();
 protected:
-    long       _animationInterval;  //micro second
+    long long  _animationInterval;  //nanoseconds
     std::string _resourceRootPath;
     
 	static Application * sm_pSharedApplication;
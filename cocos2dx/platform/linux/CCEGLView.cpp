@@ -10,6 +10,7 @@
 #include "GL/glfw.h"
 #include "ccMacros.h"
 #include "CCDirector.h"
+#include "shaders/ccGLStateCache.h"
 #include "touch_dispatcher/CCTouch.h"
 #include "touch_dispatcher/CCTouchDispatcher.h"
 #include "text_input_node/CCIMEDispatcher.h"
@@ -283,10 +284,10 @@ void EGLView::setViewPortInPoints(float x , float y , float w , float h)
 
 void EGLView::setScissorInPoints(float x , float y , float w , float h)
 {
-    glScissor((GLint)(x * _scaleX * _frameZoomFactor + _viewPortRect.origin.x * _frameZoomFactor),
-              (GLint)(y * _scaleY * _frameZoomFactor + _viewPortRect.origin.y * _frameZoomFactor),
-              (GLsizei)(w * _scaleX * _frameZoomFactor),
-              (GLsizei)(h * _scaleY * _frameZoomFactor));
+    GL::scissor((GLint)(x * _scaleX * _frameZoomFactor + _viewPortRect.origin.x * _frameZoomFactor),
+                (GLint)(y * _scaleY * _frameZoomFactor + _viewPortRect.origin.y * _frameZoomFactor),
+                (GLsizei)(w * _scaleX * _frameZoomFactor),
+                (GLsizei)(h * _scaleY * _frameZoomFactor));
 }
 
 
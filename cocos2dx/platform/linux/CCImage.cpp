@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <unordered_map>
 #include <fontconfig/fontconfig.h>
 
 #include "platform/CCFileUtils.h"
@@ -17,6 +18,7 @@
 #include "CCStdC.h"
 
 #include FT_FREETYPE_H
+#include FT_SIZES_H
 
 using namespace std;
 
@@ -52,6 +54,24 @@ struct LineBreakLine {
 	}
 };
 
+// metrics of a glyph, in pixels
+struct GlyphMetrics {
+	FT_UInt glyphIndex;
+	bool loaded;
+	int width;
+	int bearingX;
+	int horizAdvance;
+};
+
+// a face at one pixel size, with the metrics and kerning of the glyphs it has measured
+struct SizedFace {
+	FT_Face face;
+	FT_Size size;
+	bool hasKerning;
+	std::unordered_map<FT_UInt, GlyphMetrics> metrics;
+	std::unordered_map<unsigned long long, int> kerning;
+};
+
 NS_CC_BEGIN
 class BitmapDC
 {
@@ -64,6 +84,15 @@ public:
 	}
 
 	~BitmapDC() {
+		// the sizes are freed with their faces
+		for (auto& it : faces) {
+			if (it.second) {
+				FT_Done_Face(it.second);
+			}
+		}
+		for (auto& it : sizedFaces) {
+			delete it.second;
+		}
 		FT_Done_FreeType(library);
 		FcFini();
 		//data will be deleted by Image
@@ -122,7 +151,39 @@ public:
     	return false;
     }
 
-	bool divideString(FT_Face face, const char* sText, int iMaxWidth, int iMaxHeight) {
+	// returns the metrics of the glyph of a character, measuring it the first time
+	const GlyphMetrics* getGlyphMetrics(SizedFace* sized, FT_UInt unicode) {
+		auto it = sized->metrics.find(unicode);
+		if (it != sized->metrics.end()) {
+			return it->second.loaded ? &it->second : NULL;
+		}
+
+		GlyphMetrics& metrics = sized->metrics[unicode];
+		metrics.glyphIndex = FT_Get_Char_Index(sized->face, unicode);
+		metrics.loaded = (FT_Load_Glyph(sized->face, metrics.glyphIndex, FT_LOAD_DEFAULT) == 0);
+		metrics.width = sized->face->glyph->metrics.width >> 6;
+		metrics.bearingX = sized->face->glyph->metrics.horiBearingX >> 6;
+		metrics.horizAdvance = sized->face->glyph->metrics.horiAdvance >> 6;
+		return metrics.loaded ? &metrics : NULL;
+	}
+
+	int getKerning(SizedFace* sized, FT_UInt left, FT_UInt right) {
+		unsigned long long key = ((unsigned long long)left << 32) | right;
+		auto it = sized->kerning.find(key);
+		if (it != sized->kerning.end()) {
+			return it->second;
+		}
+
+		FT_Vector delta;
+		int kerning = 0;
+		if (FT_Get_Kerning(sized->face, left, right, FT_KERNING_DEFAULT, &delta) == 0) {
+			kerning = delta.x >> 6;
+		}
+		sized->kerning[key] = kerning;
+		return kerning;
+	}
+
+	bool divideString(SizedFace* sized, const char* sText, int iMaxWidth, int iMaxHeight) {
 		const char* pText = sText;
 		textLines.clear();
 		iMaxLineWidth = 0;
@@ -131,12 +192,11 @@ public:
 		FT_UInt prevCharacter = 0;
 		FT_UInt glyphIndex = 0;
 		FT_UInt prevGlyphIndex = 0;
-		FT_Vector delta;
 		LineBreakLine currentLine;
 
 		int currentPaintPosition = 0;
 		int lastBreakIndex = -1;
-		bool hasKerning = FT_HAS_KERNING( face );
+		bool hasKerning = sized->hasKerning;
         while ((unicode=utf8((char**)&pText))) {
             if (unicode == '\n') {
 				currentLine.calculateWidth();
@@ -154,13 +214,14 @@ public:
             	lastBreakIndex = currentLine.glyphs.size() - 1;
             }
 
-			glyphIndex = FT_Get_Char_Index(face, unicode);
-			if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT)) {
+			const GlyphMetrics* metrics = getGlyphMetrics(sized, unicode);
+			if (! metrics) {
 				return false;
 			}
+			glyphIndex = metrics->glyphIndex;
 
 			if (isspace(unicode)) {
-				currentPaintPosition += face->glyph->metrics.horiAdvance >> 6;
+				currentPaintPosition += metrics->horizAdvance;
 				prevGlyphIndex = glyphIndex;
 				prevCharacter = unicode;
 				lastBreakIndex = currentLine.glyphs.size();
@@ -169,14 +230,13 @@ public:
 
 			LineBreakGlyph glyph;
 			glyph.glyphIndex = glyphIndex;
-			glyph.glyphWidth = face->glyph->metrics.width >> 6;
-			glyph.bearingX = face->glyph->metrics.horiBearingX >> 6;
-			glyph.horizAdvance = face->glyph->metrics.horiAdvance >> 6;
+			glyph.glyphWidth = metrics->width;
+			glyph.bearingX = metrics->bearingX;
+			glyph.horizAdvance = metrics->horizAdvance;
 			glyph.kerning = 0;
 
 			if (prevGlyphIndex != 0 && hasKerning) {
-				FT_Get_Kerning(face, prevGlyphIndex, glyphIndex, FT_KERNING_DEFAULT, &delta);
-				glyph.kerning = delta.x >> 6;
+				glyph.kerning = getKerning(sized, prevGlyphIndex, glyphIndex);
 			}
 
 			if (iMaxWidth > 0 && currentPaintPosition + glyph.bearingX + glyph.kerning + glyph.glyphWidth > iMaxWidth) {
@@ -313,34 +373,86 @@ public:
     	return family_name;
     }
 
-	bool getBitmap(const char *text, int nWidth, int nHeight, Image::TextAlign eAlignMask, const char * pFontName, float fontSize) {
-		if (libError) {
-			return false;
+	// returns the face of a font file, opening it the first time. The faces are kept until the BitmapDC is destroyed
+	FT_Face getFace(const std::string& fontFile) {
+		auto it = faces.find(fontFile);
+		if ( it != faces.end() ) {
+			return it->second;
 		}
 
-		FT_Face face;
-		std::string fontfile = getFontFile(pFontName);
-		if ( FT_New_Face(library, fontfile.c_str(), 0, &face) ) {
-			//no valid font found use default
-			if ( FT_New_Face(library, "/usr/share/fonts/truetype/freefont/FreeSerif.ttf", 0, &face) ) {
-				return false;
+		FT_Face face = NULL;
+		if ( FT_New_Face(library, fontFile.c_str(), 0, &face) == 0 ) {
+			//select utf8 charmap
+			if ( FT_Select_Charmap(face, FT_ENCODING_UNICODE) ) {
+				FT_Done_Face(face);
+				face = NULL;
 			}
+		} else {
+			face = NULL;
 		}
 
-		//select utf8 charmap
-		if ( FT_Select_Charmap(face, FT_ENCODING_UNICODE) ) {
-			FT_Done_Face(face);
-			return false;
+		// the fonts that can't be opened are cached too, as NULL
+		faces[fontFile] = face;
+		return face;
+	}
+
+	// returns the face of a font file at a pixel size, activated
+	SizedFace* getSizedFace(const std::string& fontFile, float fontSize) {
+		std::stringstream key;
+		key << fontFile << "@" << fontSize;
+
+		SizedFace* sized = NULL;
+		auto it = sizedFaces.find(key.str());
+		if ( it != sizedFaces.end() ) {
+			sized = it->second;
+		} else {
+			FT_Face face = getFace(fontFile);
+			if ( ! face ) {
+				//no valid font found use default
+				face = getFace("/usr/share/fonts/truetype/freefont/FreeSerif.ttf");
+			}
+
+			// each size of a face has its own FT_Size, activated before using the face
+			FT_Size size = NULL;
+			if ( face && FT_New_Size(face, &size) == 0 ) {
+				if ( FT_Activate_Size(size) || FT_Set_Pixel_Sizes(face, fontSize, fontSize) ) {
+					FT_Done_Size(size);
+					size = NULL;
+				}
+			}
+
+			if ( size ) {
+				sized = new SizedFace();
+				sized->face = face;
+				sized->size = size;
+				sized->hasKerning = FT_HAS_KERNING(face);
+			}
+			sizedFaces[key.str()] = sized;
 		}
 
-		if ( FT_Set_Pixel_Sizes(face, fontSize, fontSize) ) {
-			FT_Done_Face(face);
-			return false;
+		if ( sized && FT_Activate_Size(sized->size) ) {
+			return NULL;
 		}
+		return sized;
+	}
 
-		if ( divideString(face, text, nWidth, nHeight) == false ) {
-			FT_Done_Face(face);
-			return false;
+	/**
+	 * Breaks the text in lines and computes iMaxLineWidth and iMaxLineHeight, without rendering anything.
+	 * Returns the face of the font, or NULL if the text can't be laid out.
+	 */
+	SizedFace* layoutString(const char *text, int nWidth, int nHeight, const char * pFontName, float fontSize, int* txtHeight) {
+		if (libError) {
+			return NULL;
+		}
+
+		SizedFace* sized = getSizedFace(getFontFile(pFontName), fontSize);
+		if ( ! sized ) {
+			return NULL;
+		}
+		FT_Face face = sized->face;
+
+		if ( divideString(sized, text, nWidth, nHeight) == false ) {
+			return NULL;
 		}
 
 		//compute the final line width
@@ -352,8 +464,19 @@ public:
 		if ( textLines.size() > 0 ) {
 			iMaxLineHeight += (lineHeight * (textLines.size() -1));
 		}
-		int txtHeight = iMaxLineHeight;
+		*txtHeight = iMaxLineHeight;
 		iMaxLineHeight = MAX(iMaxLineHeight, nHeight);
+		return sized;
+	}
+
+	bool getBitmap(const char *text, int nWidth, int nHeight, Image::TextAlign eAlignMask, const char * pFontName, float fontSize) {
+		int txtHeight = 0;
+		SizedFace* sized = layoutString(text, nWidth, nHeight, pFontName, fontSize, &txtHeight);
+		if ( ! sized ) {
+			return false;
+		}
+		FT_Face face = sized->face;
+		int lineHeight = face->size->metrics.height>>6;
 
 		_data = new unsigned char[iMaxLineWidth * iMaxLineHeight * 4];
 		memset(_data,0, iMaxLineWidth * iMaxLineHeight*4);
@@ -403,14 +526,16 @@ public:
 			iCurYCursor += lineHeight;
 		}
 
-		//  free face
-		FT_Done_Face(face);
 		return true;
 	}
 
 public:
 	FT_Library library;
 
+	// faces by font file, and faces by font file and size
+	std::unordered_map<std::string, FT_Face> faces;
+	std::unordered_map<std::string, SizedFace*> sizedFaces;
+
 	unsigned char *_data;
 	int libError;
 	std::vector<LineBreakLine> textLines;
@@ -462,4 +587,30 @@ bool Image::initWithString(
 	return bRet;
 }
 
+bool Image::getStringSize(
+		const char * pText,
+		int nWidth,
+		int nHeight,
+		const char * pFontName,
+		int nSize,
+		int * pOutWidth,
+		int * pOutHeight)
+{
+	if (! pText) {
+		return false;
+	}
+
+	BitmapDC &dc = sharedBitmapDC();
+
+	int txtHeight = 0;
+	bool bRet = dc.layoutString(pText, nWidth, nHeight, pFontName, nSize, &txtHeight) != NULL;
+	if (bRet) {
+		*pOutWidth = dc.iMaxLineWidth;
+		*pOutHeight = dc.iMaxLineHeight;
+	}
+
+	dc.reset();
+	return bRet;
+}
+
 NS_CC_END
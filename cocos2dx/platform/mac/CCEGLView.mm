@@ -27,6 +27,7 @@
 #include "CCSet.h"
 #include "CCTouch.h"
 #include "CCTouchDispatcher.h"
+#include "shaders/ccGLStateCache.h"
 
 NS_CC_BEGIN
 
@@ -108,10 +109,10 @@ void EGLView::setScissorInPoints(float x , float y , float w , float h)
 {
     float frameZoomFactor = [[CCEAGLView sharedEGLView] frameZoomFactor];
     
-    glScissor((GLint)(x * _scaleX * frameZoomFactor + _viewPortRect.origin.x * frameZoomFactor),
-              (GLint)(y * _scaleY * frameZoomFactor + _viewPortRect.origin.y * frameZoomFactor),
-              (GLsizei)(w * _scaleX * frameZoomFactor),
-              (GLsizei)(h * _scaleY * frameZoomFactor));
+    GL::scissor((GLint)(x * _scaleX * frameZoomFactor + _viewPortRect.origin.x * frameZoomFactor),
+                (GLint)(y * _scaleY * frameZoomFactor + _viewPortRect.origin.y * frameZoomFactor),
+                (GLsizei)(w * _scaleX * frameZoomFactor),
+                (GLsizei)(h * _scaleY * frameZoomFactor));
 }
 
 void EGLView::setMultiTouchMask(bool mask)
@@ -239,6 +239,12 @@ bool FileUtilsMac::isFileExist(const std::string& strFilePath)
     {
         return false;
     }
+
+    // the files of the mounted zip files
+    if (findPackFile(strFilePath, NULL))
+    {
+        return true;
+    }
     
     bool bRet = false;
     
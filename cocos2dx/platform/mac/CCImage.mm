@@ -533,6 +533,8 @@ Image::Image()
 , _data(0)
 , _hasAlpha(false)
 , _preMulti(false)
+, _decodeDownscale(0)
+, _downscale(0)
 {
     
 }
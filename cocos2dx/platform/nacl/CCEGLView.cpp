@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include "CCGL.h"
 #include "ccMacros.h"
 #include "CCDirector.h"
+#include "shaders/ccGLStateCache.h"
 #include "CCInstance.h"
 #include "touch_dispatcher/CCTouch.h"
 #include "touch_dispatcher/CCTouchDispatcher.h"
@@ -138,10 +139,10 @@ void OpenGLContext::FlushContext()
 
 NS_CC_BEGIN
 
-EGLView::EGLView() : bIsInit(false), bIsMouseDown(false), _frameZoomFactor(1.0f), _context(NULL)
+EGLView::EGLView() : bIsInit(false), bIsMouseDown(false), _frameZoomFactor(1.0f), _context(NULL),
+    _eventQueueHead(0), _eventQueueTail(0)
 {
     CCLOG("CCEGLView::EGLView");
-    pthread_mutex_init(&_mutex, NULL);
     initGL();
 }
 
@@ -166,10 +167,10 @@ void EGLView::setViewPortInPoints(float x , float y , float w , float h)
 
 void EGLView::setScissorInPoints(float x , float y , float w , float h)
 {
-    glScissor((GLint)(x * _scaleX * _frameZoomFactor + _viewPortRect.origin.x * _frameZoomFactor),
-            (GLint)(y * _scaleY * _frameZoomFactor + _viewPortRect.origin.y * _frameZoomFactor),
-            (GLsizei)(w * _scaleX * _frameZoomFactor),
-            (GLsizei)(h * _scaleY * _frameZoomFactor));
+    GL::scissor((GLint)(x * _scaleX * _frameZoomFactor + _viewPortRect.origin.x * _frameZoomFactor),
+                (GLint)(y * _scaleY * _frameZoomFactor + _viewPortRect.origin.y * _frameZoomFactor),
+                (GLsizei)(w * _scaleX * _frameZoomFactor),
+                (GLsizei)(h * _scaleY * _frameZoomFactor));
 }
 
 
@@ -238,11 +239,10 @@ EGLView* EGLView::sharedOpenGLView()
     return EGLView::getInstance();
 }
 
-void EGLView::HandleMouseEvent(const pp::MouseInputEvent* event)
+void EGLView::HandleMouseEvent(const InputEventData& event)
 {
-    pp::Point pos = event->GetPosition();
-    float x = pos.x();
-    float y = pos.y();
+    float x = event.x;
+    float y = event.y;
     int touchID = 1;
 
     // Clamp event position to be within cocos2dx window size
@@ -259,7 +259,7 @@ void EGLView::HandleMouseEvent(const pp::MouseInputEvent* event)
     if (x > max_x)
       x = max_x;
 
-    switch (event->GetType())
+    switch (event.type)
     {
         case PP_INPUTEVENT_TYPE_MOUSEDOWN:
             handleTouchesBegin(1, &touchID, &x, &y);
@@ -288,12 +288,20 @@ void EGLView::ProcessEventQueue()
         setFrameSize(size.width(), size.height());
     }
 
-    pthread_mutex_lock(&_mutex);
-    while (_event_queue.size())
+    unsigned int head = _eventQueueHead.load(std::memory_order_relaxed);
+    unsigned int tail = _eventQueueTail.load(std::memory_order_acquire);
+    for (; head != tail; ++head)
     {
-        pp::InputEvent event = _event_queue.front();
-        _event_queue.pop();
-        PP_InputEvent_Type type = event.GetType();
+        const InputEventData& event = _eventQueue[head % kEventQueueSize];
+        PP_InputEvent_Type type = event.type;
+
+        // only the last of consecutive moves matters
+        if (type == PP_INPUTEVENT_TYPE_MOUSEMOVE && head + 1 != tail
+            && _eventQueue[(head + 1) % kEventQueueSize].type == PP_INPUTEVENT_TYPE_MOUSEMOVE)
+        {
+            continue;
+        }
+
         switch (type)
         {
             case PP_INPUTEVENT_TYPE_KEYDOWN:
@@ -314,25 +322,41 @@ void EGLView::ProcessEventQueue()
             case PP_INPUTEVENT_TYPE_MOUSEDOWN:
             case PP_INPUTEVENT_TYPE_MOUSEUP:
             case PP_INPUTEVENT_TYPE_MOUSEMOVE:
-                {
-                    const pp::MouseInputEvent* mevent =
-                        reinterpret_cast<const pp::MouseInputEvent*>(&event);
-                    HandleMouseEvent(mevent);
-                    break;
-                }
+                HandleMouseEvent(event);
+                break;
             default:
                 CCLOG("unhandled event type: %d", type);
                 break;
         }
     }
-    pthread_mutex_unlock(&_mutex);
+    // hands the slots back to the producer
+    _eventQueueHead.store(head, std::memory_order_release);
 }
 
 void EGLView::AddEvent(const pp::InputEvent& event)
 {
-    pthread_mutex_lock(&_mutex);
-    _event_queue.push(event);
-    pthread_mutex_unlock(&_mutex);
+    unsigned int tail = _eventQueueTail.load(std::memory_order_relaxed);
+    if (tail - _eventQueueHead.load(std::memory_order_acquire) >= kEventQueueSize)
+    {
+        // the cocos thread is more than a full queue behind
+        CCLOG("EGLView: input event queue full, event dropped");
+        return;
+    }
+
+    InputEventData& data = _eventQueue[tail % kEventQueueSize];
+    data.type = event.GetType();
+    data.x = 0;
+    data.y = 0;
+    pp::MouseInputEvent mouseEvent(event);
+    if (!mouseEvent.is_null())
+    {
+        pp::Point pos = mouseEvent.GetPosition();
+        data.x = pos.x();
+        data.y = pos.y();
+    }
+
+    // publishes the event to the cocos thread
+    _eventQueueTail.store(tail + 1, std::memory_order_release);
 }
 
 CocosPepperInstance* EGLView::g_instance;
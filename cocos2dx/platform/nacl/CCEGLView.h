@@ -29,8 +29,7 @@ THE SOFTWARE.
 #include "cocoa/CCGeometry.h"
 #include "platform/CCEGLViewProtocol.h"
 #include "ppapi/cpp/input_event.h"
-#include <pthread.h>
-#include <queue>
+#include <atomic>
 
 
 bool initExtensions();
@@ -64,7 +63,9 @@ public:
     virtual void setIMEKeyboardState(bool bOpen);
 
     void addEvent();
+    /** Dispatches the queued input events, on the cocos thread */
     void ProcessEventQueue();
+    /** Queues an input event, on the PPAPI main thread. It never waits for the cocos thread */
     void AddEvent(const pp::InputEvent& event);
 
     /**
@@ -77,15 +78,28 @@ public:
 
     static CocosPepperInstance* g_instance;
 private:
-    void HandleMouseEvent(const pp::MouseInputEvent* event);
+    /** the data of an input event, copied on the PPAPI main thread so that the cocos thread doesn't use PPAPI resources */
+    struct InputEventData
+    {
+        PP_InputEvent_Type type;
+        float x;
+        float y;
+    };
+
+    void HandleMouseEvent(const InputEventData& event);
     bool initGL();
     void destroyGL();
     bool bIsInit;
     bool bIsMouseDown;
     float _frameZoomFactor;
     OpenGLContext* _context;
-    std::queue<pp::InputEvent> _event_queue;
-    pthread_mutex_t _mutex;
+
+    // Single producer (PPAPI main thread), single consumer (cocos thread) ring of input events.
+    // The producer only writes _eventQueueTail and the consumer only writes _eventQueueHead.
+    static const unsigned int kEventQueueSize = 256;
+    InputEventData _eventQueue[kEventQueueSize];
+    std::atomic<unsigned int> _eventQueueHead;
+    std::atomic<unsigned int> _eventQueueTail;
 };
 
 NS_CC_END
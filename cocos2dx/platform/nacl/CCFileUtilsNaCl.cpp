@@ -58,6 +58,12 @@ bool FileUtilsNaCl::isFileExist(const std::string& strFilePath)
         return false;
     }
 
+    // the files of the mounted zip files
+    if (findPackFile(strFilePath, NULL))
+    {
+        return true;
+    }
+
     std::string strPath = strFilePath;
     if (!isAbsolutePath(strPath))
     { // Not absolute path, add the default root path at the beginning.
@@ -99,6 +99,12 @@ FileUtilsQt5::getWritablePath()
 
 bool FileUtilsQt5::isFileExist(const std::string& strFilePath)
 {
+    // the files of the mounted zip files
+    if (findPackFile(strFilePath, NULL))
+    {
+        return true;
+    }
+
     QString filePath = QString::fromStdString(strFilePath);
 
     // Try filename without any path first
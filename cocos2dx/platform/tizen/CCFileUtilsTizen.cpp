@@ -103,6 +103,12 @@ string FileUtilsTizen::getWritablePath()
 
 bool FileUtilsTizen::isFileExist(const std::string& strFilePath)
 {
+    // the files of the mounted zip files
+    if (findPackFile(strFilePath, NULL))
+    {
+        return true;
+    }
+
     std::string strPath = strFilePath;
     if (!isAbsolutePath(strPath))
     { // Not absolute path, add the default root path at the beginning.
@@ -63,7 +63,12 @@ int Application::run()
             // If it's the time to draw next frame, draw it, else sleep a while.
             if (nNow.QuadPart - nLast.QuadPart > _animationInterval.QuadPart)
             {
-                nLast.QuadPart = nNow.QuadPart;
+                // the frames start at regular deadlines, unless they are late by more than a frame
+                nLast.QuadPart += _animationInterval.QuadPart;
+                if (nNow.QuadPart - nLast.QuadPart > _animationInterval.QuadPart)
+                {
+                    nLast.QuadPart = nNow.QuadPart;
+                }
                 Director::getInstance()->mainLoop();
             }
             else
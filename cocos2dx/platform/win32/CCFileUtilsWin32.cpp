@@ -23,6 +23,8 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "CCFileUtilsWin32.h"
 #include "platform/CCCommon.h"
+#include "support/zip_support/ZipUtils.h"
+#include "support/CCAssetLoadProfiler.h"
 #include <Shlobj.h>
 
 using namespace std;
@@ -105,6 +107,12 @@ bool FileUtilsWin32::isFileExist(const std::string& strFilePath)
     {
         return false;
     }
+
+    // the files of the mounted zip files
+    if (findPackFile(strFilePath, NULL))
+    {
+        return true;
+    }
     
     std::string strPath = strFilePath;
     if (!isAbsolutePath(strPath))
@@ -135,11 +143,21 @@ unsigned char* FileUtilsWin32::getFileData(const char* filename, const char* mod
     unsigned char * pBuffer = NULL;
     CCASSERT(filename != NULL && size != NULL && mode != NULL, "Invalid parameters.");
     *size = 0;
+    CC_PROFILE_ASSET_STAGE(stage, READ, filename);
     do
     {
         // read the file from hardware
         std::string fullPath = fullPathForFilename(filename);
 
+        // the files of the mounted zip files
+        std::string entryName;
+        ZipFile* packFile = findPackFile(fullPath, &entryName);
+        if (packFile)
+        {
+            pBuffer = packFile->getFileData(entryName, size);
+            break;
+        }
+
         WCHAR wszBuf[MAX_PATH] = {0};
         MultiByteToWideChar(CP_UTF8, 0, fullPath.c_str(), -1, wszBuf, sizeof(wszBuf));
 
@@ -160,6 +178,7 @@ unsigned char* FileUtilsWin32::getFileData(const char* filename, const char* mod
             CC_SAFE_DELETE_ARRAY(pBuffer);
         }
     } while (0);
+    CC_PROFILE_ASSET_BYTES(stage, *size);
     
     if (! pBuffer)
     {
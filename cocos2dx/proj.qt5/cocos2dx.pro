@@ -13,6 +13,8 @@ LIBS += $${COCOS2DX_SYSTEM_LIBS}
 SOURCES += ../actions/CCAction.cpp \
 ../actions/CCActionCamera.cpp \
 ../actions/CCActionEase.cpp \
+../actions/CCTweenEasing.cpp \
+../actions/CCActionTemplate.cpp \
 ../actions/CCActionGrid.cpp \
 ../actions/CCActionGrid3D.cpp \
 ../actions/CCActionInstant.cpp \
@@ -27,25 +29,38 @@ SOURCES += ../actions/CCAction.cpp \
 ../base_nodes/CCNode.cpp \
 ../cocoa/CCAffineTransform.cpp \
 ../cocoa/CCAutoreleasePool.cpp \
+../cocoa/CCPoolAllocator.cpp \
 ../cocoa/CCGeometry.cpp \
 ../cocoa/CCNS.cpp \
 ../cocoa/CCObject.cpp \
 ../cocoa/CCSet.cpp \
 ../cocoa/CCArray.cpp \
 ../cocoa/CCDictionary.cpp \
+../cocoa/CCStringDictionary.cpp \
 ../cocoa/CCString.cpp \
 ../cocoa/CCDataVisitor.cpp \
 ../cocoa/CCData.cpp \
 ../draw_nodes/CCDrawingPrimitives.cpp \
 ../draw_nodes/CCDrawNode.cpp \
+../renderer/CCRenderer.cpp \
+../renderer/CCGroupCommand.cpp \
+../renderer/CCPrimitiveCommand.cpp \
+../renderer/CCBufferArena.cpp \
+../renderer/CCCustomCommand.cpp \
+../renderer/CCQuadCommand.cpp \
+../renderer/CCRenderCommand.cpp \
 ../effects/CCGrabber.cpp \
 ../effects/CCGrid.cpp \
 ../keypad_dispatcher/CCKeypadDelegate.cpp \
 ../keypad_dispatcher/CCKeypadDispatcher.cpp \
 ../keyboard_dispatcher/CCKeyboardDispatcher.cpp \
+../event_dispatcher/CCEvent.cpp \
+../event_dispatcher/CCEventListener.cpp \
+../event_dispatcher/CCEventDispatcher.cpp \
 ../label_nodes/CCLabelAtlas.cpp \
 ../label_nodes/CCLabelBMFont.cpp \
 ../label_nodes/CCLabelTTF.cpp \
+../label_nodes/CCFontAtlas.cpp \
 ../layers_scenes_transitions_nodes/CCLayer.cpp \
 ../layers_scenes_transitions_nodes/CCScene.cpp \
 ../layers_scenes_transitions_nodes/CCTransition.cpp \
@@ -60,12 +75,15 @@ SOURCES += ../actions/CCAction.cpp \
 ../particle_nodes/CCParticleExamples.cpp \
 ../particle_nodes/CCParticleSystem.cpp \
 ../particle_nodes/CCParticleSystemQuad.cpp \
+../particle_nodes/CCParticleSystemGPU.cpp \
+../particle_nodes/CCParticleSystemManager.cpp \
 ../particle_nodes/CCParticleBatchNode.cpp \
 ../platform/CCSAXParser.cpp \
 ../platform/CCThread.cpp \
 ../platform/CCImageCommonWebp.cpp \
 ../platform/CCEGLViewProtocol.cpp \
 ../platform/CCFileUtils.cpp \
+../platform/CCMappedFile.cpp \
 ../platform/qt5/CCCommon.cpp \
 ../platform/qt5/CCFileUtilsQt5.cpp \
 ../platform/qt5/CCEGLView.cpp \
@@ -79,6 +97,7 @@ SOURCES += ../actions/CCAction.cpp \
 ../sprite_nodes/CCAnimationCache.cpp \
 ../sprite_nodes/CCSprite.cpp \
 ../sprite_nodes/CCSpriteBatchNode.cpp \
+../sprite_nodes/CCInstancedSpriteBatch.cpp \
 ../sprite_nodes/CCSpriteFrame.cpp \
 ../sprite_nodes/CCSpriteFrameCache.cpp \
 ../support/ccUTF8.cpp \
@@ -89,6 +108,17 @@ SOURCES += ../actions/CCAction.cpp \
 ../support/ccUtils.cpp \
 ../support/CCVertex.cpp \
 ../support/CCNotificationCenter.cpp \
+../support/CCJobSystem.cpp \
+../support/CCSkeletonEvaluator.cpp \
+../support/CCNodeBuildQueue.cpp \
+../support/CCResourceGroupManager.cpp \
+../support/CCInputRecorder.cpp \
+../support/CCObjectPool.cpp \
+../support/CCFrameProfiler.cpp \
+../support/CCStatsOverlay.cpp \
+../support/CCAssetLoadProfiler.cpp \
+../support/CCGPUProfiler.cpp \
+../support/CCObjectTracker.cpp \
 ../support/image_support/TGAlib.cpp \
 ../support/tinyxml2/tinyxml2.cpp \
 ../support/zip_support/ZipUtils.cpp \
@@ -97,12 +127,15 @@ SOURCES += ../actions/CCAction.cpp \
 ../support/data_support/ccCArray.cpp \
 ../support/component/CCComponent.cpp \
 ../support/component/CCComponentContainer.cpp \
+../support/component/CCComponentSystem.cpp \
 ../text_input_node/CCIMEDispatcher.cpp \
 ../text_input_node/CCTextFieldTTF.cpp \
 ../textures/CCTexture2D.cpp \
 ../textures/CCTextureAtlas.cpp \
 ../textures/CCTextureCache.cpp \
+../textures/CCDynamicAtlas.cpp \
 ../textures/CCTextureETC.cpp \
+../textures/CCTextureKTX.cpp \
 ../textures/CCTexturePVR.cpp \
 ../textures/etc/etc1.cpp \
 ../tilemap_parallax_nodes/CCParallaxNode.cpp \
@@ -132,6 +165,7 @@ SOURCES += ../actions/CCAction.cpp \
 ../kazmath/src/GL/mat4stack.c \
 ../kazmath/src/GL/matrix.c \
 ../CCCamera.cpp \
+../CCCamera2D.cpp \
 ../CCConfiguration.cpp \
 ../CCDirector.cpp \
 ../CCScheduler.cpp \
@@ -0,0 +1,190 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCBufferArena.h"
+#include "shaders/ccGLStateCache.h"
+#include "ccMacros.h"
+#include <stdlib.h>
+
+NS_CC_BEGIN
+
+// offsets of the ranges, enough for any vertex attribute
+static const GLsizeiptr RANGE_ALIGNMENT = 16;
+
+BufferArena::BufferArena()
+: _frame(0)
+, _quadIndices(0)
+, _quadIndicesCapacity(0)
+{
+    for (int i = 0; i < POOL_COUNT; i++)
+    {
+        _cursor[i] = 0;
+    }
+}
+
+BufferArena::~BufferArena()
+{
+    deleteBuffers();
+}
+
+const GLvoid* BufferArena::upload(GLenum target, const void* data, GLsizeiptr size)
+{
+    CCASSERT(target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER, "Invalid target");
+
+    const int pool = target == GL_ARRAY_BUFFER ? POOL_VERTICES : POOL_INDICES;
+    std::vector<Block>& blocks = _blocks[pool][_frame];
+    const GLsizeiptr alignedSize = (size + RANGE_ALIGNMENT - 1) & ~(RANGE_ALIGNMENT - 1);
+
+    // the blocks are filled in turn: the ranges of a full block are being drawn, it isn't searched again
+    size_t& cursor = _cursor[pool];
+    while (cursor < blocks.size() && blocks[cursor].size - blocks[cursor].used < alignedSize)
+    {
+        ++cursor;
+    }
+
+    // the attribute pointers and the element buffer set by the caller belong to the default vertex array
+    GL::bindVAO(0);
+
+    if (cursor == blocks.size())
+    {
+        Block block;
+        block.size = MAX(alignedSize, (GLsizeiptr)CC_BUFFER_ARENA_BLOCK_SIZE);
+        block.used = 0;
+        glGenBuffers(1, &block.buffer);
+        GL::bindBuffer(target, block.buffer);
+        glBufferData(target, block.size, NULL, GL_STREAM_DRAW);
+        blocks.push_back(block);
+    }
+
+    Block& block = blocks[cursor];
+    const GLsizeiptr offset = block.used;
+    block.used += alignedSize;
+
+    GL::bindBuffer(target, block.buffer);
+    glBufferSubData(target, offset, size, data);
+
+    CHECK_GL_ERROR_DEBUG();
+
+    return (const GLvoid*)offset;
+}
+
+void BufferArena::bindQuadIndices(unsigned int quadCount)
+{
+    CCASSERT(quadCount <= MAX_QUADS, "Too many quads for GLushort indices");
+
+    GL::bindVAO(0);
+
+    if (quadCount > _quadIndicesCapacity || !_quadIndices)
+    {
+        // the indices don't depend on the frame: a single buffer, grown as needed
+        unsigned int capacity = MAX(_quadIndicesCapacity * 2, MAX(quadCount, 64u));
+        capacity = MIN(capacity, MAX_QUADS);
+
+        GLushort* indices = (GLushort*)malloc(capacity * 6 * sizeof(GLushort));
+        for (unsigned int i = 0; i < capacity; i++)
+        {
+            const unsigned int i6 = i * 6;
+            const unsigned int i4 = i * 4;
+            indices[i6+0] = (GLushort) i4+0;
+            indices[i6+1] = (GLushort) i4+1;
+            indices[i6+2] = (GLushort) i4+2;
+
+            indices[i6+5] = (GLushort) i4+1;
+            indices[i6+4] = (GLushort) i4+2;
+            indices[i6+3] = (GLushort) i4+3;
+        }
+
+        if (!_quadIndices)
+        {
+            glGenBuffers(1, &_quadIndices);
+        }
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndices);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, capacity * 6 * sizeof(GLushort), indices, GL_STATIC_DRAW);
+        free(indices);
+
+        _quadIndicesCapacity = capacity;
+        CHECK_GL_ERROR_DEBUG();
+    }
+    else
+    {
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _quadIndices);
+    }
+}
+
+void BufferArena::endFrame()
+{
+    _frame = (_frame + 1) % CC_BUFFER_ARENA_FRAMES;
+
+    for (int pool = 0; pool < POOL_COUNT; pool++)
+    {
+        _cursor[pool] = 0;
+
+        // the frame needed fewer buffers the last time it was drawn: the blocks it didn't touch are freed
+        std::vector<Block>& blocks = _blocks[pool][_frame];
+        while (!blocks.empty() && blocks.back().used == 0)
+        {
+            GL::deleteBuffers(1, &blocks.back().buffer);
+            blocks.pop_back();
+        }
+        for (auto& block : blocks)
+        {
+            block.used = 0;
+        }
+    }
+}
+
+void BufferArena::resetBuffers()
+{
+    for (int pool = 0; pool < POOL_COUNT; pool++)
+    {
+        for (int frame = 0; frame < CC_BUFFER_ARENA_FRAMES; frame++)
+        {
+            _blocks[pool][frame].clear();
+        }
+        _cursor[pool] = 0;
+    }
+    _quadIndices = 0;
+    _quadIndicesCapacity = 0;
+}
+
+void BufferArena::deleteBuffers()
+{
+    for (int pool = 0; pool < POOL_COUNT; pool++)
+    {
+        for (int frame = 0; frame < CC_BUFFER_ARENA_FRAMES; frame++)
+        {
+            for (auto& block : _blocks[pool][frame])
+            {
+                GL::deleteBuffers(1, &block.buffer);
+            }
+        }
+    }
+    if (_quadIndices)
+    {
+        GL::deleteBuffers(1, &_quadIndices);
+    }
+    resetBuffers();
+}
+
+NS_CC_END
@@ -0,0 +1,112 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCRENDERER_CCBUFFERARENA_H__
+#define __CCRENDERER_CCBUFFERARENA_H__
+
+#include "CCGL.h"
+#include "ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief BufferArena holds the vertex and index data written every frame by the small dynamic meshes
+ (self-rendered particle systems, motion streaks, grids, the primitives of the Renderer).
+
+ Instead of a buffer per node, the data is copied to a range of large streaming buffers shared by all
+ the nodes: a frame fills its buffers one after the other, and its buffers are written again
+ CC_BUFFER_ARENA_FRAMES frames later, once the GPU is done drawing them. The buffers a frame doesn't
+ need anymore are deleted when the frame comes back.
+
+ The Renderer owns the arena, and ends its frame.
+
+ @since v3.0
+ */
+class CC_DLL BufferArena
+{
+public:
+    /** GLushort indices can address up to 65536 vertices */
+    static const unsigned int MAX_QUADS = 65536 / 4;
+
+    BufferArena();
+    ~BufferArena();
+
+    /** Copies size bytes to a range of the buffers of the frame, and binds its buffer to target.
+     Returns the offset of the range in the buffer, to be used as the pointer of glVertexAttribPointer() or glDrawElements().
+     The range is valid until the end of the frame.
+     The VAO 0 is bound first, so the attribute pointers and the element buffer are those of the default vertex array.
+     @param target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+     */
+    const GLvoid* upload(GLenum target, const void* data, GLsizeiptr size);
+
+    /** Binds a GL_ELEMENT_ARRAY_BUFFER of GLushort indices which draws quadCount quads of 4 vertices as GL_TRIANGLES,
+     from the offset 0. The VAO 0 is bound first. At most MAX_QUADS quads.
+     */
+    void bindQuadIndices(unsigned int quadCount);
+
+    /** Ends the frame: the buffers of the oldest frame are reused by the next one */
+    void endFrame();
+
+    /** Forgets the buffers without deleting them, after the GL context was lost */
+    void resetBuffers();
+
+protected:
+    struct Block
+    {
+        GLuint buffer;
+        GLsizeiptr size;
+        GLsizeiptr used;
+    };
+
+    enum
+    {
+        POOL_VERTICES,
+        POOL_INDICES,
+        POOL_COUNT,
+    };
+
+    void deleteBuffers();
+
+    // WebGL doesn't allow a buffer to be bound to both targets, so the vertices and the indices have buffers of their own
+    std::vector<Block> _blocks[POOL_COUNT][CC_BUFFER_ARENA_FRAMES];
+    // block being filled in the frame
+    size_t _cursor[POOL_COUNT];
+    unsigned int _frame;
+
+    GLuint _quadIndices;
+    unsigned int _quadIndicesCapacity;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCRENDERER_CCBUFFERARENA_H__
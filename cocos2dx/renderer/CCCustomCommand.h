@@ -0,0 +1,75 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCRENDERER_CCCUSTOMCOMMAND_H__
+#define __CCRENDERER_CCCUSTOMCOMMAND_H__
+
+#include "renderer/CCRenderCommand.h"
+#include "kazmath/mat4.h"
+#include <functional>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief Executes a callback when the Renderer is flushed.
+
+ The model-view matrix given to init() is loaded on the KM_GL_MODELVIEW stack
+ before calling the callback, so the callback can issue regular GL code, e.g.
+ by using CC_NODE_DRAW_SETUP().
+
+ @since v3.0
+ */
+class CC_DLL CustomCommand : public RenderCommand
+{
+public:
+    CustomCommand();
+    virtual ~CustomCommand();
+
+    /** Initializes the command. It must be called each time before the command is added to the Renderer.
+     * @param mv model-view matrix used to execute the callback, usually the top of the KM_GL_MODELVIEW stack
+     */
+    void init(const kmMat4& mv);
+
+    /** loads the model-view matrix and calls func */
+    void execute();
+
+    inline const kmMat4& getModelView() const { return _mv; }
+
+    /** callback that renders the command */
+    std::function<void()> func;
+
+protected:
+    kmMat4 _mv;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCRENDERER_CCCUSTOMCOMMAND_H__
@@ -0,0 +1,71 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCRENDERER_CCGROUPCOMMAND_H__
+#define __CCRENDERER_CCGROUPCOMMAND_H__
+
+#include "renderer/CCRenderCommand.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief A list of commands that is executed as a single unit.
+
+ Use Renderer::pushGroup() / Renderer::popGroup() to record commands into a group.
+ The group is executed at the position where it was pushed, no matter how many
+ commands were added to the Renderer while the group was open.
+
+ @since v3.0
+ */
+class CC_DLL GroupCommand : public RenderCommand
+{
+public:
+    GroupCommand();
+    virtual ~GroupCommand();
+
+    /** Appends a command to the group */
+    void addCommand(RenderCommand* command);
+
+    /** Removes all the commands of the group.
+     The Renderer clears the group once it has been executed.
+     */
+    void clear();
+
+    inline std::vector<RenderCommand*>& getCommands() { return _commands; }
+
+protected:
+    std::vector<RenderCommand*> _commands;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCRENDERER_CCGROUPCOMMAND_H__
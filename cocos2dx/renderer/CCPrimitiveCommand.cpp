@@ -0,0 +1,59 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCPrimitiveCommand.h"
+#include "ccMacros.h"
+
+NS_CC_BEGIN
+
+PrimitiveCommand::PrimitiveCommand()
+: RenderCommand(Type::PRIMITIVE_COMMAND)
+, _mode(GL_TRIANGLES)
+, _shader(NULL)
+, _vertices(NULL)
+, _vertexCount(0)
+{
+    _blendType.src = CC_BLEND_SRC;
+    _blendType.dst = CC_BLEND_DST;
+    kmMat4Identity(&_mv);
+}
+
+PrimitiveCommand::~PrimitiveCommand()
+{
+}
+
+void PrimitiveCommand::init(GLenum mode, GLProgram* shader, const BlendFunc& blendType, const V2F_C4B_T2F* vertices, int vertexCount, const kmMat4& mv)
+{
+    CCASSERT(shader, "PrimitiveCommand needs a shader program");
+    CCASSERT(mode == GL_TRIANGLES || mode == GL_LINES || mode == GL_POINTS, "PrimitiveCommand can't batch strips and fans");
+
+    _mode = mode;
+    _shader = shader;
+    _blendType = blendType;
+    _vertices = vertices;
+    _vertexCount = vertexCount;
+    _mv = mv;
+}
+
+NS_CC_END
@@ -0,0 +1,85 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCRENDERER_CCPRIMITIVECOMMAND_H__
+#define __CCRENDERER_CCPRIMITIVECOMMAND_H__
+
+#include "renderer/CCRenderCommand.h"
+#include "ccTypes.h"
+#include "CCGL.h"
+#include "kazmath/mat4.h"
+
+NS_CC_BEGIN
+
+class GLProgram;
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief Draws untextured primitives (V2F_C4B_T2F vertices) with a shader and a blending function.
+
+ The vertices are added to the batch of primitives of the Renderer (see Renderer::addPrimitives()),
+ so the consecutive PrimitiveCommands, and the DrawPrimitives functions called between them, are
+ drawn with a single draw call when they have the same mode, shader and blending function.
+
+ The vertices are not copied: they must stay valid until the Renderer is flushed.
+
+ @since v3.0
+ */
+class CC_DLL PrimitiveCommand : public RenderCommand
+{
+public:
+    PrimitiveCommand();
+    virtual ~PrimitiveCommand();
+
+    /** Initializes the command. It must be called each time before the command is added to the Renderer.
+     * @param mode GL_TRIANGLES, GL_LINES or GL_POINTS
+     * @param mv model-view matrix of the vertices, usually the top of the KM_GL_MODELVIEW stack
+     */
+    void init(GLenum mode, GLProgram* shader, const BlendFunc& blendType, const V2F_C4B_T2F* vertices, int vertexCount, const kmMat4& mv);
+
+    inline GLenum getMode() const { return _mode; }
+    inline GLProgram* getShader() const { return _shader; }
+    inline const BlendFunc& getBlendType() const { return _blendType; }
+    inline const V2F_C4B_T2F* getVertices() const { return _vertices; }
+    inline int getVertexCount() const { return _vertexCount; }
+    inline const kmMat4& getModelView() const { return _mv; }
+
+protected:
+    GLenum _mode;
+    GLProgram* _shader;
+    BlendFunc _blendType;
+    const V2F_C4B_T2F* _vertices;
+    int _vertexCount;
+    kmMat4 _mv;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCRENDERER_CCPRIMITIVECOMMAND_H__
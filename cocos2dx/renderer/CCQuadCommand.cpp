@@ -0,0 +1,77 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCQuadCommand.h"
+#include "shaders/CCGLProgram.h"
+#include "shaders/ccGLStateCache.h"
+#include "ccMacros.h"
+
+NS_CC_BEGIN
+
+QuadCommand::QuadCommand()
+: RenderCommand(Type::QUAD_COMMAND)
+, _textureID(0)
+, _alphaTextureID(0)
+, _shader(NULL)
+, _quads(NULL)
+, _quadCount(0)
+{
+    _blendType.src = CC_BLEND_SRC;
+    _blendType.dst = CC_BLEND_DST;
+    kmMat4Identity(&_mv);
+}
+
+QuadCommand::~QuadCommand()
+{
+}
+
+void QuadCommand::init(GLuint textureID, GLProgram* shader, const BlendFunc& blendType, V3F_C4B_T2F_Quad* quads, int quadCount, const kmMat4& mv, GLuint alphaTextureID)
+{
+    CCASSERT(shader, "QuadCommand needs a shader program");
+
+    _textureID = textureID;
+    _alphaTextureID = alphaTextureID;
+    _shader = shader;
+    _blendType = blendType;
+    _quads = quads;
+    _quadCount = quadCount;
+    _mv = mv;
+}
+
+void QuadCommand::useMaterial() const
+{
+    _shader->use();
+    _shader->setUniformsForBuiltins();
+
+    GL::blendFunc(_blendType.src, _blendType.dst);
+    GL::bindTexture2D(_textureID);
+    if (_alphaTextureID)
+    {
+        GL::bindTexture2DN(1, _alphaTextureID);
+        // code that binds textures without the state cache expects the unit 0
+        glActiveTexture(GL_TEXTURE0);
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,100 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCRENDERER_CCQUADCOMMAND_H__
+#define __CCRENDERER_CCQUADCOMMAND_H__
+
+#include "renderer/CCRenderCommand.h"
+#include "ccTypes.h"
+#include "CCGL.h"
+#include "kazmath/mat4.h"
+
+NS_CC_BEGIN
+
+class GLProgram;
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief Draws textured quads (V3F_C4B_T2F) with a texture, a shader and a blending function.
+
+ The quads are not copied: they must stay valid until the Renderer is flushed.
+
+ @since v3.0
+ */
+class CC_DLL QuadCommand : public RenderCommand
+{
+public:
+    QuadCommand();
+    virtual ~QuadCommand();
+
+    /** Initializes the command. It must be called each time before the command is added to the Renderer.
+     * @param mv model-view matrix of the quads, usually the top of the KM_GL_MODELVIEW stack
+     * @param alphaTextureID texture bound to the texture unit 1, used by the textures without alpha channel (ETC1)
+     */
+    void init(GLuint textureID, GLProgram* shader, const BlendFunc& blendType, V3F_C4B_T2F_Quad* quads, int quadCount, const kmMat4& mv, GLuint alphaTextureID = 0);
+
+    /** uses the shader, the blending function and binds the texture of the command.
+     * The model-view matrix must be loaded before calling this method.
+     */
+    void useMaterial() const;
+
+    /** whether or not both commands use the same texture, shader and blending function,
+     * in which case they can be drawn with a single draw call
+     */
+    inline bool hasSameMaterial(const QuadCommand* other) const
+    {
+        return _textureID == other->_textureID
+            && _alphaTextureID == other->_alphaTextureID
+            && _shader == other->_shader
+            && _blendType.src == other->_blendType.src
+            && _blendType.dst == other->_blendType.dst;
+    }
+
+    inline GLuint getTextureID() const { return _textureID; }
+    inline GLuint getAlphaTextureID() const { return _alphaTextureID; }
+    inline GLProgram* getShader() const { return _shader; }
+    inline const BlendFunc& getBlendType() const { return _blendType; }
+    inline V3F_C4B_T2F_Quad* getQuads() const { return _quads; }
+    inline int getQuadCount() const { return _quadCount; }
+    inline const kmMat4& getModelView() const { return _mv; }
+
+protected:
+    GLuint _textureID;
+    GLuint _alphaTextureID;
+    GLProgram* _shader;
+    BlendFunc _blendType;
+    V3F_C4B_T2F_Quad* _quads;
+    int _quadCount;
+    kmMat4 _mv;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCRENDERER_CCQUADCOMMAND_H__
@@ -0,0 +1,1007 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCRenderer.h"
+#include "shaders/CCGLProgram.h"
+#include "shaders/ccGLStateCache.h"
+#include "shaders/CCShaderCache.h"
+#include "support/CCNotificationCenter.h"
+#include "support/CCJobSystem.h"
+#include "CCEventType.h"
+#include "ccMacros.h"
+#include "kazmath/GL/matrix.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+
+NS_CC_BEGIN
+
+// initial number of quads of the vertex buffer. It grows as needed.
+static const int DEFAULT_QUAD_CAPACITY = 64;
+// GLushort indices can address up to 65536 vertices
+static const int MAX_QUAD_CAPACITY = 65536 / 4;
+// initial number of vertices of the batch of primitives. It grows as needed.
+static const int DEFAULT_PRIMITIVE_CAPACITY = 256;
+// below this number of quads, the GL thread prepares the command list itself
+static const unsigned int PARALLEL_PREPARATION_MIN_QUADS = 256;
+// the preparation is waited for by the GL thread: it runs before the loading tasks
+static const int PREPARATION_PRIORITY = 100;
+
+static const char* s_batchBreakNames[Renderer::BATCH_BREAK_COUNT] = {
+    "texture",
+    "shader",
+    "blend",
+    "primitive state",
+    "command type",
+    "custom command",
+    "group",
+    "flush",
+    "buffer full",
+    "batching disabled",
+};
+
+// color of a draw call in DebugMode::BATCHES: the hue turns by the golden ratio, so consecutive batches differ
+static Color4B getBatchColor(unsigned int index)
+{
+    float hue = fmodf(index * 0.618034f, 1.0f) * 6.0f;
+    int sector = (int)hue;
+    float f = hue - sector;
+    float r, g, b;
+    switch (sector)
+    {
+        case 0: r = 1; g = f; b = 0; break;
+        case 1: r = 1 - f; g = 1; b = 0; break;
+        case 2: r = 0; g = 1; b = f; break;
+        case 3: r = 0; g = 1 - f; b = 1; break;
+        case 4: r = f; g = 0; b = 1; break;
+        default: r = 1; g = 0; b = 1 - f; break;
+    }
+    return Color4B((GLubyte)(r * 255), (GLubyte)(g * 255), (GLubyte)(b * 255), 255);
+}
+
+// color added by a draw call in DebugMode::OVERDRAW: red after 5 layers, yellow after 16, white after 32
+static const Color4B OVERDRAW_COLOR(48, 16, 8, 255);
+
+Renderer::Renderer()
+: _indices(NULL)
+, _quads(NULL)
+, _quadCapacity(0)
+, _primitives(NULL)
+, _primitiveCount(0)
+, _primitiveCapacity(0)
+, _primitiveMode(GL_TRIANGLES)
+, _primitiveShader(NULL)
+, _primitiveLineWidth(1.0f)
+, _buffersInitialized(false)
+, _isRendering(false)
+, _batchingEnabled(true)
+, _quadMaterial(NULL)
+, _parallelPreparation(false)
+, _debugMode(DebugMode::NONE)
+, _recordBatches(false)
+, _logBatchBreaks(false)
+, _logNextFrame(false)
+, _drawIndex(0)
+, _breakHint(-1)
+{
+    _buffersVBO[0] = _buffersVBO[1] = 0;
+    _primitiveBlendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+    memset(&_lastDraw, 0, sizeof(_lastDraw));
+    memset(_batchBreaks, 0, sizeof(_batchBreaks));
+    memset(_lastFrameBatchBreaks, 0, sizeof(_lastFrameBatchBreaks));
+
+    _renderQueue.reserve(256);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // listen the event when app go to foreground
+    NotificationCenter::getInstance()->addObserver(this,
+                                                   callfuncO_selector(Renderer::listenBackToForeground),
+                                                   EVNET_COME_TO_FOREGROUND,
+                                                   NULL);
+#endif
+}
+
+Renderer::~Renderer()
+{
+    _renderQueue.clear();
+    _groupStack.clear();
+
+    if (_buffersInitialized)
+    {
+        GL::deleteBuffers(2, _buffersVBO);
+    }
+    CC_SAFE_FREE(_indices);
+    CC_SAFE_FREE(_quads);
+    CC_SAFE_FREE(_primitives);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    NotificationCenter::getInstance()->removeObserver(this, EVNET_COME_TO_FOREGROUND);
+#endif
+}
+
+void Renderer::listenBackToForeground(Object *obj)
+{
+    CC_UNUSED_PARAM(obj);
+    // the GL objects were destroyed with the context, they will be re-created by the next flush
+    _buffersInitialized = false;
+    _bufferArena.resetBuffers();
+}
+
+void Renderer::addCommand(RenderCommand* command)
+{
+    CCASSERT(command, "Invalid render command");
+    CCASSERT(!_isRendering, "Commands can't be added while the Renderer is flushing");
+
+    if (_groupStack.empty())
+    {
+        _renderQueue.push_back(command);
+    }
+    else
+    {
+        _groupStack.back()->addCommand(command);
+    }
+}
+
+void Renderer::pushGroup(GroupCommand* group)
+{
+    addCommand(group);
+    _groupStack.push_back(group);
+}
+
+void Renderer::popGroup()
+{
+    CCASSERT(!_groupStack.empty(), "popGroup() called without pushGroup()");
+    _groupStack.pop_back();
+}
+
+void Renderer::flush()
+{
+    // the pending primitives were added before the pending commands, and before the draw call that flushes
+    drawPrimitives();
+
+    if (_isRendering)
+    {
+        return;
+    }
+    if (_renderQueue.empty())
+    {
+        setBreakHint(BatchBreak::FLUSH);
+        return;
+    }
+
+    _isRendering = true;
+
+    if (_parallelPreparation)
+    {
+        flushPrepared();
+    }
+    else
+    {
+        processQueue(_renderQueue);
+    }
+    _renderQueue.clear();
+    drawPrimitives();
+
+    // groups that are still open were executed and cleared, but they keep recording:
+    // queue them again so the commands added after this flush are not lost
+    for (auto it = _groupStack.begin(); it != _groupStack.end(); ++it)
+    {
+        if (it == _groupStack.begin())
+        {
+            _renderQueue.push_back(*it);
+        }
+        else
+        {
+            (*(it - 1))->addCommand(*it);
+        }
+    }
+
+    _isRendering = false;
+    setBreakHint(BatchBreak::FLUSH);
+}
+
+void Renderer::processQueue(std::vector<RenderCommand*>& queue)
+{
+    for (auto it = queue.begin(); it != queue.end(); ++it)
+    {
+        RenderCommand* command = *it;
+        switch (command->getType())
+        {
+            case RenderCommand::Type::QUAD_COMMAND:
+            {
+                // batch the following quad commands that share the material of this one
+                auto last = it + 1;
+                if (_batchingEnabled)
+                {
+                    QuadCommand* first = static_cast<QuadCommand*>(command);
+                    while (last != queue.end()
+                           && (*last)->getType() == RenderCommand::Type::QUAD_COMMAND
+                           && first->hasSameMaterial(static_cast<QuadCommand*>(*last)))
+                    {
+                        ++last;
+                    }
+                }
+                else
+                {
+                    setBreakHint(BatchBreak::BATCHING_DISABLED);
+                }
+                drawQuadCommands(it, last);
+                it = last - 1;
+                break;
+            }
+            case RenderCommand::Type::CUSTOM_COMMAND:
+            case RenderCommand::Type::PRIMITIVE_COMMAND:
+                executeCommand(command);
+                break;
+            case RenderCommand::Type::GROUP_COMMAND:
+            {
+                GroupCommand* group = static_cast<GroupCommand*>(command);
+                setBreakHint(BatchBreak::GROUP);
+                processQueue(group->getCommands());
+                group->clear();
+                setBreakHint(BatchBreak::GROUP);
+                break;
+            }
+            default:
+                CCASSERT(false, "Unknown render command");
+                break;
+        }
+    }
+}
+
+void Renderer::executeCommand(RenderCommand* command)
+{
+    if (command->getType() == RenderCommand::Type::CUSTOM_COMMAND)
+    {
+        if (_recordBatches)
+        {
+            DrawInfo draw = { DrawType::CUSTOM, 0, NULL, BlendFunc::DISABLE, 0, 0.0f };
+            recordDraw(draw);
+        }
+        static_cast<CustomCommand*>(command)->execute();
+    }
+    else
+    {
+        PrimitiveCommand* primitives = static_cast<PrimitiveCommand*>(command);
+        addPrimitives(primitives->getMode(), primitives->getShader(), primitives->getBlendType(), 1.0f,
+                      primitives->getVertices(), primitives->getVertexCount(), primitives->getModelView());
+    }
+}
+
+struct Renderer::PreparedList
+{
+    std::vector<RenderCommand*> commands;
+    std::vector<PreparedStep> steps;
+    /** the quad steps, by batch */
+    std::vector<unsigned int> batches;
+    /** the groups flattened in the list, cleared once it is executed */
+    std::vector<GroupCommand*> groups;
+    unsigned int quadCount;
+
+    // quads of the batches, in world space
+    V3F_C4B_T2F_Quad* quads;
+    unsigned int quadCapacity;
+
+    /** whether each batch is prepared. The GL thread waits on them */
+    std::unique_ptr<std::atomic<bool>[]> prepared;
+    unsigned int preparedCapacity;
+    /** next batch to prepare, claimed by the workers and by the GL thread */
+    std::atomic<unsigned int> nextBatch;
+    JobSystem::TaskPtr task;
+
+    PreparedList()
+    : quadCount(0)
+    , quads(NULL)
+    , quadCapacity(0)
+    , preparedCapacity(0)
+    , nextBatch(0)
+    {
+    }
+
+    ~PreparedList()
+    {
+        CC_SAFE_FREE(quads);
+    }
+
+    /** prepares the next batch not claimed yet. Returns false when they are all claimed */
+    bool prepareNextBatch()
+    {
+        unsigned int batch = nextBatch.fetch_add(1, std::memory_order_relaxed);
+        if (batch >= batches.size())
+        {
+            return false;
+        }
+
+        const PreparedStep& step = steps[batches[batch]];
+        V3F_C4B_T2F_Quad* out = quads + step.quadOffset;
+        for (unsigned int i = step.first; i < step.last; ++i)
+        {
+            const QuadCommand* command = static_cast<const QuadCommand*>(commands[i]);
+            int count = command->getQuadCount();
+            if (count <= 0)
+            {
+                continue;
+            }
+
+            memcpy(out, command->getQuads(), sizeof(V3F_C4B_T2F_Quad) * count);
+            kmVec3TransformArray((kmVec3*)&out->tl.vertices, sizeof(V3F_C4B_T2F),
+                                 (kmVec3*)&out->tl.vertices, sizeof(V3F_C4B_T2F),
+                                 &command->getModelView(), count * 4);
+            out += count;
+        }
+
+        prepared[batch].store(true, std::memory_order_release);
+        return true;
+    }
+};
+
+void Renderer::flattenQueue(std::vector<RenderCommand*>& queue, PreparedList& list, int breakHint)
+{
+    for (auto it = queue.begin(); it != queue.end(); ++it)
+    {
+        RenderCommand* command = *it;
+        PreparedStep step = { command->getType(), (unsigned int)list.commands.size(), 0, 0, 0, 0, breakHint };
+
+        switch (command->getType())
+        {
+            case RenderCommand::Type::QUAD_COMMAND:
+            {
+                // the same batches as processQueue()
+                auto last = it + 1;
+                if (_batchingEnabled)
+                {
+                    QuadCommand* first = static_cast<QuadCommand*>(command);
+                    while (last != queue.end()
+                           && (*last)->getType() == RenderCommand::Type::QUAD_COMMAND
+                           && first->hasSameMaterial(static_cast<QuadCommand*>(*last)))
+                    {
+                        ++last;
+                    }
+                }
+                else if (step.breakHint < 0)
+                {
+                    step.breakHint = (int)BatchBreak::BATCHING_DISABLED;
+                }
+
+                unsigned int quadCount = 0;
+                for (auto quads = it; quads != last; ++quads)
+                {
+                    quadCount += MAX(static_cast<QuadCommand*>(*quads)->getQuadCount(), 0);
+                }
+                list.commands.insert(list.commands.end(), it, last);
+                it = last - 1;
+
+                if (quadCount == 0)
+                {
+                    continue;
+                }
+                step.last = (unsigned int)list.commands.size();
+                step.quadOffset = list.quadCount;
+                step.quadCount = quadCount;
+                step.batch = (unsigned int)list.batches.size();
+                list.quadCount += quadCount;
+                list.batches.push_back((unsigned int)list.steps.size());
+                break;
+            }
+            case RenderCommand::Type::GROUP_COMMAND:
+            {
+                GroupCommand* group = static_cast<GroupCommand*>(command);
+                flattenQueue(group->getCommands(), list, (int)BatchBreak::GROUP);
+                list.groups.push_back(group);
+                breakHint = (int)BatchBreak::GROUP;
+                continue;
+            }
+            default:
+                list.commands.push_back(command);
+                step.last = step.first + 1;
+                break;
+        }
+
+        list.steps.push_back(step);
+        breakHint = -1;
+    }
+}
+
+void Renderer::flushPrepared()
+{
+    // a list whose task is done isn't referenced by the workers anymore
+    std::shared_ptr<PreparedList> list;
+    for (auto& prepared : _preparedLists)
+    {
+        if (!prepared->task || prepared->task->isDone())
+        {
+            list = prepared;
+            break;
+        }
+    }
+    if (!list)
+    {
+        list = std::make_shared<PreparedList>();
+        _preparedLists.push_back(list);
+    }
+
+    list->commands.clear();
+    list->steps.clear();
+    list->batches.clear();
+    list->groups.clear();
+    list->quadCount = 0;
+    list->task.reset();
+    flattenQueue(_renderQueue, *list, -1);
+
+    if (list->quadCount > list->quadCapacity)
+    {
+        V3F_C4B_T2F_Quad* quads = (V3F_C4B_T2F_Quad*)realloc(list->quads, list->quadCount * sizeof(V3F_C4B_T2F_Quad));
+        if (!quads)
+        {
+            CCLOG("cocos2d: Renderer: not enough memory to prepare %u quads", list->quadCount);
+            processQueue(_renderQueue);
+            return;
+        }
+        list->quads = quads;
+        list->quadCapacity = list->quadCount;
+    }
+    if (list->batches.size() > list->preparedCapacity)
+    {
+        list->preparedCapacity = (unsigned int)list->batches.size();
+        list->prepared.reset(new std::atomic<bool>[list->preparedCapacity]);
+    }
+    for (unsigned int i = 0; i < list->batches.size(); ++i)
+    {
+        list->prepared[i].store(false, std::memory_order_relaxed);
+    }
+    list->nextBatch.store(0, std::memory_order_relaxed);
+
+    JobSystem* jobSystem = JobSystem::getInstance();
+    if (list->quadCount >= PARALLEL_PREPARATION_MIN_QUADS && jobSystem->getWorkerCount() > 0)
+    {
+        // the task keeps the list alive, even if it runs after the flush
+        std::shared_ptr<PreparedList> shared = list;
+        list->task = jobSystem->addTask([shared] {
+            while (shared->prepareNextBatch())
+            {
+            }
+        }, nullptr, PREPARATION_PRIORITY);
+    }
+
+    for (const auto& step : list->steps)
+    {
+        if (step.breakHint >= 0)
+        {
+            setBreakHint((BatchBreak)step.breakHint);
+        }
+
+        if (step.type == RenderCommand::Type::QUAD_COMMAND)
+        {
+            // the sync point: the GL thread prepares the next batches itself rather than waiting for busy workers
+            while (!list->prepared[step.batch].load(std::memory_order_acquire))
+            {
+                if (!list->prepareNextBatch())
+                {
+                    std::this_thread::yield();
+                }
+            }
+            drawPreparedBatch(*list, step);
+        }
+        else
+        {
+            executeCommand(list->commands[step.first]);
+        }
+    }
+
+    for (auto group : list->groups)
+    {
+        group->clear();
+    }
+
+    // every batch is prepared: a task that didn't start has nothing left to do
+    if (list->task && !list->task->isDone())
+    {
+        jobSystem->cancelTask(list->task);
+    }
+}
+
+void Renderer::drawPreparedBatch(PreparedList& list, const PreparedStep& step)
+{
+    // the quads are in world space: they are drawn with an identity model-view matrix
+    kmGLPushMatrix();
+    kmGLLoadIdentity();
+
+    _quadMaterial = static_cast<QuadCommand*>(list.commands[step.first]);
+    _quadMaterial->useMaterial();
+
+    if (!ensureQuadCapacity(MIN((int)step.quadCount, MAX_QUAD_CAPACITY)))
+    {
+        kmGLPopMatrix();
+        return;
+    }
+
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+
+    V3F_C4B_T2F_Quad* quads = list.quads + step.quadOffset;
+    int quadCount = step.quadCount;
+    while (quadCount > 0)
+    {
+        int count = MIN(quadCount, _quadCapacity);
+        drawQuads(quads, count);
+        quads += count;
+        quadCount -= count;
+        if (quadCount > 0)
+        {
+            setBreakHint(BatchBreak::BUFFER_FULL);
+        }
+    }
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+
+    kmGLPopMatrix();
+}
+
+void Renderer::setupBuffers()
+{
+    glGenBuffers(2, &_buffersVBO[0]);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(V3F_C4B_T2F_Quad) * _quadCapacity, NULL, GL_DYNAMIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _quadCapacity * 6, _indices, GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    _buffersInitialized = true;
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+bool Renderer::ensureQuadCapacity(int quadCount)
+{
+    if (quadCount > _quadCapacity)
+    {
+        int capacity = MAX(_quadCapacity, DEFAULT_QUAD_CAPACITY);
+        while (capacity < quadCount)
+        {
+            capacity *= 2;
+        }
+        capacity = MIN(capacity, MAX_QUAD_CAPACITY);
+
+        GLushort* indices = (GLushort*)realloc(_indices, capacity * 6 * sizeof(GLushort));
+        V3F_C4B_T2F_Quad* quads = (V3F_C4B_T2F_Quad*)realloc(_quads, capacity * sizeof(V3F_C4B_T2F_Quad));
+        if (indices)
+        {
+            _indices = indices;
+        }
+        if (quads)
+        {
+            _quads = quads;
+        }
+        if (!indices || !quads)
+        {
+            // keep the current capacity: big batches are split in several draw calls
+            CCLOG("cocos2d: Renderer: not enough memory to grow the buffers to %d quads", capacity);
+            if (_quadCapacity == 0)
+            {
+                return false;
+            }
+            capacity = _quadCapacity;
+        }
+
+        for (int i = _quadCapacity; i < capacity; i++)
+        {
+            _indices[i*6+0] = i*4+0;
+            _indices[i*6+1] = i*4+1;
+            _indices[i*6+2] = i*4+2;
+            _indices[i*6+3] = i*4+3;
+            _indices[i*6+4] = i*4+2;
+            _indices[i*6+5] = i*4+1;
+        }
+        if (capacity != _quadCapacity && _buffersInitialized)
+        {
+            GL::deleteBuffers(2, _buffersVBO);
+            _buffersInitialized = false;
+        }
+        _quadCapacity = capacity;
+    }
+
+    if (!_buffersInitialized)
+    {
+        setupBuffers();
+    }
+    return true;
+}
+
+void Renderer::drawQuadCommands(CommandIterator first, CommandIterator last)
+{
+    int totalCount = 0;
+    for (auto it = first; it != last; ++it)
+    {
+        totalCount += static_cast<QuadCommand*>(*it)->getQuadCount();
+    }
+    if (totalCount <= 0)
+    {
+        return;
+    }
+
+    // the quads are transformed on the CPU: they are drawn with an identity model-view matrix
+    kmGLPushMatrix();
+    kmGLLoadIdentity();
+
+    _quadMaterial = static_cast<QuadCommand*>(*first);
+    _quadMaterial->useMaterial();
+
+    if (!ensureQuadCapacity(MIN(totalCount, MAX_QUAD_CAPACITY)))
+    {
+        kmGLPopMatrix();
+        return;
+    }
+
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+
+    int batchCount = 0;
+    for (auto it = first; it != last; ++it)
+    {
+        const QuadCommand* command = static_cast<QuadCommand*>(*it);
+        const kmMat4& mv = command->getModelView();
+        const V3F_C4B_T2F_Quad* quads = command->getQuads();
+        int quadCount = command->getQuadCount();
+
+        while (quadCount > 0)
+        {
+            if (batchCount == _quadCapacity)
+            {
+                drawQuads(_quads, batchCount);
+                batchCount = 0;
+                setBreakHint(BatchBreak::BUFFER_FULL);
+            }
+
+            int count = MIN(quadCount, _quadCapacity - batchCount);
+            V3F_C4B_T2F_Quad* out = _quads + batchCount;
+            memcpy(out, quads, sizeof(V3F_C4B_T2F_Quad) * count);
+
+            // the 4 vertices of a quad are contiguous: all the positions are transformed at once
+            kmVec3TransformArray((kmVec3*)&out->tl.vertices, sizeof(V3F_C4B_T2F),
+                                 (kmVec3*)&out->tl.vertices, sizeof(V3F_C4B_T2F),
+                                 &mv, count * 4);
+
+            batchCount += count;
+            quads += count;
+            quadCount -= count;
+        }
+    }
+    drawQuads(_quads, batchCount);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+
+    kmGLPopMatrix();
+}
+
+void Renderer::drawQuads(V3F_C4B_T2F_Quad* quads, int quadCount)
+{
+    if (quadCount <= 0)
+    {
+        return;
+    }
+
+    if (_recordBatches)
+    {
+        DrawInfo draw = { DrawType::QUADS, _quadMaterial->getTextureID(), _quadMaterial->getShader(),
+                          _quadMaterial->getBlendType(), GL_TRIANGLES, 1.0f };
+        Color4B color = recordDraw(draw);
+        if (_debugMode != DebugMode::NONE)
+        {
+            // the quads are drawn with the color of the batch and the alpha of their texture
+            for (int i = 0; i < quadCount; i++)
+            {
+                quads[i].tl.colors = quads[i].bl.colors = quads[i].tr.colors = quads[i].br.colors = color;
+            }
+            GLProgram* shader = ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR);
+            GL::useProgram(shader->getProgram());
+            shader->setUniformsForBuiltins();
+            GL::blendFunc(GL_SRC_ALPHA, _debugMode == DebugMode::OVERDRAW ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+        }
+    }
+
+#define kQuadSize sizeof(V3F_C4B_T2F)
+    // orphan the previous storage, so the driver doesn't have to wait for the previous draw
+    glBufferData(GL_ARRAY_BUFFER, sizeof(V3F_C4B_T2F_Quad) * _quadCapacity, NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(V3F_C4B_T2F_Quad) * quadCount, quads);
+
+    // vertices
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
+
+    // colors
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
+
+    // tex coords
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
+#undef kQuadSize
+
+    glDrawElements(GL_TRIANGLES, (GLsizei) quadCount*6, GL_UNSIGNED_SHORT, 0);
+
+    CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_QUADS(quadCount);
+}
+
+void Renderer::addPrimitives(GLenum mode, GLProgram* shader, const BlendFunc& blendFunc, float lineWidth,
+                             const V2F_C4B_T2F* vertices, int vertexCount, const kmMat4& mv)
+{
+    CCASSERT(shader, "Invalid shader program");
+    CCASSERT(mode == GL_TRIANGLES || mode == GL_LINES || mode == GL_POINTS, "Strips and fans can't be batched");
+
+    if (vertexCount <= 0)
+    {
+        return;
+    }
+
+    if (!_isRendering && !_renderQueue.empty())
+    {
+        flush();
+    }
+
+    if (mode != GL_LINES)
+    {
+        lineWidth = 1.0f;
+    }
+
+    if (_primitiveCount > 0
+        && (mode != _primitiveMode
+            || shader != _primitiveShader
+            || blendFunc.src != _primitiveBlendFunc.src
+            || blendFunc.dst != _primitiveBlendFunc.dst
+            || lineWidth != _primitiveLineWidth))
+    {
+        drawPrimitives();
+    }
+
+    if (_primitiveCount + vertexCount > _primitiveCapacity)
+    {
+        int capacity = MAX(_primitiveCapacity, DEFAULT_PRIMITIVE_CAPACITY);
+        while (capacity < _primitiveCount + vertexCount)
+        {
+            capacity *= 2;
+        }
+
+        V3F_C4B_T2F* primitives = (V3F_C4B_T2F*)realloc(_primitives, capacity * sizeof(V3F_C4B_T2F));
+        if (!primitives)
+        {
+            CCLOG("cocos2d: Renderer: not enough memory to grow the batch of primitives to %d vertices", capacity);
+            return;
+        }
+        _primitives = primitives;
+        _primitiveCapacity = capacity;
+    }
+
+    _primitiveMode = mode;
+    _primitiveShader = shader;
+    _primitiveBlendFunc = blendFunc;
+    _primitiveLineWidth = lineWidth;
+
+    // the z axis is ignored by the primitives: only the 2D affine part of the matrix is needed
+    const float* m = mv.mat;
+    V3F_C4B_T2F* out = _primitives + _primitiveCount;
+    for (int i = 0; i < vertexCount; i++)
+    {
+        const V2F_C4B_T2F& vertex = vertices[i];
+        const float x = vertex.vertices.x;
+        const float y = vertex.vertices.y;
+        out[i].vertices = Vertex3F(m[0] * x + m[4] * y + m[12],
+                                   m[1] * x + m[5] * y + m[13],
+                                   m[2] * x + m[6] * y + m[14]);
+        out[i].colors = vertex.colors;
+        out[i].texCoords = vertex.texCoords;
+    }
+    _primitiveCount += vertexCount;
+}
+
+void Renderer::drawPrimitives()
+{
+    if (_primitiveCount == 0)
+    {
+        return;
+    }
+
+    const int count = _primitiveCount;
+    _primitiveCount = 0;
+
+    // the primitives are in world space
+    kmGLPushMatrix();
+    kmGLLoadIdentity();
+
+    // GLProgram::use() would flush the Renderer again
+    GL::useProgram(_primitiveShader->getProgram());
+    _primitiveShader->setUniformsForBuiltins();
+    GL::blendFunc(_primitiveBlendFunc.src, _primitiveBlendFunc.dst);
+
+    if (_recordBatches)
+    {
+        DrawInfo draw = { DrawType::PRIMITIVES, 0, _primitiveShader, _primitiveBlendFunc, _primitiveMode, _primitiveLineWidth };
+        Color4B color = recordDraw(draw);
+        if (_debugMode != DebugMode::NONE)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                _primitives[i].colors = color;
+            }
+            GL::blendFunc(GL_SRC_ALPHA, _debugMode == DebugMode::OVERDRAW ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+        }
+    }
+
+    // binds the VAO 0
+    const char* offset = (const char*) _bufferArena.upload(GL_ARRAY_BUFFER, _primitives, sizeof(V3F_C4B_T2F) * count);
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), offset + offsetof(V3F_C4B_T2F, vertices));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), offset + offsetof(V3F_C4B_T2F, colors));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), offset + offsetof(V3F_C4B_T2F, texCoords));
+
+    GLfloat lineWidth = 1.0f;
+    if (_primitiveMode == GL_LINES)
+    {
+        // the line width may have been changed since the lines were added
+        glGetFloatv(GL_LINE_WIDTH, &lineWidth);
+        glLineWidth(_primitiveLineWidth);
+    }
+
+    glDrawArrays(_primitiveMode, 0, (GLsizei) count);
+
+    if (_primitiveMode == GL_LINES)
+    {
+        glLineWidth(lineWidth);
+    }
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_VERTICES(count);
+    CHECK_GL_ERROR_DEBUG();
+
+    kmGLPopMatrix();
+}
+
+void Renderer::setDebugMode(DebugMode mode)
+{
+    _debugMode = mode;
+    _recordBatches = _debugMode != DebugMode::NONE || _logBatchBreaks;
+}
+
+void Renderer::logNextFrameBatchBreaks()
+{
+    _logNextFrame = true;
+}
+
+unsigned int Renderer::getBatchBreakCount(BatchBreak reason) const
+{
+    return _lastFrameBatchBreaks[(int)reason];
+}
+
+const char* Renderer::getBatchBreakName(BatchBreak reason)
+{
+    return s_batchBreakNames[(int)reason];
+}
+
+Color4B Renderer::recordDraw(const DrawInfo& draw)
+{
+    if (_drawIndex > 0)
+    {
+        BatchBreak reason;
+        if (draw.type == DrawType::CUSTOM || _lastDraw.type == DrawType::CUSTOM)
+        {
+            reason = BatchBreak::CUSTOM_COMMAND;
+        }
+        else if (draw.type != _lastDraw.type)
+        {
+            reason = BatchBreak::COMMAND_TYPE;
+        }
+        else if (draw.texture != _lastDraw.texture)
+        {
+            reason = BatchBreak::TEXTURE;
+        }
+        else if (draw.shader != _lastDraw.shader)
+        {
+            reason = BatchBreak::SHADER;
+        }
+        else if (draw.blendFunc.src != _lastDraw.blendFunc.src || draw.blendFunc.dst != _lastDraw.blendFunc.dst)
+        {
+            reason = BatchBreak::BLEND;
+        }
+        else if (draw.mode != _lastDraw.mode || draw.lineWidth != _lastDraw.lineWidth)
+        {
+            reason = BatchBreak::PRIMITIVE_STATE;
+        }
+        else
+        {
+            // the same state: the commands weren't consecutive in the queue
+            reason = _breakHint >= 0 ? (BatchBreak)_breakHint : BatchBreak::FLUSH;
+        }
+        ++_batchBreaks[(int)reason];
+
+        if (_logBatchBreaks)
+        {
+            switch (reason)
+            {
+                case BatchBreak::TEXTURE:
+                    log("Renderer: draw %u: texture %u -> %u", _drawIndex, _lastDraw.texture, draw.texture);
+                    break;
+                case BatchBreak::SHADER:
+                    log("Renderer: draw %u: shader %u -> %u", _drawIndex, _lastDraw.shader->getProgram(), draw.shader->getProgram());
+                    break;
+                case BatchBreak::BLEND:
+                    log("Renderer: draw %u: blend (0x%x, 0x%x) -> (0x%x, 0x%x)", _drawIndex,
+                        _lastDraw.blendFunc.src, _lastDraw.blendFunc.dst, draw.blendFunc.src, draw.blendFunc.dst);
+                    break;
+                default:
+                    log("Renderer: draw %u: %s", _drawIndex, getBatchBreakName(reason));
+                    break;
+            }
+        }
+    }
+
+    _lastDraw = draw;
+    _breakHint = -1;
+    Color4B color = _debugMode == DebugMode::OVERDRAW ? OVERDRAW_COLOR : getBatchColor(_drawIndex);
+    ++_drawIndex;
+    return color;
+}
+
+void Renderer::endFrame()
+{
+    if (_logBatchBreaks)
+    {
+        log("Renderer: %u draw calls", _drawIndex);
+        for (int i = 0; i < BATCH_BREAK_COUNT; i++)
+        {
+            if (_batchBreaks[i] > 0)
+            {
+                log("Renderer: %u batch breaks: %s", _batchBreaks[i], s_batchBreakNames[i]);
+            }
+        }
+    }
+
+    memcpy(_lastFrameBatchBreaks, _batchBreaks, sizeof(_batchBreaks));
+    memset(_batchBreaks, 0, sizeof(_batchBreaks));
+    _drawIndex = 0;
+    _breakHint = -1;
+
+    _logBatchBreaks = _logNextFrame;
+    _logNextFrame = false;
+    _recordBatches = _debugMode != DebugMode::NONE || _logBatchBreaks;
+
+    _bufferArena.endFrame();
+}
+
+NS_CC_END
@@ -0,0 +1,295 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCRENDERER_CCRENDERER_H__
+#define __CCRENDERER_CCRENDERER_H__
+
+#include "cocoa/CCObject.h"
+#include "CCGL.h"
+#include "renderer/CCRenderCommand.h"
+#include "renderer/CCQuadCommand.h"
+#include "renderer/CCCustomCommand.h"
+#include "renderer/CCGroupCommand.h"
+#include "renderer/CCPrimitiveCommand.h"
+#include "renderer/CCBufferArena.h"
+#include <memory>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief Renderer records the render commands submitted while the scene is visited,
+ and executes them when it is flushed.
+
+ The Director flushes the Renderer once per frame, after the scene and the notification
+ node were visited.
+
+ Code that draws "immediately" (eg: Node::draw() overrides that use CC_NODE_DRAW_SETUP(), DrawPrimitives)
+ flushes the Renderer automatically when it uses a GLProgram, so the painter's order of the scene is preserved.
+ Code that changes the GL state that the pending commands depend on (framebuffer, stencil, scissor, projection)
+ must call flush() before changing it.
+
+ Consecutive QuadCommands that have the same material (texture, shader and blending function) are
+ batched: their quads are transformed to world space on the CPU and drawn with a single draw call,
+ so sprites don't need to be children of a SpriteBatchNode to be batched.
+
+ Untextured primitives (PrimitiveCommands of DrawNodes, and the DrawPrimitives functions) are transformed
+ to world space too, and accumulated in a batch of primitives that is drawn with a single draw call before
+ the next draw call of the Renderer or of immediate code, or when the primitives that follow need a
+ different mode, shader, blending function or line width.
+
+ The vertices of the primitives, and the small meshes written every frame by the nodes that draw themselves,
+ are copied to the streaming buffers of the BufferArena of the Renderer: see getBufferArena().
+
+ The debug modes show the batches: DebugMode::BATCHES draws each draw call of the Renderer with a color of
+ its own, and DebugMode::OVERDRAW draws them additively with a dim color, so the pixels drawn many times are the
+ brightest (use a black clear color). The quads keep the alpha of their texture. The custom commands and the
+ immediate code draw as usual. While a debug mode is set or a log is requested, the Renderer records why each
+ draw call couldn't be batched with the previous one: see BatchBreak.
+
+ With setParallelPreparationEnabled(), the queue is turned into a command list when it is flushed, and the quads
+ of its batches are transformed to world space by the worker threads of the JobSystem while the GL thread issues
+ the draw calls of the batches already prepared, waiting for a batch only when it reaches it before the workers.
+ The command lists are reused once their workers are done with them, so a worker late on a list never races
+ with the next flush.
+
+ @since v3.0
+ */
+class CC_DLL Renderer : public Object
+{
+public:
+    enum class DebugMode
+    {
+        NONE,
+        /** each draw call has a color of its own */
+        BATCHES,
+        /** heatmap of the pixels drawn several times */
+        OVERDRAW,
+    };
+
+    /** Why a draw call wasn't batched with the previous one. The first reason that applies is recorded. */
+    enum class BatchBreak
+    {
+        /** quads with another texture */
+        TEXTURE,
+        /** another shader */
+        SHADER,
+        /** another blending function */
+        BLEND,
+        /** primitives with another mode or line width */
+        PRIMITIVE_STATE,
+        /** quads after primitives, or primitives after quads */
+        COMMAND_TYPE,
+        /** a CustomCommand, eg: a LabelTTF with a glyph effect */
+        CUSTOM_COMMAND,
+        /** the beginning or the end of a GroupCommand */
+        GROUP,
+        /** the Renderer was flushed: immediate drawing (Node::draw() using a GLProgram, DrawPrimitives),
+         or a change of framebuffer, stencil or scissor (RenderTexture, ClippingNode, ScrollView) */
+        FLUSH,
+        /** more quads than an index buffer of GLushort can address */
+        BUFFER_FULL,
+        /** see setBatchingEnabled() */
+        BATCHING_DISABLED,
+    };
+    static const int BATCH_BREAK_COUNT = 10;
+
+    Renderer();
+    virtual ~Renderer();
+
+    /** Adds a command to the render queue (or to the current group).
+     The command is not retained.
+     */
+    void addCommand(RenderCommand* command);
+
+    /** Adds a group to the render queue. The commands added until popGroup() is called are recorded into the group. */
+    void pushGroup(GroupCommand* group);
+
+    /** Closes the group opened by the last pushGroup() */
+    void popGroup();
+
+    /** Executes all the pending commands, and empties the render queue */
+    void flush();
+
+    /** Adds vertices to the batch of primitives. They are copied, and transformed by mv.
+     The pending commands are executed first, so the primitives are drawn in submission order.
+     @param mode GL_TRIANGLES, GL_LINES or GL_POINTS
+     @param lineWidth width of the lines, used by GL_LINES
+     */
+    void addPrimitives(GLenum mode, GLProgram* shader, const BlendFunc& blendFunc, float lineWidth,
+                       const V2F_C4B_T2F* vertices, int vertexCount, const kmMat4& mv);
+
+    /** Whether or not the Renderer is executing commands */
+    inline bool isRendering() const { return _isRendering; }
+
+    /** Enables or disables the batching of consecutive QuadCommands. Enabled by default.
+     Shaders that expect the quads in node space (eg: using the position of the vertex in the fragment shader)
+     may need to disable it.
+     */
+    inline void setBatchingEnabled(bool enabled) { _batchingEnabled = enabled; }
+    inline bool isBatchingEnabled() const { return _batchingEnabled; }
+
+    /** Enables or disables the preparation of the batches of quads by the worker threads. Disabled by default.
+     The quads of the QuadCommands are read by the workers during the flush: the CustomCommands must not change them.
+     */
+    inline void setParallelPreparationEnabled(bool enabled) { _parallelPreparation = enabled; }
+    inline bool isParallelPreparationEnabled() const { return _parallelPreparation; }
+
+    /** Sets how the draw calls are shown, DebugMode::NONE by default */
+    void setDebugMode(DebugMode mode);
+    inline DebugMode getDebugMode() const { return _debugMode; }
+
+    /** Logs the draw calls of the next frame that break a batch, with the reason, and the number of breaks per reason */
+    void logNextFrameBatchBreaks();
+
+    /** Number of draw calls of the last frame that broke a batch for the reason.
+     The breaks are counted while a debug mode is set, or while a log is requested.
+     */
+    unsigned int getBatchBreakCount(BatchBreak reason) const;
+
+    static const char* getBatchBreakName(BatchBreak reason);
+
+    /** The streaming buffers shared by the meshes written every frame */
+    inline BufferArena* getBufferArena() { return &_bufferArena; }
+
+    /** Ends the frame of the batch statistics and of the BufferArena, called by the Director once the frame is drawn */
+    void endFrame();
+
+    /** listen the event that coming to foreground on Android */
+    void listenBackToForeground(Object *obj);
+
+protected:
+    /** the kind of the draw calls, to find why two draw calls weren't batched */
+    enum class DrawType
+    {
+        QUADS,
+        PRIMITIVES,
+        CUSTOM,
+    };
+
+    struct DrawInfo
+    {
+        DrawType type;
+        GLuint texture;
+        GLProgram* shader;
+        BlendFunc blendFunc;
+        GLenum mode;
+        float lineWidth;
+    };
+
+    /** a step of a command list: a batch of quad commands, or a custom or a primitive command */
+    struct PreparedStep
+    {
+        RenderCommand::Type type;
+        /** commands [first, last) of the list */
+        unsigned int first;
+        unsigned int last;
+        /** quads of a batch in the quads of the list */
+        unsigned int quadOffset;
+        unsigned int quadCount;
+        /** index of a batch in the batches of the list */
+        unsigned int batch;
+        /** BatchBreak of the step when the draw calls have the same state, -1 for none */
+        int breakHint;
+    };
+
+    /** the queue flattened for the parallel preparation, defined in the implementation */
+    struct PreparedList;
+
+    /** executes the custom and the primitive commands */
+    void executeCommand(RenderCommand* command);
+    /** flushes the queue through a command list prepared by the workers */
+    void flushPrepared();
+    void flattenQueue(std::vector<RenderCommand*>& queue, PreparedList& list, int breakHint);
+    void drawPreparedBatch(PreparedList& list, const PreparedStep& step);
+
+    /** records a draw call in the batch statistics, and returns the color of its batch in the debug modes */
+    Color4B recordDraw(const DrawInfo& draw);
+    /** hints the reason of the next batch break, used when the draw calls have the same state */
+    inline void setBreakHint(BatchBreak reason) { if (_recordBatches && _breakHint < 0) _breakHint = (int)reason; }
+
+    void setupBuffers();
+    /** grows the buffers to hold quadCount quads. Returns false if the buffers can't be used */
+    bool ensureQuadCapacity(int quadCount);
+    void processQueue(std::vector<RenderCommand*>& queue);
+    typedef std::vector<RenderCommand*>::iterator CommandIterator;
+    /** draws the quad commands in [first, last), which must share the same material */
+    void drawQuadCommands(CommandIterator first, CommandIterator last);
+    /** draws quads in world space, at most _quadCapacity */
+    void drawQuads(V3F_C4B_T2F_Quad* quads, int quadCount);
+    /** draws and empties the batch of primitives */
+    void drawPrimitives();
+
+    std::vector<RenderCommand*> _renderQueue;
+    std::vector<GroupCommand*> _groupStack;
+
+    GLushort* _indices;
+    // quads of the current batch, in world space
+    V3F_C4B_T2F_Quad* _quads;
+    int _quadCapacity;
+    GLuint _buffersVBO[2]; //0: vertex  1: indices
+
+    // batch of primitives, in world space
+    V3F_C4B_T2F* _primitives;
+    int _primitiveCount;
+    int _primitiveCapacity;
+    GLenum _primitiveMode;
+    GLProgram* _primitiveShader;
+    BlendFunc _primitiveBlendFunc;
+    float _primitiveLineWidth;
+
+    BufferArena _bufferArena;
+    bool _buffersInitialized;
+    bool _isRendering;
+    bool _batchingEnabled;
+
+    // first command of the quads being drawn
+    QuadCommand* _quadMaterial;
+
+    bool _parallelPreparation;
+    // the command lists, reused once their workers are done
+    std::vector<std::shared_ptr<PreparedList>> _preparedLists;
+
+    // batch statistics
+    DebugMode _debugMode;
+    bool _recordBatches;
+    bool _logBatchBreaks;
+    bool _logNextFrame;
+    unsigned int _drawIndex;
+    DrawInfo _lastDraw;
+    int _breakHint;
+    unsigned int _batchBreaks[BATCH_BREAK_COUNT];
+    unsigned int _lastFrameBatchBreaks[BATCH_BREAK_COUNT];
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CCRENDERER_CCRENDERER_H__
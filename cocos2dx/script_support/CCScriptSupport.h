@@ -296,6 +296,9 @@ public:
 
     /** Remove script object. */
     virtual void removeScriptObjectByObject(Object* pObj) = 0;
+
+    /** Remove the script handlers registered on an object that stays alive, like the objects put back in the ObjectPool. */
+    virtual void removeScriptHandlersByObject(Object* pObj) {};
     
     /** Remove script function handler, only LuaEngine class need to implement this function. */
     virtual void removeScriptHandler(int nHandler) {};
@@ -332,6 +335,27 @@ public:
      * @return true if the assert was handled by the script engine, false otherwise.
      */
     virtual bool handleAssert(const char *msg) = 0;
+
+    /** Starts a batch of events: the engine may queue the events whose return value isn't used,
+     * like the schedule callbacks, and dispatch them at once when the batch ends.
+     * Batches can be nested, the events are dispatched at the end of the outermost one.
+     */
+    virtual void beginEventBatch() {};
+
+    /** Ends a batch of events, see beginEventBatch */
+    virtual void endEventBatch() {};
+
+    /** Drops the queued events of a handler that is removed before the end of the batch */
+    virtual void cancelQueuedEvents(int nHandler) {};
+
+    /** Runs the garbage collector for about budget seconds, called at the end of the frames, see
+     * Director::setScriptGCBudget. From the first call, the engine collects in these steps rather than
+     * in the middle of the frames, as far as it can.
+     */
+    virtual void collectGarbage(float budget) {};
+
+    /** Gives the collections back to the engine after collectGarbage */
+    virtual void resumeAutomaticGarbageCollection() {};
 };
 
 /**
@@ -365,6 +389,33 @@ private:
     ScriptEngineProtocol *_scriptEngine;
 };
 
+/**
+ ScriptEventBatch batches the script events sent during its scope, see ScriptEngineProtocol::beginEventBatch
+ */
+class ScriptEventBatch
+{
+public:
+    ScriptEventBatch()
+    : _engine(ScriptEngineManager::getInstance()->getScriptEngine())
+    {
+        if (_engine)
+        {
+            _engine->beginEventBatch();
+        }
+    }
+
+    ~ScriptEventBatch()
+    {
+        if (_engine)
+        {
+            _engine->endEventBatch();
+        }
+    }
+
+private:
+    ScriptEngineProtocol* _engine;
+};
+
 // end of script_support group
 /// @}
 
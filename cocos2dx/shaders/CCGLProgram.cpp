@@ -26,6 +26,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "CCDirector.h"
+#include "CCConfiguration.h"
 #include "CCGLProgram.h"
 #include "ccGLStateCache.h"
 #include "ccMacros.h"
@@ -35,9 +36,82 @@ THE SOFTWARE.
 // extern
 #include "kazmath/GL/matrix.h"
 #include "kazmath/kazmath.h"
+#include "renderer/CCRenderer.h"
+#include <stdio.h>
+#include <vector>
+
+#if CC_ENABLE_PROGRAM_BINARY_CACHE && (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#include <EGL/egl.h>
+#endif
 
 NS_CC_BEGIN
 
+// program binaries: GL_OES_get_program_binary on Android, GL_ARB_get_program_binary through GLEW on desktop
+#if CC_ENABLE_PROGRAM_BINARY_CACHE && (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#define CC_USE_PROGRAM_BINARY 1
+
+static PFNGLGETPROGRAMBINARYOESPROC s_glGetProgramBinary = NULL;
+static PFNGLPROGRAMBINARYOESPROC s_glProgramBinary = NULL;
+
+static bool loadProgramBinaryFunctions()
+{
+    if (! s_glGetProgramBinary || ! s_glProgramBinary)
+    {
+        s_glGetProgramBinary = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+        s_glProgramBinary = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
+    }
+    return s_glGetProgramBinary && s_glProgramBinary;
+}
+#elif CC_ENABLE_PROGRAM_BINARY_CACHE && ((CC_TARGET_PLATFORM == CC_PLATFORM_LINUX) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32))
+#define CC_USE_PROGRAM_BINARY 1
+
+#define s_glGetProgramBinary glGetProgramBinary
+#define s_glProgramBinary glProgramBinary
+
+// GLEW loaded the functions of the extension reported by Configuration
+static bool loadProgramBinaryFunctions()
+{
+    return true;
+}
+#else
+#define CC_USE_PROGRAM_BINARY 0
+#endif
+
+#if CC_USE_PROGRAM_BINARY
+// header of the files of the program binary cache
+struct ProgramBinaryHeader
+{
+    unsigned int magic;
+    unsigned int sourceHash;
+    unsigned int format;
+    unsigned int length;
+};
+
+static const unsigned int s_programBinaryMagic = 0x42504343; // "CCPB"
+
+// FNV-1a
+static unsigned int hashString(unsigned int hash, const char* str)
+{
+    for (; str && *str; ++str)
+    {
+        hash = (hash ^ (unsigned char)*str) * 16777619u;
+    }
+    return (hash ^ 0xff) * 16777619u;
+}
+
+// the binaries of a driver can't be used by another one
+static unsigned int hashProgramSources(const GLchar* vShaderByteArray, const GLchar* fShaderByteArray)
+{
+    unsigned int hash = 2166136261u;
+    hash = hashString(hash, vShaderByteArray);
+    hash = hashString(hash, fShaderByteArray);
+    hash = hashString(hash, (const char*)glGetString(GL_VENDOR));
+    hash = hashString(hash, (const char*)glGetString(GL_RENDERER));
+    hash = hashString(hash, (const char*)glGetString(GL_VERSION));
+    return hash;
+}
+#endif
+
 typedef struct _hashUniformEntry
 {
     GLvoid*         value;       // value
@@ -53,6 +127,13 @@ const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR = "ShaderPositionTex
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR = "ShaderPositionTextureA8Color";
 const char* GLProgram::SHADER_NAME_POSITION_U_COLOR = "ShaderPosition_uColor";
 const char* GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR = "ShaderPositionLengthTextureColor";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_ALPHA_TEXTURE = "ShaderPositionTextureColorAlphaTexture";
+const char* GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD = "ShaderLabelDistanceField";
+const char* GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_EFFECT = "ShaderLabelDistanceFieldEffect";
+const char* GLProgram::SHADER_NAME_PARTICLE_GPU = "ShaderParticleGPU";
+const char* GLProgram::SHADER_NAME_MOTION_STREAK = "ShaderMotionStreak";
+const char* GLProgram::SHADER_NAME_GRID_EFFECT = "ShaderGridEffect";
+const char* GLProgram::SHADER_NAME_INSTANCED_SPRITE = "ShaderInstancedSprite";
 
 // uniform names
 const char* GLProgram::UNIFORM_NAME_P_MATRIX = "CC_PMatrix";
@@ -63,6 +144,7 @@ const char* GLProgram::UNIFORM_NAME_SIN_TIME = "CC_SinTime";
 const char* GLProgram::UNIFORM_NAME_COS_TIME = "CC_CosTime";
 const char* GLProgram::UNIFORM_NAME_RANDOM01 = "CC_Random01";
 const char* GLProgram::UNIFORM_NAME_SAMPLER	= "CC_Texture0";
+const char* GLProgram::UNIFORM_NAME_SAMPLER1 = "CC_Texture1";
 const char* GLProgram::UNIFORM_NAME_ALPHA_TEST_VALUE = "CC_alpha_value";
 
 // Attribute names
@@ -76,6 +158,9 @@ GLProgram::GLProgram()
 , _fragShader(0)
 , _hashForUniforms(NULL)
 , _usesTime(false)
+, _builtinMatricesSet(false)
+, _sourceHash(0)
+, _linkedFromBinary(false)
 {
     memset(_uniforms, 0, sizeof(_uniforms));
 }
@@ -110,6 +195,21 @@ bool GLProgram::initWithVertexShaderByteArray(const GLchar* vShaderByteArray, co
     CHECK_GL_ERROR_DEBUG();
 
     _vertShader = _fragShader = 0;
+    _hashForUniforms = NULL;
+    _linkedFromBinary = false;
+
+#if CC_USE_PROGRAM_BINARY
+    // a program linked by a previous run from the same sources doesn't need its shaders
+    if (! _binaryCacheName.empty())
+    {
+        _sourceHash = hashProgramSources(vShaderByteArray, fShaderByteArray);
+        if (loadProgramBinary())
+        {
+            _linkedFromBinary = true;
+            return true;
+        }
+    }
+#endif
 
     if (vShaderByteArray)
     {
@@ -138,7 +238,6 @@ bool GLProgram::initWithVertexShaderByteArray(const GLchar* vShaderByteArray, co
     {
         glAttachShader(_program, _fragShader);
     }
-    _hashForUniforms = NULL;
     
     CHECK_GL_ERROR_DEBUG();
 
@@ -239,21 +338,39 @@ void GLProgram::updateUniforms()
 	_uniforms[UNIFORM_RANDOM01] = glGetUniformLocation(_program, UNIFORM_NAME_RANDOM01);
 
     _uniforms[UNIFORM_SAMPLER] = glGetUniformLocation(_program, UNIFORM_NAME_SAMPLER);
+    _uniforms[UNIFORM_SAMPLER1] = glGetUniformLocation(_program, UNIFORM_NAME_SAMPLER1);
+
+    _uniformLocations.clear();
+    _builtinMatricesSet = false;
 
     this->use();
     
     // Since sample most probably won't change, set it to 0 now.
     this->setUniformLocationWith1i(_uniforms[GLProgram::UNIFORM_SAMPLER], 0);
+    if (_uniforms[GLProgram::UNIFORM_SAMPLER1] != -1)
+    {
+        this->setUniformLocationWith1i(_uniforms[GLProgram::UNIFORM_SAMPLER1], 1);
+    }
 }
 
 bool GLProgram::link()
 {
     CCASSERT(_program != 0, "Cannot link invalid program");
+
+    if (_linkedFromBinary)
+    {
+        return true;
+    }
     
     GLint status = GL_TRUE;
     
     glLinkProgram(_program);
 
+    if (! _binaryCacheName.empty())
+    {
+        saveProgramBinary();
+    }
+
     if (_vertShader)
     {
         glDeleteShader(_vertShader);
@@ -280,8 +397,108 @@ bool GLProgram::link()
     return (status == GL_TRUE);
 }
 
+bool GLProgram::loadProgramBinary()
+{
+#if CC_USE_PROGRAM_BINARY
+    if (! Configuration::getInstance()->supportsProgramBinary() || ! loadProgramBinaryFunctions())
+    {
+        return false;
+    }
+
+    std::string path = FileUtils::getInstance()->getWritablePath() + "cc_program_" + _binaryCacheName + ".bin";
+    FILE *file = fopen(path.c_str(), "rb");
+    if (! file)
+    {
+        return false;
+    }
+
+    ProgramBinaryHeader header;
+    std::vector<unsigned char> binary;
+    bool ret = fread(&header, sizeof(header), 1, file) == 1
+        && header.magic == s_programBinaryMagic
+        && header.sourceHash == _sourceHash
+        && header.length > 0;
+    if (ret)
+    {
+        binary.resize(header.length);
+        ret = fread(&binary[0], header.length, 1, file) == 1;
+    }
+    fclose(file);
+
+    if (! ret)
+    {
+        return false;
+    }
+
+    s_glProgramBinary(_program, (GLenum)header.format, &binary[0], (GLsizei)header.length);
+
+    // the driver may reject a binary even if it made it itself, eg: after an update
+    GLint status = GL_FALSE;
+    glGetProgramiv(_program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        glGetError();
+        CCLOG("cocos2d: the binary of program %s was rejected, compiling it", _binaryCacheName.c_str());
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void GLProgram::saveProgramBinary()
+{
+#if CC_USE_PROGRAM_BINARY
+    if (! Configuration::getInstance()->supportsProgramBinary() || ! loadProgramBinaryFunctions())
+    {
+        return;
+    }
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(_program, GL_LINK_STATUS, &status);
+    GLint length = 0;
+    glGetProgramiv(_program, 0x8741 /* GL_PROGRAM_BINARY_LENGTH */, &length);
+    if (status != GL_TRUE || length <= 0)
+    {
+        return;
+    }
+
+    std::vector<unsigned char> binary(length);
+    GLenum format = 0;
+    s_glGetProgramBinary(_program, length, &length, &format, &binary[0]);
+    if (length <= 0)
+    {
+        return;
+    }
+
+    ProgramBinaryHeader header;
+    header.magic = s_programBinaryMagic;
+    header.sourceHash = _sourceHash;
+    header.format = format;
+    header.length = (unsigned int)length;
+
+    std::string path = FileUtils::getInstance()->getWritablePath() + "cc_program_" + _binaryCacheName + ".bin";
+    FILE *file = fopen(path.c_str(), "wb");
+    if (! file)
+    {
+        return;
+    }
+
+    bool ret = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(&binary[0], length, 1, file) == 1;
+    if (fclose(file) != 0 || ! ret)
+    {
+        // a truncated file is rejected when it's loaded, but there is no need to read it
+        remove(path.c_str());
+    }
+#endif
+}
+
 void GLProgram::use()
 {
+    // immediate mode drawing: execute the pending render commands first to keep the drawing order
+    Director::getInstance()->getRenderer()->flush();
+
     GL::useProgram(_program);
 }
 
@@ -362,8 +579,21 @@ GLint GLProgram::getUniformLocationForName(const char* name) const
 {
     CCASSERT(name != NULL, "Invalid uniform name" );
     CCASSERT(_program != 0, "Invalid operation. Cannot get uniform location when program is not initialized");
-    
-    return glGetUniformLocation(_program, name);
+
+    // a program has a few uniforms, the driver isn't asked again for them
+    for (auto it = _uniformLocations.begin(); it != _uniformLocations.end(); ++it)
+    {
+        if (it->name == name)
+        {
+            return it->location;
+        }
+    }
+
+    UniformLocation uniform;
+    uniform.name = name;
+    uniform.location = glGetUniformLocation(_program, name);
+    _uniformLocations.push_back(uniform);
+    return uniform.location;
 }
 
 void GLProgram::setUniformLocationWith1i(GLint location, GLint i1)
@@ -520,6 +750,11 @@ void GLProgram::setUniformLocationWithMatrix4fv(GLint location, GLfloat* matrixA
     if( updated )
     {
         glUniformMatrix4fv( (GLint)location, (GLsizei)numberOfMatrices, GL_FALSE, matrixArray);
+
+        if (location == _uniforms[UNIFORM_P_MATRIX] || location == _uniforms[UNIFORM_MV_MATRIX] || location == _uniforms[UNIFORM_MVP_MATRIX])
+        {
+            _builtinMatricesSet = false;
+        }
     }
 }
 
@@ -531,12 +766,22 @@ void GLProgram::setUniformsForBuiltins()
 	
 	kmGLGetMatrix(KM_GL_PROJECTION, &matrixP);
 	kmGLGetMatrix(KM_GL_MODELVIEW, &matrixMV);
-	
-	kmMat4Multiply(&matrixMVP, &matrixP, &matrixMV);
-    
-    setUniformLocationWithMatrix4fv(_uniforms[UNIFORM_P_MATRIX], matrixP.mat, 1);
-    setUniformLocationWithMatrix4fv(_uniforms[UNIFORM_MV_MATRIX], matrixMV.mat, 1);
-    setUniformLocationWithMatrix4fv(_uniforms[UNIFORM_MVP_MATRIX], matrixMVP.mat, 1);
+
+    // consecutive draws with the same program and matrices, eg: the quads batched by the Renderer
+    if (! _builtinMatricesSet ||
+        memcmp(&matrixMV, &_builtinMV, sizeof(kmMat4)) != 0 ||
+        memcmp(&matrixP, &_builtinP, sizeof(kmMat4)) != 0)
+    {
+        kmMat4Multiply(&matrixMVP, &matrixP, &matrixMV);
+        
+        setUniformLocationWithMatrix4fv(_uniforms[UNIFORM_P_MATRIX], matrixP.mat, 1);
+        setUniformLocationWithMatrix4fv(_uniforms[UNIFORM_MV_MATRIX], matrixMV.mat, 1);
+        setUniformLocationWithMatrix4fv(_uniforms[UNIFORM_MVP_MATRIX], matrixMVP.mat, 1);
+
+        _builtinP = matrixP;
+        _builtinMV = matrixMV;
+        _builtinMatricesSet = true;
+    }
 	
 	if(_usesTime)
     {
@@ -566,6 +811,8 @@ void GLProgram::reset()
     // it is already deallocated by android
     //GL::deleteProgram(_program);
     _program = 0;
+    _uniformLocations.clear();
+    _builtinMatricesSet = false;
 
     
     tHashUniformEntry *current_element, *tmp;
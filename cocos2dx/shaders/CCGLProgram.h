@@ -32,6 +32,9 @@ THE SOFTWARE.
 #include "cocoa/CCObject.h"
 
 #include "CCGL.h"
+#include "kazmath/mat4.h"
+#include <string>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -73,6 +76,7 @@ public:
         UNIFORM_COS_TIME,
         UNIFORM_RANDOM01,
         UNIFORM_SAMPLER,
+        UNIFORM_SAMPLER1,
         
         UNIFORM_MAX,
     };
@@ -85,6 +89,13 @@ public:
     static const char* SHADER_NAME_POSITION_TEXTURE_A8_COLOR;
     static const char* SHADER_NAME_POSITION_U_COLOR;
     static const char* SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR;
+    static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_ALPHA_TEXTURE;
+    static const char* SHADER_NAME_LABEL_DISTANCEFIELD;
+    static const char* SHADER_NAME_LABEL_DISTANCEFIELD_EFFECT;
+    static const char* SHADER_NAME_PARTICLE_GPU;
+    static const char* SHADER_NAME_MOTION_STREAK;
+    static const char* SHADER_NAME_GRID_EFFECT;
+    static const char* SHADER_NAME_INSTANCED_SPRITE;
     
     // uniform names
     static const char* UNIFORM_NAME_P_MATRIX;
@@ -95,6 +106,7 @@ public:
     static const char* UNIFORM_NAME_COS_TIME;
     static const char* UNIFORM_NAME_RANDOM01;
     static const char* UNIFORM_NAME_SAMPLER;
+    static const char* UNIFORM_NAME_SAMPLER1;
     static const char* UNIFORM_NAME_ALPHA_TEST_VALUE;
     
     // Attribute names
@@ -108,11 +120,20 @@ public:
     bool initWithVertexShaderByteArray(const GLchar* vShaderByteArray, const GLchar* fShaderByteArray);
     /** Initializes the GLProgram with a vertex and fragment with contents of filenames */
     bool initWithVertexShaderFilename(const char* vShaderFilename, const char* fShaderFilename);
+    /** Sets the name under which the binary of the program is cached in the writable path (see CC_ENABLE_PROGRAM_BINARY_CACHE).
+     It must be set before the program is initialized: if a binary linked from the same sources is found, the shaders
+     aren't compiled and link() does nothing. Otherwise link() saves the binary.
+     @since v3.0
+     */
+    void setBinaryCacheName(const char* name) { _binaryCacheName = name ? name : ""; }
+
     /**  It will add a new attribute to the shader */
     void addAttribute(const char* attributeName, GLuint index);
     /** links the glProgram */
     bool link();
-    /** it will call glUseProgram() */
+    /** it will call glUseProgram().
+     The pending render commands of the Renderer are executed before, unless the Renderer is the caller.
+     */
     void use();
 /** It will create 4 uniforms:
     - kUniformPMatrix
@@ -120,12 +141,14 @@ public:
     - kUniformMVPMatrix
     - GLProgram::UNIFORM_SAMPLER
 
- And it will bind "GLProgram::UNIFORM_SAMPLER" to 0
+ And it will bind "GLProgram::UNIFORM_SAMPLER" to 0 and "GLProgram::UNIFORM_SAMPLER1" to 1
 
  */
     void updateUniforms();
     
-    /** calls retrieves the named uniform location for this shader program. */
+    /** retrieves the named uniform location for this shader program.
+     The locations are cached once they are retrieved, so it can be called when drawing.
+     */
     GLint getUniformLocationForName(const char* name) const;
     
     /** calls glUniform1i only if the values are different than the previous call for this same shader program. */
@@ -174,7 +197,10 @@ public:
     /** calls glUniformMatrix4fv only if the values are different than the previous call for this same shader program. */
     void setUniformLocationWithMatrix4fv(GLint location, GLfloat* matrixArray, unsigned int numberOfMatrices);
     
-    /** will update the builtin uniforms if they are different than the previous call for this same shader program. */
+    /** will update the builtin uniforms if they are different than the previous call for this same shader program.
+     The matrices aren't multiplied nor compared again when the projection and modelview matrices didn't change
+     since the previous call.
+     */
     void setUniformsForBuiltins();
 
     /** returns the vertexShader error log */
@@ -195,6 +221,8 @@ private:
     const char* description() const;
     bool compileShader(GLuint * shader, GLenum type, const GLchar* source);
     const char* logForOpenGLObject(GLuint object, GLInfoFunction infoFunc, GLLogFunction logFunc) const;
+    bool loadProgramBinary();
+    void saveProgramBinary();
 
 private:
     GLuint            _program;
@@ -203,6 +231,24 @@ private:
     GLint             _uniforms[UNIFORM_MAX];
     struct _hashUniformEntry* _hashForUniforms;
     bool              _usesTime;
+
+    // locations of the uniforms retrieved by name
+    struct UniformLocation
+    {
+        std::string     name;
+        GLint           location;
+    };
+    mutable std::vector<UniformLocation> _uniformLocations;
+
+    // matrices of the previous setUniformsForBuiltins()
+    kmMat4            _builtinP;
+    kmMat4            _builtinMV;
+    bool              _builtinMatricesSet;
+
+    // program binary cache
+    std::string       _binaryCacheName;
+    unsigned int      _sourceHash;
+    bool              _linkedFromBinary;
 };
 
 // end of shaders group
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "CCGLProgram.h"
 #include "ccMacros.h"
 #include "ccShaders.h"
+#include "textures/CCTexture2D.h"
 
 NS_CC_BEGIN
 
@@ -40,6 +41,13 @@ enum {
     kShaderType_PositionTextureA8Color,
     kShaderType_Position_uColor,
     kShaderType_PositionLengthTexureColor,
+    kShaderType_PositionTextureColorAlphaTexture,
+    kShaderType_LabelDistanceField,
+    kShaderType_LabelDistanceFieldEffect,
+    kShaderType_ParticleGPU,
+    kShaderType_MotionStreak,
+    kShaderType_GridEffect,
+    kShaderType_InstancedSprite,
     
     kShaderType_MAX,
 };
@@ -78,7 +86,7 @@ void ShaderCache::purgeSharedShaderCache()
 ShaderCache::ShaderCache()
 : _programs(0)
 {
-
+    memset(_variants, 0, sizeof(_variants));
 }
 
 ShaderCache::~ShaderCache()
@@ -89,141 +97,122 @@ ShaderCache::~ShaderCache()
 
 bool ShaderCache::init()
 {
+    // the default shaders are compiled when they are first used
     _programs = new Dictionary();
-    loadDefaultShaders();
     return true;
 }
 
+// the defines of the features of the variants, in the order of their bits
+static const char* s_variantDefines[] = {
+    "#define CC_VARIANT_NO_VERTEX_COLOR\n",
+    "#define CC_VARIANT_PREMULTIPLIED\n",
+    "#define CC_VARIANT_OPAQUE\n",
+    "#define CC_VARIANT_ALPHA_TEST\n",
+    "#define CC_VARIANT_A8\n",
+};
+
+static std::string getVariantName(unsigned int variant)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%sVariant%u", GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR, variant);
+    return name;
+}
+
+// the variants that are default shaders, reloaded as such
+static inline bool isDefaultVariant(unsigned int variant)
+{
+    return variant == 0 || variant == ShaderCache::VARIANT_ALPHA_TEST || variant == ShaderCache::VARIANT_A8;
+}
+
+static const char* getDefaultShaderName(int type)
+{
+    switch (type) {
+        // Position Texture Color shader
+        case kShaderType_PositionTextureColor:
+            return GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR;
+        // Position Texture Color alpha test
+        case kShaderType_PositionTextureColorAlphaTest:
+            return GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST;
+        // Position, Color shader
+        case kShaderType_PositionColor:
+            return GLProgram::SHADER_NAME_POSITION_COLOR;
+        // Position Texture shader
+        case kShaderType_PositionTexture:
+            return GLProgram::SHADER_NAME_POSITION_TEXTURE;
+        // Position, Texture attribs, 1 Color as uniform shader
+        case kShaderType_PositionTexture_uColor:
+            return GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR;
+        // Position Texture A8 Color shader
+        case kShaderType_PositionTextureA8Color:
+            return GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR;
+        // Label shaders, with a distance field in the alpha channel
+        case kShaderType_LabelDistanceField:
+            return GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD;
+        case kShaderType_LabelDistanceFieldEffect:
+            return GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_EFFECT;
+        // Particles simulated by the vertex shader
+        case kShaderType_ParticleGPU:
+            return GLProgram::SHADER_NAME_PARTICLE_GPU;
+        // Motion streak faded by the vertex shader
+        case kShaderType_MotionStreak:
+            return GLProgram::SHADER_NAME_MOTION_STREAK;
+        // Grid vertices displaced by the vertex shader
+        case kShaderType_GridEffect:
+            return GLProgram::SHADER_NAME_GRID_EFFECT;
+        // Sprites drawn with instancing, transformed by the vertex shader
+        case kShaderType_InstancedSprite:
+            return GLProgram::SHADER_NAME_INSTANCED_SPRITE;
+        // Position and 1 color passed as a uniform (to simulate glColor4ub )
+        case kShaderType_Position_uColor:
+            return GLProgram::SHADER_NAME_POSITION_U_COLOR;
+        // Position, Legth(TexCoords, Color (used by Draw Node basically )
+        case kShaderType_PositionLengthTexureColor:
+            return GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR;
+        // Position Texture Color shader, with the alpha channel in a second texture (ETC1)
+        case kShaderType_PositionTextureColorAlphaTexture:
+            return GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_ALPHA_TEXTURE;
+        default:
+            return NULL;
+    }
+}
+
 void ShaderCache::loadDefaultShaders()
 {
-    // Position Texture Color shader
-    GLProgram *p = new GLProgram();
-    loadDefaultShader(p, kShaderType_PositionTextureColor);
-
-    _programs->setObject(p, GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);
-    p->release();
-
-    // Position Texture Color alpha test
-    p = new GLProgram();
-    loadDefaultShader(p, kShaderType_PositionTextureColorAlphaTest);
-
-    _programs->setObject(p, GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST);
-    p->release();
-
-    //
-    // Position, Color shader
-    //
-    p = new GLProgram();
-    loadDefaultShader(p, kShaderType_PositionColor);
-
-    _programs->setObject(p, GLProgram::SHADER_NAME_POSITION_COLOR);
-    p->release();
-
-    //
-    // Position Texture shader
-    //
-    p = new GLProgram();
-    loadDefaultShader(p, kShaderType_PositionTexture);
-
-    _programs->setObject(p, GLProgram::SHADER_NAME_POSITION_TEXTURE);
-    p->release();
-
-    //
-    // Position, Texture attribs, 1 Color as uniform shader
-    //
-    p = new GLProgram();
-    loadDefaultShader(p, kShaderType_PositionTexture_uColor);
-
-    _programs->setObject(p ,GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR);
-    p->release();
-
-    //
-    // Position Texture A8 Color shader
-    //
-    p = new GLProgram();
-    loadDefaultShader(p, kShaderType_PositionTextureA8Color);
-    
-    _programs->setObject(p, GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR);
-    p->release();
-
-    //
-    // Position and 1 color passed as a uniform (to simulate glColor4ub )
-    //
-    p = new GLProgram();
-    loadDefaultShader(p, kShaderType_Position_uColor);
-    
-    _programs->setObject(p, GLProgram::SHADER_NAME_POSITION_U_COLOR);
-    p->release();
-    
-    //
-	// Position, Legth(TexCoords, Color (used by Draw Node basically )
-	//
-    p = new GLProgram();
-    loadDefaultShader(p, kShaderType_PositionLengthTexureColor);
-    
-    _programs->setObject(p, GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR);
-    p->release();
+    for (int type = 0; type < kShaderType_MAX; ++type)
+    {
+        programForKey(getDefaultShaderName(type));
+    }
 }
 
 void ShaderCache::reloadDefaultShaders()
 {
-    // reset all programs and reload them
-    
-    // Position Texture Color shader
-    GLProgram *p = programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);    
-    p->reset();
-    loadDefaultShader(p, kShaderType_PositionTextureColor);
-
-    // Position Texture Color alpha test
-    p = programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST);
-    p->reset();    
-    loadDefaultShader(p, kShaderType_PositionTextureColorAlphaTest);
-    
-    //
-    // Position, Color shader
-    //
-    p = programForKey(GLProgram::SHADER_NAME_POSITION_COLOR);
-    p->reset();
-    loadDefaultShader(p, kShaderType_PositionColor);
-    
-    //
-    // Position Texture shader
-    //
-    p = programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE);
-    p->reset();
-    loadDefaultShader(p, kShaderType_PositionTexture);
-    
-    //
-    // Position, Texture attribs, 1 Color as uniform shader
-    //
-    p = programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR);
-    p->reset();
-    loadDefaultShader(p, kShaderType_PositionTexture_uColor);
-    
-    //
-    // Position Texture A8 Color shader
-    //
-    p = programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR);
-    p->reset();
-    loadDefaultShader(p, kShaderType_PositionTextureA8Color);
-    
-    //
-    // Position and 1 color passed as a uniform (to simulate glColor4ub )
-    //
-    p = programForKey(GLProgram::SHADER_NAME_POSITION_U_COLOR);
-    p->reset();
-    loadDefaultShader(p, kShaderType_Position_uColor);
-    
-    //
-	// Position, Legth(TexCoords, Color (used by Draw Node basically )
-	//
-    p = programForKey(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR);
-    p->reset();
-    loadDefaultShader(p, kShaderType_PositionLengthTexureColor);
+    // reset the programs that were used and reload them, the others are still loaded when they are first used
+    for (int type = 0; type < kShaderType_MAX; ++type)
+    {
+        GLProgram *p = static_cast<GLProgram*>(_programs->objectForKey(getDefaultShaderName(type)));
+        if (p)
+        {
+            p->reset();
+            loadDefaultShader(p, type);
+        }
+    }
+
+    for (unsigned int variant = 0; variant < VARIANT_COUNT; ++variant)
+    {
+        GLProgram *p = static_cast<GLProgram*>(_programs->objectForKey(getVariantName(variant)));
+        if (p && ! isDefaultVariant(variant))
+        {
+            p->reset();
+            loadVariant(p, variant);
+        }
+    }
 }
 
 void ShaderCache::loadDefaultShader(GLProgram *p, int type)
 {
+    // the linked programs are cached in the writable path, see CC_ENABLE_PROGRAM_BINARY_CACHE
+    p->setBinaryCacheName(getDefaultShaderName(type));
+
     switch (type) {
         case kShaderType_PositionTextureColor:
             p->initWithVertexShaderByteArray(ccPositionTextureColor_vert, ccPositionTextureColor_frag);
@@ -240,6 +229,14 @@ void ShaderCache::loadDefaultShader(GLProgram *p, int type)
             p->addAttribute(GLProgram::ATTRIBUTE_NAME_COLOR, GLProgram::VERTEX_ATTRIB_COLOR);
             p->addAttribute(GLProgram::ATTRIBUTE_NAME_TEX_COORD, GLProgram::VERTEX_ATTRIB_TEX_COORDS);
 
+            break;
+        case kShaderType_PositionTextureColorAlphaTexture:
+            p->initWithVertexShaderByteArray(ccPositionTextureColor_vert, ccPositionTextureColorAlphaTexture_frag);
+
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_POSITION, GLProgram::VERTEX_ATTRIB_POSITION);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_COLOR, GLProgram::VERTEX_ATTRIB_COLOR);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_TEX_COORD, GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+
             break;
         case kShaderType_PositionColor:  
             p->initWithVertexShaderByteArray(ccPositionColor_vert ,ccPositionColor_frag);
@@ -269,6 +266,59 @@ void ShaderCache::loadDefaultShader(GLProgram *p, int type)
             p->addAttribute(GLProgram::ATTRIBUTE_NAME_COLOR, GLProgram::VERTEX_ATTRIB_COLOR);
             p->addAttribute(GLProgram::ATTRIBUTE_NAME_TEX_COORD, GLProgram::VERTEX_ATTRIB_TEX_COORDS);
 
+            break;
+        case kShaderType_LabelDistanceField:
+            p->initWithVertexShaderByteArray(ccPositionTextureA8Color_vert, ccLabelDistanceField_frag);
+
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_POSITION, GLProgram::VERTEX_ATTRIB_POSITION);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_COLOR, GLProgram::VERTEX_ATTRIB_COLOR);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_TEX_COORD, GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+
+            break;
+        case kShaderType_LabelDistanceFieldEffect:
+            p->initWithVertexShaderByteArray(ccPositionTextureA8Color_vert, ccLabelDistanceFieldEffect_frag);
+
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_POSITION, GLProgram::VERTEX_ATTRIB_POSITION);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_COLOR, GLProgram::VERTEX_ATTRIB_COLOR);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_TEX_COORD, GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+
+            break;
+        case kShaderType_ParticleGPU:
+            p->initWithVertexShaderByteArray(ccParticleGPU_vert, ccPositionTextureColor_frag);
+
+            // the two last attributes use the indices after the ones of GLProgram
+            p->addAttribute("a_spawn", GLProgram::VERTEX_ATTRIB_POSITION);
+            p->addAttribute("a_startColor", GLProgram::VERTEX_ATTRIB_COLOR);
+            p->addAttribute("a_endColor", GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+            p->addAttribute("a_motion", GLProgram::VERTEX_ATTRIB_MAX);
+            p->addAttribute("a_size", GLProgram::VERTEX_ATTRIB_MAX + 1);
+
+            break;
+        case kShaderType_MotionStreak:
+            p->initWithVertexShaderByteArray(ccMotionStreak_vert, ccPositionTextureColor_frag);
+
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_POSITION, GLProgram::VERTEX_ATTRIB_POSITION);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_COLOR, GLProgram::VERTEX_ATTRIB_COLOR);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_TEX_COORD, GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+
+            break;
+        case kShaderType_GridEffect:
+            p->initWithVertexShaderByteArray(ccGridEffect_vert, ccPositionTexture_frag);
+
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_POSITION, GLProgram::VERTEX_ATTRIB_POSITION);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_TEX_COORD, GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+
+            break;
+        case kShaderType_InstancedSprite:
+            p->initWithVertexShaderByteArray(ccInstancedSprite_vert, ccPositionTextureColor_frag);
+
+            // the two last attributes use the indices after the ones of GLProgram
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_POSITION, GLProgram::VERTEX_ATTRIB_POSITION);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_COLOR, GLProgram::VERTEX_ATTRIB_COLOR);
+            p->addAttribute(GLProgram::ATTRIBUTE_NAME_TEX_COORD, GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+            p->addAttribute("a_transformX", GLProgram::VERTEX_ATTRIB_MAX);
+            p->addAttribute("a_transformY", GLProgram::VERTEX_ATTRIB_MAX + 1);
+
             break;
         case kShaderType_Position_uColor:
             p->initWithVertexShaderByteArray(ccPosition_uColor_vert, ccPosition_uColor_frag);    
@@ -295,14 +345,174 @@ void ShaderCache::loadDefaultShader(GLProgram *p, int type)
     CHECK_GL_ERROR_DEBUG();
 }
 
+void ShaderCache::loadVariant(GLProgram *p, unsigned int variant)
+{
+    std::string name = getVariantName(variant);
+    p->setBinaryCacheName(name.c_str());
+
+    std::string defines;
+    for (unsigned int i = 0; (1u << i) < VARIANT_COUNT; ++i)
+    {
+        if (variant & (1u << i))
+        {
+            defines += s_variantDefines[i];
+        }
+    }
+    std::string vert = defines + ccPositionTextureColorVariant_vert;
+    std::string frag = defines + ccPositionTextureColorVariant_frag;
+    p->initWithVertexShaderByteArray(vert.c_str(), frag.c_str());
+
+    p->addAttribute(GLProgram::ATTRIBUTE_NAME_POSITION, GLProgram::VERTEX_ATTRIB_POSITION);
+    p->addAttribute(GLProgram::ATTRIBUTE_NAME_COLOR, GLProgram::VERTEX_ATTRIB_COLOR);
+    p->addAttribute(GLProgram::ATTRIBUTE_NAME_TEX_COORD, GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+
+    p->link();
+    p->updateUniforms();
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
 GLProgram* ShaderCache::programForKey(const char* key)
 {
-    return static_cast<GLProgram*>(_programs->objectForKey(key));
+    GLProgram *p = static_cast<GLProgram*>(_programs->objectForKey(key));
+    if (p || ! key)
+    {
+        return p;
+    }
+
+    // a default shader is loaded when it is first used
+    for (int type = 0; type < kShaderType_MAX; ++type)
+    {
+        if (strcmp(key, getDefaultShaderName(type)) == 0)
+        {
+            p = new GLProgram();
+            loadDefaultShader(p, type);
+
+            _programs->setObject(p, key);
+            p->release();
+            break;
+        }
+    }
+    return p;
 }
 
 void ShaderCache::addProgram(GLProgram* program, const char* key)
 {
     _programs->setObject(program, key);
+
+    // the program may replace a variant
+    memset(_variants, 0, sizeof(_variants));
+}
+
+GLProgram* ShaderCache::programForTexture(GLProgram* program, Texture2D* texture)
+{
+    GLProgram* defaultProgram = programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);
+
+    // the program for alpha textures isn't loaded until a texture needs it
+    bool hasAlphaTexture = texture && texture->getAlphaTexture();
+    if (hasAlphaTexture && program == defaultProgram)
+    {
+        return programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_ALPHA_TEXTURE);
+    }
+    if (! hasAlphaTexture && program == _programs->objectForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_ALPHA_TEXTURE))
+    {
+        return defaultProgram;
+    }
+    return program;
+}
+
+GLProgram* ShaderCache::programForVariant(unsigned int variant)
+{
+    CCASSERT(variant < VARIANT_COUNT, "unknown shader variant");
+
+    // the vertex color is either white or the premultiplied opacity
+    if (variant & VARIANT_NO_VERTEX_COLOR)
+    {
+        variant &= ~VARIANT_PREMULTIPLIED;
+    }
+
+    GLProgram* p = _variants[variant];
+    if (p)
+    {
+        return p;
+    }
+
+    switch (variant)
+    {
+        case 0:
+            p = programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);
+            break;
+        case VARIANT_ALPHA_TEST:
+            p = programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST);
+            break;
+        case VARIANT_A8:
+            p = programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR);
+            break;
+        default:
+        {
+            std::string name = getVariantName(variant);
+            p = static_cast<GLProgram*>(_programs->objectForKey(name));
+            if (! p)
+            {
+                p = new GLProgram();
+                loadVariant(p, variant);
+
+                _programs->setObject(p, name);
+                p->release();
+            }
+            break;
+        }
+    }
+
+    _variants[variant] = p;
+    return p;
+}
+
+GLProgram* ShaderCache::programForQuads(GLProgram* program, Texture2D* texture, const BlendFunc& blendFunc, const Color4B* color)
+{
+#if CC_USE_SHADER_VARIANTS
+    if (texture && texture->getAlphaTexture())
+    {
+        return programForTexture(program, texture);
+    }
+
+    // only the default program and the variants of the vertex color and the blending are replaced
+    if (program != programForVariant(0))
+    {
+        const unsigned int replaced = VARIANT_NO_VERTEX_COLOR | VARIANT_PREMULTIPLIED | VARIANT_OPAQUE;
+        unsigned int variant = 1;
+        while (variant <= replaced && _variants[variant] != program)
+        {
+            ++variant;
+        }
+        if (variant > replaced)
+        {
+            return program;
+        }
+    }
+
+    unsigned int variant = 0;
+    if (color)
+    {
+        if (color->r == 255 && color->g == 255 && color->b == 255 && color->a == 255)
+        {
+            variant |= VARIANT_NO_VERTEX_COLOR;
+        }
+        else if (texture && texture->hasPremultipliedAlpha() && color->r == color->a && color->g == color->a && color->b == color->a)
+        {
+            variant |= VARIANT_PREMULTIPLIED;
+        }
+    }
+    if (blendFunc.src == GL_ONE && blendFunc.dst == GL_ZERO)
+    {
+        variant |= VARIANT_OPAQUE;
+    }
+    return programForVariant(variant);
+#else
+    CC_UNUSED_PARAM(blendFunc);
+    CC_UNUSED_PARAM(color);
+    return programForTexture(program, texture);
+#endif // CC_USE_SHADER_VARIANTS
 }
 
 NS_CC_END
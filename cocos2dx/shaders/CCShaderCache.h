@@ -28,10 +28,12 @@ THE SOFTWARE.
 #define __CCSHADERCACHE_H__
 
 #include "cocoa/CCDictionary.h"
+#include "ccTypes.h"
 
 NS_CC_BEGIN
 
 class GLProgram;
+class Texture2D;
 
 /**
  * @addtogroup shaders
@@ -45,6 +47,27 @@ class GLProgram;
 class CC_DLL ShaderCache : public Object 
 {
 public:
+    /** Features of the variants of the textured quad program, SHADER_NAME_POSITION_TEXTURE_COLOR, combined in a
+     mask. Each variant is compiled from the same sources with the defines of its features, so that its fragment
+     shader only does what is needed.
+     @since v3.0
+     */
+    enum
+    {
+        /// the vertex color is opaque white: the texture color is drawn as is
+        VARIANT_NO_VERTEX_COLOR = 1 << 0,
+        /// the vertex color is the premultiplied opacity (a, a, a, a): only its alpha is interpolated. Ignored with VARIANT_NO_VERTEX_COLOR
+        VARIANT_PREMULTIPLIED = 1 << 1,
+        /// the quads are drawn without blending: the alpha isn't computed, it is 1
+        VARIANT_OPAQUE = 1 << 2,
+        /// the fragments whose texture alpha is less than or equal to the CC_alpha_value uniform are discarded
+        VARIANT_ALPHA_TEST = 1 << 3,
+        /// the texture is A8: it only gives the alpha, the color is the vertex color
+        VARIANT_A8 = 1 << 4,
+
+        VARIANT_COUNT = 1 << 5,
+    };
+
     ShaderCache();
 
     virtual ~ShaderCache();
@@ -61,23 +84,56 @@ public:
     /** @deprecated Use destroyInstance() instead */
     CC_DEPRECATED_ATTRIBUTE static void purgeSharedShaderCache();
 
-    /** loads the default shaders */
+    /** loads the default shaders.
+     It isn't needed: the default shaders are loaded when they are first requested by programForKey().
+     */
     void loadDefaultShaders();
     
-    /** reload the default shaders */
+    /** reload the default shaders that were loaded */
     void reloadDefaultShaders();
 
-    /** returns a GL program for a given key */
+    /** returns a GL program for a given key. The default shaders are loaded the first time they are requested */
     GLProgram * programForKey(const char* key);
 
     /** adds a GLProgram to the cache for a given name */
     void addProgram(GLProgram* program, const char* key);
 
+    /** returns the GL program to draw a texture with, given the current one.
+     Textures with an alpha texture (ETC1) need SHADER_NAME_POSITION_TEXTURE_COLOR_ALPHA_TEXTURE instead of
+     SHADER_NAME_POSITION_TEXTURE_COLOR, and vice versa. Custom programs are returned as is.
+     @since v3.0
+     */
+    GLProgram* programForTexture(GLProgram* program, Texture2D* texture);
+
+    /** returns the variant of the textured quad program with the given features, see VARIANT_NO_VERTEX_COLOR.
+     The variant without any feature is SHADER_NAME_POSITION_TEXTURE_COLOR, the one with VARIANT_ALPHA_TEST only is
+     SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST, and the one with VARIANT_A8 only is SHADER_NAME_POSITION_TEXTURE_A8_COLOR.
+     The other ones are compiled when they are first requested.
+     @since v3.0
+     */
+    GLProgram* programForVariant(unsigned int variant);
+
+    /** returns the cheapest program to draw quads with, given the current one: the variant of the textured quad
+     program without the vertex color when it is opaque white, with the premultiplied opacity only when the texture
+     is premultiplied and the color is white, and without the alpha when the blending is disabled.
+     Only SHADER_NAME_POSITION_TEXTURE_COLOR and the variants returned by this method are replaced, other programs,
+     including the alpha test ones that have their own CC_alpha_value, are returned as is. Textures with an alpha
+     texture use programForTexture().
+     Variants split the batches of the Renderer: the quads of a texture are only batched with the quads drawn with
+     the same variant. It can be disabled with CC_USE_SHADER_VARIANTS.
+     @param color the color of all the vertices, NULL when they have different colors
+     @since v3.0
+     */
+    GLProgram* programForQuads(GLProgram* program, Texture2D* texture, const BlendFunc& blendFunc, const Color4B* color);
+
 private:
     bool init();
     void loadDefaultShader(GLProgram *program, int type);
+    void loadVariant(GLProgram *program, unsigned int variant);
 
     Dictionary* _programs;
+    // the variants that were requested, weak references. Cleared when a program is added
+    GLProgram* _variants[VARIANT_COUNT];
 
 };
 
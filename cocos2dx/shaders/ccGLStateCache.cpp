@@ -40,6 +40,16 @@ static bool        s_bVertexAttribPosition = false;
 static bool        s_bVertexAttribColor = false;
 static bool        s_bVertexAttribTexCoords = false;
 
+// the binds of programs, textures, blending functions and buffers that reached GL
+static unsigned int s_uStateChanges = 0;
+#define CC_GL_STATE_CHANGED() (++s_uStateChanges)
+
+#if COCOS2D_DEBUG > 0
+static unsigned int s_uSkippedStateChanges = 0;
+#define CC_GL_STATE_SKIPPED() (++s_uSkippedStateChanges)
+#else
+#define CC_GL_STATE_SKIPPED()
+#endif
 
 #if CC_ENABLE_GL_STATE_CACHE
 
@@ -53,6 +63,51 @@ static int       s_eGLServerState = 0;
 #if CC_TEXTURE_ATLAS_USE_VAO
 static GLuint    s_uVAO = 0;
 #endif
+
+// capabilities toggled by the engine, -1 when their state is unknown
+enum {
+    kCapabilityDepthTest,
+    kCapabilityStencilTest,
+    kCapabilityScissorTest,
+    kCapabilityBlend,
+    kCapabilityCullFace,
+    kCapabilityMax,
+};
+static int       s_eCapabilities[kCapabilityMax] = { -1, -1, -1, -1, -1 };
+
+static bool      s_bScissorBoxKnown = false;
+static GLint     s_aScissorBox[4] = { 0, 0, 0, 0 };
+static int       s_eDepthMask = -1;
+static bool      s_bStencilFuncKnown = false;
+static GLenum    s_eStencilFunc = GL_ALWAYS;
+static GLint     s_iStencilRef = 0;
+static GLuint    s_uStencilValueMask = ~0u;
+static bool      s_bStencilOpKnown = false;
+static GLenum    s_aStencilOp[3] = { GL_KEEP, GL_KEEP, GL_KEEP };
+static bool      s_bStencilWriteMaskKnown = false;
+static GLuint    s_uStencilWriteMask = ~0u;
+static GLuint    s_uFramebuffer = -1;
+static GLuint    s_uArrayBuffer = -1;
+static GLuint    s_uElementArrayBuffer = -1;
+
+static int capabilityIndex(GLenum capability)
+{
+    switch (capability)
+    {
+        case GL_DEPTH_TEST:
+            return kCapabilityDepthTest;
+        case GL_STENCIL_TEST:
+            return kCapabilityStencilTest;
+        case GL_SCISSOR_TEST:
+            return kCapabilityScissorTest;
+        case GL_BLEND:
+            return kCapabilityBlend;
+        case GL_CULL_FACE:
+            return kCapabilityCullFace;
+        default:
+            return -1;
+    }
+}
 #endif // CC_ENABLE_GL_STATE_CACHE
 
 // GL State Cache functions
@@ -81,6 +136,19 @@ void invalidateStateCache( void )
 #if CC_TEXTURE_ATLAS_USE_VAO
     s_uVAO = 0;
 #endif
+
+    for (int i = 0; i < kCapabilityMax; i++)
+    {
+        s_eCapabilities[i] = -1;
+    }
+    s_bScissorBoxKnown = false;
+    s_eDepthMask = -1;
+    s_bStencilFuncKnown = false;
+    s_bStencilOpKnown = false;
+    s_bStencilWriteMaskKnown = false;
+    s_uFramebuffer = -1;
+    s_uArrayBuffer = -1;
+    s_uElementArrayBuffer = -1;
     
 #endif // CC_ENABLE_GL_STATE_CACHE
 }
@@ -103,9 +171,15 @@ void useProgram( GLuint program )
     if( program != s_uCurrentShaderProgram ) {
         s_uCurrentShaderProgram = program;
         glUseProgram(program);
+        CC_GL_STATE_CHANGED();
+    }
+    else
+    {
+        CC_GL_STATE_SKIPPED();
     }
 #else
     glUseProgram(program);
+    CC_GL_STATE_CHANGED();
 #endif // CC_ENABLE_GL_STATE_CACHE
 }
 
@@ -113,13 +187,14 @@ static void SetBlending(GLenum sfactor, GLenum dfactor)
 {
 	if (sfactor == GL_ONE && dfactor == GL_ZERO)
     {
-		glDisable(GL_BLEND);
+		GL::disable(GL_BLEND);
 	}
     else
     {
-		glEnable(GL_BLEND);
+		GL::enable(GL_BLEND);
 		glBlendFunc(sfactor, dfactor);
 	}
+    CC_GL_STATE_CHANGED();
 }
 
 void blendFunc(GLenum sfactor, GLenum dfactor)
@@ -131,6 +206,10 @@ void blendFunc(GLenum sfactor, GLenum dfactor)
         s_eBlendingDest = dfactor;
         SetBlending(sfactor, dfactor);
     }
+    else
+    {
+        CC_GL_STATE_SKIPPED();
+    }
 #else
     SetBlending( sfactor, dfactor );
 #endif // CC_ENABLE_GL_STATE_CACHE
@@ -160,10 +239,16 @@ void bindTexture2DN(GLuint textureUnit, GLuint textureId)
         s_uCurrentBoundTexture[textureUnit] = textureId;
         glActiveTexture(GL_TEXTURE0 + textureUnit);
         glBindTexture(GL_TEXTURE_2D, textureId);
+        CC_GL_STATE_CHANGED();
+    }
+    else
+    {
+        CC_GL_STATE_SKIPPED();
     }
 #else
     glActiveTexture(GL_TEXTURE0 + textureUnit);
     glBindTexture(GL_TEXTURE_2D, textureId);
+    CC_GL_STATE_CHANGED();
 #endif
 }
 
@@ -194,9 +279,18 @@ void bindVAO(GLuint vaoId)
 	{
 		s_uVAO = vaoId;
 		glBindVertexArray(vaoId);
+        CC_GL_STATE_CHANGED();
+
+        // the element array buffer is bound to the vertex array
+        s_uElementArrayBuffer = -1;
 	}
+    else
+    {
+        CC_GL_STATE_SKIPPED();
+    }
 #else
 	glBindVertexArray(vaoId);
+    CC_GL_STATE_CHANGED();
 #endif // CC_ENABLE_GL_STATE_CACHE
     
 #endif
@@ -252,6 +346,328 @@ void setProjectionMatrixDirty( void )
     s_uCurrentProjectionMatrix = -1;
 }
 
+//#pragma mark - GL server-side capabilities functions
+
+void enable(GLenum capability)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    int index = capabilityIndex(capability);
+    if (index >= 0 && s_eCapabilities[index] == 1)
+    {
+        CC_GL_STATE_SKIPPED();
+        return;
+    }
+    if (index >= 0)
+    {
+        s_eCapabilities[index] = 1;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glEnable(capability);
+}
+
+void disable(GLenum capability)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    int index = capabilityIndex(capability);
+    if (index >= 0 && s_eCapabilities[index] == 0)
+    {
+        CC_GL_STATE_SKIPPED();
+        return;
+    }
+    if (index >= 0)
+    {
+        s_eCapabilities[index] = 0;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glDisable(capability);
+}
+
+bool isEnabled(GLenum capability)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    int index = capabilityIndex(capability);
+    if (index >= 0)
+    {
+        if (s_eCapabilities[index] < 0)
+        {
+            s_eCapabilities[index] = glIsEnabled(capability) ? 1 : 0;
+        }
+        return s_eCapabilities[index] == 1;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+    return glIsEnabled(capability) == GL_TRUE;
+}
+
+//#pragma mark - GL scissor, depth and stencil functions
+
+void scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_bScissorBoxKnown &&
+        s_aScissorBox[0] == x && s_aScissorBox[1] == y && s_aScissorBox[2] == width && s_aScissorBox[3] == height)
+    {
+        CC_GL_STATE_SKIPPED();
+        return;
+    }
+    s_aScissorBox[0] = x;
+    s_aScissorBox[1] = y;
+    s_aScissorBox[2] = width;
+    s_aScissorBox[3] = height;
+    s_bScissorBoxKnown = true;
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glScissor(x, y, width, height);
+}
+
+void getScissorBox(GLint *box)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (! s_bScissorBoxKnown)
+    {
+        glGetIntegerv(GL_SCISSOR_BOX, s_aScissorBox);
+        s_bScissorBoxKnown = true;
+    }
+    memcpy(box, s_aScissorBox, sizeof(s_aScissorBox));
+#else
+    glGetIntegerv(GL_SCISSOR_BOX, box);
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+void depthMask(GLboolean flag)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    int value = flag ? 1 : 0;
+    if (s_eDepthMask == value)
+    {
+        CC_GL_STATE_SKIPPED();
+        return;
+    }
+    s_eDepthMask = value;
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glDepthMask(flag);
+}
+
+GLboolean getDepthMask(void)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_eDepthMask < 0)
+    {
+        GLboolean flag = GL_TRUE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &flag);
+        s_eDepthMask = flag ? 1 : 0;
+    }
+    return s_eDepthMask ? GL_TRUE : GL_FALSE;
+#else
+    GLboolean flag = GL_TRUE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &flag);
+    return flag;
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+void stencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_bStencilFuncKnown && s_eStencilFunc == func && s_iStencilRef == ref && s_uStencilValueMask == mask)
+    {
+        CC_GL_STATE_SKIPPED();
+        return;
+    }
+    s_eStencilFunc = func;
+    s_iStencilRef = ref;
+    s_uStencilValueMask = mask;
+    s_bStencilFuncKnown = true;
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glStencilFunc(func, ref, mask);
+}
+
+void getStencilFunc(GLenum *func, GLint *ref, GLuint *mask)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (! s_bStencilFuncKnown)
+    {
+        glGetIntegerv(GL_STENCIL_FUNC, (GLint *)&s_eStencilFunc);
+        glGetIntegerv(GL_STENCIL_REF, &s_iStencilRef);
+        glGetIntegerv(GL_STENCIL_VALUE_MASK, (GLint *)&s_uStencilValueMask);
+        s_bStencilFuncKnown = true;
+    }
+    *func = s_eStencilFunc;
+    *ref = s_iStencilRef;
+    *mask = s_uStencilValueMask;
+#else
+    glGetIntegerv(GL_STENCIL_FUNC, (GLint *)func);
+    glGetIntegerv(GL_STENCIL_REF, ref);
+    glGetIntegerv(GL_STENCIL_VALUE_MASK, (GLint *)mask);
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+void stencilOp(GLenum fail, GLenum zfail, GLenum zpass)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_bStencilOpKnown && s_aStencilOp[0] == fail && s_aStencilOp[1] == zfail && s_aStencilOp[2] == zpass)
+    {
+        CC_GL_STATE_SKIPPED();
+        return;
+    }
+    s_aStencilOp[0] = fail;
+    s_aStencilOp[1] = zfail;
+    s_aStencilOp[2] = zpass;
+    s_bStencilOpKnown = true;
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glStencilOp(fail, zfail, zpass);
+}
+
+void getStencilOp(GLenum *fail, GLenum *zfail, GLenum *zpass)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (! s_bStencilOpKnown)
+    {
+        glGetIntegerv(GL_STENCIL_FAIL, (GLint *)&s_aStencilOp[0]);
+        glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, (GLint *)&s_aStencilOp[1]);
+        glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, (GLint *)&s_aStencilOp[2]);
+        s_bStencilOpKnown = true;
+    }
+    *fail = s_aStencilOp[0];
+    *zfail = s_aStencilOp[1];
+    *zpass = s_aStencilOp[2];
+#else
+    glGetIntegerv(GL_STENCIL_FAIL, (GLint *)fail);
+    glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, (GLint *)zfail);
+    glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, (GLint *)zpass);
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+void stencilMask(GLuint mask)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_bStencilWriteMaskKnown && s_uStencilWriteMask == mask)
+    {
+        CC_GL_STATE_SKIPPED();
+        return;
+    }
+    s_uStencilWriteMask = mask;
+    s_bStencilWriteMaskKnown = true;
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glStencilMask(mask);
+}
+
+GLuint getStencilMask(void)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (! s_bStencilWriteMaskKnown)
+    {
+        glGetIntegerv(GL_STENCIL_WRITEMASK, (GLint *)&s_uStencilWriteMask);
+        s_bStencilWriteMaskKnown = true;
+    }
+    return s_uStencilWriteMask;
+#else
+    GLuint mask = ~0u;
+    glGetIntegerv(GL_STENCIL_WRITEMASK, (GLint *)&mask);
+    return mask;
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+//#pragma mark - GL framebuffer and buffer functions
+
+void bindFramebuffer(GLuint framebuffer)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_uFramebuffer == framebuffer)
+    {
+        CC_GL_STATE_SKIPPED();
+        return;
+    }
+    s_uFramebuffer = framebuffer;
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+GLuint getBoundFramebuffer(void)
+{
+    GLint framebuffer = 0;
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_uFramebuffer != (GLuint)-1)
+    {
+        return s_uFramebuffer;
+    }
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    s_uFramebuffer = framebuffer;
+#else
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+#endif // CC_ENABLE_GL_STATE_CACHE
+    return framebuffer;
+}
+
+void deleteFramebuffer(GLuint framebuffer)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    // the default framebuffer is bound instead
+    if (s_uFramebuffer == framebuffer)
+    {
+        s_uFramebuffer = -1;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+void bindBuffer(GLenum target, GLuint buffer)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    GLuint *current = NULL;
+    if (target == GL_ARRAY_BUFFER)
+    {
+        current = &s_uArrayBuffer;
+    }
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        current = &s_uElementArrayBuffer;
+    }
+
+    if (current)
+    {
+        if (*current == buffer)
+        {
+            CC_GL_STATE_SKIPPED();
+            return;
+        }
+        *current = buffer;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glBindBuffer(target, buffer);
+    CC_GL_STATE_CHANGED();
+}
+
+void deleteBuffers(GLsizei n, const GLuint *buffers)
+{
+#if CC_ENABLE_GL_STATE_CACHE
+    // the deleted buffers are unbound, and their names can be reused
+    for (GLsizei i = 0; i < n; i++)
+    {
+        if (buffers[i] == s_uArrayBuffer)
+        {
+            s_uArrayBuffer = 0;
+        }
+        if (buffers[i] == s_uElementArrayBuffer)
+        {
+            s_uElementArrayBuffer = -1;
+        }
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+    glDeleteBuffers(n, buffers);
+}
+
+unsigned int getStateChanges(void)
+{
+    return s_uStateChanges;
+}
+
+unsigned int getSkippedStateChanges(void)
+{
+#if COCOS2D_DEBUG > 0
+    return s_uSkippedStateChanges;
+#else
+    return 0;
+#endif
+}
+
 } // Namespace GL
 
 NS_CC_END
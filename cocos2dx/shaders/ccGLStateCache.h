@@ -134,6 +134,119 @@ void CC_DLL deleteTextureN(GLuint textureUnit, GLuint textureId);
  */
 void CC_DLL bindVAO(GLuint vaoId);
 
+/** Enables a server-side capability in case it is not already enabled.
+ The depth, stencil and scissor tests, blending and face culling are cached, the other capabilities are always enabled.
+ If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glEnable() directly.
+ @since v3.0
+ */
+void CC_DLL enable(GLenum capability);
+
+/** Disables a server-side capability in case it is not already disabled.
+ If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDisable() directly.
+ @since v3.0
+ */
+void CC_DLL disable(GLenum capability);
+
+/** Returns whether a capability is enabled, without asking the driver if the capability is cached.
+ @since v3.0
+ */
+bool CC_DLL isEnabled(GLenum capability);
+
+/** Sets the scissor box in case it is different than the current one.
+ If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glScissor() directly.
+ @since v3.0
+ */
+void CC_DLL scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+/** Returns the scissor box (x, y, width, height), without asking the driver if it is cached.
+ @since v3.0
+ */
+void CC_DLL getScissorBox(GLint *box);
+
+/** Sets the depth write mask in case it is different than the current one.
+ If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDepthMask() directly.
+ @since v3.0
+ */
+void CC_DLL depthMask(GLboolean flag);
+
+/** Returns the depth write mask, without asking the driver if it is cached.
+ @since v3.0
+ */
+GLboolean CC_DLL getDepthMask(void);
+
+/** Sets the stencil test function in case it is different than the current one.
+ If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glStencilFunc() directly.
+ @since v3.0
+ */
+void CC_DLL stencilFunc(GLenum func, GLint ref, GLuint mask);
+
+/** Returns the stencil test function, without asking the driver if it is cached.
+ @since v3.0
+ */
+void CC_DLL getStencilFunc(GLenum *func, GLint *ref, GLuint *mask);
+
+/** Sets the stencil operations in case they are different than the current ones.
+ If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glStencilOp() directly.
+ @since v3.0
+ */
+void CC_DLL stencilOp(GLenum fail, GLenum zfail, GLenum zpass);
+
+/** Returns the stencil operations, without asking the driver if they are cached.
+ @since v3.0
+ */
+void CC_DLL getStencilOp(GLenum *fail, GLenum *zfail, GLenum *zpass);
+
+/** Sets the stencil write mask in case it is different than the current one.
+ If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glStencilMask() directly.
+ @since v3.0
+ */
+void CC_DLL stencilMask(GLuint mask);
+
+/** Returns the stencil write mask, without asking the driver if it is cached.
+ @since v3.0
+ */
+GLuint CC_DLL getStencilMask(void);
+
+/** Binds a framebuffer to GL_FRAMEBUFFER in case it is not already bound.
+ If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glBindFramebuffer() directly.
+ @since v3.0
+ */
+void CC_DLL bindFramebuffer(GLuint framebuffer);
+
+/** Returns the framebuffer bound to GL_FRAMEBUFFER, without asking the driver if it is cached.
+ @since v3.0
+ */
+GLuint CC_DLL getBoundFramebuffer(void);
+
+/** Deletes a framebuffer. If it was bound, it invalidates the cache.
+ @since v3.0
+ */
+void CC_DLL deleteFramebuffer(GLuint framebuffer);
+
+/** Binds a buffer to GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER in case it is not already bound.
+ The binding of GL_ELEMENT_ARRAY_BUFFER belongs to the vertex array, so it is invalidated by bindVAO().
+ If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glBindBuffer() directly.
+ @since v3.0
+ */
+void CC_DLL bindBuffer(GLenum target, GLuint buffer);
+
+/** Deletes buffers. If they were bound, it invalidates the cache.
+ @since v3.0
+ */
+void CC_DLL deleteBuffers(GLsizei n, const GLuint *buffers);
+
+/** Returns the number of binds of programs, textures, blending functions, vertex arrays and buffers made
+ since the application started. The Director's stats show it per frame.
+ @since v3.0
+ */
+unsigned int CC_DLL getStateChanges(void);
+
+/** Returns the number of GL calls that were skipped because they wouldn't have changed the state.
+ It is only counted when COCOS2D_DEBUG > 0.
+ @since v3.0
+ */
+unsigned int CC_DLL getSkippedStateChanges(void);
+
 // end of shaders group
 /// @}
 
@@ -0,0 +1,102 @@
+/*
+ * cocos2d-x   http://www.cocos2d-x.org
+ *
+ * Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"																		\n\
+attribute vec4 a_position;												\n\
+attribute vec2 a_texCoord;												\n\
+																		\n\
+// x: effect (0: Waves3D, 1: Ripple3D, 2: Shaky3D, 3: Liquid, 4: Waves)	\n\
+// y: phase of the waves, z: amplitude, w: effect parameter				\n\
+// Ripple3D: radius, Shaky3D: random seed								\n\
+uniform vec4 u_effect[2];												\n\
+// u_effect[1]:															\n\
+// Ripple3D: position x, position y										\n\
+// Shaky3D: range, 1 to shake z											\n\
+// Liquid: width and height of the grid, width and height of a cell		\n\
+// Waves: 1 for vertical waves, 1 for horizontal waves					\n\
+																		\n\
+#ifdef GL_ES															\n\
+varying mediump vec2 v_texCoord;										\n\
+#else																	\n\
+varying vec2 v_texCoord;												\n\
+#endif																	\n\
+																		\n\
+float random(vec2 seed)													\n\
+{																		\n\
+	return fract(sin(dot(seed, vec2(12.9898, 78.233))) * 43758.5453);	\n\
+}																		\n\
+																		\n\
+void main()																\n\
+{																		\n\
+	vec4 position = a_position;											\n\
+	float effect = u_effect[0].x;										\n\
+	float phase = u_effect[0].y;										\n\
+	float amplitude = u_effect[0].z;									\n\
+	vec4 params = u_effect[1];											\n\
+																		\n\
+	if (effect < 0.5)													\n\
+	{																	\n\
+		position.z += sin(phase + (position.x + position.y) * 0.01) * amplitude;	\n\
+	}																	\n\
+	else if (effect < 1.5)												\n\
+	{																	\n\
+		float radius = u_effect[0].w;									\n\
+		float r = length(params.xy - position.xy);						\n\
+		if (r < radius)													\n\
+		{																\n\
+			r = radius - r;												\n\
+			float rate = (r / radius) * (r / radius);					\n\
+			position.z += sin(phase + r * 0.1) * amplitude * rate;		\n\
+		}																\n\
+	}																	\n\
+	else if (effect < 2.5)												\n\
+	{																	\n\
+		// integers in [-range, range), as rand() % (range * 2) - range	\n\
+		vec2 seed = position.xy + u_effect[0].w;						\n\
+		float range = params.x;											\n\
+		position.x += floor(random(seed) * range * 2.0) - range;		\n\
+		position.y += floor(random(seed + 1.0) * range * 2.0) - range;	\n\
+		position.z += params.y * (floor(random(seed + 2.0) * range * 2.0) - range);	\n\
+	}																	\n\
+	else if (effect < 3.5)												\n\
+	{																	\n\
+		// the vertices of the border don't move						\n\
+		vec2 margin = params.zw * 0.5;									\n\
+		if (all(greaterThan(position.xy, margin)) && all(lessThan(position.xy, params.xy - margin)))	\n\
+		{																\n\
+			position.x += sin(phase + position.x * 0.01) * amplitude;	\n\
+			position.y += sin(phase + position.y * 0.01) * amplitude;	\n\
+		}																\n\
+	}																	\n\
+	else																\n\
+	{																	\n\
+		vec2 original = position.xy;									\n\
+		position.x += params.x * sin(phase + original.y * 0.01) * amplitude;	\n\
+		position.y += params.y * sin(phase + original.x * 0.01) * amplitude;	\n\
+	}																	\n\
+																		\n\
+	gl_Position = CC_MVPMatrix * position;								\n\
+	v_texCoord = a_texCoord;											\n\
+}																		\n\
+";
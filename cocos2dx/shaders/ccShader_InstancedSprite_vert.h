@@ -0,0 +1,50 @@
+/*
+ * cocos2d-x   http://www.cocos2d-x.org
+ *
+ * Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"																		\n\
+// corner of the unit quad												\n\
+attribute vec2 a_position;												\n\
+attribute vec4 a_color;													\n\
+// texture coordinates of the corners (0, 0) and (1, 1) of the unit quad	\n\
+attribute vec4 a_texCoord;												\n\
+// rows of the affine transform of the unit quad						\n\
+attribute vec3 a_transformX;											\n\
+attribute vec3 a_transformY;											\n\
+																		\n\
+#ifdef GL_ES															\n\
+varying lowp vec4 v_fragmentColor;										\n\
+varying mediump vec2 v_texCoord;										\n\
+#else																	\n\
+varying vec4 v_fragmentColor;											\n\
+varying vec2 v_texCoord;												\n\
+#endif																	\n\
+																		\n\
+void main()																\n\
+{																		\n\
+	vec3 corner = vec3(a_position, 1.0);								\n\
+	gl_Position = CC_MVPMatrix * vec4(dot(a_transformX, corner), dot(a_transformY, corner), 0.0, 1.0);	\n\
+	v_fragmentColor = a_color;											\n\
+	v_texCoord = mix(a_texCoord.xy, a_texCoord.zw, a_position);			\n\
+}																		\n\
+";
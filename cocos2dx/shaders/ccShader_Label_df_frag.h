@@ -0,0 +1,48 @@
+/*
+ * cocos2d-x   http://www.cocos2d-x.org
+ *
+ * Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"																\n\
+#ifdef GL_ES													\n\
+precision mediump float;										\n\
+#endif															\n\
+																\n\
+varying vec4 v_fragmentColor;									\n\
+varying vec2 v_texCoord;										\n\
+uniform sampler2D CC_Texture0;									\n\
+																\n\
+void main()														\n\
+{																\n\
+	// the texture stores the distance to the edge of the glyph: 0.5 on the edge, 1.0 inside	\n\
+	float dist = texture2D(CC_Texture0, v_texCoord).a;			\n\
+#ifdef GL_ES													\n\
+	float width = 0.04;											\n\
+#else															\n\
+	float width = fwidth(dist);									\n\
+#endif															\n\
+	float alpha = smoothstep(0.5 - width, 0.5 + width, dist);	\n\
+																\n\
+	gl_FragColor = vec4(v_fragmentColor.rgb, v_fragmentColor.a * alpha);	\n\
+}																\n\
+																\n\
+";
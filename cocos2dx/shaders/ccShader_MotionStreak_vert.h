@@ -0,0 +1,49 @@
+/*
+ * cocos2d-x   http://www.cocos2d-x.org
+ *
+ * Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"																		\n\
+attribute vec4 a_position;												\n\
+attribute vec4 a_color;													\n\
+// side of the streak (0 or 1), index of the point, time of the point	\n\
+attribute vec3 a_texCoord;												\n\
+																		\n\
+// time, index of the oldest point, number of points, 1 / fade time		\n\
+uniform vec4 u_streak;													\n\
+																		\n\
+#ifdef GL_ES															\n\
+varying lowp vec4 v_fragmentColor;										\n\
+varying mediump vec2 v_texCoord;										\n\
+#else																	\n\
+varying vec4 v_fragmentColor;											\n\
+varying vec2 v_texCoord;												\n\
+#endif																	\n\
+																		\n\
+void main()																\n\
+{																		\n\
+	gl_Position = CC_MVPMatrix * a_position;							\n\
+	float opacity = clamp(1.0 - (u_streak.x - a_texCoord.z) * u_streak.w, 0.0, 1.0);	\n\
+	v_fragmentColor = vec4(a_color.rgb, a_color.a * opacity);			\n\
+	v_texCoord = vec2(a_texCoord.x, (a_texCoord.y - u_streak.y) / u_streak.z);	\n\
+}																		\n\
+";
@@ -0,0 +1,97 @@
+/*
+ * cocos2d-x   http://www.cocos2d-x.org
+ *
+ * Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"																		\n\
+// corner x, corner y in [-0.5, 0.5], emission time, life				\n\
+attribute vec4 a_spawn;													\n\
+attribute vec4 a_startColor;											\n\
+attribute vec4 a_endColor;												\n\
+// gravity mode: position x, position y, direction x, direction y		\n\
+// radius mode: angle, radians per second, start radius, end radius		\n\
+attribute vec4 a_motion;												\n\
+// start size, end size, start rotation, end rotation (degrees)			\n\
+attribute vec4 a_size;													\n\
+																		\n\
+// time, period of the emission, end of the emission (-1: never), mode (0: gravity, 1: radius)	\n\
+uniform vec4 u_time;													\n\
+uniform vec2 u_gravity;													\n\
+// texture coordinates of the bottom left corner, and size				\n\
+uniform vec4 u_texRect;													\n\
+uniform float u_opacityModifyRGB;										\n\
+																		\n\
+#ifdef GL_ES															\n\
+varying lowp vec4 v_fragmentColor;										\n\
+varying mediump vec2 v_texCoord;										\n\
+#else																	\n\
+varying vec4 v_fragmentColor;											\n\
+varying vec2 v_texCoord;												\n\
+#endif																	\n\
+																		\n\
+void main()																\n\
+{																		\n\
+	// the particle is emitted again every period						\n\
+	float elapsed = u_time.x - a_spawn.z;								\n\
+	float cycle = floor(elapsed / u_time.y);							\n\
+	float age = elapsed - cycle * u_time.y;								\n\
+	float emission = a_spawn.z + cycle * u_time.y;						\n\
+																		\n\
+	if (elapsed < 0.0 || age >= a_spawn.w || (u_time.z >= 0.0 && emission > u_time.z))	\n\
+	{																	\n\
+		// not emitted, or dead: the quad is moved out of the screen	\n\
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);							\n\
+		v_fragmentColor = vec4(0.0);									\n\
+		v_texCoord = vec2(0.0);											\n\
+	}																	\n\
+	else																\n\
+	{																	\n\
+		float t = age / a_spawn.w;										\n\
+																		\n\
+		vec2 position;													\n\
+		if (u_time.w < 0.5)												\n\
+		{																\n\
+			position = a_motion.xy + a_motion.zw * age + 0.5 * u_gravity * age * age;	\n\
+		}																\n\
+		else															\n\
+		{																\n\
+			float angle = a_motion.x + a_motion.y * age;				\n\
+			float radius = mix(a_motion.z, a_motion.w, t);				\n\
+			position = -vec2(cos(angle), sin(angle)) * radius;			\n\
+		}																\n\
+																		\n\
+		float size = max(mix(a_size.x, a_size.y, t), 0.0);				\n\
+		float rotation = -radians(mix(a_size.z, a_size.w, t));			\n\
+		vec2 corner = a_spawn.xy * size;								\n\
+		float c = cos(rotation);										\n\
+		float s = sin(rotation);										\n\
+		position += vec2(corner.x * c - corner.y * s, corner.x * s + corner.y * c);	\n\
+																		\n\
+		gl_Position = CC_MVPMatrix * vec4(position, 0.0, 1.0);			\n\
+																		\n\
+		vec4 color = clamp(mix(a_startColor, a_endColor, t), 0.0, 1.0);	\n\
+		color.rgb *= mix(1.0, color.a, u_opacityModifyRGB);				\n\
+		v_fragmentColor = color;										\n\
+		v_texCoord = u_texRect.xy + (a_spawn.xy + 0.5) * u_texRect.zw;	\n\
+	}																	\n\
+}																		\n\
+";
@@ -0,0 +1,69 @@
+/*
+ * cocos2d-x   http://www.cocos2d-x.org
+ *
+ * Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"															\n\
+#ifdef GL_ES												\n\
+precision lowp float;										\n\
+#endif														\n\
+															\n\
+varying vec2 v_texCoord;									\n\
+#if defined(CC_VARIANT_PREMULTIPLIED)						\n\
+varying float v_alpha;										\n\
+#elif ! defined(CC_VARIANT_NO_VERTEX_COLOR)					\n\
+varying vec4 v_fragmentColor;								\n\
+#endif														\n\
+uniform sampler2D CC_Texture0;								\n\
+#ifdef CC_VARIANT_ALPHA_TEST								\n\
+uniform float CC_alpha_value;								\n\
+#endif														\n\
+															\n\
+void main()													\n\
+{															\n\
+	vec4 color = texture2D(CC_Texture0, v_texCoord);		\n\
+															\n\
+#ifdef CC_VARIANT_ALPHA_TEST								\n\
+	// same as glAlphaFunc(GL_GREATER, CC_alpha_value)		\n\
+	if (color.a <= CC_alpha_value)							\n\
+	    discard;											\n\
+#endif														\n\
+															\n\
+#ifdef CC_VARIANT_A8										\n\
+	// the texture only gives the alpha						\n\
+	color = vec4(1.0, 1.0, 1.0, color.a);					\n\
+#endif														\n\
+															\n\
+#if defined(CC_VARIANT_PREMULTIPLIED)						\n\
+	// the vertex color is (a, a, a, a)						\n\
+	color *= v_alpha;										\n\
+#elif ! defined(CC_VARIANT_NO_VERTEX_COLOR)					\n\
+	color *= v_fragmentColor;								\n\
+#endif														\n\
+															\n\
+#ifdef CC_VARIANT_OPAQUE									\n\
+	gl_FragColor = vec4(color.rgb, 1.0);					\n\
+#else														\n\
+	gl_FragColor = color;									\n\
+#endif														\n\
+}															\n\
+";
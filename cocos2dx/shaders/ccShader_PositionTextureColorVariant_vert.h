@@ -0,0 +1,55 @@
+/*
+ * cocos2d-x   http://www.cocos2d-x.org
+ *
+ * Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+"																						\n\
+// the features are defined before the source, see ShaderCache::programForVariant()		\n\
+#ifndef GL_ES																			\n\
+#define lowp																			\n\
+#define mediump																			\n\
+#endif																					\n\
+																						\n\
+attribute vec4 a_position;																\n\
+attribute vec2 a_texCoord;																\n\
+#ifndef CC_VARIANT_NO_VERTEX_COLOR														\n\
+attribute vec4 a_color;																	\n\
+#endif																					\n\
+																						\n\
+varying mediump vec2 v_texCoord;														\n\
+#if defined(CC_VARIANT_PREMULTIPLIED)													\n\
+varying lowp float v_alpha;																\n\
+#elif ! defined(CC_VARIANT_NO_VERTEX_COLOR)												\n\
+varying lowp vec4 v_fragmentColor;														\n\
+#endif																					\n\
+																						\n\
+void main()																				\n\
+{																						\n\
+	gl_Position = CC_MVPMatrix * a_position;											\n\
+	v_texCoord = a_texCoord;															\n\
+#if defined(CC_VARIANT_PREMULTIPLIED)													\n\
+	v_alpha = a_color.a;																\n\
+#elif ! defined(CC_VARIANT_NO_VERTEX_COLOR)												\n\
+	v_fragmentColor = a_color;															\n\
+#endif																					\n\
+}																						\n\
+";
@@ -50,6 +50,28 @@ const GLchar * ccPositionTextureA8Color_frag =
 const GLchar * ccPositionTextureA8Color_vert =
 #include "ccShader_PositionTextureA8Color_vert.h"
 
+//
+const GLchar * ccLabelDistanceField_frag =
+#include "ccShader_Label_df_frag.h"
+const GLchar * ccLabelDistanceFieldEffect_frag =
+#include "ccShader_Label_df_effect_frag.h"
+
+//
+const GLchar * ccParticleGPU_vert =
+#include "ccShader_ParticleGPU_vert.h"
+
+//
+const GLchar * ccMotionStreak_vert =
+#include "ccShader_MotionStreak_vert.h"
+
+//
+const GLchar * ccGridEffect_vert =
+#include "ccShader_GridEffect_vert.h"
+
+//
+const GLchar * ccInstancedSprite_vert =
+#include "ccShader_InstancedSprite_vert.h"
+
 //
 const GLchar * ccPositionTextureColor_frag =
 #include "ccShader_PositionTextureColor_frag.h"
@@ -59,6 +81,15 @@ const GLchar * ccPositionTextureColor_vert =
 //
 const GLchar * ccPositionTextureColorAlphaTest_frag = 
 #include "ccShader_PositionTextureColorAlphaTest_frag.h"
+//
+const GLchar * ccPositionTextureColorVariant_frag =
+#include "ccShader_PositionTextureColorVariant_frag.h"
+const GLchar * ccPositionTextureColorVariant_vert =
+#include "ccShader_PositionTextureColorVariant_vert.h"
+
+//
+const GLchar * ccPositionTextureColorAlphaTexture_frag =
+#include "ccShader_PositionTextureColorAlphaTexture_frag.h"
 
 //
 const GLchar * ccPositionTexture_uColor_frag = 
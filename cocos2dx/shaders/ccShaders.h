@@ -47,11 +47,24 @@ extern CC_DLL const GLchar * ccPositionTexture_vert;
 extern CC_DLL const GLchar * ccPositionTextureA8Color_frag;
 extern CC_DLL const GLchar * ccPositionTextureA8Color_vert;
 
+extern CC_DLL const GLchar * ccLabelDistanceField_frag;
+extern CC_DLL const GLchar * ccLabelDistanceFieldEffect_frag;
+
+extern CC_DLL const GLchar * ccParticleGPU_vert;
+extern CC_DLL const GLchar * ccMotionStreak_vert;
+extern CC_DLL const GLchar * ccGridEffect_vert;
+extern CC_DLL const GLchar * ccInstancedSprite_vert;
+
 extern CC_DLL const GLchar * ccPositionTextureColor_frag;
 extern CC_DLL const GLchar * ccPositionTextureColor_vert;
 
 extern CC_DLL const GLchar * ccPositionTextureColorAlphaTest_frag;
 
+extern CC_DLL const GLchar * ccPositionTextureColorVariant_frag;
+extern CC_DLL const GLchar * ccPositionTextureColorVariant_vert;
+
+extern CC_DLL const GLchar * ccPositionTextureColorAlphaTexture_frag;
+
 extern CC_DLL const GLchar * ccPositionTexture_uColor_frag;
 extern CC_DLL const GLchar * ccPositionTexture_uColor_vert;
 
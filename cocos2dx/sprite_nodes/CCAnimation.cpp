@@ -27,6 +27,8 @@ THE SOFTWARE.
 #include "textures/CCTextureCache.h"
 #include "textures/CCTexture2D.h"
 #include "ccMacros.h"
+#include "ccConfig.h"
+#include "CCDirector.h"
 #include "sprite_nodes/CCSpriteFrame.h"
 
 NS_CC_BEGIN
@@ -189,6 +191,60 @@ void Animation::addSpriteFrameWithTexture(Texture2D *pobTexture, const Rect& rec
     addSpriteFrame(pFrame);
 }
 
+const std::vector<AnimationFlipbookFrame>& Animation::getFlipbook()
+{
+    unsigned int count = _frames ? _frames->count() : 0;
+    if (_flipbook.size() == count)
+    {
+        return _flipbook;
+    }
+
+    _flipbook.clear();
+    _flipbook.reserve(count);
+
+    Object* pObj = NULL;
+    CCARRAY_FOREACH(_frames, pObj)
+    {
+        AnimationFrame* animFrame = static_cast<AnimationFrame*>(pObj);
+        SpriteFrame* spriteFrame = animFrame->getSpriteFrame();
+
+        AnimationFlipbookFrame frame;
+        frame.texture = spriteFrame->getTexture();
+        frame.rect = spriteFrame->getRect();
+        frame.offset = spriteFrame->getOffset();
+        frame.originalSize = spriteFrame->getOriginalSize();
+        frame.rotated = spriteFrame->isRotated();
+        frame.hasUserInfo = animFrame->getUserInfo() != NULL;
+        frame.left = frame.right = frame.top = frame.bottom = 0;
+
+        if (frame.texture)
+        {
+            // same mapping as Sprite::setTextureCoords, without the flips
+            Rect rect = CC_RECT_POINTS_TO_PIXELS(frame.rect);
+            float atlasWidth = (float)frame.texture->getPixelsWide();
+            float atlasHeight = (float)frame.texture->getPixelsHigh();
+            float width = frame.rotated ? rect.size.height : rect.size.width;
+            float height = frame.rotated ? rect.size.width : rect.size.height;
+
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+            frame.left   = (2*rect.origin.x+1)/(2*atlasWidth);
+            frame.right  = frame.left + (width*2-2)/(2*atlasWidth);
+            frame.top    = (2*rect.origin.y+1)/(2*atlasHeight);
+            frame.bottom = frame.top + (height*2-2)/(2*atlasHeight);
+#else
+            frame.left   = rect.origin.x/atlasWidth;
+            frame.right  = (rect.origin.x + width) / atlasWidth;
+            frame.top    = rect.origin.y/atlasHeight;
+            frame.bottom = (rect.origin.y + height) / atlasHeight;
+#endif // CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+        }
+
+        _flipbook.push_back(frame);
+    }
+
+    return _flipbook;
+}
+
 float Animation::getDuration(void) const
 {
     return _totalDelayUnits * _delayPerUnit;
@@ -200,6 +256,7 @@ Animation* Animation::clone() const
 	auto a = new Animation();
     a->initWithAnimationFrames(_frames, _delayPerUnit, _loops);
     a->setRestoreOriginalFrame(_restoreOriginalFrame);
+    a->_flipbook = _flipbook;
 	a->autorelease();
 	return a;
 }
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "cocoa/CCGeometry.h"
 #include "CCSpriteFrame.h"
 #include <string>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -106,6 +107,29 @@ protected:
 
 
 
+/** The display data of one AnimationFrame, flattened for playback.
+
+ Animate applies these with Sprite::setFlipbookFrame() instead of going through
+ the SpriteFrame, so a frame change only rewrites the sprite's quad.
+ The texture is not retained; the SpriteFrames of the animation keep it alive.
+ @since v3.0
+ */
+struct CC_DLL AnimationFlipbookFrame
+{
+    Texture2D* texture;
+    /** rect in the texture, in points */
+    Rect rect;
+    /** offset from the center of the untrimmed frame, in points */
+    Point offset;
+    /** untrimmed size, in points */
+    Size originalSize;
+    bool rotated;
+    /** unflipped texture coordinates of the rect */
+    float left, right, top, bottom;
+    /** whether the AnimationFrame has user info */
+    bool hasUserInfo;
+};
+
 /** A Animation object is used to perform animations on the Sprite objects.
 
 The Animation object contains AnimationFrame objects, and a possible delay between the frames.
@@ -187,7 +211,20 @@ public:
         CC_SAFE_RETAIN(frames);
         CC_SAFE_RELEASE(_frames);
         _frames = frames;
+        invalidateFlipbook();
     }
+
+    /** Returns the frames in the compact form used by Animate, building it if needed.
+     The table is rebuilt automatically when frames are added, but not when an
+     AnimationFrame or its SpriteFrame is modified in place; call invalidateFlipbook() then.
+     @since v3.0
+     */
+    const std::vector<AnimationFlipbookFrame>& getFlipbook();
+
+    /** Discards the compact frame table so that it is rebuilt on next use
+     @since v3.0
+     */
+    void invalidateFlipbook() { _flipbook.clear(); }
     
     /** Checks whether to restore the original frame when animation finishes. */
     bool getRestoreOriginalFrame() const { return _restoreOriginalFrame; };
@@ -222,6 +259,9 @@ protected:
 
     /** how many times the animation is going to loop. 0 means animation is not animated. 1, animation is executed one time, ... */
     unsigned int _loops;
+
+    /** the frames flattened for playback, shared by all the Animate actions that run this animation */
+    std::vector<AnimationFlipbookFrame> _flipbook;
 };
 
 // end of sprite_nodes group
@@ -55,24 +55,23 @@ void AnimationCache::destroyInstance()
 
 bool AnimationCache::init()
 {
-    _animations = new Dictionary();
     return true;
 }
 
 AnimationCache::AnimationCache()
-: _animations(NULL)
 {
 }
 
 AnimationCache::~AnimationCache()
 {
     CCLOGINFO("cocos2d: deallocing %p", this);
-    CC_SAFE_RELEASE(_animations);
 }
 
 void AnimationCache::addAnimation(Animation *animation, const char * name)
 {
-    _animations->setObject(animation, name);
+    // build the playback table now, so the Animate actions that share the animation don't pay for it
+    animation->getFlipbook();
+    _animations.setObject(animation, name);
 }
 
 void AnimationCache::removeAnimationByName(const char* name)
@@ -82,12 +81,12 @@ void AnimationCache::removeAnimationByName(const char* name)
         return;
     }
 
-    _animations->removeObjectForKey(name);
+    _animations.removeObjectForKey(name);
 }
 
 Animation* AnimationCache::animationByName(const char* name)
 {
-    return (Animation*)_animations->objectForKey(name);
+    return (Animation*)_animations.objectForKey(name);
 }
 
 void AnimationCache::parseVersion1(Dictionary* animations)
@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "cocoa/CCObject.h"
 #include "cocoa/CCDictionary.h"
+#include "cocoa/CCStringDictionary.h"
 
 #include <string>
 
@@ -68,6 +69,7 @@ public:
     bool init(void);
 
     /** Adds a Animation with a name.
+    The animation's flipbook table is built when it is added, see Animation::getFlipbook().
     */
     void addAnimation(Animation *animation, const char * name);
 
@@ -98,7 +100,7 @@ private:
     void parseVersion2(Dictionary* animations);
 
 private:
-    Dictionary* _animations;
+    StringDictionary _animations;
     static AnimationCache* s_pSharedAnimationCache;
 };
 
@@ -0,0 +1,439 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "CCInstancedSpriteBatch.h"
+#include "CCSprite.h"
+#include "CCDirector.h"
+#include "CCConfiguration.h"
+#include "CCEventType.h"
+#include "effects/CCGrid.h"
+#include "textures/CCTextureCache.h"
+#include "shaders/CCShaderCache.h"
+#include "shaders/CCGLProgram.h"
+#include "shaders/ccGLStateCache.h"
+#include "support/CCNotificationCenter.h"
+#include "support/CCFrameProfiler.h"
+#include "renderer/CCRenderer.h"
+#include "kazmath/GL/matrix.h"
+#include <stddef.h>
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#include <EGL/egl.h>
+#endif
+
+NS_CC_BEGIN
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+
+#define CC_SPRITE_INSTANCING 1
+
+#define ccDrawArraysInstanced glDrawArraysInstancedARB
+#define ccVertexAttribDivisor glVertexAttribDivisorARB
+
+// loaded by GLEW
+static bool loadInstancingFunctions()
+{
+    return true;
+}
+
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+
+#define CC_SPRITE_INSTANCING 1
+
+typedef void (GL_APIENTRYP CC_PFNGLDRAWARRAYSINSTANCEDPROC)(GLenum mode, GLint first, GLsizei count, GLsizei primcount);
+typedef void (GL_APIENTRYP CC_PFNGLVERTEXATTRIBDIVISORPROC)(GLuint index, GLuint divisor);
+
+static CC_PFNGLDRAWARRAYSINSTANCEDPROC ccDrawArraysInstanced = NULL;
+static CC_PFNGLVERTEXATTRIBDIVISORPROC ccVertexAttribDivisor = NULL;
+
+static bool loadInstancingFunctions()
+{
+    ccDrawArraysInstanced = (CC_PFNGLDRAWARRAYSINSTANCEDPROC)eglGetProcAddress("glDrawArraysInstancedEXT");
+    ccVertexAttribDivisor = (CC_PFNGLVERTEXATTRIBDIVISORPROC)eglGetProcAddress("glVertexAttribDivisorEXT");
+    return ccDrawArraysInstanced && ccVertexAttribDivisor;
+}
+
+#else
+
+// the other platforms draw the sprites as quads
+#define CC_SPRITE_INSTANCING 0
+
+#endif
+
+// the corners of the unit quad, drawn as a triangle strip
+static const GLfloat s_unitQuad[] = { 0, 0,  1, 0,  0, 1,  1, 1 };
+
+InstancedSpriteBatch* InstancedSpriteBatch::createWithTexture(Texture2D* texture)
+{
+    InstancedSpriteBatch *batch = new InstancedSpriteBatch();
+    if (batch->initWithTexture(texture))
+    {
+        batch->autorelease();
+        return batch;
+    }
+    CC_SAFE_DELETE(batch);
+    return NULL;
+}
+
+InstancedSpriteBatch* InstancedSpriteBatch::create(const char* fileImage)
+{
+    InstancedSpriteBatch *batch = new InstancedSpriteBatch();
+    if (batch->initWithFile(fileImage))
+    {
+        batch->autorelease();
+        return batch;
+    }
+    CC_SAFE_DELETE(batch);
+    return NULL;
+}
+
+bool InstancedSpriteBatch::isInstancingSupported()
+{
+#if CC_SPRITE_INSTANCING
+    static int s_supported = -1;
+    if (s_supported < 0)
+    {
+        s_supported = Configuration::getInstance()->supportsInstancing() && loadInstancingFunctions() ? 1 : 0;
+    }
+    return s_supported == 1;
+#else
+    return false;
+#endif
+}
+
+InstancedSpriteBatch::InstancedSpriteBatch()
+: _texture(NULL)
+, _blendFunc(BlendFunc::ALPHA_PREMULTIPLIED)
+, _instancingEnabled(true)
+, _bufferCapacity(0)
+{
+    memset(_buffersVBO, 0, sizeof(_buffersVBO));
+}
+
+InstancedSpriteBatch::~InstancedSpriteBatch()
+{
+    CC_SAFE_RELEASE(_texture);
+    GL::deleteBuffers(2, &_buffersVBO[0]);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    NotificationCenter::getInstance()->removeObserver(this, EVNET_COME_TO_FOREGROUND);
+#endif
+}
+
+bool InstancedSpriteBatch::initWithTexture(Texture2D* texture)
+{
+    CCASSERT(texture != NULL, "Invalid texture");
+
+    setTexture(texture);
+    setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_INSTANCED_SPRITE));
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    NotificationCenter::getInstance()->addObserver(this,
+                                                   callfuncO_selector(InstancedSpriteBatch::listenBackToForeground),
+                                                   EVNET_COME_TO_FOREGROUND,
+                                                   NULL);
+#endif
+
+    return true;
+}
+
+bool InstancedSpriteBatch::initWithFile(const char* fileImage)
+{
+    Texture2D *texture = TextureCache::getInstance()->addImage(fileImage);
+    return texture != NULL && initWithTexture(texture);
+}
+
+void InstancedSpriteBatch::listenBackToForeground(Object *obj)
+{
+    CC_UNUSED_PARAM(obj);
+    // the buffers were lost with the context
+    memset(_buffersVBO, 0, sizeof(_buffersVBO));
+    _bufferCapacity = 0;
+}
+
+Texture2D* InstancedSpriteBatch::getTexture(void) const
+{
+    return _texture;
+}
+
+void InstancedSpriteBatch::setTexture(Texture2D *texture)
+{
+    if (_texture != texture)
+    {
+        CC_SAFE_RETAIN(texture);
+        CC_SAFE_RELEASE(_texture);
+        _texture = texture;
+    }
+
+    if (_texture && ! _texture->hasPremultipliedAlpha())
+    {
+        _blendFunc = BlendFunc::ALPHA_NON_PREMULTIPLIED;
+    }
+}
+
+void InstancedSpriteBatch::setBlendFunc(const BlendFunc &blendFunc)
+{
+    _blendFunc = blendFunc;
+}
+
+const BlendFunc& InstancedSpriteBatch::getBlendFunc(void) const
+{
+    return _blendFunc;
+}
+
+void InstancedSpriteBatch::addChild(Node *child, int zOrder, int tag)
+{
+    CCASSERT(child != NULL, "child should not be null");
+    CCASSERT(dynamic_cast<Sprite*>(child) != NULL, "InstancedSpriteBatch only supports Sprites as children");
+    CCASSERT(static_cast<Sprite*>(child)->getTexture()->getName() == _texture->getName(), "Sprite is not using the same texture id");
+
+    Node::addChild(child, zOrder, tag);
+}
+
+void InstancedSpriteBatch::addChild(Node *child)
+{
+    Node::addChild(child);
+}
+
+void InstancedSpriteBatch::addChild(Node *child, int zOrder)
+{
+    Node::addChild(child, zOrder);
+}
+
+void InstancedSpriteBatch::visit(void)
+{
+    CC_PROFILE_ZONE("CCInstancedSpriteBatch - visit");
+
+    // like SpriteBatchNode::visit(), the children are drawn by draw()
+    if (! _visible)
+    {
+        return;
+    }
+
+    kmGLPushMatrix();
+
+    if (_grid && _grid->isActive())
+    {
+        _grid->beforeDraw();
+        transformAncestors();
+    }
+
+    sortAllChildren();
+    transform();
+
+    draw();
+
+    if (_grid && _grid->isActive())
+    {
+        _grid->afterDraw(this);
+    }
+
+    kmGLPopMatrix();
+    setOrderOfArrival(0);
+}
+
+void InstancedSpriteBatch::collectSprite(Sprite* sprite, const AffineTransform& parentTransform, bool instanced)
+{
+    if (! sprite->isVisible())
+    {
+        return;
+    }
+
+    AffineTransform transform = AffineTransformConcat(sprite->getNodeToParentTransform(), parentTransform);
+    sprite->sortAllChildren();
+
+    // the children with a negative z order are drawn before their parent
+    auto& children = sprite->getChildren();
+    size_t i = 0;
+    for (; i < children.size() && children.at(i)->getZOrder() < 0; ++i)
+    {
+        collectSprite(static_cast<Sprite*>(children.at(i)), transform, instanced);
+    }
+
+    addSprite(sprite, transform, instanced);
+
+    for (; i < children.size(); ++i)
+    {
+        collectSprite(static_cast<Sprite*>(children.at(i)), transform, instanced);
+    }
+}
+
+void InstancedSpriteBatch::addSprite(Sprite* sprite, const AffineTransform& transform, bool instanced)
+{
+    V3F_C4B_T2F_Quad quad = sprite->getQuad();
+
+    if (! instanced)
+    {
+        V3F_C4B_T2F* corners[] = { &quad.bl, &quad.br, &quad.tl, &quad.tr };
+        for (auto corner : corners)
+        {
+            Point position = PointApplyAffineTransform(Point(corner->vertices.x, corner->vertices.y), transform);
+            corner->vertices.x = position.x;
+            corner->vertices.y = position.y;
+        }
+        _quads.push_back(quad);
+        return;
+    }
+
+    // the corners (1, 0) and (0, 1) of the unit quad have the v, and the u, of the bottom left corner:
+    // they are swapped when the frame is rotated
+    const V3F_C4B_T2F& cornerU = quad.br.texCoords.v == quad.bl.texCoords.v ? quad.br : quad.tl;
+    const V3F_C4B_T2F& cornerV = quad.br.texCoords.v == quad.bl.texCoords.v ? quad.tl : quad.br;
+
+    float ux = cornerU.vertices.x - quad.bl.vertices.x;
+    float uy = cornerU.vertices.y - quad.bl.vertices.y;
+    float vx = cornerV.vertices.x - quad.bl.vertices.x;
+    float vy = cornerV.vertices.y - quad.bl.vertices.y;
+    Point origin = PointApplyAffineTransform(Point(quad.bl.vertices.x, quad.bl.vertices.y), transform);
+
+    Instance instance;
+    instance.transform[0] = transform.a * ux + transform.c * uy;
+    instance.transform[1] = transform.a * vx + transform.c * vy;
+    instance.transform[2] = origin.x;
+    instance.transform[3] = transform.b * ux + transform.d * uy;
+    instance.transform[4] = transform.b * vx + transform.d * vy;
+    instance.transform[5] = origin.y;
+    instance.color = quad.bl.colors;
+    instance.texCoords[0] = (GLushort)(clampf(quad.bl.texCoords.u, 0, 1) * 65535 + 0.5f);
+    instance.texCoords[1] = (GLushort)(clampf(quad.bl.texCoords.v, 0, 1) * 65535 + 0.5f);
+    instance.texCoords[2] = (GLushort)(clampf(quad.tr.texCoords.u, 0, 1) * 65535 + 0.5f);
+    instance.texCoords[3] = (GLushort)(clampf(quad.tr.texCoords.v, 0, 1) * 65535 + 0.5f);
+    _instances.push_back(instance);
+}
+
+void InstancedSpriteBatch::draw(void)
+{
+    CC_PROFILE_ZONE("CCInstancedSpriteBatch - draw");
+
+    if (_texture == NULL || _children.empty())
+    {
+        return;
+    }
+
+    // the textures with an alpha texture need the shader of the quads
+    bool instanced = _instancingEnabled && isInstancingSupported() && _texture->getAlphaTexture() == NULL;
+
+    _instances.clear();
+    _quads.clear();
+    for (auto& child : _children)
+    {
+        collectSprite(static_cast<Sprite*>(child), AffineTransformIdentity, instanced);
+    }
+
+    if (instanced)
+    {
+        drawInstances();
+    }
+    else if (! _quads.empty())
+    {
+        // the quads are drawn by the Renderer when it is flushed, batched with the other quads of the texture
+        kmMat4 mv;
+        kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
+
+        ShaderCache* cache = ShaderCache::getInstance();
+        GLProgram* program = cache->programForTexture(cache->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR), _texture);
+        Texture2D* alphaTexture = _texture->getAlphaTexture();
+        _quadCommand.init(_texture->getName(), program, _blendFunc, &_quads[0], (int)_quads.size(), mv, alphaTexture ? alphaTexture->getName() : 0);
+        Director::getInstance()->getRenderer()->addCommand(&_quadCommand);
+    }
+}
+
+void InstancedSpriteBatch::setupVBO()
+{
+    GL::deleteBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(2, &_buffersVBO[0]);
+    _bufferCapacity = 0;
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(s_unitQuad), s_unitQuad, GL_STATIC_DRAW);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void InstancedSpriteBatch::drawInstances()
+{
+#if CC_SPRITE_INSTANCING
+    if (_instances.empty())
+    {
+        return;
+    }
+
+    if (_buffersVBO[0] == 0)
+    {
+        setupVBO();
+    }
+
+    CC_NODE_DRAW_SETUP();
+
+    GL::bindTexture2D( _texture->getName() );
+    GL::blendFunc( _blendFunc.src, _blendFunc.dst );
+
+    // the transform uses the attributes after the ones of GLProgram
+    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
+    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_MAX);
+    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_MAX + 1);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
+
+    // the buffer is orphaned each frame, so the upload doesn't wait for the previous draw call
+    GL::bindBuffer(GL_ARRAY_BUFFER, _buffersVBO[1]);
+    if (_instances.size() > _bufferCapacity)
+    {
+        _bufferCapacity = _instances.size() + _instances.size() / 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Instance) * _bufferCapacity, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Instance) * _instances.size(), &_instances[0]);
+
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), (GLvoid*) offsetof(Instance, color));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Instance), (GLvoid*) offsetof(Instance, texCoords));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_MAX, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (GLvoid*) offsetof(Instance, transform));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_MAX + 1, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (GLvoid*) (offsetof(Instance, transform) + 3 * sizeof(GLfloat)));
+
+    ccVertexAttribDivisor(GLProgram::VERTEX_ATTRIB_COLOR, 1);
+    ccVertexAttribDivisor(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 1);
+    ccVertexAttribDivisor(GLProgram::VERTEX_ATTRIB_MAX, 1);
+    ccVertexAttribDivisor(GLProgram::VERTEX_ATTRIB_MAX + 1, 1);
+
+    ccDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) _instances.size());
+    CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_QUADS(_instances.size());
+
+    // the other draw calls read an attribute per vertex
+    ccVertexAttribDivisor(GLProgram::VERTEX_ATTRIB_COLOR, 0);
+    ccVertexAttribDivisor(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 0);
+    ccVertexAttribDivisor(GLProgram::VERTEX_ATTRIB_MAX, 0);
+    ccVertexAttribDivisor(GLProgram::VERTEX_ATTRIB_MAX + 1, 0);
+
+    glDisableVertexAttribArray(GLProgram::VERTEX_ATTRIB_MAX);
+    glDisableVertexAttribArray(GLProgram::VERTEX_ATTRIB_MAX + 1);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+#endif // CC_SPRITE_INSTANCING
+}
+
+NS_CC_END
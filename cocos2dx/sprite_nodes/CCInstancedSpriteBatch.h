@@ -0,0 +1,136 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_INSTANCED_SPRITE_BATCH_H__
+#define __CC_INSTANCED_SPRITE_BATCH_H__
+
+#include "base_nodes/CCNode.h"
+#include "CCProtocols.h"
+#include "CCGL.h"
+#include "renderer/CCQuadCommand.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup sprite_nodes
+ * @{
+ */
+
+class Sprite;
+
+/** @brief InstancedSpriteBatch draws its Sprites with a single instanced draw call.
+
+ Instead of expanding each sprite into the 4 vertices of a quad (96 bytes), the batch uploads one instance per
+ sprite (36 bytes): the affine transform of a unit quad, its color and its texture rectangle. The vertex shader
+ places the 4 corners of the unit quad, drawn with glDrawArraysInstanced, so the vertex data is divided by
+ about 2.7. It suits the layers of many sprites that move each frame: bullets, crowds.
+
+ When the GPU doesn't support instancing (see Configuration::supportsInstancing()), the sprites are drawn as
+ quads by the Renderer, as if they weren't in a batch, and batched with the other quads of the same texture.
+
+ Limitations:
+ - Its children (and their children) must be Sprites using the texture of the batch.
+ - The sprites are not culled, and the textures with an alpha texture (ETC1) are drawn as quads.
+ - The vertex z and the shader programs of the sprites are ignored.
+
+ @since v3.0
+ */
+class CC_DLL InstancedSpriteBatch : public Node, public TextureProtocol
+{
+public:
+    /** creates an InstancedSpriteBatch that draws the sprites of a texture */
+    static InstancedSpriteBatch* createWithTexture(Texture2D* texture);
+
+    /** creates an InstancedSpriteBatch that draws the sprites of an image file */
+    static InstancedSpriteBatch* create(const char* fileImage);
+
+    /** Whether the GPU can draw the batches with instancing */
+    static bool isInstancingSupported();
+
+    InstancedSpriteBatch();
+    virtual ~InstancedSpriteBatch();
+
+    bool initWithTexture(Texture2D* texture);
+    bool initWithFile(const char* fileImage);
+
+    /** Whether the sprites are drawn with instancing when it is supported, true by default.
+     When it is disabled, the sprites are drawn as quads.
+     */
+    void setInstancingEnabled(bool enabled) { _instancingEnabled = enabled; }
+    bool isInstancingEnabled() const { return _instancingEnabled; }
+
+    /** listen the event that coming to foreground on Android */
+    void listenBackToForeground(Object *obj);
+
+    // Overrides
+    virtual Texture2D* getTexture(void) const override;
+    virtual void setTexture(Texture2D *texture) override;
+    virtual void setBlendFunc(const BlendFunc &blendFunc) override;
+    virtual const BlendFunc& getBlendFunc(void) const override;
+
+    virtual void addChild(Node * child) override;
+    virtual void addChild(Node * child, int zOrder) override;
+    virtual void addChild(Node * child, int zOrder, int tag) override;
+    virtual void visit(void) override;
+    virtual void draw(void) override;
+
+protected:
+    /** A sprite, for the vertex shader */
+    struct Instance
+    {
+        // rows of the affine transform of the unit quad: a, c, tx and b, d, ty
+        GLfloat transform[6];
+        Color4B color;
+        // texture coordinates of the corners (0, 0) and (1, 1) of the unit quad
+        GLushort texCoords[4];
+    };
+
+    /** collects the instances, or the quads, of a sprite and of its children */
+    void collectSprite(Sprite* sprite, const AffineTransform& parentTransform, bool instanced);
+    void addSprite(Sprite* sprite, const AffineTransform& transform, bool instanced);
+    void drawInstances();
+    void setupVBO();
+
+    Texture2D* _texture;
+    BlendFunc _blendFunc;
+    bool _instancingEnabled;
+
+    std::vector<Instance> _instances;
+    std::vector<V3F_C4B_T2F_Quad> _quads;
+
+    GLuint _buffersVBO[2]; //0: corners of the unit quad  1: instances
+    // number of instances the instance buffer can hold
+    size_t _bufferCapacity;
+
+    QuadCommand _quadCommand;
+};
+
+// end of sprite_nodes group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_INSTANCED_SPRITE_BATCH_H__
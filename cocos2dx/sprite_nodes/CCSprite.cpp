@@ -41,7 +41,8 @@ THE SOFTWARE.
 #include "textures/CCTexture2D.h"
 #include "cocoa/CCAffineTransform.h"
 #include "support/TransformUtils.h"
-#include "support/CCProfiling.h"
+#include "support/CCFrameProfiler.h"
+#include "renderer/CCRenderer.h"
 // external
 #include "kazmath/GL/matrix.h"
 #include <string.h>
@@ -312,11 +313,35 @@ void Sprite::setTextureRect(const Rect& rect)
 void Sprite::setTextureRect(const Rect& rect, bool rotated, const Size& untrimmedSize)
 {
     _rectRotated = rotated;
+    invalidateRenderCache();
 
     setContentSize(untrimmedSize);
     setVertexRect(rect);
     setTextureCoords(rect);
+    updateOffsetAndVertices();
+}
+
+void Sprite::setFlipbookFrame(const AnimationFlipbookFrame& frame)
+{
+    _unflippedOffsetPositionFromCenter = frame.offset;
 
+    // update texture before updating texture rect
+    if (!_batchNode && frame.texture != _texture)
+    {
+        setTexture(frame.texture);
+    }
+
+    _rectRotated = frame.rotated;
+    invalidateRenderCache();
+
+    setContentSize(frame.originalSize);
+    setVertexRect(frame.rect);
+    applyTextureCoords(frame.left, frame.right, frame.top, frame.bottom);
+    updateOffsetAndVertices();
+}
+
+void Sprite::updateOffsetAndVertices()
+{
     Point relativeOffset = _unflippedOffsetPositionFromCenter;
 
     // issue #732
@@ -390,7 +415,29 @@ void Sprite::setTextureCoords(Rect rect)
         top     = rect.origin.y/atlasHeight;
         bottom  = (rect.origin.y+rect.size.width) / atlasHeight;
 #endif // CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+    }
+    else
+    {
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+        left    = (2*rect.origin.x+1)/(2*atlasWidth);
+        right    = left + (rect.size.width*2-2)/(2*atlasWidth);
+        top        = (2*rect.origin.y+1)/(2*atlasHeight);
+        bottom    = top + (rect.size.height*2-2)/(2*atlasHeight);
+#else
+        left    = rect.origin.x/atlasWidth;
+        right    = (rect.origin.x + rect.size.width) / atlasWidth;
+        top        = rect.origin.y/atlasHeight;
+        bottom    = (rect.origin.y + rect.size.height) / atlasHeight;
+#endif // ! CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+    }
+
+    applyTextureCoords(left, right, top, bottom);
+}
 
+void Sprite::applyTextureCoords(float left, float right, float top, float bottom)
+{
+    if (_rectRotated)
+    {
         if (_flipX)
         {
             CC_SWAP(top, bottom, float);
@@ -412,18 +459,6 @@ void Sprite::setTextureCoords(Rect rect)
     }
     else
     {
-#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
-        left    = (2*rect.origin.x+1)/(2*atlasWidth);
-        right    = left + (rect.size.width*2-2)/(2*atlasWidth);
-        top        = (2*rect.origin.y+1)/(2*atlasHeight);
-        bottom    = top + (rect.size.height*2-2)/(2*atlasHeight);
-#else
-        left    = rect.origin.x/atlasWidth;
-        right    = (rect.origin.x + rect.size.width) / atlasWidth;
-        top        = rect.origin.y/atlasHeight;
-        bottom    = (rect.origin.y + rect.size.height) / atlasHeight;
-#endif // ! CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
-
         if(_flipX)
         {
             CC_SWAP(left,right,float);
@@ -451,71 +486,8 @@ void Sprite::updateTransform(void)
 
     // recalculate matrix only if it is dirty
     if( isDirty() ) {
-
-        // If it is not visible, or one of its ancestors is not visible, then do nothing:
-        if( !_visible || ( _parent && _parent != _batchNode && ((Sprite*)_parent)->_shouldBeHidden) )
-        {
-            _quad.br.vertices = _quad.tl.vertices = _quad.tr.vertices = _quad.bl.vertices = Vertex3F(0,0,0);
-            _shouldBeHidden = true;
-        }
-        else 
-        {
-            _shouldBeHidden = false;
-
-            if( ! _parent || _parent == _batchNode )
-            {
-                _transformToBatch = getNodeToParentTransform();
-            }
-            else 
-            {
-                CCASSERT( dynamic_cast<Sprite*>(_parent), "Logic error in Sprite. Parent must be a Sprite");
-                _transformToBatch = AffineTransformConcat( getNodeToParentTransform() , ((Sprite*)_parent)->_transformToBatch );
-            }
-
-            //
-            // calculate the Quad based on the Affine Matrix
-            //
-
-            Size size = _rect.size;
-
-            float x1 = _offsetPosition.x;
-            float y1 = _offsetPosition.y;
-
-            float x2 = x1 + size.width;
-            float y2 = y1 + size.height;
-            float x = _transformToBatch.tx;
-            float y = _transformToBatch.ty;
-
-            float cr = _transformToBatch.a;
-            float sr = _transformToBatch.b;
-            float cr2 = _transformToBatch.d;
-            float sr2 = -_transformToBatch.c;
-            float ax = x1 * cr - y1 * sr2 + x;
-            float ay = x1 * sr + y1 * cr2 + y;
-
-            float bx = x2 * cr - y1 * sr2 + x;
-            float by = x2 * sr + y1 * cr2 + y;
-
-            float cx = x2 * cr - y2 * sr2 + x;
-            float cy = x2 * sr + y2 * cr2 + y;
-
-            float dx = x1 * cr - y2 * sr2 + x;
-            float dy = x1 * sr + y2 * cr2 + y;
-
-            _quad.bl.vertices = Vertex3F( RENDER_IN_SUBPIXEL(ax), RENDER_IN_SUBPIXEL(ay), _vertexZ );
-            _quad.br.vertices = Vertex3F( RENDER_IN_SUBPIXEL(bx), RENDER_IN_SUBPIXEL(by), _vertexZ );
-            _quad.tl.vertices = Vertex3F( RENDER_IN_SUBPIXEL(dx), RENDER_IN_SUBPIXEL(dy), _vertexZ );
-            _quad.tr.vertices = Vertex3F( RENDER_IN_SUBPIXEL(cx), RENDER_IN_SUBPIXEL(cy), _vertexZ );
-        }
-
-        // MARMALADE CHANGE: ADDED CHECK FOR NULL, TO PERMIT SPRITES WITH NO BATCH NODE / TEXTURE ATLAS
-        if (_textureAtlas)
-		{
-            _textureAtlas->updateQuad(&_quad, _atlasIndex);
-        }
-		
-        _recursiveDirty = false;
-        setDirty(false);
+        updateQuadInBatch();
+        commitQuadToAtlas();
     }
 
     // MARMALADE CHANGED
@@ -524,7 +496,10 @@ void Sprite::updateTransform(void)
     {
         // MARMALADE: CHANGED TO USE Node*
         // NOTE THAT WE HAVE ALSO DEFINED virtual Node::updateTransform()
-        arrayMakeObjectsPerformSelector(_children, updateTransform, Sprite*);
+        for (auto child : _children)
+        {
+            child->updateTransform();
+        }
     }*/
     Node::updateTransform();
 
@@ -540,46 +515,109 @@ void Sprite::updateTransform(void)
 #endif // CC_SPRITE_DEBUG_DRAW
 }
 
-// draw
-
-void Sprite::draw(void)
+void Sprite::updateQuadInBatch(void)
 {
-    CC_PROFILER_START_CATEGORY(kProfilerCategorySprite, "CCSprite - draw");
+    // If it is not visible, or one of its ancestors is not visible, then do nothing:
+    if( !_visible || ( _parent && _parent != _batchNode && ((Sprite*)_parent)->_shouldBeHidden) )
+    {
+        _quad.br.vertices = _quad.tl.vertices = _quad.tr.vertices = _quad.bl.vertices = Vertex3F(0,0,0);
+        _shouldBeHidden = true;
+    }
+    else 
+    {
+        _shouldBeHidden = false;
 
-    CCASSERT(!_batchNode, "If Sprite is being rendered by SpriteBatchNode, Sprite#draw SHOULD NOT be called");
+        if( ! _parent || _parent == _batchNode )
+        {
+            _transformToBatch = getNodeToParentTransform();
+        }
+        else 
+        {
+            CCASSERT( dynamic_cast<Sprite*>(_parent), "Logic error in Sprite. Parent must be a Sprite");
+            _transformToBatch = AffineTransformConcat( getNodeToParentTransform() , ((Sprite*)_parent)->_transformToBatch );
+        }
 
-    CC_NODE_DRAW_SETUP();
-    
-    GL::blendFunc( _blendFunc.src, _blendFunc.dst );
+        //
+        // calculate the Quad based on the Affine Matrix
+        //
 
-    GL::bindTexture2D( _texture->getName() );
-    GL::enableVertexAttribs( GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
+        Size size = _rect.size;
 
-#define kQuadSize sizeof(_quad.bl)
-#ifdef EMSCRIPTEN
-    long offset = 0;
-    setGLBufferData(&_quad, 4 * kQuadSize, 0);
-#else
-    long offset = (long)&_quad;
-#endif // EMSCRIPTEN
+        float x1 = _offsetPosition.x;
+        float y1 = _offsetPosition.y;
 
-    // vertex
-    int diff = offsetof( V3F_C4B_T2F, vertices);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (void*) (offset + diff));
+        float x2 = x1 + size.width;
+        float y2 = y1 + size.height;
+        float x = _transformToBatch.tx;
+        float y = _transformToBatch.ty;
 
-    // texCoods
-    diff = offsetof( V3F_C4B_T2F, texCoords);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (void*)(offset + diff));
-    
-    // color
-    diff = offsetof( V3F_C4B_T2F, colors);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (void*)(offset + diff));
+        float cr = _transformToBatch.a;
+        float sr = _transformToBatch.b;
+        float cr2 = _transformToBatch.d;
+        float sr2 = -_transformToBatch.c;
+        float ax = x1 * cr - y1 * sr2 + x;
+        float ay = x1 * sr + y1 * cr2 + y;
+
+        float bx = x2 * cr - y1 * sr2 + x;
+        float by = x2 * sr + y1 * cr2 + y;
+
+        float cx = x2 * cr - y2 * sr2 + x;
+        float cy = x2 * sr + y2 * cr2 + y;
+
+        float dx = x1 * cr - y2 * sr2 + x;
+        float dy = x1 * sr + y2 * cr2 + y;
+
+        _quad.bl.vertices = Vertex3F( RENDER_IN_SUBPIXEL(ax), RENDER_IN_SUBPIXEL(ay), _vertexZ );
+        _quad.br.vertices = Vertex3F( RENDER_IN_SUBPIXEL(bx), RENDER_IN_SUBPIXEL(by), _vertexZ );
+        _quad.tl.vertices = Vertex3F( RENDER_IN_SUBPIXEL(dx), RENDER_IN_SUBPIXEL(dy), _vertexZ );
+        _quad.tr.vertices = Vertex3F( RENDER_IN_SUBPIXEL(cx), RENDER_IN_SUBPIXEL(cy), _vertexZ );
+    }
+}
+
+void Sprite::commitQuadToAtlas(void)
+{
+    // MARMALADE CHANGE: ADDED CHECK FOR NULL, TO PERMIT SPRITES WITH NO BATCH NODE / TEXTURE ATLAS
+    if (_textureAtlas)
+    {
+        _textureAtlas->updateQuad(&_quad, _atlasIndex);
+    }
 
+    _recursiveDirty = false;
+    setDirty(false);
+}
+
+// draw
+
+void Sprite::draw(void)
+{
+    CC_PROFILE_ZONE("CCSprite - draw");
+
+    CCASSERT(!_batchNode, "If Sprite is being rendered by SpriteBatchNode, Sprite#draw SHOULD NOT be called");
 
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    // the quad is drawn by the Renderer when it is flushed
+    kmMat4 mv;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
 
-    CHECK_GL_ERROR_DEBUG();
+#if CC_USE_CULLING
+    kmMat4 mvp;
+    kmGLGetMatrix(KM_GL_PROJECTION, &mvp);
+    kmMat4Multiply(&mvp, &mvp, &mv);
+    if (!isQuadVisible(&mvp, &_quad))
+    {
+        return;
+    }
+#endif // CC_USE_CULLING
+
+    // updateColor() gives the same color to the 4 vertices
+    GLProgram* program = ShaderCache::getInstance()->programForQuads(_shaderProgram, _texture, _blendFunc, &_quad.bl.colors);
+    if (program != _shaderProgram)
+    {
+        setShaderProgram(program);
+    }
 
+    Texture2D* alphaTexture = _texture->getAlphaTexture();
+    _quadCommand.init(_texture->getName(), _shaderProgram, _blendFunc, &_quad, 1, mv, alphaTexture ? alphaTexture->getName() : 0);
+    Director::getInstance()->getRenderer()->addCommand(&_quadCommand);
 
 #if CC_SPRITE_DEBUG_DRAW == 1
     // draw bounding box
@@ -600,10 +638,6 @@ void Sprite::draw(void)
     };
     ccDrawPoly(vertices, 4, true);
 #endif // CC_SPRITE_DEBUG_DRAW
-
-    CC_INCREMENT_GL_DRAWS(1);
-
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategorySprite, "CCSprite - draw");
 }
 
 // Node overrides
@@ -643,7 +677,7 @@ void Sprite::addChild(Node *child, int zOrder, int tag)
 void Sprite::reorderChild(Node *child, int zOrder)
 {
     CCASSERT(child != NULL, "");
-    CCASSERT(_children->containsObject(child), "");
+    CCASSERT(_children.contains(child), "");
 
     if (zOrder == child->getZOrder())
     {
@@ -674,10 +708,9 @@ void Sprite::removeAllChildrenWithCleanup(bool bCleanup)
 {
     if (_batchNode)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
+        for (auto node : _children)
         {
-            Sprite* child = dynamic_cast<Sprite*>(pObject);
+            Sprite* child = dynamic_cast<Sprite*>(node);
             if (child)
             {
                 _batchNode->removeSpriteFromAtlas(child);
@@ -694,28 +727,14 @@ void Sprite::sortAllChildren()
 {
     if (_reorderChildDirty)
     {
-        int i = 0, j = 0, length = _children->data->num;
-        Node** x = (Node**)_children->data->arr;
-        Node *tempItem = NULL;
+        sortNodes(_children.data(), _children.size());
 
-        // insertion sort
-        for(i=1; i<length; i++)
+        if ( _batchNode)
         {
-            tempItem = x[i];
-            j = i-1;
-
-            //continue moving element downwards while zOrder is smaller or when zOrder is the same but orderOfArrival is smaller
-            while(j>=0 && ( tempItem->getZOrder() < x[j]->getZOrder() || ( tempItem->getZOrder() == x[j]->getZOrder() && tempItem->getOrderOfArrival() < x[j]->getOrderOfArrival() ) ) )
+            for (auto child : _children)
             {
-                x[j+1] = x[j];
-                j = j-1;
+                child->sortAllChildren();
             }
-            x[j+1] = tempItem;
-        }
-
-        if ( _batchNode)
-        {
-            arrayMakeObjectsPerformSelector(_children, sortAllChildren, Sprite*);
         }
 
         _reorderChildDirty = false;
@@ -750,10 +769,9 @@ void Sprite::setDirtyRecursively(bool bValue)
     // recursively set dirty
     if (_hasChildren)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(_children, pObject)
+        for (auto node : _children)
         {
-            Sprite* child = dynamic_cast<Sprite*>(pObject);
+            Sprite* child = dynamic_cast<Sprite*>(node);
             if (child)
             {
                 child->setDirtyRecursively(true);
@@ -960,6 +978,14 @@ void Sprite::updateDisplayedOpacity(GLubyte opacity)
     updateColor();
 }
 
+void Sprite::resetForReuse()
+{
+    NodeRGBA::resetForReuse();
+
+    setFlipX(false);
+    setFlipY(false);
+}
+
 // Frames
 
 void Sprite::setDisplayFrame(SpriteFrame *pNewFrame)
@@ -1063,48 +1089,19 @@ void Sprite::updateBlendFunc(void)
     }
 }
 
-/*
- * This array is the data of a white image with 2 by 2 dimension.
- * It's used for creating a default texture when sprite's texture is set to NULL.
- * Supposing codes as follows:
- *
- *   auto sp = new Sprite();
- *   sp->init();  // Texture was set to NULL, in order to make opacity and color to work correctly, we need to create a 2x2 white texture.
- *
- * The test is in "TestCpp/SpriteTest/Sprite without texture".
- */
-static unsigned char cc_2x2_white_image[] = {
-    // RGBA8888
-    0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF
-};
-
-#define CC_2x2_WHITE_IMAGE_KEY  "cc_2x2_white_image"
-
 void Sprite::setTexture(Texture2D *texture)
 {
     // If batchnode, then texture id should be the same
     CCASSERT(! _batchNode || texture->getName() == _batchNode->getTexture()->getName(), "CCSprite: Batched sprites should use the same texture as the batchnode");
     // accept texture==nil as argument
     CCASSERT( !texture || dynamic_cast<Texture2D*>(texture), "setTexture expects a Texture2D. Invalid argument");
+    invalidateRenderCache();
     
     if (NULL == texture)
     {
-        // Gets the texture by key firstly.
-        texture = TextureCache::getInstance()->textureForKey(CC_2x2_WHITE_IMAGE_KEY);
-        
-        // If texture wasn't in cache, create it from RAW data.
-        if (NULL == texture)
-        {
-            Image* image = new Image();
-            bool isOK = image->initWithImageData(cc_2x2_white_image, sizeof(cc_2x2_white_image), Image::Format::RAW_DATA, 2, 2, 8);
-            CCASSERT(isOK, "The 2x2 empty texture was created unsuccessfully.");
-
-            texture = TextureCache::getInstance()->addUIImage(image, CC_2x2_WHITE_IMAGE_KEY);
-            CC_SAFE_RELEASE(image);
-        }
+        // in order to make opacity and color to work correctly, the sprite uses a white texture,
+        // see "TestCpp/SpriteTest/Sprite without texture"
+        texture = TextureCache::getInstance()->getWhiteTexture();
     }
     
     if (!_batchNode && _texture != texture)
@@ -1113,6 +1110,7 @@ void Sprite::setTexture(Texture2D *texture)
         CC_SAFE_RELEASE(_texture);
         _texture = texture;
         updateBlendFunc();
+        setShaderProgram(ShaderCache::getInstance()->programForTexture(_shaderProgram, _texture));
     }
 }
 
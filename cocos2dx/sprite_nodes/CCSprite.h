@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include "textures/CCTextureAtlas.h"
 #include "ccTypes.h"
 #include "cocoa/CCDictionary.h"
+#include "cocoa/CCPoolAllocator.h"
+#include "renderer/CCQuadCommand.h"
 #include <string>
 #ifdef EMSCRIPTEN
 #include "base_nodes/CCGLBufferedNode.h"
@@ -42,6 +44,7 @@ NS_CC_BEGIN
 class SpriteBatchNode;
 class SpriteFrame;
 class Animation;
+struct AnimationFlipbookFrame;
 class Rect;
 class Point;
 class Size;
@@ -76,7 +79,7 @@ struct transformValues_;
  *
  * The default anchorPoint in Sprite is (0.5, 0.5).
  */
-class CC_DLL Sprite : public NodeRGBA, public TextureProtocol
+class CC_DLL Sprite : public NodeRGBA, public TextureProtocol, public PoolAllocated
 #ifdef EMSCRIPTEN
 , public GLBufferedNode
 #endif // EMSCRIPTEN
@@ -265,6 +268,20 @@ public:
      * Updates the quad according the rotation, position, scale values. 
      */
     virtual void updateTransform(void);
+
+    /**
+     * Computes the quad of a dirty sprite like updateTransform(), without writing it to the texture atlas
+     * and without visiting the children. It only reads the parent, so the sprites whose parents are up to date
+     * can be computed in parallel.
+     * @since v3.0
+     */
+    void updateQuadInBatch(void);
+
+    /**
+     * Writes the quad computed by updateQuadInBatch() to the texture atlas and clears the dirty flags.
+     * @since v3.0
+     */
+    void commitQuadToAtlas(void);
     
     /**
      * Returns the batch node object if this sprite is rendered by SpriteBatchNode
@@ -333,6 +350,14 @@ public:
      * Returns the current displayed frame.
      */
     virtual SpriteFrame* displayFrame(void);
+
+    /**
+     * Displays a frame of an animation from its flipbook table.
+     * It shows the same image as setDisplayFrame() with the frame's SpriteFrame,
+     * but it only rewrites the quad, with texture coordinates computed when the table was built.
+     * @since v3.0
+     */
+    void setFlipbookFrame(const AnimationFlipbookFrame& frame);
     
     /// @} End of frames methods
     
@@ -487,11 +512,17 @@ public:
     virtual void setOpacityModifyRGB(bool modify) override;
     virtual bool isOpacityModifyRGB(void) const override;
     virtual void updateDisplayedOpacity(GLubyte parentOpacity) override;
+    /** also unflips the sprite, the texture and its rect are kept */
+    virtual void resetForReuse() override;
     /// @}
 
 protected:
     void updateColor(void);
     virtual void setTextureCoords(Rect rect);
+    /// writes the texture coordinates of an unflipped rect into the quad, applying the rotation and flips
+    void applyTextureCoords(float left, float right, float top, float bottom);
+    /// recomputes _offsetPosition and, when not batched, the quad vertices from _rect and _contentSize
+    void updateOffsetAndVertices();
     virtual void updateBlendFunc(void);
     virtual void setReorderChildDirtyRecursively(void);
     virtual void setDirtyRecursively(bool bValue);
@@ -530,6 +561,9 @@ protected:
     // vertex coords, texture coords and color info
     V3F_C4B_T2F_Quad _quad;
 
+    // command submitted to the Renderer when the sprite isn't rendered by a SpriteBatchNode
+    QuadCommand _quadCommand;
+
     // opacity and RGB protocol
     bool _opacityModifyRGB;
 
@@ -35,9 +35,12 @@ THE SOFTWARE.
 #include "shaders/ccGLStateCache.h"
 #include "CCDirector.h"
 #include "support/TransformUtils.h"
-#include "support/CCProfiling.h"
+#include "support/CCFrameProfiler.h"
+#include "support/CCJobSystem.h"
+#include "renderer/CCRenderer.h"
 // external
 #include "kazmath/GL/matrix.h"
+#include <algorithm>
 
 NS_CC_BEGIN
 
@@ -87,13 +90,13 @@ bool SpriteBatchNode::initWithTexture(Texture2D *tex, int capacity)
     updateBlendFunc();
 
     // no lazy alloc in this node
-    _children = new Array();
-    _children->initWithCapacity(capacity);
+    _children.reserve(capacity);
 
     _descendants = new Array();
     _descendants->initWithCapacity(capacity);
 
-    setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR));
+    ShaderCache* shaderCache = ShaderCache::getInstance();
+    setShaderProgram(shaderCache->programForTexture(shaderCache->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR), tex));
     return true;
 }
 
@@ -116,6 +119,8 @@ bool SpriteBatchNode::initWithFile(const char* fileImage, int capacity)
 SpriteBatchNode::SpriteBatchNode()
 : _textureAtlas(NULL)
 , _descendants(NULL)
+, _parallelQuadUpdate(false)
+, _deferredRemoval(false)
 {
 }
 
@@ -129,7 +134,7 @@ SpriteBatchNode::~SpriteBatchNode()
 // don't call visit on it's children
 void SpriteBatchNode::visit(void)
 {
-    CC_PROFILER_START_CATEGORY(kProfilerCategoryBatchSprite, "CCSpriteBatchNode - visit");
+    CC_PROFILE_ZONE("CCSpriteBatchNode - visit");
 
     // CAREFUL:
     // This visit is almost identical to CocosNode#visit
@@ -163,8 +168,6 @@ void SpriteBatchNode::visit(void)
 
     kmGLPopMatrix();
     setOrderOfArrival(0);
-
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryBatchSprite, "CCSpriteBatchNode - visit");
 }
 
 void SpriteBatchNode::addChild(Node *child, int zOrder, int tag)
@@ -194,7 +197,7 @@ void SpriteBatchNode::addChild(Node *child, int zOrder)
 void SpriteBatchNode::reorderChild(Node *child, int zOrder)
 {
     CCASSERT(child != NULL, "the child should not be null");
-    CCASSERT(_children->containsObject(child), "Child doesn't belong to Sprite");
+    CCASSERT(_children.contains(child), "Child doesn't belong to Sprite");
 
     if (zOrder == child->getZOrder())
     {
@@ -216,7 +219,7 @@ void SpriteBatchNode::removeChild(Node *child, bool cleanup)
         return;
     }
 
-    CCASSERT(_children->containsObject(pSprite), "sprite batch node should contain the child");
+    CCASSERT(_children.contains(pSprite), "sprite batch node should contain the child");
 
     // cleanup before removing
     removeSpriteFromAtlas(pSprite);
@@ -226,11 +229,14 @@ void SpriteBatchNode::removeChild(Node *child, bool cleanup)
 
 void SpriteBatchNode::removeChildAtIndex(unsigned int uIndex, bool bDoCleanup)
 {
-    removeChild((Sprite*)(_children->objectAtIndex(uIndex)), bDoCleanup);
+    removeChild(_children.at(uIndex), bDoCleanup);
 }
 
 void SpriteBatchNode::removeAllChildrenWithCleanup(bool bCleanup)
 {
+    // the removed sprites may belong to another batch node by now
+    compactAtlas();
+
     // Invalidate atlas index. issue #569
     // useSelfRender should be performed on all descendants. issue #1216
     arrayMakeObjectsPerformSelectorWithObject(_descendants, setBatchNode, NULL, Sprite*);
@@ -244,43 +250,28 @@ void SpriteBatchNode::removeAllChildrenWithCleanup(bool bCleanup)
 //override sortAllChildren
 void SpriteBatchNode::sortAllChildren()
 {
+    compactAtlas();
+
     if (_reorderChildDirty)
     {
-        int i = 0,j = 0,length = _children->data->num;
-        Node ** x = (Node**)_children->data->arr;
-        Node *tempItem = NULL;
-
-        //insertion sort
-        for(i=1; i<length; i++)
-        {
-            tempItem = x[i];
-            j = i-1;
-
-            //continue moving element downwards while zOrder is smaller or when zOrder is the same but orderOfArrival is smaller
-            while(j>=0 && ( tempItem->getZOrder() < x[j]->getZOrder() || ( tempItem->getZOrder() == x[j]->getZOrder() && tempItem->getOrderOfArrival() < x[j]->getOrderOfArrival() ) ) )
-            {
-                x[j+1] = x[j];
-                j--;
-            }
-
-            x[j+1] = tempItem;
-        }
+        sortNodes(_children.data(), _children.size());
 
         //sorted now check all children
-        if (_children->count() > 0)
+        if (!_children.empty())
         {
             //first sort all children recursively based on zOrder
-            arrayMakeObjectsPerformSelector(_children, sortAllChildren, Sprite*);
+            for (auto child : _children)
+            {
+                child->sortAllChildren();
+            }
 
             int index=0;
 
-            Object* pObj = NULL;
             //fast dispatch, give every child a new atlasIndex based on their relative zOrder (keep parent -> child relations intact)
             // and at the same time reorder descendants and the quads to the right index
-            CCARRAY_FOREACH(_children, pObj)
+            for (auto child : _children)
             {
-                Sprite* child = static_cast<Sprite*>(pObj);
-                updateAtlasIndex(child, &index);
+                updateAtlasIndex(static_cast<Sprite*>(child), &index);
             }
         }
 
@@ -290,13 +281,9 @@ void SpriteBatchNode::sortAllChildren()
 
 void SpriteBatchNode::updateAtlasIndex(Sprite* sprite, int* curIndex)
 {
-    unsigned int count = 0;
-    Array* array = sprite->getChildren();
-    if (array != NULL)
-    {
-        count = array->count();
-    }
-    
+    auto& array = sprite->getChildren();
+    unsigned int count = array.size();
+
     int oldIndex = 0;
 
     if( count == 0 )
@@ -313,7 +300,7 @@ void SpriteBatchNode::updateAtlasIndex(Sprite* sprite, int* curIndex)
     {
         bool needNewIndex=true;
 
-        if (static_cast<Sprite*>(array->data->arr[0])->getZOrder() >= 0)
+        if (array.front()->getZOrder() >= 0)
         {
             //all children are in front of the parent
             oldIndex = sprite->getAtlasIndex();
@@ -328,10 +315,9 @@ void SpriteBatchNode::updateAtlasIndex(Sprite* sprite, int* curIndex)
             needNewIndex = false;
         }
 
-        Object* pObj = NULL;
-        CCARRAY_FOREACH(array,pObj)
+        for (auto node : array)
         {
-            Sprite* child = static_cast<Sprite*>(pObj);
+            Sprite* child = static_cast<Sprite*>(node);
             if (needNewIndex && child->getZOrder() >= 0)
             {
                 oldIndex = sprite->getAtlasIndex();
@@ -383,10 +369,87 @@ void SpriteBatchNode::reorderBatch(bool reorder)
     _reorderChildDirty=reorder;
 }
 
+void SpriteBatchNode::addLevel(const Vector<Node*>& children)
+{
+    for (auto child : children)
+    {
+        Sprite* sprite = static_cast<Sprite*>(child);
+        if (typeid(*sprite) == typeid(Sprite))
+        {
+            _levelSprites.push_back(sprite);
+        }
+        else
+        {
+            _serialSprites.push_back(sprite);
+        }
+    }
+}
+
+void SpriteBatchNode::updateQuadsInParallel()
+{
+    CC_PROFILE_ZONE("CCSpriteBatchNode - updateQuadsInParallel");
+
+    _levelSprites.clear();
+    _levelEnds.clear();
+    _serialSprites.clear();
+    _serialLevelEnds.clear();
+
+    // flatten the tree: the children of the sprites of a level make the next level.
+    // The subclasses keep their children, updateTransform() visits them.
+    addLevel(_children);
+    _levelEnds.push_back(_levelSprites.size());
+    _serialLevelEnds.push_back(_serialSprites.size());
+    for (unsigned int begin = 0; begin < _levelSprites.size(); )
+    {
+        unsigned int end = _levelSprites.size();
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            addLevel(_levelSprites[i]->getChildren());
+        }
+        _levelEnds.push_back(_levelSprites.size());
+        _serialLevelEnds.push_back(_serialSprites.size());
+        begin = end;
+    }
+
+    std::vector<Sprite*>& sprites = _levelSprites;
+    unsigned int levelBegin = 0;
+    unsigned int serialBegin = 0;
+    for (size_t level = 0; level < _levelEnds.size(); ++level)
+    {
+        unsigned int levelEnd = _levelEnds[level];
+        // the dirty flags are cleared by commitQuadToAtlas(), once all the levels are done
+        JobSystem::getInstance()->parallelFor(levelEnd - levelBegin, 64, [&sprites, levelBegin](unsigned int begin, unsigned int end) {
+            for (unsigned int i = levelBegin + begin; i < levelBegin + end; ++i)
+            {
+                if (sprites[i]->isDirty())
+                {
+                    sprites[i]->updateQuadInBatch();
+                }
+            }
+        });
+        levelBegin = levelEnd;
+
+        for (unsigned int i = serialBegin; i < _serialLevelEnds[level]; ++i)
+        {
+            _serialSprites[i]->updateTransform();
+        }
+        serialBegin = _serialLevelEnds[level];
+    }
+
+    // the texture atlas tracks its dirty range, so the quads are written on this thread
+    for (auto sprite : _levelSprites)
+    {
+        if (sprite->isDirty())
+        {
+            sprite->commitQuadToAtlas();
+        }
+    }
+}
+
 // draw
 void SpriteBatchNode::draw(void)
 {
-    CC_PROFILER_START("CCSpriteBatchNode - draw");
+    CC_PROFILE_ZONE("CCSpriteBatchNode - draw");
 
     // Optimization: Fast Dispatch
     if( _textureAtlas->getTotalQuads() == 0 )
@@ -394,15 +457,70 @@ void SpriteBatchNode::draw(void)
         return;
     }
 
-    CC_NODE_DRAW_SETUP();
+    // the colors of the children aren't known, only the blending picks the variant
+    GLProgram* program = ShaderCache::getInstance()->programForQuads(_shaderProgram, _textureAtlas->getTexture(), _blendFunc, NULL);
+    if (program != _shaderProgram)
+    {
+        setShaderProgram(program);
+    }
+
+    // below a few hundred sprites the jobs cost more than they save
+    if (_parallelQuadUpdate && _descendants->count() >= 256)
+    {
+        updateQuadsInParallel();
+    }
+    else
+    {
+        for (auto child : _children)
+        {
+            child->updateTransform();
+        }
+    }
 
-    arrayMakeObjectsPerformSelector(_children, updateTransform, Sprite*);
+#if CC_USE_CULLING
+    kmMat4 mv, mvp;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
+    kmGLGetMatrix(KM_GL_PROJECTION, &mvp);
+    kmMat4Multiply(&mvp, &mvp, &mv);
+
+    V3F_C4B_T2F_Quad* quads = _textureAtlas->getQuads();
+    int totalQuads = _textureAtlas->getTotalQuads();
+
+    int i = 0;
+    while (i < totalQuads && isQuadVisible(&mvp, &quads[i]))
+    {
+        ++i;
+    }
+
+    if (i < totalQuads)
+    {
+        // some quads are outside the viewport: only the visible ones are sent to the Renderer
+        _visibleQuads.assign(quads, quads + i);
+        for (++i; i < totalQuads; ++i)
+        {
+            if (isQuadVisible(&mvp, &quads[i]))
+            {
+                _visibleQuads.push_back(quads[i]);
+            }
+        }
+
+        if (!_visibleQuads.empty())
+        {
+            Texture2D* texture = _textureAtlas->getTexture();
+            Texture2D* alphaTexture = texture->getAlphaTexture();
+            _quadCommand.init(texture->getName(), _shaderProgram, _blendFunc, &_visibleQuads[0], (int)_visibleQuads.size(), mv,
+                              alphaTexture ? alphaTexture->getName() : 0);
+            Director::getInstance()->getRenderer()->addCommand(&_quadCommand);
+        }
+        return;
+    }
+#endif // CC_USE_CULLING
+
+    CC_NODE_DRAW_SETUP();
 
     GL::blendFunc( _blendFunc.src, _blendFunc.dst );
 
     _textureAtlas->drawQuads();
-
-    CC_PROFILER_STOP("CCSpriteBatchNode - draw");
 }
 
 void SpriteBatchNode::increaseAtlasCapacity(void)
@@ -426,20 +544,15 @@ void SpriteBatchNode::increaseAtlasCapacity(void)
 
 unsigned int SpriteBatchNode::rebuildIndexInOrder(Sprite *pobParent, unsigned int uIndex)
 {
-    Array *children = pobParent->getChildren();
+    auto& children = pobParent->getChildren();
 
-    if (children && children->count() > 0)
+    for (auto child : children)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(children, pObject)
+        if (child->getZOrder() < 0)
         {
-            Sprite* child = static_cast<Sprite*>(pObject);
-            if (child && (child->getZOrder() < 0))
-            {
-                uIndex = rebuildIndexInOrder(child, uIndex);
-            }
+            uIndex = rebuildIndexInOrder(static_cast<Sprite*>(child), uIndex);
         }
-    }    
+    }
 
     // ignore self (batch node)
     if (! pobParent->isEqual(this))
@@ -448,16 +561,11 @@ unsigned int SpriteBatchNode::rebuildIndexInOrder(Sprite *pobParent, unsigned in
         uIndex++;
     }
 
-    if (children && children->count() > 0)
+    for (auto child : children)
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(children, pObject)
+        if (child->getZOrder() >= 0)
         {
-            Sprite* child = static_cast<Sprite*>(pObject);
-            if (child && (child->getZOrder() >= 0))
-            {
-                uIndex = rebuildIndexInOrder(child, uIndex);
-            }
+            uIndex = rebuildIndexInOrder(static_cast<Sprite*>(child), uIndex);
         }
     }
 
@@ -466,50 +574,49 @@ unsigned int SpriteBatchNode::rebuildIndexInOrder(Sprite *pobParent, unsigned in
 
 unsigned int SpriteBatchNode::highestAtlasIndexInChild(Sprite *pSprite)
 {
-    Array *children = pSprite->getChildren();
+    auto& children = pSprite->getChildren();
 
-    if (! children || children->count() == 0)
+    if (children.empty())
     {
         return pSprite->getAtlasIndex();
     }
     else
     {
-        return highestAtlasIndexInChild((Sprite*)(children->lastObject()));
+        return highestAtlasIndexInChild(static_cast<Sprite*>(children.back()));
     }
 }
 
 unsigned int SpriteBatchNode::lowestAtlasIndexInChild(Sprite *pSprite)
 {
-    Array *children = pSprite->getChildren();
+    auto& children = pSprite->getChildren();
 
-    if (! children || children->count() == 0)
+    if (children.empty())
     {
         return pSprite->getAtlasIndex();
     }
     else
     {
-        return lowestAtlasIndexInChild((Sprite*)(children->objectAtIndex(0)));
+        return lowestAtlasIndexInChild(static_cast<Sprite*>(children.front()));
     }
 }
 
 unsigned int SpriteBatchNode::atlasIndexForChild(Sprite *sprite, int nZ)
 {
-    Array *pBrothers = sprite->getParent()->getChildren();
-    unsigned int uChildIndex = pBrothers->indexOfObject(sprite);
+    auto& brothers = sprite->getParent()->getChildren();
+    int childIndex = brothers.getIndex(sprite);
 
     // ignore parent Z if parent is spriteSheet
     bool bIgnoreParent = (SpriteBatchNode*)(sprite->getParent()) == this;
     Sprite *pPrevious = NULL;
-    if (uChildIndex > 0 &&
-        uChildIndex < UINT_MAX)
+    if (childIndex > 0)
     {
-        pPrevious = (Sprite*)(pBrothers->objectAtIndex(uChildIndex - 1));
+        pPrevious = static_cast<Sprite*>(brothers.at(childIndex - 1));
     }
 
     // first child of the sprite sheet
     if (bIgnoreParent)
     {
-        if (uChildIndex == 0)
+        if (childIndex == 0)
         {
             return 0;
         }
@@ -520,7 +627,7 @@ unsigned int SpriteBatchNode::atlasIndexForChild(Sprite *sprite, int nZ)
     // parent is a Sprite, so, it must be taken into account
 
     // first child of an Sprite ?
-    if (uChildIndex == 0)
+    if (childIndex == 0)
     {
         Sprite *p = (Sprite*)(sprite->getParent());
 
@@ -556,6 +663,8 @@ unsigned int SpriteBatchNode::atlasIndexForChild(Sprite *sprite, int nZ)
 
 void SpriteBatchNode::insertChild(Sprite *pSprite, unsigned int uIndex)
 {
+    compactAtlas();
+
     pSprite->setBatchNode(this);
     pSprite->setAtlasIndex(uIndex);
     pSprite->setDirty(true);
@@ -582,10 +691,9 @@ void SpriteBatchNode::insertChild(Sprite *pSprite, unsigned int uIndex)
     }
 
     // add children recursively
-    Object* pObj = nullptr;
-    CCARRAY_FOREACH(pSprite->getChildren(), pObj)
+    for (auto node : pSprite->getChildren())
     {
-        child = static_cast<Sprite*>(pObj);
+        child = static_cast<Sprite*>(node);
         unsigned int idx = atlasIndexForChild(child, child->getZOrder());
         insertChild(child, idx);
     }
@@ -594,6 +702,8 @@ void SpriteBatchNode::insertChild(Sprite *pSprite, unsigned int uIndex)
 // addChild helper, faster than insertChild
 void SpriteBatchNode::appendChild(Sprite* sprite)
 {
+    compactAtlas();
+
     _reorderChildDirty=true;
     sprite->setBatchNode(this);
     sprite->setDirty(true);
@@ -615,16 +725,34 @@ void SpriteBatchNode::appendChild(Sprite* sprite)
 
     // add children recursively
     
-    Object* pObj = nullptr;
-    CCARRAY_FOREACH(sprite->getChildren(), pObj)
+    for (auto child : sprite->getChildren())
     {
-        Sprite* child = static_cast<Sprite*>(pObj);
-        appendChild(child);
+        appendChild(static_cast<Sprite*>(child));
     }
 }
 
 void SpriteBatchNode::removeSpriteFromAtlas(Sprite *sprite)
 {
+    if (_deferredRemoval)
+    {
+        unsigned int index = sprite->getAtlasIndex();
+        CCASSERT(index < _descendants->count() && _descendants->getObjectAtIndex(index) == sprite, "Invalid atlas index");
+
+        // leave a degenerate quad, compactAtlas() moves the following ones
+        V3F_C4B_T2F_Quad quad = sprite->getQuad();
+        quad.br.vertices = quad.tl.vertices = quad.tr.vertices = quad.bl.vertices = Vertex3F(0,0,0);
+        _textureAtlas->updateQuad(&quad, index);
+        _atlasHoles.push_back(index);
+
+        sprite->setBatchNode(NULL);
+
+        for (auto child : sprite->getChildren())
+        {
+            removeSpriteFromAtlas(static_cast<Sprite*>(child));
+        }
+        return;
+    }
+
     // remove from TextureAtlas
     _textureAtlas->removeQuadAtIndex(sprite->getAtlasIndex());
 
@@ -647,19 +775,58 @@ void SpriteBatchNode::removeSpriteFromAtlas(Sprite *sprite)
     }
 
     // remove children recursively
-    Array *children = sprite->getChildren();
-    if (children && children->count() > 0)
+    for (auto child : sprite->getChildren())
+    {
+        removeSpriteFromAtlas(static_cast<Sprite*>(child));
+    }
+}
+
+void SpriteBatchNode::setDeferredRemovalEnabled(bool enabled)
+{
+    if (! enabled)
+    {
+        compactAtlas();
+    }
+    _deferredRemoval = enabled;
+}
+
+void SpriteBatchNode::compactAtlas()
+{
+    if (_atlasHoles.empty())
     {
-        Object* pObject = NULL;
-        CCARRAY_FOREACH(children, pObject)
+        return;
+    }
+
+    CC_PROFILE_ZONE("CCSpriteBatchNode - compactAtlas");
+
+    std::sort(_atlasHoles.begin(), _atlasHoles.end());
+
+    ccArray *descendantsData = _descendants->data;
+    V3F_C4B_T2F_Quad* quads = _textureAtlas->getQuads();
+    unsigned int count = descendantsData->num;
+    unsigned int holeCount = _atlasHoles.size();
+    unsigned int hole = 0;
+    unsigned int dst = _atlasHoles[0];
+
+    for (unsigned int src = dst; src < count; ++src)
+    {
+        if (hole < holeCount && _atlasHoles[hole] == src)
         {
-            Sprite* child = static_cast<Sprite*>(pObject);
-            if (child)
-            {
-                removeSpriteFromAtlas(child);
-            }
+            descendantsData->arr[src]->release();
+            ++hole;
+            continue;
         }
+
+        Sprite* sprite = static_cast<Sprite*>(descendantsData->arr[src]);
+        descendantsData->arr[dst] = sprite;
+        quads[dst] = quads[src];
+        sprite->setAtlasIndex(dst);
+        ++dst;
     }
+
+    descendantsData->num = dst;
+    _textureAtlas->removeQuadsAtIndex(dst, count - dst);
+    _atlasHoles.clear();
 }
 
 void SpriteBatchNode::updateBlendFunc(void)
@@ -688,6 +855,7 @@ void SpriteBatchNode::setTexture(Texture2D *texture)
 {
     _textureAtlas->setTexture(texture);
     updateBlendFunc();
+    setShaderProgram(ShaderCache::getInstance()->programForTexture(_shaderProgram, texture));
 }
 
 
@@ -699,6 +867,8 @@ void SpriteBatchNode::insertQuadFromSprite(Sprite *sprite, int index)
     CCASSERT( sprite != NULL, "Argument must be non-NULL");
     CCASSERT( dynamic_cast<Sprite*>(sprite), "CCSpriteBatchNode only supports Sprites as children");
 
+    compactAtlas();
+
     // make needed room
     while(index >= _textureAtlas->getCapacity() || _textureAtlas->getCapacity() == _textureAtlas->getTotalQuads())
     {
@@ -33,6 +33,8 @@ THE SOFTWARE.
 #include "textures/CCTextureAtlas.h"
 #include "ccMacros.h"
 #include "cocoa/CCArray.h"
+#include "renderer/CCQuadCommand.h"
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -103,7 +105,7 @@ public:
         }
     }
 
-    inline Array* getDescendants(void) { return _descendants; }
+    inline Array* getDescendants(void) { compactAtlas(); return _descendants; }
 
     void increaseAtlasCapacity();
 
@@ -123,6 +125,31 @@ public:
     /* Sprites use this to start sortChildren, don't call this manually */
     void reorderBatch(bool reorder);
 
+    /** Computes the quads of the dirty sprites on the JobSystem before they are written to the texture atlas.
+     The descendants are flattened level by level, and the sprites of a level are computed in parallel
+     once the ones of the previous level are up to date.
+     Worth it for batch nodes with thousands of moving sprites. Default: false.
+     @warning The subclasses of Sprite may override updateTransform(): they are updated, with their children, on the calling thread.
+     @since v3.0
+     */
+    inline void setParallelQuadUpdateEnabled(bool enabled) { _parallelQuadUpdate = enabled; }
+    inline bool isParallelQuadUpdateEnabled() const { return _parallelQuadUpdate; }
+
+    /** Removed sprites leave a degenerate quad in the texture atlas instead of moving all the following quads,
+     and the holes are compacted in one pass before the next visit or the next insertion.
+     Worth it when many sprites are removed per frame from a large batch node. Default: false.
+     @warning The atlas indices of the other sprites only change when the atlas is compacted,
+     so it doesn't fit subclasses that manage the quads themselves, like TMXLayer.
+     @since v3.0
+     */
+    void setDeferredRemovalEnabled(bool enabled);
+    inline bool isDeferredRemovalEnabled() const { return _deferredRemoval; }
+
+    /** Removes the holes left by the deferred removals, and updates the atlas indices of the sprites that follow them.
+     @since v3.0
+     */
+    void compactAtlas();
+
     //
     // Overrides
     //
@@ -163,6 +190,8 @@ private:
     void updateAtlasIndex(Sprite* sprite, int* curIndex);
     void swap(int oldIndex, int newIndex);
     void updateBlendFunc();
+    void updateQuadsInParallel();
+    void addLevel(const Vector<Node*>& children);
 
 protected:
     TextureAtlas *_textureAtlas;
@@ -170,6 +199,23 @@ protected:
 
     // all descendants: children, grand children, etc...
     Array* _descendants;
+
+    bool _parallelQuadUpdate;
+    bool _deferredRemoval;
+    // atlas indices of the sprites removed since the last compactAtlas()
+    std::vector<unsigned int> _atlasHoles;
+    // descendants flattened by updateQuadsInParallel(), level after level
+    std::vector<Sprite*> _levelSprites;
+    std::vector<unsigned int> _levelEnds;
+    // subclasses of Sprite met in each level, updated on the calling thread
+    std::vector<Sprite*> _serialSprites;
+    std::vector<unsigned int> _serialLevelEnds;
+
+#if CC_USE_CULLING
+    // quads of the children inside the viewport, used when some children are culled
+    std::vector<V3F_C4B_T2F_Quad> _visibleQuads;
+    QuadCommand _quadCommand;
+#endif
 };
 
 // end of sprite_nodes group
@@ -34,10 +34,14 @@ THE SOFTWARE.
 #include "CCSprite.h"
 #include "support/TransformUtils.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
 #include "cocoa/CCString.h"
 #include "cocoa/CCArray.h"
 #include "cocoa/CCDictionary.h"
+#include "CCDirector.h"
+#include "CCScheduler.h"
 #include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -63,19 +67,67 @@ void SpriteFrameCache::destroyInstance()
 
 bool SpriteFrameCache::init(void)
 {
-    _spriteFrames= new Dictionary();
-    _spriteFramesAliases = new Dictionary();
     _loadedFileNames = new std::set<std::string>();
     return true;
 }
 
 SpriteFrameCache::~SpriteFrameCache(void)
 {
-    CC_SAFE_RELEASE(_spriteFrames);
-    CC_SAFE_RELEASE(_spriteFramesAliases);
     CC_SAFE_DELETE(_loadedFileNames);
+
+    // drop the asynchronous loads that were not completed: their callbacks won't be called
+    for (auto& task : _asyncTasks)
+    {
+        JobSystem::getInstance()->cancelTask(task);
+    }
 }
 
+/** Target of the asynchronous texture load of a plist loaded with addSpriteFramesWithFileAsync().
+ TextureCache releases it once the texture is loaded, or if the load failed or was cancelled.
+ */
+class SpriteFramesAsyncLoader : public Object
+{
+public:
+    SpriteFramesAsyncLoader(const std::string& plist, Dictionary* dictionary, const std::function<void(bool)>& callback)
+    : _plist(plist)
+    , _dictionary(dictionary)
+    , _callback(callback)
+    , _done(false)
+    {
+    }
+
+    virtual ~SpriteFramesAsyncLoader()
+    {
+        if (!_done && _callback)
+        {
+            CCLOG("cocos2d: SpriteFrameCache: Couldn't load the texture of %s", _plist.c_str());
+            _callback(false);
+        }
+    }
+
+    void textureLoaded(Object* obj)
+    {
+        SpriteFrameCache* cache = SpriteFrameCache::getInstance();
+        if (cache->_loadedFileNames->find(_plist) == cache->_loadedFileNames->end())
+        {
+            cache->addSpriteFramesWithDictionary(_dictionary, static_cast<Texture2D*>(obj));
+            cache->_loadedFileNames->insert(_plist);
+        }
+
+        _done = true;
+        if (_callback)
+        {
+            _callback(true);
+        }
+    }
+
+private:
+    std::string _plist;
+    RefPtr<Dictionary> _dictionary;
+    std::function<void(bool)> _callback;
+    bool _done;
+};
+
 void SpriteFrameCache::addSpriteFramesWithDictionary(Dictionary* dictionary, Texture2D *pobTexture)
 {
     /*
@@ -100,12 +152,14 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(Dictionary* dictionary, Tex
     // check the format
     CCASSERT(format >=0 && format <= 3, "format is not supported for SpriteFrameCache addSpriteFramesWithDictionary:textureFilename:");
 
+    _spriteFrames.reserve(_spriteFrames.count() + framesDict->count());
+
     DictElement* pElement = NULL;
     CCDICT_FOREACH(framesDict, pElement)
     {
         Dictionary* frameDict = static_cast<Dictionary*>(pElement->getObject());
         std::string spriteFrameName = pElement->getStrKey();
-        SpriteFrame* spriteFrame = static_cast<SpriteFrame*>(_spriteFrames->objectForKey(spriteFrameName));
+        SpriteFrame* spriteFrame = static_cast<SpriteFrame*>(_spriteFrames.objectForKey(spriteFrameName));
         if (spriteFrame)
         {
             continue;
@@ -178,12 +232,12 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(Dictionary* dictionary, Tex
             CCARRAY_FOREACH(aliases, pObj)
             {
                 std::string oneAlias = static_cast<String*>(pObj)->getCString();
-                if (_spriteFramesAliases->objectForKey(oneAlias.c_str()))
+                if (_spriteFramesAliases.objectForKey(oneAlias.c_str()))
                 {
                     CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", oneAlias.c_str());
                 }
 
-                _spriteFramesAliases->setObject(frameKey, oneAlias.c_str());
+                _spriteFramesAliases.setObject(frameKey, oneAlias.c_str());
             }
             frameKey->release();
             // create frame
@@ -196,13 +250,226 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(Dictionary* dictionary, Tex
         }
 
         // add sprite frame
-        _spriteFrames->setObject(spriteFrame, spriteFrameName);
+        _spriteFrames.setObject(spriteFrame, spriteFrameName);
         spriteFrame->release();
     }
 }
 
+// Binary sprite frame files (.ccsf), created by tools/spriteframe_converter.
+// All the values are little endian, and 4 bytes aligned:
+//   Header
+//   FrameRecord[frameCount]
+//   AliasRecord[aliasCount]
+//   string table: stringTableSize bytes of '\0' terminated names
+static const char BINARY_FRAMES_MAGIC[4] = { 'C', 'C', 'S', 'F' };
+static const unsigned int BINARY_FRAMES_VERSION = 1;
+static const unsigned int BINARY_FRAMES_NO_NAME = 0xffffffff;
+
+struct BinaryFramesHeader
+{
+    char magic[4];
+    unsigned int version;
+    unsigned int frameCount;
+    unsigned int aliasCount;
+    unsigned int textureNameOffset; // BINARY_FRAMES_NO_NAME when the texture has the name of the file
+    unsigned int stringTableSize;
+};
+
+struct BinaryFrameRecord
+{
+    unsigned int nameOffset;
+    float rect[4];                  // x, y, width, height in the texture
+    float offset[2];
+    float sourceSize[2];
+    unsigned int rotated;
+};
+
+struct BinaryAliasRecord
+{
+    unsigned int nameOffset;
+    unsigned int frameIndex;
+};
+
+static bool isBinaryFramesFile(const char* filename)
+{
+    size_t len = strlen(filename);
+    return len > 5 && strcmp(filename + len - 5, ".ccsf") == 0;
+}
+
+struct BinaryFrames
+{
+    const BinaryFramesHeader* header;
+    const BinaryFrameRecord* frames;
+    const BinaryAliasRecord* aliases;
+    const char* strings;
+};
+
+// validates the file, and finds its sections. The data is used in place
+static bool parseBinaryFrames(const unsigned char* data, unsigned long size, BinaryFrames* out)
+{
+    if (data == NULL || size < sizeof(BinaryFramesHeader))
+    {
+        return false;
+    }
+
+    const BinaryFramesHeader* header = reinterpret_cast<const BinaryFramesHeader*>(data);
+    if (memcmp(header->magic, BINARY_FRAMES_MAGIC, sizeof(BINARY_FRAMES_MAGIC)) != 0 || header->version != BINARY_FRAMES_VERSION)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: invalid binary sprite frame file (version %u)", header->version);
+        return false;
+    }
+
+    unsigned long framesSize = (unsigned long)header->frameCount * sizeof(BinaryFrameRecord);
+    unsigned long aliasesSize = (unsigned long)header->aliasCount * sizeof(BinaryAliasRecord);
+    if (sizeof(BinaryFramesHeader) + framesSize + aliasesSize + header->stringTableSize > size
+        || header->stringTableSize == 0)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: truncated binary sprite frame file");
+        return false;
+    }
+
+    out->header = header;
+    out->frames = reinterpret_cast<const BinaryFrameRecord*>(data + sizeof(BinaryFramesHeader));
+    out->aliases = reinterpret_cast<const BinaryAliasRecord*>(data + sizeof(BinaryFramesHeader) + framesSize);
+    out->strings = reinterpret_cast<const char*>(data + sizeof(BinaryFramesHeader) + framesSize + aliasesSize);
+
+    // names are read in place: the table must end with a '\0'
+    if (out->strings[header->stringTableSize - 1] != '\0')
+    {
+        CCLOG("cocos2d: SpriteFrameCache: corrupted binary sprite frame file");
+        return false;
+    }
+
+    return true;
+}
+
+bool SpriteFrameCache::addSpriteFramesWithBinaryData(const unsigned char* data, unsigned long size, Texture2D *texture, std::string* textureFileName)
+{
+    BinaryFrames binaryFrames;
+    if (!parseBinaryFrames(data, size, &binaryFrames))
+    {
+        return false;
+    }
+
+    const BinaryFramesHeader* header = binaryFrames.header;
+    const BinaryFrameRecord* frames = binaryFrames.frames;
+    const BinaryAliasRecord* aliases = binaryFrames.aliases;
+    const char* strings = binaryFrames.strings;
+    unsigned int stringTableSize = header->stringTableSize;
+
+    if (textureFileName)
+    {
+        *textureFileName = header->textureNameOffset < stringTableSize ? strings + header->textureNameOffset : "";
+    }
+
+    if (texture == NULL)
+    {
+        return true;
+    }
+
+    _spriteFrames.reserve(_spriteFrames.count() + header->frameCount);
+
+    for (unsigned int i = 0; i < header->frameCount; i++)
+    {
+        const BinaryFrameRecord& record = frames[i];
+        if (record.nameOffset >= stringTableSize)
+        {
+            continue;
+        }
+
+        const char* spriteFrameName = strings + record.nameOffset;
+        if (_spriteFrames.objectForKey(spriteFrameName))
+        {
+            continue;
+        }
+
+        SpriteFrame* spriteFrame = new SpriteFrame();
+        spriteFrame->initWithTexture(texture,
+                                     Rect(record.rect[0], record.rect[1], record.rect[2], record.rect[3]),
+                                     record.rotated != 0,
+                                     Point(record.offset[0], record.offset[1]),
+                                     Size(record.sourceSize[0], record.sourceSize[1]));
+        _spriteFrames.setObject(spriteFrame, spriteFrameName);
+        spriteFrame->release();
+    }
+
+    for (unsigned int i = 0; i < header->aliasCount; i++)
+    {
+        const BinaryAliasRecord& alias = aliases[i];
+        if (alias.nameOffset >= stringTableSize || alias.frameIndex >= header->frameCount
+            || frames[alias.frameIndex].nameOffset >= stringTableSize)
+        {
+            continue;
+        }
+
+        const char* aliasName = strings + alias.nameOffset;
+        if (_spriteFramesAliases.objectForKey(aliasName))
+        {
+            CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", aliasName);
+        }
+
+        String* frameKey = new String(strings + frames[alias.frameIndex].nameOffset);
+        _spriteFramesAliases.setObject(frameKey, aliasName);
+        frameKey->release();
+    }
+
+    return true;
+}
+
+bool SpriteFrameCache::addSpriteFramesWithBinaryFile(const char* filename, Texture2D *texture)
+{
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
+
+    MappedFile* file = FileUtils::getInstance()->getMappedFileData(fullPath.c_str());
+    if (file == NULL)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: Couldn't open %s", filename);
+        return false;
+    }
+    const unsigned char* data = file->getBytes();
+    unsigned long size = file->getSize();
+
+    std::string textureFileName;
+    bool ret = addSpriteFramesWithBinaryData(data, size, NULL, &textureFileName);
+    if (ret && texture == NULL)
+    {
+        std::string texturePath;
+        if (!textureFileName.empty())
+        {
+            // build texture path relative to the file
+            texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(textureFileName.c_str(), filename);
+        }
+        else
+        {
+            // build texture path by replacing file extension
+            texturePath = filename;
+            texturePath = texturePath.erase(texturePath.find_last_of(".")).append(".png");
+        }
+
+        texture = TextureCache::getInstance()->addImage(texturePath.c_str());
+        if (texture == NULL)
+        {
+            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+            ret = false;
+        }
+    }
+
+    if (ret)
+    {
+        ret = addSpriteFramesWithBinaryData(data, size, texture, NULL);
+    }
+
+    return ret;
+}
+
 void SpriteFrameCache::addSpriteFramesWithFile(const char *pszPlist, Texture2D *pobTexture)
 {
+    if (isBinaryFramesFile(pszPlist))
+    {
+        addSpriteFramesWithBinaryFile(pszPlist, pobTexture);
+        return;
+    }
+
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(pszPlist);
     Dictionary *dict = Dictionary::createWithContentsOfFileThreadSafe(fullPath.c_str());
 
@@ -232,81 +499,160 @@ void SpriteFrameCache::addSpriteFramesWithFile(const char *pszPlist)
 
     if (_loadedFileNames->find(pszPlist) == _loadedFileNames->end())
     {
+        if (isBinaryFramesFile(pszPlist))
+        {
+            if (addSpriteFramesWithBinaryFile(pszPlist, NULL))
+            {
+                _loadedFileNames->insert(pszPlist);
+            }
+            return;
+        }
+
         std::string fullPath = FileUtils::getInstance()->fullPathForFilename(pszPlist);
         Dictionary *dict = Dictionary::createWithContentsOfFileThreadSafe(fullPath.c_str());
 
-        string texturePath("");
+        string texturePath = getTexturePathForPlist(dict, pszPlist);
 
-        Dictionary* metadataDict = (Dictionary*)dict->objectForKey("metadata");
-        if (metadataDict)
-        {
-            // try to read  texture file name from meta data
-            texturePath = metadataDict->valueForKey("textureFileName")->getCString();
-        }
+        Texture2D *texture = TextureCache::getInstance()->addImage(texturePath.c_str());
 
-        if (! texturePath.empty())
+        if (texture)
         {
-            // build texture path relative to plist file
-            texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath.c_str(), pszPlist);
+            addSpriteFramesWithDictionary(dict, texture);
+            _loadedFileNames->insert(pszPlist);
         }
         else
         {
-            // build texture path by replacing file extension
-            texturePath = pszPlist;
+            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+        }
 
-            // remove .xxx
-            size_t startPos = texturePath.find_last_of("."); 
-            texturePath = texturePath.erase(startPos);
+        dict->release();
+    }
 
-            // append .png
-            texturePath = texturePath.append(".png");
+}
 
-            CCLOG("cocos2d: SpriteFrameCache: Trying to use file %s as texture", texturePath.c_str());
-        }
+std::string SpriteFrameCache::getTexturePathForPlist(Dictionary* dict, const char* pszPlist)
+{
+    string texturePath("");
 
-        Texture2D *texture = TextureCache::getInstance()->addImage(texturePath.c_str());
+    Dictionary* metadataDict = (Dictionary*)dict->objectForKey("metadata");
+    if (metadataDict)
+    {
+        // try to read  texture file name from meta data
+        texturePath = metadataDict->valueForKey("textureFileName")->getCString();
+    }
 
-        if (texture)
+    if (! texturePath.empty())
+    {
+        // build texture path relative to plist file
+        texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath.c_str(), pszPlist);
+    }
+    else
+    {
+        // build texture path by replacing file extension
+        texturePath = pszPlist;
+
+        // remove .xxx
+        size_t startPos = texturePath.find_last_of("."); 
+        texturePath = texturePath.erase(startPos);
+
+        // append .png
+        texturePath = texturePath.append(".png");
+
+        CCLOG("cocos2d: SpriteFrameCache: Trying to use file %s as texture", texturePath.c_str());
+    }
+
+    return texturePath;
+}
+
+void SpriteFrameCache::addSpriteFramesWithFileAsync(const char *plist, const std::function<void(bool)>& callback)
+{
+    CCASSERT(plist, "plist filename should not be NULL");
+
+    if (_loadedFileNames->find(plist) != _loadedFileNames->end())
+    {
+        if (callback)
         {
-            addSpriteFramesWithDictionary(dict, texture);
-            _loadedFileNames->insert(pszPlist);
+            callback(true);
         }
-        else
+        return;
+    }
+
+    // binary files don't need to be parsed
+    if (isBinaryFramesFile(plist))
+    {
+        addSpriteFramesWithFile(plist);
+        if (callback)
         {
-            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+            callback(_loadedFileNames->find(plist) != _loadedFileNames->end());
         }
+        return;
+    }
 
-        dict->release();
+    std::shared_ptr<AsyncPlist> asyncPlist = std::make_shared<AsyncPlist>();
+    asyncPlist->plist = plist;
+    asyncPlist->fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
+    asyncPlist->callback = callback;
+
+    JobSystem::TaskPtr task = JobSystem::getInstance()->addTask([asyncPlist] {
+        // the dictionary is not autoreleased: the AsyncPlist takes its reference
+        asyncPlist->dictionary = RefPtr<Dictionary>::adopt(Dictionary::createWithContentsOfFileThreadSafe(asyncPlist->fullPath.c_str()));
+    }, [this, asyncPlist] {
+        addSpriteFramesAsyncCallBack(asyncPlist.get());
+    });
+    _asyncTasks.push_back(task);
+}
+
+void SpriteFrameCache::addSpriteFramesAsyncCallBack(AsyncPlist* asyncPlist)
+{
+    // forget the tasks that are done, including this one
+    _asyncTasks.erase(std::remove_if(_asyncTasks.begin(), _asyncTasks.end(),
+                                     [](const JobSystem::TaskPtr& task) { return task->isDone(); }),
+                      _asyncTasks.end());
+
+    Dictionary* dict = asyncPlist->dictionary;
+    if (dict == NULL || dict->count() == 0)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: Couldn't load %s", asyncPlist->plist.c_str());
+        if (asyncPlist->callback)
+        {
+            asyncPlist->callback(false);
+        }
     }
+    else
+    {
+        string texturePath = getTexturePathForPlist(dict, asyncPlist->plist.c_str());
 
+        // TextureCache retains the loader until the texture is loaded
+        SpriteFramesAsyncLoader* loader = new SpriteFramesAsyncLoader(asyncPlist->plist, dict, asyncPlist->callback);
+        TextureCache::getInstance()->addImageAsync(texturePath.c_str(), loader, callfuncO_selector(SpriteFramesAsyncLoader::textureLoaded));
+        loader->release();
+    }
 }
 
 void SpriteFrameCache::addSpriteFrame(SpriteFrame *pobFrame, const char *pszFrameName)
 {
-    _spriteFrames->setObject(pobFrame, pszFrameName);
+    _spriteFrames.setObject(pobFrame, pszFrameName);
 }
 
 void SpriteFrameCache::removeSpriteFrames(void)
 {
-    _spriteFrames->removeAllObjects();
-    _spriteFramesAliases->removeAllObjects();
+    _spriteFrames.removeAllObjects();
+    _spriteFramesAliases.removeAllObjects();
     _loadedFileNames->clear();
 }
 
 void SpriteFrameCache::removeUnusedSpriteFrames(void)
 {
     bool bRemoved = false;
-    DictElement* pElement = NULL;
-    CCDICT_FOREACH(_spriteFrames, pElement)
-    {
-        SpriteFrame* spriteFrame = static_cast<SpriteFrame*>(pElement->getObject());
+    _spriteFrames.removeObjectsIf([&](const char* key, Object* spriteFrame) {
         if( spriteFrame->retainCount() == 1 ) 
         {
-            CCLOG("cocos2d: SpriteFrameCache: removing unused frame: %s", pElement->getStrKey());
-            _spriteFrames->removeObjectForElememt(pElement);
+            CCLOG("cocos2d: SpriteFrameCache: removing unused frame: %s", key);
             bRemoved = true;
+            return true;
         }
-    }
+        return false;
+    });
 
     // XXX. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
     if( bRemoved )
@@ -325,16 +671,16 @@ void SpriteFrameCache::removeSpriteFrameByName(const char *pszName)
     }
 
     // Is this an alias ?
-    String* key = (String*)_spriteFramesAliases->objectForKey(pszName);
+    String* key = (String*)_spriteFramesAliases.objectForKey(pszName);
 
     if (key)
     {
-        _spriteFrames->removeObjectForKey(key->getCString());
-        _spriteFramesAliases->removeObjectForKey(key->getCString());
+        _spriteFrames.removeObjectForKey(key->getCString());
+        _spriteFramesAliases.removeObjectForKey(key->getCString());
     }
     else
     {
-        _spriteFrames->removeObjectForKey(pszName);
+        _spriteFrames.removeObjectForKey(pszName);
     }
 
     // XXX. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
@@ -343,6 +689,12 @@ void SpriteFrameCache::removeSpriteFrameByName(const char *pszName)
 
 void SpriteFrameCache::removeSpriteFramesFromFile(const char* plist)
 {
+    if (isBinaryFramesFile(plist))
+    {
+        removeSpriteFramesFromBinaryFile(plist);
+        return;
+    }
+
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
     Dictionary* dict = Dictionary::createWithContentsOfFileThreadSafe(fullPath.c_str());
 
@@ -358,51 +710,62 @@ void SpriteFrameCache::removeSpriteFramesFromFile(const char* plist)
     dict->release();
 }
 
-void SpriteFrameCache::removeSpriteFramesFromDictionary(Dictionary* dictionary)
+void SpriteFrameCache::removeSpriteFramesFromBinaryFile(const char* filename)
 {
-    Dictionary* framesDict = static_cast<Dictionary*>(dictionary->objectForKey("frames"));
-    Array* keysToRemove = Array::create();
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
-    DictElement* pElement = NULL;
-    CCDICT_FOREACH(framesDict, pElement)
+    MappedFile* file = FileUtils::getInstance()->getMappedFileData(fullPath.c_str());
+
+    BinaryFrames binaryFrames;
+    if (file && parseBinaryFrames(file->getBytes(), file->getSize(), &binaryFrames))
     {
-        if (_spriteFrames->objectForKey(pElement->getStrKey()))
+        for (unsigned int i = 0; i < binaryFrames.header->frameCount; i++)
         {
-            keysToRemove->addObject(String::create(pElement->getStrKey()));
+            if (binaryFrames.frames[i].nameOffset < binaryFrames.header->stringTableSize)
+            {
+                _spriteFrames.removeObjectForKey(binaryFrames.strings + binaryFrames.frames[i].nameOffset);
+            }
         }
     }
 
-    _spriteFrames->removeObjectsForKeys(keysToRemove);
+    // remove it from the cache
+    set<string>::iterator ret = _loadedFileNames->find(filename);
+    if (ret != _loadedFileNames->end())
+    {
+        _loadedFileNames->erase(ret);
+    }
 }
 
-void SpriteFrameCache::removeSpriteFramesFromTexture(Texture2D* texture)
+void SpriteFrameCache::removeSpriteFramesFromDictionary(Dictionary* dictionary)
 {
-    Array* keysToRemove = Array::create();
+    Dictionary* framesDict = static_cast<Dictionary*>(dictionary->objectForKey("frames"));
 
     DictElement* pElement = NULL;
-    CCDICT_FOREACH(_spriteFrames, pElement)
+    CCDICT_FOREACH(framesDict, pElement)
     {
-        string key = pElement->getStrKey();
-        SpriteFrame* frame = static_cast<SpriteFrame*>(_spriteFrames->objectForKey(key.c_str()));
-        if (frame && (frame->getTexture() == texture))
-        {
-            keysToRemove->addObject(String::create(pElement->getStrKey()));
-        }
+        _spriteFrames.removeObjectForKey(pElement->getStrKey());
     }
+}
 
-    _spriteFrames->removeObjectsForKeys(keysToRemove);
+void SpriteFrameCache::removeSpriteFramesFromTexture(Texture2D* texture)
+{
+    _spriteFrames.removeObjectsIf([=](const char*, Object* frame) {
+        return static_cast<SpriteFrame*>(frame)->getTexture() == texture;
+    });
 }
 
 SpriteFrame* SpriteFrameCache::getSpriteFrameByName(const char *pszName)
 {
-    SpriteFrame* frame = (SpriteFrame*)_spriteFrames->objectForKey(pszName);
+    // the name is hashed once for both dictionaries
+    StringDictionary::Key name(pszName);
+    SpriteFrame* frame = (SpriteFrame*)_spriteFrames.objectForKey(name);
     if (!frame)
     {
         // try alias dictionary
-        String *key = (String*)_spriteFramesAliases->objectForKey(pszName);  
+        String *key = (String*)_spriteFramesAliases.objectForKey(name);
         if (key)
         {
-            frame = (SpriteFrame*)_spriteFrames->objectForKey(key->getCString());
+            frame = (SpriteFrame*)_spriteFrames.objectForKey(key->getCString());
             if (! frame)
             {
                 CCLOG("cocos2d: SpriteFrameCache: Frame '%s' not found", pszName);
@@ -37,14 +37,21 @@ THE SOFTWARE.
 #include "sprite_nodes/CCSpriteFrame.h"
 #include "textures/CCTexture2D.h"
 #include "cocoa/CCObject.h"
+#include "cocoa/CCRefPtr.h"
+#include "cocoa/CCStringDictionary.h"
 #include <set>
 #include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include "support/CCJobSystem.h"
 
 NS_CC_BEGIN
 
 class Dictionary;
 class Array;
 class Sprite;
+class SpriteFramesAsyncLoader;
 
 /**
  * @addtogroup sprite_nodes
@@ -72,7 +79,7 @@ public:
 
 protected:
     // MARMALADE: Made this protected not private, as deriving from this class is pretty useful
-    SpriteFrameCache() : _spriteFrames(NULL), _spriteFramesAliases(NULL){}
+    SpriteFrameCache() {}
 
 public:
     virtual ~SpriteFrameCache();
@@ -82,6 +89,8 @@ public:
     /** Adds multiple Sprite Frames from a plist file.
      * A texture will be loaded automatically. The texture name will composed by replacing the .plist suffix with .png
      * If you want to use another texture, you should use the addSpriteFramesWithFile:texture method.
+     * Files with the .ccsf extension are read as binary sprite frame files (see tools/spriteframe_converter),
+     * which are loaded without any string parsing. It is also the case for the other addSpriteFramesWithFile methods.
      */
     void addSpriteFramesWithFile(const char *pszPlist);
 
@@ -93,6 +102,15 @@ public:
     /** Adds multiple Sprite Frames from a plist file. The texture will be associated with the created sprite frames. */
     void addSpriteFramesWithFile(const char *pszPlist, Texture2D *pobTexture);
 
+    /** Adds multiple Sprite Frames from a plist file, asynchronously.
+     * The plist is parsed by a task of the JobSystem, and its texture is loaded with TextureCache::addImageAsync().
+     * The frames are added in the main thread, then the callback is called with true,
+     * or with false if the plist or its texture couldn't be loaded.
+     * Binary sprite frame files (.ccsf) don't need parsing: they and their texture are loaded immediately.
+     * @since v3.0
+     */
+    void addSpriteFramesWithFileAsync(const char *plist, const std::function<void(bool)>& callback);
+
     /** Adds an sprite frame with a given name.
      If the name already exists, then the contents of the old name will be replaced with the new one.
      */
@@ -142,15 +160,46 @@ private:
      */
     void addSpriteFramesWithDictionary(Dictionary* pobDictionary, Texture2D *pobTexture);
 
+    /** Adds the frames of a binary sprite frame file (.ccsf). textureFileName is set to the texture name stored in the file.
+     * @return false if the data is not a valid binary sprite frame file
+     */
+    bool addSpriteFramesWithBinaryData(const unsigned char* data, unsigned long size, Texture2D *texture, std::string* textureFileName);
+
+    /** adds the frames of a binary sprite frame file. If texture is NULL, the texture stored in the file is loaded */
+    bool addSpriteFramesWithBinaryFile(const char* filename, Texture2D *texture);
+
+    /** removes the frames of a binary sprite frame file */
+    void removeSpriteFramesFromBinaryFile(const char* filename);
+
+    /** Returns the path of the texture of a plist, read from its metadata or built from the name of the plist */
+    std::string getTexturePathForPlist(Dictionary* dictionary, const char* plist);
+
+    struct AsyncPlist
+    {
+        std::string plist;
+        std::string fullPath;
+        // parsed by the loading task and released by the main thread
+        RefPtr<Dictionary> dictionary;
+        std::function<void(bool)> callback;
+    };
+
+    /** adds the frames of a plist parsed by addSpriteFramesWithFileAsync(), in the main thread */
+    void addSpriteFramesAsyncCallBack(AsyncPlist* asyncPlist);
+
+    friend class SpriteFramesAsyncLoader;
+
     /** Removes multiple Sprite Frames from Dictionary.
     * @since v0.99.5
     */
     void removeSpriteFramesFromDictionary(Dictionary* dictionary);
 
 protected:
-    Dictionary* _spriteFrames;
-    Dictionary* _spriteFramesAliases;
+    StringDictionary _spriteFrames;
+    StringDictionary _spriteFramesAliases;
     std::set<std::string>*  _loadedFileNames;
+
+    // the tasks parsing plists, cancelled when the cache is destroyed
+    std::vector<JobSystem::TaskPtr> _asyncTasks;
 };
 
 // end of sprite_nodes group
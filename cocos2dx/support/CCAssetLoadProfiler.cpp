@@ -0,0 +1,269 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCAssetLoadProfiler.h"
+#include "ccMacros.h"
+#include <algorithm>
+#include <chrono>
+
+// thread_local isn't supported by the compilers of all the platforms, a pointer is enough here
+#if defined(_MSC_VER)
+#define CC_ASSET_PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define CC_ASSET_PROFILER_THREAD_LOCAL __thread
+#endif
+
+NS_CC_BEGIN
+
+static AssetLoadProfiler *s_sharedAssetLoadProfiler = NULL;
+
+std::atomic<bool> AssetLoadProfiler::s_enabled(false);
+
+// the asset and the stage run by each thread
+static CC_ASSET_PROFILER_THREAD_LOCAL AssetLoadProfiler::AssetScope* s_currentAsset = NULL;
+static CC_ASSET_PROFILER_THREAD_LOCAL AssetLoadProfiler::StageScope* s_currentStage = NULL;
+
+// nanoseconds of the monotonic clock
+static inline long long profilerTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+AssetLoadProfiler* AssetLoadProfiler::getInstance()
+{
+    if (!s_sharedAssetLoadProfiler)
+    {
+        s_sharedAssetLoadProfiler = new AssetLoadProfiler();
+    }
+    return s_sharedAssetLoadProfiler;
+}
+
+void AssetLoadProfiler::destroyInstance()
+{
+    s_enabled.store(false, std::memory_order_relaxed);
+    CC_SAFE_DELETE(s_sharedAssetLoadProfiler);
+}
+
+AssetLoadProfiler::AssetLoadProfiler()
+{
+}
+
+void AssetLoadProfiler::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+const char* AssetLoadProfiler::getStageName(Stage stage)
+{
+    static const char* names[STAGE_COUNT] = { "read", "decode", "convert", "upload", "parse" };
+    return names[(int)stage];
+}
+
+AssetLoadProfiler::AssetStats& AssetLoadProfiler::getStats(const std::string& name)
+{
+    for (auto& asset : _assets)
+    {
+        if (asset.name == name)
+        {
+            return asset;
+        }
+    }
+
+    AssetStats stats;
+    stats.name = name;
+    stats.loads = 0;
+    stats.totalTime = 0;
+    std::fill(stats.stageTimes, stats.stageTimes + STAGE_COUNT, 0.0);
+    std::fill(stats.stageBytes, stats.stageBytes + STAGE_COUNT, 0ul);
+    _assets.push_back(stats);
+    return _assets.back();
+}
+
+void AssetLoadProfiler::addLoad(const std::string& name, double time)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    AssetStats& stats = getStats(name);
+    ++stats.loads;
+    stats.totalTime += time;
+}
+
+void AssetLoadProfiler::addStage(const std::string& name, Stage stage, double time, unsigned long bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    AssetStats& stats = getStats(name);
+    stats.stageTimes[(int)stage] += time;
+    stats.stageBytes[(int)stage] += bytes;
+}
+
+std::vector<AssetLoadProfiler::AssetStats> AssetLoadProfiler::getAssetStats() const
+{
+    std::vector<AssetStats> stats;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        stats = _assets;
+    }
+
+    std::sort(stats.begin(), stats.end(), [](const AssetStats& a, const AssetStats& b) {
+        return a.totalTime > b.totalTime;
+    });
+    return stats;
+}
+
+bool AssetLoadProfiler::hasAssets() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return !_assets.empty();
+}
+
+void AssetLoadProfiler::displayReport() const
+{
+    std::vector<AssetStats> stats = getAssetStats();
+
+    double totalTime = 0;
+    unsigned long readBytes = 0;
+    for (const auto& asset : stats)
+    {
+        totalTime += asset.totalTime;
+        readBytes += asset.stageBytes[(int)Stage::READ];
+    }
+
+    log("AssetLoadProfiler: %u assets, %.3f ms, %lu KB read", (unsigned int)stats.size(), totalTime, readBytes / 1024);
+    for (const auto& asset : stats)
+    {
+        log("%s: %.3f ms in %u loads, read %.3f ms %lu KB, decode %.3f ms, convert %.3f ms, upload %.3f ms %lu KB, parse %.3f ms",
+            asset.name.c_str(), asset.totalTime, asset.loads,
+            asset.stageTimes[(int)Stage::READ], asset.stageBytes[(int)Stage::READ] / 1024,
+            asset.stageTimes[(int)Stage::DECODE], asset.stageTimes[(int)Stage::CONVERT],
+            asset.stageTimes[(int)Stage::UPLOAD], asset.stageBytes[(int)Stage::UPLOAD] / 1024,
+            asset.stageTimes[(int)Stage::PARSE]);
+    }
+}
+
+void AssetLoadProfiler::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _assets.clear();
+}
+
+AssetLoadProfiler::AssetScope::AssetScope(const std::string& name)
+: _active(AssetLoadProfiler::isEnabled())
+, _parent(NULL)
+, _start(0)
+, _childTime(0)
+{
+    // an asset loading itself again, like an image read by its texture, is the same load
+    if (_active && s_currentAsset && s_currentAsset->_name == name)
+    {
+        _active = false;
+    }
+
+    if (_active)
+    {
+        _name = name;
+        _parent = s_currentAsset;
+        s_currentAsset = this;
+        _start = profilerTime();
+    }
+}
+
+AssetLoadProfiler::AssetScope::~AssetScope()
+{
+    if (!_active)
+    {
+        return;
+    }
+
+    long long elapsed = profilerTime() - _start;
+    s_currentAsset = _parent;
+    if (_parent)
+    {
+        _parent->_childTime += elapsed;
+    }
+
+    // the profiler may have been disabled meanwhile
+    if (AssetLoadProfiler::isEnabled())
+    {
+        AssetLoadProfiler::getInstance()->addLoad(_name, (elapsed - _childTime) / 1000000.0);
+    }
+}
+
+AssetLoadProfiler::StageScope::StageScope(Stage stage, const char* name)
+: _stage(stage)
+, _name(name)
+, _active(AssetLoadProfiler::isEnabled())
+, _parent(NULL)
+, _start(0)
+, _childTime(0)
+, _bytes(0)
+{
+    if (_active)
+    {
+        _parent = s_currentStage;
+        s_currentStage = this;
+        _start = profilerTime();
+    }
+}
+
+AssetLoadProfiler::StageScope::~StageScope()
+{
+    if (!_active)
+    {
+        return;
+    }
+
+    long long elapsed = profilerTime() - _start;
+    s_currentStage = _parent;
+    if (_parent)
+    {
+        _parent->_childTime += elapsed;
+    }
+
+    if (!AssetLoadProfiler::isEnabled())
+    {
+        return;
+    }
+
+    AssetLoadProfiler* profiler = AssetLoadProfiler::getInstance();
+    double time = (elapsed - _childTime) / 1000000.0;
+    if (s_currentAsset)
+    {
+        profiler->addStage(s_currentAsset->getName(), _stage, time, _bytes);
+        return;
+    }
+
+    // without asset, the stages are counted for the outermost one, which is a load of its own
+    const StageScope* root = this;
+    while (root->_parent)
+    {
+        root = root->_parent;
+    }
+    std::string name = root->_name ? root->_name : "unknown";
+    profiler->addStage(name, _stage, time, _bytes);
+    if (root == this)
+    {
+        profiler->addLoad(name, elapsed / 1000000.0);
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,184 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __SUPPORT_CCASSETLOADPROFILER_H__
+#define __SUPPORT_CCASSETLOADPROFILER_H__
+
+#include "ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief AssetLoadProfiler measures what each asset costs to load: the reading of its files, the decoding,
+ the conversion of its pixels, the upload to the GPU and the parsing of the plists and the XML files.
+
+ The stages are marked with CC_PROFILE_ASSET_STAGE in FileUtils, Image, Texture2D and the parsers, and the loads
+ of an asset with CC_PROFILE_ASSET in the caches: the stages run by a load are counted for its asset, on every
+ thread, so the file read by the decoder of a texture is counted for the texture. The time of a stage excludes
+ the stages it contains, the time of an asset excludes the assets it loads.
+
+ When it is enabled, the Director logs the report of the assets loaded since the previous scene once a scene
+ has entered, the most expensive first, then clears it. The stages are compiled when CC_ENABLE_FRAME_PROFILER
+ is not 0, the profiler is enabled at runtime with setEnabled(). When it is disabled, a stage costs one test.
+
+ @since v3.0
+ */
+class CC_DLL AssetLoadProfiler
+{
+public:
+    enum class Stage
+    {
+        READ,
+        DECODE,
+        CONVERT,
+        UPLOAD,
+        PARSE,
+    };
+
+    static const int STAGE_COUNT = 5;
+
+    /** statistics of an asset since the last reset, the times are in milliseconds */
+    struct AssetStats
+    {
+        std::string name;
+        unsigned int loads;
+        double totalTime;
+        double stageTimes[STAGE_COUNT];
+        /** bytes read, decoded, converted, uploaded or parsed */
+        unsigned long stageBytes[STAGE_COUNT];
+    };
+
+    /** Gets the single instance of AssetLoadProfiler. */
+    static AssetLoadProfiler* getInstance();
+
+    /** Destroys the single instance of AssetLoadProfiler. */
+    static void destroyInstance();
+
+    AssetLoadProfiler();
+
+    /** Whether the loads are recorded, false by default */
+    static inline bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled);
+
+    /** Statistics of the assets loaded since the last reset, the most expensive first. Thread safe. */
+    std::vector<AssetStats> getAssetStats() const;
+
+    /** Whether an asset was loaded since the last reset. Thread safe. */
+    bool hasAssets() const;
+
+    /** Logs the statistics of the assets, the most expensive first. Thread safe. */
+    void displayReport() const;
+
+    /** Clears the statistics. Thread safe. */
+    void reset();
+
+    static const char* getStageName(Stage stage);
+
+    /** Records the load of an asset on the calling thread for the lifetime of the object. Use CC_PROFILE_ASSET instead. */
+    class CC_DLL AssetScope
+    {
+    public:
+        explicit AssetScope(const std::string& name);
+        ~AssetScope();
+
+        const std::string& getName() const { return _name; }
+
+    private:
+        friend class AssetLoadProfiler;
+
+        std::string _name;
+        bool _active;
+        AssetScope* _parent;
+        long long _start;
+        long long _childTime;
+    };
+
+    /** Records a stage on the calling thread for the lifetime of the object. Use CC_PROFILE_ASSET_STAGE instead. */
+    class CC_DLL StageScope
+    {
+    public:
+        /** @param name the asset, when the stage isn't run by the load of an asset. Can be NULL */
+        StageScope(Stage stage, const char* name);
+        ~StageScope();
+
+        void setBytes(unsigned long bytes) { _bytes = bytes; }
+
+    private:
+        Stage _stage;
+        const char* _name;
+        bool _active;
+        StageScope* _parent;
+        long long _start;
+        long long _childTime;
+        unsigned long _bytes;
+    };
+
+protected:
+    AssetStats& getStats(const std::string& name);
+    void addLoad(const std::string& name, double time);
+    void addStage(const std::string& name, Stage stage, double time, unsigned long bytes);
+
+    static std::atomic<bool> s_enabled;
+
+    mutable std::mutex _mutex;
+    std::vector<AssetStats> _assets;
+};
+
+#if CC_ENABLE_FRAME_PROFILER
+
+/** Counts the stages run on the calling thread until the end of the enclosing scope for an asset */
+#define CC_PROFILE_ASSET(__name__) \
+    cocos2d::AssetLoadProfiler::AssetScope __ccProfileAsset(__name__)
+
+/** Records the rest of the enclosing scope as a stage of the loading of an asset, in the variable __var__ */
+#define CC_PROFILE_ASSET_STAGE(__var__, __stage__, __name__) \
+    cocos2d::AssetLoadProfiler::StageScope __var__(cocos2d::AssetLoadProfiler::Stage::__stage__, __name__)
+
+/** Sets the bytes handled by a stage */
+#define CC_PROFILE_ASSET_BYTES(__var__, __bytes__) __var__.setBytes(__bytes__)
+
+#else
+
+#define CC_PROFILE_ASSET(__name__) do {} while (0)
+#define CC_PROFILE_ASSET_STAGE(__var__, __stage__, __name__) do {} while (0)
+#define CC_PROFILE_ASSET_BYTES(__var__, __bytes__) do {} while (0)
+
+#endif // CC_ENABLE_FRAME_PROFILER
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCASSETLOADPROFILER_H__
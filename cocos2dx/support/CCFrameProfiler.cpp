@@ -0,0 +1,592 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCFrameProfiler.h"
+#include "ccMacros.h"
+#include "support/CCJobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <stdio.h>
+#include <string.h>
+
+// thread_local isn't supported by the compilers of all the platforms, a pointer is enough here
+#if defined(_MSC_VER)
+#define CC_PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define CC_PROFILER_THREAD_LOCAL __thread
+#endif
+
+NS_CC_BEGIN
+
+// events kept per thread between two frames, a power of 2
+static const unsigned int EVENT_BUFFER_SIZE = 16384;
+// zones recorded in a trace at most, the next ones are dropped
+static const size_t MAX_TRACE_EVENTS = 1 << 20;
+// zone of the frames in the traces
+static const unsigned int FRAME_ZONE = 0xffffffff;
+
+struct ProfilerEvent
+{
+    long long time;
+    unsigned int zone;
+    bool begin;
+};
+
+/** Ring buffer written by its thread and read by the main thread at the end of the frames */
+struct FrameProfiler::ThreadBuffer
+{
+    ThreadBuffer(unsigned int bufferId)
+    : writeIndex(0)
+    , readIndex(0)
+    , dropped(0)
+    , id(bufferId)
+    , threadId(std::this_thread::get_id())
+    {}
+
+    ProfilerEvent events[EVENT_BUFFER_SIZE];
+    std::atomic<unsigned int> writeIndex;
+    std::atomic<unsigned int> readIndex;
+    std::atomic<unsigned int> dropped;
+
+    // thread of the traces
+    unsigned int id;
+    std::thread::id threadId;
+
+    // the zones entered and not left yet, used by the main thread only
+    struct OpenZone
+    {
+        unsigned int zone;
+        long long start;
+        long long childTime;
+    };
+    std::vector<OpenZone> stack;
+};
+
+static FrameProfiler *s_sharedFrameProfiler = NULL;
+
+std::atomic<bool> FrameProfiler::s_enabled(false);
+
+// the names of the zones and the buffers of the threads, kept until the end of the process
+// since the threads keep a pointer to their buffer
+// the track of the zones measured by GPUProfiler in the traces
+static const unsigned int GPU_THREAD = 0xfffffffe;
+
+static std::mutex s_registryMutex;
+static std::vector<const char*> s_zoneNames;
+static std::vector<FrameProfiler::ThreadBuffer*>* s_threadBuffers = NULL;
+static std::vector<std::pair<std::thread::id, std::string> > s_threadNames;
+
+// nanoseconds of the monotonic clock
+static inline long long profilerTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline void pushEvent(FrameProfiler::ThreadBuffer* buffer, unsigned int zone, bool begin, long long time)
+{
+    unsigned int write = buffer->writeIndex.load(std::memory_order_relaxed);
+    if (write - buffer->readIndex.load(std::memory_order_acquire) >= EVENT_BUFFER_SIZE)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ProfilerEvent& event = buffer->events[write & (EVENT_BUFFER_SIZE - 1)];
+    event.time = time;
+    event.zone = zone;
+    event.begin = begin;
+    buffer->writeIndex.store(write + 1, std::memory_order_release);
+}
+
+FrameProfiler* FrameProfiler::getInstance()
+{
+    if (!s_sharedFrameProfiler)
+    {
+        s_sharedFrameProfiler = new FrameProfiler();
+    }
+    return s_sharedFrameProfiler;
+}
+
+void FrameProfiler::destroyInstance()
+{
+    if (s_sharedFrameProfiler)
+    {
+        s_sharedFrameProfiler->setEnabled(false);
+    }
+    CC_SAFE_DELETE(s_sharedFrameProfiler);
+}
+
+FrameProfiler::FrameProfiler()
+: _frameCount(0)
+, _totalFrameTime(0)
+, _maxFrameTime(0)
+, _lastFrameTime(0)
+, _droppedEvents(0)
+, _tracing(false)
+, _enabledByTrace(false)
+, _traceFramesLeft(0)
+{
+}
+
+FrameProfiler::~FrameProfiler()
+{
+}
+
+unsigned int FrameProfiler::registerZone(const char* name)
+{
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+
+    // the zones with the same name are merged
+    for (size_t i = 0; i < s_zoneNames.size(); ++i)
+    {
+        if (strcmp(s_zoneNames[i], name) == 0)
+        {
+            return (unsigned int)i;
+        }
+    }
+
+    s_zoneNames.push_back(name);
+    return (unsigned int)s_zoneNames.size() - 1;
+}
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+    if (enabled && !isEnabled())
+    {
+        // the events recorded before aren't collected, and the first frame starts now
+        discardEvents();
+        _lastFrameTime = 0;
+    }
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+FrameProfiler::ThreadBuffer* FrameProfiler::getThreadBuffer()
+{
+    static CC_PROFILER_THREAD_LOCAL ThreadBuffer* s_threadBuffer = NULL;
+    if (!s_threadBuffer)
+    {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        if (!s_threadBuffers)
+        {
+            s_threadBuffers = new std::vector<ThreadBuffer*>();
+        }
+        s_threadBuffer = new ThreadBuffer((unsigned int)s_threadBuffers->size());
+        s_threadBuffers->push_back(s_threadBuffer);
+    }
+    return s_threadBuffer;
+}
+
+void FrameProfiler::beginZone(unsigned int zone)
+{
+    pushEvent(getThreadBuffer(), zone, true, profilerTime());
+}
+
+void FrameProfiler::endZone(unsigned int zone)
+{
+    long long time = profilerTime();
+    pushEvent(getThreadBuffer(), zone, false, time);
+}
+
+void FrameProfiler::markFrame()
+{
+    long long time = profilerTime();
+    if (_lastFrameTime != 0)
+    {
+        double frameTime = (time - _lastFrameTime) / 1000000.0;
+        ++_frameCount;
+        _totalFrameTime += frameTime;
+        _maxFrameTime = std::max(_maxFrameTime, frameTime);
+
+        if (_tracing)
+        {
+            addTraceEvent(FRAME_ZONE, getThreadBuffer()->id, _lastFrameTime, time - _lastFrameTime);
+        }
+    }
+    _lastFrameTime = time;
+
+    {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        if (_zones.size() < s_zoneNames.size())
+        {
+            ZoneAccumulator empty = { 0, 0, 0, 0 };
+            _zones.resize(s_zoneNames.size(), empty);
+        }
+        if (s_threadBuffers)
+        {
+            for (auto buffer : *s_threadBuffers)
+            {
+                collect(buffer);
+            }
+        }
+    }
+
+    if (_traceFramesLeft > 0 && --_traceFramesLeft == 0)
+    {
+        finishTrace();
+    }
+}
+
+void FrameProfiler::collect(ThreadBuffer* buffer)
+{
+    unsigned int read = buffer->readIndex.load(std::memory_order_relaxed);
+    unsigned int write = buffer->writeIndex.load(std::memory_order_acquire);
+
+    for (; read != write; ++read)
+    {
+        const ProfilerEvent& event = buffer->events[read & (EVENT_BUFFER_SIZE - 1)];
+        if (event.begin)
+        {
+            ThreadBuffer::OpenZone open = { event.zone, event.time, 0 };
+            buffer->stack.push_back(open);
+            continue;
+        }
+
+        // the zones left without event, when it was dropped, are closed with their parent
+        size_t depth = buffer->stack.size();
+        while (depth > 0 && buffer->stack[depth - 1].zone != event.zone)
+        {
+            --depth;
+        }
+        if (depth == 0 || event.zone >= _zones.size())
+        {
+            // its beginning was dropped
+            continue;
+        }
+
+        const ThreadBuffer::OpenZone& open = buffer->stack[depth - 1];
+        long long elapsed = event.time - open.start;
+        double duration = elapsed / 1000000.0;
+        double self = (elapsed - open.childTime) / 1000000.0;
+        buffer->stack.resize(depth - 1);
+        if (!buffer->stack.empty())
+        {
+            buffer->stack.back().childTime += elapsed;
+        }
+
+        if (_tracing)
+        {
+            addTraceEvent(event.zone, buffer->id, event.time - elapsed, elapsed);
+        }
+
+        ZoneAccumulator& accumulator = _zones[event.zone];
+        ++accumulator.calls;
+        accumulator.totalTime += duration;
+        accumulator.selfTime += self;
+        accumulator.maxTime = std::max(accumulator.maxTime, duration);
+    }
+
+    buffer->readIndex.store(write, std::memory_order_release);
+    _droppedEvents += buffer->dropped.exchange(0, std::memory_order_relaxed);
+}
+
+void FrameProfiler::discardEvents()
+{
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    if (s_threadBuffers)
+    {
+        for (auto buffer : *s_threadBuffers)
+        {
+            buffer->readIndex.store(buffer->writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+            buffer->stack.clear();
+        }
+    }
+}
+
+unsigned int FrameProfiler::getFrameCount() const
+{
+    return _frameCount;
+}
+
+double FrameProfiler::getAverageFrameTime() const
+{
+    return _frameCount > 0 ? _totalFrameTime / _frameCount : 0;
+}
+
+double FrameProfiler::getMaxFrameTime() const
+{
+    return _maxFrameTime;
+}
+
+unsigned int FrameProfiler::getDroppedEventCount() const
+{
+    return _droppedEvents;
+}
+
+std::vector<FrameProfiler::ZoneStats> FrameProfiler::getZoneStats() const
+{
+    std::vector<ZoneStats> stats;
+
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    for (size_t i = 0; i < _zones.size(); ++i)
+    {
+        const ZoneAccumulator& accumulator = _zones[i];
+        if (accumulator.calls > 0)
+        {
+            ZoneStats zone = { s_zoneNames[i], accumulator.calls, accumulator.totalTime, accumulator.selfTime, accumulator.maxTime };
+            stats.push_back(zone);
+        }
+    }
+    return stats;
+}
+
+void FrameProfiler::displayZones() const
+{
+    std::vector<ZoneStats> stats = getZoneStats();
+    std::sort(stats.begin(), stats.end(), [](const ZoneStats& a, const ZoneStats& b) {
+        return a.totalTime > b.totalTime;
+    });
+
+    double frames = std::max(_frameCount, 1u);
+    log("FrameProfiler: %u frames, %.3f ms/frame, max %.3f ms, %u events dropped",
+        _frameCount, getAverageFrameTime(), _maxFrameTime, _droppedEvents);
+    for (const auto& zone : stats)
+    {
+        log("%s: %.3f ms/frame, self %.3f ms/frame, %.1f calls/frame, max %.3f ms",
+            zone.name, zone.totalTime / frames, zone.selfTime / frames, zone.calls / frames, zone.maxTime);
+    }
+}
+
+void FrameProfiler::reset()
+{
+    ZoneAccumulator empty = { 0, 0, 0, 0 };
+    std::fill(_zones.begin(), _zones.end(), empty);
+    _frameCount = 0;
+    _totalFrameTime = 0;
+    _maxFrameTime = 0;
+    _droppedEvents = 0;
+}
+
+void FrameProfiler::setThreadName(const char* name)
+{
+    std::thread::id threadId = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    for (auto& threadName : s_threadNames)
+    {
+        if (threadName.first == threadId)
+        {
+            threadName.second = name;
+            return;
+        }
+    }
+    s_threadNames.push_back(std::make_pair(threadId, std::string(name)));
+}
+
+void FrameProfiler::addTraceEvent(unsigned int zone, unsigned int thread, long long start, long long duration)
+{
+    if (_traceEvents.size() >= MAX_TRACE_EVENTS)
+    {
+        ++_droppedEvents;
+        return;
+    }
+
+    TraceEvent event = { zone, thread, start, duration };
+    _traceEvents.push_back(event);
+}
+
+void FrameProfiler::addGPUTraceEvent(unsigned int zone, long long start, long long duration)
+{
+    if (_tracing)
+    {
+        addTraceEvent(zone, GPU_THREAD, start, duration);
+    }
+}
+
+void FrameProfiler::startTrace(const std::string& path, unsigned int frames, const std::function<void(bool)>& callback)
+{
+    if (_tracing)
+    {
+        stopTrace();
+    }
+
+    setThreadName("Main");
+    _tracing = true;
+    _enabledByTrace = !isEnabled();
+    _traceFramesLeft = frames;
+    _tracePath = path;
+    _traceCallback = callback;
+    _traceEvents.clear();
+    if (_enabledByTrace)
+    {
+        setEnabled(true);
+    }
+}
+
+bool FrameProfiler::isTracing() const
+{
+    return _tracing;
+}
+
+static void writeJsonString(FILE* file, const char* text)
+{
+    fputc('"', file);
+    for (const char* c = text; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', file);
+            fputc(*c, file);
+        }
+        else if ((unsigned char)*c < 0x20)
+        {
+            fprintf(file, "\\u%04x", *c);
+        }
+        else
+        {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+/** the data of a stopped trace, written by a task */
+struct TraceData
+{
+    std::string path;
+    std::vector<FrameProfiler::TraceEvent> events;
+    std::vector<const char*> zoneNames;
+    // id and name of the threads
+    std::vector<std::pair<unsigned int, std::string> > threads;
+    bool succeeded;
+};
+
+static bool writeTrace(const TraceData& trace)
+{
+    FILE* file = fopen(trace.path.c_str(), "w");
+    if (!file)
+    {
+        return false;
+    }
+
+    // the time stamps are in microseconds from the beginning of the trace
+    long long origin = trace.events.empty() ? 0 : trace.events[0].start;
+    for (const auto& event : trace.events)
+    {
+        origin = std::min(origin, event.start);
+    }
+
+    fputs("{\"traceEvents\":[\n", file);
+    bool first = true;
+    for (const auto& thread : trace.threads)
+    {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", thread.first);
+        writeJsonString(file, thread.second.c_str());
+        fputs("}}", file);
+        first = false;
+    }
+    for (const auto& event : trace.events)
+    {
+        fputs(first ? "{\"name\":" : ",\n{\"name\":", file);
+        writeJsonString(file, event.zone == FRAME_ZONE ? "Frame" : trace.zoneNames[event.zone]);
+        fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                event.zone == FRAME_ZONE ? "frame" : "zone",
+                (event.start - origin) / 1000.0, event.duration / 1000.0, event.thread);
+        first = false;
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+
+    bool succeeded = !ferror(file);
+    return fclose(file) == 0 && succeeded;
+}
+
+void FrameProfiler::stopTrace()
+{
+    if (_tracing)
+    {
+        // the zones left during the frame are collected first
+        markFrame();
+        finishTrace();
+    }
+}
+
+void FrameProfiler::finishTrace()
+{
+    if (!_tracing)
+    {
+        return;
+    }
+
+    _tracing = false;
+    _traceFramesLeft = 0;
+    if (_enabledByTrace)
+    {
+        setEnabled(false);
+        _enabledByTrace = false;
+    }
+
+    std::shared_ptr<TraceData> trace = std::make_shared<TraceData>();
+    trace->path = _tracePath;
+    trace->events.swap(_traceEvents);
+    trace->succeeded = false;
+    {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        trace->zoneNames = s_zoneNames;
+        if (s_threadBuffers)
+        {
+            for (auto buffer : *s_threadBuffers)
+            {
+                char name[32];
+                snprintf(name, sizeof(name), "Thread %u", buffer->id);
+                std::string threadName(name);
+                for (const auto& namedThread : s_threadNames)
+                {
+                    if (namedThread.first == buffer->threadId)
+                    {
+                        threadName = namedThread.second;
+                    }
+                }
+                trace->threads.push_back(std::make_pair(buffer->id, threadName));
+            }
+        }
+    }
+    for (const auto& event : trace->events)
+    {
+        if (event.thread == GPU_THREAD)
+        {
+            trace->threads.push_back(std::make_pair(GPU_THREAD, std::string("GPU")));
+            break;
+        }
+    }
+
+    std::function<void(bool)> callback = _traceCallback;
+    _traceCallback = nullptr;
+    JobSystem::getInstance()->addTask([trace] {
+        trace->succeeded = writeTrace(*trace);
+        if (!trace->succeeded)
+        {
+            CCLOG("FrameProfiler: can not write the trace %s", trace->path.c_str());
+        }
+    }, [trace, callback] {
+        if (callback)
+        {
+            callback(trace->succeeded);
+        }
+    });
+}
+
+NS_CC_END
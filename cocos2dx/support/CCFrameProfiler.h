@@ -0,0 +1,238 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __SUPPORT_CCFRAMEPROFILER_H__
+#define __SUPPORT_CCFRAMEPROFILER_H__
+
+#include "ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief FrameProfiler measures the time spent in zones of code, on all the threads, frame by frame.
+
+ A zone is a scope marked with CC_PROFILE_ZONE("name"). Its id is registered once, the first time the scope runs,
+ then entering and leaving it only record a time stamp of the monotonic clock in a ring buffer of the thread,
+ without lock, when the profiler is enabled. When it is disabled, a zone costs one test.
+
+ The zones can be nested: the time of a zone is given with and without the time of the zones it contains.
+ The Director marks the end of the frames: the events of the threads are collected then, and added to the
+ statistics of the zones. The events that don't fit in the ring buffer of a thread during a frame are dropped.
+
+ The zones are compiled when CC_ENABLE_FRAME_PROFILER is not 0, the profiler is enabled at runtime with
+ setEnabled(). It replaces Profiler and the CC_PROFILER_XXX macros, kept for the existing code.
+
+ The zones and the frames can also be recorded in a trace, written as Chrome trace events: the file is opened
+ with chrome://tracing or https://ui.perfetto.dev to see the timeline of each thread, frame by frame.
+
+ @since v3.0
+ */
+class CC_DLL FrameProfiler
+{
+public:
+    /** statistics of a zone since the last reset, the times are in milliseconds */
+    struct ZoneStats
+    {
+        const char* name;
+        unsigned int calls;
+        /** time spent in the zone, including the nested zones */
+        double totalTime;
+        /** time spent in the zone, excluding the nested zones */
+        double selfTime;
+        /** longest call */
+        double maxTime;
+    };
+
+    /** Gets the single instance of FrameProfiler. */
+    static FrameProfiler* getInstance();
+
+    /** Destroys the single instance of FrameProfiler. */
+    static void destroyInstance();
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    /** Gets the id of a zone, registered the first time. Thread safe.
+     The name isn't copied: it must be a string literal.
+     */
+    static unsigned int registerZone(const char* name);
+
+    /** Whether the zones are recorded, false by default */
+    static inline bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled);
+
+    /** Records the beginning and the end of a zone on the calling thread. Use CC_PROFILE_ZONE instead. */
+    static void beginZone(unsigned int zone);
+    static void endZone(unsigned int zone);
+
+    /** Collects the events of the frame, called by the Director after a frame is drawn. Main thread only. */
+    void markFrame();
+
+    /** Number of frames since the last reset */
+    unsigned int getFrameCount() const;
+    /** Average and maximum durations of the frames since the last reset, in milliseconds */
+    double getAverageFrameTime() const;
+    double getMaxFrameTime() const;
+    /** Number of events dropped because a ring buffer was full, since the last reset */
+    unsigned int getDroppedEventCount() const;
+
+    /** Statistics of the zones called since the last reset */
+    std::vector<ZoneStats> getZoneStats() const;
+
+    /** Logs the statistics of the zones per frame, the most expensive first */
+    void displayZones() const;
+
+    /** Clears the statistics */
+    void reset();
+
+    /** Names the calling thread in the traces. Thread safe. */
+    static void setThreadName(const char* name);
+
+    /** Starts recording a trace, and enables the profiler until it is stopped if it wasn't. Main thread only.
+     @param path file written when the trace is stopped, usually in FileUtils::getWritablePath()
+     @param frames number of frames recorded before the trace is stopped, 0 to record until stopTrace()
+     @param callback called on the main thread once the file is written, with whether it succeeded. Can be nullptr
+     */
+    void startTrace(const std::string& path, unsigned int frames = 0, const std::function<void(bool)>& callback = nullptr);
+
+    /** Stops recording the trace and writes it, in a task of the JobSystem */
+    void stopTrace();
+
+    /** Whether a trace is recorded */
+    bool isTracing() const;
+
+    /** Records a zone measured on the GPU in the trace, on a track of its own, called by GPUProfiler.
+     The start is in nanoseconds of the steady clock. Main thread only.
+     */
+    void addGPUTraceEvent(unsigned int zone, long long start, long long duration);
+
+    /** Records a zone for the lifetime of the object */
+    class Scope
+    {
+    public:
+        explicit Scope(unsigned int zone)
+        : _zone(zone)
+        , _active(FrameProfiler::isEnabled())
+        {
+            if (_active)
+            {
+                FrameProfiler::beginZone(_zone);
+            }
+        }
+
+        ~Scope()
+        {
+            if (_active)
+            {
+                FrameProfiler::endZone(_zone);
+            }
+        }
+
+    private:
+        unsigned int _zone;
+        // a zone entered while disabled isn't left, even if the profiler is enabled meanwhile
+        bool _active;
+    };
+
+    /** ring buffer of the events of a thread, internal */
+    struct ThreadBuffer;
+
+    /** a zone or a frame recorded in a trace, in nanoseconds, internal */
+    struct TraceEvent
+    {
+        unsigned int zone;
+        unsigned int thread;
+        long long start;
+        long long duration;
+    };
+
+protected:
+    struct ZoneAccumulator
+    {
+        unsigned int calls;
+        double totalTime;
+        double selfTime;
+        double maxTime;
+    };
+
+    /** the ring buffer of the calling thread, created the first time */
+    static ThreadBuffer* getThreadBuffer();
+    void collect(ThreadBuffer* buffer);
+    void addTraceEvent(unsigned int zone, unsigned int thread, long long start, long long duration);
+    /** writes the trace recorded until the last frame */
+    void finishTrace();
+    /** drops the events not collected yet */
+    void discardEvents();
+
+    static std::atomic<bool> s_enabled;
+
+    std::vector<ZoneAccumulator> _zones;
+    unsigned int _frameCount;
+    double _totalFrameTime;
+    double _maxFrameTime;
+    /** time stamp of the end of the last frame, 0 before the first one */
+    long long _lastFrameTime;
+    unsigned int _droppedEvents;
+
+    bool _tracing;
+    /** whether the profiler was enabled by startTrace() */
+    bool _enabledByTrace;
+    unsigned int _traceFramesLeft;
+    std::string _tracePath;
+    std::function<void(bool)> _traceCallback;
+    std::vector<TraceEvent> _traceEvents;
+};
+
+#if CC_ENABLE_FRAME_PROFILER
+
+#define CC_PROFILE_CONCAT_(__a__, __b__) __a__##__b__
+#define CC_PROFILE_CONCAT(__a__, __b__) CC_PROFILE_CONCAT_(__a__, __b__)
+
+/** Records the rest of the enclosing scope as a zone. The name must be a string literal. */
+#define CC_PROFILE_ZONE(__name__) \
+    static const unsigned int CC_PROFILE_CONCAT(__ccProfileZone, __LINE__) = cocos2d::FrameProfiler::registerZone(__name__); \
+    cocos2d::FrameProfiler::Scope CC_PROFILE_CONCAT(__ccProfileScope, __LINE__)(CC_PROFILE_CONCAT(__ccProfileZone, __LINE__))
+
+#else
+
+#define CC_PROFILE_ZONE(__name__) do {} while (0)
+
+#endif // CC_ENABLE_FRAME_PROFILER
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCFRAMEPROFILER_H__
@@ -0,0 +1,543 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCGPUProfiler.h"
+#include "CCConfiguration.h"
+#include "ccMacros.h"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#include <EGL/egl.h>
+#endif
+
+NS_CC_BEGIN
+
+// GL_ARB_timer_query on OpenGL, GL_EXT_disjoint_timer_query on OpenGL ES, with the same values
+static const GLenum QUERY_COUNTER_BITS = 0x8864;
+static const GLenum QUERY_RESULT = 0x8866;
+static const GLenum QUERY_RESULT_AVAILABLE = 0x8867;
+static const GLenum QUERY_TIMESTAMP = 0x8E28;
+static const GLenum GPU_DISJOINT = 0x8FBB;
+
+// frames between two calibrations of the GPU clock against the steady clock
+static const unsigned int CALIBRATION_INTERVAL = 300;
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+
+#define CC_GPU_PROFILER_QUERIES 1
+
+typedef GLuint64 QueryUInt64;
+typedef GLint64 QueryInt64;
+
+#define ccGenQueries glGenQueries
+#define ccDeleteQueries glDeleteQueries
+#define ccQueryCounter glQueryCounter
+#define ccGetQueryiv glGetQueryiv
+#define ccGetQueryObjectiv glGetQueryObjectiv
+#define ccGetQueryObjectui64v glGetQueryObjectui64v
+#define ccGetInteger64v glGetInteger64v
+
+// loaded by GLEW
+static bool loadQueryFunctions()
+{
+    return true;
+}
+
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+
+#define CC_GPU_PROFILER_QUERIES 1
+
+typedef unsigned long long QueryUInt64;
+typedef long long QueryInt64;
+
+typedef void (GL_APIENTRYP CC_PFNGLGENQUERIESPROC)(GLsizei n, GLuint* ids);
+typedef void (GL_APIENTRYP CC_PFNGLDELETEQUERIESPROC)(GLsizei n, const GLuint* ids);
+typedef void (GL_APIENTRYP CC_PFNGLQUERYCOUNTERPROC)(GLuint id, GLenum target);
+typedef void (GL_APIENTRYP CC_PFNGLGETQUERYIVPROC)(GLenum target, GLenum pname, GLint* params);
+typedef void (GL_APIENTRYP CC_PFNGLGETQUERYOBJECTIVPROC)(GLuint id, GLenum pname, GLint* params);
+typedef void (GL_APIENTRYP CC_PFNGLGETQUERYOBJECTUI64VPROC)(GLuint id, GLenum pname, QueryUInt64* params);
+typedef void (GL_APIENTRYP CC_PFNGLGETINTEGER64VPROC)(GLenum pname, QueryInt64* data);
+
+static CC_PFNGLGENQUERIESPROC ccGenQueries = NULL;
+static CC_PFNGLDELETEQUERIESPROC ccDeleteQueries = NULL;
+static CC_PFNGLQUERYCOUNTERPROC ccQueryCounter = NULL;
+static CC_PFNGLGETQUERYIVPROC ccGetQueryiv = NULL;
+static CC_PFNGLGETQUERYOBJECTIVPROC ccGetQueryObjectiv = NULL;
+static CC_PFNGLGETQUERYOBJECTUI64VPROC ccGetQueryObjectui64v = NULL;
+static CC_PFNGLGETINTEGER64VPROC ccGetInteger64v = NULL;
+
+static bool loadQueryFunctions()
+{
+    ccGenQueries = (CC_PFNGLGENQUERIESPROC)eglGetProcAddress("glGenQueriesEXT");
+    ccDeleteQueries = (CC_PFNGLDELETEQUERIESPROC)eglGetProcAddress("glDeleteQueriesEXT");
+    ccQueryCounter = (CC_PFNGLQUERYCOUNTERPROC)eglGetProcAddress("glQueryCounterEXT");
+    ccGetQueryiv = (CC_PFNGLGETQUERYIVPROC)eglGetProcAddress("glGetQueryivEXT");
+    ccGetQueryObjectiv = (CC_PFNGLGETQUERYOBJECTIVPROC)eglGetProcAddress("glGetQueryObjectivEXT");
+    ccGetQueryObjectui64v = (CC_PFNGLGETQUERYOBJECTUI64VPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+    ccGetInteger64v = (CC_PFNGLGETINTEGER64VPROC)eglGetProcAddress("glGetInteger64vEXT");
+    return ccGenQueries && ccDeleteQueries && ccQueryCounter && ccGetQueryiv && ccGetQueryObjectiv
+        && ccGetQueryObjectui64v && ccGetInteger64v;
+}
+
+#else
+
+// the other platforms don't expose the timer queries
+#define CC_GPU_PROFILER_QUERIES 0
+
+#endif
+
+static GPUProfiler *s_sharedGPUProfiler = NULL;
+
+bool GPUProfiler::s_enabled = false;
+
+// nanoseconds of the monotonic clock, the clock of the traces of FrameProfiler
+static inline long long profilerTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::vector<const char*>& getZoneNames()
+{
+    static std::vector<const char*> names(1, "GPU frame");
+    return names;
+}
+
+GPUProfiler* GPUProfiler::getInstance()
+{
+    if (!s_sharedGPUProfiler)
+    {
+        s_sharedGPUProfiler = new GPUProfiler();
+    }
+    return s_sharedGPUProfiler;
+}
+
+void GPUProfiler::destroyInstance()
+{
+    if (s_sharedGPUProfiler)
+    {
+        s_sharedGPUProfiler->setEnabled(false);
+    }
+    CC_SAFE_DELETE(s_sharedGPUProfiler);
+}
+
+GPUProfiler::GPUProfiler()
+: _supported(-1)
+, _currentFrame(0)
+, _inFrame(false)
+, _openEvent(-1)
+, _frameCount(0)
+, _totalFrameTime(0)
+, _maxFrameTime(0)
+, _lastFrameTime(0)
+, _droppedFrames(0)
+, _clockOffset(0)
+, _framesSinceCalibration(0)
+{
+}
+
+GPUProfiler::~GPUProfiler()
+{
+}
+
+bool GPUProfiler::isSupported()
+{
+    if (_supported < 0)
+    {
+        _supported = 0;
+#if CC_GPU_PROFILER_QUERIES
+        // some drivers expose the extension with a counter of 0 bits for the timestamps
+        if (Configuration::getInstance()->supportsTimerQuery() && loadQueryFunctions())
+        {
+            GLint bits = 0;
+            ccGetQueryiv(QUERY_TIMESTAMP, QUERY_COUNTER_BITS, &bits);
+            _supported = bits > 0 ? 1 : 0;
+        }
+#endif
+    }
+    return _supported == 1;
+}
+
+bool GPUProfiler::setEnabled(bool enabled)
+{
+    if (enabled == s_enabled)
+    {
+        return s_enabled;
+    }
+
+    if (enabled)
+    {
+        if (!isSupported())
+        {
+            CCLOG("cocos2d: GPUProfiler: the GPU doesn't support the timer queries");
+            return false;
+        }
+
+        Frame empty;
+        empty.usedQueries = 0;
+        empty.pending = false;
+        _frames.assign(CC_GPU_PROFILER_FRAME_LATENCY, empty);
+        _currentFrame = 0;
+        _inFrame = false;
+        _openEvent = -1;
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+        // the flag is cleared when it is read
+        GLint disjoint = 0;
+        glGetIntegerv(GPU_DISJOINT, &disjoint);
+#endif
+        calibrateClock();
+    }
+    else
+    {
+        deleteQueries();
+    }
+
+    s_enabled = enabled;
+    return s_enabled;
+}
+
+unsigned int GPUProfiler::registerZone(const char* name)
+{
+    std::vector<const char*>& names = getZoneNames();
+
+    // the zones with the same name are merged
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (strcmp(names[i], name) == 0)
+        {
+            return (unsigned int)i;
+        }
+    }
+
+    names.push_back(name);
+    return (unsigned int)names.size() - 1;
+}
+
+const char* GPUProfiler::getZoneName(unsigned int zone)
+{
+    const std::vector<const char*>& names = getZoneNames();
+    return zone < names.size() ? names[zone] : "";
+}
+
+unsigned int GPUProfiler::addTimestamp()
+{
+    Frame& frame = _frames[_currentFrame];
+    if (frame.usedQueries == frame.queries.size())
+    {
+        size_t size = frame.queries.size();
+        size_t count = std::max(size, (size_t)16);
+        frame.queries.resize(size + count);
+#if CC_GPU_PROFILER_QUERIES
+        ccGenQueries((GLsizei)count, &frame.queries[size]);
+#endif
+    }
+
+#if CC_GPU_PROFILER_QUERIES
+    ccQueryCounter(frame.queries[frame.usedQueries], QUERY_TIMESTAMP);
+#endif
+    return frame.usedQueries++;
+}
+
+void GPUProfiler::beginZone(unsigned int zone)
+{
+    // the GL commands issued out of the frames, while loading, aren't measured
+    if (!_inFrame)
+    {
+        return;
+    }
+
+    Frame& frame = _frames[_currentFrame];
+    ZoneEvent event = { zone, addTimestamp(), 0, _openEvent };
+    frame.events.push_back(event);
+    _openEvent = (int)frame.events.size() - 1;
+}
+
+void GPUProfiler::endZone(unsigned int zone)
+{
+    if (!_inFrame)
+    {
+        return;
+    }
+
+    // the zones left without end are closed with their parent
+    Frame& frame = _frames[_currentFrame];
+    int open = _openEvent;
+    while (open >= 0 && frame.events[open].zone != zone)
+    {
+        open = frame.events[open].parent;
+    }
+    if (open < 0)
+    {
+        // it began before the profiler was enabled
+        return;
+    }
+
+    unsigned int end = addTimestamp();
+    for (int event = _openEvent; event != frame.events[open].parent; event = frame.events[event].parent)
+    {
+        frame.events[event].end = end;
+    }
+    _openEvent = frame.events[open].parent;
+}
+
+void GPUProfiler::beginFrame()
+{
+    Frame& frame = _frames[_currentFrame];
+    if (frame.pending && !readFrame(frame))
+    {
+        // the GPU is later than the queries kept: the results of the frame are lost
+        ++_droppedFrames;
+    }
+
+    frame.usedQueries = 0;
+    frame.events.clear();
+    frame.pending = false;
+    _inFrame = true;
+    _openEvent = -1;
+    beginZone(FRAME_ZONE);
+}
+
+void GPUProfiler::endFrame()
+{
+    if (!_inFrame)
+    {
+        return;
+    }
+
+    endZone(FRAME_ZONE);
+    _frames[_currentFrame].pending = true;
+    _inFrame = false;
+    _currentFrame = (_currentFrame + 1) % _frames.size();
+
+    // the oldest frames first, the next ones aren't ready when one isn't
+    for (size_t i = 0; i < _frames.size(); ++i)
+    {
+        Frame& frame = _frames[(_currentFrame + i) % _frames.size()];
+        if (frame.pending && !readFrame(frame))
+        {
+            break;
+        }
+    }
+}
+
+bool GPUProfiler::readFrame(Frame& frame)
+{
+#if CC_GPU_PROFILER_QUERIES
+    if (frame.usedQueries == 0)
+    {
+        frame.pending = false;
+        return true;
+    }
+
+    GLint available = 0;
+    ccGetQueryObjectiv(frame.queries[frame.usedQueries - 1], QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        return false;
+    }
+    frame.pending = false;
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    GLint disjoint = 0;
+    glGetIntegerv(GPU_DISJOINT, &disjoint);
+    if (disjoint)
+    {
+        ++_droppedFrames;
+        calibrateClock();
+        return true;
+    }
+#endif
+
+    _timestamps.resize(frame.usedQueries);
+    for (unsigned int i = 0; i < frame.usedQueries; ++i)
+    {
+        QueryUInt64 timestamp = 0;
+        ccGetQueryObjectui64v(frame.queries[i], QUERY_RESULT, &timestamp);
+        _timestamps[i] = timestamp;
+    }
+
+    const std::vector<const char*>& names = getZoneNames();
+    if (_zones.size() < names.size())
+    {
+        ZoneAccumulator empty = { 0, 0, 0, 0 };
+        _zones.resize(names.size(), empty);
+    }
+
+    // the nested zones are closed before their parent
+    std::vector<long long> durations(frame.events.size(), 0);
+    std::vector<long long> childTimes(frame.events.size(), 0);
+    for (size_t i = 0; i < frame.events.size(); ++i)
+    {
+        const ZoneEvent& event = frame.events[i];
+        if (event.end > event.begin && _timestamps[event.end] > _timestamps[event.begin])
+        {
+            durations[i] = (long long)(_timestamps[event.end] - _timestamps[event.begin]);
+        }
+    }
+    for (size_t i = 0; i < frame.events.size(); ++i)
+    {
+        if (frame.events[i].parent >= 0)
+        {
+            childTimes[frame.events[i].parent] += durations[i];
+        }
+    }
+
+    bool tracing = FrameProfiler::getInstance()->isTracing();
+    _lastFrameZones.clear();
+    for (size_t i = 0; i < frame.events.size(); ++i)
+    {
+        const ZoneEvent& event = frame.events[i];
+        double duration = durations[i] / 1000000.0;
+        double self = std::max(durations[i] - childTimes[i], 0LL) / 1000000.0;
+
+        ZoneAccumulator& accumulator = _zones[event.zone];
+        ++accumulator.calls;
+        accumulator.totalTime += duration;
+        accumulator.selfTime += self;
+        accumulator.maxTime = std::max(accumulator.maxTime, duration);
+
+        auto last = std::find_if(_lastFrameZones.begin(), _lastFrameZones.end(), [&](const FrameProfiler::ZoneStats& stats) {
+            return stats.name == names[event.zone];
+        });
+        if (last == _lastFrameZones.end())
+        {
+            FrameProfiler::ZoneStats stats = { names[event.zone], 0, 0, 0, 0 };
+            _lastFrameZones.push_back(stats);
+            last = _lastFrameZones.end() - 1;
+        }
+        ++last->calls;
+        last->totalTime += duration;
+        last->selfTime += self;
+        last->maxTime = std::max(last->maxTime, duration);
+
+        if (tracing)
+        {
+            if (_traceZones.size() < names.size())
+            {
+                _traceZones.resize(names.size(), FrameProfiler::registerZone(names[0]));
+                for (size_t zone = 1; zone < names.size(); ++zone)
+                {
+                    _traceZones[zone] = FrameProfiler::registerZone(names[zone]);
+                }
+            }
+            FrameProfiler::getInstance()->addGPUTraceEvent(_traceZones[event.zone],
+                                                           (long long)_timestamps[event.begin] + _clockOffset, durations[i]);
+        }
+    }
+
+    if (!frame.events.empty() && frame.events[0].zone == FRAME_ZONE)
+    {
+        _lastFrameTime = durations[0] / 1000000.0;
+        ++_frameCount;
+        _totalFrameTime += _lastFrameTime;
+        _maxFrameTime = std::max(_maxFrameTime, _lastFrameTime);
+    }
+
+    if (++_framesSinceCalibration >= CALIBRATION_INTERVAL)
+    {
+        calibrateClock();
+    }
+#else
+    frame.pending = false;
+#endif
+    return true;
+}
+
+void GPUProfiler::calibrateClock()
+{
+#if CC_GPU_PROFILER_QUERIES
+    // the time of the GPU when the commands issued so far have reached it
+    QueryInt64 gpuTime = 0;
+    ccGetInteger64v(QUERY_TIMESTAMP, &gpuTime);
+    _clockOffset = profilerTime() - (long long)gpuTime;
+#endif
+    _framesSinceCalibration = 0;
+}
+
+void GPUProfiler::deleteQueries()
+{
+#if CC_GPU_PROFILER_QUERIES
+    for (auto& frame : _frames)
+    {
+        if (!frame.queries.empty())
+        {
+            ccDeleteQueries((GLsizei)frame.queries.size(), &frame.queries[0]);
+        }
+    }
+#endif
+    _frames.clear();
+    _inFrame = false;
+    _openEvent = -1;
+}
+
+double GPUProfiler::getAverageFrameTime() const
+{
+    return _frameCount > 0 ? _totalFrameTime / _frameCount : 0;
+}
+
+std::vector<FrameProfiler::ZoneStats> GPUProfiler::getZoneStats() const
+{
+    const std::vector<const char*>& names = getZoneNames();
+    std::vector<FrameProfiler::ZoneStats> stats;
+    for (size_t i = 0; i < _zones.size(); ++i)
+    {
+        const ZoneAccumulator& accumulator = _zones[i];
+        if (accumulator.calls > 0)
+        {
+            FrameProfiler::ZoneStats zone = { names[i], accumulator.calls, accumulator.totalTime, accumulator.selfTime, accumulator.maxTime };
+            stats.push_back(zone);
+        }
+    }
+    return stats;
+}
+
+void GPUProfiler::displayZones() const
+{
+    std::vector<FrameProfiler::ZoneStats> stats = getZoneStats();
+    std::sort(stats.begin(), stats.end(), [](const FrameProfiler::ZoneStats& a, const FrameProfiler::ZoneStats& b) {
+        return a.totalTime > b.totalTime;
+    });
+
+    double frames = std::max(_frameCount, 1u);
+    log("GPUProfiler: %u frames, %.3f ms/frame, max %.3f ms, %u frames dropped",
+        _frameCount, getAverageFrameTime(), _maxFrameTime, _droppedFrames);
+    for (const auto& zone : stats)
+    {
+        log("%s: %.3f ms/frame, self %.3f ms/frame, %.1f calls/frame, max %.3f ms",
+            zone.name, zone.totalTime / frames, zone.selfTime / frames, zone.calls / frames, zone.maxTime);
+    }
+}
+
+void GPUProfiler::reset()
+{
+    ZoneAccumulator empty = { 0, 0, 0, 0 };
+    std::fill(_zones.begin(), _zones.end(), empty);
+    _frameCount = 0;
+    _totalFrameTime = 0;
+    _maxFrameTime = 0;
+    _droppedFrames = 0;
+}
+
+NS_CC_END
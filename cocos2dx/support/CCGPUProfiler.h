@@ -0,0 +1,224 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __SUPPORT_CCGPUPROFILER_H__
+#define __SUPPORT_CCGPUPROFILER_H__
+
+#include "ccConfig.h"
+#include "CCGL.h"
+#include "support/CCFrameProfiler.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief GPUProfiler measures the time the GPU spends in the render passes and in tagged subtrees, frame by frame.
+
+ A GPU zone is marked with CC_PROFILE_GPU_ZONE("name") around code that issues GL commands, or with
+ Node::setGPUProfileZone() on a node: the render commands of its subtree are then executed apart, with a flush
+ of the Renderer before and after it, which breaks the batches at its boundaries while the profiler is enabled.
+ The Director measures the frames and the flushes of the Renderer, ClippingNode its stencil and its content,
+ and RenderTexture its passes between begin() and end().
+
+ The zones are measured with timestamp queries (GL_ARB_timer_query, or GL_EXT_disjoint_timer_query on OpenGL ES)
+ read a few frames later, so the GPU isn't waited for: the statistics lag behind by up to
+ CC_GPU_PROFILER_FRAME_LATENCY frames. The frames whose queries aren't available when their queries are needed
+ again, or which were disjoint (the GPU changed its frequency or was switched), are dropped.
+ The time of a zone is the time between the GPU reaching its first and its last commands: on the tile-based
+ GPUs it includes the idle time of the GPU waiting for the commands of the zone.
+
+ The zones are shown by the detailed stats overlay, and recorded on a GPU track in the traces of FrameProfiler.
+ The zones are compiled when CC_ENABLE_FRAME_PROFILER is not 0, the profiler is enabled at runtime with
+ setEnabled() when the GPU supports the queries. When it is disabled, a zone costs one test. Main thread only.
+
+ @since v3.0
+ */
+class CC_DLL GPUProfiler
+{
+public:
+    /** id of the zone of the frames */
+    static const unsigned int FRAME_ZONE = 0;
+
+    /** Gets the single instance of GPUProfiler. */
+    static GPUProfiler* getInstance();
+
+    /** Destroys the single instance of GPUProfiler, and its queries. */
+    static void destroyInstance();
+
+    GPUProfiler();
+    ~GPUProfiler();
+
+    /** Whether the GPU supports the timer queries. Needs a GL context. */
+    bool isSupported();
+
+    /** Whether the zones are measured, false by default */
+    static inline bool isEnabled() { return s_enabled; }
+    /** Enables the profiler if the GPU supports it. Returns whether it is enabled. */
+    bool setEnabled(bool enabled);
+
+    /** Gets the id of a zone, registered the first time. The name isn't copied: it must be a string literal. */
+    static unsigned int registerZone(const char* name);
+    static const char* getZoneName(unsigned int zone);
+
+    /** Marks the beginning and the end of a zone in the GL commands. Use CC_PROFILE_GPU_ZONE instead. */
+    void beginZone(unsigned int zone);
+    void endZone(unsigned int zone);
+
+    /** Marks the beginning and the end of a frame, called by the Director. The results available are read at the end. */
+    void beginFrame();
+    void endFrame();
+
+    /** Number of frames measured since the last reset */
+    unsigned int getFrameCount() const { return _frameCount; }
+    /** Average and maximum GPU times of the frames since the last reset, in milliseconds */
+    double getAverageFrameTime() const;
+    double getMaxFrameTime() const { return _maxFrameTime; }
+    /** Frames dropped since the last reset */
+    unsigned int getDroppedFrameCount() const { return _droppedFrames; }
+
+    /** GPU time of the last frame measured, in milliseconds */
+    double getLastFrameTime() const { return _lastFrameTime; }
+    /** Statistics of the zones of the last frame measured */
+    const std::vector<FrameProfiler::ZoneStats>& getLastFrameZones() const { return _lastFrameZones; }
+
+    /** Statistics of the zones since the last reset, the times are in milliseconds */
+    std::vector<FrameProfiler::ZoneStats> getZoneStats() const;
+
+    /** Logs the statistics of the zones per frame, the most expensive first */
+    void displayZones() const;
+
+    /** Clears the statistics */
+    void reset();
+
+    /** Measures a zone for the lifetime of the object */
+    class Scope
+    {
+    public:
+        explicit Scope(unsigned int zone)
+        : _zone(zone)
+        , _active(GPUProfiler::isEnabled())
+        {
+            if (_active)
+            {
+                GPUProfiler::getInstance()->beginZone(_zone);
+            }
+        }
+
+        ~Scope()
+        {
+            if (_active && GPUProfiler::isEnabled())
+            {
+                GPUProfiler::getInstance()->endZone(_zone);
+            }
+        }
+
+    private:
+        unsigned int _zone;
+        bool _active;
+    };
+
+protected:
+    struct ZoneEvent
+    {
+        unsigned int zone;
+        /** indices of the queries of the beginning and of the end, the end is 0 while the zone is open */
+        unsigned int begin;
+        unsigned int end;
+        /** index of the enclosing event, -1 for none */
+        int parent;
+    };
+
+    /** the queries of a frame, read CC_GPU_PROFILER_FRAME_LATENCY frames later */
+    struct Frame
+    {
+        std::vector<GLuint> queries;
+        unsigned int usedQueries;
+        std::vector<ZoneEvent> events;
+        bool pending;
+    };
+
+    struct ZoneAccumulator
+    {
+        unsigned int calls;
+        double totalTime;
+        double selfTime;
+        double maxTime;
+    };
+
+    /** issues a timestamp query in the current frame. Returns its index */
+    unsigned int addTimestamp();
+    /** reads the queries of a frame if they are available. Returns false if they aren't */
+    bool readFrame(Frame& frame);
+    void calibrateClock();
+    void deleteQueries();
+
+    static bool s_enabled;
+
+    int _supported;
+    std::vector<Frame> _frames;
+    unsigned int _currentFrame;
+    bool _inFrame;
+    /** events of the current frame enclosing the next zone */
+    int _openEvent;
+
+    std::vector<ZoneAccumulator> _zones;
+    unsigned int _frameCount;
+    double _totalFrameTime;
+    double _maxFrameTime;
+    double _lastFrameTime;
+    unsigned int _droppedFrames;
+    std::vector<FrameProfiler::ZoneStats> _lastFrameZones;
+
+    /** zones of the traces of FrameProfiler */
+    std::vector<unsigned int> _traceZones;
+    /** steady clock time minus GPU time, in nanoseconds */
+    long long _clockOffset;
+    unsigned int _framesSinceCalibration;
+    std::vector<unsigned long long> _timestamps;
+};
+
+#if CC_ENABLE_FRAME_PROFILER
+
+/** Measures the GL commands of the rest of the enclosing scope on the GPU. The name must be a string literal. */
+#define CC_PROFILE_GPU_ZONE(__name__) \
+    static const unsigned int CC_PROFILE_CONCAT(__ccProfileGPUZone, __LINE__) = cocos2d::GPUProfiler::registerZone(__name__); \
+    cocos2d::GPUProfiler::Scope CC_PROFILE_CONCAT(__ccProfileGPUScope, __LINE__)(CC_PROFILE_CONCAT(__ccProfileGPUZone, __LINE__))
+
+#else
+
+#define CC_PROFILE_GPU_ZONE(__name__) do {} while (0)
+
+#endif // CC_ENABLE_FRAME_PROFILER
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCGPUPROFILER_H__
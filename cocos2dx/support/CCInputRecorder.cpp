@@ -0,0 +1,520 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "CCInputRecorder.h"
+#include "CCDirector.h"
+#include "CCEGLView.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCAccelerometerDelegate.h"
+#include "keypad_dispatcher/CCKeypadDispatcher.h"
+#include "keyboard_dispatcher/CCKeyboardDispatcher.h"
+#include "event_dispatcher/CCEventDispatcher.h"
+#include "event_dispatcher/CCEvent.h"
+#include "support/CCFrameProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+NS_CC_BEGIN
+
+extern const char* cocos2dVersion(void);
+
+/*
+ The file starts with a header, followed by the records: the type, the frame, the size of the data, and the data.
+ The values are written in the byte order of the machine.
+ */
+static const char RECORDING_MAGIC[4] = { 'C', 'C', 'I', 'R' };
+static const uint32_t RECORDING_VERSION = 1;
+
+struct RecordingHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t seed;
+};
+
+struct RecordHeader
+{
+    uint8_t type;
+    uint32_t frame;
+    uint32_t size;
+};
+
+struct TouchRecord
+{
+    int32_t id;
+    float x;
+    float y;
+};
+
+static InputRecorder *s_sharedInputRecorder = NULL;
+bool InputRecorder::s_active = false;
+
+static double getTime()
+{
+    return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+InputRecorder* InputRecorder::getInstance()
+{
+    if (!s_sharedInputRecorder)
+    {
+        s_sharedInputRecorder = new InputRecorder();
+    }
+    return s_sharedInputRecorder;
+}
+
+void InputRecorder::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedInputRecorder);
+}
+
+InputRecorder::InputRecorder()
+: _file(nullptr)
+, _replaying(false)
+, _dispatching(false)
+, _nextRecord(0)
+, _lastFrameTime(0.0)
+, _frame(0)
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+    stopRecording();
+    stopReplay();
+}
+
+bool InputRecorder::startRecording(const std::string& path)
+{
+    stopRecording();
+    stopReplay();
+
+    _file = fopen(path.c_str(), "wb");
+    if (_file == nullptr)
+    {
+        CCLOG("cocos2d: InputRecorder: can't write %s", path.c_str());
+        return false;
+    }
+
+    RecordingHeader header;
+    memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+    header.version = RECORDING_VERSION;
+    header.seed = (uint32_t)time(nullptr);
+    fwrite(&header, sizeof(header), 1, _file);
+    srand(header.seed);
+
+    _frame = 0;
+    s_active = true;
+    return true;
+}
+
+void InputRecorder::stopRecording()
+{
+    if (_file)
+    {
+        fclose(_file);
+        _file = nullptr;
+        s_active = _replaying;
+    }
+}
+
+void InputRecorder::writeRecord(RecordType type, const void* data, size_t size)
+{
+    RecordHeader header;
+    header.type = (uint8_t)type;
+    header.frame = _frame;
+    header.size = (uint32_t)size;
+    fwrite(&header, sizeof(header), 1, _file);
+    fwrite(data, size, 1, _file);
+}
+
+bool InputRecorder::startReplay(const std::string& path, const std::function<void()>& callback)
+{
+    stopRecording();
+    stopReplay();
+
+    unsigned long size = 0;
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(path.c_str());
+    unsigned char* bytes = FileUtils::getInstance()->getFileData(fullPath.c_str(), "rb", &size);
+    if (bytes == nullptr)
+    {
+        CCLOG("cocos2d: InputRecorder: can't read %s", path.c_str());
+        return false;
+    }
+
+    RecordingHeader header;
+    bool valid = size >= sizeof(header);
+    if (valid)
+    {
+        memcpy(&header, bytes, sizeof(header));
+        valid = memcmp(header.magic, RECORDING_MAGIC, sizeof(header.magic)) == 0 && header.version == RECORDING_VERSION;
+    }
+
+    // the delta times are indexed by frame, the events are kept in the order they arrived
+    size_t offset = sizeof(header);
+    while (valid && offset < size)
+    {
+        RecordHeader recordHeader;
+        valid = offset + sizeof(recordHeader) <= size;
+        if (valid)
+        {
+            memcpy(&recordHeader, bytes + offset, sizeof(recordHeader));
+            offset += sizeof(recordHeader);
+            valid = offset + recordHeader.size <= size;
+        }
+        if (!valid)
+        {
+            // the end of a recording interrupted by a crash
+            CCLOG("cocos2d: InputRecorder: %s is truncated", path.c_str());
+            valid = true;
+            break;
+        }
+
+        if ((RecordType)recordHeader.type == RecordType::FRAME && recordHeader.size == sizeof(float))
+        {
+            float deltaTime;
+            memcpy(&deltaTime, bytes + offset, sizeof(deltaTime));
+            _deltaTimes.resize(recordHeader.frame + 1, deltaTime);
+            _deltaTimes[recordHeader.frame] = deltaTime;
+        }
+        else
+        {
+            Record record = { (RecordType)recordHeader.type, recordHeader.frame, (unsigned int)_data.size() };
+            _records.push_back(record);
+            _data.insert(_data.end(), bytes + offset, bytes + offset + recordHeader.size);
+        }
+        offset += recordHeader.size;
+    }
+    delete [] bytes;
+
+    if (!valid)
+    {
+        CCLOG("cocos2d: InputRecorder: %s isn't a recording", path.c_str());
+        stopReplay();
+        return false;
+    }
+
+    srand(header.seed);
+    if (FrameProfiler::isEnabled())
+    {
+        FrameProfiler::getInstance()->reset();
+    }
+
+    _callback = callback;
+    _frameTimes.clear();
+    _frameTimes.reserve(_deltaTimes.size());
+    _nextRecord = 0;
+    _frame = 0;
+    _replaying = true;
+    s_active = true;
+    return true;
+}
+
+void InputRecorder::stopReplay()
+{
+    _replaying = false;
+    _records.clear();
+    _data.clear();
+    _deltaTimes.clear();
+    _callback = nullptr;
+    s_active = _file != nullptr;
+}
+
+bool InputRecorder::onTouches(TouchPhase phase, int num, int ids[], float xs[], float ys[])
+{
+    if (_replaying)
+    {
+        return _dispatching;
+    }
+
+    if (_file)
+    {
+        std::vector<unsigned char> data(1 + sizeof(int32_t) + num * sizeof(TouchRecord));
+        data[0] = (unsigned char)phase;
+        int32_t count = num;
+        memcpy(&data[1], &count, sizeof(count));
+        for (int i = 0; i < num; ++i)
+        {
+            TouchRecord touch = { ids[i], xs[i], ys[i] };
+            memcpy(&data[1 + sizeof(count) + i * sizeof(touch)], &touch, sizeof(touch));
+        }
+        writeRecord(RecordType::TOUCHES, &data[0], data.size());
+    }
+    return true;
+}
+
+bool InputRecorder::onKeypad(int type)
+{
+    if (_replaying)
+    {
+        return _dispatching;
+    }
+
+    if (_file)
+    {
+        int32_t value = type;
+        writeRecord(RecordType::KEYPAD, &value, sizeof(value));
+    }
+    return true;
+}
+
+bool InputRecorder::onKeyboard(int keyCode, bool pressed)
+{
+    if (_replaying)
+    {
+        return _dispatching;
+    }
+
+    if (_file)
+    {
+        unsigned char data[sizeof(int32_t) + 1];
+        int32_t value = keyCode;
+        memcpy(data, &value, sizeof(value));
+        data[sizeof(value)] = pressed ? 1 : 0;
+        writeRecord(RecordType::KEYBOARD, data, sizeof(data));
+    }
+    return true;
+}
+
+bool InputRecorder::onAcceleration(const Acceleration& acceleration)
+{
+    if (_replaying)
+    {
+        return _dispatching;
+    }
+
+    if (_file)
+    {
+        double values[4] = { acceleration.x, acceleration.y, acceleration.z, acceleration.timestamp };
+        writeRecord(RecordType::ACCELERATION, values, sizeof(values));
+    }
+    return true;
+}
+
+float InputRecorder::onFrame(float deltaTime)
+{
+    if (_file)
+    {
+        writeRecord(RecordType::FRAME, &deltaTime, sizeof(deltaTime));
+        ++_frame;
+        return deltaTime;
+    }
+
+    if (!_replaying)
+    {
+        return deltaTime;
+    }
+
+    // the time since the previous call is the time of the previous frame
+    double now = getTime();
+    if (_frame > 0)
+    {
+        _frameTimes.push_back((float)((now - _lastFrameTime) * 1000.0));
+    }
+    _lastFrameTime = now;
+
+    if (_frame >= _deltaTimes.size())
+    {
+        std::function<void()> callback = _callback;
+        stopReplay();
+        if (callback)
+        {
+            callback();
+        }
+        return deltaTime;
+    }
+
+    // the events that arrived before the frame when it was recorded
+    while (_nextRecord < _records.size() && _records[_nextRecord].frame <= _frame)
+    {
+        dispatchRecord(_records[_nextRecord++]);
+        if (!_replaying)
+        {
+            // stopped by a listener
+            return deltaTime;
+        }
+    }
+
+    return _deltaTimes[_frame++];
+}
+
+void InputRecorder::dispatchRecord(const Record& record)
+{
+    Director* director = Director::getInstance();
+    const unsigned char* data = &_data[record.dataOffset];
+    _dispatching = true;
+
+    switch (record.type)
+    {
+    case RecordType::TOUCHES:
+        {
+            TouchPhase phase = (TouchPhase)data[0];
+            int32_t count;
+            memcpy(&count, data + 1, sizeof(count));
+
+            std::vector<int> ids(count);
+            std::vector<float> xs(count);
+            std::vector<float> ys(count);
+            for (int i = 0; i < count; ++i)
+            {
+                TouchRecord touch;
+                memcpy(&touch, data + 1 + sizeof(count) + i * sizeof(touch), sizeof(touch));
+                ids[i] = touch.id;
+                xs[i] = touch.x;
+                ys[i] = touch.y;
+            }
+
+            EGLView* view = director->getOpenGLView();
+            if (view && count > 0)
+            {
+                switch (phase)
+                {
+                case TouchPhase::BEGAN: view->handleTouchesBegin(count, &ids[0], &xs[0], &ys[0]); break;
+                case TouchPhase::MOVED: view->handleTouchesMove(count, &ids[0], &xs[0], &ys[0]); break;
+                case TouchPhase::ENDED: view->handleTouchesEnd(count, &ids[0], &xs[0], &ys[0]); break;
+                case TouchPhase::CANCELLED: view->handleTouchesCancel(count, &ids[0], &xs[0], &ys[0]); break;
+                }
+            }
+        }
+        break;
+    case RecordType::KEYPAD:
+        {
+            int32_t type;
+            memcpy(&type, data, sizeof(type));
+            director->getKeypadDispatcher()->dispatchKeypadMSG((ccKeypadMSGType)type);
+        }
+        break;
+    case RecordType::KEYBOARD:
+        {
+            int32_t keyCode;
+            memcpy(&keyCode, data, sizeof(keyCode));
+            director->getKeyboardDispatcher()->dispatchKeyboardEvent(keyCode, data[sizeof(keyCode)] != 0);
+        }
+        break;
+    case RecordType::ACCELERATION:
+        {
+            double values[4];
+            memcpy(values, data, sizeof(values));
+            Acceleration acceleration;
+            acceleration.x = values[0];
+            acceleration.y = values[1];
+            acceleration.z = values[2];
+            acceleration.timestamp = values[3];
+            EventAcceleration event(acceleration);
+            director->getEventDispatcher()->dispatchEvent(&event);
+        }
+        break;
+    default:
+        break;
+    }
+
+    _dispatching = false;
+}
+
+// value at a fraction of the sorted values
+static float percentile(const std::vector<float>& sorted, float fraction)
+{
+    return sorted[(size_t)(fraction * (sorted.size() - 1) + 0.5f)];
+}
+
+static std::string escapeJSON(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+bool InputRecorder::writeReport(const std::string& path, const std::string& name) const
+{
+    if (_frameTimes.empty())
+    {
+        return false;
+    }
+
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        CCLOG("cocos2d: InputRecorder: can't write %s", path.c_str());
+        return false;
+    }
+
+    std::vector<float> sorted(_frameTimes);
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (float time : sorted)
+    {
+        sum += time;
+    }
+    double mean = sum / sorted.size();
+    double variance = 0.0;
+    for (float time : sorted)
+    {
+        variance += (time - mean) * (time - mean);
+    }
+    double deviation = sqrt(variance / sorted.size());
+
+    fprintf(file, "{\n  \"engine\": \"%s\",\n  \"frames\": %u,\n  \"scenarios\": [\n", escapeJSON(cocos2dVersion()).c_str(), (unsigned int)_frameTimes.size());
+    fprintf(file, "    {\n      \"name\": \"%s\",\n", escapeJSON(name).c_str());
+    fprintf(file, "      \"frameTime\": { \"mean\": %.3f, \"stddev\": %.3f, \"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n",
+            mean, deviation, sorted.front(), percentile(sorted, 0.5f), percentile(sorted, 0.9f), percentile(sorted, 0.95f),
+            percentile(sorted, 0.99f), sorted.back());
+
+    std::vector<FrameProfiler::ZoneStats> zones;
+    if (FrameProfiler::isEnabled())
+    {
+        zones = FrameProfiler::getInstance()->getZoneStats();
+    }
+    fprintf(file, "      \"zones\": [");
+    for (size_t i = 0; i < zones.size(); ++i)
+    {
+        const FrameProfiler::ZoneStats& zone = zones[i];
+        fprintf(file, "%s\n        { \"name\": \"%s\", \"calls\": %u, \"totalTime\": %.3f, \"selfTime\": %.3f, \"maxTime\": %.3f }",
+                i > 0 ? "," : "", escapeJSON(zone.name).c_str(), zone.calls, zone.totalTime, zone.selfTime, zone.maxTime);
+    }
+    fprintf(file, "%s],\n", zones.empty() ? "" : "\n      ");
+
+    fprintf(file, "      \"frameTimes\": [");
+    for (size_t i = 0; i < _frameTimes.size(); ++i)
+    {
+        fprintf(file, "%s%.3f", i > 0 ? ", " : "", _frameTimes[i]);
+    }
+    fprintf(file, "]\n    }\n  ]\n}\n");
+
+    fclose(file);
+    return true;
+}
+
+NS_CC_END
@@ -0,0 +1,176 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __SUPPORT_CCINPUTRECORDER_H__
+#define __SUPPORT_CCINPUTRECORDER_H__
+
+#include "platform/CCPlatformMacros.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+NS_CC_BEGIN
+
+class Acceleration;
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief InputRecorder records the input and the delta time of the frames, and replays them deterministically.
+
+The touches given to the EGLView, the keypad and keyboard events and the accelerometer values are written to a file
+with the frame they arrived in, along with the delta time of each frame computed by the Director and the seed given
+to srand(). Replaying the file dispatches the same events before the same frames, updated with the same delta times:
+the game goes through the same sequence, whatever time the frames take, so the frame times of two builds can be
+compared. The live input is ignored during a replay.
+
+The recording and the replay must start from the same state, for instance from the launch of the application, or when
+the same scene is entered. The touches are recorded in the coordinates of the view: replay them with the same frame size.
+
+During a replay the frame times are measured, and writeReport() writes them with the zones of the FrameProfiler, when
+it is enabled, in the JSON format of the benchmark runner of TestCpp.
+
+@since v3.0
+*/
+class CC_DLL InputRecorder
+{
+public:
+    enum class TouchPhase
+    {
+        BEGAN,
+        MOVED,
+        ENDED,
+        CANCELLED,
+    };
+
+    /** Gets the single instance of InputRecorder. */
+    static InputRecorder* getInstance();
+
+    /** Destroys the single instance of InputRecorder, closing the recording. */
+    static void destroyInstance();
+
+    /** Whether a recording or a replay is running, checked by the input entry points before getInstance() */
+    static inline bool isActive() { return s_active; }
+
+    InputRecorder();
+    ~InputRecorder();
+
+    /** Starts recording into a file, usually in FileUtils::getWritablePath(). The events are written as they
+     arrive, so the recording survives a crash. The random generator is seeded with a new seed, which is recorded.
+     @return false if the file can't be written
+     */
+    bool startRecording(const std::string& path);
+
+    /** Stops recording and closes the file */
+    void stopRecording();
+
+    bool isRecording() const { return _file != nullptr; }
+
+    /** Starts replaying a recording from the next frame. The random generator is seeded as it was when it was recorded.
+     @param callback called once the last recorded frame is replayed. Can be nullptr
+     @return false if the file can't be read
+     */
+    bool startReplay(const std::string& path, const std::function<void()>& callback = nullptr);
+
+    /** Stops replaying, the live input is dispatched again */
+    void stopReplay();
+
+    bool isReplaying() const { return _replaying; }
+
+    /** Frames recorded, or replayed, since the start */
+    unsigned int getFrame() const { return _frame; }
+
+    /** Number of frames of the replayed recording */
+    unsigned int getFrameCount() const { return (unsigned int)_deltaTimes.size(); }
+
+    /** Wall-clock times of the replayed frames, in milliseconds */
+    const std::vector<float>& getFrameTimes() const { return _frameTimes; }
+
+    /** Writes the frame times of the replay and the zones of the FrameProfiler as JSON.
+     @param name name of the scenario in the report, usually the recording
+     */
+    bool writeReport(const std::string& path, const std::string& name) const;
+
+    /** Called by the EGLView, the KeypadDispatcher, the KeyboardDispatcher and the EventDispatcher with the events
+     they get. Records the event, and returns false when it must be dropped because a replay is running.
+     */
+    bool onTouches(TouchPhase phase, int num, int ids[], float xs[], float ys[]);
+    bool onKeypad(int type);
+    bool onKeyboard(int keyCode, bool pressed);
+    bool onAcceleration(const Acceleration& acceleration);
+
+    /** Called by the Director with the delta time of each new frame. Records it, or dispatches the events recorded
+     before the frame and returns the recorded delta time when replaying.
+     */
+    float onFrame(float deltaTime);
+
+protected:
+    enum class RecordType : unsigned char
+    {
+        FRAME,
+        TOUCHES,
+        KEYPAD,
+        KEYBOARD,
+        ACCELERATION,
+    };
+
+    /** a recorded event, with its data */
+    struct Record
+    {
+        RecordType type;
+        unsigned int frame;
+        unsigned int dataOffset;
+    };
+
+    void writeRecord(RecordType type, const void* data, size_t size);
+    void dispatchRecord(const Record& record);
+
+    static bool s_active;
+
+    // recording
+    FILE* _file;
+    // replay
+    bool _replaying;
+    bool _dispatching;
+    std::vector<Record> _records;
+    std::vector<unsigned char> _data;
+    std::vector<float> _deltaTimes;
+    std::vector<float> _frameTimes;
+    size_t _nextRecord;
+    double _lastFrameTime;
+    std::function<void()> _callback;
+
+    unsigned int _frame;
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCINPUTRECORDER_H__
@@ -0,0 +1,402 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCJobSystem.h"
+#include "ccMacros.h"
+#include "CCDirector.h"
+#include "CCScheduler.h"
+#include "platform/CCThread.h"
+#include "support/CCFrameProfiler.h"
+#include <algorithm>
+
+NS_CC_BEGIN
+
+static JobSystem *s_sharedJobSystem = NULL;
+
+JobSystem* JobSystem::getInstance()
+{
+    if (!s_sharedJobSystem)
+    {
+        s_sharedJobSystem = new JobSystem();
+    }
+    return s_sharedJobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedJobSystem);
+}
+
+JobSystem::JobSystem()
+: _workerCount(0)
+, _started(false)
+, _quit(false)
+, _running(false)
+, _nextItem(0)
+, _count(0)
+, _grainSize(1)
+, _job(NULL)
+, _generation(0)
+, _loopActive(false)
+, _loopWorkers(0)
+{
+#ifndef EMSCRIPTEN
+    // keep one core for the main thread
+    int cores = (int)std::thread::hardware_concurrency();
+    _workerCount = MIN(MAX(cores - 1, 1), 7);
+#endif // EMSCRIPTEN
+}
+
+JobSystem::~JobSystem()
+{
+    stopWorkers();
+
+    for (auto& task : _tasks)
+    {
+        task->_cancelled = true;
+        task->_state = Task::State::DONE;
+    }
+    _tasks.clear();
+}
+
+void JobSystem::setWorkerCount(unsigned int count)
+{
+    std::lock_guard<std::mutex> loopLock(_loopMutex);
+
+    bool started = _started;
+    stopWorkers();
+    _workerCount = count;
+
+    if (_workerCount == 0)
+    {
+        runQueuedTasks();
+    }
+    else if (started)
+    {
+        startWorkers();
+    }
+}
+
+void JobSystem::startWorkers()
+{
+    _quit = false;
+    for (unsigned int i = 0; i < _workerCount; ++i)
+    {
+        // the new workers wait for the next loop
+        _workers.push_back(new std::thread(&JobSystem::workerLoop, this, _generation));
+    }
+    _started = true;
+}
+
+void JobSystem::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _wakeCondition.notify_all();
+
+    for (auto worker : _workers)
+    {
+        worker->join();
+        delete worker;
+    }
+    _workers.clear();
+    _started = false;
+}
+
+void JobSystem::workerLoop(unsigned int generation)
+{
+    FrameProfiler::setThreadName("JobSystem worker");
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _wakeCondition.wait(lock, [this, generation] {
+            return _quit || (_loopActive && _generation != generation) || ! _tasks.empty();
+        });
+        if (_quit)
+        {
+            return;
+        }
+
+        // the loops first, the main thread is waiting for them
+        if (_loopActive && _generation != generation)
+        {
+            generation = _generation;
+            ++_loopWorkers;
+            lock.unlock();
+
+            runJobs();
+
+            lock.lock();
+            if (--_loopWorkers == 0)
+            {
+                _doneCondition.notify_all();
+            }
+            continue;
+        }
+
+        TaskPtr task = _tasks.front();
+        _tasks.pop_front();
+        lock.unlock();
+
+        runTask(task);
+
+        lock.lock();
+    }
+}
+
+void JobSystem::runJobs()
+{
+    while (true)
+    {
+        unsigned int begin = _nextItem.fetch_add(_grainSize);
+        if (begin >= _count)
+        {
+            break;
+        }
+        (*_job)(begin, MIN(begin + _grainSize, _count));
+    }
+}
+
+void JobSystem::parallelFor(unsigned int count, unsigned int grainSize, const Job& job)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // nested loops and loops started while another thread runs one are not split
+    if (_workerCount == 0 || count == 1 || _running.exchange(true))
+    {
+        job(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> loopLock(_loopMutex);
+
+    if (! _started)
+    {
+        startWorkers();
+    }
+
+    if (grainSize == 0)
+    {
+        // a few ranges per thread, so that the threads finishing first can take more
+        grainSize = MAX(count / ((_workerCount + 1) * 4), 1u);
+    }
+
+    _count = count;
+    _grainSize = grainSize;
+    _job = &job;
+    _nextItem = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _loopActive = true;
+        ++_generation;
+    }
+    _wakeCondition.notify_all();
+
+    runJobs();
+
+    // all the ranges are taken: waits for the workers that are still running one
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _loopActive = false;
+        _doneCondition.wait(lock, [this] { return _loopWorkers == 0; });
+    }
+
+    _job = NULL;
+    _running = false;
+}
+
+JobSystem::TaskPtr JobSystem::addTask(const std::function<void()>& work, const std::function<void()>& callback, int priority)
+{
+    return addTask(work, callback, std::vector<TaskPtr>(), priority);
+}
+
+JobSystem::TaskPtr JobSystem::addTask(const std::function<void()>& work, const std::function<void()>& callback, const std::vector<TaskPtr>& dependencies, int priority)
+{
+    CCASSERT(work, "JobSystem: a task needs some work");
+
+    TaskPtr task = std::make_shared<Task>();
+    task->_work = work;
+    task->_callback = callback;
+    task->_priority = priority;
+    task->_state = Task::State::WAITING;
+    task->_cancelled = false;
+    task->_pendingDependencies = 0;
+
+    if (_workerCount > 0 && ! _started)
+    {
+        std::lock_guard<std::mutex> loopLock(_loopMutex);
+        if (! _started)
+        {
+            startWorkers();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& dependency : dependencies)
+        {
+            if (dependency->_state != Task::State::DONE)
+            {
+                dependency->_dependents.push_back(task);
+                ++task->_pendingDependencies;
+            }
+        }
+
+        if (task->_pendingDependencies == 0)
+        {
+            queueTask(task);
+        }
+    }
+
+    if (_workerCount == 0)
+    {
+        runQueuedTasks();
+    }
+    return task;
+}
+
+void JobSystem::queueTask(const TaskPtr& task)
+{
+    task->_state = Task::State::QUEUED;
+
+    // after the tasks with the same or a higher priority
+    auto pos = std::upper_bound(_tasks.begin(), _tasks.end(), task,
+                                [](const TaskPtr& a, const TaskPtr& b) { return a->_priority > b->_priority; });
+    _tasks.insert(pos, task);
+    _wakeCondition.notify_one();
+}
+
+void JobSystem::runQueuedTasks()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (! _tasks.empty())
+    {
+        TaskPtr task = _tasks.front();
+        _tasks.pop_front();
+        lock.unlock();
+
+        runTask(task);
+
+        lock.lock();
+    }
+}
+
+void JobSystem::runTask(const TaskPtr& task)
+{
+    task->_state = Task::State::RUNNING;
+    if (! task->_cancelled)
+    {
+        // create autorelease pool for iOS
+        Thread thread;
+        thread.createAutoreleasePool();
+
+        CC_PROFILE_ZONE("JobSystem - task");
+        task->_work();
+    }
+    // releases what the work holds in the thread that ran it
+    task->_work = nullptr;
+
+    if (task->_callback && ! task->_cancelled)
+    {
+        TaskPtr callbackTask = task;
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([callbackTask] {
+            // it may have been cancelled since it was queued
+            if (! callbackTask->_cancelled)
+            {
+                callbackTask->_callback();
+            }
+            callbackTask->_callback = nullptr;
+        });
+    }
+
+    std::vector<TaskPtr> dependents;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        task->_state = Task::State::DONE;
+        dependents.swap(task->_dependents);
+        for (auto& dependent : dependents)
+        {
+            if (--dependent->_pendingDependencies == 0)
+            {
+                queueTask(dependent);
+            }
+        }
+    }
+    _taskDoneCondition.notify_all();
+}
+
+bool JobSystem::cancelTask(const TaskPtr& task)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    task->_cancelled = true;
+
+    if (task->_state == Task::State::QUEUED)
+    {
+        auto it = std::find(_tasks.begin(), _tasks.end(), task);
+        if (it != _tasks.end())
+        {
+            _tasks.erase(it);
+        }
+        lock.unlock();
+
+        // completes it without running its work, for its dependents
+        runTask(task);
+        return true;
+    }
+
+    // the tasks waiting for their dependencies are completed like the others, when they become ready
+    return task->_state == Task::State::WAITING;
+}
+
+void JobSystem::waitForTask(const TaskPtr& task)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (task->_state != Task::State::DONE)
+    {
+        if (! _tasks.empty())
+        {
+            TaskPtr queued = _tasks.front();
+            _tasks.pop_front();
+            lock.unlock();
+
+            runTask(queued);
+
+            lock.lock();
+        }
+        else
+        {
+            _taskDoneCondition.wait(lock);
+        }
+    }
+}
+
+NS_CC_END
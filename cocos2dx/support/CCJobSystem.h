@@ -0,0 +1,189 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __SUPPORT_CCJOBSYSTEM_H__
+#define __SUPPORT_CCJOBSYSTEM_H__
+
+#include "platform/CCPlatformMacros.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief Runs tasks and loops of independent jobs on a pool of worker threads shared by the engine and the games.
+
+ The worker threads are created when needed and sleep when there is nothing to do.
+
+ - Tasks run on a worker thread once the tasks they depend on are done.
+   They can have a callback, called on the main thread by the Scheduler once the task is done.
+ - Loops (parallelFor()) split a range of items between the workers and the calling thread,
+   which waits for all of them before returning.
+
+ The workers are meant for computations: blocking I/O, like network requests, keeps them from running other tasks.
+
+ @since v3.0
+ */
+class CC_DLL JobSystem
+{
+public:
+    /** the job of a loop, called for the items [begin, end) */
+    typedef std::function<void(unsigned int begin, unsigned int end)> Job;
+
+    /** A task added with addTask() */
+    class CC_DLL Task
+    {
+    public:
+        /** whether the work of the task is done, or the task was cancelled before it ran.
+         * Its callback may not have been called yet.
+         */
+        inline bool isDone() const { return _state == State::DONE; }
+
+        /** whether the task was cancelled */
+        inline bool isCancelled() const { return _cancelled; }
+
+    private:
+        friend class JobSystem;
+
+        enum class State
+        {
+            WAITING,    // for its dependencies
+            QUEUED,
+            RUNNING,
+            DONE,
+        };
+
+        std::function<void()> _work;
+        std::function<void()> _callback;
+        int _priority;
+        std::atomic<State> _state;
+        std::atomic<bool> _cancelled;
+        // under JobSystem::_mutex
+        unsigned int _pendingDependencies;
+        std::vector<std::shared_ptr<Task>> _dependents;
+    };
+
+    typedef std::shared_ptr<Task> TaskPtr;
+
+    /** Gets the single instance of JobSystem. */
+    static JobSystem* getInstance();
+
+    /** Destroys the single instance of JobSystem. The worker threads are joined, and the queued tasks are dropped. */
+    static void destroyInstance();
+
+    JobSystem();
+    ~JobSystem();
+
+    /** Runs work on a worker thread, then callback on the main thread.
+     * The tasks with a higher priority are run first, the ones with the same priority in the order they were added.
+     * Without worker threads the work is done immediately by the calling thread.
+     * @param callback called by the Scheduler, in the main thread, once the work is done. Can be nullptr
+     */
+    TaskPtr addTask(const std::function<void()>& work, const std::function<void()>& callback, int priority = 0);
+
+    /** Same as addTask(work, callback, priority), but the work is only run once all the dependencies are done. */
+    TaskPtr addTask(const std::function<void()>& work, const std::function<void()>& callback, const std::vector<TaskPtr>& dependencies, int priority = 0);
+
+    /** Cancels a task: its work won't be run if it didn't start yet, and its callback won't be called.
+     * The work of a cancelled task counts as done for the tasks depending on it.
+     * Must be called from the main thread.
+     * @return true if the work of the task won't be run
+     */
+    bool cancelTask(const TaskPtr& task);
+
+    /** Waits for the work of a task to be done, running the queued tasks meanwhile.
+     * Its callback is still called by the Scheduler.
+     */
+    void waitForTask(const TaskPtr& task);
+
+    /** Calls job for ranges of at most grainSize items covering [0, count), in parallel.
+     * The ranges are distributed to the threads on demand, so a slow range doesn't stall the others.
+     * The workers running tasks don't delay the loop: it is completed by the other threads.
+     * If grainSize is 0, it is chosen from the number of threads.
+     * Loops started from a job, or while another thread runs a loop, run on the calling thread only.
+     */
+    void parallelFor(unsigned int count, unsigned int grainSize, const Job& job);
+
+    /** Number of worker threads, the thread calling parallelFor() not included.
+     * By default it is the number of CPU cores minus one, between 1 and 7.
+     */
+    inline unsigned int getWorkerCount() const { return _workerCount; };
+
+    /** Sets the number of worker threads. The current workers are joined once they are done with their task.
+     * It must not be called from a task or a job.
+     */
+    void setWorkerCount(unsigned int count);
+
+private:
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop(unsigned int generation);
+    void runJobs();
+    /** queues a task whose dependencies are done, called with _mutex locked */
+    void queueTask(const TaskPtr& task);
+    void runTask(const TaskPtr& task);
+    /** runs the tasks queued while there are no workers */
+    void runQueuedTasks();
+
+    unsigned int _workerCount;
+    std::vector<std::thread*> _workers;
+    std::atomic<bool> _started;
+
+    std::mutex _mutex;
+    std::condition_variable _wakeCondition;
+    std::condition_variable _doneCondition;
+    std::condition_variable _taskDoneCondition;
+    bool _quit;
+
+    // tasks whose dependencies are done, sorted by priority. Under _mutex
+    std::deque<TaskPtr> _tasks;
+
+    // the current loop
+    std::mutex _loopMutex;
+    std::atomic<bool> _running;
+    std::atomic<unsigned int> _nextItem;
+    unsigned int _count;
+    unsigned int _grainSize;
+    const Job *_job;
+    unsigned int _generation;   // incremented for each loop, under _mutex
+    bool _loopActive;           // whether workers can still join the loop, under _mutex
+    unsigned int _loopWorkers;  // workers running jobs of the loop, under _mutex
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCJOBSYSTEM_H__
@@ -0,0 +1,259 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "CCNodeBuildQueue.h"
+#include "base_nodes/CCNode.h"
+#include "CCDirector.h"
+#include "CCScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <limits.h>
+
+NS_CC_BEGIN
+
+static NodeBuildQueue *s_sharedNodeBuildQueue = NULL;
+
+NodeBuildQueue* NodeBuildQueue::getInstance()
+{
+    if (!s_sharedNodeBuildQueue)
+    {
+        s_sharedNodeBuildQueue = new NodeBuildQueue();
+    }
+    return s_sharedNodeBuildQueue;
+}
+
+void NodeBuildQueue::destroyInstance()
+{
+    if (s_sharedNodeBuildQueue)
+    {
+        // the scheduler may still retain it
+        Director::getInstance()->getScheduler()->unscheduleUpdateForTarget(s_sharedNodeBuildQueue);
+        CC_SAFE_RELEASE_NULL(s_sharedNodeBuildQueue);
+    }
+}
+
+NodeBuildQueue::NodeBuildQueue()
+: _nextId(0)
+, _budget(0.004f)
+, _scheduled(false)
+{
+}
+
+NodeBuildQueue::~NodeBuildQueue()
+{
+    for (auto& entry : _entries)
+    {
+        clear(entry);
+    }
+    for (auto& entry : _running)
+    {
+        clear(entry);
+    }
+}
+
+void NodeBuildQueue::clear(Entry& entry)
+{
+    entry.work = nullptr;
+    CC_SAFE_RELEASE_NULL(entry.owner);
+}
+
+bool NodeBuildQueue::isOnScreen(Node* node)
+{
+    if (!node->isRunning())
+    {
+        return false;
+    }
+    for (Node* ancestor = node; ancestor != NULL; ancestor = ancestor->getParent())
+    {
+        if (!ancestor->isVisible())
+        {
+            return false;
+        }
+    }
+
+    // a node without size may only hold other nodes
+    const Size& size = node->getContentSize();
+    if (size.width == 0 && size.height == 0)
+    {
+        return true;
+    }
+
+    Director* director = Director::getInstance();
+    Rect screen(director->getVisibleOrigin().x, director->getVisibleOrigin().y,
+                director->getVisibleSize().width, director->getVisibleSize().height);
+    Rect box = RectApplyAffineTransform(Rect(0, 0, size.width, size.height), node->getNodeToWorldTransform());
+    return box.intersectsRect(screen);
+}
+
+unsigned int NodeBuildQueue::addWork(Node* owner, const Work& work, int priority)
+{
+    CCASSERT(work, "the work can't be empty");
+
+    if (! _scheduled)
+    {
+        Director::getInstance()->getScheduler()->scheduleUpdateForTarget(this, INT_MAX, false);
+        _scheduled = true;
+    }
+
+    CC_SAFE_RETAIN(owner);
+    Entry entry = { ++_nextId, owner, priority, false, work };
+    _entries.push_back(entry);
+    return entry.id;
+}
+
+bool NodeBuildQueue::cancelWork(unsigned int workId)
+{
+    for (auto list : { &_entries, &_running })
+    {
+        for (auto& entry : *list)
+        {
+            if (entry.id == workId)
+            {
+                bool pending = (bool)entry.work;
+                clear(entry);
+                return pending;
+            }
+        }
+    }
+    return false;
+}
+
+void NodeBuildQueue::cancelWorkForOwner(Node* owner)
+{
+    for (auto list : { &_entries, &_running })
+    {
+        for (auto& entry : *list)
+        {
+            if (entry.owner == owner)
+            {
+                clear(entry);
+            }
+        }
+    }
+}
+
+void NodeBuildQueue::finishWorkForOwner(Node* owner)
+{
+    // the work may queue more work, don't keep references to the entries while it runs
+    for (auto list : { &_running, &_entries })
+    {
+        for (unsigned int i = 0; i < list->size(); i++)
+        {
+            if ((*list)[i].owner == owner && (*list)[i].work)
+            {
+                Work work;
+                work.swap((*list)[i].work);
+                work();
+                clear((*list)[i]);
+            }
+        }
+    }
+}
+
+unsigned int NodeBuildQueue::getPendingCount() const
+{
+    unsigned int count = 0;
+    for (auto list : { &_entries, &_running })
+    {
+        for (auto& entry : *list)
+        {
+            if (entry.work)
+            {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+void NodeBuildQueue::update(float dt)
+{
+    CC_UNUSED_PARAM(dt);
+
+    // the work queued while the others run waits for the next frame
+    _running.swap(_entries);
+
+    // drop the cancelled work, and the work of the owners nobody else retains
+    unsigned int kept = 0;
+    for (auto& entry : _running)
+    {
+        if (entry.work && (!entry.owner || entry.owner->retainCount() > 1))
+        {
+            entry.onScreen = entry.owner && isOnScreen(entry.owner);
+            _running[kept++] = entry;
+        }
+        else
+        {
+            clear(entry);
+        }
+    }
+    _running.resize(kept);
+
+    // the order of addition is kept between the entries of the same rank
+    std::stable_sort(_running.begin(), _running.end(), [](const Entry& a, const Entry& b) {
+        if (a.onScreen != b.onScreen)
+        {
+            return a.onScreen;
+        }
+        return a.priority > b.priority;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int done = 0;
+    while (done < _running.size())
+    {
+        unsigned int index = done++;
+        if (_running[index].work)
+        {
+            Work work;
+            work.swap(_running[index].work);
+            work();
+        }
+        clear(_running[index]);
+
+        if (_budget > 0)
+        {
+            std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= _budget)
+            {
+                break;
+            }
+        }
+    }
+
+    // the remaining work keeps its place before the work queued meanwhile
+    _running.erase(_running.begin(), _running.begin() + done);
+    _running.insert(_running.end(), _entries.begin(), _entries.end());
+    _entries.swap(_running);
+    _running.clear();
+
+    if (_entries.empty())
+    {
+        Director::getInstance()->getScheduler()->unscheduleUpdateForTarget(this);
+        _scheduled = false;
+    }
+}
+
+NS_CC_END
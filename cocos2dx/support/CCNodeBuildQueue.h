@@ -0,0 +1,126 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __SUPPORT_CCNODEBUILDQUEUE_H__
+#define __SUPPORT_CCNODEBUILDQUEUE_H__
+
+#include "cocoa/CCObject.h"
+#include <functional>
+#include <vector>
+
+NS_CC_BEGIN
+
+class Node;
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief NodeBuildQueue spreads the construction of big node trees over several frames.
+
+The work added to the queue, usually a function creating a few nodes and adding them to a parent, is run by the
+Scheduler at the end of the next frames, until the time budget of the frame is spent. At least one work is run per
+frame, so the queue always progresses.
+
+The work of an owner shown on the screen runs before the work of the hidden or offscreen owners, then the work with
+the highest priority, then the work added first. The work of an owner removed from the scene and released by
+everybody else is dropped.
+
+@since v3.0
+*/
+class CC_DLL NodeBuildQueue : public Object
+{
+public:
+    typedef std::function<void()> Work;
+
+    /** Gets the single instance of NodeBuildQueue. */
+    static NodeBuildQueue* getInstance();
+
+    /** Destroys the single instance of NodeBuildQueue. The queued work is dropped. */
+    static void destroyInstance();
+
+    NodeBuildQueue();
+    virtual ~NodeBuildQueue();
+
+    /** Queues work to run in a later frame.
+     @param owner the node the work builds into, retained until the work runs. Can be NULL
+     @param priority the work with a higher priority runs first
+     @return an identifier to cancel the work
+     */
+    unsigned int addWork(Node* owner, const Work& work, int priority = 0);
+
+    /** Cancels a work that didn't run yet.
+     @return true if the work won't run
+     */
+    bool cancelWork(unsigned int workId);
+
+    /** Cancels the work of an owner that didn't run yet, for instance before removing it from the scene. */
+    void cancelWorkForOwner(Node* owner);
+
+    /** Runs now, regardless of the budget, the queued work of an owner. */
+    void finishWorkForOwner(Node* owner);
+
+    /** Time spent running work per frame, in milliseconds. 4 by default, 0 runs all the queued work at once. */
+    void setBudget(float milliseconds) { _budget = milliseconds / 1000.0f; }
+    float getBudget() const { return _budget * 1000.0f; }
+
+    /** Number of works waiting to run */
+    unsigned int getPendingCount() const;
+
+    /** runs the queued work until the budget of the frame is spent */
+    virtual void update(float dt) override;
+
+protected:
+    struct Entry
+    {
+        unsigned int id;
+        Node* owner;
+        int priority;
+        bool onScreen;
+        Work work;
+    };
+
+    /** whether the node and its ancestors are visible, and the node intersects the screen */
+    static bool isOnScreen(Node* node);
+    /** releases the owner of an entry and empties it, so it is dropped */
+    static void clear(Entry& entry);
+
+    // work waiting for the next frames, with the owners retained
+    std::vector<Entry> _entries;
+    // work being run this frame, sorted
+    std::vector<Entry> _running;
+    unsigned int _nextId;
+    // in seconds
+    float _budget;
+    bool _scheduled;
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCNODEBUILDQUEUE_H__
@@ -25,6 +25,10 @@ THE SOFTWARE.
 #include "CCNotificationCenter.h"
 #include "cocoa/CCArray.h"
 #include "script_support/CCScriptSupport.h"
+#include "CCDirector.h"
+#include "CCScheduler.h"
+#include <algorithm>
+#include <mutex>
 #include <string>
 
 using namespace std;
@@ -33,16 +37,39 @@ NS_CC_BEGIN
 
 static NotificationCenter *s_sharedNotifCenter = NULL;
 
+// interned notification names, shared by all the centers
+static std::mutex s_namesMutex;
+static std::unordered_map<std::string, NotificationID> s_notificationIDs;
+static std::vector<const std::string*> s_notificationNames;
+
 NotificationCenter::NotificationCenter()
-: _scriptHandler(0)
+: _pendingQueue(std::make_shared<PendingQueue>())
+, _scriptHandler(0)
 {
-    _observers = Array::createWithCapacity(3);
-    _observers->retain();
+    _pendingQueue->head = nullptr;
+    _pendingQueue->center = this;
 }
 
 NotificationCenter::~NotificationCenter()
 {
-    _observers->release();
+    // the notifications still pending are dropped, the functions already scheduled find no center
+    _pendingQueue->center = nullptr;
+    PendingNotification *pending = _pendingQueue->head.exchange(nullptr);
+    while (pending)
+    {
+        PendingNotification *next = pending->next;
+        CC_SAFE_RELEASE(pending->object);
+        delete pending;
+        pending = next;
+    }
+
+    for (auto& iter : _observers)
+    {
+        for (auto observer : iter.second)
+        {
+            observer->release();
+        }
+    }
 }
 
 NotificationCenter *NotificationCenter::getInstance()
@@ -71,24 +98,53 @@ void NotificationCenter::purgeNotificationCenter(void)
     NotificationCenter::destroyInstance();
 }
 
+NotificationID NotificationCenter::getNotificationID(const char *name)
+{
+    CCASSERT(name, "name should not be null");
+
+    std::lock_guard<std::mutex> lock(s_namesMutex);
+    auto iter = s_notificationIDs.find(name);
+    if (iter != s_notificationIDs.end())
+    {
+        return iter->second;
+    }
+
+    NotificationID id = static_cast<NotificationID>(s_notificationNames.size());
+    iter = s_notificationIDs.insert(std::make_pair(std::string(name), id)).first;
+    // the keys of the map don't move when it grows
+    s_notificationNames.push_back(&iter->first);
+    return id;
+}
+
+const std::string& NotificationCenter::getNotificationName(NotificationID id)
+{
+    std::lock_guard<std::mutex> lock(s_namesMutex);
+    CCASSERT(id < s_notificationNames.size(), "invalid notification ID");
+    return *s_notificationNames[id];
+}
+
 //
 // internal functions
 //
-bool NotificationCenter::observerExisted(Object *target,const char *name)
+bool NotificationCenter::observerExisted(Object *target, NotificationID id)
 {
-    Object* obj = NULL;
-    CCARRAY_FOREACH(_observers, obj)
+    auto iter = _observers.find(id);
+    if (iter == _observers.end())
+        return false;
+
+    for (auto observer : iter->second)
     {
-        NotificationObserver* observer = (NotificationObserver*) obj;
-        if (!observer)
-            continue;
-        
-        if (!strcmp(observer->getName(),name) && observer->getTarget() == target)
+        if (observer->getTarget() == target)
             return true;
     }
     return false;
 }
 
+void NotificationCenter::addObserver(NotificationObserver *observer)
+{
+    _observers[observer->getID()].push_back(observer);
+}
+
 //
 // observer functions
 //
@@ -97,29 +153,39 @@ void NotificationCenter::addObserver(Object *target,
                                        const char *name,
                                        Object *obj)
 {
-    if (this->observerExisted(target, name))
-        return;
-    
-    NotificationObserver *observer = new NotificationObserver(target, selector, name, obj);
-    if (!observer)
+    this->addObserver(target, selector, getNotificationID(name), obj);
+}
+
+void NotificationCenter::addObserver(Object *target,
+                                       SEL_CallFuncO selector,
+                                       NotificationID id,
+                                       Object *obj)
+{
+    if (this->observerExisted(target, id))
         return;
-    
-    observer->autorelease();
-    _observers->addObject(observer);
+
+    this->addObserver(new NotificationObserver(target, selector, id, obj));
 }
 
 void NotificationCenter::removeObserver(Object *target,const char *name)
 {
-    Object* obj = NULL;
-    CCARRAY_FOREACH(_observers, obj)
+    this->removeObserver(target, getNotificationID(name));
+}
+
+void NotificationCenter::removeObserver(Object *target, NotificationID id)
+{
+    auto iter = _observers.find(id);
+    if (iter == _observers.end())
+        return;
+
+    std::vector<NotificationObserver*>& observers = iter->second;
+    for (auto obsIter = observers.begin(); obsIter != observers.end(); ++obsIter)
     {
-        NotificationObserver* observer = static_cast<NotificationObserver*>(obj);
-        if (!observer)
-            continue;
-        
-        if (!strcmp(observer->getName(),name) && observer->getTarget() == target)
+        NotificationObserver *observer = *obsIter;
+        if (observer->getTarget() == target)
         {
-            _observers->removeObject(observer);
+            observers.erase(obsIter);
+            observer->release();
             return;
         }
     }
@@ -127,72 +193,76 @@ void NotificationCenter::removeObserver(Object *target,const char *name)
 
 int NotificationCenter::removeAllObservers(Object *target)
 {
-    Object *obj = NULL;
-    Array *toRemove = Array::create();
+    int removed = 0;
 
-    CCARRAY_FOREACH(_observers, obj)
+    for (auto& iter : _observers)
     {
-        NotificationObserver *observer = static_cast<NotificationObserver *>(obj);
-        if (!observer)
-            continue;
+        std::vector<NotificationObserver*>& observers = iter.second;
+        auto last = std::remove_if(observers.begin(), observers.end(), [&](NotificationObserver *observer) {
+            if (observer->getTarget() != target)
+                return false;
 
-        if (observer->getTarget() == target)
-        {
-            toRemove->addObject(observer);
-        }
+            observer->release();
+            ++removed;
+            return true;
+        });
+        observers.erase(last, observers.end());
     }
 
-    _observers->removeObjectsInArray(toRemove);
-    return toRemove->count();
+    return removed;
 }
 
 void NotificationCenter::registerScriptObserver( Object *target, int handler,const char* name)
 {
-    
-    if (this->observerExisted(target, name))
-        return;
-    
-    NotificationObserver *observer = new NotificationObserver(target, NULL, name, NULL);
-    if (!observer)
+    NotificationID id = getNotificationID(name);
+    if (this->observerExisted(target, id))
         return;
     
+    NotificationObserver *observer = new NotificationObserver(target, NULL, id, NULL);
     observer->setHandler(handler);
-    observer->autorelease();
-    _observers->addObject(observer);
+    this->addObserver(observer);
 }
 
 void NotificationCenter::unregisterScriptObserver(Object *target,const char* name)
 {        
-    Object* obj = NULL;
-    CCARRAY_FOREACH(_observers, obj)
-    {
-        NotificationObserver* observer = static_cast<NotificationObserver*>(obj);
-        if (!observer)
-            continue;
-            
-        if ( !strcmp(observer->getName(),name) && observer->getTarget() == target)
-        {
-            _observers->removeObject(observer);
-        }
-    }
+    auto iter = _observers.find(getNotificationID(name));
+    if (iter == _observers.end())
+        return;
+
+    std::vector<NotificationObserver*>& observers = iter->second;
+    auto last = std::remove_if(observers.begin(), observers.end(), [&](NotificationObserver *observer) {
+        if (observer->getTarget() != target)
+            return false;
+
+        observer->release();
+        return true;
+    });
+    observers.erase(last, observers.end());
 }
 
-void NotificationCenter::postNotification(const char *name, Object *object)
+void NotificationCenter::postNotification(NotificationID id, Object *object)
 {
-    Array* ObserversCopy = Array::createWithCapacity(_observers->count());
-    ObserversCopy->addObjectsFromArray(_observers);
-    Object* obj = NULL;
-    CCARRAY_FOREACH(ObserversCopy, obj)
+    auto iter = _observers.find(id);
+    if (iter == _observers.end() || iter->second.empty())
+        return;
+
+    // the observers can add or remove observers, and post notifications: call a retained copy of the list
+    const size_t begin = _postStack.size();
+    for (auto observer : iter->second)
     {
-        NotificationObserver* observer = static_cast<NotificationObserver*>(obj);
-        if (!observer)
-            continue;
-        
-        if (!strcmp(name,observer->getName()) && (observer->getObject() == object || observer->getObject() == NULL || object == NULL))
+        observer->retain();
+        _postStack.push_back(observer);
+    }
+    const size_t end = _postStack.size();
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        NotificationObserver* observer = _postStack[i];
+        if (observer->getObject() == object || observer->getObject() == NULL || object == NULL)
         {
             if (0 != observer->getHandler())
             {
-                BasicScriptData data(this, (void*)name);
+                BasicScriptData data(this, (void*)observer->getName());
                 ScriptEvent scriptEvent(kNotificationEvent,(void*)&data);
                 ScriptEngineManager::getInstance()->getScriptEngine()->sendEvent(&scriptEvent);
             }
@@ -202,6 +272,18 @@ void NotificationCenter::postNotification(const char *name, Object *object)
             }
         }
     }
+
+    // the nested posts have already popped their observers
+    for (size_t i = begin; i < end; ++i)
+    {
+        _postStack[i]->release();
+    }
+    _postStack.resize(begin);
+}
+
+void NotificationCenter::postNotification(const char *name, Object *object)
+{
+    this->postNotification(getNotificationID(name), object);
 }
 
 void NotificationCenter::postNotification(const char *name)
@@ -209,6 +291,55 @@ void NotificationCenter::postNotification(const char *name)
     this->postNotification(name,NULL);
 }
 
+void NotificationCenter::postNotificationFromThread(NotificationID id, Object *object)
+{
+    PendingNotification *pending = new PendingNotification();
+    pending->id = id;
+    pending->object = object;
+    pending->next = _pendingQueue->head.load(std::memory_order_relaxed);
+    while (!_pendingQueue->head.compare_exchange_weak(pending->next, pending,
+                                                      std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+
+    // the thread that makes the queue non-empty schedules its draining
+    if (pending->next == nullptr)
+    {
+        std::shared_ptr<PendingQueue> queue = _pendingQueue;
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([queue]() {
+            NotificationCenter::dispatchPendingNotifications(queue);
+        });
+    }
+}
+
+void NotificationCenter::dispatchPendingNotifications(const std::shared_ptr<PendingQueue>& queue)
+{
+    PendingNotification *pending = queue->head.exchange(nullptr, std::memory_order_acquire);
+
+    // the queue is a stack: reverse it to deliver in the posting order
+    PendingNotification *ordered = nullptr;
+    while (pending)
+    {
+        PendingNotification *next = pending->next;
+        pending->next = ordered;
+        ordered = pending;
+        pending = next;
+    }
+
+    while (ordered)
+    {
+        PendingNotification *next = ordered->next;
+        NotificationCenter *center = queue->center;
+        if (center)
+        {
+            center->postNotification(ordered->id, ordered->object);
+        }
+        CC_SAFE_RELEASE(ordered->object);
+        delete ordered;
+        ordered = next;
+    }
+}
+
 int NotificationCenter::getObserverHandlerByName(const char* name)
 {
     if (NULL == name || strlen(name) == 0)
@@ -216,21 +347,13 @@ int NotificationCenter::getObserverHandlerByName(const char* name)
         return 0;
     }
     
-    Object* obj = NULL;
-    CCARRAY_FOREACH(_observers, obj)
+    auto iter = _observers.find(getNotificationID(name));
+    if (iter == _observers.end() || iter->second.empty())
     {
-        NotificationObserver* observer = static_cast<NotificationObserver*>(obj);
-        if (NULL == observer)
-            continue;
-        
-        if ( 0 == strcmp(observer->getName(),name) )
-        {
-            return observer->getHandler();
-            break;
-        }
+        return 0;
     }
-    
-    return 0;
+
+    return iter->second.front()->getHandler();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -247,7 +370,20 @@ NotificationObserver::NotificationObserver(Object *target,
     _selector = selector;
     _object = obj;
     
-    _name = name;
+    _id = NotificationCenter::getNotificationID(name);
+    _handler = 0;
+}
+
+NotificationObserver::NotificationObserver(Object *target,
+                                               SEL_CallFuncO selector,
+                                               NotificationID id,
+                                               Object *obj)
+{
+    _target = target;
+    _selector = selector;
+    _object = obj;
+
+    _id = id;
     _handler = 0;
 }
 
@@ -280,7 +416,7 @@ SEL_CallFuncO NotificationObserver::getSelector() const
 
 const char* NotificationObserver::getName() const
 {
-    return _name.c_str();
+    return NotificationCenter::getNotificationName(_id).c_str();
 }
 
 Object* NotificationObserver::getObject() const
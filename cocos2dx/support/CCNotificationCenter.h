@@ -27,10 +27,22 @@ THE SOFTWARE.
 
 #include "cocoa/CCObject.h"
 #include "cocoa/CCArray.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 NS_CC_BEGIN
 
 class ScriptHandlerMgr;
+class NotificationObserver;
+
+/** Interned name of a notification, see NotificationCenter::getNotificationID().
+ @since v3.0
+ */
+typedef unsigned int NotificationID;
+
 class CC_DLL NotificationCenter : public Object
 {
     friend class ScriptHandlerMgr;
@@ -54,6 +66,18 @@ public:
     CC_DEPRECATED_ATTRIBUTE static void purgeNotificationCenter(void);
 
 
+    /** @brief Returns the interned ID of a notification name.
+     *  The same name always gets the same ID, for all the centers. Posting and observing by ID skips hashing the name.
+     *  @note Can be called from any thread.
+     *  @since v3.0
+     */
+    static NotificationID getNotificationID(const char *name);
+
+    /** @brief Returns the name of an ID returned by getNotificationID().
+     *  @since v3.0
+     */
+    static const std::string& getNotificationName(NotificationID id);
+
     /** @brief Adds an observer for the specified target.
      *  @param target The target which wants to observe notification events.
      *  @param selector The callback function which will be invoked when the specified notification event was posted.
@@ -65,11 +89,24 @@ public:
                      const char *name,
                      Object *obj);
 
+    /** @brief Adds an observer for the notification of an interned ID.
+     *  @since v3.0
+     */
+    void addObserver(Object *target,
+                     SEL_CallFuncO selector,
+                     NotificationID id,
+                     Object *obj);
+
     /** @brief Removes the observer by the specified target and name.
      *  @param target The target of this notification.
      *  @param name The name of this notification. 
      */
     void removeObserver(Object *target,const char *name);
+
+    /** @brief Removes the observer of a target for the notification of an interned ID.
+     *  @since v3.0
+     */
+    void removeObserver(Object *target, NotificationID id);
     
     /** @brief Removes all notifications registered by this target
      *  @param target The target of this notification.
@@ -96,6 +133,20 @@ public:
      *  @param object The extra parameter.
      */
     void postNotification(const char *name, Object *object);
+
+    /** @brief Posts the notification of an interned ID.
+     *  @since v3.0
+     */
+    void postNotification(NotificationID id, Object *object = NULL);
+
+    /** @brief Posts a notification from any thread. It is delivered on the cocos thread, at the next frame.
+     *  Posting doesn't lock the center: the notifications are pushed to a lock-free queue,
+     *  drained by a function run with Scheduler::performFunctionInCocosThread().
+     *  @param object Owned by the center: it is released on the cocos thread once the notification is delivered.
+     *  Pass an object created with new, and don't autorelease it on the posting thread.
+     *  @since v3.0
+     */
+    void postNotificationFromThread(NotificationID id, Object *object = NULL);
     
     /** @brief Gets script handler.
      *  @note Only supports Lua Binding now.
@@ -109,14 +160,39 @@ public:
      */
     int getObserverHandlerByName(const char* name);
 private:
+    // a notification posted by another thread
+    struct PendingNotification
+    {
+        NotificationID id;
+        Object *object;
+        PendingNotification *next;
+    };
+
+    // queue of the notifications posted by the other threads. Shared with the functions
+    // scheduled on the cocos thread, which can run after the center is destroyed
+    struct PendingQueue
+    {
+        std::atomic<PendingNotification*> head;
+        std::atomic<NotificationCenter*> center;
+    };
+
     // internal functions
 
     // Check whether the observer exists by the specified target and name.
-    bool observerExisted(Object *target,const char *name);
+    bool observerExisted(Object *target, NotificationID id);
+
+    void addObserver(NotificationObserver *observer);
+
+    // delivers the notifications posted by the other threads, in the order they were posted
+    static void dispatchPendingNotifications(const std::shared_ptr<PendingQueue>& queue);
     
     // variables
     //
-    Array *_observers;
+    // observers by notification ID, in the order they were added. Retained
+    std::unordered_map<NotificationID, std::vector<NotificationObserver*>> _observers;
+    // observers being notified by postNotification(), retained. Reentrant posts push after the outer ones
+    std::vector<NotificationObserver*> _postStack;
+    std::shared_ptr<PendingQueue> _pendingQueue;
     int     _scriptHandler;
 };
 
@@ -134,6 +210,14 @@ public:
                            const char *name,
                            Object *obj);
 
+    /** @brief NotificationObserver constructor for an interned notification ID
+     *  @since v3.0
+     */
+    NotificationObserver(Object *target,
+                           SEL_CallFuncO selector,
+                           NotificationID id,
+                           Object *obj);
+
     /** NotificationObserver destructor function */
     ~NotificationObserver();      
     
@@ -144,6 +228,8 @@ public:
     Object* getTarget() const;
     SEL_CallFuncO getSelector() const;
     const char* getName() const;
+    /** @since v3.0 */
+    NotificationID getID() const { return _id; }
     Object* getObject() const;
     int getHandler() const;
     void setHandler(int handler);
@@ -151,7 +237,7 @@ public:
 private:
     Object* _target;
     SEL_CallFuncO _selector;
-    std::string _name;
+    NotificationID _id;
     Object* _object;
     int _handler;
 };
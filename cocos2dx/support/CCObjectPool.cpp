@@ -0,0 +1,167 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCObjectPool.h"
+#include "base_nodes/CCNode.h"
+#include "actions/CCAction.h"
+#include "actions/CCActionManager.h"
+#include "CCDirector.h"
+#include "script_support/CCScriptSupport.h"
+#include <algorithm>
+
+NS_CC_BEGIN
+
+static ObjectPool *s_sharedObjectPool = NULL;
+
+ObjectPool* ObjectPool::getInstance()
+{
+    if (!s_sharedObjectPool)
+    {
+        s_sharedObjectPool = new ObjectPool();
+    }
+    return s_sharedObjectPool;
+}
+
+void ObjectPool::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedObjectPool);
+}
+
+ObjectPool::ObjectPool()
+{
+}
+
+ObjectPool::~ObjectPool()
+{
+    purgeAll();
+}
+
+bool ObjectPool::recycle(Object* object, const std::string& key)
+{
+    CCASSERT(object, "object can't be NULL");
+
+    Node* node = dynamic_cast<Node*>(object);
+    Action* action = node ? NULL : dynamic_cast<Action*>(object);
+    if (!node && !action)
+    {
+        CCLOG("cocos2d: ObjectPool: only the nodes and the actions can be recycled");
+        return false;
+    }
+
+    Bucket& bucket = _buckets[key];
+    if (bucket.objects.size() >= bucket.capacity)
+    {
+        return false;
+    }
+    CCASSERT(std::find(bucket.objects.begin(), bucket.objects.end(), object) == bucket.objects.end(),
+             "object already recycled");
+
+    // retained first, removing it from its parent or its action manager may release it for the last time
+    object->retain();
+    bucket.objects.push_back(object);
+
+    if (node)
+    {
+        node->removeFromParentAndCleanup(true);
+        node->resetForReuse();
+    }
+    else
+    {
+        // the target of a finished action may be deleted, the action manager only compares it
+        if (action->getOriginalTarget())
+        {
+            Director::getInstance()->getActionManager()->removeAction(action);
+        }
+        action->resetForReuse();
+    }
+
+    ScriptEngineProtocol* engine = ScriptEngineManager::getInstance()->getScriptEngine();
+    if (engine)
+    {
+        engine->removeScriptHandlersByObject(object);
+    }
+    return true;
+}
+
+Object* ObjectPool::obtain(const std::string& key)
+{
+    auto it = _buckets.find(key);
+    if (it == _buckets.end() || it->second.objects.empty())
+    {
+        return NULL;
+    }
+
+    Object* object = it->second.objects.back();
+    it->second.objects.pop_back();
+    object->autorelease();
+    return object;
+}
+
+void ObjectPool::setCapacity(const std::string& key, unsigned int capacity)
+{
+    Bucket& bucket = _buckets[key];
+    bucket.capacity = capacity;
+    shrink(bucket, capacity);
+}
+
+unsigned int ObjectPool::getCapacity(const std::string& key) const
+{
+    auto it = _buckets.find(key);
+    return it != _buckets.end() ? it->second.capacity : DEFAULT_CAPACITY;
+}
+
+unsigned int ObjectPool::getCount(const std::string& key) const
+{
+    auto it = _buckets.find(key);
+    return it != _buckets.end() ? (unsigned int)it->second.objects.size() : 0;
+}
+
+void ObjectPool::purge(const std::string& key)
+{
+    auto it = _buckets.find(key);
+    if (it != _buckets.end())
+    {
+        shrink(it->second, 0);
+    }
+}
+
+void ObjectPool::purgeAll()
+{
+    for (auto& bucket : _buckets)
+    {
+        shrink(bucket.second, 0);
+    }
+}
+
+void ObjectPool::shrink(Bucket& bucket, unsigned int capacity)
+{
+    while (bucket.objects.size() > capacity)
+    {
+        Object* object = bucket.objects.back();
+        bucket.objects.pop_back();
+        object->release();
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,110 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __SUPPORT_CCOBJECTPOOL_H__
+#define __SUPPORT_CCOBJECTPOOL_H__
+
+#include "cocoa/CCObject.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief ObjectPool keeps the nodes and actions that are not used anymore, to reuse them instead of creating new ones.
+
+A recycled node is removed from its parent and reset with Node::resetForReuse, a recycled action is stopped and reset
+with Action::resetForReuse. They are kept by key, usually the kind of object and its resource, like "bullet.png":
+the objects obtained with a key are the ones recycled with it, and the caller sets them up again.
+
+The pooled objects are retained, so they are never deleted while pooled and the script engines keep their proxies:
+obtaining one doesn't go through the creation of the object and of its script proxy. The script handlers registered
+on them are removed when they are recycled.
+
+@since v3.0
+*/
+class CC_DLL ObjectPool
+{
+public:
+    /** Gets the single instance of ObjectPool. */
+    static ObjectPool* getInstance();
+
+    /** Destroys the single instance of ObjectPool. The pooled objects are released. */
+    static void destroyInstance();
+
+    ObjectPool();
+    ~ObjectPool();
+
+    /** Resets a node or an action and keeps it to be obtained with the key.
+     @return false when the object isn't a node or an action, or when the pool of the key is full: the object is
+     left as is then
+     */
+    bool recycle(Object* object, const std::string& key);
+
+    /** Gets back an object recycled with the key, autoreleased like the objects returned by create().
+     @return NULL when the pool of the key is empty
+     */
+    Object* obtain(const std::string& key);
+
+    /** Maximum number of objects kept for a key, 64 by default. The objects over the capacity are released. */
+    void setCapacity(const std::string& key, unsigned int capacity);
+    unsigned int getCapacity(const std::string& key) const;
+
+    /** Number of objects kept for a key */
+    unsigned int getCount(const std::string& key) const;
+
+    /** Releases the objects kept for a key */
+    void purge(const std::string& key);
+
+    /** Releases all the pooled objects, on memory warnings for instance */
+    void purgeAll();
+
+protected:
+    struct Bucket
+    {
+        Bucket() : capacity(DEFAULT_CAPACITY) {}
+        std::vector<Object*> objects;
+        unsigned int capacity;
+    };
+
+    static const unsigned int DEFAULT_CAPACITY = 64;
+
+    /** releases the objects of a bucket over a capacity */
+    static void shrink(Bucket& bucket, unsigned int capacity);
+
+    std::unordered_map<std::string, Bucket> _buckets;
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCOBJECTPOOL_H__
@@ -0,0 +1,300 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCObjectTracker.h"
+#include "cocoa/CCObject.h"
+#include "ccMacros.h"
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <typeinfo>
+#include <unordered_map>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#include <stdlib.h>
+#endif
+
+#if defined(_MSC_VER)
+#define CC_TRACKER_THREAD_LOCAL __declspec(thread)
+#else
+#define CC_TRACKER_THREAD_LOCAL __thread
+#endif
+
+NS_CC_BEGIN
+
+static const char* NO_SITE = "(none)";
+
+namespace {
+
+struct ObjectRecord
+{
+    size_t size;
+    const char* site;
+};
+
+struct PeakStats
+{
+    unsigned int count;
+    size_t bytes;
+};
+
+struct TrackerState
+{
+    std::mutex mutex;
+    std::unordered_map<const Object*, ObjectRecord> objects;
+    size_t bytes;
+    unsigned int peakCount;
+    size_t peakBytes;
+    // demangled names and high-water marks of the classes, by the name of their type_info
+    std::unordered_map<const char*, std::string> classNames;
+    std::unordered_map<std::string, PeakStats> classPeaks;
+};
+
+} // namespace
+
+// the Objects can be created while the static variables are initialized, and deleted after they are destroyed:
+// the state is created the first time and kept until the end of the application
+static TrackerState& getState()
+{
+    static TrackerState* s_state = NULL;
+    if (!s_state)
+    {
+        s_state = new TrackerState();
+        s_state->bytes = 0;
+        s_state->peakCount = 0;
+        s_state->peakBytes = 0;
+    }
+    return *s_state;
+}
+
+// the allocation of the object being constructed by the thread
+static CC_TRACKER_THREAD_LOCAL const char* s_pendingAllocation = NULL;
+static CC_TRACKER_THREAD_LOCAL size_t s_pendingSize = 0;
+static CC_TRACKER_THREAD_LOCAL const char* s_currentSite = NULL;
+
+void* ObjectTracker::allocate(size_t size)
+{
+    void* ptr = ::operator new(size);
+    s_pendingAllocation = static_cast<const char*>(ptr);
+    s_pendingSize = size;
+    return ptr;
+}
+
+void ObjectTracker::deallocate(void* ptr)
+{
+    ::operator delete(ptr);
+}
+
+void ObjectTracker::addObject(const Object* object)
+{
+    // the constructor of Object runs right after the allocation, before the members of the class are constructed.
+    // The Object is not at the beginning of the allocation when it isn't the first base class.
+    const char* address = reinterpret_cast<const char*>(object);
+    ObjectRecord record = { 0, s_currentSite ? s_currentSite : NO_SITE };
+    if (s_pendingAllocation && address >= s_pendingAllocation && address < s_pendingAllocation + s_pendingSize)
+    {
+        record.size = s_pendingSize;
+    }
+    s_pendingAllocation = NULL;
+
+    TrackerState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.objects[object] = record;
+    state.bytes += record.size;
+    state.peakCount = std::max(state.peakCount, (unsigned int)state.objects.size());
+    state.peakBytes = std::max(state.peakBytes, state.bytes);
+}
+
+void ObjectTracker::removeObject(const Object* object)
+{
+    TrackerState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto it = state.objects.find(object);
+    if (it != state.objects.end())
+    {
+        state.bytes -= it->second.size;
+        state.objects.erase(it);
+    }
+}
+
+unsigned int ObjectTracker::getObjectCount()
+{
+    TrackerState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return (unsigned int)state.objects.size();
+}
+
+size_t ObjectTracker::getObjectBytes()
+{
+    TrackerState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.bytes;
+}
+
+unsigned int ObjectTracker::getPeakObjectCount()
+{
+    TrackerState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.peakCount;
+}
+
+size_t ObjectTracker::getPeakObjectBytes()
+{
+    TrackerState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.peakBytes;
+}
+
+static const std::string& getClassName(TrackerState& state, const std::type_info& type)
+{
+    auto it = state.classNames.find(type.name());
+    if (it != state.classNames.end())
+    {
+        return it->second;
+    }
+
+    std::string name = type.name();
+#if defined(__GNUC__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+    if (demangled)
+    {
+        if (status == 0)
+        {
+            name = demangled;
+        }
+        free(demangled);
+    }
+#endif
+    return state.classNames[type.name()] = name;
+}
+
+std::vector<ObjectTracker::ClassStats> ObjectTracker::getClassStats()
+{
+    TrackerState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    // the Objects deleted by another thread wait for the lock in the destructor of Object: they are still valid
+    std::unordered_map<const std::string*, ClassStats> classes;
+    for (const auto& object : state.objects)
+    {
+        const std::string& name = getClassName(state, typeid(*object.first));
+        ClassStats& stats = classes[&name];
+        ++stats.count;
+        stats.bytes += object.second.size;
+    }
+
+    std::vector<ClassStats> result;
+    result.reserve(classes.size());
+    for (auto& entry : classes)
+    {
+        ClassStats& stats = entry.second;
+        stats.name = *entry.first;
+        PeakStats& peak = state.classPeaks[stats.name];
+        peak.count = std::max(peak.count, stats.count);
+        peak.bytes = std::max(peak.bytes, stats.bytes);
+        stats.peakCount = peak.count;
+        stats.peakBytes = peak.bytes;
+        result.push_back(stats);
+    }
+
+    std::sort(result.begin(), result.end(), [](const ClassStats& a, const ClassStats& b) {
+        return a.bytes != b.bytes ? a.bytes > b.bytes : a.count > b.count;
+    });
+    return result;
+}
+
+std::vector<ObjectTracker::SiteStats> ObjectTracker::getSiteStats()
+{
+    TrackerState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    std::unordered_map<const char*, SiteStats> sites;
+    for (const auto& object : state.objects)
+    {
+        SiteStats& stats = sites[object.second.site];
+        stats.name = object.second.site;
+        ++stats.count;
+        stats.bytes += object.second.size;
+    }
+
+    std::vector<SiteStats> result;
+    result.reserve(sites.size());
+    for (const auto& entry : sites)
+    {
+        result.push_back(entry.second);
+    }
+
+    std::sort(result.begin(), result.end(), [](const SiteStats& a, const SiteStats& b) {
+        return a.bytes != b.bytes ? a.bytes > b.bytes : a.count > b.count;
+    });
+    return result;
+}
+
+void ObjectTracker::dump(unsigned int maxLines)
+{
+    std::vector<ClassStats> classes = getClassStats();
+    std::vector<SiteStats> sites = getSiteStats();
+
+    log("ObjectTracker: %u objects, %.1f KB (peak %u objects, %.1f KB)",
+        getObjectCount(), getObjectBytes() / 1024.0, getPeakObjectCount(), getPeakObjectBytes() / 1024.0);
+
+    log("ObjectTracker: classes");
+    for (size_t i = 0; i < classes.size() && (maxLines == 0 || i < maxLines); ++i)
+    {
+        const ClassStats& stats = classes[i];
+        log("%s: %u objects, %.1f KB (peak %u objects, %.1f KB)",
+            stats.name.c_str(), stats.count, stats.bytes / 1024.0, stats.peakCount, stats.peakBytes / 1024.0);
+    }
+
+    log("ObjectTracker: allocation sites");
+    for (size_t i = 0; i < sites.size() && (maxLines == 0 || i < maxLines); ++i)
+    {
+        const SiteStats& stats = sites[i];
+        log("%s: %u objects, %.1f KB", stats.name, stats.count, stats.bytes / 1024.0);
+    }
+}
+
+void ObjectTracker::resetPeaks()
+{
+    TrackerState& state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.peakCount = (unsigned int)state.objects.size();
+    state.peakBytes = state.bytes;
+    state.classPeaks.clear();
+}
+
+ObjectTracker::SiteScope::SiteScope(const char* name)
+: _previous(s_currentSite)
+{
+    s_currentSite = name;
+}
+
+ObjectTracker::SiteScope::~SiteScope()
+{
+    s_currentSite = _previous;
+}
+
+NS_CC_END
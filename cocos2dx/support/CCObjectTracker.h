@@ -0,0 +1,144 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __SUPPORT_CCOBJECTTRACKER_H__
+#define __SUPPORT_CCOBJECTTRACKER_H__
+
+#include "ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+NS_CC_BEGIN
+
+class Object;
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief ObjectTracker counts the living Objects by class and by allocation site, when CC_ENABLE_OBJECT_TRACKING
+ is enabled.
+
+ The size of an Object is the size of its class when it was allocated with new, and 0 when it lives in another
+ object, on the stack or in a static variable. The memory the objects own besides (the pixels of the textures,
+ the buffers of the strings and of the arrays) isn't counted.
+ The class of an object is read when the statistics are computed, with typeid.
+
+ The allocation site of an object is the name given to the innermost CC_TRACK_OBJECT_SITE() scope of the thread
+ creating it, or "(none)":
+
+     {
+         CC_TRACK_OBJECT_SITE("Level - load");
+         // the Objects created here are counted in "Level - load"
+     }
+
+ The functions are thread safe.
+
+ @since v3.0
+ */
+class CC_DLL ObjectTracker
+{
+public:
+    struct ClassStats
+    {
+        /** name of the class, demangled when the compiler allows it */
+        std::string name;
+        unsigned int count;
+        size_t bytes;
+        /** highest count and bytes seen by getClassStats() since the last reset */
+        unsigned int peakCount;
+        size_t peakBytes;
+    };
+
+    struct SiteStats
+    {
+        const char* name;
+        unsigned int count;
+        size_t bytes;
+    };
+
+    /** Number of living Objects, and their bytes */
+    static unsigned int getObjectCount();
+    static size_t getObjectBytes();
+
+    /** Highest number of living Objects, and of their bytes, since the last reset */
+    static unsigned int getPeakObjectCount();
+    static size_t getPeakObjectBytes();
+
+    /** Statistics of the living Objects per class, the biggest first. Goes through all the Objects. */
+    static std::vector<ClassStats> getClassStats();
+
+    /** Statistics of the living Objects per allocation site, the biggest first */
+    static std::vector<SiteStats> getSiteStats();
+
+    /** Logs the totals, and the classes and the sites, the biggest first.
+     @param maxLines maximum number of classes and of sites logged, 0 for all
+     */
+    static void dump(unsigned int maxLines = 0);
+
+    /** Sets the high-water marks to the current values */
+    static void resetPeaks();
+
+    /** Allocation functions of Object */
+    static void* allocate(size_t size);
+    static void deallocate(void* ptr);
+
+    /** Registers an Object, called by its constructor */
+    static void addObject(const Object* object);
+    /** Unregisters an Object, called by its destructor */
+    static void removeObject(const Object* object);
+
+    /** Sets the allocation site of the Objects created by the thread for the lifetime of the object */
+    class SiteScope
+    {
+    public:
+        explicit SiteScope(const char* name);
+        ~SiteScope();
+
+    private:
+        const char* _previous;
+    };
+};
+
+#if CC_ENABLE_OBJECT_TRACKING
+
+/** Sets the allocation site of the Objects created in the rest of the enclosing scope. The name must be a string literal. */
+#define CC_TRACK_OBJECT_SITE(__name__) \
+    cocos2d::ObjectTracker::SiteScope __ccObjectSite(__name__)
+
+#else
+
+#define CC_TRACK_OBJECT_SITE(__name__) do {} while (0)
+
+#endif // CC_ENABLE_OBJECT_TRACKING
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCOBJECTTRACKER_H__
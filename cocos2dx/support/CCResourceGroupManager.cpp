@@ -0,0 +1,439 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "CCResourceGroupManager.h"
+#include "cocoa/CCArray.h"
+#include "cocoa/CCDictionary.h"
+#include "cocoa/CCString.h"
+#include "textures/CCTextureCache.h"
+#include "sprite_nodes/CCSpriteFrameCache.h"
+#include "label_nodes/CCLabelBMFont.h"
+#include <algorithm>
+#include <string.h>
+
+NS_CC_BEGIN
+
+static ResourceGroupManager *s_sharedResourceGroupManager = NULL;
+
+ResourceGroupManager* ResourceGroupManager::getInstance()
+{
+    if (!s_sharedResourceGroupManager)
+    {
+        s_sharedResourceGroupManager = new ResourceGroupManager();
+    }
+    return s_sharedResourceGroupManager;
+}
+
+void ResourceGroupManager::destroyInstance()
+{
+    CC_SAFE_RELEASE_NULL(s_sharedResourceGroupManager);
+}
+
+ResourceGroupManager::ResourceGroupManager()
+: _nextRequestId(0)
+{
+    auto loadTexture = [](const std::string& path, const DoneCallback& done) {
+        TextureCache::getInstance()->addImageAsync(path.c_str(), [done](Texture2D* texture) {
+            done(texture != nullptr);
+        });
+    };
+
+    registerResourceType("textures", loadTexture, [](const std::string& path) {
+        TextureCache::getInstance()->removeTextureForKey(path.c_str());
+    });
+
+    registerResourceType("spriteFrames", [](const std::string& path, const DoneCallback& done) {
+        SpriteFrameCache::getInstance()->addSpriteFramesWithFileAsync(path.c_str(), done);
+    }, [](const std::string& path) {
+        SpriteFrameCache::getInstance()->removeSpriteFramesFromFile(path.c_str());
+    });
+
+    // the FNT file is small and parsed now, its atlas is loaded asynchronously
+    registerResourceType("bmFonts", [loadTexture](const std::string& path, const DoneCallback& done) {
+        CCBMFontConfiguration* configuration = FNTConfigLoadFile(path.c_str());
+        if (configuration == nullptr)
+        {
+            done(false);
+            return;
+        }
+        loadTexture(configuration->getAtlasName(), done);
+    }, [](const std::string& path) {
+        CCBMFontConfiguration* configuration = FNTConfigLoadFile(path.c_str());
+        if (configuration != nullptr)
+        {
+            std::string atlasName = configuration->getAtlasName();
+            FNTConfigRemoveFile(path.c_str());
+            TextureCache::getInstance()->removeTextureForKey(atlasName.c_str());
+        }
+    });
+}
+
+ResourceGroupManager::~ResourceGroupManager()
+{
+}
+
+void ResourceGroupManager::registerResourceType(const std::string& type, const LoadFunction& load, const UnloadFunction& unload)
+{
+    ResourceType& resourceType = _types[type];
+    resourceType.load = load;
+    resourceType.unload = unload;
+}
+
+void ResourceGroupManager::addGroup(const std::string& name, const Resources& resources, const std::vector<std::string>& dependencies)
+{
+    Group& group = _groups[name];
+    CCASSERT(group.refCount == 0, "ResourceGroupManager: a loaded group can't be replaced");
+    group.resources = resources;
+    group.dependencies = dependencies;
+}
+
+bool ResourceGroupManager::addGroupsWithFile(const char* manifest)
+{
+    Dictionary* root = Dictionary::createWithContentsOfFile(manifest);
+    if (root == nullptr)
+    {
+        CCLOG("cocos2d: ResourceGroupManager: can't read the manifest %s", manifest);
+        return false;
+    }
+
+    DictElement* groupElement = nullptr;
+    CCDICT_FOREACH(root, groupElement)
+    {
+        Dictionary* groupDict = dynamic_cast<Dictionary*>(groupElement->getObject());
+        if (groupDict == nullptr)
+        {
+            continue;
+        }
+
+        Resources resources;
+        std::vector<std::string> dependencies;
+
+        DictElement* typeElement = nullptr;
+        CCDICT_FOREACH(groupDict, typeElement)
+        {
+            Array* paths = dynamic_cast<Array*>(typeElement->getObject());
+            std::vector<std::string>& names = strcmp(typeElement->getStrKey(), "dependencies") == 0
+                                            ? dependencies : resources[typeElement->getStrKey()];
+
+            Object* object = nullptr;
+            CCARRAY_FOREACH(paths, object)
+            {
+                String* path = dynamic_cast<String*>(object);
+                if (path)
+                {
+                    names.push_back(path->getCString());
+                }
+            }
+        }
+
+        addGroup(groupElement->getStrKey(), resources, dependencies);
+    }
+
+    return true;
+}
+
+bool ResourceGroupManager::hasGroup(const std::string& name) const
+{
+    return _groups.find(name) != _groups.end();
+}
+
+bool ResourceGroupManager::collectGroups(const std::string& name, std::vector<std::string>& closure) const
+{
+    // the groups already collected also stop the cycles
+    if (std::find(closure.begin(), closure.end(), name) != closure.end())
+    {
+        return true;
+    }
+
+    auto it = _groups.find(name);
+    if (it == _groups.end())
+    {
+        CCLOG("cocos2d: ResourceGroupManager: unknown group %s", name.c_str());
+        return false;
+    }
+
+    closure.push_back(name);
+    bool found = true;
+    for (const auto& dependency : it->second.dependencies)
+    {
+        found = collectGroups(dependency, closure) && found;
+    }
+    return found;
+}
+
+std::string ResourceGroupManager::keyForResource(const std::string& type, const std::string& path)
+{
+    return type + ":" + path;
+}
+
+void ResourceGroupManager::retainResources(const Group& group)
+{
+    for (const auto& typePaths : group.resources)
+    {
+        for (const auto& path : typePaths.second)
+        {
+            Resource& resource = _resources[keyForResource(typePaths.first, path)];
+            if (resource.type.empty())
+            {
+                resource.type = typePaths.first;
+                resource.path = path;
+                resource.refCount = 0;
+                resource.state = State::UNLOADED;
+            }
+            ++resource.refCount;
+        }
+    }
+}
+
+void ResourceGroupManager::releaseResources(const Group& group)
+{
+    for (const auto& typePaths : group.resources)
+    {
+        for (const auto& path : typePaths.second)
+        {
+            auto it = _resources.find(keyForResource(typePaths.first, path));
+            if (it == _resources.end() || it->second.refCount == 0)
+            {
+                continue;
+            }
+
+            Resource& resource = it->second;
+            if (--resource.refCount == 0 && resource.state == State::LOADED)
+            {
+                unloadResource(resource);
+            }
+        }
+    }
+}
+
+void ResourceGroupManager::unloadResource(Resource& resource)
+{
+    resource.state = State::UNLOADED;
+
+    auto it = _types.find(resource.type);
+    if (it != _types.end() && it->second.unload)
+    {
+        it->second.unload(resource.path);
+    }
+}
+
+void ResourceGroupManager::loadGroup(const std::string& name, const ProgressCallback& progress, const DoneCallback& callback)
+{
+    std::vector<std::string> closure;
+    bool found = collectGroups(name, closure);
+
+    // the resources of the closure, once each
+    std::vector<std::string> keys;
+    for (const auto& groupName : closure)
+    {
+        Group& group = _groups[groupName];
+        if (group.refCount++ == 0)
+        {
+            retainResources(group);
+        }
+
+        for (const auto& typePaths : group.resources)
+        {
+            for (const auto& path : typePaths.second)
+            {
+                keys.push_back(keyForResource(typePaths.first, path));
+            }
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    if (keys.empty())
+    {
+        if (progress)
+        {
+            progress(1.0f);
+        }
+        if (callback)
+        {
+            callback(found);
+        }
+        return;
+    }
+
+    // the request is registered first, since the loaders may call back immediately
+    unsigned int requestId = ++_nextRequestId;
+    Request& request = _requests[requestId];
+    request.progress = progress;
+    request.callback = callback;
+    request.total = (unsigned int)keys.size();
+    request.done = 0;
+    request.succeeded = found;
+
+    for (const auto& key : keys)
+    {
+        auto it = _resources.find(key);
+        CCASSERT(it != _resources.end(), "ResourceGroupManager: the resource should have been retained");
+        Resource& resource = it->second;
+
+        if (resource.state == State::LOADED)
+        {
+            onRequestProgress(requestId, true);
+            continue;
+        }
+
+        resource.requests.push_back(requestId);
+        if (resource.state == State::LOADING)
+        {
+            continue;
+        }
+
+        auto type = _types.find(resource.type);
+        if (type == _types.end() || !type->second.load)
+        {
+            CCLOG("cocos2d: ResourceGroupManager: no loader for the type %s", resource.type.c_str());
+            onResourceLoaded(key, false);
+            continue;
+        }
+
+        resource.state = State::LOADING;
+        ResourceGroupManager* manager = this;
+        type->second.load(resource.path, [manager, key](bool succeeded) {
+            // the manager may have been destroyed while the resource was loading
+            if (s_sharedResourceGroupManager == manager)
+            {
+                manager->onResourceLoaded(key, succeeded);
+            }
+        });
+    }
+}
+
+void ResourceGroupManager::onResourceLoaded(const std::string& key, bool succeeded)
+{
+    auto it = _resources.find(key);
+    if (it == _resources.end())
+    {
+        return;
+    }
+
+    Resource& resource = it->second;
+    resource.state = succeeded ? State::LOADED : State::UNLOADED;
+    std::vector<unsigned int> requests;
+    requests.swap(resource.requests);
+
+    // the groups that needed it were unloaded while it was loading
+    if (succeeded && resource.refCount == 0)
+    {
+        unloadResource(resource);
+    }
+
+    for (auto requestId : requests)
+    {
+        onRequestProgress(requestId, succeeded);
+    }
+}
+
+void ResourceGroupManager::onRequestProgress(unsigned int requestId, bool succeeded)
+{
+    auto it = _requests.find(requestId);
+    if (it == _requests.end())
+    {
+        return;
+    }
+
+    Request& request = it->second;
+    ++request.done;
+    request.succeeded = request.succeeded && succeeded;
+
+    ProgressCallback progress = request.progress;
+    float fraction = (float)request.done / request.total;
+    DoneCallback callback;
+    bool finished = request.done == request.total;
+    if (finished)
+    {
+        callback = request.callback;
+        succeeded = request.succeeded;
+        _requests.erase(it);
+    }
+
+    // the callbacks may load or unload groups
+    if (progress)
+    {
+        progress(fraction);
+    }
+    if (finished && callback)
+    {
+        callback(succeeded);
+    }
+}
+
+void ResourceGroupManager::unloadGroup(const std::string& name)
+{
+    std::vector<std::string> closure;
+    collectGroups(name, closure);
+
+    for (const auto& groupName : closure)
+    {
+        Group& group = _groups[groupName];
+        if (group.refCount == 0)
+        {
+            CCLOG("cocos2d: ResourceGroupManager: the group %s isn't loaded", groupName.c_str());
+            continue;
+        }
+
+        if (--group.refCount == 0)
+        {
+            releaseResources(group);
+        }
+    }
+}
+
+bool ResourceGroupManager::isGroupLoaded(const std::string& name) const
+{
+    std::vector<std::string> closure;
+    if (!collectGroups(name, closure))
+    {
+        return false;
+    }
+
+    for (const auto& groupName : closure)
+    {
+        const Group& group = _groups.find(groupName)->second;
+        if (group.refCount == 0)
+        {
+            return false;
+        }
+
+        for (const auto& typePaths : group.resources)
+        {
+            for (const auto& path : typePaths.second)
+            {
+                auto it = _resources.find(keyForResource(typePaths.first, path));
+                if (it == _resources.end() || it->second.state != State::LOADED)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+NS_CC_END
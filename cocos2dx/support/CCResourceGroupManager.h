@@ -0,0 +1,176 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __SUPPORT_CCRESOURCEGROUPMANAGER_H__
+#define __SUPPORT_CCRESOURCEGROUPMANAGER_H__
+
+#include "cocoa/CCObject.h"
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief ResourceGroupManager preloads and unloads named groups of resources, like the assets of a level.
+
+A group lists its resources by type, and the groups it depends on. Loading a group loads the groups it depends on,
+and each resource of the whole set once, asynchronously when the loader of the type allows it. Groups and resources
+are reference counted: a resource shared by several loaded groups is unloaded with the last of them, and every
+loadGroup() must be balanced by an unloadGroup().
+
+The "textures", "spriteFrames" and "bmFonts" types are registered by default. The texture of a sprite frames plist
+is not unloaded with the frames, so list it under "textures" too. The other types, like sounds or armatures, are
+registered by the game or the extensions:
+@code
+manager->registerResourceType("effects",
+    [](const std::string& path, const ResourceGroupManager::DoneCallback& done) {
+        SimpleAudioEngine::getInstance()->preloadEffect(path.c_str());
+        done(true);
+    },
+    [](const std::string& path) { SimpleAudioEngine::getInstance()->unloadEffect(path.c_str()); });
+@endcode
+
+@since v3.0
+*/
+class CC_DLL ResourceGroupManager : public Object
+{
+public:
+    typedef std::function<void(bool)> DoneCallback;
+    typedef std::function<void(float)> ProgressCallback;
+    /** loads a resource and calls done with whether it succeeded, immediately or later in the main thread */
+    typedef std::function<void(const std::string& path, const DoneCallback& done)> LoadFunction;
+    typedef std::function<void(const std::string& path)> UnloadFunction;
+    /** paths of resources, by type */
+    typedef std::map<std::string, std::vector<std::string>> Resources;
+
+    /** Gets the single instance of ResourceGroupManager. */
+    static ResourceGroupManager* getInstance();
+
+    /** Destroys the single instance of ResourceGroupManager. The loaded resources stay in their caches. */
+    static void destroyInstance();
+
+    ResourceGroupManager();
+    virtual ~ResourceGroupManager();
+
+    /** Registers, or replaces, how to load and unload a type of resource. */
+    void registerResourceType(const std::string& type, const LoadFunction& load, const UnloadFunction& unload);
+
+    /** Adds, or replaces, a group.
+     @param resources the paths of the resources, by type
+     @param dependencies the groups loaded with this one
+     */
+    void addGroup(const std::string& name, const Resources& resources, const std::vector<std::string>& dependencies = std::vector<std::string>());
+
+    /** Adds the groups of a plist manifest. The root dictionary maps the name of each group to a dictionary holding
+     an array of paths per type, and the optional "dependencies" array of group names.
+     @return false if the manifest couldn't be read
+     */
+    bool addGroupsWithFile(const char* manifest);
+
+    bool hasGroup(const std::string& name) const;
+
+    /** Loads a group and its dependencies.
+     @param progress called with the loaded fraction, from 0 to 1, after each resource. Can be nullptr
+     @param callback called once everything is loaded, with false if a resource or a group is missing. Can be nullptr
+     */
+    void loadGroup(const std::string& name, const ProgressCallback& progress, const DoneCallback& callback);
+
+    /** Releases a group and its dependencies. The resources no loaded group uses anymore are unloaded, when their
+     load completes for the ones still loading.
+     */
+    void unloadGroup(const std::string& name);
+
+    /** Whether the group was loaded and all its resources, and the ones of its dependencies, are ready. */
+    bool isGroupLoaded(const std::string& name) const;
+
+protected:
+    enum class State
+    {
+        UNLOADED,
+        LOADING,
+        LOADED,
+    };
+
+    struct Group
+    {
+        Resources resources;
+        std::vector<std::string> dependencies;
+        unsigned int refCount;
+    };
+
+    struct Resource
+    {
+        std::string type;
+        std::string path;
+        unsigned int refCount;
+        State state;
+        // the loadGroup() requests waiting for the resource
+        std::vector<unsigned int> requests;
+    };
+
+    struct Request
+    {
+        ProgressCallback progress;
+        DoneCallback callback;
+        unsigned int total;
+        unsigned int done;
+        bool succeeded;
+    };
+
+    struct ResourceType
+    {
+        LoadFunction load;
+        UnloadFunction unload;
+    };
+
+    /** appends the names of the group and of its dependencies, once each, to the closure. Returns false if a group is missing */
+    bool collectGroups(const std::string& name, std::vector<std::string>& closure) const;
+    /** "type:path", the key of a resource */
+    static std::string keyForResource(const std::string& type, const std::string& path);
+    void retainResources(const Group& group);
+    void releaseResources(const Group& group);
+    void unloadResource(Resource& resource);
+    void onResourceLoaded(const std::string& key, bool succeeded);
+    void onRequestProgress(unsigned int requestId, bool succeeded);
+
+    std::unordered_map<std::string, ResourceType> _types;
+    std::unordered_map<std::string, Group> _groups;
+    std::unordered_map<std::string, Resource> _resources;
+    std::unordered_map<unsigned int, Request> _requests;
+    unsigned int _nextRequestId;
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCRESOURCEGROUPMANAGER_H__
@@ -0,0 +1,116 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCSkeletonEvaluator.h"
+#include "base_nodes/CCNode.h"
+#include "CCDirector.h"
+#include "CCScheduler.h"
+#include "support/CCJobSystem.h"
+#include <limits.h>
+
+NS_CC_BEGIN
+
+static SkeletonEvaluator *s_sharedSkeletonEvaluator = NULL;
+
+SkeletonEvaluator* SkeletonEvaluator::getInstance()
+{
+    if (!s_sharedSkeletonEvaluator)
+    {
+        s_sharedSkeletonEvaluator = new SkeletonEvaluator();
+    }
+    return s_sharedSkeletonEvaluator;
+}
+
+void SkeletonEvaluator::destroyInstance()
+{
+    if (s_sharedSkeletonEvaluator)
+    {
+        // the scheduler may still retain it
+        Director::getInstance()->getScheduler()->unscheduleUpdateForTarget(s_sharedSkeletonEvaluator);
+        s_sharedSkeletonEvaluator->clear(s_sharedSkeletonEvaluator->_skeletons);
+        CC_SAFE_RELEASE_NULL(s_sharedSkeletonEvaluator);
+    }
+}
+
+SkeletonEvaluator::SkeletonEvaluator()
+: _scheduled(false)
+{
+}
+
+SkeletonEvaluator::~SkeletonEvaluator()
+{
+    clear(_skeletons);
+}
+
+void SkeletonEvaluator::clear(std::vector<Entry>& entries)
+{
+    for (auto& entry : entries)
+    {
+        entry.node->release();
+    }
+    entries.clear();
+}
+
+void SkeletonEvaluator::addSkeleton(Node* node, Target* target)
+{
+    if (! _scheduled)
+    {
+        Director::getInstance()->getScheduler()->scheduleUpdateForTarget(this, INT_MAX, false);
+        _scheduled = true;
+    }
+
+    // retained until its pose is evaluated: an update selector may remove it
+    node->retain();
+    Entry entry = { node, target };
+    _skeletons.push_back(entry);
+}
+
+void SkeletonEvaluator::update(float dt)
+{
+    CC_UNUSED_PARAM(dt);
+
+    if (_skeletons.empty())
+    {
+        return;
+    }
+
+    // the skeletons added while the others finish are evaluated next frame
+    _evaluatedSkeletons.swap(_skeletons);
+
+    std::vector<Entry>& entries = _evaluatedSkeletons;
+    JobSystem::getInstance()->parallelFor(entries.size(), 1, [&entries](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            entries[i].target->evaluatePose();
+        }
+    });
+
+    for (auto& entry : entries)
+    {
+        entry.target->finishPoseEvaluation();
+    }
+    clear(entries);
+}
+
+NS_CC_END
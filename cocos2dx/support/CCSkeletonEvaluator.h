@@ -0,0 +1,109 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __SUPPORT_CCSKELETONEVALUATOR_H__
+#define __SUPPORT_CCSKELETONEVALUATOR_H__
+
+#include "cocoa/CCObject.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+class Node;
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief SkeletonEvaluator evaluates the poses of animated skeletons in parallel.
+
+The skeletons evaluated in parallel, like the spine skeletons and the armatures of the extensions, advance their
+animations in update(), then add themselves to the evaluator. Once all the update selectors were called, the evaluator
+computes the poses of the skeletons on the threads of the JobSystem, then finishes them in one pass on the main thread,
+before the scene is drawn.
+
+The evaluator is scheduled with the highest priority, so it runs after the other update selectors.
+
+@since v3.0
+*/
+class CC_DLL SkeletonEvaluator : public Object
+{
+public:
+    /** A skeleton whose pose can be evaluated by the SkeletonEvaluator */
+    class CC_DLL Target
+    {
+    public:
+        virtual ~Target() {}
+
+        /** Computes the pose of the skeleton, on a thread of the JobSystem.
+         It must only modify the state of the skeleton: it can't use the Scheduler, other nodes or OpenGL,
+         nor create, retain, release or autorelease objects.
+         */
+        virtual void evaluatePose() = 0;
+
+        /** Called on the main thread once the poses of all the skeletons added this frame are evaluated */
+        virtual void finishPoseEvaluation() {}
+    };
+
+    /** Gets the single instance of SkeletonEvaluator. */
+    static SkeletonEvaluator* getInstance();
+
+    /** Destroys the single instance of SkeletonEvaluator. The skeletons waiting for their evaluation are dropped. */
+    static void destroyInstance();
+
+    SkeletonEvaluator();
+    virtual ~SkeletonEvaluator();
+
+    /** Adds a skeleton to evaluate this frame.
+     @param node the node of the skeleton, retained until the pose is evaluated. Usually the target itself
+     */
+    void addSkeleton(Node* node, Target* target);
+
+    /** evaluates the skeletons added this frame */
+    virtual void update(float dt) override;
+
+protected:
+    struct Entry
+    {
+        Node* node;
+        Target* target;
+    };
+
+    void clear(std::vector<Entry>& entries);
+
+    // skeletons added this frame, retained
+    std::vector<Entry> _skeletons;
+    // skeletons being evaluated, swapped with _skeletons to reuse the memory
+    std::vector<Entry> _evaluatedSkeletons;
+    bool _scheduled;
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCSKELETONEVALUATOR_H__
@@ -0,0 +1,246 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "CCStatsOverlay.h"
+#include "CCDirector.h"
+#include "CCScheduler.h"
+#include "actions/CCActionManager.h"
+#include "cocoa/CCAutoreleasePool.h"
+#include "draw_nodes/CCDrawNode.h"
+#include "label_nodes/CCLabelTTF.h"
+#include "shaders/ccGLStateCache.h"
+#include "support/CCGPUProfiler.h"
+#include "support/CCObjectTracker.h"
+#include "textures/CCTextureCache.h"
+#include <algorithm>
+#include <stdio.h>
+
+NS_CC_BEGIN
+
+// size of the graph in points, before the overlay is scaled
+static const float GRAPH_WIDTH = 240.0f;
+static const float GRAPH_HEIGHT = 60.0f;
+
+StatsOverlay* StatsOverlay::create()
+{
+    StatsOverlay* pRet = new StatsOverlay();
+    if (pRet && pRet->init())
+    {
+        pRet->autorelease();
+    }
+    else
+    {
+        CC_SAFE_DELETE(pRet);
+    }
+
+    return pRet;
+}
+
+StatsOverlay::StatsOverlay()
+: _label(NULL)
+, _graph(NULL)
+, _sampleIndex(0)
+, _sampleCount(0)
+, _p50(0.0f)
+, _p95(0.0f)
+, _p99(0.0f)
+, _accumTime(0.0f)
+, _frames(0)
+, _draws(0)
+, _quads(0)
+, _vertices(0)
+, _stateChanges(0)
+, _autoreleased(0)
+, _gpuTime(0.0)
+, _lastStateChanges(0)
+{
+}
+
+StatsOverlay::~StatsOverlay()
+{
+}
+
+bool StatsOverlay::init()
+{
+    if (!Node::init())
+    {
+        return false;
+    }
+
+    _samples.resize(SAMPLE_COUNT, 0.0f);
+    _sorted.reserve(SAMPLE_COUNT);
+    _lastStateChanges = GL::getStateChanges();
+
+    _graph = DrawNode::create();
+    addChild(_graph);
+
+    _label = LabelTTF::create("", "Arial", 10, Size::ZERO, Label::HAlignment::LEFT);
+    _label->setAnchorPoint(Point::ZERO);
+    _label->setPosition(Point(0, GRAPH_HEIGHT + 2));
+    addChild(_label);
+
+    return true;
+}
+
+void StatsOverlay::addFrame(float frameTime)
+{
+    _samples[_sampleIndex] = frameTime * 1000.0f;
+    _sampleIndex = (_sampleIndex + 1) % SAMPLE_COUNT;
+    if (_sampleCount < SAMPLE_COUNT)
+    {
+        ++_sampleCount;
+    }
+
+    unsigned int stateChanges = GL::getStateChanges();
+    _stateChanges += stateChanges - _lastStateChanges;
+    _lastStateChanges = stateChanges;
+
+    _draws += g_uNumberOfDraws;
+    _quads += g_uNumberOfQuads;
+    _vertices += g_uNumberOfVertices;
+    _autoreleased += PoolManager::sharedPoolManager()->getCurReleasePool()->getObjectCount();
+    if (GPUProfiler::isEnabled())
+    {
+        _gpuTime += GPUProfiler::getInstance()->getLastFrameTime();
+    }
+    ++_frames;
+
+    updateGraph();
+
+    _accumTime += frameTime;
+    if (_accumTime > CC_DIRECTOR_STATS_INTERVAL)
+    {
+        updateText();
+        _accumTime = 0.0f;
+        _frames = 0;
+        _draws = 0;
+        _quads = 0;
+        _vertices = 0;
+        _stateChanges = 0;
+        _autoreleased = 0;
+        _gpuTime = 0.0;
+    }
+}
+
+void StatsOverlay::updateText()
+{
+    Director* director = Director::getInstance();
+    Scheduler* scheduler = director->getScheduler();
+    ActionManager* actionManager = director->getActionManager();
+    unsigned int frames = MAX(_frames, 1u);
+
+    char text[768];
+    int length = snprintf(text, sizeof(text),
+             "draws %u  quads %u  vertices %u\n"
+             "GL state changes %u  autoreleased %u\n"
+             "textures %.1f MB\n"
+             "updates %u  timers %u  actions %u  tweens %u\n"
+             "frame p50 %.1f  p95 %.1f  p99 %.1f ms",
+             _draws / frames, _quads / frames, _vertices / frames,
+             _stateChanges / frames, _autoreleased / frames,
+             TextureCache::getInstance()->getTotalMemory() / (1024.0f * 1024.0f),
+             scheduler->getScheduledUpdateCount(), scheduler->getScheduledTimerCount(),
+             actionManager->getNumberOfRunningActions(), actionManager->getNumberOfRunningTweens(),
+             _p50, _p95, _p99);
+
+    if (GPUProfiler::isEnabled() && length > 0 && length < (int)sizeof(text))
+    {
+        // the zones of the last frame measured, the frame itself excepted
+        std::vector<FrameProfiler::ZoneStats> zones = GPUProfiler::getInstance()->getLastFrameZones();
+        zones.erase(std::remove_if(zones.begin(), zones.end(), [](const FrameProfiler::ZoneStats& zone) {
+            return zone.name == GPUProfiler::getZoneName(GPUProfiler::FRAME_ZONE);
+        }), zones.end());
+        std::sort(zones.begin(), zones.end(), [](const FrameProfiler::ZoneStats& a, const FrameProfiler::ZoneStats& b) {
+            return a.totalTime > b.totalTime;
+        });
+
+        length += snprintf(text + length, sizeof(text) - length, "\nGPU %.2f ms", _gpuTime / frames);
+        for (size_t i = 0; i < zones.size() && i < 3 && length < (int)sizeof(text); ++i)
+        {
+            length += snprintf(text + length, sizeof(text) - length, "\n  %s %.2f ms", zones[i].name, zones[i].totalTime);
+        }
+    }
+
+#if CC_ENABLE_OBJECT_TRACKING
+    if (length > 0 && length < (int)sizeof(text))
+    {
+        length += snprintf(text + length, sizeof(text) - length, "\nobjects %u  %.1f MB  peak %u  %.1f MB",
+                           ObjectTracker::getObjectCount(), ObjectTracker::getObjectBytes() / (1024.0f * 1024.0f),
+                           ObjectTracker::getPeakObjectCount(), ObjectTracker::getPeakObjectBytes() / (1024.0f * 1024.0f));
+        std::vector<ObjectTracker::ClassStats> classes = ObjectTracker::getClassStats();
+        for (size_t i = 0; i < classes.size() && i < 3 && length < (int)sizeof(text); ++i)
+        {
+            length += snprintf(text + length, sizeof(text) - length, "\n  %s %u  %.1f KB",
+                               classes[i].name.c_str(), classes[i].count, classes[i].bytes / 1024.0f);
+        }
+    }
+#endif
+    _label->setString(text);
+}
+
+void StatsOverlay::updateGraph()
+{
+    _sorted.assign(_samples.begin(), _samples.begin() + _sampleCount);
+    auto percentile = [this](float fraction) -> float {
+        auto nth = _sorted.begin() + (size_t)(fraction * (_sorted.size() - 1));
+        std::nth_element(_sorted.begin(), nth, _sorted.end());
+        return *nth;
+    };
+    _p50 = percentile(0.50f);
+    _p95 = percentile(0.95f);
+    _p99 = percentile(0.99f);
+    float maxTime = *std::max_element(_sorted.begin(), _sorted.end());
+
+    float targetTime = (float)(Director::getInstance()->getAnimationInterval() * 1000.0);
+    // the target is at the middle of the graph, unless longer frames need more room
+    float scale = GRAPH_HEIGHT / MAX(targetTime * 2.0f, maxTime);
+
+    _graph->clear();
+
+    Point background[] = { Point(0, 0), Point(GRAPH_WIDTH, 0), Point(GRAPH_WIDTH, GRAPH_HEIGHT), Point(0, GRAPH_HEIGHT) };
+    _graph->drawPolygon(background, 4, Color4F(0, 0, 0, 0.5f), 0, Color4F(0, 0, 0, 0));
+
+    // the oldest frame on the left
+    float barWidth = GRAPH_WIDTH / SAMPLE_COUNT;
+    unsigned int first = (_sampleIndex + SAMPLE_COUNT - _sampleCount) % SAMPLE_COUNT;
+    for (unsigned int i = 0; i < _sampleCount; ++i)
+    {
+        float time = _samples[(first + i) % SAMPLE_COUNT];
+        Color4F color = time <= targetTime * 1.1f ? Color4F(0.2f, 0.8f, 0.2f, 0.8f)
+                      : time <= targetTime * 2.1f ? Color4F(0.9f, 0.8f, 0.1f, 0.8f)
+                      : Color4F(0.9f, 0.2f, 0.2f, 0.8f);
+        float x = (SAMPLE_COUNT - _sampleCount + i) * barWidth;
+        float height = time * scale;
+        Point bar[] = { Point(x, 0), Point(x + barWidth, 0), Point(x + barWidth, height), Point(x, height) };
+        _graph->drawPolygon(bar, 4, color, 0, Color4F(0, 0, 0, 0));
+    }
+
+    _graph->drawSegment(Point(0, targetTime * scale), Point(GRAPH_WIDTH, targetTime * scale), 0.5f, Color4F(1, 1, 1, 0.6f));
+    _graph->drawSegment(Point(0, _p50 * scale), Point(GRAPH_WIDTH, _p50 * scale), 0.5f, Color4F(0.3f, 1, 0.3f, 1));
+    _graph->drawSegment(Point(0, _p95 * scale), Point(GRAPH_WIDTH, _p95 * scale), 0.5f, Color4F(1, 1, 0.3f, 1));
+    _graph->drawSegment(Point(0, _p99 * scale), Point(GRAPH_WIDTH, _p99 * scale), 0.5f, Color4F(1, 0.3f, 0.3f, 1));
+}
+
+NS_CC_END
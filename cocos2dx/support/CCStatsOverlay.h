@@ -0,0 +1,116 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __SUPPORT_CCSTATSOVERLAY_H__
+#define __SUPPORT_CCSTATSOVERLAY_H__
+
+#include "base_nodes/CCNode.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+class LabelTTF;
+class DrawNode;
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief StatsOverlay shows the detailed statistics of the frames, drawn by the Director when
+ Director::setDisplayDetailedStats() is set.
+
+ The text gives, per frame and averaged over CC_DIRECTOR_STATS_INTERVAL: the draw calls, the quads drawn in
+ batches, the vertices, the GL state changes, the autoreleased objects, and the texture memory, the scheduled
+ updates and timers, and the running actions and tweens of the last frame. When GPUProfiler is enabled, it adds
+ the GPU time of the frames and the most expensive GPU zones of the last frame measured. When CC_ENABLE_OBJECT_TRACKING
+ is enabled, it adds the living Objects, their bytes and high-water marks, and the classes using the most memory.
+
+ The graph shows the time of the last SAMPLE_COUNT frames, with the median, the 95th and the 99th percentiles
+ of these frames, and the frame time of the animation interval of the Director.
+
+ @since v3.0
+ */
+class CC_DLL StatsOverlay : public Node
+{
+public:
+    /** number of frames shown by the graph */
+    static const int SAMPLE_COUNT = 120;
+
+    static StatsOverlay* create();
+
+    StatsOverlay();
+    virtual ~StatsOverlay();
+
+    virtual bool init() override;
+
+    /** Records the counters of the frame drawn and updates the overlay. Called by the Director before the
+     overlay is visited, and before the counters are reset.
+     @param frameTime time since the previous frame, in seconds
+     */
+    void addFrame(float frameTime);
+
+    /** Percentiles of the frame times of the graph, in milliseconds */
+    float getMedianFrameTime() const { return _p50; }
+    float getFrameTime95() const { return _p95; }
+    float getFrameTime99() const { return _p99; }
+
+protected:
+    void updateText();
+    void updateGraph();
+
+    LabelTTF* _label;
+    DrawNode* _graph;
+
+    /** frame times in milliseconds, a ring of SAMPLE_COUNT frames */
+    std::vector<float> _samples;
+    unsigned int _sampleIndex;
+    unsigned int _sampleCount;
+    /** copy of the samples partially sorted for the percentiles */
+    std::vector<float> _sorted;
+    float _p50;
+    float _p95;
+    float _p99;
+
+    /** counters summed since the text was updated */
+    float _accumTime;
+    unsigned int _frames;
+    unsigned int _draws;
+    unsigned int _quads;
+    unsigned int _vertices;
+    unsigned int _stateChanges;
+    unsigned int _autoreleased;
+    /** GPU times of the frames in milliseconds, when GPUProfiler is enabled */
+    double _gpuTime;
+    /** value of GL::getStateChanges() at the previous frame */
+    unsigned int _lastStateChanges;
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCSTATSOVERLAY_H__
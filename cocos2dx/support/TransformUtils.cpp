@@ -25,6 +25,7 @@ THE SOFTWARE.
 
 #include "TransformUtils.h"
 #include "cocoa/CCAffineTransform.h"
+#include "ccTypes.h"
 
 namespace cocos2d {
 
@@ -47,5 +48,36 @@ void GLToCGAffine(const GLfloat *m, AffineTransform *t)
     t->b = m[1]; t->d = m[5]; t->ty = m[13];
 }
 
+bool isQuadVisible(const kmMat4 *mvp, const V3F_C4B_T2F_Quad *quad)
+{
+    const Vertex3F* vertices[4] = { &quad->bl.vertices, &quad->br.vertices, &quad->tl.vertices, &quad->tr.vertices };
+    const float* m = mvp->mat;
+
+    // bit set for each side of the clip volume the vertex is outside of
+    unsigned int outside = 0xff;
+    for (int i = 0; i < 4; i++)
+    {
+        const Vertex3F* v = vertices[i];
+        float x = m[0] * v->x + m[4] * v->y + m[8]  * v->z + m[12];
+        float y = m[1] * v->x + m[5] * v->y + m[9]  * v->z + m[13];
+        float w = m[3] * v->x + m[7] * v->y + m[11] * v->z + m[15];
+
+        if (w <= 0)
+        {
+            return true;
+        }
+
+        unsigned int code = 0;
+        if (x < -w) code |= 1;
+        if (x > w)  code |= 2;
+        if (y < -w) code |= 4;
+        if (y > w)  code |= 8;
+        outside &= code;
+    }
+
+    // all the vertices are on the outer side of the same plane
+    return outside == 0;
+}
+
 }//namespace   cocos2d 
 
@@ -29,13 +29,20 @@ THE SOFTWARE.
 // todo:
 // when in MAC or windows, it includes <OpenGL/gl.h>
 #include "CCGL.h"
+#include "kazmath/mat4.h"
 
 namespace   cocos2d {
 
 struct AffineTransform;
+struct V3F_C4B_T2F_Quad;
 
 void CGAffineToGL(const AffineTransform *t, GLfloat *m);
 void GLToCGAffine(const GLfloat *m, AffineTransform *t);
+
+/** Returns false if the quad, transformed by mvp (projection * model-view), is outside the viewport.
+ The test is conservative: quads crossing the near plane are considered visible.
+ */
+bool isQuadVisible(const kmMat4 *mvp, const V3F_C4B_T2F_Quad *quad);
 }//namespace   cocos2d 
 
 #endif // __SUPPORT_TRANSFORM_UTILS_H__
@@ -25,6 +25,18 @@
 #include "ccUTF8.h"
 #include "platform/CCCommon.h"
 
+#include <string.h>
+#include <stdint.h>
+
+// SIMD ASCII scanning
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CC_UTF8_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define CC_UTF8_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
 NS_CC_BEGIN
 
 int cc_wcslen(const unsigned short* str)
@@ -36,40 +48,6 @@ int cc_wcslen(const unsigned short* str)
 
 /* Code from GLIB gutf8.c starts here. */
 
-#define UTF8_COMPUTE(Char, Mask, Len)        \
-if (Char < 128)                \
-{                        \
-Len = 1;                    \
-Mask = 0x7f;                \
-}                        \
-else if ((Char & 0xe0) == 0xc0)        \
-{                        \
-Len = 2;                    \
-Mask = 0x1f;                \
-}                        \
-else if ((Char & 0xf0) == 0xe0)        \
-{                        \
-Len = 3;                    \
-Mask = 0x0f;                \
-}                        \
-else if ((Char & 0xf8) == 0xf0)        \
-{                        \
-Len = 4;                    \
-Mask = 0x07;                \
-}                        \
-else if ((Char & 0xfc) == 0xf8)        \
-{                        \
-Len = 5;                    \
-Mask = 0x03;                \
-}                        \
-else if ((Char & 0xfe) == 0xfc)        \
-{                        \
-Len = 6;                    \
-Mask = 0x01;                \
-}                        \
-else                        \
-Len = -1;
-
 #define UTF8_LENGTH(Char)            \
 ((Char) < 0x80 ? 1 :                \
 ((Char) < 0x800 ? 2 :            \
@@ -78,49 +56,6 @@ Len = -1;
 ((Char) < 0x4000000 ? 5 : 6)))))
 
 
-#define UTF8_GET(Result, Chars, Count, Mask, Len)    \
-(Result) = (Chars)[0] & (Mask);            \
-for ((Count) = 1; (Count) < (Len); ++(Count))        \
-{                            \
-if (((Chars)[(Count)] & 0xc0) != 0x80)        \
-{                        \
-(Result) = -1;                \
-break;                    \
-}                        \
-(Result) <<= 6;                    \
-(Result) |= ((Chars)[(Count)] & 0x3f);        \
-}
-
-#define UNICODE_VALID(Char)            \
-((Char) < 0x110000 &&                \
-(((Char) & 0xFFFFF800) != 0xD800) &&        \
-((Char) < 0xFDD0 || (Char) > 0xFDEF) &&    \
-((Char) & 0xFFFE) != 0xFFFE)
-
-
-static const char utf8_skip_data[256] = {
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    1, 1, 1, 1, 1, 1, 1,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2,
-    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 5,
-    5, 5, 5, 6, 6, 1, 1
-};
-
-static const char *const g_utf8_skip = utf8_skip_data;
-
-#define cc_utf8_next_char(p) (char *)((p) + g_utf8_skip[*(unsigned char *)(p)])
-
 /*
  * @str:    the string to search through.
  * @c:        the character to not look for.
@@ -193,6 +128,161 @@ void cc_utf8_trim_ws(std::vector<unsigned short>* str)
     }
 }
 
+/*
+ * cc_utf8_ascii_run:
+ * @p: start of the bytes to scan.
+ * @end: end of the bytes to scan.
+ * @out: where to widen the ASCII bytes to UTF-16, or %NULL to only scan.
+ *
+ * Skips the run of 7-bit ASCII bytes at @p, 16 bytes at a time with SSE2/NEON
+ * and 8 bytes at a time elsewhere, widening them into @out when given. The
+ * tail of the run (fewer than one block) is left to the scalar decoder.
+ *
+ * Return value: the number of bytes consumed.
+ **/
+static int
+cc_utf8_ascii_run (const unsigned char * p, const unsigned char * end, unsigned short * out)
+{
+    const unsigned char *start = p;
+
+#if CC_UTF8_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    while (end - p >= 16)
+    {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)p);
+        if (_mm_movemask_epi8(bytes))
+            break;
+        if (out)
+        {
+            _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi8(bytes, zero));
+            _mm_storeu_si128((__m128i*)(out + 8), _mm_unpackhi_epi8(bytes, zero));
+            out += 16;
+        }
+        p += 16;
+    }
+#elif CC_UTF8_USE_NEON
+    while (end - p >= 16)
+    {
+        uint8x16_t bytes = vld1q_u8(p);
+        uint8x8_t high = vshrn_n_u16(vreinterpretq_u16_u8(vshrq_n_u8(bytes, 7)), 4);
+        if (vget_lane_u64(vreinterpret_u64_u8(high), 0))
+            break;
+        if (out)
+        {
+            vst1q_u16(out, vmovl_u8(vget_low_u8(bytes)));
+            vst1q_u16(out + 8, vmovl_u8(vget_high_u8(bytes)));
+            out += 16;
+        }
+        p += 16;
+    }
+#endif
+
+    while (end - p >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        if (word & 0x8080808080808080ULL)
+            break;
+        if (out)
+        {
+            for (int i = 0; i < 8; ++i)
+                out[i] = p[i];
+            out += 8;
+        }
+        p += 8;
+    }
+
+    return (int)(p - start);
+}
+
+/*
+ * cc_utf8_decode_validated:
+ * @p: start of a UTF-8 sequence.
+ * @end: end of the input; @p must be before @end.
+ * @ch: location to store the decoded character.
+ *
+ * Decodes one character, rejecting overlong forms, surrogates, stray
+ * continuation bytes and values above U+10FFFF. Invalid bytes decode to
+ * U+FFFD one at a time so that a damaged string still lays out.
+ *
+ * Return value: the number of bytes consumed, or 0 if @p starts a valid
+ *               sequence that is cut off by @end.
+ **/
+static int
+cc_utf8_decode_validated (const unsigned char * p, const unsigned char * end, unsigned int * ch)
+{
+    unsigned int c = p[0];
+    int len;
+    unsigned int min;
+
+    if (c < 0x80)
+    {
+        *ch = c;
+        return 1;
+    }
+    else if (c >= 0xc2 && c <= 0xdf)
+    {
+        len = 2;
+        min = 0x80;
+        c &= 0x1f;
+    }
+    else if (c >= 0xe0 && c <= 0xef)
+    {
+        len = 3;
+        min = 0x800;
+        c &= 0x0f;
+    }
+    else if (c >= 0xf0 && c <= 0xf4)
+    {
+        len = 4;
+        min = 0x10000;
+        c &= 0x07;
+    }
+    else
+    {
+        *ch = 0xfffd;
+        return 1;
+    }
+
+    for (int i = 1; i < len; ++i)
+    {
+        if (p + i >= end)
+            return 0;
+        if ((p[i] & 0xc0) != 0x80)
+        {
+            *ch = 0xfffd;
+            return 1;
+        }
+        c = (c << 6) | (p[i] & 0x3f);
+    }
+
+    if (c < min || c > 0x10ffff || (c & 0xfffff800) == 0xd800)
+    {
+        *ch = 0xfffd;
+        return 1;
+    }
+
+    *ch = c;
+    return len;
+}
+
+/*
+ * cc_utf8_byte_length:
+ * @p: pointer to a UTF-8 string.
+ * @max: the maximum number of bytes to examine, or < 0 for null-terminated.
+ *
+ * Return value: the number of bytes before the terminating 0 or @max.
+ **/
+static int
+cc_utf8_byte_length (const char * p, int max)
+{
+    if (max < 0)
+        return (int)strlen(p);
+
+    const void *nul = memchr(p, 0, max);
+    return nul ? (int)((const char *)nul - p) : max;
+}
+
 /*
  * cc_utf8_strlen:
  * @p: pointer to the start of a UTF-8 encoded string.
@@ -208,88 +298,109 @@ void cc_utf8_trim_ws(std::vector<unsigned short>* str)
 long
 cc_utf8_strlen (const char * p, int max)
 {
-    long len = 0;
-    const char *start = p;
-    
-    if (!(p != NULL || max == 0))
+    if (p == NULL || max == 0)
     {
         return 0;
     }
-    
-    if (max < 0)
+
+    const unsigned char *in = (const unsigned char *)p;
+    const unsigned char *end = in + cc_utf8_byte_length(p, max);
+    long len = 0;
+
+    while (in < end)
     {
-        while (*p)
+        int ascii = cc_utf8_ascii_run(in, end, NULL);
+        in += ascii;
+        len += ascii;
+
+        while (in < end && *in < 0x80)
         {
-            p = cc_utf8_next_char (p);
+            ++in;
             ++len;
         }
+        if (in >= end)
+            break;
+
+        unsigned int ch;
+        int n = cc_utf8_decode_validated(in, end, &ch);
+        /* don't count partial chars */
+        if (n == 0)
+            break;
+        in += n;
+        ++len;
     }
-    else
+
+    return len;
+}
+
+int cc_utf8_to_utf16_buffer(const char* str, int length, unsigned short* out, int capacity)
+{
+    if (str == NULL)
     {
-        if (max == 0 || !*p)
-            return 0;
-        
-        p = cc_utf8_next_char (p);
-        
-        while (p - start < max && *p)
+        if (out && capacity > 0)
+            out[0] = 0;
+        return 0;
+    }
+
+    const unsigned char *in = (const unsigned char *)str;
+    const unsigned char *end = in + cc_utf8_byte_length(str, length);
+    int limit = (out && capacity > 0) ? capacity - 1 : 0;
+    int written = 0;
+
+    while (in < end)
+    {
+        // widen whole ASCII blocks straight into the buffer while they fit
+        const unsigned char *blockEnd = end;
+        if (out)
         {
-            ++len;
-            p = cc_utf8_next_char (p);
+            int room = written < limit ? limit - written : 0;
+            if (end - in > room)
+                blockEnd = in + room;
         }
-        
-        /* only do the last len increment if we got a complete
-         * char (don't count partial chars)
-         */
-        if (p - start == max)
-            ++len;
+        int ascii = cc_utf8_ascii_run(in, blockEnd, out ? out + written : NULL);
+        in += ascii;
+        written += ascii;
+
+        if (in >= end)
+            break;
+
+        unsigned int ch;
+        int n = 1;
+        if (*in < 0x80)
+        {
+            ch = *in;
+        }
+        else
+        {
+            n = cc_utf8_decode_validated(in, end, &ch);
+            if (n == 0)
+                break;
+            // glyphs are looked up by 16-bit code, characters outside the BMP have none
+            if (ch > 0xffff)
+                ch = 0xfffd;
+        }
+        in += n;
+
+        if (written < limit)
+            out[written] = (unsigned short)ch;
+        ++written;
     }
-    
-    return len;
-}
 
-/*
- * g_utf8_get_char:
- * @p: a pointer to Unicode character encoded as UTF-8
- *
- * Converts a sequence of bytes encoded as UTF-8 to a Unicode character.
- * If @p does not point to a valid UTF-8 encoded character, results are
- * undefined. If you are not sure that the bytes are complete
- * valid Unicode characters, you should use g_utf8_get_char_validated()
- * instead.
- *
- * Return value: the resulting character
- **/
-static unsigned int
-cc_utf8_get_char (const char * p)
-{
-    int i, mask = 0, len;
-    unsigned int result;
-    unsigned char c = (unsigned char) *p;
-    
-    UTF8_COMPUTE (c, mask, len);
-    if (len == -1)
-        return (unsigned int) - 1;
-    UTF8_GET (result, p, i, mask, len);
-    
-    return result;
-}
+    if (out && capacity > 0)
+        out[written < limit ? written : limit] = 0;
 
+    return written;
+}
 
 unsigned short* cc_utf8_to_utf16(const char* str_old, int length/* = -1 */, int* rUtf16Size/* = NULL */)
 {
-    int len = cc_utf8_strlen(str_old, length);
+    int len = (int)cc_utf8_strlen(str_old, length);
     if (rUtf16Size != NULL) {
         *rUtf16Size = len;
     }
     
     unsigned short* str_new = new unsigned short[len + 1];
-    str_new[len] = 0;
-    
-    for (int i = 0; i < len; ++i)
-    {
-        str_new[i] = cc_utf8_get_char(str_old);
-        str_old = cc_utf8_next_char(str_old);
-    }
+    cc_utf8_to_utf16_buffer(str_old, length, str_new, len + 1);
     
     return str_new;
 }
@@ -297,13 +408,7 @@ unsigned short* cc_utf8_to_utf16(const char* str_old, int length/* = -1 */, int*
 std::vector<unsigned short> cc_utf16_vec_from_utf16_str(const unsigned short* str)
 {
     int len = cc_wcslen(str);
-    std::vector<unsigned short> str_new;
-    
-    for (int i = 0; i < len; ++i)
-    {
-        str_new.push_back(str[i]);
-    }
-    return str_new;
+    return std::vector<unsigned short>(str, str + len);
 }
 
 /**
@@ -61,6 +61,26 @@ CC_DLL std::vector<unsigned short> cc_utf16_vec_from_utf16_str(const unsigned sh
  * */
 CC_DLL unsigned short* cc_utf8_to_utf16(const char* str_old, int length = -1, int* rUtf16Size = NULL);
 
+/*
+ * cc_utf8_to_utf16_buffer:
+ * @str: pointer to the start of a UTF-8 string, may be %NULL.
+ * @length: the maximum number of bytes to convert. If @length is
+ *          less than 0, then the string is assumed to be null-terminated.
+ * @out: the caller-provided buffer, or %NULL to only measure.
+ * @capacity: the size of @out in units, including the terminating 0.
+ *
+ * Converts a UTF-8 string into @out without allocating. Invalid bytes and
+ * characters outside the BMP become U+FFFD, and a trailing partial character
+ * is dropped. At most @capacity - 1 units are written and the result is
+ * always 0-terminated when @capacity > 0. A buffer of (byte length + 1)
+ * units is always large enough.
+ *
+ * Return value: the number of UTF-16 units in the whole string, which is
+ *               more than was written when @out was too small.
+ * @since v3.0
+ * */
+CC_DLL int cc_utf8_to_utf16_buffer(const char* str, int length, unsigned short* out, int capacity);
+
 /**
  * cc_utf16_to_utf8:
  * @str: a UTF-16 encoded string
@@ -30,6 +30,8 @@ NS_CC_BEGIN
 Component::Component(void)
 : _owner(NULL)
 , _enabled(true)
+, _systemGroup(-1)
+, _systemIndex(-1)
 {
 }
 
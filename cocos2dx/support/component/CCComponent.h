@@ -54,6 +54,14 @@ protected:
     Node *_owner;
     std::string _name;
     bool _enabled;
+
+private:
+    // array of the type of the component in the ComponentSystem, and index in it, -1 if it isn't in the system
+    int _systemGroup;
+    int _systemIndex;
+
+    friend class ComponentSystem;
+    friend class ComponentContainer;
 };
 
 NS_CC_END
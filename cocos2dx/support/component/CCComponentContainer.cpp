@@ -25,6 +25,7 @@ THE SOFTWARE.
 
 #include "support/component/CCComponentContainer.h"
 #include "support/component/CCComponent.h"
+#include "support/component/CCComponentSystem.h"
 #include "CCDirector.h"
 
 NS_CC_BEGIN
@@ -32,6 +33,7 @@ NS_CC_BEGIN
 ComponentContainer::ComponentContainer(Node *pNode)
 : _components(NULL)
 , _owner(pNode)
+, _paused(true)
 {
 }
 
@@ -64,7 +66,6 @@ bool ComponentContainer::add(Component *pCom)
         {
             _components = Dictionary::create();
             _components->retain();
-            _owner->scheduleUpdate();
         }
         Component *pComponent = dynamic_cast<Component*>(_components->objectForKey(pCom->getName()));
         
@@ -72,6 +73,7 @@ bool ComponentContainer::add(Component *pCom)
         CC_BREAK_IF(pComponent);
         pCom->setOwner(_owner);
         _components->setObject(pCom, pCom->getName());
+        ComponentSystem::getInstance()->addComponent(pCom, this);
         pCom->onEnter();
         bRet = true;
     } while(0);
@@ -96,6 +98,7 @@ bool ComponentContainer::remove(const char *pName)
         CC_BREAK_IF(!com);
         com->onExit();
         com->setOwner(NULL);
+        removeFromSystem(com);
         HASH_DEL(_components->_elements, pElement);
         pElement->getObject()->release();
         CC_SAFE_DELETE(pElement);
@@ -114,10 +117,19 @@ void ComponentContainer::removeAll()
             HASH_DEL(_components->_elements, pElement);
             ((Component*)pElement->getObject())->onExit();
             ((Component*)pElement->getObject())->setOwner(NULL);
+            removeFromSystem((Component*)pElement->getObject());
             pElement->getObject()->release();
             CC_SAFE_DELETE(pElement);
         }
-        _owner->unscheduleUpdate();
+    }
+}
+
+void ComponentContainer::removeFromSystem(Component *pCom)
+{
+    // the system may be destroyed already, with the director
+    if (pCom->_systemIndex >= 0)
+    {
+        ComponentSystem::getInstance()->removeComponent(pCom);
     }
 }
 
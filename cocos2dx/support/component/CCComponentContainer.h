@@ -46,13 +46,17 @@ public:
     virtual void visit(float fDelta);
 public:
     bool isEmpty() const;
+    /** whether the scheduler of the owner is paused: its components aren't updated by the ComponentSystem */
+    inline bool isPaused() const { return _paused; }
     
 private:
     void alloc(void);
+    void removeFromSystem(Component *pCom);
     
 private:
     Dictionary *_components;        ///< Dictionary of components
     Node *_owner;
+    bool _paused;
     
     friend class Node;
 };
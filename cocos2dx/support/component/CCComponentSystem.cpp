@@ -0,0 +1,170 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "support/component/CCComponentSystem.h"
+#include "support/component/CCComponent.h"
+#include "support/component/CCComponentContainer.h"
+#include "CCDirector.h"
+#include "CCScheduler.h"
+#include <typeinfo>
+
+NS_CC_BEGIN
+
+static ComponentSystem *s_sharedComponentSystem = NULL;
+
+ComponentSystem* ComponentSystem::getInstance()
+{
+    if (!s_sharedComponentSystem)
+    {
+        s_sharedComponentSystem = new ComponentSystem();
+        Director::getInstance()->getScheduler()->scheduleUpdateForTarget(s_sharedComponentSystem, 0, false);
+    }
+    return s_sharedComponentSystem;
+}
+
+void ComponentSystem::destroyInstance()
+{
+    if (s_sharedComponentSystem)
+    {
+        // the scheduler retains it
+        Director::getInstance()->getScheduler()->unscheduleUpdateForTarget(s_sharedComponentSystem);
+        CC_SAFE_RELEASE_NULL(s_sharedComponentSystem);
+    }
+}
+
+ComponentSystem::ComponentSystem()
+: _updating(false)
+{
+}
+
+ComponentSystem::~ComponentSystem()
+{
+    // the components still added can be removed from their nodes without the system
+    for (auto& group : _groups)
+    {
+        for (auto& entry : group.entries)
+        {
+            if (entry.component)
+            {
+                entry.component->_systemIndex = -1;
+            }
+        }
+    }
+}
+
+void ComponentSystem::addComponent(Component* component, ComponentContainer* container)
+{
+    CCASSERT(component->_systemIndex == -1, "Component already added to the system");
+
+    std::type_index type(typeid(*component));
+    auto it = _groupIndices.find(type);
+    int groupIndex;
+    if (it == _groupIndices.end())
+    {
+        groupIndex = (int)_groups.size();
+        _groupIndices[type] = groupIndex;
+        Group group;
+        group.hasHoles = false;
+        _groups.push_back(group);
+    }
+    else
+    {
+        groupIndex = it->second;
+    }
+
+    Group& group = _groups[groupIndex];
+    Entry entry = { component, container };
+    component->_systemGroup = groupIndex;
+    component->_systemIndex = (int)group.entries.size();
+    group.entries.push_back(entry);
+}
+
+void ComponentSystem::removeComponent(Component* component)
+{
+    if (component->_systemIndex < 0)
+    {
+        return;
+    }
+
+    Group& group = _groups[component->_systemGroup];
+    CCASSERT(group.entries[component->_systemIndex].component == component, "Invalid component index");
+
+    group.entries[component->_systemIndex].component = NULL;
+    component->_systemIndex = -1;
+    group.hasHoles = true;
+
+    if (! _updating)
+    {
+        compact(group);
+    }
+}
+
+void ComponentSystem::compact(Group& group)
+{
+    // keeps the order of the components, which is the order of their updates
+    int count = 0;
+    for (auto& entry : group.entries)
+    {
+        if (entry.component)
+        {
+            entry.component->_systemIndex = count;
+            group.entries[count++] = entry;
+        }
+    }
+    group.entries.resize(count);
+    group.hasHoles = false;
+}
+
+void ComponentSystem::update(float dt)
+{
+    _updating = true;
+
+    // by index: an update may add a component of a new type and grow the arrays
+    for (size_t g = 0; g < _groups.size(); ++g)
+    {
+        // the components added by an update are updated next frame
+        size_t count = _groups[g].entries.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            Entry entry = _groups[g].entries[i];
+            if (entry.component && ! entry.container->isPaused())
+            {
+                entry.component->update(dt);
+                Director::setNextFrameDirty();
+            }
+        }
+    }
+
+    _updating = false;
+
+    for (auto& group : _groups)
+    {
+        if (group.hasHoles)
+        {
+            compact(group);
+        }
+    }
+}
+
+NS_CC_END
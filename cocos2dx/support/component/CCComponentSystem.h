@@ -0,0 +1,91 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_FRAMEWORK_COMSYSTEM_H__
+#define __CC_FRAMEWORK_COMSYSTEM_H__
+
+#include "cocoa/CCObject.h"
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+NS_CC_BEGIN
+
+class Component;
+class ComponentContainer;
+
+/** @brief ComponentSystem updates the components of all the nodes, type by type.
+
+The components added to a node are also stored in one array per dynamic type of component, so the components
+of the same type are updated together every frame, instead of node by node through a Dictionary.
+The components of a node are updated while the node is running and its scheduler isn't paused, as they were when
+the node scheduled its own update.
+
+The system is scheduled once, with the same priority as Node::scheduleUpdate().
+*/
+class CC_DLL ComponentSystem : public Object
+{
+public:
+    /** Gets the single instance of ComponentSystem. */
+    static ComponentSystem* getInstance();
+
+    /** Destroys the single instance of ComponentSystem. The components stop being updated. */
+    static void destroyInstance();
+
+    ComponentSystem();
+    virtual ~ComponentSystem();
+
+    /** Adds a component of a node to the array of its type. Called by the ComponentContainer of the node */
+    void addComponent(Component* component, ComponentContainer* container);
+
+    /** Removes a component from the array of its type. Called by the ComponentContainer of its node */
+    void removeComponent(Component* component);
+
+    /** updates all the components, type by type */
+    virtual void update(float dt) override;
+
+protected:
+    struct Entry
+    {
+        Component* component;
+        ComponentContainer* container;
+    };
+
+    struct Group
+    {
+        std::vector<Entry> entries;
+        // the entries removed while updating are cleared, and compacted after the update
+        bool hasHoles;
+    };
+
+    void compact(Group& group);
+
+    std::vector<Group> _groups;
+    std::unordered_map<std::type_index, int> _groupIndices;
+    bool _updating;
+};
+
+NS_CC_END
+
+#endif  // __CC_FRAMEWORK_COMSYSTEM_H__
@@ -26,6 +26,12 @@ THE SOFTWARE.
 #include "platform/CCFileUtils.h"
 #include "../tinyxml2/tinyxml2.h"
 #include "support/base64.h"
+#include "support/CCNotificationCenter.h"
+#include "CCDirector.h"
+#include "CCScheduler.h"
+#include "CCEventType.h"
+#include <unordered_map>
+#include <stdio.h>
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS && CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
 
@@ -38,102 +44,149 @@ using namespace std;
 
 NS_CC_BEGIN
 
+// seconds between a change of a value and the save of the xml file, so that a burst of changes is written once
+#define USERDEFAULT_FLUSH_DELAY    2.0f
+
 /**
  * define the functions here because we don't want to
  * export xmlNodePtr and other types in "CCUserDefault.h"
  */
 
-static tinyxml2::XMLElement* getXMLNodeForKey(const char* pKey, tinyxml2::XMLElement** rootNode, tinyxml2::XMLDocument **doc)
+// the values of the xml file, which is only parsed once
+static std::unordered_map<std::string, std::string> s_values;
+static bool s_valuesLoaded = false;
+// whether s_values has changes that aren't in the xml file yet
+static bool s_dirty = false;
+
+/**
+ * Saves the values some time after they changed, and when the application goes to background.
+ */
+class UserDefaultFlusher : public Object
 {
-    tinyxml2::XMLElement* curNode = NULL;
+public:
+    UserDefaultFlusher()
+    : _scheduled(false)
+    {
+        NotificationCenter::getInstance()->addObserver(this,
+                                                      callfuncO_selector(UserDefaultFlusher::onComeToBackground),
+                                                      EVENT_COME_TO_BACKGROUND,
+                                                      NULL);
+    }
 
-    // check the key value
-    if (! pKey)
+    virtual ~UserDefaultFlusher()
     {
-        return NULL;
+        NotificationCenter::getInstance()->removeObserver(this, EVENT_COME_TO_BACKGROUND);
     }
 
-    do 
+    void schedule()
     {
- 		tinyxml2::XMLDocument* xmlDoc = new tinyxml2::XMLDocument();
-		*doc = xmlDoc;
-		//CCFileData data(UserDefault::getInstance()->getXMLFilePath().c_str(),"rt");
-		unsigned long nSize;
-		const char* pXmlBuffer = (const char*)FileUtils::getInstance()->getFileData(UserDefault::getInstance()->getXMLFilePath().c_str(), "rb", &nSize);
-		//const char* pXmlBuffer = (const char*)data.getBuffer();
-		if(NULL == pXmlBuffer)
-		{
-			CCLOG("can not read xml file");
-			break;
-		}
-		xmlDoc->Parse(pXmlBuffer);
-        delete[] pXmlBuffer;
-		// get root node
-		*rootNode = xmlDoc->RootElement();
-		if (NULL == *rootNode)
-		{
-			CCLOG("read root node error");
-			break;
-		}
-		// find the node
-		curNode = (*rootNode)->FirstChildElement();
-		while (NULL != curNode)
-		{
-			const char* nodeName = curNode->Value();
-			if (!strcmp(nodeName, pKey))
-			{
-				break;
-			}
-
-			curNode = curNode->NextSiblingElement();
-		}
-	} while (0);
-
-	return curNode;
-}
+        if (! _scheduled)
+        {
+            _scheduled = true;
+            Director::getInstance()->getScheduler()->scheduleSelector(schedule_selector(UserDefaultFlusher::onTimer), this, USERDEFAULT_FLUSH_DELAY, 0, 0, false);
+        }
+    }
 
-static void setValueForKey(const char* pKey, const char* pValue)
-{
- 	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	// check the params
-	if (! pKey || ! pValue)
-	{
-		return;
-	}
-	// find the node
-	node = getXMLNodeForKey(pKey, &rootNode, &doc);
-	// if node exist, change the content
-	if (node)
-	{
-        if (node->FirstChild())
+    void cancel()
+    {
+        if (_scheduled)
         {
-            node->FirstChild()->SetValue(pValue);
+            _scheduled = false;
+            Director::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(UserDefaultFlusher::onTimer), this);
         }
-        else
+    }
+
+private:
+    void onTimer(float dt)
+    {
+        // the timer only fires once, it unschedules itself
+        _scheduled = false;
+        UserDefault::getInstance()->flush();
+    }
+
+    void onComeToBackground(Object* obj)
+    {
+        UserDefault::getInstance()->flush();
+    }
+
+    bool _scheduled;
+};
+
+static UserDefaultFlusher* s_flusher = NULL;
+
+static void loadValues()
+{
+    if (s_valuesLoaded)
+    {
+        return;
+    }
+    s_valuesLoaded = true;
+
+    unsigned long nSize = 0;
+    unsigned char* pXmlBuffer = FileUtils::getInstance()->getFileData(UserDefault::getXMLFilePath().c_str(), "rb", &nSize);
+    if (NULL == pXmlBuffer)
+    {
+        CCLOG("can not read xml file");
+        return;
+    }
+
+    tinyxml2::XMLDocument xmlDoc;
+    xmlDoc.Parse((const char*)pXmlBuffer, nSize);
+    delete[] pXmlBuffer;
+
+    tinyxml2::XMLElement* rootNode = xmlDoc.RootElement();
+    if (NULL == rootNode)
+    {
+        CCLOG("read root node error");
+        return;
+    }
+
+    // a node without content has no value, like a key that was never set
+    for (tinyxml2::XMLElement* node = rootNode->FirstChildElement(); node; node = node->NextSiblingElement())
+    {
+        if (node->FirstChild())
         {
-            tinyxml2::XMLText* content = doc->NewText(pValue);
-            node->LinkEndChild(content);
+            s_values[node->Value()] = node->FirstChild()->Value();
         }
-	}
-	else
-	{
-		if (rootNode)
-		{
-			tinyxml2::XMLElement* tmpNode = doc->NewElement(pKey);//new tinyxml2::XMLElement(pKey);
-			rootNode->LinkEndChild(tmpNode);
-			tinyxml2::XMLText* content = doc->NewText(pValue);//new tinyxml2::XMLText(pValue);
-			tmpNode->LinkEndChild(content);
-		}	
-	}
+    }
+}
 
-    // save file and free doc
-	if (doc)
-	{
-		doc->SaveFile(UserDefault::getInstance()->getXMLFilePath().c_str());
-		delete doc;
-	}
+static const char* getValueForKey(const char* pKey)
+{
+    if (! pKey)
+    {
+        return NULL;
+    }
+
+    loadValues();
+
+    auto iter = s_values.find(pKey);
+    return iter != s_values.end() ? iter->second.c_str() : NULL;
+}
+
+static void setValueForKey(const char* pKey, const char* pValue)
+{
+    // check the params
+    if (! pKey || ! pValue)
+    {
+        return;
+    }
+
+    loadValues();
+
+    auto iter = s_values.find(pKey);
+    if (iter != s_values.end() && iter->second == pValue)
+    {
+        return;
+    }
+    s_values[pKey] = pValue;
+    s_dirty = true;
+
+    if (! s_flusher)
+    {
+        s_flusher = new UserDefaultFlusher();
+    }
+    s_flusher->schedule();
 }
 
 /**
@@ -166,16 +219,7 @@ bool UserDefault::getBoolForKey(const char* pKey)
 
 bool UserDefault::getBoolForKey(const char* pKey, bool defaultValue)
 {
-    const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
+    const char* value = getValueForKey(pKey);
 
 	bool ret = defaultValue;
 
@@ -184,8 +228,6 @@ bool UserDefault::getBoolForKey(const char* pKey, bool defaultValue)
 		ret = (! strcmp(value, "true"));
 	}
 
-    if (doc) delete doc;
-
 	return ret;
 }
 
@@ -196,16 +238,7 @@ int UserDefault::getIntegerForKey(const char* pKey)
 
 int UserDefault::getIntegerForKey(const char* pKey, int defaultValue)
 {
-	const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
+	const char* value = getValueForKey(pKey);
 
 	int ret = defaultValue;
 
@@ -214,12 +247,6 @@ int UserDefault::getIntegerForKey(const char* pKey, int defaultValue)
 		ret = atoi(value);
 	}
 
-	if(doc)
-	{
-		delete doc;
-	}
-
-
 	return ret;
 }
 
@@ -242,16 +269,7 @@ double  UserDefault::getDoubleForKey(const char* pKey)
 
 double UserDefault::getDoubleForKey(const char* pKey, double defaultValue)
 {
-	const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
+	const char* value = getValueForKey(pKey);
 
 	double ret = defaultValue;
 
@@ -260,8 +278,6 @@ double UserDefault::getDoubleForKey(const char* pKey, double defaultValue)
 		ret = atof(value);
 	}
 
-    if (doc) delete doc;
-
 	return ret;
 }
 
@@ -272,16 +288,7 @@ std::string UserDefault::getStringForKey(const char* pKey)
 
 string UserDefault::getStringForKey(const char* pKey, const std::string & defaultValue)
 {
-    const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
+    const char* value = getValueForKey(pKey);
 
 	string ret = defaultValue;
 
@@ -290,8 +297,6 @@ string UserDefault::getStringForKey(const char* pKey, const std::string & defaul
 		ret = string(value);
 	}
 
-    if (doc) delete doc;
-
 	return ret;
 }
 
@@ -302,16 +307,7 @@ Data* UserDefault::getDataForKey(const char* pKey)
 
 Data* UserDefault::getDataForKey(const char* pKey, Data* defaultValue)
 {
-    const char* encodedData = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        encodedData = (const char*)(node->FirstChild()->Value());
-	}
+    const char* encodedData = getValueForKey(pKey);
     
 	Data* ret = defaultValue;
     
@@ -327,8 +323,6 @@ Data* UserDefault::getDataForKey(const char* pKey, Data* defaultValue)
         }
 	}
     
-    if (doc) delete doc;
-    
 	return ret;    
 }
 
@@ -413,17 +407,17 @@ void UserDefault::setDataForKey(const char* pKey, const Data& value) {
 
 UserDefault* UserDefault::getInstance()
 {
-    initXMLFilePath();
-
-    // only create xml file one time
-    // the file exists after the program exit
-    if ((! isXMLFileExist()) && (! createXMLFile()))
-    {
-        return NULL;
-    }
-
     if (! _userDefault)
     {
+        initXMLFilePath();
+
+        // only create xml file one time
+        // the file exists after the program exit
+        if ((! isXMLFileExist()) && (! createXMLFile()))
+        {
+            return NULL;
+        }
+
         _userDefault = new UserDefault();
     }
 
@@ -432,6 +426,16 @@ UserDefault* UserDefault::getInstance()
 
 void UserDefault::destroyInstance()
 {
+    if (_userDefault)
+    {
+        _userDefault->flush();
+    }
+    if (s_flusher)
+    {
+        s_flusher->cancel();
+        s_flusher->release();
+        s_flusher = NULL;
+    }
     _userDefault = NULL;
 }
 
@@ -508,6 +512,47 @@ const string& UserDefault::getXMLFilePath()
 
 void UserDefault::flush()
 {
+    if (! s_dirty)
+    {
+        return;
+    }
+
+    if (s_flusher)
+    {
+        s_flusher->cancel();
+    }
+
+    tinyxml2::XMLDocument doc;
+    doc.LinkEndChild(doc.NewDeclaration("1.0"));
+    tinyxml2::XMLElement* rootNode = doc.NewElement(USERDEFAULT_ROOT_NAME);
+    doc.LinkEndChild(rootNode);
+    for (const auto& value : s_values)
+    {
+        tinyxml2::XMLElement* node = doc.NewElement(value.first.c_str());
+        node->LinkEndChild(doc.NewText(value.second.c_str()));
+        rootNode->LinkEndChild(node);
+    }
+
+    // write a temporary file and rename it, so that the xml file is never left half written
+    string tmpPath = _filePath + ".tmp";
+    if (tinyxml2::XML_SUCCESS != doc.SaveFile(tmpPath.c_str()))
+    {
+        CCLOG("can not write xml file %s", tmpPath.c_str());
+        return;
+    }
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    bool replaced = MoveFileExA(tmpPath.c_str(), _filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool replaced = rename(tmpPath.c_str(), _filePath.c_str()) == 0;
+#endif
+    if (! replaced)
+    {
+        CCLOG("can not replace xml file %s", _filePath.c_str());
+        remove(tmpPath.c_str());
+        return;
+    }
+
+    s_dirty = false;
 }
 
 NS_CC_END
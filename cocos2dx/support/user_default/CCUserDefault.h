@@ -114,7 +114,9 @@ public:
      */
     void    setDataForKey(const char* pKey, const Data& value);
     /**
-     @brief Save content to xml file
+     @brief Save content to xml file.
+     The values are kept in memory: changes are saved a moment after they were made and when the application
+     goes to background, call it to save them at once.
      */
     void    flush();
 
@@ -28,8 +28,13 @@
 #include "ZipUtils.h"
 #include "ccMacros.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
 #include "unzip.h"
-#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 NS_CC_BEGIN
 
@@ -171,17 +176,21 @@ int ZipUtils::ccInflateMemoryWithHint(unsigned char *in, unsigned int inLength,
         // not enough memory ?
         if (err != Z_STREAM_END)
         {
-            delete [] *out;
-            *out = new unsigned char[bufferSize * BUFFER_INC_FACTOR];
+            unsigned char *tmp = new unsigned char[bufferSize * BUFFER_INC_FACTOR];
             
             /* not enough memory, ouch */
-            if (! *out )
+            if (! tmp )
             {
                 CCLOG("cocos2d: ZipUtils: realloc failed");
                 inflateEnd(&d_stream);
                 return Z_MEM_ERROR;
             }
             
+            // keep what was already inflated
+            memcpy(tmp, *out, bufferSize);
+            delete [] *out;
+            *out = tmp;
+            
             d_stream.next_out = *out + bufferSize;
             d_stream.avail_out = bufferSize;
             bufferSize *= BUFFER_INC_FACTOR;
@@ -238,14 +247,32 @@ int ZipUtils::ccInflateGZipFile(const char *path, unsigned char **out)
     CCASSERT(out, "");
     CCASSERT(&*out, "");
     
+    /* 512k initial decompress buffer */
+    unsigned int bufferSize = 512 * 1024;
+    
+    // the last 4 bytes of a gzip file are the inflated size (modulo 4G): one more byte makes the first read short,
+    // and ends the loop without growing the buffer
+    FILE *fp = fopen(path, "rb");
+    if (fp)
+    {
+        unsigned char trailer[4];
+        if (fseek(fp, -4, SEEK_END) == 0 && fread(trailer, 1, 4, fp) == 4)
+        {
+            unsigned int inflatedSize = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((unsigned int)trailer[3] << 24);
+            if (inflatedSize > 0 && inflatedSize < 0x40000000)
+            {
+                bufferSize = inflatedSize + 1;
+            }
+        }
+        fclose(fp);
+    }
+    
     gzFile inFile = gzopen(path, "rb");
     if( inFile == NULL ) {
         CCLOG("cocos2d: ZipUtils: error open gzip file: %s", path);
         return -1;
     }
     
-    /* 512k initial decompress buffer */
-    unsigned int bufferSize = 512 * 1024;
     unsigned int totalBufferSize = bufferSize;
     
     *out = (unsigned char*)malloc( bufferSize );
@@ -305,19 +332,34 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
     CCASSERT(out, "");
     CCASSERT(&*out, "");
     
-    // load file into memory
-    unsigned char* compressed = NULL;
+    // map the file, the data is inflated as it is read
+    MappedFile* compressed = FileUtils::getInstance()->getMappedFileData(path);
     
-    unsigned long fileLen = 0;
-    compressed = FileUtils::getInstance()->getFileData(path, "rb", &fileLen);
-    
-    if(NULL == compressed || 0 == fileLen)
+    if(NULL == compressed || 0 == compressed->getSize())
     {
         CCLOG("cocos2d: Error loading CCZ compressed file");
         return -1;
     }
     
-    struct CCZHeader *header = (struct CCZHeader*) compressed;
+    return ccInflateCCZBuffer(compressed->getBytes(), compressed->getSize(), out);
+}
+
+int ZipUtils::ccInflateCCZBuffer(const unsigned char *buffer, long bufferLen, unsigned char **out)
+{
+    CCASSERT(out, "");
+    CCASSERT(&*out, "");
+    
+    if (bufferLen < (long)sizeof(struct CCZHeader))
+    {
+        CCLOG("cocos2d: Invalid CCZ file");
+        return -1;
+    }
+    
+    const unsigned char* compressed = buffer;
+    // only the encrypted files are copied, to be decrypted
+    unsigned char* decrypted = NULL;
+    
+    const struct CCZHeader *header = (const struct CCZHeader*) compressed;
     
     // verify header
     if( header->sig[0] == 'C' && header->sig[1] == 'C' && header->sig[2] == 'Z' && header->sig[3] == '!' )
@@ -327,7 +369,6 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
         if( version > 2 )
         {
             CCLOG("cocos2d: Unsupported CCZ header format");
-            delete [] compressed;
             return -1;
         }
         
@@ -335,21 +376,18 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
         if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
         {
             CCLOG("cocos2d: CCZ Unsupported compression method");
-            delete [] compressed;
             return -1;
         }
     }
     else if( header->sig[0] == 'C' && header->sig[1] == 'C' && header->sig[2] == 'Z' && header->sig[3] == 'p' )
     {
         // encrypted ccz file
-        header = (struct CCZHeader*) compressed;
         
         // verify header version
         unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
         if( version > 0 )
         {
             CCLOG("cocos2d: Unsupported CCZ header format");
-            delete [] compressed;
             return -1;
         }
         
@@ -357,13 +395,17 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
         if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
         {
             CCLOG("cocos2d: CCZ Unsupported compression method");
-            delete [] compressed;
             return -1;
         }
         
+        decrypted = new unsigned char[bufferLen];
+        memcpy(decrypted, buffer, bufferLen);
+        compressed = decrypted;
+        header = (const struct CCZHeader*) compressed;
+        
         // decrypt
-        unsigned int* ints = (unsigned int*)(compressed+12);
-        int enclen = (fileLen-12)/4;
+        unsigned int* ints = (unsigned int*)(decrypted+12);
+        int enclen = (bufferLen-12)/4;
         
         ccDecodeEncodedPvr(ints, enclen);
                 
@@ -375,7 +417,7 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
         if(calculated != required)
         {
             CCLOG("cocos2d: Can't decrypt image file. Is the decryption key valid?");
-            delete [] compressed;
+            delete [] decrypted;
             return -1;
         }
 #endif
@@ -383,25 +425,25 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
     else
     {
         CCLOG("cocos2d: Invalid CCZ file");
-        delete [] compressed;
         return -1;
     }
     
+    // the header has the exact inflated size
     unsigned int len = CC_SWAP_INT32_BIG_TO_HOST( header->len );
     
     *out = (unsigned char*)malloc( len );
     if(! *out )
     {
         CCLOG("cocos2d: CCZ: Failed to allocate memory for texture");
-        delete [] compressed;
+        CC_SAFE_DELETE_ARRAY(decrypted);
         return -1;
     }
     
     unsigned long destlen = len;
-    unsigned long source = (unsigned long) compressed + sizeof(*header);
-    int ret = uncompress(*out, &destlen, (Bytef*)source, fileLen - sizeof(*header) );
+    const Bytef* source = compressed + sizeof(*header);
+    int ret = uncompress(*out, &destlen, source, bufferLen - sizeof(*header) );
     
-    delete [] compressed;
+    CC_SAFE_DELETE_ARRAY(decrypted);
     
     if( ret != Z_OK )
     {
@@ -414,6 +456,56 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
     return len;
 }
 
+void ZipUtils::ccInflateCCZFiles(const std::vector<std::string>& filenames, std::vector<unsigned char*>& out, std::vector<int>& outLengths, unsigned int threadCount)
+{
+    size_t count = filenames.size();
+    out.assign(count, NULL);
+    outLengths.assign(count, -1);
+    
+    // the files are mapped by the calling thread, FileUtils is not thread safe
+    std::vector<MappedFile*> files(count, NULL);
+    for (size_t i = 0; i < count; ++i)
+    {
+        files[i] = FileUtils::getInstance()->getMappedFileData(filenames[i].c_str());
+        if (! files[i])
+        {
+            CCLOG("cocos2d: Error loading CCZ compressed file %s", filenames[i].c_str());
+        }
+    }
+    
+    // the key is computed by the first decryption, don't let the threads compute it concurrently
+    ccDecodeEncodedPvr(NULL, 0);
+    
+    if (threadCount == 0)
+    {
+        threadCount = MAX((int)std::thread::hardware_concurrency(), 1);
+    }
+    threadCount = MIN(threadCount, (unsigned int)count);
+    
+    std::atomic<size_t> next(0);
+    auto inflateNextFiles = [&]() {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            if (files[i])
+            {
+                outLengths[i] = ccInflateCCZBuffer(files[i]->getBytes(), files[i]->getSize(), &out[i]);
+            }
+        }
+    };
+    
+    // the calling thread inflates files too
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < threadCount; ++i)
+    {
+        threads.push_back(std::thread(inflateNextFiles));
+    }
+    inflateNextFiles();
+    for (auto iter = threads.begin(); iter != threads.end(); ++iter)
+    {
+        iter->join();
+    }
+}
+
 void ZipUtils::ccSetPvrEncryptionKeyPart(int index, unsigned int value)
 {
     CCASSERT(index >= 0, "Cocos2d: key part index cannot be less than 0");
@@ -442,21 +534,29 @@ struct ZipEntryInfo
 {
     unz_file_pos pos;
     uLong uncompressed_size;
+    uLong compression_method;
+    uLong flag;
+    // offset of the data in the zip file, read from the local header the first time the entry is mapped
+    ZPOS64_T data_offset;
 };
 
 class ZipFilePrivate
 {
 public:
     unzFile zipFile;
+    std::string path;
     
-    // std::unordered_map is faster if available on the platform
-    typedef std::map<std::string, struct ZipEntryInfo> FileListContainer;
+    typedef std::unordered_map<std::string, struct ZipEntryInfo> FileListContainer;
     FileListContainer fileList;
+
+    // zipFile has a single read position, shared by the loader threads
+    std::mutex mutex;
 };
 
 ZipFile::ZipFile(const std::string &zipFile, const std::string &filter)
 : _data(new ZipFilePrivate)
 {
+    _data->path = zipFile;
     _data->zipFile = unzOpen(zipFile.c_str());
     setFilter(filter);
 }
@@ -479,6 +579,8 @@ bool ZipFile::setFilter(const std::string &filter)
         CC_BREAK_IF(!_data);
         CC_BREAK_IF(!_data->zipFile);
         
+        std::lock_guard<std::mutex> lock(_data->mutex);
+
         // clear existing file list
         _data->fileList.clear();
         
@@ -503,6 +605,9 @@ bool ZipFile::setFilter(const std::string &filter)
                     ZipEntryInfo entry;
                     entry.pos = posInfo;
                     entry.uncompressed_size = (uLong)fileInfo.uncompressed_size;
+                    entry.compression_method = fileInfo.compression_method;
+                    entry.flag = fileInfo.flag;
+                    entry.data_offset = 0;
                     _data->fileList[currentFileName] = entry;
                 }
             }
@@ -543,6 +648,8 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, unsigned long *
         CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
         
+        std::lock_guard<std::mutex> lock(_data->mutex);
+
         ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
         CC_BREAK_IF(it ==  _data->fileList.end());
         
@@ -568,4 +675,56 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, unsigned long *
     return pBuffer;
 }
 
+MappedFile *ZipFile::getMappedFileData(const std::string &fileName)
+{
+    do
+    {
+        CC_BREAK_IF(!_data->zipFile);
+        CC_BREAK_IF(fileName.empty());
+
+        ZPOS64_T offset = 0;
+        uLong size = 0;
+        {
+            std::lock_guard<std::mutex> lock(_data->mutex);
+
+            ZipFilePrivate::FileListContainer::iterator it = _data->fileList.find(fileName);
+            CC_BREAK_IF(it == _data->fileList.end());
+
+            ZipEntryInfo& fileInfo = it->second;
+            // only the entries stored without compression nor encryption are mapped, an empty entry can't be mapped
+            CC_BREAK_IF(fileInfo.compression_method != 0 || (fileInfo.flag & 1) || fileInfo.uncompressed_size == 0);
+
+            if (fileInfo.data_offset == 0)
+            {
+                CC_BREAK_IF(UNZ_OK != unzGoToFilePos(_data->zipFile, &fileInfo.pos));
+                CC_BREAK_IF(UNZ_OK != unzOpenCurrentFile(_data->zipFile));
+                fileInfo.data_offset = unzGetCurrentFileZStreamPos64(_data->zipFile);
+                unzCloseCurrentFile(_data->zipFile);
+            }
+            offset = fileInfo.data_offset;
+            size = fileInfo.uncompressed_size;
+        }
+
+        MappedFile* file = MappedFile::createWithFile(_data->path, (unsigned long)offset, size);
+        if (file)
+        {
+            return file;
+        }
+    } while (0);
+
+    unsigned long size = 0;
+    unsigned char* buffer = getFileData(fileName, &size);
+    return buffer ? MappedFile::createWithBuffer(buffer, size) : NULL;
+}
+
+const std::string& ZipFile::getPath() const
+{
+    return _data->path;
+}
+
+bool ZipFile::isOpen() const
+{
+    return _data->zipFile != NULL;
+}
+
 NS_CC_END
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #define __SUPPORT_ZIPUTILS_H__
 
 #include <string>
+#include <vector>
 #include "platform/CCPlatformConfig.h"
 #include "CCPlatformDefine.h"
 
@@ -80,6 +81,8 @@ namespace cocos2d
 
         /** inflates a GZip file into memory
         *
+        * The buffer is allocated with the inflated size stored at the end of the file.
+        *
         * @returns the length of the deflated buffer
         *
         * @since v0.99.5
@@ -94,6 +97,26 @@ namespace cocos2d
         */
         static int ccInflateCCZFile(const char *filename, unsigned char **out);
 
+        /** inflates a CCZ buffer into memory, allocated with the size given by the CCZ header.
+        * The inflated memory is expected to be freed by the caller with free().
+        *
+        * @returns the length of the deflated buffer, or -1 on error
+        *
+        * @since v3.0
+        */
+        static int ccInflateCCZBuffer(const unsigned char *buffer, long len, unsigned char **out);
+
+        /** inflates several CCZ files on threadCount threads, including the calling one.
+        * The files are inflated concurrently, in no particular order, and the function returns when all of them are.
+        * out[i] and outLengths[i] are the inflated memory and its length for filenames[i], NULL and -1 on error.
+        * The inflated memory is expected to be freed by the caller with free().
+        *
+        * @param threadCount number of threads, the number of cores if 0
+        *
+        * @since v3.0
+        */
+        static void ccInflateCCZFiles(const std::vector<std::string>& filenames, std::vector<unsigned char*>& out, std::vector<int>& outLengths, unsigned int threadCount = 0);
+
         /** Sets the pvr.ccz encryption key parts separately for added
         * security.
         *
@@ -159,6 +182,7 @@ namespace cocos2d
 
     // forward declaration
     class ZipFilePrivate;
+    class MappedFile;
 
     /**
     * Zip file - reader helper class.
@@ -215,6 +239,22 @@ namespace cocos2d
         */
         unsigned char *getFileData(const std::string &fileName, unsigned long *pSize);
 
+        /**
+        * Get a read-only view of resource file data from a zip file.
+        * The entries stored without compression are mapped in memory, the others are inflated into a buffer.
+        * @param fileName File name
+        * @return Upon success, an autoreleased MappedFile, otherwise NULL.
+        *
+        * @since v3.0
+        */
+        MappedFile *getMappedFileData(const std::string &fileName);
+
+        /** Returns the path of the zip file */
+        const std::string& getPath() const;
+
+        /** Whether or not the zip file was opened */
+        bool isOpen() const;
+
     private:
         /** Internal data like zip file pointer / file list array and so on */
         ZipFilePrivate *_data;
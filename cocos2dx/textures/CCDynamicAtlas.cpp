@@ -0,0 +1,454 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "textures/CCDynamicAtlas.h"
+#include "textures/CCTexture2D.h"
+#include "textures/CCTextureCache.h"
+#include "sprite_nodes/CCSpriteFrame.h"
+#include "platform/CCImage.h"
+#include "platform/CCFileUtils.h"
+#include "shaders/ccGLStateCache.h"
+#include "ccMacros.h"
+#include <algorithm>
+#include <climits>
+#include <cctype>
+#include <string.h>
+
+NS_CC_BEGIN
+
+static Image::Format formatForFilename(const std::string& filename)
+{
+    std::string lowerCase(filename);
+    std::transform(lowerCase.begin(), lowerCase.end(), lowerCase.begin(), ::tolower);
+
+    if (std::string::npos != lowerCase.find(".png"))
+    {
+        return Image::Format::PNG;
+    }
+    if (std::string::npos != lowerCase.find(".jpg") || std::string::npos != lowerCase.find(".jpeg"))
+    {
+        return Image::Format::JPG;
+    }
+    if (std::string::npos != lowerCase.find(".tif"))
+    {
+        return Image::Format::TIFF;
+    }
+    if (std::string::npos != lowerCase.find(".webp"))
+    {
+        return Image::Format::WEBP;
+    }
+    return Image::Format::UNKOWN;
+}
+
+DynamicAtlas* DynamicAtlas::create(int pageSize, int padding)
+{
+    DynamicAtlas* atlas = new DynamicAtlas();
+    if (atlas->init(pageSize, padding))
+    {
+        atlas->autorelease();
+        return atlas;
+    }
+    CC_SAFE_DELETE(atlas);
+    return NULL;
+}
+
+DynamicAtlas::DynamicAtlas()
+: _pageSize(0)
+, _padding(0)
+{
+}
+
+DynamicAtlas::~DynamicAtlas()
+{
+    for (auto& entry : _entries)
+    {
+        entry.second.frame->release();
+    }
+
+    for (auto& page : _pages)
+    {
+        page.texture->release();
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+        delete [] page.data;
+#endif
+    }
+}
+
+bool DynamicAtlas::init(int pageSize, int padding)
+{
+    CCASSERT(pageSize > 0 && padding >= 0, "Invalid atlas size");
+
+    _pageSize = pageSize;
+    _padding = padding;
+    return true;
+}
+
+bool DynamicAtlas::addPage()
+{
+    // the pages are cleared, so the padding around the images stays transparent
+    unsigned char* data = new unsigned char[_pageSize * _pageSize * 4];
+    memset(data, 0, _pageSize * _pageSize * 4);
+
+    // the pixels of the images are premultiplied, so is the texture
+    Image* image = new Image();
+    Texture2D* texture = new Texture2D();
+    bool ok = image->initWithRawData(data, _pageSize * _pageSize * 4, _pageSize, _pageSize, 8, true)
+        && texture->initWithImage(image);
+    image->release();
+
+    if (! ok)
+    {
+        CCLOG("cocos2d: DynamicAtlas: can't create a page of %d x %d", _pageSize, _pageSize);
+        texture->release();
+        delete [] data;
+        return false;
+    }
+
+    Page page;
+    page.texture = texture;
+    page.usedArea = 0;
+    Slot all = { 0, 0, _pageSize, _pageSize };
+    page.freeSlots.push_back(all);
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    page.data = data;
+    VolatileTexture::addDataTexture(texture, data, Texture2D::PixelFormat::RGBA8888, texture->getContentSizeInPixels());
+#else
+    delete [] data;
+#endif
+    _pages.push_back(page);
+    return true;
+}
+
+bool DynamicAtlas::allocate(const Page& page, int width, int height, Slot& slot, int& score) const
+{
+    // best short side fit: the free rectangle that leaves the smallest margin on one side
+    bool found = false;
+    int bestLongSide = INT_MAX;
+
+    for (const auto& free : page.freeSlots)
+    {
+        if (free.width < width || free.height < height)
+        {
+            continue;
+        }
+
+        int leftoverX = free.width - width;
+        int leftoverY = free.height - height;
+        int shortSide = std::min(leftoverX, leftoverY);
+        int longSide = std::max(leftoverX, leftoverY);
+
+        if (shortSide < score || (shortSide == score && longSide < bestLongSide))
+        {
+            slot.x = free.x;
+            slot.y = free.y;
+            slot.width = width;
+            slot.height = height;
+            score = shortSide;
+            bestLongSide = longSide;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+void DynamicAtlas::splitFreeSlots(Page& page, const Slot& used)
+{
+    std::vector<Slot> slots;
+    slots.reserve(page.freeSlots.size() + 4);
+
+    for (const auto& free : page.freeSlots)
+    {
+        if (used.x >= free.x + free.width || used.x + used.width <= free.x ||
+            used.y >= free.y + free.height || used.y + used.height <= free.y)
+        {
+            slots.push_back(free);
+            continue;
+        }
+
+        // the parts of the free rectangle on each side of the used one, they overlap
+        if (used.x > free.x)
+        {
+            Slot left = { free.x, free.y, used.x - free.x, free.height };
+            slots.push_back(left);
+        }
+        if (used.x + used.width < free.x + free.width)
+        {
+            Slot right = { used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height };
+            slots.push_back(right);
+        }
+        if (used.y > free.y)
+        {
+            Slot bottom = { free.x, free.y, free.width, used.y - free.y };
+            slots.push_back(bottom);
+        }
+        if (used.y + used.height < free.y + free.height)
+        {
+            Slot top = { free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height };
+            slots.push_back(top);
+        }
+    }
+
+    page.freeSlots.swap(slots);
+    pruneFreeSlots(page);
+}
+
+void DynamicAtlas::pruneFreeSlots(Page& page)
+{
+    // removes the free rectangles contained in another one
+    auto& slots = page.freeSlots;
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        for (size_t j = i + 1; j < slots.size(); ++j)
+        {
+            const Slot& a = slots[i];
+            const Slot& b = slots[j];
+            if (a.x >= b.x && a.y >= b.y && a.x + a.width <= b.x + b.width && a.y + a.height <= b.y + b.height)
+            {
+                slots.erase(slots.begin() + i);
+                --i;
+                break;
+            }
+            if (b.x >= a.x && b.y >= a.y && b.x + b.width <= a.x + a.width && b.y + b.height <= a.y + a.height)
+            {
+                slots.erase(slots.begin() + j);
+                --j;
+            }
+        }
+    }
+}
+
+void DynamicAtlas::upload(Page& page, const Slot& slot, const unsigned char* pixels)
+{
+    GL::bindTexture2D(page.texture->getName());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, slot.x, slot.y, slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    CHECK_GL_ERROR_DEBUG();
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    for (int row = 0; row < slot.height; ++row)
+    {
+        memcpy(page.data + ((slot.y + row) * _pageSize + slot.x) * 4, pixels + row * slot.width * 4, slot.width * 4);
+    }
+#endif
+}
+
+SpriteFrame* DynamicAtlas::addImage(Image* image, const std::string& key)
+{
+    auto found = _entries.find(key);
+    if (found != _entries.end())
+    {
+        return found->second.frame;
+    }
+
+    CCASSERT(image && image->getData(), "Invalid image");
+
+    int width = image->getWidth();
+    int height = image->getHeight();
+    // the padding is on the right and on the top of the images, the edges of the page are clamped
+    int slotWidth = width + _padding;
+    int slotHeight = height + _padding;
+    if (slotWidth > _pageSize || slotHeight > _pageSize)
+    {
+        CCLOG("cocos2d: DynamicAtlas: image %s (%d x %d) is bigger than a page", key.c_str(), width, height);
+        return NULL;
+    }
+
+    Slot slot;
+    int page = -1;
+    int score = INT_MAX;
+    for (int i = 0; i < static_cast<int>(_pages.size()); ++i)
+    {
+        if (allocate(_pages[i], slotWidth, slotHeight, slot, score))
+        {
+            page = i;
+        }
+    }
+
+    if (page < 0)
+    {
+        if (! addPage())
+        {
+            return NULL;
+        }
+        page = static_cast<int>(_pages.size()) - 1;
+        score = INT_MAX;
+        allocate(_pages[page], slotWidth, slotHeight, slot, score);
+    }
+
+    // RGBA8888 with premultiplied alpha, the padding cleared as it can hold the pixels of a removed image
+    std::vector<unsigned char> pixels(slotWidth * slotHeight * 4, 0);
+    const unsigned char* src = image->getData();
+    bool hasAlpha = image->hasAlpha();
+    bool premultiply = hasAlpha && ! image->isPremultipliedAlpha();
+    for (int y = 0; y < height; ++y)
+    {
+        unsigned char* dst = &pixels[y * slotWidth * 4];
+        for (int x = 0; x < width; ++x, dst += 4)
+        {
+            if (hasAlpha)
+            {
+                unsigned int alpha = src[3];
+                if (premultiply)
+                {
+                    dst[0] = static_cast<unsigned char>(src[0] * alpha / 255);
+                    dst[1] = static_cast<unsigned char>(src[1] * alpha / 255);
+                    dst[2] = static_cast<unsigned char>(src[2] * alpha / 255);
+                }
+                else
+                {
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                }
+                dst[3] = static_cast<unsigned char>(alpha);
+                src += 4;
+            }
+            else
+            {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = 255;
+                src += 3;
+            }
+        }
+    }
+
+    Page& target = _pages[page];
+    upload(target, slot, &pixels[0]);
+    splitFreeSlots(target, slot);
+    target.usedArea += slotWidth * slotHeight;
+
+    Rect rect(slot.x, slot.y, width, height);
+    SpriteFrame* frame = SpriteFrame::createWithTexture(target.texture, rect, false, Point::ZERO, rect.size);
+    frame->retain();
+
+    Entry entry;
+    entry.frame = frame;
+    entry.page = page;
+    entry.slot = slot;
+    _entries[key] = entry;
+
+    return frame;
+}
+
+SpriteFrame* DynamicAtlas::addImage(const std::string& filename)
+{
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename.c_str());
+    auto found = _entries.find(fullpath);
+    if (found != _entries.end())
+    {
+        return found->second.frame;
+    }
+
+    Image* image = new Image();
+    SpriteFrame* frame = NULL;
+    if (image->initWithImageFile(fullpath.c_str(), formatForFilename(fullpath)))
+    {
+        frame = addImage(image, fullpath);
+    }
+    else
+    {
+        CCLOG("cocos2d: DynamicAtlas: can't load %s", filename.c_str());
+    }
+    image->release();
+
+    return frame;
+}
+
+SpriteFrame* DynamicAtlas::getSpriteFrame(const std::string& key) const
+{
+    auto found = _entries.find(key);
+    return found != _entries.end() ? found->second.frame : NULL;
+}
+
+void DynamicAtlas::removeSpriteFrame(const std::string& key)
+{
+    auto found = _entries.find(key);
+    if (found == _entries.end())
+    {
+        return;
+    }
+
+    Entry& entry = found->second;
+    Page& page = _pages[entry.page];
+    page.usedArea -= entry.slot.width * entry.slot.height;
+    page.freeSlots.push_back(entry.slot);
+    if (page.usedArea == 0)
+    {
+        // the freed rectangles aren't merged: start again from the whole page
+        page.freeSlots.clear();
+        Slot all = { 0, 0, _pageSize, _pageSize };
+        page.freeSlots.push_back(all);
+    }
+    else
+    {
+        pruneFreeSlots(page);
+    }
+
+    entry.frame->release();
+    _entries.erase(found);
+}
+
+void DynamicAtlas::removeAllSpriteFrames()
+{
+    for (auto& entry : _entries)
+    {
+        entry.second.frame->release();
+    }
+    _entries.clear();
+
+    for (auto& page : _pages)
+    {
+        page.usedArea = 0;
+        page.freeSlots.clear();
+        Slot all = { 0, 0, _pageSize, _pageSize };
+        page.freeSlots.push_back(all);
+    }
+}
+
+Texture2D* DynamicAtlas::getPageTexture(int index) const
+{
+    CCASSERT(index >= 0 && index < static_cast<int>(_pages.size()), "Invalid page index");
+    return _pages[index].texture;
+}
+
+float DynamicAtlas::getOccupancy() const
+{
+    if (_pages.empty())
+    {
+        return 0.0f;
+    }
+
+    long long used = 0;
+    for (const auto& page : _pages)
+    {
+        used += page.usedArea;
+    }
+    return static_cast<float>(used) / (static_cast<float>(_pageSize) * _pageSize * _pages.size());
+}
+
+NS_CC_END
@@ -0,0 +1,139 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCDYNAMICATLAS_H__
+#define __CCDYNAMICATLAS_H__
+
+#include "ccConfig.h"
+#include "cocoa/CCObject.h"
+#include "cocoa/CCGeometry.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+NS_CC_BEGIN
+
+class Image;
+class Texture2D;
+class SpriteFrame;
+
+/**
+ * @addtogroup textures
+ * @{
+ */
+
+/** @brief DynamicAtlas packs the images loaded at runtime into a few big textures, so the sprites that show
+ them can be batched: the avatars downloaded with HttpClient, the thumbnails saved from a RenderTexture or the
+ images that aren't in a sprite sheet.
+
+ The images are copied with glTexSubImage2D into RGBA8888 pages of CC_DYNAMIC_ATLAS_PAGE_SIZE pixels, where
+ their rectangles are allocated with the MaxRects algorithm (best short side fit). A new page is added when no
+ page has room for an image. Each image is returned as a SpriteFrame of its page, with premultiplied alpha.
+
+ Removing an image frees its rectangle for the images added later, its SpriteFrame stays valid but its pixels
+ can be overwritten: remove the images that are no longer displayed.
+
+ @since v3.0
+ */
+class CC_DLL DynamicAtlas : public Object
+{
+public:
+    /** Creates an atlas of pages of pageSize x pageSize pixels, with padding transparent pixels around the images */
+    static DynamicAtlas* create(int pageSize = CC_DYNAMIC_ATLAS_PAGE_SIZE, int padding = 1);
+
+    DynamicAtlas();
+    virtual ~DynamicAtlas();
+
+    bool init(int pageSize, int padding);
+
+    /** Copies an image into the atlas and returns its frame, or the frame already added with this key.
+     Returns NULL when the image is bigger than a page.
+     */
+    SpriteFrame* addImage(Image* image, const std::string& key);
+
+    /** Loads an image file into the atlas, with its path as key */
+    SpriteFrame* addImage(const std::string& filename);
+
+    /** Returns the frame of an image, or NULL */
+    SpriteFrame* getSpriteFrame(const std::string& key) const;
+
+    /** Frees the rectangle of an image */
+    void removeSpriteFrame(const std::string& key);
+
+    /** Frees all the rectangles. The pages are kept */
+    void removeAllSpriteFrames();
+
+    int getPageCount() const { return static_cast<int>(_pages.size()); }
+    Texture2D* getPageTexture(int index) const;
+
+    /** Fraction of the pixels of the pages allocated to images */
+    float getOccupancy() const;
+
+protected:
+    struct Slot
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    struct Page
+    {
+        Texture2D* texture;
+        // rectangles not allocated yet, they can overlap
+        std::vector<Slot> freeSlots;
+        int usedArea;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+        // copy of the pixels, to recreate the texture when the context is lost
+        unsigned char* data;
+#endif
+    };
+
+    struct Entry
+    {
+        SpriteFrame* frame;
+        int page;
+        Slot slot;
+    };
+
+    bool addPage();
+    bool allocate(const Page& page, int width, int height, Slot& slot, int& score) const;
+    void splitFreeSlots(Page& page, const Slot& used);
+    void pruneFreeSlots(Page& page);
+    void upload(Page& page, const Slot& slot, const unsigned char* pixels);
+
+    int _pageSize;
+    int _padding;
+    std::vector<Page> _pages;
+    std::unordered_map<std::string, Entry> _entries;
+};
+
+// end of textures group
+/// @}
+
+NS_CC_END
+
+#endif // __CCDYNAMICATLAS_H__
@@ -37,16 +37,26 @@ THE SOFTWARE.
 #include "platform/CCImage.h"
 #include "CCGL.h"
 #include "support/ccUtils.h"
+#include "support/CCAssetLoadProfiler.h"
 #include "platform/CCPlatformMacros.h"
 #include "textures/CCTexturePVR.h"
 #include "textures/CCTextureETC.h"
+#include "textures/CCTextureKTX.h"
 #include "CCDirector.h"
 #include "shaders/CCGLProgram.h"
 #include "shaders/ccGLStateCache.h"
 #include "shaders/CCShaderCache.h"
+#include "textures/CCTextureCache.h"
 
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    #include "CCTextureCache.h"
+#include <vector>
+
+// SIMD pixel format converters
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CC_TEXTURE2D_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define CC_TEXTURE2D_USE_NEON 1
+#include <arm_neon.h>
 #endif
 
 NS_CC_BEGIN
@@ -57,18 +67,290 @@ NS_CC_BEGIN
 // Default is: RGBA8888 (32-bit textures)
 static Texture2D::PixelFormat g_defaultAlphaPixelFormat = Texture2D::PixelFormat::DEFAULT;
 
+//
+// Pixel format conversions (from RGBA8888 or RGB888)
+//
+// The converters use SSE2 or NEON when they are available, and write into a scratch buffer
+// that is kept between conversions, instead of allocating a buffer for each texture.
+//
+
+static bool g_ditheringEnabled = false;
+static std::vector<unsigned char> g_conversionBuffer;
+
+static unsigned char* getConversionBuffer(size_t size)
+{
+    if (g_conversionBuffer.size() < size)
+    {
+        g_conversionBuffer.resize(size);
+    }
+    return &g_conversionBuffer[0];
+}
+
+// 4x4 ordered dithering matrix, values in [0, 16)
+static const unsigned char s_bayerMatrix[4][4] =
+{
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+// adds a threshold to a channel before it is truncated to "bits" bits
+static inline unsigned int ditherChannel(unsigned int value, unsigned int bits, unsigned int threshold)
+{
+    value += (threshold << (8 - bits)) >> 4;
+    return value > 255 ? 255 : value;
+}
+
+static void convertRGBA8888ToRGB565(const unsigned char* in, unsigned short* out, unsigned int length)
+{
+    unsigned int i = 0;
+#if CC_TEXTURE2D_USE_SSE2
+    const __m128i maskR = _mm_set1_epi32(0xF8);
+    const __m128i maskG = _mm_set1_epi32(0xFC00);
+    const __m128i maskB = _mm_set1_epi32(0xF80000);
+    for (; i + 8 <= length; i += 8)
+    {
+        __m128i p0 = _mm_loadu_si128((const __m128i*)(in + i * 4));
+        __m128i p1 = _mm_loadu_si128((const __m128i*)(in + i * 4 + 16));
+        __m128i o0 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p0, maskR), 8),
+                                               _mm_srli_epi32(_mm_and_si128(p0, maskG), 5)),
+                                  _mm_srli_epi32(_mm_and_si128(p0, maskB), 19));
+        __m128i o1 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p1, maskR), 8),
+                                               _mm_srli_epi32(_mm_and_si128(p1, maskG), 5)),
+                                  _mm_srli_epi32(_mm_and_si128(p1, maskB), 19));
+        // sign extend the 16 bits values so that the saturated pack keeps them unchanged
+        o0 = _mm_srai_epi32(_mm_slli_epi32(o0, 16), 16);
+        o1 = _mm_srai_epi32(_mm_slli_epi32(o1, 16), 16);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(o0, o1));
+    }
+#elif CC_TEXTURE2D_USE_NEON
+    for (; i + 8 <= length; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(in + i * 4);
+        uint16x8_t o = vshll_n_u8(vand_u8(p.val[0], vdup_n_u8(0xF8)), 8);
+        o = vorrq_u16(o, vshll_n_u8(vand_u8(p.val[1], vdup_n_u8(0xFC)), 3));
+        o = vorrq_u16(o, vmovl_u8(vshr_n_u8(p.val[2], 3)));
+        vst1q_u16(out + i, o);
+    }
+#endif
+    in += i * 4;
+    for (; i < length; ++i, in += 4)
+    {
+        out[i] = ((in[0] >> 3) << 11) | ((in[1] >> 2) << 5) | (in[2] >> 3);
+    }
+}
+
+static void convertRGB888ToRGB565(const unsigned char* in, unsigned short* out, unsigned int length)
+{
+    unsigned int i = 0;
+#if CC_TEXTURE2D_USE_NEON
+    for (; i + 8 <= length; i += 8)
+    {
+        uint8x8x3_t p = vld3_u8(in + i * 3);
+        uint16x8_t o = vshll_n_u8(vand_u8(p.val[0], vdup_n_u8(0xF8)), 8);
+        o = vorrq_u16(o, vshll_n_u8(vand_u8(p.val[1], vdup_n_u8(0xFC)), 3));
+        o = vorrq_u16(o, vmovl_u8(vshr_n_u8(p.val[2], 3)));
+        vst1q_u16(out + i, o);
+    }
+#endif
+    in += i * 3;
+    for (; i < length; ++i, in += 3)
+    {
+        out[i] = ((in[0] >> 3) << 11) | ((in[1] >> 2) << 5) | (in[2] >> 3);
+    }
+}
+
+static void convertRGBA8888ToRGBA4444(const unsigned char* in, unsigned short* out, unsigned int length)
+{
+    unsigned int i = 0;
+#if CC_TEXTURE2D_USE_SSE2
+    const __m128i maskR = _mm_set1_epi32(0xF0);
+    const __m128i maskG = _mm_set1_epi32(0xF000);
+    const __m128i maskB = _mm_set1_epi32(0xF00000);
+    for (; i + 8 <= length; i += 8)
+    {
+        __m128i p0 = _mm_loadu_si128((const __m128i*)(in + i * 4));
+        __m128i p1 = _mm_loadu_si128((const __m128i*)(in + i * 4 + 16));
+        __m128i o0 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p0, maskR), 8),
+                                               _mm_srli_epi32(_mm_and_si128(p0, maskG), 4)),
+                                  _mm_or_si128(_mm_srli_epi32(_mm_and_si128(p0, maskB), 16),
+                                               _mm_srli_epi32(p0, 28)));
+        __m128i o1 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p1, maskR), 8),
+                                               _mm_srli_epi32(_mm_and_si128(p1, maskG), 4)),
+                                  _mm_or_si128(_mm_srli_epi32(_mm_and_si128(p1, maskB), 16),
+                                               _mm_srli_epi32(p1, 28)));
+        o0 = _mm_srai_epi32(_mm_slli_epi32(o0, 16), 16);
+        o1 = _mm_srai_epi32(_mm_slli_epi32(o1, 16), 16);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(o0, o1));
+    }
+#elif CC_TEXTURE2D_USE_NEON
+    for (; i + 8 <= length; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(in + i * 4);
+        uint16x8_t o = vshll_n_u8(vand_u8(p.val[0], vdup_n_u8(0xF0)), 8);
+        o = vorrq_u16(o, vshll_n_u8(vand_u8(p.val[1], vdup_n_u8(0xF0)), 4));
+        o = vorrq_u16(o, vmovl_u8(vand_u8(p.val[2], vdup_n_u8(0xF0))));
+        o = vorrq_u16(o, vmovl_u8(vshr_n_u8(p.val[3], 4)));
+        vst1q_u16(out + i, o);
+    }
+#endif
+    in += i * 4;
+    for (; i < length; ++i, in += 4)
+    {
+        out[i] = ((in[0] >> 4) << 12) | ((in[1] >> 4) << 8) | ((in[2] >> 4) << 4) | (in[3] >> 4);
+    }
+}
+
+static void convertRGBA8888ToRGB5A1(const unsigned char* in, unsigned short* out, unsigned int length)
+{
+    unsigned int i = 0;
+#if CC_TEXTURE2D_USE_SSE2
+    const __m128i maskR = _mm_set1_epi32(0xF8);
+    const __m128i maskG = _mm_set1_epi32(0xF800);
+    const __m128i maskB = _mm_set1_epi32(0xF80000);
+    for (; i + 8 <= length; i += 8)
+    {
+        __m128i p0 = _mm_loadu_si128((const __m128i*)(in + i * 4));
+        __m128i p1 = _mm_loadu_si128((const __m128i*)(in + i * 4 + 16));
+        __m128i o0 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p0, maskR), 8),
+                                               _mm_srli_epi32(_mm_and_si128(p0, maskG), 5)),
+                                  _mm_or_si128(_mm_srli_epi32(_mm_and_si128(p0, maskB), 18),
+                                               _mm_srli_epi32(p0, 31)));
+        __m128i o1 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p1, maskR), 8),
+                                               _mm_srli_epi32(_mm_and_si128(p1, maskG), 5)),
+                                  _mm_or_si128(_mm_srli_epi32(_mm_and_si128(p1, maskB), 18),
+                                               _mm_srli_epi32(p1, 31)));
+        o0 = _mm_srai_epi32(_mm_slli_epi32(o0, 16), 16);
+        o1 = _mm_srai_epi32(_mm_slli_epi32(o1, 16), 16);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(o0, o1));
+    }
+#elif CC_TEXTURE2D_USE_NEON
+    for (; i + 8 <= length; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(in + i * 4);
+        uint16x8_t o = vshll_n_u8(vand_u8(p.val[0], vdup_n_u8(0xF8)), 8);
+        o = vorrq_u16(o, vshll_n_u8(vand_u8(p.val[1], vdup_n_u8(0xF8)), 3));
+        o = vorrq_u16(o, vshlq_n_u16(vmovl_u8(vshr_n_u8(p.val[2], 3)), 1));
+        o = vorrq_u16(o, vmovl_u8(vshr_n_u8(p.val[3], 7)));
+        vst1q_u16(out + i, o);
+    }
+#endif
+    in += i * 4;
+    for (; i < length; ++i, in += 4)
+    {
+        out[i] = ((in[0] >> 3) << 11) | ((in[1] >> 3) << 6) | ((in[2] >> 3) << 1) | (in[3] >> 7);
+    }
+}
+
+static void convertRGBA8888ToA8(const unsigned char* in, unsigned char* out, unsigned int length)
+{
+    unsigned int i = 0;
+#if CC_TEXTURE2D_USE_SSE2
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i a0 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(in + i * 4)), 24);
+        __m128i a1 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(in + i * 4 + 16)), 24);
+        __m128i a2 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(in + i * 4 + 32)), 24);
+        __m128i a3 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(in + i * 4 + 48)), 24);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3)));
+    }
+#elif CC_TEXTURE2D_USE_NEON
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16x4_t p = vld4q_u8(in + i * 4);
+        vst1q_u8(out + i, p.val[3]);
+    }
+#endif
+    for (; i < length; ++i)
+    {
+        out[i] = in[i * 4 + 3];
+    }
+}
+
+static void convertRGBA8888ToRGB888(const unsigned char* in, unsigned char* out, unsigned int length)
+{
+    unsigned int i = 0;
+#if CC_TEXTURE2D_USE_NEON
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16x4_t p = vld4q_u8(in + i * 4);
+        uint8x16x3_t o = { { p.val[0], p.val[1], p.val[2] } };
+        vst3q_u8(out + i * 3, o);
+    }
+#endif
+    for (; i < length; ++i)
+    {
+        out[i * 3 + 0] = in[i * 4 + 0];
+        out[i * 3 + 1] = in[i * 4 + 1];
+        out[i * 3 + 2] = in[i * 4 + 2];
+    }
+}
+
+// dithered conversions to 16-bit formats, "bytesPerPixel" is 3 (RGB888) or 4 (RGBA8888)
+static void convertToRGB565Dithered(const unsigned char* in, unsigned int bytesPerPixel, unsigned short* out, unsigned int width, unsigned int height)
+{
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        for (unsigned int x = 0; x < width; ++x, in += bytesPerPixel)
+        {
+            unsigned int t = s_bayerMatrix[y & 3][x & 3];
+            *out++ = ((ditherChannel(in[0], 5, t) >> 3) << 11)
+                   | ((ditherChannel(in[1], 6, t) >> 2) << 5)
+                   | (ditherChannel(in[2], 5, t) >> 3);
+        }
+    }
+}
+
+static void convertRGBA8888ToRGBA4444Dithered(const unsigned char* in, unsigned short* out, unsigned int width, unsigned int height)
+{
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        for (unsigned int x = 0; x < width; ++x, in += 4)
+        {
+            unsigned int t = s_bayerMatrix[y & 3][x & 3];
+            *out++ = ((ditherChannel(in[0], 4, t) >> 4) << 12)
+                   | ((ditherChannel(in[1], 4, t) >> 4) << 8)
+                   | ((ditherChannel(in[2], 4, t) >> 4) << 4)
+                   | (ditherChannel(in[3], 4, t) >> 4);
+        }
+    }
+}
+
+static void convertRGBA8888ToRGB5A1Dithered(const unsigned char* in, unsigned short* out, unsigned int width, unsigned int height)
+{
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        for (unsigned int x = 0; x < width; ++x, in += 4)
+        {
+            unsigned int t = s_bayerMatrix[y & 3][x & 3];
+            *out++ = ((ditherChannel(in[0], 5, t) >> 3) << 11)
+                   | ((ditherChannel(in[1], 5, t) >> 3) << 6)
+                   | ((ditherChannel(in[2], 5, t) >> 3) << 1)
+                   | (in[3] >> 7);
+        }
+    }
+}
+
 static bool _PVRHaveAlphaPremultiplied = false;
 
 Texture2D::Texture2D()
 : _pixelFormat(Texture2D::PixelFormat::DEFAULT)
 , _pixelsWide(0)
 , _pixelsHigh(0)
+, _downscale(0)
 , _name(0)
 , _maxS(0.0)
 , _maxT(0.0)
 , _hasPremultipliedAlpha(false)
 , _hasMipmaps(false)
+, _maxAnisotropy(1)
 , _shaderProgram(NULL)
+, _alphaTexture(NULL)
+, _pinned(false)
+, _lastAccess(0)
+, _hibernation(nullptr)
+, _streamedPVR(nullptr)
 {
 }
 
@@ -80,6 +362,9 @@ Texture2D::~Texture2D()
 
     CCLOGINFO("cocos2d: deallocing Texture2D %u.", _name);
     CC_SAFE_RELEASE(_shaderProgram);
+    CC_SAFE_RELEASE(_alphaTexture);
+    CC_SAFE_DELETE(_hibernation);
+    CC_SAFE_RELEASE(_streamedPVR);
 
     if(_name)
     {
@@ -94,16 +379,21 @@ Texture2D::PixelFormat Texture2D::getPixelFormat() const
 
 unsigned int Texture2D::getPixelsWide() const
 {
-    return _pixelsWide;
+    return _pixelsWide << _downscale;
 }
 
 unsigned int Texture2D::getPixelsHigh() const
 {
-    return _pixelsHigh;
+    return _pixelsHigh << _downscale;
 }
 
 GLuint Texture2D::getName() const
 {
+    if (_hibernation)
+    {
+        // used before it was woken up, e.g. by a scene sharing the texture with a hibernated one
+        TextureCache::getInstance()->wakeTexture(const_cast<Texture2D*>(this));
+    }
     return _name;
 }
 
@@ -184,6 +474,8 @@ bool Texture2D::initWithData(const void *data, Texture2D::PixelFormat pixelForma
     }
 
     unsigned int bytesPerRow = pixelsWide * bitsPerPixel / 8;
+    CC_PROFILE_ASSET_STAGE(stage, UPLOAD, NULL);
+    CC_PROFILE_ASSET_BYTES(stage, bytesPerRow * pixelsHigh);
 
     if(bytesPerRow % 8 == 0)
     {
@@ -203,7 +495,11 @@ bool Texture2D::initWithData(const void *data, Texture2D::PixelFormat pixelForma
     }
 
 
-    glGenTextures(1, &_name);
+    // a texture initialized again keeps its name, so the framebuffers it is attached to stay valid
+    if (_name == 0)
+    {
+        glGenTextures(1, &_name);
+    }
     GL::bindTexture2D(_name);
 
     glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
@@ -247,12 +543,14 @@ bool Texture2D::initWithData(const void *data, Texture2D::PixelFormat pixelForma
     _contentSize = contentSize;
     _pixelsWide = pixelsWide;
     _pixelsHigh = pixelsHigh;
+    _downscale = 0;
     _pixelFormat = pixelFormat;
     _maxS = contentSize.width / (float)(pixelsWide);
     _maxT = contentSize.height / (float)(pixelsHigh);
 
     _hasPremultipliedAlpha = false;
     _hasMipmaps = false;
+    _maxAnisotropy = 1;
 
     setShaderProgram(ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE));
 
@@ -293,13 +591,30 @@ bool Texture2D::initWithImage(Image *uiImage)
 
 bool Texture2D::initPremultipliedATextureWithImage(Image *image, unsigned int width, unsigned int height)
 {
-    unsigned char*            tempData = image->getData();
-    unsigned int*             inPixel32  = NULL;
-    unsigned char*            inPixel8 = NULL;
-    unsigned short*           outPixel16 = NULL;
-    bool                      hasAlpha = image->hasAlpha();
     Size                    imageSize = Size((float)(image->getWidth()), (float)(image->getHeight()));
     Texture2D::PixelFormat    pixelFormat;
+    const unsigned char*      tempData = NULL;
+    {
+        CC_PROFILE_ASSET_STAGE(stage, CONVERT, NULL);
+        tempData = convertImageData(image, pixelFormat);
+    }
+
+    initWithData(tempData, pixelFormat, width, height, imageSize);
+
+    // a downscaled image keeps the size of its file, the sprite frames don't change
+    _downscale = image->getDownscale();
+    _contentSize = Size(imageSize.width * (1 << _downscale), imageSize.height * (1 << _downscale));
+
+    _hasPremultipliedAlpha = image->isPremultipliedAlpha();
+    return true;
+}
+
+const unsigned char* Texture2D::convertImageData(Image *image, Texture2D::PixelFormat& pixelFormat)
+{
+    unsigned char*            tempData = image->getData();
+    bool                      hasAlpha = image->hasAlpha();
+    unsigned int              width = image->getWidth();
+    unsigned int              height = image->getHeight();
     size_t                    bpp = image->getBitsPerComponent();
 
     // compute pixel format
@@ -322,112 +637,69 @@ bool Texture2D::initPremultipliedATextureWithImage(Image *image, unsigned int wi
     
     // Repack the pixel data into the right format
     unsigned int length = width * height;
+    const unsigned char* inPixel = image->getData();
 
     if (pixelFormat == Texture2D::PixelFormat::RGB565)
     {
-        if (hasAlpha)
+        // Convert "RRRRRRRRRGGGGGGGGBBBBBBBB[AAAAAAAA]" to "RRRRRGGGGGGBBBBB"
+        unsigned short* outPixel16 = (unsigned short*)getConversionBuffer(length * 2);
+        if (g_ditheringEnabled)
         {
-            // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRRGGGGGGBBBBB"
-            
-            tempData = new unsigned char[width * height * 2];
-            outPixel16 = (unsigned short*)tempData;
-            inPixel32 = (unsigned int*)image->getData();
-            
-            for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-            {
-                *outPixel16++ = 
-                ((((*inPixel32 >>  0) & 0xFF) >> 3) << 11) |  // R
-                ((((*inPixel32 >>  8) & 0xFF) >> 2) << 5)  |  // G
-                ((((*inPixel32 >> 16) & 0xFF) >> 3) << 0);    // B
-            }
+            convertToRGB565Dithered(inPixel, hasAlpha ? 4 : 3, outPixel16, width, height);
         }
-        else 
+        else if (hasAlpha)
         {
-            // Convert "RRRRRRRRRGGGGGGGGBBBBBBBB" to "RRRRRGGGGGGBBBBB"
-            
-            tempData = new unsigned char[width * height * 2];
-            outPixel16 = (unsigned short*)tempData;
-            inPixel8 = (unsigned char*)image->getData();
-            
-            for(unsigned int i = 0; i < length; ++i)
-            {
-                *outPixel16++ = 
-                (((*inPixel8++ & 0xFF) >> 3) << 11) |  // R
-                (((*inPixel8++ & 0xFF) >> 2) << 5)  |  // G
-                (((*inPixel8++ & 0xFF) >> 3) << 0);    // B
-            }
-        }    
+            convertRGBA8888ToRGB565(inPixel, outPixel16, length);
+        }
+        else
+        {
+            convertRGB888ToRGB565(inPixel, outPixel16, length);
+        }
+        tempData = (unsigned char*)outPixel16;
     }
     else if (pixelFormat == Texture2D::PixelFormat::RGBA4444)
     {
         // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRGGGGBBBBAAAA"
-        
-        inPixel32 = (unsigned int*)image->getData();  
-        tempData = new unsigned char[width * height * 2];
-        outPixel16 = (unsigned short*)tempData;
-        
-        for(unsigned int i = 0; i < length; ++i, ++inPixel32)
+        unsigned short* outPixel16 = (unsigned short*)getConversionBuffer(length * 2);
+        if (g_ditheringEnabled)
+        {
+            convertRGBA8888ToRGBA4444Dithered(inPixel, outPixel16, width, height);
+        }
+        else
         {
-            *outPixel16++ = 
-            ((((*inPixel32 >> 0) & 0xFF) >> 4) << 12) | // R
-            ((((*inPixel32 >> 8) & 0xFF) >> 4) <<  8) | // G
-            ((((*inPixel32 >> 16) & 0xFF) >> 4) << 4) | // B
-            ((((*inPixel32 >> 24) & 0xFF) >> 4) << 0);  // A
+            convertRGBA8888ToRGBA4444(inPixel, outPixel16, length);
         }
+        tempData = (unsigned char*)outPixel16;
     }
     else if (pixelFormat == Texture2D::PixelFormat::RGB5A1)
     {
         // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRRGGGGGBBBBBA"
-        inPixel32 = (unsigned int*)image->getData();   
-        tempData = new unsigned char[width * height * 2];
-        outPixel16 = (unsigned short*)tempData;
-        
-        for(unsigned int i = 0; i < length; ++i, ++inPixel32)
+        unsigned short* outPixel16 = (unsigned short*)getConversionBuffer(length * 2);
+        if (g_ditheringEnabled)
+        {
+            convertRGBA8888ToRGB5A1Dithered(inPixel, outPixel16, width, height);
+        }
+        else
         {
-            *outPixel16++ = 
-            ((((*inPixel32 >> 0) & 0xFF) >> 3) << 11) | // R
-            ((((*inPixel32 >> 8) & 0xFF) >> 3) <<  6) | // G
-            ((((*inPixel32 >> 16) & 0xFF) >> 3) << 1) | // B
-            ((((*inPixel32 >> 24) & 0xFF) >> 7) << 0);  // A
+            convertRGBA8888ToRGB5A1(inPixel, outPixel16, length);
         }
+        tempData = (unsigned char*)outPixel16;
     }
     else if (pixelFormat == Texture2D::PixelFormat::A8)
     {
         // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "AAAAAAAA"
-        inPixel32 = (unsigned int*)image->getData();
-        tempData = new unsigned char[width * height];
-        unsigned char *outPixel8 = tempData;
-        
-        for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-        {
-            *outPixel8++ = (*inPixel32 >> 24) & 0xFF;  // A
-        }
+        tempData = getConversionBuffer(length);
+        convertRGBA8888ToA8(inPixel, tempData, length);
     }
     
     if (hasAlpha && pixelFormat == Texture2D::PixelFormat::RGB888)
     {
         // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRRRRRGGGGGGGGBBBBBBBB"
-        inPixel32 = (unsigned int*)image->getData();
-        tempData = new unsigned char[width * height * 3];
-        unsigned char *outPixel8 = tempData;
-        
-        for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-        {
-            *outPixel8++ = (*inPixel32 >> 0) & 0xFF; // R
-            *outPixel8++ = (*inPixel32 >> 8) & 0xFF; // G
-            *outPixel8++ = (*inPixel32 >> 16) & 0xFF; // B
-        }
-    }
-    
-    initWithData(tempData, pixelFormat, width, height, imageSize);
-    
-    if (tempData != image->getData())
-    {
-        delete [] tempData;
+        tempData = getConversionBuffer(length * 3);
+        convertRGBA8888ToRGB888(inPixel, tempData, length);
     }
 
-    _hasPremultipliedAlpha = image->isPremultipliedAlpha();
-    return true;
+    return tempData;
 }
 
 // implementation Texture2D (Text)
@@ -580,8 +852,8 @@ void Texture2D::drawAtPoint(const Point& point)
         0.0f,    0.0f,
         _maxS,0.0f };
 
-    GLfloat    width = (GLfloat)_pixelsWide * _maxS,
-        height = (GLfloat)_pixelsHigh * _maxT;
+    GLfloat    width = (GLfloat)getPixelsWide() * _maxS,
+        height = (GLfloat)getPixelsHigh() * _maxT;
 
     GLfloat        vertices[] = {    
         point.x,            point.y,
@@ -597,11 +869,11 @@ void Texture2D::drawAtPoint(const Point& point)
 
 
 #ifdef EMSCRIPTEN
-    setGLBufferData(vertices, 8 * sizeof(GLfloat), 0);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    const GLvoid* offset = setGLBufferData(vertices, 8 * sizeof(GLfloat));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, offset);
 
-    setGLBufferData(coordinates, 8 * sizeof(GLfloat), 1);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    offset = setGLBufferData(coordinates, 8 * sizeof(GLfloat));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, offset);
 #else
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
@@ -630,11 +902,11 @@ void Texture2D::drawInRect(const Rect& rect)
     GL::bindTexture2D( _name );
 
 #ifdef EMSCRIPTEN
-    setGLBufferData(vertices, 8 * sizeof(GLfloat), 0);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    const GLvoid* offset = setGLBufferData(vertices, 8 * sizeof(GLfloat));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, offset);
 
-    setGLBufferData(coordinates, 8 * sizeof(GLfloat), 1);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    offset = setGLBufferData(coordinates, 8 * sizeof(GLfloat));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, offset);
 #else
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
@@ -642,13 +914,13 @@ void Texture2D::drawInRect(const Rect& rect)
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
 
-bool Texture2D::initWithPVRFile(const char* file)
+bool Texture2D::initWithPVRFile(const char* file, unsigned int downscale/* = 0*/, bool streamed/* = false*/)
 {
     bool bRet = false;
     // nothing to do with Object::init
     
     TexturePVR *pvr = new TexturePVR;
-    bRet = pvr->initWithContentsOfFile(file);
+    bRet = pvr->initWithContentsOfFile(file, downscale, streamed);
         
     if (bRet)
     {
@@ -659,14 +931,24 @@ bool Texture2D::initWithPVRFile(const char* file)
         _maxT = 1.0f;
         _pixelsWide = pvr->getWidth();
         _pixelsHigh = pvr->getHeight();
-        _contentSize = Size((float)_pixelsWide, (float)_pixelsHigh);
+        _downscale = pvr->getSkippedMipmaps();
+        _contentSize = Size((float)getPixelsWide(), (float)getPixelsHigh());
         // FIX ME, if premultiply should be false, or the test case in RenderTextureTest(RenderTextureTargetNode) works in wrong effect
         //_hasPremultipliedAlpha = (pvr->isForcePremultipliedAlpha()) ? pvr->hasPremultipliedAlpha() : _PVRHaveAlphaPremultiplied;
         _hasPremultipliedAlpha = _PVRHaveAlphaPremultiplied;
         _pixelFormat = pvr->getFormat();
         _hasMipmaps = pvr->getNumberOfMipmaps() > 1;       
 
-        pvr->release();
+        CC_SAFE_RELEASE_NULL(_streamedPVR);
+        if (pvr->isStreaming())
+        {
+            // kept with the data of its file until the larger levels are uploaded
+            _streamedPVR = pvr;
+        }
+        else
+        {
+            pvr->release();
+        }
     }
     else
     {
@@ -676,6 +958,29 @@ bool Texture2D::initWithPVRFile(const char* file)
     return bRet;
 }
 
+bool Texture2D::streamMipmap()
+{
+    if (! _streamedPVR)
+    {
+        return false;
+    }
+
+    bool more = _streamedPVR->streamMipmap();
+    _pixelsWide = _streamedPVR->getWidth();
+    _pixelsHigh = _streamedPVR->getHeight();
+    _downscale = _streamedPVR->getSkippedMipmaps();
+    if (! more)
+    {
+        CC_SAFE_RELEASE_NULL(_streamedPVR);
+    }
+    return more;
+}
+
+void Texture2D::stopStreaming()
+{
+    CC_SAFE_RELEASE_NULL(_streamedPVR);
+}
+
 bool Texture2D::initWithETCFile(const char* file)
 {
     bool bRet = false;
@@ -691,6 +996,7 @@ bool Texture2D::initWithETCFile(const char* file)
         _maxT = 1.0f;
         _pixelsWide = etc->getWidth();
         _pixelsHigh = etc->getHeight();
+        _downscale = 0;
         _contentSize = Size((float)_pixelsWide, (float)_pixelsHigh);
         _hasPremultipliedAlpha = true;
         
@@ -704,6 +1010,37 @@ bool Texture2D::initWithETCFile(const char* file)
     return bRet;
 }
 
+bool Texture2D::initWithKTXFile(const char* file)
+{
+    bool bRet = false;
+    // nothing to do with Object::init
+
+    TextureKTX *ktx = new TextureKTX;
+    bRet = ktx->initWithFile(file);
+
+    if (bRet)
+    {
+        _name = ktx->getName();
+        _maxS = 1.0f;
+        _maxT = 1.0f;
+        _pixelsWide = ktx->getWidth();
+        _pixelsHigh = ktx->getHeight();
+        _downscale = 0;
+        _contentSize = Size((float)_pixelsWide, (float)_pixelsHigh);
+        _hasPremultipliedAlpha = _PVRHaveAlphaPremultiplied;
+        _pixelFormat = ktx->getFormat();
+        _hasMipmaps = ktx->getNumberOfMipmaps() > 1;
+    }
+    else
+    {
+        CCLOG("cocos2d: Couldn't load KTX image %s", file);
+    }
+
+    ktx->release();
+
+    return bRet;
+}
+
 void Texture2D::PVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
 {
     _PVRHaveAlphaPremultiplied = haveAlphaPremultiplied;
@@ -721,6 +1058,24 @@ void Texture2D::generateMipmap()
     GL::bindTexture2D( _name );
     glGenerateMipmap(GL_TEXTURE_2D);
     _hasMipmaps = true;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    VolatileTexture::setGenerateMipmap(this);
+#endif
+}
+
+void Texture2D::setMaxAnisotropy(float anisotropy)
+{
+    float maxAnisotropy = Configuration::getInstance()->getMaxAnisotropy();
+    anisotropy = MAX(1.0f, MIN(anisotropy, maxAnisotropy));
+    if (maxAnisotropy > 1.0f)
+    {
+        GL::bindTexture2D( _name );
+        glTexParameterf(GL_TEXTURE_2D, 0x84FE /* GL_TEXTURE_MAX_ANISOTROPY_EXT */, anisotropy);
+    }
+    _maxAnisotropy = anisotropy;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    VolatileTexture::setMaxAnisotropy(this, anisotropy);
+#endif
 }
 
 bool Texture2D::hasMipmaps() const
@@ -819,6 +1174,30 @@ const char* Texture2D::getStringForFormat() const
 		case Texture2D::PixelFormat::PRVTC2:
 			return  "PVRTC2";
 
+		case Texture2D::PixelFormat::ETC:
+			return  "ETC";
+
+		case Texture2D::PixelFormat::ETC2_RGB:
+			return  "ETC2_RGB";
+
+		case Texture2D::PixelFormat::ETC2_RGBA:
+			return  "ETC2_RGBA";
+
+		case Texture2D::PixelFormat::ASTC_4x4:
+			return  "ASTC_4x4";
+
+		case Texture2D::PixelFormat::ASTC_8x8:
+			return  "ASTC_8x8";
+
+		case Texture2D::PixelFormat::S3TC_DXT1:
+			return  "S3TC_DXT1";
+
+		case Texture2D::PixelFormat::S3TC_DXT3:
+			return  "S3TC_DXT3";
+
+		case Texture2D::PixelFormat::S3TC_DXT5:
+			return  "S3TC_DXT5";
+
 		default:
 			CCASSERT(false , "unrecognized pixel format");
 			CCLOG("stringForFormat: %ld, cannot give useful result", (long)_pixelFormat);
@@ -843,6 +1222,21 @@ Texture2D::PixelFormat Texture2D::getDefaultAlphaPixelFormat()
     return g_defaultAlphaPixelFormat;
 }
 
+void Texture2D::setDitheringEnabled(bool enabled)
+{
+    g_ditheringEnabled = enabled;
+}
+
+bool Texture2D::isDitheringEnabled()
+{
+    return g_ditheringEnabled;
+}
+
+void Texture2D::purgeConversionBuffer()
+{
+    std::vector<unsigned char>().swap(g_conversionBuffer);
+}
+
 unsigned int Texture2D::getBitsPerPixelForFormat(Texture2D::PixelFormat format) const
 {
 	unsigned int ret=0;
@@ -879,6 +1273,20 @@ unsigned int Texture2D::getBitsPerPixelForFormat(Texture2D::PixelFormat format)
 		case Texture2D::PixelFormat::PRVTC2:
 			ret = 2;
 			break;
+		case Texture2D::PixelFormat::ETC:
+		case Texture2D::PixelFormat::ETC2_RGB:
+		case Texture2D::PixelFormat::S3TC_DXT1:
+			ret = 4;
+			break;
+		case Texture2D::PixelFormat::ETC2_RGBA:
+		case Texture2D::PixelFormat::ASTC_4x4:
+		case Texture2D::PixelFormat::S3TC_DXT3:
+		case Texture2D::PixelFormat::S3TC_DXT5:
+			ret = 8;
+			break;
+		case Texture2D::PixelFormat::ASTC_8x8:
+			ret = 2;
+			break;
 		default:
 			ret = -1;
 			CCASSERT(false , "unrecognized pixel format");
@@ -893,5 +1301,32 @@ unsigned int Texture2D::getBitsPerPixelForFormat() const
 	return this->getBitsPerPixelForFormat(_pixelFormat);
 }
 
+void Texture2D::setAlphaTexture(Texture2D* alphaTexture)
+{
+    CC_SAFE_RETAIN(alphaTexture);
+    CC_SAFE_RELEASE(_alphaTexture);
+    _alphaTexture = alphaTexture;
+}
+
+unsigned int Texture2D::getMemorySize() const
+{
+    if (_hibernation)
+    {
+        return 0;
+    }
+
+    unsigned int bytes = _pixelsWide * _pixelsHigh * getBitsPerPixelForFormat() / 8;
+    if (_hasMipmaps)
+    {
+        // the mipmap chain adds 1/4 + 1/16 + ... of the base level
+        bytes += bytes / 3;
+    }
+    if (_alphaTexture)
+    {
+        bytes += _alphaTexture->getMemorySize();
+    }
+    return bytes;
+}
+
 
 NS_CC_END
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #define __CCTEXTURE2D_H__
 
 #include <string>
+#include <vector>
 #include "cocoa/CCObject.h"
 #include "cocoa/CCGeometry.h"
 #include "ccTypes.h"
@@ -37,6 +38,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class Image;
+class TexturePVR;
 
 /**
  * @addtogroup textures
@@ -97,6 +99,22 @@ public:
         PRVTC4,
         //! 2-bit PVRTC-compressed texture: PVRTC2
         PRVTC2,
+        //! 4-bit ETC1-compressed texture, without alpha channel: ETC
+        ETC,
+        //! 4-bit ETC2-compressed texture, without alpha channel: ETC2_RGB
+        ETC2_RGB,
+        //! 8-bit ETC2/EAC-compressed texture: ETC2_RGBA
+        ETC2_RGBA,
+        //! 8-bit ASTC-compressed texture, 4x4 blocks: ASTC_4x4
+        ASTC_4x4,
+        //! 2-bit ASTC-compressed texture, 8x8 blocks: ASTC_8x8
+        ASTC_8x8,
+        //! 4-bit S3TC-compressed texture, 1-bit alpha at most: S3TC_DXT1
+        S3TC_DXT1,
+        //! 8-bit S3TC-compressed texture, explicit alpha: S3TC_DXT3
+        S3TC_DXT3,
+        //! 8-bit S3TC-compressed texture, interpolated alpha: S3TC_DXT5
+        S3TC_DXT5,
 
         //! Default texture format: RGBA8888
         DEFAULT = RGBA8888
@@ -127,6 +145,20 @@ public:
     static Texture2D::PixelFormat getDefaultAlphaPixelFormat();
     CC_DEPRECATED_ATTRIBUTE static Texture2D::PixelFormat defaultAlphaPixelFormat() { return Texture2D::getDefaultAlphaPixelFormat(); };
 
+    /** sets whether or not images converted to 16-bit formats (RGB565, RGBA4444, RGB5A1) are dithered.
+     Dithering hides the banding of gradients, but the conversion can't use SIMD instructions.
+     By default it is disabled.
+     @since v3.0
+     */
+    static void setDitheringEnabled(bool enabled);
+    static bool isDitheringEnabled();
+
+    /** releases the buffer kept to convert images to other pixel formats.
+     It is called by Director::purgeCachedData().
+     @since v3.0
+     */
+    static void purgeConversionBuffer();
+
     /** treats (or not) PVR files as if they have alpha premultiplied.
      Since it is impossible to know at runtime if the PVR images have the alpha channel premultiplied, it is
      possible load them as if they have (or not) the alpha channel premultiplied.
@@ -172,12 +204,37 @@ public:
     /** Initializes a texture from a string using a text definition*/
     bool initWithString(const char *text, const FontDefinition& textDefinition);
     
-    /** Initializes a texture from a PVR file */
-    bool initWithPVRFile(const char* file);
+    /** Initializes a texture from a PVR file.
+     The first downscale levels are skipped when the file has smaller mipmaps (since v3.0)
+     @param streamed only the mipmap levels up to CC_PVR_STREAMING_INITIAL_SIZE pixels are uploaded, the texture is
+     usable immediately and streamMipmap() uploads the larger ones, see TextureCache::TexturePolicy::streamed (since v3.0)
+     */
+    bool initWithPVRFile(const char* file, unsigned int downscale = 0, bool streamed = false);
+
+    /** Uploads the next larger mipmap level of a streamed PVR texture. Its downscale decreases, its size doesn't change.
+     @return whether more levels are waiting
+     @since v3.0
+     */
+    bool streamMipmap();
+
+    /** Drops the levels of a streamed PVR texture that are still waiting, and the data of its file
+     @since v3.0
+     */
+    void stopStreaming();
+
+    /** Whether larger mipmap levels are waiting to be uploaded by streamMipmap()
+     @since v3.0
+     */
+    inline bool isStreaming() const { return _streamedPVR != nullptr; }
     
     /** Initializes a texture from a ETC file */
     bool initWithETCFile(const char* file);
 
+    /** Initializes a texture from a KTX file (ETC1, ETC2/EAC, ASTC or S3TC compressed, or uncompressed)
+     @since v3.0
+     */
+    bool initWithKTXFile(const char* file);
+
     /** sets the min filter, mag filter, wrap s and wrap t texture parameters.
     If the texture size is NPOT (non power of 2), then in can only use GL_CLAMP_TO_EDGE in GL_TEXTURE_WRAP_{S,T}.
 
@@ -215,6 +272,13 @@ public:
     */
     void generateMipmap();
 
+    /** sets the maximum anisotropy of the texture filtering, clamped to Configuration::getMaxAnisotropy().
+    1, the default, disables the anisotropic filtering. It is ignored when GL_EXT_texture_filter_anisotropic isn't supported.
+    @since v3.0
+    */
+    void setMaxAnisotropy(float anisotropy);
+    inline float getMaxAnisotropy() const { return _maxAnisotropy; }
+
     /** returns the pixel format.
      @since v2.0
      */
@@ -242,11 +306,19 @@ public:
     /** Gets the pixel format of the texture */
     Texture2D::PixelFormat getPixelFormat() const;
     
-    /** Gets the width of the texture in pixels */
+    /** Gets the width of the texture in pixels.
+     The size of the file is returned for the downscaled textures, so the texture coordinates computed from it stay right.
+     */
     unsigned int getPixelsWide() const;
     
-    /** Gets the height of the texture in pixels */
+    /** Gets the height of the texture in pixels, see getPixelsWide() */
     unsigned int getPixelsHigh() const;
+
+    /** Number of halvings applied to the image of the file while it was decoded, see Image::setDecodeDownscale().
+     The texture uses 4^getDownscale() times less memory, but has the size of the file.
+     @since v3.0
+     */
+    inline unsigned int getDownscale() const { return _downscale; }
     
     /** Gets the texture name */
     GLuint getName() const;
@@ -265,9 +337,38 @@ public:
     
     void setShaderProgram(GLProgram* program);
     GLProgram* getShaderProgram() const;
+
+    /** Pinned textures are never evicted by the TextureCache when its memory budget is exceeded.
+     * @since v3.0
+     */
+    inline void setPinned(bool pinned) { _pinned = pinned; }
+    inline bool isPinned() const { return _pinned; }
+
+    /** Sets the texture that holds the alpha channel of this texture, in its red channel.
+     It is used by ETC1 textures, which have no alpha channel: the default Sprite and SpriteBatchNode shader
+     is then replaced by GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_ALPHA_TEXTURE, which samples both textures.
+     The alpha texture is retained.
+     @since v3.0
+     */
+    void setAlphaTexture(Texture2D* alphaTexture);
+    inline Texture2D* getAlphaTexture() const { return _alphaTexture; }
+
+    /** Returns the amount of video memory used by the texture, in bytes (a third more when it has mipmaps).
+     * @since v3.0
+     */
+    unsigned int getMemorySize() const;
+
+    /** Whether the video memory of the texture was released by TextureCache::hibernateTextures().
+     A hibernated texture is reloaded by TextureCache::wakeTextures(), or immediately when its name is used.
+     @since v3.0
+     */
+    inline bool isHibernated() const { return _hibernation != nullptr; }
     
 private:
     bool initPremultipliedATextureWithImage(Image * image, unsigned int pixelsWide, unsigned int pixelsHigh);
+    /** converts the pixels of the image to the pixel format of the texture, which is returned in pixelFormat.
+     The returned pixels are either the ones of the image or the conversion buffer, they must not be deleted. */
+    const unsigned char* convertImageData(Image * image, Texture2D::PixelFormat& pixelFormat);
 
 protected:
     /** pixel format of the texture */
@@ -279,6 +380,9 @@ protected:
     /** height in pixels */
     unsigned int _pixelsHigh;
 
+    /** the size of the file is the size of the texture times 2^_downscale */
+    unsigned int _downscale;
+
     /** texture name */
     GLuint _name;
 
@@ -296,8 +400,43 @@ protected:
 
     bool _hasMipmaps;
 
+    /** maximum anisotropy of the texture filtering */
+    float _maxAnisotropy;
+
     /** shader program used by drawAtPoint and drawInRect */
     GLProgram* _shaderProgram;
+
+    /** texture holding the alpha channel, for the formats without one */
+    Texture2D* _alphaTexture;
+
+    /** whether or not the texture can be evicted by the TextureCache */
+    bool _pinned;
+
+    /** TextureCache access stamp, used to evict the least recently used textures first */
+    unsigned int _lastAccess;
+
+    /** what a hibernated texture needs to be reloaded */
+    struct Hibernation
+    {
+        /** key of the texture in the TextureCache, empty when the texture is restored from its pixels */
+        std::string key;
+        /** RGBA8888 pixels read back from the texture */
+        std::vector<unsigned char> pixels;
+        Size contentSize;
+        bool hasPremultipliedAlpha;
+        bool hasMipmaps;
+        float maxAnisotropy;
+        ccTexParams texParams;
+    };
+
+    /** NULL unless the texture is hibernated */
+    Hibernation* _hibernation;
+
+    /** PVR file whose larger mipmap levels are waiting to be uploaded, NULL when the texture isn't streamed */
+    TexturePVR* _streamedPVR;
+
+    friend class TextureCache;
+    friend class VolatileTexture;
 };
 
 // end of textures group
@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "CCTexture2D.h"
 #include "cocoa/CCString.h"
 #include <stdlib.h>
+#include <limits.h>
 
 //According to some tests GL_TRIANGLE_STRIP is slower, MUCH slower. Probably I'm doing something very wrong
 
@@ -46,10 +47,23 @@ NS_CC_BEGIN
 
 TextureAtlas::TextureAtlas()
     :_indices(NULL)
+    ,_indicesVBO(0)
+    ,_currentVBO(0)
     ,_dirty(false)
     ,_texture(NULL)
     ,_quads(NULL)
-{}
+    ,_vertexFormat(VertexFormat::V3F_C4B_T2F)
+{
+    memset(_verticesVBO, 0, sizeof(_verticesVBO));
+#if CC_TEXTURE_ATLAS_USE_VAO
+    memset(_VAOnames, 0, sizeof(_VAOnames));
+#endif
+    for (int i = 0; i < CC_TEXTURE_ATLAS_VBO_COUNT; ++i)
+    {
+        _dirtyStart[i] = INT_MAX;
+        _dirtyEnd[i] = 0;
+    }
+}
 
 TextureAtlas::~TextureAtlas()
 {
@@ -58,10 +72,11 @@ TextureAtlas::~TextureAtlas()
     CC_SAFE_FREE(_quads);
     CC_SAFE_FREE(_indices);
 
-    glDeleteBuffers(2, _buffersVBO);
+    GL::deleteBuffers(CC_TEXTURE_ATLAS_VBO_COUNT, _verticesVBO);
+    GL::deleteBuffers(1, &_indicesVBO);
 
 #if CC_TEXTURE_ATLAS_USE_VAO
-    glDeleteVertexArrays(1, &_VAOname);
+    glDeleteVertexArrays(CC_TEXTURE_ATLAS_VBO_COUNT, _VAOnames);
     GL::bindVAO(0);
 #endif
     CC_SAFE_RELEASE(_texture);
@@ -96,10 +111,32 @@ void TextureAtlas::setTexture(Texture2D * var)
 V3F_C4B_T2F_Quad* TextureAtlas::getQuads()
 {
     //if someone accesses the quads directly, presume that changes will be made
-    _dirty = true;
+    setDirty(true);
     return _quads;
 }
 
+void TextureAtlas::setDirty(bool bDirty)
+{
+    if (bDirty)
+    {
+        addDirtyRange(0, _capacity);
+    }
+    else
+    {
+        _dirty = false;
+    }
+}
+
+void TextureAtlas::addDirtyRange(int start, int end)
+{
+    for (int i = 0; i < CC_TEXTURE_ATLAS_VBO_COUNT; ++i)
+    {
+        _dirtyStart[i] = MIN(_dirtyStart[i], start);
+        _dirtyEnd[i] = MAX(_dirtyEnd[i], end);
+    }
+    _dirty = true;
+}
+
 void TextureAtlas::setQuads(V3F_C4B_T2F_Quad* quads)
 {
     _quads = quads;
@@ -251,42 +288,43 @@ void TextureAtlas::setupIndices()
 #if CC_TEXTURE_ATLAS_USE_VAO
 void TextureAtlas::setupVBOandVAO()
 {
-    glGenVertexArrays(1, &_VAOname);
-    GL::bindVAO(_VAOname);
+    glGenVertexArrays(CC_TEXTURE_ATLAS_VBO_COUNT, _VAOnames);
+    glGenBuffers(CC_TEXTURE_ATLAS_VBO_COUNT, _verticesVBO);
+    glGenBuffers(1, &_indicesVBO);
 
-#define kQuadSize sizeof(_quads[0].bl)
-
-    glGenBuffers(2, &_buffersVBO[0]);
-
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
+    mapBuffers();
+    setupVAOs();
+}
 
-    // vertices
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+void TextureAtlas::setupVAOs()
+{
+    // one VAO per vertex buffer
+    for (int i = 0; i < CC_TEXTURE_ATLAS_VBO_COUNT; ++i)
+    {
+        GL::bindVAO(_VAOnames[i]);
 
-    // colors
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+        GL::bindBuffer(GL_ARRAY_BUFFER, _verticesVBO[i]);
 
-    // tex coords
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORDS);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORDS);
+        setVertexAttribPointers();
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _capacity * 6, _indices, GL_STATIC_DRAW);
+        GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO);
+    }
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
 #else // CC_TEXTURE_ATLAS_USE_VAO
 void TextureAtlas::setupVBO()
 {
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(CC_TEXTURE_ATLAS_VBO_COUNT, _verticesVBO);
+    glGenBuffers(1, &_indicesVBO);
 
     mapBuffers();
 }
@@ -296,18 +334,119 @@ void TextureAtlas::mapBuffers()
 {
     // Avoid changing the element buffer for whatever VAO might be bound.
 	GL::bindVAO(0);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _capacity, _quads, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    for (int i = 0; i < CC_TEXTURE_ATLAS_VBO_COUNT; ++i)
+    {
+        GL::bindBuffer(GL_ARRAY_BUFFER, _verticesVBO[i]);
+        glBufferData(GL_ARRAY_BUFFER, getQuadSize() * _capacity, getVertexData(0, _capacity), GL_DYNAMIC_DRAW);
+
+        // all the buffers are up to date
+        _dirtyStart[i] = INT_MAX;
+        _dirtyEnd[i] = 0;
+    }
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _capacity * 6, _indices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
 
+void TextureAtlas::updateVertexBuffer()
+{
+    // the buffer used the longest time ago is the least likely to be read by the GPU
+    _currentVBO = (_currentVBO + 1) % CC_TEXTURE_ATLAS_VBO_COUNT;
+
+    int start = _dirtyStart[_currentVBO];
+    int end = MIN(_dirtyEnd[_currentVBO], _capacity);
+
+    GL::bindBuffer(GL_ARRAY_BUFFER, _verticesVBO[_currentVBO]);
+    if (start < end)
+    {
+        if (start == 0 && end >= _totalQuads)
+        {
+            // all the quads changed: orphan the buffer, the driver gives a new one instead of waiting for the GPU
+            glBufferData(GL_ARRAY_BUFFER, getQuadSize() * _capacity, NULL, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, getQuadSize() * start, getQuadSize() * (end - start), getVertexData(start, end));
+    }
+
+    _dirtyStart[_currentVBO] = INT_MAX;
+    _dirtyEnd[_currentVBO] = 0;
+    _dirty = false;
+}
+
+GLsizei TextureAtlas::getQuadSize() const
+{
+    return _vertexFormat == VertexFormat::V2F_C4B_T2US ? sizeof(V2F_C4B_T2US_Quad) : sizeof(V3F_C4B_T2F_Quad);
+}
+
+const GLvoid* TextureAtlas::getVertexData(int start, int end)
+{
+    if (_vertexFormat == VertexFormat::V3F_C4B_T2F)
+    {
+        return &_quads[start];
+    }
+
+    if (end <= start)
+    {
+        return NULL;
+    }
+
+    _compactQuads.resize(end - start);
+    const V3F_C4B_T2F* src = &_quads[start].tl;
+    V2F_C4B_T2US* dst = &_compactQuads[0].tl;
+    for (int i = 0; i < (end - start) * 4; ++i, ++src, ++dst)
+    {
+        dst->vertices.x = src->vertices.x;
+        dst->vertices.y = src->vertices.y;
+        dst->colors = src->colors;
+        dst->texCoords[0] = (GLushort)(clampf(src->texCoords.u, 0, 1) * 65535 + 0.5f);
+        dst->texCoords[1] = (GLushort)(clampf(src->texCoords.v, 0, 1) * 65535 + 0.5f);
+    }
+    return &_compactQuads[0];
+}
+
+void TextureAtlas::setVertexAttribPointers()
+{
+    if (_vertexFormat == VertexFormat::V2F_C4B_T2US)
+    {
+        // the shaders read a z of 0
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2US), (GLvoid*) offsetof(V2F_C4B_T2US, vertices));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V2F_C4B_T2US), (GLvoid*) offsetof(V2F_C4B_T2US, colors));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(V2F_C4B_T2US), (GLvoid*) offsetof(V2F_C4B_T2US, texCoords));
+    }
+    else
+    {
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof(V3F_C4B_T2F, colors));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
+    }
+}
+
+void TextureAtlas::setVertexFormat(VertexFormat format)
+{
+    if (format == _vertexFormat)
+    {
+        return;
+    }
+
+    _vertexFormat = format;
+    if (_capacity == 0)
+    {
+        return;
+    }
+
+    // the buffers change size: all the quads are uploaded again, and the VAOs describe the new vertices
+    mapBuffers();
+#if CC_TEXTURE_ATLAS_USE_VAO
+    setupVAOs();
+#endif
+    _compactQuads.clear();
+    _compactQuads.shrink_to_fit();
+}
+
 // TextureAtlas - Update, Insert, Move & Remove
 
 void TextureAtlas::updateQuad(V3F_C4B_T2F_Quad *quad, int index)
@@ -319,7 +458,7 @@ void TextureAtlas::updateQuad(V3F_C4B_T2F_Quad *quad, int index)
     _quads[index] = *quad;    
 
 
-    _dirty = true;
+    addDirtyRange(index, index+1);
 
 }
 
@@ -343,7 +482,7 @@ void TextureAtlas::insertQuad(V3F_C4B_T2F_Quad *quad, int index)
     _quads[index] = *quad;
 
 
-    _dirty = true;
+    addDirtyRange(index, _totalQuads);
 
 }
 
@@ -375,7 +514,7 @@ void TextureAtlas::insertQuads(V3F_C4B_T2F_Quad* quads, int index, int amount)
         j++;
     }
 
-    _dirty = true;
+    addDirtyRange(max - amount, _totalQuads);
 }
 
 void TextureAtlas::insertQuadFromIndex(int oldIndex, int newIndex)
@@ -404,7 +543,7 @@ void TextureAtlas::insertQuadFromIndex(int oldIndex, int newIndex)
     _quads[newIndex] = quadsBackup;
 
 
-    _dirty = true;
+    addDirtyRange(MIN(oldIndex, newIndex), MAX(oldIndex, newIndex)+1);
 }
 
 void TextureAtlas::removeQuadAtIndex(int index)
@@ -423,7 +562,7 @@ void TextureAtlas::removeQuadAtIndex(int index)
     _totalQuads--;
 
 
-    _dirty = true;
+    addDirtyRange(index, _totalQuads);
 }
 
 void TextureAtlas::removeQuadsAtIndex(int index, int amount)
@@ -439,7 +578,7 @@ void TextureAtlas::removeQuadsAtIndex(int index, int amount)
         memmove( &_quads[index], &_quads[index+amount], sizeof(_quads[0]) * remaining );
     }
 
-    _dirty = true;
+    addDirtyRange(index, _totalQuads);
 }
 
 void TextureAtlas::removeAllQuads()
@@ -526,6 +665,7 @@ void TextureAtlas::increaseTotalQuadsWith(int amount)
 {
     CCASSERT(amount>=0, "amount >= 0");
     _totalQuads += amount;
+    addDirtyRange(_totalQuads - amount, _totalQuads);
 }
 
 void TextureAtlas::moveQuadsFromIndex(int oldIndex, int amount, int newIndex)
@@ -557,7 +697,7 @@ void TextureAtlas::moveQuadsFromIndex(int oldIndex, int amount, int newIndex)
 
     free(tempQuads);
 
-    _dirty = true;
+    addDirtyRange(MIN(oldIndex, newIndex), MAX(oldIndex, newIndex)+amount);
 }
 
 void TextureAtlas::moveQuadsFromIndex(int index, int newIndex)
@@ -566,6 +706,7 @@ void TextureAtlas::moveQuadsFromIndex(int index, int newIndex)
     CCASSERT(newIndex + (_totalQuads - index) <= _capacity, "moveQuadsFromIndex move is out of bounds");
 
     memmove(_quads + newIndex,_quads + index, (_totalQuads - index) * sizeof(_quads[0]));
+    addDirtyRange(MIN(index, newIndex), newIndex + (_totalQuads - index));
 }
 
 void TextureAtlas::fillWithEmptyQuadsFromIndex(int index, int amount)
@@ -579,6 +720,7 @@ void TextureAtlas::fillWithEmptyQuadsFromIndex(int index, int amount)
     {
         _quads[i] = quad;
     }
+    addDirtyRange(index, to);
 }
 
 // TextureAtlas - Drawing
@@ -602,6 +744,12 @@ void TextureAtlas::drawNumberOfQuads(int numberOfQuads, int start)
         return;
 
     GL::bindTexture2D(_texture->getName());
+    if (_texture->getAlphaTexture())
+    {
+        GL::bindTexture2DN(1, _texture->getAlphaTexture()->getName());
+        // code that binds textures without the state cache expects the unit 0
+        glActiveTexture(GL_TEXTURE0);
+    }
 
 #if CC_TEXTURE_ATLAS_USE_VAO
 
@@ -612,28 +760,14 @@ void TextureAtlas::drawNumberOfQuads(int numberOfQuads, int start)
     // XXX: update is done in draw... perhaps it should be done in a timer
     if (_dirty) 
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-        // option 1: subdata
-        //glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
-		
-		// option 2: data
-        //		glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
-		
-		// option 3: orphaning + glMapBuffer
-		glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * (numberOfQuads-start), NULL, GL_DYNAMIC_DRAW);
-		void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-		memcpy(buf, _quads, sizeof(_quads[0])* (numberOfQuads-start));
-		glUnmapBuffer(GL_ARRAY_BUFFER);
-		
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        _dirty = false;
+        updateVertexBuffer();
+        GL::bindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    GL::bindVAO(_VAOname);
+    GL::bindVAO(_VAOnames[_currentVBO]);
 
 #if CC_REBIND_INDICES_BUFFER
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO);
 #endif
 
 #if CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP
@@ -643,7 +777,7 @@ void TextureAtlas::drawNumberOfQuads(int numberOfQuads, int start)
 #endif // CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP
 
 #if CC_REBIND_INDICES_BUFFER
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 #endif
 
 //    glBindVertexArray(0);
@@ -654,28 +788,22 @@ void TextureAtlas::drawNumberOfQuads(int numberOfQuads, int start)
     // Using VBO without VAO
     //
 
-#define kQuadSize sizeof(_quads[0].bl)
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
     // XXX: update is done in draw... perhaps it should be done in a timer
     if (_dirty) 
     {
-        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * numberOfQuads , &_quads[start] );
-        _dirty = false;
+        updateVertexBuffer();
+    }
+    else
+    {
+        GL::bindBuffer(GL_ARRAY_BUFFER, _verticesVBO[_currentVBO]);
     }
 
     GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
 
-    // vertices
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
-
-    // colors
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
-
-    // tex coords
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
+    // vertices, colors and tex coords
+    setVertexAttribPointers();
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO);
 
 #if CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP
     glDrawElements(GL_TRIANGLE_STRIP, (GLsizei)numberOfQuads*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(_indices[0])));
@@ -683,12 +811,13 @@ void TextureAtlas::drawNumberOfQuads(int numberOfQuads, int start)
     glDrawElements(GL_TRIANGLES, (GLsizei)numberOfQuads*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(_indices[0])));
 #endif // CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
 #endif // CC_TEXTURE_ATLAS_USE_VAO
 
     CC_INCREMENT_GL_DRAWS(1);
+    CC_INCREMENT_GL_QUADS(numberOfQuads);
     CHECK_GL_ERROR_DEBUG();
 }
 
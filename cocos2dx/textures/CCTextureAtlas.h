@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "cocoa/CCObject.h"
 #include "ccConfig.h"
 #include <string>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -49,13 +50,27 @@ Supported features:
 * Quads can be removed in runtime
 * Quads can be re-ordered in runtime
 * The TextureAtlas capacity can be increased or decreased in runtime
-* OpenGL component: V3F, C4B, T2F.
+* OpenGL component: V3F, C4B, T2F, or V2F, C4B, T2US with VertexFormat::V2F_C4B_T2US.
 The quads are rendered using an OpenGL ES VBO.
 To render the quads using an interleaved vertex array list, you should modify the ccConfig.h file 
 */
 class CC_DLL TextureAtlas : public Object 
 {
 public:
+    /** Layout of the vertices in the vertex buffers. The quads are always stored as V3F_C4B_T2F_Quad.
+     @since v3.0
+     */
+    enum class VertexFormat
+    {
+        /** 24 bytes per vertex */
+        V3F_C4B_T2F,
+        /** 16 bytes per vertex: the z of the vertices is dropped, and the texture coordinates are normalized
+         on 16 bits, so they must be between 0 and 1. For the 2D batches limited by the memory bandwidth.
+         The modified quads are converted when they are uploaded.
+         */
+        V2F_C4B_T2US,
+    };
+
     /** creates a TextureAtlas with an filename and with an initial capacity for Quads.
      * The TextureAtlas capacity can be increased in runtime.
      */
@@ -182,8 +197,8 @@ public:
 
     /** whether or not the array buffer of the VBO needs to be updated*/
     inline bool isDirty(void) { return _dirty; }
-    /** specify if the array buffer of the VBO needs to be updated */
-    inline void setDirty(bool bDirty) { _dirty = bDirty; }
+    /** specify if the array buffer of the VBO needs to be updated. If true, all the quads are uploaded */
+    void setDirty(bool bDirty);
 
     const char* description() const;
 
@@ -204,12 +219,29 @@ public:
     
     /** Sets the quads that are going to be rendered */
     void setQuads(V3F_C4B_T2F_Quad* quads);
+
+    /** Sets the layout of the vertices uploaded to the GPU, V3F_C4B_T2F by default. All the quads are uploaded again.
+     @since v3.0
+     */
+    void setVertexFormat(VertexFormat format);
+    VertexFormat getVertexFormat() const { return _vertexFormat; }
     
 private:
     void setupIndices();
     void mapBuffers();
+    /** marks the quads [start, end) as modified in all the vertex buffers */
+    void addDirtyRange(int start, int end);
+    /** writes the modified quads in the next vertex buffer, and makes it the current one */
+    void updateVertexBuffer();
+    /** size in the vertex buffers of a quad */
+    GLsizei getQuadSize() const;
+    /** the quads [start, end) in the vertex format */
+    const GLvoid* getVertexData(int start, int end);
+    /** describes the vertices of the bound vertex buffer */
+    void setVertexAttribPointers();
 #if CC_TEXTURE_ATLAS_USE_VAO
     void setupVBOandVAO();
+    void setupVAOs();
 #else
     void setupVBO();
 #endif
@@ -217,9 +249,15 @@ private:
 protected:
     GLushort*           _indices;
 #if CC_TEXTURE_ATLAS_USE_VAO
-    GLuint              _VAOname;
+    GLuint              _VAOnames[CC_TEXTURE_ATLAS_VBO_COUNT];
 #endif
-    GLuint              _buffersVBO[2]; //0: vertex  1: indices
+    GLuint              _indicesVBO;
+    // the vertex buffers are written in turn, so the GPU can still draw with the previous ones
+    GLuint              _verticesVBO[CC_TEXTURE_ATLAS_VBO_COUNT];
+    int                 _currentVBO;
+    // quads modified since each vertex buffer was written: [start, end)
+    int                 _dirtyStart[CC_TEXTURE_ATLAS_VBO_COUNT];
+    int                 _dirtyEnd[CC_TEXTURE_ATLAS_VBO_COUNT];
     bool                _dirty; //indicates whether or not the array buffer of the VBO needs to be updated
     /** quantity of quads that are going to be drawn */
     int _totalQuads;
@@ -229,6 +267,10 @@ protected:
     Texture2D* _texture;
     /** Quads that are going to be rendered */
     V3F_C4B_T2F_Quad* _quads;
+
+    VertexFormat _vertexFormat;
+    // quads converted to V2F_C4B_T2US before they are uploaded
+    std::vector<V2F_C4B_T2US_Quad> _compactQuads;
 };
 
 // end of textures group
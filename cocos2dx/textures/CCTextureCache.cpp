@@ -28,17 +28,33 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <sys/stat.h>
 
 #include "CCTextureCache.h"
 #include "CCTexture2D.h"
 #include "ccMacros.h"
 #include "CCDirector.h"
+#include "CCConfiguration.h"
 #include "platform/CCFileUtils.h"
-#include "platform/CCThread.h"
 #include "support/ccUtils.h"
+#include "support/CCFrameProfiler.h"
+#include "support/CCAssetLoadProfiler.h"
 #include "CCScheduler.h"
 #include "cocoa/CCString.h"
-
+#include "CCProtocols.h"
+#include "layers_scenes_transitions_nodes/CCScene.h"
+#include "shaders/ccGLStateCache.h"
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
 #ifdef EMSCRIPTEN
 #include <emscripten/emscripten.h>
@@ -67,54 +83,82 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
-, _asyncStructQueue(nullptr)
-, _imageInfoQueue(nullptr)
-, _needQuit(false)
+: _loadingThreadCount(1)
 , _asyncRefCount(0)
-, _textures(new Dictionary())
+, _uploadBudgetTime(0)
+, _uploadBudgetBytes(0)
+
+, _compressedVariantsEnabled(false)
+, _diskCacheEnabled(false)
+, _memoryBudget(0)
+, _accessCounter(0)
 {
     CCASSERT(_sharedTextureCache == nullptr, "Attempted to allocate a second instance of a singleton.");
+
+    // keep one core for the main thread
+    int cores = (int)std::thread::hardware_concurrency();
+    _loadingThreadCount = MIN(MAX(cores - 1, 1), 4);
 }
 
 TextureCache::~TextureCache()
 {
     CCLOGINFO("cocos2d: deallocing TextureCache: %p", this);
 
-    CC_SAFE_RELEASE(_textures);
+    _textures.removeAllObjects();
 
-    CC_SAFE_DELETE(_loadingThread);
     _sharedTextureCache = nullptr;
 }
 
 void TextureCache::destroyInstance()
 {
-    // notify sub thread to quick
-    _sharedTextureCache->_needQuit = true;
-    _sharedTextureCache->_sleepCondition.notify_one();
-    if (_sharedTextureCache->_loadingThread) _sharedTextureCache->_loadingThread->join();
+    if (!_sharedTextureCache)
+    {
+        return;
+    }
+
+    // the requests that were not completed are dropped: the callbacks of their tasks won't be called
+    for (auto it = _sharedTextureCache->_loadingTasks.begin(); it != _sharedTextureCache->_loadingTasks.end(); ++it)
+    {
+        JobSystem::getInstance()->cancelTask(*it);
+    }
+    _sharedTextureCache->_loadingTasks.clear();
+    _sharedTextureCache->_imageInfoQueue.clear();
+
+    _sharedTextureCache->unbindAllImageAsync();
+    std::vector<AsyncStruct*>& requests = _sharedTextureCache->_asyncRequests;
+    for (auto it = requests.begin(); it != requests.end(); ++it)
+    {
+        delete *it;
+    }
+    requests.clear();
+
+    if (_sharedTextureCache->_asyncRefCount > 0)
+    {
+        _sharedTextureCache->_asyncRefCount = 0;
+        Director::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(TextureCache::addImageAsyncCallBack), _sharedTextureCache);
+    }
+
+    _sharedTextureCache->stopMipmapStreaming();
 
     CC_SAFE_RELEASE_NULL(_sharedTextureCache);
 }
 
 const char* TextureCache::description() const
 {
-    return String::createWithFormat("<TextureCache | Number of textures = %u>", _textures->count())->getCString();
+    return String::createWithFormat("<TextureCache | Number of textures = %u>", _textures.count())->getCString();
 }
 
 Dictionary* TextureCache::snapshotTextures()
 { 
-    Dictionary* pRet = new Dictionary();
-    DictElement* pElement = NULL;
-    CCDICT_FOREACH(_textures, pElement)
-    {
-        pRet->setObject(pElement->getObject(), pElement->getStrKey());
-    }
-    pRet->autorelease();
-    return pRet;
+    return _textures.toDictionary();
 }
 
 void TextureCache::addImageAsync(const char *path, Object *target, SEL_CallFuncO selector)
+{
+    addImageAsync(path, target, selector, 0);
+}
+
+void TextureCache::addImageAsync(const char *path, Object *target, SEL_CallFuncO selector, int priority)
 {
     CCASSERT(path != NULL, "TextureCache: fileimage MUST not be NULL");    
 
@@ -125,11 +169,12 @@ void TextureCache::addImageAsync(const char *path, Object *target, SEL_CallFuncO
     std::string pathKey = path;
 
     pathKey = FileUtils::getInstance()->fullPathForFilename(pathKey.c_str());
-    texture = static_cast<Texture2D*>(_textures->objectForKey(pathKey.c_str()));
+    texture = static_cast<Texture2D*>(_textures.objectForKey(pathKey));
 
     std::string fullpath = pathKey;
-    if (texture != NULL)
+    if (texture != NULL && !texture->isHibernated())
     {
+        touchTexture(texture);
         if (target && selector)
         {
             (target->*selector)(texture);
@@ -138,18 +183,6 @@ void TextureCache::addImageAsync(const char *path, Object *target, SEL_CallFuncO
         return;
     }
 
-    // lazy init
-    if (_asyncStructQueue == NULL)
-    {             
-        _asyncStructQueue = new queue<AsyncStruct*>();
-        _imageInfoQueue = new queue<ImageInfo*>();        
-
-        // create a new thread to load images
-        _loadingThread = new std::thread(&TextureCache::loadImage, this);
-
-        _needQuit = false;
-    }
-
     if (0 == _asyncRefCount)
     {
         Director::getInstance()->getScheduler()->scheduleSelector(schedule_selector(TextureCache::addImageAsyncCallBack), this, 0, false);
@@ -163,89 +196,199 @@ void TextureCache::addImageAsync(const char *path, Object *target, SEL_CallFuncO
     }
 
     // generate async struct
-    AsyncStruct *data = new AsyncStruct(fullpath, target, selector);
+    AsyncStruct *data = new AsyncStruct(fullpath, target, selector, priority);
+    _asyncRequests.push_back(data);
 
-    // add async struct into queue
-    _asyncStructQueueMutex.lock();
-    _asyncStructQueue->push(data);
-    _asyncStructQueueMutex.unlock();
+    // add async struct into queue, after the requests with the same or a higher priority
+    auto pos = std::upper_bound(_asyncStructQueue.begin(), _asyncStructQueue.end(), data,
+                                [](const AsyncStruct* a, const AsyncStruct* b) { return a->priority > b->priority; });
+    _asyncStructQueue.insert(pos, data);
 
-    _sleepCondition.notify_one();
+    startLoadingTasks();
 }
 
-void TextureCache::loadImage()
+void TextureCache::addImageAsync(const char *path, const std::function<void(Texture2D*)>& callback, int priority/* = 0*/)
 {
-    AsyncStruct *pAsyncStruct = nullptr;
+    CCASSERT(path != NULL, "TextureCache: fileimage MUST not be NULL");
 
-    while (true)
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
+    Texture2D* texture = static_cast<Texture2D*>(_textures.objectForKey(fullpath));
+    if (texture != NULL && !texture->isHibernated())
     {
-        // create autorelease pool for iOS
-        Thread thread;
-        thread.createAutoreleasePool();
-
-        std::queue<AsyncStruct*> *pQueue = _asyncStructQueue;
-        _asyncStructQueueMutex.lock();
-        if (pQueue->empty())
+        touchTexture(texture);
+        if (callback)
         {
-            _asyncStructQueueMutex.unlock();
-            if (_needQuit) {
-                break;
+            callback(texture);
+        }
+        return;
+    }
+
+    // the request is queued like the ones of the other addImageAsync(), then given its callback
+    addImageAsync(path, NULL, NULL, priority);
+    _asyncRequests.back()->callback = callback;
+}
+
+void TextureCache::startLoadingTasks()
+{
+    while ((int)_loadingTasks.size() < _loadingThreadCount && !_asyncStructQueue.empty())
+    {
+        AsyncStruct *request = _asyncStructQueue.front();
+        _asyncStructQueue.pop_front();
+
+        // the task only uses its own copies: the request belongs to the main thread
+        std::shared_ptr<ImageInfo> imageInfo = std::make_shared<ImageInfo>();
+        imageInfo->asyncStruct = request;
+        imageInfo->imageType = computeImageFormatType(request->filename);
+        std::string filename = request->filename;
+        unsigned int downscale = getDownscale(filename);
+
+        JobSystem::TaskPtr task = JobSystem::getInstance()->addTask([imageInfo, filename, downscale] {
+            CC_PROFILE_ZONE("TextureCache - decode image");
+            CC_PROFILE_ASSET(filename);
+
+            if (imageInfo->imageType == Image::Format::UNKOWN)
+            {
+                CCLOG("unsupported format %s", filename.c_str());
+                return;
             }
-            else {
-                std::unique_lock<std::mutex> lk(_sleepMutex);
-                _sleepCondition.wait(lk);
-                continue;
+
+            // generate image. Failed images are sent too, so the main thread completes the request
+            RefPtr<Image> image = RefPtr<Image>::adopt(new Image());
+            image->setDecodeDownscale(downscale);
+            if (image->initWithImageFileThreadSafe(filename.c_str(), imageInfo->imageType))
+            {
+                imageInfo->image = std::move(image);
+            }
+            else
+            {
+                CCLOG("can not load %s", filename.c_str());
             }
+        }, [this, imageInfo] {
+            _imageInfoQueue.push_back(imageInfo);
+
+            // forget the tasks that are done, including this one, and decode the next requests
+            _loadingTasks.erase(std::remove_if(_loadingTasks.begin(), _loadingTasks.end(),
+                                               [](const JobSystem::TaskPtr& task) { return task->isDone(); }),
+                                _loadingTasks.end());
+            startLoadingTasks();
+        }, request->priority);
+
+        _loadingTasks.push_back(task);
+    }
+}
+
+void TextureCache::removeAsyncRequest(AsyncStruct* request)
+{
+    if (request->target)
+    {
+        request->target->release();
+        request->target = nullptr;
+    }
+    request->selector = nullptr;
+    request->callback = nullptr;
+
+    auto it = std::find(_asyncRequests.begin(), _asyncRequests.end(), request);
+    if (it != _asyncRequests.end())
+    {
+        _asyncRequests.erase(it);
+    }
+
+    --_asyncRefCount;
+    if (0 == _asyncRefCount)
+    {
+        Director::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(TextureCache::addImageAsyncCallBack), this);
+    }
+}
+
+void TextureCache::unbindImageAsync(const char *path)
+{
+    CCASSERT(path != NULL, "TextureCache: fileimage MUST not be NULL");
+    if (_asyncRequests.empty())
+    {
+        return;
+    }
+
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
+
+    // the requests that were not decoded yet are removed
+    std::vector<AsyncStruct*> removed;
+    for (auto it = _asyncStructQueue.begin(); it != _asyncStructQueue.end(); )
+    {
+        if ((*it)->filename == fullpath)
+        {
+            removed.push_back(*it);
+            it = _asyncStructQueue.erase(it);
         }
         else
         {
-            pAsyncStruct = pQueue->front();
-            pQueue->pop();
-            _asyncStructQueueMutex.unlock();
-        }        
+            ++it;
+        }
+    }
 
-        const char *filename = pAsyncStruct->filename.c_str();
+    for (auto it = removed.begin(); it != removed.end(); ++it)
+    {
+        removeAsyncRequest(*it);
+        delete *it;
+    }
 
-        // compute image type
-        Image::Format imageType = computeImageFormatType(pAsyncStruct->filename);
-        if (imageType == Image::Format::UNKOWN)
-        {
-            CCLOG("unsupported format %s",filename);
-            delete pAsyncStruct;
-            
-            continue;
-        }
-        
-        // generate image            
-        Image *pImage = new Image();
-        if (pImage && !pImage->initWithImageFileThreadSafe(filename, imageType))
+    // the ones being decoded just lose their callback
+    for (auto it = _asyncRequests.begin(); it != _asyncRequests.end(); ++it)
+    {
+        AsyncStruct* request = *it;
+        if (request->filename == fullpath)
         {
-            CC_SAFE_RELEASE(pImage);
-            CCLOG("can not load %s", filename);
-            continue;
+            if (request->target)
+            {
+                request->target->release();
+                request->target = nullptr;
+            }
+            request->selector = nullptr;
+            request->callback = nullptr;
         }
+    }
+}
 
-        // generate image info
-        ImageInfo *pImageInfo = new ImageInfo();
-        pImageInfo->asyncStruct = pAsyncStruct;
-        pImageInfo->image = pImage;
-        pImageInfo->imageType = imageType;
+void TextureCache::unbindAllImageAsync()
+{
+    if (_asyncRequests.empty())
+    {
+        return;
+    }
 
-        // put the image info into the queue
-        _imageInfoMutex.lock();
-        _imageInfoQueue->push(pImageInfo);
-        _imageInfoMutex.unlock();
+    std::deque<AsyncStruct*> removed;
+    removed.swap(_asyncStructQueue);
+
+    for (auto it = removed.begin(); it != removed.end(); ++it)
+    {
+        removeAsyncRequest(*it);
+        delete *it;
     }
-    
-	if(_asyncStructQueue != nullptr)
+
+    for (auto it = _asyncRequests.begin(); it != _asyncRequests.end(); ++it)
     {
-        delete _asyncStructQueue;
-	    _asyncStructQueue = nullptr;
-        delete _imageInfoQueue;
-	    _imageInfoQueue = nullptr;
+        AsyncStruct* request = *it;
+        if (request->target)
+        {
+            request->target->release();
+            request->target = nullptr;
+        }
+        request->selector = nullptr;
+        request->callback = nullptr;
     }
 }
 
+void TextureCache::setAsyncLoadingThreadCount(int count)
+{
+    CCASSERT(count > 0, "TextureCache: at least one loading thread is needed");
+    _loadingThreadCount = MAX(count, 1);
+}
+
+void TextureCache::setAsyncUploadBudget(float milliseconds, unsigned int bytes)
+{
+    _uploadBudgetTime = milliseconds / 1000.0f;
+    _uploadBudgetBytes = bytes;
+}
+
 Image::Format TextureCache::computeImageFormatType(string& filename)
 {
     Image::Format ret = Image::Format::UNKOWN;
@@ -272,54 +415,87 @@ Image::Format TextureCache::computeImageFormatType(string& filename)
 
 void TextureCache::addImageAsyncCallBack(float dt)
 {
-    // the image is generated in loading thread
-    std::queue<ImageInfo*> *imagesQueue = _imageInfoQueue;
+    auto start = std::chrono::steady_clock::now();
+    unsigned int uploadedBytes = 0;
 
-    _imageInfoMutex.lock();
-    if (imagesQueue->empty())
+    // the images are generated by the loading tasks
+    while (_asyncRefCount > 0 && !_imageInfoQueue.empty())
     {
-        _imageInfoMutex.unlock();
-    }
-    else
-    {
-        ImageInfo *pImageInfo = imagesQueue->front();
-        imagesQueue->pop();
-        _imageInfoMutex.unlock();
+        std::shared_ptr<ImageInfo> pImageInfo = _imageInfoQueue.front();
+        _imageInfoQueue.pop_front();
 
         AsyncStruct *pAsyncStruct = pImageInfo->asyncStruct;
-        Image *pImage = pImageInfo->image;
+        RefPtr<Image> pImage = std::move(pImageInfo->image);
 
         Object *target = pAsyncStruct->target;
         SEL_CallFuncO selector = pAsyncStruct->selector;
         const char* filename = pAsyncStruct->filename.c_str();
 
-        // generate texture in render thread
-        Texture2D *texture = new Texture2D();
+        Texture2D *texture = nullptr;
+        if (pImage)
+        {
+            // the same image may have been requested twice, or the texture is woken up
+            texture = static_cast<Texture2D*>(_textures.objectForKey(filename));
+            if (texture != nullptr)
+            {
+                if (texture->isHibernated())
+                {
+                    restoreTexture(texture, pImage);
+                    uploadedBytes += pImage->getWidth() * pImage->getHeight() * 4;
+                }
+                touchTexture(texture);
+            }
+            else
+            {
+                // generate texture in render thread
+                texture = new Texture2D();
 
-        texture->initWithImage(pImage);
+                {
+                    CC_PROFILE_ASSET(pAsyncStruct->filename);
+                    texture->initWithImage(pImage);
+                }
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
-       // cache the texture file name
-       VolatileTexture::addImageTexture(texture, filename, pImageInfo->imageType);
+                // cache the texture file name
+                VolatileTexture::addImageTexture(texture, filename, pImageInfo->imageType);
 #endif
-        // cache the texture
-        _textures->setObject(texture, filename);
-        texture->autorelease();
+                // cache the texture
+                cacheTexture(texture, filename);
+                texture->autorelease();
 
-        if (target && selector)
+                uploadedBytes += pImage->getWidth() * pImage->getHeight() * 4;
+            }
+        }
+
+        if (texture && target && selector)
         {
             (target->*selector)(texture);
-            target->release();
-        }        
+        }
+        if (pAsyncStruct->callback)
+        {
+            std::function<void(Texture2D*)> callback = pAsyncStruct->callback;
+            callback(texture);
+        }
 
-        pImage->release();
+        removeAsyncRequest(pAsyncStruct);
         delete pAsyncStruct;
-        delete pImageInfo;
 
-        --_asyncRefCount;
-        if (0 == _asyncRefCount)
+        // one texture per frame, unless a budget is set
+        if (_uploadBudgetTime <= 0 && _uploadBudgetBytes == 0)
+        {
+            break;
+        }
+        if (_uploadBudgetBytes > 0 && uploadedBytes >= _uploadBudgetBytes)
         {
-            Director::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(TextureCache::addImageAsyncCallBack), this);
+            break;
+        }
+        if (_uploadBudgetTime > 0)
+        {
+            std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= _uploadBudgetTime)
+            {
+                break;
+            }
         }
     }
 }
@@ -341,11 +517,17 @@ Texture2D * TextureCache::addImage(const char * path)
     {
         return NULL;
     }
-    texture = static_cast<Texture2D*>(_textures->objectForKey(pathKey.c_str()));
+    texture = static_cast<Texture2D*>(_textures.objectForKey(pathKey));
 
     std::string fullpath = pathKey;
-    if (! texture) 
+    if (texture)
+    {
+        touchTexture(texture);
+    }
+    else
     {
+        CC_PROFILE_ASSET(fullpath);
+
         std::string lowerCase(pathKey);
         for (unsigned int i = 0; i < lowerCase.length(); ++i)
         {
@@ -363,8 +545,33 @@ Texture2D * TextureCache::addImage(const char * path)
                 // ETC1 file format, only supportted on Android
                 texture = this->addETCImage(fullpath.c_str());
             }
+            else if (std::string::npos != lowerCase.find(".ktx"))
+            {
+                texture = this->addKTXImage(fullpath.c_str());
+            }
             else
             {
+                // use a compressed version of the image if the GPU supports it
+                std::string variant = _compressedVariantsEnabled ? findCompressedVariant(fullpath) : "";
+                if (! variant.empty())
+                {
+                    texture = new Texture2D();
+                    if (texture->initWithKTXFile(variant.c_str()))
+                    {
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+                        VolatileTexture::addImageTexture(texture, variant.c_str(), Image::Format::RAW_DATA);
+#endif
+                        if (texture->getPixelFormat() == Texture2D::PixelFormat::ETC)
+                        {
+                            loadAlphaTexture(texture, variant);
+                        }
+                        cacheTexture(texture, pathKey);
+                        texture->release();
+                        break;
+                    }
+                    CC_SAFE_RELEASE_NULL(texture);
+                }
+
                 Image::Format eImageFormat = Image::Format::UNKOWN;
                 if (std::string::npos != lowerCase.find(".png"))
                 {
@@ -382,23 +589,40 @@ Texture2D * TextureCache::addImage(const char * path)
                 {
                     eImageFormat = Image::Format::WEBP;
                 }
+
+                // use the pixels converted by a previous launch, the cache only keeps full size images
+                unsigned int downscale = getDownscale(fullpath);
+                bool diskCache = _diskCacheEnabled && downscale == 0;
+                texture = diskCache ? loadTextureFromDiskCache(fullpath) : NULL;
+                if (texture)
+                {
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+                    VolatileTexture::addImageTexture(texture, fullpath.c_str(), eImageFormat);
+#endif
+                    cacheTexture(texture, pathKey);
+                    texture->release();
+                    break;
+                }
                 
+                CC_PROFILE_ZONE("TextureCache - load image");
+
                 pImage = new Image();
                 CC_BREAK_IF(NULL == pImage);
 
+                pImage->setDecodeDownscale(downscale);
                 bool bRet = pImage->initWithImageFile(fullpath.c_str(), eImageFormat);
                 CC_BREAK_IF(!bRet);
 
                 texture = new Texture2D();
                 
                 if( texture &&
-                    texture->initWithImage(pImage) )
+                    (diskCache ? initTextureAndSaveToDiskCache(texture, pImage, fullpath) : texture->initWithImage(pImage)) )
                 {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
                     // cache the texture file name
                     VolatileTexture::addImageTexture(texture, fullpath.c_str(), eImageFormat);
 #endif
-                    _textures->setObject(texture, pathKey.c_str());
+                    cacheTexture(texture, pathKey);
                     texture->release();
                 }
                 else
@@ -421,22 +645,34 @@ Texture2D * TextureCache::addPVRImage(const char* path)
     Texture2D* texture = NULL;
     std::string key(path);
     
-    if( (texture = (Texture2D*)_textures->objectForKey(key.c_str())) ) 
+    if( (texture = (Texture2D*)_textures.objectForKey(key)) ) 
     {
-        return texture;
+        return touchTexture(texture);
     }
 
     // Split up directory and filename
     std::string fullpath = FileUtils::getInstance()->fullPathForFilename(key.c_str());
     texture = new Texture2D();
-    if(texture != NULL && texture->initWithPVRFile(fullpath.c_str()) )
+    const TexturePolicy* policy = getTexturePolicy(fullpath);
+    bool streamed = policy && policy->streamed;
+    if(texture != NULL && texture->initWithPVRFile(fullpath.c_str(), getDownscale(fullpath), streamed) )
     {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
         // cache the texture file name
         VolatileTexture::addImageTexture(texture, fullpath.c_str(), Image::Format::RAW_DATA);
 #endif
-        _textures->setObject(texture, key.c_str());
+        cacheTexture(texture, key);
         texture->autorelease();
+
+        if (texture->isStreaming())
+        {
+            if (_streamedTextures.empty())
+            {
+                Director::getInstance()->getScheduler()->scheduleSelector(schedule_selector(TextureCache::streamMipmaps), this, 0, false);
+            }
+            texture->retain();
+            _streamedTextures.push_back(texture);
+        }
     }
     else
     {
@@ -447,162 +683,981 @@ Texture2D * TextureCache::addPVRImage(const char* path)
     return texture;
 }
 
-Texture2D* TextureCache::addETCImage(const char* path)
+Texture2D* TextureCache::addKTXImage(const char* path)
 {
     CCASSERT(path != NULL, "TextureCache: fileimage MUST not be nil");
-    
+
     Texture2D* texture = NULL;
     std::string key(path);
-    
-    if( (texture = (Texture2D*)_textures->objectForKey(key.c_str())) )
+
+    if( (texture = (Texture2D*)_textures.objectForKey(key)) )
     {
-        return texture;
+        return touchTexture(texture);
     }
-    
-    // Split up directory and filename
+
     std::string fullpath = FileUtils::getInstance()->fullPathForFilename(key.c_str());
     texture = new Texture2D();
-    if(texture != NULL && texture->initWithETCFile(fullpath.c_str()))
+    if(texture != NULL && texture->initWithKTXFile(fullpath.c_str()))
     {
-        _textures->setObject(texture, key.c_str());
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+        // cache the texture file name
+        VolatileTexture::addImageTexture(texture, fullpath.c_str(), Image::Format::RAW_DATA);
+#endif
+        if (texture->getPixelFormat() == Texture2D::PixelFormat::ETC)
+        {
+            loadAlphaTexture(texture, fullpath);
+        }
+        cacheTexture(texture, key);
         texture->autorelease();
     }
     else
     {
-        CCLOG("cocos2d: Couldn't add ETCImage:%s in TextureCache",key.c_str());
+        CCLOG("cocos2d: Couldn't add KTXImage:%s in TextureCache",key.c_str());
         CC_SAFE_DELETE(texture);
     }
-    
+
     return texture;
 }
 
-Texture2D* TextureCache::addUIImage(Image *image, const char *key)
+void TextureCache::setCompressedVariantsEnabled(bool enabled)
 {
-    CCASSERT(image != NULL, "TextureCache: image MUST not be nil");
+    _compressedVariantsEnabled = enabled;
+}
 
-    Texture2D * texture = NULL;
-    // textureForKey() use full path,so the key should be full path
-    std::string forKey;
-    if (key)
+std::string TextureCache::findCompressedVariant(const std::string& fullpath) const
+{
+    // from the smallest to the biggest format
+    static const struct
     {
-        forKey = FileUtils::getInstance()->fullPathForFilename(key);
+        const char* suffix;
+        bool (Configuration::*isSupported)(void) const;
+    } variants[] = {
+        { ".astc.ktx", &Configuration::supportsASTC },
+        { ".etc2.ktx", &Configuration::supportsETC2 },
+        { ".dxt.ktx", &Configuration::supportsS3TC },
+        { ".etc.ktx", &Configuration::supportsETC },
+    };
+
+    size_t dot = fullpath.find_last_of('.');
+    size_t slash = fullpath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        return "";
     }
+    std::string base = fullpath.substr(0, dot);
 
-    // Don't have to lock here, because addImageAsync() will not 
-    // invoke opengl function in loading thread.
-
-    do 
+    Configuration* conf = Configuration::getInstance();
+    FileUtils* fileUtils = FileUtils::getInstance();
+    for (unsigned int i = 0; i < sizeof(variants) / sizeof(variants[0]); ++i)
     {
-        // If key is nil, then create a new texture each time
-        if(key && (texture = (Texture2D *)_textures->objectForKey(forKey.c_str())))
-        {
-            break;
-        }
-
-        // prevents overloading the autorelease pool
-        texture = new Texture2D();
-        texture->initWithImage(image);
-
-        if(key && texture)
-        {
-            _textures->setObject(texture, forKey.c_str());
-            texture->autorelease();
-        }
-        else
+        if ((conf->*variants[i].isSupported)())
         {
-            CCLOG("cocos2d: Couldn't add UIImage in TextureCache");
+            std::string variant = base + variants[i].suffix;
+            if (fileUtils->isFileExist(variant))
+            {
+                return variant;
+            }
         }
-
-    } while (0);
-
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    VolatileTexture::addImage(texture, image);
-#endif
-    
-    return texture;
+    }
+    return "";
 }
 
-// TextureCache - Remove
-
-void TextureCache::removeAllTextures()
+void TextureCache::setDiskCacheEnabled(bool enabled)
 {
-    _textures->removeAllObjects();
+    _diskCacheEnabled = enabled;
 }
 
-void TextureCache::removeUnusedTextures()
+// header of the files of the disk cache, followed by the path of the image and the pixels
+struct DiskCacheHeader
 {
-    /*
-    DictElement* pElement = NULL;
-    CCDICT_FOREACH(_textures, pElement)
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceTime;
+    uint32_t pixelFormat;
+    uint32_t width;
+    uint32_t height;
+    uint32_t premultipliedAlpha;
+    uint32_t pathLength;
+    uint32_t dataLength;
+};
+
+static const char DISK_CACHE_MAGIC[4] = { 'C', 'C', 'T', 'C' };
+static const uint32_t DISK_CACHE_VERSION = 1;
+
+// maps a file in memory, or reads it where mmap() is not available
+class DiskCacheFile
+{
+public:
+    DiskCacheFile() : _data(NULL), _size(0) {}
+    ~DiskCacheFile()
     {
-        CCLOG("cocos2d: TextureCache: texture: %s", pElement->getStrKey());
-        Texture2D *value = static_cast<Texture2D*>(pElement->getObject());
-        if (value->retainCount() == 1)
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+        if (_data)
         {
-            CCLOG("cocos2d: TextureCache: removing unused texture: %s", pElement->getStrKey());
-            _textures->removeObjectForElememt(pElement);
+            munmap(_data, _size);
         }
+#else
+        CC_SAFE_DELETE_ARRAY(_data);
+#endif
     }
-     */
-    
-    /** Inter engineer zhuoshi sun finds that this way will get better performance
-     */    
-    if (_textures->count())
-    {   
-        // find elements to be removed
-        DictElement* pElement = NULL;
-        list<DictElement*> elementToRemove;
-        CCDICT_FOREACH(_textures, pElement)
-        {
-            CCLOG("cocos2d: TextureCache: texture: %s", pElement->getStrKey());
-            Texture2D *value = static_cast<Texture2D*>(pElement->getObject());
-            if (value->retainCount() == 1)
+
+    bool open(const std::string& path)
+    {
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
             {
-                elementToRemove.push_back(pElement);
+                _data = (unsigned char*)data;
+                _size = st.st_size;
             }
         }
-        
-        // remove elements
-        for (auto iter = elementToRemove.begin(); iter != elementToRemove.end(); ++iter)
+        close(fd);
+#else
+        FILE* fp = fopen(path.c_str(), "rb");
+        if (! fp)
+        {
+            return false;
+        }
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        if (size > 0)
         {
-            CCLOG("cocos2d: TextureCache: removing unused texture: %s", (*iter)->getStrKey());
-            _textures->removeObjectForElememt(*iter);
+            _data = new unsigned char[size];
+            _size = fread(_data, 1, size, fp);
         }
+        fclose(fp);
+#endif
+        return _data != NULL;
     }
+
+    inline const unsigned char* getData() const { return _data; }
+    inline size_t getSize() const { return _size; }
+
+private:
+    unsigned char* _data;
+    size_t _size;
+};
+
+static unsigned int getDataLengthForFormat(const Texture2D* texture, Texture2D::PixelFormat format, unsigned int width, unsigned int height)
+{
+    // bitsPerPixelForFormat returns 32 for RGB888, see Texture2D::initWithData()
+    unsigned int bitsPerPixel = (format == Texture2D::PixelFormat::RGB888) ? 24 : texture->getBitsPerPixelForFormat(format);
+    return width * height * bitsPerPixel / 8;
 }
 
-void TextureCache::removeTexture(Texture2D* texture)
+std::string TextureCache::getDiskCachePath(const std::string& fullpath) const
 {
-    if( ! texture )
+    // an entry is kept per image and per conversion setting
+    char key[32];
+    snprintf(key, sizeof(key), "#%d#%d", (int)Texture2D::getDefaultAlphaPixelFormat(), Texture2D::isDitheringEnabled() ? 1 : 0);
+    size_t hash = std::hash<std::string>()(fullpath + key);
+
+    char name[48];
+    snprintf(name, sizeof(name), "texcache-%016llx.bin", (unsigned long long)hash);
+    return FileUtils::getInstance()->getWritablePath() + name;
+}
+
+Texture2D* TextureCache::loadTextureFromDiskCache(const std::string& fullpath)
+{
+    Texture2D* texture = new Texture2D();
+    if (! initTextureFromDiskCache(texture, fullpath))
     {
-        return;
+        CC_SAFE_RELEASE(texture);
+        return NULL;
     }
-
-    Array* keys = _textures->allKeysForObject(texture);
-    _textures->removeObjectsForKeys(keys);
+    return texture;
 }
 
-void TextureCache::removeTextureForKey(const char *textureKeyName)
+bool TextureCache::initTextureFromDiskCache(Texture2D* texture, const std::string& fullpath)
 {
-    if (textureKeyName == NULL)
+    struct stat st;
+    if (stat(fullpath.c_str(), &st) != 0)
     {
-        return;
+        return false;
     }
 
-    string fullPath = FileUtils::getInstance()->fullPathForFilename(textureKeyName);
-    _textures->removeObjectForKey(fullPath);
-}
+    DiskCacheFile file;
+    if (! file.open(getDiskCachePath(fullpath)) || file.getSize() < sizeof(DiskCacheHeader))
+    {
+        return false;
+    }
+
+    DiskCacheHeader header;
+    memcpy(&header, file.getData(), sizeof(header));
+    if (memcmp(header.magic, DISK_CACHE_MAGIC, sizeof(DISK_CACHE_MAGIC)) != 0
+        || header.version != DISK_CACHE_VERSION
+        || header.sourceTime != (uint64_t)st.st_mtime
+        || header.pathLength != fullpath.length()
+        || file.getSize() != sizeof(header) + header.pathLength + header.dataLength
+        || memcmp(file.getData() + sizeof(header), fullpath.c_str(), header.pathLength) != 0)
+    {
+        // stale entry, it is overwritten when the image is converted
+        return false;
+    }
+
+    // only the formats Texture2D::convertImageData() produces
+    Texture2D::PixelFormat pixelFormat = (Texture2D::PixelFormat)header.pixelFormat;
+    if (pixelFormat != Texture2D::PixelFormat::RGBA8888 && pixelFormat != Texture2D::PixelFormat::RGB888
+        && pixelFormat != Texture2D::PixelFormat::RGB565 && pixelFormat != Texture2D::PixelFormat::RGBA4444
+        && pixelFormat != Texture2D::PixelFormat::RGB5A1 && pixelFormat != Texture2D::PixelFormat::A8
+        && pixelFormat != Texture2D::PixelFormat::AI88 && pixelFormat != Texture2D::PixelFormat::I8)
+    {
+        return false;
+    }
+
+    const unsigned char* data = file.getData() + sizeof(header) + header.pathLength;
+    if (header.dataLength != getDataLengthForFormat(texture, pixelFormat, header.width, header.height)
+        || ! texture->initWithData(data, pixelFormat, header.width, header.height, Size((float)header.width, (float)header.height)))
+    {
+        return false;
+    }
+    texture->_hasPremultipliedAlpha = (header.premultipliedAlpha != 0);
+    return true;
+}
+
+bool TextureCache::initTextureAndSaveToDiskCache(Texture2D* texture, Image* image, const std::string& fullpath)
+{
+    struct stat st;
+    unsigned int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+    if (stat(fullpath.c_str(), &st) != 0 || image->getWidth() > maxTextureSize || image->getHeight() > maxTextureSize)
+    {
+        return texture->initWithImage(image);
+    }
+
+    Texture2D::PixelFormat pixelFormat;
+    const unsigned char* data = texture->convertImageData(image, pixelFormat);
+    unsigned int width = image->getWidth();
+    unsigned int height = image->getHeight();
+    if (! texture->initWithData(data, pixelFormat, width, height, Size((float)width, (float)height)))
+    {
+        return false;
+    }
+    texture->_hasPremultipliedAlpha = image->isPremultipliedAlpha();
+
+    DiskCacheHeader header;
+    memcpy(header.magic, DISK_CACHE_MAGIC, sizeof(DISK_CACHE_MAGIC));
+    header.version = DISK_CACHE_VERSION;
+    header.sourceTime = (uint64_t)st.st_mtime;
+    header.pixelFormat = (uint32_t)pixelFormat;
+    header.width = width;
+    header.height = height;
+    header.premultipliedAlpha = image->isPremultipliedAlpha() ? 1 : 0;
+    header.pathLength = fullpath.length();
+    header.dataLength = getDataLengthForFormat(texture, pixelFormat, width, height);
+
+    // write a temporary file first, so that an interrupted write never leaves a truncated entry
+    std::string cachePath = getDiskCachePath(fullpath);
+    std::string tempPath = cachePath + ".tmp";
+    FILE* fp = fopen(tempPath.c_str(), "wb");
+    if (! fp)
+    {
+        CCLOG("cocos2d: TextureCache: can't write the disk cache entry of %s", fullpath.c_str());
+        return true;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1
+        && fwrite(fullpath.c_str(), 1, header.pathLength, fp) == header.pathLength
+        && fwrite(data, 1, header.dataLength, fp) == header.dataLength;
+    written = (fclose(fp) == 0) && written;
+
+    // rename() doesn't replace an existing file on Windows
+    remove(cachePath.c_str());
+    if (! written || rename(tempPath.c_str(), cachePath.c_str()) != 0)
+    {
+        remove(tempPath.c_str());
+    }
+    return true;
+}
+
+void TextureCache::loadAlphaTexture(Texture2D* texture, const std::string& fullpath)
+{
+    // "foo.pkm" has its alpha channel in "foo_alpha.pkm"
+    size_t dot = fullpath.find_last_of('.');
+    if (dot == std::string::npos)
+    {
+        return;
+    }
+    std::string alphaPath = fullpath.substr(0, dot) + "_alpha" + fullpath.substr(dot);
+    if (! FileUtils::getInstance()->isFileExist(alphaPath))
+    {
+        return;
+    }
+
+    std::string lowerCase(alphaPath);
+    std::transform(lowerCase.begin(), lowerCase.end(), lowerCase.begin(), ::tolower);
+
+    Texture2D* alphaTexture = new Texture2D();
+    bool bRet = (std::string::npos != lowerCase.find(".ktx"))
+        ? alphaTexture->initWithKTXFile(alphaPath.c_str())
+        : alphaTexture->initWithETCFile(alphaPath.c_str());
+
+    if (bRet && alphaTexture->getPixelsWide() == texture->getPixelsWide() && alphaTexture->getPixelsHigh() == texture->getPixelsHigh())
+    {
+        texture->setAlphaTexture(alphaTexture);
+    }
+    else
+    {
+        CCLOG("cocos2d: TextureCache: invalid alpha texture: %s", alphaPath.c_str());
+    }
+    alphaTexture->release();
+}
+
+Texture2D* TextureCache::addETCImage(const char* path)
+{
+    CCASSERT(path != NULL, "TextureCache: fileimage MUST not be nil");
+    
+    Texture2D* texture = NULL;
+    std::string key(path);
+    
+    if( (texture = (Texture2D*)_textures.objectForKey(key)) )
+    {
+        return touchTexture(texture);
+    }
+    
+    // Split up directory and filename
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(key.c_str());
+    texture = new Texture2D();
+    if(texture != NULL && texture->initWithETCFile(fullpath.c_str()))
+    {
+        loadAlphaTexture(texture, fullpath);
+        cacheTexture(texture, key);
+        texture->autorelease();
+    }
+    else
+    {
+        CCLOG("cocos2d: Couldn't add ETCImage:%s in TextureCache",key.c_str());
+        CC_SAFE_DELETE(texture);
+    }
+    
+    return texture;
+}
+
+Texture2D* TextureCache::addUIImage(Image *image, const char *key)
+{
+    CCASSERT(image != NULL, "TextureCache: image MUST not be nil");
+
+    Texture2D * texture = NULL;
+    // textureForKey() use full path,so the key should be full path
+    std::string forKey;
+    if (key)
+    {
+        forKey = FileUtils::getInstance()->fullPathForFilename(key);
+    }
+
+    // Don't have to lock here, because addImageAsync() will not 
+    // invoke opengl function in loading thread.
+
+    do 
+    {
+        // If key is nil, then create a new texture each time
+        if(key && (texture = (Texture2D *)_textures.objectForKey(forKey)))
+        {
+            touchTexture(texture);
+            break;
+        }
+
+        // prevents overloading the autorelease pool
+        texture = new Texture2D();
+        texture->initWithImage(image);
+
+        if(key && texture)
+        {
+            cacheTexture(texture, forKey);
+            texture->autorelease();
+        }
+        else
+        {
+            CCLOG("cocos2d: Couldn't add UIImage in TextureCache");
+        }
+
+    } while (0);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    VolatileTexture::addImage(texture, image);
+#endif
+    
+    return texture;
+}
+
+// TextureCache - Remove
+
+void TextureCache::removeAllTextures()
+{
+    _textures.removeAllObjects();
+}
+
+void TextureCache::streamMipmaps(float dt)
+{
+    CC_UNUSED_PARAM(dt);
+
+    while (! _streamedTextures.empty())
+    {
+        Texture2D* texture = _streamedTextures.front();
+
+        // the texture was removed from the cache and nobody uses it, or its video memory was released
+        bool stop = texture->retainCount() == 1 || texture->isHibernated();
+        if (! stop && texture->streamMipmap())
+        {
+            break;
+        }
+
+        texture->stopStreaming();
+        texture->release();
+        _streamedTextures.pop_front();
+        if (! stop)
+        {
+            // the texture is complete, the next one is streamed in the next frame
+            break;
+        }
+    }
+
+    if (_streamedTextures.empty())
+    {
+        Director::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(TextureCache::streamMipmaps), this);
+    }
+}
+
+void TextureCache::stopMipmapStreaming()
+{
+    if (_streamedTextures.empty())
+    {
+        return;
+    }
+
+    for (auto texture : _streamedTextures)
+    {
+        texture->stopStreaming();
+        texture->release();
+    }
+    _streamedTextures.clear();
+    Director::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(TextureCache::streamMipmaps), this);
+}
+
+void TextureCache::removeUnusedTextures()
+{
+    stopMipmapStreaming();
+
+    _textures.removeObjectsIf([](const char* key, Object* texture) {
+        CCLOG("cocos2d: TextureCache: texture: %s", key);
+        if (texture->retainCount() == 1)
+        {
+            CCLOG("cocos2d: TextureCache: removing unused texture: %s", key);
+            return true;
+        }
+        return false;
+    });
+}
+
+void TextureCache::removeTexture(Texture2D* texture)
+{
+    if( ! texture )
+    {
+        return;
+    }
+
+    _textures.removeObjectsIf([=](const char*, Object* object) {
+        return object == texture;
+    });
+}
+
+void TextureCache::removeTextureForKey(const char *textureKeyName)
+{
+    if (textureKeyName == NULL)
+    {
+        return;
+    }
+
+    string fullPath = FileUtils::getInstance()->fullPathForFilename(textureKeyName);
+    _textures.removeObjectForKey(fullPath);
+}
 
 Texture2D* TextureCache::textureForKey(const char* key)
 {
-    return static_cast<Texture2D*>(_textures->objectForKey(FileUtils::getInstance()->fullPathForFilename(key)));
+    Texture2D* texture = static_cast<Texture2D*>(_textures.objectForKey(FileUtils::getInstance()->fullPathForFilename(key)));
+    if (texture)
+    {
+        touchTexture(texture);
+    }
+    return texture;
+}
+
+// RGBA8888 white image, 2 by 2
+static unsigned char cc_2x2_white_image[] = {
+    0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF
+};
+
+#define CC_2x2_WHITE_IMAGE_KEY  "cc_2x2_white_image"
+
+Texture2D* TextureCache::getWhiteTexture()
+{
+    Texture2D* texture = static_cast<Texture2D*>(_textures.objectForKey(CC_2x2_WHITE_IMAGE_KEY));
+    if (texture)
+    {
+        return touchTexture(texture);
+    }
+
+    Image* image = new Image();
+    bool isOK = image->initWithImageData(cc_2x2_white_image, sizeof(cc_2x2_white_image), Image::Format::RAW_DATA, 2, 2, 8);
+    CCASSERT(isOK, "The 2x2 white texture was created unsuccessfully.");
+    CC_UNUSED_PARAM(isOK);
+
+    texture = addUIImage(image, CC_2x2_WHITE_IMAGE_KEY);
+    CC_SAFE_RELEASE(image);
+    if (texture)
+    {
+        texture->setPinned(true);
+    }
+    return texture;
+}
+
+void TextureCache::reloadAllTextures()
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    VolatileTexture::reloadAllTextures();
+#endif
+}
+
+// TextureCache - Memory budget
+
+void TextureCache::setMemoryBudget(unsigned int bytes)
+{
+    _memoryBudget = bytes;
+    evictTextures(nullptr);
+}
+
+unsigned int TextureCache::getTotalMemory() const
+{
+    unsigned int totalBytes = 0;
+
+    for (auto entry : _textures)
+    {
+        totalBytes += static_cast<Texture2D*>(entry.object)->getMemorySize();
+    }
+    return totalBytes;
+}
+
+void TextureCache::setTextureEvictedCallback(const std::function<void(const std::string&)>& callback)
+{
+    _textureEvictedCallback = callback;
+}
+
+// '*' matches any characters, '?' one character
+static bool matchesPattern(const char* str, const char* pattern)
+{
+    const char* starPattern = nullptr;
+    const char* starStr = nullptr;
+
+    while (*str)
+    {
+        if (*pattern == '*')
+        {
+            starPattern = ++pattern;
+            starStr = str;
+        }
+        else if (*pattern == '?' || *pattern == *str)
+        {
+            ++pattern;
+            ++str;
+        }
+        else if (starPattern)
+        {
+            // let the last '*' match one more character
+            pattern = starPattern;
+            str = ++starStr;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pattern == '*')
+    {
+        ++pattern;
+    }
+    return *pattern == '\0';
+}
+
+void TextureCache::setTexturePolicy(const std::string& pattern, const TexturePolicy& policy)
+{
+    removeTexturePolicy(pattern);
+    _texturePolicies.push_back(std::make_pair(pattern, policy));
+}
+
+void TextureCache::removeTexturePolicy(const std::string& pattern)
+{
+    auto iter = std::find_if(_texturePolicies.begin(), _texturePolicies.end(),
+                             [&pattern](const std::pair<std::string, TexturePolicy>& entry) { return entry.first == pattern; });
+    if (iter != _texturePolicies.end())
+    {
+        _texturePolicies.erase(iter);
+    }
+}
+
+void TextureCache::removeAllTexturePolicies()
+{
+    _texturePolicies.clear();
+}
+
+const TextureCache::TexturePolicy* TextureCache::getTexturePolicy(const std::string& path) const
+{
+    for (auto iter = _texturePolicies.rbegin(); iter != _texturePolicies.rend(); ++iter)
+    {
+        if (matchesPattern(path.c_str(), iter->first.c_str()))
+        {
+            return &iter->second;
+        }
+    }
+    return nullptr;
+}
+
+unsigned int TextureCache::getDownscale(const std::string& fullpath) const
+{
+    const TexturePolicy* policy = getTexturePolicy(fullpath);
+    return policy ? policy->downscale : 0;
+}
+
+void TextureCache::applyTexturePolicy(Texture2D* texture, const std::string& key)
+{
+    const TexturePolicy* policy = getTexturePolicy(key);
+    if (!policy)
+    {
+        return;
+    }
+
+    if (policy->mipmaps && !texture->hasMipmaps())
+    {
+        // the compressed formats can't generate their mipmaps, they must come with the file.
+        // ETC1 files don't set the pixel format of their texture
+        bool compressed = texture->getPixelFormat() >= Texture2D::PixelFormat::PRVTC4
+            || (key.length() >= 4 && key.compare(key.length() - 4, 4, ".pkm") == 0);
+        unsigned int width = texture->getPixelsWide();
+        unsigned int height = texture->getPixelsHigh();
+        if (!compressed && width == ccNextPOT(width) && height == ccNextPOT(height))
+        {
+            texture->generateMipmap();
+        }
+    }
+
+    GLuint minFilter;
+    if (policy->mipmaps && texture->hasMipmaps())
+    {
+        minFilter = policy->antialiased ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+    }
+    else
+    {
+        minFilter = policy->antialiased ? GL_LINEAR : GL_NEAREST;
+    }
+    ccTexParams texParams = { minFilter, (GLuint)(policy->antialiased ? GL_LINEAR : GL_NEAREST), GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE };
+    texture->setTexParameters(texParams);
+    texture->setMaxAnisotropy(policy->anisotropy);
+}
+
+void TextureCache::cacheTexture(Texture2D* texture, const std::string& key)
+{
+    applyTexturePolicy(texture, key);
+    _textures.setObject(texture, key);
+    touchTexture(texture);
+    evictTextures(texture);
+}
+
+Texture2D* TextureCache::touchTexture(Texture2D* texture)
+{
+    texture->_lastAccess = ++_accessCounter;
+    return texture;
+}
+
+void TextureCache::evictTextures(Texture2D* keep)
+{
+    if (_memoryBudget == 0)
+    {
+        return;
+    }
+
+    unsigned int totalBytes = getTotalMemory();
+    if (totalBytes <= _memoryBudget)
+    {
+        return;
+    }
+
+    // only the textures that are retained by the cache alone can be evicted
+    std::vector<StringDictionary::Entry> candidates;
+    for (auto entry : _textures)
+    {
+        Texture2D* tex = static_cast<Texture2D*>(entry.object);
+        if (tex != keep && tex->retainCount() == 1 && !tex->isPinned())
+        {
+            candidates.push_back(entry);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const StringDictionary::Entry& a, const StringDictionary::Entry& b) {
+        return static_cast<Texture2D*>(a.object)->_lastAccess < static_cast<Texture2D*>(b.object)->_lastAccess;
+    });
+
+    // the keys of the entries are only valid until the dictionary is modified: they are copied first
+    std::vector<std::string> evictedKeys;
+    for (auto iter = candidates.begin(); iter != candidates.end() && totalBytes > _memoryBudget; ++iter)
+    {
+        Texture2D* tex = static_cast<Texture2D*>(iter->object);
+        totalBytes -= tex->getMemorySize();
+        evictedKeys.push_back(iter->key);
+        CCLOG("cocos2d: TextureCache: evicting texture: %s", iter->key);
+    }
+    for (auto iter = evictedKeys.begin(); iter != evictedKeys.end(); ++iter)
+    {
+        _textures.removeObjectForKey(*iter);
+    }
+
+    if (totalBytes > _memoryBudget)
+    {
+        CCLOG("cocos2d: TextureCache: %lu KB of textures are in use, the budget of %lu KB is exceeded", (long)totalBytes / 1024, (long)_memoryBudget / 1024);
+    }
+
+    // the callback may add textures to the cache, the loop above must be over
+    if (_textureEvictedCallback)
+    {
+        for (auto iter = evictedKeys.begin(); iter != evictedKeys.end(); ++iter)
+        {
+            _textureEvictedCallback(*iter);
+        }
+    }
+}
+
+void TextureCache::collectTextures(Node *node, std::set<Texture2D*>& textures)
+{
+    TextureProtocol *textureProtocol = dynamic_cast<TextureProtocol*>(node);
+    if (textureProtocol && textureProtocol->getTexture())
+    {
+        Texture2D *texture = textureProtocol->getTexture();
+        textures.insert(texture);
+        if (texture->getAlphaTexture())
+        {
+            textures.insert(texture->getAlphaTexture());
+        }
+    }
+
+    for (auto child : node->getChildren())
+    {
+        collectTextures(child, textures);
+    }
+}
+
+// TextureCache - Hibernation
+
+// reads the pixels of a RGBA8888 texture through a framebuffer it is attached to
+static bool readTexturePixels(Texture2D* texture, std::vector<unsigned char>& pixels)
+{
+    GLuint oldFBO = GL::getBoundFramebuffer();
+    GLuint fbo = 0;
+    glGenFramebuffers(1, &fbo);
+    GL::bindFramebuffer(fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->getName(), 0);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete)
+    {
+        unsigned int width = texture->getPixelsWide();
+        unsigned int height = texture->getPixelsHigh();
+        pixels.resize(width * height * 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, (GLsizei)width, (GLsizei)height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    }
+
+    GL::bindFramebuffer(oldFBO);
+    GL::deleteFramebuffer(fbo);
+    return complete;
 }
 
-void TextureCache::reloadAllTextures()
+std::vector<Texture2D*> TextureCache::hibernateTextures(const std::set<Texture2D*>& textures, bool keepPixels)
 {
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    VolatileTexture::reloadAllTextures();
-#endif
+    std::vector<Texture2D*> hibernated;
+
+    // the keys of the cached textures, to reload them from their file
+    std::unordered_map<Texture2D*, std::string> keys;
+    for (auto entry : _textures)
+    {
+        Texture2D* texture = static_cast<Texture2D*>(entry.object);
+        if (textures.find(texture) != textures.end())
+        {
+            keys[texture] = entry.key;
+        }
+    }
+
+    for (auto texture : textures)
+    {
+        if (texture->isHibernated())
+        {
+            hibernated.push_back(texture);
+            continue;
+        }
+
+        // the compressed textures and the ETC1 ones, with an alpha texture, are kept
+        if (texture->_name == 0 || texture->getPixelFormat() >= Texture2D::PixelFormat::PRVTC4 || texture->getAlphaTexture())
+        {
+            continue;
+        }
+
+        std::unique_ptr<Texture2D::Hibernation> hibernation(new Texture2D::Hibernation());
+        auto key = keys.find(texture);
+        if (key != keys.end())
+        {
+            // addUIImage() keys may look like a file name
+            std::string path = key->second;
+            if (computeImageFormatType(path) == Image::Format::UNKOWN || ! FileUtils::getInstance()->isFileExist(path))
+            {
+                continue;
+            }
+            hibernation->key = path;
+        }
+        else if (! keepPixels || texture->getPixelFormat() != Texture2D::PixelFormat::RGBA8888
+                 || ! readTexturePixels(texture, hibernation->pixels))
+        {
+            continue;
+        }
+
+        GLint params[4];
+        GL::bindTexture2D(texture->_name);
+        glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &params[0]);
+        glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, &params[1]);
+        glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, &params[2]);
+        glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, &params[3]);
+        ccTexParams texParams = { (GLuint)params[0], (GLuint)params[1], (GLuint)params[2], (GLuint)params[3] };
+        hibernation->texParams = texParams;
+        hibernation->contentSize = texture->_contentSize;
+        hibernation->hasPremultipliedAlpha = texture->_hasPremultipliedAlpha;
+        hibernation->hasMipmaps = texture->_hasMipmaps;
+        hibernation->maxAnisotropy = texture->_maxAnisotropy;
+
+        // the levels are redefined empty: their memory is released, but the name and the framebuffers using it stay valid
+        unsigned int width = texture->_pixelsWide;
+        unsigned int height = texture->_pixelsHigh;
+        for (GLint level = 0; ; ++level)
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            if (! texture->_hasMipmaps || (width <= 1 && height <= 1))
+            {
+                break;
+            }
+            width = MAX(1u, width / 2);
+            height = MAX(1u, height / 2);
+        }
+
+        texture->_hibernation = hibernation.release();
+        hibernated.push_back(texture);
+    }
+
+    return hibernated;
+}
+
+void TextureCache::wakeTextures(const std::vector<Texture2D*>& textures, const std::function<void()>& callback)
+{
+    // shared by the requests, the last one to complete calls the callback
+    std::shared_ptr<unsigned int> pending = std::make_shared<unsigned int>(1);
+    auto complete = [pending, callback](Texture2D*) {
+        if (--*pending == 0 && callback)
+        {
+            callback();
+        }
+    };
+
+    for (auto texture : textures)
+    {
+        Texture2D::Hibernation* hibernation = texture->_hibernation;
+        if (hibernation == nullptr)
+        {
+            continue;
+        }
+
+        // the pixels kept in memory are uploaded now, like the textures removed from the cache meanwhile
+        if (hibernation->key.empty() || _textures.objectForKey(hibernation->key) != texture)
+        {
+            wakeTexture(texture);
+            continue;
+        }
+
+        ++*pending;
+        addImageAsync(hibernation->key.c_str(), complete);
+    }
+
+    // the reference held while the requests were added
+    complete(nullptr);
+}
+
+void TextureCache::wakeTexture(Texture2D* texture)
+{
+    Texture2D::Hibernation* hibernation = texture->_hibernation;
+    if (hibernation == nullptr)
+    {
+        return;
+    }
+
+    RefPtr<Image> image;
+    if (! hibernation->key.empty())
+    {
+        CC_PROFILE_ZONE("TextureCache - wake texture");
+
+        image = RefPtr<Image>::adopt(new Image());
+        image->setDecodeDownscale(getDownscale(hibernation->key));
+        if (! image->initWithImageFile(hibernation->key.c_str(), computeImageFormatType(hibernation->key)))
+        {
+            image = nullptr;
+        }
+    }
+    restoreTexture(texture, image);
+}
+
+void TextureCache::restoreTexture(Texture2D* texture, Image* image)
+{
+    Texture2D::Hibernation* hibernation = texture->_hibernation;
+    if (hibernation == nullptr)
+    {
+        return;
+    }
+    // cleared first, the texture is used below
+    texture->_hibernation = nullptr;
+
+    bool restored;
+    if (! hibernation->key.empty())
+    {
+        restored = image != nullptr && texture->initWithImage(image);
+    }
+    else
+    {
+        restored = texture->initWithData(&hibernation->pixels[0], Texture2D::PixelFormat::RGBA8888,
+                                         texture->_pixelsWide, texture->_pixelsHigh, hibernation->contentSize);
+        texture->_hasPremultipliedAlpha = hibernation->hasPremultipliedAlpha;
+    }
+
+    if (restored)
+    {
+        if (hibernation->hasMipmaps && ! texture->hasMipmaps())
+        {
+            texture->generateMipmap();
+        }
+        texture->setTexParameters(hibernation->texParams);
+        if (hibernation->maxAnisotropy > 1.0f)
+        {
+            texture->setMaxAnisotropy(hibernation->maxAnisotropy);
+        }
+    }
+    else
+    {
+        CCLOG("cocos2d: TextureCache: couldn't wake up the texture %s", hibernation->key.c_str());
+    }
+
+    delete hibernation;
 }
 
 void TextureCache::dumpCachedTextureInfo()
@@ -610,17 +1665,16 @@ void TextureCache::dumpCachedTextureInfo()
     unsigned int count = 0;
     unsigned int totalBytes = 0;
 
-    DictElement* pElement = NULL;
-    CCDICT_FOREACH(_textures, pElement)
+    for (auto entry : _textures)
     {
-        Texture2D* tex = static_cast<Texture2D*>(pElement->getObject());
+        Texture2D* tex = static_cast<Texture2D*>(entry.object);
         unsigned int bpp = tex->getBitsPerPixelForFormat();
         // Each texture takes up width * height * bytesPerPixel bytes.
         unsigned int bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
         totalBytes += bytes;
         count++;
         CCLOG("cocos2d: \"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB",
-               pElement->getStrKey(),
+               entry.key,
                (long)tex->retainCount(),
                (long)tex->getName(),
                (long)tex->getPixelsWide(),
@@ -630,6 +1684,10 @@ void TextureCache::dumpCachedTextureInfo()
     }
 
     CCLOG("cocos2d: TextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
+    if (_memoryBudget)
+    {
+        CCLOG("cocos2d: TextureCache memory budget: %lu KB", (long)_memoryBudget / 1024);
+    }
 }
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -651,11 +1709,17 @@ VolatileTexture::VolatileTexture(Texture2D *t)
     _texParams.magFilter = GL_LINEAR;
     _texParams.wrapS = GL_CLAMP_TO_EDGE;
     _texParams.wrapT = GL_CLAMP_TO_EDGE;
+    _generateMipmap = false;
+    _maxAnisotropy = 1.0f;
     _textures.push_back(this);
 }
 
 VolatileTexture::~VolatileTexture()
 {
+    if (_reloadTask)
+    {
+        JobSystem::getInstance()->cancelTask(_reloadTask);
+    }
     _textures.remove(this);
     CC_SAFE_RELEASE(_uiImage);
 }
@@ -748,6 +1812,20 @@ void VolatileTexture::setTexParameters(Texture2D *t, const ccTexParams &texParam
         vt->_texParams.wrapT = texParams.wrapT;
 }
 
+void VolatileTexture::setGenerateMipmap(Texture2D *t)
+{
+    VolatileTexture *vt = findVolotileTexture(t);
+
+    vt->_generateMipmap = true;
+}
+
+void VolatileTexture::setMaxAnisotropy(Texture2D *t, float anisotropy)
+{
+    VolatileTexture *vt = findVolotileTexture(t);
+
+    vt->_maxAnisotropy = anisotropy;
+}
+
 void VolatileTexture::removeTexture(Texture2D *t) 
 {
     auto i = _textures.begin();
@@ -762,82 +1840,263 @@ void VolatileTexture::removeTexture(Texture2D *t)
     }
 }
 
-void VolatileTexture::reloadAllTextures()
+bool VolatileTexture::needsDecoding() const
 {
-    _isReloading = true;
+    if (_cashedImageType != kImageFile)
+    {
+        return false;
+    }
 
-    CCLOG("reload all texture");
-    auto iter = _textures.begin();
+    std::string lowerCase(_fileName);
+    std::transform(lowerCase.begin(), lowerCase.end(), lowerCase.begin(), ::tolower);
+    return std::string::npos == lowerCase.find(".pvr") && std::string::npos == lowerCase.find(".ktx");
+}
 
-    while (iter != _textures.end())
+bool VolatileTexture::reloadFromDiskCache()
+{
+    TextureCache *cache = TextureCache::getInstance();
+    if (! cache->isDiskCacheEnabled() || ! needsDecoding() || _texture->getDownscale() > 0)
     {
-        VolatileTexture *vt = *iter++;
+        return false;
+    }
 
-        switch (vt->_cashedImageType)
-        {
-        case kImageFile:
-            {
-                std::string lowerCase(vt->_fileName.c_str());
-                for (unsigned int i = 0; i < lowerCase.length(); ++i)
-                {
-                    lowerCase[i] = tolower(lowerCase[i]);
-                }
+    // the entries are kept per default pixel format
+    Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
+    Texture2D::setDefaultAlphaPixelFormat(_pixelFormat);
+    _isReloading = true;
+    bool loaded = cache->initTextureFromDiskCache(_texture, _fileName);
+    _isReloading = false;
+    Texture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
 
-                if (std::string::npos != lowerCase.find(".pvr")) 
-                {
-                    Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
-                    Texture2D::setDefaultAlphaPixelFormat(vt->_pixelFormat);
+    if (loaded)
+    {
+        restoreTexParameters();
+    }
+    return loaded;
+}
 
-                    vt->_texture->initWithPVRFile(vt->_fileName.c_str());
-                    Texture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
-                } 
-                else 
-                {
-                    Image* pImage = new Image();
-                    unsigned long nSize = 0;
-                    unsigned char* pBuffer = FileUtils::getInstance()->getFileData(vt->_fileName.c_str(), "rb", &nSize);
+void VolatileTexture::reload(Image *decodedImage)
+{
+    if (! decodedImage && reloadFromDiskCache())
+    {
+        return;
+    }
 
-                    if (pImage && pImage->initWithImageData((void*)pBuffer, nSize, vt->_fmtImage))
-                    {
-                        Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
-                        Texture2D::setDefaultAlphaPixelFormat(vt->_pixelFormat);
-                        vt->_texture->initWithImage(pImage);
-                        Texture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
-                    }
+    _isReloading = true;
 
-                    CC_SAFE_DELETE_ARRAY(pBuffer);
-                    CC_SAFE_RELEASE(pImage);
-                }
+    switch (_cashedImageType)
+    {
+    case kImageFile:
+        {
+            std::string lowerCase(_fileName.c_str());
+            for (unsigned int i = 0; i < lowerCase.length(); ++i)
+            {
+                lowerCase[i] = tolower(lowerCase[i]);
             }
-            break;
-        case kImageData:
+
+            if (std::string::npos != lowerCase.find(".pvr")) 
+            {
+                Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
+                Texture2D::setDefaultAlphaPixelFormat(_pixelFormat);
+
+                _texture->initWithPVRFile(_fileName.c_str(), _texture->getDownscale());
+                Texture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
+            } 
+            else if (std::string::npos != lowerCase.find(".ktx"))
             {
-                vt->_texture->initWithData(vt->_textureData, 
-                                          vt->_pixelFormat, 
-                                          vt->_textureSize.width, 
-                                          vt->_textureSize.height, 
-                                          vt->_textureSize);
+                _texture->initWithKTXFile(_fileName.c_str());
             }
-            break;
-        case kString:
+            else if (decodedImage)
             {
-                vt->_texture->initWithString(vt->_text.c_str(), vt->_fontDefinition);
+                Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
+                Texture2D::setDefaultAlphaPixelFormat(_pixelFormat);
+                _texture->initWithImage(decodedImage);
+                Texture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
             }
-            break;
-        case kImage:
+            else 
             {
-                vt->_texture->initWithImage(vt->_uiImage);
+                Image* pImage = new Image();
+                unsigned long nSize = 0;
+                unsigned char* pBuffer = FileUtils::getInstance()->getFileData(_fileName.c_str(), "rb", &nSize);
+
+                pImage->setDecodeDownscale(_texture->getDownscale());
+                if (pImage && pImage->initWithImageData((void*)pBuffer, nSize, _fmtImage))
+                {
+                    Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
+                    Texture2D::setDefaultAlphaPixelFormat(_pixelFormat);
+                    _texture->initWithImage(pImage);
+                    Texture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
+                }
+
+                CC_SAFE_DELETE_ARRAY(pBuffer);
+                CC_SAFE_RELEASE(pImage);
             }
-            break;
-        default:
-            break;
         }
-        vt->_texture->setTexParameters(vt->_texParams);
+        break;
+    case kImageData:
+        {
+            _texture->initWithData(_textureData, 
+                                   _pixelFormat, 
+                                   _textureSize.width, 
+                                   _textureSize.height, 
+                                   _textureSize);
+        }
+        break;
+    case kString:
+        {
+            _texture->initWithString(_text.c_str(), _fontDefinition);
+        }
+        break;
+    case kImage:
+        {
+            _texture->initWithImage(_uiImage);
+        }
+        break;
+    default:
+        break;
+    }
+
+    _isReloading = false;
+
+    restoreTexParameters();
+}
+
+void VolatileTexture::restoreTexParameters()
+{
+    _isReloading = true;
+
+    // the mipmaps of the PVR and KTX files are reloaded with them
+    if (_generateMipmap && !_texture->hasMipmaps())
+    {
+        _texture->generateMipmap();
+    }
+    _texture->setTexParameters(_texParams);
+    if (_maxAnisotropy > 1.0f)
+    {
+        _texture->setMaxAnisotropy(_maxAnisotropy);
     }
 
     _isReloading = false;
 }
 
+void VolatileTexture::reloadAllTextures()
+{
+    CCLOG("reload all texture");
+
+    // the names of the lost context are given again to the reloaded textures: until they are reloaded,
+    // the other textures must not be drawn with the name of another one
+    for (auto iter = _textures.begin(); iter != _textures.end(); ++iter)
+    {
+        VolatileTexture *vt = *iter;
+        if (vt->_reloadTask)
+        {
+            JobSystem::getInstance()->cancelTask(vt->_reloadTask);
+            vt->_reloadTask = nullptr;
+        }
+        vt->_texture->_name = 0;
+    }
+
+    // the textures of the running scene are needed by the first frame
+    std::set<Texture2D*> sceneTextures;
+    Scene *scene = Director::getInstance()->getRunningScene();
+    if (scene)
+    {
+        TextureCache::collectTextures(scene, sceneTextures);
+    }
+
+    std::vector<VolatileTexture*> urgent;
+    std::vector<VolatileTexture*> deferred;
+    for (auto iter = _textures.begin(); iter != _textures.end(); ++iter)
+    {
+        VolatileTexture *vt = *iter;
+        if (vt->_texture->isHibernated())
+        {
+            // reloaded when it is woken up
+            continue;
+        }
+        if (sceneTextures.find(vt->_texture) != sceneTextures.end())
+        {
+            urgent.push_back(vt);
+        }
+        else
+        {
+            deferred.push_back(vt);
+        }
+    }
+
+    // the images missing from the disk cache are decoded in parallel, the other textures are reloaded meanwhile
+    std::vector<VolatileTexture*> decoding;
+    for (auto iter = urgent.begin(); iter != urgent.end(); ++iter)
+    {
+        VolatileTexture *vt = *iter;
+        if (vt->needsDecoding() && ! vt->reloadFromDiskCache())
+        {
+            decoding.push_back(vt);
+        }
+    }
+
+    std::vector<RefPtr<Image>> images(decoding.size());
+    JobSystem::getInstance()->parallelFor(decoding.size(), 1, [&decoding, &images](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            RefPtr<Image> image = RefPtr<Image>::adopt(new Image());
+            image->setDecodeDownscale(decoding[i]->_texture->getDownscale());
+            if (image->initWithImageFileThreadSafe(decoding[i]->_fileName.c_str(), decoding[i]->_fmtImage))
+            {
+                images[i] = std::move(image);
+            }
+        }
+    });
+
+    for (auto iter = urgent.begin(); iter != urgent.end(); ++iter)
+    {
+        VolatileTexture *vt = *iter;
+        if (! vt->needsDecoding())
+        {
+            vt->reload(nullptr);
+        }
+    }
+    for (size_t i = 0; i < decoding.size(); ++i)
+    {
+        // an image that couldn't be decoded is loaded again, and reported, by reload()
+        decoding[i]->reload(images[i]);
+    }
+
+    // the most recently used textures are reloaded first
+    std::stable_sort(deferred.begin(), deferred.end(), [](const VolatileTexture* a, const VolatileTexture* b) {
+        return a->_texture->_lastAccess > b->_texture->_lastAccess;
+    });
+
+    int priority = 0;
+    for (auto iter = deferred.begin(); iter != deferred.end(); ++iter)
+    {
+        VolatileTexture *vt = *iter;
+
+        // the images found in the disk cache don't need to be decoded
+        std::shared_ptr<RefPtr<Image>> image = std::make_shared<RefPtr<Image>>();
+        unsigned int downscale = vt->_texture->getDownscale();
+        bool decode = vt->needsDecoding() && (! TextureCache::getInstance()->isDiskCacheEnabled() || downscale > 0);
+        std::string fileName = vt->_fileName;
+        Image::Format format = vt->_fmtImage;
+
+        vt->_reloadTask = JobSystem::getInstance()->addTask([image, decode, fileName, format, downscale] {
+            if (decode)
+            {
+                RefPtr<Image> decoded = RefPtr<Image>::adopt(new Image());
+                decoded->setDecodeDownscale(downscale);
+                if (decoded->initWithImageFileThreadSafe(fileName.c_str(), format))
+                {
+                    *image = std::move(decoded);
+                }
+            }
+        }, [vt, image] {
+            // the task is cancelled when the texture is released
+            vt->_reloadTask = nullptr;
+            vt->reload(*image);
+        }, priority--);
+    }
+}
+
 #endif // CC_ENABLE_CACHE_TEXTURE_DATA
 
 NS_CC_END
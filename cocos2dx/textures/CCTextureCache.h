@@ -28,16 +28,20 @@ THE SOFTWARE.
 #define __CCTEXTURE_CACHE_H__
 
 #include <string>
-#include <mutex>
-#include <thread>
-#include <condition_variable>
-#include <queue>
+#include <memory>
+#include <deque>
+#include <vector>
 #include <string>
+#include <functional>
+#include <set>
 
 #include "cocoa/CCObject.h"
 #include "cocoa/CCDictionary.h"
+#include "cocoa/CCRefPtr.h"
+#include "cocoa/CCStringDictionary.h"
 #include "textures/CCTexture2D.h"
 #include "platform/CCImage.h"
+#include "support/CCJobSystem.h"
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     #include "platform/CCImage.h"
@@ -46,6 +50,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+class Node;
+
 /**
  * @addtogroup textures
  * @{
@@ -74,6 +80,9 @@ public:
 
     /** Reload all textures
      It's only useful when the value of CC_ENABLE_CACHE_TEXTURE_DATA is 1
+     The textures of the running scene are reloaded before returning, their images being decoded in parallel.
+     The other ones are decoded by the JobSystem and uploaded in the next frames, the most recently used first:
+     until then they are drawn as an unbound texture. Decoded images kept in the disk cache are used when enabled.
      */
     static void reloadAllTextures();
 
@@ -95,13 +104,52 @@ public:
 
     /* Returns a Texture2D object given a file image
     * If the file image was not previously loaded, it will create a new Texture2D object and it will return it.
-    * Otherwise it will load a texture in a new thread, and when the image is loaded, the callback will be called with the Texture2D as a parameter.
+    * Otherwise the image is decoded by a task of the JobSystem, and when the image is loaded, the callback will be called with the Texture2D as a parameter.
     * The callback will be called from the main thread, so it is safe to create any cocos2d object from the callback.
     * Supported image extensions: .png, .jpg
     * @since v0.8
     */
     virtual void addImageAsync(const char *path, Object *target, SEL_CallFuncO selector);
 
+    /** Same as addImageAsync(path, target, selector), but the images with a higher priority are decoded first.
+    * Images with the same priority are decoded in the order they were requested. The default priority is 0.
+    * @since v3.0
+    */
+    virtual void addImageAsync(const char *path, Object *target, SEL_CallFuncO selector, int priority);
+
+    /** Same as addImageAsync(path, target, selector, priority), but the callback is also called, with NULL,
+    * when the image couldn't be loaded.
+    * @since v3.0
+    */
+    void addImageAsync(const char *path, const std::function<void(Texture2D*)>& callback, int priority = 0);
+
+    /** Cancels the asynchronous loads of an image: the callbacks won't be called and their targets are released.
+    * Images that were already decoded are still added to the cache.
+    * @since v3.0
+    */
+    void unbindImageAsync(const char *path);
+
+    /** Cancels all the asynchronous loads
+    * @since v3.0
+    */
+    void unbindAllImageAsync();
+
+    /** Sets the number of images loaded with addImageAsync() that are decoded at the same time by the JobSystem.
+    * By default it is the number of CPU cores minus one (the main thread), between 1 and 4.
+    * Lowering the count doesn't stop the decoding tasks that are already running.
+    * @since v3.0
+    */
+    void setAsyncLoadingThreadCount(int count);
+    inline int getAsyncLoadingThreadCount() const { return _loadingThreadCount; }
+
+    /** Sets how much time and bytes can be spent per frame to create the textures of the decoded images.
+    * At least one texture is created per frame. When both are 0 (the default), one texture is created per frame.
+    * @param milliseconds time budget per frame, 0 means no time limit
+    * @param bytes texture size budget per frame, 0 means no size limit
+    * @since v3.0
+    */
+    void setAsyncUploadBudget(float milliseconds, unsigned int bytes);
+
     /** Returns a Texture2D object given an UIImage image
     * If the image was not previously loaded, it will create a new Texture2D object and it will return it.
     * Otherwise it will return a reference of a previously loaded image
@@ -115,6 +163,12 @@ public:
     */
     Texture2D* textureForKey(const char* key);
 
+    /** Returns a pinned 2x2 white texture, shared by the sprites without texture and the color layers,
+     so that they are drawn with the same material and batched together by the Renderer.
+     @since v3.0
+     */
+    Texture2D* getWhiteTexture();
+
     /** Purges the dictionary of loaded textures.
     * Call this method if you receive the "Memory Warning"
     * In the short term: it will free some resources preventing your app from being killed
@@ -126,10 +180,17 @@ public:
     /** Removes unused textures
     * Textures that have a retain count of 1 will be deleted
     * It is convenient to call this method after when starting a new Scene
+    * The streamed PVR textures stop at the mipmap levels they already have, see stopMipmapStreaming()
     * @since v0.8
     */
     void removeUnusedTextures();
 
+    /** Stops streaming the mipmaps of the PVR textures, see TexturePolicy::streamed. They keep the levels uploaded
+    * so far and release the data of their files. It is called under memory pressure, by removeUnusedTextures().
+    * @since v3.0
+    */
+    void stopMipmapStreaming();
+
     /** Deletes a texture from the cache given a texture
     */
     void removeTexture(Texture2D* texture);
@@ -145,6 +206,27 @@ public:
     * @since v1.0
     */
     void dumpCachedTextureInfo();
+
+    /** Sets the amount of video memory, in bytes, the cached textures should not exceed.
+    * When a texture is added and the budget is exceeded, the least recently used textures
+    * that are only retained by the cache, and that are not pinned (see Texture2D::setPinned()), are removed.
+    * The budget may still be exceeded if every candidate is in use. 0, the default, means no budget.
+    * @since v3.0
+    */
+    void setMemoryBudget(unsigned int bytes);
+    inline unsigned int getMemoryBudget() const { return _memoryBudget; }
+
+    /** Returns the amount of video memory, in bytes, used by the cached textures
+    * @since v3.0
+    */
+    unsigned int getTotalMemory() const;
+
+    /** Sets a function called with the key of each texture evicted to honor the memory budget.
+    * Evicted textures are reloaded from their file the next time addImage() is called with their key,
+    * the callback is the place to reload textures that were created from other sources (addUIImage(), etc).
+    * @since v3.0
+    */
+    void setTextureEvictedCallback(const std::function<void(const std::string&)>& callback);
     
     /** Returns a Texture2D object given an PVR filename
     * If the file image was not previously loaded, it will create a new Texture2D
@@ -155,51 +237,192 @@ public:
     /** Returns a Texture2D object given an ETC filename
      * If the file image was not previously loaded, it will create a new Texture2D
      *  object and it will return it. Otherwise it will return a reference of a previously loaded image
+     * ETC1 has no alpha channel: if "foo_alpha.pkm" exists beside "foo.pkm", it is loaded as the alpha texture
+     *  of "foo.pkm" (see Texture2D::setAlphaTexture()). The same applies to ETC1 KTX files.
      */
     Texture2D* addETCImage(const char* filename);
 
+    /** Returns a Texture2D object given a KTX filename
+     * If the file image was not previously loaded, it will create a new Texture2D
+     *  object and it will return it. Otherwise it will return a reference of a previously loaded image
+     * @since v3.0
+     */
+    Texture2D* addKTXImage(const char* filename);
+
+    /** Whether or not addImage() loads a compressed version of the images the GPU supports.
+     * For "hero.png", the first existing file among "hero.astc.ktx", "hero.etc2.ktx", "hero.dxt.ktx"
+     * and "hero.etc.ktx" whose format is supported is loaded instead, and cached with the key of "hero.png".
+     * Disabled by default since it looks for up to 4 files each time an image is loaded.
+     * @since v3.0
+     */
+    void setCompressedVariantsEnabled(bool enabled);
+    inline bool isCompressedVariantsEnabled() const { return _compressedVariantsEnabled; }
+
+    /** Whether or not addImage() keeps the converted pixels of the PNG, JPG, TIFF and WebP images in the writable path.
+     * On the next launches the pixels are mapped in memory and uploaded as they are, without decoding and converting the image again.
+     * An entry is used while the modification time of the image, the default alpha pixel format and the dithering setting are unchanged.
+     * Images in archives (Android assets) have no modification time and are never kept.
+     * Disabled by default.
+     * @since v3.0
+     */
+    void setDiskCacheEnabled(bool enabled);
+    inline bool isDiskCacheEnabled() const { return _diskCacheEnabled; }
+
+    /** Filtering applied to the textures of a group when they are added to the cache.
+     * @since v3.0
+     */
+    struct TexturePolicy
+    {
+        TexturePolicy(bool mip = false, bool antiAlias = true, float aniso = 1.0f, unsigned int down = 0, bool stream = false)
+        : mipmaps(mip), antialiased(antiAlias), anisotropy(aniso), downscale(down), streamed(stream) {}
+
+        /** whether or not the textures use mipmaps. The mipmaps of the PVR and KTX files are used when present,
+         * otherwise they are generated for the uncompressed POT textures. The other textures are left without mipmaps. */
+        bool mipmaps;
+        /** linear filtering when true, nearest filtering otherwise */
+        bool antialiased;
+        /** maximum anisotropy of the filtering, see Texture2D::setMaxAnisotropy() */
+        float anisotropy;
+        /** number of halvings applied to the PNG and JPG images while they are decoded, see Image::setDecodeDownscale().
+         * The PVR files skip as many mipmap levels, when they have them. The textures keep the size of their file,
+         * so the sprite frames and the content scale factor are unchanged: it makes a low-memory mode with the same assets.
+         * The downscaled images are not kept in the disk cache. */
+        unsigned int downscale;
+        /** whether the mipmap levels of the PVR files are streamed: the levels up to CC_PVR_STREAMING_INITIAL_SIZE pixels
+         * are uploaded when the texture is added, so it can be used immediately, then one larger level per frame.
+         * The texture keeps its size, so the sprites don't change while its resolution increases. */
+        bool streamed;
+    };
+
+    /** Sets the policy applied to the textures whose full path matches the pattern, in which '*' matches any characters
+     * and '?' one character, e.g. "*.pvr.ccz", or "*terrain/?*" to select a group by its directory. The policy is applied each time a texture is added to the cache,
+     * including the textures reloaded after an eviction, and is kept by the textures reloaded after the GL context is lost.
+     * When several patterns match, the last one set wins. Textures matching no pattern are left untouched.
+     * @since v3.0
+     */
+    void setTexturePolicy(const std::string& pattern, const TexturePolicy& policy);
+    void removeTexturePolicy(const std::string& pattern);
+    void removeAllTexturePolicies();
+
+    /** Returns the policy of the last pattern matching the path, or NULL if none matches
+     * @since v3.0
+     */
+    const TexturePolicy* getTexturePolicy(const std::string& path) const;
+
+    /** Adds the textures used by the node and its children, and their alpha textures
+    * @since v3.0
+    */
+    static void collectTextures(Node *node, std::set<Texture2D*>& textures);
+
+    /** Releases the video memory of textures, keeping the Texture2D objects and their GL names, see Scene::hibernate().
+    * The textures the cache loaded from a PNG, JPG, TIFF or WebP file are reloaded from it. The other RGBA8888 textures,
+    * like the ones of the labels and the render textures, are read back into memory when keepPixels is true.
+    * The other textures, like the compressed ones, keep their video memory.
+    * @return the textures of the set that are hibernated, including the ones that already were
+    * @since v3.0
+    */
+    std::vector<Texture2D*> hibernateTextures(const std::set<Texture2D*>& textures, bool keepPixels);
+
+    /** Reloads hibernated textures. Their images are decoded by the loading tasks and uploaded in the next frames,
+    * like the ones of addImageAsync(), and the callback is called once all of them are back.
+    * @since v3.0
+    */
+    void wakeTextures(const std::vector<Texture2D*>& textures, const std::function<void()>& callback);
+
+    /** Reloads a hibernated texture now
+    * @since v3.0
+    */
+    void wakeTexture(Texture2D* texture);
+
 private:
+    /** downscale of the policy of the path, 0 without policy */
+    unsigned int getDownscale(const std::string& fullpath) const;
     void addImageAsyncCallBack(float dt);
-    void loadImage();
+    /** uploads the next mipmap level of the first streamed texture */
+    void streamMipmaps(float dt);
+    /** starts decoding the queued requests, up to the loading thread count */
+    void startLoadingTasks();
     Image::Format computeImageFormatType(std::string& filename);
+    std::string findCompressedVariant(const std::string& fullpath) const;
+    void loadAlphaTexture(Texture2D* texture, const std::string& fullpath);
+    std::string getDiskCachePath(const std::string& fullpath) const;
+    Texture2D* loadTextureFromDiskCache(const std::string& fullpath);
+    bool initTextureFromDiskCache(Texture2D* texture, const std::string& fullpath);
+    bool initTextureAndSaveToDiskCache(Texture2D* texture, Image* image, const std::string& fullpath);
 
 public:
     struct AsyncStruct
     {
     public:
-        AsyncStruct(const std::string& fn, Object *t, SEL_CallFuncO s) : filename(fn), target(t), selector(s) {}
+        AsyncStruct(const std::string& fn, Object *t, SEL_CallFuncO s, int p = 0) : filename(fn), target(t), selector(s), priority(p) {}
 
         std::string            filename;
         Object    *target;
         SEL_CallFuncO        selector;
+        std::function<void(Texture2D*)> callback;
+        int priority;
     };
 
 protected:
-    typedef struct _ImageInfo
+    struct ImageInfo
     {
+        ImageInfo() : asyncStruct(nullptr), imageType(Image::Format::UNKOWN) {}
+
         AsyncStruct *asyncStruct;
-        Image        *image;
+        // created by the loading task and released by the main thread
+        RefPtr<Image> image;
         Image::Format imageType;
-    } ImageInfo;
+    };
+
+    /** releases the target of the request, and forgets it */
+    void removeAsyncRequest(AsyncStruct* request);
+
+    /** adds a texture to the cache, and evicts textures if the memory budget is exceeded */
+    void cacheTexture(Texture2D* texture, const std::string& key);
+    /** applies the texture policy matching the key, if any */
+    void applyTexturePolicy(Texture2D* texture, const std::string& key);
+    /** uploads again the image or the pixels of a hibernated texture. The texture is left empty when the image is NULL */
+    void restoreTexture(Texture2D* texture, Image* image);
+    /** marks a cached texture as recently used, and returns it */
+    Texture2D* touchTexture(Texture2D* texture);
+    /** removes the least recently used textures, but keep, until the memory budget is honored */
+    void evictTextures(Texture2D* keep);
     
-    std::thread* _loadingThread;
+    int _loadingThreadCount;
+
+    // Only used by the main thread:
+    // requests waiting to be decoded, sorted by priority
+    std::deque<AsyncStruct*> _asyncStructQueue;
+    // the decoding tasks
+    std::vector<JobSystem::TaskPtr> _loadingTasks;
+    // decoded images waiting for their texture
+    std::deque<std::shared_ptr<ImageInfo>> _imageInfoQueue;
+    // all the requests that were not completed yet
+    std::vector<AsyncStruct*> _asyncRequests;
 
-    std::queue<AsyncStruct*>* _asyncStructQueue;
-    std::queue<ImageInfo*>* _imageInfoQueue;
+    int _asyncRefCount;
 
-    std::mutex _asyncStructQueueMutex;
-    std::mutex _imageInfoMutex;
+    float _uploadBudgetTime;
+    unsigned int _uploadBudgetBytes;
 
-    std::mutex _sleepMutex;
-    std::condition_variable _sleepCondition;
+    StringDictionary _textures;
 
-    bool _needQuit;
+    bool _compressedVariantsEnabled;
+    bool _diskCacheEnabled;
 
-    int _asyncRefCount;
+    unsigned int _memoryBudget;
+    unsigned int _accessCounter;
+    std::function<void(const std::string&)> _textureEvictedCallback;
+
+    // patterns and their policies, in the order they were set
+    std::vector<std::pair<std::string, TexturePolicy>> _texturePolicies;
 
-    Dictionary* _textures;
+    // PVR textures whose larger mipmap levels are waiting to be uploaded, retained
+    std::deque<Texture2D*> _streamedTextures;
 
     static TextureCache *_sharedTextureCache;
+
+    friend class VolatileTexture;
 };
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -224,6 +447,8 @@ public:
     static void addImage(Texture2D *tt, Image *image);
 
     static void setTexParameters(Texture2D *t, const ccTexParams &texParams);
+    static void setGenerateMipmap(Texture2D *t);
+    static void setMaxAnisotropy(Texture2D *t, float anisotropy);
     static void removeTexture(Texture2D *t);
     static void reloadAllTextures();
 
@@ -236,6 +461,15 @@ private:
     // if not found, create a new one
     static VolatileTexture* findVolotileTexture(Texture2D *tt);
 
+    // whether the texture is reloaded from an image file that must be decoded
+    bool needsDecoding() const;
+    // reloads the texture from the disk cache of the TextureCache, if it has a valid entry
+    bool reloadFromDiskCache();
+    // reloads the texture, with its image when it was already decoded
+    void reload(Image *decodedImage);
+    // restores the mipmaps and the parameters of the reloaded texture
+    void restoreTexParameters();
+
 protected:
     Texture2D *_texture;
     
@@ -251,8 +485,13 @@ protected:
     Image::Format _fmtImage;
 
     ccTexParams      _texParams;
+    bool             _generateMipmap;
+    float            _maxAnisotropy;
     std::string      _text;
     FontDefinition   _fontDefinition;
+
+    // decodes the image of a texture reloaded in the next frames
+    JobSystem::TaskPtr _reloadTask;
 };
 
 #endif
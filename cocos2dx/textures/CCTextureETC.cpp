@@ -25,6 +25,7 @@
 #include "CCTextureETC.h"
 #include "platform/CCPlatformConfig.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
 #include "CCConfiguration.h"
 #include "etc/etc1.h"
 
@@ -89,19 +90,17 @@ extern "C"
 
 bool TextureETC::loadTexture(const char* file)
 {
-    unsigned long etcFileSize = 0;
-    etc1_byte* etcFileData = NULL;
-    etcFileData = FileUtils::getInstance()->getFileData(file, "rb", &etcFileSize);
-    
-    if(0 == etcFileSize)
+    MappedFile* etcFile = FileUtils::getInstance()->getMappedFileData(file);
+    if(NULL == etcFile || etcFile->getSize() < ETC_PKM_HEADER_SIZE)
     {
         return false;
     }
     
+    unsigned long etcFileSize = etcFile->getSize();
+    const etc1_byte* etcFileData = etcFile->getBytes();
+    
     if(!etc1_pkm_is_valid(etcFileData))
     {
-        delete[] etcFileData;
-        etcFileData = NULL;
         return  false;
     }
     
@@ -110,8 +109,6 @@ bool TextureETC::loadTexture(const char* file)
     
     if( 0 == _width || 0 == _height )
     {
-        delete[] etcFileData;
-        etcFileData = NULL;
         return false;
     }
     
@@ -131,8 +128,6 @@ bool TextureETC::loadTexture(const char* file)
         
         glBindTexture(GL_TEXTURE_2D, 0);
         
-        delete[] etcFileData;
-        etcFileData = NULL;
         return true;
 #endif
     }
@@ -165,8 +160,6 @@ bool TextureETC::loadTexture(const char* file)
         
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, _width, _height, 0, GL_RGB, fallBackType, &decodeImageData[0]);
         glBindTexture(GL_TEXTURE_2D, 0);
-        delete[] etcFileData;
-        etcFileData = NULL;
         return true;
     }
     return false;
@@ -0,0 +1,379 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCTextureKTX.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
+#include "shaders/ccGLStateCache.h"
+#include "CCConfiguration.h"
+#include "ccMacros.h"
+#include "etc/etc1.h"
+
+#include <string.h>
+#include <vector>
+
+// compressed formats that older OpenGL headers don't define
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES                                0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2                         0x9274
+#endif
+#ifndef GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2     0x9276
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC                    0x9278
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR                 0x93B0
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+#define GL_COMPRESSED_RGBA_ASTC_8x8_KHR                 0x93B7
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT                 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT                0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT                0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT                0x83F3
+#endif
+
+NS_CC_BEGIN
+
+namespace
+{
+    const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    const uint32_t KTX_ENDIANNESS = 0x04030201;
+    const uint32_t KTX_ENDIANNESS_SWAPPED = 0x01020304;
+
+    struct KTXHeader
+    {
+        unsigned char identifier[12];
+        uint32_t endianness;
+        uint32_t glType;
+        uint32_t glTypeSize;
+        uint32_t glFormat;
+        uint32_t glInternalFormat;
+        uint32_t glBaseInternalFormat;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t numberOfArrayElements;
+        uint32_t numberOfFaces;
+        uint32_t numberOfMipmapLevels;
+        uint32_t bytesOfKeyValueData;
+    };
+
+    enum class Support
+    {
+        ALWAYS,
+        ETC,
+        ETC2,
+        ASTC,
+        S3TC,
+    };
+
+    struct KTXFormatInfo
+    {
+        GLenum internalFormat;
+        Texture2D::PixelFormat pixelFormat;
+        Support support;
+    };
+
+    const KTXFormatInfo s_compressedFormats[] =
+    {
+        { GL_ETC1_RGB8_OES,                             Texture2D::PixelFormat::ETC,        Support::ETC },
+        { GL_COMPRESSED_RGB8_ETC2,                      Texture2D::PixelFormat::ETC2_RGB,   Support::ETC2 },
+        { GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2,  Texture2D::PixelFormat::ETC2_RGB,   Support::ETC2 },
+        { GL_COMPRESSED_RGBA8_ETC2_EAC,                 Texture2D::PixelFormat::ETC2_RGBA,  Support::ETC2 },
+        { GL_COMPRESSED_RGBA_ASTC_4x4_KHR,              Texture2D::PixelFormat::ASTC_4x4,   Support::ASTC },
+        { GL_COMPRESSED_RGBA_ASTC_8x8_KHR,              Texture2D::PixelFormat::ASTC_8x8,   Support::ASTC },
+        { GL_COMPRESSED_RGB_S3TC_DXT1_EXT,              Texture2D::PixelFormat::S3TC_DXT1,  Support::S3TC },
+        { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,             Texture2D::PixelFormat::S3TC_DXT1,  Support::S3TC },
+        { GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,             Texture2D::PixelFormat::S3TC_DXT3,  Support::S3TC },
+        { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,             Texture2D::PixelFormat::S3TC_DXT5,  Support::S3TC },
+    };
+
+    struct KTXUncompressedFormatInfo
+    {
+        GLenum format;
+        GLenum type;
+        Texture2D::PixelFormat pixelFormat;
+    };
+
+    const KTXUncompressedFormatInfo s_uncompressedFormats[] =
+    {
+        { GL_RGBA,              GL_UNSIGNED_BYTE,           Texture2D::PixelFormat::RGBA8888 },
+        { GL_RGB,               GL_UNSIGNED_BYTE,           Texture2D::PixelFormat::RGB888 },
+        { GL_RGB,               GL_UNSIGNED_SHORT_5_6_5,    Texture2D::PixelFormat::RGB565 },
+        { GL_RGBA,              GL_UNSIGNED_SHORT_4_4_4_4,  Texture2D::PixelFormat::RGBA4444 },
+        { GL_RGBA,              GL_UNSIGNED_SHORT_5_5_5_1,  Texture2D::PixelFormat::RGB5A1 },
+        { GL_ALPHA,             GL_UNSIGNED_BYTE,           Texture2D::PixelFormat::A8 },
+        { GL_LUMINANCE,         GL_UNSIGNED_BYTE,           Texture2D::PixelFormat::I8 },
+        { GL_LUMINANCE_ALPHA,   GL_UNSIGNED_BYTE,           Texture2D::PixelFormat::AI88 },
+    };
+
+    bool isSupported(Support support)
+    {
+        Configuration* conf = Configuration::getInstance();
+        switch (support)
+        {
+            case Support::ALWAYS:   return true;
+            case Support::ETC:      return conf->supportsETC();
+            case Support::ETC2:     return conf->supportsETC2();
+            case Support::ASTC:     return conf->supportsASTC();
+            case Support::S3TC:     return conf->supportsS3TC();
+        }
+        return false;
+    }
+
+    inline uint32_t swap32(uint32_t value)
+    {
+        return ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) | ((value >> 8) & 0xFF00) | (value >> 24);
+    }
+
+    inline uint32_t readUInt32(const unsigned char* p, bool swap)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return swap ? swap32(value) : value;
+    }
+}
+
+TextureKTX::TextureKTX()
+: _name(0)
+, _width(0)
+, _height(0)
+, _numberOfMipmaps(0)
+, _format(Texture2D::PixelFormat::DEFAULT)
+{
+}
+
+TextureKTX::~TextureKTX()
+{
+}
+
+bool TextureKTX::initWithFile(const char* file)
+{
+    MappedFile* data = FileUtils::getInstance()->getMappedFileData(file);
+    if (data == NULL || data->getSize() == 0)
+    {
+        return false;
+    }
+
+    return initWithData(data->getBytes(), data->getSize());
+}
+
+bool TextureKTX::initWithData(const unsigned char* data, unsigned long dataLength)
+{
+    if (dataLength < sizeof(KTXHeader) || memcmp(data, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0)
+    {
+        CCLOG("cocos2d: TextureKTX: not a KTX file");
+        return false;
+    }
+
+    KTXHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    bool swap = false;
+    if (header.endianness == KTX_ENDIANNESS_SWAPPED)
+    {
+        swap = true;
+        uint32_t* fields = &header.endianness;
+        for (unsigned int i = 0; i < (sizeof(header) - sizeof(header.identifier)) / sizeof(uint32_t); ++i)
+        {
+            fields[i] = swap32(fields[i]);
+        }
+    }
+    else if (header.endianness != KTX_ENDIANNESS)
+    {
+        CCLOG("cocos2d: TextureKTX: invalid endianness");
+        return false;
+    }
+
+    if (header.pixelHeight == 0 || header.pixelDepth > 1 || header.numberOfArrayElements > 0 || header.numberOfFaces != 1)
+    {
+        CCLOG("cocos2d: TextureKTX: only 2D textures are supported");
+        return false;
+    }
+
+    bool compressed = (header.glType == 0);
+    bool softwareETC = false;
+    GLenum format = 0;
+    GLenum type = 0;
+
+    if (compressed)
+    {
+        const KTXFormatInfo* info = NULL;
+        for (unsigned int i = 0; i < sizeof(s_compressedFormats) / sizeof(s_compressedFormats[0]); ++i)
+        {
+            if (s_compressedFormats[i].internalFormat == header.glInternalFormat)
+            {
+                info = &s_compressedFormats[i];
+                break;
+            }
+        }
+
+        if (info == NULL)
+        {
+            CCLOG("cocos2d: TextureKTX: unsupported compressed format 0x%04X", header.glInternalFormat);
+            return false;
+        }
+
+        if (! isSupported(info->support))
+        {
+            if (info->support != Support::ETC)
+            {
+                CCLOG("cocos2d: TextureKTX: the GPU doesn't support the format %s",
+                      info->support == Support::ETC2 ? "ETC2" : (info->support == Support::ASTC ? "ASTC" : "S3TC"));
+                return false;
+            }
+            softwareETC = true;
+        }
+
+        _format = softwareETC ? Texture2D::PixelFormat::RGB888 : info->pixelFormat;
+    }
+    else
+    {
+        if (swap && header.glTypeSize != 1)
+        {
+            CCLOG("cocos2d: TextureKTX: big endian packed pixels are not supported");
+            return false;
+        }
+
+        const KTXUncompressedFormatInfo* info = NULL;
+        for (unsigned int i = 0; i < sizeof(s_uncompressedFormats) / sizeof(s_uncompressedFormats[0]); ++i)
+        {
+            if (s_uncompressedFormats[i].format == header.glFormat && s_uncompressedFormats[i].type == header.glType)
+            {
+                info = &s_uncompressedFormats[i];
+                break;
+            }
+        }
+
+        if (info == NULL)
+        {
+            CCLOG("cocos2d: TextureKTX: unsupported format 0x%04X, type 0x%04X", header.glFormat, header.glType);
+            return false;
+        }
+
+        format = info->format;
+        type = info->type;
+        _format = info->pixelFormat;
+    }
+
+    _width = header.pixelWidth;
+    _height = header.pixelHeight;
+    // 0 means that the mipmaps should be generated, only the base level is used
+    _numberOfMipmaps = MAX(header.numberOfMipmapLevels, 1u);
+    if (softwareETC)
+    {
+        // only the base level is decoded
+        _numberOfMipmaps = 1;
+    }
+
+    glGenTextures(1, &_name);
+    GL::bindTexture2D(_name);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _numberOfMipmaps > 1 ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // KTX rows are 4 bytes aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    CHECK_GL_ERROR_DEBUG(); // clean possible GL error
+
+    unsigned long offset = sizeof(KTXHeader) + header.bytesOfKeyValueData;
+    unsigned int width = _width;
+    unsigned int height = _height;
+
+    for (unsigned int level = 0; level < _numberOfMipmaps; ++level)
+    {
+        if (offset + sizeof(uint32_t) > dataLength)
+        {
+            CCLOG("cocos2d: TextureKTX: truncated file");
+            break;
+        }
+
+        uint32_t imageSize = readUInt32(data + offset, swap);
+        offset += sizeof(uint32_t);
+
+        if (offset + imageSize > dataLength)
+        {
+            CCLOG("cocos2d: TextureKTX: truncated file");
+            break;
+        }
+
+        const unsigned char* imageData = data + offset;
+
+        if (softwareETC)
+        {
+            unsigned int stride = width * 3;
+            std::vector<unsigned char> decodedData(stride * height);
+            etc1_decode_image(imageData, &decodedData[0], width, height, 3, stride);
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, &decodedData[0]);
+        }
+        else if (compressed)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, header.glInternalFormat, width, height, 0, imageSize, imageData);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, format, type, imageData);
+        }
+
+        GLenum err = glGetError();
+        if (err != GL_NO_ERROR)
+        {
+            CCLOG("cocos2d: TextureKTX: Error uploading texture level: %u . glError: 0x%04X", level, err);
+            break;
+        }
+
+        // each level is padded to 4 bytes
+        offset += (imageSize + 3) & ~3u;
+        width = MAX(width >> 1, 1u);
+        height = MAX(height >> 1, 1u);
+
+        if (level + 1 == _numberOfMipmaps)
+        {
+            return true;
+        }
+    }
+
+    GL::deleteTexture(_name);
+    _name = 0;
+    return false;
+}
+
+NS_CC_END
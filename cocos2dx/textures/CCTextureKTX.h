@@ -0,0 +1,87 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCKTXTEXTURE_H__
+#define __CCKTXTEXTURE_H__
+
+#include "cocoa/CCObject.h"
+#include "platform/CCPlatformMacros.h"
+#include "textures/CCTexture2D.h"
+#include "CCGL.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup textures
+ * @{
+ */
+
+/** TextureKTX
+
+ Object that loads KTX (Khronos texture container) images.
+
+ Supported formats:
+    - ETC1 (decoded by software when the GPU doesn't support it)
+    - ETC2 RGB8, ETC2 RGB8 with punchthrough alpha, ETC2 RGBA8 (EAC)
+    - ASTC 4x4 and 8x8 (LDR)
+    - S3TC DXT1, DXT3 and DXT5
+    - uncompressed RGBA8888, RGB888, RGB565, RGBA4444, RGB5A1, A8, I8 and AI88
+
+ Only 2D textures are supported: cube maps, texture arrays and 3D textures are rejected.
+ Compressed formats that the GPU doesn't support are rejected too, except ETC1.
+
+ @since v3.0
+ */
+class CC_DLL TextureKTX : public Object
+{
+public:
+    TextureKTX();
+    virtual ~TextureKTX();
+
+    /** initializes a TextureKTX with a path. The texture name must be released by the caller. */
+    bool initWithFile(const char* file);
+
+    /** initializes a TextureKTX with the contents of a KTX file */
+    bool initWithData(const unsigned char* data, unsigned long dataLength);
+
+    inline unsigned int getName() const { return _name; }
+    inline unsigned int getWidth() const { return _width; }
+    inline unsigned int getHeight() const { return _height; }
+    inline unsigned int getNumberOfMipmaps() const { return _numberOfMipmaps; }
+    inline Texture2D::PixelFormat getFormat() const { return _format; }
+
+private:
+    GLuint _name;
+    unsigned int _width;
+    unsigned int _height;
+    unsigned int _numberOfMipmaps;
+    Texture2D::PixelFormat _format;
+};
+
+// end of textures group
+/// @}
+
+NS_CC_END
+
+#endif /* defined(__CCKTXTEXTURE_H__) */
@@ -228,8 +228,14 @@ typedef struct {
 
 TexturePVR::TexturePVR() 
 : _numberOfMipmaps(0)
+, _skippedMipmaps(0)
+, _numberOfFileMipmaps(0)
 , _width(0)
 , _height(0)
+, _fileWidth(0)
+, _fileHeight(0)
+, _data(NULL)
+, _streamedSkippedMipmaps(0)
 , _name(0)
 , _hasAlpha(false)
 , _hasPremultipliedAlpha(false)
@@ -248,6 +254,7 @@ TexturePVR::~TexturePVR()
     {
         GL::deleteTexture(_name);
     }
+    CC_SAFE_DELETE_ARRAY(_data);
 }
 
 bool TexturePVR::unpackPVRv2Data(unsigned char* data, unsigned int len)
@@ -536,16 +543,16 @@ bool TexturePVR::createGLTexture()
     unsigned int height = _height;
     GLenum err;
     
-    if (_numberOfMipmaps > 0)
+    // From PVR sources: "PVR files are never row aligned."
+    glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+
+    if (_numberOfMipmaps > 0 && _name != 0)
+    {
+        // a streamed texture is respecified with one more level, the filtering set on it is kept
+        GL::bindTexture2D(_name);
+    }
+    else if (_numberOfMipmaps > 0)
     {
-        if (_name != 0)
-        {
-            GL::deleteTexture(_name);
-        }
-        
-        // From PVR sources: "PVR files are never row aligned."
-        glPixelStorei(GL_UNPACK_ALIGNMENT,1);
-        
         glGenTextures(1, &_name);
         GL::bindTexture2D(_name);
         
@@ -580,8 +587,8 @@ bool TexturePVR::createGLTexture()
 			return false;
 		}
         
-		unsigned char *data = _asMipmaps[i].address;
-		GLsizei datalen = _asMipmaps[i].len;
+		unsigned char *data = _asMipmaps[_skippedMipmaps + i].address;
+		GLsizei datalen = _asMipmaps[_skippedMipmaps + i].len;
         
 		if (compressed)
         {
@@ -612,7 +619,44 @@ bool TexturePVR::createGLTexture()
 }
 
 
-bool TexturePVR::initWithContentsOfFile(const char* path)
+void TexturePVR::skipMipmaps(unsigned int count)
+{
+    // the smaller levels become the first ones, at least one level is kept
+    _skippedMipmaps = MIN(count, _numberOfFileMipmaps > 0 ? _numberOfFileMipmaps - 1 : 0);
+    _numberOfMipmaps = _numberOfFileMipmaps - _skippedMipmaps;
+    _width = MAX(_fileWidth >> _skippedMipmaps, 1u);
+    _height = MAX(_fileHeight >> _skippedMipmaps, 1u);
+}
+
+bool TexturePVR::streamMipmap()
+{
+    if (! isStreaming())
+    {
+        return false;
+    }
+
+    // the new level 0 is uploaded, then the levels the texture already had, one index further
+    skipMipmaps(_skippedMipmaps - 1);
+    if (! createGLTexture())
+    {
+        stopStreaming();
+        return false;
+    }
+
+    if (_skippedMipmaps <= _streamedSkippedMipmaps)
+    {
+        stopStreaming();
+        return false;
+    }
+    return true;
+}
+
+void TexturePVR::stopStreaming()
+{
+    CC_SAFE_DELETE_ARRAY(_data);
+}
+
+bool TexturePVR::initWithContentsOfFile(const char* path, unsigned int skippedMipmaps/* = 0*/, bool streamed/* = false*/)
 {
     unsigned char* pvrdata = NULL;
     int pvrlen = 0;
@@ -643,6 +687,7 @@ bool TexturePVR::initWithContentsOfFile(const char* path)
     }
     
     _numberOfMipmaps = 0;
+    _skippedMipmaps = 0;
 
     _name = 0;
     _width = _height = 0;
@@ -653,7 +698,31 @@ bool TexturePVR::initWithContentsOfFile(const char* path)
 
     _retainName = false; // cocos2d integration
 
-    if (! ((unpackPVRv2Data(pvrdata, pvrlen)  || unpackPVRv3Data(pvrdata, pvrlen)) && createGLTexture()) )
+    bool unpacked = unpackPVRv2Data(pvrdata, pvrlen)  || unpackPVRv3Data(pvrdata, pvrlen);
+    if (unpacked)
+    {
+        _numberOfFileMipmaps = _numberOfMipmaps;
+        _fileWidth = _width;
+        _fileHeight = _height;
+        skipMipmaps(skippedMipmaps);
+
+        // the texture starts with the levels that fit in CC_PVR_STREAMING_INITIAL_SIZE, the file is kept for the others
+        _streamedSkippedMipmaps = _skippedMipmaps;
+        unsigned int initialSkippedMipmaps = _skippedMipmaps;
+        while (streamed && initialSkippedMipmaps + 1 < _numberOfFileMipmaps
+               && MAX(_fileWidth, _fileHeight) >> initialSkippedMipmaps > CC_PVR_STREAMING_INITIAL_SIZE)
+        {
+            ++initialSkippedMipmaps;
+        }
+        if (initialSkippedMipmaps > _skippedMipmaps)
+        {
+            skipMipmaps(initialSkippedMipmaps);
+            _data = pvrdata;
+            pvrdata = NULL;
+        }
+    }
+
+    if (! (unpacked && createGLTexture()) )
     {
         CC_SAFE_DELETE_ARRAY(pvrdata);
         this->release();
@@ -96,8 +96,26 @@ public:
     TexturePVR();
     virtual ~TexturePVR();
 
-    /** initializes a TexturePVR with a path */
-    bool initWithContentsOfFile(const char* path);
+    /** initializes a TexturePVR with a path.
+     The first skippedMipmaps levels are dropped when the file has smaller ones, to save memory (since v3.0)
+     @param streamed only the levels up to CC_PVR_STREAMING_INITIAL_SIZE pixels are uploaded, the larger ones are
+     uploaded by streamMipmap(). The data of the file is kept until then (since v3.0)
+     */
+    bool initWithContentsOfFile(const char* path, unsigned int skippedMipmaps = 0, bool streamed = false);
+
+    /** Uploads the next larger mipmap level of a streamed texture, which keeps its name.
+     @return false when the texture is complete, or the upload failed
+     @since v3.0
+     */
+    bool streamMipmap();
+
+    /** Stops streaming: the texture keeps the levels uploaded so far, and the data of the file is released
+     @since v3.0
+     */
+    void stopStreaming();
+
+    /** whether or not larger levels are waiting to be uploaded by streamMipmap() */
+    inline bool isStreaming() const { return _data != NULL; }
 
     // properties
     
@@ -115,6 +133,8 @@ public:
     inline bool isForcePremultipliedAlpha() const { return _forcePremultipliedAlpha; }
     /** how many mipmaps the texture has. 1 means one level (level 0 */
     inline unsigned int getNumberOfMipmaps() const { return _numberOfMipmaps; }
+    /** how many levels were dropped: the size of the file is the size of the texture times 2^getSkippedMipmaps() */
+    inline unsigned int getSkippedMipmaps() const { return _skippedMipmaps; }
     inline Texture2D::PixelFormat getFormat() const { return _format; }
     inline bool isRetainName() const { return _retainName; }
     inline void setRetainName(bool retainName) { _retainName = retainName; }
@@ -123,12 +143,20 @@ private:
     bool unpackPVRv2Data(unsigned char* data, unsigned int len);
     bool unpackPVRv3Data(unsigned char* dataPointer, unsigned int dataLength);
     bool createGLTexture();
+    void skipMipmaps(unsigned int count);
     
 protected:
-    struct CCPVRMipmap _asMipmaps[CC_PVRMIPMAP_MAX];   // pointer to mipmap images    
+    struct CCPVRMipmap _asMipmaps[CC_PVRMIPMAP_MAX];   // pointer to mipmap images of the file
     unsigned int _numberOfMipmaps;                    // number of mipmap used
+    unsigned int _skippedMipmaps;                     // number of levels of the file the texture starts after
+    unsigned int _numberOfFileMipmaps;
     
     unsigned int _width, _height;
+    unsigned int _fileWidth, _fileHeight;
+    // data of the file, kept while the texture is streamed
+    unsigned char *_data;
+    // the streaming stops once the texture starts after this level
+    unsigned int _streamedSkippedMipmaps;
     GLuint _name;
     bool _hasAlpha;
     bool _hasPremultipliedAlpha;
@@ -25,6 +25,9 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "CCParallaxNode.h"
 #include "support/data_support/ccCArray.h"
+#include "sprite_nodes/CCSprite.h"
+#include "sprite_nodes/CCSpriteFrame.h"
+#include "CCDirector.h"
 
 NS_CC_BEGIN
 
@@ -44,6 +47,7 @@ public:
         _ratio = ratio;
         _offset = offset;
         _child = NULL;
+        _repeatWidth = 0;
         return true;
     }
     
@@ -55,11 +59,16 @@ public:
     
     inline Node* getChild() const { return _child; };
     inline void setChild(Node* child) { _child = child; };
+
+    // width after which a repeating child wraps around, 0 if the child doesn't repeat
+    inline float getRepeatWidth() const { return _repeatWidth; };
+    inline void setRepeatWidth(float width) { _repeatWidth = width; };
     
 private:
     Point _ratio;
     Point _offset;
     Node *_child; // weak ref
+    float _repeatWidth;
 };
 
 ParallaxNode::ParallaxNode()
@@ -106,6 +115,34 @@ void ParallaxNode::addChild(Node *child, int z, const Point& ratio, const Point&
 
     Node::addChild(child, z, child->getTag());
 }
+
+Node* ParallaxNode::addRepeatingChild(SpriteFrame *frame, int z, const Point& ratio, const Point& offset)
+{
+    CCASSERT( frame != NULL, "Argument must be non-nil");
+    float width = frame->getRect().size.width;
+    CCASSERT( width > 0, "ParallaxNode: the frame of a repeating child can't be empty");
+
+    // enough copies to cover the screen wherever the first one starts
+    float visibleWidth = Director::getInstance()->getVisibleSize().width;
+    int copies = (int)ceilf(visibleWidth / width) + 1;
+
+    Node *layer = Node::create();
+    for (int i = 0; i < copies; i++)
+    {
+        Sprite *sprite = Sprite::createWithSpriteFrame(frame);
+        sprite->setAnchorPoint(Point::ZERO);
+        sprite->setPosition(Point(i * width, 0));
+        layer->addChild(sprite);
+    }
+
+    addChild(layer, z, ratio, offset);
+    PointObject *point = (PointObject*)_parallaxArray->arr[_parallaxArray->num - 1];
+    point->setRepeatWidth(width);
+
+    // the layer is placed at the next visit
+    _lastPosition = Point(-100,-100);
+    return layer;
+}
 void ParallaxNode::removeChild(Node* child, bool cleanup)
 {
     for( unsigned int i=0;i < _parallaxArray->num;i++)
@@ -126,14 +163,12 @@ void ParallaxNode::removeAllChildrenWithCleanup(bool cleanup)
 }
 Point ParallaxNode::absolutePosition()
 {
-    Point ret = _position;
-    Node *cn = this;
-    while (cn->getParent() != NULL)
+    // the transform of the parent is cached, so there is no need to walk up the ancestors
+    if (_parent)
     {
-        cn = cn->getParent();
-        ret = ret + cn->getPosition();
+        return PointApplyAffineTransform(_position, _parent->getNodeToWorldTransform());
     }
-    return ret;
+    return _position;
 }
 
 /*
@@ -153,6 +188,19 @@ void ParallaxNode::visit()
             PointObject *point = (PointObject*)_parallaxArray->arr[i];
             float x = -pos.x + pos.x * point->getRatio().x + point->getOffset().x;
             float y = -pos.y + pos.y * point->getRatio().y + point->getOffset().y;            
+
+            // a repeating child is moved back by whole copies to keep covering the screen
+            float width = point->getRepeatWidth();
+            if (width > 0)
+            {
+                float left = Director::getInstance()->getVisibleOrigin().x;
+                float shift = fmodf(pos.x + x - left, width);
+                if (shift > 0)
+                {
+                    shift -= width;
+                }
+                x = left - pos.x + shift;
+            }
             point->getChild()->setPosition(Point(x,y));
         }
         _lastPosition = pos;
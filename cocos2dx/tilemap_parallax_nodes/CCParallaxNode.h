@@ -32,6 +32,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 struct _ccArray;
+class SpriteFrame;
 
 /**
  * @addtogroup tilemap_parallax_nodes
@@ -61,6 +62,13 @@ public:
 
     void addChild(Node * child, int z, const Point& parallaxRatio, const Point& positionOffset);
 
+    /** Adds a layer that repeats a sprite frame horizontally without end, for infinite scrolling.
+    The copies of the frame cover the visible width of the screen and wrap around as the node scrolls.
+    They are consecutive quads of the same texture, so the Renderer draws them in a single call.
+    It returns the node holding the copies.
+    */
+    Node* addRepeatingChild(SpriteFrame *frame, int z, const Point& parallaxRatio, const Point& positionOffset);
+
     /** Sets an array of layers for the Parallax node */
     void setParallaxArray( struct _ccArray *parallaxArray) { _parallaxArray = parallaxArray; }
     /** Returns the array of layers of the Parallax node */
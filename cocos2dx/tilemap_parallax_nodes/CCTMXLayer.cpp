@@ -30,8 +30,10 @@ THE SOFTWARE.
 #include "textures/CCTextureCache.h"
 #include "shaders/CCShaderCache.h"
 #include "shaders/CCGLProgram.h"
-#include "support/data_support/ccCArray.h"
+#include "textures/CCTextureAtlas.h"
+#include "support/TransformUtils.h"
 #include "CCDirector.h"
+#include "support/CCFrameProfiler.h"
 
 NS_CC_BEGIN
 
@@ -50,10 +52,8 @@ TMXLayer * TMXLayer::create(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *layerInfo
 }
 bool TMXLayer::initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *layerInfo, TMXMapInfo *mapInfo)
 {    
-    // XXX: is 35% a good estimate ?
+    // the tiles are drawn by chunks, only the tiles that became a Sprite are in the atlas of the layer
     Size size = layerInfo->_layerSize;
-    float totalNumberOfTiles = size.width * size.height;
-    float capacity = totalNumberOfTiles * 0.35f + 1; // 35 percent is occupied ?
 
     Texture2D *texture = NULL;
     if( tilesetInfo )
@@ -61,7 +61,7 @@ bool TMXLayer::initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *la
         texture = TextureCache::getInstance()->addImage(tilesetInfo->_sourceImage.c_str());
     }
 
-    if (SpriteBatchNode::initWithTexture(texture, (unsigned int)capacity))
+    if (SpriteBatchNode::initWithTexture(texture, 29))
     {
         // layerInfo
         _layerName = layerInfo->_name;
@@ -85,12 +85,13 @@ bool TMXLayer::initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *la
         Point offset = this->calculateLayerOffset(layerInfo->_offset);
         this->setPosition(CC_POINT_PIXELS_TO_POINTS(offset));
 
-        _atlasIndexArray = ccCArrayNew((unsigned int)totalNumberOfTiles);
-
         this->setContentSize(CC_SIZE_PIXELS_TO_POINTS(Size(_layerSize.width * _mapTileSize.width, _layerSize.height * _mapTileSize.height)));
 
         _useAutomaticVertexZ = false;
         _vertexZvalue = 0;
+
+        // the tile sprites are looked up by their position in the layer
+        setChildTagIndexEnabled(true);
         
         return true;
     }
@@ -104,8 +105,8 @@ TMXLayer::TMXLayer()
 ,_maxGID(0)
 ,_vertexZvalue(0)
 ,_useAutomaticVertexZ(false)
-,_reusedTile(NULL)
-,_atlasIndexArray(NULL)
+,_chunksWide(0)
+,_animationTime(0.0f)
 ,_contentScaleFactor(1.0f)
 ,_layerSize(Size::ZERO)
 ,_mapTileSize(Size::ZERO)
@@ -118,13 +119,16 @@ TMXLayer::TMXLayer()
 TMXLayer::~TMXLayer()
 {
     CC_SAFE_RELEASE(_tileSet);
-    CC_SAFE_RELEASE(_reusedTile);
     CC_SAFE_RELEASE(_properties);
 
-    if (_atlasIndexArray)
+    for (auto chunk : _chunks)
+    {
+        CC_SAFE_RELEASE(chunk);
+    }
+
+    for (auto chunk : _freeChunks)
     {
-        ccCArrayFree(_atlasIndexArray);
-        _atlasIndexArray = NULL;
+        chunk->release();
     }
 
     CC_SAFE_DELETE_ARRAY(_tiles);
@@ -134,14 +138,19 @@ void TMXLayer::releaseMap()
 {
     if (_tiles)
     {
+        // the chunks can't be built anymore
+        for (int i = 0; i < (int)_chunks.size(); ++i)
+        {
+            if (! _chunks[i])
+            {
+                _chunks[i] = buildChunk(i);
+            }
+        }
+
         delete [] _tiles;
         _tiles = NULL;
-    }
 
-    if (_atlasIndexArray)
-    {
-        ccCArrayFree(_atlasIndexArray);
-        _atlasIndexArray = NULL;
+        std::vector<int>().swap(_tileQuads);
     }
 }
 
@@ -163,33 +172,32 @@ void TMXLayer::setupTiles()
     // Parse cocos2d properties
     this->parseInternalProperties();
 
-    for (unsigned int y=0; y < _layerSize.height; y++) 
+    unsigned int totalNumberOfTiles = (unsigned int)(_layerSize.width * _layerSize.height);
+    for (unsigned int pos = 0; pos < totalNumberOfTiles; pos++)
     {
-        for (unsigned int x=0; x < _layerSize.width; x++) 
-        {
-            unsigned int pos = (unsigned int)(x + _layerSize.width * y);
-            unsigned int gid = _tiles[ pos ];
-
-            // gid are stored in little endian.
-            // if host is big endian, then swap
-            //if( o == CFByteOrderBigEndian )
-            //    gid = CFSwapInt32( gid );
-            /* We support little endian.*/
+        unsigned int gid = _tiles[ pos ];
 
-            // XXX: gid == 0 --> empty tile
-            if (gid != 0) 
-            {
-                this->appendTileForGID(gid, Point(x, y));
+        // gid are stored in little endian.
+        // if host is big endian, then swap
+        //if( o == CFByteOrderBigEndian )
+        //    gid = CFSwapInt32( gid );
+        /* We support little endian.*/
 
-                // Optimization: update min and max GID rendered by the layer
-                _minGID = MIN(gid, _minGID);
-                _maxGID = MAX(gid, _maxGID);
-            }
+        // XXX: gid == 0 --> empty tile
+        if (gid != 0) 
+        {
+            // Optimization: update min and max GID rendered by the layer
+            _minGID = MIN(gid, _minGID);
+            _maxGID = MAX(gid, _maxGID);
         }
     }
 
     CCASSERT( _maxGID >= _tileSet->_firstGid &&
         _minGID >= _tileSet->_firstGid, "TMX: Only 1 tileset per layer is supported");    
+
+    // the quads are built when the chunks are drawn
+    setupChunks();
+    setupAnimations();
 }
 
 // TMXLayer - Properties
@@ -290,203 +298,489 @@ void TMXLayer::setupTileSprite(Sprite* sprite, Point pos, unsigned int gid)
     }
 }
 
-Sprite* TMXLayer::reusedTileWithRect(Rect rect)
+void TMXLayer::setupTileQuad(V3F_C4B_T2F_Quad* quad, const Point& pos, unsigned int gid)
 {
-    if (! _reusedTile) 
+    Texture2D *texture = _textureAtlas->getTexture();
+    float atlasWidth = (float)texture->getPixelsWide();
+    float atlasHeight = (float)texture->getPixelsHigh();
+
+    Rect rect = _tileSet->rectForGID(gid);
+
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+    float left    = (2*rect.origin.x+1)/(2*atlasWidth);
+    float right   = left + (rect.size.width*2-2)/(2*atlasWidth);
+    float top     = (2*rect.origin.y+1)/(2*atlasHeight);
+    float bottom  = top + (rect.size.height*2-2)/(2*atlasHeight);
+#else
+    float left    = rect.origin.x/atlasWidth;
+    float right   = (rect.origin.x + rect.size.width) / atlasWidth;
+    float top     = rect.origin.y/atlasHeight;
+    float bottom  = (rect.origin.y + rect.size.height) / atlasHeight;
+#endif // CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+
+    // the tile is rotated by the diagonal flip, as in setupTileSprite()
+    Size size = CC_SIZE_PIXELS_TO_POINTS(rect.size);
+    if (gid & kTMXTileDiagonalFlag)
     {
-        _reusedTile = new Sprite();
-        _reusedTile->initWithTexture(_textureAtlas->getTexture(), rect, false);
-        _reusedTile->setBatchNode(this);
+        std::swap(size.width, size.height);
     }
-    else
+
+    Point origin = getPositionAt(pos);
+    float vertexZ = (float)getVertexZForPos(pos);
+
+    quad->bl.vertices = Vertex3F(origin.x, origin.y, vertexZ);
+    quad->br.vertices = Vertex3F(origin.x + size.width, origin.y, vertexZ);
+    quad->tl.vertices = Vertex3F(origin.x, origin.y + size.height, vertexZ);
+    quad->tr.vertices = Vertex3F(origin.x + size.width, origin.y + size.height, vertexZ);
+
+    // Tiled draws the diagonal flip first, then the horizontal and vertical flips:
+    // undo them in the opposite order to find the texels of each corner.
+    // (x, y) is the corner of the tile on the screen, y going down as in the texture.
+    V3F_C4B_T2F *corners[4] = { &quad->tl, &quad->tr, &quad->bl, &quad->br };
+    for (int i = 0; i < 4; ++i)
     {
-        // XXX HACK: Needed because if "batch node" is nil,
-		// then the Sprite'squad will be reset
-        _reusedTile->setBatchNode(NULL);
-        
-		// Re-init the sprite
-        _reusedTile->setTextureRect(rect, false, rect.size);
-        
-		// restore the batch node
-        _reusedTile->setBatchNode(this);
+        float x = (float)(i % 2);
+        float y = (float)(i / 2);
+
+        if (gid & kTMXTileVerticalFlag)
+        {
+            y = 1 - y;
+        }
+        if (gid & kTMXTileHorizontalFlag)
+        {
+            x = 1 - x;
+        }
+        if (gid & kTMXTileDiagonalFlag)
+        {
+            std::swap(x, y);
+        }
+
+        corners[i]->texCoords.u = left + x * (right - left);
+        corners[i]->texCoords.v = top + y * (bottom - top);
     }
 
-    return _reusedTile;
+    // same color as a Sprite with the opacity of the layer
+    Color4B color(255, 255, 255, _opacity);
+    if (texture->hasPremultipliedAlpha())
+    {
+        color.r = color.g = color.b = _opacity;
+    }
+    quad->bl.colors = color;
+    quad->br.colors = color;
+    quad->tl.colors = color;
+    quad->tr.colors = color;
 }
 
-// TMXLayer - obtaining tiles/gids
-Sprite * TMXLayer::getTileAt(const Point& pos)
+// TMXLayer - chunks
+void TMXLayer::setupChunks()
 {
-    CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles && _atlasIndexArray, "TMXLayer: the tiles map has been released");
+    int chunkSize = CC_TMX_LAYER_CHUNK_SIZE;
+    int layerWidth = (int)_layerSize.width;
+    int layerHeight = (int)_layerSize.height;
+
+    _chunksWide = (layerWidth + chunkSize - 1) / chunkSize;
+    int chunksHigh = (layerHeight + chunkSize - 1) / chunkSize;
+
+    _chunks.assign(_chunksWide * chunksHigh, nullptr);
+    _chunkRects.resize(_chunks.size());
+    _chunkFreeQuads.resize(_chunks.size());
+    _tileQuads.assign(layerWidth * layerHeight, -1);
+
+    // the tiles of the tileset may be bigger than the tiles of the map
+    Size tileSize = CC_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
+    Size mapTileSize = CC_SIZE_PIXELS_TO_POINTS(_mapTileSize);
+    float extentX = MAX(tileSize.width, tileSize.height);
+    extentX = MAX(extentX, mapTileSize.width);
+    float extentY = MAX(extentX, mapTileSize.height);
+
+    for (int cy = 0; cy < chunksHigh; ++cy)
+    {
+        for (int cx = 0; cx < _chunksWide; ++cx)
+        {
+            // the positions of the tiles are affine in the tile coordinates,
+            // except the half tile of the odd columns of the hexagonal maps
+            float x0 = (float)(cx * chunkSize);
+            float y0 = (float)(cy * chunkSize);
+            float x1 = (float)(MIN((cx + 1) * chunkSize, layerWidth) - 1);
+            float y1 = (float)(MIN((cy + 1) * chunkSize, layerHeight) - 1);
+
+            Point corners[4] = {
+                getPositionAt(Point(x0, y0)),
+                getPositionAt(Point(x1, y0)),
+                getPositionAt(Point(x0, y1)),
+                getPositionAt(Point(x1, y1)),
+            };
+
+            float minX = corners[0].x, maxX = corners[0].x;
+            float minY = corners[0].y, maxY = corners[0].y;
+            for (int i = 1; i < 4; ++i)
+            {
+                minX = MIN(minX, corners[i].x);
+                maxX = MAX(maxX, corners[i].x);
+                minY = MIN(minY, corners[i].y);
+                maxY = MAX(maxY, corners[i].y);
+            }
 
-    Sprite *tile = nullptr;
-    unsigned int gid = this->getTileGIDAt(pos);
+            minY -= mapTileSize.height / 2;
+            _chunkRects[cy * _chunksWide + cx] = Rect(minX, minY, maxX + extentX - minX, maxY + extentY - minY);
+        }
+    }
+}
 
-    // if GID == 0, then no tile is present
-    if (gid) 
+int TMXLayer::getChunkIndexForPos(const Point& pos) const
+{
+    return ((int)pos.y / CC_TMX_LAYER_CHUNK_SIZE) * _chunksWide + (int)pos.x / CC_TMX_LAYER_CHUNK_SIZE;
+}
+
+TextureAtlas* TMXLayer::buildChunk(int index)
+{
+    int chunkSize = CC_TMX_LAYER_CHUNK_SIZE;
+
+    TextureAtlas *atlas = NULL;
+    if (! _freeChunks.empty())
     {
-        int z = (int)(pos.x + pos.y * _layerSize.width);
-        tile = static_cast<Sprite*>(this->getChildByTag(z));
+        atlas = _freeChunks.back();
+        _freeChunks.pop_back();
+        atlas->removeAllQuads();
+    }
+    else
+    {
+        atlas = new TextureAtlas();
+        atlas->initWithTexture(_textureAtlas->getTexture(), chunkSize * chunkSize);
+    }
 
-        // tile not created yet. create it
-        if (! tile) 
-        {
-            Rect rect = _tileSet->rectForGID(gid);
-            rect = CC_RECT_PIXELS_TO_POINTS(rect);
+    int x0 = (index % _chunksWide) * chunkSize;
+    int y0 = (index / _chunksWide) * chunkSize;
+    int x1 = MIN(x0 + chunkSize, (int)_layerSize.width);
+    int y1 = MIN(y0 + chunkSize, (int)_layerSize.height);
 
-            tile = new Sprite();
-            tile->initWithTexture(this->getTexture(), rect);
-            tile->setBatchNode(this);
-            tile->setPosition(getPositionAt(pos));
-            tile->setVertexZ((float)getVertexZForPos(pos));
-            tile->setAnchorPoint(Point::ZERO);
-            tile->setOpacity(_opacity);
-
-            unsigned int indexForZ = atlasIndexForExistantZ(z);
-            this->addSpriteWithoutQuad(tile, indexForZ, z);
-            tile->release();
+    // the tiles that became a Sprite are drawn by the layer
+    int quadCount = 0;
+    V3F_C4B_T2F_Quad quad;
+    for (int y = y0; y < y1; ++y)
+    {
+        for (int x = x0; x < x1; ++x)
+        {
+            int z = x + y * (int)_layerSize.width;
+            unsigned int gid = _tiles[z];
+            if (gid != 0 && (_children.empty() || ! getChildByTag(z)))
+            {
+                setupTileQuad(&quad, Point(x, y), getAnimatedGID(gid));
+                _tileQuads[z] = quadCount;
+                atlas->updateQuad(&quad, quadCount++);
+            }
+            else
+            {
+                _tileQuads[z] = -1;
+            }
         }
     }
-    
-    return tile;
+
+    return atlas;
 }
 
-unsigned int TMXLayer::getTileGIDAt(const Point& pos, ccTMXTileFlags* flags/* = nullptr*/)
+void TMXLayer::releaseChunk(int index)
 {
-    CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles && _atlasIndexArray, "TMXLayer: the tiles map has been released");
+    TextureAtlas *atlas = _chunks[index];
+    if (! atlas)
+    {
+        return;
+    }
 
-    int idx = (int)(pos.x + pos.y * _layerSize.width);
-    // Bits on the far end of the 32-bit global tile ID are used for tile flags
-    unsigned int tile = _tiles[idx];
+    _chunks[index] = NULL;
+    _chunkFreeQuads[index].clear();
 
-    // issue1264, flipped tiles can be changed dynamically
-    if (flags) 
+    // keep a few atlases to build the chunks coming into view
+    if (_freeChunks.size() < 8)
     {
-        *flags = (ccTMXTileFlags)(tile & kFlipedAll);
+        _freeChunks.push_back(atlas);
+    }
+    else
+    {
+        atlas->release();
     }
-    
-    return (tile & kFlippedMask);
 }
 
-// TMXLayer - adding helper methods
-Sprite * TMXLayer::insertTileForGID(unsigned int gid, const Point& pos)
+// edits in a built chunk only touch the quad of the tile. The quads aren't ordered, so the quad
+// of a removed tile is emptied and reused by the next tile added to the chunk
+void TMXLayer::updateTileQuad(const Point& pos, unsigned int gid)
 {
-    Rect rect = _tileSet->rectForGID(gid);
-    rect = CC_RECT_PIXELS_TO_POINTS(rect);
+    int index = getChunkIndexForPos(pos);
+    TextureAtlas *atlas = _chunks[index];
+    if (! atlas)
+    {
+        return;
+    }
+
+    int z = (int)(pos.x + pos.y * _layerSize.width);
+    int quadIndex = _tileQuads[z];
+    if (quadIndex < 0)
+    {
+        std::vector<int>& freeQuads = _chunkFreeQuads[index];
+        if (! freeQuads.empty())
+        {
+            quadIndex = freeQuads.back();
+            freeQuads.pop_back();
+        }
+        else
+        {
+            quadIndex = atlas->getTotalQuads();
+        }
+        _tileQuads[z] = quadIndex;
+    }
+
+    V3F_C4B_T2F_Quad quad;
+    setupTileQuad(&quad, pos, getAnimatedGID(gid));
+    atlas->updateQuad(&quad, quadIndex);
+}
+
+void TMXLayer::removeTileQuad(const Point& pos)
+{
+    int index = getChunkIndexForPos(pos);
+    TextureAtlas *atlas = _chunks[index];
+    int z = (int)(pos.x + pos.y * _layerSize.width);
+    if (! atlas || _tileQuads[z] < 0)
+    {
+        return;
+    }
+
+    // an empty quad draws nothing
+    V3F_C4B_T2F_Quad quad;
+    memset(&quad, 0, sizeof(quad));
+    atlas->updateQuad(&quad, _tileQuads[z]);
+
+    _chunkFreeQuads[index].push_back(_tileQuads[z]);
+    _tileQuads[z] = -1;
+}
+
+// TMXLayer - animated tiles
+void TMXLayer::setupAnimations()
+{
+    if (_tileSet->_animations.empty())
+    {
+        return;
+    }
 
-    intptr_t z = (intptr_t)(pos.x + pos.y * _layerSize.width);
+    for (auto it = _tileSet->_animations.begin(); it != _tileSet->_animations.end(); ++it)
+    {
+        if (! it->second.empty())
+        {
+            _animationFrames[it->first] = it->second.front().gid;
+        }
+    }
 
-    Sprite *tile = reusedTileWithRect(rect);
+    unsigned int totalNumberOfTiles = (unsigned int)(_layerSize.width * _layerSize.height);
+    for (unsigned int pos = 0; pos < totalNumberOfTiles; pos++)
+    {
+        if (_animationFrames.find(_tiles[pos] & kFlippedMask) != _animationFrames.end())
+        {
+            _animatedTiles.push_back(pos);
+        }
+    }
 
-    setupTileSprite(tile, pos, gid);
+    scheduleUpdate();
+}
 
-    // get atlas index
-    unsigned int indexForZ = atlasIndexForNewZ(z);
+unsigned int TMXLayer::getAnimatedGID(unsigned int gid) const
+{
+    if (! _animationFrames.empty())
+    {
+        auto it = _animationFrames.find(gid & kFlippedMask);
+        if (it != _animationFrames.end())
+        {
+            return it->second | (gid & kFlipedAll);
+        }
+    }
+    return gid;
+}
 
-    // Optimization: add the quad without adding a child
-    this->insertQuadFromSprite(tile, indexForZ);
+void TMXLayer::update(float delta)
+{
+    if (! _tiles)
+    {
+        return;
+    }
 
-    // insert it into the local atlasindex array
-    ccCArrayInsertValueAtIndex(_atlasIndexArray, (void*)z, indexForZ);
+    _animationTime += delta;
 
-    // update possible children
-    if (_children && _children->count()>0)
+    bool changed = false;
+    for (auto it = _tileSet->_animations.begin(); it != _tileSet->_animations.end(); ++it)
     {
-        Object* pObject = nullptr;
-        CCARRAY_FOREACH(_children, pObject)
+        const std::vector<TMXTileAnimationFrame>& frames = it->second;
+        if (frames.empty())
         {
-            Sprite* child = static_cast<Sprite*>(pObject);
-            if (child)
+            continue;
+        }
+
+        float duration = 0;
+        for (auto frame = frames.begin(); frame != frames.end(); ++frame)
+        {
+            duration += frame->duration;
+        }
+
+        unsigned int gid = frames.front().gid;
+        if (duration > 0)
+        {
+            float time = fmodf(_animationTime, duration);
+            for (auto frame = frames.begin(); frame != frames.end(); ++frame)
             {
-                unsigned int ai = child->getAtlasIndex();
-                if ( ai >= indexForZ )
+                if (time < frame->duration)
                 {
-                    child->setAtlasIndex(ai+1);
+                    gid = frame->gid;
+                    break;
                 }
+                time -= frame->duration;
             }
         }
+
+        unsigned int& current = _animationFrames[it->first];
+        if (current != gid)
+        {
+            current = gid;
+            changed = true;
+        }
     }
-    _tiles[z] = gid;
-    return tile;
-}
-Sprite * TMXLayer::updateTileForGID(unsigned int gid, const Point& pos)    
-{
-    Rect rect = _tileSet->rectForGID(gid);
-    rect = Rect(rect.origin.x / _contentScaleFactor, rect.origin.y / _contentScaleFactor, rect.size.width/ _contentScaleFactor, rect.size.height/ _contentScaleFactor);
-    int z = (int)(pos.x + pos.y * _layerSize.width);
 
-    Sprite *tile = reusedTileWithRect(rect);
+    if (! changed)
+    {
+        return;
+    }
 
-    setupTileSprite(tile ,pos ,gid);
+    // one pass over the animated tiles updates the quads of the built chunks
+    int layerWidth = (int)_layerSize.width;
+    for (unsigned int i = 0; i < _animatedTiles.size(); )
+    {
+        int z = _animatedTiles[i];
+        unsigned int gid = _tiles[z];
 
-    // get atlas index
-    unsigned int indexForZ = atlasIndexForExistantZ(z);
-    tile->setAtlasIndex(indexForZ);
-    tile->setDirty(true);
-    tile->updateTransform();
-    _tiles[z] = gid;
+        // the tile was changed by setTileGID
+        if (_animationFrames.find(gid & kFlippedMask) == _animationFrames.end())
+        {
+            _animatedTiles[i] = _animatedTiles.back();
+            _animatedTiles.pop_back();
+            continue;
+        }
+        ++i;
 
-    return tile;
+        Point pos((float)(z % layerWidth), (float)(z / layerWidth));
+        TextureAtlas *atlas = _chunks[getChunkIndexForPos(pos)];
+        if (atlas && _tileQuads[z] >= 0)
+        {
+            V3F_C4B_T2F_Quad quad;
+            setupTileQuad(&quad, pos, getAnimatedGID(gid));
+            atlas->updateQuad(&quad, _tileQuads[z]);
+        }
+    }
 }
 
-// used only when parsing the map. useless after the map was parsed
-// since lot's of assumptions are no longer true
-Sprite * TMXLayer::appendTileForGID(unsigned int gid, const Point& pos)
+void TMXLayer::draw()
 {
-    Rect rect = _tileSet->rectForGID(gid);
-    rect = CC_RECT_PIXELS_TO_POINTS(rect);
+    if (! _chunks.empty())
+    {
+        CC_PROFILE_ZONE("CCTMXLayer - draw");
 
-    intptr_t z = (intptr_t)(pos.x + pos.y * _layerSize.width);
+        // the visible area of the screen in the space of the layer, with a margin of half a chunk
+        Director *director = Director::getInstance();
+        Point visibleOrigin = director->getVisibleOrigin();
+        Size visibleSize = director->getVisibleSize();
+        Rect visibleRect(visibleOrigin.x, visibleOrigin.y, visibleSize.width, visibleSize.height);
+        visibleRect = RectApplyAffineTransform(visibleRect, getWorldToNodeTransform());
 
-    Sprite *tile = reusedTileWithRect(rect);
+        Size margin = CC_SIZE_PIXELS_TO_POINTS(_mapTileSize) * (CC_TMX_LAYER_CHUNK_SIZE / 2.0f);
+        visibleRect.origin = visibleRect.origin - Point(margin.width, margin.height);
+        visibleRect.size = visibleRect.size + Size(margin.width, margin.height) * 2;
 
-    setupTileSprite(tile ,pos ,gid);
+        bool setup = false;
+        for (int i = 0; i < (int)_chunks.size(); ++i)
+        {
+            if (! _chunkRects[i].intersectsRect(visibleRect))
+            {
+                releaseChunk(i);
+                continue;
+            }
 
-    // optimization:
-    // The difference between appendTileForGID and insertTileforGID is that append is faster, since
-    // it appends the tile at the end of the texture atlas
-    unsigned int indexForZ = _atlasIndexArray->num;
+            if (! _chunks[i])
+            {
+                if (! _tiles)
+                {
+                    continue;
+                }
+                _chunks[i] = buildChunk(i);
+            }
 
-    // don't add it using the "standard" way.
-    insertQuadFromSprite(tile, indexForZ);
+            if (_chunks[i]->getTotalQuads() == 0)
+            {
+                continue;
+            }
 
-    // append should be after addQuadFromSprite since it modifies the quantity values
-    ccCArrayInsertValueAtIndex(_atlasIndexArray, (void*)z, indexForZ);
+            if (! setup)
+            {
+                CC_NODE_DRAW_SETUP();
+                GL::blendFunc( _blendFunc.src, _blendFunc.dst );
+                setup = true;
+            }
 
-    return tile;
-}
+            // the quads of the chunk stay in its buffers while it is visible
+            _chunks[i]->drawQuads();
+        }
+    }
 
-// TMXLayer - atlasIndex and Z
-static inline int compareInts(const void * a, const void * b)
-{
-    return ((*(int*)a) - (*(int*)b));
+    // the tiles that became a Sprite
+    SpriteBatchNode::draw();
 }
-unsigned int TMXLayer::atlasIndexForExistantZ(unsigned int z)
+
+// TMXLayer - obtaining tiles/gids
+Sprite * TMXLayer::getTileAt(const Point& pos)
 {
-    int key=z;
-    int *item = (int*)bsearch((void*)&key, (void*)&_atlasIndexArray->arr[0], _atlasIndexArray->num, sizeof(void*), compareInts);
+    CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
+    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
 
-    CCASSERT(item, "TMX atlas index not found. Shall not happen");
+    Sprite *tile = nullptr;
+    unsigned int gid = this->getTileGIDAt(pos);
 
-    int index = ((size_t)item - (size_t)_atlasIndexArray->arr) / sizeof(void*);
-    return index;
-}
-unsigned int TMXLayer::atlasIndexForNewZ(int z)
-{
-    // XXX: This can be improved with a sort of binary search
-    unsigned int i=0;
-    for (i=0; i< _atlasIndexArray->num ; i++) 
+    // if GID == 0, then no tile is present
+    if (gid) 
     {
-        int val = (size_t) _atlasIndexArray->arr[i];
-        if (z < val)
+        int z = (int)(pos.x + pos.y * _layerSize.width);
+        tile = static_cast<Sprite*>(this->getChildByTag(z));
+
+        // tile not created yet. create it
+        if (! tile) 
         {
-            break;
+            Rect rect = _tileSet->rectForGID(gid);
+            rect = CC_RECT_PIXELS_TO_POINTS(rect);
+
+            tile = new Sprite();
+            tile->initWithTexture(this->getTexture(), rect);
+            setupTileSprite(tile, pos, _tiles[z]);
+
+            SpriteBatchNode::addChild(tile, z, z);
+            tile->release();
+
+            // the chunk must not draw the tile anymore
+            removeTileQuad(pos);
         }
-    } 
+    }
+    
+    return tile;
+}
+
+unsigned int TMXLayer::getTileGIDAt(const Point& pos, ccTMXTileFlags* flags/* = nullptr*/)
+{
+    CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
+    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
+
+    int idx = (int)(pos.x + pos.y * _layerSize.width);
+    // Bits on the far end of the 32-bit global tile ID are used for tile flags
+    unsigned int tile = _tiles[idx];
+
+    // issue1264, flipped tiles can be changed dynamically
+    if (flags) 
+    {
+        *flags = (ccTMXTileFlags)(tile & kFlipedAll);
+    }
     
-    return i;
+    return (tile & kFlippedMask);
 }
 
 // TMXLayer - adding / remove tiles
@@ -498,7 +792,7 @@ void TMXLayer::setTileGID(unsigned int gid, const Point& pos)
 void TMXLayer::setTileGID(unsigned int gid, const Point& pos, ccTMXTileFlags flags)
 {
     CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles && _atlasIndexArray, "TMXLayer: the tiles map has been released");
+    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
     CCASSERT(gid == 0 || gid >= _tileSet->_firstGid, "TMXLayer: invalid gid" );
 
     ccTMXTileFlags currentFlags;
@@ -513,16 +807,21 @@ void TMXLayer::setTileGID(unsigned int gid, const Point& pos, ccTMXTileFlags fla
         {
             removeTileAt(pos);
         }
-        // empty tile. create a new one
-        else if (currentGID == 0)
-        {
-            insertTileForGID(gidAndFlags, pos);
-        }
-        // modifying an existing tile with a non-empty tile
+        // modifying an existing tile, or creating a new one
         else 
         {
             unsigned int z = (unsigned int)(pos.x + pos.y * _layerSize.width);
-            Sprite *sprite = static_cast<Sprite*>(getChildByTag(z));
+
+            if (! _animationFrames.empty() &&
+                _animationFrames.find(gid) != _animationFrames.end() &&
+                _animationFrames.find(currentGID) == _animationFrames.end())
+            {
+                _animatedTiles.push_back(z);
+            }
+
+            Sprite *sprite = _children.empty() ? nullptr : static_cast<Sprite*>(getChildByTag(z));
+            _tiles[z] = gidAndFlags;
+
             if (sprite)
             {
                 Rect rect = _tileSet->rectForGID(gid);
@@ -533,11 +832,10 @@ void TMXLayer::setTileGID(unsigned int gid, const Point& pos, ccTMXTileFlags fla
                 {
                     setupTileSprite(sprite, sprite->getPosition(), gidAndFlags);
                 }
-                _tiles[z] = gidAndFlags;
             } 
             else 
             {
-                updateTileForGID(gidAndFlags, pos);
+                updateTileQuad(pos, gidAndFlags);
             }
         }
     }
@@ -560,60 +858,39 @@ void TMXLayer::removeChild(Node* node, bool cleanup)
         return;
     }
 
-    CCASSERT(_children->containsObject(sprite), "Tile does not belong to TMXLayer");
+    CCASSERT(_children.contains(sprite), "Tile does not belong to TMXLayer");
 
-    unsigned int atlasIndex = sprite->getAtlasIndex();
-    unsigned int zz = (size_t)_atlasIndexArray->arr[atlasIndex];
-    _tiles[zz] = 0;
-    ccCArrayRemoveValueAtIndex(_atlasIndexArray, atlasIndex);
+    // the tag of a tile is its index in the map
+    if (_tiles)
+    {
+        _tiles[sprite->getTag()] = 0;
+    }
     SpriteBatchNode::removeChild(sprite, cleanup);
 }
 
 void TMXLayer::removeTileAt(const Point& pos)
 {
     CCASSERT(pos.x < _layerSize.width && pos.y < _layerSize.height && pos.x >=0 && pos.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles && _atlasIndexArray, "TMXLayer: the tiles map has been released");
+    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
 
     unsigned int gid = getTileGIDAt(pos);
 
     if (gid) 
     {
         unsigned int z = (unsigned int)(pos.x + pos.y * _layerSize.width);
-        unsigned int atlasIndex = atlasIndexForExistantZ(z);
 
         // remove tile from GID map
         _tiles[z] = 0;
 
-        // remove tile from atlas position array
-        ccCArrayRemoveValueAtIndex(_atlasIndexArray, atlasIndex);
-
-        // remove it from sprites and/or texture atlas
-        Sprite *sprite = (Sprite*)getChildByTag(z);
+        // remove it from sprites and/or its chunk
+        Sprite *sprite = _children.empty() ? nullptr : (Sprite*)getChildByTag(z);
         if (sprite)
         {
             SpriteBatchNode::removeChild(sprite, true);
         }
         else 
         {
-            _textureAtlas->removeQuadAtIndex(atlasIndex);
-
-            // update possible children
-            if (_children && _children->count()>0)
-            {
-                Object* pObject = nullptr;
-                CCARRAY_FOREACH(_children, pObject)
-                {
-                    Sprite* child = static_cast<Sprite*>(pObject);
-                    if (child)
-                    {
-                        unsigned int ai = child->getAtlasIndex();
-                        if ( ai >= atlasIndex )
-                        {
-                            child->setAtlasIndex(ai-1);
-                        }
-                    }
-                }
-            }
+            removeTileQuad(pos);
         }
     }
 }
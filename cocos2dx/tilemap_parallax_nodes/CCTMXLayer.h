@@ -30,12 +30,13 @@ THE SOFTWARE.
 #include "base_nodes/CCAtlasNode.h"
 #include "sprite_nodes/CCSpriteBatchNode.h"
 #include "CCTMXXMLParser.h"
+#include <map>
+#include <vector>
 NS_CC_BEGIN
 
 class TMXMapInfo;
 class TMXLayerInfo;
 class TMXTilesetInfo;
-struct _ccCArray;
 
 /**
  * @addtogroup tilemap_parallax_nodes
@@ -44,8 +45,11 @@ struct _ccCArray;
 
 /** @brief TMXLayer represents the TMX layer.
 
-It is a subclass of SpriteBatchNode. By default the tiles are rendered using a TextureAtlas.
-If you modify a tile on runtime, then, that tile will become a Sprite, otherwise no Sprite objects are created.
+It is a subclass of SpriteBatchNode. By default the tiles are rendered using a TextureAtlas per chunk of
+CC_TMX_LAYER_CHUNK_SIZE x CC_TMX_LAYER_CHUNK_SIZE tiles. The quads of a chunk are only built when the chunk
+comes near the visible area, and its atlas is recycled for another chunk when it goes out of it, so the memory
+used by a layer depends on the size of the screen, not on the size of the map.
+If you get a tile (getTileAt) on runtime, then, that tile will become a Sprite, otherwise no Sprite objects are created.
 The benefits of using Sprite objects as tiles are:
 - tiles (Sprite) can be rotated/scaled/moved with a nice API
 
@@ -84,7 +88,7 @@ public:
     bool initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *layerInfo, TMXMapInfo *mapInfo);
 
     /** dealloc the map that contains the tile position from memory.
-    Unless you want to know at runtime the tiles positions, you can safely call this method.
+    The chunks are built from the map, so all of them are built before releasing it: the whole layer stays in memory.
     If you are going to call layer->tileGIDAt() then, don't release the map
     */
     void releaseMap();
@@ -179,6 +183,10 @@ public:
     virtual void addChild(Node * child, int zOrder, int tag) override;
     // super method
     void removeChild(Node* child, bool cleanup) override;
+    virtual void draw() override;
+    /** plays the animated tiles of the tileset. The tiles that became a Sprite aren't animated,
+     and the animations stop once the map has been released */
+    virtual void update(float delta) override;
 
 
 private:
@@ -188,20 +196,23 @@ private:
 
     Point calculateLayerOffset(const Point& offset);
 
-    /* optimization methods */
-    Sprite* appendTileForGID(unsigned int gid, const Point& pos);
-    Sprite* insertTileForGID(unsigned int gid, const Point& pos);
-    Sprite* updateTileForGID(unsigned int gid, const Point& pos);
-
     /* The layer recognizes some special properties, like cc_vertez */
     void parseInternalProperties();
     void setupTileSprite(Sprite* sprite, Point pos, unsigned int gid);
-    Sprite* reusedTileWithRect(Rect rect);
+    void setupTileQuad(V3F_C4B_T2F_Quad* quad, const Point& pos, unsigned int gid);
     int getVertexZForPos(const Point& pos);
 
-    // index
-    unsigned int atlasIndexForExistantZ(unsigned int z);
-    unsigned int atlasIndexForNewZ(int z);
+    /* chunks */
+    void setupChunks();
+    int getChunkIndexForPos(const Point& pos) const;
+    TextureAtlas* buildChunk(int index);
+    void releaseChunk(int index);
+    void updateTileQuad(const Point& pos, unsigned int gid);
+    void removeTileQuad(const Point& pos);
+
+    /* animated tiles */
+    void setupAnimations();
+    unsigned int getAnimatedGID(unsigned int gid) const;
     
 protected:
     //! name of the layer
@@ -216,9 +227,25 @@ protected:
     int                    _vertexZvalue;
     bool                _useAutomaticVertexZ;
 
-    //! used for optimization
-    Sprite            *_reusedTile;
-    ccCArray            *_atlasIndexArray;
+    //! atlases of the chunks, row by row, NULL if the chunk isn't built
+    std::vector<TextureAtlas*> _chunks;
+    //! bounding box in points of the tiles of each chunk
+    std::vector<Rect> _chunkRects;
+    //! index of the quad of each tile in the atlas of its chunk, -1 if the tile has no quad
+    std::vector<int> _tileQuads;
+    //! indices of the quads of each chunk that were emptied by an edit, to be reused
+    std::vector< std::vector<int> > _chunkFreeQuads;
+    //! atlases of the chunks that went out of the visible area, to be recycled
+    std::vector<TextureAtlas*> _freeChunks;
+    //! number of chunks in a row
+    int                 _chunksWide;
+
+    //! gid of the current frame of each animated gid of the tileset
+    std::map<unsigned int, unsigned int> _animationFrames;
+    //! indices of the tiles that may show an animated gid
+    std::vector<int> _animatedTiles;
+    //! time in seconds since the animations started
+    float               _animationTime;
     
     // used for retina display
     float               _contentScaleFactor;
@@ -26,14 +26,32 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "CCTMXObjectGroup.h"
 #include "ccMacros.h"
+#include <algorithm>
+#include <math.h>
 
 NS_CC_BEGIN
 
+// objects covering more cells are tested by every query instead
+static const int kMaxObjectCells = 64;
+
+static inline long long objectCellKey(int x, int y)
+{
+    return ((long long)x << 32) | (unsigned int)y;
+}
+
+static float floatForKey(Dictionary* dict, const char* key)
+{
+    String* value = static_cast<String*>(dict->objectForKey(key));
+    return value ? value->floatValue() : 0.0f;
+}
+
 //implementation TMXObjectGroup
 
 TMXObjectGroup::TMXObjectGroup()
     : _groupName("")
     , _positionOffset(Point::ZERO)
+    , _objectIndexDirty(true)
+    , _objectIndexCellSize(256.0f)
 {
     _objects = Array::create();
     _objects->retain();
@@ -49,21 +67,156 @@ TMXObjectGroup::~TMXObjectGroup()
 
 Dictionary* TMXObjectGroup::getObject(const char *objectName) const
 {
-    if (_objects && _objects->count() > 0)
+    const TMXObjectInfo* info = getObjectInfo(objectName);
+    return info ? info->dictionary : NULL;
+}
+
+const TMXObjectInfo* TMXObjectGroup::getObjectInfo(const char *objectName) const
+{
+    rebuildObjectIndex();
+
+    auto it = _objectNames.find(objectName);
+    if (it == _objectNames.end())
+    {
+        // object not found
+        return NULL;
+    }
+    return &_objectInfos[it->second];
+}
+
+const std::vector<TMXObjectInfo>& TMXObjectGroup::getObjectInfos() const
+{
+    rebuildObjectIndex();
+    return _objectInfos;
+}
+
+void TMXObjectGroup::getObjectsInRect(const Rect& rect, std::vector<const TMXObjectInfo*>& result) const
+{
+    queryObjects(rect, result);
+}
+
+void TMXObjectGroup::getObjectsAtPoint(const Point& point, std::vector<const TMXObjectInfo*>& result) const
+{
+    queryObjects(Rect(point.x, point.y, 0, 0), result);
+}
+
+void TMXObjectGroup::setObjectIndexCellSize(float size)
+{
+    CCASSERT(size > 0, "The cell size must be positive");
+
+    if (_objectIndexCellSize != size)
     {
-        Object* pObj = nullptr;
-        CCARRAY_FOREACH(_objects, pObj)
+        _objectIndexCellSize = size;
+        _objectIndexDirty = true;
+    }
+}
+
+void TMXObjectGroup::rebuildObjectIndex() const
+{
+    unsigned int count = _objects ? _objects->count() : 0;
+
+    // the parser and the games add objects to the array directly
+    if (! _objectIndexDirty && _objectInfos.size() == count)
+    {
+        return;
+    }
+    _objectIndexDirty = false;
+
+    _objectInfos.clear();
+    _objectNames.clear();
+    _objectCells.clear();
+    _unindexedObjects.clear();
+    _objectInfos.reserve(count);
+
+    const float invCellSize = 1.0f / _objectIndexCellSize;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Dictionary* dict = static_cast<Dictionary*>(_objects->objectAtIndex(i));
+
+        TMXObjectInfo info;
+        String* name = static_cast<String*>(dict->objectForKey("name"));
+        String* type = static_cast<String*>(dict->objectForKey("type"));
+        info.name = name ? name->getCString() : "";
+        info.type = type ? type->getCString() : "";
+        info.rect = Rect(floatForKey(dict, "x"), floatForKey(dict, "y"), floatForKey(dict, "width"), floatForKey(dict, "height"));
+        info.dictionary = dict;
+        _objectInfos.push_back(info);
+
+        // the 1st object with a name wins, as the linear search did
+        if (name)
         {
-            Dictionary* pDict = static_cast<Dictionary*>(pObj);
-            String *name = static_cast<String*>(pDict->objectForKey("name"));
-            if (name && name->_string == objectName)
+            _objectNames.insert(std::make_pair(info.name, i));
+        }
+
+        int x0 = (int)floorf(info.rect.getMinX() * invCellSize);
+        int x1 = (int)floorf(info.rect.getMaxX() * invCellSize);
+        int y0 = (int)floorf(info.rect.getMinY() * invCellSize);
+        int y1 = (int)floorf(info.rect.getMaxY() * invCellSize);
+
+        if ((long long)(x1 - x0 + 1) * (y1 - y0 + 1) > kMaxObjectCells)
+        {
+            _unindexedObjects.push_back(i);
+            continue;
+        }
+
+        for (int y = y0; y <= y1; ++y)
+        {
+            for (int x = x0; x <= x1; ++x)
             {
-                return pDict;
+                _objectCells[objectCellKey(x, y)].push_back(i);
             }
         }
     }
-    // object not found
-    return NULL;    
+}
+
+void TMXObjectGroup::queryObjects(const Rect& rect, std::vector<const TMXObjectInfo*>& result) const
+{
+    rebuildObjectIndex();
+
+    _queryIndices.clear();
+    _queryIndices.insert(_queryIndices.end(), _unindexedObjects.begin(), _unindexedObjects.end());
+
+    const float invCellSize = 1.0f / _objectIndexCellSize;
+    int x0 = (int)floorf(rect.getMinX() * invCellSize);
+    int x1 = (int)floorf(rect.getMaxX() * invCellSize);
+    int y0 = (int)floorf(rect.getMinY() * invCellSize);
+    int y1 = (int)floorf(rect.getMaxY() * invCellSize);
+
+    if ((long long)(x1 - x0 + 1) * (y1 - y0 + 1) > (long long)_objectCells.size())
+    {
+        // the rect covers more cells than there are: every object is a candidate
+        for (unsigned int i = 0; i < _objectInfos.size(); ++i)
+        {
+            _queryIndices.push_back(i);
+        }
+    }
+    else
+    {
+        for (int y = y0; y <= y1; ++y)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                auto it = _objectCells.find(objectCellKey(x, y));
+                if (it != _objectCells.end())
+                {
+                    _queryIndices.insert(_queryIndices.end(), it->second.begin(), it->second.end());
+                }
+            }
+        }
+    }
+
+    // an object spanning several cells is found once, and the results keep the order of the group
+    std::sort(_queryIndices.begin(), _queryIndices.end());
+    _queryIndices.erase(std::unique(_queryIndices.begin(), _queryIndices.end()), _queryIndices.end());
+
+    for (auto i : _queryIndices)
+    {
+        const TMXObjectInfo& info = _objectInfos[i];
+        if (info.rect.intersectsRect(rect))
+        {
+            result.push_back(&info);
+        }
+    }
 }
 
 String* TMXObjectGroup::getProperty(const char* propertyName) const
@@ -31,6 +31,9 @@ THE SOFTWARE.
 #include "cocoa/CCString.h"
 #include "cocoa/CCArray.h"
 #include "cocoa/CCDictionary.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -39,6 +42,19 @@ NS_CC_BEGIN
  * @{
  */
 
+/** @brief An object of a TMXObjectGroup, with the fields of its dictionary parsed once.
+The rect uses the units of the "x", "y", "width" and "height" entries: map pixels, with y going up.
+@since v3.0
+*/
+struct CC_DLL TMXObjectInfo
+{
+    std::string name;
+    std::string type;
+    Rect rect;
+    /** the dictionary of the object, with all its properties */
+    Dictionary* dictionary;
+};
+
 /** @brief TMXObjectGroup represents the TMX object group.
 @since v0.99.0
 */
@@ -62,6 +78,37 @@ public:
     Dictionary* getObject(const char *objectName) const;
     
     CC_DEPRECATED_ATTRIBUTE Dictionary* objectNamed(const char *objectName) const { return getObject(objectName); };
+
+    /** returns the parsed object with the name, or NULL. The 1st one when several objects have the name.
+    @since v3.0
+    */
+    const TMXObjectInfo* getObjectInfo(const char *objectName) const;
+
+    /** returns the parsed objects, in the order of the group
+    @since v3.0
+    */
+    const std::vector<TMXObjectInfo>& getObjectInfos() const;
+
+    /** appends to result the objects whose rect intersects rect, in the order of the group
+    @since v3.0
+    */
+    void getObjectsInRect(const Rect& rect, std::vector<const TMXObjectInfo*>& result) const;
+
+    /** appends to result the objects whose rect contains point, in the order of the group
+    @since v3.0
+    */
+    void getObjectsAtPoint(const Point& point, std::vector<const TMXObjectInfo*>& result) const;
+
+    /** The parsed objects and their indices are rebuilt at the next query when objects are added or removed.
+    Call this after changing the name or the position of an object in its dictionary.
+    @since v3.0
+    */
+    inline void invalidateObjectIndex() { _objectIndexDirty = true; }
+
+    /** Sets the size of the cells of the spatial index, in map pixels. Default: 256
+    @since v3.0
+    */
+    void setObjectIndexCellSize(float size);
     
     /** Gets the offset position of child objects */
     inline const Point& getPositionOffset() const { return _positionOffset; };
@@ -87,9 +134,13 @@ public:
         CC_SAFE_RETAIN(objects);
         CC_SAFE_RELEASE(_objects);
         _objects = objects;
+        _objectIndexDirty = true;
     };
     
 protected:
+    void rebuildObjectIndex() const;
+    void queryObjects(const Rect& rect, std::vector<const TMXObjectInfo*>& result) const;
+
     /** name of the group */
     std::string _groupName;
     /** offset position of child objects */
@@ -98,6 +149,17 @@ protected:
     Dictionary* _properties;
     /** array of the objects */
     Array* _objects;
+
+    // parsed objects and their indices, built by the 1st query
+    mutable std::vector<TMXObjectInfo> _objectInfos;
+    mutable std::unordered_map<std::string, unsigned int> _objectNames;
+    // grid of the object rects: cell -> indices in _objectInfos, sorted
+    mutable std::unordered_map<long long, std::vector<unsigned int>> _objectCells;
+    // indices of the objects covering too many cells, tested by every query
+    mutable std::vector<unsigned int> _unindexedObjects;
+    mutable std::vector<unsigned int> _queryIndices;
+    mutable bool _objectIndexDirty;
+    float _objectIndexCellSize;
 };
 
 // end of tilemap_parallax_nodes group
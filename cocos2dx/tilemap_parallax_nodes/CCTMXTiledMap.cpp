@@ -209,10 +209,9 @@ void TMXTiledMap::buildWithMapInfo(TMXMapInfo* mapInfo)
 TMXLayer * TMXTiledMap::getLayer(const char *layerName) const
 {
     CCASSERT(layerName != NULL && strlen(layerName) > 0, "Invalid layer name!");
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(_children, pObj) 
+    for (auto child : _children)
     {
-        TMXLayer* layer = dynamic_cast<TMXLayer*>(pObj);
+        TMXLayer* layer = dynamic_cast<TMXLayer*>(child);
         if(layer)
         {
             if(0 == strcmp(layer->getLayerName(), layerName))
@@ -25,28 +25,222 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 
-#include <map>
 #include <sstream>
+#include <stdio.h>
 #include "CCTMXXMLParser.h"
 #include "CCTMXTiledMap.h"
 #include "ccMacros.h"
 #include "platform/CCFileUtils.h"
 #include "support/zip_support/ZipUtils.h"
 #include "support/base64.h"
+#include "support/CCJobSystem.h"
+#include "platform/CCMappedFile.h"
 
 using namespace std;
 
 NS_CC_BEGIN
 
-static const char* valueForKey(const char *key, std::map<std::string, std::string>* dict)
+// the attributes are looked up in place: elements only have a few of them
+static const char* valueForKey(const char *key, const char **atts)
 {
-    if (dict)
+    if (atts)
     {
-        std::map<std::string, std::string>::iterator it = dict->find(key);
-        return it!=dict->end() ? it->second.c_str() : "";
+        for (int i = 0; atts[i]; i += 2)
+        {
+            if (strcmp(atts[i], key) == 0)
+            {
+                return atts[i+1];
+            }
+        }
     }
     return "";
 }
+
+// binary maps written by TMXMapInfo::writeBinaryFile(), with the byte order of the device
+static const char s_binaryMagic[8] = { 'C', 'C', 'T', 'M', 'X', 'B', 'I', 'N' };
+static const unsigned int s_binaryVersion = 2;
+
+// types of the properties: the values of the dictionaries and arrays are strings, dictionaries or arrays
+enum {
+    kBinaryString,
+    kBinaryDictionary,
+    kBinaryArray,
+};
+
+class TMXBinaryWriter
+{
+public:
+    TMXBinaryWriter(FILE *file) : _file(file), _ok(true) {}
+
+    bool isOk() const { return _ok; }
+
+    void write(const void *data, size_t size)
+    {
+        if (_ok && size > 0 && fwrite(data, size, 1, _file) != 1)
+        {
+            _ok = false;
+        }
+    }
+
+    void writeUInt(unsigned int value) { write(&value, sizeof(value)); }
+    void writeFloat(float value) { write(&value, sizeof(value)); }
+    void writeSize(const Size& size) { writeFloat(size.width); writeFloat(size.height); }
+    void writePoint(const Point& point) { writeFloat(point.x); writeFloat(point.y); }
+
+    void writeString(const std::string& value)
+    {
+        writeUInt((unsigned int)value.size());
+        write(value.data(), value.size());
+    }
+
+    // dictionaries with string keys
+    void writeDictionary(Dictionary *dict)
+    {
+        writeUInt(dict ? dict->count() : 0);
+        if (dict)
+        {
+            DictElement *element = NULL;
+            CCDICT_FOREACH(dict, element)
+            {
+                writeString(element->getStrKey());
+                writeObject(element->getObject());
+            }
+        }
+    }
+
+    void writeObject(Object *object)
+    {
+        if (Dictionary *dict = dynamic_cast<Dictionary*>(object))
+        {
+            writeUInt(kBinaryDictionary);
+            writeDictionary(dict);
+        }
+        else if (Array *array = dynamic_cast<Array*>(object))
+        {
+            writeUInt(kBinaryArray);
+            writeUInt(array->count());
+            Object *item = NULL;
+            CCARRAY_FOREACH(array, item)
+            {
+                writeObject(item);
+            }
+        }
+        else
+        {
+            String *string = dynamic_cast<String*>(object);
+            writeUInt(kBinaryString);
+            writeString(string ? string->getCString() : "");
+        }
+    }
+
+private:
+    FILE *_file;
+    bool _ok;
+};
+
+class TMXBinaryReader
+{
+public:
+    TMXBinaryReader(const unsigned char *data, unsigned long size) : _data(data), _end(data + size), _ok(true) {}
+
+    bool isOk() const { return _ok; }
+
+    const unsigned char* read(size_t size)
+    {
+        if (! _ok || size > (size_t)(_end - _data))
+        {
+            _ok = false;
+            return NULL;
+        }
+        const unsigned char *data = _data;
+        _data += size;
+        return data;
+    }
+
+    unsigned int readUInt()
+    {
+        unsigned int value = 0;
+        const unsigned char *data = read(sizeof(value));
+        if (data)
+        {
+            memcpy(&value, data, sizeof(value));
+        }
+        return value;
+    }
+
+    float readFloat()
+    {
+        float value = 0;
+        const unsigned char *data = read(sizeof(value));
+        if (data)
+        {
+            memcpy(&value, data, sizeof(value));
+        }
+        return value;
+    }
+
+    Size readSize() { float width = readFloat(); return Size(width, readFloat()); }
+    Point readPoint() { float x = readFloat(); return Point(x, readFloat()); }
+
+    std::string readString()
+    {
+        unsigned int length = readUInt();
+        const unsigned char *data = read(length);
+        return data ? std::string((const char*)data, length) : std::string();
+    }
+
+    // returns an autoreleased dictionary with string keys
+    Dictionary* readDictionary()
+    {
+        Dictionary *dict = Dictionary::create();
+        unsigned int count = readUInt();
+        for (unsigned int i = 0; i < count && _ok; ++i)
+        {
+            std::string key = readString();
+            Object *object = readObject();
+            if (object)
+            {
+                dict->setObject(object, key);
+            }
+        }
+        return dict;
+    }
+
+    // returns an autoreleased object
+    Object* readObject()
+    {
+        switch (readUInt())
+        {
+        case kBinaryString:
+            return String::create(readString());
+        case kBinaryDictionary:
+            return readDictionary();
+        case kBinaryArray:
+            {
+                unsigned int count = readUInt();
+                Array *array = Array::createWithCapacity(MIN(count, 1024u));
+                for (unsigned int i = 0; i < count && _ok; ++i)
+                {
+                    Object *object = readObject();
+                    if (object)
+                    {
+                        array->addObject(object);
+                    }
+                }
+                return array;
+            }
+        default:
+            _ok = false;
+            return NULL;
+        }
+    }
+
+private:
+    const unsigned char *_data;
+    const unsigned char *_end;
+    bool _ok;
+};
+
 // implementation TMXLayerInfo
 TMXLayerInfo::TMXLayerInfo()
 : _name("")
@@ -169,13 +363,86 @@ void TMXMapInfo::internalInit(const char* tmxFileName, const char* resourcePath)
 bool TMXMapInfo::initWithXML(const char* tmxString, const char* resourcePath)
 {
     internalInit(NULL, resourcePath);
-    return parseXMLString(tmxString);
+    bool ret = parseXMLString(tmxString);
+    decodeLayerData();
+    return ret;
 }
 
 bool TMXMapInfo::initWithTMXFile(const char *tmxFile)
 {
     internalInit(tmxFile, NULL);
-    return parseXMLFile(_TMXFileName.c_str());
+
+    MappedFile *file = FileUtils::getInstance()->getMappedFileData(_TMXFileName.c_str());
+    if (! file)
+    {
+        return false;
+    }
+
+    if (file->getSize() >= sizeof(s_binaryMagic) && memcmp(file->getBytes(), s_binaryMagic, sizeof(s_binaryMagic)) == 0)
+    {
+        return parseBinaryData(file->getBytes(), file->getSize());
+    }
+
+    SAXParser parser;
+    if (false == parser.init("UTF-8") )
+    {
+        return false;
+    }
+    parser.setDelegator(this);
+
+    bool ret = parser.parse((const char*)file->getBytes(), (unsigned int)file->getSize());
+    decodeLayerData();
+    return ret;
+}
+
+void TMXMapInfo::decodeLayerData()
+{
+    // each layer is decoded and inflated by its own job
+    JobSystem::getInstance()->parallelFor((unsigned int)_layerData.size(), 1, [this](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            LayerData& layerData = _layerData[i];
+            TMXLayerInfo *layer = layerData.layer;
+
+            unsigned char *buffer;
+            int len = base64Decode((unsigned char*)layerData.data.c_str(), (unsigned int)layerData.data.length(), &buffer);
+            if( ! buffer ) 
+            {
+                CCLOG("cocos2d: TiledMap: decode data error");
+                continue;
+            }
+
+            if( layerData.attribs & (TMXLayerAttribGzip | TMXLayerAttribZlib) )
+            {
+                unsigned char *deflated;
+                Size s = layer->_layerSize;
+                // int sizeHint = s.width * s.height * sizeof(uint32_t);
+                int sizeHint = (int)(s.width * s.height * sizeof(unsigned int));
+
+                int inflatedLen = ZipUtils::ccInflateMemoryWithHint(buffer, len, &deflated, sizeHint);
+                CCASSERT(inflatedLen == sizeHint, "");
+
+                inflatedLen = (size_t)&inflatedLen; // XXX: to avoid warnings in compiler
+                
+                delete [] buffer;
+                buffer = NULL;
+
+                if( ! deflated ) 
+                {
+                    CCLOG("cocos2d: TiledMap: inflate data error");
+                    continue;
+                }
+
+                layer->_tiles = (unsigned int*) deflated;
+            }
+            else
+            {
+                layer->_tiles = (unsigned int*) buffer;
+            }
+        }
+    });
+
+    _layerData.clear();
 }
 
 TMXMapInfo::TMXMapInfo()
@@ -237,30 +504,241 @@ bool TMXMapInfo::parseXMLFile(const char *xmlFilename)
 }
 
 
+bool TMXMapInfo::writeBinaryFile(const char *binaryFile) const
+{
+    FILE *file = fopen(binaryFile, "wb");
+    if (! file)
+    {
+        CCLOG("cocos2d: TMXFormat: can't open '%s' for writing", binaryFile);
+        return false;
+    }
+
+    // the images are found from the directory of the map when it is loaded
+    std::string dir;
+    if (_TMXFileName.find_last_of("/") != string::npos)
+    {
+        dir = _TMXFileName.substr(0, _TMXFileName.find_last_of("/") + 1);
+    }
+
+    TMXBinaryWriter writer(file);
+    writer.write(s_binaryMagic, sizeof(s_binaryMagic));
+    writer.writeUInt(s_binaryVersion);
+
+    writer.writeUInt((unsigned int)_orientation);
+    writer.writeSize(_mapSize);
+    writer.writeSize(_tileSize);
+    writer.writeDictionary(_properties);
+
+    // the tile properties are keyed by gid
+    writer.writeUInt(_tileProperties->count());
+    DictElement *element = NULL;
+    CCDICT_FOREACH(_tileProperties, element)
+    {
+        writer.writeUInt((unsigned int)element->getIntKey());
+        writer.writeDictionary(static_cast<Dictionary*>(element->getObject()));
+    }
+
+    Object *object = NULL;
+    writer.writeUInt(_tilesets->count());
+    CCARRAY_FOREACH(_tilesets, object)
+    {
+        TMXTilesetInfo *tileset = static_cast<TMXTilesetInfo*>(object);
+        std::string image = tileset->_sourceImage;
+        if (! dir.empty() && image.compare(0, dir.size(), dir) == 0)
+        {
+            image = image.substr(dir.size());
+        }
+
+        writer.writeString(tileset->_name);
+        writer.writeUInt(tileset->_firstGid);
+        writer.writeSize(tileset->_tileSize);
+        writer.writeUInt(tileset->_spacing);
+        writer.writeUInt(tileset->_margin);
+        writer.writeString(image);
+        writer.writeSize(tileset->_imageSize);
+
+        writer.writeUInt((unsigned int)tileset->_animations.size());
+        for (auto it = tileset->_animations.begin(); it != tileset->_animations.end(); ++it)
+        {
+            writer.writeUInt(it->first);
+            writer.writeUInt((unsigned int)it->second.size());
+            for (auto frame = it->second.begin(); frame != it->second.end(); ++frame)
+            {
+                writer.writeUInt(frame->gid);
+                writer.writeFloat(frame->duration);
+            }
+        }
+    }
+
+    writer.writeUInt(_layers->count());
+    CCARRAY_FOREACH(_layers, object)
+    {
+        TMXLayerInfo *layer = static_cast<TMXLayerInfo*>(object);
+        writer.writeString(layer->_name);
+        writer.writeSize(layer->_layerSize);
+        writer.writeUInt(layer->_visible ? 1 : 0);
+        writer.writeUInt(layer->_opacity);
+        writer.writeUInt(layer->_minGID);
+        writer.writeUInt(layer->_maxGID);
+        writer.writePoint(layer->_offset);
+        writer.writeDictionary(layer->_properties);
+
+        unsigned int count = layer->_tiles ? (unsigned int)(layer->_layerSize.width * layer->_layerSize.height) : 0;
+        writer.writeUInt(count);
+        writer.write(layer->_tiles, count * sizeof(unsigned int));
+    }
+
+    writer.writeUInt(_objectGroups->count());
+    CCARRAY_FOREACH(_objectGroups, object)
+    {
+        TMXObjectGroup *objectGroup = static_cast<TMXObjectGroup*>(object);
+        writer.writeString(objectGroup->getGroupName());
+        writer.writePoint(objectGroup->getPositionOffset());
+        writer.writeDictionary(objectGroup->getProperties());
+        writer.writeObject(objectGroup->getObjects());
+    }
+
+    bool ret = writer.isOk();
+    if (fclose(file) != 0)
+    {
+        ret = false;
+    }
+
+    if (! ret)
+    {
+        CCLOG("cocos2d: TMXFormat: error writing '%s'", binaryFile);
+    }
+    return ret;
+}
+
+bool TMXMapInfo::parseBinaryData(const unsigned char* data, unsigned long size)
+{
+    TMXBinaryReader reader(data, size);
+    reader.read(sizeof(s_binaryMagic));
+    if (reader.readUInt() != s_binaryVersion)
+    {
+        CCLOG("cocos2d: TMXFormat: unsupported version of binary map: %s", _TMXFileName.c_str());
+        return false;
+    }
+
+    std::string dir;
+    if (_TMXFileName.find_last_of("/") != string::npos)
+    {
+        dir = _TMXFileName.substr(0, _TMXFileName.find_last_of("/") + 1);
+    }
+
+    _orientation = (int)reader.readUInt();
+    _mapSize = reader.readSize();
+    _tileSize = reader.readSize();
+    setProperties(reader.readDictionary());
+
+    unsigned int count = reader.readUInt();
+    for (unsigned int i = 0; i < count && reader.isOk(); ++i)
+    {
+        unsigned int gid = reader.readUInt();
+        _tileProperties->setObject(reader.readDictionary(), gid);
+    }
+
+    count = reader.readUInt();
+    for (unsigned int i = 0; i < count && reader.isOk(); ++i)
+    {
+        TMXTilesetInfo *tileset = new TMXTilesetInfo();
+        tileset->_name = reader.readString();
+        tileset->_firstGid = reader.readUInt();
+        tileset->_tileSize = reader.readSize();
+        tileset->_spacing = reader.readUInt();
+        tileset->_margin = reader.readUInt();
+        tileset->_sourceImage = reader.readString();
+        if (! FileUtils::getInstance()->isAbsolutePath(tileset->_sourceImage))
+        {
+            tileset->_sourceImage = dir + tileset->_sourceImage;
+        }
+        tileset->_imageSize = reader.readSize();
+
+        unsigned int animationCount = reader.readUInt();
+        for (unsigned int j = 0; j < animationCount && reader.isOk(); ++j)
+        {
+            std::vector<TMXTileAnimationFrame>& frames = tileset->_animations[reader.readUInt()];
+            unsigned int frameCount = reader.readUInt();
+            for (unsigned int k = 0; k < frameCount && reader.isOk(); ++k)
+            {
+                TMXTileAnimationFrame frame;
+                frame.gid = reader.readUInt();
+                frame.duration = reader.readFloat();
+                frames.push_back(frame);
+            }
+        }
+
+        _tilesets->addObject(tileset);
+        tileset->release();
+    }
+
+    count = reader.readUInt();
+    for (unsigned int i = 0; i < count && reader.isOk(); ++i)
+    {
+        TMXLayerInfo *layer = new TMXLayerInfo();
+        layer->_name = reader.readString();
+        layer->_layerSize = reader.readSize();
+        layer->_visible = reader.readUInt() != 0;
+        layer->_opacity = (unsigned char)reader.readUInt();
+        layer->_minGID = reader.readUInt();
+        layer->_maxGID = reader.readUInt();
+        layer->_offset = reader.readPoint();
+        layer->setProperties(reader.readDictionary());
+
+        // the gids are copied as they are
+        unsigned int tileCount = reader.readUInt();
+        const unsigned char *tiles = reader.read(tileCount * sizeof(unsigned int));
+        if (tiles && tileCount > 0)
+        {
+            layer->_tiles = new unsigned int[tileCount];
+            memcpy(layer->_tiles, tiles, tileCount * sizeof(unsigned int));
+        }
+
+        _layers->addObject(layer);
+        layer->release();
+    }
+
+    count = reader.readUInt();
+    for (unsigned int i = 0; i < count && reader.isOk(); ++i)
+    {
+        TMXObjectGroup *objectGroup = new TMXObjectGroup();
+        objectGroup->setGroupName(reader.readString().c_str());
+        objectGroup->setPositionOffset(reader.readPoint());
+        objectGroup->setProperties(reader.readDictionary());
+
+        Array *objects = dynamic_cast<Array*>(reader.readObject());
+        if (objects)
+        {
+            objectGroup->setObjects(objects);
+        }
+
+        _objectGroups->addObject(objectGroup);
+        objectGroup->release();
+    }
+
+    if (! reader.isOk())
+    {
+        CCLOG("cocos2d: TMXFormat: corrupted binary map: %s", _TMXFileName.c_str());
+        return false;
+    }
+    return true;
+}
+
 // the XML parser calls here with all the elements
 void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
 {    
     CC_UNUSED_PARAM(ctx);
     TMXMapInfo *pTMXMapInfo = this;
     std::string elementName = (char*)name;
-    std::map<std::string, std::string> *attributeDict = new std::map<std::string, std::string>();
-    if (atts && atts[0])
-    {
-        for(int i = 0; atts[i]; i += 2) 
-        {
-            std::string key = (char*)atts[i];
-            std::string value = (char*)atts[i+1];
-            attributeDict->insert(pair<std::string, std::string>(key, value));
-        }
-    }
     if (elementName == "map")
     {
-        std::string version = valueForKey("version", attributeDict);
+        std::string version = valueForKey("version", atts);
         if ( version != "1.0")
         {
             CCLOG("cocos2d: TMXFormat: Unsupported TMX version: %s", version.c_str());
         }
-        std::string orientationStr = valueForKey("orientation", attributeDict);
+        std::string orientationStr = valueForKey("orientation", atts);
         if (orientationStr == "orthogonal")
             pTMXMapInfo->setOrientation(TMXOrientationOrtho);
         else if (orientationStr  == "isometric")
@@ -271,12 +749,12 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             CCLOG("cocos2d: TMXFomat: Unsupported orientation: %d", pTMXMapInfo->getOrientation());
 
         Size s;
-        s.width = (float)atof(valueForKey("width", attributeDict));
-        s.height = (float)atof(valueForKey("height", attributeDict));
+        s.width = (float)atof(valueForKey("width", atts));
+        s.height = (float)atof(valueForKey("height", atts));
         pTMXMapInfo->setMapSize(s);
 
-        s.width = (float)atof(valueForKey("tilewidth", attributeDict));
-        s.height = (float)atof(valueForKey("tileheight", attributeDict));
+        s.width = (float)atof(valueForKey("tilewidth", atts));
+        s.height = (float)atof(valueForKey("tileheight", atts));
         pTMXMapInfo->setTileSize(s);
 
         // The parent element is now "map"
@@ -285,7 +763,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     else if (elementName == "tileset") 
     {
         // If this is an external tileset then start parsing that
-        std::string externalTilesetFilename = valueForKey("source", attributeDict);
+        std::string externalTilesetFilename = valueForKey("source", atts);
         if (externalTilesetFilename != "")
         {
             // Tileset file will be relative to the map file. So we need to convert it to an absolute path
@@ -300,28 +778,28 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             }
             externalTilesetFilename = FileUtils::getInstance()->fullPathForFilename(externalTilesetFilename.c_str());
             
-            _currentFirstGID = (unsigned int)atoi(valueForKey("firstgid", attributeDict));
+            _currentFirstGID = (unsigned int)atoi(valueForKey("firstgid", atts));
             
             pTMXMapInfo->parseXMLFile(externalTilesetFilename.c_str());
         }
         else
         {
             TMXTilesetInfo *tileset = new TMXTilesetInfo();
-            tileset->_name = valueForKey("name", attributeDict);
+            tileset->_name = valueForKey("name", atts);
             if (_currentFirstGID == 0)
             {
-                tileset->_firstGid = (unsigned int)atoi(valueForKey("firstgid", attributeDict));
+                tileset->_firstGid = (unsigned int)atoi(valueForKey("firstgid", atts));
             }
             else
             {
                 tileset->_firstGid = _currentFirstGID;
                 _currentFirstGID = 0;
             }
-            tileset->_spacing = (unsigned int)atoi(valueForKey("spacing", attributeDict));
-            tileset->_margin = (unsigned int)atoi(valueForKey("margin", attributeDict));
+            tileset->_spacing = (unsigned int)atoi(valueForKey("spacing", atts));
+            tileset->_margin = (unsigned int)atoi(valueForKey("margin", atts));
             Size s;
-            s.width = (float)atof(valueForKey("tilewidth", attributeDict));
-            s.height = (float)atof(valueForKey("tileheight", attributeDict));
+            s.width = (float)atof(valueForKey("tilewidth", atts));
+            s.height = (float)atof(valueForKey("tileheight", atts));
             tileset->_tileSize = s;
 
             pTMXMapInfo->getTilesets()->addObject(tileset);
@@ -332,27 +810,36 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     {
         TMXTilesetInfo* info = (TMXTilesetInfo*)pTMXMapInfo->getTilesets()->lastObject();
         Dictionary *dict = new Dictionary();
-        pTMXMapInfo->setParentGID(info->_firstGid + atoi(valueForKey("id", attributeDict)));
+        pTMXMapInfo->setParentGID(info->_firstGid + atoi(valueForKey("id", atts)));
         pTMXMapInfo->getTileProperties()->setObject(dict, pTMXMapInfo->getParentGID());
         CC_SAFE_RELEASE(dict);
         
         pTMXMapInfo->setParentElement(TMXPropertyTile);
 
     }
+    else if (elementName == "frame")
+    {
+        // a frame of the <animation> of the current tile
+        TMXTilesetInfo* info = (TMXTilesetInfo*)pTMXMapInfo->getTilesets()->lastObject();
+        TMXTileAnimationFrame frame;
+        frame.gid = info->_firstGid + atoi(valueForKey("tileid", atts));
+        frame.duration = (float)atof(valueForKey("duration", atts)) / 1000.0f;
+        info->_animations[pTMXMapInfo->getParentGID()].push_back(frame);
+    }
     else if (elementName == "layer")
     {
         TMXLayerInfo *layer = new TMXLayerInfo();
-        layer->_name = valueForKey("name", attributeDict);
+        layer->_name = valueForKey("name", atts);
 
         Size s;
-        s.width = (float)atof(valueForKey("width", attributeDict));
-        s.height = (float)atof(valueForKey("height", attributeDict));
+        s.width = (float)atof(valueForKey("width", atts));
+        s.height = (float)atof(valueForKey("height", atts));
         layer->_layerSize = s;
 
-        std::string visible = valueForKey("visible", attributeDict);
+        std::string visible = valueForKey("visible", atts);
         layer->_visible = !(visible == "0");
 
-        std::string opacity = valueForKey("opacity", attributeDict);
+        std::string opacity = valueForKey("opacity", atts);
         if( opacity != "" )
         {
             layer->_opacity = (unsigned char)(255 * atof(opacity.c_str()));
@@ -362,8 +849,8 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             layer->_opacity = 255;
         }
 
-        float x = (float)atof(valueForKey("x", attributeDict));
-        float y = (float)atof(valueForKey("y", attributeDict));
+        float x = (float)atof(valueForKey("x", atts));
+        float y = (float)atof(valueForKey("y", atts));
         layer->_offset = Point(x,y);
 
         pTMXMapInfo->getLayers()->addObject(layer);
@@ -376,10 +863,10 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     else if (elementName == "objectgroup")
     {
         TMXObjectGroup *objectGroup = new TMXObjectGroup();
-        objectGroup->setGroupName(valueForKey("name", attributeDict));
+        objectGroup->setGroupName(valueForKey("name", atts));
         Point positionOffset;
-        positionOffset.x = (float)atof(valueForKey("x", attributeDict)) * pTMXMapInfo->getTileSize().width;
-        positionOffset.y = (float)atof(valueForKey("y", attributeDict)) * pTMXMapInfo->getTileSize().height;
+        positionOffset.x = (float)atof(valueForKey("x", atts)) * pTMXMapInfo->getTileSize().width;
+        positionOffset.y = (float)atof(valueForKey("y", atts)) * pTMXMapInfo->getTileSize().height;
         objectGroup->setPositionOffset(positionOffset);
 
         pTMXMapInfo->getObjectGroups()->addObject(objectGroup);
@@ -394,7 +881,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         TMXTilesetInfo* tileset = (TMXTilesetInfo*)pTMXMapInfo->getTilesets()->lastObject();
 
         // build full path
-        std::string imagename = valueForKey("source", attributeDict);
+        std::string imagename = valueForKey("source", atts);
 
         if (_TMXFileName.find_last_of("/") != string::npos)
         {
@@ -408,8 +895,8 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     } 
     else if (elementName == "data")
     {
-        std::string encoding = valueForKey("encoding", attributeDict);
-        std::string compression = valueForKey("compression", attributeDict);
+        std::string encoding = valueForKey("encoding", atts);
+        std::string compression = valueForKey("compression", atts);
 
         if( encoding == "base64" )
         {
@@ -446,7 +933,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         for(size_t i = 0; i < sizeof(pArray)/sizeof(pArray[0]); ++i )
         {
             const char* key = pArray[i];
-            String* obj = new String(valueForKey(key, attributeDict));
+            String* obj = new String(valueForKey(key, atts));
             if( obj )
             {
                 obj->autorelease();
@@ -457,7 +944,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         // But X and Y since they need special treatment
         // X
 
-        const char* value = valueForKey("x", attributeDict);
+        const char* value = valueForKey("x", atts);
         if (value) 
         {
             int x = atoi(value) + (int)objectGroup->getPositionOffset().x;
@@ -468,12 +955,12 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         }
 
         // Y
-        value = valueForKey("y", attributeDict);
+        value = valueForKey("y", atts);
         if (value)  {
             int y = atoi(value) + (int)objectGroup->getPositionOffset().y;
 
             // Correct y position. (Tiled uses Flipped, cocos2d uses Standard)
-            y = (int)(_mapSize.height * _tileSize.height) - y - atoi(valueForKey("height", attributeDict));
+            y = (int)(_mapSize.height * _tileSize.height) - y - atoi(valueForKey("height", atts));
             sprintf(buffer, "%d", y);
             String* pStr = new String(buffer);
             pStr->autorelease();
@@ -493,13 +980,13 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         if ( pTMXMapInfo->getParentElement() == TMXPropertyNone ) 
         {
             CCLOG( "TMX tile map: Parent element is unsupported. Cannot add property named '%s' with value '%s'",
-                valueForKey("name", attributeDict), valueForKey("value",attributeDict) );
+                valueForKey("name", atts), valueForKey("value",atts) );
         } 
         else if ( pTMXMapInfo->getParentElement() == TMXPropertyMap )
         {
             // The parent element is the map
-            String *value = new String(valueForKey("value", attributeDict));
-            std::string key = valueForKey("name", attributeDict);
+            String *value = new String(valueForKey("value", atts));
+            std::string key = valueForKey("name", atts);
             pTMXMapInfo->getProperties()->setObject(value, key.c_str());
             value->release();
 
@@ -508,8 +995,8 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         {
             // The parent element is the last layer
             TMXLayerInfo* layer = (TMXLayerInfo*)pTMXMapInfo->getLayers()->lastObject();
-            String *value = new String(valueForKey("value", attributeDict));
-            std::string key = valueForKey("name", attributeDict);
+            String *value = new String(valueForKey("value", atts));
+            std::string key = valueForKey("name", atts);
             // Add the property to the layer
             layer->getProperties()->setObject(value, key.c_str());
             value->release();
@@ -519,8 +1006,8 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         {
             // The parent element is the last object group
             TMXObjectGroup* objectGroup = (TMXObjectGroup*)pTMXMapInfo->getObjectGroups()->lastObject();
-            String *value = new String(valueForKey("value", attributeDict));
-            const char* key = valueForKey("name", attributeDict);
+            String *value = new String(valueForKey("value", atts));
+            const char* key = valueForKey("name", atts);
             objectGroup->getProperties()->setObject(value, key);
             value->release();
 
@@ -531,8 +1018,8 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             TMXObjectGroup* objectGroup = (TMXObjectGroup*)pTMXMapInfo->getObjectGroups()->lastObject();
             Dictionary* dict = (Dictionary*)objectGroup->getObjects()->lastObject();
 
-            const char* propertyName = valueForKey("name", attributeDict);
-            String *propertyValue = new String(valueForKey("value", attributeDict));
+            const char* propertyName = valueForKey("name", atts);
+            String *propertyValue = new String(valueForKey("value", atts));
             dict->setObject(propertyValue, propertyName);
             propertyValue->release();
         } 
@@ -540,8 +1027,8 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         {
             Dictionary* dict = (Dictionary*)pTMXMapInfo->getTileProperties()->objectForKey(pTMXMapInfo->getParentGID());
 
-            const char* propertyName = valueForKey("name", attributeDict);
-            String *propertyValue = new String(valueForKey("value", attributeDict));
+            const char* propertyName = valueForKey("name", atts);
+            String *propertyValue = new String(valueForKey("value", atts));
             dict->setObject(propertyValue, propertyName);
             propertyValue->release();
         }
@@ -553,7 +1040,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         Dictionary* dict = (Dictionary*)objectGroup->getObjects()->lastObject();
 
         // get points value string
-        const char* value = valueForKey("points", attributeDict);
+        const char* value = valueForKey("points", atts);
         if(value)
         {
             Array* pPointsArray = new Array;
@@ -607,11 +1094,6 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         // TODO: dict->setObject:[attributeDict objectForKey:@"points"] forKey:@"polylinePoints"];
     }
 
-    if (attributeDict)
-    {
-        attributeDict->clear();
-        delete attributeDict;
-    }
 }
 
 void TMXMapInfo::endElement(void *ctx, const char *name)
@@ -620,50 +1102,16 @@ void TMXMapInfo::endElement(void *ctx, const char *name)
     TMXMapInfo *pTMXMapInfo = this;
     std::string elementName = (char*)name;
 
-    int len = 0;
-
     if(elementName == "data" && pTMXMapInfo->getLayerAttribs()&TMXLayerAttribBase64) 
     {
         pTMXMapInfo->setStoringCharacters(false);
 
-        TMXLayerInfo* layer = (TMXLayerInfo*)pTMXMapInfo->getLayers()->lastObject();
-
-        std::string currentString = pTMXMapInfo->getCurrentString();
-        unsigned char *buffer;
-        len = base64Decode((unsigned char*)currentString.c_str(), (unsigned int)currentString.length(), &buffer);
-        if( ! buffer ) 
-        {
-            CCLOG("cocos2d: TiledMap: decode data error");
-            return;
-        }
-
-        if( pTMXMapInfo->getLayerAttribs() & (TMXLayerAttribGzip | TMXLayerAttribZlib) )
-        {
-            unsigned char *deflated;
-            Size s = layer->_layerSize;
-            // int sizeHint = s.width * s.height * sizeof(uint32_t);
-            int sizeHint = (int)(s.width * s.height * sizeof(unsigned int));
-
-            int inflatedLen = ZipUtils::ccInflateMemoryWithHint(buffer, len, &deflated, sizeHint);
-            CCASSERT(inflatedLen == sizeHint, "");
-
-            inflatedLen = (size_t)&inflatedLen; // XXX: to avoid warnings in compiler
-            
-            delete [] buffer;
-            buffer = NULL;
-
-            if( ! deflated ) 
-            {
-                CCLOG("cocos2d: TiledMap: inflate data error");
-                return;
-            }
-
-            layer->_tiles = (unsigned int*) deflated;
-        }
-        else
-        {
-            layer->_tiles = (unsigned int*) buffer;
-        }
+        // the layers are decoded together once the file is parsed
+        LayerData layerData;
+        layerData.layer = (TMXLayerInfo*)pTMXMapInfo->getLayers()->lastObject();
+        layerData.attribs = pTMXMapInfo->getLayerAttribs();
+        _layerData.push_back(layerData);
+        _layerData.back().data.swap(_currentString);
 
         pTMXMapInfo->setCurrentString("");
 
@@ -694,13 +1142,10 @@ void TMXMapInfo::textHandler(void *ctx, const char *ch, int len)
 {
     CC_UNUSED_PARAM(ctx);
     TMXMapInfo *pTMXMapInfo = this;
-    std::string pText((char*)ch,0,len);
 
     if (pTMXMapInfo->isStoringCharacters())
     {
-        std::string currentString = pTMXMapInfo->getCurrentString();
-        currentString += pText;
-        pTMXMapInfo->setCurrentString(currentString.c_str());
+        _currentString.append(ch, len);
     }
 }
 
@@ -33,7 +33,9 @@ THE SOFTWARE.
 #include "cocoa/CCGeometry.h"
 #include "platform/CCSAXParser.h"
 
+#include <map>
 #include <string>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -107,6 +109,15 @@ public:
     Point               _offset;
 };
 
+/** @brief a frame of an animated tile, from the <animation> of a tile of a tileset */
+struct TMXTileAnimationFrame
+{
+    //! gid of the tile shown by the frame
+    unsigned int    gid;
+    //! duration of the frame in seconds
+    float           duration;
+};
+
 /** @brief TMXTilesetInfo contains the information about the tilesets like:
 - Tileset name
 - Tileset spacing
@@ -129,6 +140,8 @@ public:
     std::string     _sourceImage;
     //! size in pixels of the image
     Size          _imageSize;
+    //! frames of the animated tiles, by gid of the animated tile
+    std::map<unsigned int, std::vector<TMXTileAnimationFrame> > _animations;
 public:
     TMXTilesetInfo();
     virtual ~TMXTilesetInfo();
@@ -145,7 +158,8 @@ And it also contains:
 - Tilesets (an array of TMXTilesetInfo objects)
 - ObjectGroups (an array of TMXObjectGroupInfo objects)
 
-This information is obtained from the TMX file.
+This information is obtained from the TMX file, or from a binary map written by writeBinaryFile().
+The tiles of the layers of a TMX file are decoded in parallel once the file is parsed.
 
 */
 class CC_DLL TMXMapInfo : public Object, public SAXDelegator
@@ -164,7 +178,7 @@ public:
     TMXMapInfo();
     virtual ~TMXMapInfo();
     
-    /** initializes a TMX format with a  tmx file */
+    /** initializes a TMX format with a  tmx file, or a binary map written by writeBinaryFile() */
     bool initWithTMXFile(const char *tmxFile);
     /** initializes a TMX format with an XML string and a TMX resource path */
     bool initWithXML(const char* tmxString, const char* resourcePath);
@@ -173,6 +187,14 @@ public:
     /* initializes parsing of an XML string, either a tmx (Map) string or tsx (Tileset) string */
     bool parseXMLString(const char *xmlString);
 
+    /** writes the map in a binary format that initWithTMXFile() loads without parsing XML nor decoding the tiles:
+     the gids of the layers are stored as they are in memory, and the properties already parsed.
+     The images of the tilesets are stored relative to the directory of the TMX file,
+     so the binary file must be placed in the same directory.
+     @since v3.0
+     */
+    bool writeBinaryFile(const char *binaryFile) const;
+
     Dictionary* getTileProperties() { return _tileProperties; };
     void setTileProperties(Dictionary* tileProperties) {
         CC_SAFE_RETAIN(tileProperties);
@@ -252,6 +274,9 @@ public:
     inline void setTMXFileName(const char *fileName){ _TMXFileName = fileName; }
 private:
     void internalInit(const char* tmxFileName, const char* resourcePath);
+    bool parseBinaryData(const unsigned char* data, unsigned long size);
+    /** decodes the tiles of the layers stored by endElement() */
+    void decodeLayerData();
 protected:
 
     /// map orientation
@@ -286,6 +311,15 @@ protected:
     //! tile properties
     Dictionary* _tileProperties;
     unsigned int _currentFirstGID;
+
+    //! the encoded tiles of the layers, decoded once the file is parsed
+    struct LayerData
+    {
+        TMXLayerInfo *layer;
+        std::string data;
+        int attribs;
+    };
+    std::vector<LayerData> _layerData;
 };
 
 // end of tilemap_parallax_nodes group
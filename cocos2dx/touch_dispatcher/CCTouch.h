@@ -27,6 +27,9 @@ THE SOFTWARE.
 
 #include "cocoa/CCObject.h"
 #include "cocoa/CCGeometry.h"
+#include "cocoa/CCPoolAllocator.h"
+#include "event_dispatcher/CCEvent.h"
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -35,7 +38,7 @@ NS_CC_BEGIN
  * @{
  */
 
-class CC_DLL Touch : public Object
+class CC_DLL Touch : public Object, public PoolAllocated
 {
 public:
     /** how the touches are dispathced */
@@ -84,16 +87,21 @@ public:
         return _id;
     }
 
+    /** returns the screen locations of the platform move events coalesced into the last move, oldest first.
+     It is only recorded when EGLViewProtocol::setTouchHistoryEnabled(true) was called.
+     @since v3.0
+     */
+    const std::vector<Point>& getHistoryInView() const { return _history; }
+
 private:
+    friend class EGLViewProtocol;
+
     int _id;
     bool _startPointCaptured;
     Point _startPoint;
     Point _point;
     Point _prevPoint;
-};
-
-class CC_DLL Event : public Object
-{
+    std::vector<Point> _history;
 };
 
 // end of input group
@@ -30,8 +30,12 @@ THE SOFTWARE.
 #include "CCTouch.h"
 #include "textures/CCTexture2D.h"
 #include "support/data_support/ccCArray.h"
+#include "event_dispatcher/CCEventDispatcher.h"
+#include "script_support/CCScriptSupport.h"
+#include "CCDirector.h"
 #include "ccMacros.h"
 #include <algorithm>
+#include <math.h>
 
 NS_CC_BEGIN
 
@@ -43,6 +47,16 @@ static int less(const Object* p1, const Object* p2)
     return ((TouchHandler*)p1)->getPriority() < ((TouchHandler*)p2)->getPriority();
 }
 
+/**
+ * Areas covering more cells are tested for every touch instead of being indexed
+ */
+static const int kMaxTouchAreaCells = 64;
+
+static inline long long touchAreaCellKey(int x, int y)
+{
+    return ((long long)x << 32) | (unsigned int)y;
+}
+
 bool TouchDispatcher::isDispatchEvents(void)
 {
     return _dispatchEvents;
@@ -79,6 +93,7 @@ bool TouchDispatcher::init(void)
     _toAdd = false;
     _toQuit = false;
     _locked = false;
+    _dispatchDepth = 0;
 
     _handlerHelperData[CCTOUCHBEGAN]._type = CCTOUCHBEGAN;
     _handlerHelperData[CCTOUCHMOVED]._type = CCTOUCHMOVED;
@@ -125,6 +140,15 @@ void TouchDispatcher::forceAddHandler(TouchHandler *pHandler, Array *pArray)
      }
 
     pArray->insertObject(pHandler, u);
+
+    if (pArray == _targetedHandlers)
+    {
+        if (static_cast<TargetedTouchHandler*>(pHandler)->hasTouchArea())
+        {
+            ++_touchAreaCount;
+        }
+        _touchAreasDirty = true;
+    }
 }
 
 void TouchDispatcher::addStandardDelegate(TouchDelegate *pDelegate, int nPriority)
@@ -197,7 +221,12 @@ void TouchDispatcher::forceRemoveDelegate(TouchDelegate *pDelegate)
         pHandler = static_cast<TouchHandler*>(pObj);
         if (pHandler && pHandler->getDelegate() == pDelegate)
         {
+            if (static_cast<TargetedTouchHandler*>(pHandler)->hasTouchArea())
+            {
+                --_touchAreaCount;
+            }
             _targetedHandlers->removeObject(pHandler);
+            _touchAreasDirty = true;
             break;
         }
     }
@@ -235,6 +264,8 @@ void TouchDispatcher::forceRemoveAllDelegates(void)
 {
      _standardHandlers->removeAllObjects();
      _targetedHandlers->removeAllObjects();
+     _touchAreaCount = 0;
+     _touchAreasDirty = true;
 }
 
 void TouchDispatcher::removeAllDelegates(void)
@@ -293,6 +324,11 @@ TouchHandler* TouchDispatcher::findHandler(Array* pArray, TouchDelegate *pDelega
 void TouchDispatcher::rearrangeHandlers(Array *pArray)
 {
     std::sort(pArray->data->arr, pArray->data->arr + pArray->data->num, less);
+
+    if (pArray == _targetedHandlers)
+    {
+        _touchAreasDirty = true;
+    }
 }
 
 void TouchDispatcher::setPriority(int nPriority, TouchDelegate *pDelegate)
@@ -313,13 +349,258 @@ void TouchDispatcher::setPriority(int nPriority, TouchDelegate *pDelegate)
     }
 }
 
+//
+// touch areas
+//
+void TouchDispatcher::setTouchArea(TouchDelegate *pDelegate, const Rect& area)
+{
+    CCASSERT(pDelegate != NULL, "");
+
+    // the handler can still be waiting in _handlersToAdd, it is counted once added
+    bool bPending = false;
+    TargetedTouchHandler *pHandler = dynamic_cast<TargetedTouchHandler*>(findHandler(_targetedHandlers, pDelegate));
+    if (! pHandler)
+    {
+        pHandler = dynamic_cast<TargetedTouchHandler*>(findHandler(_handlersToAdd, pDelegate));
+        bPending = true;
+    }
+
+    CCASSERT(pHandler != NULL, "Only targeted delegates have a touch area");
+    if (! pHandler)
+    {
+        return;
+    }
+
+    if (! bPending)
+    {
+        if (! pHandler->hasTouchArea())
+        {
+            ++_touchAreaCount;
+        }
+        _touchAreasDirty = true;
+    }
+    pHandler->setTouchArea(area);
+}
+
+void TouchDispatcher::removeTouchArea(TouchDelegate *pDelegate)
+{
+    CCASSERT(pDelegate != NULL, "");
+
+    bool bPending = false;
+    TargetedTouchHandler *pHandler = dynamic_cast<TargetedTouchHandler*>(findHandler(_targetedHandlers, pDelegate));
+    if (! pHandler)
+    {
+        pHandler = dynamic_cast<TargetedTouchHandler*>(findHandler(_handlersToAdd, pDelegate));
+        bPending = true;
+    }
+
+    if (pHandler && pHandler->hasTouchArea())
+    {
+        if (! bPending)
+        {
+            --_touchAreaCount;
+            _touchAreasDirty = true;
+        }
+        pHandler->removeTouchArea();
+    }
+}
+
+void TouchDispatcher::setTouchAreaCellSize(float size)
+{
+    CCASSERT(size > 0, "The cell size must be positive");
+
+    if (_touchAreaCellSize != size)
+    {
+        _touchAreaCellSize = size;
+        _touchAreasDirty = true;
+    }
+}
+
+void TouchDispatcher::rebuildTouchAreas(void)
+{
+    _touchAreasDirty = false;
+
+    _touchAreaCells.clear();
+    _unindexedHandlers.clear();
+
+    const float fInvCellSize = 1.0f / _touchAreaCellSize;
+    unsigned int uCount = _targetedHandlers->count();
+
+    // handlers are visited by priority, so the indices of each cell end up sorted
+    for (unsigned int i = 0; i < uCount; ++i)
+    {
+        TargetedTouchHandler *pHandler = static_cast<TargetedTouchHandler*>(_targetedHandlers->objectAtIndex(i));
+        if (! pHandler->hasTouchArea())
+        {
+            _unindexedHandlers.push_back(i);
+            continue;
+        }
+
+        const Rect& area = pHandler->getTouchArea();
+        int x0 = (int)floorf(area.getMinX() * fInvCellSize);
+        int x1 = (int)floorf(area.getMaxX() * fInvCellSize);
+        int y0 = (int)floorf(area.getMinY() * fInvCellSize);
+        int y1 = (int)floorf(area.getMaxY() * fInvCellSize);
+
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > kMaxTouchAreaCells)
+        {
+            _unindexedHandlers.push_back(i);
+            continue;
+        }
+
+        for (int y = y0; y <= y1; ++y)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                _touchAreaCells[touchAreaCellKey(x, y)].push_back(i);
+            }
+        }
+    }
+}
+
+void TouchDispatcher::collectTouchCandidates(Touch *pTouch)
+{
+    _touchCandidates.clear();
+
+    Point location = pTouch->getLocation();
+    int x = (int)floorf(location.x / _touchAreaCellSize);
+    int y = (int)floorf(location.y / _touchAreaCellSize);
+
+    static const std::vector<unsigned int> s_emptyCell;
+    auto it = _touchAreaCells.find(touchAreaCellKey(x, y));
+    const std::vector<unsigned int>& cell = (it != _touchAreaCells.end() ? it->second : s_emptyCell);
+
+    // merge both sorted lists to keep the priority order
+    auto itCell = cell.begin();
+    auto itUnindexed = _unindexedHandlers.begin();
+    while (itCell != cell.end() || itUnindexed != _unindexedHandlers.end())
+    {
+        unsigned int uIndex;
+        if (itUnindexed == _unindexedHandlers.end() || (itCell != cell.end() && *itCell < *itUnindexed))
+        {
+            uIndex = *itCell++;
+        }
+        else
+        {
+            uIndex = *itUnindexed++;
+        }
+
+        TargetedTouchHandler *pHandler = static_cast<TargetedTouchHandler*>(_targetedHandlers->objectAtIndex(uIndex));
+        if (pHandler->hasTouchArea() && ! pHandler->getTouchArea().containsPoint(location))
+        {
+            continue;
+        }
+
+        _touchCandidates.push_back(pHandler);
+    }
+}
+
 //
 // dispatch events
 //
+bool TouchDispatcher::dispatchTargetedTouch(TargetedTouchHandler *pHandler, Touch *pTouch, Event *pEvent, int type)
+{
+    bool bClaimed = false;
+    if (type == CCTOUCHBEGAN)
+    {
+        bClaimed = pHandler->getDelegate()->ccTouchBegan(pTouch, pEvent);
+
+        if (bClaimed)
+        {
+            pHandler->getClaimedTouches()->addObject(pTouch);
+        }
+    } else
+    if (pHandler->getClaimedTouches()->containsObject(pTouch))
+    {
+        // moved ended canceled
+        bClaimed = true;
+
+        switch (type)
+        {
+        case CCTOUCHMOVED:
+            pHandler->getDelegate()->ccTouchMoved(pTouch, pEvent);
+            break;
+        case CCTOUCHENDED:
+            pHandler->getDelegate()->ccTouchEnded(pTouch, pEvent);
+            pHandler->getClaimedTouches()->removeObject(pTouch);
+            break;
+        case CCTOUCHCANCELLED:
+            pHandler->getDelegate()->ccTouchCancelled(pTouch, pEvent);
+            pHandler->getClaimedTouches()->removeObject(pTouch);
+            break;
+        }
+    }
+
+    return bClaimed && pHandler->isSwallowsTouches();
+}
+
 void TouchDispatcher::touches(Set *pTouches, Event *pEvent, unsigned int uIndex)
 {
     CCASSERT(uIndex >= 0 && uIndex < 4, "");
 
+    // the script handlers that don't claim the touches are called at once at the end
+    ScriptEventBatch batch;
+
+    // A handler dispatching touches itself gets its own containers, the reused ones are those of the outer dispatch.
+    // In the steady state the outer dispatch doesn't allocate: the touches are pooled, the nodes of the sets come
+    // from the PoolAllocator, and the containers keep their capacity.
+    struct DepthGuard
+    {
+        explicit DepthGuard(int& depth) : _depth(depth) { ++_depth; }
+        ~DepthGuard() { --_depth; }
+        int& _depth;
+    } depthGuard(_dispatchDepth);
+    bool bReuse = (_dispatchDepth == 1);
+
+    // the listeners of the EventDispatcher get the touches 1st, the touches they swallow aren't dispatched here
+    EventDispatcher* pEventDispatcher = Director::getInstance()->getEventDispatcher();
+    if (pEventDispatcher->hasEventListeners(EventListener::getListenerIDForType(Event::Type::TOUCH)))
+    {
+        std::vector<Touch*> touchVector;
+        std::vector<Touch*>& eventTouches = (bReuse ? _eventTouches : touchVector);
+        eventTouches.clear();
+        for (SetIterator setIter = pTouches->begin(); setIter != pTouches->end(); ++setIter)
+        {
+            eventTouches.push_back(static_cast<Touch*>(*setIter));
+        }
+        size_t uTouchCount = eventTouches.size();
+
+        EventTouch event((EventTouch::EventCode)uIndex, std::move(eventTouches));
+        pEventDispatcher->dispatchEvent(&event);
+
+        bool bSomeSwallowed = (event.getTouches().size() != uTouchCount);
+        if (bSomeSwallowed && event.getTouches().empty())
+        {
+            if (bReuse)
+            {
+                _eventTouches.swap(event._touches);
+            }
+            return;
+        }
+
+        if (bSomeSwallowed)
+        {
+            Set *pRemainingTouches = &_remainingTouches;
+            if (! bReuse)
+            {
+                pRemainingTouches = new Set();
+                pRemainingTouches->autorelease();
+            }
+            pRemainingTouches->removeAllObjects();
+            for (auto pTouch : event.getTouches())
+            {
+                pRemainingTouches->addObject(pTouch);
+            }
+            pTouches = pRemainingTouches;
+        }
+
+        if (bReuse)
+        {
+            // gives the storage back for the next event
+            _eventTouches.swap(event._touches);
+        }
+    }
+
     Set *pMutableTouches;
     _locked = true;
 
@@ -328,7 +609,22 @@ void TouchDispatcher::touches(Set *pTouches, Event *pEvent, unsigned int uIndex)
      unsigned int uStandardHandlersCount = _standardHandlers->count();
     bool bNeedsMutableSet = (uTargetedHandlersCount && uStandardHandlersCount);
 
-    pMutableTouches = (bNeedsMutableSet ? pTouches->mutableCopy() : pTouches);
+    pMutableTouches = pTouches;
+    if (bNeedsMutableSet)
+    {
+        if (bReuse)
+        {
+            pMutableTouches = &_mutableTouches;
+            for (SetIterator setIter = pTouches->begin(); setIter != pTouches->end(); ++setIter)
+            {
+                pMutableTouches->addObject(*setIter);
+            }
+        }
+        else
+        {
+            pMutableTouches = pTouches->mutableCopy();
+        }
+    }
 
     struct ccTouchHandlerHelperData sHelper = _handlerHelperData[uIndex];
     //
@@ -336,63 +632,52 @@ void TouchDispatcher::touches(Set *pTouches, Event *pEvent, unsigned int uIndex)
     //
     if (uTargetedHandlersCount > 0)
     {
+        // touches only begin on the handlers whose area is under them
+        bool bUseTouchAreas = (uIndex == CCTOUCHBEGAN && _touchAreaCount > 0);
+        if (bUseTouchAreas && _touchAreasDirty)
+        {
+            rebuildTouchAreas();
+        }
+
         Touch *pTouch;
         SetIterator setIter;
         for (setIter = pTouches->begin(); setIter != pTouches->end(); ++setIter)
         {
             pTouch = (Touch *)(*setIter);
 
-            TargetedTouchHandler *pHandler = NULL;
-            Object* pObj = NULL;
-            CCARRAY_FOREACH(_targetedHandlers, pObj)
+            bool bSwallowed = false;
+            if (bUseTouchAreas)
             {
-                pHandler = static_cast<TargetedTouchHandler*>(pObj);
-
-                if (! pHandler)
+                collectTouchCandidates(pTouch);
+                for (auto it = _touchCandidates.begin(); it != _touchCandidates.end() && ! bSwallowed; ++it)
                 {
-                   break;
+                    bSwallowed = dispatchTargetedTouch(*it, pTouch, pEvent, sHelper._type);
                 }
-
-                bool bClaimed = false;
-                if (uIndex == CCTOUCHBEGAN)
+            }
+            else
+            {
+                TargetedTouchHandler *pHandler = NULL;
+                Object* pObj = NULL;
+                CCARRAY_FOREACH(_targetedHandlers, pObj)
                 {
-                    bClaimed = pHandler->getDelegate()->ccTouchBegan(pTouch, pEvent);
+                    pHandler = static_cast<TargetedTouchHandler*>(pObj);
 
-                    if (bClaimed)
+                    if (! pHandler)
                     {
-                        pHandler->getClaimedTouches()->addObject(pTouch);
+                       break;
                     }
-                } else
-                if (pHandler->getClaimedTouches()->containsObject(pTouch))
-                {
-                    // moved ended canceled
-                    bClaimed = true;
 
-                    switch (sHelper._type)
+                    if (dispatchTargetedTouch(pHandler, pTouch, pEvent, sHelper._type))
                     {
-                    case CCTOUCHMOVED:
-                        pHandler->getDelegate()->ccTouchMoved(pTouch, pEvent);
-                        break;
-                    case CCTOUCHENDED:
-                        pHandler->getDelegate()->ccTouchEnded(pTouch, pEvent);
-                        pHandler->getClaimedTouches()->removeObject(pTouch);
-                        break;
-                    case CCTOUCHCANCELLED:
-                        pHandler->getDelegate()->ccTouchCancelled(pTouch, pEvent);
-                        pHandler->getClaimedTouches()->removeObject(pTouch);
+                        bSwallowed = true;
                         break;
                     }
                 }
+            }
 
-                if (bClaimed && pHandler->isSwallowsTouches())
-                {
-                    if (bNeedsMutableSet)
-                    {
-                        pMutableTouches->removeObject(pTouch);
-                    }
-
-                    break;
-                }
+            if (bSwallowed && bNeedsMutableSet)
+            {
+                pMutableTouches->removeObject(pTouch);
             }
         }
     }
@@ -433,7 +718,19 @@ void TouchDispatcher::touches(Set *pTouches, Event *pEvent, unsigned int uIndex)
 
     if (bNeedsMutableSet)
     {
-        pMutableTouches->release();
+        if (bReuse)
+        {
+            _mutableTouches.removeAllObjects();
+        }
+        else
+        {
+            pMutableTouches->release();
+        }
+    }
+
+    if (bReuse)
+    {
+        _remainingTouches.removeAllObjects();
     }
 
     //
@@ -29,6 +29,10 @@ THE SOFTWARE.
 #include "CCTouchDelegateProtocol.h"
 #include "cocoa/CCObject.h"
 #include "cocoa/CCArray.h"
+#include "cocoa/CCGeometry.h"
+#include "cocoa/CCSet.h"
+#include <vector>
+#include <unordered_map>
 
 NS_CC_BEGIN
 
@@ -47,7 +51,6 @@ enum {
     ccTouchMax,
 };
 
-class Set;
 class Event;
 
 struct ccTouchHandlerHelperData {
@@ -70,6 +73,8 @@ public:
 };
 
 class TouchHandler;
+class TargetedTouchHandler;
+class Touch;
 struct _ccCArray;
 /** @brief TouchDispatcher.
  Singleton that handles all the touch events.
@@ -97,7 +102,9 @@ public:
         , _standardHandlers(NULL)
         , _handlersToAdd(NULL)
         , _handlersToRemove(NULL)
-        
+        , _touchAreaCount(0)
+        , _touchAreasDirty(false)
+        , _touchAreaCellSize(CC_TOUCH_AREA_CELL_SIZE)
     {}
 
 public:
@@ -129,6 +136,26 @@ public:
     the higher the priority */
     void setPriority(int nPriority, TouchDelegate *pDelegate);
 
+    /** Sets the area, in world coordinates (those of Touch::getLocation()), outside of which
+     touches don't begin on a targeted delegate: ccTouchBegan() isn't called for them.
+     The areas are indexed in a grid, so a touch only tests the delegates whose area is under it
+     and the delegates without an area, instead of every delegate.
+     The area isn't updated when the delegate moves: set it again.
+     @since v3.0
+     */
+    void setTouchArea(TouchDelegate *pDelegate, const Rect& area);
+
+    /** Removes the touch area of a targeted delegate, which gets all the touches again.
+     @since v3.0
+     */
+    void removeTouchArea(TouchDelegate *pDelegate);
+
+    /** Size, in points, of the cells of the grid of touch areas. Default: CC_TOUCH_AREA_CELL_SIZE
+     @since v3.0
+     */
+    float getTouchAreaCellSize(void) const { return _touchAreaCellSize; }
+    void setTouchAreaCellSize(float size);
+
     void touches(Set *pTouches, Event *pEvent, unsigned int uIndex);
 
     virtual void touchesBegan(Set* touches, Event* pEvent);
@@ -144,6 +171,10 @@ protected:
     void forceRemoveAllDelegates(void);
     void rearrangeHandlers(Array* pArray);
     TouchHandler* findHandler(Array* pArray, TouchDelegate *pDelegate);
+    /** returns whether the touch was claimed by a handler that swallows touches */
+    bool dispatchTargetedTouch(TargetedTouchHandler *pHandler, Touch *pTouch, Event *pEvent, int type);
+    void rebuildTouchAreas(void);
+    void collectTouchCandidates(Touch *pTouch);
 
 protected:
      Array* _targetedHandlers;
@@ -159,6 +190,22 @@ protected:
 
     // 4, 1 for each type of event
     struct ccTouchHandlerHelperData _handlerHelperData[ccTouchMax];
+
+    // grid of the touch areas: cell -> indices in _targetedHandlers, sorted
+    std::unordered_map<long long, std::vector<unsigned int>> _touchAreaCells;
+    // indices of the targeted handlers that are tested for every touch
+    std::vector<unsigned int> _unindexedHandlers;
+    std::vector<TargetedTouchHandler*> _touchCandidates;
+    unsigned int _touchAreaCount;
+    bool _touchAreasDirty;
+    float _touchAreaCellSize;
+
+    // reused by every event, so that the dispatch doesn't allocate once they have grown
+    std::vector<Touch*> _eventTouches;
+    Set _remainingTouches;
+    Set _mutableTouches;
+    // the reused containers belong to the outermost dispatch
+    int _dispatchDepth;
 };
 
 // end of input group
@@ -156,6 +156,17 @@ Set* TargetedTouchHandler::getClaimedTouches(void)
     return _claimedTouches;
 }
 
+void TargetedTouchHandler::setTouchArea(const Rect& area)
+{
+    _touchArea = area;
+    _hasTouchArea = true;
+}
+
+void TargetedTouchHandler::removeTouchArea(void)
+{
+    _hasTouchArea = false;
+}
+
 TargetedTouchHandler* TargetedTouchHandler::handlerWithDelegate(TouchDelegate *pDelegate, int nPriority, bool bSwallow)
 {
     TargetedTouchHandler *pHandler = new TargetedTouchHandler();
@@ -180,6 +191,7 @@ bool TargetedTouchHandler::initWithDelegate(TouchDelegate *pDelegate, int nPrior
     {
         _claimedTouches = new Set();
         _swallowsTouches = bSwallow;
+        _hasTouchArea = false;
 
         return true;
     }
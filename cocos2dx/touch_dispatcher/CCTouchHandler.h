@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "CCTouchDispatcher.h"
 #include "cocoa/CCObject.h"
 #include "cocoa/CCSet.h"
+#include "cocoa/CCGeometry.h"
 
 NS_CC_BEGIN
 
@@ -103,6 +104,12 @@ public:
     /** MutableSet that contains the claimed touches */
     Set* getClaimedTouches(void);
 
+    /** area, in world coordinates, outside of which touches don't begin on the delegate */
+    bool hasTouchArea(void) const { return _hasTouchArea; }
+    const Rect& getTouchArea(void) const { return _touchArea; }
+    void setTouchArea(const Rect& area);
+    void removeTouchArea(void);
+
     /** initializes a TargetedTouchHandler with a delegate, a priority and whether or not it swallows touches or not */
     bool initWithDelegate(TouchDelegate *pDelegate, int nPriority, bool bSwallow);
 
@@ -113,6 +120,8 @@ public:
 protected:
     bool _swallowsTouches;
     Set *_claimedTouches;
+    bool _hasTouchArea;
+    Rect _touchArea;
 };
 
 // end of input group
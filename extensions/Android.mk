@@ -81,6 +81,7 @@ network/WebSocket.cpp \
 network/SocketIO.cpp \
 physics_nodes/CCPhysicsDebugNode.cpp \
 physics_nodes/CCPhysicsSprite.cpp \
+physics_nodes/CCPhysicsStepper.cpp \
 LocalStorage/LocalStorageAndroid.cpp \
 spine/Animation.cpp \
 spine/AnimationState.cpp \
@@ -96,6 +97,7 @@ spine/RegionAttachment.cpp \
 spine/Skeleton.cpp \
 spine/SkeletonData.cpp \
 spine/SkeletonJson.cpp \
+spine/SkeletonBinary.cpp \
 spine/Skin.cpp \
 spine/Slot.cpp \
 spine/SlotData.cpp \
@@ -28,11 +28,17 @@
 #include <curl/easy.h>
 #include <stdio.h>
 #include <vector>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <algorithm>
 #include <thread>
+#include <chrono>
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/select.h>
 #include <errno.h>
 #endif
 
@@ -45,15 +51,26 @@ NS_CC_EXT_BEGIN;
 
 #define KEY_OF_VERSION   "current-version-code"
 #define KEY_OF_DOWNLOADED_VERSION    "downloaded-version-code"
+#define KEY_OF_DOWNLOADING_VERSION   "downloading-version-code"
 #define TEMP_PACKAGE_FILE_NAME    "cocos2dx-update-temp-package.zip"
+#define MOUNTED_PACKAGE_FILE_NAME "cocos2dx-update-package.zip"
+#define MANIFEST_FILE_NAME        "cocos2dx-update-manifest"
+#define TEMP_FILE_SUFFIX          ".download"
 #define BUFFER_SIZE    8192
 #define MAX_FILENAME   512
+// Entries are extracted by blocks of this size
+#define UNCOMPRESS_BUFFER_SIZE    (256 * 1024)
+// The package is downloaded by ranges of this size, a fixed size keeps the parts of an interrupted download valid
+#define PACKAGE_PART_SIZE    (4 * 1024 * 1024)
+// How many times a file or a range is tried before giving up, an interrupted download resumes
+#define MAX_DOWNLOAD_ATTEMPTS    5
 
 // Message type
 #define ASSETSMANAGER_MESSAGE_UPDATE_SUCCEED                0
 #define ASSETSMANAGER_MESSAGE_RECORD_DOWNLOADED_VERSION     1
 #define ASSETSMANAGER_MESSAGE_PROGRESS                      2
 #define ASSETSMANAGER_MESSAGE_ERROR                         3
+#define ASSETSMANAGER_MESSAGE_UNCOMPRESS_PROGRESS           4
 
 // Some data struct for sending messages
 
@@ -69,6 +86,109 @@ struct ProgressMessage
     AssetsManager* manager;
 };
 
+// A file listed by the manifest
+struct ManifestEntry
+{
+    uLong crc;
+    long long size;
+};
+
+// A running download
+struct Transfer
+{
+    CURL *curl;
+    FILE *fp;
+    std::string path;
+    long long received;
+    int attempts;
+    bool started;
+    bool resumed;   // a range was requested
+    bool wholeFile; // the range ends the file, so the whole file may be sent instead
+};
+
+static string getPackagePartPath(const string& packagePath, int index)
+{
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".part%d", index);
+    return packagePath + suffix;
+}
+
+static void removePackageFiles(const string& packagePath)
+{
+    remove(packagePath.c_str());
+    // The parts are created in order
+    for (int i = 0; remove(getPackagePartPath(packagePath, i).c_str()) == 0; ++i);
+}
+
+static bool getFileCrc(const string& path, uLong *crc)
+{
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (! fp)
+    {
+        return false;
+    }
+    
+    char buffer[BUFFER_SIZE];
+    size_t size = 0;
+    *crc = crc32(0L, Z_NULL, 0);
+    while ((size = fread(buffer, 1, BUFFER_SIZE, fp)) > 0)
+    {
+        *crc = crc32(*crc, (const Bytef*)buffer, (uInt)size);
+    }
+    fclose(fp);
+    return true;
+}
+
+static bool readFile(const string& path, string *content)
+{
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (! fp)
+    {
+        return false;
+    }
+    
+    char buffer[BUFFER_SIZE];
+    size_t size = 0;
+    while ((size = fread(buffer, 1, BUFFER_SIZE, fp)) > 0)
+    {
+        content->append(buffer, size);
+    }
+    fclose(fp);
+    return true;
+}
+
+// Each line is "<crc32 in hexadecimal> <size> <path>"
+static bool parseManifest(const string& content, map<string, ManifestEntry> *entries)
+{
+    istringstream stream(content);
+    string line;
+    while (getline(stream, line))
+    {
+        if (line.size() > 0 && line[line.size() - 1] == '\r')
+        {
+            line.erase(line.size() - 1);
+        }
+        if (line.size() == 0)
+        {
+            continue;
+        }
+        
+        istringstream lineStream(line);
+        ManifestEntry entry;
+        string path;
+        lineStream >> hex >> entry.crc >> dec >> entry.size;
+        getline(lineStream >> ws, path);
+        // A path can't leave the storage path
+        if (lineStream.fail() || path.size() == 0 || path[0] == '/' || path.find("..") != string::npos)
+        {
+            CCLOG("invalid line in manifest: %s", line.c_str());
+            return false;
+        }
+        (*entries)[path] = entry;
+    }
+    return true;
+}
+
 // Implementation of AssetsManager
 
 AssetsManager::AssetsManager(const char* packageUrl/* =NULL */, const char* versionFileUrl/* =NULL */, const char* storagePath/* =NULL */)
@@ -76,9 +196,12 @@ AssetsManager::AssetsManager(const char* packageUrl/* =NULL */, const char* vers
 , _version("")
 , _packageUrl(packageUrl)
 , _versionFileUrl(versionFileUrl)
+, _manifestUrl("")
 , _downloadedVersion("")
 , _curl(NULL)
 , _connectionTimeout(0)
+, _maxConcurrentDownloads(4)
+, _mountPackage(false)
 , _delegate(NULL)
 , _isDownloading(false)
 {
@@ -131,12 +254,13 @@ bool AssetsManager::checkUpdate()
     curl_easy_setopt(_curl, CURLOPT_WRITEDATA, &_version);
     if (_connectionTimeout) curl_easy_setopt(_curl, CURLOPT_CONNECTTIMEOUT, _connectionTimeout);
     res = curl_easy_perform(_curl);
+    curl_easy_cleanup(_curl);
+    _curl = NULL;
     
     if (res != 0)
     {
         sendErrorMessage(ErrorCode::NETWORK);
         CCLOG("can not get version file content, error code is %d", res);
-        curl_easy_cleanup(_curl);
         return false;
     }
     
@@ -159,6 +283,18 @@ void AssetsManager::downloadAndUncompress()
 {
     do
     {
+        if (_manifestUrl.size() > 0)
+        {
+            // The files are moved into the storage path as they are downloaded
+            if (! updateFromManifest()) break;
+            
+            AssetsManager::Message *msg = new AssetsManager::Message();
+            msg->what = ASSETSMANAGER_MESSAGE_UPDATE_SUCCEED;
+            msg->obj = this;
+            _schedule->sendMessage(msg);
+            break;
+        }
+        
         if (_downloadedVersion != _version)
         {
             if (! downLoad()) break;
@@ -170,23 +306,44 @@ void AssetsManager::downloadAndUncompress()
             _schedule->sendMessage(msg1);
         }
         
-        // Uncompress zip file.
-        if (! uncompress())
+        // A mounted package isn't extracted
+        if (_mountPackage)
         {
-            sendErrorMessage(ErrorCode::UNCOMPRESS);
+            AssetsManager::Message *msg = new AssetsManager::Message();
+            msg->what = ASSETSMANAGER_MESSAGE_UPDATE_SUCCEED;
+            msg->obj = this;
+            _schedule->sendMessage(msg);
             break;
         }
         
-        // Record updated version and remove downloaded zip file
-        AssetsManager::Message *msg2 = new AssetsManager::Message();
-        msg2->what = ASSETSMANAGER_MESSAGE_UPDATE_SUCCEED;
-        msg2->obj = this;
-        _schedule->sendMessage(msg2);
+        // The package is extracted by its own thread, and the download thread ends.
+        auto t = std::thread(&AssetsManager::uncompressPackage, this);
+        t.detach();
+        return;
     } while (0);
     
     _isDownloading = false;
 }
 
+void AssetsManager::uncompressPackage()
+{
+    // Uncompress zip file.
+    if (uncompress())
+    {
+        // Record updated version and remove downloaded zip file
+        AssetsManager::Message *msg = new AssetsManager::Message();
+        msg->what = ASSETSMANAGER_MESSAGE_UPDATE_SUCCEED;
+        msg->obj = this;
+        _schedule->sendMessage(msg);
+    }
+    else
+    {
+        sendErrorMessage(ErrorCode::UNCOMPRESS);
+    }
+    
+    _isDownloading = false;
+}
+
 void AssetsManager::update()
 {
     if (_isDownloading) return;
@@ -195,9 +352,10 @@ void AssetsManager::update()
     
     // 1. Urls of package and version should be valid;
     // 2. Package should be a zip file.
+    // The package isn't used when there is a manifest.
     if (_versionFileUrl.size() == 0 ||
-        _packageUrl.size() == 0 ||
-        std::string::npos == _packageUrl.find(".zip"))
+        (_manifestUrl.size() == 0 &&
+         (_packageUrl.size() == 0 || std::string::npos == _packageUrl.find(".zip"))))
     {
         CCLOG("no version file url, or no package url, or the package is not a zip file");
         _isDownloading = false;
@@ -214,6 +372,15 @@ void AssetsManager::update()
     // Is package already downloaded?
     _downloadedVersion = UserDefault::getInstance()->getStringForKey(KEY_OF_DOWNLOADED_VERSION);
     
+    // The parts of an interrupted download are only resumed by the same version.
+    if (_downloadedVersion != _version &&
+        UserDefault::getInstance()->getStringForKey(KEY_OF_DOWNLOADING_VERSION) != _version)
+    {
+        removePackageFiles(_storagePath + TEMP_PACKAGE_FILE_NAME);
+        UserDefault::getInstance()->setStringForKey(KEY_OF_DOWNLOADING_VERSION, _version);
+        UserDefault::getInstance()->flush();
+    }
+    
     auto t = std::thread(&AssetsManager::downloadAndUncompress, this);
     t.detach();
 }
@@ -238,8 +405,26 @@ bool AssetsManager::uncompress()
         return false;
     }
     
-    // Buffer to hold data read from the zip file
-    char readBuffer[BUFFER_SIZE];
+    // Sums the sizes of the entries, the progress is reported by bytes
+    uLong total = 0;
+    for (uLong i = 0; i < global_info.number_entry; ++i)
+    {
+        unz_file_info fileInfo;
+        if (unzGetCurrentFileInfo(zipfile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) == UNZ_OK)
+        {
+            total += fileInfo.uncompressed_size;
+        }
+        if ((i+1) < global_info.number_entry && unzGoToNextFile(zipfile) != UNZ_OK)
+        {
+            break;
+        }
+    }
+    unzGoToFirstFile(zipfile);
+    uLong uncompressed = 0;
+    int percent = -1;
+    
+    // Buffer to hold data read from the zip file, large blocks are written directly to the files
+    vector<char> readBuffer(UNCOMPRESS_BUFFER_SIZE);
     
     CCLOG("start uncompressing");
     
@@ -305,10 +490,11 @@ bool AssetsManager::uncompress()
             int error = UNZ_OK;
             do
             {
-                error = unzReadCurrentFile(zipfile, readBuffer, BUFFER_SIZE);
+                error = unzReadCurrentFile(zipfile, &readBuffer[0], UNCOMPRESS_BUFFER_SIZE);
                 if (error < 0)
                 {
                     CCLOG("can not read zip file %s, error code is %d", fileName, error);
+                    fclose(out);
                     unzCloseCurrentFile(zipfile);
                     unzClose(zipfile);
                     return false;
@@ -316,7 +502,22 @@ bool AssetsManager::uncompress()
                 
                 if (error > 0)
                 {
-                    fwrite(readBuffer, error, 1, out);
+                    if (fwrite(&readBuffer[0], error, 1, out) != 1)
+                    {
+                        CCLOG("can not write destination file %s", fullPath.c_str());
+                        fclose(out);
+                        unzCloseCurrentFile(zipfile);
+                        unzClose(zipfile);
+                        return false;
+                    }
+                    
+                    uncompressed += error;
+                    int newPercent = total > 0 ? (int)((double)uncompressed * 100 / total) : 100;
+                    if (newPercent != percent)
+                    {
+                        percent = newPercent;
+                        sendProgressMessage(ASSETSMANAGER_MESSAGE_UNCOMPRESS_PROGRESS, percent);
+                    }
                 }
             } while(error > 0);
             
@@ -338,6 +539,7 @@ bool AssetsManager::uncompress()
     }
     
     CCLOG("end uncompressing");
+    unzClose(zipfile);
     
     return true;
 }
@@ -369,6 +571,12 @@ bool AssetsManager::createDirectory(const char *path)
 
 void AssetsManager::setSearchPath()
 {
+    if (_mountPackage)
+    {
+        mountPackage();
+    }
+    
+
     vector<string> searchPaths = FileUtils::getInstance()->getSearchPaths();
     vector<string>::iterator iter = searchPaths.begin();
     searchPaths.insert(iter, _storagePath);
@@ -377,62 +585,515 @@ void AssetsManager::setSearchPath()
 
 static size_t downLoadPackage(void *ptr, size_t size, size_t nmemb, void *userdata)
 {
-    FILE *fp = (FILE*)userdata;
-    size_t written = fwrite(ptr, size, nmemb, fp);
+    Transfer *transfer = (Transfer*)userdata;
+    
+    if (! transfer->started)
+    {
+        transfer->started = true;
+        
+        long code = 0;
+        curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &code);
+        if (code == 200 && transfer->resumed)
+        {
+            // The server ignored the range and sends the whole file
+            if (! transfer->wholeFile)
+            {
+                return 0;
+            }
+            transfer->fp = freopen(transfer->path.c_str(), "wb", transfer->fp);
+            if (! transfer->fp)
+            {
+                return 0;
+            }
+            transfer->received = 0;
+        }
+    }
+    
+    size_t written = fwrite(ptr, 1, size * nmemb, transfer->fp);
+    transfer->received += written;
     return written;
 }
 
-int assetsManagerProgressFunc(void *ptr, double totalToDownload, double nowDownloaded, double totalToUpLoad, double nowUpLoaded)
+static size_t checkAcceptRanges(void *ptr, size_t size, size_t nmemb, void *userdata)
+{
+    string header((char*)ptr, size * nmemb);
+    std::transform(header.begin(), header.end(), header.begin(), ::tolower);
+    if (header.find("accept-ranges: bytes") == 0)
+    {
+        *(bool*)userdata = true;
+    }
+    
+    return size * nmemb;
+}
+
+void AssetsManager::mountPackage()
+{
+    string packageFileName = _storagePath + MOUNTED_PACKAGE_FILE_NAME;
+    FileUtils::getInstance()->removePackFile(packageFileName);
+    FileUtils::getInstance()->addPackFile(packageFileName, _storagePath);
+}
+
+void AssetsManager::sendProgressMessage(unsigned int what, int percent)
 {
-    AssetsManager* manager = (AssetsManager*)ptr;
     AssetsManager::Message *msg = new AssetsManager::Message();
-    msg->what = ASSETSMANAGER_MESSAGE_PROGRESS;
+    msg->what = what;
     
     ProgressMessage *progressData = new ProgressMessage();
-    progressData->percent = (int)(nowDownloaded/totalToDownload*100);
-    progressData->manager = manager;
+    progressData->percent = percent;
+    progressData->manager = this;
     msg->obj = progressData;
     
-    manager->_schedule->sendMessage(msg);
+    _schedule->sendMessage(msg);
+    
+    CCLOG("%s... %d%%", what == ASSETSMANAGER_MESSAGE_PROGRESS ? "downloading" : "uncompressing", percent);
+}
+
+bool AssetsManager::downloadAll(const vector<Download>& downloads, const DownloadCallback& callback)
+{
+    CURLM *multi = curl_multi_init();
+    if (! multi)
+    {
+        sendErrorMessage(ErrorCode::NETWORK);
+        CCLOG("can not init curl");
+        return false;
+    }
+    
+    vector<Transfer> transfers(downloads.size());
+    deque<size_t> pending;
+    long long total = 0;
+    for (size_t i = 0; i < downloads.size(); ++i)
+    {
+        transfers[i].curl = NULL;
+        transfers[i].fp = NULL;
+        transfers[i].received = 0;
+        transfers[i].attempts = 0;
+        pending.push_back(i);
+        if (downloads[i].size > 0)
+        {
+            total += downloads[i].size;
+        }
+    }
     
-    CCLOG("downloading... %d%%", (int)(nowDownloaded/totalToDownload*100));
+    unsigned int maxTransfers = std::max(_maxConcurrentDownloads, 1u);
+    unsigned int active = 0;
+    int percent = -1;
+    bool succeed = true;
+    ErrorCode error = ErrorCode::NETWORK;
     
-    return 0;
+    // Closes a transfer, and tries it again if it failed
+    auto finish = [&](size_t index, bool ok) {
+        Transfer& transfer = transfers[index];
+        if (transfer.curl)
+        {
+            curl_multi_remove_handle(multi, transfer.curl);
+            curl_easy_cleanup(transfer.curl);
+            transfer.curl = NULL;
+            --active;
+        }
+        if (transfer.fp)
+        {
+            fclose(transfer.fp);
+            transfer.fp = NULL;
+        }
+        
+        if (ok && callback)
+        {
+            ok = callback(downloads[index]);
+        }
+        if (! ok)
+        {
+            if (transfer.attempts < MAX_DOWNLOAD_ATTEMPTS)
+            {
+                CCLOG("retrying to download %s", downloads[index].url.c_str());
+                pending.push_back(index);
+            }
+            else
+            {
+                CCLOG("can not download %s", downloads[index].url.c_str());
+                succeed = false;
+            }
+        }
+    };
+    
+    while (succeed && (active > 0 || ! pending.empty()))
+    {
+        // Starts downloads as connections become available
+        while (succeed && active < maxTransfers && ! pending.empty())
+        {
+            size_t index = pending.front();
+            pending.pop_front();
+            const Download& download = downloads[index];
+            Transfer& transfer = transfers[index];
+            ++transfer.attempts;
+            
+            // The data is appended to what a previous attempt received
+            transfer.fp = fopen(download.path.c_str(), "ab");
+            if (! transfer.fp)
+            {
+                CCLOG("can not create file %s", download.path.c_str());
+                error = ErrorCode::CREATE_FILE;
+                succeed = false;
+                break;
+            }
+            fseek(transfer.fp, 0, SEEK_END);
+            long long existing = ftell(transfer.fp);
+            transfer.path = download.path;
+            transfer.received = existing;
+            transfer.started = false;
+            transfer.resumed = download.offset > 0 || existing > 0;
+            transfer.wholeFile = download.offset == 0;
+            
+            if (download.size >= 0 && existing >= download.size)
+            {
+                finish(index, true);
+                continue;
+            }
+            
+            transfer.curl = curl_easy_init();
+            if (! transfer.curl)
+            {
+                CCLOG("can not init curl");
+                succeed = false;
+                break;
+            }
+            
+            char range[64];
+            if (transfer.resumed)
+            {
+                if (download.size >= 0)
+                {
+                    snprintf(range, sizeof(range), "%lld-%lld", download.offset + existing, download.offset + download.size - 1);
+                }
+                else
+                {
+                    snprintf(range, sizeof(range), "%lld-", download.offset + existing);
+                }
+                curl_easy_setopt(transfer.curl, CURLOPT_RANGE, range);
+            }
+            curl_easy_setopt(transfer.curl, CURLOPT_URL, download.url.c_str());
+            curl_easy_setopt(transfer.curl, CURLOPT_SSL_VERIFYPEER, 0L);
+            curl_easy_setopt(transfer.curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(transfer.curl, CURLOPT_FAILONERROR, 1L);
+            curl_easy_setopt(transfer.curl, CURLOPT_WRITEFUNCTION, downLoadPackage);
+            curl_easy_setopt(transfer.curl, CURLOPT_WRITEDATA, &transfer);
+            curl_easy_setopt(transfer.curl, CURLOPT_PRIVATE, (void*)index);
+            // A stalled connection is dropped, and the download resumed on a new one
+            curl_easy_setopt(transfer.curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+            curl_easy_setopt(transfer.curl, CURLOPT_LOW_SPEED_TIME, 30L);
+            if (_connectionTimeout) curl_easy_setopt(transfer.curl, CURLOPT_CONNECTTIMEOUT, _connectionTimeout);
+            curl_multi_add_handle(multi, transfer.curl);
+            ++active;
+        }
+        if (! succeed) break;
+        
+        int running = 0;
+        curl_multi_perform(multi, &running);
+        
+        CURLMsg *msg = NULL;
+        int left = 0;
+        while ((msg = curl_multi_info_read(multi, &left)))
+        {
+            if (msg->msg != CURLMSG_DONE) continue;
+            
+            CURLcode res = msg->data.result;
+            char *index = NULL;
+            long code = 0;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &index);
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &code);
+            // The range starts at the end of the file: a previous attempt already received all of it
+            if (res == CURLE_HTTP_RETURNED_ERROR && code == 416 && transfers[(size_t)index].resumed)
+            {
+                res = CURLE_OK;
+            }
+            if (res != CURLE_OK)
+            {
+                CCLOG("error when downloading %s, error code is %d", downloads[(size_t)index].url.c_str(), res);
+            }
+            finish((size_t)index, res == CURLE_OK);
+        }
+        
+        if (total > 0)
+        {
+            long long received = 0;
+            for (auto& transfer : transfers)
+            {
+                received += transfer.received;
+            }
+            int newPercent = (int)(std::min(received, total) * 100 / total);
+            if (newPercent != percent)
+            {
+                percent = newPercent;
+                sendProgressMessage(ASSETSMANAGER_MESSAGE_PROGRESS, percent);
+            }
+        }
+        
+        // Waits for the connections
+        if (active > 0)
+        {
+            fd_set readSet, writeSet, errorSet;
+            FD_ZERO(&readSet);
+            FD_ZERO(&writeSet);
+            FD_ZERO(&errorSet);
+            int maxFd = -1;
+            long timeout = -1;
+            curl_multi_fdset(multi, &readSet, &writeSet, &errorSet, &maxFd);
+            curl_multi_timeout(multi, &timeout);
+            if (timeout < 0 || timeout > 100)
+            {
+                timeout = 100;
+            }
+            
+            if (maxFd < 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            }
+            else
+            {
+                struct timeval tv;
+                tv.tv_sec = 0;
+                tv.tv_usec = timeout * 1000;
+                select(maxFd + 1, &readSet, &writeSet, &errorSet, &tv);
+            }
+        }
+    }
+    
+    for (auto& transfer : transfers)
+    {
+        if (transfer.curl)
+        {
+            curl_multi_remove_handle(multi, transfer.curl);
+            curl_easy_cleanup(transfer.curl);
+        }
+        if (transfer.fp)
+        {
+            fclose(transfer.fp);
+        }
+    }
+    curl_multi_cleanup(multi);
+    
+    if (! succeed)
+    {
+        sendErrorMessage(error);
+    }
+    return succeed;
 }
 
 bool AssetsManager::downLoad()
 {
-    // Create a file to save package.
     string outFileName = _storagePath + TEMP_PACKAGE_FILE_NAME;
-    FILE *fp = fopen(outFileName.c_str(), "wb");
-    if (! fp)
+    
+    // Asks the size of the package, and whether it can be downloaded by ranges
+    long long size = -1;
+    bool acceptRanges = false;
+    CURL *curl = curl_easy_init();
+    if (curl)
     {
-        sendErrorMessage(ErrorCode::CREATE_FILE);
-        CCLOG("can not create file %s", outFileName.c_str());
-        return false;
+        curl_easy_setopt(curl, CURLOPT_URL, _packageUrl.c_str());
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, checkAcceptRanges);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &acceptRanges);
+        if (_connectionTimeout) curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, _connectionTimeout);
+        double length = -1;
+        if (curl_easy_perform(curl) == CURLE_OK &&
+            curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length) == CURLE_OK &&
+            length >= 0)
+        {
+            size = (long long)length;
+        }
+        curl_easy_cleanup(curl);
     }
     
-    // Download pacakge
-    CURLcode res;
-    curl_easy_setopt(_curl, CURLOPT_URL, _packageUrl.c_str());
-    curl_easy_setopt(_curl, CURLOPT_WRITEFUNCTION, downLoadPackage);
-    curl_easy_setopt(_curl, CURLOPT_WRITEDATA, fp);
-    curl_easy_setopt(_curl, CURLOPT_NOPROGRESS, false);
-    curl_easy_setopt(_curl, CURLOPT_PROGRESSFUNCTION, assetsManagerProgressFunc);
-    curl_easy_setopt(_curl, CURLOPT_PROGRESSDATA, this);
-    res = curl_easy_perform(_curl);
-    curl_easy_cleanup(_curl);
-    if (res != 0)
+    vector<Download> downloads;
+    if (acceptRanges && size > PACKAGE_PART_SIZE)
+    {
+        int index = 0;
+        for (long long offset = 0; offset < size; offset += PACKAGE_PART_SIZE)
+        {
+            Download download;
+            download.url = _packageUrl;
+            download.path = getPackagePartPath(outFileName, index++);
+            download.offset = offset;
+            download.size = std::min((long long)PACKAGE_PART_SIZE, size - offset);
+            downloads.push_back(download);
+        }
+    }
+    else
+    {
+        Download download;
+        download.url = _packageUrl;
+        download.path = outFileName;
+        download.offset = 0;
+        download.size = acceptRanges ? size : -1;
+        downloads.push_back(download);
+    }
+    
+    if (! downloadAll(downloads, nullptr))
     {
-        sendErrorMessage(ErrorCode::NETWORK);
         CCLOG("error when download package");
-        fclose(fp);
         return false;
     }
     
+    // Joins the parts
+    if (downloads.size() > 1)
+    {
+        FILE *out = fopen(outFileName.c_str(), "wb");
+        bool joined = out != NULL;
+        char buffer[BUFFER_SIZE];
+        for (size_t i = 0; joined && i < downloads.size(); ++i)
+        {
+            FILE *in = fopen(downloads[i].path.c_str(), "rb");
+            joined = in != NULL;
+            size_t read = 0;
+            while (joined && (read = fread(buffer, 1, BUFFER_SIZE, in)) > 0)
+            {
+                joined = fwrite(buffer, 1, read, out) == read;
+            }
+            if (in) fclose(in);
+        }
+        if (out) fclose(out);
+        
+        if (! joined)
+        {
+            sendErrorMessage(ErrorCode::CREATE_FILE);
+            CCLOG("can not create file %s", outFileName.c_str());
+            return false;
+        }
+        
+        for (size_t i = 0; i < downloads.size(); ++i)
+        {
+            remove(downloads[i].path.c_str());
+        }
+    }
+    
     CCLOG("succeed downloading package %s", _packageUrl.c_str());
+    return true;
+}
+
+bool AssetsManager::updateFromManifest()
+{
+    string manifest;
+    CURLcode res = CURLE_FAILED_INIT;
+    CURL *curl = curl_easy_init();
+    if (curl)
+    {
+        curl_easy_setopt(curl, CURLOPT_URL, _manifestUrl.c_str());
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, getVersionCode);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &manifest);
+        if (_connectionTimeout) curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, _connectionTimeout);
+        res = curl_easy_perform(curl);
+        curl_easy_cleanup(curl);
+    }
+    
+    map<string, ManifestEntry> remoteEntries;
+    if (res != CURLE_OK || ! parseManifest(manifest, &remoteEntries))
+    {
+        sendErrorMessage(ErrorCode::NETWORK);
+        CCLOG("can not get manifest content, error code is %d", res);
+        return false;
+    }
+    
+    map<string, ManifestEntry> localEntries;
+    string localManifest;
+    string localManifestPath = _storagePath + MANIFEST_FILE_NAME;
+    if (readFile(localManifestPath, &localManifest))
+    {
+        parseManifest(localManifest, &localEntries);
+    }
+    
+    // Only the files which changed since the last update are downloaded
+    string baseUrl = _manifestUrl.substr(0, _manifestUrl.rfind('/') + 1);
+    vector<Download> downloads;
+    map<string, uLong> crcs;
+    for (auto& entry : remoteEntries)
+    {
+        string fullPath = _storagePath + entry.first;
+        auto localEntry = localEntries.find(entry.first);
+        if (localEntry != localEntries.end() &&
+            localEntry->second.crc == entry.second.crc &&
+            localEntry->second.size == entry.second.size)
+        {
+            continue;
+        }
+        
+        // An interrupted update may have already replaced the file
+        uLong crc = 0;
+        if (getFileCrc(fullPath, &crc) && crc == entry.second.crc)
+        {
+            continue;
+        }
+        
+        for (size_t pos = entry.first.find('/'); pos != string::npos; pos = entry.first.find('/', pos + 1))
+        {
+            if (! createDirectory((_storagePath + entry.first.substr(0, pos)).c_str()))
+            {
+                sendErrorMessage(ErrorCode::CREATE_FILE);
+                CCLOG("can not create directory for %s", fullPath.c_str());
+                return false;
+            }
+        }
+        
+        Download download;
+        download.url = baseUrl + entry.first;
+        download.path = fullPath + TEMP_FILE_SUFFIX;
+        download.offset = 0;
+        download.size = entry.second.size;
+        downloads.push_back(download);
+        crcs[download.path] = entry.second.crc;
+    }
+    
+    CCLOG("%d files to update", (int)downloads.size());
+    
+    // Each file is verified and moved into place as soon as it is downloaded
+    auto moveFile = [&crcs](const Download& download) -> bool {
+        uLong crc = 0;
+        if (! getFileCrc(download.path, &crc) || crc != crcs[download.path])
+        {
+            CCLOG("downloaded file %s is corrupted", download.path.c_str());
+            remove(download.path.c_str());
+            return false;
+        }
+        
+        string path = download.path.substr(0, download.path.size() - strlen(TEMP_FILE_SUFFIX));
+        // rename() doesn't replace an existing file on win32
+        remove(path.c_str());
+        if (rename(download.path.c_str(), path.c_str()) != 0)
+        {
+            CCLOG("can not move downloaded file to %s", path.c_str());
+            return false;
+        }
+        return true;
+    };
+    
+    if (! downloadAll(downloads, moveFile))
+    {
+        return false;
+    }
+    
+    // Removes the files which aren't listed anymore
+    for (auto& entry : localEntries)
+    {
+        if (remoteEntries.find(entry.first) == remoteEntries.end())
+        {
+            remove((_storagePath + entry.first).c_str());
+        }
+    }
     
+    FILE *fp = fopen(localManifestPath.c_str(), "wb");
+    if (! fp || fwrite(manifest.c_str(), 1, manifest.size(), fp) != manifest.size())
+    {
+        if (fp) fclose(fp);
+        sendErrorMessage(ErrorCode::CREATE_FILE);
+        CCLOG("can not create file %s", localManifestPath.c_str());
+        return false;
+    }
     fclose(fp);
+    
     return true;
 }
 
@@ -457,6 +1118,16 @@ void AssetsManager::setStoragePath(const char *storagePath)
     checkStoragePath();
 }
 
+const char* AssetsManager::getManifestUrl() const
+{
+    return _manifestUrl.c_str();
+}
+
+void AssetsManager::setManifestUrl(const char *manifestUrl)
+{
+    _manifestUrl = manifestUrl;
+}
+
 const char* AssetsManager::getVersionFileUrl() const
 {
     return _versionFileUrl.c_str();
@@ -492,6 +1163,26 @@ unsigned int AssetsManager::getConnectionTimeout()
     return _connectionTimeout;
 }
 
+void AssetsManager::setMaxConcurrentDownloads(unsigned int count)
+{
+    _maxConcurrentDownloads = count;
+}
+
+unsigned int AssetsManager::getMaxConcurrentDownloads() const
+{
+    return _maxConcurrentDownloads;
+}
+
+void AssetsManager::setMountPackage(bool mountPackage)
+{
+    _mountPackage = mountPackage;
+}
+
+bool AssetsManager::isMountingPackage() const
+{
+    return _mountPackage;
+}
+
 void AssetsManager::sendErrorMessage(AssetsManager::ErrorCode code)
 {
     Message *msg = new Message();
@@ -562,6 +1253,15 @@ void AssetsManager::Helper::update(float dt)
             
             delete (ProgressMessage*)msg->obj;
             
+            break;
+        case ASSETSMANAGER_MESSAGE_UNCOMPRESS_PROGRESS:
+            if (((ProgressMessage*)msg->obj)->manager->_delegate)
+            {
+                ((ProgressMessage*)msg->obj)->manager->_delegate->onUncompressProgress(((ProgressMessage*)msg->obj)->percent);
+            }
+            
+            delete (ProgressMessage*)msg->obj;
+            
             break;
         case ASSETSMANAGER_MESSAGE_ERROR:
             // error call back
@@ -591,12 +1291,24 @@ void AssetsManager::Helper::handleUpdateSucceed(Message *msg)
     UserDefault::getInstance()->setStringForKey(KEY_OF_DOWNLOADED_VERSION, "");
     UserDefault::getInstance()->flush();
     
+    string zipfileName = manager->_storagePath + TEMP_PACKAGE_FILE_NAME;
+    if (manager->_manifestUrl.size() == 0 && manager->_mountPackage)
+    {
+        // Replace the mounted package, it is mounted again by setSearchPath().
+        string packageFileName = manager->_storagePath + MOUNTED_PACKAGE_FILE_NAME;
+        FileUtils::getInstance()->removePackFile(packageFileName);
+        remove(packageFileName.c_str());
+        if (rename(zipfileName.c_str(), packageFileName.c_str()) != 0)
+        {
+            CCLOG("can not move downloaded zip file to %s", packageFileName.c_str());
+        }
+    }
+    
     // Set resource search path.
     manager->setSearchPath();
     
     // Delete unloaded zip file.
-    string zipfileName = manager->_storagePath + TEMP_PACKAGE_FILE_NAME;
-    if (remove(zipfileName.c_str()) != 0)
+    if (manager->_manifestUrl.size() == 0 && ! manager->_mountPackage && remove(zipfileName.c_str()) != 0)
     {
         CCLOG("can not remove downloaded zip file %s", zipfileName.c_str());
     }
@@ -28,6 +28,8 @@
 #include <string>
 #include <curl/curl.h>
 #include <mutex>
+#include <vector>
+#include <functional>
 
 #include "cocos2d.h"
 #include "ExtensionMacros.h"
@@ -40,6 +42,8 @@ class AssetsManagerDelegateProtocol;
  *  This class is used to auto update resources, such as pictures or scripts.
  *  The updated package should be a zip file. And there should be a file named
  *  version in the server, which contains version code.
+ *  The package is downloaded by ranges over several connections, and an interrupted download is resumed.
+ *  With a manifest, only the files that changed are downloaded instead of the package.
  */
 class AssetsManager
 {
@@ -96,6 +100,17 @@ public:
      */
     void setPackageUrl(const char* packageUrl);
     
+    /* @brief Gets manifest url.
+     */
+    const char* getManifestUrl() const;
+    
+    /* @brief Sets manifest url. When it is set, update() downloads the files of the manifest which changed
+     *        since the last update, instead of the package. Each line of the manifest is
+     *        "<crc32 in hexadecimal> <size in bytes> <path relative to the manifest url>".
+     *        The files are moved into the storage path as soon as they are downloaded and verified.
+     */
+    void setManifestUrl(const char* manifestUrl);
+    
     /* @brief Gets version file url.
      */
     const char* getVersionFileUrl() const;
@@ -135,12 +150,44 @@ public:
      */
     unsigned int getConnectionTimeout();
     
-    /* downloadAndUncompress is the entry of a new thread 
+    /** @brief Sets how many files or ranges of the package are downloaded at the same time, 4 by default
+     */
+    void setMaxConcurrentDownloads(unsigned int count);
+    
+    /** @brief Gets how many files or ranges of the package are downloaded at the same time
+     */
+    unsigned int getMaxConcurrentDownloads() const;
+    
+    /** @brief Sets whether the package is mounted with FileUtils::addPackFile() instead of being extracted.
+     *         The entries stored without compression are then read directly from the package, the others
+     *         are uncompressed when they are read. The package is mounted by update() or checkUpdate(),
+     *         so they must be called while no texture is loaded asynchronously.
      */
-    friend int assetsManagerProgressFunc(void *, double, double, double, double);
+    void setMountPackage(bool mountPackage);
+    
+    /** @brief Gets whether the package is mounted instead of being extracted
+     */
+    bool isMountingPackage() const;
     
 protected:
+    /* A file, or a range of it, to download. The data is appended to path, which resumes an
+     * interrupted download
+     */
+    struct Download
+    {
+        std::string url;
+        std::string path;
+        long long offset; // first byte of the range
+        long long size;   // size of the range, -1 for the whole file of unknown size
+    };
+    typedef std::function<bool(const Download&)> DownloadCallback;
+    
     bool downLoad();
+    bool downloadAll(const std::vector<Download>& downloads, const DownloadCallback& callback);
+    bool updateFromManifest();
+    void uncompressPackage();
+    void mountPackage();
+    void sendProgressMessage(unsigned int what, int percent);
     void checkStoragePath();
     bool uncompress();
     bool createDirectory(const char *path);
@@ -182,12 +229,15 @@ private:
     
     std::string _packageUrl;
     std::string _versionFileUrl;
+    std::string _manifestUrl;
     
     std::string _downloadedVersion;
     
     CURL *_curl;
     Helper *_schedule;
     unsigned int _connectionTimeout;
+    unsigned int _maxConcurrentDownloads;
+    bool _mountPackage;
     
     AssetsManagerDelegateProtocol *_delegate; // weak reference
     
@@ -208,6 +258,10 @@ public:
               write code in onSuccess() after downloading. 
      */
     virtual void onProgress(int percent) {};
+    /** @brief Call back function for recording uncompressing percent, by bytes uncompressed
+        @param percent How much percent uncompressed
+     */
+    virtual void onUncompressProgress(int percent) {};
     /** @brief Call back function for success
      */
     virtual void onSuccess() {};
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "utils/CCDataReaderHelper.h"
 #include "datas/CCDatas.h"
 #include "display/CCSkin.h"
+#include "display/CCDisplayFactory.h"
 
 namespace cocos2d { namespace extension { namespace armature {
 
@@ -78,6 +79,13 @@ Armature::Armature()
 	, _parentBone(NULL)
 	, _boneDic(NULL)
     , _topBoneList(NULL)
+    , _boneListDirty(true)
+    , _poseSource(NULL)
+    , _bakedPoseMovement(NULL)
+    , _bakedPoseFrame(-1)
+    , _evaluatedInParallel(false)
+    , _poseEvaluated(false)
+    , _evaluationDelta(0)
 {
 }
 
@@ -95,6 +103,7 @@ Armature::~Armature(void)
         CC_SAFE_DELETE(_topBoneList);
     }
     CC_SAFE_DELETE(_animation);
+    CC_SAFE_RELEASE(_poseSource);
 }
 
 
@@ -267,6 +276,7 @@ void Armature::addBone(Bone *bone, const char *parentName)
         else
             _topBoneList->addObject(bone);
     }
+    invalidateBoneList();
 
     bone->setArmature(this);
 
@@ -286,6 +296,7 @@ void Armature::removeBone(Bone *bone, bool recursion)
     {
         _topBoneList->removeObject(bone);
     }
+    invalidateBoneList();
     _boneDic->removeObjectForKey(bone->getName());
     removeChild(bone, true);
 }
@@ -301,8 +312,9 @@ void Armature::changeBoneParent(Bone *bone, const char *parentName)
 {
     CCASSERT(bone != NULL, "bone must be added to the bone dictionary!");
 
-    bone->getParentBone()->getChildren()->removeObject(bone);
+    bone->getParentBone()->getChildrenBone()->removeObject(bone);
     bone->setParentBone(NULL);
+    invalidateBoneList();
 
     if (parentName != NULL)
     {
@@ -408,27 +420,274 @@ void Armature::updateOffsetPoint()
 }
 
 
-void Armature::update(float dt)
+void Armature::invalidateBoneList()
 {
-    _animation->update(dt);
+    _boneListDirty = true;
+
+    // the bones of a child armature are updated by the armature of its parent bone
+    if (_parentBone && _parentBone->getArmature())
+    {
+        _parentBone->getArmature()->invalidateBoneList();
+    }
+}
+
+void Armature::sortBones()
+{
+    _sortedBones.clear();
+    _boneParents.clear();
 
     Object *object = NULL;
     CCARRAY_FOREACH(_topBoneList, object)
     {
-        static_cast<Bone*>(object)->update(dt);
+        _sortedBones.push_back(static_cast<Bone *>(object));
+        _boneParents.push_back(-1);
+    }
+
+    // the children of a bone are added after it, so the list is walked while it grows
+    for (size_t i = 0; i < _sortedBones.size(); ++i)
+    {
+        CCARRAY_FOREACH(_sortedBones[i]->getChildrenBone(), object)
+        {
+            _sortedBones.push_back(static_cast<Bone *>(object));
+            _boneParents.push_back((int)i);
+        }
+    }
+
+    _boneDirty.resize(_sortedBones.size());
+    _boneListDirty = false;
+}
+
+void Armature::setPoseSource(Armature *source)
+{
+    CCASSERT(source != this, "an armature can't be its own pose source");
+    CCASSERT(source == NULL || source->getArmatureData() == _armatureData, "the pose source must have the same ArmatureData");
+
+    if (_poseSource == source)
+    {
+        return;
+    }
+
+    CC_SAFE_RETAIN(source);
+    CC_SAFE_RELEASE(_poseSource);
+    _poseSource = source;
+
+    if (_poseSource)
+    {
+        _animation->stop();
+
+        // the whole pose is taken at the next update
+        DictElement *element = NULL;
+        CCDICT_FOREACH(_boneDic, element)
+        {
+            static_cast<Bone *>(element->getObject())->setTransformDirty(true);
+        }
+    }
+}
+
+void Armature::updateFromPoseSource(float dt)
+{
+    if (_boneListDirty)
+    {
+        sortBones();
+    }
+    if (_poseSource->_boneListDirty)
+    {
+        _poseSource->sortBones();
+    }
+
+    // both armatures were built from the same data, so their bones are sorted in the same order
+    CCASSERT(_sortedBones.size() == _poseSource->_sortedBones.size(), "the pose source must have the same bones");
+    size_t count = MIN(_sortedBones.size(), _poseSource->_sortedBones.size());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Bone *bone = _sortedBones[i];
+        bone->updatePoseFrom(_poseSource->_sortedBones[i], dt, _poseSource->_boneDirty[i] || bone->isTransformDirty());
+        bone->setTransformDirty(false);
+    }
+}
+
+BakedAnimationData *Armature::bakeAnimation(const char *name)
+{
+    ArmatureDataManager *armatureDataManager = ArmatureDataManager::sharedArmatureDataManager();
+
+    BakedAnimationData *bakedAnimationData = armatureDataManager->getBakedAnimationData(name);
+    if (bakedAnimationData)
+    {
+        return bakedAnimationData;
+    }
+
+    Armature *armature = Armature::create(name);
+    CCASSERT(armature, "the armature can't be created");
+    armature->unscheduleUpdate();
+
+    ArmatureAnimation *animation = armature->getAnimation();
+    AnimationData *animationData = animation->getAnimationData();
+    float interval = animation->getAnimationInternal();
+
+    bakedAnimationData = BakedAnimationData::create();
+    bakedAnimationData->name = name;
+
+    for (const auto &movementName : animationData->movementNames)
+    {
+        MovementData *movementData = animationData->getMovement(movementName.c_str());
+
+        BakedMovementData *bakedMovement = BakedMovementData::create();
+        bakedMovement->name = movementName;
+        bakedMovement->frameCount = movementData->durationTween > 0 ? movementData->durationTween : movementData->duration;
+        bakedMovement->frameCount = MAX(bakedMovement->frameCount, 1);
+
+        animation->play(movementName.c_str(), 0);
+
+        for (int frame = 0; frame < bakedMovement->frameCount; ++frame)
+        {
+            armature->update(frame == 0 ? 0 : interval);
+
+            for (auto bone : armature->_sortedBones)
+            {
+                FrameData *tweenData = bone->getTweenData();
+                BakedBonePose pose = {
+                    bone->nodeToArmatureTransform(),
+                    bone->getDisplayManager()->getCurrentDisplayIndex(),
+                    bone->getZOrder(),
+                    Color4B(tweenData->r, tweenData->g, tweenData->b, tweenData->a)
+                };
+                bakedMovement->poses.push_back(pose);
+            }
+        }
+        bakedMovement->boneCount = (int)armature->_sortedBones.size();
+
+        bakedAnimationData->addMovement(bakedMovement);
+    }
+
+    armatureDataManager->addBakedAnimationData(name, bakedAnimationData);
+    return bakedAnimationData;
+}
+
+void Armature::setBakedAnimationEnabled(bool enabled)
+{
+    _animation->setBakedAnimationData(enabled ? bakeAnimation(_name.c_str()) : NULL);
+}
+
+void Armature::updateFromBakedMovement(BakedMovementData *movement, float dt)
+{
+    CCASSERT(movement->boneCount == (int)_sortedBones.size(), "the bones changed since the animation was baked");
+    size_t count = MIN(_sortedBones.size(), (size_t)movement->boneCount);
+
+    int frame = _animation->getBakedFrameIndex();
+    bool frameChanged = movement != _bakedPoseMovement || frame != _bakedPoseFrame;
+    _bakedPoseMovement = movement;
+    _bakedPoseFrame = frame;
+
+    const BakedBonePose *poses = movement->getFramePoses(frame);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Bone *bone = _sortedBones[i];
+        const BakedBonePose &pose = poses[i];
+
+        _boneDirty[i] = frameChanged || bone->isTransformDirty();
+        bone->updatePose(pose.transform, pose.displayIndex, pose.zOrder, pose.color, dt, _boneDirty[i]);
+        bone->setTransformDirty(false);
+    }
+}
+
+void Armature::update(float dt)
+{
+    if (_poseSource)
+    {
+        updateFromPoseSource(dt);
+        return;
+    }
+
+    _animation->update(dt);
+
+    if (_boneListDirty)
+    {
+        sortBones();
+    }
+
+    BakedMovementData *bakedMovement = _animation->getBakedMovement();
+    if (bakedMovement)
+    {
+        updateFromBakedMovement(bakedMovement, dt);
+        return;
+    }
+
+    if (_evaluatedInParallel)
+    {
+        // the bones are updated once all the update selectors were called
+        _evaluationDelta = dt;
+        SkeletonEvaluator::getInstance()->addSkeleton(this, this);
+        return;
+    }
+
+    // a single pass: the transform of a parent bone is always updated before the ones of its children
+    for (size_t i = 0; i < _sortedBones.size(); ++i)
+    {
+        int parent = _boneParents[i];
+        _boneDirty[i] = _sortedBones[i]->updateTransform(dt, parent >= 0 && _boneDirty[parent]);
+        _sortedBones[i]->setTransformDirty(false);
+    }
+}
+
+void Armature::evaluatePose()
+{
+    _poseEvaluated = isVisible();
+    if (!_poseEvaluated)
+    {
+        // the bones stay dirty until the armature is visible
+        return;
+    }
+
+    for (size_t i = 0; i < _sortedBones.size(); ++i)
+    {
+        Bone *bone = _sortedBones[i];
+        int parent = _boneParents[i];
+        _boneDirty[i] = bone->updateWorldTransform(parent >= 0 && _boneDirty[parent]);
+
+        DecorativeDisplay *decoDisplay = bone->getDisplayManager()->getCurrentDecorativeDisplay();
+        if (decoDisplay && DisplayFactory::isUpdateThreadSafe(decoDisplay))
+        {
+            DisplayFactory::updateDisplay(bone, decoDisplay, _evaluationDelta, _boneDirty[i] != 0);
+        }
+    }
+}
+
+void Armature::finishPoseEvaluation()
+{
+    if (!_poseEvaluated)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < _sortedBones.size(); ++i)
+    {
+        Bone *bone = _sortedBones[i];
+        DecorativeDisplay *decoDisplay = bone->getDisplayManager()->getCurrentDecorativeDisplay();
+        if (decoDisplay && !DisplayFactory::isUpdateThreadSafe(decoDisplay))
+        {
+            DisplayFactory::updateDisplay(bone, decoDisplay, _evaluationDelta, _boneDirty[i] != 0);
+        }
+        bone->setTransformDirty(false);
     }
 }
 
 void Armature::draw()
 {
+    if (_batchNode)
+    {
+        // the armature is a child of the batch node
+        addQuadsToBatchNode(_batchNode, getNodeToParentTransform());
+        return;
+    }
+
     if (_parentBone == NULL)
     {
         CC_NODE_DRAW_SETUP();
         GL::blendFunc(_blendFunc.src, _blendFunc.dst);
     }
 
-    Object *object = NULL;
-    CCARRAY_FOREACH(_children, object)
+    for (auto object : _children)
     {
         Bone *bone = static_cast<Bone *>(object);
 
@@ -484,13 +743,41 @@ void Armature::draw()
         }
     }
 
-    if(_atlas && !_batchNode && _parentBone == NULL)
+    if(_atlas && _parentBone == NULL)
     {
         _atlas->drawQuads();
         _atlas->removeAllQuads();
     }
 }
 
+void Armature::addQuadsToBatchNode(BatchNode *batchNode, const AffineTransform &transform)
+{
+    for (auto object : _children)
+    {
+        Bone *bone = static_cast<Bone *>(object);
+
+        Node *node = bone->getDisplayManager()->getDisplayRenderNode();
+        if (NULL == node)
+            continue;
+
+        if(Skin *skin = dynamic_cast<Skin *>(node))
+        {
+            skin->updateQuad(transform);
+            batchNode->addQuad(skin->getTexture(), skin->getQuad());
+        }
+        else if(Armature *armature = dynamic_cast<Armature *>(node))
+        {
+            // the bones of the child armatures are in the space of this armature
+            armature->addQuadsToBatchNode(batchNode, transform);
+        }
+        else
+        {
+            // drawn now, below the skins
+            node->visit();
+        }
+    }
+}
+
 void Armature::visit()
 {
     // quick return if not visible. children won't be drawn.
@@ -528,8 +815,7 @@ Rect Armature::getBoundingBox() const
 
     Rect boundingBox = Rect(0, 0, 0, 0);
 
-    Object *object = NULL;
-    CCARRAY_FOREACH(_children, object)
+    for (auto object : _children)
     {
         Bone *bone = static_cast<Bone *>(object);
         Rect r = bone->getDisplayManager()->getBoundingBox();
@@ -559,14 +845,12 @@ Rect Armature::getBoundingBox() const
 
 Bone *Armature::getBoneAtPoint(float x, float y)
 {
-    int length = _children->data->num;
-    Bone **bs = (Bone **)_children->data->arr;
-
-    for(int i = length - 1; i >= 0; i--)
+    for (auto iter = _children.rbegin(); iter != _children.rend(); ++iter)
     {
-        if(bs[i]->getDisplayManager()->containPoint(x, y))
+        Bone *bone = static_cast<Bone *>(*iter);
+        if(bone->getDisplayManager()->containPoint(x, y))
         {
-            return bs[i];
+            return bone;
         }
     }
     return NULL;
@@ -68,7 +68,7 @@ CC_DEPRECATED_ATTRIBUTE typedef ArmatureAnimation CCArmatureAnimation;
 CC_DEPRECATED_ATTRIBUTE typedef Armature CCArmature;
 CC_DEPRECATED_ATTRIBUTE typedef ArmatureDataManager CCArmatureDataManager;
     
-class  Armature : public NodeRGBA, public BlendProtocol 
+class  Armature : public NodeRGBA, public BlendProtocol, public SkeletonEvaluator::Target
 {
 
 public:
@@ -139,6 +139,49 @@ public:
 	Dictionary *getBoneDic();
     
     Bone *getBoneAtPoint(float x, float y);
+
+    /**
+     * Rebuilds the flat list of the bones before the next update.
+     * Called when the hierarchy of the bones changes.
+     */
+    void invalidateBoneList();
+
+    /**
+     * Shows the pose of another armature of the same ArmatureData instead of playing an animation:
+     * the bones take the transforms, displays and colors evaluated by the source each frame,
+     * without evaluating their tweens. It is meant for crowds of armatures playing the same movement in sync.
+     * The animation of the armature is stopped, and the movement and frame events are only sent by the source,
+     * which must be running. If it is updated after this armature, the pose is shown one frame late.
+     * @param source the armature whose pose is shown, NULL to play the own animation of the armature again
+     */
+    void setPoseSource(Armature *source);
+
+    /**
+     * Plays each movement of the armature named name at its durationTween, and saves the pose of the bones
+     * at each frame in the ArmatureDataManager. Meant to be done once, when loading.
+     * @return the baked movements, or the ones already baked
+     */
+    static BakedAnimationData *bakeAnimation(const char *name);
+
+    /**
+     * Plays the baked movements, baking them if needed, instead of evaluating the tweens of the bones:
+     * the pose of each frame is looked up. Meant for the armatures that don't need the exact curves of the animation:
+     * the frames aren't interpolated, the changes of movement aren't tweened and the frame events aren't sent.
+     * It must be enabled before playing a movement.
+     */
+    void setBakedAnimationEnabled(bool enabled);
+    inline Armature *getPoseSource() const { return _poseSource; }
+
+    /**
+     * Whether the transforms of the bones are computed by the SkeletonEvaluator, on the threads of the JobSystem,
+     * together with the other armatures evaluated in parallel, once all the update selectors were called.
+     * The animation still advances in update(), which sends the movement and frame events. The displays that aren't
+     * sprites, like the particles and the child armatures, and the colliders are updated on the main thread once all
+     * the poses are evaluated. The bones of an armature that isn't visible are only updated once it is visible again.
+     * It doesn't apply to the armatures showing the pose of another one or a baked movement. By default it is false.
+     */
+    inline bool isEvaluatedInParallel() const { return _evaluatedInParallel; }
+    inline void setEvaluatedInParallel(bool evaluatedInParallel) { _evaluatedInParallel = evaluatedInParallel; }
     
 
 	/**
@@ -150,6 +193,8 @@ public:
 	virtual void visit() override;
     virtual void update(float dt) override;
 	virtual void draw() override;
+    virtual void evaluatePose() override;
+    virtual void finishPoseEvaluation() override;
 	virtual AffineTransform getNodeToParentTransform() const override;
 	/** This boundingBox will calculate all bones' boundingBox every time */
 	virtual Rect getBoundingBox() const override;
@@ -162,6 +207,28 @@ protected:
      * Used to create Bone internal
      */
 	Bone *createBone(const char *boneName );
+
+    /*
+     * Lists the bones updated by the armature, the bones of the child armatures included,
+     * so that a parent bone is always before its children.
+     */
+    void sortBones();
+
+    /*
+     * Updates the bones from the pose of _poseSource
+     */
+    void updateFromPoseSource(float dt);
+
+    /*
+     * Updates the bones from a frame of a baked movement
+     */
+    void updateFromBakedMovement(BakedMovementData *movement, float dt);
+
+    /*
+     * Adds the quads of the skins to the batch node, the child armatures included
+     * @param transform the transform from the armature to the batch node
+     */
+    void addQuadsToBatchNode(BatchNode *batchNode, const AffineTransform &transform);
     
 
 	CC_SYNTHESIZE_RETAIN(ArmatureAnimation *, _animation, Animation);
@@ -180,6 +247,20 @@ protected:
 
 	Array *_topBoneList;
 
+    std::vector<Bone *> _sortedBones;       //! The bones to update, a parent bone before its children
+    std::vector<int> _boneParents;          //! Index of the parent of each sorted bone, -1 for a top bone
+    std::vector<char> _boneDirty;           //! Whether the transform of each sorted bone changed during the update
+    bool _boneListDirty;                    //! Whether the sorted bones must be rebuilt
+
+    Armature *_poseSource;                  //! The armature whose pose is shown, retained
+
+    BakedMovementData *_bakedPoseMovement;  //! The baked movement of the pose shown, a weak reference
+    int _bakedPoseFrame;                    //! The frame of the pose shown
+
+    bool _evaluatedInParallel;              //! Whether the bones are updated by the SkeletonEvaluator
+    bool _poseEvaluated;                    //! Whether the bones were updated by the last evaluatePose()
+    float _evaluationDelta;                 //! The time passed since the previous pose evaluated by evaluatePose()
+
     static std::map<int, Armature*> _armatureIndexDic;	//! Use to save armature zorder info, 
 
 	BlendFunc _blendFunc;                    //! It's required for TextureProtocol inheritance
@@ -158,8 +158,30 @@ Armature *Bone::getArmature()
 
 void Bone::update(float delta)
 {
-    if (_parent)
-        _transformDirty = _transformDirty || _parent->isTransformDirty();
+    updateTransform(delta, _parent && _parent->isTransformDirty());
+
+    Object *object = NULL;
+    CCARRAY_FOREACH(_children, object)
+    {
+        Bone *childBone = static_cast<Bone *>(object);
+        childBone->update(delta);
+    }
+
+    _transformDirty = false;
+}
+
+bool Bone::updateTransform(float delta, bool parentDirty)
+{
+    updateWorldTransform(parentDirty);
+
+    DisplayFactory::updateDisplay(this, _displayManager->getCurrentDecorativeDisplay(), delta, _transformDirty);
+
+    return _transformDirty;
+}
+
+bool Bone::updateWorldTransform(bool parentDirty)
+{
+    _transformDirty = _transformDirty || parentDirty;
 
     if (_transformDirty)
     {
@@ -183,18 +205,45 @@ void Bone::update(float delta)
         }
     }
 
-    DisplayFactory::updateDisplay(this, _displayManager->getCurrentDecorativeDisplay(), delta, _transformDirty);
+    return _transformDirty;
+}
 
-    Object *object = NULL;
-    CCARRAY_FOREACH(_children, object)
+
+void Bone::updatePoseFrom(Bone *source, float delta, bool dirty)
+{
+    FrameData *sourceData = source->_tweenData;
+    updatePose(source->_worldTransform, source->_displayManager->getCurrentDisplayIndex(), source->getZOrder(),
+               Color4B(sourceData->r, sourceData->g, sourceData->b, sourceData->a), delta, dirty);
+}
+
+void Bone::updatePose(const AffineTransform &transform, int displayIndex, int zOrder, const Color4B &color, float delta, bool dirty)
+{
+    if (displayIndex != _displayManager->getCurrentDisplayIndex())
     {
-        Bone *childBone = static_cast<Bone *>(object);
-        childBone->update(delta);
+        _displayManager->changeDisplayByIndex(displayIndex, false);
+        // the new display isn't placed yet
+        dirty = true;
     }
 
-    _transformDirty = false;
-}
+    if (dirty)
+    {
+        _worldTransform = transform;
+    }
 
+    setZOrder(zOrder);
+
+    if (_tweenData->a != color.a || _tweenData->r != color.r
+        || _tweenData->g != color.g || _tweenData->b != color.b)
+    {
+        _tweenData->a = color.a;
+        _tweenData->r = color.r;
+        _tweenData->g = color.g;
+        _tweenData->b = color.b;
+        updateColor();
+    }
+
+    DisplayFactory::updateDisplay(this, _displayManager->getCurrentDecorativeDisplay(), delta, dirty);
+}
 
 void Bone::updateDisplayedColor(const Color3B &parentColor)
 {
@@ -234,6 +283,11 @@ void Bone::addChildBone(Bone *child)
     {
         _children->addObject(child);
         child->setParentBone(this);
+
+        if (_armature)
+        {
+            _armature->invalidateBoneList();
+        }
     }
 }
 
@@ -257,6 +311,11 @@ void Bone::removeChildBone(Bone *bone, bool recursion)
         bone->getDisplayManager()->setCurrentDecorativeDisplay(NULL);
 
         _children->removeObject(bone);
+
+        if (_armature)
+        {
+            _armature->invalidateBoneList();
+        }
     }
 }
 
@@ -301,7 +360,7 @@ Armature *Bone::getChildArmature()
     return _childArmature;
 }
 
-Array *Bone::getChildren()
+Array *Bone::getChildrenBone()
 {
     return _children;
 }
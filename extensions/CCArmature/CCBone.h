@@ -118,13 +118,44 @@ public:
 
     void update(float delta);
 
+    /**
+     * Updates the transform of the bone and its display, but not its child bones.
+     * The transform of the parent bone must be up to date.
+     * @param parentDirty whether the transform of the parent bone changed
+     * @return whether the transform of the bone changed
+     */
+    bool updateTransform(float delta, bool parentDirty);
+
+    /**
+     * Updates the transform of the bone, but not its display nor its child bones.
+     * It only modifies the bone, so it can be called on any thread.
+     * @param parentDirty whether the transform of the parent bone changed
+     * @return whether the transform of the bone changed
+     */
+    bool updateWorldTransform(bool parentDirty);
+
+    /**
+     * Takes the transform, display, order and color of the same bone of another armature, then updates the display.
+     * The tween of the bone isn't used.
+     * @param dirty whether the transform of the source bone changed
+     */
+    void updatePoseFrom(Bone *source, float delta, bool dirty);
+
+    /**
+     * Takes a transform in the armature, a display, an order and a color, then updates the display.
+     * The tween of the bone isn't used.
+     * @param dirty whether the transform changed
+     */
+    void updatePose(const AffineTransform &transform, int displayIndex, int zOrder, const Color4B &color, float delta, bool dirty);
+
     void updateDisplayedColor(const Color3B &parentColor);
     void updateDisplayedOpacity(GLubyte parentOpacity);
 
     //! Update color to render display
     void updateColor();
 
-    Array *getChildren();
+    //! child bones, which aren't children of the bone in the node tree
+    Array *getChildrenBone();
     Tween *getTween();
 
     virtual void setZOrder(int zOrder);
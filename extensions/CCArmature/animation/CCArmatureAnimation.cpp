@@ -48,6 +48,10 @@ ArmatureAnimation *ArmatureAnimation::create(Armature *armature)
 
 ArmatureAnimation::ArmatureAnimation()
 	: _animationData(NULL)
+	, _bakedAnimationData(NULL)
+	, _bakedMovement(NULL)
+	, _bakedFrame(0)
+	, _bakedLoop(false)
 	, _armature(NULL)
     , _movementID("")
     , _toIndex(0)
@@ -59,6 +63,7 @@ ArmatureAnimation::~ArmatureAnimation(void)
 {
     CC_SAFE_RELEASE_NULL(_tweenList);
     CC_SAFE_RELEASE_NULL(_animationData);
+    CC_SAFE_RELEASE_NULL(_bakedAnimationData);
 }
 
 bool ArmatureAnimation::init(Armature *armature)
@@ -107,6 +112,7 @@ void ArmatureAnimation::stop()
         static_cast<Tween *>(object)->stop();
     }
     _tweenList->removeAllObjects();
+    _bakedMovement = NULL;
     ProcessBase::stop();
 }
 
@@ -179,6 +185,15 @@ void ArmatureAnimation::play(const char *animationName, int durationTo, int dura
     MovementBoneData *movementBoneData = NULL;
     _tweenList->removeAllObjects();
 
+    _bakedMovement = _bakedAnimationData ? _bakedAnimationData->getMovement(animationName) : NULL;
+    if (_bakedMovement)
+    {
+        // the poses of the bones are looked up, the tweens aren't played
+        _bakedFrame = 0;
+        _bakedLoop = loop != 0;
+        return;
+    }
+
     DictElement *element = NULL;
     Dictionary *dict = _armature->getBoneDic();
 
@@ -231,9 +246,28 @@ int ArmatureAnimation::getMovementCount()
     return _animationData->getMovementCount();
 }
 
+int ArmatureAnimation::getBakedFrameIndex() const
+{
+    int frame = (int)_bakedFrame;
+    if (_bakedLoop)
+    {
+        return MIN(frame, _bakedMovement->frameCount - 1);
+    }
+    return MIN(frame, _bakedMovement->frameCount - 1);
+}
+
 void ArmatureAnimation::update(float dt)
 {
     ProcessBase::update(dt);
+
+    if (_bakedMovement && !_isPause && dt <= 1)
+    {
+        _bakedFrame += _animationScale * (dt / _animationInternal);
+        if (_bakedLoop)
+        {
+            _bakedFrame = fmodf(_bakedFrame, (float)_bakedMovement->frameCount);
+        }
+    }
     Object *object = NULL;
     CCARRAY_FOREACH(_tweenList, object)
     {
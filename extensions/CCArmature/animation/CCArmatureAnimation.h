@@ -123,6 +123,16 @@ public:
     int getMovementCount();
 
     void update(float dt);
+
+    /**
+     * The movement played from the baked animation, NULL if the tweens of the bones are played
+     */
+    inline BakedMovementData *getBakedMovement() const { return _bakedMovement; }
+
+    /**
+     * The frame of the baked movement to show
+     */
+    int getBakedFrameIndex() const;
 protected:
 
     /**
@@ -139,6 +149,13 @@ protected:
     //! AnimationData save all MovementDatas this animation used.
     CC_SYNTHESIZE_RETAIN(AnimationData *, _animationData, AnimationData);
 
+    //! The baked movements played instead of the tweens, when they contain the movement. See Armature::setBakedAnimationEnabled()
+    CC_SYNTHESIZE_RETAIN(BakedAnimationData *, _bakedAnimationData, BakedAnimationData);
+
+    BakedMovementData *_bakedMovement;          //! A weak reference to the baked movement played
+    float _bakedFrame;                          //! The frames played of the baked movement
+    bool _bakedLoop;                            //! Whether the baked movement is looped
+
 
     MovementData *_movementData;				//! MovementData save all MovementFrameDatas this animation used.
 
@@ -368,6 +368,36 @@ int AnimationData::getMovementCount()
 
 
 
+BakedMovementData::BakedMovementData(void)
+    : frameCount(0)
+    , boneCount(0)
+{
+}
+
+BakedMovementData::~BakedMovementData(void)
+{
+}
+
+BakedAnimationData::BakedAnimationData(void)
+{
+}
+
+BakedAnimationData::~BakedAnimationData(void)
+{
+}
+
+void BakedAnimationData::addMovement(BakedMovementData *movData)
+{
+    movementDataDic.setObject(movData, movData->name);
+}
+
+BakedMovementData *BakedAnimationData::getMovement(const char *movementName)
+{
+    return (BakedMovementData *)movementDataDic.objectForKey(movementName);
+}
+
+
+
 ContourData::ContourData()
 {
 }
@@ -394,6 +394,57 @@ public:
 };
 
 
+/**
+*  The pose of a bone in a frame of a baked movement
+*/
+struct BakedBonePose
+{
+    AffineTransform transform;  //! transform of the bone in the armature
+    int displayIndex;
+    int zOrder;
+    Color4B color;
+};
+
+/**
+*  BakedMovementData contains the poses of the bones of an armature at each frame of a movement, sampled by Armature::bakeAnimation().
+*  The poses are stored frame by frame, in the order in which the armature updates its bones.
+*/
+class  BakedMovementData : public Object
+{
+public:
+    CS_CREATE_NO_PARAM_NO_INIT(BakedMovementData)
+public:
+    BakedMovementData(void);
+    ~BakedMovementData(void);
+
+    //! the poses of the bones at a frame
+    inline const BakedBonePose *getFramePoses(int frame) const { return &poses[frame * boneCount]; }
+public:
+    std::string name;
+    int frameCount;     //! the frames sampled, one per frame of the movement played at its durationTween
+    int boneCount;
+    std::vector<BakedBonePose> poses;
+};
+
+/**
+*  BakedAnimationData contains the baked movements of an armature
+*/
+class  BakedAnimationData : public Object
+{
+public:
+    CS_CREATE_NO_PARAM_NO_INIT(BakedAnimationData)
+public:
+    BakedAnimationData(void);
+    ~BakedAnimationData(void);
+
+    void addMovement(BakedMovementData *movData);
+    BakedMovementData *getMovement(const char *movementName);
+public:
+    std::string name;
+    Dictionary movementDataDic;
+};
+
+
 struct ContourVertex2F : public Object
 {
     ContourVertex2F(float x, float y)
@@ -41,10 +41,17 @@ BatchNode *BatchNode::create()
 }
 
 BatchNode::BatchNode()
-    : _atlas(NULL)
 {
 }
 
+BatchNode::~BatchNode()
+{
+    for (auto &textureAtlas : _textureAtlases)
+    {
+        textureAtlas.second->release();
+    }
+}
+
 bool BatchNode::init()
 {
     bool ret = Node::init();
@@ -93,27 +100,44 @@ void BatchNode::visit()
 
 void BatchNode::draw()
 {
+    // the armatures add their quads
+    for (auto object : _children)
+    {
+        object->visit();
+    }
+
     CC_NODE_DRAW_SETUP();
-    Object *object = NULL;
-    CCARRAY_FOREACH(_children, object)
+    GL::blendFunc(BlendFunc::ALPHA_PREMULTIPLIED.src, BlendFunc::ALPHA_PREMULTIPLIED.dst);
+
+    for (auto atlas : _usedAtlases)
     {
-        Armature *armature = dynamic_cast<Armature *>(object);
-        if (armature)
-        {
-            armature->visit();
-            _atlas = armature->getTextureAtlas();
-        }
-        else
-        {
-            static_cast<Node*>(object)->visit();
-        }
+        atlas->drawQuads();
+        atlas->removeAllQuads();
+    }
+    _usedAtlases.clear();
+}
+
+void BatchNode::addQuad(Texture2D *texture, const V3F_C4B_T2F_Quad &quad)
+{
+    TextureAtlas *&atlas = _textureAtlases[texture];
+    if (atlas == NULL)
+    {
+        atlas = TextureAtlas::createWithTexture(texture, 64);
+        atlas->retain();
     }
 
-    if (_atlas)
+    int index = atlas->getTotalQuads();
+    if (index == 0)
     {
-        _atlas->drawQuads();
-        _atlas->removeAllQuads();
+        _usedAtlases.push_back(atlas);
     }
+    if (index == atlas->getCapacity() && !atlas->resizeCapacity(atlas->getCapacity() * 2))
+    {
+        return;
+    }
+
+    V3F_C4B_T2F_Quad copy = quad;
+    atlas->updateQuad(&copy, index);
 }
 
 }}} // namespace cocos2d { namespace extension { namespace armature {
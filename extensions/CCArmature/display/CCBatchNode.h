@@ -26,23 +26,37 @@ THE SOFTWARE.
 #define __CCBATCHNODE_H__
 
 #include "../utils/CCArmatureDefine.h"
+#include <unordered_map>
+#include <vector>
 
 namespace cocos2d { namespace extension { namespace armature {
 
+/**
+ * Draws its armatures with a draw call per texture: the armatures write the quads of their skins, in the space of
+ * the BatchNode, to the atlas of their texture, and the atlases are drawn once all the children are visited.
+ * The other displays of the bones, like particles, are drawn when their armature is visited, below all the skins.
+ */
 class BatchNode : public Node
 {
 public:
     static BatchNode *create();
 public:
     BatchNode();
+    ~BatchNode();
 
     virtual bool init();
     virtual void addChild(Node *child, int zOrder, int tag);
     virtual void visit();
     void draw();
 
+    /**
+     * Adds a quad to draw with the texture at the end of this frame
+     */
+    void addQuad(Texture2D *texture, const V3F_C4B_T2F_Quad &quad);
+
 protected:
-    TextureAtlas *_atlas;
+    std::unordered_map<Texture2D *, TextureAtlas *> _textureAtlases;   //! the atlas of each texture, retained
+    std::vector<TextureAtlas *> _usedAtlases;                           //! the atlases with quads, in the order of their first quad
 };
 
 }}} // namespace cocos2d { namespace extension { namespace armature {
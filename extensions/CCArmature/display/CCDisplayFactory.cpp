@@ -104,6 +104,20 @@ void DisplayFactory::updateDisplay(Bone *bone, DecorativeDisplay *decoDisplay, f
 
 
 
+bool DisplayFactory::isUpdateThreadSafe(DecorativeDisplay *decoDisplay)
+{
+#if ENABLE_PHYSICS_DETECT
+    // the bodies of the colliders are moved in the physics world
+    if (decoDisplay->getColliderDetector())
+    {
+        return false;
+    }
+#endif
+
+    // the particles and the child armatures are updated like nodes
+    return decoDisplay->getDisplayData()->displayType == CS_DISPLAY_SPRITE;
+}
+
 void DisplayFactory::addSpriteDisplay(Bone *bone, DecorativeDisplay *decoDisplay, DisplayData *displayData)
 {
     SpriteDisplayData *sdp = SpriteDisplayData::create();
@@ -41,6 +41,8 @@ public:
 	static void addDisplay(Bone *bone, DecorativeDisplay *decoDisplay, DisplayData *displayData);
 	static void createDisplay(Bone *bone, DecorativeDisplay *decoDisplay);
 	static void updateDisplay(Bone *bone, DecorativeDisplay *decoDisplay, float dt, bool dirty);
+	//! whether updateDisplay() only modifies the display, so that it can be called on any thread
+	static bool isUpdateThreadSafe(DecorativeDisplay *decoDisplay);
 
 	static void addSpriteDisplay(Bone *bone, DecorativeDisplay *decoDisplay, DisplayData *displayData);
 	static void createSpriteDisplay(Bone *bone, DecorativeDisplay *decoDisplay);
@@ -85,6 +85,17 @@ void Skin::updateTransform()
 }
 
 void Skin::draw()
+{
+    updateQuad(AffineTransformIdentity);
+
+    // MARMALADE CHANGE: ADDED CHECK FOR NULL, TO PERMIT SPRITES WITH NO BATCH NODE / TEXTURE ATLAS
+    if (_textureAtlas)
+    {
+        _textureAtlas->updateQuad(&_quad, _textureAtlas->getTotalQuads());
+    }
+}
+
+void Skin::updateQuad(const AffineTransform &armatureTransform)
 {
     // If it is not visible, or one of its ancestors is not visible, then do nothing:
     if( !_visible)
@@ -105,13 +116,15 @@ void Skin::draw()
         float x2 = x1 + size.width;
         float y2 = y1 + size.height;
 
-        float x = _transform.tx;
-        float y = _transform.ty;
+        AffineTransform transform = AffineTransformConcat(_transform, armatureTransform);
+
+        float x = transform.tx;
+        float y = transform.ty;
 
-        float cr = _transform.a;
-        float sr = _transform.b;
-        float cr2 = _transform.d;
-        float sr2 = -_transform.c;
+        float cr = transform.a;
+        float sr = transform.b;
+        float cr2 = transform.d;
+        float sr2 = -transform.c;
         float ax = x1 * cr - y1 * sr2 + x;
         float ay = x1 * sr + y1 * cr2 + y;
 
@@ -129,12 +142,6 @@ void Skin::draw()
         _quad.tl.vertices = Vertex3F( RENDER_IN_SUBPIXEL(dx), RENDER_IN_SUBPIXEL(dy), _vertexZ );
         _quad.tr.vertices = Vertex3F( RENDER_IN_SUBPIXEL(cx), RENDER_IN_SUBPIXEL(cy), _vertexZ );
     }
-
-    // MARMALADE CHANGE: ADDED CHECK FOR NULL, TO PERMIT SPRITES WITH NO BATCH NODE / TEXTURE ATLAS
-    if (_textureAtlas)
-    {
-        _textureAtlas->updateQuad(&_quad, _textureAtlas->getTotalQuads());
-    }
 }
 
 }}} // namespace cocos2d { namespace extension { namespace armature {
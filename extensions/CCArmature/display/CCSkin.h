@@ -41,6 +41,11 @@ public:
     void updateTransform();
     void draw();
 
+    /**
+     * Computes the quad of the skin, in the space given by the transform of its armature
+     */
+    void updateQuad(const AffineTransform &armatureTransform);
+
     CC_PROPERTY_PASS_BY_REF(BaseData, _skinData, SkinData);
     CC_SYNTHESIZE(Bone *, _bone, Bone);
 
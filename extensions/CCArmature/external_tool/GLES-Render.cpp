@@ -20,6 +20,7 @@
 
 #include "GLES-Render.h"
 #include "cocos2d.h"
+#include "renderer/CCRenderer.h"
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
@@ -42,149 +43,93 @@ GLESDebugDraw::GLESDebugDraw( float32 ratio )
 
 void GLESDebugDraw::initShader( void )
 {
-    mShaderProgram = ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_U_COLOR);
-
-    mColorLocation = glGetUniformLocation( mShaderProgram->getProgram(), "u_color");
+    // Position, color and a texture coordinate set to 0 so the color is not faded, as DrawNode
+    mShaderProgram = ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR);
 }
 
-void GLESDebugDraw::DrawPolygon(const b2Vec2* old_vertices, int vertexCount, const b2Color& color)
+void GLESDebugDraw::AddVertex(std::vector<V2F_C4B_T2F>& vertices, const b2Vec2& v, const Color4B& color)
 {
-    mShaderProgram->use();
-    mShaderProgram->setUniformsForBuiltins();
+    V2F_C4B_T2F vertex = { Vertex2F(v.x * mRatio, v.y * mRatio), color, Tex2F(0.0f, 0.0f) };
+    vertices.push_back(vertex);
+}
 
-    b2Vec2* vertices = new b2Vec2[vertexCount];
-    for( int i=0;i<vertexCount;i++) 
+void GLESDebugDraw::AddLineLoop(const b2Vec2* vertices, int vertexCount, const Color4B& color)
+{
+    for (int i = 0; i < vertexCount; i++)
     {
-        vertices[i] = old_vertices[i];
-        vertices[i] *= mRatio;
+        AddVertex(mLines, vertices[i], color);
+        AddVertex(mLines, vertices[(i + 1) % vertexCount], color);
     }
-
-    mShaderProgram->setUniformLocationWith4f(mColorLocation, color.r, color.g, color.b, 1);
-
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-    glDrawArrays(GL_LINE_LOOP, 0, vertexCount);
-
-    CC_INCREMENT_GL_DRAWS(1);
-
-    CHECK_GL_ERROR_DEBUG();
-
-    delete[] vertices;
 }
 
-void GLESDebugDraw::DrawSolidPolygon(const b2Vec2* old_vertices, int vertexCount, const b2Color& color)
+void GLESDebugDraw::AddFan(const b2Vec2* vertices, int vertexCount, const Color4B& color)
 {
-    mShaderProgram->use();
-    mShaderProgram->setUniformsForBuiltins();
-
-    b2Vec2* vertices = new b2Vec2[vertexCount];
-    for( int i=0;i<vertexCount;i++) {
-        vertices[i] = old_vertices[i];
-        vertices[i] *= mRatio;
-	}
-    
-    mShaderProgram->setUniformLocationWith4f(mColorLocation, color.r*0.5f, color.g*0.5f, color.b*0.5f, 0.5f);
-
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-
-    glDrawArrays(GL_TRIANGLE_FAN, 0, vertexCount);
-
-    mShaderProgram->setUniformLocationWith4f(mColorLocation, color.r, color.g, color.b, 1);
-    glDrawArrays(GL_LINE_LOOP, 0, vertexCount);
+    for (int i = 1; i + 1 < vertexCount; i++)
+    {
+        AddVertex(mTriangles, vertices[0], color);
+        AddVertex(mTriangles, vertices[i], color);
+        AddVertex(mTriangles, vertices[i + 1], color);
+    }
+}
 
-    CC_INCREMENT_GL_DRAWS(2);
+// the fills are half transparent, premultiplied
+static Color4B fillColor(const b2Color& color)
+{
+    return Color4B(Color4F(color.r * 0.5f, color.g * 0.5f, color.b * 0.5f, 0.5f));
+}
 
-    CHECK_GL_ERROR_DEBUG();
+static Color4B lineColor(const b2Color& color)
+{
+    return Color4B(Color4F(color.r, color.g, color.b, 1.0f));
+}
 
-    delete[] vertices;
+void GLESDebugDraw::DrawPolygon(const b2Vec2* vertices, int vertexCount, const b2Color& color)
+{
+    AddLineLoop(vertices, vertexCount, lineColor(color));
 }
 
-void GLESDebugDraw::DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color)
+void GLESDebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int vertexCount, const b2Color& color)
 {
-    mShaderProgram->use();
-    mShaderProgram->setUniformsForBuiltins();
+    AddFan(vertices, vertexCount, fillColor(color));
+    AddLineLoop(vertices, vertexCount, lineColor(color));
+}
 
-    const float32 k_segments = 16.0f;
-    int vertexCount=16;
-    const float32 k_increment = 2.0f * b2_pi / k_segments;
+static const int k_circleSegments = 16;
+
+static void circleVertices(const b2Vec2& center, float32 radius, b2Vec2* vertices)
+{
+    const float32 k_increment = 2.0f * b2_pi / k_circleSegments;
     float32 theta = 0.0f;
-    
-    GLfloat*    glVertices = new GLfloat[vertexCount*2];
-    for (int i = 0; i < k_segments; ++i)
+    for (int i = 0; i < k_circleSegments; ++i)
     {
-        b2Vec2 v = center + radius * b2Vec2(cosf(theta), sinf(theta));
-        glVertices[i*2]=v.x * mRatio;
-        glVertices[i*2+1]=v.y * mRatio;
+        vertices[i] = center + radius * b2Vec2(cosf(theta), sinf(theta));
         theta += k_increment;
     }
-    
-    mShaderProgram->setUniformLocationWith4f(mColorLocation, color.r, color.g, color.b, 1);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, glVertices);
-
-    glDrawArrays(GL_LINE_LOOP, 0, vertexCount);
-
-    CC_INCREMENT_GL_DRAWS(1);
-
-    CHECK_GL_ERROR_DEBUG();
+}
 
-    delete[] glVertices;
+void GLESDebugDraw::DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color)
+{
+    b2Vec2 vertices[k_circleSegments];
+    circleVertices(center, radius, vertices);
+    AddLineLoop(vertices, k_circleSegments, lineColor(color));
 }
 
 void GLESDebugDraw::DrawSolidCircle(const b2Vec2& center, float32 radius, const b2Vec2& axis, const b2Color& color)
 {
-    mShaderProgram->use();
-    mShaderProgram->setUniformsForBuiltins();
-
-    const float32 k_segments = 16.0f;
-    int vertexCount=16;
-    const float32 k_increment = 2.0f * b2_pi / k_segments;
-    float32 theta = 0.0f;
-    
-    GLfloat*    glVertices = new GLfloat[vertexCount*2];
-    for (int i = 0; i < k_segments; ++i)
-    {
-        b2Vec2 v = center + radius * b2Vec2(cosf(theta), sinf(theta));
-        glVertices[i*2]=v.x * mRatio;
-        glVertices[i*2+1]=v.y * mRatio;
-        theta += k_increment;
-    }
-    
-    mShaderProgram->setUniformLocationWith4f(mColorLocation, color.r*0.5f, color.g*0.5f, color.b*0.5f, 0.5f);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, glVertices);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, vertexCount);
-
-
-    mShaderProgram->setUniformLocationWith4f(mColorLocation, color.r, color.g, color.b, 1);
-    glDrawArrays(GL_LINE_LOOP, 0, vertexCount);
+    b2Vec2 vertices[k_circleSegments];
+    circleVertices(center, radius, vertices);
+    AddFan(vertices, k_circleSegments, fillColor(color));
+    AddLineLoop(vertices, k_circleSegments, lineColor(color));
 
     // Draw the axis line
     DrawSegment(center,center+radius*axis,color);
-
-    CC_INCREMENT_GL_DRAWS(2);
-
-    CHECK_GL_ERROR_DEBUG();
-
-    delete[] glVertices;
 }
 
 void GLESDebugDraw::DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color)
 {
-    mShaderProgram->use();
-    mShaderProgram->setUniformsForBuiltins();
-
-    mShaderProgram->setUniformLocationWith4f(mColorLocation, color.r, color.g, color.b, 1);
-
-    GLfloat    glVertices[] = 
-    {
-        p1.x * mRatio, p1.y * mRatio,
-        p2.x * mRatio, p2.y * mRatio
-    };
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, glVertices);
-
-    glDrawArrays(GL_LINES, 0, 2);
-
-    CC_INCREMENT_GL_DRAWS(1);
-
-    CHECK_GL_ERROR_DEBUG();
+    Color4B c = lineColor(color);
+    AddVertex(mLines, p1, c);
+    AddVertex(mLines, p2, c);
 }
 
 void GLESDebugDraw::DrawTransform(const b2Transform& xf)
@@ -200,25 +145,15 @@ void GLESDebugDraw::DrawTransform(const b2Transform& xf)
 
 void GLESDebugDraw::DrawPoint(const b2Vec2& p, float32 size, const b2Color& color)
 {
-    mShaderProgram->use();
-    mShaderProgram->setUniformsForBuiltins();
-
-    mShaderProgram->setUniformLocationWith4f(mColorLocation, color.r, color.g, color.b, 1);
-
-    //    glPointSize(size);
-
-    GLfloat                glVertices[] = {
-        p.x * mRatio, p.y * mRatio
+    // a square of size pixels, the points can't be batched with the triangles
+    float32 half = size * 0.5f / mRatio;
+    b2Vec2 vertices[] = {
+        b2Vec2(p.x - half, p.y - half),
+        b2Vec2(p.x + half, p.y - half),
+        b2Vec2(p.x + half, p.y + half),
+        b2Vec2(p.x - half, p.y + half)
     };
-
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, glVertices);
-
-    glDrawArrays(GL_POINTS, 0, 1);
-    //    glPointSize(1.0f);
-
-    CC_INCREMENT_GL_DRAWS(1);
-
-    CHECK_GL_ERROR_DEBUG();
+    AddFan(vertices, 4, lineColor(color));
 }
 
 void GLESDebugDraw::DrawString(int x, int y, const char *string, ...)
@@ -230,25 +165,33 @@ void GLESDebugDraw::DrawString(int x, int y, const char *string, ...)
 
 void GLESDebugDraw::DrawAABB(b2AABB* aabb, const b2Color& color)
 {
-    mShaderProgram->use();
-    mShaderProgram->setUniformsForBuiltins();
-
-    mShaderProgram->setUniformLocationWith4f(mColorLocation, color.r, color.g, color.b, 1);
-
-    GLfloat                glVertices[] = {
-        aabb->lowerBound.x * mRatio, aabb->lowerBound.y * mRatio,
-        aabb->upperBound.x * mRatio, aabb->lowerBound.y * mRatio,
-        aabb->upperBound.x * mRatio, aabb->upperBound.y * mRatio,
-        aabb->lowerBound.x * mRatio, aabb->upperBound.y * mRatio
+    b2Vec2 vertices[] = {
+        aabb->lowerBound,
+        b2Vec2(aabb->upperBound.x, aabb->lowerBound.y),
+        aabb->upperBound,
+        b2Vec2(aabb->lowerBound.x, aabb->upperBound.y)
     };
+    AddLineLoop(vertices, 4, lineColor(color));
+}
 
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, glVertices);
-    glDrawArrays(GL_LINE_LOOP, 0, 8);
-
-    CC_INCREMENT_GL_DRAWS(1);
+void GLESDebugDraw::Flush()
+{
+    kmMat4 mv;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
 
-    CHECK_GL_ERROR_DEBUG();
-    
+    Renderer *renderer = Director::getInstance()->getRenderer();
+    if (!mTriangles.empty())
+    {
+        renderer->addPrimitives(GL_TRIANGLES, mShaderProgram, BlendFunc::ALPHA_PREMULTIPLIED, 1.0f,
+                                &mTriangles[0], (int)mTriangles.size(), mv);
+        mTriangles.clear();
+    }
+    if (!mLines.empty())
+    {
+        renderer->addPrimitives(GL_LINES, mShaderProgram, BlendFunc::ALPHA_PREMULTIPLIED, 1.0f,
+                                &mLines[0], (int)mLines.size(), mv);
+        mLines.clear();
+    }
 }
 
-}}} // namespace cocos2d { namespace extension { namespace armature {
\ No newline at end of file
+}}} // namespace cocos2d { namespace extension { namespace armature {
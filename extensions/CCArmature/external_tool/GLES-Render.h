@@ -25,19 +25,27 @@
 #include "cocos2d.h"
 #include "ExtensionMacros.h"
 
+#include <vector>
+
 struct b2AABB;
 
 namespace cocos2d { namespace extension { namespace armature {
 
 // This class implements debug drawing callbacks that are invoked
 // inside b2World::Step.
+// The shapes are collected with a color per vertex, then added to the batched primitives of the Renderer
+// by Flush(), which must be called after b2World::DrawDebugData().
 class GLESDebugDraw : public b2Draw
 {
     float32 mRatio;
     cocos2d::GLProgram* mShaderProgram;
-    GLint        mColorLocation;
+    std::vector<cocos2d::V2F_C4B_T2F> mTriangles;
+    std::vector<cocos2d::V2F_C4B_T2F> mLines;
 
     void initShader( void );
+    void AddVertex(std::vector<cocos2d::V2F_C4B_T2F>& vertices, const b2Vec2& v, const cocos2d::Color4B& color);
+    void AddLineLoop(const b2Vec2* vertices, int vertexCount, const cocos2d::Color4B& color);
+    void AddFan(const b2Vec2* vertices, int vertexCount, const cocos2d::Color4B& color);
 public:
     GLESDebugDraw();
 
@@ -60,6 +68,9 @@ public:
     virtual void DrawString(int x, int y, const char* string, ...); 
 
     virtual void DrawAABB(b2AABB* aabb, const b2Color& color);
+
+    // Draws the shapes collected since the last call, the fills first then the outlines
+    void Flush();
 };
 
 }}} // namespace cocos2d { namespace extension { namespace armature {
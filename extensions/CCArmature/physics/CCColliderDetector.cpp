@@ -55,6 +55,8 @@ ColliderDetector *ColliderDetector::create(Bone *bone)
 
 ColliderDetector::ColliderDetector()
     : _colliderBodyList(NULL)
+    , _rigid(false)
+    , _transformValid(false)
 {
 }
 
@@ -117,7 +119,7 @@ void ColliderDetector::addContourData(ContourData *contourData)
     fixtureDef.isSensor = true;
 
     b2BodyDef bodyDef;
-    bodyDef.type = b2_dynamicBody;
+    bodyDef.type = _rigid ? b2_kinematicBody : b2_dynamicBody;
     bodyDef.position = b2Vec2(0.0f, 0.0f);
     bodyDef.userData = _bone;
 
@@ -127,6 +129,8 @@ void ColliderDetector::addContourData(ContourData *contourData)
     ColliderBody *colliderBody = new ColliderBody(body, contourData);
     _colliderBodyList->addObject(colliderBody);
     colliderBody->release();
+
+    _transformValid = false;
 }
 
 void ColliderDetector::addContourDataList(Array *contourDataList)
@@ -168,10 +172,53 @@ void ColliderDetector::setActive(bool active)
     }
 }
 
+void ColliderDetector::setRigid(bool rigid)
+{
+    if (_rigid == rigid)
+    {
+        return;
+    }
+    _rigid = rigid;
+
+    Object *object = NULL;
+    CCARRAY_FOREACH(_colliderBodyList, object)
+    {
+        ColliderBody *colliderBody = static_cast<ColliderBody *>(object);
+        b2Body *body = colliderBody->getB2Body();
+
+        body->SetType(_rigid ? b2_kinematicBody : b2_dynamicBody);
+        body->SetTransform(b2Vec2(0.0f, 0.0f), 0.0f);
+
+        if (_rigid)
+        {
+            //! the shape is in the space of the bone
+            b2PolygonShape *shape = (b2PolygonShape *)body->GetFixtureList()->GetShape();
+            const Array *array = &colliderBody->getContourData()->vertexList;
+            Object *vertexObject = NULL;
+            int i = 0;
+            CCARRAY_FOREACH(array, vertexObject)
+            {
+                ContourVertex2F *cv = static_cast<ContourVertex2F *>(vertexObject);
+                shape->m_vertices[i].Set(cv->x / PT_RATIO, cv->y / PT_RATIO);
+                i++;
+            }
+        }
+    }
+
+    _transformValid = false;
+}
+
 Point helpPoint;
 
 void ColliderDetector::updateTransform(AffineTransform &t)
 {
+    if (_transformValid && AffineTransformEqualToTransform(t, _transform))
+    {
+        return;
+    }
+    _transform = t;
+    _transformValid = true;
+
     Object *object = NULL;
     CCARRAY_FOREACH(_colliderBodyList, object)
     {
@@ -180,6 +227,12 @@ void ColliderDetector::updateTransform(AffineTransform &t)
         ContourData *contourData = colliderBody->getContourData();
         b2Body *body = colliderBody->getB2Body();
 
+        if (_rigid)
+        {
+            body->SetTransform(b2Vec2(t.tx / PT_RATIO, t.ty / PT_RATIO), atan2f(t.b, t.a));
+            continue;
+        }
+
         b2PolygonShape *shape = (b2PolygonShape *)body->GetFixtureList()->GetShape();
 
         //! update every vertex
@@ -88,13 +88,28 @@ public:
 	void removeContourData(ContourData *contourData);
 	void removeAll();
     
+    /**
+     * Moves the colliders to the transform of the bone. Nothing is done if the transform didn't change.
+     */
     void updateTransform(AffineTransform &t);
 
 	void setColliderFilter(b2Filter &filter);
 
     void setActive(bool active);
+
+    /**
+     * When the contours are rigid, the bodies are kinematic and moved to the position and rotation of the bone,
+     * instead of transforming each vertex of their shape. The scale and the skew of the bone are then ignored.
+     * By default the contours aren't rigid.
+     */
+    void setRigid(bool rigid);
+    inline bool isRigid() const { return _rigid; }
 private:
     Array *_colliderBodyList;
+
+    bool _rigid;
+    bool _transformValid;           //! whether _transform is the transform of the colliders
+    AffineTransform _transform;
     
 	CC_SYNTHESIZE(Bone*, _bone, Bone);
 
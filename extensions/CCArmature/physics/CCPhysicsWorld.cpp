@@ -160,6 +160,7 @@ void PhysicsWorld::update(float dt)
 void PhysicsWorld::drawDebug()
 {
     _noGravityWorld->DrawDebugData();
+    _debugDraw->Flush();
 }
 
 }}} // namespace cocos2d { namespace extension { namespace armature {
@@ -28,12 +28,67 @@ THE SOFTWARE.
 #include "CCDataReaderHelper.h"
 #include "CCSpriteFrameCacheHelper.h"
 #include "../physics/CCPhysicsWorld.h"
+#include "support/CCJobSystem.h"
 
 
 namespace cocos2d { namespace extension { namespace armature {
 
 static ArmatureDataManager *s_sharedArmatureDataManager = NULL;
 
+// files requested and loaded by the pending addArmatureFileInfoAsync()
+static unsigned int s_asyncFileCount = 0;
+static unsigned int s_asyncLoadedFileCount = 0;
+
+static void asyncFileLoaded(Object *target, SEL_SCHEDULE selector)
+{
+    ++s_asyncLoadedFileCount;
+    float percent = (float)s_asyncLoadedFileCount / s_asyncFileCount;
+    if (s_asyncLoadedFileCount == s_asyncFileCount)
+    {
+        s_asyncFileCount = 0;
+        s_asyncLoadedFileCount = 0;
+    }
+
+    if (target && selector)
+    {
+        (target->*selector)(percent);
+    }
+}
+
+// the image and plist of an addArmatureFileInfoAsync()
+class AsyncArmatureFileInfo : public Object
+{
+public:
+    AsyncArmatureFileInfo(const char *imagePath, Object *target, SEL_SCHEDULE selector)
+        : imagePath(imagePath)
+        , plist(NULL)
+        , target(target)
+        , selector(selector)
+    {
+        CC_SAFE_RETAIN(target);
+    }
+
+    ~AsyncArmatureFileInfo()
+    {
+        CC_SAFE_RELEASE(plist);
+        CC_SAFE_RELEASE(target);
+    }
+
+    void imageLoaded(Object *texture)
+    {
+        if (plist)
+        {
+            SpriteFrameCacheHelper::sharedSpriteFrameCacheHelper()->addSpriteFrameFromDict(plist, static_cast<Texture2D *>(texture), imagePath.c_str());
+        }
+        asyncFileLoaded(target, selector);
+    }
+
+    std::string imagePath;
+    Dictionary *plist;      //! parsed by the JobSystem, retained
+    Object *target;
+    SEL_SCHEDULE selector;
+};
+
 ArmatureDataManager *ArmatureDataManager::sharedArmatureDataManager()
 {
     if (s_sharedArmatureDataManager == NULL)
@@ -52,6 +107,7 @@ ArmatureDataManager::ArmatureDataManager(void)
 	_armarureDatas = NULL;
     _animationDatas = NULL;
     _textureDatas = NULL;
+    _bakedAnimationDatas = NULL;
 }
 
 
@@ -62,6 +118,7 @@ ArmatureDataManager::~ArmatureDataManager(void)
     CC_SAFE_DELETE(_animationDatas);
     CC_SAFE_DELETE(_armarureDatas);
     CC_SAFE_DELETE(_textureDatas);
+    CC_SAFE_DELETE(_bakedAnimationDatas);
 }
 
 void ArmatureDataManager::purgeArmatureSystem()
@@ -89,6 +146,10 @@ bool ArmatureDataManager::init()
         CCASSERT(_textureDatas, "create ArmatureDataManager::_textureDatas fail!");
         _textureDatas->retain();
 
+        _bakedAnimationDatas = Dictionary::create();
+        CCASSERT(_bakedAnimationDatas, "create ArmatureDataManager::_bakedAnimationDatas fail!");
+        _bakedAnimationDatas->retain();
+
         bRet = true;
     }
     while (0);
@@ -150,6 +211,24 @@ TextureData *ArmatureDataManager::getTextureData(const char *id)
     return textureData;
 }
 
+void ArmatureDataManager::addBakedAnimationData(const char *id, BakedAnimationData *bakedAnimationData)
+{
+    if(_bakedAnimationDatas)
+    {
+        _bakedAnimationDatas->setObject(bakedAnimationData, id);
+    }
+}
+
+BakedAnimationData *ArmatureDataManager::getBakedAnimationData(const char *id)
+{
+    BakedAnimationData *bakedAnimationData = NULL;
+    if (_bakedAnimationDatas)
+    {
+        bakedAnimationData = (BakedAnimationData *)_bakedAnimationDatas->objectForKey(id);
+    }
+    return bakedAnimationData;
+}
+
 
 
 void ArmatureDataManager::addArmatureFileInfo(const char *armatureName, const char *useExistFileInfo, const char *imagePath, const char *plistPath, const char *configFilePath)
@@ -164,6 +243,27 @@ void ArmatureDataManager::addArmatureFileInfo(const char *imagePath, const char
     addSpriteFrameFromFile(plistPath, imagePath);
 }
 
+void ArmatureDataManager::addArmatureFileInfoAsync(const char *imagePath, const char *plistPath, const char *configFilePath, Object *target, SEL_SCHEDULE selector)
+{
+    // the config file and the image
+    s_asyncFileCount += 2;
+
+    CC_SAFE_RETAIN(target);
+    DataReaderHelper::addDataFromFileAsync(configFilePath, [target, selector]() {
+        asyncFileLoaded(target, selector);
+        CC_SAFE_RELEASE(target);
+    });
+
+    AsyncArmatureFileInfo *info = new AsyncArmatureFileInfo(imagePath, target, selector);
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plistPath);
+    JobSystem::getInstance()->addTask([info, fullPath]() {
+        info->plist = Dictionary::createWithContentsOfFileThreadSafe(fullPath.c_str());
+    }, [info]() {
+        TextureCache::getInstance()->addImageAsync(info->imagePath.c_str(), info, callfuncO_selector(AsyncArmatureFileInfo::imageLoaded));
+        info->release();
+    });
+}
+
 void ArmatureDataManager::addSpriteFrameFromFile(const char *plistPath, const char *imagePath)
 {
     //	if(Game::sharedGame()->isUsePackage())
@@ -194,6 +294,11 @@ void ArmatureDataManager::removeAll()
         _textureDatas->removeAllObjects();
     }
 
+    if( _bakedAnimationDatas )
+    {
+        _bakedAnimationDatas->removeAllObjects();
+    }
+
     DataReaderHelper::clear();
 }
 
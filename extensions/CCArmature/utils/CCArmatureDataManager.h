@@ -101,6 +101,22 @@ public:
 	 *  @return TextureData *
      */
     TextureData *getTextureData(const char *id);
+
+    /**
+     *	@brief	add the movements of an armature baked by Armature::bakeAnimation()
+     *
+     *	@param 	id the id of the armature
+     */
+    void addBakedAnimationData(const char *id, BakedAnimationData *bakedAnimationData);
+
+	/**
+     *	@brief	get the baked movements of an armature
+     *
+     *	@param 	id the id of the armature
+	 *
+	 *  @return BakedAnimationData *, NULL if the armature wasn't baked
+     */
+    BakedAnimationData *getBakedAnimationData(const char *id);
     
     /**
 	 *	@brief	Add ArmatureFileInfo, it is managed by ArmatureDataManager.
@@ -111,6 +127,14 @@ public:
      */
 	void addArmatureFileInfo(const char *imagePath, const char *plistPath, const char *configFilePath);
 
+    /**
+     *	@brief	Same as addArmatureFileInfo(), but the config file and the plist are parsed by the JobSystem,
+     *          and the image is loaded with TextureCache::addImageAsync().
+     *          Each time a config file or an image of the pending asynchronous loads is loaded, the selector
+     *          is called on the target with the part of the files loaded, from 0 to 1.
+     */
+    void addArmatureFileInfoAsync(const char *imagePath, const char *plistPath, const char *configFilePath, Object *target, SEL_SCHEDULE selector);
+
     /**
      *	@brief	Add sprite frame to SpriteFrameCache, it will save display name and it's relative image name
      */
@@ -145,6 +169,13 @@ private:
      */
 	CC_SYNTHESIZE_READONLY(Dictionary *, _textureDatas, TextureDatas);
 
+	/**
+	 *	@brief	save baked animation datas
+	 *  @key	std::string
+	 *  @value	BakedAnimationData *
+     */
+	CC_SYNTHESIZE_READONLY(Dictionary *, _bakedAnimationDatas, BakedAnimationDatas);
+
 };
 
 
@@ -28,6 +28,12 @@ THE SOFTWARE.
 #include "CCTransformHelp.h"
 #include "CCArmatureDefine.h"
 #include "../datas/CCDatas.h"
+#include "platform/CCMappedFile.h"
+#include "support/CCJobSystem.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 
 
@@ -132,6 +138,99 @@ std::vector<std::string> s_arrConfigFileList;
 float s_PositionReadScale = 1;
 static float s_FlashToolVersion = VERSION_2_0;
 
+// The datas decoded by addDataFromFileAsync() can't be autoreleased on the loading thread, nor added to the
+// ArmatureDataManager from it: they are kept in the context of the load, and added then released on the main thread.
+struct AsyncDecodeContext
+{
+    std::thread::id thread;
+    std::vector<Object *> objects;
+    std::vector<ArmatureData *> armatureDatas;
+    std::vector<AnimationData *> animationDatas;
+    std::vector<TextureData *> textureDatas;
+};
+
+// the context of the file decoded by the loading thread, one file at a time
+static std::atomic<AsyncDecodeContext *> s_asyncDecodeContext(nullptr);
+static std::mutex s_asyncDecodeMutex;
+
+static AsyncDecodeContext *getAsyncDecodeContext()
+{
+    AsyncDecodeContext *context = s_asyncDecodeContext;
+    return context && context->thread == std::this_thread::get_id() ? context : NULL;
+}
+
+template <typename T>
+static T *createData()
+{
+    T *data = new T();
+    AsyncDecodeContext *context = getAsyncDecodeContext();
+    if (context)
+    {
+        context->objects.push_back(data);
+    }
+    else
+    {
+        data->autorelease();
+    }
+    return data;
+}
+
+static void addArmatureData(ArmatureData *armatureData)
+{
+    AsyncDecodeContext *context = getAsyncDecodeContext();
+    if (context)
+    {
+        context->armatureDatas.push_back(armatureData);
+    }
+    else
+    {
+        ArmatureDataManager::sharedArmatureDataManager()->addArmatureData(armatureData->name.c_str(), armatureData);
+    }
+}
+
+// the armature decoded from the same file by the loading thread isn't in the ArmatureDataManager yet
+static ArmatureData *getArmatureData(const char *name)
+{
+    AsyncDecodeContext *context = getAsyncDecodeContext();
+    if (context)
+    {
+        for (auto armatureData : context->armatureDatas)
+        {
+            if (armatureData->name.compare(name) == 0)
+            {
+                return armatureData;
+            }
+        }
+    }
+    return ArmatureDataManager::sharedArmatureDataManager()->getArmatureData(name);
+}
+
+static void addAnimationData(AnimationData *animationData)
+{
+    AsyncDecodeContext *context = getAsyncDecodeContext();
+    if (context)
+    {
+        context->animationDatas.push_back(animationData);
+    }
+    else
+    {
+        ArmatureDataManager::sharedArmatureDataManager()->addAnimationData(animationData->name.c_str(), animationData);
+    }
+}
+
+static void addTextureData(TextureData *textureData)
+{
+    AsyncDecodeContext *context = getAsyncDecodeContext();
+    if (context)
+    {
+        context->textureDatas.push_back(textureData);
+    }
+    else
+    {
+        ArmatureDataManager::sharedArmatureDataManager()->addTextureData(textureData->name.c_str(), textureData);
+    }
+}
+
 void DataReaderHelper::setPositionReadScale(float scale)
 {
     s_PositionReadScale = scale;
@@ -166,6 +265,9 @@ void DataReaderHelper::addDataFromFile(const char *filePath)
     size_t startPos = filePathStr.find_last_of(".");
     std::string str = &filePathStr[startPos];
 
+    // waits for the file decoded by the loading thread, if any
+    std::lock_guard<std::mutex> lock(s_asyncDecodeMutex);
+
     if (str.compare(".xml") == 0)
     {
         DataReaderHelper::addDataFromXML(filePathStr.c_str());
@@ -174,6 +276,86 @@ void DataReaderHelper::addDataFromFile(const char *filePath)
     {
         DataReaderHelper::addDataFromJson(filePathStr.c_str());
     }
+    else if(str.compare(".ccab") == 0)
+    {
+        DataReaderHelper::addDataFromBinary(filePathStr.c_str());
+    }
+}
+
+void DataReaderHelper::addDataFromFileAsync(const char *filePath, const std::function<void()> &callback)
+{
+    for(unsigned int i = 0; i < s_arrConfigFileList.size(); i++)
+    {
+        if (s_arrConfigFileList[i].compare(filePath) == 0)
+        {
+            if (callback)
+            {
+                callback();
+            }
+            return;
+        }
+    }
+    s_arrConfigFileList.push_back(filePath);
+
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+    std::string extension = fullPath.substr(fullPath.find_last_of("."));
+    std::shared_ptr<AsyncDecodeContext> context = std::make_shared<AsyncDecodeContext>();
+
+    JobSystem::getInstance()->addTask([context, fullPath, extension]() {
+        unsigned long size = 0;
+        unsigned char *data = FileUtils::getInstance()->getFileData(fullPath.c_str(), "rb", &size);
+        if (data == NULL)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(s_asyncDecodeMutex);
+        context->thread = std::this_thread::get_id();
+        s_asyncDecodeContext = context.get();
+
+        if (extension.compare(".xml") == 0)
+        {
+            std::string content((const char *)data, size);
+            addDataFromCache(content.c_str());
+        }
+        else if (extension.compare(".json") == 0 || extension.compare(".ExportJson") == 0)
+        {
+            std::string content((const char *)data, size);
+            addDataFromJsonCache(content.c_str());
+        }
+        else if (extension.compare(".ccab") == 0)
+        {
+            addDataFromBinaryData(data, size);
+        }
+
+        s_asyncDecodeContext = nullptr;
+        delete [] data;
+    }, [context, callback]() {
+        ArmatureDataManager *armatureDataManager = ArmatureDataManager::sharedArmatureDataManager();
+        for (auto armatureData : context->armatureDatas)
+        {
+            armatureDataManager->addArmatureData(armatureData->name.c_str(), armatureData);
+        }
+        for (auto animationData : context->animationDatas)
+        {
+            armatureDataManager->addAnimationData(animationData->name.c_str(), animationData);
+        }
+        for (auto textureData : context->textureDatas)
+        {
+            armatureDataManager->addTextureData(textureData->name.c_str(), textureData);
+        }
+
+        for (auto object : context->objects)
+        {
+            object->release();
+        }
+        context->objects.clear();
+
+        if (callback)
+        {
+            callback();
+        }
+    });
 }
 
 
@@ -229,7 +411,7 @@ void DataReaderHelper::addDataFromCache(const char *pFileContent)
     while(armatureXML)
     {
         ArmatureData *armatureData = DataReaderHelper::decodeArmature(armatureXML);
-        ArmatureDataManager::sharedArmatureDataManager()->addArmatureData(armatureData->name.c_str(), armatureData);
+        addArmatureData(armatureData);
 
         armatureXML = armatureXML->NextSiblingElement(ARMATURE);
     }
@@ -242,7 +424,7 @@ void DataReaderHelper::addDataFromCache(const char *pFileContent)
     while(animationXML)
     {
         AnimationData *animationData = DataReaderHelper::decodeAnimation(animationXML);
-        ArmatureDataManager::sharedArmatureDataManager()->addAnimationData(animationData->name.c_str(), animationData);
+        addAnimationData(animationData);
 
         animationXML = animationXML->NextSiblingElement(ANIMATION);
     }
@@ -255,7 +437,7 @@ void DataReaderHelper::addDataFromCache(const char *pFileContent)
     while(textureXML)
     {
         TextureData *textureData = DataReaderHelper::decodeTexture(textureXML);
-        ArmatureDataManager::sharedArmatureDataManager()->addTextureData(textureData->name.c_str(), textureData);
+        addTextureData(textureData);
 
         textureXML = textureXML->NextSiblingElement(SUB_TEXTURE);
     }
@@ -267,7 +449,7 @@ ArmatureData *DataReaderHelper::decodeArmature(tinyxml2::XMLElement *armatureXML
     const char	*name = armatureXML->Attribute(A_NAME);
 
 
-    ArmatureData *armatureData = ArmatureData::create();
+    ArmatureData *armatureData = createData<ArmatureData>();
     armatureData->name = name;
 
 
@@ -310,7 +492,7 @@ BoneData *DataReaderHelper::decodeBone(tinyxml2::XMLElement *boneXML, tinyxml2::
 
     CCASSERT(name.length() != 0, "");
 
-    BoneData *boneData = BoneData::create();
+    BoneData *boneData = createData<BoneData>();
 
     boneData->name = name;
 
@@ -341,19 +523,19 @@ DisplayData *DataReaderHelper::decodeBoneDisplay(tinyxml2::XMLElement *displayXM
     {
         if(!_isArmature)
         {
-            displayData = SpriteDisplayData::create();
+            displayData = createData<SpriteDisplayData>();
             displayData->displayType  = CS_DISPLAY_SPRITE;
         }
         else
         {
-            displayData = ArmatureDisplayData::create();
+            displayData = createData<ArmatureDisplayData>();
             displayData->displayType  = CS_DISPLAY_ARMATURE;
         }
 
     }
     else
     {
-        displayData = SpriteDisplayData::create();
+        displayData = createData<SpriteDisplayData>();
         displayData->displayType  = CS_DISPLAY_SPRITE;
     }
 
@@ -378,9 +560,9 @@ AnimationData *DataReaderHelper::decodeAnimation(tinyxml2::XMLElement *animation
     const char	*name = animationXML->Attribute(A_NAME);
 
 
-    AnimationData *aniData =  AnimationData::create();
+    AnimationData *aniData =  createData<AnimationData>();
 
-    ArmatureData *armatureData = ArmatureDataManager::sharedArmatureDataManager()->getArmatureData(name);
+    ArmatureData *armatureData = getArmatureData(name);
 
     aniData->name = name;
 
@@ -402,7 +584,7 @@ MovementData *DataReaderHelper::decodeMovement(tinyxml2::XMLElement *movementXML
 {
     const char *movName = movementXML->Attribute(A_NAME);
 
-    MovementData *movementData = MovementData::create();
+    MovementData *movementData = createData<MovementData>();
 
     movementData->name = movName;
 
@@ -487,7 +669,7 @@ MovementData *DataReaderHelper::decodeMovement(tinyxml2::XMLElement *movementXML
 
 MovementBoneData *DataReaderHelper::decodeMovementBone(tinyxml2::XMLElement *movBoneXml, tinyxml2::XMLElement *parentXml, BoneData *boneData)
 {
-    MovementBoneData *movBoneData = MovementBoneData::create();
+    MovementBoneData *movBoneData = createData<MovementBoneData>();
     float scale, delay;
 
     if( movBoneXml )
@@ -575,7 +757,7 @@ FrameData *DataReaderHelper::decodeFrame(tinyxml2::XMLElement *frameXML,  tinyxm
     float _x, _y, _scale_x, _scale_y, _skew_x, _skew_y = 0;
     int _duration, _displayIndex, _zOrder, _tweenEasing = 0;
 
-    FrameData *frameData = FrameData::create();
+    FrameData *frameData = createData<FrameData>();
 
 
     if(frameXML->Attribute(A_MOVEMENT) != NULL)
@@ -728,7 +910,7 @@ FrameData *DataReaderHelper::decodeFrame(tinyxml2::XMLElement *frameXML,  tinyxm
 
 TextureData *DataReaderHelper::decodeTexture(tinyxml2::XMLElement *textureXML)
 {
-    TextureData *textureData = TextureData::create();
+    TextureData *textureData = createData<TextureData>();
 
     if( textureXML->Attribute(A_NAME) != NULL)
     {
@@ -772,20 +954,20 @@ TextureData *DataReaderHelper::decodeTexture(tinyxml2::XMLElement *textureXML)
 
 ContourData *DataReaderHelper::decodeContour(tinyxml2::XMLElement *contourXML)
 {
-    ContourData *contourData = ContourData::create();
+    ContourData *contourData = createData<ContourData>();
 
     tinyxml2::XMLElement *vertexDataXML = contourXML->FirstChildElement(CONTOUR_VERTEX);
 
     while (vertexDataXML)
     {
         ContourVertex2F *vertex = new ContourVertex2F(0, 0);
-        vertex->autorelease();
 
         vertexDataXML->QueryFloatAttribute(A_X, &vertex->x);
         vertexDataXML->QueryFloatAttribute(A_Y, &vertex->y);
 
         vertex->y = -vertex->y;
         contourData->vertexList.addObject(vertex);
+        vertex->release();
 
         vertexDataXML = vertexDataXML->NextSiblingElement(CONTOUR_VERTEX);
     }
@@ -816,7 +998,7 @@ void DataReaderHelper::addDataFromJsonCache(const char *fileContent)
     {
         cs::CSJsonDictionary *armatureDic = json.getSubItemFromArray(ARMATURE_DATA, i);
         ArmatureData *armatureData = decodeArmature(*armatureDic);
-        ArmatureDataManager::sharedArmatureDataManager()->addArmatureData(armatureData->name.c_str(), armatureData);
+        addArmatureData(armatureData);
 
         delete armatureDic;
     }
@@ -827,7 +1009,7 @@ void DataReaderHelper::addDataFromJsonCache(const char *fileContent)
     {
         cs::CSJsonDictionary *animationDic = json.getSubItemFromArray(ANIMATION_DATA, i);
         AnimationData *animationData = decodeAnimation(*animationDic);
-        ArmatureDataManager::sharedArmatureDataManager()->addAnimationData(animationData->name.c_str(), animationData);
+        addAnimationData(animationData);
 
         delete animationDic;
     }
@@ -838,7 +1020,7 @@ void DataReaderHelper::addDataFromJsonCache(const char *fileContent)
     {
         cs::CSJsonDictionary *textureDic = json.getSubItemFromArray(TEXTURE_DATA, i);
         TextureData *textureData = decodeTexture(*textureDic);
-        ArmatureDataManager::sharedArmatureDataManager()->addTextureData(textureData->name.c_str(), textureData);
+        addTextureData(textureData);
 
         delete textureDic;
     }
@@ -846,7 +1028,7 @@ void DataReaderHelper::addDataFromJsonCache(const char *fileContent)
 
 ArmatureData *DataReaderHelper::decodeArmature(cs::CSJsonDictionary &json)
 {
-    ArmatureData *armatureData = ArmatureData::create();
+    ArmatureData *armatureData = createData<ArmatureData>();
 
     const char *name = json.getItemStringValue(A_NAME);
     if(name != NULL)
@@ -868,7 +1050,7 @@ ArmatureData *DataReaderHelper::decodeArmature(cs::CSJsonDictionary &json)
 
 BoneData *DataReaderHelper::decodeBone(cs::CSJsonDictionary &json)
 {
-    BoneData *boneData = BoneData::create();
+    BoneData *boneData = createData<BoneData>();
 
     decodeNode(boneData, json);
 
@@ -907,7 +1089,7 @@ DisplayData *DataReaderHelper::decodeBoneDisplay(cs::CSJsonDictionary &json)
     {
     case CS_DISPLAY_SPRITE:
     {
-        displayData = SpriteDisplayData::create();
+        displayData = createData<SpriteDisplayData>();
         const char *name = json.getItemStringValue(A_NAME);
         if(name != NULL)
         {
@@ -918,7 +1100,7 @@ DisplayData *DataReaderHelper::decodeBoneDisplay(cs::CSJsonDictionary &json)
     break;
     case CS_DISPLAY_ARMATURE:
     {
-        displayData = ArmatureDisplayData::create();
+        displayData = createData<ArmatureDisplayData>();
         const char *name = json.getItemStringValue(A_NAME);
         if(name != NULL)
         {
@@ -928,7 +1110,7 @@ DisplayData *DataReaderHelper::decodeBoneDisplay(cs::CSJsonDictionary &json)
     break;
     case CS_DISPLAY_PARTICLE:
     {
-        displayData = ParticleDisplayData::create();
+        displayData = createData<ParticleDisplayData>();
         const char *plist = json.getItemStringValue(A_PLIST);
         if(plist != NULL)
         {
@@ -938,7 +1120,7 @@ DisplayData *DataReaderHelper::decodeBoneDisplay(cs::CSJsonDictionary &json)
     break;
     case CS_DISPLAY_SHADER:
     {
-        displayData = ShaderDisplayData::create();
+        displayData = createData<ShaderDisplayData>();
         const char *vert = json.getItemStringValue(A_VERT);
         if(vert != NULL)
         {
@@ -954,7 +1136,7 @@ DisplayData *DataReaderHelper::decodeBoneDisplay(cs::CSJsonDictionary &json)
     }
     break;
     default:
-        displayData = SpriteDisplayData::create();
+        displayData = createData<SpriteDisplayData>();
         break;
     }
 
@@ -965,7 +1147,7 @@ DisplayData *DataReaderHelper::decodeBoneDisplay(cs::CSJsonDictionary &json)
 
 AnimationData *DataReaderHelper::decodeAnimation(cs::CSJsonDictionary &json)
 {
-    AnimationData *aniData = AnimationData::create();
+    AnimationData *aniData = createData<AnimationData>();
 
     const char *name = json.getItemStringValue(A_NAME);
     if(name != NULL)
@@ -988,7 +1170,7 @@ AnimationData *DataReaderHelper::decodeAnimation(cs::CSJsonDictionary &json)
 
 MovementData *DataReaderHelper::decodeMovement(cs::CSJsonDictionary &json)
 {
-    MovementData *movementData = MovementData::create();
+    MovementData *movementData = createData<MovementData>();
 
     movementData->loop = json.getItemBoolvalue(A_LOOP, true);
     movementData->durationTween = json.getItemIntValue(A_DURATION_TWEEN, 0);
@@ -1016,7 +1198,7 @@ MovementData *DataReaderHelper::decodeMovement(cs::CSJsonDictionary &json)
 
 MovementBoneData *DataReaderHelper::decodeMovementBone(cs::CSJsonDictionary &json)
 {
-    MovementBoneData *movementBoneData = MovementBoneData::create();
+    MovementBoneData *movementBoneData = createData<MovementBoneData>();
 
     movementBoneData->delay = json.getItemFloatValue(A_MOVEMENT_DELAY, 0);
     movementBoneData->scale = json.getItemFloatValue(A_MOVEMENT_SCALE, 1);
@@ -1043,7 +1225,7 @@ MovementBoneData *DataReaderHelper::decodeMovementBone(cs::CSJsonDictionary &jso
 
 FrameData *DataReaderHelper::decodeFrame(cs::CSJsonDictionary &json)
 {
-    FrameData *frameData = FrameData::create();
+    FrameData *frameData = createData<FrameData>();
 
     decodeNode(frameData, json);
 
@@ -1062,7 +1244,7 @@ FrameData *DataReaderHelper::decodeFrame(cs::CSJsonDictionary &json)
 
 TextureData *DataReaderHelper::decodeTexture(cs::CSJsonDictionary &json)
 {
-    TextureData *textureData = TextureData::create();
+    TextureData *textureData = createData<TextureData>();
 
     const char *name = json.getItemStringValue(A_NAME);
     if(name != NULL)
@@ -1089,7 +1271,7 @@ TextureData *DataReaderHelper::decodeTexture(cs::CSJsonDictionary &json)
 
 ContourData *DataReaderHelper::decodeContour(cs::CSJsonDictionary &json)
 {
-    ContourData *contourData = ContourData::create();
+    ContourData *contourData = createData<ContourData>();
 
     int length = json.getArrayItemCount(VERTEX_POINT);
     for (int i = length - 1; i >= 0; i--)
@@ -1137,4 +1319,520 @@ void DataReaderHelper::decodeNode(BaseData *node, cs::CSJsonDictionary &json)
 
 }
 
+// Binary armature files (.ccab), created by tools/armature_converter.
+// All the values are little endian, and 4 bytes aligned. The records of each kind are stored in one
+// flat section, and a record refers to its children by the index of the first one and their count:
+//   Header
+//   ArmatureRecord[armatureCount], BoneRecord[boneCount], DisplayRecord[displayCount]
+//   AnimationRecord[animationCount], MovementRecord[movementCount], MovementBoneRecord[movementBoneCount], FrameRecord[frameCount]
+//   TextureRecord[textureCount], ContourRecord[contourCount], VertexRecord[vertexCount]
+//   string table: stringTableSize bytes of '\0' terminated strings, referenced by their offset
+static const char BINARY_ARMATURE_MAGIC[4] = { 'C', 'C', 'A', 'B' };
+static const unsigned int BINARY_ARMATURE_VERSION = 1;
+static const unsigned int BINARY_ARMATURE_NO_STRING = 0xffffffff;
+
+struct BinaryArmatureHeader
+{
+    char magic[4];
+    unsigned int version;
+    unsigned int armatureCount;
+    unsigned int boneCount;
+    unsigned int displayCount;
+    unsigned int animationCount;
+    unsigned int movementCount;
+    unsigned int movementBoneCount;
+    unsigned int frameCount;
+    unsigned int textureCount;
+    unsigned int contourCount;
+    unsigned int vertexCount;
+    unsigned int stringTableSize;
+};
+
+struct BinaryNodeRecord
+{
+    float x;
+    float y;
+    int zOrder;
+    float skewX;
+    float skewY;
+    float scaleX;
+    float scaleY;
+    unsigned int useColorInfo;
+    unsigned char a, r, g, b;
+};
+
+struct BinaryArmatureRecord
+{
+    unsigned int nameOffset;
+    unsigned int firstBone;
+    unsigned int boneCount;
+};
+
+struct BinaryBoneRecord
+{
+    unsigned int nameOffset;
+    unsigned int parentNameOffset;
+    BinaryNodeRecord node;
+    unsigned int firstDisplay;
+    unsigned int displayCount;
+};
+
+struct BinaryDisplayRecord
+{
+    unsigned int displayType;
+    unsigned int nameOffset;        // display name, plist of a particle or vertex shader
+    unsigned int fragOffset;        // fragment shader
+};
+
+struct BinaryAnimationRecord
+{
+    unsigned int nameOffset;
+    unsigned int firstMovement;
+    unsigned int movementCount;
+};
+
+struct BinaryMovementRecord
+{
+    unsigned int nameOffset;
+    int duration;
+    int durationTo;
+    int durationTween;
+    unsigned int loop;
+    int tweenEasing;
+    unsigned int firstMovementBone;
+    unsigned int movementBoneCount;
+};
+
+struct BinaryMovementBoneRecord
+{
+    unsigned int nameOffset;
+    float delay;
+    float scale;
+    unsigned int firstFrame;
+    unsigned int frameCount;
+};
+
+struct BinaryFrameRecord
+{
+    BinaryNodeRecord node;
+    int duration;
+    int tweenEasing;
+    int displayIndex;
+    unsigned int eventOffset;
+};
+
+struct BinaryTextureRecord
+{
+    unsigned int nameOffset;
+    float width;
+    float height;
+    float pivotX;
+    float pivotY;
+    unsigned int firstContour;
+    unsigned int contourCount;
+};
+
+struct BinaryContourRecord
+{
+    unsigned int firstVertex;
+    unsigned int vertexCount;
+};
+
+struct BinaryVertexRecord
+{
+    float x;
+    float y;
+};
+
+// the sections of a binary armature file, used in place
+struct BinaryArmatureFile
+{
+    const BinaryArmatureHeader *header;
+    const BinaryArmatureRecord *armatures;
+    const BinaryBoneRecord *bones;
+    const BinaryDisplayRecord *displays;
+    const BinaryAnimationRecord *animations;
+    const BinaryMovementRecord *movements;
+    const BinaryMovementBoneRecord *movementBones;
+    const BinaryFrameRecord *frames;
+    const BinaryTextureRecord *textures;
+    const BinaryContourRecord *contours;
+    const BinaryVertexRecord *vertices;
+    const char *strings;
+
+    const char *getString(unsigned int offset) const
+    {
+        return offset < header->stringTableSize ? strings + offset : NULL;
+    }
+};
+
+template <typename T>
+static const T *binarySection(const unsigned char *data, unsigned long &offset, unsigned int count)
+{
+    const T *section = reinterpret_cast<const T *>(data + offset);
+    offset += (unsigned long)count * sizeof(T);
+    return section;
+}
+
+static bool isBinaryRange(unsigned int first, unsigned int count, unsigned int total)
+{
+    return first <= total && count <= total - first;
+}
+
+// validates the file, and finds its sections
+static bool parseBinaryArmatureFile(const unsigned char *data, unsigned long size, BinaryArmatureFile *out)
+{
+    if (data == NULL || size < sizeof(BinaryArmatureHeader))
+    {
+        return false;
+    }
+
+    const BinaryArmatureHeader *header = reinterpret_cast<const BinaryArmatureHeader *>(data);
+    if (memcmp(header->magic, BINARY_ARMATURE_MAGIC, sizeof(BINARY_ARMATURE_MAGIC)) != 0 || header->version != BINARY_ARMATURE_VERSION)
+    {
+        CCLOG("DataReaderHelper: invalid binary armature file (version %u)", header->version);
+        return false;
+    }
+
+    unsigned long long expectedSize = sizeof(BinaryArmatureHeader)
+        + (unsigned long long)header->armatureCount * sizeof(BinaryArmatureRecord)
+        + (unsigned long long)header->boneCount * sizeof(BinaryBoneRecord)
+        + (unsigned long long)header->displayCount * sizeof(BinaryDisplayRecord)
+        + (unsigned long long)header->animationCount * sizeof(BinaryAnimationRecord)
+        + (unsigned long long)header->movementCount * sizeof(BinaryMovementRecord)
+        + (unsigned long long)header->movementBoneCount * sizeof(BinaryMovementBoneRecord)
+        + (unsigned long long)header->frameCount * sizeof(BinaryFrameRecord)
+        + (unsigned long long)header->textureCount * sizeof(BinaryTextureRecord)
+        + (unsigned long long)header->contourCount * sizeof(BinaryContourRecord)
+        + (unsigned long long)header->vertexCount * sizeof(BinaryVertexRecord)
+        + header->stringTableSize;
+    if (expectedSize > size || header->stringTableSize == 0)
+    {
+        CCLOG("DataReaderHelper: truncated binary armature file");
+        return false;
+    }
+
+    unsigned long offset = sizeof(BinaryArmatureHeader);
+    out->header = header;
+    out->armatures = binarySection<BinaryArmatureRecord>(data, offset, header->armatureCount);
+    out->bones = binarySection<BinaryBoneRecord>(data, offset, header->boneCount);
+    out->displays = binarySection<BinaryDisplayRecord>(data, offset, header->displayCount);
+    out->animations = binarySection<BinaryAnimationRecord>(data, offset, header->animationCount);
+    out->movements = binarySection<BinaryMovementRecord>(data, offset, header->movementCount);
+    out->movementBones = binarySection<BinaryMovementBoneRecord>(data, offset, header->movementBoneCount);
+    out->frames = binarySection<BinaryFrameRecord>(data, offset, header->frameCount);
+    out->textures = binarySection<BinaryTextureRecord>(data, offset, header->textureCount);
+    out->contours = binarySection<BinaryContourRecord>(data, offset, header->contourCount);
+    out->vertices = binarySection<BinaryVertexRecord>(data, offset, header->vertexCount);
+    out->strings = reinterpret_cast<const char *>(data + offset);
+
+    // strings are read in place: the table must end with a '\0'
+    if (out->strings[header->stringTableSize - 1] != '\0')
+    {
+        CCLOG("DataReaderHelper: corrupted binary armature file");
+        return false;
+    }
+
+    // the children of the records must be in their sections
+    for (unsigned int i = 0; i < header->armatureCount; i++)
+    {
+        if (!isBinaryRange(out->armatures[i].firstBone, out->armatures[i].boneCount, header->boneCount)) return false;
+    }
+    for (unsigned int i = 0; i < header->boneCount; i++)
+    {
+        if (!isBinaryRange(out->bones[i].firstDisplay, out->bones[i].displayCount, header->displayCount)) return false;
+    }
+    for (unsigned int i = 0; i < header->animationCount; i++)
+    {
+        if (!isBinaryRange(out->animations[i].firstMovement, out->animations[i].movementCount, header->movementCount)) return false;
+    }
+    for (unsigned int i = 0; i < header->movementCount; i++)
+    {
+        if (!isBinaryRange(out->movements[i].firstMovementBone, out->movements[i].movementBoneCount, header->movementBoneCount)) return false;
+    }
+    for (unsigned int i = 0; i < header->movementBoneCount; i++)
+    {
+        if (!isBinaryRange(out->movementBones[i].firstFrame, out->movementBones[i].frameCount, header->frameCount)) return false;
+    }
+    for (unsigned int i = 0; i < header->textureCount; i++)
+    {
+        if (!isBinaryRange(out->textures[i].firstContour, out->textures[i].contourCount, header->contourCount)) return false;
+    }
+    for (unsigned int i = 0; i < header->contourCount; i++)
+    {
+        if (!isBinaryRange(out->contours[i].firstVertex, out->contours[i].vertexCount, header->vertexCount)) return false;
+    }
+
+    return true;
+}
+
+static void decodeBinaryNode(BaseData *node, const BinaryNodeRecord &record)
+{
+    node->x = record.x * s_PositionReadScale;
+    node->y = record.y * s_PositionReadScale;
+    node->zOrder = record.zOrder;
+
+    node->skewX = record.skewX;
+    node->skewY = record.skewY;
+    node->scaleX = record.scaleX;
+    node->scaleY = record.scaleY;
+
+    if (record.useColorInfo)
+    {
+        node->a = record.a;
+        node->r = record.r;
+        node->g = record.g;
+        node->b = record.b;
+
+        node->isUseColorInfo = true;
+    }
+}
+
+static DisplayData *decodeBinaryDisplay(const BinaryArmatureFile &file, const BinaryDisplayRecord &record)
+{
+    const char *name = file.getString(record.nameOffset);
+    DisplayData *displayData = NULL;
+
+    switch (record.displayType)
+    {
+    case CS_DISPLAY_ARMATURE:
+        displayData = createData<ArmatureDisplayData>();
+        if (name)
+        {
+            ((ArmatureDisplayData *)displayData)->displayName = name;
+        }
+        break;
+    case CS_DISPLAY_PARTICLE:
+        displayData = createData<ParticleDisplayData>();
+        if (name)
+        {
+            ((ParticleDisplayData *)displayData)->plist = name;
+        }
+        break;
+    case CS_DISPLAY_SHADER:
+    {
+        displayData = createData<ShaderDisplayData>();
+        if (name)
+        {
+            ((ShaderDisplayData *)displayData)->vert = name;
+        }
+        const char *frag = file.getString(record.fragOffset);
+        if (frag)
+        {
+            ((ShaderDisplayData *)displayData)->frag = frag;
+        }
+    }
+    break;
+    case CS_DISPLAY_SPRITE:
+    default:
+        displayData = createData<SpriteDisplayData>();
+        if (name)
+        {
+            ((SpriteDisplayData *)displayData)->displayName = name;
+        }
+        break;
+    }
+
+    displayData->displayType = record.displayType < CS_DISPLAY_MAX ? (DisplayType)record.displayType : CS_DISPLAY_SPRITE;
+
+    return displayData;
+}
+
+static ArmatureData *decodeBinaryArmature(const BinaryArmatureFile &file, const BinaryArmatureRecord &record)
+{
+    ArmatureData *armatureData = createData<ArmatureData>();
+
+    const char *name = file.getString(record.nameOffset);
+    if (name)
+    {
+        armatureData->name = name;
+    }
+
+    for (unsigned int i = 0; i < record.boneCount; i++)
+    {
+        const BinaryBoneRecord &boneRecord = file.bones[record.firstBone + i];
+        BoneData *boneData = createData<BoneData>();
+
+        decodeBinaryNode(boneData, boneRecord.node);
+
+        const char *str = file.getString(boneRecord.nameOffset);
+        if (str)
+        {
+            boneData->name = str;
+        }
+        str = file.getString(boneRecord.parentNameOffset);
+        if (str)
+        {
+            boneData->parentName = str;
+        }
+
+        for (unsigned int j = 0; j < boneRecord.displayCount; j++)
+        {
+            boneData->addDisplayData(decodeBinaryDisplay(file, file.displays[boneRecord.firstDisplay + j]));
+        }
+
+        armatureData->addBoneData(boneData);
+    }
+
+    return armatureData;
+}
+
+static MovementBoneData *decodeBinaryMovementBone(const BinaryArmatureFile &file, const BinaryMovementBoneRecord &record)
+{
+    MovementBoneData *movementBoneData = createData<MovementBoneData>();
+
+    movementBoneData->delay = record.delay;
+    movementBoneData->scale = record.scale;
+
+    const char *name = file.getString(record.nameOffset);
+    if (name)
+    {
+        movementBoneData->name = name;
+    }
+
+    for (unsigned int i = 0; i < record.frameCount; i++)
+    {
+        const BinaryFrameRecord &frameRecord = file.frames[record.firstFrame + i];
+        FrameData *frameData = createData<FrameData>();
+
+        decodeBinaryNode(frameData, frameRecord.node);
+
+        frameData->duration = frameRecord.duration;
+        frameData->tweenEasing = (TweenType)frameRecord.tweenEasing;
+        frameData->displayIndex = frameRecord.displayIndex;
+
+        const char *event = file.getString(frameRecord.eventOffset);
+        if (event)
+        {
+            frameData->_event = event;
+        }
+
+        movementBoneData->addFrameData(frameData);
+    }
+
+    return movementBoneData;
+}
+
+static AnimationData *decodeBinaryAnimation(const BinaryArmatureFile &file, const BinaryAnimationRecord &record)
+{
+    AnimationData *aniData = createData<AnimationData>();
+
+    const char *name = file.getString(record.nameOffset);
+    if (name)
+    {
+        aniData->name = name;
+    }
+
+    for (unsigned int i = 0; i < record.movementCount; i++)
+    {
+        const BinaryMovementRecord &movementRecord = file.movements[record.firstMovement + i];
+        MovementData *movementData = createData<MovementData>();
+
+        movementData->loop = movementRecord.loop != 0;
+        movementData->durationTween = movementRecord.durationTween;
+        movementData->durationTo = movementRecord.durationTo;
+        movementData->duration = movementRecord.duration;
+        movementData->tweenEasing = (TweenType)movementRecord.tweenEasing;
+
+        name = file.getString(movementRecord.nameOffset);
+        if (name)
+        {
+            movementData->name = name;
+        }
+
+        for (unsigned int j = 0; j < movementRecord.movementBoneCount; j++)
+        {
+            movementData->addMovementBoneData(decodeBinaryMovementBone(file, file.movementBones[movementRecord.firstMovementBone + j]));
+        }
+
+        aniData->addMovement(movementData);
+    }
+
+    return aniData;
+}
+
+static TextureData *decodeBinaryTexture(const BinaryArmatureFile &file, const BinaryTextureRecord &record)
+{
+    TextureData *textureData = createData<TextureData>();
+
+    const char *name = file.getString(record.nameOffset);
+    if (name)
+    {
+        textureData->name = name;
+    }
+
+    textureData->width = record.width;
+    textureData->height = record.height;
+    textureData->pivotX = record.pivotX;
+    textureData->pivotY = record.pivotY;
+
+    for (unsigned int i = 0; i < record.contourCount; i++)
+    {
+        const BinaryContourRecord &contourRecord = file.contours[record.firstContour + i];
+        ContourData *contourData = createData<ContourData>();
+
+        // the vertices are stored in the order of the contour
+        for (unsigned int j = 0; j < contourRecord.vertexCount; j++)
+        {
+            const BinaryVertexRecord &vertexRecord = file.vertices[contourRecord.firstVertex + j];
+
+            ContourVertex2F *vertex = new ContourVertex2F(vertexRecord.x, vertexRecord.y);
+            contourData->vertexList.addObject(vertex);
+            vertex->release();
+        }
+
+        textureData->contourDataList.addObject(contourData);
+    }
+
+    return textureData;
+}
+
+bool DataReaderHelper::addDataFromBinaryData(const unsigned char *data, unsigned long size)
+{
+    BinaryArmatureFile file;
+    if (!parseBinaryArmatureFile(data, size, &file))
+    {
+        return false;
+    }
+
+    const BinaryArmatureHeader *header = file.header;
+
+    for (unsigned int i = 0; i < header->armatureCount; i++)
+    {
+        ArmatureData *armatureData = decodeBinaryArmature(file, file.armatures[i]);
+        addArmatureData(armatureData);
+    }
+
+    for (unsigned int i = 0; i < header->animationCount; i++)
+    {
+        AnimationData *animationData = decodeBinaryAnimation(file, file.animations[i]);
+        addAnimationData(animationData);
+    }
+
+    for (unsigned int i = 0; i < header->textureCount; i++)
+    {
+        TextureData *textureData = decodeBinaryTexture(file, file.textures[i]);
+        addTextureData(textureData);
+    }
+
+    return true;
+}
+
+void DataReaderHelper::addDataFromBinary(const char *filePath)
+{
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+
+    MappedFile *file = FileUtils::getInstance()->getMappedFileData(fullPath.c_str());
+    if (file == NULL)
+    {
+        CCLOG("DataReaderHelper: Couldn't open %s", filePath);
+        return;
+    }
+
+    if (!addDataFromBinaryData(file->getBytes(), file->getSize()))
+    {
+        CCLOG("DataReaderHelper: Couldn't read %s", filePath);
+    }
+}
+
 }}} // namespace cocos2d { namespace extension { namespace armature {
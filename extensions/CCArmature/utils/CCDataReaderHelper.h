@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "../utils/CCConstValue.h"
 #include "../CCArmature.h"
 #include "../external_tool/Json/CSContentJsonDictionary.h"
+#include <functional>
 
 namespace tinyxml2 { class XMLElement; }
 
@@ -49,6 +50,13 @@ public:
 
     static void addDataFromFile(const char *filePath);
 
+    /**
+     * Same as addDataFromFile(), but the file is read and decoded by the JobSystem. The datas are added to the
+     * ArmatureDataManager on the main thread, then the callback is called.
+     * The files are decoded one at a time, and addDataFromFile() waits for the file being decoded.
+     */
+    static void addDataFromFileAsync(const char *filePath, const std::function<void()> &callback);
+
     static void clear();
 public:
 
@@ -124,6 +132,23 @@ public:
     static ContourData *decodeContour(cs::CSJsonDictionary &json);
 
     static void decodeNode(BaseData *node, cs::CSJsonDictionary &json);
+
+public:
+
+    /**
+     * Adds the datas of a binary armature file (.ccab), converted from an ExportJson file by tools/armature_converter.
+     * The records of the file are read in place, nothing is parsed.
+     *
+     * @param filePath Path of the .ccab file
+     */
+    static void addDataFromBinary(const char *filePath);
+
+    /**
+     * Adds the datas of a binary armature file already in memory.
+     *
+     * @return false if the data isn't a valid binary armature file
+     */
+    static bool addDataFromBinaryData(const unsigned char *data, unsigned long size);
 };
 
 }}} // namespace cocos2d { namespace extension { namespace armature {
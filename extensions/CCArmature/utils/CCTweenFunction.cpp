@@ -31,6 +31,8 @@ float TweenFunction::tweenTo(float from, float change, float time, float duratio
 {
     float delta = 0;
 
+    // the curves which are the same as the ones of the ease actions use cocos2d::tweenfunc,
+    // which can read them from lookup tables
     switch (tweenType)
     {
     case Linear:
@@ -38,13 +40,13 @@ float TweenFunction::tweenTo(float from, float change, float time, float duratio
         break;
 
     case Sine_EaseIn:
-        delta = sineEaseIn(time, 0, 1, duration);
+        delta = tweenfunc::sineIn(time / duration);
         break;
     case Sine_EaseOut:
-        delta = sineEaseOut(time, 0, 1, duration);
+        delta = tweenfunc::sineOut(time / duration);
         break;
     case Sine_EaseInOut:
-        delta = sineEaseInOut(time, 0, 1, duration);
+        delta = tweenfunc::sineInOut(time / duration);
         break;
 
     case Quad_EaseIn:
@@ -108,10 +110,10 @@ float TweenFunction::tweenTo(float from, float change, float time, float duratio
         break;
 
     case Elastic_EaseIn:
-        delta = elasticEaseIn(time, 0, 1, duration);
+        delta = tweenfunc::elasticIn(time / duration, 0.3f);
         break;
     case Elastic_EaseOut:
-        delta = elasticEaseOut(time, 0, 1, duration);
+        delta = tweenfunc::elasticOut(time / duration, 0.3f);
         break;
     case Elastic_EaseInOut:
         delta = elasticEaseInOut(time, 0, 1, duration);
@@ -119,23 +121,23 @@ float TweenFunction::tweenTo(float from, float change, float time, float duratio
 
 
     case Back_EaseIn:
-        delta = backEaseIn(time, 0, 1, duration);
+        delta = tweenfunc::backIn(time / duration);
         break;
     case Back_EaseOut:
-        delta = backEaseOut(time, 0, 1, duration);
+        delta = tweenfunc::backOut(time / duration);
         break;
     case Back_EaseInOut:
-        delta = backEaseInOut(time, 0, 1, duration);
+        delta = tweenfunc::backInOut(time / duration);
         break;
 
     case Bounce_EaseIn:
-        delta = bounceEaseIn(time, 0, 1, duration);
+        delta = tweenfunc::bounceIn(time / duration);
         break;
     case Bounce_EaseOut:
-        delta = bounceEaseOut(time, 0, 1, duration);
+        delta = tweenfunc::bounceOut(time / duration);
         break;
     case Bounce_EaseInOut:
-        delta = bounceEaseInOut(time, 0, 1, duration);
+        delta = tweenfunc::bounceInOut(time / duration);
         break;
 
     default:
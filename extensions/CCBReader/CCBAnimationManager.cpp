@@ -8,12 +8,463 @@
 #include <set>
 #include "SimpleAudioEngine.h"
 #include "CCBSelectorResolver.h"
+#include <algorithm>
 
 using namespace cocos2d;
 using namespace std;
 
 NS_CC_EXT_BEGIN
 
+/************************************************************
+ CCBTimeline
+ ************************************************************/
+
+/* Evaluates the keyframes of a sequence for all the nodes, in place of an action per keyframe.
+ The segments between two keyframes are stepped like the actions they replace: each one starts
+ from the current value of its property, and is eased like the ease actions. */
+class CCBTimeline : public Action
+{
+public:
+    CCBTimeline(CCBAnimationManager *pManager, float fDuration);
+    virtual ~CCBTimeline();
+
+    /** animates a property of a node to pValue from fStart, during fDuration */
+    void addSegment(Node *pNode, const char *propName, float fStart, float fDuration,
+                    CCBKeyframe::EasingType easingType, float fEasingOpt, Object *pValue);
+
+    // Overrides
+    virtual bool isDone() const override;
+    virtual void step(float dt) override;
+    virtual CCBTimeline* clone() const override;
+    virtual CCBTimeline* reverse() const override;
+
+private:
+    enum class Property
+    {
+        ROTATION,
+        ROTATION_X,
+        ROTATION_Y,
+        OPACITY,
+        COLOR,
+        VISIBLE,
+        DISPLAY_FRAME,
+        POSITION,
+        SCALE,
+        SKEW,
+    };
+
+    struct Segment
+    {
+        Node *node;
+        Property property;
+        float start;
+        float duration;
+        tweenfunc::Easing easing;
+        float easingParam;
+        bool instant;
+        // the value of the keyframe, retained by the animation manager
+        Object *value;
+        bool started;
+        bool finished;
+        float from[3];
+        float delta[3];
+    };
+
+    void startSegment(Segment &segment);
+    void updateSegment(Segment &segment, float time);
+
+    // weak reference, cleared by the animation manager when it is deleted
+    CCBAnimationManager *_manager;
+    std::vector<Segment> _segments;
+    // retained while the timeline exists, like the targets of the actions
+    std::vector<Node*> _nodes;
+    float _duration;
+    float _elapsed;
+    bool _firstTick;
+    bool _completed;
+
+    friend class CCBAnimationManager;
+};
+
+CCBTimeline::CCBTimeline(CCBAnimationManager *pManager, float fDuration)
+: _manager(pManager)
+, _duration(fDuration)
+, _elapsed(0)
+, _firstTick(true)
+, _completed(false)
+{
+}
+
+CCBTimeline::~CCBTimeline()
+{
+    if (_manager && _manager->_timeline == this)
+    {
+        _manager->_timeline = NULL;
+    }
+
+    for (auto node : _nodes)
+    {
+        node->release();
+    }
+}
+
+void CCBTimeline::addSegment(Node *pNode, const char *propName, float fStart, float fDuration,
+                             CCBKeyframe::EasingType easingType, float fEasingOpt, Object *pValue)
+{
+    Segment segment;
+    if (strcmp(propName, "rotation") == 0)
+    {
+        segment.property = Property::ROTATION;
+    }
+    else if (strcmp(propName, "rotationX") == 0)
+    {
+        segment.property = Property::ROTATION_X;
+    }
+    else if (strcmp(propName, "rotationY") == 0)
+    {
+        segment.property = Property::ROTATION_Y;
+    }
+    else if (strcmp(propName, "opacity") == 0)
+    {
+        segment.property = Property::OPACITY;
+    }
+    else if (strcmp(propName, "color") == 0)
+    {
+        segment.property = Property::COLOR;
+    }
+    else if (strcmp(propName, "visible") == 0)
+    {
+        segment.property = Property::VISIBLE;
+    }
+    else if (strcmp(propName, "displayFrame") == 0)
+    {
+        segment.property = Property::DISPLAY_FRAME;
+    }
+    else if (strcmp(propName, "position") == 0)
+    {
+        segment.property = Property::POSITION;
+    }
+    else if (strcmp(propName, "scale") == 0)
+    {
+        segment.property = Property::SCALE;
+    }
+    else if (strcmp(propName, "skew") == 0)
+    {
+        segment.property = Property::SKEW;
+    }
+    else
+    {
+        log("CCBReader: Failed to create animation for property: %s", propName);
+        return;
+    }
+
+    segment.node = pNode;
+    segment.start = fStart;
+    segment.duration = fDuration;
+    segment.easingParam = fEasingOpt;
+    segment.instant = false;
+    segment.value = pValue;
+    segment.started = false;
+    segment.finished = false;
+
+    switch (easingType)
+    {
+        case CCBKeyframe::EasingType::LINEAR:
+            segment.easing = tweenfunc::Easing::LINEAR;
+            break;
+        case CCBKeyframe::EasingType::INSTANT:
+            segment.easing = tweenfunc::Easing::LINEAR;
+            segment.instant = true;
+            break;
+        case CCBKeyframe::EasingType::CUBIC_IN:
+            segment.easing = tweenfunc::Easing::EASE_IN;
+            break;
+        case CCBKeyframe::EasingType::CUBIC_OUT:
+            segment.easing = tweenfunc::Easing::EASE_OUT;
+            break;
+        case CCBKeyframe::EasingType::CUBIC_INOUT:
+            segment.easing = tweenfunc::Easing::EASE_IN_OUT;
+            break;
+        case CCBKeyframe::EasingType::BACK_IN:
+            segment.easing = tweenfunc::Easing::BACK_IN;
+            break;
+        case CCBKeyframe::EasingType::BACK_OUT:
+            segment.easing = tweenfunc::Easing::BACK_OUT;
+            break;
+        case CCBKeyframe::EasingType::BACK_INOUT:
+            segment.easing = tweenfunc::Easing::BACK_IN_OUT;
+            break;
+        case CCBKeyframe::EasingType::BOUNCE_IN:
+            segment.easing = tweenfunc::Easing::BOUNCE_IN;
+            break;
+        case CCBKeyframe::EasingType::BOUNCE_OUT:
+            segment.easing = tweenfunc::Easing::BOUNCE_OUT;
+            break;
+        case CCBKeyframe::EasingType::BOUNCE_INOUT:
+            segment.easing = tweenfunc::Easing::BOUNCE_IN_OUT;
+            break;
+        case CCBKeyframe::EasingType::ELASTIC_IN:
+            segment.easing = tweenfunc::Easing::ELASTIC_IN;
+            break;
+        case CCBKeyframe::EasingType::ELASTIC_OUT:
+            segment.easing = tweenfunc::Easing::ELASTIC_OUT;
+            break;
+        case CCBKeyframe::EasingType::ELASTIC_INOUT:
+            segment.easing = tweenfunc::Easing::ELASTIC_IN_OUT;
+            break;
+        default:
+            log("CCBReader: Unkown easing type %d", (int)easingType);
+            segment.easing = tweenfunc::Easing::LINEAR;
+            break;
+    }
+
+    _segments.push_back(segment);
+
+    if (std::find(_nodes.begin(), _nodes.end(), pNode) == _nodes.end())
+    {
+        pNode->retain();
+        _nodes.push_back(pNode);
+    }
+}
+
+// Same start values as the actions the segments replace
+void CCBTimeline::startSegment(Segment &segment)
+{
+    Node *node = segment.node;
+    segment.started = true;
+
+    switch (segment.property)
+    {
+        case Property::ROTATION:
+            segment.from[0] = node->getRotation();
+            segment.delta[0] = static_cast<CCBValue*>(segment.value)->getFloatValue() - segment.from[0];
+            break;
+        case Property::ROTATION_X:
+            segment.from[0] = node->getRotationX();
+            segment.delta[0] = static_cast<CCBValue*>(segment.value)->getFloatValue() - segment.from[0];
+            break;
+        case Property::ROTATION_Y:
+            segment.from[0] = node->getRotationY();
+            segment.delta[0] = static_cast<CCBValue*>(segment.value)->getFloatValue() - segment.from[0];
+            break;
+        case Property::OPACITY:
+            segment.from[0] = dynamic_cast<RGBAProtocol*>(node)->getOpacity();
+            segment.delta[0] = static_cast<CCBValue*>(segment.value)->getByteValue() - segment.from[0];
+            break;
+        case Property::COLOR:
+            {
+                Color3B from = dynamic_cast<RGBAProtocol*>(node)->getColor();
+                Color3B to = static_cast<Color3BWapper*>(segment.value)->getColor();
+                segment.from[0] = from.r;
+                segment.from[1] = from.g;
+                segment.from[2] = from.b;
+                segment.delta[0] = to.r - from.r;
+                segment.delta[1] = to.g - from.g;
+                segment.delta[2] = to.b - from.b;
+            }
+            break;
+        case Property::VISIBLE:
+        case Property::DISPLAY_FRAME:
+            break;
+        case Property::POSITION:
+            {
+                Array *array = static_cast<Array*>(_manager->getBaseValue(node, "position"));
+                CCBReader::PositionType type = (CCBReader::PositionType)((CCBValue*)array->objectAtIndex(2))->getIntValue();
+
+                Array *value = static_cast<Array*>(segment.value);
+                float x = ((CCBValue*)value->objectAtIndex(0))->getFloatValue();
+                float y = ((CCBValue*)value->objectAtIndex(1))->getFloatValue();
+                Point absPos = getAbsolutePosition(Point(x,y), type, _manager->getContainerSize(node->getParent()), "position");
+
+                segment.from[0] = node->getPosition().x;
+                segment.from[1] = node->getPosition().y;
+                segment.delta[0] = absPos.x - segment.from[0];
+                segment.delta[1] = absPos.y - segment.from[1];
+            }
+            break;
+        case Property::SCALE:
+            {
+                Array *array = static_cast<Array*>(_manager->getBaseValue(node, "scale"));
+                CCBReader::ScaleType type = (CCBReader::ScaleType)((CCBValue*)array->objectAtIndex(2))->getIntValue();
+
+                Array *value = static_cast<Array*>(segment.value);
+                float x = ((CCBValue*)value->objectAtIndex(0))->getFloatValue();
+                float y = ((CCBValue*)value->objectAtIndex(1))->getFloatValue();
+                if (type == CCBReader::ScaleType::MULTIPLY_RESOLUTION)
+                {
+                    float resolutionScale = CCBReader::getResolutionScale();
+                    x *= resolutionScale;
+                    y *= resolutionScale;
+                }
+
+                segment.from[0] = node->getScaleX();
+                segment.from[1] = node->getScaleY();
+                segment.delta[0] = x - segment.from[0];
+                segment.delta[1] = y - segment.from[1];
+            }
+            break;
+        case Property::SKEW:
+            {
+                Array *value = static_cast<Array*>(segment.value);
+                float x = ((CCBValue*)value->objectAtIndex(0))->getFloatValue();
+                float y = ((CCBValue*)value->objectAtIndex(1))->getFloatValue();
+
+                // same as SkewTo, which takes the shortest way
+                float startX = node->getSkewX();
+                startX = fmodf(startX, startX > 0 ? 180.f : -180.f);
+                float deltaX = x - startX;
+                if (deltaX > 180) deltaX -= 360;
+                if (deltaX < -180) deltaX += 360;
+
+                float startY = node->getSkewY();
+                startY = fmodf(startY, startY > 0 ? 360.f : -360.f);
+                float deltaY = y - startY;
+                if (deltaY > 180) deltaY -= 360;
+                if (deltaY < -180) deltaY += 360;
+
+                segment.from[0] = startX;
+                segment.from[1] = startY;
+                segment.delta[0] = deltaX;
+                segment.delta[1] = deltaY;
+            }
+            break;
+    }
+}
+
+void CCBTimeline::updateSegment(Segment &segment, float time)
+{
+    Node *node = segment.node;
+
+    switch (segment.property)
+    {
+        case Property::ROTATION:
+            node->setRotation(segment.from[0] + segment.delta[0] * time);
+            break;
+        case Property::ROTATION_X:
+            node->setRotationX(segment.from[0] + segment.delta[0] * time);
+            break;
+        case Property::ROTATION_Y:
+            node->setRotationY(segment.from[0] + segment.delta[0] * time);
+            break;
+        case Property::OPACITY:
+            dynamic_cast<RGBAProtocol*>(node)->setOpacity((GLubyte)(segment.from[0] + segment.delta[0] * time));
+            break;
+        case Property::COLOR:
+            dynamic_cast<RGBAProtocol*>(node)->setColor(Color3B((GLubyte)(segment.from[0] + segment.delta[0] * time),
+                                                                (GLubyte)(segment.from[1] + segment.delta[1] * time),
+                                                                (GLubyte)(segment.from[2] + segment.delta[2] * time)));
+            break;
+        case Property::VISIBLE:
+            // set at the end of the segment, like a DelayTime followed by Show or Hide
+            if (time >= 1)
+            {
+                node->setVisible(static_cast<CCBValue*>(segment.value)->getBoolValue());
+            }
+            break;
+        case Property::DISPLAY_FRAME:
+            if (time >= 1)
+            {
+                static_cast<Sprite*>(node)->setDisplayFrame(static_cast<SpriteFrame*>(segment.value));
+            }
+            break;
+        case Property::POSITION:
+            node->setPosition(Point(segment.from[0] + segment.delta[0] * time, segment.from[1] + segment.delta[1] * time));
+            break;
+        case Property::SCALE:
+            node->setScaleX(segment.from[0] + segment.delta[0] * time);
+            node->setScaleY(segment.from[1] + segment.delta[1] * time);
+            break;
+        case Property::SKEW:
+            node->setSkewX(segment.from[0] + segment.delta[0] * time);
+            node->setSkewY(segment.from[1] + segment.delta[1] * time);
+            break;
+    }
+}
+
+bool CCBTimeline::isDone() const
+{
+    return _completed;
+}
+
+void CCBTimeline::step(float dt)
+{
+    // same as ActionInterval::step()
+    if (_firstTick)
+    {
+        _firstTick = false;
+    }
+    else
+    {
+        _elapsed += dt;
+    }
+
+    // the segments of a property are in the order of its keyframes, so a segment starts
+    // from the end value of the previous one even when a frame skips over both
+    for (auto& segment : _segments)
+    {
+        if (segment.finished || _elapsed < segment.start)
+        {
+            continue;
+        }
+
+        if (! segment.started)
+        {
+            startSegment(segment);
+        }
+
+        float time = MIN(1, (_elapsed - segment.start) / MAX(segment.duration, FLT_EPSILON));
+        if (segment.property == Property::VISIBLE || segment.property == Property::DISPLAY_FRAME)
+        {
+            // not eased, like the Sequence actions they replace
+            updateSegment(segment, time);
+        }
+        else if (segment.instant)
+        {
+            // same as CCBEaseInstant
+            updateSegment(segment, 1);
+        }
+        else
+        {
+            updateSegment(segment, tweenfunc::ease(segment.easing, time, segment.easingParam));
+        }
+        segment.finished = (time >= 1);
+    }
+
+    if (_elapsed >= _duration && ! _completed)
+    {
+        _completed = true;
+        if (_manager)
+        {
+            // may run another sequence, which stops this timeline
+            _manager->sequenceCompleted();
+        }
+    }
+}
+
+CCBTimeline* CCBTimeline::clone() const
+{
+    auto a = new CCBTimeline(_manager, _duration);
+    a->_segments = _segments;
+    for (auto& segment : a->_segments)
+    {
+        segment.started = false;
+        segment.finished = false;
+    }
+    a->_nodes = _nodes;
+    for (auto node : a->_nodes)
+    {
+        node->retain();
+    }
+    a->autorelease();
+    return a;
+}
+
+CCBTimeline* CCBTimeline::reverse() const
+{
+    CCASSERT(false, "reverse() not supported in CCBTimeline");
+    return nullptr;
+}
+
 // Implementation of CCBAinmationManager
 
 CCBAnimationManager::CCBAnimationManager()
@@ -27,6 +478,7 @@ CCBAnimationManager::CCBAnimationManager()
 , _rootContainerSize(Size::ZERO)
 , _delegate(NULL)
 , _runningSequence(NULL)
+, _timeline(NULL)
 
 {
     init();
@@ -66,6 +518,11 @@ CCBAnimationManager::~CCBAnimationManager()
 //         node->release();
 //     }
     
+    if (_timeline)
+    {
+        _timeline->_manager = NULL;
+    }
+
     _nodeSequences->release();
     _baseValues->release();
     _sequences->release();
@@ -286,123 +743,12 @@ void CCBAnimationManager::moveAnimationsFromNode(Node* fromNode, Node* toNode) {
     }
 }
 
-// Refer to CCBReader::readKeyframe() for the real type of value
-ActionInterval* CCBAnimationManager::getAction(CCBKeyframe *pKeyframe0, CCBKeyframe *pKeyframe1, const char *propName, Node *pNode)
-{
-    float duration = pKeyframe1->getTime() - (pKeyframe0 ? pKeyframe0->getTime() : 0);
-    
-    if (strcmp(propName, "rotationX") == 0)
-    {
-        CCBValue *value = (CCBValue*)pKeyframe1->getValue();
-        return CCBRotateXTo::create(duration, value->getFloatValue());
-    }
-    else if(strcmp(propName, "rotationY") == 0)
-    {
-        CCBValue *value = (CCBValue*)pKeyframe1->getValue();
-        return CCBRotateYTo::create(duration, value->getFloatValue());
-    }
-    else if (strcmp(propName, "rotation") == 0)
-    {
-        CCBValue *value = (CCBValue*)pKeyframe1->getValue();
-        return CCBRotateTo::create(duration, value->getFloatValue());
-    } 
-    else if (strcmp(propName, "opacity") == 0)
-    {
-        CCBValue *value = (CCBValue*)pKeyframe1->getValue();
-        return FadeTo::create(duration, value->getByteValue());
-    }
-    else if (strcmp(propName, "color") == 0)
-    {
-        Color3BWapper* color = (Color3BWapper*)pKeyframe1->getValue();
-        Color3B c = color->getColor();
-        
-        return TintTo::create(duration, c.r, c.g, c.b);
-    }
-    else if (strcmp(propName, "visible") == 0)
-    {
-        CCBValue *value = (CCBValue*)pKeyframe1->getValue();
-        if (value->getBoolValue())
-        {
-            return Sequence::createWithTwoActions(DelayTime::create(duration), Show::create());
-        }
-        else 
-        {
-            return Sequence::createWithTwoActions(DelayTime::create(duration), Hide::create());
-        }
-    }
-    else if (strcmp(propName, "displayFrame") == 0)
-    {
-        return Sequence::createWithTwoActions(DelayTime::create(duration),
-                                                CCBSetSpriteFrame::create((SpriteFrame *)pKeyframe1->getValue()));
-    }
-    else if (strcmp(propName, "position") == 0)
-    {
-        // Get position type
-        Array *array = static_cast<Array*>(getBaseValue(pNode, propName));
-        CCBReader::PositionType type = (CCBReader::PositionType)((CCBValue*)array->objectAtIndex(2))->getIntValue();
-        
-        // Get relative position
-        Array *value = static_cast<Array*>(pKeyframe1->getValue());
-        float x = ((CCBValue*)value->objectAtIndex(0))->getFloatValue();
-        float y = ((CCBValue*)value->objectAtIndex(1))->getFloatValue();
-        
-        Size containerSize = getContainerSize(pNode->getParent());
-        
-        Point absPos = getAbsolutePosition(Point(x,y), type, containerSize, propName);
-        
-        return MoveTo::create(duration, absPos);
-    }
-    else if (strcmp(propName, "scale") == 0)
-    {
-        // Get position type
-        Array *array = (Array*)getBaseValue(pNode, propName);
-        CCBReader::ScaleType type = (CCBReader::ScaleType)((CCBValue*)array->objectAtIndex(2))->getIntValue();
-        
-        // Get relative scale
-        Array *value = (Array*)pKeyframe1->getValue();
-        float x = ((CCBValue*)value->objectAtIndex(0))->getFloatValue();
-        float y = ((CCBValue*)value->objectAtIndex(1))->getFloatValue();
-        
-        if (type == CCBReader::ScaleType::MULTIPLY_RESOLUTION)
-        {
-            float resolutionScale = CCBReader::getResolutionScale();
-            x *= resolutionScale;
-            y *= resolutionScale;
-        }
-        
-        return ScaleTo::create(duration, x, y);
-    }
-    else if(strcmp(propName, "skew") == 0) 
-    {
-        // Get relative skew
-        Array *value = (Array*)pKeyframe1->getValue();
-        float x = ((CCBValue*)value->objectAtIndex(0))->getFloatValue();
-        float y = ((CCBValue*)value->objectAtIndex(1))->getFloatValue();
-        
-        return SkewTo::create(duration, x, y);
-    }
-    else 
-    {
-        log("CCBReader: Failed to create animation for property: %s", propName);
-    }
-    
-    return NULL;
-}
-
 void CCBAnimationManager::setAnimatedProperty(const char *propName, Node *pNode, Object *pValue, float fTweenDuration)
 {
     if (fTweenDuration > 0)
     {
-        // Create a fake keyframe to generate the action from
-        CCBKeyframe *kf1 = new CCBKeyframe();
-        kf1->autorelease();
-        kf1->setValue(pValue);
-        kf1->setTime(fTweenDuration);
-        kf1->setEasingType(CCBKeyframe::EasingType::LINEAR);
-        
         // Animate
-        ActionInterval *tweenAction = getAction(NULL, kf1, propName, pNode);
-        pNode->runAction(tweenAction);
+        _timeline->addSegment(pNode, propName, 0, fTweenDuration, CCBKeyframe::EasingType::LINEAR, 0, pValue);
     }
     else 
     {
@@ -509,76 +855,6 @@ void CCBAnimationManager::setFirstFrame(Node *pNode, CCBSequenceProperty *pSeqPr
     }
 }
 
-ActionInterval* CCBAnimationManager::getEaseAction(ActionInterval *pAction, CCBKeyframe::EasingType easingType, float fEasingOpt)
-{
-    if (dynamic_cast<Sequence*>(pAction))
-    {
-        return pAction;
-    }
-    
-    if (easingType == CCBKeyframe::EasingType::LINEAR)
-    {
-        return pAction;
-    }
-    else if (easingType == CCBKeyframe::EasingType::INSTANT)
-    {
-        return CCBEaseInstant::create(pAction);
-    }
-    else if (easingType == CCBKeyframe::EasingType::CUBIC_IN)
-    {
-        return EaseIn::create(pAction, fEasingOpt);
-    }
-    else if (easingType == CCBKeyframe::EasingType::CUBIC_OUT)
-    {
-        return EaseOut::create(pAction, fEasingOpt);
-    }
-    else if (easingType == CCBKeyframe::EasingType::CUBIC_INOUT)
-    {
-        return EaseInOut::create(pAction, fEasingOpt);
-    }
-    else if (easingType == CCBKeyframe::EasingType::BACK_IN)
-    {
-        return EaseBackIn::create(pAction);
-    }
-    else if (easingType == CCBKeyframe::EasingType::BACK_OUT)
-    {
-        return EaseBackOut::create(pAction);
-    }
-    else if (easingType == CCBKeyframe::EasingType::BACK_INOUT)
-    {
-        return EaseBackInOut::create(pAction);
-    }
-    else if (easingType == CCBKeyframe::EasingType::BOUNCE_IN)
-    {
-        return EaseBounceIn::create(pAction);
-    }
-    else if (easingType == CCBKeyframe::EasingType::BOUNCE_OUT)
-    {
-        return EaseBounceOut::create(pAction);
-    }
-    else if (easingType == CCBKeyframe::EasingType::BOUNCE_INOUT)
-    {
-        return EaseBounceInOut::create(pAction);
-    }
-    else if (easingType == CCBKeyframe::EasingType::ELASTIC_IN)
-    {
-        return EaseElasticIn::create(pAction, fEasingOpt);
-    }
-    else if (easingType == CCBKeyframe::EasingType::ELASTIC_OUT)
-    {
-        return EaseElasticOut::create(pAction, fEasingOpt);
-    }
-    else if (easingType == CCBKeyframe::EasingType::ELASTIC_INOUT)
-    {
-        return EaseElasticInOut::create(pAction, fEasingOpt);
-    }
-    else
-    {
-        log("CCBReader: Unkown easing type %d", easingType);
-        return pAction;
-    }
-}
-
 Object* CCBAnimationManager::actionForCallbackChannel(CCBSequenceProperty* channel) {
   
     float lastKeyframeTime = 0;
@@ -705,33 +981,14 @@ void CCBAnimationManager::runAction(Node *pNode, CCBSequenceProperty *pSeqProp,
     if (numKeyframes > 1)
     {
         // Make an animation!
-        Array *actions = Array::create();
-        
-        CCBKeyframe *keyframeFirst = (CCBKeyframe*)keyframes->objectAtIndex(0);
-        float timeFirst = keyframeFirst->getTime() + fTweenDuration;
-        
-        if (timeFirst > 0)
-        {
-            actions->addObject(DelayTime::create(timeFirst));
-        }
-        
         for (int i = 0; i < numKeyframes - 1; ++i)
         {
             CCBKeyframe *kf0 = (CCBKeyframe*)keyframes->objectAtIndex(i);
             CCBKeyframe *kf1 = (CCBKeyframe*)keyframes->objectAtIndex(i+1);
             
-            ActionInterval *action = getAction(kf0, kf1, pSeqProp->getName(), pNode);
-            if (action)
-            {
-                // Apply easing
-                action = getEaseAction(action, kf0->getEasingType(), kf0->getEasingOpt());
-                
-                actions->addObject(action);
-            }
+            _timeline->addSegment(pNode, pSeqProp->getName(), kf0->getTime() + fTweenDuration, kf1->getTime() - kf0->getTime(),
+                                  kf0->getEasingType(), kf0->getEasingOpt(), kf1->getValue());
         }
-        
-        FiniteTimeAction *seq = Sequence::create(actions);
-        pNode->runAction(seq);
     }
 }
 
@@ -755,6 +1012,11 @@ void CCBAnimationManager::runAnimationsForSequenceIdTweenDuration(int nSeqId, fl
     CCASSERT(nSeqId != -1, "Sequence id couldn't be found");
     
     _rootNode->stopAllActions();
+
+    // The keyframes of all the nodes are evaluated by one timeline, run by the root node
+    CCBSequence *seq = getSequence(nSeqId);
+    CCBTimeline *timeline = new CCBTimeline(this, seq->getDuration() + fTweenDuration);
+    _timeline = timeline;
     
     DictElement* pElement = NULL;
     CCDICT_FOREACH(_nodeSequences, pElement)
@@ -803,11 +1065,9 @@ void CCBAnimationManager::runAnimationsForSequenceIdTweenDuration(int nSeqId, fl
         }
     }
     
-    // Make callback at end of sequence
-    CCBSequence *seq = getSequence(nSeqId);
-    Action *completeAction = Sequence::createWithTwoActions(DelayTime::create(seq->getDuration() + fTweenDuration),
-                                                                CallFunc::create( CC_CALLBACK_0(CCBAnimationManager::sequenceCompleted,this)));
-    _rootNode->runAction(completeAction);
+    // The timeline makes the callback at end of sequence
+    _rootNode->runAction(timeline);
+    timeline->release();
     
     // Set the running scene
 
@@ -825,7 +1085,7 @@ void CCBAnimationManager::runAnimationsForSequenceIdTweenDuration(int nSeqId, fl
         }
     }
 
-    _runningSequence = getSequence(nSeqId);
+    _runningSequence = seq;
 }
 
 void CCBAnimationManager::runAnimationsForSequenceNamedTweenDuration(const char *pName, float fTweenDuration)
@@ -9,6 +9,8 @@
 
 NS_CC_EXT_BEGIN
 
+class CCBTimeline;
+
 class CCBAnimationManagerDelegate
 {
 public:
@@ -92,12 +94,12 @@ private:
     Object* getBaseValue(Node *pNode, const char* propName);
     int getSequenceId(const char* pSequenceName);
     CCBSequence* getSequence(int nSequenceId);
-    ActionInterval* getAction(CCBKeyframe *pKeyframe0, CCBKeyframe *pKeyframe1, const char *propName, Node *pNode);
     void setAnimatedProperty(const char *propName, Node *pNode, Object *pValue, float fTweenDuraion);
     void setFirstFrame(Node *pNode, CCBSequenceProperty *pSeqProp, float fTweenDuration);
-    ActionInterval* getEaseAction(ActionInterval *pAction, CCBKeyframe::EasingType easingType, float fEasingOpt);
     void runAction(Node *pNode, CCBSequenceProperty *pSeqProp, float fTweenDuration);
     void sequenceCompleted();
+
+    friend class CCBTimeline;
     
 private:
     Array *_sequences;
@@ -111,6 +113,8 @@ private:
     
     CCBAnimationManagerDelegate *_delegate;
     CCBSequence *_runningSequence;
+    // weak reference, the timeline of the running sequence while it runs
+    CCBTimeline *_timeline;
     
     Array *_documentOutletNames;
     Array *_documentOutletNodes;
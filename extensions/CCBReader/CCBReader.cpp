@@ -13,6 +13,7 @@
 #include "CCBValue.h"
 
 #include <ctype.h>
+#include <unordered_map>
 
 using namespace std;
 
@@ -48,6 +49,122 @@ void CCBFile::setCCBFileNode(Node *pNode)
     CC_SAFE_RETAIN(_CCBFileNode);
 }
 
+/*************************************************************************
+ Implementation of CCBTemplate
+ *************************************************************************/
+
+/* The values read from a file in the order they were read, and the node loaders of its nodes. */
+class CCBTemplate : public Object
+{
+public:
+    union Value
+    {
+        int i;
+        float f;
+    };
+
+    CCBTemplate() : nodeLoaderLibrary(NULL) {}
+    ~CCBTemplate() { CC_SAFE_RELEASE(nodeLoaderLibrary); }
+
+    std::vector<Value> values;
+    // strings read with readUTF8(), values holds their index
+    std::vector<std::string> strings;
+    // node loaders found in nodeLoaderLibrary, in the order of the nodes
+    std::vector<NodeLoader*> nodeLoaders;
+    NodeLoaderLibrary *nodeLoaderLibrary;
+};
+
+static bool s_templateCacheEnabled = false;
+static std::unordered_map<std::string, CCBTemplate*> s_templates;
+
+/*************************************************************************
+ Implementation of CCBLazyChildren
+ *************************************************************************/
+
+/* Where the children of a lazy node are, and what reading them needs. */
+class CCBLazyChildren : public Object
+{
+public:
+    CCBLazyChildren()
+    : node(NULL)
+    , data(NULL)
+    , ccbTemplate(NULL)
+    , owner(NULL)
+    , actionManager(NULL)
+    , nodeLoaderLibrary(NULL)
+    {}
+
+    ~CCBLazyChildren()
+    {
+        CC_SAFE_RELEASE(node);
+        CC_SAFE_RELEASE(data);
+        CC_SAFE_RELEASE(ccbTemplate);
+        CC_SAFE_RELEASE(actionManager);
+        CC_SAFE_RELEASE(nodeLoaderLibrary);
+    }
+
+    Node *node;
+    Data *data;
+    // replayed instead of data if the file was read from a template
+    CCBTemplate *ccbTemplate;
+    int currentByte;
+    int currentBit;
+    unsigned int templateValue;
+    unsigned int templateNode;
+
+    std::vector<std::string> stringCache;
+    std::string CCBRootPath;
+    bool jsControlled;
+
+    // weak reference, as in CCBAnimationManager
+    Object *owner;
+    CCBAnimationManager *actionManager;
+    NodeLoaderLibrary *nodeLoaderLibrary;
+    NodeLoaderListener *nodeLoaderListener;
+    CCBMemberVariableAssigner *memberVariableAssigner;
+    CCBSelectorResolver *selectorResolver;
+};
+
+/* Reads the children of the lazy nodes that became visible, after the other updates. */
+class CCBLazyChildrenLoader : public Object
+{
+public:
+    virtual void update(float dt) override;
+};
+
+static std::vector<CCBLazyChildren*> s_lazyChildren;
+static CCBLazyChildrenLoader *s_lazyChildrenLoader = NULL;
+
+void CCBLazyChildrenLoader::update(float dt)
+{
+    // reading children can add lazy children
+    for (size_t i = 0; i < s_lazyChildren.size(); )
+    {
+        Node *node = s_lazyChildren[i]->node;
+        if (node->retainCount() == 1)
+        {
+            // nothing but the lazy children holds the node anymore
+            s_lazyChildren[i]->release();
+            s_lazyChildren.erase(s_lazyChildren.begin() + i);
+        }
+        else if (node->isVisible())
+        {
+            CCBReader::loadLazyChildren(node);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    if (s_lazyChildren.empty())
+    {
+        Director::getInstance()->getScheduler()->unscheduleUpdateForTarget(this);
+        s_lazyChildrenLoader = NULL;
+        this->release();
+    }
+}
+
 /*************************************************************************
  Implementation of CCBReader
  *************************************************************************/
@@ -57,6 +174,11 @@ CCBReader::CCBReader(NodeLoaderLibrary * pNodeLoaderLibrary, CCBMemberVariableAs
 , _bytes(NULL)
 , _currentByte(-1)
 , _currentBit(-1)
+, _template(NULL)
+, _replaying(false)
+, _templateValue(0)
+, _templateNode(0)
+, _lazyNode(NULL)
 , _owner(NULL)
 , _actionManager(NULL)
 , _actionManagers(NULL)
@@ -80,6 +202,11 @@ CCBReader::CCBReader(CCBReader * ccbReader)
 , _bytes(NULL)
 , _currentByte(-1)
 , _currentBit(-1)
+, _template(NULL)
+, _replaying(false)
+, _templateValue(0)
+, _templateNode(0)
+, _lazyNode(NULL)
 , _owner(NULL)
 , _actionManager(NULL)
 , _actionManagers(NULL)
@@ -115,6 +242,11 @@ CCBReader::CCBReader()
 , _bytes(NULL)
 , _currentByte(-1)
 , _currentBit(-1)
+, _template(NULL)
+, _replaying(false)
+, _templateValue(0)
+, _templateNode(0)
+, _lazyNode(NULL)
 , _owner(NULL)
 , _actionManager(NULL)
 , _actionManagers(NULL)
@@ -132,6 +264,10 @@ CCBReader::CCBReader()
 CCBReader::~CCBReader() {
     CC_SAFE_RELEASE_NULL(_owner);
     CC_SAFE_RELEASE_NULL(_data);
+    if (! _replaying)
+    {
+        CC_SAFE_RELEASE(_template);
+    }
 
     this->_nodeLoaderLibrary->release();
 
@@ -244,24 +380,34 @@ Node* CCBReader::readNodeGraphFromFile(const char *pCCBFileName, Object *pOwner,
     }
 
     std::string strPath = FileUtils::getInstance()->fullPathForFilename(strCCBFileName.c_str());
-    unsigned long size = 0;
 
-    unsigned char * pBytes = FileUtils::getInstance()->getFileData(strPath.c_str(), "rb", &size);
-    Data *data = new Data(pBytes, size);
-    CC_SAFE_DELETE_ARRAY(pBytes);
+    Node *ret = NULL;
+    if (openTemplate(strPath))
+    {
+        ret = this->readNodeGraphFromData(NULL, pOwner, parentSize);
+    }
+    else
+    {
+        unsigned long size = 0;
 
-    Node *ret =  this->readNodeGraphFromData(data, pOwner, parentSize);
-    
-    data->release();
+        unsigned char * pBytes = FileUtils::getInstance()->getFileData(strPath.c_str(), "rb", &size);
+        Data *data = new Data(pBytes, size);
+        CC_SAFE_DELETE_ARRAY(pBytes);
+
+        ret = this->readNodeGraphFromData(data, pOwner, parentSize);
+
+        data->release();
+    }
+    closeTemplate(strPath, ret != NULL);
     
     return ret;
 }
 
 Node* CCBReader::readNodeGraphFromData(Data *pData, Object *pOwner, const Size &parentSize)
 {
-   _data = pData;
+    _data = pData;
     CC_SAFE_RETAIN(_data);
-    _bytes =_data->getBytes();
+    _bytes = _data ? _data->getBytes() : NULL;
     _currentByte = 0;
     _currentBit = 0;
     _owner = pOwner;
@@ -326,10 +472,9 @@ void CCBReader::cleanUpNodeGraph(Node *pNode)
 {
     pNode->setUserObject(NULL);
     
-    Object *pChild = NULL;
-    CCARRAY_FOREACH(pNode->getChildren(), pChild)
+    for (auto child : pNode->getChildren())
     {
-        cleanUpNodeGraph(static_cast<Node*>(pChild));
+        cleanUpNodeGraph(child);
     }
 }
 
@@ -376,17 +521,20 @@ bool CCBReader::readStringCache() {
 
 bool CCBReader::readHeader()
 {
-    /* If no bytes loaded, don't crash about it. */
-    if(this->_bytes == NULL) {
-        return false;
-    }
+    /* A replayed template was checked when it was recorded. */
+    if(! _replaying) {
+        /* If no bytes loaded, don't crash about it. */
+        if(this->_bytes == NULL) {
+            return false;
+        }
 
-    /* Read magic bytes */
-    int magicBytes = *((int*)(this->_bytes + this->_currentByte));
-    this->_currentByte += 4;
+        /* Read magic bytes */
+        int magicBytes = *((int*)(this->_bytes + this->_currentByte));
+        this->_currentByte += 4;
 
-    if(CC_SWAP_INT32_LITTLE_TO_HOST(magicBytes) != 'ccbi') {
-        return false; 
+        if(CC_SWAP_INT32_LITTLE_TO_HOST(magicBytes) != 'ccbi') {
+            return false; 
+        }
     }
 
     /* Read version. */
@@ -404,6 +552,24 @@ bool CCBReader::readHeader()
 }
 
 unsigned char CCBReader::readByte()
+{
+    if (_replaying)
+    {
+        CCASSERT(_templateValue < _template->values.size(), "the node loaders read more values than the template has");
+        return _template->values[_templateValue++].i;
+    }
+
+    unsigned char byte = decodeByte();
+    if (_template)
+    {
+        CCBTemplate::Value value;
+        value.i = byte;
+        _template->values.push_back(value);
+    }
+    return byte;
+}
+
+unsigned char CCBReader::decodeByte()
 {
     unsigned char byte = this->_bytes[this->_currentByte];
     this->_currentByte++;
@@ -417,10 +583,16 @@ bool CCBReader::readBool()
 
 std::string CCBReader::readUTF8()
 {
+    if (_replaying)
+    {
+        CCASSERT(_templateValue < _template->values.size(), "the node loaders read more values than the template has");
+        return _template->strings[_template->values[_templateValue++].i];
+    }
+
     std::string ret;
 
-    int b0 = this->readByte();
-    int b1 = this->readByte();
+    int b0 = this->decodeByte();
+    int b1 = this->decodeByte();
 
     int numBytes = b0 << 8 | b1;
 
@@ -432,6 +604,14 @@ std::string CCBReader::readUTF8()
 
     _currentByte += numBytes;
 
+    if (_template)
+    {
+        CCBTemplate::Value value;
+        value.i = _template->strings.size();
+        _template->values.push_back(value);
+        _template->strings.push_back(ret);
+    }
+
     return ret;
 }
 
@@ -462,6 +642,23 @@ void CCBReader::alignBits() {
 }
 
 int CCBReader::readInt(bool pSigned) {
+    if (_replaying)
+    {
+        CCASSERT(_templateValue < _template->values.size(), "the node loaders read more values than the template has");
+        return _template->values[_templateValue++].i;
+    }
+
+    int num = decodeInt(pSigned);
+    if (_template)
+    {
+        CCBTemplate::Value value;
+        value.i = num;
+        _template->values.push_back(value);
+    }
+    return num;
+}
+
+int CCBReader::decodeInt(bool pSigned) {
     // Read encoded int
     int numBits = 0;
     while(!this->getBit()) {
@@ -496,27 +693,38 @@ int CCBReader::readInt(bool pSigned) {
 
 float CCBReader::readFloat()
 {
-    FloatType type = static_cast<FloatType>(this->readByte());
+    if (_replaying)
+    {
+        CCASSERT(_templateValue < _template->values.size(), "the node loaders read more values than the template has");
+        return _template->values[_templateValue++].f;
+    }
+
+    float f = 0;
+    FloatType type = static_cast<FloatType>(this->decodeByte());
     
     switch (type)
     {
         case FloatType::_0:
-            return 0;    
+            f = 0;
+            break;
         case FloatType::_1:
-            return 1;
+            f = 1;
+            break;
         case FloatType::MINUS1:
-            return -1;
+            f = -1;
+            break;
         case FloatType::_05:
-            return 0.5f;
+            f = 0.5f;
+            break;
         case FloatType::INTEGER:
-            return (float)this->readInt(true);
+            f = (float)this->decodeInt(true);
+            break;
         default:
             {
                 /* using a memcpy since the compiler isn't
                  * doing the float ptr math correctly on device.
                  * TODO still applies in C++ ? */
                 unsigned char* pF = (this->_bytes + this->_currentByte);
-                float f = 0;
                 
                 // N.B - in order to avoid an unaligned memory access crash on 'memcpy()' the the (void*) casts of the source and
                 // destination pointers are EXTREMELY important for the ARM compiler.
@@ -532,12 +740,20 @@ float CCBReader::readFloat()
                 memcpy((void*) &f, (const void*) pF, sizeof(float));
                 
                 this->_currentByte += sizeof(float);
-                return f;
+                break;
             }
     }
+
+    if (_template)
+    {
+        CCBTemplate::Value value;
+        value.f = f;
+        _template->values.push_back(value);
+    }
+    return f;
 }
 
-std::string CCBReader::readCachedString()
+const std::string& CCBReader::readCachedString()
 {
     int n = this->readInt(false);
     return this->_stringCache[n];
@@ -562,7 +778,7 @@ Node * CCBReader::readNodeGraph(Node * pParent)
         memberVarAssignmentName = this->readCachedString();
     }
     
-    NodeLoader *ccNodeLoader = this->_nodeLoaderLibrary->getNodeLoader(className.c_str());
+    NodeLoader *ccNodeLoader = findNodeLoader(className);
      
     if (! ccNodeLoader)
     {
@@ -626,7 +842,10 @@ Node * CCBReader::readNodeGraph(Node * pParent)
     }
     
     // Read properties
+    _lazyNode = NULL;
     ccNodeLoader->parseProperties(node, pParent, this);
+    bool isLazy = (_lazyNode == node && ! node->isVisible());
+    _lazyNode = NULL;
     
     bool isCCBFileNode = (NULL == dynamic_cast<CCBFile*>(node)) ? false : true;
     // Handle sub ccb files (remove middle node)
@@ -740,10 +959,17 @@ Node * CCBReader::readNodeGraph(Node * pParent)
     _animatedProps = NULL;
 
     /* Read and add children. */
-    int numChildren = this->readInt(false);
-    for(int i = 0; i < numChildren; i++) {
-        Node * child = this->readNodeGraph(node);
-        node->addChild(child);
+    if (isLazy)
+    {
+        readLazyChildren(node);
+    }
+    else
+    {
+        int numChildren = this->readInt(false);
+        for(int i = 0; i < numChildren; i++) {
+            Node * child = this->readNodeGraph(node);
+            node->addChild(child);
+        }
     }
 
     // FIX ISSUE #1860: "onNodeLoaded will be called twice if ccb was added as a CCBFile".
@@ -761,6 +987,248 @@ Node * CCBReader::readNodeGraph(Node * pParent)
     return node;
 }
 
+NodeLoader* CCBReader::findNodeLoader(const std::string& className)
+{
+    if (_replaying)
+    {
+        CCASSERT(_templateNode < _template->nodeLoaders.size(), "the template has less nodes than read");
+        NodeLoader *nodeLoader = _template->nodeLoaders[_templateNode++];
+        if (_template->nodeLoaderLibrary == _nodeLoaderLibrary)
+        {
+            return nodeLoader;
+        }
+        return _nodeLoaderLibrary->getNodeLoader(className.c_str());
+    }
+
+    NodeLoader *nodeLoader = _nodeLoaderLibrary->getNodeLoader(className.c_str());
+    if (_template)
+    {
+        _template->nodeLoaders.push_back(nodeLoader);
+    }
+    return nodeLoader;
+}
+
+void CCBReader::readLazyChildren(Node *pNode)
+{
+    CCBLazyChildren *lazy = new CCBLazyChildren();
+    lazy->node = pNode;
+    pNode->retain();
+    lazy->data = _data;
+    CC_SAFE_RETAIN(_data);
+    if (_replaying)
+    {
+        lazy->ccbTemplate = _template;
+        _template->retain();
+    }
+    lazy->currentByte = _currentByte;
+    lazy->currentBit = _currentBit;
+    lazy->templateValue = _templateValue;
+    lazy->templateNode = _templateNode;
+    lazy->stringCache = _stringCache;
+    lazy->CCBRootPath = _CCBRootPath;
+    lazy->jsControlled = _jsControlled;
+    lazy->owner = _owner;
+    lazy->actionManager = _actionManager;
+    _actionManager->retain();
+    lazy->nodeLoaderLibrary = _nodeLoaderLibrary;
+    _nodeLoaderLibrary->retain();
+    lazy->nodeLoaderListener = _nodeLoaderListener;
+    lazy->memberVariableAssigner = _CCBMemberVariableAssigner;
+    lazy->selectorResolver = _CCBSelectorResolver;
+    s_lazyChildren.push_back(lazy);
+
+    if (! s_lazyChildrenLoader)
+    {
+        s_lazyChildrenLoader = new CCBLazyChildrenLoader();
+        Director::getInstance()->getScheduler()->scheduleUpdateForTarget(s_lazyChildrenLoader, INT_MAX, false);
+    }
+
+    int numChildren = this->readInt(false);
+    for(int i = 0; i < numChildren; i++) {
+        skipNodeGraph();
+    }
+}
+
+void CCBReader::skipNodeGraph()
+{
+    // Same reads as readNodeGraph(), but nothing is created
+    const std::string& className = this->readCachedString();
+    if(_jsControlled) {
+        this->readCachedString();
+    }
+
+    TargetType memberVarAssignmentType = static_cast<TargetType>(this->readInt(false));
+    if(memberVarAssignmentType != TargetType::NONE)
+    {
+        this->readCachedString();
+    }
+
+    // keeps the node loaders of the template in the order of the nodes
+    findNodeLoader(className);
+
+    int numSequence = readInt(false);
+    for (int i = 0; i < numSequence; ++i)
+    {
+        readInt(false);
+        int numProps = readInt(false);
+        for (int j = 0; j < numProps; ++j)
+        {
+            readCachedString();
+            PropertyType type = static_cast<PropertyType>(readInt(false));
+            int numKeyframes = readInt(false);
+            for (int k = 0; k < numKeyframes; ++k)
+            {
+                skipKeyframe(type);
+            }
+        }
+    }
+
+    int numRegularProps = readInt(false);
+    int numExtraProps = readInt(false);
+    for (int i = 0; i < numRegularProps + numExtraProps; ++i)
+    {
+        PropertyType type = static_cast<PropertyType>(readInt(false));
+        readCachedString();
+        readByte();
+        skipPropertyValue(type);
+    }
+
+    int numChildren = this->readInt(false);
+    for(int i = 0; i < numChildren; i++) {
+        skipNodeGraph();
+    }
+}
+
+void CCBReader::skipKeyframe(PropertyType type)
+{
+    readFloat();
+
+    CCBKeyframe::EasingType easingType = static_cast<CCBKeyframe::EasingType>(readInt(false));
+    if (easingType == CCBKeyframe::EasingType::CUBIC_IN
+        || easingType == CCBKeyframe::EasingType::CUBIC_OUT
+        || easingType == CCBKeyframe::EasingType::CUBIC_INOUT
+        || easingType == CCBKeyframe::EasingType::ELASTIC_IN
+        || easingType == CCBKeyframe::EasingType::ELASTIC_OUT
+        || easingType == CCBKeyframe::EasingType::ELASTIC_INOUT)
+    {
+        readFloat();
+    }
+
+    switch (type)
+    {
+        case PropertyType::CHECK:
+            readBool();
+            break;
+        case PropertyType::BYTE:
+            readByte();
+            break;
+        case PropertyType::COLOR3:
+            readByte();
+            readByte();
+            readByte();
+            break;
+        case PropertyType::DEGREES:
+            readFloat();
+            break;
+        case PropertyType::SCALE_LOCK:
+        case PropertyType::POSITION:
+        case PropertyType::FLOAT_XY:
+            readFloat();
+            readFloat();
+            break;
+        case PropertyType::SPRITEFRAME:
+            readCachedString();
+            readCachedString();
+            break;
+        default:
+            break;
+    }
+}
+
+void CCBReader::skipPropertyValue(PropertyType type)
+{
+    // Same reads as the NodeLoader::parsePropType methods
+    switch (type)
+    {
+        case PropertyType::POSITION:
+        case PropertyType::SIZE:
+        case PropertyType::SCALE_LOCK:
+            readFloat();
+            readFloat();
+            readInt(false);
+            break;
+        case PropertyType::POINT:
+        case PropertyType::POINT_LOCK:
+        case PropertyType::FLOAT_XY:
+        case PropertyType::FLOAT_VAR:
+            readFloat();
+            readFloat();
+            break;
+        case PropertyType::FLOAT:
+        case PropertyType::DEGREES:
+            readFloat();
+            break;
+        case PropertyType::FLOAT_SCALE:
+            readFloat();
+            readInt(false);
+            break;
+        case PropertyType::INTEGER:
+        case PropertyType::INTEGER_LABELED:
+            readInt(true);
+            break;
+        case PropertyType::CHECK:
+            readBool();
+            break;
+        case PropertyType::BYTE:
+            readByte();
+            break;
+        case PropertyType::COLOR3:
+            readByte();
+            readByte();
+            readByte();
+            break;
+        case PropertyType::COLOR4F_VAR:
+            for (int i = 0; i < 8; ++i)
+            {
+                readFloat();
+            }
+            break;
+        case PropertyType::FLIP:
+            readBool();
+            readBool();
+            break;
+        case PropertyType::BLEND_MODE:
+            readInt(false);
+            readInt(false);
+            break;
+        case PropertyType::SPRITEFRAME:
+        case PropertyType::ANIMATION:
+            readCachedString();
+            readCachedString();
+            break;
+        case PropertyType::TEXTURE:
+        case PropertyType::FNT_FILE:
+        case PropertyType::TEXT:
+        case PropertyType::FONT_TTF:
+        case PropertyType::STRING:
+        case PropertyType::CCB_FILE:
+            readCachedString();
+            break;
+        case PropertyType::BLOCK:
+            readCachedString();
+            readInt(false);
+            break;
+        case PropertyType::BLOCK_CONTROL:
+            readCachedString();
+            readInt(false);
+            readInt(false);
+            break;
+        default:
+            ASSERT_FAIL_UNEXPECTED_PROPERTYTYPE(type);
+            break;
+    }
+}
+
 CCBKeyframe* CCBReader::readKeyframe(PropertyType type)
 {
     CCBKeyframe *keyframe = new CCBKeyframe();
@@ -1079,4 +1547,127 @@ void CCBReader::setResolutionScale(float scale)
     __ccbResolutionScale = scale;
 }
 
+void CCBReader::setTemplateCacheEnabled(bool enabled)
+{
+    s_templateCacheEnabled = enabled;
+    if (! enabled)
+    {
+        purgeTemplateCache();
+    }
+}
+
+bool CCBReader::isTemplateCacheEnabled()
+{
+    return s_templateCacheEnabled;
+}
+
+void CCBReader::purgeTemplateCache()
+{
+    for (auto& iter : s_templates)
+    {
+        iter.second->release();
+    }
+    s_templates.clear();
+}
+
+bool CCBReader::loadLazyChildren(Node *pNode)
+{
+    auto iter = std::find_if(s_lazyChildren.begin(), s_lazyChildren.end(), [pNode](CCBLazyChildren *lazy) {
+        return lazy->node == pNode;
+    });
+    if (iter == s_lazyChildren.end())
+    {
+        return false;
+    }
+    CCBLazyChildren *lazy = *iter;
+    s_lazyChildren.erase(iter);
+
+    CCBReader *reader = new CCBReader(lazy->nodeLoaderLibrary, lazy->memberVariableAssigner, lazy->selectorResolver, lazy->nodeLoaderListener);
+    reader->_data = lazy->data;
+    CC_SAFE_RETAIN(reader->_data);
+    reader->_bytes = lazy->data ? lazy->data->getBytes() : NULL;
+    reader->_currentByte = lazy->currentByte;
+    reader->_currentBit = lazy->currentBit;
+    if (lazy->ccbTemplate)
+    {
+        reader->_template = lazy->ccbTemplate;
+        reader->_replaying = true;
+        reader->_templateValue = lazy->templateValue;
+        reader->_templateNode = lazy->templateNode;
+    }
+    reader->_stringCache = lazy->stringCache;
+    reader->_CCBRootPath = lazy->CCBRootPath;
+    reader->_jsControlled = lazy->jsControlled;
+    reader->_owner = lazy->owner;
+    CC_SAFE_RETAIN(reader->_owner);
+    reader->setAnimationManager(lazy->actionManager);
+    reader->_ownerOutletNodes = new Array();
+    reader->_ownerCallbackNodes = new Array();
+
+    Dictionary* animationManagers = Dictionary::create();
+    reader->setAnimationManagers(animationManagers);
+
+    int numChildren = reader->readInt(false);
+    for(int i = 0; i < numChildren; i++) {
+        Node * child = reader->readNodeGraph(pNode);
+        pNode->addChild(child);
+    }
+
+    DictElement* pElement = NULL;
+    CCDICT_FOREACH(animationManagers, pElement)
+    {
+        Node* node = (Node*)pElement->getIntKey();
+        node->setUserObject(pElement->getObject());
+    }
+
+    reader->_template = NULL;
+    reader->_replaying = false;
+    reader->release();
+    lazy->release();
+    return true;
+}
+
+bool CCBReader::openTemplate(const std::string& path)
+{
+    CCASSERT(_template == NULL, "a CCBReader reads one file");
+
+    if (! s_templateCacheEnabled)
+    {
+        return false;
+    }
+
+    auto iter = s_templates.find(path);
+    if (iter != s_templates.end())
+    {
+        _template = iter->second;
+        _replaying = true;
+        _templateValue = 0;
+        _templateNode = 0;
+        return true;
+    }
+
+    _template = new CCBTemplate();
+    _template->nodeLoaderLibrary = _nodeLoaderLibrary;
+    CC_SAFE_RETAIN(_nodeLoaderLibrary);
+    return false;
+}
+
+void CCBReader::closeTemplate(const std::string& path, bool read)
+{
+    if (_template && ! _replaying)
+    {
+        // another reader may have recorded the file meanwhile
+        if (read && s_templates.find(path) == s_templates.end())
+        {
+            s_templates[path] = _template;
+        }
+        else
+        {
+            _template->release();
+        }
+    }
+    _template = NULL;
+    _replaying = false;
+}
+
 NS_CC_EXT_END;
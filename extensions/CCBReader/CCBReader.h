@@ -59,6 +59,7 @@ class CCBMemberVariableAssigner;
 class CCBSelectorResolver;
 class CCBAnimationManager;
 class CCBKeyframe;
+class CCBTemplate;
 
 /**
  * @brief Parse CCBI file which is generated by CocosBuilder
@@ -185,7 +186,7 @@ public:
     bool readBool();
     std::string readUTF8();
     float readFloat();
-    std::string readCachedString();
+    const std::string& readCachedString();
     bool isJSControlled();
             
     
@@ -212,6 +213,23 @@ public:
     
     static float getResolutionScale();
     static void setResolutionScale(float scale);
+
+    /** When the template cache is enabled, a file read by readNodeGraphFromFile() is only decoded the first time:
+     the values read from it and the node loaders of its nodes are kept as a template, and the next reads of the file
+     replay the template instead of reading the file. The node loaders must read the same values each time they
+     parse the properties of a node. Disabled by default.
+     */
+    static void setTemplateCacheEnabled(bool enabled);
+    static bool isTemplateCacheEnabled();
+    /** releases the templates of the files read so far, e.g. when the files changed or other node loaders were registered */
+    static void purgeTemplateCache();
+
+    /** Reads the children of a node whose "ccbLazy" custom property is checked and that is invisible once its properties
+     are read. Those children are skipped when the file is read, and read when the node becomes visible, before it is
+     drawn, or when this method is called. As for the animation manager, the owner must outlive the node.
+     Returns false if the node has no children left to read.
+     */
+    static bool loadLazyChildren(Node *pNode);
     
     Node* readFileWithCleanUp(bool bCleanUp, Dictionary* am);
     
@@ -231,6 +249,20 @@ private:
 
     bool getBit();
     void alignBits();
+    unsigned char decodeByte();
+    int decodeInt(bool pSigned);
+
+    /* Replays the template of the file if it is cached, otherwise starts recording it and returns false. */
+    bool openTemplate(const std::string& path);
+    /* Caches the template recorded by openTemplate() if the file was read. */
+    void closeTemplate(const std::string& path, bool read);
+
+    NodeLoader* findNodeLoader(const std::string& className);
+    /* Keeps the position of the children of a lazy node, then skips them. */
+    void readLazyChildren(Node *pNode);
+    void skipNodeGraph();
+    void skipKeyframe(PropertyType type);
+    void skipPropertyValue(PropertyType type);
 
     friend class NodeLoader;
 
@@ -239,6 +271,13 @@ private:
     unsigned char *_bytes;
     int _currentByte;
     int _currentBit;
+
+    CCBTemplate *_template;
+    bool _replaying;
+    unsigned int _templateValue;
+    unsigned int _templateNode;
+    // node whose "ccbLazy" property is checked, set while its properties are parsed
+    Node *_lazyNode;
     
     std::vector<std::string> _stringCache;
     std::set<std::string> _loadedSpriteSheets;
@@ -39,7 +39,7 @@ void NodeLoader::parseProperties(Node * pNode, Node * pParent, CCBReader * ccbRe
     for(int i = 0; i < propertyCount; i++) {
         bool isExtraProp = (i >= numRegularProps);
         CCBReader::PropertyType type = (CCBReader::PropertyType)ccbReader->readInt(false);
-        std::string propertyName = ccbReader->readCachedString();
+        const std::string& propertyName = ccbReader->readCachedString();
 
         // Check if the property can be set for this platform
         bool setProp = false;
@@ -906,19 +906,23 @@ Node * NodeLoader::parsePropTypeCCBFile(Node * pNode, Node * pParent, CCBReader
     
     // Load sub file
     std::string path = FileUtils::getInstance()->fullPathForFilename(ccbFileName.c_str());
-    unsigned long size = 0;
-    unsigned char * pBytes = FileUtils::getInstance()->getFileData(path.c_str(), "rb", &size);
 
     CCBReader * reader = new CCBReader(pCCBReader);
     reader->autorelease();
     reader->getAnimationManager()->setRootContainerSize(pParent->getContentSize());
     
-    Data *data = new Data(pBytes, size);
-    CC_SAFE_DELETE_ARRAY(pBytes);
-
-    data->retain();
-    reader->_data = data;
-    reader->_bytes = data->getBytes();
+    Data *data = NULL;
+    if (! reader->openTemplate(path))
+    {
+        unsigned long size = 0;
+        unsigned char * pBytes = FileUtils::getInstance()->getFileData(path.c_str(), "rb", &size);
+        data = new Data(pBytes, size);
+        CC_SAFE_DELETE_ARRAY(pBytes);
+
+        data->retain();
+        reader->_data = data;
+        reader->_bytes = data->getBytes();
+    }
     reader->_currentByte = 0;
     reader->_currentBit = 0;
     CC_SAFE_RETAIN(pCCBReader->_owner);
@@ -934,9 +938,10 @@ Node * NodeLoader::parsePropTypeCCBFile(Node * pNode, Node * pParent, CCBReader
 //     reader->_ownerCallbackNodes = pCCBReader->_ownerCallbackNodes;
 //     reader->_ownerCallbackNodes->retain();
 
-    data->release();
+    CC_SAFE_RELEASE(data);
     
     Node * ccbFileNode = reader->readFileWithCleanUp(false, pCCBReader->getAnimationManagers());
+    reader->closeTemplate(path, ccbFileNode != NULL);
     
     if (ccbFileNode && reader->getAnimationManager()->getAutoPlaySequenceId() != -1)
     {
@@ -1071,6 +1076,8 @@ void NodeLoader::onHandlePropTypeFloatVar(Node * pNode, Node * pParent, const ch
 void NodeLoader::onHandlePropTypeCheck(Node * pNode, Node * pParent, const char* pPropertyName, bool pCheck, CCBReader * ccbReader) {
     if(strcmp(pPropertyName, PROPERTY_VISIBLE) == 0) {
         pNode->setVisible(pCheck);
+    } else if(strcmp(pPropertyName, PROPERTY_LAZY) == 0) {
+        ccbReader->_lazyNode = pCheck ? pNode : NULL;
     } else if(strcmp(pPropertyName, PROPERTY_IGNOREANCHORPOINTFORPOSITION) == 0) {
         pNode->ignoreAnchorPointForPosition(pCheck);
     } else {
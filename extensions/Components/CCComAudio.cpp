@@ -196,6 +196,16 @@ void ComAudio::preloadEffect(const char* pszFilePath)
     CocosDenshion::SimpleAudioEngine::getInstance()->preloadEffect(pszFilePath);
 }
 
+void ComAudio::preloadEffectAsync(const char* pszFilePath, const std::function<void(const std::string&, bool)>& callback)
+{
+    CocosDenshion::SimpleAudioEngine::getInstance()->preloadEffectAsync(pszFilePath, callback);
+}
+
+void ComAudio::preloadEffectsAsync(const std::vector<std::string>& filePaths, const std::function<void(const std::string&, bool)>& callback)
+{
+    CocosDenshion::SimpleAudioEngine::getInstance()->preloadEffectsAsync(filePaths, callback);
+}
+
 void ComAudio::unloadEffect(const char *pszFilePath)
 {
     CocosDenshion::SimpleAudioEngine::getInstance()->unloadEffect(pszFilePath);
@@ -70,6 +70,9 @@ public:
    void stopEffect(unsigned int nSoundId);
    void stopAllEffects();
    void preloadEffect(const char* pszFilePath);
+   /** preloads the effects in the background, callback is called once for each file, see SimpleAudioEngine::preloadEffectAsync() */
+   void preloadEffectAsync(const char* pszFilePath, const std::function<void(const std::string&, bool)>& callback = nullptr);
+   void preloadEffectsAsync(const std::vector<std::string>& filePaths, const std::function<void(const std::string&, bool)>& callback = nullptr);
    void unloadEffect(const char* pszFilePath);
 };
 
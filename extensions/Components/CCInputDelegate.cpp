@@ -32,12 +32,18 @@ InputDelegate::InputDelegate(void)
 , _keypadEnabled(false)
 , _touchPriority(0)
 , _touchMode(Touch::DispatchMode::ALL_AT_ONCE)
+, _accelerationListener(NULL)
 {
 
 }
 
 InputDelegate::~InputDelegate(void)
 {
+    if (_accelerationListener)
+    {
+        Director::getInstance()->getEventDispatcher()->removeEventListener(_accelerationListener);
+        _accelerationListener->release();
+    }
 }
 
 bool InputDelegate::ccTouchBegan(Touch *pTouch, Event *pEvent)
@@ -171,14 +177,22 @@ void InputDelegate::setAccelerometerEnabled(bool enabled)
     {
         _accelerometerEnabled = enabled;
 
-        Director* pDirector = Director::getInstance();
+        EventDispatcher* pEventDispatcher = Director::getInstance()->getEventDispatcher();
         if (enabled)
         {
-            pDirector->getAccelerometer()->setDelegate(CC_CALLBACK_1(InputDelegate::didAccelerate, this));
+            if (! _accelerationListener)
+            {
+                _accelerationListener = EventListener::create(Event::Type::ACCELERATION, [this](Event* event) {
+                    Acceleration acceleration = static_cast<EventAcceleration*>(event)->getAcceleration();
+                    this->didAccelerate(&acceleration);
+                });
+                _accelerationListener->retain();
+            }
+            pEventDispatcher->addEventListenerWithFixedPriority(_accelerationListener, 1);
         }
         else
         {
-            pDirector->getAccelerometer()->setDelegate(nullptr);
+            pEventDispatcher->removeEventListener(_accelerationListener);
         }
     }
 }
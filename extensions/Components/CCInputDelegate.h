@@ -72,6 +72,7 @@ protected:
 private:
      int _touchPriority;
     Touch::DispatchMode _touchMode;
+    EventListener* _accelerationListener;
 };
 
 NS_CC_EXT_END
@@ -231,9 +231,7 @@ void Control::removeTargetWithActionForControlEvent(Object* target, Handler acti
 void Control::setOpacityModifyRGB(bool bOpacityModifyRGB)
 {
     _isOpacityModifyRGB=bOpacityModifyRGB;
-    Object* child;
-    Array* children=getChildren();
-    CCARRAY_FOREACH(children, child)
+    for (auto child : _children)
     {
         RGBAProtocol* pNode = dynamic_cast<RGBAProtocol*>(child);        
         if (pNode)
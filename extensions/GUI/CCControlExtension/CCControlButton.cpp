@@ -36,15 +36,11 @@ using namespace std;
 
 NS_CC_EXT_BEGIN
 
-enum
-{
-    kZoomActionTag = 0xCCCB0001,
-};
-
 ControlButton::ControlButton()
 : _isPushed(false)
 , _parentInited(false)
 , _doesAdjustBackgroundImage(false)
+, _titleLabelCache(NULL)
 , _currentTitle(NULL)
 , _currentTitleColor(Color3B::WHITE)
 , _titleLabel(NULL)
@@ -62,6 +58,7 @@ ControlButton::ControlButton()
 
 ControlButton::~ControlButton()
 {
+    CC_SAFE_RELEASE(_titleLabelCache);
     CC_SAFE_RELEASE(_currentTitle);
     CC_SAFE_RELEASE(_titleLabel);
     CC_SAFE_RELEASE(_backgroundSpriteDispatchTable);
@@ -95,6 +92,11 @@ bool ControlButton::initWithLabelAndBackgroundSprite(Node* node, Scale9Sprite* b
         this->setTitleColorDispatchTable(Dictionary::create());
         this->setTitleLabelDispatchTable(Dictionary::create());
         this->setBackgroundSpriteDispatchTable(Dictionary::create());
+        if (!_titleLabelCache)
+        {
+            _titleLabelCache = Dictionary::create();
+            _titleLabelCache->retain();
+        }
 
         setTouchEnabled(true);
         _isPushed = false;
@@ -213,18 +215,12 @@ void ControlButton::setHighlighted(bool enabled)
     
     Control::setHighlighted(enabled);
 
-    Action *action = getActionByTag(kZoomActionTag);
-    if (action)
-    {
-        stopAction(action);        
-    }
     needsLayout();
     if( _zoomOnTouchDown )
     {
+        // a tween replaces the previous one and doesn't allocate, unlike a ScaleTo on each touch
         float scaleValue = (isHighlighted() && isEnabled() && !isSelected()) ? 1.1f : 1.0f;
-        Action *zoomAction = ScaleTo::create(0.05f, scaleValue);
-        zoomAction->setTag(kZoomActionTag);
-        runAction(zoomAction);
+        _actionManager->addTween(this, ActionManager::TweenProperty::SCALE, 0.05f, scaleValue, scaleValue);
     }
 }
 
@@ -311,6 +307,7 @@ void ControlButton::setTitleForState(String* title, State state)
     {
         _titleDispatchTable->setObject(title, (int)state);
     }
+    this->clearTitleLabelCache();
     
     // If the current state if equal to the given state we update the layout
     if (getState() == state)
@@ -381,6 +378,7 @@ void ControlButton::setTitleLabelForState(Node* titleLabel, State state)
     titleLabel->setVisible(false);
     titleLabel->setAnchorPoint(Point(0.5f, 0.5f));
     addChild(titleLabel, 1);
+    this->clearTitleLabelCache();
 
     // If the current state if equal to the given state we update the layout
     if (getState() == state)
@@ -421,7 +419,12 @@ void ControlButton::setTitleTTFSizeForState(float size, State state)
         LabelTTF* labelTTF = dynamic_cast<LabelTTF*>(label);
         if(labelTTF != 0)
         {
-            return labelTTF->setFontSize(size);
+            this->clearTitleLabelCache();
+            labelTTF->setFontSize(size);
+            if (getState() == state)
+            {
+                needsLayout();
+            }
         }
     }
 }
@@ -517,21 +520,77 @@ void ControlButton::setBackgroundSpriteFrameForState(SpriteFrame * spriteFrame,
 }
 
 
-void ControlButton::needsLayout()
+Node* ControlButton::getDisplayedTitleLabelForState(State state, String* title)
 {
-    if (!_parentInited) {
+    Node* titleLabel = getTitleLabelForState(state);
+    if (state == Control::State::NORMAL || _titleLabelDispatchTable->objectForKey((int)state) || !title)
+    {
+        return titleLabel;
+    }
+
+    // the normal label already shows the title
+    String* normalTitle = getTitleForState(Control::State::NORMAL);
+    if (!normalTitle || normalTitle->compare(title->getCString()) == 0)
+    {
+        return titleLabel;
+    }
+
+    Node* cachedLabel = (Node*)_titleLabelCache->objectForKey((int)state);
+    if (cachedLabel)
+    {
+        return cachedLabel;
+    }
+
+    LabelTTF* labelTTF = dynamic_cast<LabelTTF*>(titleLabel);
+    LabelBMFont* labelBMFont = dynamic_cast<LabelBMFont*>(titleLabel);
+    if (labelTTF)
+    {
+        FontDefinition definition = labelTTF->getTextDefinition();
+        cachedLabel = LabelTTF::createWithFontDefinition(title->getCString(), definition);
+    }
+    else if (labelBMFont)
+    {
+        cachedLabel = LabelBMFont::create(title->getCString(), labelBMFont->getFntFile());
+    }
+    else
+    {
+        // unknown labels show the title of each state in turn
+        return titleLabel;
+    }
+
+    _titleLabelCache->setObject(cachedLabel, (int)state);
+    cachedLabel->setVisible(false);
+    cachedLabel->setAnchorPoint(titleLabel->getAnchorPoint());
+    addChild(cachedLabel, 1);
+    return cachedLabel;
+}
+
+void ControlButton::clearTitleLabelCache()
+{
+    if (!_titleLabelCache)
+    {
         return;
     }
-    // Hide the background and the label
-    if (_titleLabel != NULL) {
-        _titleLabel->setVisible(false);
+
+    DictElement* item = NULL;
+    CCDICT_FOREACH(_titleLabelCache, item)
+    {
+        Node* label = static_cast<Node*>(item->getObject());
+        if (label == _titleLabel)
+        {
+            this->setTitleLabel(NULL);
+        }
+        removeChild(label, true);
     }
-    if (_backgroundSprite) {
-        _backgroundSprite->setVisible(false);
+    _titleLabelCache->removeAllObjects();
+}
+
+void ControlButton::needsLayout()
+{
+    if (!_parentInited) {
+        return;
     }
-    // Update anchor of all labels
-    this->setLabelAnchorPoint(this->_labelAnchorPoint);
-    
+
     // Update the label to match with the current state
     CC_SAFE_RELEASE(_currentTitle);
     _currentTitle = getTitleForState(_state);
@@ -539,7 +598,20 @@ void ControlButton::needsLayout()
 
     _currentTitleColor = getTitleColorForState(_state);
 
-    this->setTitleLabel(getTitleLabelForState(_state));
+    // Only hide the label and the background when the state shows others,
+    // the nodes of each state keep their content between the state changes
+    Node* titleLabel = getDisplayedTitleLabelForState(_state, _currentTitle);
+    if (_titleLabel != NULL && _titleLabel != titleLabel) {
+        _titleLabel->setVisible(false);
+    }
+    Scale9Sprite* backgroundSprite = this->getBackgroundSpriteForState(_state);
+    if (_backgroundSprite && _backgroundSprite != backgroundSprite) {
+        _backgroundSprite->setVisible(false);
+    }
+
+    this->setTitleLabel(titleLabel);
+    // Update anchor of the label
+    this->setLabelAnchorPoint(this->_labelAnchorPoint);
 
     LabelProtocol* label = dynamic_cast<LabelProtocol*>(_titleLabel);
     if (label && _currentTitle)
@@ -558,7 +630,7 @@ void ControlButton::needsLayout()
     }
     
     // Update the background sprite
-    this->setBackgroundSprite(this->getBackgroundSpriteForState(_state));
+    this->setBackgroundSprite(backgroundSprite);
     if (_backgroundSprite != NULL)
     {
         _backgroundSprite->setPosition(Point (getContentSize().width / 2, getContentSize().height / 2));
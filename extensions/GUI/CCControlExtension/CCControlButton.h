@@ -198,9 +198,16 @@ public:
     void setAdjustBackgroundImage(bool adjustBackgroundImage);
 
 protected:
+    /** The label showing the title of a state. A state without a label of its own shows the normal label, or a
+     copy of it kept in _titleLabelCache when the titles differ, so switching states doesn't render the label again. */
+    Node* getDisplayedTitleLabelForState(State state, String* title);
+    void clearTitleLabelCache();
+
     bool _isPushed;
     bool _parentInited;
     bool _doesAdjustBackgroundImage;
+    // <ControlState, Node*> copies of the normal label for the states with another title
+    Dictionary* _titleLabelCache;
 
     /** The current title that is displayed on the button. */
     CC_SYNTHESIZE_READONLY(String*, _currentTitle, CurrentTitle);
@@ -169,8 +169,7 @@ void ControlSwitchSprite::draw()
 
 #define kQuadSize sizeof(_quad.bl)
 #ifdef EMSCRIPTEN
-    long offset = 0;
-    setGLBufferData(&_quad, 4 * kQuadSize, 0);
+    long offset = (long)setGLBufferData(&_quad, 4 * kQuadSize);
 #else
     long offset = (long)&_quad;
 #endif // EMSCRIPTEN
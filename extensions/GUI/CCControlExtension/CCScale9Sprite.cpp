@@ -26,36 +26,88 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "CCScale9Sprite.h"
+#include "support/TransformUtils.h"
 
 NS_CC_EXT_BEGIN
 
+// the parts, in the order of their quads
 enum positions
 {
-    pCentre = 0,
-    pTop,
+    pBottomLeft = 0,
+    pBottom,
+    pBottomRight,
     pLeft,
+    pCentre,
     pRight,
-    pBottom,
-    pTopRight,
     pTopLeft,
-    pBottomRight,
-    pBottomLeft
+    pTop,
+    pTopRight
 };
 
+// same texture coordinates as a Sprite showing the rect
+static void setQuadTexCoords(V3F_C4B_T2F_Quad& quad, Rect rect, bool rotated, Texture2D* tex)
+{
+    rect = CC_RECT_POINTS_TO_PIXELS(rect);
+
+    float atlasWidth = (float)tex->getPixelsWide();
+    float atlasHeight = (float)tex->getPixelsHigh();
+
+    float left, right, top, bottom;
+
+    if (rotated)
+    {
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+        left    = (2*rect.origin.x+1)/(2*atlasWidth);
+        right   = left+(rect.size.height*2-2)/(2*atlasWidth);
+        top     = (2*rect.origin.y+1)/(2*atlasHeight);
+        bottom  = top+(rect.size.width*2-2)/(2*atlasHeight);
+#else
+        left    = rect.origin.x/atlasWidth;
+        right   = (rect.origin.x+rect.size.height) / atlasWidth;
+        top     = rect.origin.y/atlasHeight;
+        bottom  = (rect.origin.y+rect.size.width) / atlasHeight;
+#endif // CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+
+        quad.bl.texCoords.u = left;
+        quad.bl.texCoords.v = top;
+        quad.br.texCoords.u = left;
+        quad.br.texCoords.v = bottom;
+        quad.tl.texCoords.u = right;
+        quad.tl.texCoords.v = top;
+        quad.tr.texCoords.u = right;
+        quad.tr.texCoords.v = bottom;
+    }
+    else
+    {
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+        left    = (2*rect.origin.x+1)/(2*atlasWidth);
+        right   = left + (rect.size.width*2-2)/(2*atlasWidth);
+        top     = (2*rect.origin.y+1)/(2*atlasHeight);
+        bottom  = top + (rect.size.height*2-2)/(2*atlasHeight);
+#else
+        left    = rect.origin.x/atlasWidth;
+        right   = (rect.origin.x + rect.size.width) / atlasWidth;
+        top     = rect.origin.y/atlasHeight;
+        bottom  = (rect.origin.y + rect.size.height) / atlasHeight;
+#endif // ! CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+
+        quad.bl.texCoords.u = left;
+        quad.bl.texCoords.v = bottom;
+        quad.br.texCoords.u = right;
+        quad.br.texCoords.v = bottom;
+        quad.tl.texCoords.u = left;
+        quad.tl.texCoords.v = top;
+        quad.tr.texCoords.u = right;
+        quad.tr.texCoords.v = top;
+    }
+}
+
 Scale9Sprite::Scale9Sprite()
 : _spritesGenerated(false)
 , _spriteFrameRotated(false)
 , _positionsAreDirty(false)
 , _scale9Image(NULL)
-, _topLeft(NULL)
-, _top(NULL)
-, _topRight(NULL)
-, _left(NULL)
-, _centre(NULL)
-, _right(NULL)
-, _bottomLeft(NULL)
-, _bottom(NULL)
-, _bottomRight(NULL)
+, _blendFunc(BlendFunc::ALPHA_NON_PREMULTIPLIED)
 , _opacityModifyRGB(false)
 , _insetLeft(0)
 , _insetTop(0)
@@ -67,15 +119,6 @@ Scale9Sprite::Scale9Sprite()
 
 Scale9Sprite::~Scale9Sprite()
 {
-    CC_SAFE_RELEASE(_topLeft);
-    CC_SAFE_RELEASE(_top);
-    CC_SAFE_RELEASE(_topRight);
-    CC_SAFE_RELEASE(_left);
-    CC_SAFE_RELEASE(_centre);
-    CC_SAFE_RELEASE(_right);
-    CC_SAFE_RELEASE(_bottomLeft);
-    CC_SAFE_RELEASE(_bottom);
-    CC_SAFE_RELEASE(_bottomRight);
     CC_SAFE_RELEASE(_scale9Image);
 }
 
@@ -102,31 +145,8 @@ bool Scale9Sprite::initWithBatchNode(SpriteBatchNode* batchnode, Rect rect, bool
     return true;
 }
 
-#define    TRANSLATE_X(x, y, xtranslate) \
-    x+=xtranslate;                       \
-
-#define    TRANSLATE_Y(x, y, ytranslate) \
-    y+=ytranslate;                       \
-
 bool Scale9Sprite::updateWithBatchNode(SpriteBatchNode* batchnode, Rect rect, bool rotated, Rect capInsets)
 {
-    GLubyte opacity = getOpacity();
-    Color3B color = getColor();
-
-    // Release old sprites
-    this->removeAllChildrenWithCleanup(true);
-
-    CC_SAFE_RELEASE(this->_centre);
-    CC_SAFE_RELEASE(this->_top);
-    CC_SAFE_RELEASE(this->_topLeft);
-    CC_SAFE_RELEASE(this->_topRight);
-    CC_SAFE_RELEASE(this->_left);
-    CC_SAFE_RELEASE(this->_right);
-    CC_SAFE_RELEASE(this->_bottomLeft);
-    CC_SAFE_RELEASE(this->_bottom);
-    CC_SAFE_RELEASE(this->_bottomRight);
-
-    
     if(this->_scale9Image != batchnode)
     {
         CC_SAFE_RELEASE(this->_scale9Image);
@@ -134,16 +154,16 @@ bool Scale9Sprite::updateWithBatchNode(SpriteBatchNode* batchnode, Rect rect, bo
         CC_SAFE_RETAIN(_scale9Image);
     }
 
-    _scale9Image->removeAllChildrenWithCleanup(true);
-
     _capInsets = capInsets;
     _spriteFrameRotated = rotated;
-    
+
+    Texture2D* texture = _scale9Image->getTexture();
+
     // If there is no given rect
     if ( rect.equals(Rect::ZERO) )
     {
         // Get the texture size as original
-        Size textureSize = _scale9Image->getTextureAtlas()->getTexture()->getContentSize();
+        Size textureSize = texture->getContentSize();
     
         rect = Rect(0, 0, textureSize.width, textureSize.height);
     }
@@ -172,212 +192,56 @@ bool Scale9Sprite::updateWithBatchNode(SpriteBatchNode* batchnode, Rect rect, bo
     float center_h = _capInsetsInternal.size.height;
     float bottom_h = rect.size.height - (top_h + center_h);
 
-    // calculate rects
-
-    // ... top row
-    float x = 0.0;
-    float y = 0.0;
-
-    // top left
-    Rect lefttopbounds = Rect(x, y, left_w, top_h);
-
-    // top center
-    TRANSLATE_X(x, y, left_w);
-    Rect centertopbounds = Rect(x, y, center_w, top_h);
-        
-    // top right
-    TRANSLATE_X(x, y, center_w);
-    Rect righttopbounds = Rect(x, y, right_w, top_h);
-
-    // ... center row
-    x = 0.0;
-    y = 0.0;
-    TRANSLATE_Y(x, y, top_h);
-
-    // center left
-    Rect leftcenterbounds = Rect(x, y, left_w, center_h);
-
-    // center center
-    TRANSLATE_X(x, y, left_w);
-    Rect centerbounds = Rect(x, y, center_w, center_h);
-
-    // center right
-    TRANSLATE_X(x, y, center_w);
-    Rect rightcenterbounds = Rect(x, y, right_w, center_h);
-
-    // ... bottom row
-    x = 0.0;
-    y = 0.0;
-    TRANSLATE_Y(x, y, top_h);
-    TRANSLATE_Y(x, y, center_h);
-
-    // bottom left
-    Rect leftbottombounds = Rect(x, y, left_w, bottom_h);
-
-    // bottom center
-    TRANSLATE_X(x, y, left_w);
-    Rect centerbottombounds = Rect(x, y, center_w, bottom_h);
-
-    // bottom right
-    TRANSLATE_X(x, y, center_w);
-    Rect rightbottombounds = Rect(x, y, right_w, bottom_h);
-
-    if (!rotated) {
-        // log("!rotated");
+    // calculate rects, the top row of the texture is the top row of the sprite
+    const float widths[3] = { left_w, center_w, right_w };
+    const float xs[3] = { 0.0f, left_w, left_w + center_w };
+    const float heights[3] = { bottom_h, center_h, top_h };
+    const float ys[3] = { top_h + center_h, top_h, 0.0f };
 
-        AffineTransform t = AffineTransformMakeIdentity();
+    AffineTransform t = AffineTransformMakeIdentity();
+    if (!rotated)
+    {
         t = AffineTransformTranslate(t, rect.origin.x, rect.origin.y);
-
-        centerbounds = RectApplyAffineTransform(centerbounds, t);
-        rightbottombounds = RectApplyAffineTransform(rightbottombounds, t);
-        leftbottombounds = RectApplyAffineTransform(leftbottombounds, t);
-        righttopbounds = RectApplyAffineTransform(righttopbounds, t);
-        lefttopbounds = RectApplyAffineTransform(lefttopbounds, t);
-        rightcenterbounds = RectApplyAffineTransform(rightcenterbounds, t);
-        leftcenterbounds = RectApplyAffineTransform(leftcenterbounds, t);
-        centerbottombounds = RectApplyAffineTransform(centerbottombounds, t);
-        centertopbounds = RectApplyAffineTransform(centertopbounds, t);
-
-        // Centre
-        _centre = new Sprite();
-        _centre->initWithTexture(_scale9Image->getTexture(), centerbounds);
-        _scale9Image->addChild(_centre, 0, pCentre);
-        
-        // Top
-        _top = new Sprite();
-        _top->initWithTexture(_scale9Image->getTexture(), centertopbounds);
-        _scale9Image->addChild(_top, 1, pTop);
-        
-        // Bottom
-        _bottom = new Sprite();
-        _bottom->initWithTexture(_scale9Image->getTexture(), centerbottombounds);
-        _scale9Image->addChild(_bottom, 1, pBottom);
-        
-        // Left
-        _left = new Sprite();
-        _left->initWithTexture(_scale9Image->getTexture(), leftcenterbounds);
-        _scale9Image->addChild(_left, 1, pLeft);
-        
-        // Right
-        _right = new Sprite();
-        _right->initWithTexture(_scale9Image->getTexture(), rightcenterbounds);
-        _scale9Image->addChild(_right, 1, pRight);
-        
-        // Top left
-        _topLeft = new Sprite();
-        _topLeft->initWithTexture(_scale9Image->getTexture(), lefttopbounds);
-        _scale9Image->addChild(_topLeft, 2, pTopLeft);
-        
-        // Top right
-        _topRight = new Sprite();
-        _topRight->initWithTexture(_scale9Image->getTexture(), righttopbounds);
-        _scale9Image->addChild(_topRight, 2, pTopRight);
-        
-        // Bottom left
-        _bottomLeft = new Sprite();
-        _bottomLeft->initWithTexture(_scale9Image->getTexture(), leftbottombounds);
-        _scale9Image->addChild(_bottomLeft, 2, pBottomLeft);
-        
-        // Bottom right
-        _bottomRight = new Sprite();
-        _bottomRight->initWithTexture(_scale9Image->getTexture(), rightbottombounds);
-        _scale9Image->addChild(_bottomRight, 2, pBottomRight);
-    } else {
+    }
+    else
+    {
         // set up transformation of coordinates
         // to handle the case where the sprite is stored rotated
         // in the spritesheet
-        // log("rotated");
-
-        AffineTransform t = AffineTransformMakeIdentity();
-
-        Rect rotatedcenterbounds = centerbounds;
-        Rect rotatedrightbottombounds = rightbottombounds;
-        Rect rotatedleftbottombounds = leftbottombounds;
-        Rect rotatedrighttopbounds = righttopbounds;
-        Rect rotatedlefttopbounds = lefttopbounds;
-        Rect rotatedrightcenterbounds = rightcenterbounds;
-        Rect rotatedleftcenterbounds = leftcenterbounds;
-        Rect rotatedcenterbottombounds = centerbottombounds;
-        Rect rotatedcentertopbounds = centertopbounds;
-        
         t = AffineTransformTranslate(t, rect.size.height+rect.origin.x, rect.origin.y);
         t = AffineTransformRotate(t, 1.57079633f);
-        
-        centerbounds = RectApplyAffineTransform(centerbounds, t);
-        rightbottombounds = RectApplyAffineTransform(rightbottombounds, t);
-        leftbottombounds = RectApplyAffineTransform(leftbottombounds, t);
-        righttopbounds = RectApplyAffineTransform(righttopbounds, t);
-        lefttopbounds = RectApplyAffineTransform(lefttopbounds, t);
-        rightcenterbounds = RectApplyAffineTransform(rightcenterbounds, t);
-        leftcenterbounds = RectApplyAffineTransform(leftcenterbounds, t);
-        centerbottombounds = RectApplyAffineTransform(centerbottombounds, t);
-        centertopbounds = RectApplyAffineTransform(centertopbounds, t);
-
-        rotatedcenterbounds.origin = centerbounds.origin;
-        rotatedrightbottombounds.origin = rightbottombounds.origin;
-        rotatedleftbottombounds.origin = leftbottombounds.origin;
-        rotatedrighttopbounds.origin = righttopbounds.origin;
-        rotatedlefttopbounds.origin = lefttopbounds.origin;
-        rotatedrightcenterbounds.origin = rightcenterbounds.origin;
-        rotatedleftcenterbounds.origin = leftcenterbounds.origin;
-        rotatedcenterbottombounds.origin = centerbottombounds.origin;
-        rotatedcentertopbounds.origin = centertopbounds.origin;
-
-        // Centre
-        _centre = new Sprite();
-        _centre->initWithTexture(_scale9Image->getTexture(), rotatedcenterbounds, true);
-        _scale9Image->addChild(_centre, 0, pCentre);
-        
-        // Top
-        _top = new Sprite();
-        _top->initWithTexture(_scale9Image->getTexture(), rotatedcentertopbounds, true);
-        _scale9Image->addChild(_top, 1, pTop);
-        
-        // Bottom
-        _bottom = new Sprite();
-        _bottom->initWithTexture(_scale9Image->getTexture(), rotatedcenterbottombounds, true);
-        _scale9Image->addChild(_bottom, 1, pBottom);
-        
-        // Left
-        _left = new Sprite();
-        _left->initWithTexture(_scale9Image->getTexture(), rotatedleftcenterbounds, true);
-        _scale9Image->addChild(_left, 1, pLeft);
-        
-        // Right
-        _right = new Sprite();
-        _right->initWithTexture(_scale9Image->getTexture(), rotatedrightcenterbounds, true);
-        _scale9Image->addChild(_right, 1, pRight);
-        
-        // Top left
-        _topLeft = new Sprite();
-        _topLeft->initWithTexture(_scale9Image->getTexture(), rotatedlefttopbounds, true);
-        _scale9Image->addChild(_topLeft, 2, pTopLeft);
-        
-        // Top right
-        _topRight = new Sprite();
-        _topRight->initWithTexture(_scale9Image->getTexture(), rotatedrighttopbounds, true);
-        _scale9Image->addChild(_topRight, 2, pTopRight);
-        
-        // Bottom left
-        _bottomLeft = new Sprite();
-        _bottomLeft->initWithTexture(_scale9Image->getTexture(), rotatedleftbottombounds, true);
-        _scale9Image->addChild(_bottomLeft, 2, pBottomLeft);
-        
-        // Bottom right
-        _bottomRight = new Sprite();
-        _bottomRight->initWithTexture(_scale9Image->getTexture(), rotatedrightbottombounds, true);
-        _scale9Image->addChild(_bottomRight, 2, pBottomRight);
     }
 
-    this->setContentSize(rect.size);
-    this->addChild(_scale9Image);
-    
-    if (_spritesGenerated)
+    for (int row = 0; row < 3; row++)
     {
-        // Restore color and opacity
-        this->setOpacity(opacity);
-        this->setColor(color);
+        for (int column = 0; column < 3; column++)
+        {
+            Rect bounds = Rect(xs[column], ys[row], widths[column], heights[row]);
+            // a rotated part keeps its size, only its origin moves in the texture
+            bounds.origin = RectApplyAffineTransform(bounds, t).origin;
+
+            V3F_C4B_T2F_Quad& quad = _quads[row * 3 + column];
+            _sliceRects[row * 3 + column] = bounds;
+            setQuadTexCoords(quad, bounds, rotated, texture);
+            quad.bl.vertices.z = quad.br.vertices.z = quad.tl.vertices.z = quad.tr.vertices.z = 0;
+        }
+    }
+
+    if (texture->hasPremultipliedAlpha())
+    {
+        _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+        _opacityModifyRGB = true;
     }
+    else
+    {
+        _blendFunc = BlendFunc::ALPHA_NON_PREMULTIPLIED;
+        _opacityModifyRGB = false;
+    }
+    this->setShaderProgram(ShaderCache::getInstance()->programForTexture(
+        ShaderCache::getInstance()->programForKey(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR), texture));
+
+    this->setContentSize(rect.size);
+    this->updateColor();
     _spritesGenerated = true;
 
     return true;
@@ -391,68 +255,62 @@ void Scale9Sprite::setContentSize(const Size &size)
 
 void Scale9Sprite::updatePositions()
 {
-    // Check that instances are non-NULL
-    if(!((_topLeft) &&
-         (_topRight) &&
-         (_bottomRight) &&
-         (_bottomLeft) &&
-         (_centre))) {
-        // if any of the above sprites are NULL, return
+    if (!_scale9Image)
+    {
         return;
     }
 
     Size size = this->_contentSize;
 
-    float sizableWidth = size.width - _topLeft->getContentSize().width - _topRight->getContentSize().width;
-    float sizableHeight = size.height - _topLeft->getContentSize().height - _bottomRight->getContentSize().height;
-    
-    float horizontalScale = sizableWidth/_centre->getContentSize().width;
-    float verticalScale = sizableHeight/_centre->getContentSize().height;
-
-    _centre->setScaleX(horizontalScale);
-    _centre->setScaleY(verticalScale);
-
-    float rescaledWidth = _centre->getContentSize().width * horizontalScale;
-    float rescaledHeight = _centre->getContentSize().height * verticalScale;
-
-    float leftWidth = _bottomLeft->getContentSize().width;
-    float bottomHeight = _bottomLeft->getContentSize().height;
-
-    _bottomLeft->setAnchorPoint(Point(0,0));
-    _bottomRight->setAnchorPoint(Point(0,0));
-    _topLeft->setAnchorPoint(Point(0,0));
-    _topRight->setAnchorPoint(Point(0,0));
-    _left->setAnchorPoint(Point(0,0));
-    _right->setAnchorPoint(Point(0,0));
-    _top->setAnchorPoint(Point(0,0));
-    _bottom->setAnchorPoint(Point(0,0));
-    _centre->setAnchorPoint(Point(0,0));
-
-    // Position corners
-    _bottomLeft->setPosition(Point(0,0));
-    _bottomRight->setPosition(Point(leftWidth+rescaledWidth,0));
-    _topLeft->setPosition(Point(0, bottomHeight+rescaledHeight));
-    _topRight->setPosition(Point(leftWidth+rescaledWidth, bottomHeight+rescaledHeight));
-
-    // Scale and position borders
-    _left->setPosition(Point(0, bottomHeight));
-    _left->setScaleY(verticalScale);
-    _right->setPosition(Point(leftWidth+rescaledWidth,bottomHeight));
-    _right->setScaleY(verticalScale);
-    _bottom->setPosition(Point(leftWidth,0));
-    _bottom->setScaleX(horizontalScale);
-    _top->setPosition(Point(leftWidth,bottomHeight+rescaledHeight));
-    _top->setScaleX(horizontalScale);
-
-    // Position centre
-    _centre->setPosition(Point(leftWidth, bottomHeight));
+    float leftWidth = _sliceRects[pBottomLeft].size.width;
+    float bottomHeight = _sliceRects[pBottomLeft].size.height;
+
+    float sizableWidth = size.width - _sliceRects[pTopLeft].size.width - _sliceRects[pTopRight].size.width;
+    float sizableHeight = size.height - _sliceRects[pTopLeft].size.height - _sliceRects[pBottomRight].size.height;
+
+    // edges of the columns and of the rows, the centre ones are stretched
+    const float xs[4] = { 0.0f, leftWidth, leftWidth + sizableWidth, leftWidth + sizableWidth + _sliceRects[pBottomRight].size.width };
+    const float ys[4] = { 0.0f, bottomHeight, bottomHeight + sizableHeight, bottomHeight + sizableHeight + _sliceRects[pTopLeft].size.height };
+
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            V3F_C4B_T2F_Quad& quad = _quads[row * 3 + column];
+            quad.bl.vertices.x = quad.tl.vertices.x = xs[column];
+            quad.br.vertices.x = quad.tr.vertices.x = xs[column + 1];
+            quad.bl.vertices.y = quad.br.vertices.y = ys[row];
+            quad.tl.vertices.y = quad.tr.vertices.y = ys[row + 1];
+        }
+    }
+}
+
+void Scale9Sprite::updateColor()
+{
+    Color4B color4(_displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity);
+
+    // special opacity for premultiplied textures
+    if (_opacityModifyRGB)
+    {
+        color4.r *= _displayedOpacity/255.0f;
+        color4.g *= _displayedOpacity/255.0f;
+        color4.b *= _displayedOpacity/255.0f;
+    }
+
+    for (int i = 0; i < 9; i++)
+    {
+        _quads[i].bl.colors = color4;
+        _quads[i].br.colors = color4;
+        _quads[i].tl.colors = color4;
+        _quads[i].tr.colors = color4;
+    }
 }
 
 bool Scale9Sprite::initWithFile(const char* file, Rect rect,  Rect capInsets)
 {
     CCASSERT(file != NULL, "Invalid file for sprite");
     
-    SpriteBatchNode *batchnode = SpriteBatchNode::create(file, 9);
+    SpriteBatchNode *batchnode = SpriteBatchNode::create(file, 1);
     bool pReturn = this->initWithBatchNode(batchnode, rect, capInsets);
     return pReturn;
 }
@@ -531,7 +389,7 @@ bool Scale9Sprite::initWithSpriteFrame(SpriteFrame* spriteFrame, Rect capInsets)
     Texture2D* texture = spriteFrame->getTexture();
     CCASSERT(texture != NULL, "CCTexture must be not nil");
 
-    SpriteBatchNode *batchnode = SpriteBatchNode::createWithTexture(texture, 9);
+    SpriteBatchNode *batchnode = SpriteBatchNode::createWithTexture(texture, 1);
     CCASSERT(batchnode != NULL, "CCSpriteBatchNode must be not nil");
 
     bool pReturn = this->initWithBatchNode(batchnode, spriteFrame->getRect(), spriteFrame->isRotated(), capInsets);
@@ -688,16 +546,7 @@ void Scale9Sprite::updateCapInset()
 void Scale9Sprite::setOpacityModifyRGB(bool var)
 {
     _opacityModifyRGB = var;
-    Object* child;
-    Array* children = _scale9Image->getChildren();
-    CCARRAY_FOREACH(children, child)
-    {
-        RGBAProtocol* pNode = dynamic_cast<RGBAProtocol*>(child);
-        if (pNode)
-        {
-            pNode->setOpacityModifyRGB(_opacityModifyRGB);
-        }
-    }
+    this->updateColor();
 }
 bool Scale9Sprite::isOpacityModifyRGB() const
 {
@@ -706,7 +555,7 @@ bool Scale9Sprite::isOpacityModifyRGB() const
 
 void Scale9Sprite::setSpriteFrame(SpriteFrame * spriteFrame)
 {
-    SpriteBatchNode * batchnode = SpriteBatchNode::createWithTexture(spriteFrame->getTexture(), 9);
+    SpriteBatchNode * batchnode = SpriteBatchNode::createWithTexture(spriteFrame->getTexture(), 1);
     this->updateWithBatchNode(batchnode, spriteFrame->getRect(), spriteFrame->isRotated(), Rect::ZERO);
 
     // Reset insets
@@ -760,29 +609,48 @@ void Scale9Sprite::setInsetBottom(float insetBottom)
     this->updateCapInset();
 }
 
-void Scale9Sprite::visit()
+void Scale9Sprite::draw()
 {
+    if (!_scale9Image)
+    {
+        return;
+    }
+
     if(this->_positionsAreDirty)
     {
         this->updatePositions();
         this->_positionsAreDirty = false;
     }
-    Node::visit();
+
+    // the quads are drawn by the Renderer when it is flushed
+    kmMat4 mv;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
+
+#if CC_USE_CULLING
+    kmMat4 mvp;
+    kmGLGetMatrix(KM_GL_PROJECTION, &mvp);
+    kmMat4Multiply(&mvp, &mvp, &mv);
+    V3F_C4B_T2F_Quad bounds;
+    bounds.bl = _quads[pBottomLeft].bl;
+    bounds.br = _quads[pBottomRight].br;
+    bounds.tl = _quads[pTopLeft].tl;
+    bounds.tr = _quads[pTopRight].tr;
+    if (!isQuadVisible(&mvp, &bounds))
+    {
+        return;
+    }
+#endif // CC_USE_CULLING
+
+    Texture2D* texture = _scale9Image->getTexture();
+    Texture2D* alphaTexture = texture->getAlphaTexture();
+    _quadCommand.init(texture->getName(), _shaderProgram, _blendFunc, _quads, 9, mv, alphaTexture ? alphaTexture->getName() : 0);
+    Director::getInstance()->getRenderer()->addCommand(&_quadCommand);
 }
 
 void Scale9Sprite::setColor(const Color3B& color)
 {
     NodeRGBA::setColor(color);
-    Object* child;
-    Array* children = _scale9Image->getChildren();
-    CCARRAY_FOREACH(children, child)
-    {
-        RGBAProtocol* pNode = dynamic_cast<RGBAProtocol*>(child);
-        if (pNode)
-        {
-            pNode->setColor(color);
-        }
-    }
+    this->updateColor();
 }
 
 const Color3B& Scale9Sprite::getColor() const
@@ -793,16 +661,7 @@ const Color3B& Scale9Sprite::getColor() const
 void Scale9Sprite::setOpacity(GLubyte opacity)
 {
     NodeRGBA::setOpacity(opacity);
-    Object* child;
-    Array* children = _scale9Image->getChildren();
-    CCARRAY_FOREACH(children, child)
-    {
-        RGBAProtocol* pNode = dynamic_cast<RGBAProtocol*>(child);
-        if (pNode)
-        {
-            pNode->setOpacity(opacity);
-        }
-    }
+    this->updateColor();
 }
 
 GLubyte Scale9Sprite::getOpacity() const
@@ -813,31 +672,13 @@ GLubyte Scale9Sprite::getOpacity() const
 void Scale9Sprite::updateDisplayedColor(const cocos2d::Color3B &parentColor)
 {
     NodeRGBA::updateDisplayedColor(parentColor);
-    Object* child;
-    Array* children = _scale9Image->getChildren();
-    CCARRAY_FOREACH(children, child)
-    {
-        RGBAProtocol* pNode = dynamic_cast<RGBAProtocol*>(child);
-        if (pNode)
-        {
-            pNode->updateDisplayedColor(parentColor);
-        }
-    }
+    this->updateColor();
 }
 
 void Scale9Sprite::updateDisplayedOpacity(GLubyte parentOpacity)
 {
     NodeRGBA::updateDisplayedOpacity(parentOpacity);
-    Object* child;
-    Array* children = _scale9Image->getChildren();
-    CCARRAY_FOREACH(children, child)
-    {
-        RGBAProtocol* pNode = dynamic_cast<RGBAProtocol*>(child);
-        if (pNode)
-        {
-            pNode->updateDisplayedOpacity(parentOpacity);
-        }
-    }
+    this->updateColor();
 }
 
 NS_CC_EXT_END
@@ -48,6 +48,10 @@ NS_CC_EXT_BEGIN
  * you can ensure that the sprite does not become distorted when
  * scaled.
  *
+ * The nine parts are drawn as the quads of a single QuadCommand, built
+ * directly from the texture: no child sprite is created, and the Renderer
+ * batches consecutive 9-slice sprites and sprites sharing their texture.
+ *
  * @see http://yannickloriot.com/library/ios/cccontrolextension/Classes/CCScale9Sprite.html
  */
 class Scale9Sprite : public NodeRGBA
@@ -247,7 +251,7 @@ public:
 
     // overrides
     virtual void setContentSize(const Size & size) override;
-    virtual void visit() override;
+    virtual void draw() override;
     virtual void setOpacityModifyRGB(bool bValue) override;
     virtual bool isOpacityModifyRGB(void) const override;
     virtual void setOpacity(GLubyte opacity) override;
@@ -260,6 +264,7 @@ public:
 protected:
     void updateCapInset();
     void updatePositions();
+    void updateColor();
 
     bool _spritesGenerated;
     Rect _spriteRect;
@@ -267,16 +272,14 @@ protected:
     Rect _capInsetsInternal;
     bool _positionsAreDirty;
 
+    /** holds the texture of the sprite, its children aren't used */
     SpriteBatchNode* _scale9Image;
-    Sprite* _topLeft;
-    Sprite* _top;
-    Sprite* _topRight;
-    Sprite* _left;
-    Sprite* _centre;
-    Sprite* _right;
-    Sprite* _bottomLeft;
-    Sprite* _bottom;
-    Sprite* _bottomRight;
+    /** rects in the texture of the nine parts, from the bottom left to the top right, row by row.
+     The sizes are the ones of the parts before the rotation of the sprite frame, if any. */
+    Rect _sliceRects[9];
+    V3F_C4B_T2F_Quad _quads[9];
+    QuadCommand _quadCommand;
+    BlendFunc _blendFunc;
 
     bool _opacityModifyRGB;
 
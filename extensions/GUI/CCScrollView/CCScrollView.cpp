@@ -33,6 +33,13 @@ NS_CC_EXT_BEGIN
 #define INSET_RATIO          0.2f
 #define MOVE_INCH            7.0f/160.0f
 
+// a child without size may only hold other nodes, it can't be culled
+static inline bool isInView(Node* child, const Rect& viewRect)
+{
+    const Size& size = child->getContentSize();
+    return (size.width == 0 && size.height == 0) || child->getBoundingBox().intersectsRect(viewRect);
+}
+
 static float convertDistanceFromPointToInch(float pointDis)
 {
     float factor = ( EGLView::getInstance()->getScaleX() + EGLView::getInstance()->getScaleY() ) / 2;
@@ -55,6 +62,11 @@ ScrollView::ScrollView()
 , _touches(NULL)
 , _minScale(0.0f)
 , _maxScale(0.0f)
+, _scissorRestored(false)
+, _scissorChanged(false)
+, _clippedOut(false)
+, _ownsContainer(false)
+, _cullingChildren(false)
 {
 
 }
@@ -98,6 +110,7 @@ bool ScrollView::initWithViewSize(Size size, Node *container/* = NULL*/)
     if (Layer::init())
     {
         _container = container;
+        _ownsContainer = (container == NULL);
         
         if (!this->_container)
         {
@@ -152,25 +165,17 @@ void ScrollView::pause(Object* sender)
 {
     _container->pauseSchedulerAndActions();
 
-    Object* pObj = NULL;
-    Array* pChildren = _container->getChildren();
-
-    CCARRAY_FOREACH(pChildren, pObj)
+    for (auto child : _container->getChildren())
     {
-        Node* pChild = static_cast<Node*>(pObj);
-        pChild->pauseSchedulerAndActions();
+        child->pauseSchedulerAndActions();
     }
 }
 
 void ScrollView::resume(Object* sender)
 {
-    Object* pObj = NULL;
-    Array* pChildren = _container->getChildren();
-
-    CCARRAY_FOREACH(pChildren, pObj)
+    for (auto child : _container->getChildren())
     {
-        Node* pChild = static_cast<Node*>(pObj);
-        pChild->resumeSchedulerAndActions();
+        child->resumeSchedulerAndActions();
     }
 
     _container->resumeSchedulerAndActions();
@@ -312,6 +317,7 @@ void ScrollView::setContainer(Node * pContainer)
 
     this->removeAllChildrenWithCleanup(true);
     this->_container = pContainer;
+    this->_ownsContainer = false;
 
     this->_container->ignoreAnchorPointForPosition(false);
     this->_container->setAnchorPoint(Point(0.0f, 0.0f));
@@ -492,24 +498,38 @@ void ScrollView::addChild(Node * child)
  */
 void ScrollView::beforeDraw()
 {
+    _scissorChanged = false;
+    _scissorRestored = false;
+    _clippedOut = false;
+
     if (_clippingToBounds)
     {
-		_scissorRestored = false;
         Rect frame = getViewRect();
         if (EGLView::getInstance()->isScissorEnabled()) {
-            _scissorRestored = true;
             _parentScissorRect = EGLView::getInstance()->getScissorRect();
             //set the intersection of _parentScissorRect and frame as the new scissor rect
-            if (frame.intersectsRect(_parentScissorRect)) {
-                float x = MAX(frame.origin.x, _parentScissorRect.origin.x);
-                float y = MAX(frame.origin.y, _parentScissorRect.origin.y);
-                float xx = MIN(frame.origin.x+frame.size.width, _parentScissorRect.origin.x+_parentScissorRect.size.width);
-                float yy = MIN(frame.origin.y+frame.size.height, _parentScissorRect.origin.y+_parentScissorRect.size.height);
-                EGLView::getInstance()->setScissorInPoints(x, y, xx-x, yy-y);
+            if (!frame.intersectsRect(_parentScissorRect)) {
+                _clippedOut = true;
+                return;
             }
+            float x = MAX(frame.origin.x, _parentScissorRect.origin.x);
+            float y = MAX(frame.origin.y, _parentScissorRect.origin.y);
+            float xx = MIN(frame.origin.x+frame.size.width, _parentScissorRect.origin.x+_parentScissorRect.size.width);
+            float yy = MIN(frame.origin.y+frame.size.height, _parentScissorRect.origin.y+_parentScissorRect.size.height);
+            // nested in a smaller clipping, the scissor box stays the same
+            if (x == _parentScissorRect.origin.x && y == _parentScissorRect.origin.y &&
+                xx-x == _parentScissorRect.size.width && yy-y == _parentScissorRect.size.height) {
+                return;
+            }
+            Director::getInstance()->getRenderer()->flush();
+            _scissorChanged = true;
+            _scissorRestored = true;
+            EGLView::getInstance()->setScissorInPoints(x, y, xx-x, yy-y);
         }
         else {
-            glEnable(GL_SCISSOR_TEST);
+            Director::getInstance()->getRenderer()->flush();
+            _scissorChanged = true;
+            GL::enable(GL_SCISSOR_TEST);
             EGLView::getInstance()->setScissorInPoints(frame.origin.x, frame.origin.y, frame.size.width, frame.size.height);
         }
     }
@@ -521,17 +541,71 @@ void ScrollView::beforeDraw()
  */
 void ScrollView::afterDraw()
 {
-    if (_clippingToBounds)
+    if (_scissorChanged)
     {
+        Director::getInstance()->getRenderer()->flush();
         if (_scissorRestored) {//restore the parent's scissor rect
             EGLView::getInstance()->setScissorInPoints(_parentScissorRect.origin.x, _parentScissorRect.origin.y, _parentScissorRect.size.width, _parentScissorRect.size.height);
         }
         else {
-            glDisable(GL_SCISSOR_TEST);
+            GL::disable(GL_SCISSOR_TEST);
         }
+        _scissorChanged = false;
     }
 }
 
+void ScrollView::visitContainer()
+{
+    // a custom container is visited as usual, it may override visit()
+    GridBase* grid = _container->getGrid();
+    if (!_cullingChildren || !_ownsContainer || !_clippingToBounds || (grid && grid->isActive()))
+    {
+        _container->visit();
+        return;
+    }
+    if (!_container->isVisible())
+    {
+        return;
+    }
+
+    // the view in the space of the container, where the bounding boxes of its children are
+    Rect viewRect = RectApplyAffineTransform(Rect(0, 0, _viewSize.width, _viewSize.height), _container->getParentToNodeTransform());
+
+    kmGLPushMatrix();
+    _container->transform();
+
+    auto& children = _container->getChildren();
+    unsigned int i = 0;
+
+    _container->sortAllChildren();
+    // draw children zOrder < 0
+    for( ; i < children.size(); i++ )
+    {
+        Node* child = children.at(i);
+        if (child->getZOrder() >= 0)
+        {
+            break;
+        }
+        if (isInView(child, viewRect))
+        {
+            child->visit();
+        }
+    }
+
+    _container->draw();
+
+    for( ; i < children.size(); i++ )
+    {
+        Node* child = children.at(i);
+        if (isInView(child, viewRect))
+        {
+            child->visit();
+        }
+    }
+
+    kmGLPopMatrix();
+}
+
 void ScrollView::visit()
 {
 	// quick return if not visible
@@ -551,18 +625,28 @@ void ScrollView::visit()
 	this->transform();
     this->beforeDraw();
 
-	if(_children)
+    if (_clippedOut)
+    {
+        // nothing of the view is inside the scissor rect of its parents
+    }
+	else if(!_children.empty())
     {
-		ccArray *arrayData = _children->data;
 		unsigned int i=0;
 		
 		// draw children zOrder < 0
-		for( ; i < arrayData->num; i++ )
+		for( ; i < _children.size(); i++ )
         {
-			Node *child =  (Node*)arrayData->arr[i];
+			Node *child = _children.at(i);
 			if ( child->getZOrder() < 0 )
             {
-				child->visit();
+				if (child == _container)
+                {
+                    this->visitContainer();
+                }
+                else
+                {
+                    child->visit();
+                }
 			}
             else
             {
@@ -574,10 +658,17 @@ void ScrollView::visit()
 		this->draw();
 		
 		// draw children zOrder >= 0
-		for( ; i < arrayData->num; i++ )
+		for( ; i < _children.size(); i++ )
         {
-			Node* child = (Node*)arrayData->arr[i];
-			child->visit();
+			Node* child = _children.at(i);
+			if (child == _container)
+            {
+                this->visitContainer();
+            }
+            else
+            {
+                child->visit();
+            }
 		}
         
 	}
@@ -729,7 +820,16 @@ void ScrollView::ccTouchEnded(Touch* touch, Event* event)
     {
         if (_touches->count() == 1 && _touchMoved)
         {
-            this->schedule(schedule_selector(ScrollView::deaccelerateScrolling));
+            if (fabsf(_scrollDistance.x) <= SCROLL_DEACCEL_DIST &&
+                fabsf(_scrollDistance.y) <= SCROLL_DEACCEL_DIST)
+            {
+                // released at rest, there is nothing to deaccelerate
+                this->relocateContainer(true);
+            }
+            else
+            {
+                this->schedule(schedule_selector(ScrollView::deaccelerateScrolling));
+            }
         }
         _touches->removeObject(touch);
     } 
@@ -757,28 +857,9 @@ void ScrollView::ccTouchCancelled(Touch* touch, Event* event)
 
 Rect ScrollView::getViewRect()
 {
-    Point screenPos = this->convertToWorldSpace(Point::ZERO);
-    
-    float scaleX = this->getScaleX();
-    float scaleY = this->getScaleY();
-    
-    for (Node *p = _parent; p != NULL; p = p->getParent()) {
-        scaleX *= p->getScaleX();
-        scaleY *= p->getScaleY();
-    }
-
-    // Support negative scaling. Not doing so causes intersectsRect calls
-    // (eg: to check if the touch was within the bounds) to return false.
-    // Note, Node::getScale will assert if X and Y scales are different.
-    if(scaleX<0.f) {
-        screenPos.x += _viewSize.width*scaleX;
-        scaleX = -scaleX;
-    }
-    if(scaleY<0.f) {
-        screenPos.y += _viewSize.height*scaleY;
-        scaleY = -scaleY;
-    }
-
-    return Rect(screenPos.x, screenPos.y, _viewSize.width*scaleX, _viewSize.height*scaleY);
+    // bounding box of the view in world space, a single walk up the parents.
+    // It also supports negative scaling, which would otherwise make intersectsRect calls
+    // (eg: to check if the touch was within the bounds) return false.
+    return RectApplyAffineTransform(Rect(0, 0, _viewSize.width, _viewSize.height), this->getNodeToWorldTransform());
 }
 NS_CC_EXT_END
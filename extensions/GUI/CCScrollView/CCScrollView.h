@@ -186,6 +186,14 @@ public:
     bool isClippingToBounds() { return _clippingToBounds; }
     void setClippingToBounds(bool bClippingToBounds) { _clippingToBounds = bClippingToBounds; }
 
+    /**
+     * Determines whether the children of the container that are out of the view are skipped when clipping.
+     * A child is out of the view when its bounding box is, so its own children must be drawn inside of it.
+     * It only applies to the container created by the scroll view. Disabled by default.
+     */
+    bool isCullingChildren() { return _cullingChildren; }
+    void setCullingChildren(bool bCullingChildren) { _cullingChildren = bCullingChildren; }
+
     // Overrides
     virtual bool ccTouchBegan(Touch *pTouch, Event *pEvent) override;
     virtual void ccTouchMoved(Touch *pTouch, Event *pEvent) override;
@@ -230,6 +238,10 @@ protected:
      * other nodes.
      */
     void afterDraw();
+    /**
+     * visits the container, skipping its children that are out of the view.
+     */
+    void visitContainer();
     /**
      * Zoom handling
      */
@@ -319,6 +331,19 @@ protected:
      */
     Rect _parentScissorRect;
     bool _scissorRestored;
+    /**
+     * whether beforeDraw changed the scissor test, which afterDraw then restores
+     */
+    bool _scissorChanged;
+    /**
+     * whether the view is outside of the scissor rect of its parents, in which case nothing is drawn
+     */
+    bool _clippedOut;
+    /**
+     * whether the container was created by the scroll view, in which case its children out of the view aren't visited
+     */
+    bool _ownsContainer;
+    bool _cullingChildren;
 };
 
 // end of GUI group
@@ -68,6 +68,9 @@ bool TableView::initWithViewSize(Size size, Node* container/* = NULL*/)
 TableView::TableView()
 : _touchedCell(nullptr)
 , _indices(nullptr)
+, _cellsPositionsValid(0)
+, _cellsTotalSize(0.0f)
+, _prefetchDistance(0.0f)
 , _cellsUsed(nullptr)
 , _cellsFreed(nullptr)
 , _dataSource(nullptr)
@@ -160,6 +163,11 @@ void TableView::updateCellAtIndex(unsigned int idx)
     {
         this->_moveCellOutOfSight(cell);
     }
+    if (idx < _vCellsSizes.size() && this->_measureCell(idx))
+    {
+        this->_updateContentSize();
+        this->_relayoutCellsUsed();
+    }
     cell = _dataSource->tableCellAtIndex(this, idx);
     this->_setIndexForCell(idx, cell);
     this->_addCellIfNecessary(cell);
@@ -181,26 +189,37 @@ void TableView::insertCellAtIndex(unsigned  int idx)
     TableViewCell* cell = NULL;
     int newIdx = 0;
 
+    if (_vCellsSizes.size() + 1 == uCountOfItems)
+    {
+        this->_insertCellSize(idx);
+    }
+    else
+    {
+        this->_updateCellPositions();
+    }
+
     cell = (TableViewCell*)_cellsUsed->objectWithObjectID(idx);
     if (cell)
     {
         newIdx = _cellsUsed->indexOfSortedObject(cell);
-        for (unsigned int i=newIdx; i<_cellsUsed->count(); i++)
+        // shift from the end, so each index is inserted before the one it replaces is erased
+        for (int i=_cellsUsed->count()-1; i>=newIdx; i--)
         {
             cell = (TableViewCell*)_cellsUsed->objectAtIndex(i);
-            this->_setIndexForCell(cell->getIdx()+1, cell);
+            _indices->insert(cell->getIdx()+1);
+            _indices->erase(cell->getIdx());
+            cell->setIdx(cell->getIdx()+1);
         }
     }
 
- //   [_indices shiftIndexesStartingAtIndex:idx by:1];
-
     //insert a new cell
+    this->_measureCell(idx);
     cell = _dataSource->tableCellAtIndex(this, idx);
     this->_setIndexForCell(idx, cell);
     this->_addCellIfNecessary(cell);
 
-    this->_updateCellPositions();
     this->_updateContentSize();
+    this->_relayoutCellsUsed();
 }
 
 void TableView::removeCellAtIndex(unsigned int idx)
@@ -229,14 +248,21 @@ void TableView::removeCellAtIndex(unsigned int idx)
     //remove first
     this->_moveCellOutOfSight(cell);
 
-    _indices->erase(idx);
-    this->_updateCellPositions();
-//    [_indices shiftIndexesStartingAtIndex:idx+1 by:-1];
-    for (unsigned int i=_cellsUsed->count()-1; i > newIdx; i--)
+    if (idx < _vCellsSizes.size())
+    {
+        this->_removeCellSize(idx);
+    }
+    // the cells after the removed one now start at newIdx, shift them from the front
+    for (unsigned int i=newIdx; i < _cellsUsed->count(); i++)
     {
         cell = (TableViewCell*)_cellsUsed->objectAtIndex(i);
-        this->_setIndexForCell(cell->getIdx()-1, cell);
+        _indices->insert(cell->getIdx()-1);
+        _indices->erase(cell->getIdx());
+        cell->setIdx(cell->getIdx()-1);
     }
+
+    this->_updateContentSize();
+    this->_relayoutCellsUsed();
 }
 
 TableViewCell *TableView::dequeueCell()
@@ -272,7 +298,7 @@ void TableView::_updateContentSize()
 
     if (cellsCount > 0)
     {
-        float maxPosition = _vCellsPositions[cellsCount];
+        float maxPosition = _cellsTotalSize;
 
         switch (this->getDirection())
         {
@@ -306,10 +332,18 @@ Point TableView::_offsetFromIndex(unsigned int index)
 {
     Point offset = this->__offsetFromIndex(index);
 
-    const Size cellSize = _dataSource->tableCellSizeForIndex(this, index);
     if (_vordering == VerticalFillOrder::TOP_DOWN)
     {
-        offset.y = this->getContainer()->getContentSize().height - offset.y - cellSize.height;
+        float cellHeight;
+        if (this->getDirection() == Direction::HORIZONTAL)
+        {
+            cellHeight = _dataSource->tableCellSizeForIndex(this, index).height;
+        }
+        else
+        {
+            cellHeight = _vCellsSizes[index];
+        }
+        offset.y = this->getContainer()->getContentSize().height - offset.y - cellHeight;
     }
     return offset;
 }
@@ -322,10 +356,10 @@ Point TableView::__offsetFromIndex(unsigned int index)
     switch (this->getDirection())
     {
         case Direction::HORIZONTAL:
-            offset = Point(_vCellsPositions[index], 0.0f);
+            offset = Point(this->_cellPosition(index), 0.0f);
             break;
         default:
-            offset = Point(0.0f, _vCellsPositions[index]);
+            offset = Point(0.0f, this->_cellPosition(index));
             break;
     }
 
@@ -356,8 +390,7 @@ unsigned int TableView::_indexFromOffset(Point offset)
 
 int TableView::__indexFromOffset(Point offset)
 {
-    int low = 0;
-    int high = _dataSource->numberOfCellsInTableView(this) - 1;
+    const unsigned int cellsCount = _vCellsSizes.size();
     float search;
     switch (this->getDirection())
     {
@@ -369,6 +402,15 @@ int TableView::__indexFromOffset(Point offset)
             break;
     }
 
+    // only sum the positions up to the searched offset, the cells after it don't matter yet
+    while (_cellsPositionsValid < cellsCount && _vCellsPositions[_cellsPositionsValid] <= search)
+    {
+        this->_cellPosition(_cellsPositionsValid + 1);
+    }
+
+    int low = 0;
+    int high = (int)_cellsPositionsValid - 1;
+
     while (high >= low)
     {
         int index = low + (high - low) / 2;
@@ -420,30 +462,101 @@ void TableView::_setIndexForCell(unsigned int index, TableViewCell *cell)
 }
 
 void TableView::_updateCellPositions() {
-    int cellsCount = _dataSource->numberOfCellsInTableView(this);
-    _vCellsPositions.resize(cellsCount + 1, 0.0);
+    unsigned int cellsCount = _dataSource->numberOfCellsInTableView(this);
+    const float estimate = this->_estimatedCellSize();
 
-    if (cellsCount > 0)
+    _vCellsPositions.assign(cellsCount + 1, 0.0f);//1 extra value allows us to get right/bottom of the last cell
+    _vCellsSizes.assign(cellsCount, estimate);
+    _vCellsMeasured.assign(cellsCount, false);
+    _cellsPositionsValid = 0;
+    _cellsTotalSize = estimate * cellsCount;
+
+    if (estimate <= 0.0f)
     {
-        float currentPos = 0;
-        Size cellSize;
-        for (int i=0; i < cellsCount; i++)
+        // without an estimate all the cells are measured up front
+        for (unsigned int i=0; i < cellsCount; i++)
         {
-            _vCellsPositions[i] = currentPos;
-            cellSize = _dataSource->tableCellSizeForIndex(this, i);
-            switch (this->getDirection())
-            {
-                case Direction::HORIZONTAL:
-                    currentPos += cellSize.width;
-                    break;
-                default:
-                    currentPos += cellSize.height;
-                    break;
-            }
+            this->_measureCell(i);
         }
-        _vCellsPositions[cellsCount] = currentPos;//1 extra value allows us to get right/bottom of the last cell
+        _cellsTotalSize = this->_cellPosition(cellsCount);
     }
+}
 
+float TableView::_estimatedCellSize()
+{
+    const Size estimatedSize = _dataSource->estimatedCellSizeForTable(this);
+    switch (this->getDirection())
+    {
+        case Direction::HORIZONTAL:
+            return estimatedSize.width;
+        default:
+            return estimatedSize.height;
+    }
+}
+
+float TableView::_cellPosition(unsigned int index)
+{
+    if (index > _cellsPositionsValid)
+    {
+        for (unsigned int i=_cellsPositionsValid; i < index; i++)
+        {
+            _vCellsPositions[i + 1] = _vCellsPositions[i] + _vCellsSizes[i];
+        }
+        _cellsPositionsValid = index;
+    }
+    return _vCellsPositions[index];
+}
+
+bool TableView::_measureCell(unsigned int index)
+{
+    if (_vCellsMeasured[index])
+    {
+        return false;
+    }
+    _vCellsMeasured[index] = true;
+
+    const Size cellSize = _dataSource->tableCellSizeForIndex(this, index);
+    const float size = (this->getDirection() == Direction::HORIZONTAL) ? cellSize.width : cellSize.height;
+    if (size == _vCellsSizes[index])
+    {
+        return false;
+    }
+
+    _cellsTotalSize += size - _vCellsSizes[index];
+    _vCellsSizes[index] = size;
+    _cellsPositionsValid = MIN(_cellsPositionsValid, index);
+    return true;
+}
+
+void TableView::_insertCellSize(unsigned int index)
+{
+    const float estimate = this->_estimatedCellSize();
+
+    _vCellsSizes.insert(_vCellsSizes.begin() + index, estimate);
+    _vCellsMeasured.insert(_vCellsMeasured.begin() + index, false);
+    _vCellsPositions.push_back(0.0f);
+    _cellsTotalSize += estimate;
+    _cellsPositionsValid = MIN(_cellsPositionsValid, index);
+}
+
+void TableView::_removeCellSize(unsigned int index)
+{
+    _cellsTotalSize -= _vCellsSizes[index];
+
+    _vCellsSizes.erase(_vCellsSizes.begin() + index);
+    _vCellsMeasured.erase(_vCellsMeasured.begin() + index);
+    _vCellsPositions.pop_back();
+    _cellsPositionsValid = MIN(_cellsPositionsValid, index);
+}
+
+void TableView::_relayoutCellsUsed()
+{
+    Object* pObj = NULL;
+    CCARRAY_FOREACH(_cellsUsed, pObj)
+    {
+        TableViewCell* cell = static_cast<TableViewCell*>(pObj);
+        cell->setPosition(this->_offsetFromIndex(cell->getIdx()));
+    }
 }
 
 void TableView::scrollViewDidScroll(ScrollView* view)
@@ -459,34 +572,59 @@ void TableView::scrollViewDidScroll(ScrollView* view)
     }
 
     unsigned int startIdx = 0, endIdx = 0, idx = 0, maxIdx = 0;
-    Point offset = this->getContentOffset() * -1;
     maxIdx = MAX(uCountOfItems-1, 0);
 
-    if (_vordering == VerticalFillOrder::TOP_DOWN)
+    // the cells in range are measured before being shown, which may move them: repeat until the range is stable
+    bool resized = true;
+    while (resized)
     {
-        offset.y = offset.y + _viewSize.height/this->getContainer()->getScaleY();
-    }
-    startIdx = this->_indexFromOffset(offset);
-	if (startIdx == CC_INVALID_INDEX)
-	{
-		startIdx = uCountOfItems - 1;
-	}
+        Point offset = this->getContentOffset() * -1;
+        offset.x -= _prefetchDistance;
 
-    if (_vordering == VerticalFillOrder::TOP_DOWN)
-    {
-        offset.y -= _viewSize.height/this->getContainer()->getScaleY();
-    }
-    else
-    {
-        offset.y += _viewSize.height/this->getContainer()->getScaleY();
-    }
-    offset.x += _viewSize.width/this->getContainer()->getScaleX();
+        if (_vordering == VerticalFillOrder::TOP_DOWN)
+        {
+            offset.y = offset.y + _viewSize.height/this->getContainer()->getScaleY() + _prefetchDistance;
+        }
+        else
+        {
+            offset.y -= _prefetchDistance;
+        }
+        startIdx = this->_indexFromOffset(offset);
+        if (startIdx == CC_INVALID_INDEX)
+        {
+            startIdx = uCountOfItems - 1;
+        }
 
-    endIdx   = this->_indexFromOffset(offset);
-    if (endIdx == CC_INVALID_INDEX)
-	{
-		endIdx = uCountOfItems - 1;
-	}
+        if (_vordering == VerticalFillOrder::TOP_DOWN)
+        {
+            offset.y -= _viewSize.height/this->getContainer()->getScaleY() + 2 * _prefetchDistance;
+        }
+        else
+        {
+            offset.y += _viewSize.height/this->getContainer()->getScaleY() + 2 * _prefetchDistance;
+        }
+        offset.x += _viewSize.width/this->getContainer()->getScaleX() + 2 * _prefetchDistance;
+
+        endIdx   = this->_indexFromOffset(offset);
+        if (endIdx == CC_INVALID_INDEX)
+        {
+            endIdx = uCountOfItems - 1;
+        }
+
+        resized = false;
+        for (unsigned int i=startIdx; i <= endIdx && i < _vCellsSizes.size(); i++)
+        {
+            if (this->_measureCell(i))
+            {
+                resized = true;
+            }
+        }
+        if (resized)
+        {
+            this->_updateContentSize();
+            this->_relayoutCellsUsed();
+        }
+    }
 
 #if 0 // For Testing.
     Object* pObj;
@@ -106,6 +106,18 @@ public:
     virtual Size cellSizeForTable(TableView *table) {
         return Size::ZERO;
     };
+    /**
+     * estimated cell size for a given table.
+     * When it isn't zero, the cells that weren't shown yet are laid out with this size, and
+     * tableCellSizeForIndex is only asked for a cell when it is about to be shown, so reloading
+     * a long table doesn't measure all of its cells.
+     *
+     * @param table table to hold the instances of Class
+     * @return estimated cell size, or Size::ZERO to measure all the cells on reload
+     */
+    virtual Size estimatedCellSizeForTable(TableView *table) {
+        return Size::ZERO;
+    };
     /**
      * a cell instance at a given index
      *
@@ -178,6 +190,13 @@ public:
     void setVerticalFillOrder(VerticalFillOrder order);
     VerticalFillOrder getVerticalFillOrder();
 
+    /**
+     * distance in points beyond the view where cells are already loaded, so they are ready
+     * before being scrolled into view. 0 by default.
+     */
+    void setPrefetchDistance(float distance) { _prefetchDistance = distance; }
+    float getPrefetchDistance() const { return _prefetchDistance; }
+
     /**
      * Updates the content of the cell at a given index.
      *
@@ -237,9 +256,24 @@ protected:
     std::set<unsigned int>* _indices;
 
     /**
-     * vector with all cell positions
+     * vector with all cell positions, the sums of the sizes of the cells before each of them.
+     * Only the first _cellsPositionsValid + 1 values are up to date, the others are computed when asked for.
      */
     std::vector<float> _vCellsPositions;
+    /**
+     * size of each cell along the direction of the table, estimated until the cell is measured
+     */
+    std::vector<float> _vCellsSizes;
+    /**
+     * whether the size of each cell was asked to the data source
+     */
+    std::vector<bool> _vCellsMeasured;
+    unsigned int _cellsPositionsValid;
+    /**
+     * sum of the sizes of all cells
+     */
+    float _cellsTotalSize;
+    float _prefetchDistance;
     //NSMutableIndexSet *indices_;
     /**
      * cells that are currently in the table
@@ -269,6 +303,13 @@ protected:
     void _setIndexForCell(unsigned int index, TableViewCell *cell);
     void _addCellIfNecessary(TableViewCell * cell);
 
+    float _cellPosition(unsigned int index);
+    float _estimatedCellSize();
+    bool _measureCell(unsigned int index);
+    void _insertCellSize(unsigned int index);
+    void _removeCellSize(unsigned int index);
+    void _relayoutCellsUsed();
+
     void _updateCellPositions();
 public:
     void _updateContentSize();
@@ -28,6 +28,7 @@
  */
 
 #include "cocos2d.h"
+#include "LocalStorage.h"
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID && CC_TARGET_PLATFORM != CC_PLATFORM_TIZEN)
 
@@ -35,12 +36,40 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <sqlite3.h>
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 static int _initialized = 0;
 static sqlite3 *_db;
 static sqlite3_stmt *_stmt_select;
 static sqlite3_stmt *_stmt_remove;
 static sqlite3_stmt *_stmt_update;
+static sqlite3_stmt *_stmt_begin;
+static sqlite3_stmt *_stmt_commit;
+static int _transactionDepth = 0;
+
+// guards the connection and the statements, used by the writer thread in write-behind mode
+static std::mutex _dbMutex;
+
+// write-behind: the items set or removed, until the writer thread writes them
+struct PendingItem
+{
+	std::string value;
+	bool removed;
+	unsigned int version;
+};
+static bool _writeBehind = false;
+static std::map<std::string, PendingItem> _pendingItems;
+static unsigned int _pendingVersion = 0;
+static std::mutex _pendingMutex;
+static std::condition_variable _pendingCondition;
+static std::condition_variable _writtenCondition;
+static std::thread *_writer = nullptr;
+static bool _quitWriter = false;
+static std::string _pendingValue;
 
 
 static void localStorageCreateTable()
@@ -55,6 +84,81 @@ static void localStorageCreateTable()
 		printf("Error in CREATE TABLE\n");
 }
 
+static int localStorageStep(sqlite3_stmt *stmt)
+{
+	int ok = sqlite3_step(stmt);
+	ok |= sqlite3_reset(stmt);
+	return ok;
+}
+
+static void localStorageWriteItem( const char *key, const char *value)
+{
+	int ok = sqlite3_bind_text(_stmt_update, 1, key, -1, SQLITE_TRANSIENT);
+	ok |= sqlite3_bind_text(_stmt_update, 2, value, -1, SQLITE_TRANSIENT);
+
+	ok |= localStorageStep(_stmt_update);
+	
+	if( ok != SQLITE_OK && ok != SQLITE_DONE)
+		printf("Error in localStorage.setItem()\n");
+}
+
+static void localStorageDeleteItem( const char *key )
+{
+	int ok = sqlite3_bind_text(_stmt_remove, 1, key, -1, SQLITE_TRANSIENT);
+	
+	ok |= localStorageStep(_stmt_remove);
+
+	if( ok != SQLITE_OK && ok != SQLITE_DONE)
+		printf("Error in localStorage.removeItem()\n");
+}
+
+// writes the pending items in batches, each one in a transaction
+static void localStorageWriterLoop()
+{
+	std::unique_lock<std::mutex> lock(_pendingMutex);
+	while( true ) {
+		_pendingCondition.wait(lock, []{ return _quitWriter || ! _pendingItems.empty(); });
+		if( _pendingItems.empty() )
+			break;
+
+		// the items stay visible to localStorageGetItem() until they are written
+		std::map<std::string, PendingItem> items(_pendingItems);
+		lock.unlock();
+
+		{
+			std::lock_guard<std::mutex> dbLock(_dbMutex);
+			localStorageStep(_stmt_begin);
+			for( auto iter = items.begin(); iter != items.end(); ++iter ) {
+				if( iter->second.removed )
+					localStorageDeleteItem(iter->first.c_str());
+				else
+					localStorageWriteItem(iter->first.c_str(), iter->second.value.c_str());
+			}
+			if( localStorageStep(_stmt_commit) != SQLITE_DONE )
+				printf("Error in localStorage write-behind\n");
+		}
+
+		lock.lock();
+		// the items set again meanwhile are written by the next batch
+		for( auto iter = items.begin(); iter != items.end(); ++iter ) {
+			auto pending = _pendingItems.find(iter->first);
+			if( pending != _pendingItems.end() && pending->second.version == iter->second.version )
+				_pendingItems.erase(pending);
+		}
+		_writtenCondition.notify_all();
+	}
+}
+
+static void localStorageQueueItem( const char *key, const char *value)
+{
+	std::lock_guard<std::mutex> lock(_pendingMutex);
+	PendingItem& item = _pendingItems[key];
+	item.removed = (value == NULL);
+	item.value = value ? value : "";
+	item.version = ++_pendingVersion;
+	_pendingCondition.notify_one();
+}
+
 void localStorageInit( const char *fullpath)
 {
 	if( ! _initialized ) {
@@ -66,6 +170,12 @@ void localStorageInit( const char *fullpath)
 		else
 			ret = sqlite3_open(fullpath, &_db);
 
+		// with a write-ahead log, a commit appends to the log and doesn't wait for the disk
+		if (fullpath) {
+			sqlite3_exec(_db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL);
+			sqlite3_exec(_db, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
+		}
+
 		localStorageCreateTable();
 
 		// SELECT
@@ -80,6 +190,10 @@ void localStorageInit( const char *fullpath)
 		const char *sql_remove = "DELETE FROM data WHERE key=?;";
 		ret |= sqlite3_prepare_v2(_db, sql_remove, -1, &_stmt_remove, NULL);
 
+		// TRANSACTION
+		ret |= sqlite3_prepare_v2(_db, "BEGIN;", -1, &_stmt_begin, NULL);
+		ret |= sqlite3_prepare_v2(_db, "COMMIT;", -1, &_stmt_commit, NULL);
+
 		if( ret != SQLITE_OK ) {
 			printf("Error initializing DB\n");
 			// report error
@@ -92,9 +206,29 @@ void localStorageInit( const char *fullpath)
 void localStorageFree()
 {
 	if( _initialized ) {
+		if( _writer ) {
+			{
+				std::lock_guard<std::mutex> lock(_pendingMutex);
+				_quitWriter = true;
+				_pendingCondition.notify_one();
+			}
+			_writer->join();
+			delete _writer;
+			_writer = nullptr;
+			_quitWriter = false;
+		}
+		_writeBehind = false;
+
+		if( _transactionDepth > 0 ) {
+			localStorageStep(_stmt_commit);
+			_transactionDepth = 0;
+		}
+
 		sqlite3_finalize(_stmt_select);
 		sqlite3_finalize(_stmt_remove);
 		sqlite3_finalize(_stmt_update);		
+		sqlite3_finalize(_stmt_begin);
+		sqlite3_finalize(_stmt_commit);
 
 		sqlite3_close(_db);
 		
@@ -107,15 +241,13 @@ void localStorageSetItem( const char *key, const char *value)
 {
 	assert( _initialized );
 	
-	int ok = sqlite3_bind_text(_stmt_update, 1, key, -1, SQLITE_TRANSIENT);
-	ok |= sqlite3_bind_text(_stmt_update, 2, value, -1, SQLITE_TRANSIENT);
+	if( _writeBehind ) {
+		localStorageQueueItem(key, value);
+		return;
+	}
 
-	ok |= sqlite3_step(_stmt_update);
-	
-	ok |= sqlite3_reset(_stmt_update);
-	
-	if( ok != SQLITE_OK && ok != SQLITE_DONE)
-		printf("Error in localStorage.setItem()\n");
+	std::lock_guard<std::mutex> dbLock(_dbMutex);
+	localStorageWriteItem(key, value);
 }
 
 /** gets an item from the LS */
@@ -123,6 +255,19 @@ const char* localStorageGetItem( const char *key )
 {
 	assert( _initialized );
 
+	if( _writeBehind ) {
+		std::lock_guard<std::mutex> lock(_pendingMutex);
+		auto pending = _pendingItems.find(key);
+		if( pending != _pendingItems.end() ) {
+			if( pending->second.removed )
+				return NULL;
+			_pendingValue = pending->second.value;
+			return _pendingValue.c_str();
+		}
+	}
+
+	std::lock_guard<std::mutex> dbLock(_dbMutex);
+
 	int ok = sqlite3_reset(_stmt_select);
 
 	ok |= sqlite3_bind_text(_stmt_select, 1, key, -1, SQLITE_TRANSIENT);
@@ -141,14 +286,70 @@ void localStorageRemoveItem( const char *key )
 {
 	assert( _initialized );
 
-	int ok = sqlite3_bind_text(_stmt_remove, 1, key, -1, SQLITE_TRANSIENT);
-	
-	ok |= sqlite3_step(_stmt_remove);
-	
-	ok |= sqlite3_reset(_stmt_remove);
+	if( _writeBehind ) {
+		localStorageQueueItem(key, NULL);
+		return;
+	}
 
-	if( ok != SQLITE_OK && ok != SQLITE_DONE)
-		printf("Error in localStorage.removeItem()\n");
+	std::lock_guard<std::mutex> dbLock(_dbMutex);
+	localStorageDeleteItem(key);
+}
+
+/** starts a transaction */
+void localStorageBeginTransaction()
+{
+	assert( _initialized );
+
+	if( _writeBehind )
+		return;
+
+	std::lock_guard<std::mutex> dbLock(_dbMutex);
+	if( _transactionDepth++ == 0 && localStorageStep(_stmt_begin) != SQLITE_DONE )
+		printf("Error in localStorage.beginTransaction()\n");
+}
+
+/** commits the transaction */
+void localStorageCommit()
+{
+	assert( _initialized );
+
+	if( _writeBehind || _transactionDepth == 0 )
+		return;
+
+	std::lock_guard<std::mutex> dbLock(_dbMutex);
+	if( --_transactionDepth == 0 && localStorageStep(_stmt_commit) != SQLITE_DONE )
+		printf("Error in localStorage.commit()\n");
+}
+
+/** enables or disables the write-behind mode */
+void localStorageSetWriteBehind( bool enabled )
+{
+	assert( _initialized );
+
+	if( enabled == _writeBehind )
+		return;
+
+	if( enabled ) {
+		// the open transaction would hold the items of the writer thread
+		while( _transactionDepth > 0 )
+			localStorageCommit();
+
+		if( ! _writer )
+			_writer = new std::thread(localStorageWriterLoop);
+	}
+	else {
+		localStorageFlush();
+	}
+	_writeBehind = enabled;
+}
+
+/** waits until the pending items are written */
+void localStorageFlush()
+{
+	assert( _initialized );
+
+	std::unique_lock<std::mutex> lock(_pendingMutex);
+	_writtenCondition.wait(lock, []{ return _pendingItems.empty(); });
 }
 
 #endif // #if (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
@@ -48,4 +48,18 @@ const char* localStorageGetItem( const char *key );
 /** removes an item from the LS */
 void localStorageRemoveItem( const char *key );
 
+/** Starts a transaction: the items set or removed until localStorageCommit() are written at once, with a single
+    sync of the disk instead of one per item. Transactions can be nested, the outermost one is committed. */
+void localStorageBeginTransaction();
+
+/** Commits the transaction started by localStorageBeginTransaction() */
+void localStorageCommit();
+
+/** When enabled, the items are set and removed by a background thread, in batches. Getting an item returns the
+    last value set, even if it isn't written yet. Transactions aren't needed then, and are ignored. Disabled by default. */
+void localStorageSetWriteBehind( bool enabled );
+
+/** Waits until the items set or removed in write-behind mode are written */
+void localStorageFlush();
+
 #endif // __JSB_LOCALSTORAGE_H
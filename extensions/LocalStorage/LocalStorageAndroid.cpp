@@ -29,6 +29,7 @@
  */
 
 #include "cocos2d.h"
+#include "LocalStorage.h"
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 
@@ -141,4 +142,45 @@ void localStorageRemoveItem( const char *key )
 
 }
 
+static void localStorageCallVoidMethod( const char *name )
+{
+	assert( _initialized );
+    JniMethodInfo t;
+
+    if (JniHelper::getStaticMethodInfo(t, "org/cocos2dx/lib/Cocos2dxLocalStorage", name, "()V")) {
+        t.env->CallStaticVoidMethod(t.classID, t.methodID);
+        t.env->DeleteLocalRef(t.classID);
+    }
+}
+
+/** starts a transaction */
+void localStorageBeginTransaction()
+{
+    localStorageCallVoidMethod("beginTransaction");
+}
+
+/** commits the transaction */
+void localStorageCommit()
+{
+    localStorageCallVoidMethod("commit");
+}
+
+/** enables or disables the write-behind mode */
+void localStorageSetWriteBehind( bool enabled )
+{
+	assert( _initialized );
+    JniMethodInfo t;
+
+    if (JniHelper::getStaticMethodInfo(t, "org/cocos2dx/lib/Cocos2dxLocalStorage", "setWriteBehind", "(Z)V")) {
+        t.env->CallStaticVoidMethod(t.classID, t.methodID, (jboolean)enabled);
+        t.env->DeleteLocalRef(t.classID);
+    }
+}
+
+/** waits until the pending items are written */
+void localStorageFlush()
+{
+    localStorageCallVoidMethod("flush");
+}
+
 #endif // #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
@@ -46,6 +46,7 @@
 #if CC_ENABLE_CHIPMUNK_INTEGRATION || CC_ENABLE_BOX2D_INTEGRATION
 #include "physics_nodes/CCPhysicsDebugNode.h"
 #include "physics_nodes/CCPhysicsSprite.h"
+#include "physics_nodes/CCPhysicsStepper.h"
 #endif
 
 #include "spine/spine-cocos2dx.h"
@@ -25,8 +25,17 @@
 
 #include "HttpClient.h"
 #include <thread>
-#include <queue>
+#include <deque>
+#include <algorithm>
+#include <unordered_map>
 #include <errno.h>
+#include <stdio.h>
+#include <time.h>
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
 
 #include "curl/curl.h"
 
@@ -34,10 +43,10 @@
 
 NS_CC_EXT_BEGIN
 
+// guards the request queue and the worker counts
 static std::mutex       s_requestQueueMutex;
 static std::mutex       s_responseQueueMutex;
 
-static std::mutex		s_SleepMutex;
 static std::condition_variable		s_SleepCondition;
 
 static unsigned long    s_asyncRequestCount = 0;
@@ -48,17 +57,43 @@ typedef int int32_t;
 
 static bool s_need_quit = false;
 
-static Array* s_requestQueue = NULL;
+// sorted by priority, retained
+static std::deque<HttpRequest*> s_requestQueue;
 static Array* s_responseQueue = NULL;
 
-static HttpClient *s_pHttpClient = NULL; // pointer to singleton
+static int s_workerCount = 0;
+static int s_idleWorkerCount = 0;
+static int s_maxWorkerCount = 4;
 
-static char s_errorBuffer[CURL_ERROR_SIZE];
+// DNS cache, TLS sessions and cookies shared by the handles of the workers
+static CURLSH *s_share = NULL;
+static std::mutex s_shareMutexes[CURL_LOCK_DATA_LAST];
+
+static HttpClient *s_pHttpClient = NULL; // pointer to singleton
 
 typedef size_t (*write_callback)(void *ptr, size_t size, size_t nmemb, void *stream);
 
 static std::string s_cookieFilename = "";
 
+// Response cache, see HttpClient::enableResponseCache(). The bodies are stored in numbered files
+// next to an index of their urls and validators
+struct CacheEntry
+{
+    unsigned long id;           // the body is stored in "<id>.data"
+    std::string etag;
+    std::string lastModified;
+    time_t expires;             // fresh until then, revalidated afterwards
+    time_t lastUsed;
+    long size;
+};
+
+static std::mutex s_cacheMutex;
+static std::string s_cachePath;    // empty if the cache is disabled
+static long s_cacheMaxSize = 0;
+static long s_cacheSize = 0;
+static unsigned long s_cacheNextId = 1;
+static std::unordered_map<std::string, CacheEntry> s_cacheEntries; // by url
+
 // Callback function used by libcurl for collect response data
 static size_t writeData(void *ptr, size_t size, size_t nmemb, void *stream)
 {
@@ -86,49 +121,454 @@ static size_t writeHeaderData(void *ptr, size_t size, size_t nmemb, void *stream
 }
 
 
-static int processGetTask(HttpRequest *request, write_callback callback, void *stream, int32_t *errorCode, write_callback headerCallback, void *headerStream);
-static int processPostTask(HttpRequest *request, write_callback callback, void *stream, int32_t *errorCode, write_callback headerCallback, void *headerStream);
-static int processPutTask(HttpRequest *request, write_callback callback, void *stream, int32_t *errorCode, write_callback headerCallback, void *headerStream);
-static int processDeleteTask(HttpRequest *request, write_callback callback, void *stream, int32_t *errorCode, write_callback headerCallback, void *headerStream);
-// int processDownloadTask(HttpRequest *task, write_callback callback, void *stream, int32_t *errorCode);
+// Writes the body of a response to a file and/or a StreamCallback
+struct ResponseStream
+{
+    CURL *handle;
+    std::string path;
+    FILE *file;
+    curl_off_t resumeFrom;
+    bool started;
+    bool discarded;
+    HttpRequest::StreamCallback callback;
+    HttpRequest::StreamStartCallback startCallback;
+};
 
+// Callback function used by libcurl for streaming response data
+static size_t writeStreamData(void *ptr, size_t size, size_t nmemb, void *stream)
+{
+    ResponseStream *responseStream = (ResponseStream*)stream;
+    size_t sizes = size * nmemb;
+    
+    if (!responseStream->started)
+    {
+        responseStream->started = true;
+        
+        long code = 0;
+        curl_easy_getinfo(responseStream->handle, CURLINFO_RESPONSE_CODE, &code);
+        if (responseStream->startCallback)
+        {
+            double length = -1;
+            curl_easy_getinfo(responseStream->handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length);
+            responseStream->startCallback(code, length);
+        }
+        // the body of an error isn't written
+        responseStream->discarded = code < 200 || code >= 300;
+        if (!responseStream->discarded && !responseStream->path.empty())
+        {
+            // without 206 the server ignored the range and sends the whole file
+            bool append = responseStream->resumeFrom > 0 && code == 206;
+            responseStream->file = fopen(responseStream->path.c_str(), append ? "ab" : "wb");
+            if (!responseStream->file)
+            {
+                return 0;
+            }
+        }
+    }
+    
+    if (responseStream->discarded)
+    {
+        return sizes;
+    }
+    if (responseStream->file && fwrite(ptr, 1, sizes, responseStream->file) != sizes)
+    {
+        return 0;
+    }
+    if (responseStream->callback && !responseStream->callback((const char*)ptr, sizes))
+    {
+        return 0;
+    }
+    return sizes;
+}
 
-// Worker thread
-static void networkThread(void)
-{    
-    HttpRequest *request = NULL;
+static bool createCacheDirectory(const std::string& path)
+{
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+    mode_t processMask = umask(0);
+    int ret = mkdir(path.c_str(), S_IRWXU | S_IRWXG | S_IRWXO);
+    umask(processMask);
+    return ret == 0 || errno == EEXIST;
+#else
+    BOOL ret = CreateDirectoryA(path.c_str(), NULL);
+    return ret || ERROR_ALREADY_EXISTS == GetLastError();
+#endif
+}
+
+static std::string getCacheFile(unsigned long id)
+{
+    char name[32];
+    sprintf(name, "%lu.data", id);
+    return s_cachePath + name;
+}
+
+// One line per entry: id, expires, last use, size, ETag, Last-Modified and url, separated by tabs.
+// Written to a temporary file first, so that a crash never leaves a truncated index. s_cacheMutex must be locked
+static void writeCacheIndex()
+{
+    std::string path = s_cachePath + "index.txt";
+    std::string temporary = path + ".tmp";
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (!file)
+    {
+        return;
+    }
+    for (const auto& it : s_cacheEntries)
+    {
+        const CacheEntry& entry = it.second;
+        fprintf(file, "%lu\t%ld\t%ld\t%ld\t%s\t%s\t%s\n", entry.id, (long)entry.expires, (long)entry.lastUsed, entry.size,
+                entry.etag.c_str(), entry.lastModified.c_str(), it.first.c_str());
+    }
+    fclose(file);
+    remove(path.c_str());
+    rename(temporary.c_str(), path.c_str());
+}
+
+// s_cacheMutex must be locked
+static void readCacheIndex()
+{
+    s_cacheEntries.clear();
+    s_cacheSize = 0;
     
-    while (true) 
+    FILE *file = fopen((s_cachePath + "index.txt").c_str(), "rb");
+    if (!file)
     {
-        if (s_need_quit)
+        return;
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), file))
+    {
+        std::vector<std::string> fields;
+        char *start = line;
+        for (char *c = line; ; ++c)
         {
-            break;
+            if (*c == '\t' || *c == '\n' || *c == '\r' || *c == 0)
+            {
+                bool end = *c != '\t';
+                fields.push_back(std::string(start, c));
+                start = c + 1;
+                if (end)
+                {
+                    break;
+                }
+            }
         }
-        
-        // step 1: send http request if the requestQueue isn't empty
-        request = NULL;
-        
-        s_requestQueueMutex.lock();
-        
-        //Get request task from queue
-        
-        if (0 != s_requestQueue->count())
+        if (fields.size() != 7 || fields[6].empty())
         {
-            request = dynamic_cast<HttpRequest*>(s_requestQueue->objectAtIndex(0));
-            s_requestQueue->removeObjectAtIndex(0);
+            continue;
         }
+        CacheEntry entry;
+        entry.id = strtoul(fields[0].c_str(), NULL, 10);
+        entry.expires = (time_t)atol(fields[1].c_str());
+        entry.lastUsed = (time_t)atol(fields[2].c_str());
+        entry.size = atol(fields[3].c_str());
+        entry.etag = fields[4];
+        entry.lastModified = fields[5];
+        s_cacheEntries[fields[6]] = entry;
+        s_cacheSize += entry.size;
+        s_cacheNextId = MAX(s_cacheNextId, entry.id + 1);
+    }
+    fclose(file);
+}
+
+// s_cacheMutex must be locked
+static void removeCacheEntry(std::unordered_map<std::string, CacheEntry>::iterator it)
+{
+    remove(getCacheFile(it->second.id).c_str());
+    s_cacheSize -= it->second.size;
+    s_cacheEntries.erase(it);
+}
+
+// Validators and freshness of a response, from its raw headers. Only the last response counts after redirections.
+// Returns false if the response must not be stored (Cache-Control: no-store)
+static bool parseCacheHeaders(const std::vector<char>& header, CacheEntry *entry)
+{
+    time_t now = time(NULL);
+    bool noStore = false;
+    bool noCache = false;
+    long maxAge = -1;
+    time_t expires = 0;
+    
+    size_t start = 0;
+    while (start < header.size())
+    {
+        size_t end = start;
+        while (end < header.size() && header[end] != '\n')
+        {
+            ++end;
+        }
+        std::string line(header.begin() + start, header.begin() + end);
+        start = end + 1;
         
-        s_requestQueueMutex.unlock();
-        
-        if (NULL == request)
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+        {
+            line.erase(line.size() - 1);
+        }
+        if (line.compare(0, 5, "HTTP/") == 0)
         {
-            // Wait for http request tasks from main thread
-            std::unique_lock<std::mutex> lk(s_SleepMutex); 
-            s_SleepCondition.wait(lk);
+            // the headers of a redirection are ignored
+            noStore = noCache = false;
+            maxAge = -1;
+            expires = 0;
+            entry->etag.clear();
+            entry->lastModified.clear();
             continue;
         }
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+        {
+            continue;
+        }
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        size_t valueStart = line.find_first_not_of(' ', colon + 1);
+        std::string value = valueStart == std::string::npos ? "" : line.substr(valueStart);
+        
+        if (name == "etag")
+        {
+            entry->etag = value;
+        }
+        else if (name == "last-modified")
+        {
+            entry->lastModified = value;
+        }
+        else if (name == "expires")
+        {
+            // an invalid date means already expired
+            expires = MAX(curl_getdate(value.c_str(), NULL), (time_t)0);
+        }
+        else if (name == "cache-control")
+        {
+            std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+            noStore = noStore || value.find("no-store") != std::string::npos;
+            noCache = noCache || value.find("no-cache") != std::string::npos;
+            size_t age = value.find("max-age=");
+            if (age != std::string::npos)
+            {
+                maxAge = atol(value.c_str() + age + 8);
+            }
+        }
+    }
+    
+    // max-age overrides Expires, no-cache means that the response is always revalidated
+    if (noCache)
+    {
+        entry->expires = 0;
+    }
+    else if (maxAge >= 0)
+    {
+        entry->expires = now + maxAge;
+    }
+    else
+    {
+        entry->expires = expires;
+    }
+    entry->lastUsed = now;
+    return !noStore;
+}
+
+// Copies the cache entry of url, returns false if there is none
+static bool findCacheEntry(const std::string& url, CacheEntry *entry)
+{
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    if (s_cachePath.empty())
+    {
+        return false;
+    }
+    auto it = s_cacheEntries.find(url);
+    if (it == s_cacheEntries.end())
+    {
+        return false;
+    }
+    it->second.lastUsed = time(NULL);
+    *entry = it->second;
+    return true;
+}
+
+static bool readCacheFile(const CacheEntry& entry, std::vector<char> *data)
+{
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(s_cacheMutex);
+        path = getCacheFile(entry.id);
+    }
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+    data->resize(entry.size);
+    bool ok = entry.size == 0 || fread(&data->front(), 1, entry.size, file) == (size_t)entry.size;
+    fclose(file);
+    return ok;
+}
+
+// Stores the body of a 200 response, unless its headers forbid it or it can't be revalidated
+static void storeCacheEntry(const std::string& url, const std::vector<char>& header, const std::vector<char>& data)
+{
+    CacheEntry entry;
+    // the index holds one url per line
+    bool storable = url.size() < 2048 && parseCacheHeaders(header, &entry)
+                    && (entry.expires > entry.lastUsed || !entry.etag.empty() || !entry.lastModified.empty());
+    
+    std::unique_lock<std::mutex> lock(s_cacheMutex);
+    if (s_cachePath.empty())
+    {
+        return;
+    }
+    auto it = s_cacheEntries.find(url);
+    if (it != s_cacheEntries.end())
+    {
+        removeCacheEntry(it);
+    }
+    if (!storable || (long)data.size() > s_cacheMaxSize)
+    {
+        writeCacheIndex();
+        return;
+    }
+    entry.id = s_cacheNextId++;
+    entry.size = (long)data.size();
+    std::string path = getCacheFile(entry.id);
+    lock.unlock();
+    
+    // the body is written without holding the lock, each store has its own file
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        return;
+    }
+    bool ok = data.empty() || fwrite(&data.front(), 1, data.size(), file) == data.size();
+    fclose(file);
+    
+    lock.lock();
+    it = s_cacheEntries.find(url);
+    if (!ok || s_cachePath.empty() || getCacheFile(entry.id) != path)
+    {
+        // failed, or the cache was disabled or moved meanwhile
+        remove(path.c_str());
+        return;
+    }
+    if (it != s_cacheEntries.end())
+    {
+        removeCacheEntry(it);
+    }
+    s_cacheEntries[url] = entry;
+    s_cacheSize += entry.size;
+    
+    // the least recently used entries are removed beyond the maximum size
+    while (s_cacheSize > s_cacheMaxSize)
+    {
+        auto oldest = s_cacheEntries.begin();
+        for (auto candidate = s_cacheEntries.begin(); candidate != s_cacheEntries.end(); ++candidate)
+        {
+            if (candidate->second.lastUsed < oldest->second.lastUsed)
+            {
+                oldest = candidate;
+            }
+        }
+        removeCacheEntry(oldest);
+    }
+    writeCacheIndex();
+}
+
+// After a 304 response, the cached entry takes the freshness and validators of the new headers
+static void refreshCacheEntry(const std::string& url, const std::vector<char>& header)
+{
+    CacheEntry refreshed;
+    bool storable = parseCacheHeaders(header, &refreshed);
+    
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    auto it = s_cacheEntries.find(url);
+    if (it == s_cacheEntries.end())
+    {
+        return;
+    }
+    if (!storable)
+    {
+        removeCacheEntry(it);
+    }
+    else
+    {
+        CacheEntry& entry = it->second;
+        entry.expires = refreshed.expires;
+        entry.lastUsed = refreshed.lastUsed;
+        if (!refreshed.etag.empty())
+        {
+            entry.etag = refreshed.etag;
+        }
+        if (!refreshed.lastModified.empty())
+        {
+            entry.lastModified = refreshed.lastModified;
+        }
+    }
+    writeCacheIndex();
+}
+
+static void forgetCacheEntry(const std::string& url)
+{
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    auto it = s_cacheEntries.find(url);
+    if (it != s_cacheEntries.end())
+    {
+        removeCacheEntry(it);
+        writeCacheIndex();
+    }
+}
+
+static int processGetTask(CURL *handle, char *errorBuffer, HttpRequest *request, write_callback callback, void *stream, int32_t *errorCode, write_callback headerCallback, void *headerStream, curl_off_t resumeFrom, const std::vector<std::string>& conditionalHeaders);
+static int processPostTask(CURL *handle, char *errorBuffer, HttpRequest *request, write_callback callback, void *stream, int32_t *errorCode, write_callback headerCallback, void *headerStream, curl_off_t resumeFrom);
+static int processPutTask(CURL *handle, char *errorBuffer, HttpRequest *request, write_callback callback, void *stream, int32_t *errorCode, write_callback headerCallback, void *headerStream, curl_off_t resumeFrom);
+static int processDeleteTask(CURL *handle, char *errorBuffer, HttpRequest *request, write_callback callback, void *stream, int32_t *errorCode, write_callback headerCallback, void *headerStream, curl_off_t resumeFrom);
+// int processDownloadTask(HttpRequest *task, write_callback callback, void *stream, int32_t *errorCode);
+
+
+static void lockShare(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+    s_shareMutexes[data].lock();
+}
+
+static void unlockShare(CURL *handle, curl_lock_data data, void *userptr)
+{
+    s_shareMutexes[data].unlock();
+}
+
+// Worker thread, several of them send requests at the same time
+static void networkThread(void)
+{    
+    // kept from a request to the next one, so that its connections are reused
+    CURL *handle = curl_easy_init();
+    char errorBuffer[CURL_ERROR_SIZE];
+    HttpRequest *request = NULL;
+    bool lastWorker = false;
+
+    FrameProfiler::setThreadName("HttpClient");
+    
+    while (true) 
+    {
+        // step 1: get the most important request, waiting for one if the queue is empty
+        request = NULL;
+        {
+            std::unique_lock<std::mutex> lock(s_requestQueueMutex);
+            ++s_idleWorkerCount;
+            while (!s_need_quit && s_requestQueue.empty() && s_workerCount <= s_maxWorkerCount)
+            {
+                s_SleepCondition.wait(lock);
+            }
+            --s_idleWorkerCount;
+            
+            // quit, or too many workers since setMaxConcurrentRequests()
+            if (s_need_quit || s_workerCount > s_maxWorkerCount)
+            {
+                --s_workerCount;
+                lastWorker = s_need_quit && s_workerCount == 0;
+                break;
+            }
+            
+            request = s_requestQueue.front();
+            s_requestQueue.pop_front();
+        }
         
         // step 2: libcurl sync access
+        CC_PROFILE_ZONE("HttpClient - request");
         
         // Create a HttpResponse object, the default setting is http access failed
         HttpResponse *response = new HttpResponse(request);
@@ -139,44 +579,139 @@ static void networkThread(void)
         
         int32_t responseCode = -1;
         int retValue = 0;
+        errorBuffer[0] = 0;
+        
+        // the GET responses kept in memory go through the response cache: a fresh one isn't requested again,
+        // a stale one is requested with its validators, and served from the cache on 304
+        bool cacheable = request->getRequestType() == HttpRequest::Type::GET && request->isCacheEnabled()
+                         && request->getResponseFile()[0] == 0 && !request->getStreamCallback();
+        CacheEntry cached;
+        bool hasCached = cacheable && findCacheEntry(request->getUrl(), &cached);
+        std::vector<std::string> conditionalHeaders;
+        if (hasCached)
+        {
+            if (cached.expires > time(NULL) && readCacheFile(cached, response->getResponseData()))
+            {
+                response->setResponseCode(200);
+                response->setSucceed(true);
+                response->setCached(true);
+                
+                s_responseQueueMutex.lock();
+                s_responseQueue->addObject(response);
+                s_responseQueueMutex.unlock();
+                
+                Director::getInstance()->getScheduler()->resumeTarget(HttpClient::getInstance());
+                continue;
+            }
+            response->getResponseData()->clear();
+            if (!cached.etag.empty())
+            {
+                conditionalHeaders.push_back("If-None-Match: " + cached.etag);
+            }
+            if (!cached.lastModified.empty())
+            {
+                conditionalHeaders.push_back("If-Modified-Since: " + cached.lastModified);
+            }
+        }
+        
+        // the body is kept in the response, unless it is streamed to a file or a callback
+        write_callback callback = writeData;
+        void *stream = response->getResponseData();
+        ResponseStream responseStream;
+        responseStream.handle = handle;
+        responseStream.path = request->getResponseFile();
+        responseStream.file = NULL;
+        responseStream.resumeFrom = 0;
+        responseStream.started = false;
+        responseStream.discarded = false;
+        responseStream.callback = request->getStreamCallback();
+        responseStream.startCallback = request->getStreamStartCallback();
+        if (!responseStream.path.empty() || responseStream.callback)
+        {
+            callback = writeStreamData;
+            stream = &responseStream;
+            
+            // only the end of a partially downloaded file is requested
+            if (!responseStream.path.empty() && request->isResumingResponseFile())
+            {
+                FILE *file = fopen(responseStream.path.c_str(), "rb");
+                if (file)
+                {
+                    fseek(file, 0, SEEK_END);
+                    responseStream.resumeFrom = ftell(file);
+                    fclose(file);
+                }
+            }
+        }
 
         // Process the request -> get response packet
         switch (request->getRequestType())
         {
             case HttpRequest::Type::GET: // HTTP GET
-                retValue = processGetTask(request,
-                                          writeData, 
-                                          response->getResponseData(), 
+                retValue = processGetTask(handle, errorBuffer,
+                                          request,
+                                          callback, 
+                                          stream, 
                                           &responseCode,
                                           writeHeaderData,
-                                          response->getResponseHeader());
+                                          response->getResponseHeader(),
+                                          responseStream.resumeFrom,
+                                          conditionalHeaders);
+                if (retValue == 0 && responseCode == 304)
+                {
+                    if (readCacheFile(cached, response->getResponseData()))
+                    {
+                        refreshCacheEntry(request->getUrl(), *response->getResponseHeader());
+                        response->setCached(true);
+                        responseCode = 200;
+                        break;
+                    }
+                    
+                    // the cached body is gone, the whole response is requested again
+                    forgetCacheEntry(request->getUrl());
+                    conditionalHeaders.clear();
+                    response->getResponseData()->clear();
+                    response->getResponseHeader()->clear();
+                    retValue = processGetTask(handle, errorBuffer, request, callback, stream, &responseCode,
+                                              writeHeaderData, response->getResponseHeader(), 0, conditionalHeaders);
+                }
+                if (retValue == 0 && cacheable)
+                {
+                    storeCacheEntry(request->getUrl(), *response->getResponseHeader(), *response->getResponseData());
+                }
                 break;
             
             case HttpRequest::Type::POST: // HTTP POST
-                retValue = processPostTask(request,
-                                           writeData, 
-                                           response->getResponseData(), 
+                retValue = processPostTask(handle, errorBuffer,
+                                           request,
+                                           callback, 
+                                           stream, 
                                            &responseCode,
                                            writeHeaderData,
-                                           response->getResponseHeader());
+                                           response->getResponseHeader(),
+                                           responseStream.resumeFrom);
                 break;
 
             case HttpRequest::Type::PUT:
-                retValue = processPutTask(request,
-                                          writeData,
-                                          response->getResponseData(),
+                retValue = processPutTask(handle, errorBuffer,
+                                          request,
+                                          callback,
+                                          stream,
                                           &responseCode,
                                           writeHeaderData,
-                                          response->getResponseHeader());
+                                          response->getResponseHeader(),
+                                          responseStream.resumeFrom);
                 break;
 
             case HttpRequest::Type::DELETE:
-                retValue = processDeleteTask(request,
-                                             writeData,
-                                             response->getResponseData(),
+                retValue = processDeleteTask(handle, errorBuffer,
+                                             request,
+                                             callback,
+                                             stream,
                                              &responseCode,
                                              writeHeaderData,
-                                             response->getResponseHeader());
+                                             response->getResponseHeader(),
+                                             responseStream.resumeFrom);
                 break;
             
             default:
@@ -184,13 +719,18 @@ static void networkThread(void)
                 break;
         }
                 
+        if (responseStream.file)
+        {
+            fclose(responseStream.file);
+        }
+        
         // write data to HttpResponse
         response->setResponseCode(responseCode);
         
         if (retValue != 0) 
         {
             response->setSucceed(false);
-            response->setErrorBuffer(s_errorBuffer);
+            response->setErrorBuffer(errorBuffer);
         }
         else
         {
@@ -207,32 +747,46 @@ static void networkThread(void)
         Director::getInstance()->getScheduler()->resumeTarget(HttpClient::getInstance());
     }
     
-    // cleanup: if worker thread received quit signal, clean up un-completed request queue
-    s_requestQueueMutex.lock();
-    s_requestQueue->removeAllObjects();
-    s_requestQueueMutex.unlock();
-    
-    s_asyncRequestCount -= s_requestQueue->count();
-    
-    if (s_requestQueue != NULL) {
-
-        s_requestQueue->release();
-        s_requestQueue = NULL;
-        s_responseQueue->release();
-        s_responseQueue = NULL;
+    if (handle)
+    {
+        curl_easy_cleanup(handle);
     }
     
+    // cleanup: the last worker to receive the quit signal cleans up the un-completed request queue
+    if (lastWorker)
+    {
+        s_requestQueueMutex.lock();
+        s_asyncRequestCount -= s_requestQueue.size();
+        for (auto queued : s_requestQueue)
+        {
+            queued->release();
+        }
+        s_requestQueue.clear();
+        s_requestQueueMutex.unlock();
+        
+        if (s_responseQueue != NULL)
+        {
+            s_responseQueue->release();
+            s_responseQueue = NULL;
+        }
+        
+        if (s_share != NULL)
+        {
+            curl_share_cleanup(s_share);
+            s_share = NULL;
+        }
+    }
 }
 
 //Configure curl's timeout property
-static bool configureCURL(CURL *handle)
+static bool configureCURL(CURL *handle, char *errorBuffer)
 {
     if (!handle) {
         return false;
     }
     
     int32_t code;
-    code = curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, s_errorBuffer);
+    code = curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, errorBuffer);
     if (code != CURLE_OK) {
         return false;
     }
@@ -244,6 +798,9 @@ static bool configureCURL(CURL *handle)
     if (code != CURLE_OK) {
         return false;
     }
+    if (s_share) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, s_share);
+    }
     curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
     curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0L);
 
@@ -252,21 +809,24 @@ static bool configureCURL(CURL *handle)
 
 class CURLRaii
 {
-    /// Instance of CURL
+    /// Instance of CURL, owned by the worker thread
     CURL *_curl;
     /// Keeps custom header data
     curl_slist *_headers;
+    char *_errorBuffer;
 public:
-    CURLRaii()
-        : _curl(curl_easy_init())
+    /// The options of the previous request are reset, its connections and caches are kept
+    CURLRaii(CURL *curl, char *errorBuffer)
+        : _curl(curl)
         , _headers(NULL)
+        , _errorBuffer(errorBuffer)
     {
+        if (_curl)
+            curl_easy_reset(_curl);
     }
 
     ~CURLRaii()
     {
-        if (_curl)
-            curl_easy_cleanup(_curl);
         /* free the linked list for header data */
         if (_headers)
             curl_slist_free_all(_headers);
@@ -284,15 +844,17 @@ public:
      * @param callback Response write callback
      * @param stream Response write stream
      */
-    bool init(HttpRequest *request, write_callback callback, void *stream, write_callback headerCallback, void *headerStream)
+    bool init(HttpRequest *request, write_callback callback, void *stream, write_callback headerCallback, void *headerStream, curl_off_t resumeFrom,
+              const std::vector<std::string>& extraHeaders = std::vector<std::string>())
     {
         if (!_curl)
             return false;
-        if (!configureCURL(_curl))
+        if (!configureCURL(_curl, _errorBuffer))
             return false;
 
         /* get custom header data (if set) */
        	std::vector<std::string> headers=request->getHeaders();
+        headers.insert(headers.end(), extraHeaders.begin(), extraHeaders.end());
         if(!headers.empty())
         {
             /* append custom headers one by one */
@@ -311,6 +873,10 @@ public:
             }
         }
 
+        if (resumeFrom > 0 && !setOption(CURLOPT_RESUME_FROM_LARGE, resumeFrom)) {
+            return false;
+        }
+
         return setOption(CURLOPT_URL, request->getUrl())
                 && setOption(CURLOPT_WRITEFUNCTION, callback)
                 && setOption(CURLOPT_WRITEDATA, stream)
@@ -320,12 +886,18 @@ public:
     }
 
     /// @param responseCode Null not allowed
-    bool perform(int *responseCode)
+    /// @param resumeFrom offset of the Range request, 206 is expected then. 416 means that the file is complete
+    /// @param conditional whether the request has validators, 304 is expected then
+    bool perform(int *responseCode, curl_off_t resumeFrom, bool conditional = false)
     {
-        if (CURLE_OK != curl_easy_perform(_curl))
+        CURLcode code = curl_easy_perform(_curl);
+        // a server ignoring the range of a resumed download makes curl fail, but it sends the whole file
+        if (CURLE_OK != code && !(resumeFrom > 0 && code == CURLE_RANGE_ERROR))
             return false;
-        CURLcode code = curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, responseCode);
-        if (code != CURLE_OK || *responseCode != 200) {
+        code = curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, responseCode);
+        bool expected = *responseCode == 200 || (resumeFrom > 0 && (*responseCode == 206 || *responseCode == 416))
+                        || (conditional && *responseCode == 304);
+        if (code != CURLE_OK || !expected) {
             CCLOGERROR("Curl curl_easy_getinfo failed: %s", curl_easy_strerror(code));
             return false;
         }
@@ -336,47 +908,47 @@ public:
 };
 
 //Process Get Request
-static int processGetTask(HttpRequest *request, write_callback callback, void *stream, int32_t *responseCode, write_callback headerCallback, void *headerStream)
+static int processGetTask(CURL *handle, char *errorBuffer, HttpRequest *request, write_callback callback, void *stream, int32_t *responseCode, write_callback headerCallback, void *headerStream, curl_off_t resumeFrom, const std::vector<std::string>& conditionalHeaders)
 {
-    CURLRaii curl;
-    bool ok = curl.init(request, callback, stream, headerCallback, headerStream)
+    CURLRaii curl(handle, errorBuffer);
+    bool ok = curl.init(request, callback, stream, headerCallback, headerStream, resumeFrom, conditionalHeaders)
             && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
+            && curl.perform(responseCode, resumeFrom, !conditionalHeaders.empty());
     return ok ? 0 : 1;
 }
 
 //Process POST Request
-static int processPostTask(HttpRequest *request, write_callback callback, void *stream, int32_t *responseCode, write_callback headerCallback, void *headerStream)
+static int processPostTask(CURL *handle, char *errorBuffer, HttpRequest *request, write_callback callback, void *stream, int32_t *responseCode, write_callback headerCallback, void *headerStream, curl_off_t resumeFrom)
 {
-    CURLRaii curl;
-    bool ok = curl.init(request, callback, stream, headerCallback, headerStream)
+    CURLRaii curl(handle, errorBuffer);
+    bool ok = curl.init(request, callback, stream, headerCallback, headerStream, resumeFrom)
             && curl.setOption(CURLOPT_POST, 1)
             && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
             && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
+            && curl.perform(responseCode, resumeFrom);
     return ok ? 0 : 1;
 }
 
 //Process PUT Request
-static int processPutTask(HttpRequest *request, write_callback callback, void *stream, int32_t *responseCode, write_callback headerCallback, void *headerStream)
+static int processPutTask(CURL *handle, char *errorBuffer, HttpRequest *request, write_callback callback, void *stream, int32_t *responseCode, write_callback headerCallback, void *headerStream, curl_off_t resumeFrom)
 {
-    CURLRaii curl;
-    bool ok = curl.init(request, callback, stream, headerCallback, headerStream)
+    CURLRaii curl(handle, errorBuffer);
+    bool ok = curl.init(request, callback, stream, headerCallback, headerStream, resumeFrom)
             && curl.setOption(CURLOPT_CUSTOMREQUEST, "PUT")
             && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
             && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
+            && curl.perform(responseCode, resumeFrom);
     return ok ? 0 : 1;
 }
 
 //Process DELETE Request
-static int processDeleteTask(HttpRequest *request, write_callback callback, void *stream, int32_t *responseCode, write_callback headerCallback, void *headerStream)
+static int processDeleteTask(CURL *handle, char *errorBuffer, HttpRequest *request, write_callback callback, void *stream, int32_t *responseCode, write_callback headerCallback, void *headerStream, curl_off_t resumeFrom)
 {
-    CURLRaii curl;
-    bool ok = curl.init(request, callback, stream, headerCallback, headerStream)
+    CURLRaii curl(handle, errorBuffer);
+    bool ok = curl.init(request, callback, stream, headerCallback, headerStream, resumeFrom)
             && curl.setOption(CURLOPT_CUSTOMREQUEST, "DELETE")
             && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
+            && curl.perform(responseCode, resumeFrom);
     return ok ? 0 : 1;
 }
 
@@ -406,6 +978,49 @@ void HttpClient::enableCookies(const char* cookieFile) {
     }
 }
 
+void HttpClient::enableResponseCache(const char* cacheDirectory, long maxSize)
+{
+    std::string path = cacheDirectory ? cacheDirectory : FileUtils::getInstance()->getWritablePath() + "httpcache";
+    if (!path.empty() && path.back() != '/' && path.back() != '\\')
+    {
+        path += '/';
+    }
+    
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    if (!createCacheDirectory(path))
+    {
+        CCLOGERROR("HttpClient: can't create the response cache directory %s", path.c_str());
+        s_cachePath.clear();
+        s_cacheEntries.clear();
+        return;
+    }
+    s_cachePath = path;
+    s_cacheMaxSize = maxSize;
+    readCacheIndex();
+}
+
+void HttpClient::disableResponseCache()
+{
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    s_cachePath.clear();
+    s_cacheEntries.clear();
+    s_cacheSize = 0;
+}
+
+void HttpClient::clearResponseCache()
+{
+    std::lock_guard<std::mutex> lock(s_cacheMutex);
+    if (s_cachePath.empty())
+    {
+        return;
+    }
+    while (!s_cacheEntries.empty())
+    {
+        removeCacheEntry(s_cacheEntries.begin());
+    }
+    writeCacheIndex();
+}
+
 HttpClient::HttpClient()
 : _timeoutForConnect(30)
 , _timeoutForRead(60)
@@ -417,32 +1032,53 @@ HttpClient::HttpClient()
 
 HttpClient::~HttpClient()
 {
+    s_requestQueueMutex.lock();
     s_need_quit = true;
+    s_requestQueueMutex.unlock();
     
-    if (s_requestQueue != NULL) {
-    	s_SleepCondition.notify_one();
-    }
+    s_SleepCondition.notify_all();
     
     s_pHttpClient = NULL;
 }
 
+void HttpClient::setMaxConcurrentRequests(int count)
+{
+    CCASSERT(count > 0, "At least one request must be sent at a time");
+    
+    s_requestQueueMutex.lock();
+    s_maxWorkerCount = count;
+    s_requestQueueMutex.unlock();
+    
+    // the workers beyond the limit quit
+    s_SleepCondition.notify_all();
+}
+
+int HttpClient::getMaxConcurrentRequests()
+{
+    std::lock_guard<std::mutex> lock(s_requestQueueMutex);
+    return s_maxWorkerCount;
+}
+
 //Lazy create semaphore & mutex & thread
 bool HttpClient::lazyInitThreadSemphore()
 {
-    if (s_requestQueue != NULL) {
+    if (s_responseQueue != NULL) {
         return true;
     } else {
         
-        s_requestQueue = new Array();
-        s_requestQueue->init();
-        
         s_responseQueue = new Array();
         s_responseQueue->init();
 
+        s_share = curl_share_init();
+        if (s_share) {
+            curl_share_setopt(s_share, CURLSHOPT_LOCKFUNC, lockShare);
+            curl_share_setopt(s_share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+            curl_share_setopt(s_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(s_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+            curl_share_setopt(s_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
+        }
         
-        auto t = std::thread(&networkThread);
-        t.detach();
-        
+        // the workers are started by send()
         s_need_quit = false;
     }
     
@@ -467,7 +1103,18 @@ void HttpClient::send(HttpRequest* request)
     request->retain();
     
     s_requestQueueMutex.lock();
-    s_requestQueue->addObject(request);
+    // after the requests with the same or a higher priority
+    auto position = std::upper_bound(s_requestQueue.begin(), s_requestQueue.end(), request,
+                                     [](HttpRequest* a, HttpRequest* b) { return a->getPriority() > b->getPriority(); });
+    s_requestQueue.insert(position, request);
+    
+    // a new worker is started if all of them are busy
+    if (s_idleWorkerCount == 0 && s_workerCount < s_maxWorkerCount)
+    {
+        ++s_workerCount;
+        auto t = std::thread(&networkThread);
+        t.detach();
+    }
     s_requestQueueMutex.unlock();
     
     // Notify thread start to work
@@ -479,20 +1126,26 @@ void HttpClient::dispatchResponseCallbacks(float delta)
 {
     // log("CCHttpClient::dispatchResponseCallbacks is running");
     
-    HttpResponse* response = NULL;
-    
-    s_responseQueueMutex.lock();
-
-    if (s_responseQueue->count())
-    {
-        response = dynamic_cast<HttpResponse*>(s_responseQueue->objectAtIndex(0));
-        s_responseQueue->removeObjectAtIndex(0);
-    }
-    
-    s_responseQueueMutex.unlock();
-    
-    if (response)
+    // all the responses received since the last frame are dispatched
+    while (true)
     {
+        HttpResponse* response = NULL;
+        
+        s_responseQueueMutex.lock();
+
+        if (s_responseQueue->count())
+        {
+            response = dynamic_cast<HttpResponse*>(s_responseQueue->objectAtIndex(0));
+            s_responseQueue->removeObjectAtIndex(0);
+        }
+        
+        s_responseQueueMutex.unlock();
+        
+        if (!response)
+        {
+            break;
+        }
+        
         --s_asyncRequestCount;
         
         HttpRequest *request = response->getHttpRequest();
@@ -54,6 +54,24 @@ public:
 
     /** Enable cookie support. **/
     void enableCookies(const char* cookieFile);
+    
+    /**
+     * Enable the cache of the responses to GET requests whose body is kept in memory, see HttpRequest::setCacheEnabled().
+     * Cache-Control and Expires are honored: a fresh response is served from the cache without sending the request,
+     * a stale one is revalidated with If-None-Match/If-Modified-Since and served from the cache on 304.
+     * HttpResponse::isCached() tells the responses served from the cache, their response code is 200.
+     * @param cacheDirectory directory of the cache, created if needed, "httpcache" in the writable path if NULL.
+     *                       The responses cached by a previous run are kept
+     * @param maxSize total size of the cached bodies in bytes, the least recently used ones are removed beyond it
+     * @since v3.0
+     */
+    void enableResponseCache(const char* cacheDirectory, long maxSize = 16 * 1024 * 1024);
+    
+    /** Disable the response cache, the cached responses stay on disk for the next enableResponseCache() */
+    void disableResponseCache();
+    
+    /** Remove all the cached responses */
+    void clearResponseCache();
         
     /**
      * Add a get request to task queue
@@ -92,6 +110,18 @@ public:
      * @return int
      */
     inline int getTimeoutForRead() {return _timeoutForRead;};
+
+    /**
+     * Change how many requests can be sent at the same time, 4 by default.
+     * Each request is sent by a worker thread, which keeps its connections open for the next requests.
+     * The requests waiting are sent by priority, see HttpRequest::setPriority()
+     */
+    void setMaxConcurrentRequests(int count);
+    
+    /**
+     * Get how many requests can be sent at the same time
+     */
+    int getMaxConcurrentRequests();
         
 private:
     HttpClient();
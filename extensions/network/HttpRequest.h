@@ -44,6 +44,12 @@ typedef void (Object::*SEL_HttpResponse)(HttpClient* client, HttpResponse* respo
 class HttpRequest : public Object
 {
 public:
+    /** Receives the body of the response by chunks, on the network thread. Returns false to abort the request */
+    typedef std::function<bool(const char* data, size_t size)> StreamCallback;
+    /** Called on the network thread before the first chunk of a streamed response, with its response code and
+        the Content-Length of the body, -1 if unknown */
+    typedef std::function<void(long responseCode, double contentLength)> StreamStartCallback;
+    
     /** Use this enum type as param in setReqeustType(param) */
     enum class Type
     {
@@ -69,6 +75,9 @@ public:
         _pTarget = NULL;
         _pSelector = NULL;
         _pUserData = NULL;
+        _priority = 0;
+        _resumeResponseFile = false;
+        _cacheEnabled = true;
     };
     
     /** Destructor */
@@ -146,6 +155,80 @@ public:
         return _tag.c_str();
     };
     
+    /** Option field. The requests with a higher priority are sent first, the ones with the same priority
+        in the order they were sent. 0 by default
+     */
+    inline void setPriority(int priority)
+    {
+        _priority = priority;
+    };
+    /** Get the priority back */
+    inline int getPriority()
+    {
+        return _priority;
+    };
+    
+    /** Option field. Writes the body of the response to a file as it is received, instead of keeping it in
+        HttpResponse::getResponseData(). The file is only written if the request succeeds (2xx response code)
+        @param resume if the file exists, only the rest of it is requested (Range request), then appended to it.
+                      A server ignoring the range sends the whole file again, which replaces it
+     */
+    inline void setResponseFile(const char* path, bool resume = false)
+    {
+        _responseFile = path ? path : "";
+        _resumeResponseFile = resume;
+    };
+    /** Get the response file back, empty if the body is kept in memory */
+    inline const char* getResponseFile()
+    {
+        return _responseFile.c_str();
+    };
+    /** Whether the response file is resumed */
+    inline bool isResumingResponseFile()
+    {
+        return _resumeResponseFile;
+    };
+    
+    /** Option field. Calls callback with the body of the response by chunks as it is received, on the network
+        thread, instead of keeping it in HttpResponse::getResponseData(). Can be combined with setResponseFile(),
+        e.g. to report the progress
+     */
+    inline void setStreamCallback(const StreamCallback& callback)
+    {
+        _streamCallback = callback;
+    };
+    /** Get the stream callback back */
+    inline const StreamCallback& getStreamCallback()
+    {
+        return _streamCallback;
+    };
+    
+    /** Option field. Called once the headers of a streamed response are received, e.g. to reserve the memory
+        of the body or to report the progress. Only used with setResponseFile() or setStreamCallback()
+     */
+    inline void setStreamStartCallback(const StreamStartCallback& callback)
+    {
+        _streamStartCallback = callback;
+    };
+    /** Get the stream start callback back */
+    inline const StreamStartCallback& getStreamStartCallback()
+    {
+        return _streamStartCallback;
+    };
+    
+    /** Option field. Whether the response of a GET request can be served from and stored in the response cache,
+        see HttpClient::enableResponseCache(). true by default, ignored with setResponseFile() or setStreamCallback()
+     */
+    inline void setCacheEnabled(bool enabled)
+    {
+        _cacheEnabled = enabled;
+    };
+    /** Whether the response cache is used */
+    inline bool isCacheEnabled()
+    {
+        return _cacheEnabled;
+    };
+    
     /** Option field. You can attach a customed data in each request, and get it back in response callback.
         But you need to new/delete the data pointer manully
      */
@@ -225,6 +308,12 @@ protected:
     SEL_HttpResponse            _pSelector;      /// callback function, e.g. MyLayer::onHttpResponse(HttpClient *sender, HttpResponse * response)
     void*                       _pUserData;      /// You can add your customed data here 
     std::vector<std::string>    _headers;		      /// custom http headers
+    int                         _priority;       /// requests with a higher priority are sent first
+    std::string                 _responseFile;   /// file the body of the response is written to, if not empty
+    bool                        _resumeResponseFile; /// whether only the rest of _responseFile is requested
+    StreamCallback              _streamCallback; /// receives the body of the response, if set
+    StreamStartCallback         _streamStartCallback; /// called before the body of the response is streamed
+    bool                        _cacheEnabled;   /// whether the response cache of HttpClient is used
 };
 
 NS_CC_EXT_END
@@ -51,6 +51,7 @@ public:
         }
         
         _succeed = false;
+        _cached = false;
         _responseData.clear();
         _errorBuffer.clear();
     }
@@ -93,6 +94,14 @@ public:
         return _succeed;
     };
     
+    /** Whether the body was served from the response cache of HttpClient, without being downloaded again.
+        The headers are the ones of the 304 response if the cached response was revalidated, empty otherwise
+     */
+    inline bool isCached()
+    {
+        return _cached;
+    }
+    
     /** Get the http response raw data */
     inline std::vector<char>* getResponseData()
     {
@@ -133,6 +142,13 @@ public:
         _succeed = value;
     };
     
+    /** Set whether the body was served from the response cache, is used by HttpClient
+     */
+    inline void setCached(bool value)
+    {
+        _cached = value;
+    }
+    
     
     /** Set the http response raw buffer, is used by HttpClient
      */
@@ -171,6 +187,7 @@ protected:
     // properties
     HttpRequest*        _pHttpRequest;  /// the corresponding HttpRequest pointer who leads to this response 
     bool                _succeed;       /// to indecate if the http reqeust is successful simply
+    bool                _cached;        /// whether _responseData comes from the response cache
     std::vector<char>   _responseData;  /// the returned raw data. You can also dump it as a string
     std::vector<char>   _responseHeader;  /// the returned raw header data. You can also dump it as a string
     int                 _responseCode;    /// the status code returned from libcurl, e.g. 200, 404
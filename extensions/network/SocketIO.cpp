@@ -53,6 +53,11 @@ private:
 
 	Dictionary* _clients;
 
+	// Reused to build the binary packets
+	std::vector<unsigned char> _binaryPacket;
+
+	void onBinaryMessage(const cocos2d::extension::WebSocket::Data& data);
+
 public:
 	SIOClientImpl(const std::string& host, int port);
 	virtual ~SIOClientImpl(void);
@@ -80,6 +85,7 @@ public:
 
 	void send(std::string endpoint, std::string s);
 	void emit(std::string endpoint, std::string eventname, std::string args);
+	void emit(const std::string& endpoint, const std::string& eventname, const char* data, size_t len);
 
 
 };
@@ -322,34 +328,57 @@ void SIOClientImpl::heartbeat(float dt)
 
 void SIOClientImpl::send(std::string endpoint, std::string s)
 {
-	std::stringstream pre;
-
 	std::string path = endpoint == "/" ? "" : endpoint;
-	
-	pre << "3::" << path << ":" << s;
 
-	std::string msg = pre.str();
+	std::string msg;
+	msg.reserve(4 + path.size() + s.size());
+	msg.append("3::").append(path).append(":").append(s);
 
-	log("sending message: %s", msg.c_str());
+	CCLOG("sending message: %s", msg.c_str());
 
 	_ws->send(msg);
 }
 
 void SIOClientImpl::emit(std::string endpoint, std::string eventname, std::string args)
 {
-	std::stringstream pre;
-
 	std::string path = endpoint == "/" ? "" : endpoint;
-	
-	pre << "5::" << path << ":{\"name\":\"" << eventname << "\",\"args\":" << args << "}";
 
-	std::string msg = pre.str();
+	std::string msg;
+	msg.reserve(24 + path.size() + eventname.size() + args.size());
+	msg.append("5::").append(path).append(":{\"name\":\"").append(eventname).append("\",\"args\":").append(args).append("}");
 
-	log("emitting event with data: %s", msg.c_str());
+	CCLOG("emitting event with data: %s", msg.c_str());
 
 	_ws->send(msg);
 }
 
+void SIOClientImpl::emit(const std::string& endpoint, const std::string& eventname, const char* data, size_t len)
+{
+	std::string path = endpoint == "/" ? "" : endpoint;
+	CCASSERT(path.size() <= 0xffff && eventname.size() <= 0xffff, "endpoint or event name too long");
+
+	// [5] [endpoint length] [endpoint] [event name length] [event name] [data]
+	_binaryPacket.resize(5 + path.size() + eventname.size() + len);
+	unsigned char* packet = &_binaryPacket[0];
+	*packet++ = 5;
+	*packet++ = (unsigned char)(path.size() >> 8);
+	*packet++ = (unsigned char)path.size();
+	memcpy(packet, path.data(), path.size());
+	packet += path.size();
+	*packet++ = (unsigned char)(eventname.size() >> 8);
+	*packet++ = (unsigned char)eventname.size();
+	memcpy(packet, eventname.data(), eventname.size());
+	packet += eventname.size();
+	if (len > 0)
+	{
+		memcpy(packet, data, len);
+	}
+
+	CCLOG("emitting binary event %s with %d bytes", eventname.c_str(), (int)len);
+
+	_ws->send(&_binaryPacket[0], _binaryPacket.size());
+}
+
 void SIOClientImpl::onOpen(cocos2d::extension::WebSocket* ws)
 {
 	_connected = true;
@@ -372,41 +401,30 @@ void SIOClientImpl::onOpen(cocos2d::extension::WebSocket* ws)
 
 void SIOClientImpl::onMessage(cocos2d::extension::WebSocket* ws, const cocos2d::extension::WebSocket::Data& data)
 {
-	log("SIOClientImpl::onMessage received: %s", data.bytes);
-
-	int control = atoi(&data.bytes[0]);
-
-	std::string payload, msgid, endpoint, s_data, eventname;
-	payload = data.bytes;
-
-	int pos, pos2;
-
-	pos = payload.find(":");
-	if(pos >=0 ) {
-		payload.erase(0, pos+1);
+	if (data.isBinary)
+	{
+		onBinaryMessage(data);
+		return;
 	}
 
-	pos = payload.find(":");
-	if(pos > 0 ) {
-		msgid = atoi(payload.substr(0, pos+1).c_str());	
-	}
-	payload.erase(0, pos+1);
+	CCLOG("SIOClientImpl::onMessage received: %s", data.bytes);
 
-	pos = payload.find(":");
-	if(pos >= 0)
-    {
-		endpoint = payload.substr(0, pos);
-		payload.erase(0, pos+1);
-	}
-    else
-    {
-		endpoint = payload;
+	// [type] ':' [id] ':' [endpoint] (':' [data]), the fields are found in place
+	const char* end = data.bytes + data.len;
+	int control = atoi(data.bytes);
+
+	const char* field = std::find((const char*)data.bytes, end, ':');
+	if (field < end)
+	{
+		field = std::find(field + 1, end, ':');
 	}
+	const char* endpointStart = field < end ? field + 1 : end;
+	const char* endpointEnd = std::find(endpointStart, end, ':');
+	const char* payload = endpointEnd < end ? endpointEnd + 1 : end;
 
+	std::string endpoint(endpointStart, endpointEnd);
 	if (endpoint == "") endpoint = "/";
 
-
-	s_data = payload;
 	SIOClient *c = NULL;
 	c = getClient(endpoint);
 	if (c == NULL) log("SIOClientImpl::onMessage client lookup returned NULL");
@@ -423,32 +441,31 @@ void SIOClientImpl::onMessage(cocos2d::extension::WebSocket* ws, const cocos2d::
 			if(c) c->onConnect();
 			break;
 		case 2: 
-			log("Heartbeat received\n");
+			CCLOG("Heartbeat received\n");
 			break;
 		case 3:
-			log("Message received: %s \n", s_data.c_str());
-			if(c) c->getDelegate()->onMessage(c, s_data);
+			CCLOG("Message received: %s \n", payload);
+			if(c) c->getDelegate()->onMessage(c, std::string(payload, end));
 			break;
 		case 4:
-			log("JSON Message Received: %s \n", s_data.c_str());
-			if(c) c->getDelegate()->onMessage(c, s_data);
+			CCLOG("JSON Message Received: %s \n", payload);
+			if(c) c->getDelegate()->onMessage(c, std::string(payload, end));
 			break;
 		case 5:
-			log("Event Received with data: %s \n", s_data.c_str());
+			CCLOG("Event Received with data: %s \n", payload);
 
 			if(c)
             {
-				eventname = "";
-				pos = s_data.find(":");
-				pos2 = s_data.find(",");
-				if(pos2 > pos)
-                {
-					s_data = s_data.substr(pos+1, pos2-pos-1);
-					std::remove_copy(s_data.begin(), s_data.end(),
-						 std::back_inserter(eventname), '"');
+				// {"name":"eventname","args":...}
+				std::string eventname;
+				const char* nameStart = std::find(payload, end, ':');
+				const char* nameEnd = std::find(payload, end, ',');
+				if (nameEnd < end && nameEnd > nameStart)
+				{
+					std::remove_copy(nameStart + 1, nameEnd, std::back_inserter(eventname), '"');
 				}
 
-				c->fireEvent(eventname, payload);
+				c->fireEvent(eventname, std::string(payload, end));
 			}
 			
 			break;
@@ -457,7 +474,7 @@ void SIOClientImpl::onMessage(cocos2d::extension::WebSocket* ws, const cocos2d::
 			break;
 		case 7:
 			log("Error\n");
-			if(c) c->getDelegate()->onError(c, s_data);
+			if(c) c->getDelegate()->onError(c, std::string(payload, end));
 			break;
 		case 8:
 			log("Noop\n");
@@ -467,6 +484,45 @@ void SIOClientImpl::onMessage(cocos2d::extension::WebSocket* ws, const cocos2d::
 	return;
 }
 
+void SIOClientImpl::onBinaryMessage(const cocos2d::extension::WebSocket::Data& data)
+{
+	// [5] [endpoint length] [endpoint] [event name length] [event name] [data]
+	const unsigned char* bytes = (const unsigned char*)data.bytes;
+	const unsigned char* end = bytes + data.len;
+	if (data.len < 5 || bytes[0] != 5)
+	{
+		log("SIOClientImpl::onBinaryMessage unknown packet");
+		return;
+	}
+
+	size_t endpointLength = (bytes[1] << 8) | bytes[2];
+	const unsigned char* endpoint = bytes + 3;
+	if (endpointLength + 2 > (size_t)(end - endpoint))
+	{
+		log("SIOClientImpl::onBinaryMessage invalid packet");
+		return;
+	}
+
+	const unsigned char* name = endpoint + endpointLength + 2;
+	size_t nameLength = (name[-2] << 8) | name[-1];
+	if (nameLength > (size_t)(end - name))
+	{
+		log("SIOClientImpl::onBinaryMessage invalid packet");
+		return;
+	}
+
+	std::string path = endpointLength > 0 ? std::string((const char*)endpoint, endpointLength) : "/";
+	SIOClient *c = getClient(path);
+	if (c == NULL)
+	{
+		log("SIOClientImpl::onBinaryMessage client lookup returned NULL");
+		return;
+	}
+
+	const unsigned char* payload = name + nameLength;
+	c->fireBinaryEvent(std::string((const char*)name, nameLength), (const char*)payload, end - payload);
+}
+
 void SIOClientImpl::onClose(cocos2d::extension::WebSocket* ws)
 {
 	if(_clients->count() > 0)
@@ -548,6 +604,19 @@ void SIOClient::emit(std::string eventname, std::string args)
 
 }
 
+void SIOClient::emit(const std::string& eventname, const char* data, size_t len)
+{
+	if(_connected)
+    {
+		_socket->emit(_path, eventname, data, len);
+	}
+    else
+    {
+		_delegate->onError(this, "Client not yet connected");
+	}
+
+}
+
 void SIOClient::disconnect()
 {
 	_connected = false;
@@ -589,6 +658,23 @@ void SIOClient::fireEvent(const std::string& eventName, const std::string& data)
 	log("SIOClient::fireEvent no event with name %s found", eventName.c_str());
 }
 
+void SIOClient::onBinary(const std::string& eventName, SIOBinaryEvent e)
+{
+	_binaryEventRegistry[eventName] = e;
+}
+
+void SIOClient::fireBinaryEvent(const std::string& eventName, const char* data, size_t len)
+{
+	auto iter = _binaryEventRegistry.find(eventName);
+	if (iter != _binaryEventRegistry.end() && iter->second)
+	{
+		iter->second(this, data, len);
+		return;
+	}
+
+	log("SIOClient::fireBinaryEvent no event with name %s found", eventName.c_str());
+}
+
 //begin SocketIO methods
 SocketIO *SocketIO::_inst = nullptr;
 
@@ -49,6 +49,15 @@ event target function should match this pattern, *this pointer will be made avai
 
 	void TargetClass::targetfunc(SIOClient *, const std::string&)
 
+binary events (e.g. msgpack) skip the text framing and the json, they are sent in binary websocket frames
+which the server has to handle itself: [type, 1 byte = 5] [endpoint length, 2 bytes] [endpoint]
+[event name length, 2 bytes] [event name] [data], the lengths are big endian
+
+	client->emit("eventname", bytes, length);
+	client->onBinary("eventname", CC_CALLBACK_3(TargetClass::binaryfunc, *targetclass_instance));
+
+	void TargetClass::binaryfunc(SIOClient *, const char* data, size_t length)
+
 disconnect from the endpoint by calling disconnect(), onClose will be called on the delegate once complete
 in the onClose method the pointer should be set to NULL or used to connect to a new endpoint
 
@@ -118,6 +127,9 @@ private:
 typedef std::function<void(SIOClient*, const std::string&)> SIOEvent;
 //c++11 map to callbacks
 typedef std::map<std::string, SIOEvent> EventRegistry;
+//callbacks of binary events, the data is only valid during the call
+typedef std::function<void(SIOClient*, const char*, size_t)> SIOBinaryEvent;
+typedef std::map<std::string, SIOBinaryEvent> BinaryEventRegistry;
 
 /**
      *  @brief A single connection to a socket.io endpoint
@@ -134,8 +146,10 @@ private:
 	SocketIO::SIODelegate* _delegate;
 
 	EventRegistry _eventRegistry;
+	BinaryEventRegistry _binaryEventRegistry;
 
 	void fireEvent(const std::string& eventName, const std::string& data);
+	void fireBinaryEvent(const std::string& eventName, const char* data, size_t len);
 
 	void onOpen();
 	void onConnect();
@@ -165,10 +179,19 @@ public:
      */
 	void emit(std::string eventname, std::string args);
 	/**
+     *  @brief Emits a binary event, sent as is in a binary frame
+     */
+	void emit(const std::string& eventname, const char* data, size_t len);
+	/**
      *  @brief Used to resgister a socket.io event callback
 	 *		   Event argument should be passed using CC_CALLBACK2(&Base::function, this)
      */
 	void on(const std::string& eventName, SIOEvent e);
+	/**
+     *  @brief Used to resgister a callback of a binary event
+	 *		   Event argument should be passed using CC_CALLBACK3(&Base::function, this)
+     */
+	void onBinary(const std::string& eventName, SIOBinaryEvent e);
 	
 	inline void setTag(const char* tag)
     {
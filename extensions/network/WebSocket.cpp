@@ -39,12 +39,67 @@
 
 NS_CC_EXT_BEGIN
 
+// Buffers of the messages, reused instead of allocating each message
+class WsBufferPool
+{
+public:
+    ~WsBufferPool()
+    {
+        for (auto iter = _buffers.begin(); iter != _buffers.end(); ++iter)
+        {
+            delete *iter;
+        }
+    }
+    
+    std::vector<char>* get(size_t size)
+    {
+        std::vector<char>* buffer = nullptr;
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            if (! _buffers.empty())
+            {
+                buffer = _buffers.back();
+                _buffers.pop_back();
+            }
+        }
+        if (! buffer)
+        {
+            buffer = new std::vector<char>();
+        }
+        buffer->resize(size);
+        return buffer;
+    }
+    
+    void recycle(std::vector<char>* buffer)
+    {
+        // Large buffers aren't kept
+        if (buffer->capacity() <= MAX_POOLED_BUFFER_SIZE)
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            if (_buffers.size() < MAX_POOLED_BUFFERS)
+            {
+                _buffers.push_back(buffer);
+                return;
+            }
+        }
+        delete buffer;
+    }
+    
+private:
+    static const size_t MAX_POOLED_BUFFERS = 64;
+    static const size_t MAX_POOLED_BUFFER_SIZE = 64 * 1024;
+    
+    std::vector<std::vector<char>*> _buffers;
+    std::mutex _mutex;
+};
+
 class WsMessage
 {
 public:
-    WsMessage() : what(0), obj(NULL){}
+    WsMessage() : what(0), buffer(NULL), isBinary(false){}
     unsigned int what; // message type
-    void* obj;
+    std::vector<char>* buffer; // bytes of a message, from the pool of WsThreadHelper
+    bool isBinary;
 };
 
 /**
@@ -65,10 +120,10 @@ public:
     virtual void update(float dt);
     
     // Sends message to UI thread. It's needed to be invoked in sub-thread.
-    void sendMessageToUIThread(WsMessage *msg);
+    void sendMessageToUIThread(const WsMessage& msg);
     
     // Sends message to sub-thread(websocket thread). It's needs to be invoked in UI thread.
-    void sendMessageToSubThread(WsMessage *msg);
+    void sendMessageToSubThread(const WsMessage& msg);
     
     // Waits the sub-thread (websocket thread) to exit,
     void joinSubThread();
@@ -78,8 +133,13 @@ protected:
     void wsThreadEntryFunc();
     
 private:
-    std::list<WsMessage*>* _UIWsMessageQueue;
-    std::list<WsMessage*>* _subThreadWsMessageQueue;
+    // The queues are swapped with the vectors of the messages being handled, so their memory is reused
+    std::vector<WsMessage> _UIWsMessageQueue;
+    std::vector<WsMessage> _subThreadWsMessageQueue;
+    std::vector<WsMessage> _receivedMessages;
+    std::vector<WsMessage> _sendingMessages;
+    std::vector<WebSocket::Data> _receivedData;
+    WsBufferPool _bufferPool;
     std::mutex   _UIWsMessageQueueMutex;
     std::mutex   _subThreadWsMessageQueueMutex;
     std::thread* _subThreadInstance;
@@ -113,9 +173,6 @@ WsThreadHelper::WsThreadHelper()
 , _ws(NULL)
 , _needQuit(false)
 {
-    _UIWsMessageQueue = new std::list<WsMessage*>();
-    _subThreadWsMessageQueue = new std::list<WsMessage*>();
-    
     Director::getInstance()->getScheduler()->scheduleUpdateForTarget(this, 0, false);
 }
 
@@ -124,8 +181,15 @@ WsThreadHelper::~WsThreadHelper()
     Director::getInstance()->getScheduler()->unscheduleAllForTarget(this);
     joinSubThread();
     CC_SAFE_DELETE(_subThreadInstance);
-    delete _UIWsMessageQueue;
-    delete _subThreadWsMessageQueue;
+    
+    for (auto iter = _UIWsMessageQueue.begin(); iter != _UIWsMessageQueue.end(); ++iter)
+    {
+        delete iter->buffer;
+    }
+    for (auto iter = _subThreadWsMessageQueue.begin(); iter != _subThreadWsMessageQueue.end(); ++iter)
+    {
+        delete iter->buffer;
+    }
 }
 
 bool WsThreadHelper::createThread(const WebSocket& ws)
@@ -157,16 +221,16 @@ void WsThreadHelper::wsThreadEntryFunc()
     _ws->onSubThreadEnded();
 }
 
-void WsThreadHelper::sendMessageToUIThread(WsMessage *msg)
+void WsThreadHelper::sendMessageToUIThread(const WsMessage& msg)
 {
     std::lock_guard<std::mutex> lk(_UIWsMessageQueueMutex);
-    _UIWsMessageQueue->push_back(msg);
+    _UIWsMessageQueue.push_back(msg);
 }
 
-void WsThreadHelper::sendMessageToSubThread(WsMessage *msg)
+void WsThreadHelper::sendMessageToSubThread(const WsMessage& msg)
 {
     std::lock_guard<std::mutex> lk(_subThreadWsMessageQueueMutex);
-    _subThreadWsMessageQueue->push_back(msg);
+    _subThreadWsMessageQueue.push_back(msg);
 }
 
 void WsThreadHelper::joinSubThread()
@@ -177,39 +241,66 @@ void WsThreadHelper::joinSubThread()
     }
 }
 
+enum WS_MSG {
+    WS_MSG_TO_SUBTRHEAD_SENDING_STRING = 0,
+    WS_MSG_TO_SUBTRHEAD_SENDING_BINARY,
+    WS_MSG_TO_UITHREAD_OPEN,
+    WS_MSG_TO_UITHREAD_MESSAGE,
+    WS_MSG_TO_UITHREAD_ERROR,
+    WS_MSG_TO_UITHREAD_CLOSE
+};
+
 void WsThreadHelper::update(float dt)
 {
-    WsMessage *msg = NULL;
-
     // Returns quickly if no message
-    std::lock_guard<std::mutex> lk(_UIWsMessageQueueMutex);
-
-    if (0 == _UIWsMessageQueue->size())
     {
-        return;
+        std::lock_guard<std::mutex> lk(_UIWsMessageQueueMutex);
+        
+        if (_UIWsMessageQueue.empty())
+        {
+            return;
+        }
+        
+        // Gets all the messages
+        _receivedMessages.swap(_UIWsMessageQueue);
     }
     
-    // Gets message
-    msg = *(_UIWsMessageQueue->begin());
-    _UIWsMessageQueue->pop_front();
-    
-    if (_ws)
+    // The websocket may be deleted by a callback
+    for (size_t i = 0; i < _receivedMessages.size() && _ws; ++i)
     {
-        _ws->onUIThreadReceiveMessage(msg);
+        WsMessage& msg = _receivedMessages[i];
+        if (msg.what != WS_MSG_TO_UITHREAD_MESSAGE)
+        {
+            _ws->onUIThreadReceiveMessage(&msg);
+            continue;
+        }
+        
+        WebSocket::Data data;
+        data.bytes = &(*msg.buffer)[0];
+        // Strings are null terminated
+        data.len = msg.isBinary ? msg.buffer->size() : msg.buffer->size() - 1;
+        data.isBinary = msg.isBinary;
+        _receivedData.push_back(data);
+        
+        // The messages received in a row are delivered together
+        if (i + 1 == _receivedMessages.size() || _receivedMessages[i + 1].what != WS_MSG_TO_UITHREAD_MESSAGE)
+        {
+            _ws->_delegate->onMessages(_ws, _receivedData);
+            _receivedData.clear();
+        }
     }
     
-    CC_SAFE_DELETE(msg);
+    for (auto iter = _receivedMessages.begin(); iter != _receivedMessages.end(); ++iter)
+    {
+        if (iter->buffer)
+        {
+            _bufferPool.recycle(iter->buffer);
+        }
+    }
+    _receivedMessages.clear();
+    _receivedData.clear();
 }
 
-enum WS_MSG {
-    WS_MSG_TO_SUBTRHEAD_SENDING_STRING = 0,
-    WS_MSG_TO_SUBTRHEAD_SENDING_BINARY,
-    WS_MSG_TO_UITHREAD_OPEN,
-    WS_MSG_TO_UITHREAD_MESSAGE,
-    WS_MSG_TO_UITHREAD_ERROR,
-    WS_MSG_TO_UITHREAD_CLOSE
-};
-
 WebSocket::WebSocket()
 : _readyState(State::CONNECTING)
 , _port(80)
@@ -219,12 +310,18 @@ WebSocket::WebSocket()
 , _delegate(nullptr)
 , _SSLConnection(0)
 , _wsProtocols(nullptr)
+, _compressionEnabled(true)
 {
 }
 
 WebSocket::~WebSocket()
 {
     close();
+    if (_wsHelper)
+    {
+        // The helper may still be running a callback of this websocket
+        _wsHelper->_ws = nullptr;
+    }
     CC_SAFE_RELEASE_NULL(_wsHelper);
     
     for (int i = 0; _wsProtocols[i].callback != nullptr; ++i)
@@ -317,18 +414,20 @@ bool WebSocket::init(const Delegate& delegate,
     return ret;
 }
 
+void WebSocket::setCompressionEnabled(bool enabled)
+{
+    _compressionEnabled = enabled;
+}
+
 void WebSocket::send(const std::string& message)
 {
     if (_readyState == State::OPEN)
     {
-        // In main thread
-        WsMessage* msg = new WsMessage();
-        msg->what = WS_MSG_TO_SUBTRHEAD_SENDING_STRING;
-        Data* data = new Data();
-        data->bytes = new char[message.length()+1];
-        strcpy(data->bytes, message.c_str());
-        data->len = message.length();
-        msg->obj = data;
+        // In main thread, the message is copied once, between the paddings needed by libwebsocket_write()
+        WsMessage msg;
+        msg.what = WS_MSG_TO_SUBTRHEAD_SENDING_STRING;
+        msg.buffer = _wsHelper->_bufferPool.get(LWS_SEND_BUFFER_PRE_PADDING + message.length() + LWS_SEND_BUFFER_POST_PADDING);
+        memcpy(&(*msg.buffer)[LWS_SEND_BUFFER_PRE_PADDING], message.c_str(), message.length());
         _wsHelper->sendMessageToSubThread(msg);
     }
 }
@@ -339,14 +438,12 @@ void WebSocket::send(const unsigned char* binaryMsg, unsigned int len)
 
     if (_readyState == State::OPEN)
     {
-        // In main thread
-        WsMessage* msg = new WsMessage();
-        msg->what = WS_MSG_TO_SUBTRHEAD_SENDING_BINARY;
-        Data* data = new Data();
-        data->bytes = new char[len];
-        memcpy((void*)data->bytes, (void*)binaryMsg, len);
-        data->len = len;
-        msg->obj = data;
+        // In main thread, the message is copied once, between the paddings needed by libwebsocket_write()
+        WsMessage msg;
+        msg.what = WS_MSG_TO_SUBTRHEAD_SENDING_BINARY;
+        msg.isBinary = true;
+        msg.buffer = _wsHelper->_bufferPool.get(LWS_SEND_BUFFER_PRE_PADDING + len + LWS_SEND_BUFFER_POST_PADDING);
+        memcpy(&(*msg.buffer)[LWS_SEND_BUFFER_PRE_PADDING], binaryMsg, len);
         _wsHelper->sendMessageToSubThread(msg);
     }
 }
@@ -412,7 +509,7 @@ void WebSocket::onSubThreadStarted()
 	info.port = CONTEXT_PORT_NO_LISTEN;
 	info.protocols = _wsProtocols;
 #ifndef LWS_NO_EXTENSIONS
-	info.extensions = libwebsocket_get_internal_extensions();
+	info.extensions = _compressionEnabled ? libwebsocket_get_internal_extensions() : nullptr;
 #endif
 	info.gid = -1;
 	info.uid = -1;
@@ -456,23 +553,26 @@ int WebSocket::onSocketCallback(struct libwebsocket_context *ctx,
         case LWS_CALLBACK_PROTOCOL_DESTROY:
         case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
             {
-                WsMessage* msg = nullptr;
+                bool hasMsg = true;
+                WsMessage msg;
                 if (reason == LWS_CALLBACK_CLIENT_CONNECTION_ERROR
                     || (reason == LWS_CALLBACK_PROTOCOL_DESTROY && _readyState == State::CONNECTING)
                     || (reason == LWS_CALLBACK_DEL_POLL_FD && _readyState == State::CONNECTING)
                     )
                 {
-                    msg = new WsMessage();
-                    msg->what = WS_MSG_TO_UITHREAD_ERROR;
+                    msg.what = WS_MSG_TO_UITHREAD_ERROR;
                     _readyState = State::CLOSING;
                 }
                 else if (reason == LWS_CALLBACK_PROTOCOL_DESTROY && _readyState == State::CLOSING)
                 {
-                    msg = new WsMessage();
-                    msg->what = WS_MSG_TO_UITHREAD_CLOSE;
+                    msg.what = WS_MSG_TO_UITHREAD_CLOSE;
+                }
+                else
+                {
+                    hasMsg = false;
                 }
 
-                if (msg)
+                if (hasMsg)
                 {
                     _wsHelper->sendMessageToUIThread(msg);
                 }
@@ -480,8 +580,8 @@ int WebSocket::onSocketCallback(struct libwebsocket_context *ctx,
             break;
         case LWS_CALLBACK_CLIENT_ESTABLISHED:
             {
-                WsMessage* msg = new WsMessage();
-                msg->what = WS_MSG_TO_UITHREAD_OPEN;
+                WsMessage msg;
+                msg.what = WS_MSG_TO_UITHREAD_OPEN;
                 _readyState = State::OPEN;
                 
                 /*
@@ -495,57 +595,45 @@ int WebSocket::onSocketCallback(struct libwebsocket_context *ctx,
             
         case LWS_CALLBACK_CLIENT_WRITEABLE:
             {
-                std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
-                                               
-                std::list<WsMessage*>::iterator iter = _wsHelper->_subThreadWsMessageQueue->begin();
+                std::vector<WsMessage>& messages = _wsHelper->_sendingMessages;
+                {
+                    std::lock_guard<std::mutex> lk(_wsHelper->_subThreadWsMessageQueueMutex);
+                    messages.swap(_wsHelper->_subThreadWsMessageQueue);
+                }
                 
                 int bytesWrite = 0;
-                for (; iter != _wsHelper->_subThreadWsMessageQueue->end(); ++iter)
+                for (auto iter = messages.begin(); iter != messages.end(); ++iter)
                 {
-                    WsMessage* subThreadMsg = *iter;
+                    // The message is written from its buffer, which has the paddings
+                    int len = iter->buffer->size() - LWS_SEND_BUFFER_PRE_PADDING - LWS_SEND_BUFFER_POST_PADDING;
+                    unsigned char* buf = (unsigned char*)&(*iter->buffer)[LWS_SEND_BUFFER_PRE_PADDING];
+                    
+                    enum libwebsocket_write_protocol writeProtocol;
+                    
+                    if (WS_MSG_TO_SUBTRHEAD_SENDING_STRING == iter->what)
+                    {
+                        writeProtocol = LWS_WRITE_TEXT;
+                    }
+                    else
+                    {
+                        writeProtocol = LWS_WRITE_BINARY;
+                    }
                     
-                    if ( WS_MSG_TO_SUBTRHEAD_SENDING_STRING == subThreadMsg->what
-                      || WS_MSG_TO_SUBTRHEAD_SENDING_BINARY == subThreadMsg->what)
+                    bytesWrite = libwebsocket_write(wsi, buf, len, writeProtocol);
+                    
+                    if (bytesWrite < 0)
+                    {
+                        CCLOGERROR("%s", "libwebsocket_write error...");
+                    }
+                    if (bytesWrite < len)
                     {
-                        Data* data = (Data*)subThreadMsg->obj;
-
-                        unsigned char* buf = new unsigned char[LWS_SEND_BUFFER_PRE_PADDING
-                                                               + data->len + LWS_SEND_BUFFER_POST_PADDING];
-                        
-                        memset(&buf[LWS_SEND_BUFFER_PRE_PADDING], 0, data->len);
-                        memcpy((char*)&buf[LWS_SEND_BUFFER_PRE_PADDING], data->bytes, data->len);
-                        
-                        enum libwebsocket_write_protocol writeProtocol;
-                        
-                        if (WS_MSG_TO_SUBTRHEAD_SENDING_STRING == subThreadMsg->what)
-                        {
-                            writeProtocol = LWS_WRITE_TEXT;
-                        }
-                        else
-                        {
-                            writeProtocol = LWS_WRITE_BINARY;
-                        }
-                        
-                        bytesWrite = libwebsocket_write(wsi,  &buf[LWS_SEND_BUFFER_PRE_PADDING], data->len, writeProtocol);
-                        
-                        if (bytesWrite < 0)
-                        {
-                            CCLOGERROR("%s", "libwebsocket_write error...");
-                        }
-                        if (bytesWrite < data->len)
-                        {
-                            CCLOGERROR("Partial write LWS_CALLBACK_CLIENT_WRITEABLE\n");
-                        }
-                        
-                        CC_SAFE_DELETE_ARRAY(data->bytes);
-                        CC_SAFE_DELETE(data);
-                        CC_SAFE_DELETE_ARRAY(buf);
+                        CCLOGERROR("Partial write LWS_CALLBACK_CLIENT_WRITEABLE\n");
                     }
                     
-                    CC_SAFE_DELETE(subThreadMsg);
+                    _wsHelper->_bufferPool.recycle(iter->buffer);
                 }
 
-                _wsHelper->_subThreadWsMessageQueue->clear();
+                messages.clear();
                 
                 
                 /* get notified as soon as we can write again */
@@ -563,9 +651,9 @@ int WebSocket::onSocketCallback(struct libwebsocket_context *ctx,
                 
                 if (_readyState != State::CLOSED)
                 {
-                    WsMessage* msg = new WsMessage();
+                    WsMessage msg;
                     _readyState = State::CLOSED;
-                    msg->what = WS_MSG_TO_UITHREAD_CLOSE;
+                    msg.what = WS_MSG_TO_UITHREAD_CLOSE;
                     _wsHelper->sendMessageToUIThread(msg);
                 }
             }
@@ -575,30 +663,17 @@ int WebSocket::onSocketCallback(struct libwebsocket_context *ctx,
             {
                 if (in && len > 0)
                 {
-                    WsMessage* msg = new WsMessage();
-                    msg->what = WS_MSG_TO_UITHREAD_MESSAGE;
+                    WsMessage msg;
+                    msg.what = WS_MSG_TO_UITHREAD_MESSAGE;
+                    msg.isBinary = lws_frame_is_binary(wsi);
                     
-                    char* bytes = NULL;
-                    Data* data = new Data();
-                    
-                    if (lws_frame_is_binary(wsi))
-                    {
-                        
-                        bytes = new char[len];
-                        data->isBinary = true;
-                    }
-                    else
+                    // Strings are null terminated
+                    msg.buffer = _wsHelper->_bufferPool.get(msg.isBinary ? len : len + 1);
+                    memcpy(&(*msg.buffer)[0], in, len);
+                    if (! msg.isBinary)
                     {
-                        bytes = new char[len+1];
-                        bytes[len] = '\0';
-                        data->isBinary = false;
+                        (*msg.buffer)[len] = '\0';
                     }
-
-                    memcpy(bytes, in, len);
-                    
-                    data->bytes = bytes;
-                    data->len = len;
-                    msg->obj = (void*)data;
                     
                     _wsHelper->sendMessageToUIThread(msg);
                 }
@@ -620,14 +695,6 @@ void WebSocket::onUIThreadReceiveMessage(WsMessage* msg)
                 _delegate->onOpen(this);
             }
             break;
-        case WS_MSG_TO_UITHREAD_MESSAGE:
-            {
-                Data* data = (Data*)msg->obj;
-                _delegate->onMessage(this, *data);
-                CC_SAFE_DELETE_ARRAY(data->bytes);
-                CC_SAFE_DELETE(data);
-            }
-            break;
         case WS_MSG_TO_UITHREAD_CLOSE:
             {
                 _delegate->onClose(this);
@@ -33,6 +33,7 @@
 #include "ExtensionMacros.h"
 #include "cocos2d.h"
 #include <list>
+#include <vector>
 
 struct libwebsocket;
 struct libwebsocket_context;
@@ -90,6 +91,17 @@ public:
         virtual ~Delegate() {}
         virtual void onOpen(WebSocket* ws) = 0;
         virtual void onMessage(WebSocket* ws, const Data& data) = 0;
+        /**
+         *  Receives all the messages received since the previous frame in one call.
+         *  By default, onMessage() is called for each of them. The bytes are only valid during the call.
+         */
+        virtual void onMessages(WebSocket* ws, const std::vector<Data>& messages)
+        {
+            for (auto iter = messages.begin(); iter != messages.end(); ++iter)
+            {
+                onMessage(ws, *iter);
+            }
+        }
         virtual void onClose(WebSocket* ws) = 0;
         virtual void onError(WebSocket* ws, const ErrorCode& error) = 0;
     };
@@ -106,6 +118,12 @@ public:
               const std::string& url,
               const std::vector<std::string>* protocols = NULL);
     
+    /**
+     *  @brief Sets whether the messages may be compressed, with the deflate extensions of libwebsockets
+     *         when the server supports them. Enabled by default, it must be set before init().
+     */
+    void setCompressionEnabled(bool enabled);
+    
     /**
      *  @brief Sends string data to websocket server.
      */
@@ -153,6 +171,7 @@ private:
     Delegate* _delegate;
     int _SSLConnection;
     struct libwebsocket_protocols* _wsProtocols;
+    bool _compressionEnabled;
 };
 
 NS_CC_EXT_END
@@ -31,6 +31,7 @@
 #include <math.h>
 #include <limits.h>
 #include <string.h>
+#include <functional>
 
 NS_CC_EXT_BEGIN
 
@@ -175,8 +176,38 @@ static void DrawConstraint(cpConstraint *constraint, DrawNode *renderer)
 	}
 }
 
+static inline void hashCombine(size_t& hash, size_t value)
+{
+    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+
+static inline size_t hashFloat(cpFloat value)
+{
+    return std::hash<cpFloat>()(value);
+}
+
 // implementation of PhysicsDebugNode
 
+void PhysicsDebugNode::collectShape(cpShape *shape, PhysicsDebugNode *node)
+{
+    cpBody *body = shape->body;
+    if (cpBodyIsRogue(body) || cpBodyIsStatic(body) || cpBodyIsSleeping(body))
+    {
+        // a rogue body is static unless it is moved by hand, which changes the bounding box of its shapes
+        node->_cachedShapes.push_back(shape);
+        hashCombine(node->_shapesHash, std::hash<cpShape*>()(shape));
+        hashCombine(node->_shapesHash, hashFloat(shape->bb.l));
+        hashCombine(node->_shapesHash, hashFloat(shape->bb.b));
+        hashCombine(node->_shapesHash, hashFloat(shape->bb.r));
+        hashCombine(node->_shapesHash, hashFloat(shape->bb.t));
+        hashCombine(node->_shapesHash, hashFloat(body->a));
+    }
+    else
+    {
+        node->_dynamicShapes.push_back(shape);
+    }
+}
+
 void PhysicsDebugNode::draw()
 {
     if (! _spacePtr)
@@ -184,15 +215,42 @@ void PhysicsDebugNode::draw()
         return;
     }
     
-    cpSpaceEachShape(_spacePtr, (cpSpaceShapeIteratorFunc)DrawShape, this);
+    _cachedShapes.clear();
+    _dynamicShapes.clear();
+    _shapesHash = 0;
+    cpSpaceEachShape(_spacePtr, (cpSpaceShapeIteratorFunc)collectShape, this);
+    hashCombine(_shapesHash, _cachedShapes.size());
+    
+    DrawNode::clear();
+    if (_shapesHash != _cachedHash)
+    {
+        for (auto shape : _cachedShapes)
+        {
+            DrawShape(shape, this);
+        }
+        _cachedVertices.assign(_buffer, _buffer + _bufferCount);
+        _cachedHash = _shapesHash;
+    }
+    else if (! _cachedVertices.empty())
+    {
+        ensureCapacity((int)_cachedVertices.size());
+        memcpy(_buffer, &_cachedVertices[0], _cachedVertices.size() * sizeof(V2F_C4B_T2F));
+        _bufferCount = (GLsizei)_cachedVertices.size();
+    }
+    
+    for (auto shape : _dynamicShapes)
+    {
+        DrawShape(shape, this);
+    }
 	cpSpaceEachConstraint(_spacePtr, (cpSpaceConstraintIteratorFunc)DrawConstraint, this);
     
     DrawNode::draw();
-    DrawNode::clear();
 }
 
 PhysicsDebugNode::PhysicsDebugNode()
 : _spacePtr(NULL)
+, _cachedHash(0)
+, _shapesHash(0)
 {}
 
 PhysicsDebugNode* PhysicsDebugNode::create(cpSpace *space)
@@ -226,6 +284,8 @@ cpSpace* PhysicsDebugNode::getSpace() const
 void PhysicsDebugNode::setSpace(cpSpace *space)
 {
     _spacePtr = space;
+    _cachedVertices.clear();
+    _cachedHash = 0;
 }
 
 NS_CC_EXT_END
@@ -60,8 +60,18 @@ public:
     virtual void draw() override;
 
 protected:
+    static void collectShape(cpShape *shape, PhysicsDebugNode *node);
+
     cpSpace *_spacePtr;
 
+    // The shapes of the static and sleeping bodies don't move: their vertices are kept from a frame to the next,
+    // until the hash of these shapes and of their bounding boxes changes
+    std::vector<cpShape*> _cachedShapes;
+    std::vector<cpShape*> _dynamicShapes;
+    std::vector<V2F_C4B_T2F> _cachedVertices;
+    size_t _cachedHash;
+    size_t _shapesHash;
+
 };
 
 NS_CC_EXT_END
@@ -21,6 +21,7 @@
  */
 
 #include "CCPhysicsSprite.h"
+#include "CCPhysicsStepper.h"
 
 #if defined(CC_ENABLE_CHIPMUNK_INTEGRATION) && defined(CC_ENABLE_BOX2D_INTEGRATION)
 #error "Either Chipmunk or Box2d should be enabled, but not both at the same time"
@@ -39,8 +40,15 @@ PhysicsSprite::PhysicsSprite()
 , _CPBody(NULL)
 , _pB2Body(NULL)
 , _PTMRatio(0.0f)
+, _stepper(NULL)
+, _stepperIndex(0)
 {}
 
+PhysicsSprite::~PhysicsSprite()
+{
+    setPhysicsStepper(NULL);
+}
+
 PhysicsSprite* PhysicsSprite::create()
 {
     PhysicsSprite* pRet = new PhysicsSprite();
@@ -164,6 +172,39 @@ void PhysicsSprite::setIgnoreBodyRotation(bool bIgnoreBodyRotation)
     _ignoreBodyRotation = bIgnoreBodyRotation;
 }
 
+PhysicsStepper* PhysicsSprite::getPhysicsStepper() const
+{
+    return _stepper;
+}
+
+void PhysicsSprite::setPhysicsStepper(PhysicsStepper *pStepper)
+{
+    if (_stepper == pStepper)
+    {
+        return;
+    }
+
+    if (_stepper)
+    {
+        _stepper->removeSprite(this);
+        _stepper->release();
+    }
+    _stepper = pStepper;
+    if (_stepper)
+    {
+        _stepper->retain();
+        _stepper->addSprite(this);
+    }
+}
+
+void PhysicsSprite::resetStepperState()
+{
+    if (_stepper)
+    {
+        _stepper->resetSprite(this);
+    }
+}
+
 // Override the setters and getters to always reflect the body's properties.
 const Point& PhysicsSprite::getPosition() const
 {
@@ -204,6 +245,7 @@ cpBody* PhysicsSprite::getCPBody() const
 void PhysicsSprite::setCPBody(cpBody *pBody)
 {
     _CPBody = pBody;
+    resetStepperState();
 }
 
 b2Body* PhysicsSprite::getB2Body() const
@@ -241,6 +283,7 @@ b2Body* PhysicsSprite::getB2Body() const
 void PhysicsSprite::setB2Body(b2Body *pBody)
 {
     _pB2Body = pBody;
+    resetStepperState();
 }
 
 float PhysicsSprite::getPTMRatio() const
@@ -251,6 +294,7 @@ float PhysicsSprite::getPTMRatio() const
 void PhysicsSprite::setPTMRatio(float fRatio)
 {
     _PTMRatio = fRatio;
+    resetStepperState();
 }
 
 cpBody* PhysicsSprite::getCPBody() const
@@ -273,6 +317,13 @@ void PhysicsSprite::setCPBody(cpBody *pBody)
 const Point& PhysicsSprite::getPosFromPhysics() const
 {
     static Point s_physicPosion;
+    if (_stepper)
+    {
+        float angle;
+        _stepper->getSpriteState(this, &s_physicPosion.x, &s_physicPosion.y, &angle);
+        return s_physicPosion;
+    }
+
 #if CC_ENABLE_CHIPMUNK_INTEGRATION
 
     cpVect cpPos = cpBodyGetPos(_CPBody);
@@ -290,6 +341,11 @@ const Point& PhysicsSprite::getPosFromPhysics() const
 
 void PhysicsSprite::setPosition(const Point &pos)
 {
+    if (_stepper)
+    {
+        _stepper->waitForStep();
+    }
+
 #if CC_ENABLE_CHIPMUNK_INTEGRATION
 
     cpVect cpPos = cpv(pos.x, pos.y);
@@ -301,10 +357,22 @@ void PhysicsSprite::setPosition(const Point &pos)
     _pB2Body->SetTransform(b2Vec2(pos.x / _PTMRatio, pos.y / _PTMRatio), angle);
 #endif
 
+    resetStepperState();
 }
 
 float PhysicsSprite::getRotation() const
 {
+    if (_stepper && !_ignoreBodyRotation)
+    {
+        float x, y, angle;
+        _stepper->getSpriteState(this, &x, &y, &angle);
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+        return -CC_RADIANS_TO_DEGREES(angle);
+#else
+        return CC_RADIANS_TO_DEGREES(angle);
+#endif
+    }
+
 #if CC_ENABLE_CHIPMUNK_INTEGRATION
 
     return (_ignoreBodyRotation ? Sprite::getRotation() : -CC_RADIANS_TO_DEGREES(cpBodyGetAngle(_CPBody)));
@@ -322,23 +390,27 @@ void PhysicsSprite::setRotation(float fRotation)
     if (_ignoreBodyRotation)
     {
         Sprite::setRotation(fRotation);
+        return;
     }
 
-#if CC_ENABLE_CHIPMUNK_INTEGRATION
-    else
+    if (_stepper)
     {
-        cpBodySetAngle(_CPBody, -CC_DEGREES_TO_RADIANS(fRotation));
+        _stepper->waitForStep();
     }
 
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+
+    cpBodySetAngle(_CPBody, -CC_DEGREES_TO_RADIANS(fRotation));
+
 #elif CC_ENABLE_BOX2D_INTEGRATION
-    else
-    {
-        b2Vec2 p = _pB2Body->GetPosition();
-        float radians = CC_DEGREES_TO_RADIANS(fRotation);
-        _pB2Body->SetTransform(p, radians);
-    }
+
+    b2Vec2 p = _pB2Body->GetPosition();
+    float radians = CC_DEGREES_TO_RADIANS(fRotation);
+    _pB2Body->SetTransform(p, radians);
 #endif
 
+    resetStepperState();
+
 }
 
 // returns the transform matrix according the Chipmunk Body values
@@ -348,11 +420,26 @@ AffineTransform PhysicsSprite::getNodeToParentTransform() const
 	// the sprite is animated (scaled up/down) using actions.
 	// For more info see: http://www.cocos2d-iphone.org/forum/topic/68990
 
+    // with a stepper, the state of the body is interpolated between the last two steps
+    float bodyX, bodyY, bodyAngle;
+    if (_stepper)
+    {
+        _stepper->getSpriteState(this, &bodyX, &bodyY, &bodyAngle);
+    }
+
 #if CC_ENABLE_CHIPMUNK_INTEGRATION
 
-	cpVect rot = (_ignoreBodyRotation ? cpvforangle(-CC_DEGREES_TO_RADIANS(_rotationX)) : _CPBody->rot);
-	float x = _CPBody->p.x + rot.x * -_anchorPointInPoints.x * _scaleX - rot.y * -_anchorPointInPoints.y * _scaleY;
-	float y = _CPBody->p.y + rot.y * -_anchorPointInPoints.x * _scaleX + rot.x * -_anchorPointInPoints.y * _scaleY;
+    cpVect bodyPos = _CPBody->p;
+    cpVect bodyRot = _CPBody->rot;
+    if (_stepper)
+    {
+        bodyPos = cpv(bodyX, bodyY);
+        bodyRot = cpvforangle(bodyAngle);
+    }
+
+	cpVect rot = (_ignoreBodyRotation ? cpvforangle(-CC_DEGREES_TO_RADIANS(_rotationX)) : bodyRot);
+	float x = bodyPos.x + rot.x * -_anchorPointInPoints.x * _scaleX - rot.y * -_anchorPointInPoints.y * _scaleY;
+	float y = bodyPos.y + rot.y * -_anchorPointInPoints.x * _scaleX + rot.x * -_anchorPointInPoints.y * _scaleY;
 
 	if (_ignoreAnchorPointForPosition)
     {
@@ -367,10 +454,16 @@ AffineTransform PhysicsSprite::getNodeToParentTransform() const
 
 #elif CC_ENABLE_BOX2D_INTEGRATION
 
-    b2Vec2 pos  = _pB2Body->GetPosition();
+    if (!_stepper)
+    {
+        b2Vec2 pos  = _pB2Body->GetPosition();
+        bodyX = pos.x * _PTMRatio;
+        bodyY = pos.y * _PTMRatio;
+        bodyAngle = _pB2Body->GetAngle();
+    }
 
-	float x = pos.x * _PTMRatio;
-	float y = pos.y * _PTMRatio;
+	float x = bodyX;
+	float y = bodyY;
 
 	if (_ignoreAnchorPointForPosition)
     {
@@ -379,7 +472,7 @@ AffineTransform PhysicsSprite::getNodeToParentTransform() const
 	}
 
 	// Make matrix
-	float radians = _pB2Body->GetAngle();
+	float radians = bodyAngle;
 	float c = cosf(radians);
 	float s = sinf(radians);
 
@@ -29,6 +29,9 @@ struct cpBody;
 class b2Body;
 
 NS_CC_EXT_BEGIN
+
+class PhysicsStepper;
+
 /** A Sprite subclass that is bound to a physics body.
  It works with:
  - Chipmunk: Preprocessor macro CC_ENABLE_CHIPMUNK_INTEGRATION should be defined
@@ -40,6 +43,7 @@ NS_CC_EXT_BEGIN
  - Position and rotation are going to updated from the physics body
  - If you update the rotation or position manually, the physics body will be updated
  - You can't enble both Chipmunk support and Box2d support at the same time. Only one can be enabled at compile time
+ - With a PhysicsStepper, the sprite is drawn with the state of the body interpolated between the last two steps
  */
 class PhysicsSprite : public Sprite
 {
@@ -79,6 +83,7 @@ public:
     static PhysicsSprite* create(const char *pszFileName, const Rect& rect);
 
     PhysicsSprite();
+    virtual ~PhysicsSprite();
 
     virtual bool isDirty() const;
 
@@ -103,6 +108,13 @@ public:
     float getPTMRatio() const;
     void setPTMRatio(float fPTMRatio);
 
+    /** Stepper of the physics engine of the body, NULL by default.
+     The position and the rotation are read from the interpolated state published by the stepper,
+     and the setters wait for the stepper before changing the body.
+     */
+    PhysicsStepper* getPhysicsStepper() const;
+    void setPhysicsStepper(PhysicsStepper *pStepper);
+
     // overrides
     virtual const Point& getPosition() const override;
     virtual void getPosition(float* x, float* y) const override;
@@ -114,7 +126,11 @@ public:
     virtual AffineTransform getNodeToParentTransform() const override;
 
 protected:
+    friend class PhysicsStepper;
+
     const Point& getPosFromPhysics() const;
+    /** lets the stepper read the body again after it was changed */
+    void resetStepperState();
 
 protected:
     bool    _ignoreBodyRotation;
@@ -125,8 +141,10 @@ protected:
     // box2d specific
     b2Body  *_pB2Body;
     float   _PTMRatio;
-    
 
+    PhysicsStepper  *_stepper;
+    /** index of the sprite in the stepper */
+    unsigned int    _stepperIndex;
 };
 
 NS_CC_EXT_END
@@ -0,0 +1,388 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "CCPhysicsStepper.h"
+#include "CCPhysicsSprite.h"
+#include <math.h>
+#include <string.h>
+
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+#include "chipmunk.h"
+#elif CC_ENABLE_BOX2D_INTEGRATION
+#include "Box2D/Box2D.h"
+#endif
+
+NS_CC_EXT_BEGIN
+
+PhysicsStepper::PhysicsStepper()
+: _space(NULL)
+, _world(NULL)
+, _velocityIterations(8)
+, _positionIterations(3)
+, _fixedTimeStep(1.0f / 60.0f)
+, _maxStepsPerFrame(5)
+, _asynchronous(true)
+, _accumulator(0.0f)
+, _front(0)
+, _interpolation(0.0f)
+, _pendingInterpolation(0.0f)
+, _pending(false)
+{
+}
+
+PhysicsStepper::~PhysicsStepper()
+{
+    waitForStep();
+    CCASSERT(_slots.empty(), "the sprites retain their stepper");
+}
+
+PhysicsStepper* PhysicsStepper::create(cpSpace* space)
+{
+    PhysicsStepper* pRet = new PhysicsStepper();
+    if (pRet && pRet->initWithSpace(space))
+    {
+        pRet->autorelease();
+    }
+    else
+    {
+        CC_SAFE_DELETE(pRet);
+    }
+
+    return pRet;
+}
+
+PhysicsStepper* PhysicsStepper::create(b2World* world)
+{
+    PhysicsStepper* pRet = new PhysicsStepper();
+    if (pRet && pRet->initWithWorld(world))
+    {
+        pRet->autorelease();
+    }
+    else
+    {
+        CC_SAFE_DELETE(pRet);
+    }
+
+    return pRet;
+}
+
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+
+bool PhysicsStepper::initWithSpace(cpSpace* space)
+{
+    CCASSERT(space, "space can't be NULL");
+    if (!Node::init())
+    {
+        return false;
+    }
+
+    _space = space;
+    scheduleUpdateWithPriority(Scheduler::PRIORITY_NON_SYSTEM_MIN);
+    return true;
+}
+
+bool PhysicsStepper::initWithWorld(b2World* world)
+{
+    CCASSERT(false, "Can't call box2d methods when Chipmunk is enabled");
+    return false;
+}
+
+#elif CC_ENABLE_BOX2D_INTEGRATION
+
+bool PhysicsStepper::initWithWorld(b2World* world)
+{
+    CCASSERT(world, "world can't be NULL");
+    if (!Node::init())
+    {
+        return false;
+    }
+
+    _world = world;
+    scheduleUpdateWithPriority(Scheduler::PRIORITY_NON_SYSTEM_MIN);
+    return true;
+}
+
+bool PhysicsStepper::initWithSpace(cpSpace* space)
+{
+    CCASSERT(false, "Can't call Chipmunk methods when Box2d is enabled");
+    return false;
+}
+
+#else
+
+bool PhysicsStepper::initWithSpace(cpSpace* space)
+{
+    CCASSERT(false, "Chipmunk integration is not enabled");
+    return false;
+}
+
+bool PhysicsStepper::initWithWorld(b2World* world)
+{
+    CCASSERT(false, "Box2d integration is not enabled");
+    return false;
+}
+
+#endif
+
+void PhysicsStepper::setFixedTimeStep(float step)
+{
+    CCASSERT(step > 0, "the time step must be positive");
+    _fixedTimeStep = step;
+}
+
+float PhysicsStepper::getFixedTimeStep() const
+{
+    return _fixedTimeStep;
+}
+
+void PhysicsStepper::setMaxStepsPerFrame(unsigned int steps)
+{
+    _maxStepsPerFrame = steps;
+}
+
+unsigned int PhysicsStepper::getMaxStepsPerFrame() const
+{
+    return _maxStepsPerFrame;
+}
+
+void PhysicsStepper::setAsynchronous(bool asynchronous)
+{
+    _asynchronous = asynchronous;
+}
+
+bool PhysicsStepper::isAsynchronous() const
+{
+    return _asynchronous;
+}
+
+void PhysicsStepper::setVelocityIterations(int iterations)
+{
+    _velocityIterations = iterations;
+}
+
+int PhysicsStepper::getVelocityIterations() const
+{
+    return _velocityIterations;
+}
+
+void PhysicsStepper::setPositionIterations(int iterations)
+{
+    _positionIterations = iterations;
+}
+
+int PhysicsStepper::getPositionIterations() const
+{
+    return _positionIterations;
+}
+
+float PhysicsStepper::getInterpolation() const
+{
+    return _interpolation;
+}
+
+void PhysicsStepper::waitForStep()
+{
+    if (_task)
+    {
+        JobSystem::getInstance()->waitForTask(_task);
+        _task.reset();
+    }
+    publish();
+}
+
+void PhysicsStepper::publish()
+{
+    if (_pending)
+    {
+        _front = 1 - _front;
+        _pending = false;
+    }
+    _interpolation = _pendingInterpolation;
+}
+
+void PhysicsStepper::onExit()
+{
+    waitForStep();
+    Node::onExit();
+}
+
+void PhysicsStepper::update(float delta)
+{
+    // the steps started by the last frame are done before any other update uses the physics engine
+    waitForStep();
+    _accumulator += delta;
+}
+
+void PhysicsStepper::visit()
+{
+    // the updates of the frame are done: the physics engine isn't used by the main thread until the next one.
+    // Without update since the last visit, when the scene is paused, there is nothing to step.
+    if (!_pending)
+    {
+        unsigned int steps = (unsigned int)(_accumulator / _fixedTimeStep);
+        if (steps > _maxStepsPerFrame)
+        {
+            steps = _maxStepsPerFrame;
+        }
+        _accumulator -= steps * _fixedTimeStep;
+        if (_accumulator >= _fixedTimeStep)
+        {
+            _accumulator = fmodf(_accumulator, _fixedTimeStep);
+        }
+        _pendingInterpolation = _accumulator / _fixedTimeStep;
+
+        if (steps > 0)
+        {
+            _pending = true;
+            float stepDuration = _fixedTimeStep;
+            if (_asynchronous)
+            {
+                _task = JobSystem::getInstance()->addTask([this, steps, stepDuration]() {
+                    step(steps, stepDuration);
+                }, nullptr);
+            }
+            else
+            {
+                step(steps, stepDuration);
+            }
+        }
+    }
+
+    Node::visit();
+}
+
+void PhysicsStepper::step(unsigned int steps, float stepDuration)
+{
+    std::vector<Frame>& frames = _frames[1 - _front];
+    for (unsigned int i = 0; i < steps; ++i)
+    {
+        if (i == steps - 1)
+        {
+            for (size_t j = 0; j < _slots.size(); ++j)
+            {
+                readBody(_slots[j], &frames[j].previous);
+            }
+        }
+
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+        cpSpaceStep(_space, stepDuration);
+#elif CC_ENABLE_BOX2D_INTEGRATION
+        _world->Step(stepDuration, _velocityIterations, _positionIterations);
+#endif
+    }
+
+    for (size_t j = 0; j < _slots.size(); ++j)
+    {
+        readBody(_slots[j], &frames[j].current);
+    }
+}
+
+void PhysicsStepper::readBody(const Slot& slot, BodyState* state) const
+{
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+    if (slot.chipmunkBody)
+    {
+        cpVect pos = cpBodyGetPos(slot.chipmunkBody);
+        state->x = pos.x;
+        state->y = pos.y;
+        state->angle = cpBodyGetAngle(slot.chipmunkBody);
+    }
+#elif CC_ENABLE_BOX2D_INTEGRATION
+    if (slot.box2dBody)
+    {
+        const b2Vec2& pos = slot.box2dBody->GetPosition();
+        state->x = pos.x * slot.ptmRatio;
+        state->y = pos.y * slot.ptmRatio;
+        state->angle = slot.box2dBody->GetAngle();
+    }
+#endif
+}
+
+void PhysicsStepper::initSlot(Slot& slot, PhysicsSprite* sprite) const
+{
+    slot.sprite = sprite;
+    slot.chipmunkBody = sprite->_CPBody;
+    slot.box2dBody = sprite->_pB2Body;
+    slot.ptmRatio = sprite->_PTMRatio;
+}
+
+void PhysicsStepper::addSprite(PhysicsSprite* sprite)
+{
+    waitForStep();
+
+    Slot slot;
+    initSlot(slot, sprite);
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    readBody(slot, &frame.current);
+    frame.previous = frame.current;
+
+    sprite->_stepperIndex = (unsigned int)_slots.size();
+    _slots.push_back(slot);
+    _frames[0].push_back(frame);
+    _frames[1].push_back(frame);
+}
+
+void PhysicsStepper::removeSprite(PhysicsSprite* sprite)
+{
+    waitForStep();
+
+    unsigned int index = sprite->_stepperIndex;
+    CCASSERT(index < _slots.size() && _slots[index].sprite == sprite, "sprite not added to the stepper");
+
+    // the last sprite takes the place of the removed one
+    unsigned int last = (unsigned int)_slots.size() - 1;
+    if (index != last)
+    {
+        _slots[index] = _slots[last];
+        _frames[0][index] = _frames[0][last];
+        _frames[1][index] = _frames[1][last];
+        _slots[index].sprite->_stepperIndex = index;
+    }
+    _slots.pop_back();
+    _frames[0].pop_back();
+    _frames[1].pop_back();
+}
+
+void PhysicsStepper::resetSprite(PhysicsSprite* sprite)
+{
+    waitForStep();
+
+    Slot& slot = _slots[sprite->_stepperIndex];
+    initSlot(slot, sprite);
+    Frame& frame = _frames[_front][sprite->_stepperIndex];
+    readBody(slot, &frame.current);
+    frame.previous = frame.current;
+}
+
+void PhysicsStepper::getSpriteState(const PhysicsSprite* sprite, float* x, float* y, float* angle) const
+{
+    const Frame& frame = _frames[_front][sprite->_stepperIndex];
+    float t = _interpolation;
+    *x = frame.previous.x + (frame.current.x - frame.previous.x) * t;
+    *y = frame.previous.y + (frame.current.y - frame.previous.y) * t;
+    *angle = frame.previous.angle + (frame.current.angle - frame.previous.angle) * t;
+}
+
+NS_CC_EXT_END
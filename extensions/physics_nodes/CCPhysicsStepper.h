@@ -0,0 +1,177 @@
+/****************************************************************************
+ Copyright (c) 2013 cocos2d-x.org
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __PHYSICSNODES_CCPHYSICSSTEPPER_H__
+#define __PHYSICSNODES_CCPHYSICSSTEPPER_H__
+
+#include "cocos2d.h"
+#include "ExtensionMacros.h"
+#include "support/CCJobSystem.h"
+#include <vector>
+
+struct cpSpace;
+struct cpBody;
+class b2World;
+class b2Body;
+
+NS_CC_EXT_BEGIN
+
+class PhysicsSprite;
+
+/** Steps a Chipmunk space or a Box2d world with a fixed time step, on a worker thread of the JobSystem.
+
+ The stepper is a node added to the scene. The steps of a frame are started when the stepper is visited,
+ once all the updates and the scheduled selectors of the frame are done, and run while the scene is drawn.
+ They are waited for by the update of the stepper, scheduled before all the other ones, at the beginning
+ of the next frame: the game code can use the physics engine during the updates as before.
+
+ The positions and angles of the bodies of the PhysicsSprite set with PhysicsSprite::setPhysicsStepper are
+ copied after the last two steps, and published to the sprites when the steps are done. The sprites are
+ drawn with the state interpolated between them, by the time left in the accumulator, so that the motion
+ is smooth when the frame rate isn't a multiple of the step rate. The sprites are drawn one frame late.
+
+ - The collision callbacks and contact listeners are called on the worker thread: they must not touch the
+   nodes, they can record what to do in the next update.
+ - The physics engine must not be used out of the updates while stepping, call waitForStep() before.
+   The setters of PhysicsSprite do it.
+ - PhysicsDebugNode reads the space while drawing: set the stepper synchronous to use it.
+
+ It works with the physics engine enabled for PhysicsSprite, see CC_ENABLE_CHIPMUNK_INTEGRATION and
+ CC_ENABLE_BOX2D_INTEGRATION.
+ */
+class PhysicsStepper : public Node
+{
+public:
+    /** Creates a stepper of a Chipmunk space */
+    static PhysicsStepper* create(cpSpace* space);
+
+    /** Creates a stepper of a Box2d world */
+    static PhysicsStepper* create(b2World* world);
+
+    PhysicsStepper();
+    virtual ~PhysicsStepper();
+
+    bool initWithSpace(cpSpace* space);
+    bool initWithWorld(b2World* world);
+
+    /** Duration of a step, 1/60 s by default */
+    void setFixedTimeStep(float step);
+    float getFixedTimeStep() const;
+
+    /** Maximum number of steps per frame, 5 by default. The time over it is dropped, so that a slow frame
+     doesn't make the next ones slower.
+     */
+    void setMaxStepsPerFrame(unsigned int steps);
+    unsigned int getMaxStepsPerFrame() const;
+
+    /** Whether the steps run on a worker thread, true by default.
+     When false, they run when the stepper is visited, and the sprites are updated the same way.
+     */
+    void setAsynchronous(bool asynchronous);
+    bool isAsynchronous() const;
+
+    /** Iterations of the Box2d solver, 8 and 3 by default */
+    void setVelocityIterations(int iterations);
+    int getVelocityIterations() const;
+    void setPositionIterations(int iterations);
+    int getPositionIterations() const;
+
+    /** Waits for the steps in progress. The physics engine can be used afterwards until the stepper is visited. */
+    void waitForStep();
+
+    /** Fraction of a step the sprites are interpolated with, between 0 and 1 */
+    float getInterpolation() const;
+
+    // overrides
+    virtual void onExit() override;
+    virtual void update(float delta) override;
+    virtual void visit() override;
+
+protected:
+    friend class PhysicsSprite;
+
+    /** Position in points and angle in radians of a body, as given by the physics engine */
+    struct BodyState
+    {
+        float x;
+        float y;
+        float angle;
+    };
+
+    /** States of a body after the last two steps */
+    struct Frame
+    {
+        BodyState previous;
+        BodyState current;
+    };
+
+    struct Slot
+    {
+        PhysicsSprite* sprite;
+        cpBody* chipmunkBody;
+        b2Body* box2dBody;
+        float ptmRatio;
+    };
+
+    void addSprite(PhysicsSprite* sprite);
+    void removeSprite(PhysicsSprite* sprite);
+    /** Copies the body of a sprite after it was changed by the main thread, so that the change isn't interpolated */
+    void resetSprite(PhysicsSprite* sprite);
+    /** Interpolated state of the body of a sprite */
+    void getSpriteState(const PhysicsSprite* sprite, float* x, float* y, float* angle) const;
+    void initSlot(Slot& slot, PhysicsSprite* sprite) const;
+
+    void readBody(const Slot& slot, BodyState* state) const;
+    /** Runs the steps and copies the bodies to the back buffer, on the worker thread */
+    void step(unsigned int steps, float stepDuration);
+    /** Makes the back buffer the one read by the sprites */
+    void publish();
+
+    cpSpace* _space;
+    b2World* _world;
+    int _velocityIterations;
+    int _positionIterations;
+
+    float _fixedTimeStep;
+    unsigned int _maxStepsPerFrame;
+    bool _asynchronous;
+    /** time not stepped yet */
+    float _accumulator;
+
+    std::vector<Slot> _slots;
+    /** the sprites read _frames[_front], the steps write the other buffer */
+    std::vector<Frame> _frames[2];
+    int _front;
+    /** interpolation of the front buffer, and the one of the back buffer once the steps are done */
+    float _interpolation;
+    float _pendingInterpolation;
+    /** whether steps were started since the back buffer was published */
+    bool _pending;
+
+    JobSystem::TaskPtr _task;
+};
+
+NS_CC_EXT_END
+
+#endif // __PHYSICSNODES_CCPHYSICSSTEPPER_H__
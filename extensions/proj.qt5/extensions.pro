@@ -50,6 +50,7 @@ SOURCES += ../CCBReader/CCBFileLoader.cpp \
 ../network/HttpClient.cpp \
 ../physics_nodes/CCPhysicsDebugNode.cpp \
 ../physics_nodes/CCPhysicsSprite.cpp \
+../physics_nodes/CCPhysicsStepper.cpp \
 ../spine/Animation.cpp \
 ../spine/AnimationState.cpp \
 ../spine/AnimationStateData.cpp \
@@ -64,6 +65,7 @@ SOURCES += ../CCBReader/CCBFileLoader.cpp \
 ../spine/Skeleton.cpp \
 ../spine/SkeletonData.cpp \
 ../spine/SkeletonJson.cpp \
+../spine/SkeletonBinary.cpp \
 ../spine/Skin.cpp \
 ../spine/Slot.cpp \
 ../spine/SlotData.cpp \
@@ -25,6 +25,8 @@
 
 #include <spine/CCSkeleton.h>
 #include <spine/spine-cocos2dx.h>
+#include <list>
+#include <string>
 
 USING_NS_CC;
 using std::min;
@@ -32,6 +34,19 @@ using std::max;
 
 namespace cocos2d { namespace extension {
 
+/* Skeleton data read by createWithFile, shared by the skeletons created with the same file, atlas and scale. */
+struct CachedSkeletonData {
+	std::string path;
+	std::string atlasPath;
+	float scale;
+	Atlas* atlas;
+	bool ownedAtlas;
+	SkeletonData* skeletonData;
+	int referenceCount;
+};
+
+static std::list<CachedSkeletonData> skeletonDataCache;
+
 CCSkeleton* CCSkeleton::createWithData (SkeletonData* skeletonData, bool ownsSkeletonData) {
 	CCSkeleton* node = new CCSkeleton(skeletonData, ownsSkeletonData);
 	node->autorelease();
@@ -52,6 +67,7 @@ CCSkeleton* CCSkeleton::createWithFile (const char* skeletonDataFile, const char
 
 void CCSkeleton::initialize () {
 	atlas = 0;
+	cachedSkeletonData = 0;
 	debugSlots = false;
 	debugBones = false;
 	timeScale = 1;
@@ -82,44 +98,88 @@ CCSkeleton::CCSkeleton (SkeletonData *skeletonData, bool ownsSkeletonData) {
 CCSkeleton::CCSkeleton (const char* skeletonDataFile, Atlas* atlas, float scale) {
 	initialize();
 
-	SkeletonJson* json = SkeletonJson_create(atlas);
-	json->scale = scale;
-	SkeletonData* skeletonData = SkeletonJson_readSkeletonDataFile(json, skeletonDataFile);
-	CCASSERT(skeletonData, json->error ? json->error : "Error reading skeleton data.");
-	SkeletonJson_dispose(json);
-
-	setSkeletonData(skeletonData, true);
+	setCachedSkeletonData(skeletonDataFile, atlas, 0, scale);
 }
 
 CCSkeleton::CCSkeleton (const char* skeletonDataFile, const char* atlasFile, float scale) {
 	initialize();
 
-	atlas = Atlas_readAtlasFile(atlasFile);
-	CCASSERT(atlas, "Error reading atlas file.");
-
-	SkeletonJson* json = SkeletonJson_create(atlas);
-	json->scale = scale;
-	SkeletonData* skeletonData = SkeletonJson_readSkeletonDataFile(json, skeletonDataFile);
-	CCASSERT(skeletonData, json->error ? json->error : "Error reading skeleton data file.");
-	SkeletonJson_dispose(json);
-
-	setSkeletonData(skeletonData, true);
+	setCachedSkeletonData(skeletonDataFile, 0, atlasFile, scale);
 }
 
 CCSkeleton::~CCSkeleton () {
 	if (ownsSkeletonData) SkeletonData_dispose(skeleton->data);
 	if (atlas) Atlas_dispose(atlas);
+	if (cachedSkeletonData) cachedSkeletonData->referenceCount--;
 	Skeleton_dispose(skeleton);
 }
 
+static SkeletonData* readSkeletonDataFile (const char* skeletonDataFile, Atlas* atlas, float scale) {
+	SkeletonData* skeletonData;
+	size_t length = strlen(skeletonDataFile);
+	if (length > 5 && strcmp(skeletonDataFile + length - 5, ".ccsk") == 0) {
+		SkeletonBinary* binary = SkeletonBinary_create(atlas);
+		binary->scale = scale;
+		skeletonData = SkeletonBinary_readSkeletonDataFile(binary, skeletonDataFile);
+		CCASSERT(skeletonData, binary->error ? binary->error : "Error reading skeleton data file.");
+		SkeletonBinary_dispose(binary);
+	} else {
+		SkeletonJson* json = SkeletonJson_create(atlas);
+		json->scale = scale;
+		skeletonData = SkeletonJson_readSkeletonDataFile(json, skeletonDataFile);
+		CCASSERT(skeletonData, json->error ? json->error : "Error reading skeleton data file.");
+		SkeletonJson_dispose(json);
+	}
+	return skeletonData;
+}
+
+void CCSkeleton::setCachedSkeletonData (const char* skeletonDataFile, Atlas* atlas, const char* atlasFile, float scale) {
+	std::string path = FileUtils::getInstance()->fullPathForFilename(skeletonDataFile);
+	std::string atlasPath = atlasFile ? FileUtils::getInstance()->fullPathForFilename(atlasFile) : "";
+	for (auto it = skeletonDataCache.begin(); it != skeletonDataCache.end(); ++it) {
+		if (it->path != path || it->scale != scale) continue;
+		if (atlasFile ? !it->ownedAtlas || it->atlasPath != atlasPath : it->ownedAtlas || it->atlas != atlas) continue;
+		it->referenceCount++;
+		cachedSkeletonData = &*it;
+		setSkeletonData(it->skeletonData, false);
+		return;
+	}
+
+	CachedSkeletonData cached;
+	cached.path = path;
+	cached.atlasPath = atlasPath;
+	cached.scale = scale;
+	cached.ownedAtlas = atlasFile != 0;
+	if (atlasFile) {
+		atlas = Atlas_readAtlasFile(atlasFile);
+		CCASSERT(atlas, "Error reading atlas file.");
+	}
+	cached.atlas = atlas;
+	cached.skeletonData = readSkeletonDataFile(skeletonDataFile, atlas, scale);
+	cached.referenceCount = 1;
+	skeletonDataCache.push_front(cached);
+
+	cachedSkeletonData = &skeletonDataCache.front();
+	setSkeletonData(cached.skeletonData, false);
+}
+
+void CCSkeleton::removeUnusedSkeletonData () {
+	for (auto it = skeletonDataCache.begin(); it != skeletonDataCache.end();) {
+		if (it->referenceCount > 0) {
+			++it;
+			continue;
+		}
+		SkeletonData_dispose(it->skeletonData);
+		if (it->ownedAtlas) Atlas_dispose(it->atlas);
+		it = skeletonDataCache.erase(it);
+	}
+}
+
 void CCSkeleton::update (float deltaTime) {
 	Skeleton_update(skeleton, deltaTime * timeScale);
 }
 
 void CCSkeleton::draw () {
-	CC_NODE_DRAW_SETUP();
-
-	GL::blendFunc(blendFunc.src, blendFunc.dst);
 	Color3B color = getColor();
 	skeleton->r = color.r / (float)255;
 	skeleton->g = color.g / (float)255;
@@ -131,33 +191,47 @@ void CCSkeleton::draw () {
 		skeleton->b *= skeleton->a;
 	}
 
+	// the quads are drawn by the Renderer when it is flushed
+	kmMat4 mv;
+	kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
+
+	int n = skeleton->slotCount;
+	if ((int)quads.size() < n) {
+		QuadSource unused = {0};
+		quadSources.resize(n, unused);
+		quads.resize(n);
+		quadCommands.resize(n);
+	}
+
 	TextureAtlas* textureAtlas = 0;
-	V3F_C4B_T2F_Quad quad;
-	quad.tl.vertices.z = 0;
-	quad.tr.vertices.z = 0;
-	quad.bl.vertices.z = 0;
-	quad.br.vertices.z = 0;
-	for (int i = 0, n = skeleton->slotCount; i < n; i++) {
+	int quadCount = 0, firstQuad = 0, commandCount = 0;
+	for (int i = 0; i < n; i++) {
 		Slot* slot = skeleton->slots[i];
 		if (!slot->attachment || slot->attachment->type != ATTACHMENT_REGION) continue;
 		RegionAttachment* attachment = (RegionAttachment*)slot->attachment;
 		TextureAtlas* regionTextureAtlas = getTextureAtlas(attachment);
 		if (regionTextureAtlas != textureAtlas) {
-			if (textureAtlas) {
-				textureAtlas->drawQuads();
-				textureAtlas->removeAllQuads();
-			}
+			if (textureAtlas) addQuadCommand(textureAtlas->getTexture(), firstQuad, quadCount - firstQuad, mv, commandCount++);
+			textureAtlas = regionTextureAtlas;
+			firstQuad = quadCount;
 		}
-		textureAtlas = regionTextureAtlas;
-		if (textureAtlas->getCapacity() == textureAtlas->getTotalQuads() &&
-			!textureAtlas->resizeCapacity(textureAtlas->getCapacity() * 2)) return;
-		RegionAttachment_updateQuad(attachment, slot, &quad, premultipliedAlpha);
-		textureAtlas->updateQuad(&quad, textureAtlas->getTotalQuads());
-	}
-	if (textureAtlas) {
-		textureAtlas->drawQuads();
-		textureAtlas->removeAllQuads();
+
+		Bone* bone = slot->bone;
+		QuadSource source = {attachment, bone->m00, bone->m01, bone->m10, bone->m11, bone->worldX, bone->worldY,
+			skeleton->x, skeleton->y, skeleton->r * slot->r, skeleton->g * slot->g, skeleton->b * slot->b, skeleton->a * slot->a,
+			premultipliedAlpha};
+		QuadSource& previous = quadSources[quadCount];
+		if (previous.attachment != source.attachment || previous.m00 != source.m00 || previous.m01 != source.m01
+			|| previous.m10 != source.m10 || previous.m11 != source.m11 || previous.worldX != source.worldX
+			|| previous.worldY != source.worldY || previous.x != source.x || previous.y != source.y
+			|| previous.r != source.r || previous.g != source.g || previous.b != source.b || previous.a != source.a
+			|| previous.premultipliedAlpha != source.premultipliedAlpha) {
+			RegionAttachment_updateQuad(attachment, slot, &quads[quadCount], premultipliedAlpha);
+			previous = source;
+		}
+		quadCount++;
 	}
+	if (textureAtlas) addQuadCommand(textureAtlas->getTexture(), firstQuad, quadCount - firstQuad, mv, commandCount++);
 
 	if (debugSlots) {
 		// Slots.
@@ -202,6 +276,13 @@ TextureAtlas* CCSkeleton::getTextureAtlas (RegionAttachment* regionAttachment) c
 	return (TextureAtlas*)((AtlasRegion*)regionAttachment->rendererObject)->page->rendererObject;
 }
 
+void CCSkeleton::addQuadCommand (Texture2D* texture, int firstQuad, int quadCount, const kmMat4& mv, int commandIndex) {
+	Texture2D* alphaTexture = texture->getAlphaTexture();
+	QuadCommand& command = quadCommands[commandIndex];
+	command.init(texture->getName(), getShaderProgram(), blendFunc, &quads[firstQuad], quadCount, mv, alphaTexture ? alphaTexture->getName() : 0);
+	Director::getInstance()->getRenderer()->addCommand(&command);
+}
+
 Rect CCSkeleton::getBoundingBox() const {
 	float minX = FLT_MAX, minY = FLT_MAX, maxX = FLT_MIN, maxY = FLT_MIN;
 	float scaleX = getScaleX();
@@ -28,11 +28,18 @@
 
 #include <spine/spine.h>
 #include "cocos2d.h"
+#include <vector>
 
 namespace cocos2d { namespace extension {
 
+struct CachedSkeletonData;
+
 /**
-Draws a skeleton.
+Draws a skeleton. The quads of the slots are drawn by the Renderer, so consecutive slots and skeletons that use the
+same texture are batched like sprites. The quad of a slot is only recomputed when its bone, its attachment or its
+color changed.
+The skeleton data read by createWithFile is shared by all the skeletons created with the same file, atlas and scale, so a
+file is only read once. Files ending with .ccsk are read with SkeletonBinary, the others with SkeletonJson.
 */
 class CCSkeleton: public cocos2d::NodeRGBA, public cocos2d::BlendProtocol {
 public:
@@ -46,6 +53,10 @@ public:
 
 	virtual ~CCSkeleton ();
 
+	/* Disposes the skeleton data read by createWithFile that isn't used by a skeleton anymore, and the atlases read for it.
+	 * An atlas passed to createWithFile must not be disposed before the skeleton data read with it. */
+	static void removeUnusedSkeletonData ();
+
 	// --- Convenience methods for common Skeleton_* functions.
 	void updateWorldTransform ();
 
@@ -93,7 +104,24 @@ protected:
 private:
 	bool ownsSkeletonData;
 	Atlas* atlas;
+	CachedSkeletonData* cachedSkeletonData;
 	void initialize ();
+	void setCachedSkeletonData (const char* skeletonDataFile, Atlas* atlas, const char* atlasFile, float scale);
+	void addQuadCommand (cocos2d::Texture2D* texture, int firstQuad, int quadCount, const kmMat4& mv, int commandIndex);
+
+	/* What the quad of a slot was computed from. */
+	struct QuadSource {
+		RegionAttachment* attachment;
+		float m00, m01, m10, m11, worldX, worldY;
+		float x, y;
+		float r, g, b, a;
+		bool premultipliedAlpha;
+	};
+	std::vector<QuadSource> quadSources;
+	/* The quads of the slots with a region attachment, in draw order. */
+	std::vector<cocos2d::V3F_C4B_T2F_Quad> quads;
+	/* A command per run of quads using the same texture. */
+	std::vector<cocos2d::QuadCommand> quadCommands;
 };
 
 }} // namespace cocos2d { namespace extension {
@@ -52,19 +52,25 @@ CCSkeletonAnimation* CCSkeletonAnimation::createWithFile (const char* skeletonDa
 	return node;
 }
 
+void CCSkeletonAnimation::initialize () {
+	evaluatedInParallel = false;
+	evaluationDelta = 0;
+	addAnimationState();
+}
+
 CCSkeletonAnimation::CCSkeletonAnimation (SkeletonData *skeletonData)
 		: CCSkeleton(skeletonData) {
-	addAnimationState();
+	initialize();
 }
 
 CCSkeletonAnimation::CCSkeletonAnimation (const char* skeletonDataFile, Atlas* atlas, float scale)
 		: CCSkeleton(skeletonDataFile, atlas, scale) {
-	addAnimationState();
+	initialize();
 }
 
 CCSkeletonAnimation::CCSkeletonAnimation (const char* skeletonDataFile, const char* atlasFile, float scale)
 		: CCSkeleton(skeletonDataFile, atlasFile, scale) {
-	addAnimationState();
+	initialize();
 }
 
 CCSkeletonAnimation::~CCSkeletonAnimation () {
@@ -79,11 +85,25 @@ void CCSkeletonAnimation::update (float deltaTime) {
 	super::update(deltaTime);
 
 	deltaTime *= timeScale;
+	if (evaluatedInParallel) {
+		// the pose is evaluated once all the update selectors were called
+		evaluationDelta = deltaTime;
+		SkeletonEvaluator::getInstance()->addSkeleton(this, this);
+		return;
+	}
+	updateAnimationStates(deltaTime, true);
+}
+
+void CCSkeletonAnimation::evaluatePose () {
+	updateAnimationStates(evaluationDelta, isVisible());
+}
+
+void CCSkeletonAnimation::updateAnimationStates (float deltaTime, bool applyPose) {
 	for (std::vector<AnimationState*>::iterator iter = states.begin(); iter != states.end(); ++iter) {
 		AnimationState_update(*iter, deltaTime);
-		AnimationState_apply(*iter, skeleton);
+		if (applyPose) AnimationState_apply(*iter, skeleton);
 	}
-	Skeleton_updateWorldTransform(skeleton);
+	if (applyPose) Skeleton_updateWorldTransform(skeleton);
 }
 
 void CCSkeletonAnimation::addAnimationState (AnimationStateData* stateData) {
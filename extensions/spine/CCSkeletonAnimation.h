@@ -35,9 +35,13 @@ namespace cocos2d { namespace extension {
 /**
 Draws an animated skeleton, providing a simple API for applying one or more animations and queuing animations to be played later.
 */
-class CCSkeletonAnimation: public CCSkeleton {
+class CCSkeletonAnimation: public CCSkeleton, public cocos2d::SkeletonEvaluator::Target {
 public:
 	std::vector<AnimationState*> states;
+	/* Whether the animations are applied by the SkeletonEvaluator, on the threads of the JobSystem, together with the other
+	 * skeletons evaluated in parallel, once all the update selectors were called. The animations of a skeleton that isn't
+	 * visible then only advance. False by default. */
+	bool evaluatedInParallel;
 
 	static CCSkeletonAnimation* createWithData (SkeletonData* skeletonData);
 	static CCSkeletonAnimation* createWithFile (const char* skeletonDataFile, Atlas* atlas, float scale = 1);
@@ -50,6 +54,7 @@ public:
 	virtual ~CCSkeletonAnimation ();
 
 	virtual void update (float deltaTime);
+	virtual void evaluatePose () override;
 
 	void addAnimationState (AnimationStateData* stateData = 0);
 	void setAnimationStateData (AnimationStateData* stateData, int stateIndex = 0);
@@ -64,8 +69,10 @@ protected:
 private:
 	typedef CCSkeleton super;
 	std::vector<AnimationStateData*> stateDatas;
+	float evaluationDelta;
 
 	void initialize ();
+	void updateAnimationStates (float deltaTime, bool applyPose);
 };
 
 }} // namespace cocos2d { namespace extension {
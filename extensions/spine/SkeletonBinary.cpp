@@ -0,0 +1,398 @@
+/*******************************************************************************
+ * Copyright (c) 2013, Esoteric Software
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include <spine/SkeletonBinary.h>
+#include <string.h>
+#include <spine/extension.h>
+#include <spine/RegionAttachment.h>
+#include <spine/AtlasAttachmentLoader.h>
+
+namespace cocos2d { namespace extension {
+
+static const char MAGIC[4] = {'C', 'C', 'S', 'K'};
+static const unsigned int VERSION = 1;
+static const unsigned int NO_STRING = 0xffffffff;
+
+enum {
+	TIMELINE_ROTATE, TIMELINE_TRANSLATE, TIMELINE_SCALE, TIMELINE_COLOR, TIMELINE_ATTACHMENT
+};
+
+enum {
+	CURVE_LINEAR, CURVE_STEPPED, CURVE_BEZIER
+};
+
+typedef struct {
+	SkeletonBinary super;
+	int ownsLoader;
+} _Internal;
+
+/* Reads the values of a .ccsk file in order. Once the end of the data has been passed, everything read is 0. */
+typedef struct {
+	const unsigned char* cursor;
+	const unsigned char* end;
+	int/*bool*/overflow;
+} _Input;
+
+SkeletonBinary* SkeletonBinary_createWithLoader (AttachmentLoader* attachmentLoader) {
+	SkeletonBinary* self = SUPER(NEW(_Internal));
+	self->scale = 1;
+	self->attachmentLoader = attachmentLoader;
+	return self;
+}
+
+SkeletonBinary* SkeletonBinary_create (Atlas* atlas) {
+	AtlasAttachmentLoader* attachmentLoader = AtlasAttachmentLoader_create(atlas);
+	SkeletonBinary* self = SkeletonBinary_createWithLoader(SUPER(attachmentLoader));
+	SUB_CAST(_Internal, self) ->ownsLoader = 1;
+	return self;
+}
+
+void SkeletonBinary_dispose (SkeletonBinary* self) {
+	if (SUB_CAST(_Internal, self) ->ownsLoader) AttachmentLoader_dispose(self->attachmentLoader);
+	FREE(self->error);
+	FREE(self);
+}
+
+static void _SkeletonBinary_setError (SkeletonBinary* self, const char* value1, const char* value2) {
+	char message[256];
+	int length;
+	FREE(self->error);
+	strcpy(message, value1);
+	length = strlen(value1);
+	if (value2) strncat(message + length, value2, 256 - length);
+	MALLOC_STR(self->error, message);
+}
+
+static unsigned int readInt (_Input* input) {
+	unsigned int value;
+	if (input->end - input->cursor < 4) {
+		input->overflow = 1;
+		input->cursor = input->end;
+		return 0;
+	}
+	value = input->cursor[0] | (input->cursor[1] << 8) | (input->cursor[2] << 16) | ((unsigned int)input->cursor[3] << 24);
+	input->cursor += 4;
+	return value;
+}
+
+static float readFloat (_Input* input) {
+	unsigned int bits = readInt(input);
+	float value;
+	memcpy(&value, &bits, 4);
+	return value;
+}
+
+/* The strings are '\0' terminated in the file: the returned pointer is in the data being read, 0 for a null string. */
+static const char* readString (_Input* input) {
+	const char* value;
+	unsigned int length = readInt(input);
+	if (length == NO_STRING || input->overflow) return 0;
+	if ((unsigned int)(input->end - input->cursor) <= length || input->cursor[length] != '\0') {
+		input->overflow = 1;
+		input->cursor = input->end;
+		return 0;
+	}
+	value = (const char*)input->cursor;
+	input->cursor += length + 1;
+	return value;
+}
+
+/* Returns -1 if the count doesn't fit in the data left, each element taking at least minSize bytes. */
+static int readCount (_Input* input, int minSize) {
+	unsigned int count = readInt(input);
+	if (input->overflow || count > (unsigned int)(input->end - input->cursor) / minSize) return -1;
+	return (int)count;
+}
+
+static void readCurve (_Input* input, CurveTimeline* timeline, int frameIndex) {
+	switch (readInt(input)) {
+	case CURVE_STEPPED:
+		CurveTimeline_setStepped(timeline, frameIndex);
+		break;
+	case CURVE_BEZIER: {
+		float cx1 = readFloat(input);
+		float cy1 = readFloat(input);
+		float cx2 = readFloat(input);
+		float cy2 = readFloat(input);
+		CurveTimeline_setCurve(timeline, frameIndex, cx1, cy1, cx2, cy2);
+		break;
+	}
+	}
+}
+
+static Animation* _SkeletonBinary_readAnimation (SkeletonBinary* self, _Input* input, SkeletonData* skeletonData) {
+	Animation* animation;
+	int i, ii;
+	const char* name = readString(input);
+	int timelineCount = readCount(input, 12);
+	if (!name || timelineCount < 0) return 0;
+
+	animation = Animation_create(name, timelineCount);
+	animation->timelineCount = 0;
+	for (i = 0; i < timelineCount; ++i) {
+		Timeline* timeline;
+		float duration;
+		unsigned int type = readInt(input);
+		unsigned int index = readInt(input);
+		int frameCount = readCount(input, 8);
+		if (frameCount <= 0) {
+			Animation_dispose(animation);
+			return 0;
+		}
+
+		switch (type) {
+		case TIMELINE_ROTATE: {
+			RotateTimeline* rotateTimeline = RotateTimeline_create(frameCount);
+			rotateTimeline->boneIndex = index;
+			for (ii = 0; ii < frameCount; ++ii) {
+				float time = readFloat(input);
+				float angle = readFloat(input);
+				RotateTimeline_setFrame(rotateTimeline, ii, time, angle);
+				readCurve(input, SUPER(rotateTimeline), ii);
+			}
+			timeline = (Timeline*)rotateTimeline;
+			duration = rotateTimeline->frames[frameCount * 2 - 2];
+			break;
+		}
+		case TIMELINE_TRANSLATE:
+		case TIMELINE_SCALE: {
+			int isScale = type == TIMELINE_SCALE;
+			float scale = isScale ? 1 : self->scale;
+			TranslateTimeline* translateTimeline = isScale ? ScaleTimeline_create(frameCount) : TranslateTimeline_create(frameCount);
+			translateTimeline->boneIndex = index;
+			for (ii = 0; ii < frameCount; ++ii) {
+				float time = readFloat(input);
+				float x = readFloat(input) * scale;
+				float y = readFloat(input) * scale;
+				TranslateTimeline_setFrame(translateTimeline, ii, time, x, y);
+				readCurve(input, SUPER(translateTimeline), ii);
+			}
+			timeline = (Timeline*)translateTimeline;
+			duration = translateTimeline->frames[frameCount * 3 - 3];
+			break;
+		}
+		case TIMELINE_COLOR: {
+			ColorTimeline* colorTimeline = ColorTimeline_create(frameCount);
+			colorTimeline->slotIndex = index;
+			for (ii = 0; ii < frameCount; ++ii) {
+				float time = readFloat(input);
+				float r = readFloat(input);
+				float g = readFloat(input);
+				float b = readFloat(input);
+				float a = readFloat(input);
+				ColorTimeline_setFrame(colorTimeline, ii, time, r, g, b, a);
+				readCurve(input, SUPER(colorTimeline), ii);
+			}
+			timeline = (Timeline*)colorTimeline;
+			duration = colorTimeline->frames[frameCount * 5 - 5];
+			break;
+		}
+		case TIMELINE_ATTACHMENT: {
+			AttachmentTimeline* attachmentTimeline = AttachmentTimeline_create(frameCount);
+			attachmentTimeline->slotIndex = index;
+			for (ii = 0; ii < frameCount; ++ii) {
+				float time = readFloat(input);
+				AttachmentTimeline_setFrame(attachmentTimeline, ii, time, readString(input));
+			}
+			timeline = (Timeline*)attachmentTimeline;
+			duration = attachmentTimeline->frames[frameCount - 1];
+			break;
+		}
+		default:
+			Animation_dispose(animation);
+			_SkeletonBinary_setError(self, "Invalid timeline type in animation: ", name);
+			return 0;
+		}
+
+		animation->timelines[animation->timelineCount++] = timeline;
+		if (duration > animation->duration) animation->duration = duration;
+
+		if (input->overflow || index >= (unsigned int)(type <= TIMELINE_SCALE ? skeletonData->boneCount : skeletonData->slotCount)) {
+			Animation_dispose(animation);
+			_SkeletonBinary_setError(self, "Invalid timeline in animation: ", name);
+			return 0;
+		}
+	}
+	return animation;
+}
+
+SkeletonData* SkeletonBinary_readSkeletonDataFile (SkeletonBinary* self, const char* path) {
+	int length;
+	SkeletonData* skeletonData;
+	const char* binary = _Util_readFile(path, &length);
+	if (!binary) {
+		_SkeletonBinary_setError(self, "Unable to read skeleton file: ", path);
+		return 0;
+	}
+	skeletonData = SkeletonBinary_readSkeletonData(self, (const unsigned char*)binary, length);
+	FREE(binary);
+	return skeletonData;
+}
+
+SkeletonData* SkeletonBinary_readSkeletonData (SkeletonBinary* self, const unsigned char* binary, int length) {
+	SkeletonData* skeletonData;
+	_Input input;
+	int i, ii, count;
+
+	FREE(self->error);
+	CONST_CAST(char*, self->error) = 0;
+
+	input.cursor = binary;
+	input.end = binary + length;
+	input.overflow = 0;
+	if (length < 8 || memcmp(binary, MAGIC, 4) != 0) {
+		_SkeletonBinary_setError(self, "Invalid binary skeleton data.", 0);
+		return 0;
+	}
+	input.cursor += 4;
+	if (readInt(&input) != VERSION) {
+		_SkeletonBinary_setError(self, "Unsupported binary skeleton version.", 0);
+		return 0;
+	}
+
+	skeletonData = SkeletonData_create();
+
+	count = readCount(&input, 32);
+	if (count < 0) goto invalid;
+	skeletonData->bones = MALLOC(BoneData*, count);
+	for (i = 0; i < count; ++i) {
+		BoneData* boneData;
+		const char* name = readString(&input);
+		int parentIndex = (int)readInt(&input);
+		if (!name || parentIndex >= i) goto invalid;
+
+		boneData = BoneData_create(name, parentIndex < 0 ? 0 : skeletonData->bones[parentIndex]);
+		boneData->length = readFloat(&input) * self->scale;
+		boneData->x = readFloat(&input) * self->scale;
+		boneData->y = readFloat(&input) * self->scale;
+		boneData->rotation = readFloat(&input);
+		boneData->scaleX = readFloat(&input);
+		boneData->scaleY = readFloat(&input);
+
+		skeletonData->bones[i] = boneData;
+		skeletonData->boneCount++;
+	}
+
+	count = readCount(&input, 28);
+	if (count < 0) goto invalid;
+	skeletonData->slots = MALLOC(SlotData*, count);
+	for (i = 0; i < count; ++i) {
+		SlotData* slotData;
+		const char* name = readString(&input);
+		unsigned int boneIndex = readInt(&input);
+		if (!name || boneIndex >= (unsigned int)skeletonData->boneCount) goto invalid;
+
+		slotData = SlotData_create(name, skeletonData->bones[boneIndex]);
+		slotData->r = readFloat(&input);
+		slotData->g = readFloat(&input);
+		slotData->b = readFloat(&input);
+		slotData->a = readFloat(&input);
+		SlotData_setAttachmentName(slotData, readString(&input));
+
+		skeletonData->slots[i] = slotData;
+		skeletonData->slotCount++;
+	}
+
+	count = readCount(&input, 8);
+	if (count < 0) goto invalid;
+	skeletonData->skins = MALLOC(Skin*, count);
+	for (i = 0; i < count; ++i) {
+		Skin* skin;
+		int attachmentCount;
+		const char* skinName = readString(&input);
+		if (!skinName) goto invalid;
+
+		skin = Skin_create(skinName);
+		skeletonData->skins[i] = skin;
+		skeletonData->skinCount++;
+		if (strcmp(skinName, "default") == 0) skeletonData->defaultSkin = skin;
+
+		attachmentCount = readCount(&input, 44);
+		if (attachmentCount < 0) goto invalid;
+		for (ii = 0; ii < attachmentCount; ++ii) {
+			Attachment* attachment;
+			unsigned int slotIndex = readInt(&input);
+			const char* skinAttachmentName = readString(&input);
+			const char* attachmentName = readString(&input);
+			unsigned int type = readInt(&input);
+			float x = readFloat(&input);
+			float y = readFloat(&input);
+			float scaleX = readFloat(&input);
+			float scaleY = readFloat(&input);
+			float rotation = readFloat(&input);
+			float width = readFloat(&input);
+			float height = readFloat(&input);
+			if (input.overflow || slotIndex >= (unsigned int)skeletonData->slotCount || !skinAttachmentName || !attachmentName
+					|| (type != ATTACHMENT_REGION && type != ATTACHMENT_REGION_SEQUENCE)) goto invalid;
+
+			attachment = AttachmentLoader_newAttachment(self->attachmentLoader, skin, (AttachmentType)type, attachmentName);
+			if (!attachment) {
+				if (self->attachmentLoader->error1) {
+					SkeletonData_dispose(skeletonData);
+					_SkeletonBinary_setError(self, self->attachmentLoader->error1, self->attachmentLoader->error2);
+					return 0;
+				}
+				continue;
+			}
+
+			if (attachment->type == ATTACHMENT_REGION || attachment->type == ATTACHMENT_REGION_SEQUENCE) {
+				RegionAttachment* regionAttachment = (RegionAttachment*)attachment;
+				regionAttachment->x = x * self->scale;
+				regionAttachment->y = y * self->scale;
+				regionAttachment->scaleX = scaleX;
+				regionAttachment->scaleY = scaleY;
+				regionAttachment->rotation = rotation;
+				regionAttachment->width = width * self->scale;
+				regionAttachment->height = height * self->scale;
+				RegionAttachment_updateOffset(regionAttachment);
+			}
+
+			Skin_addAttachment(skin, slotIndex, skinAttachmentName, attachment);
+		}
+	}
+
+	count = readCount(&input, 8);
+	if (count < 0) goto invalid;
+	skeletonData->animations = MALLOC(Animation*, count);
+	for (i = 0; i < count; ++i) {
+		Animation* animation = _SkeletonBinary_readAnimation(self, &input, skeletonData);
+		if (!animation) {
+			SkeletonData_dispose(skeletonData);
+			if (!self->error) _SkeletonBinary_setError(self, "Invalid binary skeleton data.", 0);
+			return 0;
+		}
+		skeletonData->animations[i] = animation;
+		skeletonData->animationCount++;
+	}
+
+	if (!input.overflow) return skeletonData;
+
+invalid:
+	SkeletonData_dispose(skeletonData);
+	_SkeletonBinary_setError(self, "Invalid binary skeleton data.", 0);
+	return 0;
+}
+
+}} // namespace cocos2d { namespace extension {
@@ -0,0 +1,55 @@
+/*******************************************************************************
+ * Copyright (c) 2013, Esoteric Software
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef SPINE_SKELETONBINARY_H_
+#define SPINE_SKELETONBINARY_H_
+
+#include <spine/Attachment.h>
+#include <spine/AttachmentLoader.h>
+#include <spine/SkeletonData.h>
+#include <spine/Atlas.h>
+#include <spine/Animation.h>
+
+namespace cocos2d { namespace extension {
+
+/* Reads the binary skeleton files (.ccsk) written by tools/spine_converter/json2ccsk.py from the JSON skeleton files.
+ * They hold the same data as the JSON files, but in the order it is created, so nothing has to be parsed nor looked up
+ * by name when loading them. */
+typedef struct {
+	float scale;
+	AttachmentLoader* attachmentLoader;
+	const char* const error;
+} SkeletonBinary;
+
+SkeletonBinary* SkeletonBinary_createWithLoader (AttachmentLoader* attachmentLoader);
+SkeletonBinary* SkeletonBinary_create (Atlas* atlas);
+void SkeletonBinary_dispose (SkeletonBinary* self);
+
+SkeletonData* SkeletonBinary_readSkeletonData (SkeletonBinary* self, const unsigned char* binary, int length);
+SkeletonData* SkeletonBinary_readSkeletonDataFile (SkeletonBinary* self, const char* path);
+
+}} // namespace cocos2d { namespace extension {
+
+#endif /* SPINE_SKELETONBINARY_H_ */
@@ -5,6 +5,7 @@
 #include "SimpleAudioEngine.h"
 #include "cocos-ext.h"
 #include "CCArmature/utils/CCArmatureDataManager.h"
+#include "PerformanceTest/PerformanceBenchmark.h"
 
 USING_NS_CC;
 using namespace CocosDenshion;
@@ -50,6 +51,15 @@ bool AppDelegate::applicationDidFinishLaunching()
 
     EGLView::getInstance()->setDesignResolutionSize(designSize.width, designSize.height, ResolutionPolicy::NO_BORDER);
 
+    // --record and --replay apply to the interactive tests
+    PerformanceBenchmark::getInstance()->startInput();
+
+    if (PerformanceBenchmark::getInstance()->isRequested())
+    {
+        PerformanceBenchmark::getInstance()->start();
+        return true;
+    }
+
     auto scene = Scene::create();
     auto layer = new TestController();
     layer->autorelease();
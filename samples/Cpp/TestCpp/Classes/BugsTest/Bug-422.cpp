@@ -47,12 +47,8 @@ void Bug422Layer::reset()
 
 void Bug422Layer::check(Node* t)
 {
-    Array *array = t->getChildren();
-    Object* pChild = NULL;
-    CCARRAY_FOREACH(array, pChild)
+    for (auto node : t->getChildren())
     {
-        CC_BREAK_IF(! pChild);
-        Node* node = static_cast<Node*>(pChild);
         log("%p, rc: %d", node, node->retainCount());
         check(node);
     }
@@ -474,6 +474,7 @@ Atlas4::Atlas4()
 
     // Upper Label
     LabelBMFont *label = LabelBMFont::create("Bitmap Font Atlas", "fonts/bitmapFontTest.fnt");
+    label->setLetterSpritesEnabled(true);
     addChild(label);
     
     Size s = Director::getInstance()->getWinSize();
@@ -511,6 +512,7 @@ Atlas4::Atlas4()
     
     // Bottom Label
     LabelBMFont *label2 = LabelBMFont::create("00.0", "fonts/bitmapFontTest.fnt");
+    label2->setLetterSpritesEnabled(true);
     addChild(label2, 0, kTagBitmapAtlas2);
     label2->setPosition( Point(s.width/2.0f, 80) );
     
@@ -125,11 +125,8 @@ static void setEnableRecursiveCascading(Node* node, bool enable)
         rgba->setCascadeOpacityEnabled(enable);
     }
     
-    Object* obj;
-    Array* children = node->getChildren();
-    CCARRAY_FOREACH(children, obj)
+    for (auto child : node->getChildren())
     {
-        Node* child = static_cast<Node*>(obj);
         setEnableRecursiveCascading(child, enable);
     }
 }
@@ -85,16 +85,8 @@ MenuLayerMainMenu::MenuLayerMainMenu()
     Size s = Director::getInstance()->getWinSize();
     
     int i=0;
-    Node* child;
-    Array * pArray = menu->getChildren();
-    Object* pObject = NULL;
-    CCARRAY_FOREACH(pArray, pObject)
+    for (auto child : menu->getChildren())
     {
-        if(pObject == NULL)
-            break;
-
-        child = static_cast<Node*>(pObject);
-
         Point dstPoint = child->getPosition();
         int offset = (int) (s.width/2 + 50);
         if( i % 2 == 0)
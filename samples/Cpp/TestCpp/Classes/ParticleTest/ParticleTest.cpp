@@ -1531,10 +1531,9 @@ void MultipleParticleSystems::update(float dt)
 
     unsigned int count = 0; 
     
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(getChildren(), pObj)
+    for (auto child : getChildren())
     {
-        ParticleSystem* item = dynamic_cast<ParticleSystem*>(pObj);
+        ParticleSystem* item = dynamic_cast<ParticleSystem*>(child);
         if (item != NULL)
         {
             count += item->getParticleCount();    
@@ -1583,10 +1582,9 @@ void MultipleParticleSystemsBatched::update(float dt)
     unsigned count = 0; 
     
     Node* batchNode = getChildByTag(2);
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(batchNode->getChildren(), pObj)
+    for (auto child : batchNode->getChildren())
     {
-        ParticleSystem* item = dynamic_cast<ParticleSystem*>(pObj);
+        ParticleSystem* item = dynamic_cast<ParticleSystem*>(child);
         if (item != NULL)
         {
             count += item->getParticleCount();    
@@ -1644,12 +1642,12 @@ void AddAndDeleteParticleSystems::onEnter()
 
 void AddAndDeleteParticleSystems::removeSystem(float dt)
 {
-    int nChildrenCount = _batchNode->getChildren()->count();
+    int nChildrenCount = _batchNode->getChildrenCount();
     if (nChildrenCount > 0) 
     {
         CCLOG("remove random system");
         unsigned int uRand = rand() % (nChildrenCount - 1);
-        _batchNode->removeChild((Node*)_batchNode->getChildren()->objectAtIndex(uRand), true);
+        _batchNode->removeChild(_batchNode->getChildren().at(uRand), true);
 
         ParticleSystemQuad *particleSystem = ParticleSystemQuad::create("Particles/Spiral.plist");
         //add new
@@ -1672,10 +1670,9 @@ void AddAndDeleteParticleSystems::update(float dt)
     unsigned int count = 0; 
     
     Node* batchNode = getChildByTag(2);
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(batchNode->getChildren(), pObj)
+    for (auto child : batchNode->getChildren())
     {
-        ParticleSystem* item = dynamic_cast<ParticleSystem*>(pObj);
+        ParticleSystem* item = dynamic_cast<ParticleSystem*>(child);
         if (item != NULL)
         {
             count += item->getParticleCount();    
@@ -1796,7 +1793,7 @@ void ReorderParticleSystems::onEnter()
 
 void ReorderParticleSystems::reorderSystem(float time)
 {
-    ParticleSystem* system = (ParticleSystem*)_batchNode->getChildren()->objectAtIndex(1);
+    ParticleSystem* system = static_cast<ParticleSystem*>(_batchNode->getChildren().at(1));
     _batchNode->reorderChild(system, system->getZOrder() - 1);     
 }
 
@@ -1808,10 +1805,9 @@ void ReorderParticleSystems::update(float dt)
     unsigned int count = 0; 
     
     Node* batchNode = getChildByTag(2);
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(batchNode->getChildren(), pObj)
+    for (auto child : batchNode->getChildren())
     {
-        ParticleSystem* item = dynamic_cast<ParticleSystem*>(pObj);
+        ParticleSystem* item = dynamic_cast<ParticleSystem*>(child);
         if (item != NULL)
         {
             count += item->getParticleCount();    
@@ -0,0 +1,431 @@
+#include "PerformanceBenchmark.h"
+#include "PerformanceMicrobenchmark.h"
+#include "PerformanceNodeChildrenTest.h"
+#include "PerformanceParticleTest.h"
+#include "PerformanceSpriteTest.h"
+#include "PerformanceTextureTest.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static PerformanceBenchmark* s_sharedBenchmark = NULL;
+
+static double getTime()
+{
+    return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <class T>
+static Scene* createSpriteScenario(int subTest, int nodes)
+{
+    T* scene = new T;
+    scene->initWithSubTest(subTest, nodes);
+    scene->autorelease();
+    return scene;
+}
+
+template <class T>
+static Scene* createParticleScenario(int subTest, int particles)
+{
+    T* scene = new T;
+    scene->initWithSubTest(subTest, particles);
+    scene->autorelease();
+    return scene;
+}
+
+template <class T>
+static Scene* createNodeChildrenScenario(int nodes)
+{
+    T* scene = new T;
+    scene->initWithQuantityOfNodes(nodes);
+    scene->autorelease();
+    return scene;
+}
+
+static std::string escapeJSON(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// value at a fraction of the sorted values
+static float percentile(const std::vector<float>& sorted, float fraction)
+{
+    return sorted[(size_t)(fraction * (sorted.size() - 1) + 0.5f)];
+}
+
+PerformanceBenchmark* PerformanceBenchmark::getInstance()
+{
+    if (!s_sharedBenchmark)
+    {
+        s_sharedBenchmark = new PerformanceBenchmark();
+    }
+    return s_sharedBenchmark;
+}
+
+PerformanceBenchmark::PerformanceBenchmark()
+: _requested(false)
+, _microbenchmarks(false)
+, _listOnly(false)
+, _frames(600)
+, _warmupFrames(60)
+, _deltaTime(1.0f / 60.0f)
+, _current(0)
+, _frame(0)
+, _recording(false)
+, _lastFrameTime(0.0)
+, _startDraws(0)
+, _startVertices(0)
+{
+}
+
+bool PerformanceBenchmark::parseArguments(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool hasValue = true;
+
+        if (strcmp(arg, "--benchmark") == 0)
+        {
+            _requested = true;
+            hasValue = false;
+        }
+        else if (strcmp(arg, "--microbenchmark") == 0)
+        {
+            _microbenchmarks = true;
+            hasValue = false;
+        }
+        else if (strcmp(arg, "--list") == 0)
+        {
+            _listOnly = true;
+            hasValue = false;
+        }
+        else if (strcmp(arg, "--frames") == 0 && value && atoi(value) > 0)
+        {
+            _frames = atoi(value);
+        }
+        else if (strcmp(arg, "--warmup") == 0 && value && atoi(value) >= 0)
+        {
+            _warmupFrames = atoi(value);
+        }
+        else if (strcmp(arg, "--dt") == 0 && value && atof(value) > 0)
+        {
+            _deltaTime = (float)atof(value);
+        }
+        else if (strcmp(arg, "--filter") == 0 && value)
+        {
+            _filter = value;
+        }
+        else if (strcmp(arg, "--output") == 0 && value)
+        {
+            _output = value;
+        }
+        else if (strcmp(arg, "--record") == 0 && value)
+        {
+            _recordPath = value;
+        }
+        else if (strcmp(arg, "--replay") == 0 && value)
+        {
+            _replayPath = value;
+        }
+        else
+        {
+            fprintf(stderr, "invalid argument: %s\n"
+                    "usage: %s --benchmark [--frames N] [--warmup N] [--dt SECONDS] [--filter TEXT] [--output FILE] [--list]\n"
+                    "       %s --microbenchmark [--filter TEXT] [--output FILE] [--list]\n"
+                    "       %s --record FILE\n"
+                    "       %s --replay FILE [--output FILE]\n",
+                    arg, argv[0], argv[0], argv[0], argv[0]);
+            return false;
+        }
+
+        if (hasValue)
+        {
+            ++i;
+        }
+    }
+
+    _requested = _requested || _microbenchmarks || _listOnly;
+    return true;
+}
+
+void PerformanceBenchmark::addScenarios()
+{
+    static const char* spriteTests[] = { "SpritePerformTest1", "SpritePerformTest2", "SpritePerformTest3", "SpritePerformTest4",
+                                         "SpritePerformTest5", "SpritePerformTest6", "SpritePerformTest7" };
+    static const std::function<Scene*(int, int)> createSpriteTests[] = {
+        createSpriteScenario<SpritePerformTest1>, createSpriteScenario<SpritePerformTest2>, createSpriteScenario<SpritePerformTest3>,
+        createSpriteScenario<SpritePerformTest4>, createSpriteScenario<SpritePerformTest5>, createSpriteScenario<SpritePerformTest6>,
+        createSpriteScenario<SpritePerformTest7>,
+    };
+    for (int i = 0; i < 7; ++i)
+    {
+        // 1: sprites drawn by the renderer, 2: sprites of a batch node
+        auto create = createSpriteTests[i];
+        _scenarios.push_back({ std::string(spriteTests[i]) + "/sprites-1000", [=]() { return create(1, 1000); }, -1 });
+        _scenarios.push_back({ std::string(spriteTests[i]) + "/batch-1000", [=]() { return create(2, 1000); }, -1 });
+    }
+
+    _scenarios.push_back({ "ParticlePerformTest1/2000", []() { return createParticleScenario<ParticlePerformTest1>(1, 2000); }, -1 });
+    _scenarios.push_back({ "ParticlePerformTest2/2000", []() { return createParticleScenario<ParticlePerformTest2>(1, 2000); }, -1 });
+    _scenarios.push_back({ "ParticlePerformTest3/2000", []() { return createParticleScenario<ParticlePerformTest3>(1, 2000); }, -1 });
+    _scenarios.push_back({ "ParticlePerformTest4/2000", []() { return createParticleScenario<ParticlePerformTest4>(1, 2000); }, -1 });
+
+    _scenarios.push_back({ "IterateSpriteSheetCArray/1000", []() { return createNodeChildrenScenario<IterateSpriteSheetCArray>(1000); }, -1 });
+    _scenarios.push_back({ "AddSpriteSheet/1000", []() { return createNodeChildrenScenario<AddSpriteSheet>(1000); }, -1 });
+    _scenarios.push_back({ "RemoveSpriteSheet/1000", []() { return createNodeChildrenScenario<RemoveSpriteSheet>(1000); }, -1 });
+    _scenarios.push_back({ "ReorderSpriteSheet/1000", []() { return createNodeChildrenScenario<ReorderSpriteSheet>(1000); }, -1 });
+
+    // the textures are loaded when the scene is entered: the frames of the loading are recorded
+    _scenarios.push_back({ "TextureTest", []() { return TextureTest::scene(); }, 0 });
+
+    if (!_filter.empty())
+    {
+        auto end = std::remove_if(_scenarios.begin(), _scenarios.end(), [this](const Scenario& scenario) {
+            return scenario.name.find(_filter) == std::string::npos;
+        });
+        _scenarios.erase(end, _scenarios.end());
+    }
+}
+
+void PerformanceBenchmark::start()
+{
+    if (_microbenchmarks)
+    {
+        runMicrobenchmarks();
+    }
+
+    addScenarios();
+
+    if (_listOnly || _scenarios.empty())
+    {
+        for (const auto& scenario : _scenarios)
+        {
+            printf("%s\n", scenario.name.c_str());
+        }
+        if (_scenarios.empty())
+        {
+            fprintf(stderr, "no scenario matches the filter %s\n", _filter.c_str());
+        }
+        exit(_scenarios.empty() ? 1 : 0);
+    }
+
+    Director* director = Director::getInstance();
+    director->setDisplayStats(false);
+    director->setFixedDeltaTime(_deltaTime);
+    // the frames are drawn as fast as possible
+    director->setAnimationInterval(1.0 / 1000);
+    director->getScheduler()->scheduleUpdateForTarget(this, Scheduler::PRIORITY_SYSTEM, false);
+    FrameProfiler::getInstance()->setEnabled(true);
+
+    director->runWithScene(Scene::create());
+    _current = 0;
+    startScenario();
+}
+
+void PerformanceBenchmark::startInput()
+{
+    if (!_recordPath.empty())
+    {
+        if (!InputRecorder::getInstance()->startRecording(_recordPath))
+        {
+            fprintf(stderr, "can't write %s\n", _recordPath.c_str());
+            exit(1);
+        }
+        return;
+    }
+
+    if (_replayPath.empty())
+    {
+        return;
+    }
+
+    Director* director = Director::getInstance();
+    director->setDisplayStats(false);
+    // the frames are drawn as fast as possible, the recorded delta times are used
+    director->setAnimationInterval(1.0 / 1000);
+    FrameProfiler::getInstance()->setEnabled(true);
+
+    std::string replayPath = _replayPath;
+    std::string output = _output.empty() ? FileUtils::getInstance()->getWritablePath() + "replay.json" : _output;
+    bool started = InputRecorder::getInstance()->startReplay(replayPath, [replayPath, output]() {
+        if (InputRecorder::getInstance()->writeReport(output, replayPath))
+        {
+            log("replay: report written to %s", output.c_str());
+        }
+        Director::getInstance()->end();
+    });
+    if (!started)
+    {
+        fprintf(stderr, "can't replay %s\n", replayPath.c_str());
+        exit(1);
+    }
+}
+
+void PerformanceBenchmark::startScenario()
+{
+    const Scenario& scenario = _scenarios[_current];
+    log("benchmark: %s", scenario.name.c_str());
+
+    _results.push_back(Result());
+    _results.back().name = scenario.name;
+    _results.back().frameTimes.reserve(_frames);
+
+    Director::getInstance()->replaceScene(scenario.create());
+    _frame = 0;
+    _recording = false;
+}
+
+void PerformanceBenchmark::update(float dt)
+{
+    // called at the start of each frame: the time since the last call is the time of the last frame
+    double now = getTime();
+    Result& result = _results.back();
+    if (_recording)
+    {
+        result.frameTimes.push_back((float)((now - _lastFrameTime) * 1000.0));
+    }
+    _lastFrameTime = now;
+
+    int warmupFrames = _scenarios[_current].warmupFrames;
+    if (!_recording && _frame >= (warmupFrames >= 0 ? (unsigned int)warmupFrames : _warmupFrames))
+    {
+        // the scene is running from the frame after it was replaced
+        FrameProfiler::getInstance()->reset();
+        _startDraws = g_uNumberOfDraws;
+        _startVertices = g_uNumberOfVertices;
+        _recording = true;
+    }
+    ++_frame;
+
+    if (_recording && result.frameTimes.size() >= _frames)
+    {
+        finishScenario();
+        if (++_current < _scenarios.size())
+        {
+            startScenario();
+        }
+        else
+        {
+            writeResults();
+            Director::getInstance()->getScheduler()->unscheduleUpdateForTarget(this);
+            Director::getInstance()->end();
+        }
+    }
+}
+
+void PerformanceBenchmark::finishScenario()
+{
+    Result& result = _results.back();
+    unsigned int frames = (unsigned int)result.frameTimes.size();
+    result.draws = (g_uNumberOfDraws - _startDraws) / frames;
+    result.vertices = (g_uNumberOfVertices - _startVertices) / frames;
+    // the zones of the last frame are collected when it ends, after this update
+    result.zones = FrameProfiler::getInstance()->getZoneStats();
+}
+
+void PerformanceBenchmark::writeResults()
+{
+    FILE* file = _output.empty() ? stdout : fopen(_output.c_str(), "w");
+    if (!file)
+    {
+        fprintf(stderr, "can't write %s\n", _output.c_str());
+        return;
+    }
+
+    fprintf(file, "{\n  \"engine\": \"%s\",\n  \"frames\": %u,\n  \"warmupFrames\": %u,\n  \"deltaTime\": %g,\n  \"scenarios\": [\n",
+            escapeJSON(cocos2dVersion()).c_str(), _frames, _warmupFrames, _deltaTime);
+
+    for (size_t i = 0; i < _results.size(); ++i)
+    {
+        const Result& result = _results[i];
+        std::vector<float> sorted(result.frameTimes);
+        std::sort(sorted.begin(), sorted.end());
+
+        double sum = 0.0;
+        for (float time : sorted)
+        {
+            sum += time;
+        }
+        double mean = sum / sorted.size();
+        double variance = 0.0;
+        for (float time : sorted)
+        {
+            variance += (time - mean) * (time - mean);
+        }
+        double deviation = sqrt(variance / sorted.size());
+
+        fprintf(file, "    {\n      \"name\": \"%s\",\n", escapeJSON(result.name).c_str());
+        fprintf(file, "      \"frameTime\": { \"mean\": %.3f, \"stddev\": %.3f, \"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n",
+                mean, deviation, sorted.front(), percentile(sorted, 0.5f), percentile(sorted, 0.9f), percentile(sorted, 0.95f),
+                percentile(sorted, 0.99f), sorted.back());
+        fprintf(file, "      \"drawsPerFrame\": %u,\n      \"verticesPerFrame\": %u,\n", result.draws, result.vertices);
+
+        fprintf(file, "      \"zones\": [");
+        for (size_t j = 0; j < result.zones.size(); ++j)
+        {
+            const FrameProfiler::ZoneStats& zone = result.zones[j];
+            fprintf(file, "%s\n        { \"name\": \"%s\", \"calls\": %u, \"totalTime\": %.3f, \"selfTime\": %.3f, \"maxTime\": %.3f }",
+                    j > 0 ? "," : "", escapeJSON(zone.name).c_str(), zone.calls, zone.totalTime, zone.selfTime, zone.maxTime);
+        }
+        fprintf(file, "%s],\n", result.zones.empty() ? "" : "\n      ");
+
+        fprintf(file, "      \"frameTimes\": [");
+        for (size_t j = 0; j < result.frameTimes.size(); ++j)
+        {
+            fprintf(file, "%s%.3f", j > 0 ? ", " : "", result.frameTimes[j]);
+        }
+        fprintf(file, "]\n    }%s\n", i + 1 < _results.size() ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+    if (file != stdout)
+    {
+        fclose(file);
+    }
+}
+
+void PerformanceBenchmark::runMicrobenchmarks()
+{
+    if (_listOnly)
+    {
+        for (const auto& name : microbenchmark::listBenchmarks(_filter))
+        {
+            printf("%s\n", name.c_str());
+        }
+        exit(0);
+    }
+
+    std::vector<microbenchmark::Result> results = microbenchmark::runBenchmarks(_filter);
+    if (results.empty())
+    {
+        fprintf(stderr, "no microbenchmark matches the filter %s\n", _filter.c_str());
+        exit(1);
+    }
+
+    FILE* file = _output.empty() ? stdout : fopen(_output.c_str(), "w");
+    if (!file)
+    {
+        fprintf(stderr, "can't write %s\n", _output.c_str());
+        exit(1);
+    }
+    microbenchmark::writeResults(results, file);
+    if (file != stdout)
+    {
+        fclose(file);
+    }
+    exit(0);
+}
@@ -0,0 +1,92 @@
+#ifndef __PERFORMANCE_BENCHMARK_H__
+#define __PERFORMANCE_BENCHMARK_H__
+
+#include "cocos2d.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+/** Runs the scenes of the performance tests one after the other without interaction, for a number of frames
+ updated with a fixed delta time, and writes the frame times and the zones of the FrameProfiler as JSON.
+
+ TestCpp --benchmark [--frames N] [--warmup N] [--dt SECONDS] [--filter TEXT] [--output FILE] [--list]
+
+ The frame time is the wall-clock time between the starts of two frames: run it with the vsync disabled
+ (vblank_mode=0 with Mesa, __GL_SYNC_TO_VBLANK=0 with NVIDIA) to measure the engine rather than the display.
+ The touches tests need input and aren't run.
+
+ TestCpp --microbenchmark [--filter TEXT] [--output FILE] [--list] runs the microbenchmarks instead.
+
+ TestCpp --record FILE records the input of an interactive session with the InputRecorder, from the launch.
+ TestCpp --replay FILE [--output FILE] replays it as fast as possible, then writes the frame times and the zones
+ of the FrameProfiler as JSON and exits: the touches tests, or any sequence of tests, can be benchmarked that way.
+ */
+class PerformanceBenchmark : public Object
+{
+public:
+    static PerformanceBenchmark* getInstance();
+
+    /** Reads the options of the command line. Returns false when they are invalid, after printing the usage. */
+    bool parseArguments(int argc, char** argv);
+
+    /** Whether --benchmark or --microbenchmark was given */
+    bool isRequested() const { return _requested; }
+
+    /** Runs the scenarios, called once the Director is set up. The application exits when they are done. */
+    void start();
+
+    /** Starts the recording or the replay of --record or --replay, called before the first scene runs */
+    void startInput();
+
+    virtual void update(float dt) override;
+
+protected:
+    struct Scenario
+    {
+        std::string name;
+        std::function<Scene*()> create;
+        /** warm-up frames of the scenario, -1 for the ones of the options */
+        int warmupFrames;
+    };
+
+    struct Result
+    {
+        std::string name;
+        std::vector<float> frameTimes;      // milliseconds
+        unsigned int draws;
+        unsigned int vertices;
+        std::vector<FrameProfiler::ZoneStats> zones;
+    };
+
+    PerformanceBenchmark();
+
+    void addScenarios();
+    void startScenario();
+    void finishScenario();
+    void writeResults();
+    void runMicrobenchmarks();
+
+    bool _requested;
+    bool _microbenchmarks;
+    bool _listOnly;
+    unsigned int _frames;
+    unsigned int _warmupFrames;
+    float _deltaTime;
+    std::string _filter;
+    std::string _output;
+    std::string _recordPath;
+    std::string _replayPath;
+
+    std::vector<Scenario> _scenarios;
+    std::vector<Result> _results;
+    unsigned int _current;
+    unsigned int _frame;
+    bool _recording;
+    double _lastFrameTime;
+    unsigned int _startDraws;
+    unsigned int _startVertices;
+};
+
+#endif // __PERFORMANCE_BENCHMARK_H__
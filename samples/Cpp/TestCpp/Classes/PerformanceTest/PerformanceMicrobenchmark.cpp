@@ -0,0 +1,700 @@
+#include "PerformanceMicrobenchmark.h"
+#include "support/data_support/ccCArray.h"
+#include "support/ccUTF8.h"
+#include "support/zip_support/ZipUtils.h"
+#include "kazmath/mat4.h"
+#include <zlib.h>
+#include <algorithm>
+#include <chrono>
+
+namespace microbenchmark {
+
+static double getTime()
+{
+    return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::vector<Benchmark*>& getBenchmarks()
+{
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+static std::string getBenchmarkName(const Benchmark* benchmark, int arg)
+{
+    char name[256];
+    snprintf(name, sizeof(name), "%s/%d", benchmark->getName(), arg);
+    return name;
+}
+
+State::State(long long iterations, int arg)
+: _iterations(iterations)
+, _left(iterations)
+, _arg(arg)
+, _started(false)
+, _start(0.0)
+, _elapsed(0.0)
+, _items(0)
+, _bytes(0)
+{
+}
+
+bool State::keepRunning()
+{
+    if (!_started)
+    {
+        _started = true;
+        _start = getTime();
+    }
+
+    if (_left > 0)
+    {
+        --_left;
+        return true;
+    }
+
+    _elapsed += getTime() - _start;
+    return false;
+}
+
+void State::pauseTiming()
+{
+    _elapsed += getTime() - _start;
+}
+
+void State::resumeTiming()
+{
+    _start = getTime();
+}
+
+Benchmark::Benchmark(const char* name, Function function)
+: _name(name)
+, _function(function)
+{
+}
+
+Benchmark* Benchmark::arg(int value)
+{
+    _args.push_back(value);
+    return this;
+}
+
+Benchmark* registerBenchmark(const char* name, Function function)
+{
+    Benchmark* benchmark = new Benchmark(name, function);
+    getBenchmarks().push_back(benchmark);
+    return benchmark;
+}
+
+std::vector<std::string> listBenchmarks(const std::string& filter)
+{
+    std::vector<std::string> names;
+    for (const Benchmark* benchmark : getBenchmarks())
+    {
+        for (int arg : benchmark->getArgs())
+        {
+            std::string name = getBenchmarkName(benchmark, arg);
+            if (name.find(filter) != std::string::npos)
+            {
+                names.push_back(name);
+            }
+        }
+    }
+    return names;
+}
+
+std::vector<Result> runBenchmarks(const std::string& filter, double minTime, int repetitions)
+{
+    std::vector<Result> results;
+    for (const Benchmark* benchmark : getBenchmarks())
+    {
+        for (int arg : benchmark->getArgs())
+        {
+            std::string name = getBenchmarkName(benchmark, arg);
+            if (name.find(filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            // the iterations are raised until a run lasts the minimum time
+            long long iterations = 1;
+            for (;;)
+            {
+                State state(iterations, arg);
+                benchmark->getFunction()(state);
+                double elapsed = state.getElapsedTime();
+                if (elapsed >= minTime || iterations >= 1000000000LL)
+                {
+                    break;
+                }
+                double multiplier = elapsed > 0 ? minTime * 1.4 / elapsed : 10.0;
+                iterations = (long long)(iterations * std::min(std::max(multiplier, 2.0), 10.0));
+            }
+
+            std::vector<State> runs;
+            for (int i = 0; i < repetitions; ++i)
+            {
+                runs.push_back(State(iterations, arg));
+                benchmark->getFunction()(runs.back());
+            }
+            std::sort(runs.begin(), runs.end(), [](const State& a, const State& b) {
+                return a.getElapsedTime() < b.getElapsedTime();
+            });
+            const State& median = runs[runs.size() / 2];
+            double elapsed = median.getElapsedTime();
+
+            Result result;
+            result.name = name;
+            result.iterations = iterations;
+            result.nanosecondsPerIteration = elapsed * 1e9 / iterations;
+            result.itemsPerSecond = elapsed > 0 ? median.getItemsProcessed() / elapsed : 0.0;
+            result.bytesPerSecond = elapsed > 0 ? median.getBytesProcessed() / elapsed : 0.0;
+            results.push_back(result);
+
+            log("%-40s %14.1f ns %12lld iterations %12.3g items/s %12.3g bytes/s", name.c_str(),
+                result.nanosecondsPerIteration, iterations, result.itemsPerSecond, result.bytesPerSecond);
+        }
+    }
+    return results;
+}
+
+void writeResults(const std::vector<Result>& results, FILE* file)
+{
+    fprintf(file, "{\n  \"engine\": \"%s\",\n  \"benchmarks\": [\n", cocos2dVersion());
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        fprintf(file, "    { \"name\": \"%s\", \"iterations\": %lld, \"nsPerIteration\": %.3f, \"itemsPerSecond\": %.1f, \"bytesPerSecond\": %.1f }%s\n",
+                result.name.c_str(), result.iterations, result.nanosecondsPerIteration, result.itemsPerSecond, result.bytesPerSecond,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+static const void* volatile s_sink = NULL;
+
+void doNotOptimize(const void* value)
+{
+    s_sink = value;
+}
+
+} // namespace microbenchmark
+
+using microbenchmark::State;
+using microbenchmark::doNotOptimize;
+
+// an object with a scheduled selector, for the timers of the Scheduler
+class BenchmarkTarget : public Object
+{
+public:
+    BenchmarkTarget() : _ticks(0) {}
+    void tick(float dt) { ++_ticks; }
+
+    unsigned int _ticks;
+};
+
+static std::vector<Object*> createObjects(int count)
+{
+    std::vector<Object*> objects;
+    for (int i = 0; i < count; ++i)
+    {
+        objects.push_back(new Object());
+    }
+    return objects;
+}
+
+static void releaseObjects(std::vector<Object*>& objects)
+{
+    for (Object* object : objects)
+    {
+        object->release();
+    }
+    objects.clear();
+}
+
+////////////////////////////////////////////////////////
+//
+// ccCArray, ccArray
+//
+////////////////////////////////////////////////////////
+
+static void BM_CArrayAppendRemove(State& state)
+{
+    int count = state.getArg();
+    ccCArray* array = ccCArrayNew(count);
+    while (state.keepRunning())
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            ccCArrayAppendValue(array, (void*)(intptr_t)(i + 1));
+        }
+        while (array->num > 0)
+        {
+            ccCArrayFastRemoveValueAtIndex(array, 0);
+        }
+    }
+    ccCArrayFree(array);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_CArrayAppendRemove)->arg(64)->arg(1024)->arg(16384);
+
+static void BM_CArrayIndexOfValue(State& state)
+{
+    int count = state.getArg();
+    ccCArray* array = ccCArrayNew(count);
+    for (int i = 0; i < count; ++i)
+    {
+        ccCArrayAppendValue(array, (void*)(intptr_t)(i + 1));
+    }
+    unsigned int index = 0;
+    while (state.keepRunning())
+    {
+        // the last value, the whole array is searched
+        index += ccCArrayGetIndexOfValue(array, (void*)(intptr_t)count);
+    }
+    doNotOptimize(&index);
+    ccCArrayFree(array);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_CArrayIndexOfValue)->arg(64)->arg(1024);
+
+static void BM_ccArrayAppendRemove(State& state)
+{
+    int count = state.getArg();
+    std::vector<Object*> objects = createObjects(count);
+    ccArray* array = ccArrayNew(count);
+    while (state.keepRunning())
+    {
+        for (Object* object : objects)
+        {
+            ccArrayAppendObject(array, object);
+        }
+        ccArrayRemoveAllObjects(array);
+    }
+    ccArrayFree(array);
+    releaseObjects(objects);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_ccArrayAppendRemove)->arg(64)->arg(1024)->arg(16384);
+
+////////////////////////////////////////////////////////
+//
+// Array, Dictionary
+//
+////////////////////////////////////////////////////////
+
+static void BM_ArrayAddRemove(State& state)
+{
+    int count = state.getArg();
+    std::vector<Object*> objects = createObjects(count);
+    Array* array = Array::createWithCapacity(count);
+    array->retain();
+    while (state.keepRunning())
+    {
+        for (Object* object : objects)
+        {
+            array->addObject(object);
+        }
+        array->removeAllObjects();
+    }
+    array->release();
+    releaseObjects(objects);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_ArrayAddRemove)->arg(64)->arg(1024)->arg(16384);
+
+static void BM_ArrayIterate(State& state)
+{
+    int count = state.getArg();
+    std::vector<Object*> objects = createObjects(count);
+    Array* array = Array::createWithCapacity(count);
+    array->retain();
+    for (Object* object : objects)
+    {
+        array->addObject(object);
+    }
+
+    intptr_t sum = 0;
+    while (state.keepRunning())
+    {
+        Object* object = NULL;
+        CCARRAY_FOREACH(array, object)
+        {
+            sum += (intptr_t)object;
+        }
+    }
+    doNotOptimize(&sum);
+    array->release();
+    releaseObjects(objects);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_ArrayIterate)->arg(64)->arg(1024)->arg(16384);
+
+static void BM_ArrayContainsObject(State& state)
+{
+    int count = state.getArg();
+    std::vector<Object*> objects = createObjects(count);
+    Array* array = Array::createWithCapacity(count);
+    array->retain();
+    for (Object* object : objects)
+    {
+        array->addObject(object);
+    }
+
+    unsigned int found = 0;
+    while (state.keepRunning())
+    {
+        found += array->containsObject(objects.back());
+    }
+    doNotOptimize(&found);
+    array->release();
+    releaseObjects(objects);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_ArrayContainsObject)->arg(64)->arg(1024);
+
+static std::vector<std::string> createKeys(int count)
+{
+    std::vector<std::string> keys;
+    char key[32];
+    for (int i = 0; i < count; ++i)
+    {
+        snprintf(key, sizeof(key), "sprite_frame_%d.png", i);
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+static void BM_DictionarySetObject(State& state)
+{
+    int count = state.getArg();
+    std::vector<std::string> keys = createKeys(count);
+    std::vector<Object*> objects = createObjects(count);
+    Dictionary* dictionary = Dictionary::create();
+    dictionary->retain();
+    while (state.keepRunning())
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            dictionary->setObject(objects[i], keys[i]);
+        }
+        dictionary->removeAllObjects();
+    }
+    dictionary->release();
+    releaseObjects(objects);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_DictionarySetObject)->arg(64)->arg(1024);
+
+static void BM_DictionaryObjectForKey(State& state)
+{
+    int count = state.getArg();
+    std::vector<std::string> keys = createKeys(count);
+    std::vector<Object*> objects = createObjects(count);
+    Dictionary* dictionary = Dictionary::create();
+    dictionary->retain();
+    for (int i = 0; i < count; ++i)
+    {
+        dictionary->setObject(objects[i], keys[i]);
+    }
+
+    intptr_t sum = 0;
+    while (state.keepRunning())
+    {
+        for (const std::string& key : keys)
+        {
+            sum += (intptr_t)dictionary->objectForKey(key);
+        }
+    }
+    doNotOptimize(&sum);
+    dictionary->release();
+    releaseObjects(objects);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_DictionaryObjectForKey)->arg(64)->arg(1024);
+
+////////////////////////////////////////////////////////
+//
+// Scheduler, ActionManager
+//
+////////////////////////////////////////////////////////
+
+static void BM_SchedulerUpdates(State& state)
+{
+    int count = state.getArg();
+    std::vector<Object*> objects = createObjects(count);
+    Scheduler* scheduler = new Scheduler();
+    for (int i = 0; i < count; ++i)
+    {
+        // the priorities of the nodes are mostly 0
+        scheduler->scheduleUpdateForTarget(objects[i], i % 8 == 0 ? -1 : 0, false);
+    }
+
+    while (state.keepRunning())
+    {
+        scheduler->update(1.0f / 60);
+    }
+    scheduler->unscheduleAll();
+    scheduler->release();
+    releaseObjects(objects);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_SchedulerUpdates)->arg(100)->arg(1000)->arg(10000);
+
+static void BM_SchedulerTimers(State& state)
+{
+    int count = state.getArg();
+    std::vector<BenchmarkTarget*> targets;
+    Scheduler* scheduler = new Scheduler();
+    for (int i = 0; i < count; ++i)
+    {
+        targets.push_back(new BenchmarkTarget());
+        // half of the timers fire every frame, the others every second
+        scheduler->scheduleSelector(schedule_selector(BenchmarkTarget::tick), targets.back(), i % 2 ? 1.0f : 0.0f, false);
+    }
+
+    while (state.keepRunning())
+    {
+        scheduler->update(1.0f / 60);
+    }
+    scheduler->unscheduleAll();
+    scheduler->release();
+    for (BenchmarkTarget* target : targets)
+    {
+        target->release();
+    }
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_SchedulerTimers)->arg(100)->arg(1000)->arg(10000);
+
+static void BM_ActionManagerUpdate(State& state)
+{
+    int count = state.getArg();
+    Scheduler* scheduler = new Scheduler();
+    ActionManager* actionManager = new ActionManager();
+    scheduler->scheduleUpdateForTarget(actionManager, Scheduler::PRIORITY_SYSTEM, false);
+
+    Array* nodes = Array::createWithCapacity(count);
+    nodes->retain();
+    for (int i = 0; i < count; ++i)
+    {
+        Node* node = Node::create();
+        nodes->addObject(node);
+        ActionInterval* action = i % 2 ? (ActionInterval*)RotateBy::create(1.0f, 360) : (ActionInterval*)MoveBy::create(1.0f, Point(10, 0));
+        actionManager->addAction(RepeatForever::create(action), node, false);
+    }
+
+    while (state.keepRunning())
+    {
+        scheduler->update(1.0f / 60);
+    }
+    actionManager->removeAllActions();
+    scheduler->unscheduleAll();
+    actionManager->release();
+    scheduler->release();
+    nodes->release();
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_ActionManagerUpdate)->arg(100)->arg(1000)->arg(10000);
+
+////////////////////////////////////////////////////////
+//
+// kazmath, AffineTransform
+//
+////////////////////////////////////////////////////////
+
+static std::vector<kmMat4> createMatrices(int count)
+{
+    std::vector<kmMat4> matrices(count);
+    for (int i = 0; i < count; ++i)
+    {
+        kmMat4 rotation, translation;
+        kmMat4RotationZ(&rotation, i * 0.1f);
+        kmMat4Translation(&translation, (float)i, (float)(i * 2), 0.0f);
+        kmMat4Multiply(&matrices[i], &translation, &rotation);
+    }
+    return matrices;
+}
+
+static void BM_Mat4Multiply(State& state)
+{
+    int count = state.getArg();
+    std::vector<kmMat4> a = createMatrices(count);
+    std::vector<kmMat4> b = createMatrices(count);
+    std::vector<kmMat4> out(count);
+    while (state.keepRunning())
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            kmMat4Multiply(&out[i], &a[i], &b[i]);
+        }
+    }
+    doNotOptimize(&out[0]);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_Mat4Multiply)->arg(1000);
+
+static void BM_Mat4Inverse(State& state)
+{
+    int count = state.getArg();
+    std::vector<kmMat4> matrices = createMatrices(count);
+    std::vector<kmMat4> out(count);
+    while (state.keepRunning())
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            kmMat4Inverse(&out[i], &matrices[i]);
+        }
+    }
+    doNotOptimize(&out[0]);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_Mat4Inverse)->arg(1000);
+
+static void BM_AffineTransformConcat(State& state)
+{
+    int count = state.getArg();
+    std::vector<AffineTransform> transforms;
+    for (int i = 0; i < count; ++i)
+    {
+        transforms.push_back(AffineTransformRotate(AffineTransformTranslate(AffineTransformIdentity, (float)i, (float)(i * 2)), i * 0.1f));
+    }
+
+    AffineTransform result = AffineTransformMakeIdentity();
+    while (state.keepRunning())
+    {
+        // a chain of parents to children
+        AffineTransform t = AffineTransformMakeIdentity();
+        for (int i = 0; i < count; ++i)
+        {
+            t = AffineTransformConcat(transforms[i], t);
+        }
+        result = t;
+    }
+    doNotOptimize(&result);
+    state.setItemsProcessed(state.getIterations() * count);
+}
+MICROBENCHMARK(BM_AffineTransformConcat)->arg(1000);
+
+////////////////////////////////////////////////////////
+//
+// ccUTF8, ZipUtils
+//
+////////////////////////////////////////////////////////
+
+// ASCII text with some accented and CJK characters, like the strings of a localized game
+static std::string createUTF8Text(int bytes)
+{
+    static const char* words[] = { "score ", "caf\xc3\xa9 ", "\xe6\x97\xa5\xe6\x9c\xac ", "level ", "\xc3\xa9t\xc3\xa9 ", "\xe4\xb8\xad\xe6\x96\x87 " };
+    std::string text;
+    for (int i = 0; (int)text.size() < bytes; ++i)
+    {
+        text += words[i % 6];
+    }
+    return text;
+}
+
+static void BM_UTF8ToUTF16(State& state)
+{
+    std::string text = createUTF8Text(state.getArg());
+    while (state.keepRunning())
+    {
+        int length = 0;
+        unsigned short* utf16 = cc_utf8_to_utf16(text.c_str(), -1, &length);
+        doNotOptimize(utf16);
+        delete [] utf16;
+    }
+    state.setBytesProcessed(state.getIterations() * text.size());
+}
+MICROBENCHMARK(BM_UTF8ToUTF16)->arg(64)->arg(4096);
+
+static void BM_UTF16ToUTF8(State& state)
+{
+    std::string text = createUTF8Text(state.getArg());
+    int length = 0;
+    unsigned short* utf16 = cc_utf8_to_utf16(text.c_str(), -1, &length);
+    while (state.keepRunning())
+    {
+        char* utf8 = cc_utf16_to_utf8(utf16, length, NULL, NULL);
+        doNotOptimize(utf8);
+        delete [] utf8;
+    }
+    delete [] utf16;
+    state.setBytesProcessed(state.getIterations() * text.size());
+}
+MICROBENCHMARK(BM_UTF16ToUTF8)->arg(64)->arg(4096);
+
+static void BM_ZipInflate(State& state)
+{
+    // text like a plist or a tmx file, compressed by zlib
+    std::string data;
+    char line[128];
+    for (int i = 0; (int)data.size() < state.getArg(); ++i)
+    {
+        snprintf(line, sizeof(line), "<key>frame_%d</key><string>{{%d,%d},{%d,%d}}</string>\n", i, (i * 37) % 1024, (i * 91) % 1024, 32 + i % 64, 32 + i % 48);
+        data += line;
+    }
+    uLongf compressedLength = compressBound(data.size());
+    std::vector<unsigned char> compressed(compressedLength);
+    compress2(&compressed[0], &compressedLength, (const Bytef*)data.c_str(), data.size(), Z_DEFAULT_COMPRESSION);
+
+    while (state.keepRunning())
+    {
+        unsigned char* out = NULL;
+        int length = ZipUtils::ccInflateMemory(&compressed[0], (unsigned int)compressedLength, &out);
+        doNotOptimize(out);
+        CC_UNUSED_PARAM(length);
+        delete [] out;
+    }
+    state.setBytesProcessed(state.getIterations() * data.size());
+}
+MICROBENCHMARK(BM_ZipInflate)->arg(64 * 1024)->arg(1024 * 1024);
+
+////////////////////////////////////////////////////////
+//
+// MicrobenchmarkLayer
+//
+////////////////////////////////////////////////////////
+
+MicrobenchmarkLayer::MicrobenchmarkLayer()
+: PerformBasicLayer(false)
+, _label(NULL)
+{
+}
+
+void MicrobenchmarkLayer::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    _label = LabelTTF::create("Running the microbenchmarks...", "Arial", 20);
+    _label->setPosition(VisibleRect::center());
+    addChild(_label);
+
+    // once the label is drawn
+    scheduleOnce(schedule_selector(MicrobenchmarkLayer::runBenchmarks), 0.1f);
+}
+
+void MicrobenchmarkLayer::showCurrentTest()
+{
+    _label->setString("Running the microbenchmarks...");
+    scheduleOnce(schedule_selector(MicrobenchmarkLayer::runBenchmarks), 0.1f);
+}
+
+void MicrobenchmarkLayer::runBenchmarks(float dt)
+{
+    std::vector<microbenchmark::Result> results = microbenchmark::runBenchmarks("");
+
+    char text[64];
+    snprintf(text, sizeof(text), "%d benchmarks done, see the log", (int)results.size());
+    _label->setString(text);
+}
+
+void runMicrobenchmarkTest()
+{
+    Scene* scene = Scene::create();
+    Layer* layer = new MicrobenchmarkLayer();
+    scene->addChild(layer);
+    layer->release();
+
+    Director::getInstance()->replaceScene(scene);
+}
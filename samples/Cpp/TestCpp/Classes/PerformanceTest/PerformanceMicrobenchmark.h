@@ -0,0 +1,132 @@
+#ifndef __PERFORMANCE_MICROBENCHMARK_H__
+#define __PERFORMANCE_MICROBENCHMARK_H__
+
+#include "PerformanceTest.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/** A small microbenchmark harness in the style of Google Benchmark, for the core data structures and the math.
+
+ A benchmark is a function registered with MICROBENCHMARK, given a State:
+
+     static void BM_ArrayAddObject(microbenchmark::State& state)
+     {
+         // set up, not timed
+         while (state.keepRunning())
+         {
+             // timed
+         }
+         state.setItemsProcessed(state.getIterations() * state.getArg());
+     }
+     MICROBENCHMARK(BM_ArrayAddObject)->arg(64)->arg(4096);
+
+ Each benchmark is run with each of its arguments: the number of iterations is raised until a run lasts the
+ minimum time, then the runs are repeated and the median time per iteration is reported.
+
+ They run with TestCpp --microbenchmark [--filter TEXT] [--output FILE] [--list] on the desktop, and from the
+ performance tests menu on the devices, where the results are logged.
+ */
+namespace microbenchmark {
+
+class State
+{
+public:
+    State(long long iterations, int arg);
+
+    /** Whether to run another iteration. The first call starts the timer, the last one stops it. */
+    bool keepRunning();
+
+    /** Excludes the work between the two calls from the time */
+    void pauseTiming();
+    void resumeTiming();
+
+    long long getIterations() const { return _iterations; }
+    int getArg() const { return _arg; }
+
+    /** Items or bytes handled by all the iterations, reported per second */
+    void setItemsProcessed(long long items) { _items = items; }
+    void setBytesProcessed(long long bytes) { _bytes = bytes; }
+
+    double getElapsedTime() const { return _elapsed; }
+    long long getItemsProcessed() const { return _items; }
+    long long getBytesProcessed() const { return _bytes; }
+
+private:
+    long long _iterations;
+    long long _left;
+    int _arg;
+    bool _started;
+    double _start;
+    double _elapsed;
+    long long _items;
+    long long _bytes;
+};
+
+typedef void (*Function)(State&);
+
+class Benchmark
+{
+public:
+    Benchmark(const char* name, Function function);
+
+    /** Adds an argument the benchmark is run with, usually the size of the data */
+    Benchmark* arg(int value);
+
+    const char* getName() const { return _name; }
+    Function getFunction() const { return _function; }
+    const std::vector<int>& getArgs() const { return _args; }
+
+private:
+    const char* _name;
+    Function _function;
+    std::vector<int> _args;
+};
+
+struct Result
+{
+    std::string name;
+    long long iterations;
+    double nanosecondsPerIteration;
+    /** 0 when the benchmark doesn't set them */
+    double itemsPerSecond;
+    double bytesPerSecond;
+};
+
+Benchmark* registerBenchmark(const char* name, Function function);
+
+/** Names of the registered benchmarks with their argument, like BM_ArrayAddObject/64 */
+std::vector<std::string> listBenchmarks(const std::string& filter);
+
+/** Runs the benchmarks whose name contains the filter, logging each result */
+std::vector<Result> runBenchmarks(const std::string& filter, double minTime = 0.2, int repetitions = 3);
+
+/** Writes the results as JSON */
+void writeResults(const std::vector<Result>& results, FILE* file);
+
+/** Keeps the compiler from optimizing away a value computed by a benchmark */
+void doNotOptimize(const void* value);
+
+} // namespace microbenchmark
+
+#define MICROBENCHMARK(__function__) \
+    static microbenchmark::Benchmark* __function__##_benchmark = microbenchmark::registerBenchmark(#__function__, __function__)
+
+/** Runs the microbenchmarks from the performance tests menu, and shows where the results are */
+class MicrobenchmarkLayer : public PerformBasicLayer
+{
+public:
+    MicrobenchmarkLayer();
+
+    virtual void onEnter() override;
+    virtual void showCurrentTest() override;
+
+    void runBenchmarks(float dt);
+
+protected:
+    LabelTTF* _label;
+};
+
+void runMicrobenchmarkTest();
+
+#endif // __PERFORMANCE_MICROBENCHMARK_H__
@@ -213,15 +213,13 @@ const char*  IterateSpriteSheet::profilerName()
 void IterateSpriteSheetFastEnum::update(float dt)
 {
     // iterate using fast enumeration protocol
-    Array* pChildren = batchNode->getChildren();
-    Object* pObject = NULL;
+    auto& children = batchNode->getChildren();
 
     CC_PROFILER_START_INSTANCE(this, this->profilerName());
 
-    CCARRAY_FOREACH(pChildren, pObject)
+    for (auto child : children)
     {
-        Sprite* sprite = static_cast<Sprite*>(pObject);
-        sprite->setVisible(false);
+        child->setVisible(false);
     }
 
     CC_PROFILER_STOP_INSTANCE(this, this->profilerName());
@@ -249,16 +247,16 @@ const char*  IterateSpriteSheetFastEnum::profilerName()
 ////////////////////////////////////////////////////////
 void IterateSpriteSheetCArray::update(float dt)
 {
-    // iterate using fast enumeration protocol
-    Array* pChildren = batchNode->getChildren();
-    Object* pObject = NULL;
+    // iterate using the underlying C array
+    auto& children = batchNode->getChildren();
+    Node** nodes = children.data();
+    unsigned int count = children.size();
 
     CC_PROFILER_START(this->profilerName());
 
-    CCARRAY_FOREACH(pChildren, pObject)
+    for (unsigned int i = 0; i < count; i++)
     {
-        Sprite* sprite = static_cast<Sprite*>(pObject);
-        sprite->setVisible(false);
+        nodes[i]->setVisible(false);
     }
 
     CC_PROFILER_STOP(this->profilerName());
@@ -488,7 +486,7 @@ void ReorderSpriteSheet::update(float dt)
 
         for( int i=0;i <  totalToAdd;i++)
         {
-            Node* node = (Node*) (batchNode->getChildren()->objectAtIndex(i));
+            Node* node = batchNode->getChildren().at(i);
             batchNode->reorderChild(node, CCRANDOM_MINUS1_1() * 50);
         }
         
@@ -5,6 +5,7 @@
 #include "PerformanceSpriteTest.h"
 #include "PerformanceTextureTest.h"
 #include "PerformanceTouchesTest.h"
+#include "PerformanceMicrobenchmark.h"
 
 enum
 {
@@ -22,6 +23,7 @@ struct {
 	{ "PerformanceSpriteTest",[](Object*sender){runSpriteTest();} },
 	{ "PerformanceTextureTest",[](Object*sender){runTextureTest();} },
 	{ "PerformanceTouchesTest",[](Object*sender){runTouchesTest();} },
+	{ "PerformanceMicrobenchmarks",[](Object*sender){runMicrobenchmarkTest();} },
 };
 
 static const int g_testMax = sizeof(g_testsName)/sizeof(g_testsName[0]);
@@ -694,17 +694,8 @@ void SchedulerUpdate::onEnter()
 
 void SchedulerUpdate::removeUpdates(float dt)
 {
-    Array* children = getChildren();
-    Node* node;
-    Object* pObject;
-    CCARRAY_FOREACH(children, pObject)
+    for (auto node : getChildren())
     {
-        node = static_cast<Node*>(pObject);
-
-        if (! node)
-        {
-            break;
-        }
         node->unscheduleAllSelectors();
     }
 }
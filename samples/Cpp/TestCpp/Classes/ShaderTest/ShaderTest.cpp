@@ -678,13 +678,10 @@ void ShaderRetroEffect::update(float dt)
 {
     _accum += dt;
 
-    Array* pArray = _label->getChildren();
-
     int i=0;
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(pArray, pObj)
+    for (auto child : _label->getChildren())
     {
-        Sprite *sprite = static_cast<Sprite*>(pObj);
+        Sprite *sprite = static_cast<Sprite*>(child);
         i++;
         Point oldPosition = sprite->getPosition();
         sprite->setPosition(Point( oldPosition.x, sinf( _accum * 2 + i/2.0) * 20  ));
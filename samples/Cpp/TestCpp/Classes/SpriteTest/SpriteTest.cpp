@@ -644,14 +644,11 @@ SpriteBatchNodeReorder::SpriteBatchNodeReorder()
     }
     
     int CC_UNUSED prev = -1;
-    Array* children = asmtest->getChildren();
     Sprite* child;
     Object* pObject = NULL;
-    CCARRAY_FOREACH(children, pObject)
+    for (auto node : asmtest->getChildren())
     {
-        child = static_cast<Sprite*>(pObject);
-        if(! child )
-            break;
+        child = static_cast<Sprite*>(node);
 
         int currentIndex = child->getAtlasIndex();
         CCASSERT( prev == currentIndex-1, "Child order failed");
@@ -1449,18 +1446,14 @@ void SpriteNewTexture::ccTouchesEnded(Set* touches, Event* event)
 
     Node *node = getChildByTag( kTagSpriteBatchNode );
 
-    Array* children = node->getChildren();
+    auto& children = node->getChildren();
     Sprite* sprite;
-    Object* pObject;
 
     if( _usingTexture1 )                          //--> win32 : Let's it make just simple sentence
     {
-        CCARRAY_FOREACH(children, pObject)
+        for (auto child : children)
         {
-            sprite = static_cast<Sprite*>( pObject );
-            if(! sprite)
-                break;
-
+            sprite = static_cast<Sprite*>( child );
             sprite->setTexture(_texture2);
         }
 
@@ -1468,12 +1461,9 @@ void SpriteNewTexture::ccTouchesEnded(Set* touches, Event* event)
     } 
     else 
     {
-        CCARRAY_FOREACH(children, pObject)
+        for (auto child : children)
         {
-            sprite = static_cast<Sprite*>( pObject );
-            if(! sprite)
-                break;
-
+            sprite = static_cast<Sprite*>( child );
             sprite->setTexture(_texture1);
         }
 
@@ -2209,14 +2199,9 @@ void SpriteHybrid::reparentSprite(float dt)
     
     Node* node;
     Object* pObject;
-    Array* children = p1->getChildren();
-    CCARRAY_FOREACH(children, pObject)
+    for (auto child : p1->getChildren())
     {
-        node = static_cast<Node*>( pObject );
-        if(! node )
-            break;
-
-        retArray->addObject(node);
+        retArray->addObject(child);
     }
 
     int i=0;
@@ -4142,20 +4127,19 @@ void NodeSort::reorderSprite(float dt)
 
     log("Before reorder--");
     
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(_node->getChildren(), pObj)
+    for (auto node : _node->getChildren())
     {
-        Sprite *child = static_cast<Sprite*>( pObj );
+        Sprite *child = static_cast<Sprite*>( node );
         log("tag %i z %i",(int)child->getTag(),(int)child->getZOrder());
     }
     //z-4
-    _node->reorderChild( static_cast<Node*>( _node->getChildren()->objectAtIndex(0) ), -6);
+    _node->reorderChild( _node->getChildren().at(0), -6);
 
     _node->sortAllChildren();
     log("After reorder--");
-    CCARRAY_FOREACH(_node->getChildren(), pObj)
+    for (auto node : _node->getChildren())
     {
-        Sprite *child = static_cast<Sprite*>( pObj );
+        Sprite *child = static_cast<Sprite*>( node );
         log("tag %i z %i",(int)child->getTag(),(int)child->getZOrder());
     }
 }
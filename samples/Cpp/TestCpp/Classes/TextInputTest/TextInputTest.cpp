@@ -160,13 +160,9 @@ void KeyboardNotificationLayer::keyboardWillShow(IMEKeyboardNotificationInfo& in
     CCLOG("TextInputTest:needAdjustVerticalPosition(%f)", adjustVert);
 
     // move all the children node of KeyboardNotificationLayer
-    Array * children = getChildren();
-    Node * node = 0;
-    int count = children->count();
     Point pos;
-    for (int i = 0; i < count; ++i)
+    for (auto node : getChildren())
     {
-        node = (Node*)children->objectAtIndex(i);
         pos = node->getPosition();
         pos.y += adjustVert;
         node->setPosition(pos);
@@ -128,16 +128,9 @@ TMXOrthoTest::TMXOrthoTest()
     Size CC_UNUSED s = map->getContentSize();
     CCLOG("ContentSize: %f, %f", s.width,s.height);
     
-    Array * pChildrenArray = map->getChildren();
-    SpriteBatchNode* child = NULL;
-    Object* pObject = NULL;
-    CCARRAY_FOREACH(pChildrenArray, pObject)
+    for (auto node : map->getChildren())
     {
-        child = static_cast<SpriteBatchNode*>(pObject);
-
-        if(!child)
-            break;
-
+        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(node);
         child->getTexture()->setAntiAliasTexParameters();
     }
 
@@ -177,16 +170,9 @@ TMXOrthoTest2::TMXOrthoTest2()
     Size CC_UNUSED s = map->getContentSize();
     CCLOG("ContentSize: %f, %f", s.width,s.height);
 
-    Array* pChildrenArray = map->getChildren();
-    SpriteBatchNode* child = NULL;
-    Object* pObject = NULL;
-    CCARRAY_FOREACH(pChildrenArray, pObject)
+    for (auto node : map->getChildren())
     {
-        child = static_cast<SpriteBatchNode*>(pObject);
-
-        if(!child)
-            break;
-
+        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(node);
         child->getTexture()->setAntiAliasTexParameters();
     }
 
@@ -211,16 +197,9 @@ TMXOrthoTest3::TMXOrthoTest3()
     Size CC_UNUSED s = map->getContentSize();
     CCLOG("ContentSize: %f, %f", s.width,s.height);
     
-    Array* pChildrenArray = map->getChildren();
-    SpriteBatchNode* child = NULL;
-    Object* pObject = NULL;
-    CCARRAY_FOREACH(pChildrenArray, pObject)
+    for (auto node : map->getChildren())
     {
-        child = static_cast<SpriteBatchNode*>(pObject);
-
-        if(!child)
-            break;
-
+        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(node);
         child->getTexture()->setAntiAliasTexParameters();
     }
     
@@ -246,16 +225,9 @@ TMXOrthoTest4::TMXOrthoTest4()
     Size CC_UNUSED s1 = map->getContentSize();
     CCLOG("ContentSize: %f, %f", s1.width,s1.height);
     
-    Array* pChildrenArray = map->getChildren();
-    SpriteBatchNode* child = NULL;
-    Object* pObject = NULL;
-    CCARRAY_FOREACH(pChildrenArray, pObject)
+    for (auto node : map->getChildren())
     {
-        child = static_cast<SpriteBatchNode*>(pObject);
-
-        if(!child)
-            break;
-
+        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(node);
         child->getTexture()->setAntiAliasTexParameters();
     }
     
@@ -551,16 +523,9 @@ TMXUncompressedTest::TMXUncompressedTest()
     map->runAction(MoveTo::create(1.0f, Point( -ms.width * ts.width/2, -ms.height * ts.height/2 ) ));
     
     // testing release map
-    Array* pChildrenArray = map->getChildren();
-    TMXLayer* layer;
-    Object* pObject = NULL;
-    CCARRAY_FOREACH(pChildrenArray, pObject)
+    for (auto node : map->getChildren())
     {
-        layer= static_cast<TMXLayer*>(pObject);
-
-        if(!layer)
-            break;
-
+        TMXLayer* layer = static_cast<TMXLayer*>(node);
         layer->releaseMap();
     }
 
@@ -809,7 +774,7 @@ TMXIsoZorder::TMXIsoZorder()
     map->setPosition(Point(-s.width/2,0));
     
     _tamara = Sprite::create(s_pathSister1);
-    map->addChild(_tamara, map->getChildren()->count() );
+    map->addChild(_tamara, map->getChildrenCount() );
     _tamara->retain();
     int mapWidth = map->getMapSize().width * map->getTileSize().width;
     _tamara->setPosition(CC_POINT_PIXELS_TO_POINTS(Point( mapWidth/2,0)));
@@ -877,7 +842,7 @@ TMXOrthoZorder::TMXOrthoZorder()
     CCLOG("ContentSize: %f, %f", s.width,s.height);
     
     _tamara = Sprite::create(s_pathSister1);
-    map->addChild(_tamara,  map->getChildren()->count());
+    map->addChild(_tamara,  map->getChildrenCount());
     _tamara->retain();
     _tamara->setAnchorPoint(Point(0.5f,0));
 
@@ -1154,10 +1119,9 @@ TMXOrthoFlipTest::TMXOrthoFlipTest()
     Size CC_UNUSED s = map->getContentSize();
     log("ContentSize: %f, %f", s.width,s.height);
 
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(map->getChildren(), pObj)
+    for (auto node : map->getChildren())
     {
-        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(pObj);
+        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(node);
         child->getTexture()->setAntiAliasTexParameters();
     }
 
@@ -1184,10 +1148,9 @@ TMXOrthoFlipRunTimeTest::TMXOrthoFlipRunTimeTest()
     Size s = map->getContentSize();
     log("ContentSize: %f, %f", s.width,s.height);
 
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(map->getChildren(), pObj)
+    for (auto node : map->getChildren())
     {
-        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(pObj);
+        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(node);
         child->getTexture()->setAntiAliasTexParameters();
     }
 
@@ -1263,10 +1226,9 @@ TMXOrthoFromXMLTest::TMXOrthoFromXMLTest()
     Size s = map->getContentSize();
     log("ContentSize: %f, %f", s.width,s.height);
 
-    Object* pObj = NULL;
-    CCARRAY_FOREACH(map->getChildren(), pObj)
+    for (auto node : map->getChildren())
     {
-        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(pObj);
+        SpriteBatchNode* child = static_cast<SpriteBatchNode*>(node);
         child->getTexture()->setAntiAliasTexParameters();
     }
 
@@ -1292,13 +1254,9 @@ TMXBug987::TMXBug987()
     Size CC_UNUSED s1 = map->getContentSize();
     CCLOG("ContentSize: %f, %f", s1.width,s1.height);
 
-    Array* childs = map->getChildren();
-    TMXLayer* node;
-    Object* pObject = NULL;
-    CCARRAY_FOREACH(childs, pObject)
+    for (auto child : map->getChildren())
     {
-        node = static_cast<TMXLayer*>(pObject);
-        CC_BREAK_IF(!node);
+        TMXLayer* node = static_cast<TMXLayer*>(child);
         node->getTexture()->setAntiAliasTexParameters();
     }
 
@@ -1,4 +1,5 @@
 #include "../Classes/AppDelegate.h"
+#include "../Classes/PerformanceTest/PerformanceBenchmark.h"
 #include "cocos2d.h"
 #include "CCEGLView.h"
 
@@ -11,6 +12,12 @@ USING_NS_CC;
 
 int main(int argc, char **argv)
 {
+    // --benchmark runs the performance tests and exits
+    if (!PerformanceBenchmark::getInstance()->parseArguments(argc, argv))
+    {
+        return 1;
+    }
+
     // create the application instance
     AppDelegate app;
     EGLView* eglView = EGLView::getInstance();
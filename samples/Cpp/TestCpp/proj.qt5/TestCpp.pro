@@ -83,6 +83,8 @@ SOURCES += ../Classes/AccelerometerTest/AccelerometerTest.cpp \
 	../Classes/PerformanceTest/PerformanceTest.cpp \
 	../Classes/PerformanceTest/PerformanceTextureTest.cpp \
 	../Classes/PerformanceTest/PerformanceTouchesTest.cpp \
+	../Classes/PerformanceTest/PerformanceBenchmark.cpp \
+	../Classes/PerformanceTest/PerformanceMicrobenchmark.cpp \
 	../Classes/RenderTextureTest/RenderTextureTest.cpp \
 	../Classes/RotateWorldTest/RotateWorldTest.cpp \
 	../Classes/SceneTest/SceneTest.cpp \
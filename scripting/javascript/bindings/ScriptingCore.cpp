@@ -15,6 +15,7 @@
 #include <map>
 #include "ScriptingCore.h"
 #include "jsdbgapi.h"
+#include "js/GCAPI.h"
 #include "cocos2d.h"
 #include "LocalStorage.h"
 #include "cocos2d_specifics.hpp"
@@ -53,6 +54,10 @@
 #endif // #if DEBUG
 
 #define BYTE_CODE_FILE_EXT ".jsc"
+// directory of the bytecode cache, in the writable path
+#define BYTE_CODE_CACHE_DIR "jsc_cache/"
+// first bytes of a cached bytecode file, followed by the length and the hash of the source it was compiled from
+#define BYTE_CODE_CACHE_MAGIC 0x4342534a
 
 static string inData;
 static string outData;
@@ -69,6 +74,37 @@ static void serverEntryPoint(void);
 js_proxy_t *_native_js_global_ht = NULL;
 js_proxy_t *_js_native_global_ht = NULL;
 js_type_class_t *_js_global_type_ht = NULL;
+
+// Direct-mapped caches in front of the proxy hash tables: the proxies are looked up at every call
+// crossing the boundary, most of the time for the same few objects.
+#define JSB_PROXY_CACHE_SIZE 512
+static js_proxy_t *_native_js_proxy_cache[JSB_PROXY_CACHE_SIZE];
+static js_proxy_t *_js_native_proxy_cache[JSB_PROXY_CACHE_SIZE];
+
+static inline unsigned int proxyCacheIndex(const void *ptr)
+{
+    uintptr_t p = (uintptr_t)ptr;
+    return (unsigned int)((p >> 4) ^ (p >> 13)) & (JSB_PROXY_CACHE_SIZE - 1);
+}
+
+// Ids of the properties of the points, sizes, rects and colors, interned once per runtime, so that the
+// conversions don't look up the names at every call.
+enum PropertyId {
+    PROPERTY_X,
+    PROPERTY_Y,
+    PROPERTY_WIDTH,
+    PROPERTY_HEIGHT,
+    PROPERTY_R,
+    PROPERTY_G,
+    PROPERTY_B,
+    PROPERTY_A,
+    PROPERTY_COUNT
+};
+
+static const char *_propertyNames[PROPERTY_COUNT] = { "x", "y", "width", "height", "r", "g", "b", "a" };
+static jsid _propertyIds[PROPERTY_COUNT];
+static JSRuntime *_propertyIdsRuntime = NULL;
+
 static char *_js_log_buf = NULL;
 
 static std::vector<sc_register_sth> registrationList;
@@ -333,6 +369,10 @@ ScriptingCore::ScriptingCore()
 , cx_(NULL)
 , global_(NULL)
 , debugGlobal_(NULL)
+, gcIncremental_(false)
+, gcModeBeforeIncremental_(0)
+, gcBytesAfterCollection_(0)
+, bytecodeCacheEnabled_(false)
 {
     // set utf8 strings internally (we don't need utf16)
     // XXX: Removed in SpiderMonkey 19.0
@@ -412,6 +452,8 @@ void ScriptingCore::removeAllRoots(JSContext *cx) {
     }
     HASH_CLEAR(hh, _js_native_global_ht);
     HASH_CLEAR(hh, _native_js_global_ht);
+    memset(_native_js_proxy_cache, 0, sizeof(_native_js_proxy_cache));
+    memset(_js_native_proxy_cache, 0, sizeof(_js_native_proxy_cache));
 }
 
 static JSPrincipals shellTrustedPrincipals = { 1 };
@@ -439,6 +481,8 @@ void ScriptingCore::createGlobalContext() {
     // Removed from Spidermonkey 19.
     //JS_SetCStringsAreUTF8();
     this->rt_ = JS_NewRuntime(8L * 1024L * 1024L, JS_USE_HELPER_THREADS);
+    _propertyIdsRuntime = NULL;
+    this->gcIncremental_ = false;
     JS_SetGCParameter(rt_, JSGC_MAX_BYTES, 0xffffffff);
 	
     JS_SetTrustedPrincipals(rt_, &shellTrustedPrincipals);
@@ -479,6 +523,86 @@ static std::string RemoveFileExt(const std::string& filePath) {
     }
 }
 
+// FNV-1a, to tell whether a cached bytecode file matches the source
+static uint32_t hashSource(const unsigned char *data, unsigned long length)
+{
+    uint32_t hash = 2166136261u;
+    for (unsigned long i = 0; i < length; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static std::string getBytecodeCachePath(const std::string& fullPath)
+{
+    // flattened into a single directory
+    std::string name = fullPath;
+    for (auto& c : name) {
+        if (c == '/' || c == '\\' || c == ':') {
+            c = '_';
+        }
+    }
+    return cocos2d::FileUtils::getInstance()->getWritablePath() + BYTE_CODE_CACHE_DIR + RemoveFileExt(name) + BYTE_CODE_FILE_EXT;
+}
+
+// Decodes the cached bytecode of a script, if it was compiled from the same source
+static JSScript* readBytecodeCache(JSContext *cx, const std::string& cachePath, unsigned long sourceLength, uint32_t sourceHash)
+{
+    unsigned long length = 0;
+    unsigned char *data = cocos2d::FileUtils::getInstance()->getFileData(cachePath.c_str(), "rb", &length);
+    if (!data) {
+        return NULL;
+    }
+    
+    JSScript *script = NULL;
+    uint32_t header[3];
+    if (length > sizeof(header)) {
+        memcpy(header, data, sizeof(header));
+        if (header[0] == BYTE_CODE_CACHE_MAGIC && header[1] == (uint32_t)sourceLength && header[2] == sourceHash) {
+            // fails if the bytecode was encoded by another version of SpiderMonkey
+            script = JS_DecodeScript(cx, data + sizeof(header), length - sizeof(header), NULL, NULL);
+        }
+    }
+    delete [] data;
+    
+    if (!script) {
+        JS_ClearPendingException(cx);
+        remove(cachePath.c_str());
+    }
+    return script;
+}
+
+static void writeBytecodeCache(JSContext *cx, JSScript *script, const std::string& cachePath, unsigned long sourceLength, uint32_t sourceHash)
+{
+    std::string directory = cocos2d::FileUtils::getInstance()->getWritablePath() + BYTE_CODE_CACHE_DIR;
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32)
+    mkdir(directory.c_str(), S_IRWXU | S_IRWXG | S_IRWXO);
+#else
+    CreateDirectoryA(directory.c_str(), NULL);
+#endif
+    
+    uint32_t length = 0;
+    void *data = JS_EncodeScript(cx, script, &length);
+    if (!data) {
+        JS_ClearPendingException(cx);
+        return;
+    }
+    
+    // written to a temporary file first, so that a crash never leaves a truncated cache
+    std::string temporaryPath = cachePath + ".tmp";
+    FILE *file = fopen(temporaryPath.c_str(), "wb");
+    if (file) {
+        uint32_t header[3] = { BYTE_CODE_CACHE_MAGIC, (uint32_t)sourceLength, sourceHash };
+        bool ok = fwrite(header, sizeof(header), 1, file) == 1 && fwrite(data, length, 1, file) == 1;
+        ok = fclose(file) == 0 && ok;
+        remove(cachePath.c_str());
+        if (!ok || rename(temporaryPath.c_str(), cachePath.c_str()) != 0) {
+            remove(temporaryPath.c_str());
+        }
+    }
+    JS_free(cx, data);
+}
+
 JSBool ScriptingCore::runScript(const char *path, JSObject* global, JSContext* cx)
 {
     if (!path) {
@@ -505,10 +629,34 @@ JSBool ScriptingCore::runScript(const char *path, JSObject* global, JSContext* c
                                     &length);
     if (data) {
         script = JS_DecodeScript(cx, data, length, NULL, NULL);
+        delete [] data;
     }
     
-    // b) no jsc file, check js file
-    if (!script) {
+    // b) no jsc file, check the bytecode cache, or compile the js file and cache its bytecode
+    bool compiled = false;
+    if (!script && bytecodeCacheEnabled_) {
+        /* Clear any pending exception from previous failed decoding.  */
+        ReportException(cx);
+        
+        unsigned long sourceLength = 0;
+        unsigned char *source = futil->getFileData(fullPath.c_str(), "rb", &sourceLength);
+        if (source) {
+            uint32_t sourceHash = hashSource(source, sourceLength);
+            std::string cachePath = getBytecodeCachePath(fullPath);
+            script = readBytecodeCache(cx, cachePath, sourceLength, sourceHash);
+            if (!script) {
+                compiled = true;
+                script = JS::Compile(cx, obj, options, (const char*)source, sourceLength);
+                if (script) {
+                    writeBytecodeCache(cx, script, cachePath, sourceLength, sourceHash);
+                }
+            }
+            delete [] source;
+        }
+    }
+    
+    // c) no cache, compile the js file
+    if (!script && !compiled) {
         /* Clear any pending exception from previous failed decoding.  */
         ReportException(cx);
         
@@ -649,6 +797,44 @@ JSBool ScriptingCore::executeScript(JSContext *cx, uint32_t argc, jsval *vp)
     return JS_TRUE;
 }
 
+void ScriptingCore::collectGarbage(float budget)
+{
+    if (!rt_)
+        return;
+
+    int64_t millis = MAX(1, (int64_t)(budget * 1000));
+    if (!gcIncremental_) {
+        gcModeBeforeIncremental_ = JS_GetGCParameter(rt_, JSGC_MODE);
+        JS_SetGCParameter(rt_, JSGC_MODE, JSGC_MODE_INCREMENTAL);
+        gcBytesAfterCollection_ = JS_GetGCParameter(rt_, JSGC_BYTES);
+        gcIncremental_ = true;
+    }
+    JS_SetGCParameter(rt_, JSGC_SLICE_TIME_BUDGET, (uint32_t)millis);
+
+    bool collecting = JS::IsIncrementalGCInProgress(rt_);
+    if (collecting) {
+        JS::PrepareForIncrementalGC(rt_);
+    } else if ((uint64_t)JS_GetGCParameter(rt_, JSGC_BYTES) >= (uint64_t)gcBytesAfterCollection_ * 2) {
+        JS::PrepareForFullGC(rt_);
+        collecting = true;
+    }
+
+    if (collecting) {
+        JS::IncrementalGC(rt_, JS::gcreason::API, millis);
+        if (!JS::IsIncrementalGCInProgress(rt_)) {
+            gcBytesAfterCollection_ = JS_GetGCParameter(rt_, JSGC_BYTES);
+        }
+    }
+}
+
+void ScriptingCore::resumeAutomaticGarbageCollection()
+{
+    if (rt_ && gcIncremental_) {
+        JS_SetGCParameter(rt_, JSGC_MODE, gcModeBeforeIncremental_);
+        gcIncremental_ = false;
+    }
+}
+
 JSBool ScriptingCore::forceGC(JSContext *cx, uint32_t argc, jsval *vp)
 {
     JSRuntime *rt = JS_GetRuntime(cx);
@@ -1161,15 +1347,78 @@ JSBool jsval_to_std_string(JSContext *cx, jsval v, std::string* ret) {
     return JS_TRUE;
 }
 
+static inline jsid propertyId(JSContext *cx, PropertyId prop)
+{
+    JSRuntime *rt = JS_GetRuntime(cx);
+    if (_propertyIdsRuntime != rt) {
+        for (int i = 0; i < PROPERTY_COUNT; ++i) {
+            _propertyIds[i] = INTERNED_STRING_TO_JSID(cx, JS_InternString(cx, _propertyNames[i]));
+        }
+        _propertyIdsRuntime = rt;
+    }
+    return _propertyIds[prop];
+}
+
+static inline JSBool getNumberProperty(JSContext *cx, JSObject *obj, PropertyId prop, double *ret)
+{
+    jsval v;
+    if (!JS_GetPropertyById(cx, obj, propertyId(cx, prop), &v))
+        return JS_FALSE;
+    if (JSVAL_IS_INT(v)) {
+        *ret = JSVAL_TO_INT(v);
+        return JS_TRUE;
+    }
+    if (JSVAL_IS_DOUBLE(v)) {
+        *ret = JSVAL_TO_DOUBLE(v);
+        return JS_TRUE;
+    }
+    return JS_ValueToNumber(cx, v, ret);
+}
+
+static inline JSBool defineProperty(JSContext *cx, JSObject *obj, PropertyId prop, jsval v)
+{
+    return JS_DefinePropertyById(cx, obj, propertyId(cx, prop), v, NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+}
+
+// Typed arrays are read without property lookups: a Float32Array holds x, y (width, height)
+// or r, g, b, a, and a Uint8Array or a Uint8ClampedArray r, g, b (a).
+static inline float* float32ArrayData(jsval v, uint32_t minLength)
+{
+    if (JSVAL_IS_PRIMITIVE(v))
+        return NULL;
+    JSObject *obj = JSVAL_TO_OBJECT(v);
+    if (!JS_IsFloat32Array(obj) || JS_GetTypedArrayLength(obj) < minLength)
+        return NULL;
+    return JS_GetFloat32ArrayData(obj);
+}
+
+static inline uint8_t* uint8ArrayData(jsval v, uint32_t minLength)
+{
+    if (JSVAL_IS_PRIMITIVE(v))
+        return NULL;
+    JSObject *obj = JSVAL_TO_OBJECT(v);
+    if (JS_IsUint8Array(obj)) {
+        return JS_GetTypedArrayLength(obj) >= minLength ? JS_GetUint8ArrayData(obj) : NULL;
+    }
+    if (JS_IsUint8ClampedArray(obj)) {
+        return JS_GetTypedArrayLength(obj) >= minLength ? JS_GetUint8ClampedArrayData(obj) : NULL;
+    }
+    return NULL;
+}
+
 JSBool jsval_to_ccpoint(JSContext *cx, jsval v, Point* ret) {
+    float *data = float32ArrayData(v, 2);
+    if (data) {
+        ret->x = data[0];
+        ret->y = data[1];
+        return JS_TRUE;
+    }
+
     JSObject *tmp;
-    jsval jsx, jsy;
     double x, y;
-    JSBool ok = JS_ValueToObject(cx, v, &tmp) &&
-        JS_GetProperty(cx, tmp, "x", &jsx) &&
-        JS_GetProperty(cx, tmp, "y", &jsy) &&
-        JS_ValueToNumber(cx, jsx, &x) &&
-        JS_ValueToNumber(cx, jsy, &y);
+    JSBool ok = JS_ValueToObject(cx, v, &tmp) && tmp &&
+        getNumberProperty(cx, tmp, PROPERTY_X, &x) &&
+        getNumberProperty(cx, tmp, PROPERTY_Y, &y);
 
     JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
 
@@ -1239,18 +1488,22 @@ JSBool jsvals_variadic_to_ccarray( JSContext *cx, jsval *vp, int argc, Array** r
 }
 
 JSBool jsval_to_ccrect(JSContext *cx, jsval v, Rect* ret) {
+    float *data = float32ArrayData(v, 4);
+    if (data) {
+        ret->origin.x = data[0];
+        ret->origin.y = data[1];
+        ret->size.width = data[2];
+        ret->size.height = data[3];
+        return JS_TRUE;
+    }
+
     JSObject *tmp;
-    jsval jsx, jsy, jswidth, jsheight;
     double x, y, width, height;
-    JSBool ok = JS_ValueToObject(cx, v, &tmp) &&
-        JS_GetProperty(cx, tmp, "x", &jsx) &&
-        JS_GetProperty(cx, tmp, "y", &jsy) &&
-        JS_GetProperty(cx, tmp, "width", &jswidth) &&
-        JS_GetProperty(cx, tmp, "height", &jsheight) &&
-        JS_ValueToNumber(cx, jsx, &x) &&
-        JS_ValueToNumber(cx, jsy, &y) &&
-        JS_ValueToNumber(cx, jswidth, &width) &&
-        JS_ValueToNumber(cx, jsheight, &height);
+    JSBool ok = JS_ValueToObject(cx, v, &tmp) && tmp &&
+        getNumberProperty(cx, tmp, PROPERTY_X, &x) &&
+        getNumberProperty(cx, tmp, PROPERTY_Y, &y) &&
+        getNumberProperty(cx, tmp, PROPERTY_WIDTH, &width) &&
+        getNumberProperty(cx, tmp, PROPERTY_HEIGHT, &height);
 
     JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
 
@@ -1262,14 +1515,18 @@ JSBool jsval_to_ccrect(JSContext *cx, jsval v, Rect* ret) {
 }
 
 JSBool jsval_to_ccsize(JSContext *cx, jsval v, Size* ret) {
+    float *data = float32ArrayData(v, 2);
+    if (data) {
+        ret->width = data[0];
+        ret->height = data[1];
+        return JS_TRUE;
+    }
+
     JSObject *tmp;
-    jsval jsw, jsh;
     double w, h;
-    JSBool ok = JS_ValueToObject(cx, v, &tmp) &&
-        JS_GetProperty(cx, tmp, "width", &jsw) &&
-        JS_GetProperty(cx, tmp, "height", &jsh) &&
-        JS_ValueToNumber(cx, jsw, &w) &&
-        JS_ValueToNumber(cx, jsh, &h);
+    JSBool ok = JS_ValueToObject(cx, v, &tmp) && tmp &&
+        getNumberProperty(cx, tmp, PROPERTY_WIDTH, &w) &&
+        getNumberProperty(cx, tmp, PROPERTY_HEIGHT, &h);
 
     JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
     ret->width = w;
@@ -1278,18 +1535,22 @@ JSBool jsval_to_ccsize(JSContext *cx, jsval v, Size* ret) {
 }
 
 JSBool jsval_to_cccolor4b(JSContext *cx, jsval v, Color4B* ret) {
+    uint8_t *data = uint8ArrayData(v, 4);
+    if (data) {
+        ret->r = data[0];
+        ret->g = data[1];
+        ret->b = data[2];
+        ret->a = data[3];
+        return JS_TRUE;
+    }
+
     JSObject *tmp;
-    jsval jsr, jsg, jsb, jsa;
     double r, g, b, a;
-    JSBool ok = JS_ValueToObject(cx, v, &tmp) &&
-        JS_GetProperty(cx, tmp, "r", &jsr) &&
-        JS_GetProperty(cx, tmp, "g", &jsg) &&
-        JS_GetProperty(cx, tmp, "b", &jsb) &&
-        JS_GetProperty(cx, tmp, "a", &jsa) &&
-        JS_ValueToNumber(cx, jsr, &r) &&
-        JS_ValueToNumber(cx, jsg, &g) &&
-        JS_ValueToNumber(cx, jsb, &b) &&
-        JS_ValueToNumber(cx, jsa, &a);
+    JSBool ok = JS_ValueToObject(cx, v, &tmp) && tmp &&
+        getNumberProperty(cx, tmp, PROPERTY_R, &r) &&
+        getNumberProperty(cx, tmp, PROPERTY_G, &g) &&
+        getNumberProperty(cx, tmp, PROPERTY_B, &b) &&
+        getNumberProperty(cx, tmp, PROPERTY_A, &a);
 
     JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
 
@@ -1301,18 +1562,22 @@ JSBool jsval_to_cccolor4b(JSContext *cx, jsval v, Color4B* ret) {
 }
 
 JSBool jsval_to_cccolor4f(JSContext *cx, jsval v, Color4F* ret) {
+    float *data = float32ArrayData(v, 4);
+    if (data) {
+        ret->r = data[0];
+        ret->g = data[1];
+        ret->b = data[2];
+        ret->a = data[3];
+        return JS_TRUE;
+    }
+
     JSObject *tmp;
-    jsval jsr, jsg, jsb, jsa;
     double r, g, b, a;
-    JSBool ok = JS_ValueToObject(cx, v, &tmp) &&
-        JS_GetProperty(cx, tmp, "r", &jsr) &&
-        JS_GetProperty(cx, tmp, "g", &jsg) &&
-        JS_GetProperty(cx, tmp, "b", &jsb) &&
-        JS_GetProperty(cx, tmp, "a", &jsa) &&
-        JS_ValueToNumber(cx, jsr, &r) &&
-        JS_ValueToNumber(cx, jsg, &g) &&
-        JS_ValueToNumber(cx, jsb, &b) &&
-        JS_ValueToNumber(cx, jsa, &a);
+    JSBool ok = JS_ValueToObject(cx, v, &tmp) && tmp &&
+        getNumberProperty(cx, tmp, PROPERTY_R, &r) &&
+        getNumberProperty(cx, tmp, PROPERTY_G, &g) &&
+        getNumberProperty(cx, tmp, PROPERTY_B, &b) &&
+        getNumberProperty(cx, tmp, PROPERTY_A, &a);
 
     JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
     ret->r = r;
@@ -1323,16 +1588,20 @@ JSBool jsval_to_cccolor4f(JSContext *cx, jsval v, Color4F* ret) {
 }
 
 JSBool jsval_to_cccolor3b(JSContext *cx, jsval v, Color3B* ret) {
+    uint8_t *data = uint8ArrayData(v, 3);
+    if (data) {
+        ret->r = data[0];
+        ret->g = data[1];
+        ret->b = data[2];
+        return JS_TRUE;
+    }
+
     JSObject *tmp;
-    jsval jsr, jsg, jsb;
     double r, g, b;
-    JSBool ok = JS_ValueToObject(cx, v, &tmp) &&
-        JS_GetProperty(cx, tmp, "r", &jsr) &&
-        JS_GetProperty(cx, tmp, "g", &jsg) &&
-        JS_GetProperty(cx, tmp, "b", &jsb) &&
-        JS_ValueToNumber(cx, jsr, &r) &&
-        JS_ValueToNumber(cx, jsg, &g) &&
-        JS_ValueToNumber(cx, jsb, &b);
+    JSBool ok = JS_ValueToObject(cx, v, &tmp) && tmp &&
+        getNumberProperty(cx, tmp, PROPERTY_R, &r) &&
+        getNumberProperty(cx, tmp, PROPERTY_G, &g) &&
+        getNumberProperty(cx, tmp, PROPERTY_B, &b);
 
     JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
 
@@ -1708,8 +1977,8 @@ jsval c_string_to_jsval(JSContext* cx, const char* v, size_t length /* = -1 */)
 jsval ccpoint_to_jsval(JSContext* cx, const Point& v) {
     JSObject *tmp = JS_NewObject(cx, NULL, NULL, NULL);
     if (!tmp) return JSVAL_NULL;
-    JSBool ok = JS_DefineProperty(cx, tmp, "x", DOUBLE_TO_JSVAL(v.x), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "y", DOUBLE_TO_JSVAL(v.y), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JSBool ok = defineProperty(cx, tmp, PROPERTY_X, DOUBLE_TO_JSVAL(v.x)) &&
+                defineProperty(cx, tmp, PROPERTY_Y, DOUBLE_TO_JSVAL(v.y));
     if (ok) {
         return OBJECT_TO_JSVAL(tmp);
     }
@@ -1732,10 +2001,10 @@ jsval ccacceleration_to_jsval(JSContext* cx, const Acceleration& v) {
 jsval ccrect_to_jsval(JSContext* cx, const Rect& v) {
     JSObject *tmp = JS_NewObject(cx, NULL, NULL, NULL);
     if (!tmp) return JSVAL_NULL;
-    JSBool ok = JS_DefineProperty(cx, tmp, "x", DOUBLE_TO_JSVAL(v.origin.x), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "y", DOUBLE_TO_JSVAL(v.origin.y), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "width", DOUBLE_TO_JSVAL(v.size.width), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "height", DOUBLE_TO_JSVAL(v.size.height), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JSBool ok = defineProperty(cx, tmp, PROPERTY_X, DOUBLE_TO_JSVAL(v.origin.x)) &&
+                defineProperty(cx, tmp, PROPERTY_Y, DOUBLE_TO_JSVAL(v.origin.y)) &&
+                defineProperty(cx, tmp, PROPERTY_WIDTH, DOUBLE_TO_JSVAL(v.size.width)) &&
+                defineProperty(cx, tmp, PROPERTY_HEIGHT, DOUBLE_TO_JSVAL(v.size.height));
     if (ok) {
         return OBJECT_TO_JSVAL(tmp);
     }
@@ -1745,8 +2014,8 @@ jsval ccrect_to_jsval(JSContext* cx, const Rect& v) {
 jsval ccsize_to_jsval(JSContext* cx, const Size& v) {
     JSObject *tmp = JS_NewObject(cx, NULL, NULL, NULL);
     if (!tmp) return JSVAL_NULL;
-    JSBool ok = JS_DefineProperty(cx, tmp, "width", DOUBLE_TO_JSVAL(v.width), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "height", DOUBLE_TO_JSVAL(v.height), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JSBool ok = defineProperty(cx, tmp, PROPERTY_WIDTH, DOUBLE_TO_JSVAL(v.width)) &&
+                defineProperty(cx, tmp, PROPERTY_HEIGHT, DOUBLE_TO_JSVAL(v.height));
     if (ok) {
         return OBJECT_TO_JSVAL(tmp);
     }
@@ -1756,10 +2025,10 @@ jsval ccsize_to_jsval(JSContext* cx, const Size& v) {
 jsval cccolor4b_to_jsval(JSContext* cx, const Color4B& v) {
     JSObject *tmp = JS_NewObject(cx, NULL, NULL, NULL);
     if (!tmp) return JSVAL_NULL;
-    JSBool ok = JS_DefineProperty(cx, tmp, "r", INT_TO_JSVAL(v.r), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "g", INT_TO_JSVAL(v.g), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "b", INT_TO_JSVAL(v.g), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "a", INT_TO_JSVAL(v.g), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JSBool ok = defineProperty(cx, tmp, PROPERTY_R, INT_TO_JSVAL(v.r)) &&
+                defineProperty(cx, tmp, PROPERTY_G, INT_TO_JSVAL(v.g)) &&
+                defineProperty(cx, tmp, PROPERTY_B, INT_TO_JSVAL(v.b)) &&
+                defineProperty(cx, tmp, PROPERTY_A, INT_TO_JSVAL(v.a));
     if (ok) {
         return OBJECT_TO_JSVAL(tmp);
     }
@@ -1769,10 +2038,10 @@ jsval cccolor4b_to_jsval(JSContext* cx, const Color4B& v) {
 jsval cccolor4f_to_jsval(JSContext* cx, const Color4F& v) {
     JSObject *tmp = JS_NewObject(cx, NULL, NULL, NULL);
     if (!tmp) return JSVAL_NULL;
-    JSBool ok = JS_DefineProperty(cx, tmp, "r", DOUBLE_TO_JSVAL(v.r), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "g", DOUBLE_TO_JSVAL(v.g), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "b", DOUBLE_TO_JSVAL(v.g), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "a", DOUBLE_TO_JSVAL(v.g), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JSBool ok = defineProperty(cx, tmp, PROPERTY_R, DOUBLE_TO_JSVAL(v.r)) &&
+                defineProperty(cx, tmp, PROPERTY_G, DOUBLE_TO_JSVAL(v.g)) &&
+                defineProperty(cx, tmp, PROPERTY_B, DOUBLE_TO_JSVAL(v.b)) &&
+                defineProperty(cx, tmp, PROPERTY_A, DOUBLE_TO_JSVAL(v.a));
     if (ok) {
         return OBJECT_TO_JSVAL(tmp);
     }
@@ -1782,9 +2051,9 @@ jsval cccolor4f_to_jsval(JSContext* cx, const Color4F& v) {
 jsval cccolor3b_to_jsval(JSContext* cx, const Color3B& v) {
     JSObject *tmp = JS_NewObject(cx, NULL, NULL, NULL);
     if (!tmp) return JSVAL_NULL;
-    JSBool ok = JS_DefineProperty(cx, tmp, "r", INT_TO_JSVAL(v.r), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "g", INT_TO_JSVAL(v.g), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT) &&
-                JS_DefineProperty(cx, tmp, "b", INT_TO_JSVAL(v.g), NULL, NULL, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JSBool ok = defineProperty(cx, tmp, PROPERTY_R, INT_TO_JSVAL(v.r)) &&
+                defineProperty(cx, tmp, PROPERTY_G, INT_TO_JSVAL(v.g)) &&
+                defineProperty(cx, tmp, PROPERTY_B, INT_TO_JSVAL(v.b));
     if (ok) {
         return OBJECT_TO_JSVAL(tmp);
     }
@@ -1987,20 +2256,42 @@ js_proxy_t* jsb_new_proxy(void* nativeObj, JSObject* jsObj)
 
 js_proxy_t* jsb_get_native_proxy(void* nativeObj)
 {
+    js_proxy_t*& cached = _native_js_proxy_cache[proxyCacheIndex(nativeObj)];
+    if (cached && cached->ptr == nativeObj)
+        return cached;
+
     js_proxy_t* p;
     JS_GET_PROXY(p, nativeObj);
+    if (p)
+        cached = p;
     return p;
 }
 
 js_proxy_t* jsb_get_js_proxy(JSObject* jsObj)
 {
+    js_proxy_t*& cached = _js_native_proxy_cache[proxyCacheIndex(jsObj)];
+    if (cached && cached->obj == jsObj)
+        return cached;
+
     js_proxy_t* p;
     JS_GET_NATIVE_PROXY(p, jsObj);
+    if (p)
+        cached = p;
     return p;
 }
 
 void jsb_remove_proxy(js_proxy_t* nativeProxy, js_proxy_t* jsProxy)
 {
+    if (nativeProxy) {
+        js_proxy_t*& cached = _native_js_proxy_cache[proxyCacheIndex(nativeProxy->ptr)];
+        if (cached == nativeProxy)
+            cached = NULL;
+    }
+    if (jsProxy) {
+        js_proxy_t*& cached = _js_native_proxy_cache[proxyCacheIndex(jsProxy->obj)];
+        if (cached == jsProxy)
+            cached = NULL;
+    }
     JS_REMOVE_PROXY(nativeProxy, jsProxy);
 }
 
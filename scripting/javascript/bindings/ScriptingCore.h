@@ -41,6 +41,12 @@ class ScriptingCore : public ScriptEngineProtocol
 	JSObject  *global_;
 	JSObject  *debugGlobal_;
 	SimpleRunLoop* runLoop;
+	// whether the collections are incremental, see collectGarbage
+	bool gcIncremental_;
+	uint32_t gcModeBeforeIncremental_;
+	uint32_t gcBytesAfterCollection_;
+	// whether runScript() caches the bytecode of the scripts it compiles
+	bool bytecodeCacheEnabled_;
 
 	ScriptingCore();
 public:
@@ -91,6 +97,14 @@ public:
 
     virtual bool handleAssert(const char *msg) { return false; }
 
+    /**
+     @brief Run a slice of incremental garbage collection of about budget seconds.
+     From the first call, the collections are incremental, and their slices started by SpiderMonkey
+     have the same budget. A collection starts when the heap doubled since the end of the last one.
+     */
+    virtual void collectGarbage(float budget) override;
+    virtual void resumeAutomaticGarbageCollection() override;
+
     bool executeFunctionWithObjectData(Node *self, const char *name, JSObject *obj);
     JSBool executeFunctionWithOwner(jsval owner, const char *name, uint32_t argc = 0, jsval* vp = NULL, jsval* retVal = NULL);
 
@@ -110,6 +124,16 @@ public:
 	 */
 	JSBool runScript(const char *path, JSObject* global = NULL, JSContext* cx = NULL);
 
+	/**
+	 * Enable the cache of the compiled scripts. runScript() stores the bytecode of the scripts it compiles
+	 * in the writable path, and decodes it at the next launches instead of compiling them again, as long as
+	 * their source didn't change. A bytecode file (.jsc) shipped next to a script is used first in any case.
+	 * Disabled by default
+	 * @since v3.0
+	 */
+	void setBytecodeCacheEnabled(bool enabled) { bytecodeCacheEnabled_ = enabled; }
+	bool isBytecodeCacheEnabled() const { return bytecodeCacheEnabled_; }
+
 	/**
 	 * initialize everything
 	 */
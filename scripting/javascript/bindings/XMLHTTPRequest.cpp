@@ -162,6 +162,91 @@ void MinXmlHttpRequest::_setHttpRequestHeader() {
     
 }
 
+/**
+ *  @brief Roots a callback set from Javascript, or unroots it when it is removed.
+ *  @param callback  Member holding the callback, its address is rooted
+ *  @param value     Function, or null
+ */
+void MinXmlHttpRequest::_setCallback(JSObject** callback, jsval value, const char* name) {
+    
+    JSObject* function = JSVAL_IS_PRIMITIVE(value) ? NULL : JSVAL_TO_OBJECT(value);
+    
+    if (function && !*callback) {
+        JS_AddNamedObjectRoot(cx, callback, name);
+    }
+    else if (!function && *callback) {
+        JS_RemoveObjectRoot(cx, callback);
+    }
+    *callback = function;
+}
+
+/**
+ *  @brief Calls a Javascript callback with the request as this, if it is set.
+ */
+void MinXmlHttpRequest::_notify(JSObject* callback, unsigned argc, jsval* argv) {
+    
+    js_proxy_t * p = jsb_get_native_proxy(this);
+    
+    if (p && callback) {
+        jsval fval = OBJECT_TO_JSVAL(callback);
+        jsval out;
+        JS_CallFunctionValue(cx, p->obj, fval, argc, argv, &out);
+    }
+}
+
+/**
+ *  @brief Calls onprogress with an event holding the loaded and total sizes of the response.
+ */
+void MinXmlHttpRequest::_notifyProgress() {
+    
+    if (!onprogressCallback) {
+        return;
+    }
+    
+    long long total = stream->total;
+    JSObject* event = JS_NewObject(cx, NULL, NULL, NULL);
+    if (!event) {
+        return;
+    }
+    
+    JS_DefineProperty(cx, event, "loaded", DOUBLE_TO_JSVAL((double)progressLoaded), NULL, NULL, JSPROP_ENUMERATE);
+    JS_DefineProperty(cx, event, "total", DOUBLE_TO_JSVAL(total >= 0 ? (double)total : 0), NULL, NULL, JSPROP_ENUMERATE);
+    JS_DefineProperty(cx, event, "lengthComputable", BOOLEAN_TO_JSVAL(total >= 0), NULL, NULL, JSPROP_ENUMERATE);
+    
+    jsval arg = OBJECT_TO_JSVAL(event);
+    _notify(onprogressCallback, 1, &arg);
+}
+
+/**
+ *  @brief Reports the state of the response received by the network thread, once per frame.
+ */
+void MinXmlHttpRequest::update(float dt) {
+    
+    if (readyState < HEADERS_RECEIVED && stream->responseCode != 0) {
+        status = (int)stream->responseCode;
+        readyState = HEADERS_RECEIVED;
+        _notify(onreadystateCallback, 0, NULL);
+    }
+    
+    size_t loaded = stream->loaded;
+    if (loaded != progressLoaded) {
+        progressLoaded = loaded;
+        if (readyState < LOADING) {
+            readyState = LOADING;
+            _notify(onreadystateCallback, 0, NULL);
+        }
+        _notifyProgress();
+    }
+}
+
+/**
+ *  @brief Stops reporting the progress of the request.
+ */
+void MinXmlHttpRequest::_stopProgress() {
+    
+    cocos2d::Director::getInstance()->getScheduler()->unscheduleSelector(schedule_selector(MinXmlHttpRequest::update), this);
+}
+
 /**
  *  @brief Callback for HTTPRequest. Handles the response and invokes Callback.
  *  @param sender   Object which initialized callback
@@ -169,73 +254,47 @@ void MinXmlHttpRequest::_setHttpRequestHeader() {
  */
 void MinXmlHttpRequest::handle_requestResponse(cocos2d::extension::HttpClient *sender, cocos2d::extension::HttpResponse *response) {
 
+    // the response of a request aborted, or sent before the last open()
+    if (!stream || response->getHttpRequest()->getUserData() != stream.get()) {
+        return;
+    }
+    
     if (0 != strlen(response->getHttpRequest()->getTag()))
     {
         CCLOG("%s completed", response->getHttpRequest()->getTag());
     }
     
-    int statusCode = response->getResponseCode();
-    char statusString[64] = {};
-    sprintf(statusString, "HTTP Status Code: %d, tag = %s", statusCode, response->getHttpRequest()->getTag());
+    _stopProgress();
     
-    if (!response->isSucceed())
-    {
-        CCLOG("response failed");
-        CCLOG("error buffer: %s", response->getErrorBuffer());
-        return;
-    }
+    int statusCode = response->getResponseCode();
     
     // set header
     std::vector<char> *headers = response->getResponseHeader();
-    
-    char* concatHeader = (char*) malloc(headers->size() + 1);
-    std::string header(headers->begin(), headers->end());
-    strcpy(concatHeader, header.c_str());
-    
-    std::istringstream stream(concatHeader);
+    std::istringstream headerStream(std::string(headers->begin(), headers->end()));
     std::string line;
-    while(std::getline(stream, line)) {
+    while(std::getline(headerStream, line)) {
         _gotHeader(line);
     }
     
-    /** get the response data **/
-    std::vector<char> *buffer = response->getResponseData();
-    char* concatenated = (char*) malloc(buffer->size() + 1);
-    std::string s2(buffer->begin(), buffer->end());
-    
-    strcpy(concatenated, s2.c_str());
-    
-    if (statusCode == 200)
+    if (!response->isSucceed())
     {
-        //Succeeded
-        status = 200;
-        readyState = DONE;
-        data << concatenated;
-        
+        CCLOG("response failed");
+        CCLOG("error buffer: %s", response->getErrorBuffer());
+        status = 0;
     }
     else
     {
-        status = 0;
+        status = statusCode;
     }
-    // Free Memory.
-    free((void*) concatHeader);
-    free((void*) concatenated);
-    
-    js_proxy_t * p;
-    void* ptr = (void*)this;
-    p = jsb_get_native_proxy(ptr);
-    
-    if(p){
-        JSContext* cx = ScriptingCore::getInstance()->getGlobalContext();
-       
-        if (onreadystateCallback) {
-            //JS_IsExceptionPending(cx) && JS_ReportPendingException(cx);
-            jsval fval = OBJECT_TO_JSVAL(onreadystateCallback);
-            jsval out;
-            JS_CallFunctionValue(cx, NULL, fval, 0, NULL, &out);
-        }
-     
+    
+    // the body was streamed to stream->data, the network thread is done with it
+    if (stream->loaded != progressLoaded) {
+        progressLoaded = stream->loaded;
+        _notifyProgress();
     }
+    
+    readyState = DONE;
+    _notify(onreadystateCallback, 0, NULL);
 
 }
 /**
@@ -244,23 +303,48 @@ void MinXmlHttpRequest::handle_requestResponse(cocos2d::extension::HttpClient *s
  */
 void MinXmlHttpRequest::_sendRequest(JSContext *cx) {
     
+    // the body is appended by the network thread as it is received, instead of being copied once done
+    std::shared_ptr<MinXmlHttpRequestStream> requestStream = std::make_shared<MinXmlHttpRequestStream>();
+    stream = requestStream;
+    progressLoaded = 0;
+    
+    cc_request->setUserData(requestStream.get());
+    cc_request->setStreamStartCallback([requestStream](long responseCode, double contentLength) {
+        if (contentLength >= 0) {
+            requestStream->total = (long long)contentLength;
+            requestStream->data.reserve((size_t)contentLength);
+        }
+        requestStream->responseCode = responseCode;
+    });
+    cc_request->setStreamCallback([requestStream](const char* data, size_t size) -> bool {
+        if (requestStream->aborted) {
+            return false;
+        }
+        requestStream->data.insert(requestStream->data.end(), data, data + size);
+        requestStream->loaded = requestStream->data.size();
+        return true;
+    });
+    
     cc_request->setResponseCallback(this, httpresponse_selector(MinXmlHttpRequest::handle_requestResponse));
     cocos2d::extension::HttpClient::getInstance()->send(cc_request);
     cc_request->release();
+    cc_request = NULL;
+    
+    cocos2d::Director::getInstance()->getScheduler()->scheduleSelector(schedule_selector(MinXmlHttpRequest::update), this, 0, false);
 
 }
 
 /**
- * @brief  Constructor initializes cchttprequest and stuff
+ *  @brief  Constructor initializes cchttprequest and stuff
  *
  */
-MinXmlHttpRequest::MinXmlHttpRequest() : onreadystateCallback(NULL), isNetwork(true) {
+MinXmlHttpRequest::MinXmlHttpRequest() : progressLoaded(0), responseValue(JSVAL_VOID), onreadystateCallback(NULL), onprogressCallback(NULL), readyState(UNSENT), status(0), responseType(kRequestResponseTypeString), timeout(0), isAsync(true), cc_request(NULL), isNetwork(true) {
     
     http_header.clear();
     request_header.clear();
     withCredentialsValue = true;
     cx = ScriptingCore::getInstance()->getGlobalContext();
-    cc_request = new cocos2d::extension::HttpRequest();
+    JS_AddNamedValueRoot(cx, &responseValue, "XMLHttpRequest_response");
 }
 
 /**
@@ -276,11 +360,14 @@ MinXmlHttpRequest::~MinXmlHttpRequest() {
     {
         JS_RemoveObjectRoot(cx, &onreadystateCallback);
     }
-    
-    if (cc_request) {
-        // We don't need to release cc_request here since it will be released in the http callback.
-//        cc_request->release();
+    if (onprogressCallback != NULL)
+    {
+        JS_RemoveObjectRoot(cx, &onprogressCallback);
     }
+    JS_RemoveValueRoot(cx, &responseValue);
+    
+    // a sent request is released by the HttpClient
+    CC_SAFE_RELEASE(cc_request);
 
 }
 
@@ -344,11 +431,28 @@ JS_BINDED_PROP_GET_IMPL(MinXmlHttpRequest, onreadystatechange)
  */
 JS_BINDED_PROP_SET_IMPL(MinXmlHttpRequest, onreadystatechange)
 {
-    jsval callback = vp.get();
-    if (callback != JSVAL_NULL) {
-        onreadystateCallback = JSVAL_TO_OBJECT(callback);
-        JS_AddNamedObjectRoot(cx, &onreadystateCallback, "onreadystateCallback");
-    }
+    _setCallback(&onreadystateCallback, vp.get(), "onreadystateCallback");
+    return JS_TRUE;
+}
+
+/**
+ *  @brief  get progress callback function for Javascript
+ *
+ */
+JS_BINDED_PROP_GET_IMPL(MinXmlHttpRequest, onprogress)
+{
+    vp.set(onprogressCallback ? OBJECT_TO_JSVAL(onprogressCallback) : JSVAL_NULL);
+    return JS_TRUE;
+}
+
+/**
+ *  @brief Set progress callback function coming from Javascript, called with the loaded and total sizes
+ *  of the response while it is downloaded.
+ *
+ */
+JS_BINDED_PROP_SET_IMPL(MinXmlHttpRequest, onprogress)
+{
+    _setCallback(&onprogressCallback, vp.get(), "onprogressCallback");
     return JS_TRUE;
 }
 
@@ -407,7 +511,13 @@ JS_BINDED_PROP_SET_IMPL(MinXmlHttpRequest, timeout)
  */
 JS_BINDED_PROP_GET_IMPL(MinXmlHttpRequest, responseType)
 {
-    JSString* str = JS_NewStringCopyN(cx, "", 0);
+    const char* name = "";
+    switch (responseType) {
+        case kRequestResponseTypeArrayBuffer: name = "arraybuffer"; break;
+        case kRequestResponseTypeJSON: name = "json"; break;
+        default: break;
+    }
+    JSString* str = JS_NewStringCopyZ(cx, name);
     vp.set(STRING_TO_JSVAL(str));
     return JS_TRUE;
 }
@@ -526,11 +636,16 @@ JS_BINDED_PROP_SET_IMPL(MinXmlHttpRequest, withCredentials)
  */
 JS_BINDED_PROP_GET_IMPL(MinXmlHttpRequest, responseText)
 {
-    JSString* str = JS_NewStringCopyZ(cx, data.str().c_str());//, dataSize);
+    // the network thread writes the data until the request is done
+    if (readyState != DONE || !stream || stream->data.empty()) {
+        vp.set(STRING_TO_JSVAL(JS_GetEmptyString(JS_GetRuntime(cx))));
+        return JS_TRUE;
+    }
+    
+    jsval str = c_string_to_jsval(cx, &stream->data[0], stream->data.size());
 
-    if (str) {
-        vp.set(STRING_TO_JSVAL(str));
-        //JS_ReportError(cx, "Result: %s", data.str().c_str());
+    if (!JSVAL_IS_NULL(str)) {
+        vp.set(str);
         return JS_TRUE;
     } else {
         JS_ReportError(cx, "Error trying to create JSString from data");
@@ -541,30 +656,53 @@ JS_BINDED_PROP_GET_IMPL(MinXmlHttpRequest, responseText)
 /**
  *  @brief get response of latest XHR
  *
+ *  The JSON is parsed from the UTF-8 data without creating the string of the response, and the
+ *  ArrayBuffer takes the data without text conversion. Both are created once.
  */
 JS_BINDED_PROP_GET_IMPL(MinXmlHttpRequest, response)
 {
+    if (responseType != kRequestResponseTypeJSON && responseType != kRequestResponseTypeArrayBuffer) {
+        // by default, return text
+        return _js_get_responseText(cx, id, vp);
+    }
     
+    if (readyState != DONE || !stream) {
+        vp.set(JSVAL_NULL);
+        return JS_TRUE;
+    }
+    if (!JSVAL_IS_VOID(responseValue)) {
+        vp.set(responseValue);
+        return JS_TRUE;
+    }
+    
+    std::vector<char>& data = stream->data;
     if (responseType == kRequestResponseTypeJSON) {
+        int length = 0;
+        jschar* chars = data.empty() ? NULL : (jschar*)cc_utf8_to_utf16(&data[0], data.size(), &length);
         jsval outVal;
-        
-        JSString* str = JS_NewStringCopyZ(cx, data.str().c_str());//, dataSize);
-        if (JS_ParseJSON(cx, JS_GetStringCharsZ(cx, str), dataSize, &outVal)) {
-            
-            vp.set(outVal);
+        JSBool ok = chars && JS_ParseJSON(cx, chars, length, &outVal);
+        delete[] chars;
+        if (!ok) {
+            vp.set(JSVAL_NULL);
             return JS_TRUE;
         }
-    } else if (responseType == kRequestResponseTypeArrayBuffer) {
-        JSObject* tmp = JS_NewArrayBuffer(cx, dataSize);
-        uint8_t* tmpData = JS_GetArrayBufferData(tmp);
-        data.read((char*)tmpData, dataSize);
-        jsval outVal = OBJECT_TO_JSVAL(tmp);
-
-        vp.set(outVal);
-        return JS_TRUE;
+        responseValue = outVal;
+    } else {
+        JSObject* buffer = JS_NewArrayBuffer(cx, data.size());
+        if (!buffer) {
+            return JS_FALSE;
+        }
+        if (!data.empty()) {
+            memcpy(JS_GetArrayBufferData(buffer), &data[0], data.size());
+        }
+        responseValue = OBJECT_TO_JSVAL(buffer);
+        
+        // the buffer is the only copy kept, responseText isn't available with this response type
+        std::vector<char>().swap(data);
     }
-    // by default, return text
-    return _js_get_responseText(cx, id, vp);
+    
+    vp.set(responseValue);
+    return JS_TRUE;
 }
 
 /**
@@ -596,6 +734,19 @@ JS_BINDED_FUNC_IMPL(MinXmlHttpRequest, open)
         readyState = 1;
         isAsync = async;
         
+        // a request still sent is aborted, and a request opened but not sent is replaced
+        if (stream) {
+            stream->aborted = true;
+            stream.reset();
+            _stopProgress();
+        }
+        CC_SAFE_RELEASE(cc_request);
+        cc_request = new cocos2d::extension::HttpRequest();
+        request_header.clear();
+        status = 0;
+        statusText.clear();
+        responseValue = JSVAL_VOID;
+        
         if (url.length() > 5 && url.compare(url.length() - 5, 5, ".json") == 0) {
             responseType = kRequestResponseTypeJSON;
         }
@@ -630,6 +781,11 @@ JS_BINDED_FUNC_IMPL(MinXmlHttpRequest, send)
     JSString *str = NULL;
     std::string data;
     
+    if (!cc_request) {
+        JS_ReportError(cx, "send() called before open()");
+        return JS_FALSE;
+    }
+    
     // Clean up header map. New request, new headers!
     http_header.clear();
     if (argc == 1) {
@@ -652,11 +808,19 @@ JS_BINDED_FUNC_IMPL(MinXmlHttpRequest, send)
 }
 
 /**
- *  @brief abort function Placeholder!
+ *  @brief abort the request being sent, the network thread stops receiving its response.
  *
  */
 JS_BINDED_FUNC_IMPL(MinXmlHttpRequest, abort)
 {
+    if (stream) {
+        stream->aborted = true;
+        stream.reset();
+        _stopProgress();
+    }
+    readyState = UNSENT;
+    status = 0;
+    responseValue = JSVAL_VOID;
     return JS_TRUE;
 }
 
@@ -793,6 +957,7 @@ void MinXmlHttpRequest::_js_register(JSContext *cx, JSObject *global) {
     MinXmlHttpRequest::js_class = js_class;
     static JSPropertySpec props[] = {
         JS_BINDED_PROP_DEF_ACCESSOR(MinXmlHttpRequest, onreadystatechange),
+        JS_BINDED_PROP_DEF_ACCESSOR(MinXmlHttpRequest, onprogress),
         JS_BINDED_PROP_DEF_ACCESSOR(MinXmlHttpRequest, responseType),
         JS_BINDED_PROP_DEF_ACCESSOR(MinXmlHttpRequest, withCredentials),
         JS_BINDED_PROP_DEF_GETTER(MinXmlHttpRequest, readyState),
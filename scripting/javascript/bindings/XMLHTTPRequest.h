@@ -36,6 +36,9 @@
 #include "jsapi.h"
 #include "jsfriendapi.h"
 #include "jsb_helper.h"
+#include <atomic>
+#include <memory>
+#include <vector>
 
 enum MinXmlHttpRequestResponseType {
     kRequestResponseTypeString,
@@ -52,15 +55,30 @@ const unsigned short HEADERS_RECEIVED = 2;
 const unsigned short LOADING = 3;
 const unsigned short DONE = 4;
 
+// The body of a response, written by the network thread as it is received. The main thread only reads the
+// data once the response is dispatched, and the counters to report the progress meanwhile
+struct MinXmlHttpRequestStream
+{
+    MinXmlHttpRequestStream() : responseCode(0), total(-1), loaded(0), aborted(false) {}
+    std::vector<char> data;
+    std::atomic<long> responseCode;
+    std::atomic<long long> total;
+    std::atomic<size_t> loaded;
+    std::atomic<bool> aborted;
+};
+
 class MinXmlHttpRequest : public cocos2d::Object
 {
     std::string url;
     JSContext *cx;
     std::string meth;
 	std::string type;
-	std::stringstream data;
-	size_t dataSize;
+	std::shared_ptr<MinXmlHttpRequestStream> stream;
+	size_t progressLoaded;
+	// the parsed JSON or the ArrayBuffer of the response, rooted
+	jsval responseValue;
 	JSObject* onreadystateCallback;
+	JSObject* onprogressCallback;
 	int readyState;
 	int status;
     std::string statusText;
@@ -79,6 +97,10 @@ class MinXmlHttpRequest : public cocos2d::Object
     void _setRequestHeader(const char* field, const char* value);
     void _setHttpRequestHeader();
     void _sendRequest(JSContext *cx);
+    void _setCallback(JSObject** callback, jsval value, const char* name);
+    void _notify(JSObject* callback, unsigned argc, jsval* argv);
+    void _notifyProgress();
+    void _stopProgress();
 
 public:
     MinXmlHttpRequest();
@@ -86,6 +108,7 @@ public:
     JS_BINDED_CLASS_GLUE(MinXmlHttpRequest);
     JS_BINDED_CONSTRUCTOR(MinXmlHttpRequest);
     JS_BINDED_PROP_ACCESSOR(MinXmlHttpRequest, onreadystatechange);
+    JS_BINDED_PROP_ACCESSOR(MinXmlHttpRequest, onprogress);
     JS_BINDED_PROP_ACCESSOR(MinXmlHttpRequest, responseType);
     JS_BINDED_PROP_ACCESSOR(MinXmlHttpRequest, withCredentials);
     JS_BINDED_PROP_ACCESSOR(MinXmlHttpRequest, upload);
@@ -106,6 +129,9 @@ public:
 
     void handle_requestResponse(cocos2d::extension::HttpClient *sender, cocos2d::extension::HttpResponse *response);
 
+    // reports the progress of the download while the request is sent
+    virtual void update(float dt) override;
+
 };
 
 #endif
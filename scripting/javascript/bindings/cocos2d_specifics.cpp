@@ -2082,6 +2082,99 @@ JSBool js_cocos2dx_release(JSContext *cx, uint32_t argc, jsval *vp)
 	return JS_FALSE;
 }
 
+// cc.ObjectPool, the nodes and the actions keep their JS object while they are pooled
+
+JSBool js_cocos2dx_ObjectPool_recycle(JSContext *cx, uint32_t argc, jsval *vp)
+{
+	jsval *argv = JS_ARGV(cx, vp);
+	if (argc == 2 && !JSVAL_IS_PRIMITIVE(argv[0])) {
+		js_proxy_t *proxy = jsb_get_js_proxy(JSVAL_TO_OBJECT(argv[0]));
+		JSB_PRECONDITION2(proxy, cx, JS_FALSE, "Invalid Native Object");
+		std::string key;
+		JSBool ok = jsval_to_std_string(cx, argv[1], &key);
+		JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
+
+		bool ret = ObjectPool::getInstance()->recycle((Object *)proxy->ptr, key);
+		JS_SET_RVAL(cx, vp, BOOLEAN_TO_JSVAL(ret));
+		return JS_TRUE;
+	}
+	JS_ReportError(cx, "wrong number of arguments: %d, was expecting %d", argc, 2);
+	return JS_FALSE;
+}
+
+JSBool js_cocos2dx_ObjectPool_obtain(JSContext *cx, uint32_t argc, jsval *vp)
+{
+	jsval *argv = JS_ARGV(cx, vp);
+	if (argc == 1) {
+		std::string key;
+		JSBool ok = jsval_to_std_string(cx, argv[0], &key);
+		JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
+
+		jsval ret = JSVAL_NULL;
+		Object* object = ObjectPool::getInstance()->obtain(key);
+		if (object) {
+			// the proxy of the object is found again, or created with its dynamic type
+			js_proxy_t *proxy = js_get_or_create_proxy<cocos2d::Object>(cx, object);
+			if (proxy) {
+				ret = OBJECT_TO_JSVAL(proxy->obj);
+			}
+		}
+		JS_SET_RVAL(cx, vp, ret);
+		return JS_TRUE;
+	}
+	JS_ReportError(cx, "wrong number of arguments: %d, was expecting %d", argc, 1);
+	return JS_FALSE;
+}
+
+JSBool js_cocos2dx_ObjectPool_setCapacity(JSContext *cx, uint32_t argc, jsval *vp)
+{
+	jsval *argv = JS_ARGV(cx, vp);
+	if (argc == 2) {
+		std::string key;
+		uint32_t capacity;
+		JSBool ok = jsval_to_std_string(cx, argv[0], &key);
+		ok &= jsval_to_uint32(cx, argv[1], &capacity);
+		JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
+
+		ObjectPool::getInstance()->setCapacity(key, capacity);
+		JS_SET_RVAL(cx, vp, JSVAL_VOID);
+		return JS_TRUE;
+	}
+	JS_ReportError(cx, "wrong number of arguments: %d, was expecting %d", argc, 2);
+	return JS_FALSE;
+}
+
+JSBool js_cocos2dx_ObjectPool_getCount(JSContext *cx, uint32_t argc, jsval *vp)
+{
+	jsval *argv = JS_ARGV(cx, vp);
+	if (argc == 1) {
+		std::string key;
+		JSBool ok = jsval_to_std_string(cx, argv[0], &key);
+		JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
+
+		JS_SET_RVAL(cx, vp, UINT_TO_JSVAL(ObjectPool::getInstance()->getCount(key)));
+		return JS_TRUE;
+	}
+	JS_ReportError(cx, "wrong number of arguments: %d, was expecting %d", argc, 1);
+	return JS_FALSE;
+}
+
+JSBool js_cocos2dx_ObjectPool_purge(JSContext *cx, uint32_t argc, jsval *vp)
+{
+	jsval *argv = JS_ARGV(cx, vp);
+	// without key, all the pools are purged
+	if (argc == 0) {
+		ObjectPool::getInstance()->purgeAll();
+	} else {
+		std::string key;
+		JSBool ok = jsval_to_std_string(cx, argv[0], &key);
+		JSB_PRECONDITION2(ok, cx, JS_FALSE, "Error processing arguments");
+		ObjectPool::getInstance()->purge(key);
+	}
+	JS_SET_RVAL(cx, vp, JSVAL_VOID);
+	return JS_TRUE;
+}
+
 JSBool js_cocos2dx_CCSet_constructor(JSContext *cx, uint32_t argc, jsval *vp)
 {
 	JSObject *obj;
@@ -3554,6 +3647,15 @@ void register_cocos2dx_js_extensions(JSContext* cx, JSObject* global)
     tmpObj = JSVAL_TO_OBJECT(anonEvaluate(cx, global, "(function () { return cc.LayerMultiplex; })()"));
     JS_DefineFunction(cx, tmpObj, "create", js_cocos2dx_CCLayerMultiplex_create, 0, JSPROP_READONLY | JSPROP_PERMANENT);
     
+	tmpObj = JS_NewObject(cx, NULL, NULL, NULL);
+	jsval poolVal = OBJECT_TO_JSVAL(tmpObj);
+	JS_SetProperty(cx, ns, "ObjectPool", &poolVal);
+	JS_DefineFunction(cx, tmpObj, "recycle", js_cocos2dx_ObjectPool_recycle, 2, JSPROP_READONLY | JSPROP_PERMANENT);
+	JS_DefineFunction(cx, tmpObj, "obtain", js_cocos2dx_ObjectPool_obtain, 1, JSPROP_READONLY | JSPROP_PERMANENT);
+	JS_DefineFunction(cx, tmpObj, "setCapacity", js_cocos2dx_ObjectPool_setCapacity, 2, JSPROP_READONLY | JSPROP_PERMANENT);
+	JS_DefineFunction(cx, tmpObj, "getCount", js_cocos2dx_ObjectPool_getCount, 1, JSPROP_READONLY | JSPROP_PERMANENT);
+	JS_DefineFunction(cx, tmpObj, "purge", js_cocos2dx_ObjectPool_purge, 0, JSPROP_READONLY | JSPROP_PERMANENT);
+
 	JS_DefineFunction(cx, ns, "registerTargettedDelegate", js_cocos2dx_JSTouchDelegate_registerTargettedDelegate, 1, JSPROP_READONLY | JSPROP_PERMANENT);
 	JS_DefineFunction(cx, ns, "registerStandardDelegate", js_cocos2dx_JSTouchDelegate_registerStandardDelegate, 1, JSPROP_READONLY | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "unregisterTouchDelegate", js_cocos2dx_JSTouchDelegate_unregisterTouchDelegate, 1, JSPROP_READONLY | JSPROP_PERMANENT);
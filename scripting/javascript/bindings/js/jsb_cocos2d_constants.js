@@ -116,9 +116,10 @@ cc.UNIFORM_MVP_MATRIX	= 0x2;
 cc.UNIFORM_P_MATRIX	= 0x0;
 cc.UNIFORM_RANDOM01	= 0x6;
 cc.UNIFORM_SAMPLER	= 0x7;
+cc.UNIFORM_SAMPLER1	= 0x8;
 cc.UNIFORM_SIN_TIME	= 0x4;
 cc.UNIFORM_TIME	= 0x3;
-cc.UNIFORM_MAX	= 0x8;
+cc.UNIFORM_MAX	= 0x9;
 cc.VERTEX_ATTRIB_FLAG_COLOR	= 0x2;
 cc.VERTEX_ATTRIB_FLAG_NONE	= 0x0;
 cc.VERTEX_ATTRIB_FLAG_POS_COLOR_TEX	= 0x7;
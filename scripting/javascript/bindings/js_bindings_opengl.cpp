@@ -1,6 +1,8 @@
 #include "js_bindings_opengl.h"
 
 void GLNode::draw() {
+  // the script issues gl calls directly
+  cocos2d::Director::getInstance()->getRenderer()->flush();
   js_proxy_t* proxy = NULL;
   JSContext *cx = ScriptingCore::getInstance()->getGlobalContext();
   proxy = js_get_or_create_proxy<cocos2d::Node>(cx, this);
@@ -75,6 +75,11 @@ void LuaEngine::removeScriptObjectByObject(Object* pObj)
     ScriptHandlerMgr::getInstance()->removeObjectAllHandlers(pObj);
 }
 
+void LuaEngine::removeScriptHandlersByObject(Object* pObj)
+{
+    ScriptHandlerMgr::getInstance()->removeObjectAllHandlers(pObj);
+}
+
 void LuaEngine::removeScriptHandler(int nHandler)
 {
     _stack->removeScriptHandler(nHandler);
@@ -372,6 +377,11 @@ int LuaEngine::handleScheduler(void* data)
     SchedulerScriptData* schedulerInfo = static_cast<SchedulerScriptData*>(data);
     
     _stack->pushFloat(schedulerInfo->elapse);
+    if (_eventBatchDepth > 0)
+    {
+        _stack->queueFunctionByHandler(schedulerInfo->handler, 1);
+        return 0;
+    }
     int ret = _stack->executeFunctionByHandler(schedulerInfo->handler, 1);
     _stack->clean();
     
@@ -504,6 +514,12 @@ int LuaEngine::handleTouchEvent(void* data)
         const Point pt = Director::getInstance()->convertToGL(touch->getLocationInView());
         _stack->pushFloat(pt.x);
         _stack->pushFloat(pt.y);
+        // the result of began decides whether the touch is claimed, it can't wait
+        if (_eventBatchDepth > 0 && CCTOUCHBEGAN != touchScriptData->actionType)
+        {
+            _stack->queueFunctionByHandler(handler, 3);
+            return 0;
+        }
         ret = _stack->executeFunctionByHandler(handler, 3);
     }
     _stack->clean();
@@ -563,12 +579,47 @@ int LuaEngine::handleTouchesEvent(void* data)
         lua_pushinteger(L, pTouch->getID());
         lua_rawseti(L, -2, i++);
     }
+    if (_eventBatchDepth > 0)
+    {
+        _stack->queueFunctionByHandler(handler, 2);
+        return 0;
+    }
     ret = _stack->executeFunctionByHandler(handler, 2);
 
     _stack->clean();
     return ret;
 }
 
+void LuaEngine::beginEventBatch()
+{
+    ++_eventBatchDepth;
+}
+
+void LuaEngine::endEventBatch()
+{
+    CCASSERT(_eventBatchDepth > 0, "endEventBatch without beginEventBatch");
+    if (--_eventBatchDepth == 0)
+    {
+        _stack->executeQueuedFunctions();
+        _stack->clean();
+    }
+}
+
+void LuaEngine::cancelQueuedEvents(int nHandler)
+{
+    _stack->cancelQueuedFunctions(nHandler);
+}
+
+void LuaEngine::collectGarbage(float budget)
+{
+    _stack->collectGarbage(budget);
+}
+
+void LuaEngine::resumeAutomaticGarbageCollection()
+{
+    _stack->resumeAutomaticGarbageCollection();
+}
+
 int LuaEngine::handlerControlEvent(void* data)
 {
     if ( NULL == data )
@@ -72,6 +72,11 @@ public:
      @param object to remove
      */
     virtual void removeScriptObjectByObject(Object* pObj);
+
+    /**
+     @brief Remove the handlers of ScriptHandlerMgr registered on an object, the object stays in the lua state
+     */
+    virtual void removeScriptHandlersByObject(Object* pObj);
     
     /**
      @brief Remove Lua function reference
@@ -120,10 +125,23 @@ public:
     virtual bool handleAssert(const char *msg);
     
     virtual int sendEvent(ScriptEvent* message);
+
+    /**
+     @brief The schedule and touch events whose result is not used are queued until the
+     outermost batch ends, then they are all dispatched in one call to Lua.
+     */
+    virtual void beginEventBatch();
+    virtual void endEventBatch();
+    virtual void cancelQueuedEvents(int nHandler);
+
+    virtual void collectGarbage(float budget);
+    virtual void resumeAutomaticGarbageCollection();
+
     void extendLuaObject();
 private:
     LuaEngine(void)
     : _stack(NULL)
+    , _eventBatchDepth(0)
     {
     }
     bool init(void);
@@ -149,6 +167,7 @@ private:
 private:
     static LuaEngine* _defaultEngine;
     LuaStack *_stack;
+    int _eventBatchDepth;
 };
 
 NS_CC_END
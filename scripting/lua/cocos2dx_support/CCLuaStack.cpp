@@ -34,6 +34,7 @@ extern "C" {
 
 #include "LuaCocos2d.h"
 #include "Cocos2dxLuaLoader.h"
+#include "LuaBundle.h"
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
 #include "platform/ios/CCLuaObjcBridge.h"
@@ -46,6 +47,8 @@ extern "C" {
 #include "LuaOpengl.h"
 #include "LuaScrollView.h"
 #include "LuaScriptHandlerMgr.h"
+#include "LuaFFI.h"
+#include "LuaObjectPool.h"
 
 namespace {
 int lua_print(lua_State * luastate)
@@ -133,6 +136,8 @@ bool LuaStack::init(void)
     tolua_opengl_open(_state);
     tolua_scroll_view_open(_state);
     tolua_script_handler_mgr_open(_state);
+    tolua_ffi_open(_state);
+    tolua_object_pool_open(_state);
     
     // add cocos2dx loader
     addLuaLoader(cocos2dx_lua_loader);
@@ -200,6 +205,19 @@ int LuaStack::executeString(const char *codes)
 
 int LuaStack::executeScriptFile(const char* filename)
 {
+    // the scripts of the bundles are compiled once, without looking for the files
+    int error = LuaBundle::getInstance()->loadChunk(_state, filename);
+    if (error == 0)
+    {
+        return executeFunction(0);
+    }
+    else if (error != -1)
+    {
+        CCLOG("[LUA ERROR] %s", lua_tostring(_state, -1));
+        lua_pop(_state, 1);
+        return error;
+    }
+
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
     std::string code("require \"");
     code.append(filename);
@@ -419,6 +437,196 @@ int LuaStack::executeFunctionByHandler(int nHandler, int numArgs)
     return ret;
 }
 
+// Makes the calls of a queue of LuaStack::queueFunctionByHandler.
+// events[0] is the index of the next call, so that the calls after a failing one can be made.
+static const char* s_queueDispatcherCode =
+    "local unpack = unpack\n"
+    "return function(events, count, mapping)\n"
+    "    local i = events[0]\n"
+    "    while i <= count do\n"
+    "        local f, n = mapping[events[i]], events[i + 1]\n"
+    "        local first = i + 2\n"
+    "        i = first + n\n"
+    "        events[0] = i\n"
+    "        if f then\n"
+    "            if n == 1 then\n"
+    "                f(events[first])\n"
+    "            elseif n == 2 then\n"
+    "                f(events[first], events[first + 1])\n"
+    "            elseif n == 3 then\n"
+    "                f(events[first], events[first + 1], events[first + 2])\n"
+    "            else\n"
+    "                f(unpack(events, first, i - 1))\n"
+    "            end\n"
+    "        end\n"
+    "    end\n"
+    "end\n";
+
+void LuaStack::queueFunctionByHandler(int nHandler, int numArgs)
+{
+    if (_queueRef == LUA_NOREF)
+    {
+        lua_newtable(_state);
+        lua_pushinteger(_state, 1);
+        lua_rawseti(_state, -2, 0);
+        _queueRef = luaL_ref(_state, LUA_REGISTRYINDEX);
+        _queueSize = 0;
+    }
+
+    lua_rawgeti(_state, LUA_REGISTRYINDEX, _queueRef);                 /* L: ... arg1 arg2 ... events */
+    lua_pushinteger(_state, nHandler);
+    lua_rawseti(_state, -2, ++_queueSize);
+    lua_pushinteger(_state, numArgs);
+    lua_rawseti(_state, -2, ++_queueSize);
+    for (int i = 1; i <= numArgs; ++i)
+    {
+        lua_pushvalue(_state, -(numArgs - i + 2));                     /* L: ... arg1 arg2 ... events argi */
+        lua_rawseti(_state, -2, ++_queueSize);
+    }
+    lua_pop(_state, numArgs + 1);                                      /* L: ... */
+}
+
+void LuaStack::executeQueuedFunctions(void)
+{
+    if (_queueRef == LUA_NOREF)
+    {
+        return;
+    }
+
+    // the handlers may queue calls, they go to a new queue
+    int queueRef = _queueRef;
+    int count = _queueSize;
+    int previousDispatchingQueueRef = _dispatchingQueueRef;
+    _queueRef = LUA_NOREF;
+    _queueSize = 0;
+    _dispatchingQueueRef = queueRef;
+
+    if (_dispatcherRef == LUA_NOREF)
+    {
+        if (luaL_loadbuffer(_state, s_queueDispatcherCode, strlen(s_queueDispatcherCode), "queued functions dispatcher") == 0
+            && lua_pcall(_state, 0, 1, 0) == 0)
+        {
+            _dispatcherRef = luaL_ref(_state, LUA_REGISTRYINDEX);
+        }
+        else
+        {
+            CCLOG("[LUA ERROR] %s", lua_tostring(_state, -1));
+            lua_pop(_state, 1);
+        }
+    }
+
+    int next = 1;
+    while (_dispatcherRef != LUA_NOREF && next <= count)
+    {
+        lua_rawgeti(_state, LUA_REGISTRYINDEX, _dispatcherRef);        /* L: ... dispatcher */
+        lua_rawgeti(_state, LUA_REGISTRYINDEX, queueRef);              /* L: ... dispatcher events */
+        lua_pushinteger(_state, count);                                /* L: ... dispatcher events count */
+        lua_pushstring(_state, TOLUA_REFID_FUNCTION_MAPPING);
+        lua_rawget(_state, LUA_REGISTRYINDEX);                         /* L: ... dispatcher events count mapping */
+        executeFunction(3);
+
+        // after an error, the dispatcher is called again for the calls after the failing one
+        lua_rawgeti(_state, LUA_REGISTRYINDEX, queueRef);              /* L: ... events */
+        lua_rawgeti(_state, -1, 0);                                    /* L: ... events next */
+        next = lua_tointeger(_state, -1);
+        lua_pop(_state, 2);                                            /* L: ... */
+    }
+
+    luaL_unref(_state, LUA_REGISTRYINDEX, queueRef);
+    _dispatchingQueueRef = previousDispatchingQueueRef;
+}
+
+void LuaStack::cancelQueuedFunctions(int nHandler)
+{
+    cancelHandlerInQueue(_queueRef, nHandler);
+    cancelHandlerInQueue(_dispatchingQueueRef, nHandler);
+}
+
+void LuaStack::cancelHandlerInQueue(int queueRef, int nHandler)
+{
+    if (queueRef == LUA_NOREF)
+    {
+        return;
+    }
+
+    lua_rawgeti(_state, LUA_REGISTRYINDEX, queueRef);                  /* L: ... events */
+    int i = 1;
+    for (;;)
+    {
+        lua_rawgeti(_state, -1, i);                                    /* L: ... events handler */
+        lua_rawgeti(_state, -2, i + 1);                                /* L: ... events handler n */
+        if (!lua_isnumber(_state, -2))
+        {
+            lua_pop(_state, 2);
+            break;
+        }
+        int handler = lua_tointeger(_state, -2);
+        int numArgs = lua_tointeger(_state, -1);
+        lua_pop(_state, 2);                                            /* L: ... events */
+        if (handler == nHandler)
+        {
+            // there is no function for the handler 0, the dispatcher skips the call
+            lua_pushinteger(_state, 0);
+            lua_rawseti(_state, -2, i);
+        }
+        i += 2 + numArgs;
+    }
+    lua_pop(_state, 1);                                                /* L: ... */
+}
+
+void LuaStack::collectGarbage(float budget)
+{
+    struct timeval start;
+    gettimeofday(&start, NULL);
+
+    int count = lua_gc(_state, LUA_GCCOUNT, 0);
+    if (!_gcStepped)
+    {
+        lua_gc(_state, LUA_GCSTOP, 0);
+        _gcStepped = true;
+        _gcSizeAfterCycle = count;
+    }
+
+    if (!_gcCycleRunning)
+    {
+        if (count < _gcSizeAfterCycle * 2)
+        {
+            return;
+        }
+        _gcCycleRunning = true;
+    }
+
+    bool overdue = count > _gcSizeAfterCycle * 4;
+    float elapsed = 0;
+    do
+    {
+        // one basic step, it returns 1 at the end of a cycle
+        if (lua_gc(_state, LUA_GCSTEP, 0))
+        {
+            _gcCycleRunning = false;
+            _gcSizeAfterCycle = lua_gc(_state, LUA_GCCOUNT, 0);
+            break;
+        }
+
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        elapsed = (now.tv_sec - start.tv_sec) + (now.tv_usec - start.tv_usec) / 1000000.0f;
+    } while (overdue || elapsed < budget);
+
+    // the steps set the threshold of the automatic collector again
+    lua_gc(_state, LUA_GCSTOP, 0);
+}
+
+void LuaStack::resumeAutomaticGarbageCollection(void)
+{
+    if (_gcStepped)
+    {
+        lua_gc(_state, LUA_GCRESTART, 0);
+        _gcStepped = false;
+        _gcCycleRunning = false;
+    }
+}
+
 bool LuaStack::handleAssert(const char *msg)
 {
     if (_callFromLua == 0) return false;
@@ -27,6 +27,7 @@
 
 extern "C" {
 #include "lua.h"
+#include "lauxlib.h"
 }
 
 #include "ccTypes.h"
@@ -114,20 +115,73 @@ public:
     
     virtual int executeFunctionByHandler(int nHandler, int numArgs);
 
+    /**
+     @brief Queue a call of a handler, with the numArgs values on the top of the stack as arguments.
+     The queued calls are made by executeQueuedFunctions, in one call into Lua.
+     */
+    virtual void queueFunctionByHandler(int nHandler, int numArgs);
+
+    /**
+     @brief Make the queued calls, in the order they were queued.
+     An error in a handler is reported like in executeFunction, and the next handlers are still called.
+     */
+    virtual void executeQueuedFunctions(void);
+
+    /**
+     @brief Drop the queued calls of a handler, when it is removed before they are made.
+     */
+    virtual void cancelQueuedFunctions(int nHandler);
+
+    /**
+     @brief Run incremental steps of the garbage collector for about budget seconds.
+     From the first call, the automatic collector is stopped: a cycle starts when the memory doubled
+     since the end of the last one, like with the default pause of Lua, and is carried by these steps.
+     The budget is exceeded only to finish a cycle when the memory grew 4 times, so that it stays bounded.
+     */
+    virtual void collectGarbage(float budget);
+
+    /**
+     @brief Restart the automatic collector, after collectGarbage.
+     */
+    virtual void resumeAutomaticGarbageCollection(void);
+
     virtual bool handleAssert(const char *msg);
     
 protected:
     LuaStack(void)
     : _state(NULL)
     , _callFromLua(0)
+    , _queueRef(LUA_NOREF)
+    , _queueSize(0)
+    , _dispatchingQueueRef(LUA_NOREF)
+    , _dispatcherRef(LUA_NOREF)
+    , _gcStepped(false)
+    , _gcCycleRunning(false)
+    , _gcSizeAfterCycle(0)
     {
     }
     
     bool init(void);
     bool initWithLuaState(lua_State *L);
     
+    void cancelHandlerInQueue(int queueRef, int nHandler);
+
     lua_State *_state;
     int _callFromLua;
+
+    // table of the queued calls: the handler, the number of arguments and the arguments of each call
+    int _queueRef;
+    int _queueSize;
+    // the queue being dispatched, the handlers may queue calls in a new one
+    int _dispatchingQueueRef;
+    // Lua function making the calls of a queue
+    int _dispatcherRef;
+
+    // whether the collector runs only in collectGarbage
+    bool _gcStepped;
+    bool _gcCycleRunning;
+    // KB in use at the end of the last cycle
+    int _gcSizeAfterCycle;
 };
 
 NS_CC_END
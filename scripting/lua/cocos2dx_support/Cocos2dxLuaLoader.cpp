@@ -22,6 +22,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 #include "Cocos2dxLuaLoader.h"
+#include "LuaBundle.h"
 #include <string>
 #include <algorithm>
 
@@ -45,6 +46,17 @@ extern "C"
             pos = filename.find_first_of(".");
         }
         filename.append(".lua");
+
+        int error = LuaBundle::getInstance()->loadChunk(L, filename.c_str());
+        if (error != -1)
+        {
+            if (error != 0)
+            {
+                luaL_error(L, "error loading module %s from bundle %s :\n\t%s",
+                    lua_tostring(L, 1), filename.c_str(), lua_tostring(L, -1));
+            }
+            return 1;
+        }
         
         unsigned long codeBufferSize = 0;
         unsigned char* codeBuffer = FileUtils::getInstance()->getFileData(filename.c_str(), "rb", &codeBufferSize);
@@ -0,0 +1,200 @@
+#include "LuaBundle.h"
+#include "platform/CCFileUtils.h"
+#include <string.h>
+
+extern "C" {
+#include "lauxlib.h"
+}
+
+NS_CC_BEGIN
+
+// Layout of a .cclb file, see tools/lua_bundle/lua2cclb.py. All values are little endian.
+//   Header
+//   entryCount x BundleEntry
+//   strings: '\0' terminated names, referenced by their offset in the string table
+//   data: the scripts, referenced by their offset in the file
+
+struct BundleHeader
+{
+    char magic[4];
+    unsigned int version;
+    unsigned int entryCount;
+    unsigned int stringTableSize;
+};
+
+struct BundleEntry
+{
+    unsigned int nameOffset;
+    unsigned int dataOffset;
+    unsigned int dataSize;
+};
+
+static const char BUNDLE_MAGIC[4] = { 'C', 'C', 'L', 'B' };
+static const unsigned int BUNDLE_VERSION = 1;
+
+// registry key of the table of the compiled chunks, [0] is the generation of the bundles
+#define LUA_BUNDLE_CHUNK_CACHE "cocos2dx_lua_bundle_chunk_cache"
+
+LuaBundle* LuaBundle::s_sharedLuaBundle = NULL;
+
+LuaBundle* LuaBundle::getInstance(void)
+{
+    if (s_sharedLuaBundle == NULL)
+    {
+        s_sharedLuaBundle = new LuaBundle();
+    }
+    return s_sharedLuaBundle;
+}
+
+void LuaBundle::destroyInstance(void)
+{
+    CC_SAFE_DELETE(s_sharedLuaBundle);
+}
+
+LuaBundle::LuaBundle(void)
+: _generation(0)
+{
+}
+
+LuaBundle::~LuaBundle(void)
+{
+    removeAllBundles();
+}
+
+bool LuaBundle::addBundle(const char* filename)
+{
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
+    MappedFile* file = FileUtils::getInstance()->getMappedFileData(fullPath.c_str());
+    if (file == NULL)
+    {
+        CCLOG("LuaBundle: can not open %s", filename);
+        return false;
+    }
+
+    const unsigned char* data = file->getBytes();
+    unsigned long size = file->getSize();
+    const BundleHeader* header = reinterpret_cast<const BundleHeader*>(data);
+    if (size < sizeof(BundleHeader)
+        || memcmp(header->magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0
+        || header->version != BUNDLE_VERSION
+        || header->entryCount > (size - sizeof(BundleHeader)) / sizeof(BundleEntry)
+        || header->stringTableSize > size - sizeof(BundleHeader) - header->entryCount * sizeof(BundleEntry))
+    {
+        CCLOG("LuaBundle: %s is not a valid bundle", filename);
+        return false;
+    }
+
+    const BundleEntry* entries = reinterpret_cast<const BundleEntry*>(data + sizeof(BundleHeader));
+    const char* strings = reinterpret_cast<const char*>(entries + header->entryCount);
+
+    Bundle* bundle = new Bundle();
+    bundle->chunks.reserve(header->entryCount);
+    for (unsigned int i = 0; i < header->entryCount; ++i)
+    {
+        const BundleEntry& entry = entries[i];
+        if (entry.nameOffset >= header->stringTableSize
+            || memchr(strings + entry.nameOffset, '\0', header->stringTableSize - entry.nameOffset) == NULL
+            || entry.dataOffset > size || entry.dataSize > size - entry.dataOffset)
+        {
+            CCLOG("LuaBundle: %s is corrupted", filename);
+            delete bundle;
+            return false;
+        }
+        bundle->chunks[strings + entry.nameOffset] = std::make_pair(entry.dataOffset, entry.dataSize);
+    }
+
+    file->retain();
+    bundle->file = file;
+    _bundles.insert(_bundles.begin(), bundle);
+    ++_generation;
+    return true;
+}
+
+void LuaBundle::removeAllBundles(void)
+{
+    for (auto it = _bundles.begin(); it != _bundles.end(); ++it)
+    {
+        (*it)->file->release();
+        delete *it;
+    }
+    _bundles.clear();
+    ++_generation;
+}
+
+bool LuaBundle::findChunk(const char* name, const unsigned char** data, unsigned long* size) const
+{
+    if (_bundles.empty())
+    {
+        return false;
+    }
+
+    std::string key(name);
+    for (auto it = _bundles.begin(); it != _bundles.end(); ++it)
+    {
+        auto chunk = (*it)->chunks.find(key);
+        if (chunk != (*it)->chunks.end())
+        {
+            *data = (*it)->file->getBytes() + chunk->second.first;
+            *size = chunk->second.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LuaBundle::hasChunk(const char* name) const
+{
+    const unsigned char* data;
+    unsigned long size;
+    return findChunk(name, &data, &size);
+}
+
+int LuaBundle::loadChunk(lua_State* L, const char* name)
+{
+    const unsigned char* data;
+    unsigned long size;
+    if (!findChunk(name, &data, &size))
+    {
+        return -1;
+    }
+
+    lua_pushstring(L, LUA_BUNDLE_CHUNK_CACHE);
+    lua_rawget(L, LUA_REGISTRYINDEX);                                  /* L: ... cache */
+    bool valid = false;
+    if (lua_istable(L, -1))
+    {
+        lua_rawgeti(L, -1, 0);                                         /* L: ... cache generation */
+        valid = (unsigned int)lua_tonumber(L, -1) == _generation;
+        lua_pop(L, 1);                                                 /* L: ... cache */
+    }
+    if (!valid)
+    {
+        lua_pop(L, 1);                                                 /* L: ... */
+        lua_newtable(L);                                               /* L: ... cache */
+        lua_pushnumber(L, _generation);
+        lua_rawseti(L, -2, 0);
+        lua_pushstring(L, LUA_BUNDLE_CHUNK_CACHE);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+    }
+
+    lua_getfield(L, -1, name);                                         /* L: ... cache chunk */
+    if (lua_isfunction(L, -1))
+    {
+        lua_remove(L, -2);                                             /* L: ... chunk */
+        return 0;
+    }
+    lua_pop(L, 1);                                                     /* L: ... cache */
+
+    // luaL_loadbuffer takes the source and the bytecode
+    int error = luaL_loadbuffer(L, (const char*)data, size, name);     /* L: ... cache chunk|error */
+    if (error == 0)
+    {
+        lua_pushvalue(L, -1);
+        lua_setfield(L, -3, name);
+    }
+    lua_remove(L, -2);                                                 /* L: ... chunk|error */
+    return error;
+}
+
+NS_CC_END
@@ -0,0 +1,75 @@
+#ifndef __LUA_BUNDLE_H__
+#define __LUA_BUNDLE_H__
+
+extern "C" {
+#include "lua.h"
+}
+
+#include "ccMacros.h"
+#include "platform/CCMappedFile.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+NS_CC_BEGIN
+
+/**
+ * Scripts packed in .cclb bundles by tools/lua_bundle/lua2cclb.py, as source or as
+ * precompiled Lua/LuaJIT bytecode.
+ * The bundles are read with FileUtils::getMappedFileData, so they are mapped in memory
+ * when the platform allows it. The cocos2dx loader of require and
+ * LuaStack::executeScriptFile look for the scripts in the bundles before the file system.
+ */
+class LuaBundle
+{
+public:
+    static LuaBundle* getInstance(void);
+    static void destroyInstance(void);
+
+    /**
+     @brief Adds a bundle, its scripts are found before the ones of the bundles added before.
+     @param filename path of the .cclb file, resolved by FileUtils
+     */
+    bool addBundle(const char* filename);
+
+    /** Removes the bundles. */
+    void removeAllBundles(void);
+
+    /**
+     @brief Whether a bundle has a script.
+     @param name path of the script relative to the packed directory, like "game/main.lua"
+     */
+    bool hasChunk(const char* name) const;
+
+    /**
+     @brief Pushes the function of a script of the bundles. The compiled chunks are cached
+     in the registry of the Lua state until the bundles change, so that they are loaded once.
+     @return -1 when no bundle has the script, otherwise the result of luaL_loadbuffer,
+     with the error message pushed when it isn't 0
+     */
+    int loadChunk(lua_State* L, const char* name);
+
+private:
+    struct Bundle
+    {
+        MappedFile* file;
+        /* name -> offset and size of the data */
+        std::unordered_map<std::string, std::pair<unsigned int, unsigned int> > chunks;
+    };
+
+    LuaBundle(void);
+    ~LuaBundle(void);
+
+    bool findChunk(const char* name, const unsigned char** data, unsigned long* size) const;
+
+    /* the bundles added last are first */
+    std::vector<Bundle*> _bundles;
+    /* changes with the bundles, the caches of the chunks of another generation are dropped */
+    unsigned int _generation;
+
+    static LuaBundle* s_sharedLuaBundle;
+};
+
+NS_CC_END
+
+#endif // __LUA_BUNDLE_H__
@@ -429,7 +429,7 @@ static void tolua_reg_types (lua_State* tolua_S)
  tolua_usertype(tolua_S,"CCMotionStreak");
  tolua_usertype(tolua_S,"CCAnimate");
  tolua_usertype(tolua_S,"CCTiledGrid3DAction");
- tolua_usertype(tolua_S,"std::vector<Point*>");
+ tolua_usertype(tolua_S,"std::vector<Point>");
  tolua_usertype(tolua_S,"CCPointArray");
  tolua_usertype(tolua_S,"CCTransitionProgressHorizontal");
  tolua_usertype(tolua_S,"CCTextureCache");
@@ -588,7 +588,6 @@ static void tolua_reg_types (lua_State* tolua_S)
  tolua_usertype(tolua_S,"CCTransitionSlideInL");
  tolua_usertype(tolua_S,"CCTransitionFlipX");
  tolua_usertype(tolua_S,"CCRepeat");
- tolua_usertype(tolua_S,"tParticle");
  tolua_usertype(tolua_S,"CCTransitionProgressInOut");
  tolua_usertype(tolua_S,"CCLayerRGBA");
  tolua_usertype(tolua_S,"CCMenu");
@@ -4869,9 +4868,7 @@ static int tolua_Cocos2d_CCPoint__sub00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->operator-(*right);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -4913,9 +4910,7 @@ static int tolua_Cocos2d_CCPoint__add00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->operator+(*right);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -4957,9 +4952,7 @@ static int tolua_Cocos2d_CCPoint__mul00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->operator*(a);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5001,9 +4994,7 @@ static int tolua_Cocos2d_CCPoint_getMidpoint00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getMidpoint(*other);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5111,9 +5102,7 @@ static int tolua_Cocos2d_CCPoint_getPerp00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getPerp();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5153,9 +5142,7 @@ static int tolua_Cocos2d_CCPoint_getRPerp00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getRPerp();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5197,9 +5184,7 @@ static int tolua_Cocos2d_CCPoint_project00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->project(*other);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5241,9 +5226,7 @@ static int tolua_Cocos2d_CCPoint_rotate00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->rotate(*other);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5285,9 +5268,7 @@ static int tolua_Cocos2d_CCPoint_unrotate00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->unrotate(*other);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5425,9 +5406,7 @@ static int tolua_Cocos2d_CCPoint_normalize00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->normalize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5503,9 +5482,7 @@ static int tolua_Cocos2d_CCPoint_getClampPoint00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getClampPoint(*min_inclusive,*max_inclusive);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5549,9 +5526,7 @@ static int tolua_Cocos2d_CCPoint_lerp00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->lerp(*other,alpha);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5631,9 +5606,7 @@ static int tolua_Cocos2d_CCPoint_rotateByAngle00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->rotateByAngle(*pivot,angle);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5789,9 +5762,7 @@ static int tolua_Cocos2d_CCPoint_getIntersectPoint00(lua_State* tolua_S)
    Point tolua_ret = (Point)  Point::getIntersectPoint(*A,*B,*C,*D);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -5829,9 +5800,7 @@ static int tolua_Cocos2d_CCPoint_forAngle00(lua_State* tolua_S)
    Point tolua_ret = (Point)  Point::forAngle(a);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -8492,9 +8461,7 @@ static int tolua_Cocos2d_CCEGLViewProtocol_getVisibleSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getVisibleSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -8534,9 +8501,7 @@ static int tolua_Cocos2d_CCEGLViewProtocol_getVisibleOrigin00(lua_State* tolua_S
    Point tolua_ret = (Point)  self->getVisibleOrigin();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -9964,9 +9929,7 @@ static int tolua_Cocos2d___CCPointApplyAffineTransform00(lua_State* tolua_S)
    Point tolua_ret = (Point)  __CCPointApplyAffineTransform(point,t);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -10005,9 +9968,7 @@ static int tolua_Cocos2d_CCPointApplyAffineTransform00(lua_State* tolua_S)
    Point tolua_ret = (Point)  PointApplyAffineTransform(point,t);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -10046,9 +10007,7 @@ static int tolua_Cocos2d_CCSizeApplyAffineTransform00(lua_State* tolua_S)
    Size tolua_ret = (Size)  SizeApplyAffineTransform(size,t);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -10087,9 +10046,7 @@ static int tolua_Cocos2d___CCSizeApplyAffineTransform00(lua_State* tolua_S)
    Size tolua_ret = (Size)  __CCSizeApplyAffineTransform(size,t);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -10165,9 +10122,7 @@ static int tolua_Cocos2d_CCRectApplyAffineTransform00(lua_State* tolua_S)
    Rect tolua_ret = (Rect)  RectApplyAffineTransform(rect,anAffineTransform);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Rect)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Rect),"CCRect");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Rect));
      tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
@@ -10858,9 +10813,7 @@ static int tolua_Cocos2d_CCDirector_getWinSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getWinSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -10900,9 +10853,7 @@ static int tolua_Cocos2d_CCDirector_getWinSizeInPixels00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getWinSizeInPixels();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -10944,9 +10895,7 @@ static int tolua_Cocos2d_CCDirector_convertToGL00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->convertToGL(obPoint);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -10988,9 +10937,7 @@ static int tolua_Cocos2d_CCDirector_convertToUI00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->convertToUI(obPoint);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -11679,9 +11626,7 @@ static int tolua_Cocos2d_CCDirector_getVisibleSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getVisibleSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -11721,9 +11666,7 @@ static int tolua_Cocos2d_CCDirector_getVisibleOrigin00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getVisibleOrigin();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -13824,9 +13767,7 @@ static int tolua_Cocos2d_CCNode_getAnchorPoint00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getAnchorPoint();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -13899,9 +13840,7 @@ static int tolua_Cocos2d_CCNode_getContentSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getContentSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -14036,7 +13975,12 @@ static int tolua_Cocos2d_CCNode_getChildren00(lua_State* tolua_S)
   if (!self) tolua_error(tolua_S,"invalid 'self' in function 'getChildren'", NULL);
 #endif
   {
-   Array* tolua_ret = (Array*)  self->getChildren();
+   // the children are a Vector<Node*>, the scripts get a copy of them in an Array
+   Array* tolua_ret = Array::createWithCapacity(self->getChildrenCount());
+   for (auto child : self->getChildren())
+   {
+    tolua_ret->addObject(child);
+   }
     int nID = (tolua_ret) ? (int)tolua_ret->_ID : -1;
     int* pLuaID = (tolua_ret) ? &tolua_ret->_luaID : NULL;
     toluafix_pushusertype_ccobject(tolua_S, nID, pLuaID, (void*)tolua_ret,"CCArray");
@@ -14204,9 +14148,7 @@ static int tolua_Cocos2d_CCNode_getAnchorPointInPoints00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getAnchorPointInPoints();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -15279,9 +15221,7 @@ static int tolua_Cocos2d_CCNode_getBoundingBox00(lua_State* tolua_S)
    Rect tolua_ret = (Rect)  self->getBoundingBox();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Rect)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Rect),"CCRect");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Rect));
      tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
@@ -15760,9 +15700,7 @@ static int tolua_Cocos2d_CCNode_convertToNodeSpace00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->convertToNodeSpace(worldPoint);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -15804,9 +15742,7 @@ static int tolua_Cocos2d_CCNode_convertToWorldSpace00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->convertToWorldSpace(nodePoint);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -15848,9 +15784,7 @@ static int tolua_Cocos2d_CCNode_convertToNodeSpaceAR00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->convertToNodeSpaceAR(worldPoint);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -15892,9 +15826,7 @@ static int tolua_Cocos2d_CCNode_convertToWorldSpaceAR00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->convertToWorldSpaceAR(nodePoint);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -15936,9 +15868,7 @@ static int tolua_Cocos2d_CCNode_convertTouchToNodeSpace00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->convertTouchToNodeSpace(touch);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -15980,9 +15910,7 @@ static int tolua_Cocos2d_CCNode_convertTouchToNodeSpaceAR00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->convertTouchToNodeSpaceAR(touch);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -17150,9 +17078,7 @@ static int tolua_Cocos2d_CCTexture2D_getContentSizeInPixels00(lua_State* tolua_S
    Size tolua_ret = (Size)  self->getContentSizeInPixels();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -17452,9 +17378,7 @@ static int tolua_Cocos2d_CCTexture2D_getContentSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getContentSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -19506,9 +19430,7 @@ static int tolua_Cocos2d_CCSprite_getTextureRect00(lua_State* tolua_S)
    Rect tolua_ret = (Rect)  self->getTextureRect();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Rect)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Rect),"CCRect");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Rect));
      tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
@@ -22205,9 +22127,7 @@ static int tolua_Cocos2d_CCSpriteFrame_getRectInPixels00(lua_State* tolua_S)
    Rect tolua_ret = (Rect)  self->getRectInPixels();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Rect)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Rect),"CCRect");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Rect));
      tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
@@ -22345,9 +22265,7 @@ static int tolua_Cocos2d_CCSpriteFrame_getRect00(lua_State* tolua_S)
    Rect tolua_ret = (Rect)  self->getRect();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Rect)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Rect),"CCRect");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Rect));
      tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
@@ -22420,9 +22338,7 @@ static int tolua_Cocos2d_CCSpriteFrame_getOffsetInPixels00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getOffsetInPixels();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -22495,9 +22411,7 @@ static int tolua_Cocos2d_CCSpriteFrame_getOriginalSizeInPixels00(lua_State* tolu
    Size tolua_ret = (Size)  self->getOriginalSizeInPixels();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -25041,9 +24955,7 @@ static int tolua_Cocos2d_CCLayerGradient_getVector00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getVector();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -30526,9 +30438,7 @@ static int tolua_Cocos2d_CCPointArray_getControlPointAtIndex00(lua_State* tolua_
    Point tolua_ret = (Point)  self->getControlPointAtIndex(index);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -30693,8 +30603,8 @@ static int tolua_Cocos2d_CCPointArray_getControlPoints00(lua_State* tolua_S)
   if (!self) tolua_error(tolua_S,"invalid 'self' in function 'getControlPoints'", NULL);
 #endif
   {
-   const std::vector<Point*>* tolua_ret = (const std::vector<Point*>*)  self->getControlPoints();
-    tolua_pushusertype(tolua_S,(void*)tolua_ret,"const std::vector<Point*>");
+   const std::vector<Point>* tolua_ret = (const std::vector<Point>*)  &self->getControlPoints();
+    tolua_pushusertype(tolua_S,(void*)tolua_ret,"const std::vector<Point>");
   }
  }
  return 1;
@@ -30714,7 +30624,7 @@ static int tolua_Cocos2d_CCPointArray_setControlPoints00(lua_State* tolua_S)
  tolua_Error tolua_err;
  if (
      !tolua_isusertype(tolua_S,1,"CCPointArray",0,&tolua_err) ||
-     !tolua_isusertype(tolua_S,2,"std::vector<Point*>",0,&tolua_err) ||
+     !tolua_isusertype(tolua_S,2,"std::vector<Point>",0,&tolua_err) ||
      !tolua_isnoobj(tolua_S,3,&tolua_err)
  )
   goto tolua_lerror;
@@ -30722,12 +30632,12 @@ static int tolua_Cocos2d_CCPointArray_setControlPoints00(lua_State* tolua_S)
 #endif
  {
   PointArray* self = (PointArray*)  tolua_tousertype(tolua_S,1,0);
-  std::vector<Point*>* controlPoints = ((std::vector<Point*>*)  tolua_tousertype(tolua_S,2,0));
+  const std::vector<Point>* controlPoints = ((const std::vector<Point>*)  tolua_tousertype(tolua_S,2,0));
 #ifndef TOLUA_RELEASE
   if (!self) tolua_error(tolua_S,"invalid 'self' in function 'setControlPoints'", NULL);
 #endif
   {
-   self->setControlPoints(controlPoints);
+   self->setControlPoints(*controlPoints);
   }
  }
  return 0;
@@ -33575,9 +33485,7 @@ static int tolua_Cocos2d_CCLens3D_getPosition00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getPosition();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -33686,9 +33594,7 @@ static int tolua_Cocos2d_CCRipple3D_getPosition00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getPosition();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -34303,9 +34209,7 @@ static int tolua_Cocos2d_CCTwirl_getPosition00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getPosition();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -34758,9 +34662,7 @@ static int tolua_Cocos2d_CCShuffleTiles_getDelta00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getDelta(pos);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -40270,9 +40172,7 @@ static int tolua_Cocos2d_CCLabelTTF_getDimensions00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getDimensions();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -41236,9 +41136,7 @@ static int tolua_Cocos2d_CCMenuItem_rect00(lua_State* tolua_S)
    Rect tolua_ret = (Rect)  self->rect();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Rect)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Rect),"CCRect");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Rect));
      tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
@@ -44824,39 +44722,6 @@ static int tolua_Cocos2d_CCParticleSystem_addParticle00(lua_State* tolua_S)
 }
 #endif //#ifndef TOLUA_DISABLE
 
-/* method: initParticle of class  ParticleSystem */
-#ifndef TOLUA_DISABLE_tolua_Cocos2d_CCParticleSystem_initParticle00
-static int tolua_Cocos2d_CCParticleSystem_initParticle00(lua_State* tolua_S)
-{
-#ifndef TOLUA_RELEASE
- tolua_Error tolua_err;
- if (
-     !tolua_isusertype(tolua_S,1,"CCParticleSystem",0,&tolua_err) ||
-     !tolua_isusertype(tolua_S,2,"tParticle",0,&tolua_err) ||
-     !tolua_isnoobj(tolua_S,3,&tolua_err)
- )
-  goto tolua_lerror;
- else
-#endif
- {
-  ParticleSystem* self = (ParticleSystem*)  tolua_tousertype(tolua_S,1,0);
-  tParticle* particle = ((tParticle*)  tolua_tousertype(tolua_S,2,0));
-#ifndef TOLUA_RELEASE
-  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'initParticle'", NULL);
-#endif
-  {
-   self->initParticle(particle);
-  }
- }
- return 0;
-#ifndef TOLUA_RELEASE
- tolua_lerror:
- tolua_error(tolua_S,"#ferror in function 'initParticle'.",&tolua_err);
- return 0;
-#endif
-}
-#endif //#ifndef TOLUA_DISABLE
-
 /* method: stopSystem of class  ParticleSystem */
 #ifndef TOLUA_DISABLE_tolua_Cocos2d_CCParticleSystem_stopSystem00
 static int tolua_Cocos2d_CCParticleSystem_stopSystem00(lua_State* tolua_S)
@@ -44951,41 +44816,6 @@ static int tolua_Cocos2d_CCParticleSystem_isFull00(lua_State* tolua_S)
 }
 #endif //#ifndef TOLUA_DISABLE
 
-/* method: updateQuadWithParticle of class  ParticleSystem */
-#ifndef TOLUA_DISABLE_tolua_Cocos2d_CCParticleSystem_updateQuadWithParticle00
-static int tolua_Cocos2d_CCParticleSystem_updateQuadWithParticle00(lua_State* tolua_S)
-{
-#ifndef TOLUA_RELEASE
- tolua_Error tolua_err;
- if (
-     !tolua_isusertype(tolua_S,1,"CCParticleSystem",0,&tolua_err) ||
-     !tolua_isusertype(tolua_S,2,"tParticle",0,&tolua_err) ||
-     (tolua_isvaluenil(tolua_S,3,&tolua_err) || !tolua_isusertype(tolua_S,3,"const CCPoint",0,&tolua_err)) ||
-     !tolua_isnoobj(tolua_S,4,&tolua_err)
- )
-  goto tolua_lerror;
- else
-#endif
- {
-  ParticleSystem* self = (ParticleSystem*)  tolua_tousertype(tolua_S,1,0);
-  tParticle* particle = ((tParticle*)  tolua_tousertype(tolua_S,2,0));
-  const Point* newPosition = ((const Point*)  tolua_tousertype(tolua_S,3,0));
-#ifndef TOLUA_RELEASE
-  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'updateQuadWithParticle'", NULL);
-#endif
-  {
-   self->updateQuadWithParticle(particle,*newPosition);
-  }
- }
- return 0;
-#ifndef TOLUA_RELEASE
- tolua_lerror:
- tolua_error(tolua_S,"#ferror in function 'updateQuadWithParticle'.",&tolua_err);
- return 0;
-#endif
-}
-#endif //#ifndef TOLUA_DISABLE
-
 /* method: postStep of class  ParticleSystem */
 #ifndef TOLUA_DISABLE_tolua_Cocos2d_CCParticleSystem_postStep00
 static int tolua_Cocos2d_CCParticleSystem_postStep00(lua_State* tolua_S)
@@ -45136,9 +44966,7 @@ static int tolua_Cocos2d_CCParticleSystem_getSourcePosition00(lua_State* tolua_S
    Point tolua_ret = (Point)  self->getSourcePosition();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -45211,9 +45039,7 @@ static int tolua_Cocos2d_CCParticleSystem_getPosVar00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getPosVar();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -47393,41 +47219,6 @@ static int tolua_Cocos2d_CCParticleSystemQuad_setTotalParticles00(lua_State* tol
 }
 #endif //#ifndef TOLUA_DISABLE
 
-/* method: updateQuadWithParticle of class  ParticleSystemQuad */
-#ifndef TOLUA_DISABLE_tolua_Cocos2d_CCParticleSystemQuad_updateQuadWithParticle00
-static int tolua_Cocos2d_CCParticleSystemQuad_updateQuadWithParticle00(lua_State* tolua_S)
-{
-#ifndef TOLUA_RELEASE
- tolua_Error tolua_err;
- if (
-     !tolua_isusertype(tolua_S,1,"CCParticleSystemQuad",0,&tolua_err) ||
-     !tolua_isusertype(tolua_S,2,"tParticle",0,&tolua_err) ||
-     (tolua_isvaluenil(tolua_S,3,&tolua_err) || !tolua_isusertype(tolua_S,3,"const CCPoint",0,&tolua_err)) ||
-     !tolua_isnoobj(tolua_S,4,&tolua_err)
- )
-  goto tolua_lerror;
- else
-#endif
- {
-  ParticleSystemQuad* self = (ParticleSystemQuad*)  tolua_tousertype(tolua_S,1,0);
-  tParticle* particle = ((tParticle*)  tolua_tousertype(tolua_S,2,0));
-  const Point* newPosition = ((const Point*)  tolua_tousertype(tolua_S,3,0));
-#ifndef TOLUA_RELEASE
-  if (!self) tolua_error(tolua_S,"invalid 'self' in function 'updateQuadWithParticle'", NULL);
-#endif
-  {
-   self->updateQuadWithParticle(particle,*newPosition);
-  }
- }
- return 0;
-#ifndef TOLUA_RELEASE
- tolua_lerror:
- tolua_error(tolua_S,"#ferror in function 'updateQuadWithParticle'.",&tolua_err);
- return 0;
-#endif
-}
-#endif //#ifndef TOLUA_DISABLE
-
 /* method: postStep of class  ParticleSystemQuad */
 #ifndef TOLUA_DISABLE_tolua_Cocos2d_CCParticleSystemQuad_postStep01
 static int tolua_Cocos2d_CCParticleSystemQuad_postStep01(lua_State* tolua_S)
@@ -48899,9 +48690,7 @@ static int tolua_Cocos2d_CCProgressTimer_getMidpoint00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getMidpoint();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -48974,9 +48763,7 @@ static int tolua_Cocos2d_CCProgressTimer_getBarChangeRate00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getBarChangeRate();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -49667,9 +49454,7 @@ static int tolua_Cocos2d_CCTMXLayer_getLayerSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getLayerSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -49742,9 +49527,7 @@ static int tolua_Cocos2d_CCTMXLayer_getMapTileSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getMapTileSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -50252,9 +50035,7 @@ static int tolua_Cocos2d_CCTMXLayer_getPositionAt00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getPositionAt(tileCoordinate);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -50495,9 +50276,7 @@ static int tolua_Cocos2d_CCTMXObjectGroup_getPositionOffset00(lua_State* tolua_S
    Point tolua_ret = (Point)  self->getPositionOffset();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -50841,9 +50620,7 @@ static int tolua_Cocos2d_CCTMXTiledMap_getMapSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getMapSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -50916,9 +50693,7 @@ static int tolua_Cocos2d_CCTMXTiledMap_getTileSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getTileSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -51436,9 +51211,7 @@ static int tolua_Cocos2d_CCTMXTilesetInfo_rectForGID00(lua_State* tolua_S)
    Rect tolua_ret = (Rect)  self->rectForGID(gid);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Rect)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Rect),"CCRect");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Rect));
      tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
@@ -51576,9 +51349,7 @@ static int tolua_Cocos2d_CCTMXMapInfo_getMapSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getMapSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -51651,9 +51422,7 @@ static int tolua_Cocos2d_CCTMXMapInfo_getTileSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getTileSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -52662,9 +52431,7 @@ static int tolua_Cocos2d_CCTouch_getLocation00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getLocation();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -52704,9 +52471,7 @@ static int tolua_Cocos2d_CCTouch_getPreviousLocation00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getPreviousLocation();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -52746,9 +52511,7 @@ static int tolua_Cocos2d_CCTouch_getDelta00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getDelta();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -52788,9 +52551,7 @@ static int tolua_Cocos2d_CCTouch_getLocationInView00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getLocationInView();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -52830,9 +52591,7 @@ static int tolua_Cocos2d_CCTouch_getPreviousLocationInView00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getPreviousLocationInView();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -53972,9 +53731,7 @@ static int tolua_Cocos2d_CCScale9Sprite_getOriginalSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getOriginalSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -54014,9 +53771,7 @@ static int tolua_Cocos2d_CCScale9Sprite_getPreferredSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getPreferredSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -54089,9 +53844,7 @@ static int tolua_Cocos2d_CCScale9Sprite_getCapInsets00(lua_State* tolua_S)
    Rect tolua_ret = (Rect)  self->getCapInsets();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Rect)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Rect),"CCRect");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Rect));
      tolua_pushusertype(tolua_S,tolua_obj,"CCRect");
@@ -56039,9 +55792,7 @@ static int tolua_Cocos2d_CCControl_getTouchLocation00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->getTouchLocation(touch);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -56600,9 +56351,7 @@ static int tolua_Cocos2d_CCControlButton_getPreferredSize00(lua_State* tolua_S)
    Size tolua_ret = (Size)  self->getPreferredSize();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Size));
      tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -56740,9 +56489,7 @@ static int tolua_Cocos2d_CCControlButton_getLabelAnchorPoint00(lua_State* tolua_
    Point tolua_ret = (Point)  self->getLabelAnchorPoint();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -58503,9 +58250,7 @@ static int tolua_Cocos2d_CCControlSlider_locationFromTouch00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->locationFromTouch(touch);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -59993,9 +59738,7 @@ static int tolua_Cocos2d_CCControlSwitch_locationFromTouch00(lua_State* tolua_S)
    Point tolua_ret = (Point)  self->locationFromTouch(touch);
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -60842,9 +60585,7 @@ static int tolua_Cocos2d_CCControlPotentiometer_getPreviousLocation00(lua_State*
    Point tolua_ret = (Point)  self->getPreviousLocation();
    {
 #ifdef __cplusplus
-    void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-     tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-    tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+    tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
     void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(Point));
      tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -66085,11 +65826,9 @@ TOLUA_API int tolua_Cocos2d_open (lua_State* tolua_S)
    tolua_function(tolua_S,"getRotatePerSecondVar",tolua_Cocos2d_CCParticleSystem_getRotatePerSecondVar00);
    tolua_function(tolua_S,"setRotatePerSecondVar",tolua_Cocos2d_CCParticleSystem_setRotatePerSecondVar00);
    tolua_function(tolua_S,"addParticle",tolua_Cocos2d_CCParticleSystem_addParticle00);
-   tolua_function(tolua_S,"initParticle",tolua_Cocos2d_CCParticleSystem_initParticle00);
    tolua_function(tolua_S,"stopSystem",tolua_Cocos2d_CCParticleSystem_stopSystem00);
    tolua_function(tolua_S,"resetSystem",tolua_Cocos2d_CCParticleSystem_resetSystem00);
    tolua_function(tolua_S,"isFull",tolua_Cocos2d_CCParticleSystem_isFull00);
-   tolua_function(tolua_S,"updateQuadWithParticle",tolua_Cocos2d_CCParticleSystem_updateQuadWithParticle00);
    tolua_function(tolua_S,"postStep",tolua_Cocos2d_CCParticleSystem_postStep00);
    tolua_function(tolua_S,"getParticleCount",tolua_Cocos2d_CCParticleSystem_getParticleCount00);
    tolua_function(tolua_S,"getDuration",tolua_Cocos2d_CCParticleSystem_getDuration00);
@@ -66171,7 +65910,6 @@ TOLUA_API int tolua_Cocos2d_open (lua_State* tolua_S)
    tolua_function(tolua_S,"setTextureWithRect",tolua_Cocos2d_CCParticleSystemQuad_setTextureWithRect00);
    tolua_function(tolua_S,"setBatchNode",tolua_Cocos2d_CCParticleSystemQuad_setBatchNode00);
    tolua_function(tolua_S,"setTotalParticles",tolua_Cocos2d_CCParticleSystemQuad_setTotalParticles00);
-   tolua_function(tolua_S,"updateQuadWithParticle",tolua_Cocos2d_CCParticleSystemQuad_updateQuadWithParticle00);
    tolua_function(tolua_S,"postStep",tolua_Cocos2d_CCParticleSystemQuad_postStep01);
    tolua_function(tolua_S,"setTotalParticles",tolua_Cocos2d_CCParticleSystemQuad_setTotalParticles01);
    tolua_function(tolua_S,"create",tolua_Cocos2d_CCParticleSystemQuad_create00);
@@ -0,0 +1,135 @@
+#include "LuaFFI.h"
+#include "cocos2d.h"
+
+using namespace cocos2d;
+
+// The handles are the pointers pushed by tolua, which are pointers to the most derived
+// classes: like the tolua bindings, it relies on Node being their first base.
+
+static float nodeGetPositionX(void* node)
+{
+    return static_cast<Node*>(node)->getPositionX();
+}
+
+static float nodeGetPositionY(void* node)
+{
+    return static_cast<Node*>(node)->getPositionY();
+}
+
+static void nodeSetPosition(void* node, float x, float y)
+{
+    static_cast<Node*>(node)->setPosition(x, y);
+}
+
+static float nodeGetRotation(void* node)
+{
+    return static_cast<Node*>(node)->getRotation();
+}
+
+static void nodeSetRotation(void* node, float rotation)
+{
+    static_cast<Node*>(node)->setRotation(rotation);
+}
+
+static float nodeGetScaleX(void* node)
+{
+    return static_cast<Node*>(node)->getScaleX();
+}
+
+static float nodeGetScaleY(void* node)
+{
+    return static_cast<Node*>(node)->getScaleY();
+}
+
+static void nodeSetScale(void* node, float scaleX, float scaleY)
+{
+    Node* n = static_cast<Node*>(node);
+    n->setScaleX(scaleX);
+    n->setScaleY(scaleY);
+}
+
+static bool nodeIsVisible(void* node)
+{
+    return static_cast<Node*>(node)->isVisible();
+}
+
+static void nodeSetVisible(void* node, bool visible)
+{
+    static_cast<Node*>(node)->setVisible(visible);
+}
+
+static void nodeConvertToWorldSpace(void* node, float x, float y, float* out)
+{
+    Point p = static_cast<Node*>(node)->convertToWorldSpace(Point(x, y));
+    out[0] = p.x;
+    out[1] = p.y;
+}
+
+static void nodeConvertToNodeSpace(void* node, float x, float y, float* out)
+{
+    Point p = static_cast<Node*>(node)->convertToNodeSpace(Point(x, y));
+    out[0] = p.x;
+    out[1] = p.y;
+}
+
+static void rgbaSetColor(void* node, unsigned char r, unsigned char g, unsigned char b)
+{
+    RGBAProtocol* rgba = dynamic_cast<RGBAProtocol*>(static_cast<Node*>(node));
+    CCASSERT(rgba, "the node must implement RGBAProtocol");
+    rgba->setColor(Color3B(r, g, b));
+}
+
+static unsigned char rgbaGetOpacity(void* node)
+{
+    RGBAProtocol* rgba = dynamic_cast<RGBAProtocol*>(static_cast<Node*>(node));
+    CCASSERT(rgba, "the node must implement RGBAProtocol");
+    return rgba->getOpacity();
+}
+
+static void rgbaSetOpacity(void* node, unsigned char opacity)
+{
+    RGBAProtocol* rgba = dynamic_cast<RGBAProtocol*>(static_cast<Node*>(node));
+    CCASSERT(rgba, "the node must implement RGBAProtocol");
+    rgba->setOpacity(opacity);
+}
+
+static float schedulerGetTimeScale()
+{
+    return Director::getInstance()->getScheduler()->getTimeScale();
+}
+
+static void schedulerSetTimeScale(float timeScale)
+{
+    Director::getInstance()->getScheduler()->setTimeScale(timeScale);
+}
+
+static LuaFFIApi s_api = {
+    LUA_FFI_API_VERSION,
+
+    nodeGetPositionX,
+    nodeGetPositionY,
+    nodeSetPosition,
+    nodeGetRotation,
+    nodeSetRotation,
+    nodeGetScaleX,
+    nodeGetScaleY,
+    nodeSetScale,
+    nodeIsVisible,
+    nodeSetVisible,
+    nodeConvertToWorldSpace,
+    nodeConvertToNodeSpace,
+
+    rgbaSetColor,
+    rgbaGetOpacity,
+    rgbaSetOpacity,
+
+    schedulerGetTimeScale,
+    schedulerSetTimeScale,
+};
+
+TOLUA_API int tolua_ffi_open(lua_State* tolua_S)
+{
+    lua_pushlightuserdata(tolua_S, &s_api);
+    lua_setglobal(tolua_S, "__cc_ffi_api");
+    return 0;
+}
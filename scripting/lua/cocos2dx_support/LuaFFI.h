@@ -0,0 +1,52 @@
+#ifndef __LUA_FFI_H__
+#define __LUA_FFI_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "tolua++.h"
+#ifdef __cplusplus
+}
+#endif
+
+/** Version of the LuaFFIApi layout, checked by CocosFFI.lua. Increase it when the structure changes. */
+#define LUA_FFI_API_VERSION    1
+
+/**
+ * Functions of the engine that LuaJIT calls through its FFI, without the stack marshalling
+ * of tolua, so that the traces of the scripts can compile the calls.
+ * The handles are the native pointers of the objects, see CocosFFI.lua; the structure is
+ * declared again with ffi.cdef in that script, in the same order.
+ */
+struct LuaFFIApi
+{
+    int version;
+
+    /* Node */
+    float (*nodeGetPositionX)(void* node);
+    float (*nodeGetPositionY)(void* node);
+    void (*nodeSetPosition)(void* node, float x, float y);
+    float (*nodeGetRotation)(void* node);
+    void (*nodeSetRotation)(void* node, float rotation);
+    float (*nodeGetScaleX)(void* node);
+    float (*nodeGetScaleY)(void* node);
+    void (*nodeSetScale)(void* node, float scaleX, float scaleY);
+    bool (*nodeIsVisible)(void* node);
+    void (*nodeSetVisible)(void* node, bool visible);
+    void (*nodeConvertToWorldSpace)(void* node, float x, float y, float* out);
+    void (*nodeConvertToNodeSpace)(void* node, float x, float y, float* out);
+
+    /* RGBAProtocol, like Sprite, the labels and LayerColor */
+    void (*rgbaSetColor)(void* node, unsigned char r, unsigned char g, unsigned char b);
+    unsigned char (*rgbaGetOpacity)(void* node);
+    void (*rgbaSetOpacity)(void* node, unsigned char opacity);
+
+    /* Scheduler */
+    float (*schedulerGetTimeScale)();
+    void (*schedulerSetTimeScale)(float timeScale);
+};
+
+/** Sets the global __cc_ffi_api to the address of the LuaFFIApi, as a light userdata. */
+TOLUA_API int tolua_ffi_open(lua_State* tolua_S);
+
+#endif //__LUA_FFI_H__
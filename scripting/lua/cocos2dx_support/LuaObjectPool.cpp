@@ -0,0 +1,232 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "tolua_fix.h"
+#ifdef __cplusplus
+}
+#endif
+
+#include "LuaObjectPool.h"
+#include "cocos2d.h"
+
+using namespace cocos2d;
+
+/* the type the object was first pushed with, kept by toluafix until it is deleted */
+static const char* getPushedType(lua_State* tolua_S, Object* object)
+{
+    const char* type = "CCObject";
+    if (object->_luaID == 0)
+    {
+        return type;
+    }
+
+    lua_pushstring(tolua_S, TOLUA_REFID_TYPE_MAPPING);
+    lua_rawget(tolua_S, LUA_REGISTRYINDEX);                            /* stack: refid_type */
+    lua_pushinteger(tolua_S, object->_luaID);
+    lua_rawget(tolua_S, -2);                                           /* stack: refid_type type */
+    if (lua_isstring(tolua_S, -1))
+    {
+        // the string stays referenced by the mapping once popped
+        type = lua_tostring(tolua_S, -1);
+    }
+    lua_pop(tolua_S, 2);
+    return type;
+}
+
+/* method: getInstance of class ObjectPool */
+static int tolua_Cocos2d_ObjectPool_getInstance00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+    tolua_Error tolua_err;
+    if (!tolua_isusertable(tolua_S,1,"CCObjectPool",0,&tolua_err) ||
+        !tolua_isnoobj(tolua_S,2,&tolua_err) )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        ObjectPool* tolua_ret = (ObjectPool*)  ObjectPool::getInstance();
+        tolua_pushusertype(tolua_S,(void*)tolua_ret,"CCObjectPool");
+    }
+    return 1;
+#ifndef TOLUA_RELEASE
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'getInstance'.",&tolua_err);
+    return 0;
+#endif
+}
+
+/* method: recycle of class ObjectPool */
+static int tolua_Cocos2d_ObjectPool_recycle00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"CCObjectPool",0,&tolua_err) ||
+        !tolua_isusertype(tolua_S,2,"CCObject",0,&tolua_err) ||
+        !tolua_isstring(tolua_S,3,0,&tolua_err) ||
+        !tolua_isnoobj(tolua_S,4,&tolua_err) )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        ObjectPool* self = (ObjectPool*)  tolua_tousertype(tolua_S,1,0);
+        Object* object = ((Object*)  tolua_tousertype(tolua_S,2,0));
+        const char* key = ((const char*)  tolua_tostring(tolua_S,3,0));
+#ifndef TOLUA_RELEASE
+        if (!self || !object) tolua_error(tolua_S,"invalid 'self' or 'object' in function 'recycle'", NULL);
+#endif
+        bool tolua_ret = self->recycle(object, key);
+        tolua_pushboolean(tolua_S,(bool)tolua_ret);
+    }
+    return 1;
+#ifndef TOLUA_RELEASE
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'recycle'.",&tolua_err);
+    return 0;
+#endif
+}
+
+/* method: obtain of class ObjectPool */
+static int tolua_Cocos2d_ObjectPool_obtain00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"CCObjectPool",0,&tolua_err) ||
+        !tolua_isstring(tolua_S,2,0,&tolua_err) ||
+        !tolua_isnoobj(tolua_S,3,&tolua_err) )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        ObjectPool* self = (ObjectPool*)  tolua_tousertype(tolua_S,1,0);
+        const char* key = ((const char*)  tolua_tostring(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+        if (!self) tolua_error(tolua_S,"invalid 'self' in function 'obtain'", NULL);
+#endif
+        Object* tolua_ret = self->obtain(key);
+        if (tolua_ret)
+        {
+            // the nodes and the actions have Object as their first base, so it is the pointer tolua pushed
+            toluafix_pushusertype_ccobject(tolua_S, (int)tolua_ret->_ID, &tolua_ret->_luaID, (void*)tolua_ret, getPushedType(tolua_S, tolua_ret));
+        }
+        else
+        {
+            lua_pushnil(tolua_S);
+        }
+    }
+    return 1;
+#ifndef TOLUA_RELEASE
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'obtain'.",&tolua_err);
+    return 0;
+#endif
+}
+
+/* method: setCapacity of class ObjectPool */
+static int tolua_Cocos2d_ObjectPool_setCapacity00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"CCObjectPool",0,&tolua_err) ||
+        !tolua_isstring(tolua_S,2,0,&tolua_err) ||
+        !tolua_isnumber(tolua_S,3,0,&tolua_err) ||
+        !tolua_isnoobj(tolua_S,4,&tolua_err) )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        ObjectPool* self = (ObjectPool*)  tolua_tousertype(tolua_S,1,0);
+        const char* key = ((const char*)  tolua_tostring(tolua_S,2,0));
+        unsigned int capacity = ((unsigned int)  tolua_tonumber(tolua_S,3,0));
+#ifndef TOLUA_RELEASE
+        if (!self) tolua_error(tolua_S,"invalid 'self' in function 'setCapacity'", NULL);
+#endif
+        self->setCapacity(key, capacity);
+    }
+    return 0;
+#ifndef TOLUA_RELEASE
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'setCapacity'.",&tolua_err);
+    return 0;
+#endif
+}
+
+/* method: getCount of class ObjectPool */
+static int tolua_Cocos2d_ObjectPool_getCount00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"CCObjectPool",0,&tolua_err) ||
+        !tolua_isstring(tolua_S,2,0,&tolua_err) ||
+        !tolua_isnoobj(tolua_S,3,&tolua_err) )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        ObjectPool* self = (ObjectPool*)  tolua_tousertype(tolua_S,1,0);
+        const char* key = ((const char*)  tolua_tostring(tolua_S,2,0));
+#ifndef TOLUA_RELEASE
+        if (!self) tolua_error(tolua_S,"invalid 'self' in function 'getCount'", NULL);
+#endif
+        unsigned int tolua_ret = self->getCount(key);
+        tolua_pushnumber(tolua_S,(lua_Number)tolua_ret);
+    }
+    return 1;
+#ifndef TOLUA_RELEASE
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'getCount'.",&tolua_err);
+    return 0;
+#endif
+}
+
+/* method: purge of class ObjectPool */
+static int tolua_Cocos2d_ObjectPool_purge00(lua_State* tolua_S)
+{
+#ifndef TOLUA_RELEASE
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"CCObjectPool",0,&tolua_err) ||
+        !tolua_isstring(tolua_S,2,1,&tolua_err) ||
+        !tolua_isnoobj(tolua_S,3,&tolua_err) )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        ObjectPool* self = (ObjectPool*)  tolua_tousertype(tolua_S,1,0);
+#ifndef TOLUA_RELEASE
+        if (!self) tolua_error(tolua_S,"invalid 'self' in function 'purge'", NULL);
+#endif
+        // without key, all the pools are purged
+        if (lua_isnoneornil(tolua_S, 2))
+        {
+            self->purgeAll();
+        }
+        else
+        {
+            self->purge(tolua_tostring(tolua_S,2,0));
+        }
+    }
+    return 0;
+#ifndef TOLUA_RELEASE
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'purge'.",&tolua_err);
+    return 0;
+#endif
+}
+
+TOLUA_API int tolua_object_pool_open(lua_State* tolua_S)
+{
+    tolua_open(tolua_S);
+    tolua_usertype(tolua_S, "CCObjectPool");
+    tolua_module(tolua_S, NULL,0);
+    tolua_beginmodule(tolua_S, NULL);
+      tolua_cclass(tolua_S,"CCObjectPool","CCObjectPool","",NULL);
+      tolua_beginmodule(tolua_S, "CCObjectPool");
+        tolua_function(tolua_S, "getInstance", tolua_Cocos2d_ObjectPool_getInstance00);
+        tolua_function(tolua_S, "recycle", tolua_Cocos2d_ObjectPool_recycle00);
+        tolua_function(tolua_S, "obtain", tolua_Cocos2d_ObjectPool_obtain00);
+        tolua_function(tolua_S, "setCapacity", tolua_Cocos2d_ObjectPool_setCapacity00);
+        tolua_function(tolua_S, "getCount", tolua_Cocos2d_ObjectPool_getCount00);
+        tolua_function(tolua_S, "purge", tolua_Cocos2d_ObjectPool_purge00);
+      tolua_endmodule(tolua_S);
+    tolua_endmodule(tolua_S);
+    return 1;
+}
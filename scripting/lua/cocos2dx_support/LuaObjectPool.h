@@ -0,0 +1,24 @@
+#ifndef __LUA_OBJECT_POOL_H__
+#define __LUA_OBJECT_POOL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "tolua++.h"
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * Binds the ObjectPool as CCObjectPool:
+ *
+ *     local pool = CCObjectPool:getInstance()
+ *     pool:recycle(bullet, "bullet")          -- false when the pool is full
+ *     local sprite = pool:obtain("bullet")    -- nil when the pool is empty
+ *
+ * The objects obtained are pushed with the type they were first pushed with, like CCSprite,
+ * and the userdata still referenced by the scripts is reused.
+ */
+TOLUA_API int tolua_object_pool_open(lua_State* tolua_S);
+
+#endif //__LUA_OBJECT_POOL_H__
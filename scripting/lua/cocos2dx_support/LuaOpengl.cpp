@@ -23,6 +23,8 @@ using namespace cocos2d::extension;
     
 void GLNode::draw()
 {
+    // the script issues gl calls directly
+    Director::getInstance()->getRenderer()->flush();
     int handler = ScriptHandlerMgr::getInstance()->getObjectHandler((void*)this, ScriptHandlerMgr::kGLNodeDrawHandler);
     if (0 != handler)
     {
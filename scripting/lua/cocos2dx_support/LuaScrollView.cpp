@@ -1055,9 +1055,7 @@ static int tolua_Cocos2d_ScrollView_getContentOffset00(lua_State* tolua_S)
             Point tolua_ret = (Point)  self->getContentOffset();
             {
 #ifdef __cplusplus
-                void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-                tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-                tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+                tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
                 void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(CCPoint));
                 tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -1196,9 +1194,7 @@ static int tolua_Cocos2d_ScrollView_getViewSize00(lua_State* tolua_S)
             Size tolua_ret = (Size)  self->getViewSize();
             {
 #ifdef __cplusplus
-                void* tolua_obj = Mtolua_new((Size)(tolua_ret));
-                tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
-                tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+                tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Size),"CCSize");
 #else
                 void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(CCSize));
                 tolua_pushusertype(tolua_S,tolua_obj,"CCSize");
@@ -1238,9 +1234,7 @@ static int tolua_Cocos2d_ScrollView_maxContainerOffset00(lua_State* tolua_S)
             Point tolua_ret = (Point)  self->maxContainerOffset();
             {
 #ifdef __cplusplus
-                void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-                tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-                tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+                tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
                 void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(CCPoint));
                 tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
@@ -1414,9 +1408,7 @@ static int tolua_Cocos2d_ScrollView_minContainerOffset00(lua_State* tolua_S)
             Point tolua_ret = (Point)  self->minContainerOffset();
             {
 #ifdef __cplusplus
-                void* tolua_obj = Mtolua_new((Point)(tolua_ret));
-                tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
-                tolua_register_gc(tolua_S,lua_gettop(tolua_S));
+                tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof(Point),"CCPoint");
 #else
                 void* tolua_obj = tolua_copy(tolua_S,(void*)&tolua_ret,sizeof(CCPoint));
                 tolua_pushusertype(tolua_S,tolua_obj,"CCPoint");
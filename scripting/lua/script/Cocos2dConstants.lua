@@ -111,9 +111,10 @@ CCConstants.UNIFORM_MVP_MATRIX   = 0x2
 CCConstants.UNIFORM_P_MATRIX = 0x0
 CCConstants.UNIFORM_RANDOM01 = 0x6
 CCConstants.UNIFORM_SAMPLER  = 0x7
+CCConstants.UNIFORM_SAMPLER1 = 0x8
 CCConstants.UNIFORM_SIN_TIME = 0x4
 CCConstants.UNIFORM_TIME = 0x3
-CCConstants.UNIFORM_MAX  = 0x8
+CCConstants.UNIFORM_MAX  = 0x9
 CCConstants.VERTEX_ATTRIB_FLAG_COLOR = 0x2
 CCConstants.VERTEX_ATTRIB_FLAG_NONE  = 0x0
 CCConstants.VERTEX_ATTRIB_FLAG_POS_COLOR_TEX = 0x7
@@ -0,0 +1,215 @@
+--[[
+Direct calls to the hot functions of the engine, and point and rect math, for LuaJIT.
+
+    local ccffi = require "CocosFFI"
+    local h = ccffi.handle(sprite)      -- the sprite must stay alive while h is used
+    ccffi.setPosition(h, x, y)
+    local p = ccffi.p(1, 2) + ccffi.p(3, 4)
+
+With LuaJIT the functions call the engine through the FFI and the points and rects are
+C structures, so the traces of the scripts compile them instead of stopping at the tolua
+bindings. With plain Lua they use the tolua bindings and tables, so the scripts run the same.
+]]
+
+local M = {}
+
+local API_VERSION = 1
+
+local hasFFI, ffi = pcall(require, "ffi")
+hasFFI = hasFFI and __cc_ffi_api ~= nil
+
+local new_point, new_rect
+
+--------------------------------
+-- point and rect math
+--------------------------------
+
+local point_mt = {}
+point_mt.__index = point_mt
+
+point_mt.__add = function(a, b) return new_point(a.x + b.x, a.y + b.y) end
+point_mt.__sub = function(a, b) return new_point(a.x - b.x, a.y - b.y) end
+point_mt.__unm = function(a) return new_point(-a.x, -a.y) end
+point_mt.__mul = function(a, s) return new_point(a.x * s, a.y * s) end
+point_mt.__eq = function(a, b)
+    if rawequal(a, nil) or rawequal(b, nil) then return false end
+    return a.x == b.x and a.y == b.y
+end
+point_mt.__tostring = function(a) return string.format("(%g, %g)", a.x, a.y) end
+
+function point_mt.dot(a, b) return a.x * b.x + a.y * b.y end
+function point_mt.cross(a, b) return a.x * b.y - a.y * b.x end
+function point_mt.lengthSquared(a) return a.x * a.x + a.y * a.y end
+function point_mt.length(a) return math.sqrt(a.x * a.x + a.y * a.y) end
+
+function point_mt.distance(a, b)
+    local dx, dy = a.x - b.x, a.y - b.y
+    return math.sqrt(dx * dx + dy * dy)
+end
+
+function point_mt.normalize(a)
+    local len = math.sqrt(a.x * a.x + a.y * a.y)
+    if len == 0 then return new_point(1, 0) end
+    return new_point(a.x / len, a.y / len)
+end
+
+function point_mt.lerp(a, b, t)
+    return new_point(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t)
+end
+
+local rect_mt = {}
+rect_mt.__index = rect_mt
+
+rect_mt.__eq = function(a, b)
+    if rawequal(a, nil) or rawequal(b, nil) then return false end
+    return a.x == b.x and a.y == b.y and a.width == b.width and a.height == b.height
+end
+rect_mt.__tostring = function(r)
+    return string.format("(%g, %g, %g, %g)", r.x, r.y, r.width, r.height)
+end
+
+function rect_mt.getMinX(r) return r.x end
+function rect_mt.getMidX(r) return r.x + r.width * 0.5 end
+function rect_mt.getMaxX(r) return r.x + r.width end
+function rect_mt.getMinY(r) return r.y end
+function rect_mt.getMidY(r) return r.y + r.height * 0.5 end
+function rect_mt.getMaxY(r) return r.y + r.height end
+
+function rect_mt.containsPoint(r, p)
+    return p.x >= r.x and p.x <= r.x + r.width and p.y >= r.y and p.y <= r.y + r.height
+end
+
+function rect_mt.intersectsRect(a, b)
+    return not (a.x + a.width < b.x or b.x + b.width < a.x or
+                a.y + a.height < b.y or b.y + b.height < a.y)
+end
+
+--------------------------------
+-- engine functions
+--------------------------------
+
+if hasFFI then
+    -- the declarations of LuaFFI.h, in the same order
+    if not pcall(ffi.typeof, "cc_ffi_api") then
+        ffi.cdef[[
+            typedef struct { float x, y; } cc_point;
+            typedef struct { float x, y, width, height; } cc_rect;
+            typedef struct {
+                int version;
+
+                float (*nodeGetPositionX)(void* node);
+                float (*nodeGetPositionY)(void* node);
+                void (*nodeSetPosition)(void* node, float x, float y);
+                float (*nodeGetRotation)(void* node);
+                void (*nodeSetRotation)(void* node, float rotation);
+                float (*nodeGetScaleX)(void* node);
+                float (*nodeGetScaleY)(void* node);
+                void (*nodeSetScale)(void* node, float scaleX, float scaleY);
+                bool (*nodeIsVisible)(void* node);
+                void (*nodeSetVisible)(void* node, bool visible);
+                void (*nodeConvertToWorldSpace)(void* node, float x, float y, float* out);
+                void (*nodeConvertToNodeSpace)(void* node, float x, float y, float* out);
+
+                void (*rgbaSetColor)(void* node, unsigned char r, unsigned char g, unsigned char b);
+                unsigned char (*rgbaGetOpacity)(void* node);
+                void (*rgbaSetOpacity)(void* node, unsigned char opacity);
+
+                float (*schedulerGetTimeScale)();
+                void (*schedulerSetTimeScale)(float timeScale);
+            } cc_ffi_api;
+        ]]
+    end
+
+    local api = ffi.cast("cc_ffi_api*", __cc_ffi_api)
+    assert(api.version == API_VERSION, "CocosFFI.lua doesn't match the LuaFFIApi of the engine")
+
+    local point_ct = ffi.metatype("cc_point", point_mt)
+    local rect_ct = ffi.metatype("cc_rect", rect_mt)
+    new_point = function(x, y) return point_ct(x, y) end
+    new_rect = function(x, y, width, height) return rect_ct(x, y, width, height) end
+
+    local voidpp = ffi.typeof("void**")
+    local out = ffi.new("float[2]")
+
+    -- the native pointer of a tolua object
+    function M.handle(obj)
+        if type(obj) == "table" then obj = obj[".c_instance"] end
+        return ffi.cast(voidpp, obj)[0]
+    end
+
+    function M.getPosition(h) return api.nodeGetPositionX(h), api.nodeGetPositionY(h) end
+    function M.setPosition(h, x, y) api.nodeSetPosition(h, x, y) end
+    function M.getRotation(h) return api.nodeGetRotation(h) end
+    function M.setRotation(h, rotation) api.nodeSetRotation(h, rotation) end
+    function M.getScale(h) return api.nodeGetScaleX(h), api.nodeGetScaleY(h) end
+    function M.setScale(h, scaleX, scaleY) api.nodeSetScale(h, scaleX, scaleY or scaleX) end
+    function M.isVisible(h) return api.nodeIsVisible(h) end
+    function M.setVisible(h, visible) api.nodeSetVisible(h, visible) end
+
+    function M.convertToWorldSpace(h, x, y)
+        api.nodeConvertToWorldSpace(h, x, y, out)
+        return out[0], out[1]
+    end
+
+    function M.convertToNodeSpace(h, x, y)
+        api.nodeConvertToNodeSpace(h, x, y, out)
+        return out[0], out[1]
+    end
+
+    function M.setColor(h, r, g, b) api.rgbaSetColor(h, r, g, b) end
+    function M.getOpacity(h) return api.rgbaGetOpacity(h) end
+    function M.setOpacity(h, opacity) api.rgbaSetOpacity(h, opacity) end
+
+    function M.getTimeScale() return api.schedulerGetTimeScale() end
+    function M.setTimeScale(timeScale) api.schedulerSetTimeScale(timeScale) end
+else
+    new_point = function(x, y) return setmetatable({ x = x, y = y }, point_mt) end
+    new_rect = function(x, y, width, height)
+        return setmetatable({ x = x, y = y, width = width, height = height }, rect_mt)
+    end
+
+    -- without the FFI, the handles are the tolua objects themselves
+    function M.handle(obj) return obj end
+
+    function M.getPosition(h) return h:getPositionX(), h:getPositionY() end
+    function M.setPosition(h, x, y) h:setPosition(x, y) end
+    function M.getRotation(h) return h:getRotation() end
+    function M.setRotation(h, rotation) h:setRotation(rotation) end
+    function M.getScale(h) return h:getScaleX(), h:getScaleY() end
+    function M.setScale(h, scaleX, scaleY)
+        h:setScaleX(scaleX)
+        h:setScaleY(scaleY or scaleX)
+    end
+    function M.isVisible(h) return h:isVisible() end
+    function M.setVisible(h, visible) h:setVisible(visible) end
+
+    function M.convertToWorldSpace(h, x, y)
+        local p = h:convertToWorldSpace(CCPoint(x, y))
+        return p.x, p.y
+    end
+
+    function M.convertToNodeSpace(h, x, y)
+        local p = h:convertToNodeSpace(CCPoint(x, y))
+        return p.x, p.y
+    end
+
+    function M.setColor(h, r, g, b) h:setColor(Color3B(r, g, b)) end
+    function M.getOpacity(h) return h:getOpacity() end
+    function M.setOpacity(h, opacity) h:setOpacity(opacity) end
+
+    function M.getTimeScale() return CCDirector:getInstance():getScheduler():getTimeScale() end
+    function M.setTimeScale(timeScale) CCDirector:getInstance():getScheduler():setTimeScale(timeScale) end
+end
+
+M.hasFFI = hasFFI
+
+function M.p(x, y) return new_point(x or 0, y or 0) end
+function M.rect(x, y, width, height) return new_rect(x or 0, y or 0, width or 0, height or 0) end
+
+-- conversions from and to the tolua CCPoint and CCRect
+function M.fromCCPoint(p) return new_point(p.x, p.y) end
+function M.toCCPoint(p) return CCPoint(p.x, p.y) end
+function M.fromCCRect(r) return new_rect(r.origin.x, r.origin.y, r.size.width, r.size.height) end
+function M.toCCRect(r) return CCRect(r.x, r.y, r.width, r.height) end
+
+return M
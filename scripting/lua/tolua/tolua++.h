@@ -84,6 +84,7 @@ TOLUA_API int tolua_isusertypearray
 (lua_State* L, int lo, const char* type, int dim, int def, tolua_Error* err);
 
 TOLUA_API void tolua_open (lua_State* L);
+TOLUA_API void tolua_cleartypecache (void);
 
 TOLUA_API void* tolua_copy (lua_State* L, void* value, unsigned int size);
 TOLUA_API int tolua_register_gc (lua_State* L, int lo);
@@ -110,6 +111,7 @@ TOLUA_API void tolua_pushstring (lua_State* L, const char* value);
 TOLUA_API void tolua_pushuserdata (lua_State* L, void* value);
 TOLUA_API void tolua_pushusertype (lua_State* L, void* value, const char* type);
 TOLUA_API void tolua_pushusertype_and_takeownership(lua_State* L, void* value, const char* type);
+TOLUA_API void tolua_pushusertype_value (lua_State* L, const void* value, unsigned int size, const char* type);
 TOLUA_API void tolua_pushfieldvalue (lua_State* L, int lo, int index, int v);
 TOLUA_API void tolua_pushfieldboolean (lua_State* L, int lo, int index, int v);
 TOLUA_API void tolua_pushfieldnumber (lua_State* L, int lo, int index, lua_Number v);
@@ -160,14 +160,30 @@ int push_table_instance(lua_State* L, int lo) {
     return 0;
 };
 
-/* the equivalent of lua_is* for usertype */
-static int lua_isusertype (lua_State* L, int lo, const char* type)
+/* cache of the answers of lua_isusertype, so that the bindings don't look up the
+   type names in the registry on every call. An entry maps a metatable and the hash
+   of a type name to the answer; it is cleared when the class hierarchy changes. */
+#define TOLUA_TYPECACHE_SIZE        512
+#define TOLUA_TYPECACHE_NAME_LEN    64
+
+typedef struct tolua_TypeCacheEntry
+{
+    const void* mt;
+    unsigned int hash;
+    int result;
+    char name[TOLUA_TYPECACHE_NAME_LEN];
+} tolua_TypeCacheEntry;
+
+static tolua_TypeCacheEntry tolua_typecache[TOLUA_TYPECACHE_SIZE];
+
+TOLUA_API void tolua_cleartypecache (void)
+{
+    memset(tolua_typecache, 0, sizeof(tolua_typecache));
+}
+
+/* the equivalent of lua_is* for usertype, without the cache */
+static int lua_isusertype_nocache (lua_State* L, int lo, const char* type)
 {
-    if (!lua_isuserdata(L,lo)) {
-        if (!push_table_instance(L, lo)) {
-            return 0;
-        };
-    };
     {
         /* check if it is of the same type */
         int r;
@@ -203,6 +219,46 @@ static int lua_isusertype (lua_State* L, int lo, const char* type)
     return 0;
 }
 
+/* the equivalent of lua_is* for usertype */
+static int lua_isusertype (lua_State* L, int lo, const char* type)
+{
+    const void* mt;
+    const char* c;
+    unsigned int hash = 2166136261u;
+    size_t len;
+    tolua_TypeCacheEntry* entry;
+
+    if (!lua_isuserdata(L,lo)) {
+        if (!push_table_instance(L, lo)) {
+            return 0;
+        };
+    };
+    if (!lua_getmetatable(L,lo))
+        return 0;
+    mt = lua_topointer(L,-1);
+    lua_pop(L,1);
+
+    for (c = type; *c; ++c)
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    len = c - type;
+
+    entry = &tolua_typecache[(hash ^ (unsigned int)((size_t)mt >> 4)) & (TOLUA_TYPECACHE_SIZE - 1)];
+    if (entry->mt == mt && entry->hash == hash && strcmp(entry->name,type) == 0)
+        return entry->result;
+
+    {
+        int r = lua_isusertype_nocache(L,lo,type);
+        if (len < TOLUA_TYPECACHE_NAME_LEN)
+        {
+            entry->mt = mt;
+            entry->hash = hash;
+            entry->result = r;
+            memcpy(entry->name,type,len+1);
+        }
+        return r;
+    }
+}
+
 TOLUA_API int tolua_isnoobj (lua_State* L, int lo, tolua_Error* err)
 {
     if (lua_gettop(L)<abs(lo))
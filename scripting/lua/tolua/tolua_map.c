@@ -48,6 +48,9 @@ static int tolua_newmetatable (lua_State* L, const char* name)
 */
 static void mapsuper (lua_State* L, const char* name, const char* base)
 {
+    /* the answers of tolua_isusertype may change */
+    tolua_cleartypecache();
+
     /* push registry.super */
     lua_pushstring(L,"tolua_super");
     lua_rawget(L,LUA_REGISTRYINDEX);    /* stack: super */
@@ -297,6 +300,8 @@ static int tolua_bnd_getpeer(lua_State* L) {
 TOLUA_API void tolua_open (lua_State* L)
 {
     int top = lua_gettop(L);
+    /* the metatables of a closed state may be reused by this one */
+    tolua_cleartypecache();
     lua_pushstring(L,"tolua_opened");
     lua_rawget(L,LUA_REGISTRYINDEX);
     if (!lua_isboolean(L,-1))
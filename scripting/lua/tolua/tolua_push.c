@@ -16,6 +16,7 @@
 #include "lauxlib.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 TOLUA_API void tolua_pushvalue (lua_State* L, int lo)
 {
@@ -124,6 +125,44 @@ TOLUA_API void tolua_pushusertype_and_takeownership (lua_State* L, void* value,
     tolua_register_gc(L,lua_gettop(L));
 }
 
+/* Push a copy of a value type, like a point or a size.
+    * The copy is stored in the userdata itself instead of being allocated and
+    * registered for collection, so the type must not need a destructor, and the
+    * ownership of the object must not be taken.
+*/
+#define TOLUA_VALUE_OFFSET  (sizeof(void*) > sizeof(double) ? sizeof(void*) : sizeof(double))
+
+TOLUA_API void tolua_pushusertype_value (lua_State* L, const void* value, unsigned int size, const char* type)
+{
+    void** u;
+    luaL_getmetatable(L, type);                                     /* stack: mt */
+    if (lua_isnil(L, -1)) { /* NOT FOUND metatable */
+        return;
+    }
+    u = (void**)lua_newuserdata(L, TOLUA_VALUE_OFFSET + size);      /* stack: mt newud */
+    *u = (char*)u + TOLUA_VALUE_OFFSET;
+    memcpy(*u, value, size);
+    lua_insert(L,-2);                                               /* stack: newud mt */
+    lua_pushstring(L,"tolua_ubox");
+    lua_rawget(L,-2);                                               /* stack: newud mt ubox */
+    if (lua_isnil(L, -1)) {
+        lua_pop(L, 1);
+        lua_pushstring(L, "tolua_ubox");
+        lua_rawget(L, LUA_REGISTRYINDEX);
+    };
+    /* the address is new, so it can't be in the ubox yet */
+    lua_pushlightuserdata(L,*u);
+    lua_pushvalue(L,-4);
+    lua_rawset(L,-3);                      /* ubox[value] = newud, stack: newud mt ubox */
+    lua_pop(L,1);                                                   /* stack: newud mt */
+    lua_setmetatable(L,-2);                                         /* stack: newud */
+
+#ifdef LUA_VERSION_NUM
+    lua_pushvalue(L, TOLUA_NOPEER);
+    lua_setfenv(L, -2);
+#endif
+}
+
 TOLUA_API void tolua_pushfieldvalue (lua_State* L, int lo, int index, int v)
 {
     lua_pushnumber(L,index);
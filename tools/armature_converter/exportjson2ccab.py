@@ -0,0 +1,198 @@
+#!/usr/bin/python
+# exportjson2ccab.py
+# Converts CocoStudio armature files (.ExportJson / .json) to the binary armature format
+# loaded by DataReaderHelper (.ccab)
+# Copyright (c) 2013 cocos2d-x.org
+#
+# usage: exportjson2ccab.py input.ExportJson [output.ccab]
+#
+# Layout of a .ccab file, all values little endian:
+#   header:     char magic[4] = "CCAB", uint32 version, uint32 armatureCount, boneCount, displayCount,
+#               animationCount, movementCount, movementBoneCount, frameCount, textureCount,
+#               contourCount, vertexCount, stringTableSize
+#   node:       float x, y, int32 zOrder, float skewX, skewY, scaleX, scaleY,
+#               uint32 useColorInfo, uint8 a, r, g, b (part of bones and frames)
+#   armatures:  armatureCount x (uint32 nameOffset, firstBone, boneCount)
+#   bones:      boneCount x (uint32 nameOffset, parentNameOffset, node, uint32 firstDisplay, displayCount)
+#   displays:   displayCount x (uint32 displayType, nameOffset, fragOffset)
+#   animations: animationCount x (uint32 nameOffset, firstMovement, movementCount)
+#   movements:  movementCount x (uint32 nameOffset, int32 duration, durationTo, durationTween,
+#               uint32 loop, int32 tweenEasing, uint32 firstMovementBone, movementBoneCount)
+#   movement bones: movementBoneCount x (uint32 nameOffset, float delay, scale, uint32 firstFrame, frameCount)
+#   frames:     frameCount x (node, int32 duration, tweenEasing, displayIndex, uint32 eventOffset)
+#   textures:   textureCount x (uint32 nameOffset, float width, height, pivotX, pivotY,
+#               uint32 firstContour, contourCount)
+#   contours:   contourCount x (uint32 firstVertex, vertexCount)
+#   vertices:   vertexCount x (float x, y)
+#   strings:    '\0' terminated strings, referenced by their offset
+# The positions are stored unscaled: DataReaderHelper::setPositionReadScale() applies when loading.
+
+import json
+import os
+import struct
+import sys
+
+MAGIC = b"CCAB"
+VERSION = 1
+NO_STRING = 0xffffffff
+
+DISPLAY_SPRITE = 0
+DISPLAY_ARMATURE = 1
+DISPLAY_PARTICLE = 2
+DISPLAY_SHADER = 3
+
+
+class Writer(object):
+    def __init__(self):
+        self.strings = bytearray()
+        self.offsets = {}
+        self.sections = dict((name, bytearray()) for name in ("armatures", "bones", "displays", "animations",
+                                                               "movements", "movement_bones", "frames",
+                                                               "textures", "contours", "vertices"))
+        self.counts = dict((name, 0) for name in self.sections)
+
+    def string(self, s):
+        if s is None:
+            return NO_STRING
+        if s not in self.offsets:
+            self.offsets[s] = len(self.strings)
+            self.strings.extend(s.encode("utf-8") + b"\0")
+        return self.offsets[s]
+
+    def add(self, section, data):
+        self.sections[section].extend(data)
+        self.counts[section] += 1
+        return self.counts[section] - 1
+
+    def next_index(self, section):
+        """ the children of a record are contiguous: returns the index of the first one """
+        return self.counts[section]
+
+
+def node(d):
+    """ like DataReaderHelper::decodeNode """
+    colors = d.get("color") or []
+    color = colors[0] if colors else None
+    if color is None:
+        color_info = (0, 255, 255, 255, 255)
+    else:
+        color_info = (1,) + tuple(int(color.get(k, 255)) & 0xff for k in ("a", "r", "g", "b"))
+    return struct.pack("<2fi4fI4B", float(d.get("x", 0)), float(d.get("y", 0)), int(d.get("z", 0)),
+                       float(d.get("kX", 0)), float(d.get("kY", 0)), float(d.get("cX", 1)), float(d.get("cY", 1)),
+                       *color_info)
+
+
+def convert_display(w, d):
+    display_type = int(d.get("displayType", DISPLAY_SPRITE))
+    if display_type == DISPLAY_PARTICLE:
+        name, frag = d.get("plist"), None
+    elif display_type == DISPLAY_SHADER:
+        name, frag = d.get("vert"), d.get("frag")
+    else:
+        name, frag = d.get("name"), None
+    return w.add("displays", struct.pack("<III", display_type, w.string(name), w.string(frag)))
+
+
+def convert_armature(w, armature):
+    bones = armature.get("bone_data", [])
+    records = []
+    for bone in bones:
+        displays = bone.get("display_data", [])
+        first_display = w.next_index("displays")
+        for display in displays:
+            convert_display(w, display)
+        records.append(struct.pack("<II", w.string(bone.get("name")), w.string(bone.get("parent")))
+                       + node(bone) + struct.pack("<II", first_display, len(displays)))
+    first_bone = w.next_index("bones")
+    for record in records:
+        w.add("bones", record)
+    w.add("armatures", struct.pack("<III", w.string(armature.get("name")), first_bone, len(bones)))
+
+
+def convert_movement_bone(w, movement_bone):
+    frames = movement_bone.get("frame_data", [])
+    first_frame = w.next_index("frames")
+    for frame in frames:
+        w.add("frames", node(frame) + struct.pack("<iiiI", int(frame.get("dr", 1)), int(frame.get("twE", 0)),
+                                                  int(frame.get("dI", 0)), w.string(frame.get("evt"))))
+    return struct.pack("<IffII", w.string(movement_bone.get("name")), float(movement_bone.get("dl", 0)),
+                       float(movement_bone.get("sc", 1)), first_frame, len(frames))
+
+
+def convert_animation(w, animation):
+    movements = animation.get("mov_data", [])
+    records = []
+    for movement in movements:
+        movement_bones = [convert_movement_bone(w, b) for b in movement.get("mov_bone_data", [])]
+        first_movement_bone = w.next_index("movement_bones")
+        for record in movement_bones:
+            w.add("movement_bones", record)
+        records.append(struct.pack("<IiiiIiII", w.string(movement.get("name")), int(movement.get("dr", 0)),
+                                   int(movement.get("to", 0)), int(movement.get("drTW", 0)),
+                                   1 if movement.get("lp", True) else 0, int(movement.get("twE", 0)),
+                                   first_movement_bone, len(movement_bones)))
+    first_movement = w.next_index("movements")
+    for record in records:
+        w.add("movements", record)
+    w.add("animations", struct.pack("<III", w.string(animation.get("name")), first_movement, len(records)))
+
+
+def convert_texture(w, texture):
+    contours = texture.get("contour_data", [])
+    records = []
+    for contour in contours:
+        # DataReaderHelper::decodeContour reads the vertices backwards
+        vertices = list(reversed(contour.get("vertex", [])))
+        first_vertex = w.next_index("vertices")
+        for vertex in vertices:
+            w.add("vertices", struct.pack("<ff", float(vertex.get("x", 0)), float(vertex.get("y", 0))))
+        records.append(struct.pack("<II", first_vertex, len(vertices)))
+    first_contour = w.next_index("contours")
+    for record in records:
+        w.add("contours", record)
+    w.add("textures", struct.pack("<I4fII", w.string(texture.get("name")), float(texture.get("width", 0)),
+                                  float(texture.get("height", 0)), float(texture.get("pX", 0)),
+                                  float(texture.get("pY", 0)), first_contour, len(records)))
+
+
+def convert(json_path, output_path):
+    with open(json_path, "rb") as f:
+        root = json.loads(f.read().decode("utf-8"))
+
+    w = Writer()
+    for armature in root.get("armature_data", []):
+        convert_armature(w, armature)
+    for animation in root.get("animation_data", []):
+        convert_animation(w, animation)
+    for texture in root.get("texture_data", []):
+        convert_texture(w, texture)
+
+    # keep the file size 4 bytes aligned
+    while len(w.strings) % 4:
+        w.strings.extend(b"\0")
+    if not w.strings:
+        w.strings.extend(b"\0\0\0\0")
+
+    order = ("armatures", "bones", "displays", "animations", "movements", "movement_bones", "frames",
+             "textures", "contours", "vertices")
+    header = struct.pack("<4s12I", MAGIC, VERSION, *([w.counts[name] for name in order] + [len(w.strings)]))
+    with open(output_path, "wb") as f:
+        f.write(header)
+        for name in order:
+            f.write(w.sections[name])
+        f.write(w.strings)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: %s input.ExportJson [output.ccab]" % os.path.basename(sys.argv[0]))
+        sys.exit(1)
+
+    json_path = sys.argv[1]
+    output_path = sys.argv[2] if len(sys.argv) > 2 else os.path.splitext(json_path)[0] + ".ccab"
+    convert(json_path, output_path)
+    print("%s -> %s" % (json_path, output_path))
+
+
+if __name__ == "__main__":
+    main()
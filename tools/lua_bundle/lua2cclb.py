@@ -0,0 +1,119 @@
+#!/usr/bin/python
+# lua2cclb.py
+# Packs the Lua scripts of a directory into one bundle loaded by LuaBundle (.cclb),
+# as source or precompiled with luajit or luac
+# Copyright (c) 2013 cocos2d-x.org
+#
+# usage: lua2cclb.py [--luajit PATH | --luac PATH] [--strip] directory output.cclb
+#
+# The scripts are named by their path relative to the directory, with '/' separators,
+# like "game/main.lua": that is the file name require("game.main") looks for.
+# LuaJIT bytecode only runs on LuaJIT of the same version, luac bytecode only on the
+# Lua of the same version and word size; without a compiler the scripts are packed as source.
+#
+# Layout of a .cclb file, all values little endian:
+#   header:  char magic[4] = "CCLB", uint32 version, uint32 entryCount, uint32 stringTableSize
+#   entries: entryCount x (uint32 nameOffset, uint32 dataOffset, uint32 dataSize)
+#   strings: '\0' terminated names, referenced by their offset in the string table
+#   data:    the scripts, referenced by their offset in the file
+
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+MAGIC = b"CCLB"
+VERSION = 1
+HEADER_SIZE = 16
+ENTRY_SIZE = 12
+
+
+def usage():
+    print("usage: %s [--luajit PATH | --luac PATH] [--strip] directory output.cclb" % os.path.basename(sys.argv[0]))
+    sys.exit(1)
+
+
+def compile_script(path, compiler, strip):
+    """ returns the bytecode of the script, or its source without compiler """
+    if compiler is None:
+        with open(path, "rb") as f:
+            return f.read()
+
+    kind, executable = compiler
+    fd, output = tempfile.mkstemp(suffix=".raw")
+    os.close(fd)
+    try:
+        if kind == "luajit":
+            command = [executable, "-b"] + (["-s"] if strip else ["-g"]) + [path, output]
+        else:
+            command = [executable] + (["-s"] if strip else []) + ["-o", output, path]
+        subprocess.check_call(command)
+        with open(output, "rb") as f:
+            return f.read()
+    finally:
+        os.remove(output)
+
+
+def collect_scripts(directory):
+    scripts = []
+    for root, dirs, files in os.walk(directory):
+        dirs.sort()
+        for name in sorted(files):
+            if name.endswith(".lua"):
+                path = os.path.join(root, name)
+                scripts.append((os.path.relpath(path, directory).replace(os.sep, "/"), path))
+    return scripts
+
+
+def pack(directory, output_path, compiler, strip):
+    scripts = collect_scripts(directory)
+
+    strings = bytearray()
+    chunks = []
+    for name, path in scripts:
+        name_offset = len(strings)
+        strings.extend(name.encode("utf-8") + b"\0")
+        chunks.append((name_offset, compile_script(path, compiler, strip)))
+
+    # the data is aligned on 4 bytes
+    data_offset = HEADER_SIZE + ENTRY_SIZE * len(chunks) + len(strings)
+    padding = (4 - data_offset % 4) % 4
+    data_offset += padding
+
+    entries = bytearray()
+    data = bytearray()
+    for name_offset, chunk in chunks:
+        entries.extend(struct.pack("<III", name_offset, data_offset + len(data), len(chunk)))
+        data.extend(chunk)
+        data.extend(b"\0" * ((4 - len(chunk) % 4) % 4))
+
+    with open(output_path, "wb") as f:
+        f.write(struct.pack("<4sIII", MAGIC, VERSION, len(chunks), len(strings)))
+        f.write(entries)
+        f.write(strings)
+        f.write(b"\0" * padding)
+        f.write(data)
+
+    print("%s: %d scripts" % (output_path, len(chunks)))
+
+
+def main():
+    args = sys.argv[1:]
+    compiler = None
+    strip = False
+    while args and args[0].startswith("--"):
+        option = args.pop(0)
+        if option in ("--luajit", "--luac") and args:
+            compiler = (option[2:], args.pop(0))
+        elif option == "--strip":
+            strip = True
+        else:
+            usage()
+    if len(args) != 2:
+        usage()
+    pack(args[0], args[1], compiler, strip)
+
+
+if __name__ == "__main__":
+    main()
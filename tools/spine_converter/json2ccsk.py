@@ -0,0 +1,172 @@
+#!/usr/bin/python
+# json2ccsk.py
+# Converts Spine skeleton files (.json) to the binary skeleton format
+# loaded by SkeletonBinary (.ccsk)
+# Copyright (c) 2013 cocos2d-x.org
+#
+# usage: json2ccsk.py input.json [output.ccsk]
+#
+# Layout of a .ccsk file, all values little endian, in the order the skeleton data is created:
+#   header:     char magic[4] = "CCSK", uint32 version
+#   string:     uint32 length (0xffffffff for no string), the characters and a '\0'
+#   bones:      uint32 count x (string name, int32 parentIndex (-1 for the root),
+#               float length, x, y, rotation, scaleX, scaleY)
+#   slots:      uint32 count x (string name, uint32 boneIndex, float r, g, b, a, string attachment)
+#   skins:      uint32 count x (string name, uint32 attachmentCount x (uint32 slotIndex,
+#               string skinAttachmentName, string attachmentName, uint32 type (0 region, 1 regionSequence),
+#               float x, y, scaleX, scaleY, rotation, width, height))
+#   animations: uint32 count x (string name, uint32 timelineCount x (uint32 type, uint32 boneOrSlotIndex,
+#               uint32 frameCount, frames))
+#   frames:     rotate (type 0):               float time, angle, curve
+#               translate, scale (types 1, 2): float time, x, y, curve
+#               color (type 3):                float time, r, g, b, a, curve
+#               attachment (type 4):           float time, string name
+#   curve:      uint32 kind (0 linear, 1 stepped, 2 bezier), followed by float cx1, cy1, cx2, cy2 for bezier
+# The positions are stored unscaled: SkeletonBinary::scale applies when loading.
+
+import collections
+import json
+import os
+import struct
+import sys
+
+MAGIC = b"CCSK"
+VERSION = 1
+NO_STRING = 0xffffffff
+
+BONE_TIMELINES = {"rotate": 0, "translate": 1, "scale": 2}
+SLOT_TIMELINES = {"color": 3, "attachment": 4}
+ATTACHMENT_TYPES = {"region": 0, "regionSequence": 1}
+
+
+def string(value):
+    if value is None:
+        return struct.pack("<I", NO_STRING)
+    data = value.encode("utf-8")
+    return struct.pack("<I", len(data)) + data + b"\0"
+
+
+def color(value):
+    """ 'rrggbbaa' -> [r, g, b, a], like toColor() in SkeletonJson.cpp """
+    if value is None:
+        return [1.0, 1.0, 1.0, 1.0]
+    if len(value) != 8:
+        return [-1.0] * 4
+    return [int(value[i:i + 2], 16) / 255.0 for i in range(0, 8, 2)]
+
+
+def curve(frame):
+    value = frame.get("curve")
+    if value == "stepped":
+        return struct.pack("<I", 1)
+    if isinstance(value, list):
+        return struct.pack("<I4f", 2, *[float(v) for v in value[:4]])
+    return struct.pack("<I", 0)
+
+
+def timeline(kind, index, frames):
+    out = bytearray(struct.pack("<3I", kind, index, len(frames)))
+    for frame in frames:
+        time = float(frame.get("time", 0))
+        if kind == 0:
+            out += struct.pack("<2f", time, float(frame.get("angle", 0))) + curve(frame)
+        elif kind in (1, 2):
+            out += struct.pack("<3f", time, float(frame.get("x", 0)), float(frame.get("y", 0))) + curve(frame)
+        elif kind == 3:
+            out += struct.pack("<5f", time, *color(frame.get("color"))) + curve(frame)
+        else:
+            out += struct.pack("<f", time) + string(frame.get("name"))
+    return out
+
+
+def convert(json_path, output_path):
+    with open(json_path, "rb") as f:
+        root = json.loads(f.read().decode("utf-8"), object_pairs_hook=collections.OrderedDict)
+
+    out = bytearray(MAGIC + struct.pack("<I", VERSION))
+
+    bones = root.get("bones", [])
+    bone_indices = {}
+    out += struct.pack("<I", len(bones))
+    for index, bone in enumerate(bones):
+        parent = bone.get("parent")
+        if parent is not None and parent not in bone_indices:
+            raise ValueError("parent bone not found: %s" % parent)
+        bone_indices[bone["name"]] = index
+        out += string(bone["name"])
+        out += struct.pack("<i6f", bone_indices[parent] if parent is not None else -1,
+                           float(bone.get("length", 0)), float(bone.get("x", 0)), float(bone.get("y", 0)),
+                           float(bone.get("rotation", 0)), float(bone.get("scaleX", 1)), float(bone.get("scaleY", 1)))
+
+    slots = root.get("slots", [])
+    slot_indices = {}
+    out += struct.pack("<I", len(slots))
+    for index, slot in enumerate(slots):
+        if slot.get("bone") not in bone_indices:
+            raise ValueError("slot bone not found: %s" % slot.get("bone"))
+        slot_indices[slot["name"]] = index
+        out += string(slot["name"]) + struct.pack("<I4f", bone_indices[slot["bone"]], *color(slot.get("color")))
+        out += string(slot.get("attachment"))
+
+    # the key order of the JSON objects is kept, like Json.cpp does
+    skins = root.get("skins", {})
+    out += struct.pack("<I", len(skins))
+    for skin_name, skin in skins.items():
+        attachments = bytearray()
+        count = 0
+        for slot_name, slot_attachments in skin.items():
+            if slot_name not in slot_indices:
+                raise ValueError("skin slot not found: %s" % slot_name)
+            for attachment_name, attachment in slot_attachments.items():
+                kind = attachment.get("type", "region")
+                if kind not in ATTACHMENT_TYPES:
+                    raise ValueError("unknown attachment type: %s" % kind)
+                attachments += struct.pack("<I", slot_indices[slot_name]) + string(attachment_name)
+                attachments += string(attachment.get("name", attachment_name))
+                attachments += struct.pack("<I7f", ATTACHMENT_TYPES[kind],
+                                           float(attachment.get("x", 0)), float(attachment.get("y", 0)),
+                                           float(attachment.get("scaleX", 1)), float(attachment.get("scaleY", 1)),
+                                           float(attachment.get("rotation", 0)),
+                                           float(attachment.get("width", 32)), float(attachment.get("height", 32)))
+                count += 1
+        out += string(skin_name) + struct.pack("<I", count) + attachments
+
+    animations = root.get("animations", {})
+    out += struct.pack("<I", len(animations))
+    for animation_name, animation in animations.items():
+        timelines = []
+        for bone_name, bone_timelines in animation.get("bones", {}).items():
+            if bone_name not in bone_indices:
+                raise ValueError("bone not found: %s" % bone_name)
+            for kind, frames in bone_timelines.items():
+                if kind not in BONE_TIMELINES:
+                    raise ValueError("invalid timeline type for a bone: %s" % kind)
+                timelines.append(timeline(BONE_TIMELINES[kind], bone_indices[bone_name], frames))
+        for slot_name, slot_timelines in animation.get("slots", {}).items():
+            if slot_name not in slot_indices:
+                raise ValueError("slot not found: %s" % slot_name)
+            for kind, frames in slot_timelines.items():
+                if kind not in SLOT_TIMELINES:
+                    raise ValueError("invalid timeline type for a slot: %s" % kind)
+                timelines.append(timeline(SLOT_TIMELINES[kind], slot_indices[slot_name], frames))
+        out += string(animation_name) + struct.pack("<I", len(timelines))
+        for t in timelines:
+            out += t
+
+    with open(output_path, "wb") as f:
+        f.write(out)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: %s input.json [output.ccsk]" % os.path.basename(sys.argv[0]))
+        sys.exit(1)
+
+    json_path = sys.argv[1]
+    output_path = sys.argv[2] if len(sys.argv) > 2 else os.path.splitext(json_path)[0] + ".ccsk"
+    convert(json_path, output_path)
+    print("%s -> %s" % (json_path, output_path))
+
+
+if __name__ == "__main__":
+    main()
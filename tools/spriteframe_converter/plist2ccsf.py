@@ -0,0 +1,112 @@
+#!/usr/bin/python
+# plist2ccsf.py
+# Converts sprite frame plists (Zwoptex / TexturePacker formats 0 to 3)
+# to the binary sprite frame format loaded by SpriteFrameCache (.ccsf)
+# Copyright (c) 2013 cocos2d-x.org
+#
+# usage: plist2ccsf.py input.plist [output.ccsf]
+#
+# Layout of a .ccsf file, all values little endian:
+#   header:  char magic[4] = "CCSF", uint32 version, uint32 frameCount,
+#            uint32 aliasCount, uint32 textureNameOffset, uint32 stringTableSize
+#   frames:  frameCount x (uint32 nameOffset, float x, y, width, height,
+#            float offsetX, offsetY, float sourceWidth, sourceHeight, uint32 rotated)
+#   aliases: aliasCount x (uint32 nameOffset, uint32 frameIndex)
+#   strings: '\0' terminated names, referenced by their offset
+
+import os
+import re
+import struct
+import sys
+import plistlib
+
+MAGIC = b"CCSF"
+VERSION = 1
+NO_NAME = 0xffffffff
+
+
+def read_plist(path):
+    with open(path, "rb") as f:
+        if hasattr(plistlib, "load"):
+            return plistlib.load(f)
+        return plistlib.readPlist(f)
+
+
+def numbers(value):
+    """ '{{1,2},{3,4}}' -> [1.0, 2.0, 3.0, 4.0] """
+    return [float(n) for n in re.findall(r"[-+]?[0-9]*\.?[0-9]+(?:[eE][-+]?[0-9]+)?", value)]
+
+
+def convert_frame(fmt, frame):
+    """ returns (rect, rotated, offset, source size, aliases), like SpriteFrameCache::addSpriteFramesWithDictionary """
+    if fmt == 0:
+        rect = [float(frame["x"]), float(frame["y"]), float(frame["width"]), float(frame["height"])]
+        offset = [float(frame.get("offsetX", 0)), float(frame.get("offsetY", 0))]
+        source = [abs(int(frame.get("originalWidth", 0))), abs(int(frame.get("originalHeight", 0)))]
+        return rect, False, offset, source, []
+    if fmt in (1, 2):
+        rotated = fmt == 2 and bool(frame.get("rotated", False))
+        return numbers(frame["frame"]), rotated, numbers(frame["offset"]), numbers(frame["sourceSize"]), []
+    if fmt == 3:
+        size = numbers(frame["spriteSize"])
+        texture_rect = numbers(frame["textureRect"])
+        rect = [texture_rect[0], texture_rect[1], size[0], size[1]]
+        return (rect, bool(frame.get("textureRotated", False)), numbers(frame["spriteOffset"]),
+                numbers(frame["spriteSourceSize"]), list(frame.get("aliases", [])))
+    raise ValueError("unsupported format %d" % fmt)
+
+
+def convert(plist_path, output_path):
+    root = read_plist(plist_path)
+    metadata = root.get("metadata", {})
+    fmt = int(metadata.get("format", 0))
+
+    strings = bytearray()
+    offsets = {}
+
+    def add_string(s):
+        if s not in offsets:
+            offsets[s] = len(strings)
+            strings.extend(s.encode("utf-8") + b"\0")
+        return offsets[s]
+
+    texture_name = metadata.get("textureFileName", "")
+    texture_offset = add_string(texture_name) if texture_name else NO_NAME
+
+    frames = bytearray()
+    aliases = bytearray()
+    names = sorted(root.get("frames", {}).keys())
+    for index, name in enumerate(names):
+        rect, rotated, offset, source, frame_aliases = convert_frame(fmt, root["frames"][name])
+        frames.extend(struct.pack("<I4f2f2fI", add_string(name), rect[0], rect[1], rect[2], rect[3],
+                                  offset[0], offset[1], source[0], source[1], 1 if rotated else 0))
+        for alias in frame_aliases:
+            aliases.extend(struct.pack("<II", add_string(alias), index))
+
+    # keep the file size 4 bytes aligned
+    while len(strings) % 4:
+        strings.extend(b"\0")
+    if not strings:
+        strings.extend(b"\0\0\0\0")
+
+    header = struct.pack("<4sIIIII", MAGIC, VERSION, len(names), len(aliases) // 8, texture_offset, len(strings))
+    with open(output_path, "wb") as f:
+        f.write(header)
+        f.write(frames)
+        f.write(aliases)
+        f.write(strings)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("usage: %s input.plist [output.ccsf]" % os.path.basename(sys.argv[0]))
+        sys.exit(1)
+
+    plist_path = sys.argv[1]
+    output_path = sys.argv[2] if len(sys.argv) > 2 else os.path.splitext(plist_path)[0] + ".ccsf"
+    convert(plist_path, output_path)
+    print("%s -> %s" % (plist_path, output_path))
+
+
+if __name__ == "__main__":
+    main()
@@ -321,6 +321,16 @@ TOLUA_API int  tolua_Cocos2d_open (lua_State* tolua_S);]], [[]])
 
     result = string.gsub(result, '(\"const )(CC%u%w*)', '%1_%2')
 
+    -- points, sizes and rects returned by value are copied in their userdata instead of being allocated
+    local value_types = { CCPoint = true, CCSize = true, CCRect = true }
+    result = string.gsub(result,
+        'void%* tolua_obj = Mtolua_new%(%((CC%w+)%)%(tolua_ret%)%);%s*tolua_pushusertype%(tolua_S,tolua_obj,"(CC%w+)"%);%s*tolua_register_gc%(tolua_S,lua_gettop%(tolua_S%)%);',
+        function(class, name)
+            if value_types[class] then
+                return 'tolua_pushusertype_value(tolua_S,&tolua_ret,sizeof('..class..'),"'..name..'");'
+            end
+        end)
+
     local skip_contents = { "CCPointMake", "CCSizeMake", "CCRectMake", "CCLOG", "CCLog", "CCAssert", "CCTexture2DPixelFormat", "CCTextAlignment", "CCVerticalTextAlignment", "CCControlState", "CCControlEvent" }
 
     local function remove_prefix()